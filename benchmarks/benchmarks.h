@@ -9,7 +9,10 @@
 #define BENCHMARKS_BENCHMARKS_H_
 
 
+// Can be overridden on the command line, e.g. -DNB_TESTS=50
+#ifndef NB_TESTS
 #define NB_TESTS 20
+#endif
 #define CHECK_CORRECTNESS 1
 #define PRINT_OUTPUT 0 
 #define SIZE_IS_MULTIPLE_OF_TILE 1
@@ -0,0 +1,86 @@
+#! /usr/bin/python3
+"""
+Compare benchmark results with a baseline and report the regressions.
+
+The results and the baseline are files written by the benchmarks when the
+environment variable TIRAMISU_BENCHMARK_JSON is set (see print_time() in
+include/tiramisu/utils.h): one JSON object per line, with the median time
+in ms of each variant (Tiramisu, reference, ...) of a kernel.  When a kernel
+appears several times in a file, its last run is used.
+
+Usage: compare_benchmarks.py RESULTS BASELINE [--threshold 0.05] [--update]
+
+A variant is a regression if its time is more than (1 + threshold) times
+its time in the baseline.  The exit status is 1 if there is a regression.
+With --update, the results are copied to the baseline afterwards.
+"""
+
+import argparse
+import json
+import shutil
+import sys
+
+
+def load_results(file_name):
+    results = {}
+    with open(file_name) as f:
+        for line in f:
+            line = line.strip()
+            if line:
+                record = json.loads(line)
+                results[record["kernel"]] = record
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare benchmark results with a baseline.")
+    parser.add_argument("results")
+    parser.add_argument("baseline")
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="relative slowdown above which a variant is a regression")
+    parser.add_argument("--update", action="store_true", help="copy the results to the baseline")
+    args = parser.parse_args()
+
+    results = load_results(args.results)
+    try:
+        baseline = load_results(args.baseline)
+    except FileNotFoundError:
+        print("No baseline " + args.baseline + ", nothing to compare.")
+        baseline = {}
+
+    regressions = 0
+    for kernel, record in sorted(results.items()):
+        if kernel not in baseline:
+            print("%-30s new kernel" % kernel)
+            continue
+
+        reference = baseline[kernel]
+        if record["hardware"]["cpu"] != reference["hardware"]["cpu"]:
+            print("%-30s warning: baseline measured on %s" % (kernel, reference["hardware"]["cpu"]))
+
+        for variant, time in record["median_ms"].items():
+            if variant not in reference["median_ms"] or reference["median_ms"][variant] <= 0:
+                continue
+            ratio = time / reference["median_ms"][variant]
+            status = ""
+            if ratio > 1 + args.threshold:
+                status = "REGRESSION"
+                regressions += 1
+            elif ratio < 1 - args.threshold:
+                status = "improvement"
+            print("%-30s %-15s %12.4f ms  baseline %12.4f ms  x%.3f %s"
+                  % (kernel, variant, time, reference["median_ms"][variant], ratio, status))
+
+    for kernel in sorted(set(baseline) - set(results)):
+        print("%-30s missing from the results" % kernel)
+
+    print("%d regression(s)" % regressions)
+
+    if args.update:
+        shutil.copyfile(args.results, args.baseline)
+
+    return 1 if regressions > 0 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
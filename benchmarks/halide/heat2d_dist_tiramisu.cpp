@@ -253,6 +253,11 @@ int main(int argc, char **argv)
       //      send_recv_fwd_odd_mpi.r->unschedule_this_computation();
       //      send_recv_bkwd_odd_mpi.s->unschedule_this_computation();
       //      send_recv_bkwd_odd_mpi.r->unschedule_this_computation();
+
+      // Post the halo exchanges as Isend/Irecv, compute the interior rows while
+      // they are in flight and only wait for them before the boundary rows.
+      out_comp_even.overlap_communication({send_recv_fwd_even_mpi, send_recv_bkwd_even_mpi}, t, i, 1);
+      out_comp_odd.overlap_communication({send_recv_fwd_odd_mpi, send_recv_bkwd_odd_mpi}, t, i, 1);
     }
 #endif
 
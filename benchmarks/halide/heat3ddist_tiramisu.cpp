@@ -102,6 +102,8 @@ int main(int argc, char **argv)
     v.store_in(&b_out);
     send_previous_left.r->set_access("{border_recv_pleft[t,r,k,j,i]->b_out[t-1,k,j,i]}");
     send_previous_right.r->set_access("{border_recv_pright[t,r,k,j,i]->b_out[t-1,k,j,i]}");
+    //overlap the exchange of the borders with the computation of the interior
+    heat3dc.overlap_communication({send_previous_right, send_previous_left}, t, z, 1);
     //code generation
     codegen({&b_in,&b_out}, "build/generated_fct_heat3ddist.o");
 
@@ -7,7 +7,10 @@
 #include "tiramisu/mpi_comm.h"
 
 int main(int, char**) {
-    int rank = tiramisu_MPI_init();
+    tiramisu_MPI_init();
+    //place neighbouring subdomains on the same node
+    int grid[1] = {NODES};
+    int rank = tiramisu_MPI_init_topology(1, grid);
     std::vector<std::chrono::duration<double,std::milli>> duration_vector_1;
     std::vector<std::chrono::duration<double,std::milli>> duration_vector_2;
     std::cout << "I'm rank == " << rank << std::endl;
@@ -28,14 +31,14 @@ int main(int, char**) {
     // Tiramisu
     for (int i=0; i<1; i++)
     {
-        MPI_Barrier(MPI_COMM_WORLD);
+        MPI_Barrier(tiramisu_MPI_world());
         auto start1 = std::chrono::high_resolution_clock::now();
         heat3ddist(node_input.raw_buffer(), node_output.raw_buffer());
         auto end1 = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double,std::milli> duration1 = end1 - start1;
         duration_vector_1.push_back(duration1);
     }
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(tiramisu_MPI_world());
 
     //gather all inputs, and outputs
     float in_node[_Z/NODES][_Y][_X];
@@ -48,7 +51,7 @@ int main(int, char**) {
                 in_node[z][c][r]=node_input(r, c, z);
           }
     }
-    MPI_Gather(in_node, _X*_Y*_Z/NODES, MPI_FLOAT,in_global, _X*_Y*_Z/NODES, MPI_FLOAT,0,MPI_COMM_WORLD);
+    MPI_Gather(in_node, _X*_Y*_Z/NODES, MPI_FLOAT,in_global, _X*_Y*_Z/NODES, MPI_FLOAT,0,tiramisu_MPI_world());
     //if z%NODES!=0 the last node will need to send more than _X*_Y*_Z/NODES a more sophisticated test
     //will be written
 
@@ -60,7 +63,7 @@ int main(int, char**) {
                    out_node[z-1][c][r]=node_output(r,c,z,_TIME);
             }
     }
-    MPI_Gather(out_node,_X*_Y*_Z/NODES,MPI_FLOAT,out_global,_X*_Y*_Z/NODES,MPI_FLOAT,0,MPI_COMM_WORLD);
+    MPI_Gather(out_node,_X*_Y*_Z/NODES,MPI_FLOAT,out_global,_X*_Y*_Z/NODES,MPI_FLOAT,0,tiramisu_MPI_world());
 
     if(rank==0){
         //copy to a halide buffer
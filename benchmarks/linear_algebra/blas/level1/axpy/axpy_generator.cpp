@@ -18,9 +18,12 @@ using namespace tiramisu;
 /**
  * Benchmark for BLAS SAXPY
  *     y = a*x + y 
+ *
+ * The size N is a parameter of the generated code, read from the input
+ * buffer SIZES, so that the same code runs on any size.
  */
 
-void generate_function(std::string name, int size)
+void generate_function(std::string name)
 {
     tiramisu::global::set_default_tiramisu_options();
 
@@ -29,7 +32,8 @@ void generate_function(std::string name, int size)
     // -------------------------------------------------------
 
     tiramisu::function function0(name);
-    tiramisu::constant N("N", tiramisu::expr((int32_t) size), p_int32, true, NULL, 0, &function0);
+    tiramisu::computation SIZES("{SIZES[i]}", tiramisu::expr(), false, p_int32, &function0);
+    tiramisu::constant N("N", SIZES(0), p_int32, true, NULL, 0, &function0);
     tiramisu::var i("i");
     tiramisu::var j("j");
     tiramisu::computation x("[N]->{x[i]: 0<=i<N}", tiramisu::expr(), false, p_float32, &function0);
@@ -57,10 +61,12 @@ void generate_function(std::string name, int size)
     // Layer III
     // -------------------------------------------------------
 
+    tiramisu::buffer buf_SIZES("buf_SIZES", {1}, tiramisu::p_int32, a_input, &function0);
     tiramisu::buffer buf_a("buf_a", {1}, tiramisu::p_float32, a_input, &function0);
-    tiramisu::buffer buf_x("buf_x", {10}, tiramisu::p_float32, a_input, &function0);
-    tiramisu::buffer buf_y("buf_y", {10}, tiramisu::p_float32, a_output, &function0);
+    tiramisu::buffer buf_x("buf_x", {tiramisu::var(p_int32, "N")}, tiramisu::p_float32, a_input, &function0);
+    tiramisu::buffer buf_y("buf_y", {tiramisu::var(p_int32, "N")}, tiramisu::p_float32, a_output, &function0);
 
+    SIZES.set_access("{SIZES[i]->buf_SIZES[i]}");
     a.set_access("{a[0]->buf_a[0]}");
     x.set_access("[N]->{x[i]->buf_x[i]: 0<=i<N}");
     y.set_access("[N]->{y[i]->buf_y[i]: 0<=i<N}");
@@ -70,7 +76,7 @@ void generate_function(std::string name, int size)
     // Code Generation
     // -------------------------------------------------------
 
-    function0.set_arguments({&buf_a, &buf_x, &buf_y});
+    function0.set_arguments({&buf_SIZES, &buf_a, &buf_x, &buf_y});
     function0.gen_time_space_domain();
     function0.gen_isl_ast();
     function0.gen_halide_stmt();
@@ -79,7 +85,7 @@ void generate_function(std::string name, int size)
 
 int main(int argc, char **argv)
 {
-    generate_function("tiramisu_generated_code", SIZE);
+    generate_function("tiramisu_generated_code");
 
     return 0;
 }
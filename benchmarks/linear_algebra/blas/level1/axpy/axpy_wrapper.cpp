@@ -1,11 +1,16 @@
 #include "Halide.h"
 #include <tiramisu/utils.h>
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include "mkl_cblas.h"
 
 #include "axpy_wrapper.h"
 
+// Can be overridden on the command line, e.g. -DNB_TESTS=50
+#ifndef NB_TESTS
+#define NB_TESTS 20
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -18,28 +23,49 @@ extern "C" {
 
 int main(int, char **)
 {
-    Halide::Buffer<float> a(1, "a");
-    Halide::Buffer<float> x(SIZE, "x");
-    Halide::Buffer<float> y_ref(SIZE, "y_ref");
-    Halide::Buffer<float> y(SIZE, "y");
-
-    init_buffer(x, (float)1);
-    init_buffer(y, (float)1);
-    init_buffer(y_ref, (float)1);
-    init_buffer(a, (float)1);
-
-    tiramisu_timer timer;
-    timer.start();
-    cblas_saxpy(SIZE, 1, x.data(), 1, y_ref.data(), 1);
-    timer.stop();
-    timer.print("MKL saxpy");
-
-    timer.start();
-    tiramisu_generated_code(a.raw_buffer(), x.raw_buffer(), y.raw_buffer());
-    timer.stop();
-    timer.print("Tiramisu saxpy");
-
-    compare_buffers("benchmark_" + std::string(TEST_NAME_STR), y, y_ref);
+    // The generated code is parametric: run it on the sizes given by
+    // TIRAMISU_BENCHMARK_SIZES, or on SIZE.
+    for (int size : get_benchmark_sizes({SIZE}))
+    {
+        std::vector<std::chrono::duration<double,std::milli>> duration_vector_1;
+        std::vector<std::chrono::duration<double,std::milli>> duration_vector_2;
+
+        Halide::Buffer<int> SIZES(1, "SIZES");
+        Halide::Buffer<float> a(1, "a");
+        Halide::Buffer<float> x(size, "x");
+        Halide::Buffer<float> y_ref(size, "y_ref");
+        Halide::Buffer<float> y(size, "y");
+
+        SIZES(0) = size;
+        init_buffer(x, (float)1);
+        init_buffer(a, (float)1);
+
+        for (int i = 0; i < NB_TESTS; i++)
+        {
+            init_buffer(y_ref, (float)1);
+            auto start1 = std::chrono::high_resolution_clock::now();
+            cblas_saxpy(size, 1, x.data(), 1, y_ref.data(), 1);
+            auto end1 = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double,std::milli> duration1 = end1 - start1;
+            duration_vector_1.push_back(duration1);
+        }
+
+        for (int i = 0; i < NB_TESTS; i++)
+        {
+            init_buffer(y, (float)1);
+            auto start2 = std::chrono::high_resolution_clock::now();
+            tiramisu_generated_code(SIZES.raw_buffer(), a.raw_buffer(), x.raw_buffer(), y.raw_buffer());
+            auto end2 = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double,std::milli> duration2 = end2 - start2;
+            duration_vector_2.push_back(duration2);
+        }
+
+        print_time("performance_CPU.csv", "axpy_" + std::to_string(size),
+                   {"MKL", "Tiramisu"},
+                   {median(duration_vector_1), median(duration_vector_2)});
+
+        compare_buffers("benchmark_" + std::string(TEST_NAME_STR), y, y_ref);
+    }
 
     return 0;
 }
@@ -5,7 +5,7 @@
 // Define these values for each new test
 #define TEST_NAME_STR       "axpy"
 
-// Data size
+// Default data size, the generated code takes the size as a parameter
 #if TIRAMISU_XLARGE
 #define SIZE (1024*1024*128)
 #elif TIRAMISU_LARGE
@@ -25,7 +25,7 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
-int tiramisu_generated_code(halide_buffer_t *_p0_buffer, halide_buffer_t *_p1_buffer, halide_buffer_t *_p2_buffer);
+int tiramisu_generated_code(halide_buffer_t *_p0_buffer, halide_buffer_t *_p1_buffer, halide_buffer_t *_p2_buffer, halide_buffer_t *_p3_buffer);
 int tiramisu_generated_code_argv(void **args);
 
 extern const struct halide_filter_metadata_t halide_pipeline_aot_metadata;
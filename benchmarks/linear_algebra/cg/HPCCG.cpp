@@ -72,6 +72,7 @@ using std::endl;
 #include "Halide.h"
 #include "generated_waxpby.o.h"
 #include "generated_cg.o.h"
+#include "generated_cg_update.o.h"
 #include "generated_dot.o.h"
 #include "generated_spmv.o.h"
 
@@ -217,11 +218,16 @@ int     print_spmv(// Input HPCCG format
 int HPCCG_tiramisu(HPC_Sparse_Matrix * A,
 	  const double * const b, double * const x,
 	  const int max_iter, const double tolerance, int &niters, double & normr,
-	  double * times, Halide::Buffer<double> &r)
+	  double * times, Halide::Buffer<double> &r_out)
 {
   int nrow = A->local_nrow;
   int ncol = A->local_ncol;
 
+  // In parallel case, the externals of r (its halo) are stored after its
+  // local rows, like those of p
+  Halide::Buffer<double> r(ncol);
+  Halide::Buffer<double> x_buf(x, nrow);
+
   Halide::Buffer<double> p(A->total_nnz); // In parallel case, A is rectangular
   Halide::Buffer<double> Ap(A->total_nnz);
   Halide::Buffer<double> rtrans(1);
@@ -272,19 +278,24 @@ int HPCCG_tiramisu(HPC_Sparse_Matrix * A,
   std::vector<std::chrono::duration<double,std::milli>> duration_vector_one_iter;
   std::vector<std::chrono::duration<double,std::milli>> duration_vector_comm;
 
+  // From here, rtrans holds the dot product r.r of the local rows, computed
+  // in the same sweep as the update of r (see cg_update in cg_generator.cpp),
+  // and it is reduced across the ranks at the beginning of the next iteration
   for(int k=1; k<=1 && normr > tolerance; k++ )
     {
       Halide::Buffer<double> Ap1(A->total_nnz);
       alpha(0) = 0.0;
       hpccg_waxpby(nrow, 1.0, r.data(), 0.0, r.data(), p.data()); // r + 0*p -> p
+#ifdef USING_MPI
+      exchange_externals(A, p.data());
+#endif
       HPC_sparsemv(A, p.data(), Ap1.data()); // A*p -> Ap
       hpccg_ddot(nrow, p.data(), Ap1.data(), alpha.data()); // p*Ap -> alpha
       alpha(0) = rtrans(0)/alpha(0);
-      hpccg_waxpby(nrow, 1.0, x, alpha(0), p.data(), x);// x + alpha*p -> x
-      hpccg_waxpby(nrow, 1.0, r.data(), -alpha(0), Ap1.data(), r.data());  //  r - alpha.Ap -> r
+      oldrtrans = rtrans(0);
+      cg_update(NROW.raw_buffer(), alpha.raw_buffer(), x_buf.raw_buffer(), p.raw_buffer(), r.raw_buffer(), Ap1.raw_buffer(), rtrans.raw_buffer()); // x + alpha*p -> x; r - alpha*Ap -> r; r*r -> rtrans
 
       niters = k;
-      normr = sqrt(rtrans(0));
     }
 
 
@@ -295,19 +306,36 @@ int HPCCG_tiramisu(HPC_Sparse_Matrix * A,
 
 
       alpha(0) = 0.0;
-      oldrtrans = rtrans(0);
-      dot (NROW.raw_buffer(), r.raw_buffer(), r.raw_buffer(), rtrans.raw_buffer()); // r*r -> rtrans
+#ifdef USING_MPI
+      // The reduction of r*r overlaps with the exchange of the halo of r:
+      // the halo of p = r + beta*p is then computed without communicating
+      auto start_comm = std::chrono::high_resolution_clock::now();
+      double local_rtrans = rtrans(0);
+      MPI_Request rtrans_request;
+      MPI_Iallreduce(&local_rtrans, rtrans.data(), 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD, &rtrans_request);
+      exchange_externals(A, r.data());
+      MPI_Wait(&rtrans_request, MPI_STATUS_IGNORE);
+      auto end_comm = std::chrono::high_resolution_clock::now();
+#endif
       beta(0) = rtrans(0)/oldrtrans;
+      oldrtrans = rtrans(0);
+      normr = sqrt(rtrans(0));
+#ifdef USING_MPI
+      for (int i = nrow; i < ncol; i++)
+        p(i) = r(i) + beta(0)*p(i);
+#endif
 
       cg(NROW.raw_buffer(), a.raw_buffer(), r.raw_buffer(), beta.raw_buffer(), p.raw_buffer(), p.raw_buffer(), row_start.raw_buffer(), col_idx.raw_buffer(), A_tiramisu.raw_buffer(), Ap2.raw_buffer(), alpha.raw_buffer()); // r + beta*p -> p; A*p -> Ap; p*Ap -> alpha
 
+#ifdef USING_MPI
+      double local_alpha = alpha(0);
+      MPI_Allreduce(&local_alpha, alpha.data(), 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+#endif
       alpha(0) = rtrans(0)/alpha(0);
-      hpccg_waxpby(nrow, 1.0, x, alpha(0), p.data(), x);// x + alpha*p -> x
-      hpccg_waxpby(nrow, 1.0, r.data(), -alpha(0), Ap2.data(), r.data());  //  r - alpha.Ap -> r
+      cg_update(NROW.raw_buffer(), alpha.raw_buffer(), x_buf.raw_buffer(), p.raw_buffer(), r.raw_buffer(), Ap2.raw_buffer(), rtrans.raw_buffer()); // x + alpha*p -> x; r - alpha*Ap -> r; r*r -> rtrans
 
 
       niters = k;
-      normr = sqrt(rtrans(0));
       if (rank==0 && (k%print_freq == 0 || k+1 == max_iter))
       cout << "Iteration = "<< k << "   Residual = "<< normr << endl;
       auto end_one_iter = std::chrono::high_resolution_clock::now();
@@ -315,10 +343,13 @@ int HPCCG_tiramisu(HPC_Sparse_Matrix * A,
       duration_vector_one_iter.push_back(duration_one_iter);
 #ifdef USING_MPI
       std::chrono::duration<double,std::milli> duration_one_comm = end_comm - start_comm;
-      duration_vector_one_iter.push_back(duration_one_iter);
+      duration_vector_comm.push_back(duration_one_comm);
 #endif
     }
 
+  for (int i = 0; i < nrow; i++)
+    r_out(i) = r(i);
+
   // Store times
   times[1] = median(duration_vector_one_iter); // Iteration total time
 #ifdef USING_MPI
@@ -22,6 +22,109 @@ using namespace tiramisu;
 #define PARTITIONS (67108864/THREADS)
 
 
+/**
+ * The second half of an iteration of CG in a single sweep over the vectors:
+ *     x = x + alpha*p
+ *     r = r - alpha*Ap
+ *     rtrans = r.r
+ * instead of two waxpby and a ddot (three sweeps).  rtrans is the dot product
+ * of the local rows, the caller reduces it across the ranks.
+ */
+void generate_cg_update()
+{
+    function cg_update("cg_update");
+
+    // Inputs
+    computation SIZES("[M]->{SIZES[0]}", tiramisu::expr(), false, p_int32, &cg_update);
+    computation alpha("[M]->{alpha[0]}", tiramisu::expr(), false, p_float64, &cg_update);
+    computation x("[M]->{x[j]: 0<=j<M}", tiramisu::expr(), false, p_float64, &cg_update);
+    computation p("[M]->{p[j]: 0<=j<M}", tiramisu::expr(), false, p_float64, &cg_update);
+    computation r("[M]->{r[j]: 0<=j<M}", tiramisu::expr(), false, p_float64, &cg_update);
+    computation Ap("[M]->{Ap[j]: 0<=j<M}", tiramisu::expr(), false, p_float64, &cg_update);
+
+    constant M_CST("M", SIZES(0), p_int32, true, NULL, 0, &cg_update);
+
+    tiramisu::var j("j");
+    computation x_update("[M]->{x_update[j]: 0<=j<M}", x(j) + alpha(0)*p(j), true, p_float64, &cg_update);
+    computation r_update("[M]->{r_update[j]: 0<=j<M}", r(j) - alpha(0)*Ap(j), true, p_float64, &cg_update);
+
+    // dot, on the updated r
+    computation rtrans_init("[M]->{rtrans_init[0]}", tiramisu::expr((double) 0), true, p_float64, &cg_update);
+    computation rr_init("[M]->{rr_init[t]: 0<=t<(M/"+std::to_string(PARTITIONS)+")}", tiramisu::expr((double) 0), true, p_float64, &cg_update);
+    computation rr("[M]->{rr[j]: 0<=j<M}", tiramisu::expr(), true, p_float64, &cg_update);
+    rr.set_expression(rr(j) + r_update(j)*r_update(j));
+    computation rr_global("[M]->{rr_global[t]: 0<=t<(M/"+std::to_string(PARTITIONS)+")}", tiramisu::expr(), true, p_float64, &cg_update);
+    rr_global.set_expression(rr_global(var("t")) + rr_init(var("t")));
+
+    cg_update.set_context_set("[M]->{: M>0 and M%"+std::to_string(PARTITIONS)+"=0}");
+
+    // -----------------------------------------------------------------
+    // Layer II
+    // -----------------------------------------------------------------
+    x_update.split(0, PARTITIONS);
+    r_update.split(0, PARTITIONS);
+    rr.split(0, PARTITIONS);
+    x_update.split(1, B2);
+    r_update.split(1, B2);
+    rr.split(1, B2);
+
+    x_update.tag_parallel_level(0);
+    r_update.tag_parallel_level(0);
+    rr.tag_parallel_level(0);
+    x_update.tag_vector_level(2, B2);
+    r_update.tag_vector_level(2, B2);
+    rr.tag_unroll_level(2);
+
+    // The three computations share the loops over the partitions and over the
+    // blocks of B2 elements: each block of x, p, r and Ap is read once
+    rr_init.after_low_level(rtrans_init, -1);
+    x_update.after_low_level(rr_init, -1);
+    r_update.after_low_level(x_update, 1);
+    rr.after_low_level(r_update, 1);
+    rr_global.after_low_level(rr, -1);
+
+    // ---------------------------------------------------------------------------------
+    // Layer III
+    // ---------------------------------------------------------------------------------
+    buffer b_SIZES("b_SIZES", {tiramisu::expr(1)}, p_int32, a_input, &cg_update);
+    buffer b_alpha("b_alpha", {tiramisu::expr(1)}, p_float64, a_input, &cg_update);
+    buffer b_x("b_x", {tiramisu::var("M")}, p_float64, a_output, &cg_update);
+    buffer b_p("b_p", {tiramisu::var("M")}, p_float64, a_input, &cg_update);
+    buffer b_r("b_r", {tiramisu::var("M")}, p_float64, a_output, &cg_update);
+    buffer b_Ap("b_Ap", {tiramisu::var("M")}, p_float64, a_input, &cg_update);
+    buffer b_rr("b_rr", {tiramisu::var("M")/tiramisu::expr((int) PARTITIONS)}, p_float64, a_temporary, &cg_update);
+    buffer b_rtrans("b_rtrans", {tiramisu::expr((int) 1)}, p_float64, a_output, &cg_update);
+
+    SIZES.set_access("{SIZES[0]->b_SIZES[0]}");
+    alpha.set_access("{alpha[0]->b_alpha[0]}");
+    x.set_access("{x[j]->b_x[j]}");
+    p.set_access("{p[j]->b_p[j]}");
+    r.set_access("{r[j]->b_r[j]}");
+    Ap.set_access("{Ap[j]->b_Ap[j]}");
+    x_update.set_access("{x_update[j]->b_x[j]}");
+    r_update.set_access("{r_update[j]->b_r[j]}");
+    rr_init.set_access("{rr_init[t]->b_rr[t]}");
+    rr.set_access("{rr[j]->b_rr[j/"+std::to_string(PARTITIONS)+"]}");
+    rtrans_init.set_access("{rtrans_init[0]->b_rtrans[0]}");
+    rr_global.set_access("{rr_global[j]->b_rtrans[0]}");
+
+    // ------------------------------------------------------------------
+    // Generate code
+    // ------------------------------------------------------------------
+    cg_update.set_arguments({&b_SIZES, &b_alpha, &b_x, &b_p, &b_r, &b_Ap, &b_rtrans});
+    cg_update.gen_time_space_domain();
+    cg_update.gen_isl_ast();
+    cg_update.gen_halide_stmt();
+    cg_update.gen_halide_obj("generated_cg_update.o");
+}
+
+/**
+ * The first half of an iteration of CG:
+ *     p = r + beta*p
+ *     Ap = A*p
+ *     alpha = p.Ap
+ * where the dot product is computed in the same loop as the spmv.
+ */
 int main(int argc, char **argv)
 {
     // Set default tiramisu options.
@@ -173,5 +276,7 @@ int main(int argc, char **argv)
     cg.gen_halide_stmt();
     cg.gen_halide_obj("generated_cg.o");
 
+    generate_cg_update();
+
     return 0;
 }
@@ -0,0 +1,326 @@
+#ifndef TIRAMISU_CHAIN_MM_H
+#define TIRAMISU_CHAIN_MM_H
+
+#include <tiramisu/tiramisu.h>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * Builder of the multiplication of a chain of matrices M0 x M1 x ... x Mn-1,
+ * where the matrix Mi has dims[i] rows and dims[i + 1] columns.
+ *
+ * The products are not done in the left-to-right order of the chain but in
+ * the order that needs the fewest floating point operations for the shapes
+ * of the matrices (the classic dynamic program on the sub-chains).  Each
+ * product P = L x R is computed by an initialization P(i, j) = 0 and a
+ * reduction P(i, j) += L(i, k) * R(k, j).
+ *
+ * The matrices of the chain are named A, B, C, ... and are the inputs
+ * b_A, b_B, b_C, ...; the result is the output b_O.
+ */
+namespace chain_mm
+{
+
+struct product
+{
+    // The matrices of the chain multiplied by this product
+    int first, last;
+    int rows, cols;
+
+    // The operands of the product, NULL for a matrix of the chain
+    product *left = NULL, *right = NULL;
+
+    // The matrix of the chain (if first == last)
+    tiramisu::input *matrix = NULL;
+
+    // The computations of the product (otherwise)
+    tiramisu::computation *init = NULL, *update = NULL;
+    tiramisu::buffer *buf = NULL;
+    std::string id;
+
+    bool is_product() const
+    {
+        return matrix == NULL;
+    }
+
+    tiramisu::expr value(tiramisu::expr r, tiramisu::expr c) const
+    {
+        if (matrix != NULL)
+            return (*matrix)(r, c);
+        return (*update)(r, c, 0);
+    }
+};
+
+class chain
+{
+    std::vector<int> dims;
+    tiramisu::primitive_t type;
+    bool gpu;
+
+    // split[i][j] = k if the product of the matrices i..j is (i..k) x (k+1..j)
+    std::vector<std::vector<int>> split;
+    std::vector<std::vector<double>> cost;
+
+    product *root = NULL;
+    std::vector<product *> products;
+    std::vector<tiramisu::buffer *> host_inputs;
+    tiramisu::buffer *host_output = NULL;
+    std::vector<tiramisu::computation *> copies_to_device;
+    tiramisu::computation *copy_to_host = NULL;
+
+    static std::string matrix_name(int m)
+    {
+        return std::string(1, 'A' + m);
+    }
+
+    void find_order()
+    {
+        int n = dims.size() - 1;
+        split.assign(n, std::vector<int>(n, 0));
+        cost.assign(n, std::vector<double>(n, 0));
+
+        for (int length = 2; length <= n; length++)
+            for (int i = 0; i + length - 1 < n; i++)
+            {
+                int j = i + length - 1;
+                cost[i][j] = std::numeric_limits<double>::max();
+                for (int k = i; k < j; k++)
+                {
+                    double c = cost[i][k] + cost[k + 1][j] + 2.0 * dims[i] * dims[k + 1] * dims[j + 1];
+                    if (c < cost[i][j])
+                    {
+                        cost[i][j] = c;
+                        split[i][j] = k;
+                    }
+                }
+            }
+    }
+
+    product *build(int first, int last)
+    {
+        product *p = new product();
+        p->first = first;
+        p->last = last;
+        p->rows = dims[first];
+        p->cols = dims[last + 1];
+        products.push_back(p);
+
+        if (first == last)
+        {
+            std::string name = matrix_name(first);
+            tiramisu::var i("i_" + name, 0, p->rows), j("j_" + name, 0, p->cols);
+            p->matrix = new tiramisu::input(name, {i, j}, type);
+
+            tiramisu::buffer *b = new tiramisu::buffer("b_" + name, {p->rows, p->cols}, type, tiramisu::a_input);
+            host_inputs.push_back(b);
+            if (gpu)
+            {
+                tiramisu::buffer *b_gpu = new tiramisu::buffer("b_" + name + "_gpu", {p->rows, p->cols},
+                                                               type, tiramisu::a_temporary);
+                b_gpu->tag_gpu_global();
+                copies_to_device.push_back(new tiramisu::computation({}, tiramisu::memcpy(*b, *b_gpu)));
+                p->matrix->store_in(b_gpu);
+            }
+            else
+            {
+                p->matrix->store_in(b);
+            }
+            return p;
+        }
+
+        int k = split[first][last];
+        p->left = build(first, k);
+        p->right = build(k + 1, last);
+
+        p->id = matrix_name(first) + matrix_name(last);
+        int inner = dims[k + 1];
+        tiramisu::var i("i_" + p->id, 0, p->rows), j("j_" + p->id, 0, p->cols), r("k_" + p->id, 0, inner);
+        p->init = new tiramisu::computation("init_" + p->id, {i, j}, tiramisu::cast(type, 0));
+        p->update = new tiramisu::computation("prod_" + p->id, {i, j, r}, type);
+        p->update->set_expression((*p->update)(i, j, r) + p->left->value(i, r) * p->right->value(r, j));
+
+        bool is_output = (first == 0) && (last == (int) dims.size() - 2);
+        std::string buffer_name = is_output ? "b_O" : "b_" + p->id;
+        if (is_output && gpu)
+        {
+            host_output = new tiramisu::buffer(buffer_name, {p->rows, p->cols}, type, tiramisu::a_output);
+            buffer_name += "_gpu";
+        }
+        p->buf = new tiramisu::buffer(buffer_name, {p->rows, p->cols}, type,
+                                      (is_output && !gpu) ? tiramisu::a_output : tiramisu::a_temporary);
+        if (gpu)
+            p->buf->tag_gpu_global();
+        if (is_output)
+        {
+            if (!gpu)
+                host_output = p->buf;
+            else
+                copy_to_host = new tiramisu::computation({}, tiramisu::memcpy(*p->buf, *host_output));
+        }
+        p->init->store_in(p->buf);
+        p->update->store_in(p->buf, {i, j});
+        return p;
+    }
+
+    tiramisu::var var_of(const product *p, const std::string &name) const
+    {
+        return tiramisu::var(name + "_" + p->id);
+    }
+
+    // The computations of the products of the subtree of p, in the order in
+    // which they are computed, with the level at which each one is fused with
+    // the previous one
+    void cpu_order(product *p, int block_rows, int cache_bytes,
+                   std::vector<std::pair<tiramisu::computation *, int>> &order)
+    {
+        if (!p->is_product())
+            return;
+
+        // The right operand is needed entirely by each block of rows of p
+        cpu_order(p->right, block_rows, cache_bytes, order);
+
+        // A block of rows of p only needs the same block of rows of its left
+        // operand: when that block stays in the cache, both are computed in
+        // the same loop over the blocks of rows
+        int64_t tile_bytes = (int64_t) block_rows * p->left->cols * tiramisu::halide_type_from_tiramisu_type(type).bytes();
+        bool fuse_left = p->left->is_product() && (tile_bytes <= cache_bytes);
+        cpu_order(p->left, block_rows, cache_bytes, order);
+
+        int level = (fuse_left ? 0 : tiramisu::computation::root_dimension);
+        order.push_back({p->init, level});
+        order.push_back({p->update, 1});
+    }
+
+public:
+    chain(const std::vector<int> &dims, tiramisu::primitive_t type, bool gpu)
+        : dims(dims), type(type), gpu(gpu)
+    {
+        find_order();
+        root = build(0, dims.size() - 2);
+    }
+
+    /**
+     * The number of floating point operations of the chosen order.
+     */
+    double flops() const
+    {
+        return cost[0][dims.size() - 2];
+    }
+
+    /**
+     * The chosen order, e.g. "((A x B) x C)".
+     */
+    std::string order() const
+    {
+        return order(root);
+    }
+
+    std::string order(const product *p) const
+    {
+        if (!p->is_product())
+            return matrix_name(p->first);
+        return "(" + order(p->left) + " x " + order(p->right) + ")";
+    }
+
+    /**
+     * The arguments of the generated function: the matrices of the chain
+     * then the result.
+     */
+    std::vector<tiramisu::buffer *> arguments() const
+    {
+        std::vector<tiramisu::buffer *> args = host_inputs;
+        args.push_back(host_output);
+        return args;
+    }
+
+    /**
+     * Schedule the products on the CPU.  The rows of each product are
+     * computed in parallel by blocks of \p block_rows rows, and the columns
+     * are vectorized by \p vector_length.  A product is computed in the same
+     * loop over the blocks of rows as the product that consumes it as its
+     * left operand when a block of \p block_rows of its rows takes at most
+     * \p cache_bytes, so that the block is still in the cache when it is
+     * read.
+     */
+    void schedule_cpu(int block_rows, int cache_bytes, int vector_length)
+    {
+        for (product *p : products)
+        {
+            if (!p->is_product())
+                continue;
+            tiramisu::var i = var_of(p, "i"), j = var_of(p, "j"), r = var_of(p, "k");
+            tiramisu::var i0 = var_of(p, "i0"), i1 = var_of(p, "i1");
+            p->update->interchange(j, r);
+            p->init->split(i, block_rows, i0, i1);
+            p->update->split(i, block_rows, i0, i1);
+            p->init->tag_parallel_level(0);
+            p->update->tag_parallel_level(0);
+            if (p->cols >= vector_length)
+            {
+                p->init->vectorize(j, vector_length);
+                p->update->vectorize(j, vector_length);
+            }
+        }
+
+        std::vector<std::pair<tiramisu::computation *, int>> sequence;
+        cpu_order(root, block_rows, cache_bytes, sequence);
+        for (size_t c = 1; c < sequence.size(); c++)
+            sequence[c - 1].first->then(*sequence[c].first, sequence[c].second);
+    }
+
+    /**
+     * Schedule the products on the GPU, with tiles of \p tile x \p tile
+     * threads.  The two operands of a product are independent when they are
+     * both products: they are computed on different streams, so that their
+     * kernels can overlap.
+     */
+    void schedule_gpu(int tile)
+    {
+        int next_stream = 1;
+        std::vector<std::pair<product *, int>> todo = {{root, next_stream}};
+        std::vector<product *> post_order;
+        while (!todo.empty())
+        {
+            product *p = todo.back().first;
+            int stream = todo.back().second;
+            todo.pop_back();
+            if (!p->is_product())
+                continue;
+
+            p->init->tag_gpu_stream(stream);
+            p->update->tag_gpu_stream(stream);
+            post_order.insert(post_order.begin(), p);
+
+            bool independent = p->left->is_product() && p->right->is_product();
+            todo.push_back({p->left, stream});
+            todo.push_back({p->right, independent ? ++next_stream : stream});
+        }
+
+        tiramisu::computation *last = NULL;
+        for (tiramisu::computation *copy : copies_to_device)
+        {
+            if (last != NULL)
+                last->then(*copy, tiramisu::computation::root);
+            last = copy;
+        }
+        for (product *p : post_order)
+        {
+            tiramisu::var i = var_of(p, "i"), j = var_of(p, "j");
+            tiramisu::var i0 = var_of(p, "i0"), j0 = var_of(p, "j0"), i1 = var_of(p, "i1"), j1 = var_of(p, "j1");
+            p->init->gpu_tile(i, j, tile, tile, i0, j0, i1, j1);
+            p->update->gpu_tile(i, j, tile, tile, i0, j0, i1, j1);
+
+            last->then(*p->init, tiramisu::computation::root);
+            p->init->then(*p->update, j1);
+            last = p->update;
+        }
+        last->then(*copy_to_host, tiramisu::computation::root);
+    }
+};
+
+}
+
+#endif
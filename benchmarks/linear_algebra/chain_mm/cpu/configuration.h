@@ -0,0 +1,19 @@
+#define DATA_TYPE float
+#define DATA_PTYPE p_float32
+
+// Dimensions of the chain A x B x C x D: A is S0 x S1, B is S1 x S2, C is S2 x S3
+// and D is S3 x S4.  The order of the products is chosen by the generator (see
+// ../chain_mm.h): with these shapes, ((A x (B x C)) x D) needs almost three times fewer
+// flops than the left-to-right order.
+#define S0 1024
+#define S1 64
+#define S2 1024
+#define S3 64
+#define S4 1024
+
+// Rows of the blocks computed by each thread
+#define BLOCK_ROWS 32
+// A product is fused with the product that consumes it as its left operand when
+// one of its blocks of rows fits in this many bytes (the L2 cache)
+#define CACHE_BYTES (256 * 1024)
+#define VECTOR_LENGTH 8
@@ -0,0 +1,35 @@
+#include <tiramisu/tiramisu.h>
+
+#include "configuration.h"
+#include "../chain_mm.h"
+
+using namespace tiramisu;
+
+int main(int argc, char **argv)
+{
+    tiramisu::init("chain_mm");
+
+    // -------------------------------------------------------
+    // Layer I
+    // -------------------------------------------------------
+
+    // The products, their order and their buffers
+    chain_mm::chain chain({S0, S1, S2, S3, S4}, DATA_PTYPE, false);
+
+    std::cout << "Order of the products: " << chain.order()
+              << " (" << chain.flops() << " flops)" << std::endl;
+
+    // -------------------------------------------------------
+    // Layer II
+    // -------------------------------------------------------
+
+    chain.schedule_cpu(BLOCK_ROWS, CACHE_BYTES, VECTOR_LENGTH);
+
+    // -------------------------------------------------------
+    // Code Generation
+    // -------------------------------------------------------
+
+    tiramisu::codegen(chain.arguments(), "fct.o");
+
+    return 0;
+}
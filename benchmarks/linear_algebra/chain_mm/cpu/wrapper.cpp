@@ -0,0 +1,69 @@
+#include "Halide.h"
+#include <tiramisu/utils.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "wrapper.h"
+#include "configuration.h"
+
+// Reference: the products in the left-to-right order of the chain
+static void reference_product(const Halide::Buffer<DATA_TYPE> &L, const Halide::Buffer<DATA_TYPE> &R,
+                              Halide::Buffer<DATA_TYPE> &P, int rows, int inner, int cols)
+{
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            // Note that indices are flipped (see tutorial 2)
+            P(j, i) = 0;
+    for (int i = 0; i < rows; i++)
+        for (int k = 0; k < inner; k++)
+            for (int j = 0; j < cols; j++)
+                P(j, i) += L(k, i) * R(j, k);
+}
+
+int main(int argc, char *argv[])
+{
+    int testN = 1;
+    bool check_correctness = false;
+    if (argc > 1) {
+        testN = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        check_correctness = atoi(argv[2]);
+    }
+
+    std::cout << std::endl << "----------" << std::endl;
+    std::cout << "Running chain MM benchmark: testN: " << testN
+              << ", check correctness: " << check_correctness
+              << ", size: (" << S0 << ", " << S1 << ", " << S2 << ", " << S3 << ", " << S4 << ")" << std::endl;
+
+    // Note that indices are flipped (see tutorial 2).  The values are 0 or 1,
+    // so that the results are exact whatever the order of the products.
+    Halide::Buffer<DATA_TYPE> A_buf(S1, S0), B_buf(S2, S1), C_buf(S3, S2), D_buf(S4, S3);
+    for (Halide::Buffer<DATA_TYPE> *b : {&A_buf, &B_buf, &C_buf, &D_buf})
+        b->for_each_value([](DATA_TYPE &v) { v = std::rand() % 2; });
+    Halide::Buffer<DATA_TYPE> O_buf(S4, S0);
+
+    if (check_correctness) {
+        Halide::Buffer<DATA_TYPE> AB(S2, S0), ABC(S3, S0), O_val_buf(S4, S0);
+        reference_product(A_buf, B_buf, AB, S0, S1, S2);
+        reference_product(AB, C_buf, ABC, S0, S2, S3);
+        reference_product(ABC, D_buf, O_val_buf, S0, S3, S4);
+
+        chain_mm(A_buf.raw_buffer(), B_buf.raw_buffer(), C_buf.raw_buffer(), D_buf.raw_buffer(), O_buf.raw_buffer());
+        compare_buffers("chain_mm", O_buf, O_val_buf);
+    }
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < testN; i++) {
+        chain_mm(A_buf.raw_buffer(), B_buf.raw_buffer(), C_buf.raw_buffer(), D_buf.raw_buffer(), O_buf.raw_buffer());
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    if (testN > 0)
+        std::cout << "chain_mm done: " << (std::chrono::duration<double,std::milli>(t2 - t1)).count() / testN << "ms" << std::endl;
+
+    std::cout << "----------" << std::endl << std::endl;
+
+    return 0;
+}
@@ -1,8 +1,12 @@
 #define DATA_TYPE float
 #define DATA_PTYPE p_float32
 
-// Dimensions:
+// Dimensions of the chain A x B x C: A is S0 x S1, B is S1 x S2 and C is S2 x S3.
+// The order of the products is chosen by the generator (see ../chain_mm.h).
 #define S0 1024
 #define S1 512
 #define S2 128
 #define S3 256
+
+// Size of the GPU tiles
+#define TILE 16
@@ -1,6 +1,7 @@
 #include <tiramisu/tiramisu.h>
 
 #include "configuration.h"
+#include "../chain_mm.h"
 
 using namespace tiramisu;
 
@@ -12,85 +13,25 @@ int main(int argc, char **argv)
     // Layer I
     // -------------------------------------------------------
 
-    // Declare loop iterators
-    var i("i", 0, S0), j("j", 0, S1), k("k", 0, S2), l("l", 0, S3);
-    var i0("i0"), k0("k0"), l0("l0"), i1("i1"), k1("k1"), l1("l1");
+    // The products, their order and their buffers (on the GPU)
+    chain_mm::chain chain({S0, S1, S2, S3}, DATA_PTYPE, true);
 
-    // declare cpu buffers.
-    buffer b_A("b_A", {S0, S1}, DATA_PTYPE, a_input);
-    buffer b_B("b_B", {S1, S2}, DATA_PTYPE, a_input);
-    buffer b_C("b_C", {S2, S3}, DATA_PTYPE, a_input);
-    buffer b_O("b_O", {S0, S3}, DATA_PTYPE, a_output);
-    // Declare gpu buffers.
-    buffer b_A_gpu("b_A_gpu", {S0, S1}, DATA_PTYPE, a_temporary);
-    buffer b_B_gpu("b_B_gpu", {S1, S2}, DATA_PTYPE, a_temporary);
-    buffer b_C_gpu("b_C_gpu", {S2, S3}, DATA_PTYPE, a_temporary);
-    buffer b_O_gpu("b_O_gpu", {S0, S3}, DATA_PTYPE, a_temporary);
-    // Temporary buffer to store AxB
-    buffer b_T1_gpu("b_T1_gpu", {S0, S2}, DATA_PTYPE, a_temporary);
-    b_A_gpu.tag_gpu_global();
-    b_B_gpu.tag_gpu_global();
-    b_C_gpu.tag_gpu_global();
-    b_T1_gpu.tag_gpu_global();
-    b_O_gpu.tag_gpu_global();
-
-    // Declare wrappers
-    input c_A({i, j}, DATA_PTYPE);
-    input c_B({i, j}, DATA_PTYPE);
-    input c_C({i, j}, DATA_PTYPE);
-
-    computation c_T1_init({i, k}, (DATA_TYPE) 0);
-    computation c_T1({i, j, k}, DATA_PTYPE);
-    c_T1.set_expression(c_T1(i, j, k) + c_A(i, j) * c_B(j, k));
-    // Declare wrapper for the output buffer
-    computation c_O_init({i, l}, (DATA_TYPE) 0);
-    computation c_O({i, k, l}, DATA_PTYPE);
-    c_O.set_expression(c_O(i, k, l) + c_T1(i, 0, k) * c_C(k, l));
-    // Declare host-gpu transfer computations.
-    computation copy_A_to_device({}, memcpy(b_A, b_A_gpu));
-    computation copy_B_to_device({}, memcpy(b_B, b_B_gpu));
-    computation copy_C_to_device({}, memcpy(b_C, b_C_gpu));
-    computation copy_O_to_host({}, memcpy(b_O_gpu, b_O));
+    std::cout << "Order of the products: " << chain.order()
+              << " (" << chain.flops() << " flops)" << std::endl;
 
     // -------------------------------------------------------
     // Layer II
     // -------------------------------------------------------
 
-    c_T1.interchange(j, k);
-    c_T1_init.gpu_tile(i, k, 16, 16, i0, k0, i1, k1);
-    c_T1.gpu_tile(i, k, 16, 16, i0, k0, i1, k1);
-    c_O.interchange(k, l);
-    c_O_init.gpu_tile(i, l, 16, 16, i0, l0, i1, l1);
-    c_O.gpu_tile(i, l, 16, 16, i0, l0, i1, l1);
-
-    // Scheduling commands
-
-    copy_A_to_device.then(copy_B_to_device, computation::root)
-                    .then(copy_C_to_device, computation::root)
-                    .then(c_T1_init, computation::root)
-                    .then(c_T1, k1)
-                    .then(c_O_init, computation::root)
-                    .then(c_O, l1)
-                    .then(copy_O_to_host, computation::root);
-
-    // -------------------------------------------------------
-    // Layer III
-    // -------------------------------------------------------
-
-    c_A.store_in(&b_A_gpu);
-    c_B.store_in(&b_B_gpu);
-    c_C.store_in(&b_C_gpu);
-    c_T1_init.store_in(&b_T1_gpu);
-    c_T1.store_in(&b_T1_gpu, {i, k});
-    c_O_init.store_in(&b_O_gpu);
-    c_O.store_in(&b_O_gpu, {i, l});
+    // Each product is a kernel, the independent products run on different streams
+    chain.schedule_gpu(TILE);
 
     // -------------------------------------------------------
     // Code Generation
     // -------------------------------------------------------
 
     // Generate object files. Last argument triggers cuda compilation.
-    tiramisu::codegen({&b_A, &b_B, &b_C, &b_O}, "fct.o", true);
-    
+    tiramisu::codegen(chain.arguments(), "fct.o", true);
+
     return 0;
 }
@@ -0,0 +1,152 @@
+#ifndef __POLYBENCH_CONF_HEADER_
+#define __POLYBENCH_CONF_HEADER_
+
+// Sizes of the kernels : the MEDIUM dataset of PolyBench/C 4.2 by default,
+// the LARGE dataset if POLYBENCH_LARGE_DATASET is defined.
+#ifndef POLYBENCH_LARGE_DATASET
+
+#define GEMM_NI 200
+#define GEMM_NJ 220
+#define GEMM_NK 240
+
+#define GEMVER_N 400
+
+#define GESUMMV_N 250
+
+#define SYR2K_M 200
+#define SYR2K_N 240
+
+#define SYRK_M 200
+#define SYRK_N 240
+
+#define TRMM_M 200
+#define TRMM_N 240
+
+#define K2MM_NI 180
+#define K2MM_NJ 190
+#define K2MM_NK 210
+#define K2MM_NL 220
+
+#define K3MM_NI 180
+#define K3MM_NJ 190
+#define K3MM_NK 200
+#define K3MM_NL 210
+#define K3MM_NM 220
+
+#define ATAX_M 390
+#define ATAX_N 410
+
+#define BICG_M 390
+#define BICG_N 410
+
+#define DOITGEN_NQ 40
+#define DOITGEN_NR 50
+#define DOITGEN_NP 60
+
+#define MVT_N 400
+
+#define CHOLESKY_N 400
+
+#define LU_N 400
+
+#define TRISOLV_N 400
+
+#define COVARIANCE_M 240
+#define COVARIANCE_N 260
+
+#define FLOYD_WARSHALL_N 500
+
+#define FDTD_2D_TMAX 100
+#define FDTD_2D_NX 200
+#define FDTD_2D_NY 240
+
+#define HEAT_3D_TSTEPS 100
+#define HEAT_3D_N 40
+
+#define JACOBI_1D_TSTEPS 100
+#define JACOBI_1D_N 400
+
+#define JACOBI_2D_TSTEPS 100
+#define JACOBI_2D_N 250
+
+#define SEIDEL_2D_TSTEPS 100
+#define SEIDEL_2D_N 400
+
+#else
+
+#define GEMM_NI 1000
+#define GEMM_NJ 1100
+#define GEMM_NK 1200
+
+#define GEMVER_N 2000
+
+#define GESUMMV_N 1300
+
+#define SYR2K_M 1000
+#define SYR2K_N 1200
+
+#define SYRK_M 1000
+#define SYRK_N 1200
+
+#define TRMM_M 1000
+#define TRMM_N 1200
+
+#define K2MM_NI 800
+#define K2MM_NJ 900
+#define K2MM_NK 1100
+#define K2MM_NL 1200
+
+#define K3MM_NI 800
+#define K3MM_NJ 900
+#define K3MM_NK 1000
+#define K3MM_NL 1100
+#define K3MM_NM 1200
+
+#define ATAX_M 1900
+#define ATAX_N 2100
+
+#define BICG_M 1900
+#define BICG_N 2100
+
+#define DOITGEN_NQ 140
+#define DOITGEN_NR 150
+#define DOITGEN_NP 160
+
+#define MVT_N 2000
+
+#define CHOLESKY_N 2000
+
+#define LU_N 2000
+
+#define TRISOLV_N 2000
+
+#define COVARIANCE_M 1200
+#define COVARIANCE_N 1400
+
+#define FLOYD_WARSHALL_N 2800
+
+#define FDTD_2D_TMAX 500
+#define FDTD_2D_NX 1000
+#define FDTD_2D_NY 1200
+
+#define HEAT_3D_TSTEPS 500
+#define HEAT_3D_N 120
+
+#define JACOBI_1D_TSTEPS 500
+#define JACOBI_1D_N 2000
+
+#define JACOBI_2D_TSTEPS 500
+#define JACOBI_2D_N 1300
+
+#define SEIDEL_2D_TSTEPS 500
+#define SEIDEL_2D_N 2000
+
+#endif
+
+// The scalars of the kernels, as initialized by PolyBench.
+#define POLYBENCH_ALPHA 1.5
+#define POLYBENCH_BETA 1.2
+
+#define NB_TESTS 10
+
+#endif
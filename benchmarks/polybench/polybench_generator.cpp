@@ -0,0 +1,992 @@
+#include <tiramisu/tiramisu.h>
+#include <tiramisu/auto_scheduler/evaluator.h>
+#include <tiramisu/auto_scheduler/search_method.h>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include "configure.h"
+
+using namespace tiramisu;
+
+// Generates the Tiramisu version of a PolyBench kernel.
+//
+// usage : ./polybench_generator KERNEL VARIANT
+//
+// The computations of a kernel are declared and ordered as the loops of PolyBench/C.
+// The in-place updates read the arrays through inputs stored in the same buffers
+// as the computations that update them. VARIANT is :
+//  - hand : the schedule written below for the kernel is applied,
+//  - auto : the schedule is found by the beam search of the auto-scheduler, whose
+//    schedules are measured by JIT compilation. BEAM_SIZE and MAX_DEPTH set the size
+//    of the search, and POLYBENCH_SEARCH_TIME bounds its duration in seconds.
+//    The schedule found is saved in polybench_KERNEL_auto.sched, and applied again
+//    instead of searching if POLYBENCH_REUSE_SCHEDULES is set.
+//
+// The function polybench_KERNEL_VARIANT is generated in generated_polybench_KERNEL_VARIANT.o,
+// its arguments are the arrays of the kernel of polybench_reference.c, in the same order.
+
+static bool hand_schedule;
+
+static void autoschedule(std::vector<buffer*> const& arguments, std::string const& function_name)
+{
+    std::string schedule_file = function_name + ".sched";
+    if (getenv("POLYBENCH_REUSE_SCHEDULES") != nullptr && std::ifstream(schedule_file).good())
+    {
+        global::get_implicit_function()->apply_schedule_file(schedule_file);
+        return;
+    }
+
+    prepare_schedules_for_legality_checks();
+    perform_full_dependency_analysis();
+
+    int beam_size = (getenv("BEAM_SIZE") != nullptr) ? atoi(getenv("BEAM_SIZE")) : 4;
+    int max_depth = (getenv("MAX_DEPTH") != nullptr) ? atoi(getenv("MAX_DEPTH")) : 6;
+
+    auto_scheduler::evaluate_by_jit *exec_eval = new auto_scheduler::evaluate_by_jit(arguments);
+    auto_scheduler::schedules_generator *scheds_gen = new auto_scheduler::ml_model_schedules_generator();
+    auto_scheduler::search_method *bs = new auto_scheduler::beam_search(beam_size, max_depth, exec_eval, scheds_gen);
+    auto_scheduler::auto_scheduler as(bs, exec_eval);
+    as.set_exec_evaluator(exec_eval);
+    if (getenv("POLYBENCH_SEARCH_TIME") != nullptr)
+        as.set_budget(atof(getenv("POLYBENCH_SEARCH_TIME")));
+
+    as.find_schedule();
+    as.apply_best_schedule();
+    global::get_implicit_function()->save_schedule_file(schedule_file);
+
+    delete bs;
+    delete scheds_gen;
+    delete exec_eval;
+}
+
+static void generate(std::vector<buffer*> const& arguments)
+{
+    std::string function_name = global::get_implicit_function()->get_name();
+    if (!hand_schedule)
+        autoschedule(arguments, function_name);
+
+    tiramisu::codegen(arguments, "generated_" + function_name + ".o");
+}
+
+// -------------------------------------------------------
+// Linear algebra : BLAS
+// -------------------------------------------------------
+
+static void gemm()
+{
+    var i("i", 0, GEMM_NI), j("j", 0, GEMM_NJ), k("k", 0, GEMM_NK);
+    var k0("k0"), j0("j0"), k1("k1"), j1("j1");
+
+    input A("A", {i, k}, p_float64);
+    input B("B", {k, j}, p_float64);
+    input C("C", {i, j}, p_float64);
+
+    computation C_scale("C_scale", {i, j}, C(i, j) * POLYBENCH_BETA);
+    computation C_update("C_update", {i, k, j}, p_float64);
+    C_update.set_expression(C_update(i, k, j) + expr(POLYBENCH_ALPHA) * A(i, k) * B(k, j));
+
+    C_scale.then(C_update, i);
+
+    if (hand_schedule)
+    {
+        C_scale.parallelize(i);
+        C_update.parallelize(i);
+        C_scale.vectorize(j, 8);
+        C_update.tile(k, j, 32, 64, k0, j0, k1, j1);
+        C_update.vectorize(j1, 8);
+    }
+
+    buffer b_C("b_C", {GEMM_NI, GEMM_NJ}, p_float64, a_output);
+    buffer b_A("b_A", {GEMM_NI, GEMM_NK}, p_float64, a_input);
+    buffer b_B("b_B", {GEMM_NK, GEMM_NJ}, p_float64, a_input);
+
+    A.store_in(&b_A);
+    B.store_in(&b_B);
+    C.store_in(&b_C);
+    C_scale.store_in(&b_C);
+    C_update.store_in(&b_C, {i, j});
+
+    generate({&b_C, &b_A, &b_B});
+}
+
+static void gemver()
+{
+    var i("i", 0, GEMVER_N), j("j", 0, GEMVER_N);
+
+    input A("A", {i, j}, p_float64);
+    input u1("u1", {i}, p_float64), v1("v1", {i}, p_float64);
+    input u2("u2", {i}, p_float64), v2("v2", {i}, p_float64);
+    input x("x", {i}, p_float64), y("y", {i}, p_float64), z("z", {i}, p_float64);
+
+    computation A_update("A_update", {i, j}, A(i, j) + u1(i) * v1(j) + u2(i) * v2(j));
+    computation x_update("x_update", {i, j}, p_float64);
+    x_update.set_expression(x_update(i, j) + expr(POLYBENCH_BETA) * A(j, i) * y(j));
+    computation x_add("x_add", {i}, x(i) + z(i));
+    computation w_update("w_update", {i, j}, p_float64);
+    w_update.set_expression(w_update(i, j) + expr(POLYBENCH_ALPHA) * A(i, j) * x(j));
+
+    A_update.then(x_update, computation::root)
+            .then(x_add, computation::root)
+            .then(w_update, computation::root);
+
+    if (hand_schedule)
+    {
+        A_update.parallelize(i);
+        A_update.vectorize(j, 8);
+        x_update.interchange(i, j);
+        x_update.vectorize(i, 8);
+        x_add.vectorize(i, 8);
+        w_update.parallelize(i);
+    }
+
+    buffer b_A("b_A", {GEMVER_N, GEMVER_N}, p_float64, a_output);
+    buffer b_u1("b_u1", {GEMVER_N}, p_float64, a_input);
+    buffer b_v1("b_v1", {GEMVER_N}, p_float64, a_input);
+    buffer b_u2("b_u2", {GEMVER_N}, p_float64, a_input);
+    buffer b_v2("b_v2", {GEMVER_N}, p_float64, a_input);
+    buffer b_w("b_w", {GEMVER_N}, p_float64, a_output);
+    buffer b_x("b_x", {GEMVER_N}, p_float64, a_output);
+    buffer b_y("b_y", {GEMVER_N}, p_float64, a_input);
+    buffer b_z("b_z", {GEMVER_N}, p_float64, a_input);
+
+    A.store_in(&b_A);
+    u1.store_in(&b_u1);
+    v1.store_in(&b_v1);
+    u2.store_in(&b_u2);
+    v2.store_in(&b_v2);
+    x.store_in(&b_x);
+    y.store_in(&b_y);
+    z.store_in(&b_z);
+    A_update.store_in(&b_A);
+    x_update.store_in(&b_x, {i});
+    x_add.store_in(&b_x);
+    w_update.store_in(&b_w, {i});
+
+    generate({&b_A, &b_u1, &b_v1, &b_u2, &b_v2, &b_w, &b_x, &b_y, &b_z});
+}
+
+static void gesummv()
+{
+    var i("i", 0, GESUMMV_N), j("j", 0, GESUMMV_N);
+
+    input A("A", {i, j}, p_float64), B("B", {i, j}, p_float64);
+    input x("x", {i}, p_float64), tmp("tmp", {i}, p_float64), y("y", {i}, p_float64);
+
+    computation tmp_init("tmp_init", {i}, expr(0.0));
+    computation y_init("y_init", {i}, expr(0.0));
+    computation tmp_update("tmp_update", {i, j}, p_float64);
+    tmp_update.set_expression(A(i, j) * x(j) + tmp_update(i, j));
+    computation y_update("y_update", {i, j}, p_float64);
+    y_update.set_expression(B(i, j) * x(j) + y_update(i, j));
+    computation y_result("y_result", {i}, expr(POLYBENCH_ALPHA) * tmp(i) + expr(POLYBENCH_BETA) * y(i));
+
+    tmp_init.then(y_init, i)
+            .then(tmp_update, i)
+            .then(y_update, j)
+            .then(y_result, i);
+
+    if (hand_schedule)
+    {
+        tmp_init.parallelize(i);
+        y_init.parallelize(i);
+        tmp_update.parallelize(i);
+        y_update.parallelize(i);
+        y_result.parallelize(i);
+    }
+
+    buffer b_A("b_A", {GESUMMV_N, GESUMMV_N}, p_float64, a_input);
+    buffer b_B("b_B", {GESUMMV_N, GESUMMV_N}, p_float64, a_input);
+    buffer b_tmp("b_tmp", {GESUMMV_N}, p_float64, a_output);
+    buffer b_x("b_x", {GESUMMV_N}, p_float64, a_input);
+    buffer b_y("b_y", {GESUMMV_N}, p_float64, a_output);
+
+    A.store_in(&b_A);
+    B.store_in(&b_B);
+    x.store_in(&b_x);
+    tmp.store_in(&b_tmp);
+    y.store_in(&b_y);
+    tmp_init.store_in(&b_tmp);
+    y_init.store_in(&b_y);
+    tmp_update.store_in(&b_tmp, {i});
+    y_update.store_in(&b_y, {i});
+    y_result.store_in(&b_y);
+
+    generate({&b_A, &b_B, &b_tmp, &b_x, &b_y});
+}
+
+static void syr2k()
+{
+    var i("i", 0, SYR2K_N), j("j", 0, SYR2K_N), k("k", 0, SYR2K_M);
+
+    input A("A", {i, k}, p_float64), B("B", {i, k}, p_float64), C("C", {i, j}, p_float64);
+
+    computation C_scale("C_scale", {i, j}, j <= i, C(i, j) * POLYBENCH_BETA);
+    computation C_update("C_update", {i, k, j}, j <= i, expr(p_float64));
+    C_update.set_expression(C_update(i, k, j) + (A(j, k) * POLYBENCH_ALPHA * B(i, k) + B(j, k) * POLYBENCH_ALPHA * A(i, k)));
+
+    C_scale.then(C_update, i);
+
+    if (hand_schedule)
+    {
+        C_scale.parallelize(i);
+        C_update.parallelize(i);
+    }
+
+    buffer b_C("b_C", {SYR2K_N, SYR2K_N}, p_float64, a_output);
+    buffer b_A("b_A", {SYR2K_N, SYR2K_M}, p_float64, a_input);
+    buffer b_B("b_B", {SYR2K_N, SYR2K_M}, p_float64, a_input);
+
+    A.store_in(&b_A);
+    B.store_in(&b_B);
+    C.store_in(&b_C);
+    C_scale.store_in(&b_C);
+    C_update.store_in(&b_C, {i, j});
+
+    generate({&b_C, &b_A, &b_B});
+}
+
+static void syrk()
+{
+    var i("i", 0, SYRK_N), j("j", 0, SYRK_N), k("k", 0, SYRK_M);
+
+    input A("A", {i, k}, p_float64), C("C", {i, j}, p_float64);
+
+    computation C_scale("C_scale", {i, j}, j <= i, C(i, j) * POLYBENCH_BETA);
+    computation C_update("C_update", {i, k, j}, j <= i, expr(p_float64));
+    C_update.set_expression(C_update(i, k, j) + expr(POLYBENCH_ALPHA) * A(i, k) * A(j, k));
+
+    C_scale.then(C_update, i);
+
+    if (hand_schedule)
+    {
+        C_scale.parallelize(i);
+        C_update.parallelize(i);
+    }
+
+    buffer b_C("b_C", {SYRK_N, SYRK_N}, p_float64, a_output);
+    buffer b_A("b_A", {SYRK_N, SYRK_M}, p_float64, a_input);
+
+    A.store_in(&b_A);
+    C.store_in(&b_C);
+    C_scale.store_in(&b_C);
+    C_update.store_in(&b_C, {i, j});
+
+    generate({&b_C, &b_A});
+}
+
+static void trmm()
+{
+    var i("i", 0, TRMM_M), j("j", 0, TRMM_N), k("k", 0, TRMM_M);
+
+    input A("A", {i, k}, p_float64), B("B", {i, j}, p_float64);
+
+    computation B_update("B_update", {i, j, k}, k > i, expr(p_float64));
+    B_update.set_expression(B_update(i, j, k) + A(k, i) * B(k, j));
+    computation B_scale("B_scale", {i, j}, expr(POLYBENCH_ALPHA) * B(i, j));
+
+    B_update.then(B_scale, j);
+
+    // The columns of B are independent
+    if (hand_schedule)
+    {
+        B_update.parallelize(j);
+        B_scale.parallelize(j);
+    }
+
+    buffer b_A("b_A", {TRMM_M, TRMM_M}, p_float64, a_input);
+    buffer b_B("b_B", {TRMM_M, TRMM_N}, p_float64, a_output);
+
+    A.store_in(&b_A);
+    B.store_in(&b_B);
+    B_update.store_in(&b_B, {i, j});
+    B_scale.store_in(&b_B);
+
+    generate({&b_A, &b_B});
+}
+
+// -------------------------------------------------------
+// Linear algebra : kernels
+// -------------------------------------------------------
+
+static void k2mm()
+{
+    var i("i", 0, K2MM_NI), j("j", 0, K2MM_NJ), k("k", 0, K2MM_NK), l("l", 0, K2MM_NL), m("m", 0, K2MM_NJ);
+
+    input A("A", {i, k}, p_float64), B("B", {k, j}, p_float64), C("C", {m, l}, p_float64);
+    input tmp("tmp", {i, j}, p_float64), D("D", {i, l}, p_float64);
+
+    computation tmp_init("tmp_init", {i, j}, expr(0.0));
+    computation tmp_update("tmp_update", {i, j, k}, p_float64);
+    tmp_update.set_expression(tmp_update(i, j, k) + expr(POLYBENCH_ALPHA) * A(i, k) * B(k, j));
+    computation D_scale("D_scale", {i, l}, D(i, l) * POLYBENCH_BETA);
+    computation D_update("D_update", {i, l, m}, p_float64);
+    D_update.set_expression(D_update(i, l, m) + tmp(i, m) * C(m, l));
+
+    if (hand_schedule)
+    {
+        // Rows are initialized before their reductions, so that the reductions are
+        // interchanged and vectorized along the rows of B and C
+        tmp_init.then(tmp_update, i)
+                .then(D_scale, computation::root)
+                .then(D_update, i);
+
+        tmp_update.interchange(j, k);
+        D_update.interchange(l, m);
+
+        tmp_init.parallelize(i);
+        tmp_update.parallelize(i);
+        D_scale.parallelize(i);
+        D_update.parallelize(i);
+        tmp_update.vectorize(j, 8);
+        D_update.vectorize(l, 8);
+    }
+    else
+        tmp_init.then(tmp_update, j)
+                .then(D_scale, computation::root)
+                .then(D_update, l);
+
+    buffer b_tmp("b_tmp", {K2MM_NI, K2MM_NJ}, p_float64, a_output);
+    buffer b_A("b_A", {K2MM_NI, K2MM_NK}, p_float64, a_input);
+    buffer b_B("b_B", {K2MM_NK, K2MM_NJ}, p_float64, a_input);
+    buffer b_C("b_C", {K2MM_NJ, K2MM_NL}, p_float64, a_input);
+    buffer b_D("b_D", {K2MM_NI, K2MM_NL}, p_float64, a_output);
+
+    A.store_in(&b_A);
+    B.store_in(&b_B);
+    C.store_in(&b_C);
+    tmp.store_in(&b_tmp);
+    D.store_in(&b_D);
+    tmp_init.store_in(&b_tmp);
+    tmp_update.store_in(&b_tmp, {i, j});
+    D_scale.store_in(&b_D);
+    D_update.store_in(&b_D, {i, l});
+
+    generate({&b_tmp, &b_A, &b_B, &b_C, &b_D});
+}
+
+static void k3mm()
+{
+    var i("i", 0, K3MM_NI), j("j", 0, K3MM_NJ), k("k", 0, K3MM_NK), l("l", 0, K3MM_NL), m("m", 0, K3MM_NM);
+
+    input A("A", {i, k}, p_float64), B("B", {k, j}, p_float64);
+    input C("C", {j, m}, p_float64), D("D", {m, l}, p_float64);
+    input E("E", {i, j}, p_float64), F("F", {j, l}, p_float64);
+
+    computation E_init("E_init", {i, j}, expr(0.0));
+    computation E_update("E_update", {i, j, k}, p_float64);
+    E_update.set_expression(E_update(i, j, k) + A(i, k) * B(k, j));
+    computation F_init("F_init", {j, l}, expr(0.0));
+    computation F_update("F_update", {j, l, m}, p_float64);
+    F_update.set_expression(F_update(j, l, m) + C(j, m) * D(m, l));
+    computation G_init("G_init", {i, l}, expr(0.0));
+    computation G_update("G_update", {i, l, j}, p_float64);
+    G_update.set_expression(G_update(i, l, j) + E(i, j) * F(j, l));
+
+    if (hand_schedule)
+    {
+        E_init.then(E_update, i)
+              .then(F_init, computation::root)
+              .then(F_update, j)
+              .then(G_init, computation::root)
+              .then(G_update, i);
+
+        E_update.interchange(j, k);
+        F_update.interchange(l, m);
+        G_update.interchange(l, j);
+
+        E_init.parallelize(i);
+        E_update.parallelize(i);
+        F_init.parallelize(j);
+        F_update.parallelize(j);
+        G_init.parallelize(i);
+        G_update.parallelize(i);
+        E_update.vectorize(j, 8);
+        F_update.vectorize(l, 8);
+        G_update.vectorize(l, 8);
+    }
+    else
+        E_init.then(E_update, j)
+              .then(F_init, computation::root)
+              .then(F_update, l)
+              .then(G_init, computation::root)
+              .then(G_update, l);
+
+    buffer b_E("b_E", {K3MM_NI, K3MM_NJ}, p_float64, a_output);
+    buffer b_A("b_A", {K3MM_NI, K3MM_NK}, p_float64, a_input);
+    buffer b_B("b_B", {K3MM_NK, K3MM_NJ}, p_float64, a_input);
+    buffer b_F("b_F", {K3MM_NJ, K3MM_NL}, p_float64, a_output);
+    buffer b_C("b_C", {K3MM_NJ, K3MM_NM}, p_float64, a_input);
+    buffer b_D("b_D", {K3MM_NM, K3MM_NL}, p_float64, a_input);
+    buffer b_G("b_G", {K3MM_NI, K3MM_NL}, p_float64, a_output);
+
+    A.store_in(&b_A);
+    B.store_in(&b_B);
+    C.store_in(&b_C);
+    D.store_in(&b_D);
+    E.store_in(&b_E);
+    F.store_in(&b_F);
+    E_init.store_in(&b_E);
+    E_update.store_in(&b_E, {i, j});
+    F_init.store_in(&b_F);
+    F_update.store_in(&b_F, {j, l});
+    G_init.store_in(&b_G);
+    G_update.store_in(&b_G, {i, l});
+
+    generate({&b_E, &b_A, &b_B, &b_F, &b_C, &b_D, &b_G});
+}
+
+static void atax()
+{
+    var i("i", 0, ATAX_M), j("j", 0, ATAX_N);
+
+    input A("A", {i, j}, p_float64), x("x", {j}, p_float64), tmp("tmp", {i}, p_float64);
+
+    computation y_init("y_init", {j}, expr(0.0));
+    computation tmp_init("tmp_init", {i}, expr(0.0));
+    computation tmp_update("tmp_update", {i, j}, p_float64);
+    tmp_update.set_expression(tmp_update(i, j) + A(i, j) * x(j));
+    computation y_update("y_update", {i, j}, p_float64);
+    y_update.set_expression(y_update(i, j) + A(i, j) * tmp(i));
+
+    if (hand_schedule)
+    {
+        // tmp is computed first, in parallel over its elements, and the
+        // reduction of y is interchanged to be parallel over the elements of y
+        y_init.then(tmp_init, computation::root)
+              .then(tmp_update, i)
+              .then(y_update, computation::root);
+
+        y_update.interchange(i, j);
+
+        tmp_init.parallelize(i);
+        tmp_update.parallelize(i);
+        y_update.parallelize(j);
+    }
+    else
+        y_init.then(tmp_init, computation::root)
+              .then(tmp_update, i)
+              .then(y_update, i);
+
+    buffer b_A("b_A", {ATAX_M, ATAX_N}, p_float64, a_input);
+    buffer b_x("b_x", {ATAX_N}, p_float64, a_input);
+    buffer b_y("b_y", {ATAX_N}, p_float64, a_output);
+    buffer b_tmp("b_tmp", {ATAX_M}, p_float64, a_output);
+
+    A.store_in(&b_A);
+    x.store_in(&b_x);
+    tmp.store_in(&b_tmp);
+    y_init.store_in(&b_y);
+    tmp_init.store_in(&b_tmp);
+    tmp_update.store_in(&b_tmp, {i});
+    y_update.store_in(&b_y, {j});
+
+    generate({&b_A, &b_x, &b_y, &b_tmp});
+}
+
+static void bicg()
+{
+    var i("i", 0, BICG_N), j("j", 0, BICG_M);
+
+    input A("A", {i, j}, p_float64), p("p", {j}, p_float64), r("r", {i}, p_float64);
+
+    computation s_init("s_init", {j}, expr(0.0));
+    computation q_init("q_init", {i}, expr(0.0));
+    computation s_update("s_update", {i, j}, p_float64);
+    s_update.set_expression(s_update(i, j) + r(i) * A(i, j));
+    computation q_update("q_update", {i, j}, p_float64);
+    q_update.set_expression(q_update(i, j) + A(i, j) * p(j));
+
+    if (hand_schedule)
+    {
+        // The two reductions are distributed, and the reduction of s is
+        // interchanged to be parallel over the elements of s
+        s_init.then(q_init, computation::root)
+              .then(q_update, i)
+              .then(s_update, computation::root);
+
+        s_update.interchange(i, j);
+
+        q_init.parallelize(i);
+        q_update.parallelize(i);
+        s_update.parallelize(j);
+    }
+    else
+        s_init.then(q_init, computation::root)
+              .then(s_update, i)
+              .then(q_update, j);
+
+    buffer b_A("b_A", {BICG_N, BICG_M}, p_float64, a_input);
+    buffer b_s("b_s", {BICG_M}, p_float64, a_output);
+    buffer b_q("b_q", {BICG_N}, p_float64, a_output);
+    buffer b_p("b_p", {BICG_M}, p_float64, a_input);
+    buffer b_r("b_r", {BICG_N}, p_float64, a_input);
+
+    A.store_in(&b_A);
+    p.store_in(&b_p);
+    r.store_in(&b_r);
+    s_init.store_in(&b_s);
+    q_init.store_in(&b_q);
+    s_update.store_in(&b_s, {j});
+    q_update.store_in(&b_q, {i});
+
+    generate({&b_A, &b_s, &b_q, &b_p, &b_r});
+}
+
+static void doitgen()
+{
+    var r("r", 0, DOITGEN_NR), q("q", 0, DOITGEN_NQ), p("p", 0, DOITGEN_NP), s("s", 0, DOITGEN_NP);
+
+    input A("A", {r, q, p}, p_float64), C4("C4", {s, p}, p_float64), sum("sum", {r, q, p}, p_float64);
+
+    computation sum_init("sum_init", {r, q, p}, expr(0.0));
+    computation sum_update("sum_update", {r, q, p, s}, p_float64);
+    sum_update.set_expression(sum_update(r, q, p, s) + A(r, q, s) * C4(s, p));
+    computation A_copy("A_copy", {r, q, p}, sum(r, q, p));
+
+    sum_init.then(sum_update, p)
+            .then(A_copy, q);
+
+    if (hand_schedule)
+    {
+        sum_init.parallelize(r);
+        sum_update.parallelize(r);
+        A_copy.parallelize(r);
+    }
+
+    // sum has an element per iteration of r and q (it has a single row in
+    // PolyBench), so that the iterations of r are independent
+    buffer b_A("b_A", {DOITGEN_NR, DOITGEN_NQ, DOITGEN_NP}, p_float64, a_output);
+    buffer b_C4("b_C4", {DOITGEN_NP, DOITGEN_NP}, p_float64, a_input);
+    buffer b_sum("b_sum", {DOITGEN_NR, DOITGEN_NQ, DOITGEN_NP}, p_float64, a_temporary);
+
+    A.store_in(&b_A);
+    C4.store_in(&b_C4);
+    sum.store_in(&b_sum);
+    sum_init.store_in(&b_sum);
+    sum_update.store_in(&b_sum, {r, q, p});
+    A_copy.store_in(&b_A);
+
+    generate({&b_A, &b_C4});
+}
+
+static void mvt()
+{
+    var i("i", 0, MVT_N), j("j", 0, MVT_N);
+
+    input A("A", {i, j}, p_float64), y1("y1", {j}, p_float64), y2("y2", {j}, p_float64);
+
+    computation x1_update("x1_update", {i, j}, p_float64);
+    x1_update.set_expression(x1_update(i, j) + A(i, j) * y1(j));
+    computation x2_update("x2_update", {i, j}, p_float64);
+    x2_update.set_expression(x2_update(i, j) + A(j, i) * y2(j));
+
+    x1_update.then(x2_update, computation::root);
+
+    if (hand_schedule)
+    {
+        x1_update.parallelize(i);
+        x2_update.interchange(i, j);
+        x2_update.vectorize(i, 8);
+    }
+
+    buffer b_x1("b_x1", {MVT_N}, p_float64, a_output);
+    buffer b_x2("b_x2", {MVT_N}, p_float64, a_output);
+    buffer b_y1("b_y1", {MVT_N}, p_float64, a_input);
+    buffer b_y2("b_y2", {MVT_N}, p_float64, a_input);
+    buffer b_A("b_A", {MVT_N, MVT_N}, p_float64, a_input);
+
+    A.store_in(&b_A);
+    y1.store_in(&b_y1);
+    y2.store_in(&b_y2);
+    x1_update.store_in(&b_x1, {i});
+    x2_update.store_in(&b_x2, {i});
+
+    generate({&b_x1, &b_x2, &b_y1, &b_y2, &b_A});
+}
+
+// -------------------------------------------------------
+// Linear algebra : solvers
+// -------------------------------------------------------
+
+static void cholesky()
+{
+    var i("i", 0, CHOLESKY_N), j("j", 0, CHOLESKY_N), k("k", 0, CHOLESKY_N);
+
+    input A("A", {i, j}, p_float64);
+
+    computation A_update("A_update", {i, j, k}, (j < i) && (k < j), A(i, j) - A(i, k) * A(j, k));
+    computation A_divide("A_divide", {i, j}, j < i, A(i, j) / A(j, j));
+    computation A_diagonal_update("A_diagonal_update", {i, k}, k < i, A(i, i) - A(i, k) * A(i, k));
+    computation A_diagonal_sqrt("A_diagonal_sqrt", {i}, expr(o_sqrt, A(i, i)));
+
+    A_update.then(A_divide, j)
+            .then(A_diagonal_update, i)
+            .then(A_diagonal_sqrt, i);
+
+    // The factorization is left in the order of PolyBench : the iterations of its
+    // outer loops depend on each other, and its inner loops are reductions.
+
+    buffer b_A("b_A", {CHOLESKY_N, CHOLESKY_N}, p_float64, a_output);
+
+    A.store_in(&b_A);
+    A_update.store_in(&b_A, {i, j});
+    A_divide.store_in(&b_A);
+    A_diagonal_update.store_in(&b_A, {i, i});
+    A_diagonal_sqrt.store_in(&b_A, {i, i});
+
+    generate({&b_A});
+}
+
+static void lu()
+{
+    var i("i", 0, LU_N), j("j", 0, LU_N), k("k", 0, LU_N);
+
+    input A("A", {i, j}, p_float64);
+
+    computation L_update("L_update", {i, j, k}, (j < i) && (k < j), A(i, j) - A(i, k) * A(k, j));
+    computation L_divide("L_divide", {i, j}, j < i, A(i, j) / A(j, j));
+    computation U_update("U_update", {i, j, k}, (j >= i) && (k < i), A(i, j) - A(i, k) * A(k, j));
+
+    L_update.then(L_divide, j)
+            .then(U_update, i);
+
+    // The elements of a row of U are independent : the update of the row is
+    // interchanged to be vectorized along the row
+    if (hand_schedule)
+    {
+        U_update.interchange(j, k);
+        U_update.vectorize(j, 8);
+    }
+
+    buffer b_A("b_A", {LU_N, LU_N}, p_float64, a_output);
+
+    A.store_in(&b_A);
+    L_update.store_in(&b_A, {i, j});
+    L_divide.store_in(&b_A);
+    U_update.store_in(&b_A, {i, j});
+
+    generate({&b_A});
+}
+
+static void trisolv()
+{
+    var i("i", 0, TRISOLV_N), j("j", 0, TRISOLV_N);
+
+    input L("L", {i, j}, p_float64), x("x", {i}, p_float64), b("b", {i}, p_float64);
+
+    computation x_init("x_init", {i}, b(i));
+    computation x_update("x_update", {i, j}, j < i, x(i) - L(i, j) * x(j));
+    computation x_divide("x_divide", {i}, x(i) / L(i, i));
+
+    x_init.then(x_update, i)
+          .then(x_divide, i);
+
+    // The substitution is left in the order of PolyBench : each element of x
+    // depends on the previous ones.
+
+    buffer b_L("b_L", {TRISOLV_N, TRISOLV_N}, p_float64, a_input);
+    buffer b_x("b_x", {TRISOLV_N}, p_float64, a_output);
+    buffer b_b("b_b", {TRISOLV_N}, p_float64, a_input);
+
+    L.store_in(&b_L);
+    x.store_in(&b_x);
+    b.store_in(&b_b);
+    x_init.store_in(&b_x);
+    x_update.store_in(&b_x, {i});
+    x_divide.store_in(&b_x);
+
+    generate({&b_L, &b_x, &b_b});
+}
+
+// -------------------------------------------------------
+// Data mining
+// -------------------------------------------------------
+
+static void covariance()
+{
+    var i("i", 0, COVARIANCE_N), j("j", 0, COVARIANCE_M), l("l", 0, COVARIANCE_M);
+
+    input data("data", {i, j}, p_float64), mean("mean", {j}, p_float64), cov("cov", {j, l}, p_float64);
+
+    computation mean_init("mean_init", {j}, expr(0.0));
+    computation mean_update("mean_update", {j, i}, p_float64);
+    mean_update.set_expression(mean_update(j, i) + data(i, j));
+    computation mean_divide("mean_divide", {j}, mean(j) / expr((double) COVARIANCE_N));
+    computation data_center("data_center", {i, j}, data(i, j) - mean(j));
+    computation cov_init("cov_init", {j, l}, l >= j, expr(0.0));
+    computation cov_update("cov_update", {j, l, i}, l >= j, expr(p_float64));
+    cov_update.set_expression(cov_update(j, l, i) + data(i, j) * data(i, l));
+    computation cov_divide("cov_divide", {j, l}, l >= j, cov(j, l) / expr(COVARIANCE_N - 1.0));
+    computation cov_symmetric("cov_symmetric", {j, l}, l >= j, cov(j, l));
+
+    mean_init.then(mean_update, j)
+             .then(mean_divide, j)
+             .then(data_center, computation::root)
+             .then(cov_init, computation::root)
+             .then(cov_update, l)
+             .then(cov_divide, l)
+             .then(cov_symmetric, l);
+
+    // Each iteration of j computes the row j and the column j of the upper
+    // and lower triangles of cov
+    if (hand_schedule)
+    {
+        mean_init.parallelize(j);
+        mean_update.parallelize(j);
+        mean_divide.parallelize(j);
+        data_center.parallelize(i);
+        data_center.vectorize(j, 8);
+        cov_init.parallelize(j);
+        cov_update.parallelize(j);
+        cov_divide.parallelize(j);
+        cov_symmetric.parallelize(j);
+    }
+
+    buffer b_data("b_data", {COVARIANCE_N, COVARIANCE_M}, p_float64, a_output);
+    buffer b_cov("b_cov", {COVARIANCE_M, COVARIANCE_M}, p_float64, a_output);
+    buffer b_mean("b_mean", {COVARIANCE_M}, p_float64, a_output);
+
+    data.store_in(&b_data);
+    mean.store_in(&b_mean);
+    cov.store_in(&b_cov);
+    mean_init.store_in(&b_mean);
+    mean_update.store_in(&b_mean, {j});
+    mean_divide.store_in(&b_mean);
+    data_center.store_in(&b_data);
+    cov_init.store_in(&b_cov);
+    cov_update.store_in(&b_cov, {j, l});
+    cov_divide.store_in(&b_cov);
+    cov_symmetric.store_in(&b_cov, {l, j});
+
+    generate({&b_data, &b_cov, &b_mean});
+}
+
+// -------------------------------------------------------
+// Medley
+// -------------------------------------------------------
+
+static void floyd_warshall()
+{
+    var k("k", 0, FLOYD_WARSHALL_N), i("i", 0, FLOYD_WARSHALL_N), j("j", 0, FLOYD_WARSHALL_N);
+
+    input path("path", {i, j}, p_int32);
+
+    computation path_update("path_update", {k, i, j}, expr(o_min, path(i, j), path(i, k) + path(k, j)));
+
+    // The row and the column k are not modified at the iteration k (the lengths
+    // of the paths are positive), so that the iterations of i and j are independent
+    if (hand_schedule)
+    {
+        path_update.parallelize(i);
+        path_update.vectorize(j, 8);
+    }
+
+    buffer b_path("b_path", {FLOYD_WARSHALL_N, FLOYD_WARSHALL_N}, p_int32, a_output);
+
+    path.store_in(&b_path);
+    path_update.store_in(&b_path, {i, j});
+
+    generate({&b_path});
+}
+
+// -------------------------------------------------------
+// Stencils
+// -------------------------------------------------------
+
+static void fdtd_2d()
+{
+    var t("t", 0, FDTD_2D_TMAX), i("i", 0, FDTD_2D_NX), j("j", 0, FDTD_2D_NY);
+    var i1("i1", 1, FDTD_2D_NX), j1("j1", 1, FDTD_2D_NY), i2("i2", 0, FDTD_2D_NX - 1), j2("j2", 0, FDTD_2D_NY - 1);
+
+    input ex("ex", {i, j}, p_float64), ey("ey", {i, j}, p_float64), hz("hz", {i, j}, p_float64);
+    input fict("fict", {t}, p_float64);
+
+    computation ey_boundary("ey_boundary", {t, j}, fict(t));
+    computation ey_update("ey_update", {t, i1, j}, ey(i1, j) - expr(0.5) * (hz(i1, j) - hz(i1 - 1, j)));
+    computation ex_update("ex_update", {t, i, j1}, ex(i, j1) - expr(0.5) * (hz(i, j1) - hz(i, j1 - 1)));
+    computation hz_update("hz_update", {t, i2, j2},
+                          hz(i2, j2) - expr(0.7) * (ex(i2, j2 + 1) - ex(i2, j2) + ey(i2 + 1, j2) - ey(i2, j2)));
+
+    ey_boundary.then(ey_update, t)
+               .then(ex_update, t)
+               .then(hz_update, t);
+
+    if (hand_schedule)
+    {
+        ey_update.parallelize(i1);
+        ex_update.parallelize(i);
+        hz_update.parallelize(i2);
+        ey_boundary.vectorize(j, 8);
+        ey_update.vectorize(j, 8);
+        ex_update.vectorize(j1, 8);
+        hz_update.vectorize(j2, 8);
+    }
+
+    buffer b_ex("b_ex", {FDTD_2D_NX, FDTD_2D_NY}, p_float64, a_output);
+    buffer b_ey("b_ey", {FDTD_2D_NX, FDTD_2D_NY}, p_float64, a_output);
+    buffer b_hz("b_hz", {FDTD_2D_NX, FDTD_2D_NY}, p_float64, a_output);
+    buffer b_fict("b_fict", {FDTD_2D_TMAX}, p_float64, a_input);
+
+    ex.store_in(&b_ex);
+    ey.store_in(&b_ey);
+    hz.store_in(&b_hz);
+    fict.store_in(&b_fict);
+    ey_boundary.store_in(&b_ey, {0, j});
+    ey_update.store_in(&b_ey, {i1, j});
+    ex_update.store_in(&b_ex, {i, j1});
+    hz_update.store_in(&b_hz, {i2, j2});
+
+    generate({&b_ex, &b_ey, &b_hz, &b_fict});
+}
+
+static void heat_3d()
+{
+    var t("t", 1, HEAT_3D_TSTEPS + 1);
+    var i("i", 1, HEAT_3D_N - 1), j("j", 1, HEAT_3D_N - 1), k("k", 1, HEAT_3D_N - 1);
+
+    input A("A", {i, j, k}, p_float64), B("B", {i, j, k}, p_float64);
+
+    computation B_update("B_update", {t, i, j, k},
+                         expr(0.125) * (A(i + 1, j, k) - expr(2.0) * A(i, j, k) + A(i - 1, j, k))
+                         + expr(0.125) * (A(i, j + 1, k) - expr(2.0) * A(i, j, k) + A(i, j - 1, k))
+                         + expr(0.125) * (A(i, j, k + 1) - expr(2.0) * A(i, j, k) + A(i, j, k - 1))
+                         + A(i, j, k));
+    computation A_update("A_update", {t, i, j, k},
+                         expr(0.125) * (B(i + 1, j, k) - expr(2.0) * B(i, j, k) + B(i - 1, j, k))
+                         + expr(0.125) * (B(i, j + 1, k) - expr(2.0) * B(i, j, k) + B(i, j - 1, k))
+                         + expr(0.125) * (B(i, j, k + 1) - expr(2.0) * B(i, j, k) + B(i, j, k - 1))
+                         + B(i, j, k));
+
+    B_update.then(A_update, t);
+
+    if (hand_schedule)
+    {
+        B_update.parallelize(i);
+        A_update.parallelize(i);
+        B_update.vectorize(k, 8);
+        A_update.vectorize(k, 8);
+    }
+
+    buffer b_A("b_A", {HEAT_3D_N, HEAT_3D_N, HEAT_3D_N}, p_float64, a_output);
+    buffer b_B("b_B", {HEAT_3D_N, HEAT_3D_N, HEAT_3D_N}, p_float64, a_output);
+
+    A.store_in(&b_A);
+    B.store_in(&b_B);
+    B_update.store_in(&b_B, {i, j, k});
+    A_update.store_in(&b_A, {i, j, k});
+
+    generate({&b_A, &b_B});
+}
+
+static void jacobi_1d()
+{
+    var t("t", 0, JACOBI_1D_TSTEPS), i("i", 1, JACOBI_1D_N - 1);
+
+    input A("A", {i}, p_float64), B("B", {i}, p_float64);
+
+    computation B_update("B_update", {t, i}, expr(0.33333) * (A(i - 1) + A(i) + A(i + 1)));
+    computation A_update("A_update", {t, i}, expr(0.33333) * (B(i - 1) + B(i) + B(i + 1)));
+
+    B_update.then(A_update, t);
+
+    if (hand_schedule)
+    {
+        B_update.vectorize(i, 8);
+        A_update.vectorize(i, 8);
+    }
+
+    buffer b_A("b_A", {JACOBI_1D_N}, p_float64, a_output);
+    buffer b_B("b_B", {JACOBI_1D_N}, p_float64, a_output);
+
+    A.store_in(&b_A);
+    B.store_in(&b_B);
+    B_update.store_in(&b_B, {i});
+    A_update.store_in(&b_A, {i});
+
+    generate({&b_A, &b_B});
+}
+
+static void jacobi_2d()
+{
+    var t("t", 0, JACOBI_2D_TSTEPS), i("i", 1, JACOBI_2D_N - 1), j("j", 1, JACOBI_2D_N - 1);
+
+    input A("A", {i, j}, p_float64), B("B", {i, j}, p_float64);
+
+    computation B_update("B_update", {t, i, j},
+                         expr(0.2) * (A(i, j) + A(i, j - 1) + A(i, j + 1) + A(i + 1, j) + A(i - 1, j)));
+    computation A_update("A_update", {t, i, j},
+                         expr(0.2) * (B(i, j) + B(i, j - 1) + B(i, j + 1) + B(i + 1, j) + B(i - 1, j)));
+
+    B_update.then(A_update, t);
+
+    if (hand_schedule)
+    {
+        B_update.parallelize(i);
+        A_update.parallelize(i);
+        B_update.vectorize(j, 8);
+        A_update.vectorize(j, 8);
+    }
+
+    buffer b_A("b_A", {JACOBI_2D_N, JACOBI_2D_N}, p_float64, a_output);
+    buffer b_B("b_B", {JACOBI_2D_N, JACOBI_2D_N}, p_float64, a_output);
+
+    A.store_in(&b_A);
+    B.store_in(&b_B);
+    B_update.store_in(&b_B, {i, j});
+    A_update.store_in(&b_A, {i, j});
+
+    generate({&b_A, &b_B});
+}
+
+static void seidel_2d()
+{
+    var t("t", 0, SEIDEL_2D_TSTEPS), i("i", 1, SEIDEL_2D_N - 1), j("j", 1, SEIDEL_2D_N - 1);
+
+    input A("A", {i, j}, p_float64);
+
+    computation A_update("A_update", {t, i, j},
+                         (A(i - 1, j - 1) + A(i - 1, j) + A(i - 1, j + 1)
+                          + A(i, j - 1) + A(i, j) + A(i, j + 1)
+                          + A(i + 1, j - 1) + A(i + 1, j) + A(i + 1, j + 1)) / expr(9.0));
+
+    // The updates are left in the order of PolyBench : each point depends on the
+    // points updated before it, in the same time step, in both dimensions.
+
+    buffer b_A("b_A", {SEIDEL_2D_N, SEIDEL_2D_N}, p_float64, a_output);
+
+    A.store_in(&b_A);
+    A_update.store_in(&b_A, {i, j});
+
+    generate({&b_A});
+}
+
+int main(int argc, char **argv)
+{
+    std::map<std::string, std::function<void()>> kernels = {
+        {"gemm", gemm}, {"gemver", gemver}, {"gesummv", gesummv}, {"syr2k", syr2k}, {"syrk", syrk}, {"trmm", trmm},
+        {"2mm", k2mm}, {"3mm", k3mm}, {"atax", atax}, {"bicg", bicg}, {"doitgen", doitgen}, {"mvt", mvt},
+        {"cholesky", cholesky}, {"lu", lu}, {"trisolv", trisolv},
+        {"covariance", covariance},
+        {"floyd_warshall", floyd_warshall},
+        {"fdtd_2d", fdtd_2d}, {"heat_3d", heat_3d}, {"jacobi_1d", jacobi_1d}, {"jacobi_2d", jacobi_2d}, {"seidel_2d", seidel_2d}
+    };
+
+    if (argc != 3 || kernels.find(argv[1]) == kernels.end() ||
+        (std::string(argv[2]) != "hand" && std::string(argv[2]) != "auto"))
+    {
+        std::cerr << "usage : " << argv[0] << " KERNEL hand|auto" << std::endl << "kernels :";
+        for (auto const& kernel : kernels)
+            std::cerr << " " << kernel.first;
+        std::cerr << std::endl;
+        return 1;
+    }
+
+    hand_schedule = std::string(argv[2]) == "hand";
+
+    tiramisu::init("polybench_" + std::string(argv[1]) + "_" + argv[2]);
+    kernels[argv[1]]();
+
+    return 0;
+}
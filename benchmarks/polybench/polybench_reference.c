@@ -0,0 +1,436 @@
+#include <math.h>
+#include "polybench_reference.h"
+
+// The kernels of PolyBench/C 4.2, with their scalars replaced by constants.
+//
+// This file is compiled as is for the reference variant. CMakeLists.txt also
+// preprocesses it with -DPOLYBENCH_ONLY_KERNEL -DPOLYBENCH_KERNEL_<kernel> and
+// -DPOLYBENCH_SUFFIX=ppcg (or pluto), so that each kernel is in a file of its own
+// (Pluto optimizes a single scop per file) before being given to PPCG or Pluto.
+
+#ifndef POLYBENCH_SUFFIX
+#define POLYBENCH_SUFFIX reference
+#endif
+
+#define POLYBENCH_CONCAT(name, suffix) name ## _ ## suffix
+#define POLYBENCH_EXPAND(name, suffix) POLYBENCH_CONCAT(name, suffix)
+#define POLYBENCH_FUNCTION(kernel) POLYBENCH_EXPAND(polybench_ ## kernel, POLYBENCH_SUFFIX)
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_gemm)
+void POLYBENCH_FUNCTION(gemm)(double C[GEMM_NI][GEMM_NJ], double A[GEMM_NI][GEMM_NK], double B[GEMM_NK][GEMM_NJ])
+{
+    int i, j, k;
+#pragma scop
+    for (i = 0; i < GEMM_NI; i++) {
+        for (j = 0; j < GEMM_NJ; j++)
+            C[i][j] *= POLYBENCH_BETA;
+        for (k = 0; k < GEMM_NK; k++)
+            for (j = 0; j < GEMM_NJ; j++)
+                C[i][j] += POLYBENCH_ALPHA * A[i][k] * B[k][j];
+    }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_gemver)
+void POLYBENCH_FUNCTION(gemver)(double A[GEMVER_N][GEMVER_N], double u1[GEMVER_N], double v1[GEMVER_N],
+                                double u2[GEMVER_N], double v2[GEMVER_N], double w[GEMVER_N], double x[GEMVER_N],
+                                double y[GEMVER_N], double z[GEMVER_N])
+{
+    int i, j;
+#pragma scop
+    for (i = 0; i < GEMVER_N; i++)
+        for (j = 0; j < GEMVER_N; j++)
+            A[i][j] = A[i][j] + u1[i] * v1[j] + u2[i] * v2[j];
+
+    for (i = 0; i < GEMVER_N; i++)
+        for (j = 0; j < GEMVER_N; j++)
+            x[i] = x[i] + POLYBENCH_BETA * A[j][i] * y[j];
+
+    for (i = 0; i < GEMVER_N; i++)
+        x[i] = x[i] + z[i];
+
+    for (i = 0; i < GEMVER_N; i++)
+        for (j = 0; j < GEMVER_N; j++)
+            w[i] = w[i] + POLYBENCH_ALPHA * A[i][j] * x[j];
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_gesummv)
+void POLYBENCH_FUNCTION(gesummv)(double A[GESUMMV_N][GESUMMV_N], double B[GESUMMV_N][GESUMMV_N],
+                                 double tmp[GESUMMV_N], double x[GESUMMV_N], double y[GESUMMV_N])
+{
+    int i, j;
+#pragma scop
+    for (i = 0; i < GESUMMV_N; i++) {
+        tmp[i] = 0.0;
+        y[i] = 0.0;
+        for (j = 0; j < GESUMMV_N; j++) {
+            tmp[i] = A[i][j] * x[j] + tmp[i];
+            y[i] = B[i][j] * x[j] + y[i];
+        }
+        y[i] = POLYBENCH_ALPHA * tmp[i] + POLYBENCH_BETA * y[i];
+    }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_syr2k)
+void POLYBENCH_FUNCTION(syr2k)(double C[SYR2K_N][SYR2K_N], double A[SYR2K_N][SYR2K_M], double B[SYR2K_N][SYR2K_M])
+{
+    int i, j, k;
+#pragma scop
+    for (i = 0; i < SYR2K_N; i++) {
+        for (j = 0; j <= i; j++)
+            C[i][j] *= POLYBENCH_BETA;
+        for (k = 0; k < SYR2K_M; k++)
+            for (j = 0; j <= i; j++)
+                C[i][j] += A[j][k] * POLYBENCH_ALPHA * B[i][k] + B[j][k] * POLYBENCH_ALPHA * A[i][k];
+    }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_syrk)
+void POLYBENCH_FUNCTION(syrk)(double C[SYRK_N][SYRK_N], double A[SYRK_N][SYRK_M])
+{
+    int i, j, k;
+#pragma scop
+    for (i = 0; i < SYRK_N; i++) {
+        for (j = 0; j <= i; j++)
+            C[i][j] *= POLYBENCH_BETA;
+        for (k = 0; k < SYRK_M; k++)
+            for (j = 0; j <= i; j++)
+                C[i][j] += POLYBENCH_ALPHA * A[i][k] * A[j][k];
+    }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_trmm)
+void POLYBENCH_FUNCTION(trmm)(double A[TRMM_M][TRMM_M], double B[TRMM_M][TRMM_N])
+{
+    int i, j, k;
+#pragma scop
+    for (i = 0; i < TRMM_M; i++)
+        for (j = 0; j < TRMM_N; j++) {
+            for (k = i + 1; k < TRMM_M; k++)
+                B[i][j] += A[k][i] * B[k][j];
+            B[i][j] = POLYBENCH_ALPHA * B[i][j];
+        }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_2mm)
+void POLYBENCH_FUNCTION(2mm)(double tmp[K2MM_NI][K2MM_NJ], double A[K2MM_NI][K2MM_NK], double B[K2MM_NK][K2MM_NJ],
+                             double C[K2MM_NJ][K2MM_NL], double D[K2MM_NI][K2MM_NL])
+{
+    int i, j, k;
+#pragma scop
+    for (i = 0; i < K2MM_NI; i++)
+        for (j = 0; j < K2MM_NJ; j++) {
+            tmp[i][j] = 0.0;
+            for (k = 0; k < K2MM_NK; ++k)
+                tmp[i][j] += POLYBENCH_ALPHA * A[i][k] * B[k][j];
+        }
+    for (i = 0; i < K2MM_NI; i++)
+        for (j = 0; j < K2MM_NL; j++) {
+            D[i][j] *= POLYBENCH_BETA;
+            for (k = 0; k < K2MM_NJ; ++k)
+                D[i][j] += tmp[i][k] * C[k][j];
+        }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_3mm)
+void POLYBENCH_FUNCTION(3mm)(double E[K3MM_NI][K3MM_NJ], double A[K3MM_NI][K3MM_NK], double B[K3MM_NK][K3MM_NJ],
+                             double F[K3MM_NJ][K3MM_NL], double C[K3MM_NJ][K3MM_NM], double D[K3MM_NM][K3MM_NL],
+                             double G[K3MM_NI][K3MM_NL])
+{
+    int i, j, k;
+#pragma scop
+    for (i = 0; i < K3MM_NI; i++)
+        for (j = 0; j < K3MM_NJ; j++) {
+            E[i][j] = 0.0;
+            for (k = 0; k < K3MM_NK; ++k)
+                E[i][j] += A[i][k] * B[k][j];
+        }
+    for (i = 0; i < K3MM_NJ; i++)
+        for (j = 0; j < K3MM_NL; j++) {
+            F[i][j] = 0.0;
+            for (k = 0; k < K3MM_NM; ++k)
+                F[i][j] += C[i][k] * D[k][j];
+        }
+    for (i = 0; i < K3MM_NI; i++)
+        for (j = 0; j < K3MM_NL; j++) {
+            G[i][j] = 0.0;
+            for (k = 0; k < K3MM_NJ; ++k)
+                G[i][j] += E[i][k] * F[k][j];
+        }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_atax)
+void POLYBENCH_FUNCTION(atax)(double A[ATAX_M][ATAX_N], double x[ATAX_N], double y[ATAX_N], double tmp[ATAX_M])
+{
+    int i, j;
+#pragma scop
+    for (i = 0; i < ATAX_N; i++)
+        y[i] = 0;
+    for (i = 0; i < ATAX_M; i++) {
+        tmp[i] = 0.0;
+        for (j = 0; j < ATAX_N; j++)
+            tmp[i] = tmp[i] + A[i][j] * x[j];
+        for (j = 0; j < ATAX_N; j++)
+            y[j] = y[j] + A[i][j] * tmp[i];
+    }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_bicg)
+void POLYBENCH_FUNCTION(bicg)(double A[BICG_N][BICG_M], double s[BICG_M], double q[BICG_N],
+                              double p[BICG_M], double r[BICG_N])
+{
+    int i, j;
+#pragma scop
+    for (i = 0; i < BICG_M; i++)
+        s[i] = 0;
+    for (i = 0; i < BICG_N; i++) {
+        q[i] = 0.0;
+        for (j = 0; j < BICG_M; j++) {
+            s[j] = s[j] + r[i] * A[i][j];
+            q[i] = q[i] + A[i][j] * p[j];
+        }
+    }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_doitgen)
+void POLYBENCH_FUNCTION(doitgen)(double A[DOITGEN_NR][DOITGEN_NQ][DOITGEN_NP], double C4[DOITGEN_NP][DOITGEN_NP])
+{
+    int r, q, p, s;
+    double sum[DOITGEN_NP];
+#pragma scop
+    for (r = 0; r < DOITGEN_NR; r++)
+        for (q = 0; q < DOITGEN_NQ; q++) {
+            for (p = 0; p < DOITGEN_NP; p++) {
+                sum[p] = 0.0;
+                for (s = 0; s < DOITGEN_NP; s++)
+                    sum[p] += A[r][q][s] * C4[s][p];
+            }
+            for (p = 0; p < DOITGEN_NP; p++)
+                A[r][q][p] = sum[p];
+        }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_mvt)
+void POLYBENCH_FUNCTION(mvt)(double x1[MVT_N], double x2[MVT_N], double y1[MVT_N], double y2[MVT_N],
+                             double A[MVT_N][MVT_N])
+{
+    int i, j;
+#pragma scop
+    for (i = 0; i < MVT_N; i++)
+        for (j = 0; j < MVT_N; j++)
+            x1[i] = x1[i] + A[i][j] * y1[j];
+    for (i = 0; i < MVT_N; i++)
+        for (j = 0; j < MVT_N; j++)
+            x2[i] = x2[i] + A[j][i] * y2[j];
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_cholesky)
+void POLYBENCH_FUNCTION(cholesky)(double A[CHOLESKY_N][CHOLESKY_N])
+{
+    int i, j, k;
+#pragma scop
+    for (i = 0; i < CHOLESKY_N; i++) {
+        for (j = 0; j < i; j++) {
+            for (k = 0; k < j; k++)
+                A[i][j] -= A[i][k] * A[j][k];
+            A[i][j] /= A[j][j];
+        }
+        for (k = 0; k < i; k++)
+            A[i][i] -= A[i][k] * A[i][k];
+        A[i][i] = sqrt(A[i][i]);
+    }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_lu)
+void POLYBENCH_FUNCTION(lu)(double A[LU_N][LU_N])
+{
+    int i, j, k;
+#pragma scop
+    for (i = 0; i < LU_N; i++) {
+        for (j = 0; j < i; j++) {
+            for (k = 0; k < j; k++)
+                A[i][j] -= A[i][k] * A[k][j];
+            A[i][j] /= A[j][j];
+        }
+        for (j = i; j < LU_N; j++)
+            for (k = 0; k < i; k++)
+                A[i][j] -= A[i][k] * A[k][j];
+    }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_trisolv)
+void POLYBENCH_FUNCTION(trisolv)(double L[TRISOLV_N][TRISOLV_N], double x[TRISOLV_N], double b[TRISOLV_N])
+{
+    int i, j;
+#pragma scop
+    for (i = 0; i < TRISOLV_N; i++) {
+        x[i] = b[i];
+        for (j = 0; j < i; j++)
+            x[i] -= L[i][j] * x[j];
+        x[i] = x[i] / L[i][i];
+    }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_covariance)
+void POLYBENCH_FUNCTION(covariance)(double data[COVARIANCE_N][COVARIANCE_M], double cov[COVARIANCE_M][COVARIANCE_M],
+                                    double mean[COVARIANCE_M])
+{
+    int i, j, k;
+#pragma scop
+    for (j = 0; j < COVARIANCE_M; j++) {
+        mean[j] = 0.0;
+        for (i = 0; i < COVARIANCE_N; i++)
+            mean[j] += data[i][j];
+        mean[j] /= COVARIANCE_N;
+    }
+    for (i = 0; i < COVARIANCE_N; i++)
+        for (j = 0; j < COVARIANCE_M; j++)
+            data[i][j] -= mean[j];
+    for (i = 0; i < COVARIANCE_M; i++)
+        for (j = i; j < COVARIANCE_M; j++) {
+            cov[i][j] = 0.0;
+            for (k = 0; k < COVARIANCE_N; k++)
+                cov[i][j] += data[k][i] * data[k][j];
+            cov[i][j] /= (COVARIANCE_N - 1.0);
+            cov[j][i] = cov[i][j];
+        }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_floyd_warshall)
+void POLYBENCH_FUNCTION(floyd_warshall)(int path[FLOYD_WARSHALL_N][FLOYD_WARSHALL_N])
+{
+    int i, j, k;
+#pragma scop
+    for (k = 0; k < FLOYD_WARSHALL_N; k++)
+        for (i = 0; i < FLOYD_WARSHALL_N; i++)
+            for (j = 0; j < FLOYD_WARSHALL_N; j++)
+                path[i][j] = path[i][j] < path[i][k] + path[k][j] ? path[i][j] : path[i][k] + path[k][j];
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_fdtd_2d)
+void POLYBENCH_FUNCTION(fdtd_2d)(double ex[FDTD_2D_NX][FDTD_2D_NY], double ey[FDTD_2D_NX][FDTD_2D_NY],
+                                 double hz[FDTD_2D_NX][FDTD_2D_NY], double fict[FDTD_2D_TMAX])
+{
+    int t, i, j;
+#pragma scop
+    for (t = 0; t < FDTD_2D_TMAX; t++) {
+        for (j = 0; j < FDTD_2D_NY; j++)
+            ey[0][j] = fict[t];
+        for (i = 1; i < FDTD_2D_NX; i++)
+            for (j = 0; j < FDTD_2D_NY; j++)
+                ey[i][j] = ey[i][j] - 0.5 * (hz[i][j] - hz[i - 1][j]);
+        for (i = 0; i < FDTD_2D_NX; i++)
+            for (j = 1; j < FDTD_2D_NY; j++)
+                ex[i][j] = ex[i][j] - 0.5 * (hz[i][j] - hz[i][j - 1]);
+        for (i = 0; i < FDTD_2D_NX - 1; i++)
+            for (j = 0; j < FDTD_2D_NY - 1; j++)
+                hz[i][j] = hz[i][j] - 0.7 * (ex[i][j + 1] - ex[i][j] + ey[i + 1][j] - ey[i][j]);
+    }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_heat_3d)
+void POLYBENCH_FUNCTION(heat_3d)(double A[HEAT_3D_N][HEAT_3D_N][HEAT_3D_N], double B[HEAT_3D_N][HEAT_3D_N][HEAT_3D_N])
+{
+    int t, i, j, k;
+#pragma scop
+    for (t = 1; t <= HEAT_3D_TSTEPS; t++) {
+        for (i = 1; i < HEAT_3D_N - 1; i++)
+            for (j = 1; j < HEAT_3D_N - 1; j++)
+                for (k = 1; k < HEAT_3D_N - 1; k++)
+                    B[i][j][k] = 0.125 * (A[i + 1][j][k] - 2.0 * A[i][j][k] + A[i - 1][j][k])
+                               + 0.125 * (A[i][j + 1][k] - 2.0 * A[i][j][k] + A[i][j - 1][k])
+                               + 0.125 * (A[i][j][k + 1] - 2.0 * A[i][j][k] + A[i][j][k - 1])
+                               + A[i][j][k];
+        for (i = 1; i < HEAT_3D_N - 1; i++)
+            for (j = 1; j < HEAT_3D_N - 1; j++)
+                for (k = 1; k < HEAT_3D_N - 1; k++)
+                    A[i][j][k] = 0.125 * (B[i + 1][j][k] - 2.0 * B[i][j][k] + B[i - 1][j][k])
+                               + 0.125 * (B[i][j + 1][k] - 2.0 * B[i][j][k] + B[i][j - 1][k])
+                               + 0.125 * (B[i][j][k + 1] - 2.0 * B[i][j][k] + B[i][j][k - 1])
+                               + B[i][j][k];
+    }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_jacobi_1d)
+void POLYBENCH_FUNCTION(jacobi_1d)(double A[JACOBI_1D_N], double B[JACOBI_1D_N])
+{
+    int t, i;
+#pragma scop
+    for (t = 0; t < JACOBI_1D_TSTEPS; t++) {
+        for (i = 1; i < JACOBI_1D_N - 1; i++)
+            B[i] = 0.33333 * (A[i - 1] + A[i] + A[i + 1]);
+        for (i = 1; i < JACOBI_1D_N - 1; i++)
+            A[i] = 0.33333 * (B[i - 1] + B[i] + B[i + 1]);
+    }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_jacobi_2d)
+void POLYBENCH_FUNCTION(jacobi_2d)(double A[JACOBI_2D_N][JACOBI_2D_N], double B[JACOBI_2D_N][JACOBI_2D_N])
+{
+    int t, i, j;
+#pragma scop
+    for (t = 0; t < JACOBI_2D_TSTEPS; t++) {
+        for (i = 1; i < JACOBI_2D_N - 1; i++)
+            for (j = 1; j < JACOBI_2D_N - 1; j++)
+                B[i][j] = 0.2 * (A[i][j] + A[i][j - 1] + A[i][1 + j] + A[1 + i][j] + A[i - 1][j]);
+        for (i = 1; i < JACOBI_2D_N - 1; i++)
+            for (j = 1; j < JACOBI_2D_N - 1; j++)
+                A[i][j] = 0.2 * (B[i][j] + B[i][j - 1] + B[i][1 + j] + B[1 + i][j] + B[i - 1][j]);
+    }
+#pragma endscop
+}
+#endif
+
+#if !defined(POLYBENCH_ONLY_KERNEL) || defined(POLYBENCH_KERNEL_seidel_2d)
+void POLYBENCH_FUNCTION(seidel_2d)(double A[SEIDEL_2D_N][SEIDEL_2D_N])
+{
+    int t, i, j;
+#pragma scop
+    for (t = 0; t <= SEIDEL_2D_TSTEPS - 1; t++)
+        for (i = 1; i <= SEIDEL_2D_N - 2; i++)
+            for (j = 1; j <= SEIDEL_2D_N - 2; j++)
+                A[i][j] = (A[i - 1][j - 1] + A[i - 1][j] + A[i - 1][j + 1]
+                           + A[i][j - 1] + A[i][j] + A[i][j + 1]
+                           + A[i + 1][j - 1] + A[i + 1][j] + A[i + 1][j + 1]) / 9.0;
+#pragma endscop
+}
+#endif
@@ -0,0 +1,54 @@
+#ifndef __POLYBENCH_REFERENCE_HEADER_
+#define __POLYBENCH_REFERENCE_HEADER_
+
+#include "configure.h"
+
+// The kernels of PolyBench/C compiled by the C compiler (suffix reference), and
+// optimized by PPCG (suffix ppcg) and by Pluto (suffix pluto) when they are installed.
+#define POLYBENCH_DECLARE_KERNELS(suffix) \
+    void polybench_gemm_##suffix(double C[GEMM_NI][GEMM_NJ], double A[GEMM_NI][GEMM_NK], double B[GEMM_NK][GEMM_NJ]); \
+    void polybench_gemver_##suffix(double A[GEMVER_N][GEMVER_N], double u1[GEMVER_N], double v1[GEMVER_N], \
+                                   double u2[GEMVER_N], double v2[GEMVER_N], double w[GEMVER_N], double x[GEMVER_N], \
+                                   double y[GEMVER_N], double z[GEMVER_N]); \
+    void polybench_gesummv_##suffix(double A[GESUMMV_N][GESUMMV_N], double B[GESUMMV_N][GESUMMV_N], \
+                                    double tmp[GESUMMV_N], double x[GESUMMV_N], double y[GESUMMV_N]); \
+    void polybench_syr2k_##suffix(double C[SYR2K_N][SYR2K_N], double A[SYR2K_N][SYR2K_M], double B[SYR2K_N][SYR2K_M]); \
+    void polybench_syrk_##suffix(double C[SYRK_N][SYRK_N], double A[SYRK_N][SYRK_M]); \
+    void polybench_trmm_##suffix(double A[TRMM_M][TRMM_M], double B[TRMM_M][TRMM_N]); \
+    void polybench_2mm_##suffix(double tmp[K2MM_NI][K2MM_NJ], double A[K2MM_NI][K2MM_NK], double B[K2MM_NK][K2MM_NJ], \
+                                double C[K2MM_NJ][K2MM_NL], double D[K2MM_NI][K2MM_NL]); \
+    void polybench_3mm_##suffix(double E[K3MM_NI][K3MM_NJ], double A[K3MM_NI][K3MM_NK], double B[K3MM_NK][K3MM_NJ], \
+                                double F[K3MM_NJ][K3MM_NL], double C[K3MM_NJ][K3MM_NM], double D[K3MM_NM][K3MM_NL], \
+                                double G[K3MM_NI][K3MM_NL]); \
+    void polybench_atax_##suffix(double A[ATAX_M][ATAX_N], double x[ATAX_N], double y[ATAX_N], double tmp[ATAX_M]); \
+    void polybench_bicg_##suffix(double A[BICG_N][BICG_M], double s[BICG_M], double q[BICG_N], \
+                                 double p[BICG_M], double r[BICG_N]); \
+    void polybench_doitgen_##suffix(double A[DOITGEN_NR][DOITGEN_NQ][DOITGEN_NP], double C4[DOITGEN_NP][DOITGEN_NP]); \
+    void polybench_mvt_##suffix(double x1[MVT_N], double x2[MVT_N], double y1[MVT_N], double y2[MVT_N], \
+                                double A[MVT_N][MVT_N]); \
+    void polybench_cholesky_##suffix(double A[CHOLESKY_N][CHOLESKY_N]); \
+    void polybench_lu_##suffix(double A[LU_N][LU_N]); \
+    void polybench_trisolv_##suffix(double L[TRISOLV_N][TRISOLV_N], double x[TRISOLV_N], double b[TRISOLV_N]); \
+    void polybench_covariance_##suffix(double data[COVARIANCE_N][COVARIANCE_M], double cov[COVARIANCE_M][COVARIANCE_M], \
+                                       double mean[COVARIANCE_M]); \
+    void polybench_floyd_warshall_##suffix(int path[FLOYD_WARSHALL_N][FLOYD_WARSHALL_N]); \
+    void polybench_fdtd_2d_##suffix(double ex[FDTD_2D_NX][FDTD_2D_NY], double ey[FDTD_2D_NX][FDTD_2D_NY], \
+                                    double hz[FDTD_2D_NX][FDTD_2D_NY], double fict[FDTD_2D_TMAX]); \
+    void polybench_heat_3d_##suffix(double A[HEAT_3D_N][HEAT_3D_N][HEAT_3D_N], double B[HEAT_3D_N][HEAT_3D_N][HEAT_3D_N]); \
+    void polybench_jacobi_1d_##suffix(double A[JACOBI_1D_N], double B[JACOBI_1D_N]); \
+    void polybench_jacobi_2d_##suffix(double A[JACOBI_2D_N][JACOBI_2D_N], double B[JACOBI_2D_N][JACOBI_2D_N]); \
+    void polybench_seidel_2d_##suffix(double A[SEIDEL_2D_N][SEIDEL_2D_N]);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+POLYBENCH_DECLARE_KERNELS(reference)
+POLYBENCH_DECLARE_KERNELS(ppcg)
+POLYBENCH_DECLARE_KERNELS(pluto)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,490 @@
+#include "Halide.h"
+#include <tiramisu/utils.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include "configure.h"
+#include "polybench_reference.h"
+
+#include "generated_polybench_gemm_hand.o.h"
+#include "generated_polybench_gemm_auto.o.h"
+#include "generated_polybench_gemver_hand.o.h"
+#include "generated_polybench_gemver_auto.o.h"
+#include "generated_polybench_gesummv_hand.o.h"
+#include "generated_polybench_gesummv_auto.o.h"
+#include "generated_polybench_syr2k_hand.o.h"
+#include "generated_polybench_syr2k_auto.o.h"
+#include "generated_polybench_syrk_hand.o.h"
+#include "generated_polybench_syrk_auto.o.h"
+#include "generated_polybench_trmm_hand.o.h"
+#include "generated_polybench_trmm_auto.o.h"
+#include "generated_polybench_2mm_hand.o.h"
+#include "generated_polybench_2mm_auto.o.h"
+#include "generated_polybench_3mm_hand.o.h"
+#include "generated_polybench_3mm_auto.o.h"
+#include "generated_polybench_atax_hand.o.h"
+#include "generated_polybench_atax_auto.o.h"
+#include "generated_polybench_bicg_hand.o.h"
+#include "generated_polybench_bicg_auto.o.h"
+#include "generated_polybench_doitgen_hand.o.h"
+#include "generated_polybench_doitgen_auto.o.h"
+#include "generated_polybench_mvt_hand.o.h"
+#include "generated_polybench_mvt_auto.o.h"
+#include "generated_polybench_cholesky_hand.o.h"
+#include "generated_polybench_cholesky_auto.o.h"
+#include "generated_polybench_lu_hand.o.h"
+#include "generated_polybench_lu_auto.o.h"
+#include "generated_polybench_trisolv_hand.o.h"
+#include "generated_polybench_trisolv_auto.o.h"
+#include "generated_polybench_covariance_hand.o.h"
+#include "generated_polybench_covariance_auto.o.h"
+#include "generated_polybench_floyd_warshall_hand.o.h"
+#include "generated_polybench_floyd_warshall_auto.o.h"
+#include "generated_polybench_fdtd_2d_hand.o.h"
+#include "generated_polybench_fdtd_2d_auto.o.h"
+#include "generated_polybench_heat_3d_hand.o.h"
+#include "generated_polybench_heat_3d_auto.o.h"
+#include "generated_polybench_jacobi_1d_hand.o.h"
+#include "generated_polybench_jacobi_1d_auto.o.h"
+#include "generated_polybench_jacobi_2d_hand.o.h"
+#include "generated_polybench_jacobi_2d_auto.o.h"
+#include "generated_polybench_seidel_2d_hand.o.h"
+#include "generated_polybench_seidel_2d_auto.o.h"
+
+// Runs the variants of the PolyBench kernels, checks that their outputs match the outputs
+// of the reference, and appends their times to performance_CPU.csv.
+//
+// usage : ./polybench_wrapper [KERNEL ...]
+//
+// All the kernels are run if none is given. The exit status is 1 if a variant gives a wrong result.
+
+// The relative error above which the output of a variant is wrong
+#define POLYBENCH_TOLERANCE 1e-6
+
+#define ARRAY_2D(b, n1) ((double (*)[n1]) (b).data())
+#define ARRAY_3D(b, n1, n2) ((double (*)[n1][n2]) (b).data())
+#define RAW(b) (b).raw_buffer()
+
+#ifdef POLYBENCH_PPCG
+#define POLYBENCH_PPCG_VARIANT(kernel, c_arguments) {"PPCG", [&]() { polybench_##kernel##_ppcg c_arguments; }},
+#else
+#define POLYBENCH_PPCG_VARIANT(kernel, c_arguments)
+#endif
+
+#ifdef POLYBENCH_PLUTO
+#define POLYBENCH_PLUTO_VARIANT(kernel, c_arguments) {"Pluto", [&]() { polybench_##kernel##_pluto c_arguments; }},
+#else
+#define POLYBENCH_PLUTO_VARIANT(kernel, c_arguments)
+#endif
+
+// The variants of a kernel, given the arguments of its C versions and of its Tiramisu versions
+#define POLYBENCH_VARIANTS(kernel, c_arguments, tiramisu_arguments)                     \
+    std::vector<variant> {                                                             \
+        {"Reference", [&]() { polybench_##kernel##_reference c_arguments; }},           \
+        POLYBENCH_PPCG_VARIANT(kernel, c_arguments)                                     \
+        POLYBENCH_PLUTO_VARIANT(kernel, c_arguments)                                    \
+        {"Tiramisu hand", [&]() { polybench_##kernel##_hand tiramisu_arguments; }},     \
+        {"Tiramisu auto", [&]() { polybench_##kernel##_auto tiramisu_arguments; }}      \
+    }
+
+struct variant
+{
+    std::string name;
+    std::function<void()> run;
+};
+
+static bool all_correct = true;
+
+// Values in [0, 1) that depend on the position of the elements and on seed
+static void init_array(Halide::Buffer<double> &b, int seed)
+{
+    for (size_t e = 0; e < b.number_of_elements(); e++)
+        b.data()[e] = (double) ((e * 7 + seed * 13) % 101) / 101.0;
+}
+
+// A symmetric matrix with a dominant diagonal, that is positive definite and
+// can be factorized without pivoting
+static void init_dominant_matrix(Halide::Buffer<double> &b)
+{
+    int n = b.dim(0).extent();
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            b(j, i) = (i == j) ? n : 1.0 / (1 + std::abs(i - j));
+}
+
+template <typename T>
+static double max_relative_error(Halide::Buffer<T> const& result, Halide::Buffer<T> const& expected)
+{
+    double error = 0;
+    for (size_t e = 0; e < expected.number_of_elements(); e++)
+    {
+        double difference = std::abs((double) result.data()[e] - (double) expected.data()[e]);
+        double relative = difference / std::max(1.0, std::abs((double) expected.data()[e]));
+        // NaN is an error
+        if (!(relative <= error))
+            error = std::isnan(relative) ? INFINITY : relative;
+    }
+    return error;
+}
+
+// Runs each variant NB_TESTS times on the arrays initialized by init, and compares
+// the outputs of each variant with the outputs of the reference (the first variant)
+template <typename T>
+static void benchmark(std::string const& kernel, std::function<void()> const& init,
+                      std::vector<variant> const& variants, std::vector<Halide::Buffer<T>*> const& outputs)
+{
+    std::vector<std::string> names;
+    std::vector<double> times;
+    std::vector<Halide::Buffer<T>> expected_outputs;
+
+    for (variant const& v : variants)
+    {
+        std::vector<std::chrono::duration<double, std::milli>> durations;
+        for (int i = 0; i < NB_TESTS; i++)
+        {
+            init();
+            auto start = std::chrono::high_resolution_clock::now();
+            v.run();
+            auto end = std::chrono::high_resolution_clock::now();
+            durations.push_back(end - start);
+        }
+
+        std::string status;
+        if (expected_outputs.empty())
+            for (Halide::Buffer<T> *output : outputs)
+                expected_outputs.push_back(output->copy());
+        else
+        {
+            double error = 0;
+            for (size_t o = 0; o < outputs.size(); o++)
+                error = std::max(error, max_relative_error(*outputs[o], expected_outputs[o]));
+
+            status = (error <= POLYBENCH_TOLERANCE) ? " (correct)" : " (wrong, relative error " + std::to_string(error) + ")";
+            all_correct = all_correct && error <= POLYBENCH_TOLERANCE;
+        }
+
+        names.push_back(v.name);
+        times.push_back(median(durations));
+        std::cout << kernel << " " << v.name << " : " << times.back() << " ms" << status << std::endl;
+    }
+
+    print_time("performance_CPU.csv", "polybench_" + kernel, names, times);
+}
+
+// -------------------------------------------------------
+// Linear algebra : BLAS
+// -------------------------------------------------------
+
+static void gemm()
+{
+    Halide::Buffer<double> C(GEMM_NJ, GEMM_NI), A(GEMM_NK, GEMM_NI), B(GEMM_NJ, GEMM_NK);
+
+    benchmark<double>("gemm", [&]() { init_array(C, 1); init_array(A, 2); init_array(B, 3); },
+        POLYBENCH_VARIANTS(gemm,
+                           (ARRAY_2D(C, GEMM_NJ), ARRAY_2D(A, GEMM_NK), ARRAY_2D(B, GEMM_NJ)),
+                           (RAW(C), RAW(A), RAW(B))),
+        {&C});
+}
+
+static void gemver()
+{
+    Halide::Buffer<double> A(GEMVER_N, GEMVER_N), u1(GEMVER_N), v1(GEMVER_N), u2(GEMVER_N), v2(GEMVER_N),
+                           w(GEMVER_N), x(GEMVER_N), y(GEMVER_N), z(GEMVER_N);
+
+    benchmark<double>("gemver",
+        [&]() {
+            init_array(A, 1); init_array(u1, 2); init_array(v1, 3); init_array(u2, 4); init_array(v2, 5);
+            init_array(w, 6); init_array(x, 7); init_array(y, 8); init_array(z, 9);
+        },
+        POLYBENCH_VARIANTS(gemver,
+                           (ARRAY_2D(A, GEMVER_N), u1.data(), v1.data(), u2.data(), v2.data(),
+                            w.data(), x.data(), y.data(), z.data()),
+                           (RAW(A), RAW(u1), RAW(v1), RAW(u2), RAW(v2), RAW(w), RAW(x), RAW(y), RAW(z))),
+        {&w});
+}
+
+static void gesummv()
+{
+    Halide::Buffer<double> A(GESUMMV_N, GESUMMV_N), B(GESUMMV_N, GESUMMV_N), tmp(GESUMMV_N), x(GESUMMV_N), y(GESUMMV_N);
+
+    benchmark<double>("gesummv", [&]() { init_array(A, 1); init_array(B, 2); init_array(x, 3); },
+        POLYBENCH_VARIANTS(gesummv,
+                           (ARRAY_2D(A, GESUMMV_N), ARRAY_2D(B, GESUMMV_N), tmp.data(), x.data(), y.data()),
+                           (RAW(A), RAW(B), RAW(tmp), RAW(x), RAW(y))),
+        {&y});
+}
+
+static void syr2k()
+{
+    Halide::Buffer<double> C(SYR2K_N, SYR2K_N), A(SYR2K_M, SYR2K_N), B(SYR2K_M, SYR2K_N);
+
+    benchmark<double>("syr2k", [&]() { init_array(C, 1); init_array(A, 2); init_array(B, 3); },
+        POLYBENCH_VARIANTS(syr2k,
+                           (ARRAY_2D(C, SYR2K_N), ARRAY_2D(A, SYR2K_M), ARRAY_2D(B, SYR2K_M)),
+                           (RAW(C), RAW(A), RAW(B))),
+        {&C});
+}
+
+static void syrk()
+{
+    Halide::Buffer<double> C(SYRK_N, SYRK_N), A(SYRK_M, SYRK_N);
+
+    benchmark<double>("syrk", [&]() { init_array(C, 1); init_array(A, 2); },
+        POLYBENCH_VARIANTS(syrk,
+                           (ARRAY_2D(C, SYRK_N), ARRAY_2D(A, SYRK_M)),
+                           (RAW(C), RAW(A))),
+        {&C});
+}
+
+static void trmm()
+{
+    Halide::Buffer<double> A(TRMM_M, TRMM_M), B(TRMM_N, TRMM_M);
+
+    benchmark<double>("trmm", [&]() { init_array(A, 1); init_array(B, 2); },
+        POLYBENCH_VARIANTS(trmm,
+                           (ARRAY_2D(A, TRMM_M), ARRAY_2D(B, TRMM_N)),
+                           (RAW(A), RAW(B))),
+        {&B});
+}
+
+// -------------------------------------------------------
+// Linear algebra : kernels
+// -------------------------------------------------------
+
+static void k2mm()
+{
+    Halide::Buffer<double> tmp(K2MM_NJ, K2MM_NI), A(K2MM_NK, K2MM_NI), B(K2MM_NJ, K2MM_NK),
+                           C(K2MM_NL, K2MM_NJ), D(K2MM_NL, K2MM_NI);
+
+    benchmark<double>("2mm", [&]() { init_array(A, 1); init_array(B, 2); init_array(C, 3); init_array(D, 4); },
+        POLYBENCH_VARIANTS(2mm,
+                           (ARRAY_2D(tmp, K2MM_NJ), ARRAY_2D(A, K2MM_NK), ARRAY_2D(B, K2MM_NJ),
+                            ARRAY_2D(C, K2MM_NL), ARRAY_2D(D, K2MM_NL)),
+                           (RAW(tmp), RAW(A), RAW(B), RAW(C), RAW(D))),
+        {&D});
+}
+
+static void k3mm()
+{
+    Halide::Buffer<double> E(K3MM_NJ, K3MM_NI), A(K3MM_NK, K3MM_NI), B(K3MM_NJ, K3MM_NK), F(K3MM_NL, K3MM_NJ),
+                           C(K3MM_NM, K3MM_NJ), D(K3MM_NL, K3MM_NM), G(K3MM_NL, K3MM_NI);
+
+    benchmark<double>("3mm", [&]() { init_array(A, 1); init_array(B, 2); init_array(C, 3); init_array(D, 4); },
+        POLYBENCH_VARIANTS(3mm,
+                           (ARRAY_2D(E, K3MM_NJ), ARRAY_2D(A, K3MM_NK), ARRAY_2D(B, K3MM_NJ), ARRAY_2D(F, K3MM_NL),
+                            ARRAY_2D(C, K3MM_NM), ARRAY_2D(D, K3MM_NL), ARRAY_2D(G, K3MM_NL)),
+                           (RAW(E), RAW(A), RAW(B), RAW(F), RAW(C), RAW(D), RAW(G))),
+        {&G});
+}
+
+static void atax()
+{
+    Halide::Buffer<double> A(ATAX_N, ATAX_M), x(ATAX_N), y(ATAX_N), tmp(ATAX_M);
+
+    benchmark<double>("atax", [&]() { init_array(A, 1); init_array(x, 2); },
+        POLYBENCH_VARIANTS(atax,
+                           (ARRAY_2D(A, ATAX_N), x.data(), y.data(), tmp.data()),
+                           (RAW(A), RAW(x), RAW(y), RAW(tmp))),
+        {&y});
+}
+
+static void bicg()
+{
+    Halide::Buffer<double> A(BICG_M, BICG_N), s(BICG_M), q(BICG_N), p(BICG_M), r(BICG_N);
+
+    benchmark<double>("bicg", [&]() { init_array(A, 1); init_array(p, 2); init_array(r, 3); },
+        POLYBENCH_VARIANTS(bicg,
+                           (ARRAY_2D(A, BICG_M), s.data(), q.data(), p.data(), r.data()),
+                           (RAW(A), RAW(s), RAW(q), RAW(p), RAW(r))),
+        {&s, &q});
+}
+
+static void doitgen()
+{
+    Halide::Buffer<double> A(DOITGEN_NP, DOITGEN_NQ, DOITGEN_NR), C4(DOITGEN_NP, DOITGEN_NP);
+
+    benchmark<double>("doitgen", [&]() { init_array(A, 1); init_array(C4, 2); },
+        POLYBENCH_VARIANTS(doitgen,
+                           (ARRAY_3D(A, DOITGEN_NQ, DOITGEN_NP), ARRAY_2D(C4, DOITGEN_NP)),
+                           (RAW(A), RAW(C4))),
+        {&A});
+}
+
+static void mvt()
+{
+    Halide::Buffer<double> x1(MVT_N), x2(MVT_N), y1(MVT_N), y2(MVT_N), A(MVT_N, MVT_N);
+
+    benchmark<double>("mvt",
+        [&]() { init_array(x1, 1); init_array(x2, 2); init_array(y1, 3); init_array(y2, 4); init_array(A, 5); },
+        POLYBENCH_VARIANTS(mvt,
+                           (x1.data(), x2.data(), y1.data(), y2.data(), ARRAY_2D(A, MVT_N)),
+                           (RAW(x1), RAW(x2), RAW(y1), RAW(y2), RAW(A))),
+        {&x1, &x2});
+}
+
+// -------------------------------------------------------
+// Linear algebra : solvers
+// -------------------------------------------------------
+
+static void cholesky()
+{
+    Halide::Buffer<double> A(CHOLESKY_N, CHOLESKY_N);
+
+    benchmark<double>("cholesky", [&]() { init_dominant_matrix(A); },
+        POLYBENCH_VARIANTS(cholesky, (ARRAY_2D(A, CHOLESKY_N)), (RAW(A))),
+        {&A});
+}
+
+static void lu()
+{
+    Halide::Buffer<double> A(LU_N, LU_N);
+
+    benchmark<double>("lu", [&]() { init_dominant_matrix(A); },
+        POLYBENCH_VARIANTS(lu, (ARRAY_2D(A, LU_N)), (RAW(A))),
+        {&A});
+}
+
+static void trisolv()
+{
+    Halide::Buffer<double> L(TRISOLV_N, TRISOLV_N), x(TRISOLV_N), b(TRISOLV_N);
+
+    benchmark<double>("trisolv", [&]() { init_dominant_matrix(L); init_array(b, 1); },
+        POLYBENCH_VARIANTS(trisolv,
+                           (ARRAY_2D(L, TRISOLV_N), x.data(), b.data()),
+                           (RAW(L), RAW(x), RAW(b))),
+        {&x});
+}
+
+// -------------------------------------------------------
+// Data mining
+// -------------------------------------------------------
+
+static void covariance()
+{
+    Halide::Buffer<double> data(COVARIANCE_M, COVARIANCE_N), cov(COVARIANCE_M, COVARIANCE_M), mean(COVARIANCE_M);
+
+    benchmark<double>("covariance", [&]() { init_array(data, 1); },
+        POLYBENCH_VARIANTS(covariance,
+                           (ARRAY_2D(data, COVARIANCE_M), ARRAY_2D(cov, COVARIANCE_M), mean.data()),
+                           (RAW(data), RAW(cov), RAW(mean))),
+        {&cov});
+}
+
+// -------------------------------------------------------
+// Medley
+// -------------------------------------------------------
+
+static void floyd_warshall()
+{
+    Halide::Buffer<int> path(FLOYD_WARSHALL_N, FLOYD_WARSHALL_N);
+
+    // As in PolyBench, some of the edges are missing (their length is 999)
+    auto init = [&]() {
+        for (int i = 0; i < FLOYD_WARSHALL_N; i++)
+            for (int j = 0; j < FLOYD_WARSHALL_N; j++)
+            {
+                path(j, i) = i * j % 7 + 1;
+                if ((i + j) % 13 == 0 || (i + j) % 7 == 0 || (i + j) % 11 == 0)
+                    path(j, i) = 999;
+            }
+    };
+
+    benchmark<int>("floyd_warshall", init,
+        POLYBENCH_VARIANTS(floyd_warshall,
+                           (((int (*)[FLOYD_WARSHALL_N]) path.data())),
+                           (RAW(path))),
+        {&path});
+}
+
+// -------------------------------------------------------
+// Stencils
+// -------------------------------------------------------
+
+static void fdtd_2d()
+{
+    Halide::Buffer<double> ex(FDTD_2D_NY, FDTD_2D_NX), ey(FDTD_2D_NY, FDTD_2D_NX), hz(FDTD_2D_NY, FDTD_2D_NX),
+                           fict(FDTD_2D_TMAX);
+
+    // The initialization of PolyBench
+    auto init = [&]() {
+        for (int t = 0; t < FDTD_2D_TMAX; t++)
+            fict(t) = t;
+        for (int i = 0; i < FDTD_2D_NX; i++)
+            for (int j = 0; j < FDTD_2D_NY; j++)
+            {
+                ex(j, i) = ((double) i * (j + 1)) / FDTD_2D_NX;
+                ey(j, i) = ((double) i * (j + 2)) / FDTD_2D_NY;
+                hz(j, i) = ((double) i * (j + 3)) / FDTD_2D_NX;
+            }
+    };
+
+    benchmark<double>("fdtd_2d", init,
+        POLYBENCH_VARIANTS(fdtd_2d,
+                           (ARRAY_2D(ex, FDTD_2D_NY), ARRAY_2D(ey, FDTD_2D_NY), ARRAY_2D(hz, FDTD_2D_NY), fict.data()),
+                           (RAW(ex), RAW(ey), RAW(hz), RAW(fict))),
+        {&ex, &ey, &hz});
+}
+
+static void heat_3d()
+{
+    Halide::Buffer<double> A(HEAT_3D_N, HEAT_3D_N, HEAT_3D_N), B(HEAT_3D_N, HEAT_3D_N, HEAT_3D_N);
+
+    benchmark<double>("heat_3d", [&]() { init_array(A, 1); init_array(B, 1); },
+        POLYBENCH_VARIANTS(heat_3d,
+                           (ARRAY_3D(A, HEAT_3D_N, HEAT_3D_N), ARRAY_3D(B, HEAT_3D_N, HEAT_3D_N)),
+                           (RAW(A), RAW(B))),
+        {&A, &B});
+}
+
+static void jacobi_1d()
+{
+    Halide::Buffer<double> A(JACOBI_1D_N), B(JACOBI_1D_N);
+
+    benchmark<double>("jacobi_1d", [&]() { init_array(A, 1); init_array(B, 2); },
+        POLYBENCH_VARIANTS(jacobi_1d, (A.data(), B.data()), (RAW(A), RAW(B))),
+        {&A, &B});
+}
+
+static void jacobi_2d()
+{
+    Halide::Buffer<double> A(JACOBI_2D_N, JACOBI_2D_N), B(JACOBI_2D_N, JACOBI_2D_N);
+
+    benchmark<double>("jacobi_2d", [&]() { init_array(A, 1); init_array(B, 2); },
+        POLYBENCH_VARIANTS(jacobi_2d,
+                           (ARRAY_2D(A, JACOBI_2D_N), ARRAY_2D(B, JACOBI_2D_N)),
+                           (RAW(A), RAW(B))),
+        {&A, &B});
+}
+
+static void seidel_2d()
+{
+    Halide::Buffer<double> A(SEIDEL_2D_N, SEIDEL_2D_N);
+
+    benchmark<double>("seidel_2d", [&]() { init_array(A, 1); },
+        POLYBENCH_VARIANTS(seidel_2d, (ARRAY_2D(A, SEIDEL_2D_N)), (RAW(A))),
+        {&A});
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::pair<std::string, std::function<void()>>> kernels = {
+        {"gemm", gemm}, {"gemver", gemver}, {"gesummv", gesummv}, {"syr2k", syr2k}, {"syrk", syrk}, {"trmm", trmm},
+        {"2mm", k2mm}, {"3mm", k3mm}, {"atax", atax}, {"bicg", bicg}, {"doitgen", doitgen}, {"mvt", mvt},
+        {"cholesky", cholesky}, {"lu", lu}, {"trisolv", trisolv},
+        {"covariance", covariance},
+        {"floyd_warshall", floyd_warshall},
+        {"fdtd_2d", fdtd_2d}, {"heat_3d", heat_3d}, {"jacobi_1d", jacobi_1d}, {"jacobi_2d", jacobi_2d}, {"seidel_2d", seidel_2d}
+    };
+
+    std::vector<std::string> selected(argv + 1, argv + argc);
+    for (auto const& kernel : kernels)
+        if (selected.empty() || std::find(selected.begin(), selected.end(), kernel.first) != selected.end())
+            kernel.second();
+
+    if (!all_correct)
+        std::cout << "Some variants give wrong results" << std::endl;
+
+    return all_correct ? 0 : 1;
+}
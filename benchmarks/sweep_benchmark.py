@@ -0,0 +1,96 @@
+#! /usr/bin/python3
+"""
+Run a benchmark on a range of problem sizes and numbers of threads, and
+write its scaling curves as CSV.
+
+The benchmark must generate parametric code and read its sizes with
+get_benchmark_sizes() (see include/tiramisu/utils.h), e.g. the axpy
+benchmark.  It is run once per size and number of threads, with
+TIRAMISU_BENCHMARK_SIZES, HL_NUM_THREADS (and MKL_NUM_THREADS, for the
+reference variants) and TIRAMISU_BENCHMARK_JSON set,
+and the median times it reports are collected.
+
+Usage: sweep_benchmark.py WRAPPER --sizes 1024,4096,16384 [--threads 1,2,4,8]
+                          [--weak] [--work "2*N"] [--output scaling.csv]
+
+With --weak, the size of each run is the given size multiplied by the
+number of threads (weak scaling), otherwise it is kept fixed (strong
+scaling).  --work is the amount of work of a run as a Python expression of
+the size N (e.g. "2*N" operations for axpy, "2*N**3" for a square gemm),
+used to compute the throughput.  The speedup of a run is the time of the run
+with the fewest threads on the same base size divided by its time: with
+strong scaling it is ideally the ratio of the numbers of threads, with weak
+scaling (the parallel efficiency) it is ideally 1.
+"""
+
+import argparse
+import csv
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def run(wrapper, size, threads):
+    fd, json_file = tempfile.mkstemp(suffix=".json")
+    os.close(fd)
+    env = dict(os.environ)
+    env["TIRAMISU_BENCHMARK_SIZES"] = str(size)
+    env["HL_NUM_THREADS"] = str(threads)
+    env["MKL_NUM_THREADS"] = str(threads)
+    env["TIRAMISU_BENCHMARK_JSON"] = json_file
+
+    try:
+        subprocess.check_call([wrapper], env=env, cwd=os.path.dirname(os.path.abspath(wrapper)))
+        records = []
+        with open(json_file) as f:
+            for line in f:
+                if line.strip():
+                    records.append(json.loads(line))
+    finally:
+        os.remove(json_file)
+
+    if not records:
+        sys.exit(wrapper + " did not report any time, does it call print_time()?")
+    return records[-1]["median_ms"]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Sweep the sizes and the threads of a benchmark.")
+    parser.add_argument("wrapper")
+    parser.add_argument("--sizes", required=True, help="comma separated problem sizes")
+    parser.add_argument("--threads", default=str(os.cpu_count()), help="comma separated numbers of threads")
+    parser.add_argument("--weak", action="store_true", help="scale the size with the number of threads")
+    parser.add_argument("--work", default="N", help="work of a run, as an expression of the size N")
+    parser.add_argument("--output", default="scaling.csv")
+    args = parser.parse_args()
+
+    sizes = [int(s) for s in args.sizes.split(",")]
+    threads_list = sorted(int(t) for t in args.threads.split(","))
+
+    with open(args.output, "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(["base_size", "size", "threads", "variant", "median_ms", "throughput_per_s", "speedup"])
+
+        for base_size in sizes:
+            reference = {}
+            for threads in threads_list:
+                size = base_size * threads if args.weak else base_size
+                work = eval(args.work, {}, {"N": size})
+                times = run(args.wrapper, size, threads)
+
+                for variant, time in sorted(times.items()):
+                    reference.setdefault(variant, time)
+                    speedup = reference[variant] / time if time > 0 else 0
+                    throughput = work / (time / 1000) if time > 0 else 0
+
+                    writer.writerow([base_size, size, threads, variant, time, throughput, speedup])
+                    print("N=%-12d threads=%-4d %-15s %12.4f ms  %14.4g /s  x%.2f"
+                          % (size, threads, variant, time, throughput, speedup))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
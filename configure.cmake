@@ -10,6 +10,18 @@ option(WITH_PYTHON_BINDINGS "Build Python bindings" ON)
 
 option(USE_AUTO_SCHEDULER "Build the Tiramisu auto-scheduler" FALSE)
 
+option(USE_ONNX "Build the ONNX model importer (needs ONNX and Protobuf)" OFF)
+
+option(USE_TORCH "Build the in-process cost model evaluator of the auto-scheduler (needs LibTorch)" OFF)
+
+option(USE_FLEXNLP "Build the asynchronous FlexNLP runtime (needs the FlexNLP wrappers)" OFF)
+
+option(USE_OPENMP "Build the OpenMP parallel backend of the generated code (see function::set_parallel_backend())" OFF)
+
+option(USE_TBB "Build the oneTBB parallel backend of the generated code (see function::set_parallel_backend())" OFF)
+
+option(USE_OPENCL "Build the OpenCL runtime of the kernels generated for arch_opencl_gpu (needs OpenCL 2.0)" OFF)
+
 option(WITH_TUTORIALS "Build Tutorials" OFF)
 
 option(WITH_BENCHMAKRS "Build Benchmarks" OFF)
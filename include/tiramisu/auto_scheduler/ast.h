@@ -1,6 +1,11 @@
 #ifndef _H_TIRAMISU_AUTO_SCHEDULER_AST_
 #define _H_TIRAMISU_AUTO_SCHEDULER_AST_
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <limits>
+
 #include <tiramisu/core.h>
 #include "utils.h"
 #include "optimization_info.h"
@@ -86,6 +91,25 @@ class state_computation
 
 };
 
+/**
+ * The encodings of a computation for the cost model (see evaluate_by_learning_model),
+ * computed the first time they are needed.
+ */
+struct computation_encodings
+{
+    std::once_flag json_once, features_once;
+
+    /**
+     * The JSON of the computation, without its absolute order.
+     */
+    std::string json;
+
+    /**
+     * The features of the computation in the program features.
+     */
+    std::vector<float> features;
+};
+
 /**
  * Stores information about a computation.
  */
@@ -103,13 +127,16 @@ public:
     
     /**
      * List of iterators of the computation.
+     * The iterators never change, so all the copies of this computation_info share them.
      */
-    std::vector<dnn_iterator> iters;
+    std::shared_ptr<const std::vector<dnn_iterator>> iters;
     
     /**
      * List of accesses of the computation.
+     * The accesses are shared by the copies of this computation_info (copying an AST
+     * does not copy the access matrices). Use get_mutable_accesses() to modify them.
      */
-    dnn_accesses accesses;
+    std::shared_ptr<dnn_accesses> accesses;
     
     /**
      * Number of dimensions of the output buffer.
@@ -121,6 +148,24 @@ public:
      */
     bool is_reduction;
 
+    /**
+     * The levels of the iterators that do not appear in the write access of the
+     * computation (e.g. k for C(i, j, k) stored in C_buf(i, j)). Two iterations that
+     * only differ on these levels write the same element.
+     */
+    std::vector<int> reduction_levels;
+
+    /**
+     * The ID of this definition of the computation (0 for the first definition,
+     * see tiramisu::computation::add_definitions()).
+     */
+    int definition_id;
+
+    /**
+     * True if the computation reads the buffer it writes (e.g. C(i, j, k) = C(i, j, k - 1) + ...).
+     */
+    bool is_update;
+
     /**
      * A string representing the ISL write access relation of the computation.
      */
@@ -148,6 +193,14 @@ public:
     int nb_substractions;
     int nb_multiplications;
     int nb_divisions;
+
+    /**
+     * The encodings of this computation for the cost model. They only depend on the
+     * fields above, so they are shared by the copies of this computation_info, and the
+     * program is not encoded again for each evaluated schedule : only the computations
+     * whose accesses were modified (see get_mutable_accesses()) are encoded again.
+     */
+    std::shared_ptr<computation_encodings> encodings = std::make_shared<computation_encodings>();
     
     /**
      * Get info about the given computation. The AST is needed to get some info.
@@ -160,6 +213,13 @@ public:
     */
     //computation_info(computation_info const& reference);
 
+    /**
+     * Return the accesses of this computation_info, after having copied them
+     * if they are shared with other copies (copy-on-write). The encodings of
+     * the computation are reset.
+     */
+    dnn_accesses& get_mutable_accesses();
+
     /**
      * modifies the accesses by skewing
     */
@@ -207,6 +267,12 @@ public:
      */
     int up_bound;
 
+    /**
+     * False if the bounds of this loop depend on other iterators or on parameters,
+     * in which case low_bound and up_bound are estimates (see dnn_iterator::get_estimated_bounds()).
+     */
+    bool constant_bounds = true;
+
     /**
      * True if the following loop level has been unrolled.
      */
@@ -227,6 +293,21 @@ public:
     */
     bool vectorized = false;
 
+    /**
+     * True if the loop level has been mapped to GPU blocks
+     */
+    bool gpu_block = false;
+
+    /**
+     * True if the loop level has been mapped to GPU threads
+     */
+    bool gpu_thread = false;
+
+    /**
+     * True if the loop level iterates over the ranks of a distributed program
+     */
+    bool distributed = false;
+
     /**
      * List of the computations computed at this level.
      */
@@ -332,6 +413,12 @@ public:
      */
     void get_all_computations(std::vector<tiramisu::computation*>& comps);
 
+    /**
+     * Return true if this loop is a reduction level (see computation_info::reduction_levels)
+     * of all the computations computed at this level and the levels below.
+     */
+    bool is_reduction_level() const;
+
     /**
      * Starting from this node, get the number of nodes that have no computation,
      * and only one child.
@@ -377,6 +464,12 @@ public:
     */
     void recover_isl_states();
 
+    /**
+     * keep, in this subtree, only the isl_states of the given computations if keep is true,
+     * or only the isl_states of the other computations if keep is false
+    */
+    void filter_isl_states(std::vector<tiramisu::computation*> const& comps, bool keep);
+
     /**
      * pushs all the computations inside this node recursively 
     */
@@ -432,10 +525,30 @@ public:
      */
     std::unordered_map<std::string, std::string> buffers_mapping;
 
+    /**
+     * The computations of the blocks declared by the user (see tiramisu::block),
+     * that are scheduled as a unit : an optimization that transforms the loops of
+     * a computation of a block also transforms the loops of the other computations
+     * of the block.
+     */
+    std::vector<std::vector<tiramisu::computation*>> blocks;
+
     /**
      * An evaluation given by a class of type evaluation_function.
      */
     float evaluation;
+
+    /**
+     * The energy in mJ consumed by one run of this schedule, when it was measured
+     * by an evaluate_by_execution with measurement_harness::measure_energy, NaN otherwise.
+     */
+    float energy = std::numeric_limits<float>::quiet_NaN();
+
+    /**
+     * The hardware counters of one run of this schedule, when it was measured by an
+     * evaluate_by_execution with measurement_harness::measure_counters, empty otherwise.
+     */
+    std::map<std::string, double> hardware_counters;
     
     /**
      * The depth of this AST in a search method.
@@ -488,6 +601,18 @@ public:
     }
     
     std::vector<tiramisu::computation*> const& get_computations() const { return computations_list; }
+
+    /**
+     * Return true if comps contains some computations of a block, but not all of them.
+     */
+    bool splits_block(std::vector<tiramisu::computation*> const& comps) const;
+
+    /**
+     * Return true if the given optimization transforms the computations of each
+     * block together (see blocks). The fusions, which move whole loop nests, and the
+     * optimizations of the accesses of a computation always do.
+     */
+    bool respects_blocks(optimization_info const& optim) const;
     
     /**
      * Transform the AST by applying the last optimization found.
@@ -507,9 +632,17 @@ public:
     void transform_ast_by_tiling(optimization_info const& opt);
     void transform_ast_by_interchange(optimization_info const& opt);
     void transform_ast_by_unrolling(optimization_info const& opt);
+    void transform_ast_by_unroll_and_jam(optimization_info const& opt);
     void transform_ast_by_parallelism(const optimization_info &info);
     void transform_ast_by_skewing(const optimization_info &opt);
     void transform_ast_by_skewing_positive(const optimization_info &opt);
+    void transform_ast_by_vectorization(const optimization_info &opt);
+    void transform_ast_by_gpu_mapping(const optimization_info &opt);
+    void transform_ast_by_thread_coarsening(const optimization_info &opt);
+    void transform_ast_by_gpu_split_reduction(const optimization_info &opt);
+    void transform_ast_by_distribution(const optimization_info &opt);
+    void transform_ast_by_fission(const optimization_info &opt);
+    void transform_ast_by_unimodular(const optimization_info &opt);
     
     /**
      * Copy this AST, and return the copy.
@@ -627,6 +760,25 @@ public:
      */
     std::string get_schedule_str();
 
+    /**
+     * Return a canonical form of the schedule applied to the ast: two asts that have the
+     * same canonical form generate the same code, even if their optimizations were applied
+     * in a different order (e.g. an interchange then a tiling, or the equivalent tiling then
+     * interchange).
+     *
+     * It describes the loop structure (the iterators, their bounds and their tags, and the
+     * order of the computations) after transform_ast(). The optimizations whose effect is
+     * not captured by the loop structure (skewing, unimodular transformations, shifted
+     * fusions, caching, ...) are added as they were applied.
+     */
+    std::string get_canonical_form() const;
+
+    /**
+     * Return the size in bytes of the temporary buffers of the program (its scratch memory).
+     * The buffers whose size is not constant are ignored.
+     */
+    float get_memory_footprint() const;
+
     /**
      * Predicts if the schedule applied to the ast is worth evaluating and exploring further.
      */
@@ -668,6 +820,11 @@ private:
      */
     std::string schedule_str;
 
+    /**
+     * The hardware counters of one run of the candidate, if they were measured
+     */
+    std::map<std::string, double> hardware_counters;
+
     /**
      * The child candidates that are derived from this candidate
      */
@@ -4,13 +4,18 @@
 #include <tiramisu/core.h>
 #include <tiramisu/expr.h>
 #include "ast.h"
+#include "schedule_database.h"
 #include "utils.h"
 
 namespace tiramisu::auto_scheduler
 {
 
 class evaluation_function;
+class evaluation_cache;
 class search_method;
+class schedule_database;
+
+const int DEFAULT_CHECKPOINT_PERIOD = 50;
 
 /**
   * The core class for the autoscheduler.
@@ -54,6 +59,29 @@ protected:
      * It is measured using "exec_evaluator".
      */
     float initial_exec_time;
+
+    /**
+     * The checkpoint file of the search (see set_checkpoint()). Empty if the
+     * search is not checkpointed.
+     */
+    std::string checkpoint_filename;
+
+    /**
+     * The evaluation caches created by set_checkpoint() when the evaluators did not have one.
+     */
+    std::vector<evaluation_cache*> checkpoint_caches;
+
+    /**
+     * The database of tuned schedules (see set_schedule_database()), nullptr if not used.
+     */
+    schedule_database *sched_db = nullptr;
+    int nb_seeds;
+
+    /**
+     * If resume is true, print the progress saved in the checkpoint file.
+     * Otherwise, remove the caches of a previous checkpointed search so that the search starts from scratch.
+     */
+    void prepare_checkpointed_search(bool resume);
         
 public:
     /**
@@ -69,11 +97,40 @@ public:
      * provide it with an evaluation function that measures execution time.
      */     
     void set_exec_evaluator(evaluate_by_execution *exec_evaluator) { this->exec_evaluator = exec_evaluator; }
+
+    /**
+     * Checkpoint the search into the given file every "period" explored schedules.
+     * The evaluations are kept in evaluation caches (created in filename.eval_cache and
+     * filename.exec_cache if the evaluators do not already have one), which are saved
+     * at each checkpoint. Must be called after set_exec_evaluator().
+     *
+     * The search is deterministic : when a search is resumed, the schedules explored
+     * before the interruption are evaluated from the caches, so the search quickly
+     * goes back to where it stopped, and continues from there.
+     */
+    void set_checkpoint(std::string const& filename, int period = DEFAULT_CHECKPOINT_PERIOD);
+
+    /**
+     * Use the database of tuned schedules stored in the given file : find_schedule() starts the
+     * search from the schedules of the nb_seeds most similar tuned programs (adapted to this
+     * program), and records the best schedule found in the database.
+     */
+    void set_schedule_database(std::string const& filename, int nb_seeds = DEFAULT_NB_SEEDS);
+
+    /**
+     * Limit the search to time_budget seconds and to schedules_budget explored schedules
+     * (0 means no limit). The search narrows its beam when the budget runs low, and stops
+     * when it is exhausted : apply_best_schedule() then applies the best schedule found so far.
+     */
+    void set_budget(float time_budget, int schedules_budget = 0);
+
+    ~auto_scheduler();
     
     /**
      * Use the search method to find a set of optimizations.
+     * If resume is true, continue the search saved in the checkpoint file (see set_checkpoint()).
      */
-    void find_schedule();
+    void find_schedule(bool resume = false);
     
     /**
      * Use the Tiramisu API to apply the schedule found by
@@ -81,11 +138,19 @@ public:
      */
     void apply_best_schedule();
 
+    /**
+     * Apply the schedule found by find_schedule() and save it in the given file
+     * (see function::save_schedule_file()), with the list of its optimizations.
+     * The function keeps the schedule applied : it can be generated right away,
+     * and later builds can use function::apply_schedule_file() instead of searching again.
+     */
+    void save_best_schedule(std::string const& filename);
+
     /**
      * Explores the search space and saves the explored schedules on a json file along with the measured
      * execution time of each schedule
      */
-    void sample_search_space(std::string filename = "./schedules_sample.json", bool timeout_schedules=true);
+    void sample_search_space(std::string filename = "./schedules_sample.json", bool timeout_schedules=true, bool resume=false);
 };
 
 }
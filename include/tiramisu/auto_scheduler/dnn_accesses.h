@@ -9,6 +9,12 @@
 namespace tiramisu::auto_scheduler
 {
 
+/**
+ * The value given to the parameters of the iteration domains (e.g. N)
+ * that the context of the function does not bound above.
+ */
+const int DEFAULT_PARAMETER_ESTIMATE = 1024;
+
 /**
  * Contains information about an iterator.
  * Just a convenient class to simplify working with the ML model.
@@ -19,14 +25,30 @@ public:
     std::string name;
     int low_bound;
     int up_bound;
+
+    /**
+     * False if the bounds of the iterator depend on other iterators (e.g. j <= i)
+     * or on parameters, in which case low_bound and up_bound are estimates.
+     */
+    bool constant_bounds;
     
-    dnn_iterator(std::string const& name, int low_bound, int up_bound)
-        : name(name), low_bound(low_bound), up_bound(up_bound) {}
+    dnn_iterator(std::string const& name, int low_bound, int up_bound, bool constant_bounds = true)
+        : name(name), low_bound(low_bound), up_bound(up_bound), constant_bounds(constant_bounds) {}
         
     /**
      * Return a list of dnn_iterators from the iterators of the given computation.
      */
     static std::vector<dnn_iterator> get_iterators_from_computation(tiramisu::computation const& comp);
+
+    /**
+     * Get the bounds of the iterator dim of the given computation. When they are not
+     * constant, they are estimated : the bounds of a non-rectangular loop are those of
+     * its rectangular hull, and the parameters are bounded by the context of the function
+     * (see function::set_context_set()), or set to DEFAULT_PARAMETER_ESTIMATE if the
+     * context does not bound them above.
+     * Return true if the bounds are constant.
+     */
+    static bool get_estimated_bounds(tiramisu::computation const& comp, int dim, int& low_bound, int& up_bound);
 };
 
 /**
@@ -84,6 +106,17 @@ public:
     */
     void transform_matrix_by_skewing(int first_node_depth,int alpha,int beta,int gamma,int sigma);
 
+    /**
+     * Transform the matrix after the iterator at \p depth is shifted by \p shift.
+     */
+    void transform_matrix_by_shifting(int depth, int shift);
+
+    /**
+     * Transform the matrix after the iterators from \p depth are transformed by a
+     * unimodular matrix, whose inverse is \p inverse.
+     */
+    void transform_matrix_by_unimodular(int depth, std::vector<std::vector<int>> const& inverse);
+
 };
 
 /**
@@ -121,6 +154,17 @@ public:
     void print_all_access() const;
 
     void modify_accesses_by_skewing(int first_node_depth,int alpha,int beta,int gamma,int sigma);
+
+    /**
+     * Modify the accesses after the iterator at \p depth is shifted by \p shift.
+     */
+    void modify_accesses_by_shifting(int depth, int shift);
+
+    /**
+     * Modify the accesses after the iterators from \p depth are transformed by a
+     * unimodular matrix, whose inverse is \p inverse.
+     */
+    void modify_accesses_by_unimodular(int depth, std::vector<std::vector<int>> const& inverse);
 };
 
 }
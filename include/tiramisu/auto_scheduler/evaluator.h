@@ -2,11 +2,140 @@
 #define _TIRAMISU_AUTO_SCHEDULER_EVALUATOR_
 
 #include "auto_scheduler.h"
+#include "measurement.h"
 #include "utils.h"
 
 namespace tiramisu::auto_scheduler
 {
 
+const int DEFAULT_EVALUATION_CACHE_SIZE = 100000;
+const int DEFAULT_LOWERING_MEMO_SIZE = 256;
+
+/**
+ * The cost of the messages used by evaluate_distributed : the latency of a message
+ * in ms, and the bandwidth of the network in bytes per ms.
+ */
+const float DEFAULT_MESSAGE_LATENCY = 0.002f;
+const float DEFAULT_NETWORK_BANDWIDTH = 1e7f;
+
+/**
+ * The default number of schedules executed in each batch by evaluate_hybrid
+ * (the best predicted ones, and the most uncertain ones), and the default
+ * relative uncertainty above which a prediction is not trusted.
+ */
+const int DEFAULT_NB_EXECUTED_BEST = 1;
+const int DEFAULT_NB_EXECUTED_UNCERTAIN = 1;
+const float DEFAULT_UNCERTAINTY_THRESHOLD = 0.2f;
+
+/**
+ * An on-disk cache of schedule evaluations.
+ *
+ * Entries are keyed by a hash of the program JSON, of the schedule (JSON and
+ * schedule string) and of an identifier of the evaluator (e.g. the Halide target
+ * features, or the command of the ML model). Each entry stores the list of
+ * measurements (or the model prediction) of the schedule.
+ *
+ * The cache is loaded from filename at construction, and written back by save()
+ * and at destruction. When it contains more than max_nb_entries entries,
+ * the least recently used entries are evicted.
+ */
+class evaluation_cache
+{
+private:
+    struct cache_entry
+    {
+        std::vector<float> measurements;
+
+        /**
+         * Used for the LRU eviction policy.
+         */
+        long last_use;
+    };
+
+protected:
+    /**
+     * The file where the cache is stored.
+     */
+    std::string filename;
+
+    /**
+     * The maximum number of entries kept when saving the cache.
+     */
+    int max_nb_entries;
+
+    std::unordered_map<std::string, cache_entry> entries;
+
+    /**
+     * A logical clock, incremented at each access.
+     */
+    long clock = 0;
+
+    int nb_hits = 0;
+    int nb_misses = 0;
+
+public:
+    evaluation_cache(std::string const& filename, int max_nb_entries = DEFAULT_EVALUATION_CACHE_SIZE);
+
+    ~evaluation_cache() { save(); }
+
+    /**
+     * Return the key of the given AST for an evaluator identified by evaluator_id.
+     */
+    static std::string get_key(syntax_tree& ast, std::string const& evaluator_id);
+
+    /**
+     * Return the key of a schedule given by its program JSON and schedule JSON
+     * (see evaluate_by_learning_model::get_program_json()), when the AST is not available.
+     */
+    static std::string get_key(std::string const& program_json, std::string const& schedule_json,
+                               std::string const& evaluator_id);
+
+    /**
+     * If the key is in the cache, store its measurements in measurements and return true.
+     */
+    bool lookup(std::string const& key, std::vector<float>& measurements);
+
+    /**
+     * Add (or replace) an entry.
+     */
+    void insert(std::string const& key, std::vector<float> const& measurements);
+
+    /**
+     * Write the cache to its file, evicting the least recently used entries if needed.
+     */
+    void save();
+
+    /**
+     * Remove all the entries of the cache.
+     */
+    void clear()
+    {
+        entries.clear();
+        clock = 0;
+    }
+
+    int get_nb_hits() const { return nb_hits; }
+    int get_nb_misses() const { return nb_misses; }
+
+    /**
+     * Return a JSON object with the hits and misses counters.
+     */
+    std::string get_stats_json() const;
+};
+
+/**
+ * The metrics of a schedule (see evaluation_function::evaluate_metrics()).
+ * The lower, the better.
+ */
+enum schedule_metric
+{
+    LATENCY,
+    MEMORY_FOOTPRINT,
+    ENERGY
+};
+
+const int NB_SCHEDULE_METRICS = 3;
+
 /**
   * An abstract class that represents an evaluation function.
   * Derive this class and implement the method "evaluate" to
@@ -17,7 +146,12 @@ class evaluation_function
 private:
     
 protected:
-    
+    /**
+     * If set, evaluations are looked up in this cache before being computed,
+     * and stored in it after being computed.
+     */
+    evaluation_cache *cache = nullptr;
+
 public:
     virtual ~evaluation_function() {}
     
@@ -26,6 +160,42 @@ public:
      * its evaluation.
      */
     virtual float evaluate(syntax_tree& ast) =0;
+
+    /**
+     * Evaluate a list of abstract syntax trees, and return their
+     * evaluations in the same order.
+     * The default implementation calls evaluate() on each AST. Evaluation functions
+     * that can evaluate many schedules at once (e.g. ML models) should override it.
+     */
+    virtual std::vector<float> evaluate_batch(std::vector<syntax_tree*> const& asts)
+    {
+        std::vector<float> evaluations;
+        for (syntax_tree *ast : asts)
+            evaluations.push_back(evaluate(*ast));
+
+        return evaluations;
+    }
+
+    /**
+     * Return the metrics of the given AST, indexed by schedule_metric : its evaluation,
+     * its memory footprint (see syntax_tree::get_memory_footprint()) and the energy
+     * of one run (see syntax_tree::energy, NaN if it was not measured).
+     */
+    virtual std::vector<float> evaluate_metrics(syntax_tree& ast)
+    {
+        float evaluation = evaluate(ast);
+        return {evaluation, ast.get_memory_footprint(), ast.energy};
+    }
+
+    void set_cache(evaluation_cache *cache) { this->cache = cache; }
+    evaluation_cache* get_cache() const { return cache; }
+
+    /**
+     * Return a string that identifies this evaluator in cache keys.
+     * Two evaluators with the same identifier must give the same evaluation
+     * to the same schedule.
+     */
+    virtual std::string get_cache_id() const =0;
 };
 
 /**
@@ -37,16 +207,8 @@ private:
 
 protected:
     /**
-     * The following three attributes are parameters for Halide.
+     * The following two attributes are parameters for Halide.
      */
-    std::vector<Halide::Target::Feature> halide_features = {
-        Halide::Target::AVX,
-        Halide::Target::SSE41,
-        //Halide::Target::AVX2,
-	    //Halide::Target::FMA,
-        Halide::Target::LargeBuffers
-    };
-    
     Halide::Target halide_target;
     std::vector<Halide::Argument> halide_arguments;
 
@@ -65,33 +227,261 @@ protected:
      */
     std::string wrapper_cmd;
 
+    /**
+     * When the evaluator is used by a parallel worker, the object file and the
+     * shared library are first generated with this suffix, so that concurrent
+     * workers do not overwrite each other's files.
+     */
+    std::string worker_suffix;
+
+    /**
+     * Path of the lock file that serializes the timing runs of the parallel workers.
+     * Empty if the evaluator is not used by a parallel worker.
+     */
+    std::string measurement_lock_path;
+
+    /**
+     * Used to get reliable measurements : pinning, noise detection, outliers rejection
+     * (and for evaluate_by_jit, warmup runs, adaptive repetition and cache flushing).
+     */
+    measurement_harness harness;
+
+    /**
+     * Take and release the measurement lock (do nothing if no lock is set).
+     * The lock is an advisory lock (flock) on measurement_lock_path.
+     */
+    int acquire_measurement_lock() const;
+    void release_measurement_lock(int lock_fd) const;
+
+    /**
+     * Halide statements already generated for this program, indexed by
+     * function::get_schedules_signature(). Sibling candidates of the search
+     * often end up with the same schedule (e.g. an optimization that does not
+     * change anything), in which case the isl AST and the Halide statement
+     * are not generated again.
+     * The memo is cleared when it contains more than DEFAULT_LOWERING_MEMO_SIZE statements.
+     */
+    std::unordered_map<std::string, Halide::Internal::Stmt> lowering_memo;
+
+    /**
+     * Apply the optimizations specified by the AST, and generate the Halide
+     * statement of the program.
+     */
+    void gen_halide_stmt(syntax_tree& ast);
+
+    /**
+     * Lower the Halide statement of the program to a Halide module targeting
+     * halide_target.
+     */
+    Halide::Module lower_halide_stmt() const;
+
+    /**
+     * Apply the optimizations specified by the AST, and lower the program
+     * to a Halide module targeting halide_target.
+     */
+    Halide::Module lower_to_halide_module(syntax_tree& ast);
+
+    /**
+     * Apply the optimizations specified by the AST, and compile the program
+     * to the object file obj_filename and the shared library obj_filename.so.
+     * The object file is taken from the object cache (see object_cache_key())
+     * when the same program was already compiled.
+     */
+    virtual void compile_to_shared_library(syntax_tree& ast, std::string const& obj_filename);
+
+    /**
+     * The number of computations of the program, their expressions and the buffers
+     * of the program before the optimizations are applied.
+     * Some optimizations (e.g. SHARED_MEMORY_CACHING) add computations and buffers to
+     * the program and modify the expressions : restore_program() undoes these changes.
+     */
+    int nb_program_computations = 0;
+    std::vector<tiramisu::expr> program_expressions;
+    std::set<std::string> program_buffers;
+
+    void save_program();
+    void restore_program();
+
 public:
     /**
      * arguments : the input and output buffers of the program.
+     * target : the Halide target the program is compiled for, the host machine by default.
      */
     evaluate_by_execution(std::vector<tiramisu::buffer*> const& arguments, 
 						  std::string const& obj_filename, 
 						  std::string const& wrapper_cmd,
-						  tiramisu::function *fct = tiramisu::global::get_implicit_function());
+						  tiramisu::function *fct = tiramisu::global::get_implicit_function(),
+						  Halide::Target const& target = get_host_halide_target());
+
+    /**
+     * Return the Halide target of the host machine, with all the vector extensions
+     * it supports (SSE4.1, AVX, AVX2, FMA, AVX-512 on x86 ; NEON, dot product,
+     * FP16, SVE, SVE2 with the vector length of the machine on ARM ; the V
+     * extension with its vector length on RISC-V) and with large buffers enabled.
+     * If the environment variable HL_TARGET is set, the target it describes is used instead.
+     */
+    static Halide::Target get_host_halide_target();
+
+    Halide::Target const& get_halide_target() const { return halide_target; }
     
 	/**
 	 * Apply the specified optimizations, compile the program and execute it.
 	 */
     virtual float evaluate(syntax_tree& ast);
 
+    /**
+     * The Halide target and the wrapper command identify this evaluator.
+     */
+    virtual std::string get_cache_id() const;
+
+    /**
+     * Return the key used to cache the result of get_measurements() for the given AST.
+     */
+    std::string get_measurements_cache_key(syntax_tree& ast) const
+    {
+        return evaluation_cache::get_key(ast, get_cache_id() + ":measurements");
+    }
+
     /**
      * Apply the specified optimizations, compile the program and execute it.
      * Returns a vector of measured execution times
      * If the timeout parameter is defined, it stops the execution after MAX_RUNS*timeout seconds
      * If exit_on_timeout is set to true, it raises an error when the timeout is reached and terminates the program
      */
-    std::vector<float> get_measurements(syntax_tree &ast,  bool exit_on_timeout = false, float timeout = 0);
+    virtual std::vector<float> get_measurements(syntax_tree &ast,  bool exit_on_timeout = false, float timeout = 0);
+
+    /**
+     * Configure this evaluator to be used by the parallel worker worker_id.
+     * Compilation is done in files private to the worker, and timing runs are
+     * serialized by taking the lock lock_path.
+     */
+    void set_worker(int worker_id, std::string const& lock_path)
+    {
+        worker_suffix = "_w" + std::to_string(worker_id);
+        measurement_lock_path = lock_path;
+    }
+
+    std::string const& get_obj_filename() const { return obj_filename; }
+
+    measurement_harness& get_measurement_harness() { return harness; }
+};
+
+/**
+ * Evaluate programs mapped to a GPU (see schedules_generator::set_gpu_target())
+ * by compiling them with the CUDA backend and executing them.
+ *
+ * The shared library obj_filename.so contains the host code and the GPU code of
+ * the program, and is linked with the CUDA runtime. The copies between the host
+ * and the GPU are part of the program. The wrapper links with the CUDA wrappers of
+ * Tiramisu, and measures the execution time with CUDA events by calling
+ * tiramisu_cuda_timer_start() and tiramisu_cuda_timer_stop() around each run.
+ */
+class evaluate_by_cuda : public evaluate_by_execution
+{
+private:
+
+protected:
+    /**
+     * The flags used to link the shared library with the CUDA runtime.
+     */
+    std::string cuda_link_flags;
+
+    /**
+     * True if the schedules whose kernels spill registers are evaluated as
+     * infinitely slow without being executed (see set_reject_spilling_kernels()).
+     */
+    bool reject_spilling_kernels = true;
+
+    /**
+     * Generate the CUDA code of the program, and compile it with nvcc.
+     */
+    virtual void compile_to_shared_library(syntax_tree& ast, std::string const& obj_filename);
+
+public:
+    evaluate_by_cuda(std::vector<tiramisu::buffer*> const& arguments,
+                     std::string const& obj_filename,
+                     std::string const& wrapper_cmd,
+                     tiramisu::function *fct = tiramisu::global::get_implicit_function());
+
+    /**
+     * Spilling registers to local memory makes the kernels slow, so by default
+     * the schedules whose kernels spill (see function::get_gpu_kernel_resources())
+     * are not executed, and are evaluated as infinitely slow.  Setting \p reject
+     * to false executes them.
+     */
+    void set_reject_spilling_kernels(bool reject) { reject_spilling_kernels = reject; }
+
+    /**
+     * The CUDA backend and the wrapper command identify this evaluator.
+     */
+    virtual std::string get_cache_id() const;
+};
+
+/**
+ * Fill a buffer allocated for the measurements with ones, so that floating point
+ * inputs do not contain NaNs or denormals that would bias the measurements.
+ */
+void init_resident_buffer(Halide::Runtime::Buffer<>& buf, tiramisu::primitive_t type);
+
+/**
+ * Evaluate programs by JIT-compiling them with Halide and executing them
+ * inside the autoscheduler process.
+ *
+ * No object file, shared library or wrapper is needed : the input and output
+ * buffers are allocated once (from the constant extents of the tiramisu buffers)
+ * and stay resident across all the evaluated schedules.
+ * The runs are done by the measurement harness (see measurement_harness).
+ */
+class evaluate_by_jit : public evaluate_by_execution
+{
+private:
+
+protected:
+    /**
+     * Halide buffers allocated for the arguments of the program.
+     * They are reused by every evaluation.
+     */
+    std::vector<Halide::Runtime::Buffer<>> resident_buffers;
+
+    /**
+     * The arguments passed to the JIT-compiled function (pointers to the raw buffers).
+     */
+    std::vector<const void*> jit_args;
+
+public:
+    /**
+     * arguments : the input and output buffers of the program.
+     * All of them must have constant extents.
+     * nb_warmups : the number of untimed runs executed before measuring.
+     */
+    evaluate_by_jit(std::vector<tiramisu::buffer*> const& arguments,
+                    int nb_warmups = 1,
+                    tiramisu::function *fct = tiramisu::global::get_implicit_function(),
+                    Halide::Target const& target = get_host_halide_target());
+
+    /**
+     * Apply the specified optimizations, JIT-compile the program and return
+     * the minimal measured execution time (in ms).
+     */
+    virtual float evaluate(syntax_tree& ast);
+
+    /**
+     * Same contract as evaluate_by_execution::get_measurements, but the program
+     * is compiled and timed in-process.
+     */
+    virtual std::vector<float> get_measurements(syntax_tree &ast, bool exit_on_timeout = false, float timeout = 0);
 };
 
 /**
  * This evaluation function uses system pipes to communicate with an ML model
  * that will evaluate schedules.
  * JSON is used to transfer information about the schedule to evaluate.
+ *
+ * Two messages can be written to the model :
+ *  - a single schedule : the program JSON line followed by the schedule JSON line.
+ *    The model answers with one speedup.
+ *  - a batch of schedules : a line "batch N" followed by N pairs of program JSON
+ *    and schedule JSON lines. The model answers with N speedups, in the same order.
  */
 class evaluate_by_learning_model : public evaluation_function
 {
@@ -108,6 +498,11 @@ protected:
      */
     FILE *model_read;
 
+    /**
+     * The command (path and arguments) used to launch the model.
+     */
+    std::string model_cmd;
+
 public:
     /**
      * cmd_path : path to the program containing the ML model.
@@ -119,6 +514,24 @@ public:
 	 * Call the model and return its evaluation.
 	 */
     virtual float evaluate(syntax_tree& ast);
+
+    /**
+     * Send all the schedules to the model in one batch message,
+     * and return their evaluations.
+     */
+    virtual std::vector<float> evaluate_batch(std::vector<syntax_tree*> const& asts);
+
+    /**
+     * Send schedules given by their program JSON and schedule JSON to the model
+     * in one batch message (with the JSON encoding), and return their evaluations.
+     * Used to evaluate schedules built by other processes (see autoscheduling_service).
+     */
+    std::vector<float> evaluate_json_batch(std::vector<std::pair<std::string, std::string>> const& schedules);
+
+    /**
+     * The command of the model identifies this evaluator.
+     */
+    virtual std::string get_cache_id() const { return "model:" + model_cmd; }
     
     /**
      * Return a JSON representation of the program represented by the AST.
@@ -135,6 +548,33 @@ public:
      * Return a JSON representation of the schedule of the given AST.
      */
     static std::string get_schedule_json(syntax_tree const& ast);
+
+    /**
+     * Return the name of the given computation in the JSON representations.
+     * The updates of a computation (see tiramisu::computation::add_definitions())
+     * share its name, so their definition ID is appended to it, e.g. "C_update_1".
+     */
+    static std::string get_computation_key(tiramisu::computation *comp);
+
+    /**
+     * Append to features a flat representation of the program :
+     *
+     * nb_computations, then for each computation (in absolute order) :
+     *     nb_iterators, (lower_bound, upper_bound) for each iterator,
+     *     is_reduction, nb_additions, nb_substractions, nb_multiplications, nb_divisions,
+     *     storage_buffer_id, data_type_size, nb_accesses, then for each access :
+     *         buffer_id, nb_rows, nb_columns, the access matrix in row-major order,
+     * nb_loops, then for each loop level (depth-first order) :
+     *     depth, lower_bound, upper_bound, nb_children, nb_computations.
+     */
+    static void get_program_features(syntax_tree const& ast, std::vector<float>& features);
+
+    /**
+     * Append to features a flat representation of the schedule :
+     * nb_optimizations, then for each optimization (previous ones first) :
+     *     type, nb_l, l0, l1, l2, l0_fact, l1_fact, l2_fact, l3_fact.
+     */
+    static void get_schedule_features(syntax_tree const& ast, std::vector<float>& features);
     
     // --------------------------------------------------------------------------------- //
     
@@ -168,6 +608,161 @@ public:
     static std::string get_tree_structure_json(ast_node *node);
 };
 
+/**
+ * Evaluate distributed programs (see schedules_generator::set_distributed_target())
+ * by adding the cost of the communication to the cost of the computations.
+ *
+ * The computations are evaluated by compute_eval on a single node, where DISTRIBUTION
+ * only splits the distributed level : the ranks compute their blocks in parallel, so
+ * their time is divided by the number of ranks. The evaluations of compute_eval must be
+ * execution times, or opposite speedups (as given by evaluate_by_learning_model), which
+ * are turned into times with the execution time of the initial program reference_time.
+ *
+ * A rank receives from its neighbours the data computed by the other ranks that its
+ * block reads. The messages and their size are those of computation::gen_communication(),
+ * as estimated by computation::get_communication_volume() from the exchanged sets.
+ * Each message costs message_latency, and its bytes are sent at network_bandwidth.
+ */
+class evaluate_distributed : public evaluation_function
+{
+private:
+
+protected:
+    /**
+     * The evaluation function used for the computations.
+     */
+    evaluation_function *compute_eval;
+
+    /**
+     * The function that is distributed.
+     */
+    tiramisu::function *fct;
+
+    float message_latency;
+    float network_bandwidth;
+    float reference_time;
+
+    /**
+     * The time of the communication for each number of ranks.
+     * The other optimizations are applied inside the blocks of the ranks,
+     * so they do not change the exchanged data.
+     */
+    std::unordered_map<int, float> communication_times;
+
+    /**
+     * Return the execution time corresponding to an evaluation of compute_eval.
+     */
+    float get_computation_time(float evaluation) const;
+
+    /**
+     * Return the time of the communication of the distributed AST.
+     */
+    float get_communication_time(syntax_tree const& ast, optimization_info const& distribution);
+
+    /**
+     * Return the evaluation of the AST, given the evaluation of its computations by compute_eval.
+     */
+    float get_distributed_time(syntax_tree const& ast, float evaluation);
+
+public:
+    evaluate_distributed(evaluation_function *compute_eval,
+                         float message_latency = DEFAULT_MESSAGE_LATENCY,
+                         float network_bandwidth = DEFAULT_NETWORK_BANDWIDTH,
+                         float reference_time = 1.f,
+                         tiramisu::function *fct = tiramisu::global::get_implicit_function());
+
+    virtual float evaluate(syntax_tree& ast);
+
+    /**
+     * The computations of the ASTs are evaluated in one batch by compute_eval.
+     */
+    virtual std::vector<float> evaluate_batch(std::vector<syntax_tree*> const& asts);
+
+    /**
+     * The evaluator of the computations and the cost of the messages identify this evaluator.
+     */
+    virtual std::string get_cache_id() const;
+};
+
+/**
+ * Evaluate schedules with an ensemble of ML models, and execute the schedules
+ * whose prediction matters most or is the least reliable.
+ *
+ * Each schedule is evaluated by all the models (e.g. models trained with
+ * different seeds, or the same model with dropout enabled at inference given
+ * several times, for MC dropout).  The prediction is the mean speedup, and its
+ * uncertainty is the standard deviation of the speedups divided by their mean.
+ * In each batch, the nb_executed_best schedules with the best prediction, and
+ * the nb_executed_uncertain most uncertain schedules whose uncertainty is above
+ * uncertainty_threshold, are executed with exec_eval, and their measured speedup
+ * replaces the prediction.  Like evaluate_by_learning_model, the evaluation is
+ * the opposite of the speedup.
+ *
+ * The speedups are measured against reference_time, the execution time of the
+ * initial program.  If it is 0, the environment variable INIT_EXEC_TIME is used,
+ * or else the first evaluated schedule without optimizations is executed.  Until
+ * it is known, only the models are used.
+ *
+ * If log_filename is given, each executed schedule is appended to it as a JSON
+ * line (program, schedule, predicted speedup, uncertainty, measured speedup and
+ * execution time), to fine-tune the models on the programs they mispredict.
+ */
+class evaluate_hybrid : public evaluation_function
+{
+private:
+
+protected:
+    std::vector<evaluation_function*> models;
+    evaluate_by_execution *exec_eval;
+
+    int nb_executed_best;
+    int nb_executed_uncertain;
+    float uncertainty_threshold;
+    float reference_time;
+
+    std::string log_filename;
+
+    /**
+     * The number of schedules predicted by the models, and executed.
+     */
+    int nb_predicted = 0;
+    int nb_executed = 0;
+
+    /**
+     * Return reference_time, looked up as described above. Return 0 if it is not known.
+     */
+    float get_reference_time(std::vector<syntax_tree*> const& asts);
+
+    /**
+     * Append an executed schedule to the log.
+     */
+    void log_execution(syntax_tree const& ast, float predicted_speedup, float uncertainty,
+                       float measured_speedup, float exec_time) const;
+
+public:
+    evaluate_hybrid(std::vector<evaluation_function*> const& models, evaluate_by_execution *exec_eval,
+                    int nb_executed_best = DEFAULT_NB_EXECUTED_BEST,
+                    int nb_executed_uncertain = DEFAULT_NB_EXECUTED_UNCERTAIN,
+                    float uncertainty_threshold = DEFAULT_UNCERTAINTY_THRESHOLD,
+                    float reference_time = 0, std::string const& log_filename = "");
+
+    virtual float evaluate(syntax_tree& ast);
+
+    /**
+     * Each model evaluates the batch at once, then the selected schedules are executed.
+     */
+    virtual std::vector<float> evaluate_batch(std::vector<syntax_tree*> const& asts);
+
+    int get_nb_predicted() const { return nb_predicted; }
+    int get_nb_executed() const { return nb_executed; }
+
+    /**
+     * The models and the execution identify this evaluator.  Only the measured
+     * speedups are stored in the cache, the predictions are cached by the models.
+     */
+    virtual std::string get_cache_id() const;
+};
+
 }
 
 #endif
@@ -0,0 +1,103 @@
+#ifndef _TIRAMISU_AUTO_SCHEDULER_LEGALITY_ORACLE_
+#define _TIRAMISU_AUTO_SCHEDULER_LEGALITY_ORACLE_
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tiramisu/core.h>
+#include "optimization_info.h"
+
+namespace tiramisu::auto_scheduler
+{
+
+/**
+ * Answers whether a sequence of transformations of a loop nest is legal,
+ * from the dependences of the function, without applying the transformations
+ * to the computations.
+ *
+ * The dependences computed by function::perform_full_dependency_analysis()
+ * are turned once into distance vectors over the loop levels shared by each
+ * pair of computations.  A query transforms these distances with the
+ * unimodular matrix of the sequence, and checks them with small isl sets in
+ * a context owned by the calling thread, so queries can run concurrently.
+ *
+ * The supported transformations are INTERCHANGE, SKEWING, SKEWING_POSITIVE,
+ * UNIMODULAR, TILING, PARALLELIZE, VECTORIZATION (checked like PARALLELIZE) and UNROLLING
+ * (always legal).  Their levels are those of the loop nest of the iteration
+ * domains of optim_info.comps (i.e. before any scheduling command), and the
+ * levels of a tiling are those before tiling.  The answer is conservative:
+ * a sequence with another transformation, or with a level that is not shared
+ * by all its computations, is reported illegal, and so is a tiling or a
+ * parallelization that is only legal because of the tile sizes.
+ */
+class legality_oracle
+{
+private:
+    /**
+     * An identifier of the oracle in the per-thread caches.
+     */
+    int id;
+
+    /**
+     * The distance vectors of the dependences from a computation to another
+     * (or to itself), over their shared loop levels, as isl sets.  They are
+     * stored as strings so that each thread can parse them in its own isl context.
+     */
+    std::map<std::pair<std::string, std::string>, std::string> distances;
+
+    /**
+     * The number of loop levels of each computation.
+     */
+    std::map<std::string, int> depths;
+
+protected:
+    /**
+     * Return the distance vectors of the dependences between the computations
+     * \p comps over their \p depth outermost loop levels, in the isl context of
+     * the calling thread.  The sets are cached per thread.
+     */
+    isl_set *get_distances(std::vector<std::string> const& comps, int depth) const;
+
+public:
+    /**
+     * Compute the distance vectors from the dependences of \p fct, which must
+     * already have been computed with perform_full_dependency_analysis().
+     */
+    legality_oracle(tiramisu::function *fct = tiramisu::global::get_implicit_function());
+
+    /**
+     * Return true if the transformations, applied in this order, are legal.
+     * The computations are those of the first transformation.
+     */
+    bool is_legal(std::vector<optimization_info> const& transformations) const;
+
+    /**
+     * Answer several queries with \p nb_threads threads (the number of
+     * hardware threads if 0).
+     */
+    std::vector<bool> is_legal_batch(std::vector<std::vector<optimization_info>> const& sequences,
+                                     int nb_threads = 0) const;
+
+    /**
+     * Return up to \p nb_solutions unimodular matrices (for UNIMODULAR) that
+     * make the \p nb_levels loop levels starting at \p level fully permutable,
+     * and so tileable, once the transformations \p previous are applied to
+     * \p comps.  The candidates combine a skewing (a unit lower triangular
+     * matrix with coefficients up to \p max_coefficient), an interchange and
+     * the reversal of at most one level; the simplest ones come first.
+     * Return no matrix if the band is already fully permutable, or if
+     * \p previous contains a transformation that changes the loop levels
+     * (e.g. a tiling).
+     */
+    std::vector<std::vector<std::vector<int>>> find_tiling_transformations(std::vector<optimization_info> const& previous,
+                                                                           std::vector<tiramisu::computation*> const& comps,
+                                                                           int level, int nb_levels,
+                                                                           int max_coefficient = 1,
+                                                                           int nb_solutions = 3) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef _TIRAMISU_AUTO_SCHEDULER_MACHINE_PROFILE_
+#define _TIRAMISU_AUTO_SCHEDULER_MACHINE_PROFILE_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tiramisu::auto_scheduler
+{
+
+/**
+ * The number of features of a machine profile given to the cost models
+ * (see machine_profile::get_features()).
+ */
+const int MACHINE_PROFILE_NB_FEATURES = 12;
+
+/**
+ * A description of the host measured by microbenchmarks, to run once per
+ * machine (see utils/machine_characterization) :
+ * - the bandwidth of a core when its working set fits in each cache level,
+ *   and the bandwidth of the memory with 1, 2, 4 ... threads (a STREAM triad),
+ * - the latency of a load hitting each cache level and the memory (a chase of
+ *   pointers in a random cycle),
+ * - the peak single precision GFLOP/s of a core with each instruction set
+ *   supported by the CPU (scalar, SSE, AVX, AVX2 + FMA, AVX-512, NEON),
+ *   and of all the cores with the best one.
+ *
+ * The profile is saved in a text file, and is used by the autoscheduler when
+ * the environment variable AS_MACHINE_PROFILE gives this file (see
+ * get_host_profile()) : its cache sizes are those of the tile_size_explorer
+ * and of the candidate_pruner, its peak performance and bandwidth are those of
+ * roofline_analysis, and it is recorded in the JSON written by
+ * sample_search_space() so that the cost models can be trained with it.
+ */
+struct machine_profile
+{
+    std::string host_name;
+    int nb_cores = 1;
+
+    /**
+     * Sizes in bytes of the data caches of a core, from the L1.
+     */
+    std::vector<long> cache_sizes;
+
+    /**
+     * Bandwidth in GB/s of a core whose working set fits in each cache level.
+     */
+    std::vector<double> cache_bandwidths;
+
+    /**
+     * Latency in ns of a load that hits in each cache level, and in the memory.
+     */
+    std::vector<double> cache_latencies;
+    double memory_latency = 0;
+
+    /**
+     * Bandwidth in GB/s of the memory for a number of threads, from 1 to nb_cores.
+     */
+    std::vector<std::pair<int, double>> memory_bandwidth_scaling;
+
+    /**
+     * Bandwidth in GB/s of the memory with all the cores.
+     */
+    double memory_bandwidth = 0;
+
+    /**
+     * Peak single precision GFLOP/s of a core with each instruction set.
+     */
+    std::vector<std::pair<std::string, double>> core_peak_gflops;
+
+    /**
+     * Peak single precision GFLOP/s of all the cores with the best instruction set.
+     */
+    double peak_gflops = 0;
+
+    /**
+     * Run the microbenchmarks on the host, with nb_threads threads for the
+     * multi-core measurements (0 means the number of hardware threads).
+     * It takes a few seconds.
+     */
+    static machine_profile characterize(int nb_threads = 0);
+
+    /**
+     * Save the profile in the given file, return false if it cannot be written.
+     */
+    bool save(std::string const& filename) const;
+
+    /**
+     * Load the profile saved in the given file, return false if it cannot be read.
+     */
+    bool load(std::string const& filename);
+
+    std::string get_json() const;
+
+    /**
+     * Return MACHINE_PROFILE_NB_FEATURES features of the profile for the cost models :
+     * the number of cores, the log2 of the sizes of 3 cache levels, their bandwidths, the
+     * latency of the last cache level, the memory bandwidth and latency, and the peak GFLOP/s
+     * of a core and of all the cores. The missing cache levels are 0.
+     */
+    std::vector<float> get_features() const;
+
+    /**
+     * Return the profile saved in the file given by AS_MACHINE_PROFILE, loaded the first
+     * time this function is called, or nullptr if the variable is not set or the file
+     * cannot be read.
+     */
+    static machine_profile const* get_host_profile();
+};
+
+/**
+ * The cache sizes of the host profile (see machine_profile::get_host_profile())
+ * if there is one, CACHE_SIZES_DEFAULT_LIST otherwise.
+ */
+std::vector<long> get_default_cache_sizes();
+
+}
+
+#endif
@@ -0,0 +1,247 @@
+#ifndef _TIRAMISU_AUTO_SCHEDULER_MEASUREMENT_
+#define _TIRAMISU_AUTO_SCHEDULER_MEASUREMENT_
+
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tiramisu::auto_scheduler
+{
+
+const int DEFAULT_NB_WARMUPS = 1;
+const int DEFAULT_MIN_RUNS = 5;
+const int DEFAULT_MAX_RUNS = 30;
+const float DEFAULT_TARGET_CONFIDENCE = 0.02;
+const float DEFAULT_NOISE_THRESHOLD = 0.1;
+const int DEFAULT_NB_NOISE_RETRIES = 2;
+const size_t DEFAULT_CACHE_FLUSH_SIZE = 64 * 1024 * 1024;
+
+/**
+ * Hardware counters of the calling process and of the processes it creates
+ * afterwards (e.g. the wrapper executed by evaluate_by_execution), read with
+ * perf_event_open (Linux only).
+ *
+ * The counters are "cycles", "instructions", "l1d_misses" (L1 data cache read misses),
+ * "llc_misses" (last level cache misses), "stalled_cycles_frontend" and
+ * "stalled_cycles_backend". The counters that the CPU or the permissions
+ * (/proc/sys/kernel/perf_event_paranoid) do not allow are skipped.
+ *
+ * The mix of vector instructions is only given by events specific to each CPU, so they
+ * are given as raw events, for example on Intel CPUs :
+ * "fp_scalar_single=0x02c7,fp_256_single=0x20c7,fp_512_single=0x80c7".
+ */
+class perf_counters
+{
+private:
+
+protected:
+    /**
+     * The name and the file descriptor of each opened counter.
+     */
+    std::vector<std::pair<std::string, int>> counters;
+
+    void open_counter(std::string const& name, unsigned int type, unsigned long long config);
+
+public:
+    /**
+     * Open the counters, and the raw events given as a list of NAME=CONFIG
+     * where CONFIG is hexadecimal.
+     */
+    perf_counters(std::string const& raw_events = "");
+
+    ~perf_counters();
+
+    /**
+     * Return true if at least one counter could be opened.
+     */
+    bool is_available() const { return !counters.empty(); }
+
+    void reset();
+    void enable();
+    void disable();
+
+    /**
+     * Return the value of each counter divided by nb_runs. The values are scaled
+     * if the counters were multiplexed.
+     */
+    std::map<std::string, double> read(int nb_runs) const;
+};
+
+/**
+ * Times a program several times and returns reliable measurements.
+ *
+ * A measurement consists of :
+ *  - nb_warmups untimed runs ;
+ *  - at least min_runs and at most max_runs timed runs. After min_runs runs,
+ *    the repetition stops as soon as the half-width of the 95% confidence interval
+ *    of the mean is smaller than target_confidence * mean ;
+ *  - the rejection of the outliers (runs further than 3 median absolute deviations
+ *    from the median).
+ *
+ * Optionally, the caches are flushed between two runs, and the calling thread is
+ * pinned to a set of cores (threads created afterwards, like the Halide thread pool,
+ * inherit the pinning).
+ *
+ * Frequency changes and interference from other processes are detected by timing a
+ * fixed calibration workload before and after the measurement : if both timings differ
+ * by more than noise_threshold, the measurement is redone (up to nb_noise_retries times).
+ *
+ * The default parameters are read from the environment variables :
+ *  - MAX_RUNS : max_runs ;
+ *  - MIN_RUNS : min_runs ;
+ *  - AS_FLUSH_CACHE : if set to 1, flush the caches between runs ;
+ *  - AS_PIN_CORES : list of cores to pin to, for example "0-3,8" ;
+ *  - AS_MEASURE_ENERGY : if set to 1, measure the energy consumed by the runs ;
+ *  - AS_MEASURE_COUNTERS : if set to 1, read the hardware counters of the runs
+ *    (see perf_counters), with the raw events given by AS_PERF_EVENTS.
+ *
+ * The energy is read from the RAPL counters of the packages (Linux powercap,
+ * /sys/class/powercap/intel-rapl:N/energy_uj), before and after the timed runs,
+ * so it includes the cache flushes, and the start of the wrapper for measure_batch().
+ * The hardware counters only count the runs for measure(), and include the start
+ * of the wrapper for measure_batch().
+ */
+class measurement_harness
+{
+private:
+    /**
+     * The buffer written to flush the caches (allocated on first use).
+     */
+    std::vector<char> flush_buffer;
+
+    /**
+     * True once the calling thread has been pinned.
+     */
+    bool pinned = false;
+
+    /**
+     * The hardware counters (opened on first use).
+     */
+    std::shared_ptr<perf_counters> counters;
+
+protected:
+    /**
+     * Time, in ms, of the calibration workload.
+     */
+    static double time_calibration_workload();
+
+    /**
+     * Pin the calling thread to pinned_cores (done once).
+     */
+    void pin_to_cores();
+
+    /**
+     * Return the RAPL energy counter (in uJ) of each package, with the value at which
+     * it wraps around. Empty if the counters cannot be read.
+     */
+    static std::vector<std::pair<long long, long long>> read_energy_counters();
+
+    /**
+     * Return the energy in mJ consumed by each of the nb_runs runs executed
+     * since counters_before were read, NaN if it is unknown.
+     */
+    static float get_run_energy(std::vector<std::pair<long long, long long>> const& counters_before, int nb_runs);
+
+public:
+    int nb_warmups = DEFAULT_NB_WARMUPS;
+    int min_runs = DEFAULT_MIN_RUNS;
+    int max_runs = DEFAULT_MAX_RUNS;
+
+    /**
+     * Relative half-width of the confidence interval at which the repetition stops.
+     * Use 0 to always execute max_runs runs.
+     */
+    float target_confidence = DEFAULT_TARGET_CONFIDENCE;
+
+    float noise_threshold = DEFAULT_NOISE_THRESHOLD;
+    int nb_noise_retries = DEFAULT_NB_NOISE_RETRIES;
+
+    bool flush_cache = false;
+    size_t cache_flush_size = DEFAULT_CACHE_FLUSH_SIZE;
+
+    /**
+     * The cores to pin to. No pinning if empty.
+     */
+    std::vector<int> pinned_cores;
+
+    /**
+     * True if the last measurement was still noisy after all the retries.
+     */
+    bool last_measurement_noisy = false;
+
+    bool measure_energy = false;
+
+    /**
+     * The energy in mJ consumed by one run during the last measurement,
+     * NaN if it was not measured (or if the RAPL counters cannot be read).
+     */
+    float last_energy = std::numeric_limits<float>::quiet_NaN();
+
+    bool measure_counters = false;
+
+    /**
+     * The hardware counters of one run during the last measurement (see perf_counters),
+     * empty if they were not measured.
+     */
+    std::map<std::string, double> last_counters;
+
+    /**
+     * Create a harness with the parameters given by the environment variables.
+     */
+    measurement_harness();
+
+    /**
+     * Measure the given function, that executes the program once and returns 0 on success.
+     * Returns the execution times in ms, or an empty vector if an execution failed.
+     * If timeout is not 0, stops when the cumulated execution time exceeds timeout ms.
+     * timed_out is set to true if the timeout was reached.
+     */
+    std::vector<float> measure(std::function<int()> const& run, float timeout, bool& timed_out);
+
+    /**
+     * Call the given function, that executes all the timed runs itself and returns
+     * their execution times (for example by executing a wrapper), with the noise
+     * detection and the rejection of the outliers.
+     */
+    std::vector<float> measure_batch(std::function<std::vector<float>()> const& run_all);
+
+    /**
+     * Remove the measurements further than 3 median absolute deviations from the median.
+     */
+    static void reject_outliers(std::vector<float>& measurements);
+
+    /**
+     * Return true if the confidence interval of the mean of the measurements
+     * is tight enough (see target_confidence).
+     */
+    bool is_precise_enough(std::vector<float> const& measurements) const;
+
+    /**
+     * Write to a buffer bigger than the last level cache.
+     */
+    void flush_caches();
+
+    /**
+     * Return a prefix to add to a command so that it runs on pinned_cores
+     * (empty if there is no pinning).
+     */
+    std::string get_pinning_cmd_prefix() const;
+
+    /**
+     * Parse a list of cores such as "0-3,8".
+     */
+    static std::vector<int> parse_cores_list(std::string const& cores_list);
+
+    /**
+     * Return the hardware counters, nullptr if measure_counters is false or if
+     * no counter can be read.
+     */
+    perf_counters* get_counters();
+};
+
+}
+
+#endif
@@ -17,9 +17,35 @@ enum optimization_type
     UNROLLING,
     PARALLELIZE,
     SKEWING,
-    SKEWING_POSITIVE // a specialisation of SKEWING optimization
+    SKEWING_POSITIVE, // a specialisation of SKEWING optimization
+    VECTORIZATION,
+    UNROLL_AND_JAM,
+    GPU_MAPPING,
+    THREAD_COARSENING,
+    SHARED_MEMORY_CACHING,
+    DISTRIBUTION,
+    FISSION,
+    UNIMODULAR,
+    LOCAL_TRANSPOSITION,
+    GPU_SPLIT_REDUCTION
 };
 
+/**
+ * The size in bytes of the shared memory that a GPU block can use.
+ */
+const long GPU_SHARED_MEMORY_SIZE = 48 * 1024;
+
+/**
+ * The size in bytes of a cache line : an innermost stride of at least a cache line
+ * makes an access cache-hostile.
+ */
+const int CACHE_LINE_SIZE = 64;
+
+/**
+ * The largest panel copied by LOCAL_TRANSPOSITION, in bytes (it should fit the L1 cache).
+ */
+const long LOCAL_TRANSPOSITION_MAX_SIZE = 32 * 1024;
+
 /**
  * Stores information about an optimization.
  * Check the function apply_optimizations() to see how this structure is used.
@@ -54,12 +80,49 @@ struct optimization_info
      * nb_l indicates the number of loop levels to consider.
      *
      * 1. In the case of unrolling, if l0 == -1, unrolling is applied
-     * on all innermost levels.
+     * on all innermost levels. In the case of vectorization, l0 is the
+     * vectorized level and l0_fact is the vector length, and l1_fact is 1 if the
+     * loop is peeled for alignment (see computation::vectorize_aligned()). In the case of
+     * unroll-and-jam, l0 is the unrolled level and l0_fact the unrolling factor.
      *
      * 2. In the case of fusion, l0 and l1 will contain the indices
      * of the two nodes to fuse, in the tree level to which "node" belongs to.
+     * If l0_fact is not 0, the computations of the second node (comps) are shifted
+     * by l0_fact along the fused level l2 before being fused (see
+     * function::fuse_with_shifting()).
+     *
+     * 3. In the case of GPU mapping, l0 and l1 are the levels mapped to GPU blocks
+     * and threads, and l0_fact, l1_fact the size of the thread blocks. In the case
+     * of thread coarsening, l0 and l1 are the mapped levels, and l0_fact, l1_fact
+     * the number of points computed by a thread along each of them. In the case of
+     * shared memory caching, l0 is the index of the cached access in the accesses
+     * of comps[0].
+     *
+     * 4. In the case of distribution, l0 is the distributed level (the outermost
+     * level of all the computations), l0_fact the number of ranks, and l1_fact
+     * the number of iterations of the block of a rank.
+     *
+     * 5. In the case of fission, node is the loop whose body is split, l0 is the outermost
+     * distributed level, and l1 the index in node->computations of the first computation
+     * moved to the new loop nest. comps are the moved computations : the computations of
+     * node from l1, and the computations of its children.
+     *
+     * 6. In the case of a unimodular transformation, l0 is the outermost transformed
+     * level, nb_l the number of transformed levels, and matrix the transformation
+     * (see computation::unimodular_transform()).
+     *
+     * 7. In the case of a local transposition, l0 is the index of the transposed access
+     * in the accesses of comps[0] (see get_local_transposition()).
+     *
+     * 8. In the case of a GPU split reduction, l0 is the reduction level split across
+     * the GPU blocks, l0_fact the number of iterations of a chunk and l1_fact the number
+     * of chunks (see computation::gpu_split_reduction()).
+     *
+     * 9. In the case of parallelization, l0 is the parallelized level. If nb_l is 2,
+     * l0 and l1 = l0 + 1 are collapsed into l0 before being parallelized
+     * (see computation::collapse()).
      */
-    int l0, l1, l2;
+    int l0 = 0, l1 = 0, l2 = 0;
     
     /**
      * Contains the factors of each loop level.
@@ -67,8 +130,68 @@ struct optimization_info
      * l0_fact and l1_fact will contain the tiling factors for each loop level.
      */
     int l0_fact = 0, l1_fact = 0, l2_fact = 0, l3_fact = 0;
+
+    /**
+     * The nb_l x nb_l matrix of a unimodular transformation.
+     */
+    std::vector<std::vector<int>> matrix;
+};
+
+/**
+ * The part of an input read by a GPU block, that is copied to shared memory
+ * by the optimization SHARED_MEMORY_CACHING (see computation::cache_shared()).
+ */
+struct shared_memory_footprint
+{
+    /**
+     * The name of the cached input.
+     */
+    std::string input_name;
+
+    /**
+     * The shape of the shared buffer.
+     */
+    std::vector<int> shape;
+
+    /**
+     * The first element read by a block, in function of the block iterators.
+     */
+    std::vector<tiramisu::expr> offsets;
+
+    /**
+     * The thread level before which the copy is done.
+     */
+    std::string copy_level;
+
+    /**
+     * Size of the shared buffer in bytes.
+     */
+    long size;
 };
 
+/**
+ * Compute the part of the input accessed by the access access_index of comp
+ * that is read by a GPU block, given the GPU mapping of comp in the AST.
+ * Return false if this part cannot be cached in shared memory : the input is computed
+ * by the mapped loops, its accesses are not translations of each other, the part does
+ * not fit in GPU_SHARED_MEMORY_SIZE, or its elements are not read several times.
+ */
+bool get_shared_memory_footprint(syntax_tree const& ast, tiramisu::computation *comp,
+                                 int access_index, shared_memory_footprint& footprint);
+
+/**
+ * Check that the access access_index of comp reads its producer column-wise in the
+ * innermost loop of comp in the AST : the innermost loop moves along an outer dimension
+ * of the producer, but not along its last dimension. If so, set input_name to the
+ * producer, and level to the loop level at which a transposed panel of the producer
+ * is copied : the outermost level whose inner loops have constant bounds and read
+ * at most LOCAL_TRANSPOSITION_MAX_SIZE bytes, with at least two loops inside.
+ * Return false if the access is not cache-hostile, if the producer is computed in
+ * the loop nest of comp, or if there is no such level.
+ */
+bool get_local_transposition(syntax_tree const& ast, tiramisu::computation *comp, int access_index,
+                             std::string& input_name, int& level);
+
 /**
  * Tag the outermost level of each computation to be parallelized.
  */
@@ -110,6 +233,41 @@ void apply_parallelization(syntax_tree const& ast);
  */
     void apply_parallelization(ast_node *node);
 
+/**
+ * Copy to shared memory the inputs chosen with SHARED_MEMORY_CACHING.
+ * The copies are scheduled relatively to the computations, so this is done
+ * once the computations are ordered.
+ */
+void apply_shared_memory_caching(syntax_tree const& ast);
+
+/**
+ * Copy the producers chosen with LOCAL_TRANSPOSITION to transposed panels (see
+ * computation::transpose_operand()), if the stride of their accesses in the
+ * innermost loop of the scheduled computations (see computation::get_access_stride())
+ * is at least a cache line. Like apply_shared_memory_caching(), this is done once
+ * the computations are ordered.
+ */
+void apply_local_transpositions(syntax_tree const& ast);
+
+/**
+ * Distribute the computations split by DISTRIBUTION (see apply_optimizations()) : tag
+ * the loops over the ranks, and split and tag the inputs whose outermost dimension has
+ * the same extent, so that the inputs are partitioned like the computations.
+ *
+ * apply_optimizations() only splits the distributed levels, so that the evaluators can
+ * run the program on a single node. To generate the distributed program, call this
+ * function after apply_optimizations() : if generate_communication is true, the loops
+ * over the ranks are also dropped from the accesses, the buffers are resized to the
+ * blocks of the ranks, and gen_communication() is called on the computations.
+ */
+void apply_distribution(syntax_tree const& ast, bool generate_communication = true);
+
+/**
+ * Get the distribution applied to the computations of the AST.
+ * Return false if the program is not distributed.
+ */
+bool get_distribution(syntax_tree const& ast, optimization_info& distribution);
+
 /**
  * Prints the optimization information
  */
@@ -0,0 +1,135 @@
+#ifndef _TIRAMISU_AUTO_SCHEDULER_ROOFLINE_
+#define _TIRAMISU_AUTO_SCHEDULER_ROOFLINE_
+
+#include <string>
+#include <vector>
+
+#include "ast.h"
+
+namespace tiramisu::auto_scheduler
+{
+
+/**
+ * The peak performance of the target machine, in GFLOP/s, and its memory
+ * bandwidth, in GB/s, used when they are not given to roofline_analysis.
+ */
+const double DEFAULT_PEAK_GFLOPS = 100;
+const double DEFAULT_MEMORY_BANDWIDTH = 20;
+
+/**
+ * The cost of one iteration of a loop level of a computation : the operations
+ * of the loops nested in it and the data they touch.
+ */
+struct roofline_level
+{
+    int depth;
+    std::string iterator;
+
+    /**
+     * Floating point operations of one iteration of the loop level.
+     */
+    double flops;
+
+    /**
+     * Bytes touched by one iteration of the loop level, i.e. its working set.
+     */
+    double footprint;
+
+    double arithmetic_intensity;
+};
+
+struct roofline_computation
+{
+    std::string name;
+
+    /**
+     * Floating point operations of the whole computation.
+     */
+    double flops;
+
+    /**
+     * Bytes touched by the whole computation, i.e. the compulsory traffic
+     * with the memory.
+     */
+    double footprint;
+
+    double arithmetic_intensity;
+
+    /**
+     * The cost of an iteration of each loop level, from the outermost.
+     */
+    std::vector<roofline_level> levels;
+};
+
+/**
+ * Estimates the arithmetic intensity of the computations of a program
+ * from their iteration domains and their access matrices (see
+ * computation_info), and compares it with the roofline of the target
+ * machine : a computation whose arithmetic intensity is lower than
+ * peak_gflops / memory_bandwidth is bound by the memory bandwidth, and
+ * should be optimized for locality rather than for compute.
+ *
+ * The data touched by a set of accesses to a buffer is estimated by the
+ * bounding box of the accessed elements, so the footprint of sparse or
+ * strided accesses is overestimated.  The levels are those of the
+ * iteration domain of each computation, before the transformations of
+ * its schedule.
+ *
+ * The default machine is given by the environment variables
+ * ROOFLINE_PEAK_GFLOPS and ROOFLINE_MEMORY_BANDWIDTH, or else by the
+ * machine profile of the host (see machine_profile::get_host_profile()).
+ */
+class roofline_analysis
+{
+private:
+
+protected:
+    /**
+     * Estimate the bytes touched by one iteration of the loop level
+     * "depth" (-1 for the whole computation) of "comp".
+     */
+    static double get_footprint(computation_info const& comp, std::vector<int> const& elements_sizes, int depth);
+
+public:
+    double peak_gflops;
+    double memory_bandwidth;
+
+    std::vector<roofline_computation> computations;
+
+    /**
+     * Analyze the computations of "ast".  A negative peak or bandwidth
+     * means the default one.
+     */
+    roofline_analysis(syntax_tree const& ast, double peak_gflops = -1, double memory_bandwidth = -1);
+
+    /**
+     * The performance, in GFLOP/s, attainable with the given arithmetic intensity.
+     */
+    double get_attainable_gflops(double arithmetic_intensity) const;
+
+    bool is_memory_bound(double arithmetic_intensity) const;
+
+    /**
+     * Return the fraction of the attainable performance achieved by the given
+     * computations (e.g. the computations fused in a loop nest) if they
+     * are executed in time_ms ms, or -1 if none of them was analyzed.
+     */
+    double get_efficiency(std::vector<std::string> const& comps, double time_ms) const;
+
+    /**
+     * Print the arithmetic intensity, the footprint and the bound of each computation.
+     */
+    void print() const;
+
+    /**
+     * Print, for each loop nest of the program profiled by the generated code
+     * (see function::enable_profiling()), the performance it achieved and its
+     * distance from the roofline.  "cycles_per_ms" converts the profiled cycles
+     * to milliseconds : the TSC frequency in kHz on x86, 1e6 elsewhere.
+     */
+    void print_with_profile(double cycles_per_ms) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef _TIRAMISU_AUTO_SCHEDULER_SCHEDULE_DATABASE_
+#define _TIRAMISU_AUTO_SCHEDULER_SCHEDULE_DATABASE_
+
+#include <string>
+#include <vector>
+
+#include "ast.h"
+
+namespace tiramisu::auto_scheduler
+{
+
+const int DEFAULT_NB_SEEDS = 3;
+
+/**
+ * A database of the schedules found for previously tuned programs, used to warm-start
+ * the search of a new program with the schedules of the most similar programs.
+ *
+ * A program is identified by two signatures :
+ *  - a structure signature : the shape of the loop nest, and the access matrices of the
+ *    computations (without their constant terms). Only programs with the same structure
+ *    are considered similar ;
+ *  - an extents signature : the log2 of the extents of the loops. Among the programs with
+ *    the same structure, the nearest are the ones with the smallest euclidean distance
+ *    between their extents signatures.
+ *
+ * For example, convolution layers with different shapes have the same structure signature.
+ *
+ * The database is a text file, with one tuned program per line :
+ * STRUCTURE_SIGNATURE|EXTENT EXTENT ...|SCHEDULE
+ * where a SCHEDULE is a list of optimizations separated by ';' (see serialize_schedule()).
+ */
+class schedule_database
+{
+private:
+
+protected:
+    struct entry
+    {
+        std::string structure;
+        std::vector<float> extents;
+        std::string schedule;
+    };
+
+    std::string filename;
+    std::vector<entry> entries;
+
+    static void append_structure_signature(ast_node const *node, std::string& signature, std::vector<float>& extents);
+
+public:
+    /**
+     * Load the database from the given file (the database is empty if the file does not exist).
+     */
+    schedule_database(std::string const& filename);
+
+    /**
+     * Write the database to its file.
+     */
+    void save() const;
+
+    int get_nb_entries() const { return entries.size(); }
+
+    /**
+     * Compute the structure signature and the extents signature of the given AST.
+     */
+    static void get_signatures(syntax_tree const& ast, std::string& structure, std::vector<float>& extents);
+
+    /**
+     * Return a string representation of the given schedule. The computations are stored
+     * by name, and the AST nodes are not stored.
+     */
+    static std::string serialize_schedule(std::vector<optimization_info> const& schedule);
+
+    /**
+     * Parse a schedule given by serialize_schedule(), with the computations of the given AST.
+     * The optimizations that refer to computations that are not in the AST are dropped.
+     * The node of each optimization_info is nullptr : the optimizations must be replayed
+     * (see search_method::replay_schedule()).
+     */
+    static std::vector<optimization_info> deserialize_schedule(std::string const& schedule_str, syntax_tree const& ast);
+
+    /**
+     * Return the schedules of the (at most) nb_schedules nearest tuned programs
+     * that have the same structure as the given AST, from the nearest to the furthest.
+     */
+    std::vector<std::vector<optimization_info>> find_nearest_schedules(syntax_tree const& ast, int nb_schedules) const;
+
+    /**
+     * Record the schedule found for the program of the given AST, replacing the schedule
+     * previously recorded for the same program.
+     */
+    void add_schedule(syntax_tree const& ast, std::vector<optimization_info> const& schedule);
+};
+
+}
+
+#endif
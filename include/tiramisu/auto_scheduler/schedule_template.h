@@ -0,0 +1,191 @@
+#ifndef _TIRAMISU_AUTO_SCHEDULER_SCHEDULE_TEMPLATE_
+#define _TIRAMISU_AUTO_SCHEDULER_SCHEDULE_TEMPLATE_
+
+#include <tiramisu/core.h>
+#include "measurement.h"
+
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace tiramisu::auto_scheduler
+{
+
+const int DEFAULT_TEMPLATE_BUDGET = 50;
+const int DEFAULT_NB_INITIAL_SAMPLES = 8;
+const int DEFAULT_NB_EI_CANDIDATES = 2000;
+const int DEFAULT_HALVING_ETA = 3;
+
+/**
+ * The method used by schedule_template::tune() :
+ *  - BAYESIAN_OPTIMIZATION : a gaussian process models the logarithm of the execution
+ *    time as a function of the knobs (the positions of their values, normalized to [0, 1]).
+ *    After DEFAULT_NB_INITIAL_SAMPLES random configurations, the configuration that maximizes
+ *    the expected improvement over the best time is measured next.
+ *  - SUCCESSIVE_HALVING : the budget is spent on random configurations, measured with a
+ *    single run ; the best 1/DEFAULT_HALVING_ETA of them are measured again with
+ *    DEFAULT_HALVING_ETA times more runs, and so on until one configuration remains.
+ *  - EXHAUSTIVE_SEARCH : all the configurations, in order, up to the budget.
+ */
+enum template_tuning_method
+{
+    BAYESIAN_OPTIMIZATION,
+    SUCCESSIVE_HALVING,
+    EXHAUSTIVE_SEARCH
+};
+
+/**
+ * A schedule written by hand whose parameters (tile sizes, unroll factors, vector widths,
+ * the level at which two computations are fused ...) are named knobs, tuned on the machine
+ * where the function is compiled.
+ *
+ * The schedule is a callback that calls the scheduling commands with the values of the knobs :
+ * \code
+ * schedule_template sched([&](schedule_template::knob_values const& k) {
+ *     C.tile(i, j, k.at("T0"), k.at("T1"), i0, j0, i1, j1);
+ *     C.vectorize(j1, k.at("V"));
+ *     C2.after(C, k.at("FUSION_LEVEL"));
+ * });
+ * sched.add_knob("T0", {16, 32, 64, 128});
+ * sched.add_knob("T1", {16, 32, 64, 128});
+ * sched.add_knob("V", {4, 8, 16});
+ * sched.add_knob("FUSION_LEVEL", {computation::root_dimension, 0, 1});
+ *
+ * if (!sched.apply_schedule_file("matmul.sched"))
+ * {
+ *     sched.tune({&b_A, &b_B, &b_C});
+ *     sched.save_schedule_file("matmul.sched");
+ * }
+ * tiramisu::codegen({&b_A, &b_B, &b_C}, "matmul.o");
+ * \endcode
+ *
+ * Each configuration is applied on the schedules of the function reset with
+ * function::reset_schedules(), JIT-compiled with function::jit() (a configuration that
+ * gives the same schedules as a configuration already measured is not compiled again)
+ * and measured in the process by a measurement_harness, with buffers allocated from the
+ * constant extents of the arguments. The callback must thus not call the commands that
+ * create computations or buffers (e.g. cache_shared_operation()), that are not undone.
+ *
+ * The tuned schedule is saved with function::save_schedule_file(), followed by a line
+ * "knob NAME VALUE" per knob : function::apply_schedule_file() ignores these lines and
+ * applies the schedule itself, while schedule_template::apply_schedule_file() applies the
+ * template with the saved values, so a schedule file can be produced per machine.
+ */
+class schedule_template
+{
+public:
+    typedef std::map<std::string, int> knob_values;
+    typedef std::function<void(knob_values const&)> schedule_function;
+
+private:
+
+protected:
+    tiramisu::function *fct;
+    schedule_function apply_schedule;
+
+    /**
+     * The name and the possible values of each knob, in the order of add_knob().
+     */
+    std::vector<std::pair<std::string, std::vector<int>>> knobs;
+
+    /**
+     * The configurations measured by the last call to tune(), with their
+     * execution time in ms (infinity if the compilation failed).
+     */
+    std::vector<std::pair<knob_values, float>> explored;
+
+    knob_values best_values;
+    float best_time = std::numeric_limits<float>::infinity();
+
+    measurement_harness harness;
+
+    /**
+     * Return the configuration made of the value number indices[i] of each knob.
+     */
+    knob_values get_configuration(std::vector<int> const& indices) const;
+
+    /**
+     * Return the total number of configurations.
+     */
+    long get_nb_configurations() const;
+
+    /**
+     * Apply the configuration, JIT-compile the function and return its execution
+     * times in ms, executed with between min_runs and max_runs runs.
+     * Return {infinity} if the compilation or an execution failed.
+     */
+    std::vector<float> measure(knob_values const& values, std::vector<const void*> const& args, int min_runs, int max_runs);
+
+    void tune_bayesian(std::vector<const void*> const& args, int budget, unsigned int seed);
+    void tune_successive_halving(std::vector<const void*> const& args, int budget, unsigned int seed);
+    void tune_exhaustive(std::vector<const void*> const& args, int budget);
+
+public:
+    schedule_template(schedule_function const& apply_schedule,
+                      tiramisu::function *fct = tiramisu::global::get_implicit_function());
+
+    /**
+     * Add the knob name, that takes one of the given values. The values of numeric
+     * knobs (e.g. tile sizes) should be sorted, since the gaussian process assumes
+     * that close values give close execution times.
+     */
+    void add_knob(std::string const& name, std::vector<int> const& values);
+
+    /**
+     * Add the knob name, that takes the powers of two between min_value and max_value.
+     */
+    void add_power_of_two_knob(std::string const& name, int min_value, int max_value);
+
+    std::vector<std::pair<std::string, std::vector<int>>> const& get_knobs() const { return knobs; }
+
+    /**
+     * Reset the schedules of the function, and apply the template with the given values
+     * (the knobs that are not given take their first value).
+     */
+    void apply(knob_values const& values);
+
+    /**
+     * Measure at most budget configurations with the given method, and apply the fastest one.
+     * arguments are the arguments of the function : all of them must have constant extents.
+     * Return the values of the knobs of the fastest configuration.
+     */
+    knob_values tune(std::vector<tiramisu::buffer*> const& arguments,
+                     template_tuning_method method = BAYESIAN_OPTIMIZATION,
+                     int budget = DEFAULT_TEMPLATE_BUDGET, unsigned int seed = 0);
+
+    knob_values const& get_best_values() const { return best_values; }
+
+    /**
+     * The execution time in ms of the fastest configuration found by tune().
+     */
+    float get_best_time() const { return best_time; }
+
+    std::vector<std::pair<knob_values, float>> const& get_explored_configurations() const { return explored; }
+
+    measurement_harness& get_measurement_harness() { return harness; }
+
+    /**
+     * Apply the template with the values of the knobs found by tune() (or with the given
+     * values), and save the schedule of the function and the values of the knobs in filename.
+     */
+    void save_schedule_file(std::string const& filename);
+    void save_schedule_file(std::string const& filename, knob_values const& values);
+
+    /**
+     * Read the values of the knobs saved in filename. Return false if the file cannot be read
+     * or does not give a value to every knob.
+     */
+    bool load_knob_values(std::string const& filename, knob_values& values) const;
+
+    /**
+     * Apply the template with the values of the knobs saved in filename. Return false, without
+     * changing the schedules, if the file cannot be read or does not give a value to every knob.
+     */
+    bool apply_schedule_file(std::string const& filename);
+};
+
+}
+
+#endif
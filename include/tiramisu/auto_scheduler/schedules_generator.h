@@ -3,6 +3,12 @@
 
 #include "ast.h"
 #include "evaluator.h"
+#include "legality_oracle.h"
+#include "machine_profile.h"
+
+#include <memory>
+#include <string>
+#include <unordered_set>
 
 namespace tiramisu::auto_scheduler
 {
@@ -10,8 +16,191 @@ namespace tiramisu::auto_scheduler
 const std::vector<int> TILING_FACTORS_DEFAULT_LIST = {32, 64, 128};
 const std::vector<int> UNROLLING_FACTORS_DEFAULT_LIST = {4, 8, 16};
 const std::vector<std::tuple<int,int>> SKEWING_FACTORS_DEFAULT_LIST = {{1,1}, {1,2}, {2,1}};
+const std::vector<int> VECTORIZATION_FACTORS_DEFAULT_LIST = {4, 8, 16};
 const int DEFAULT_MAX_NB_ITERATORS = 7;
 
+/**
+ * Sizes of the GPU thread blocks (along the outer and the inner mapped levels),
+ * and number of points computed by a thread with thread coarsening.
+ * The inner level is mapped to consecutive threads, so its size is a multiple of the warp size.
+ */
+const std::vector<std::tuple<int,int>> GPU_BLOCK_SIZES_DEFAULT_LIST = {{8, 32}, {16, 32}, {4, 64}, {2, 128}};
+const std::vector<std::tuple<int,int>> THREAD_COARSENING_FACTORS_DEFAULT_LIST = {{2, 1}, {4, 1}, {1, 2}, {2, 2}};
+
+/**
+ * Numbers of GPU blocks between which a reduction loop is split (see GPU_SPLIT_REDUCTION),
+ * and the smallest number of iterations of a chunk.
+ */
+const std::vector<int> GPU_SPLIT_REDUCTION_FACTORS_DEFAULT_LIST = {4, 16, 64};
+const int GPU_SPLIT_REDUCTION_MIN_CHUNK = 32;
+
+/**
+ * Sizes in bytes of the L1, L2 and L3 caches used by tile_size_explorer,
+ * when there is no machine profile (see machine_profile::get_host_profile()).
+ */
+const std::vector<long> CACHE_SIZES_DEFAULT_LIST = {32 * 1024, 1024 * 1024, 16 * 1024 * 1024};
+const int DEFAULT_NB_TILE_SIZES_PER_CACHE_LEVEL = 2;
+const int DEFAULT_MIN_TILE_SIZE = 4;
+
+/**
+ * Propose tile sizes for a band of loops, such as the data accessed by a tile
+ * (its footprint) fits in one of the caches of the target machine.
+ *
+ * The footprint of a tile is computed from the access matrices of the computations
+ * of the band (see computation_info::accesses). For each cache level (L1, L2, L3),
+ * the explorer keeps the few tile sizes with the biggest footprint that still fits
+ * in the cache. The candidate sizes of a loop are its divisors and the powers of two
+ * smaller than its extent, so non-power-of-two sizes can be proposed.
+ *
+ * The proposals are then evaluated by the search method (e.g. with the ML model),
+ * which replaces the enumeration of the fixed list of tiling factors.
+ */
+class tile_size_explorer
+{
+private:
+
+protected:
+    /**
+     * Sizes in bytes of the caches, from the smallest to the biggest.
+     */
+    std::vector<long> cache_sizes;
+
+    /**
+     * Number of tile sizes proposed for each cache level.
+     */
+    int nb_tile_sizes_per_level;
+
+    /**
+     * Tile sizes smaller than this value are not proposed.
+     */
+    int min_tile_size;
+
+    /**
+     * Return the candidate tile sizes for a loop with the given extent.
+     */
+    std::vector<int> get_candidate_sizes(int extent) const;
+
+public:
+    tile_size_explorer(std::vector<long> const& cache_sizes = get_default_cache_sizes(),
+                       int nb_tile_sizes_per_level = DEFAULT_NB_TILE_SIZES_PER_CACHE_LEVEL,
+                       int min_tile_size = DEFAULT_MIN_TILE_SIZE)
+
+        : cache_sizes(cache_sizes), nb_tile_sizes_per_level(nb_tile_sizes_per_level),
+          min_tile_size(min_tile_size) {}
+
+    /**
+     * Return the number of bytes accessed by one tile, when the loops
+     * node, node->children[0], ... are tiled with the given sizes.
+     * Loops outside the band count for one iteration, and loops inside
+     * the band count for their whole extent.
+     */
+    static long get_tile_footprint(ast_node *node, std::vector<int> const& tile_sizes);
+
+    /**
+     * Return the tile sizes proposed to tile the "nb_tiled_loops" loops
+     * starting from "node". Each proposal contains one size per tiled loop.
+     */
+    std::vector<std::vector<int>> explore_tile_sizes(ast_node *node, int nb_tiled_loops) const;
+};
+
+const float DEFAULT_PRUNING_AGGRESSIVENESS = 0.5;
+const long DEFAULT_MIN_PARALLEL_ITERATIONS = 16 * 1024;
+
+/**
+ * Drop the obviously bad schedules proposed by a schedules_generator, before
+ * they are evaluated by the search method. The rules are analytic :
+ * - a tiling is pruned if one of its tiles is not smaller than its loop, or if
+ *   the footprint of a tile (see tile_size_explorer::get_tile_footprint()) is
+ *   bigger than the biggest cache divided by the aggressiveness,
+ * - a parallelization is pruned if the parallel loop encloses less than
+ *   aggressiveness * min_parallel_iterations iterations,
+ * - an unrolling, an unroll-and-jam or a vectorization is pruned if its factor
+ *   is bigger than the extent of its loop,
+ * - a parallelization or a vectorization is pruned if its loop is a reduction
+ *   level of the computations it encloses (see ast_node::is_reduction_level()).
+ * The aggressiveness is between 0 and 1, no schedule is pruned if it is 0.
+ *
+ * A classifier can also be given (e.g. a small model trained to predict if a
+ * schedule is faster than its parent, see utils/speedup_model) : the schedules
+ * that pass the rules are evaluated by the classifier in one batch, and those
+ * whose predicted speedup is below min_predicted_speedup are pruned (the best
+ * one is always kept).
+ *
+ * \code
+ * candidate_pruner pruner(0.8);
+ * scheds_gen.set_candidate_pruner(&pruner);
+ * \endcode
+ */
+class candidate_pruner
+{
+private:
+
+protected:
+    float aggressiveness;
+
+    /**
+     * Sizes in bytes of the caches, from the smallest to the biggest.
+     */
+    std::vector<long> cache_sizes;
+
+    long min_parallel_iterations;
+
+    evaluation_function *classifier = nullptr;
+    float min_predicted_speedup = 1;
+
+    int nb_candidates = 0;
+    int nb_pruned_by_rules = 0;
+    int nb_pruned_by_classifier = 0;
+
+    /**
+     * Return true if the last optimization of new_optims of the given AST
+     * is pruned by the analytic rules.
+     */
+    bool is_pruned_by_rules(syntax_tree const& ast) const;
+
+public:
+    candidate_pruner(float aggressiveness = DEFAULT_PRUNING_AGGRESSIVENESS,
+                     std::vector<long> const& cache_sizes = get_default_cache_sizes(),
+                     long min_parallel_iterations = DEFAULT_MIN_PARALLEL_ITERATIONS)
+
+        : aggressiveness(aggressiveness), cache_sizes(cache_sizes),
+          min_parallel_iterations(min_parallel_iterations) {}
+
+    void set_aggressiveness(float aggressiveness) { this->aggressiveness = aggressiveness; }
+    float get_aggressiveness() const { return aggressiveness; }
+
+    /**
+     * Use the given evaluation function to prune the schedules. As with the
+     * speedup models, the evaluation must be the opposite of the speedup.
+     */
+    void set_classifier(evaluation_function *classifier, float min_predicted_speedup = 1)
+    {
+        this->classifier = classifier;
+        this->min_predicted_speedup = min_predicted_speedup;
+    }
+
+    /**
+     * Remove (and delete) the pruned schedules from the given list.
+     * The schedules have not been transformed yet (see syntax_tree::transform_ast()).
+     */
+    void prune(std::vector<syntax_tree*>& candidates);
+
+    int get_nb_candidates() const { return nb_candidates; }
+    int get_nb_pruned() const { return nb_pruned_by_rules + nb_pruned_by_classifier; }
+
+    /**
+     * Return a JSON object with the number of candidates and of pruned candidates.
+     */
+    std::string get_stats_json() const;
+
+    void reset_stats()
+    {
+        nb_candidates = 0;
+        nb_pruned_by_rules = 0;
+        nb_pruned_by_classifier = 0;
+    }
+};
+
 /**
  * Generate a set of AST's from a given AST.
  * Inherit this class to implement a new way to generate schedules.
@@ -36,6 +225,11 @@ protected:
      */
     std::vector<std::tuple<int,int>> skewing_factors_list;
 
+    /**
+     * A list of vector lengths to apply when vectorization is applied.
+     */
+    std::vector<int> vectorization_factors_list;
+
     /**
      * Max Number of dimension to explore for unrolling, starting from the innermost loop level,
     */
@@ -48,7 +242,13 @@ protected:
     int parallelism_search_depth = 3;
 
     /**
-     * Max Number of dimension to explore for unrolling, starting from the innermost loop level
+     * A parallel level of fewer iterations is also proposed collapsed with the
+     * next level (see computation::collapse()), so that all the cores get work.
+     */
+    int parallel_collapse_max_extent = 64;
+
+    /**
+     * Max Number of dimension to explore for vectorization, starting from the innermost loop level
     */
     int vectorization_search_depth = 3;
 
@@ -57,16 +257,137 @@ protected:
     */
     int skewing_inner_parallelism_number = 3;
 
+    /**
+     * The largest skewing coefficient of the unimodular transformations, the number
+     * of transformations proposed for a band, and the maximum number of levels of a band.
+     */
+    int unimodular_max_coefficient = 1;
+    int unimodular_solutions_number = 3;
+    int unimodular_max_depth = 4;
+
+    /**
+     * The legality oracle of the function of the last AST, used to search
+     * the unimodular transformations.
+     */
+    std::shared_ptr<legality_oracle> oracle;
+    tiramisu::function *oracle_function = nullptr;
+
+    /**
+     * If not null, used to propose the tiling factors instead of tiling_factors_list.
+     */
+    tile_size_explorer *tile_explorer = nullptr;
+
+    /**
+     * True if the schedules are generated for a GPU (see set_gpu_target()).
+     */
+    bool gpu_target = false;
+
+    /**
+     * A list of thread block sizes to apply when GPU mapping is applied.
+     */
+    std::vector<std::tuple<int,int>> gpu_block_sizes_list = GPU_BLOCK_SIZES_DEFAULT_LIST;
+
+    /**
+     * A list of factors to apply when thread coarsening is applied.
+     */
+    std::vector<std::tuple<int,int>> thread_coarsening_factors_list = THREAD_COARSENING_FACTORS_DEFAULT_LIST;
+
+    /**
+     * A list of numbers of chunks to apply when a GPU reduction is split.
+     */
+    std::vector<int> gpu_split_reduction_factors_list = GPU_SPLIT_REDUCTION_FACTORS_DEFAULT_LIST;
+
+    /**
+     * The number of ranks on which the program can be distributed (see set_distributed_target()).
+     * The program is not distributed if it is 0.
+     */
+    int nb_ranks = 0;
+
+    /**
+     * True if vectorizations that peel the loop for alignment are also proposed
+     * (see set_vectorization_peeling()).
+     */
+    bool vectorization_peeling = false;
+
+    /**
+     * If not null, used to drop the obviously bad schedules before they are returned.
+     */
+    candidate_pruner *pruner = nullptr;
+
+    /**
+     * Give the generated schedules to the pruner, if there is one, and return them.
+     */
+    std::vector<syntax_tree*> prune_schedules(std::vector<syntax_tree*>& states);
+
+    /**
+     * Apply to the given node the unimodular transformations that make the band of
+     * loops it starts fully permutable, so that it can be tiled (see
+     * legality_oracle::find_tiling_transformations()). The bands have at least 3 levels,
+     * 2 levels being handled by SKEWING. If the given node does not start such a band,
+     * call this method recursively on its children.
+     * The dependences of the function must have been computed.
+     */
+    void generate_unimodular_transformations(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast);
 
 public:
     schedules_generator(std::vector<int> const& tiling_factors_list = TILING_FACTORS_DEFAULT_LIST,
                         std::vector<int> const& unrolling_factors_list = UNROLLING_FACTORS_DEFAULT_LIST,
-                        std::vector<std::tuple<int,int>> skewing_factors_list = SKEWING_FACTORS_DEFAULT_LIST)
+                        std::vector<std::tuple<int,int>> skewing_factors_list = SKEWING_FACTORS_DEFAULT_LIST,
+                        std::vector<int> const& vectorization_factors_list = VECTORIZATION_FACTORS_DEFAULT_LIST)
         
-        : tiling_factors_list(tiling_factors_list), unrolling_factors_list(unrolling_factors_list), skewing_factors_list(skewing_factors_list) {}
+        : tiling_factors_list(tiling_factors_list), unrolling_factors_list(unrolling_factors_list), skewing_factors_list(skewing_factors_list),
+          vectorization_factors_list(vectorization_factors_list) {}
 
     virtual ~schedules_generator() {}
 
+    /**
+     * Use the given explorer to choose tiling factors.
+     */
+    void set_tile_size_explorer(tile_size_explorer *explorer) { tile_explorer = explorer; }
+
+    /**
+     * Use the given pruner to drop the obviously bad schedules.
+     */
+    void set_candidate_pruner(candidate_pruner *pruner) { this->pruner = pruner; }
+
+    candidate_pruner* get_candidate_pruner() const { return pruner; }
+
+    /**
+     * Generate schedules for a GPU : the loops are parallelized by GPU_MAPPING,
+     * THREAD_COARSENING and SHARED_MEMORY_CACHING instead of the CPU optimizations.
+     * The GPU optimizations are not generated for CPUs.
+     */
+    void set_gpu_target(bool gpu_target) { this->gpu_target = gpu_target; }
+
+    bool is_gpu_target() const { return gpu_target; }
+
+    /**
+     * Propose the vector lengths of the SIMD units of the given CPU target :
+     * 1, 2 and 4 vector registers of 32-bit elements, e.g. 8, 16 and 32 with
+     * AVX2, 4, 8 and 16 with NEON, 16, 32 and 64 with 512-bit SVE.
+     * Use the target the schedules are evaluated on (see evaluate_by_execution).
+     */
+    void set_cpu_target(Halide::Target const& target);
+
+    /**
+     * Generate schedules that distribute the program on nb_ranks ranks with DISTRIBUTION :
+     * the outermost level of the computations is split into blocks of consecutive iterations,
+     * one per rank. The number of ranks used (and so the size of the blocks) is chosen among
+     * the divisors of nb_ranks. Evaluate the schedules with evaluate_distributed.
+     */
+    void set_distributed_target(int nb_ranks) { this->nb_ranks = nb_ranks; }
+
+    int get_nb_ranks() const { return nb_ranks; }
+
+    /**
+     * Also propose, for each vectorization of a loop that contains a single computation,
+     * the same vectorization after peeling the first iterations of the loop so that the
+     * dominant access starts at an aligned address (see computation::vectorize_aligned()).
+     * These vectorizations have l1_fact = 1. The alignment of the buffers must be set
+     * (see buffer::set_alignment()), otherwise they are the same as the vectorizations.
+     */
+    void set_vectorization_peeling(bool peeling) { vectorization_peeling = peeling; }
+
     /**
      * Given an AST, and an optimization to apply, 
      * generate new ASTs by applying the given optimization.
@@ -76,7 +397,9 @@ public:
 
 /**
  * Generate all combinations of the following optimizations :
- * Fusion, tiling, interchange, unrolling.
+ * Fusion, fission, tiling, interchange, unimodular transformations, unroll-and-jam, unrolling, vectorization.
+ * For GPUs : fusion, GPU mapping, thread coarsening, split reductions, shared memory caching, unrolling.
+ * For distributed programs, distribution is generated before the other optimizations.
  */
 class exhaustive_generator : public schedules_generator
 {
@@ -85,9 +408,28 @@ private:
 protected:
     /**
      * Given a tree level, fuse nodes that have the same name, same lower bounds,
-     * and same upper bounds.
+     * and same upper bounds. The other nodes are fused if shifting the second one
+     * makes the fusion legal (see get_fusion_shift()).
      */
     void generate_fusions(std::vector<ast_node*> const& tree_level, std::vector<syntax_tree*>& states, syntax_tree const& ast);
+
+    /**
+     * Compute the shift of the loop node2 that allows to fuse it with the loop node1
+     * (see function::compute_fusion_shifts()). Return false if the computations of node2
+     * do not all need the same shift, or if no shift makes the fusion legal.
+     * consumers is set to the computations of node2.
+     */
+    bool get_fusion_shift(ast_node *node1, ast_node *node2, syntax_tree const& ast, int& shift,
+                          std::vector<tiramisu::computation*>& consumers);
+
+    /**
+     * Split the body of the given node between two loop nests (loop fission), before each
+     * of its computations but the first, and before its children. The distributed loops
+     * start at the given node or at one of the ancestors that only enclose it, and the
+     * fission must be legal (see function::loop_distribution_is_legal()).
+     * Then call this method recursively on children of the given node.
+     */
+    void generate_fissions(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast);
     
     /**
      * Try to apply tiling such as the given node is the first loop to tile, 
@@ -107,6 +449,57 @@ protected:
      */
     void generate_unrollings(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast);
 
+    /**
+     * Apply unroll-and-jam to the given node if it encloses a perfect loop nest,
+     * and then call this method recursively on children of the given node.
+     */
+    void generate_unroll_and_jams(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast);
+
+    /**
+     * Apply vectorization to the innermost loop levels of the given node
+     * on which it is legal, and then call this method recursively on children of the given node.
+     */
+    void generate_vectorizations(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast);
+
+    /**
+     * Map the given node and its child to GPU blocks and threads if both loops
+     * are parallel, and then call this method recursively on children of the given node.
+     * The levels of a computation are mapped before any other transformation.
+     */
+    void generate_gpu_mappings(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast);
+
+    /**
+     * Apply thread coarsening to the levels mapped to GPU blocks starting from the given node,
+     * and then call this method recursively on children of the given node.
+     */
+    void generate_thread_coarsenings(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast);
+
+    /**
+     * Split across GPU blocks the reduction loop inside the thread levels of a computation
+     * that is alone in its loop nest (see computation::gpu_split_reduction()), when the
+     * loop is long, and then call this method recursively on children of the given node.
+     */
+    void generate_gpu_split_reductions(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast);
+
+    /**
+     * Cache in shared memory an input of a computation mapped to the GPU
+     * (see get_shared_memory_footprint()).
+     */
+    void generate_shared_memory_cachings(std::vector<syntax_tree*>& states, syntax_tree const& ast);
+
+    /**
+     * Copy to a transposed panel the producer of an access that a computation reads
+     * column-wise (see get_local_transposition()). Only generated for CPUs.
+     */
+    void generate_local_transpositions(std::vector<syntax_tree*>& states, syntax_tree const& ast);
+
+    /**
+     * Distribute the outermost level of the computations if it is parallel, and has
+     * the same bounds in all the loop nests (so that the blocks of a consumer and of
+     * its producers match, see computation::gen_communication()).
+     */
+    void generate_distributions(std::vector<syntax_tree*>& states, syntax_tree const& ast);
+
 public:
     exhaustive_generator(std::vector<int> const& tiling_factors_list = TILING_FACTORS_DEFAULT_LIST,
                          std::vector<int> const& unrolling_factors_list = UNROLLING_FACTORS_DEFAULT_LIST)
@@ -118,8 +511,8 @@ public:
 
 /**
  * Generate unfuse applied to shared loop levels.
- * Generate tilings and interchanges applied to shared loop levels.
- * Generate unrollings applied to innermost loop levels.
+ * Generate tilings, interchanges, skewings and unimodular transformations applied to shared loop levels.
+ * Generate unrollings and vectorizations applied to innermost loop levels.
  */
 class ml_model_schedules_generator : public schedules_generator
 {
@@ -142,6 +535,39 @@ public:
     virtual std::vector<syntax_tree*> generate_schedules(syntax_tree const& ast, optimization_type optim);
 };
 
+/**
+ * Generate the schedules of another generator that only transform one loop nest of the
+ * program, or only the schedules that fuse the loop nests (see decomposed_search).
+ * A loop nest is a root of the AST, or the roots created by the fissions of that root.
+ */
+class nest_schedules_generator : public schedules_generator
+{
+private:
+
+protected:
+    /**
+     * The generator that generates the schedules.
+     */
+    schedules_generator *generator;
+
+    /**
+     * The computations of the transformed loop nest. If empty, only the fusions
+     * of the roots of the AST are generated.
+     */
+    std::unordered_set<tiramisu::computation*> nest_comps;
+
+    /**
+     * Return true if all the computations of the tree rooted at the root of node are in nest_comps.
+     */
+    bool is_in_nest(ast_node *node) const;
+
+public:
+    nest_schedules_generator(schedules_generator *generator, std::vector<tiramisu::computation*> const& nest_comps = {})
+        : generator(generator), nest_comps(nest_comps.begin(), nest_comps.end()) {}
+
+    virtual std::vector<syntax_tree*> generate_schedules(syntax_tree const& ast, optimization_type optim);
+};
+
 }
 
 #endif
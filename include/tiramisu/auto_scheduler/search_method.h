@@ -3,6 +3,13 @@
 
 #include <climits>
 #include <cfloat>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <unordered_set>
 
 #include "auto_scheduler.h"
 #include "schedules_generator.h"
@@ -13,10 +20,68 @@ namespace tiramisu::auto_scheduler
 {
 
 //const std::vector<optimization_type> DEFAULT_OPTIMIZATIONS_ORDER = {UNFUSE, INTERCHANGE, SKEWING, PARALLELIZE, TILING};
-const std::vector<optimization_type> DEFAULT_OPTIMIZATIONS_ORDER = {UNFUSE, INTERCHANGE, SKEWING, PARALLELIZE, TILING, UNROLLING};
+const std::vector<optimization_type> DEFAULT_OPTIMIZATIONS_ORDER = {DISTRIBUTION, UNFUSE, FISSION, INTERCHANGE, SKEWING, UNIMODULAR, PARALLELIZE, TILING, GPU_MAPPING, THREAD_COARSENING, GPU_SPLIT_REDUCTION, SHARED_MEMORY_CACHING,
+                                                                     LOCAL_TRANSPOSITION, UNROLL_AND_JAM, UNROLLING, VECTORIZATION};
 const int NB_OPTIMIZATIONS = DEFAULT_OPTIMIZATIONS_ORDER.size();
 const int DEFAULT_MAX_DEPTH = INT_MAX;
 
+/**
+ * When less than this fraction of the budget remains, the beam is narrowed.
+ */
+const float LOW_BUDGET_FRACTION = 0.25;
+
+/**
+ * A schedule of a pareto_front, with its metrics (indexed by schedule_metric).
+ */
+struct pareto_point
+{
+    std::vector<float> metrics;
+    syntax_tree *ast;
+    std::string schedule_str;
+};
+
+/**
+ * The explored schedules that are not dominated by another one : a schedule
+ * dominates another one if none of its metrics (latency, memory footprint,
+ * energy) is worse and one of them is better. The metrics that are unknown
+ * (NaN) for one of the schedules are not compared.
+ *
+ * \code
+ * pareto_front front;
+ * bs->set_pareto_front(&front);
+ * bs->set_constraint(MEMORY_FOOTPRINT, 64 * 1024 * 1024);
+ * \endcode
+ */
+class pareto_front
+{
+private:
+
+protected:
+    std::vector<pareto_point> points;
+
+public:
+    ~pareto_front()
+    {
+        for (pareto_point& point : points)
+            delete point.ast;
+    }
+
+    static bool dominates(std::vector<float> const& a, std::vector<float> const& b);
+
+    /**
+     * If the given schedule is not dominated, add a copy of it to the front and
+     * remove the schedules it dominates. Return true if the schedule was added.
+     */
+    bool insert(syntax_tree& ast, std::vector<float> const& metrics);
+
+    std::vector<pareto_point> const& get_points() const { return points; }
+
+    /**
+     * Return a JSON list with the metrics and the schedule of each point.
+     */
+    std::string get_json() const;
+};
+
 /**
   * An abstract class that represents a search method.
   * Derive this class and give an implementation of
@@ -59,19 +124,202 @@ protected:
      * Not mandatory, can be usefull for some search methods (like MCTS).
      */
     evaluate_by_execution *exec_eval = nullptr;
+
+    /**
+     * The number of worker processes used to compile and execute candidates
+     * in parallel. Each worker is a forked process, and thus owns its own copy
+     * of the tiramisu::function and of the isl_ctx.
+     * The timing runs of the workers are serialized, only the compilation is concurrent.
+     */
+    int nb_workers = 1;
+
+    /**
+     * Compile and execute the given ASTs with the given evaluator, using nb_workers processes.
+     * Returns the measurements of each AST, in the same order as asts.
+     */
+    std::vector<std::vector<float>> parallel_measurements(std::vector<syntax_tree*> const& asts, evaluate_by_execution *evaluator, float schedule_timeout = 0);
+
+    /**
+     * If not empty, the state of the search is saved in this file
+     * every checkpoint_period explored schedules.
+     */
+    std::string checkpoint_filename;
+    int checkpoint_period = DEFAULT_CHECKPOINT_PERIOD;
+
+    /**
+     * The value of nb_explored_schedules at the last checkpoint.
+     */
+    int last_checkpoint = 0;
+
+    /**
+     * Save the evaluation caches of eval_func and exec_eval, and write the progress
+     * of the search (number of explored schedules, best evaluation and best schedule)
+     * to checkpoint_filename.
+     */
+    void checkpoint();
+
+    /**
+     * The budget of the search : a wall-clock time in seconds, and a number of explored schedules.
+     * 0 means no limit. The budget starts when start_budget() is called.
+     */
+    float time_budget = 0;
+    int schedules_budget = 0;
+    std::chrono::steady_clock::time_point budget_start = std::chrono::steady_clock::now();
+
+    /**
+     * True if best_ast is a copy owned by the search method (see update_best_ast()).
+     */
+    bool owns_best_ast = false;
+
+    /**
+     * Return the fraction of the budget that remains, between 0 and 1
+     * (1 if there is no budget).
+     */
+    float get_remaining_budget() const;
+
+    bool budget_exhausted() const { return get_remaining_budget() <= 0; }
+
+    /**
+     * Return the beam size to use given the remaining budget : the given beam size,
+     * narrowed proportionally once less than LOW_BUDGET_FRACTION of the budget remains.
+     */
+    int get_budgeted_beam_size(int beam_size) const;
+
+    /**
+     * If ast is better than best_ast, keep a copy of it in best_ast.
+     * A copy is kept because the search deletes the candidates it does not keep.
+     * If constraints are set, ast is only kept if it satisfies them, and if
+     * there is a Pareto front, ast is added to it.
+     */
+    void update_best_ast(syntax_tree *ast);
+
+    /**
+     * Schedules given to start the search from (see set_seeds()).
+     * The search method takes their ownership.
+     */
+    std::vector<syntax_tree*> seeds;
+
+    /**
+     * If not null, the explored schedules are added to this front by update_best_ast().
+     */
+    pareto_front *front = nullptr;
+
+    /**
+     * The maximal value of each metric (see set_constraint()).
+     */
+    std::vector<float> constraints = std::vector<float>(NB_SCHEDULE_METRICS, FLT_MAX);
+    bool constrained = false;
+
+    /**
+     * Return the metrics of an evaluated AST, indexed by schedule_metric : its evaluation,
+     * its memory footprint and its energy.
+     */
+    std::vector<float> get_metrics(syntax_tree const& ast) const
+    {
+        return {ast.evaluation, ast.get_memory_footprint(), ast.energy};
+    }
+
+    /**
+     * Return true if the metrics satisfy the constraints. A metric that is
+     * unknown (NaN) does not satisfy the constraint set on it.
+     */
+    bool satisfies_constraints(std::vector<float> const& metrics) const;
+
+    /**
+     * Call checkpoint() if checkpoint_period schedules have been explored since the last checkpoint.
+     */
+    void checkpoint_if_needed()
+    {
+        if (!checkpoint_filename.empty() && nb_explored_schedules - last_checkpoint >= checkpoint_period)
+            checkpoint();
+    }
     
 public:
     search_method(evaluation_function *eval_func = nullptr, schedules_generator *scheds_gen = nullptr)
         : eval_func(eval_func), scheds_gen(scheds_gen) {}
             
-    virtual ~search_method() {}
+    virtual ~search_method()
+    {
+        if (owns_best_ast)
+            delete best_ast;
+
+        for (syntax_tree *seed : seeds)
+            delete seed;
+    }
 
     int get_nb_explored_schedules() const { return nb_explored_schedules; }
     float get_best_evaluation() const { return best_evaluation; }
     syntax_tree* get_best_ast() const { return best_ast; }
+    schedules_generator* get_schedules_generator() const { return scheds_gen; }
     
     void set_eval_func(evaluation_function *eval_func) { this->eval_func = eval_func; }
     void set_exec_eval(evaluate_by_execution *exec_eval) { this->exec_eval = exec_eval; }
+    void set_nb_workers(int nb_workers) { this->nb_workers = std::max(nb_workers, 1); }
+
+    /**
+     * Limit the search to time_budget seconds and to schedules_budget explored schedules
+     * (0 means no limit). When the budget runs low, beam searches narrow their beam, and when
+     * it is exhausted, they stop : get_best_ast() then returns the best schedule found so far.
+     */
+    void set_budget(float time_budget, int schedules_budget = 0)
+    {
+        this->time_budget = time_budget;
+        this->schedules_budget = schedules_budget;
+        start_budget();
+    }
+
+    /**
+     * Start counting the budget (called by the auto_scheduler when the search starts).
+     */
+    void start_budget() { budget_start = std::chrono::steady_clock::now(); }
+
+    void set_checkpoint(std::string const& filename, int period = DEFAULT_CHECKPOINT_PERIOD)
+    {
+        checkpoint_filename = filename;
+        checkpoint_period = std::max(period, 1);
+    }
+
+    /**
+     * Give schedules to start the search from, in addition to the initial AST
+     * (for example the schedules of similar programs, see schedule_database).
+     * beam_search adds them to the children of the initial AST. The search method
+     * takes the ownership of the seeds.
+     */
+    void set_seeds(std::vector<syntax_tree*> const& seeds) { this->seeds = seeds; }
+
+    /**
+     * Keep the explored schedules that are not dominated in the given front, to trade
+     * the latency for the memory footprint or the energy.
+     */
+    void set_pareto_front(pareto_front *front) { this->front = front; }
+
+    pareto_front* get_pareto_front() const { return front; }
+
+    /**
+     * Only keep as best schedule the schedules whose metric is not bigger than max_value,
+     * e.g. set_constraint(MEMORY_FOOTPRINT, 64 * 1024 * 1024) to search the fastest
+     * schedule that uses less than 64MB of scratch memory.
+     */
+    void set_constraint(schedule_metric metric, float max_value)
+    {
+        constraints[metric] = max_value;
+        constrained = true;
+    }
+
+    /**
+     * Replay the given schedule on a copy of ast, and return the resulting AST.
+     * The optimizations are applied in the order of DEFAULT_OPTIMIZATIONS_ORDER : each optimization
+     * is replaced by the candidate of the schedules generator that applies to the same loop levels
+     * and computations, with the nearest factors (the factors of a similar program may not be valid
+     * for this one). Optimizations that have no such candidate or that are illegal are skipped.
+     */
+    syntax_tree* replay_schedule(syntax_tree const& ast, std::vector<optimization_info> const& schedule);
+
+    /**
+     * Read the progress saved in a checkpoint file.
+     * Returns false if the file does not exist.
+     */
+    static bool read_checkpoint(std::string const& filename, int& nb_explored_schedules, float& best_evaluation, std::string& best_schedule);
         
     /**
       * The method to call to start a search.
@@ -105,6 +353,18 @@ protected:
      * The maximum depth of the search tree.
      */
     int max_depth;
+
+    /**
+     * The canonical forms of the schedules already evaluated (see
+     * syntax_tree::get_canonical_form()).
+     */
+    std::unordered_set<std::string> evaluated_schedules;
+
+    /**
+     * Delete the children whose schedule is equivalent to a schedule already
+     * evaluated, or to the schedule of a previous child.
+     */
+    void remove_duplicate_schedules(std::vector<syntax_tree*>& children);
     
 public:
     beam_search(int beam_size, int max_depth = DEFAULT_MAX_DEPTH, evaluation_function *eval_func = nullptr, schedules_generator *scheds_gen = nullptr)
@@ -162,6 +422,146 @@ public:
     virtual void search_save(syntax_tree &ast, std::vector<std::string> *schedules_annotations, candidate_trace *parent_trace, float schedule_timeout=0);
 };
 
+const int DEFAULT_NB_MCTS_THREADS = 4;
+const float DEFAULT_MCTS_EXPLORATION = 1.41;
+
+/**
+ * A multi-threaded MCTS, where all the threads share the same search tree.
+ *
+ * Each thread repeatedly :
+ *  - selects a leaf by descending the tree with UCT. The visit and value counters of the
+ *    nodes are atomics, read and updated without locks ;
+ *  - adds a virtual loss (a visit without reward) to the nodes of the path, so that the
+ *    other threads are steered towards other leaves and do not duplicate the rollout ;
+ *  - expands the leaf : the schedules generator gives its children, that are all evaluated
+ *    with a single evaluate_batch() call (one batch message for evaluate_by_learning_model) ;
+ *  - backpropagates the rewards of the children and removes the virtual loss.
+ *
+ * The tiramisu function, its ISL context and the evaluators are not thread-safe, so
+ * expansions and evaluations are serialized by a mutex : threads select and backpropagate
+ * while another thread is expanding a leaf, and a leaf is never expanded twice.
+ *
+ * The reward of a schedule is its speedup over the initial schedule according to eval_func.
+ * At the end, the topk best schedules are executed with exec_eval (if given) to return the best.
+ */
+class parallel_mcts : public search_method
+{
+private:
+
+protected:
+    /**
+     * A node of the shared search tree.
+     */
+    struct tree_node
+    {
+        syntax_tree *ast;
+        tree_node *parent;
+        std::vector<tree_node*> children;
+
+        std::atomic<int> nb_visits{0};
+        std::atomic<int> virtual_loss{0};
+        std::atomic<float> total_reward{0};
+
+        /**
+         * Set once the children of the node have been created (written under the expansion mutex).
+         */
+        std::atomic<bool> expanded{false};
+
+        /**
+         * Set when the subtree of the node cannot be expanded anymore.
+         */
+        std::atomic<bool> exhausted{false};
+
+        tree_node(syntax_tree *ast, tree_node *parent) : ast(ast), parent(parent) {}
+
+        ~tree_node()
+        {
+            for (tree_node *child : children)
+                delete child;
+
+            delete ast;
+        }
+    };
+
+    /**
+     * The number of expansions to do.
+     */
+    int nb_samples;
+
+    /**
+     * The number of schedules to execute at the end of the search.
+     */
+    int topk;
+
+    int max_depth;
+    int nb_threads;
+
+    /**
+     * The exploration constant of UCT.
+     */
+    float exploration;
+
+    /**
+     * The evaluation of the initial schedule, used to compute the rewards.
+     */
+    float initial_evaluation;
+
+    std::mutex expansion_mutex;
+    std::atomic<int> nb_expansions{0};
+    std::atomic<bool> stop_search{false};
+
+    /**
+     * Return the speedup of the given evaluation over the initial evaluation.
+     */
+    float get_reward(float evaluation) const;
+
+    /**
+     * Descend the tree from root with UCT, add a virtual loss to the visited nodes,
+     * and return the selected leaf.
+     */
+    tree_node* select_leaf(tree_node *root);
+
+    /**
+     * Create and evaluate the children of the given leaf, and return their rewards
+     * (empty if the leaf cannot be expanded). Must be called with expansion_mutex held.
+     */
+    std::vector<float> expand(tree_node *leaf);
+
+    /**
+     * Add the given rewards to leaf and its ancestors, and remove the virtual loss of the path.
+     */
+    void backpropagate(tree_node *leaf, std::vector<float> const& rewards);
+
+    /**
+     * The loop executed by each thread.
+     */
+    void worker(tree_node *root);
+
+    /**
+     * Append the nodes of the subtree of node to nodes.
+     */
+    static void collect_nodes(tree_node *node, std::vector<tree_node*>& nodes);
+
+public:
+    parallel_mcts(int nb_samples, int topk, int max_depth = DEFAULT_MAX_DEPTH, int nb_threads = DEFAULT_NB_MCTS_THREADS, 
+                  evaluation_function *eval_func = nullptr, evaluate_by_execution *exec_eval = nullptr, schedules_generator *scheds_gen = nullptr)
+        : search_method(eval_func, scheds_gen), nb_samples(nb_samples), topk(topk), 
+          max_depth(max_depth), nb_threads(std::max(nb_threads, 1)), exploration(DEFAULT_MCTS_EXPLORATION)
+    { set_exec_eval(exec_eval); }
+
+    virtual ~parallel_mcts() {}
+
+    void set_exploration(float exploration) { this->exploration = exploration; }
+
+    virtual void search(syntax_tree& ast);
+
+    /**
+     * Searches for the best schedule and saves the explored schedules and their execution time
+     *
+     */
+    virtual void search_save(syntax_tree &ast, std::vector<std::string> *schedules_annotations, candidate_trace *parent_trace, float schedule_timeout=0);
+};
+
 // ----------------------------------------------------------------------- //
 
 /**
@@ -217,6 +617,52 @@ public:
     void beam_search_subroutine(syntax_tree& ast);
 };
 
+/**
+ * A beam search that scales with the number of loop nests of the program.
+ *
+ * Searching the whole program at once explores the combinations of the optimizations
+ * of all its loop nests. Instead, each loop nest (each root of the AST) is searched by
+ * a beam search that only generates its optimizations (see nest_schedules_generator),
+ * the other loop nests being left as they are. The best schedules of the loop nests are
+ * then replayed together (see replay_schedule()), and a last beam search only explores
+ * the fusions of the loop nests, from that combined schedule.
+ *
+ * The time of the search is then proportional to the number of loop nests. The
+ * candidates of each beam search are evaluated in parallel when several workers are
+ * set (see set_nb_workers()).
+ */
+class decomposed_search : public search_method
+{
+private:
+
+protected:
+    /**
+     * The beam size of the beam searches.
+     */
+    int beam_size;
+
+    /**
+     * The maximum depth of the search tree of each beam search.
+     */
+    int max_depth;
+
+    /**
+     * Search the given AST with a beam search that uses the given generator, and
+     * return a copy of the best AST found (nullptr if none was evaluated).
+     */
+    syntax_tree* search_with(syntax_tree const& ast, schedules_generator *generator);
+
+public:
+    decomposed_search(int beam_size, int max_depth = DEFAULT_MAX_DEPTH, evaluation_function *eval_func = nullptr, schedules_generator *scheds_gen = nullptr)
+        : search_method(eval_func, scheds_gen), beam_size(beam_size), max_depth(max_depth) {}
+
+    virtual ~decomposed_search() {}
+
+    virtual void search(syntax_tree& ast);
+
+    virtual void search_save(syntax_tree &ast, std::vector<std::string> *schedules_annotations, candidate_trace *parent_trace, float schedule_timeout=0);
+};
+
 /**
  * Use this class if you want to assess the accuracy of the model by using beam search.
  * This class performs beam search with the model, and also measures the execution time
@@ -257,6 +703,203 @@ public:
     }
 };
 
+// ----------------------------------------------------------------------- //
+
+const int DEFAULT_POPULATION_SIZE = 32;
+const int DEFAULT_NB_GENERATIONS = 20;
+const int DEFAULT_NB_ELITES = 4;
+const float DEFAULT_MUTATION_RATE = 0.2;
+const float DEFAULT_CROSSOVER_RATE = 0.7;
+const int DEFAULT_TOURNAMENT_SIZE = 3;
+
+/**
+ * Implements an evolutionary (genetic) search.
+ *
+ * An individual is a sequence of genes, one per optimization of DEFAULT_OPTIMIZATIONS_ORDER
+ * (the order is repeated until max_depth genes, or one pass if max_depth is not given).
+ * A gene is either -1 (the optimization is not applied) or the index, modulo the number
+ * of candidates, of the optimization_info to pick among the candidates given by the schedules
+ * generator. An individual is decoded by applying its genes in order to a copy of the initial
+ * AST, illegal optimizations being skipped, so any sequence of genes gives a legal schedule.
+ *
+ * Each generation keeps the nb_elites best individuals, and creates the others by tournament
+ * selection, one-point crossover and mutation. Individuals are evaluated with eval_func
+ * (usually the model), and at the end, the elites are executed with exec_eval (if given)
+ * to return the best schedule.
+ *
+ * Unlike beam search, an optimization choice that looks bad at first (for example not fusing
+ * two loops) can survive and be combined with later optimizations.
+ */
+class evolutionary_search : public search_method
+{
+private:
+
+protected:
+    /**
+     * An individual of the population : its genes, the AST they decode to, and its evaluation.
+     */
+    struct individual
+    {
+        std::vector<int> genes;
+        syntax_tree *ast = nullptr;
+        float evaluation = FLT_MAX;
+    };
+
+    int population_size;
+    int nb_generations;
+    int nb_elites;
+
+    /**
+     * The probability for a gene to be mutated.
+     */
+    float mutation_rate;
+
+    /**
+     * The probability for two parents to be crossed over (they are copied otherwise).
+     */
+    float crossover_rate;
+
+    /**
+     * The number of genes of an individual.
+     */
+    int max_depth;
+
+    std::default_random_engine rand_generator;
+
+    /**
+     * Return a random gene.
+     */
+    int random_gene();
+
+    /**
+     * Apply the given genes to a copy of ast, and return the resulting AST.
+     */
+    syntax_tree* decode(syntax_tree const& ast, std::vector<int> const& genes);
+
+    /**
+     * Decode and evaluate the given individual with eval_func.
+     */
+    void evaluate_individual(syntax_tree const& ast, individual& ind);
+
+    /**
+     * Return the best of DEFAULT_TOURNAMENT_SIZE random individuals of the population.
+     */
+    individual const& tournament_selection(std::vector<individual> const& population);
+
+public:
+    evolutionary_search(int population_size = DEFAULT_POPULATION_SIZE, int nb_generations = DEFAULT_NB_GENERATIONS, int max_depth = NB_OPTIMIZATIONS, 
+                        evaluation_function *eval_func = nullptr, evaluate_by_execution *exec_eval = nullptr, schedules_generator *scheds_gen = nullptr)
+        : search_method(eval_func, scheds_gen), population_size(std::max(population_size, 2)), nb_generations(nb_generations),
+          nb_elites(std::min(DEFAULT_NB_ELITES, population_size)), mutation_rate(DEFAULT_MUTATION_RATE),
+          crossover_rate(DEFAULT_CROSSOVER_RATE), max_depth(std::min(max_depth, 4 * NB_OPTIMIZATIONS))
+    { set_exec_eval(exec_eval); }
+
+    virtual ~evolutionary_search() {}
+
+    void set_nb_elites(int nb_elites) { this->nb_elites = std::max(std::min(nb_elites, population_size), 1); }
+    void set_mutation_rate(float mutation_rate) { this->mutation_rate = mutation_rate; }
+    void set_crossover_rate(float crossover_rate) { this->crossover_rate = crossover_rate; }
+
+    virtual void search(syntax_tree& ast);
+
+    /**
+     * Searches for the best schedule and saves the explored schedules and their execution time
+     *
+     */
+    virtual void search_save(syntax_tree &ast, std::vector<std::string> *schedules_annotations, candidate_trace *parent_trace, float schedule_timeout=0);
+};
+
+// ----------------------------------------------------------------------- //
+
+const int DEFAULT_NB_SAMPLES = 1000;
+const float DEFAULT_OPTIMIZATION_PROBABILITY = 0.5;
+const int DEFAULT_SAMPLES_BATCH_SIZE = 64;
+
+/**
+ * Sample random legal schedules, to collect training data for the cost models.
+ *
+ * Unlike beam search, the schedules are not biased towards the good ones : a sample is
+ * built by going through DEFAULT_OPTIMIZATIONS_ORDER (max_depth steps), and at each step,
+ * the optimization is applied with its probability (see set_optimization_probability()).
+ * The optimization is then drawn among the candidates of the schedules generator, with
+ * probabilities proportional to their weights (see set_candidate_weights(), uniform by
+ * default), and skipped if it is illegal. Only the drawn candidate is transformed and
+ * checked, so sampling is much cheaper than exploring all the candidates. The samples
+ * are all different (the same schedule drawn again is discarded).
+ *
+ * search() evaluates the samples with eval_func (e.g. the model), by batches, and keeps
+ * the JSON of their schedules (see get_samples_json()). search_save() executes them
+ * with exec_eval (with nb_workers processes if set), for sample_search_space().
+ */
+class random_schedule_sampler : public search_method
+{
+private:
+
+protected:
+    int nb_samples;
+    int max_depth;
+
+    std::default_random_engine rand_generator;
+
+    /**
+     * The probability of applying each type of optimization at its step.
+     * DEFAULT_OPTIMIZATION_PROBABILITY for the types that are not given.
+     */
+    std::map<optimization_type, float> optimization_probabilities;
+
+    /**
+     * The weight of a candidate optimization (parameters, loop levels) in the draw.
+     * If not set, the candidates are drawn uniformly.
+     */
+    std::function<float(optimization_info const&)> candidate_weights;
+
+    /**
+     * The JSON of the schedules of the samples, and their evaluations (by eval_func or by execution).
+     */
+    std::vector<std::string> samples_json;
+    std::vector<float> samples_evaluations;
+
+    /**
+     * Return a new random legal schedule of ast, or nullptr if the schedule drawn
+     * was already sampled.
+     */
+    syntax_tree* sample(syntax_tree const& ast, std::unordered_set<std::string>& sampled);
+
+    /**
+     * Draw up to n new samples (fewer if the schedule space is too small or the budget is exhausted).
+     */
+    std::vector<syntax_tree*> sample_batch(syntax_tree const& ast, int n, std::unordered_set<std::string>& sampled);
+
+public:
+    random_schedule_sampler(int nb_samples = DEFAULT_NB_SAMPLES, int max_depth = NB_OPTIMIZATIONS, evaluation_function *eval_func = nullptr,
+                            evaluate_by_execution *exec_eval = nullptr, schedules_generator *scheds_gen = nullptr, unsigned int seed = 0)
+        : search_method(eval_func, scheds_gen), nb_samples(nb_samples), max_depth(max_depth), rand_generator(seed)
+    { set_exec_eval(exec_eval); }
+
+    virtual ~random_schedule_sampler() {}
+
+    /**
+     * Set the probability of applying the optimizations of the given type, between 0 and 1.
+     */
+    void set_optimization_probability(optimization_type type, float probability) { optimization_probabilities[type] = probability; }
+
+    /**
+     * Set the function giving the weight of a candidate in the draw (a weight of 0 excludes it),
+     * for example to prefer the small tiling factors.
+     */
+    void set_candidate_weights(std::function<float(optimization_info const&)> const& weights) { candidate_weights = weights; }
+
+    std::vector<std::string> const& get_samples_json() const { return samples_json; }
+    std::vector<float> const& get_samples_evaluations() const { return samples_evaluations; }
+
+    virtual void search(syntax_tree& ast);
+
+    /**
+     * Execute the samples and save their schedules and execution times.
+     */
+    virtual void search_save(syntax_tree &ast, std::vector<std::string> *schedules_annotations, candidate_trace *parent_trace, float schedule_timeout=0);
+};
+
 }
 
 #endif
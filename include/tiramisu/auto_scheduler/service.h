@@ -0,0 +1,220 @@
+#ifndef _TIRAMISU_AUTO_SCHEDULER_SERVICE_
+#define _TIRAMISU_AUTO_SCHEDULER_SERVICE_
+
+#include "evaluator.h"
+
+#include <map>
+#include <vector>
+#include <sys/types.h>
+
+namespace tiramisu::auto_scheduler
+{
+
+const int DEFAULT_SERVICE_NB_WORKERS = 4;
+
+/**
+ * A job of an autoscheduling_service : a command that builds a Tiramisu
+ * function and autoschedules it (e.g. a compiled generator).
+ */
+struct service_job
+{
+    enum job_state {QUEUED, RUNNING, DONE};
+
+    int id;
+    std::string directory;
+    std::string command;
+
+    job_state state = QUEUED;
+    pid_t pid = -1;
+
+    /**
+     * The worker slot the job runs on, while it is running.
+     */
+    int worker_id = -1;
+
+    int exit_status = 0;
+
+    /**
+     * The best schedule reported by the job (see evaluate_by_service::report_schedule()),
+     * "null" if it did not report one.
+     */
+    std::string schedule = "null";
+
+    /**
+     * The clients waiting for the end of the job.
+     */
+    std::vector<int> waiting_clients;
+};
+
+/**
+ * A long-lived process that autoschedules many programs concurrently.
+ *
+ * Clients submit jobs on a Unix socket. The service runs at most nb_workers jobs
+ * at the same time, each on its own worker slot, and answers the clients
+ * asynchronously when their jobs are done. The jobs share :
+ * - the cost model of the service : they evaluate their schedules with
+ *   evaluate_by_service, whose requests are batched together and given to
+ *   the model of the service, through its evaluation cache,
+ * - the measurements : the jobs measure their schedules one at a time, using
+ *   the lock of the service (see evaluate_by_service::configure_worker()).
+ *
+ * The protocol is line based, one request per line :
+ * - "submit DIRECTORY COMMAND" : run COMMAND in DIRECTORY, answers "job ID",
+ * - "status ID" : answers "queued", "running", "done EXIT_STATUS SCHEDULE" or "unknown",
+ * - "wait ID" : answers "done EXIT_STATUS SCHEDULE" when the job is done,
+ * - "stats" : answers a JSON object with the counters of the service,
+ * - "shutdown" : stops accepting jobs, and stops the service when the submitted jobs are done.
+ * The requests of evaluate_by_service are "evaluate N" followed by N program JSON
+ * and schedule JSON lines, and "result ID SCHEDULE".
+ *
+ * \code
+ * evaluate_by_learning_model model(py_cmd_path, py_cmd_args);
+ * autoscheduling_service service("/tmp/tiramisu_as.sock", &model, 8);
+ * service.run();
+ * \endcode
+ */
+class autoscheduling_service
+{
+private:
+
+protected:
+    std::string socket_path;
+    int listen_fd = -1;
+
+    evaluate_by_learning_model *model;
+    int nb_workers;
+
+    /**
+     * The lock file that serializes the measurements of the jobs.
+     */
+    std::string lock_path;
+
+    std::map<int, service_job> jobs;
+    int next_job_id = 0;
+
+    std::vector<int> free_workers;
+
+    /**
+     * The connected clients, and the data read from them that has not been handled yet.
+     */
+    std::map<int, std::string> clients;
+
+    bool shutting_down = false;
+
+    int nb_evaluated_schedules = 0;
+    int nb_model_batches = 0;
+
+    /**
+     * Handle the complete requests in the buffer of the client. The evaluate
+     * requests are appended to eval_requests, to be given to the model in one batch.
+     */
+    void handle_requests(int client_fd, std::vector<std::pair<int, std::vector<std::pair<std::string, std::string>>>>& eval_requests);
+
+    /**
+     * Handle one request of the client, other than evaluate.
+     */
+    void handle_request(int client_fd, std::string const& request);
+
+    /**
+     * Start the queued jobs on the free workers.
+     */
+    void start_jobs();
+
+    /**
+     * Collect the jobs that have exited, and answer the clients waiting for them.
+     */
+    void collect_jobs();
+
+    std::string get_job_status(service_job const& job) const;
+
+    void send_line(int client_fd, std::string const& line);
+
+public:
+    /**
+     * Listen on the Unix socket socket_path. The model is used to evaluate
+     * the schedules of all the jobs (give it an evaluation cache to share
+     * the predictions between the jobs).
+     */
+    autoscheduling_service(std::string const& socket_path, evaluate_by_learning_model *model,
+                           int nb_workers = DEFAULT_SERVICE_NB_WORKERS);
+
+    ~autoscheduling_service();
+
+    /**
+     * Serve the clients until a shutdown request, and the end of the submitted jobs.
+     * The output of a job is written to as_job_ID.log in its directory.
+     */
+    void run();
+
+    std::string get_stats_json() const;
+};
+
+/**
+ * Evaluate the schedules of a job of an autoscheduling_service with the model of
+ * the service. The socket of the service and the id of the job are given to the
+ * jobs in the environment variables AS_SERVICE_SOCKET and AS_SERVICE_JOB.
+ *
+ * \code
+ * evaluate_by_service model_eval;
+ * model_eval.configure_worker(exec_eval);
+ * ...
+ * as.find_schedule();
+ * model_eval.report_schedule(*bs.get_best_ast());
+ * \endcode
+ */
+class evaluate_by_service : public evaluation_function
+{
+private:
+
+protected:
+    int socket_fd = -1;
+
+    /**
+     * The id of the job in the service, -1 if the process was not started by the service.
+     */
+    int job_id = -1;
+
+    /**
+     * The data read from the service that has not been returned yet.
+     */
+    std::string read_buffer;
+
+    std::string read_line();
+
+public:
+    /**
+     * Connect to the service listening on socket_path, or on AS_SERVICE_SOCKET if empty.
+     */
+    evaluate_by_service(std::string const& socket_path = "");
+
+    virtual ~evaluate_by_service();
+
+    virtual float evaluate(syntax_tree& ast);
+
+    /**
+     * Send all the schedules to the service in one request, and return their evaluations.
+     */
+    virtual std::vector<float> evaluate_batch(std::vector<syntax_tree*> const& asts);
+
+    /**
+     * Measure the schedules on the worker slot given by the service, using its lock
+     * (see evaluate_by_execution::set_worker()).
+     */
+    void configure_worker(evaluate_by_execution& exec_eval) const;
+
+    /**
+     * Send the best schedule found by the job to the service, which gives
+     * it to the clients waiting for the job.
+     */
+    void report_schedule(syntax_tree& best_ast);
+
+    /**
+     * The predictions are cached by the service, so the cache of this evaluator
+     * only avoids the requests.
+     */
+    virtual std::string get_cache_id() const { return "service"; }
+};
+
+}
+
+#endif
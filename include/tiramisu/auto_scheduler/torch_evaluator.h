@@ -0,0 +1,91 @@
+#ifndef _TIRAMISU_AUTO_SCHEDULER_TORCH_EVALUATOR_
+#define _TIRAMISU_AUTO_SCHEDULER_TORCH_EVALUATOR_
+
+#include "evaluator.h"
+
+#include <memory>
+
+namespace torch::jit
+{
+struct Module;
+}
+
+namespace tiramisu::auto_scheduler
+{
+
+const int DEFAULT_TORCH_BATCH_SIZE = 256;
+
+/**
+ * Evaluate schedules with a cost model loaded in the process, instead of
+ * talking to a Python process like evaluate_by_learning_model.  Only
+ * available when Tiramisu is built with USE_TORCH (LibTorch).
+ *
+ * The model is a TorchScript module (saved with torch.jit.save()) whose
+ * forward method takes two lists of 1D float32 tensors, the program features
+ * and the schedule features of each schedule (see
+ * evaluate_by_learning_model::get_program_features() and
+ * get_schedule_features()), and returns a 1D tensor with the predicted
+ * speedup of each schedule:
+ *
+ * \code
+ * def forward(self, programs: List[Tensor], schedules: List[Tensor]) -> Tensor
+ * \endcode
+ *
+ * The features are built from the syntax_tree without JSON, the schedules of
+ * a batch are given to the model in one call (split in calls of at most
+ * max_batch_size schedules), and the model runs on \p device ("cpu", "cuda",
+ * "cuda:1", ...).  As with evaluate_by_learning_model, the evaluation is the
+ * opposite of the speedup.
+ *
+ * \code
+ * evaluate_by_torch_model model_eval("cost_model.pt", "cuda");
+ * \endcode
+ */
+class evaluate_by_torch_model : public evaluation_function
+{
+private:
+
+protected:
+    /**
+     * The path of the TorchScript module, and the device it runs on.
+     */
+    std::string model_path;
+    std::string device;
+
+    std::unique_ptr<torch::jit::Module> module;
+
+    int max_batch_size;
+
+    /**
+     * Run the model on the given ASTs, and return their speedups.
+     */
+    std::vector<float> predict(std::vector<syntax_tree*> const& asts);
+
+public:
+    /**
+     * Load the TorchScript module saved in \p model_path on \p device.
+     */
+    evaluate_by_torch_model(std::string const& model_path, std::string const& device = "cpu",
+                            int max_batch_size = DEFAULT_TORCH_BATCH_SIZE);
+
+    virtual ~evaluate_by_torch_model();
+
+    /**
+     * Run the model on the schedule and return its evaluation.
+     */
+    virtual float evaluate(syntax_tree& ast);
+
+    /**
+     * Run the model on the schedules that are not in the cache, in batches.
+     */
+    virtual std::vector<float> evaluate_batch(std::vector<syntax_tree*> const& asts);
+
+    /**
+     * The path of the model identifies this evaluator.
+     */
+    virtual std::string get_cache_id() const { return "torch:" + model_path; }
+};
+
+}
+
+#endif
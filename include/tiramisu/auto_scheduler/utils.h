@@ -1,6 +1,7 @@
 #ifndef _TIRAMISU_AUTO_SCHEDULER_UTILS_
 #define _TIRAMISU_AUTO_SCHEDULER_UTILS_
 
+#include <map>
 #include <vector>
 #include <regex>
 
@@ -47,6 +48,21 @@ inline std::string measurements_to_str(std::vector<float> measurements)
     return str_array;
 }
 
+/**
+ * Formats hardware counters (see perf_counters) into a JSON object
+ */
+inline std::string counters_to_str(std::map<std::string, double> const& counters)
+{
+    std::string str_object = "{";
+    for (auto const& counter : counters)
+        str_object += " \"" + counter.first + "\" : " + std::to_string(counter.second) + ",";
+    if (!counters.empty())
+        str_object.pop_back(); // remove the last ","
+    str_object += "}";
+
+    return str_object;
+}
+
 /**
  * return an environment variable value if declared, otherwise returns empty string
  * This function is just for reducing code clutter
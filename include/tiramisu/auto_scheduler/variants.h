@@ -0,0 +1,100 @@
+#ifndef _TIRAMISU_AUTO_SCHEDULER_VARIANTS_
+#define _TIRAMISU_AUTO_SCHEDULER_VARIANTS_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace tiramisu::auto_scheduler
+{
+
+/**
+ * A parameter of a function with variants : its runtime value is the extent
+ * of the dimension "dim" (in Tiramisu order, the outermost dimension is 0)
+ * of the argument number "argument_index".
+ */
+struct variant_parameter
+{
+    std::string name;
+    int argument_index;
+    int dim;
+};
+
+/**
+ * Generates a function made of several variants, each tuned for a set of
+ * representative values of the parameters, and of a dispatcher that calls
+ * the right variant given the runtime sizes of the arguments.
+ *
+ * Each variant is generated by a callback given to tune_variants(), that declares
+ * the function for the values of the variant (for example with constants added by
+ * function::add_invariant()), runs the autoscheduler, and generates the object file
+ * of the variant. The callback is executed in a separate process for each variant,
+ * so that the variants do not share the global state of Tiramisu.
+ *
+ * generate_object() then writes the dispatcher (a C++ function that has the signature
+ * of the variants and the name of the function), compiles it, and links it with the
+ * variants into a single object file. The dispatcher calls :
+ *  - the variant tuned for the runtime values of the parameters, if there is one ;
+ *  - otherwise, if the variants are generic (their code is valid for any size, for example
+ *    because their invariants are computed from the sizes of the arguments), the variant
+ *    tuned for the nearest values (with a logarithmic distance) ;
+ *  - otherwise no variant, and it returns -1.
+ *
+ * The dispatcher includes HalideRuntime.h : the environment variable AS_DISPATCHER_FLAGS
+ * can be used to give the compiler flags needed to find it (e.g. "-I/path/to/Halide/include").
+ */
+class variants_generator
+{
+private:
+
+protected:
+    std::string fct_name;
+    int nb_arguments;
+
+    std::vector<variant_parameter> params;
+
+    /**
+     * The values of the parameters of each variant.
+     */
+    std::vector<std::vector<int>> variants_values;
+
+    bool generic_variants;
+
+public:
+    /**
+     * fct_name : the name of the generated function (the variants are named fct_name_v0, fct_name_v1...).
+     * nb_arguments : the number of buffers given to the function.
+     * params : the parameters that select the variant.
+     * variants_values : for each variant, the values of the parameters.
+     * generic_variants : true if the code of each variant is valid for any value of the parameters.
+     */
+    variants_generator(std::string const& fct_name, int nb_arguments, std::vector<variant_parameter> const& params,
+                       std::vector<std::vector<int>> const& variants_values, bool generic_variants = false);
+
+    int get_nb_variants() const { return variants_values.size(); }
+
+    std::string get_variant_name(int variant) const { return fct_name + "_v" + std::to_string(variant); }
+    std::string get_variant_obj_filename(int variant) const { return get_variant_name(variant) + ".o"; }
+
+    /**
+     * Call generate_variant(values, variant_name, obj_filename) for each variant, in a child process.
+     * generate_variant must generate the variant with the given values, named variant_name, in obj_filename,
+     * and return 0 on success. Returns false if a variant could not be generated.
+     */
+    bool tune_variants(std::function<int(std::vector<int> const&, std::string const&, std::string const&)> const& generate_variant) const;
+
+    /**
+     * Return the C++ code of the dispatcher.
+     */
+    std::string get_dispatcher_code() const;
+
+    /**
+     * Compile the dispatcher and link it with the variants into obj_filename.
+     * Returns false if the compilation or the link failed.
+     */
+    bool generate_object(std::string const& obj_filename) const;
+};
+
+}
+
+#endif
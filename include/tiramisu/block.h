@@ -41,6 +41,10 @@ public:
       *
       * The actual order of the computations is not determined by the vector
       * order. It is rather determined by the scheduling commands.
+      *
+      * The block is recorded in the function of its computations (see
+      * function::get_blocks()), so that the auto-scheduler also transforms
+      * the loops of its computations together.
       */
     block(const std::vector<computation *> children);
 
@@ -58,6 +62,10 @@ public:
     void gpu_tile(var L0, var L1, var L2, int sizeX, int sizeY, int sizeZ,
                   var L0_outer, var L1_outer, var L2_outer,
                   var L0_inner, var L1_inner, var L2_inner) override;
+    void gpu_tile(var L0, var L1, int sizeX, int sizeY,
+                  int coarseningX, int coarseningY,
+                  var L0_outer, var L1_outer,
+                  var L0_inner, var L1_inner) override;
     void interchange(var L0, var L1) override;
     void interchange(int L0, int L1) override;
     void parallelize(var L) override;
@@ -78,6 +86,7 @@ public:
     void skew(int i, int j, int a, int b) override;
     void skew(var i, var j, int a, int b, int c, int d, var ni, var nj) override;
     void skew(int i, int j, int a, int b, int c, int d) override;
+    void unimodular_transform(int L, const std::vector<std::vector<int>> &matrix) override;
     void split(var L0, int sizeX) override;
     void split(var L0, int sizeX, var L0_outer, var L0_inner) override;
     void split(int L0, int sizeX) override;
@@ -94,6 +103,9 @@ public:
     void unroll(var L, int fac) override;
     void unroll(var L, int fac, var L_outer, var L_inner) override;
     void unroll(int L, int fac) override;
+    void unroll_and_jam(var L, int fac) override;
+    void unroll_and_jam(var L, int fac, var L_outer, var L_inner) override;
+    void unroll_and_jam(int L, int fac) override;
     void vectorize(var L, int v) override;
     void vectorize(var L, int v, var L_outer, var L_inner) override;
     // @}
@@ -0,0 +1,204 @@
+#ifndef _H_TIRAMISU_CONTRACTION_
+#define _H_TIRAMISU_CONTRACTION_
+
+#include <tiramisu/core.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace tiramisu {
+
+/**
+  * How a contraction computes each product of two tensors
+  * (see contraction::contraction()).
+  */
+enum contraction_lowering_t
+{
+    contraction_auto,      // The fastest lowering according to the cost model
+    contraction_loop_nest, // A loop nest
+    contraction_ttgt       // Transpose-transpose-GEMM-transpose
+};
+
+/**
+  * The machine assumed by the cost model of contractions: the performance
+  * in GFLOP/s of a loop nest and of a large BLAS GEMM, the bandwidth in GB/s
+  * of the copies that transpose the tensors, and the overhead in
+  * microseconds of a library call.
+  */
+const double CONTRACTION_LOOP_GFLOPS = 4;
+const double CONTRACTION_GEMM_GFLOPS = 50;
+const double CONTRACTION_COPY_BANDWIDTH = 10;
+const double CONTRACTION_CALL_OVERHEAD = 2;
+
+/**
+  * The size assumed by the cost model for the dimensions whose size is not
+  * a constant.
+  */
+const int64_t CONTRACTION_DEFAULT_DIM_SIZE = 256;
+
+/**
+  * A tensor contraction written in einsum notation, e.g.
+  *
+  * \code
+  * buffer A("A", {N, K}, p_float32, a_input), B("B", {K, L}, p_float32, a_input);
+  * buffer C("C", {L, M}, p_float32, a_input), D("D", {N, M}, p_float32, a_output);
+  * contraction ABC("ABC", "ik,kl,lj->ij", {&A, &B, &C}, &D);
+  * \endcode
+  *
+  * computes D[i, j] = sum over k and l of A[i, k] * B[k, l] * C[l, j].
+  * Each letter is an index; the letters of an operand are the indices of
+  * the dimensions of its buffer, from the outermost, and the letters that
+  * do not appear in the result are summed over.
+  *
+  * A contraction of several operands is computed as a sequence of products
+  * of two tensors, whose intermediate results are stored in temporary
+  * buffers.  The products are chosen greedily: the next one is the product
+  * that needs the fewest floating point operations (and then the smallest
+  * intermediate result).  Each product is lowered either to a loop nest or
+  * to a transpose-transpose-GEMM-transpose (TTGT): its operands are copied
+  * (if needed) into matrices whose rows and columns are the free and the
+  * summed indices, multiplied by tiramisu_cblas_sgemm (or dgemm, or the
+  * strided batched GEMM if both operands share an index of the result), and
+  * the product is copied into the layout of the result (if needed).  With
+  * contraction_auto, the cost model compares the time of the loop nest with
+  * the time of the GEMM and of the copies (see CONTRACTION_LOOP_GFLOPS).
+  * TTGT is only used for p_float32 and p_float64 operands.
+  *
+  * The computations of the contraction are created in the implicit function
+  * and are ordered one after the other; get_first() and get_last() order them
+  * with the other computations, e.g. init.then(ABC.get_first(), computation::root).
+  */
+class contraction
+{
+private:
+    std::string name;
+
+    /**
+      * The size of the dimensions of each index.
+      */
+    std::map<char, tiramisu::expr> sizes;
+
+    /**
+      * The loop iterator of each index.
+      */
+    std::map<char, tiramisu::var> vars;
+
+    /**
+      * The computations of the contraction, in the order of their execution.
+      */
+    std::vector<tiramisu::computation *> computations;
+
+    /**
+      * The input computations through which the buffers are read.
+      */
+    std::map<tiramisu::buffer *, tiramisu::input *> inputs;
+
+    /**
+      * The temporary buffers of the intermediate results and of the
+      * transposed operands.
+      */
+    std::vector<tiramisu::buffer *> temporaries;
+
+    /**
+      * The estimated number of floating point operations, and a description
+      * of each product for dump().
+      */
+    double flops = 0;
+    std::vector<std::string> products;
+
+protected:
+    /**
+      * A tensor: a buffer and the index of each of its dimensions.
+      */
+    struct tensor
+    {
+        tiramisu::buffer *buf;
+        std::string indices;
+    };
+
+    /**
+      * The size of the dimensions of \p index used by the cost model.
+      */
+    double get_estimated_size(char index) const;
+
+    /**
+      * The product of the estimated sizes of \p indices.
+      */
+    double get_estimated_size(const std::string &indices) const;
+
+    /**
+      * The product of the sizes of \p indices.
+      */
+    tiramisu::expr get_size(const std::string &indices) const;
+
+    /**
+      * Add the computation \p comp to the computations of the contraction,
+      * after the last one.
+      */
+    void add_computation(tiramisu::computation *comp);
+
+    /**
+      * Return an access to the element of \p t at the indices vars[indices].
+      */
+    tiramisu::expr access(const tensor &t);
+
+    /**
+      * Create a temporary buffer whose dimensions have the given indices.
+      */
+    tiramisu::buffer *create_temporary(const std::string &indices, tiramisu::primitive_t type);
+
+    /**
+      * Copy \p t into a tensor whose dimensions are the permutation
+      * \p indices of its dimensions, or into \p destination if it is not NULL.
+      */
+    tensor transpose(const tensor &t, const std::string &indices, tiramisu::buffer *destination = nullptr);
+
+    /**
+      * Compute result = a * b (or result = a if b is NULL), where the indices
+      * of a and b that are not in result are summed over, with a loop nest.
+      */
+    void lower_to_loop_nest(const tensor &a, const tensor *b, const tensor &result);
+
+    /**
+      * Compute result = a * b with a GEMM, if possible; return false otherwise.
+      * \p cost is set to the estimated time in microseconds of the TTGT.
+      */
+    bool lower_to_ttgt(const tensor &a, const tensor &b, const tensor &result, bool dry_run, double &cost);
+
+public:
+    /**
+      * Create the computations that compute the contraction \p spec, in
+      * einsum notation (e.g. "ij,jk->ik"), of the \p operands, and store it
+      * in \p result.  \p lowering selects the lowering of each product.
+      */
+    contraction(const std::string &name, const std::string &spec,
+                const std::vector<tiramisu::buffer *> &operands, tiramisu::buffer *result,
+                contraction_lowering_t lowering = contraction_auto);
+
+    /**
+      * Return the computations of the contraction, in the order of their execution.
+      */
+    const std::vector<tiramisu::computation *> &get_computations() const;
+
+    /**
+      * Return the first and the last computation of the contraction.
+      */
+    tiramisu::computation &get_first() const;
+    tiramisu::computation &get_last() const;
+
+    /**
+      * Return the number of floating point operations of the contraction,
+      * estimated with the sizes assumed by the cost model.
+      */
+    double get_flops() const;
+
+    /**
+      * Print the products of the contraction and their lowering.
+      */
+    void dump() const;
+};
+
+}
+
+#endif
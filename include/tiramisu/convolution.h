@@ -0,0 +1,236 @@
+#ifndef _H_TIRAMISU_CONVOLUTION_
+#define _H_TIRAMISU_CONVOLUTION_
+
+#include <tiramisu/core.h>
+#include <tiramisu/contraction.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace tiramisu {
+
+/**
+  * How a convolution is computed (see convolution::convolution()).
+  */
+enum convolution_lowering_t
+{
+    convolution_auto,         // The fastest lowering according to the cost model
+    convolution_direct,       // A loop nest
+    convolution_gemm,         // im2col, then a GEMM
+    convolution_winograd_2x2, // Winograd F(2x2, 3x3)
+    convolution_winograd_4x4, // Winograd F(4x4, 3x3)
+    convolution_fft           // Products of tiles in the Fourier domain
+};
+
+/**
+  * A 2D convolution layer with a stride of 1, of an input already padded:
+  *
+  * \code
+  * buffer in("in", {N, C, H, W}, p_float32, a_input);
+  * buffer weights("weights", {F, C, K, K}, p_float32, a_input);
+  * buffer out("out", {N, F, H - K + 1, W - K + 1}, p_float32, a_output);
+  * convolution conv("conv", &in, &weights, &out);
+  * \endcode
+  *
+  * computes out[n, f, y, x] = sum over c, ky and kx of
+  * in[n, c, y + ky, x + kx] * weights[f, c, ky, kx].
+  *
+  * The lowerings are
+  *  - convolution_direct: a loop nest, whose innermost loop runs along x.
+  *  - convolution_gemm: the input is copied into a matrix whose rows are
+  * (c, ky, kx) and whose columns are (n, y, x) (im2col), which is multiplied
+  * by the weights with a contraction (see contraction).
+  *  - convolution_winograd_2x2 and convolution_winograd_4x4: the output is
+  * divided into tiles of 2x2 or 4x4 elements.  The input tiles and the
+  * weights are transformed with the matrices of the Winograd algorithm
+  * F(m x m, 3 x 3), multiplied element-wise and summed over the channels
+  * with a batched GEMM (one per element of a transformed tile), and the
+  * products are transformed back into the output tiles.  This needs 2.25
+  * (F(2x2)) or 4 (F(4x4)) times fewer multiplications than the direct
+  * convolution, but rounds differently, F(4x4) more than F(2x2).  Only for
+  * 3x3 kernels.
+  *  - convolution_fft: the same scheme with the discrete Fourier transform
+  * of tiles of 8x8 (or 16x16 for kernels larger than 4x4) input elements
+  * (overlap-save): the products are complex, and are computed by a single
+  * real GEMM on the stacked real and imaginary parts.  This suits large
+  * kernels.
+  *
+  * The transforms of the Winograd and FFT lowerings are computations of their
+  * own, which can be scheduled (e.g. tiled, parallelized or fused with the
+  * computations that produce the input), and the transforms of the weights
+  * can be moved out of the function when the weights are constant.  These
+  * lowerings need the spatial sizes of the buffers to be constants, and
+  * p_float32 or p_float64 elements.
+  *
+  * With convolution_auto, a cost model compares the estimated time of each
+  * applicable lowering for the shape of the layer (with the machine
+  * parameters of contractions, see CONTRACTION_LOOP_GFLOPS), and picks the
+  * fastest one.
+  *
+  * The computations of the convolution are created in the implicit function
+  * and are ordered one after the other; get_first() and get_last() order them
+  * with the other computations.
+  */
+class convolution
+{
+private:
+    std::string name;
+
+    tiramisu::buffer *input, *weights, *output;
+
+    /**
+      * The sizes of the layer: batch, input channels, input height and
+      * width, output channels, kernel size, output height and width.
+      */
+    tiramisu::expr N, C, H, W, F, K, OH, OW;
+
+    /**
+      * The lowering used, once chosen.
+      */
+    convolution_lowering_t lowering;
+
+    /**
+      * The computations of the convolution, in the order of their execution.
+      */
+    std::vector<tiramisu::computation *> computations;
+
+    /**
+      * The input computations through which the buffers are read.
+      */
+    std::map<tiramisu::buffer *, tiramisu::input *> inputs;
+
+    /**
+      * The temporary buffers: the transformed tiles and weights, and the
+      * matrices of the transforms.
+      */
+    std::vector<tiramisu::buffer *> temporaries;
+
+    /**
+      * The contraction that computes the GEMM of the gemm, Winograd and FFT
+      * lowerings.
+      */
+    tiramisu::contraction *gemm = nullptr;
+
+protected:
+    /**
+      * The value of \p size used by the cost model: the size itself if it is
+      * a constant, CONTRACTION_DEFAULT_DIM_SIZE otherwise.
+      */
+    static double get_estimated_size(const tiramisu::expr &size);
+
+    /**
+      * Return true if the lowering \p l can compute this convolution.
+      */
+    bool is_applicable(convolution_lowering_t l) const;
+
+    /**
+      * Return the estimated time in microseconds of the lowering \p l.
+      */
+    double estimate_cost(convolution_lowering_t l) const;
+
+    /**
+      * The size of the tiles of the output and of the input with the Winograd
+      * or FFT lowering \p l.
+      */
+    void get_tile_sizes(convolution_lowering_t l, int &output_tile, int &input_tile) const;
+
+    /**
+      * Add the computation \p comp to the computations of the convolution,
+      * after the last one.
+      */
+    void add_computation(tiramisu::computation *comp);
+
+    /**
+      * Create a computation over \p iterators that computes \p e (only where
+      * \p predicate holds, if it is defined), store it at \p mapping in
+      * \p buf, and add it to the computations of the convolution.
+      */
+    tiramisu::computation *add_computation(const std::vector<tiramisu::var> &iterators, const tiramisu::expr &e,
+                                           tiramisu::buffer *buf, const std::vector<tiramisu::expr> &mapping,
+                                           const tiramisu::expr &predicate = tiramisu::expr());
+
+    /**
+      * Return a var named after the convolution, from 0 to \p size.
+      */
+    tiramisu::var make_var(const std::string &suffix, const tiramisu::expr &size) const;
+
+    /**
+      * Return an access to the element \p indices of the buffer \p buf.
+      */
+    tiramisu::expr access(tiramisu::buffer *buf, const std::vector<tiramisu::expr> &indices);
+
+    /**
+      * Return an access to the element \p indices of the computation \p comp.
+      */
+    static tiramisu::expr access(const tiramisu::computation *comp, const std::vector<tiramisu::expr> &indices);
+
+    /**
+      * Return \p value as a constant of the type of the elements of the output.
+      */
+    tiramisu::expr constant(double value) const;
+
+    /**
+      * Create a temporary buffer of the type of the elements of the output.
+      */
+    tiramisu::buffer *create_temporary(const std::vector<tiramisu::expr> &sizes);
+
+    /**
+      * Create a temporary buffer holding the matrix \p values, and return the
+      * computation that initializes it.
+      */
+    tiramisu::computation *create_matrix(const std::vector<std::vector<double>> &values);
+
+    /**
+      * Return the input, or a copy of the input padded with zeros, whose
+      * height and width are at least \p height and \p width.
+      */
+    tiramisu::buffer *pad_input(int64_t height, int64_t width);
+
+    /**
+      * Multiply, for each element (u, v) of a transformed tile, the weights
+      * \p transformed_weights [u, v, f, c] by the input tiles
+      * \p transformed_input [u, v, c, n, ty, tx] into \p product
+      * [u, v, f, n, ty, tx].
+      */
+    void multiply_tiles(tiramisu::buffer *transformed_weights, tiramisu::buffer *transformed_input,
+                        tiramisu::buffer *product);
+
+    void lower_to_direct();
+    void lower_to_gemm();
+    void lower_to_winograd(int m);
+    void lower_to_fft(int a);
+
+public:
+    /**
+      * Create the computations that compute the convolution of \p input by
+      * \p weights into \p output with the lowering \p l.
+      */
+    convolution(const std::string &name, tiramisu::buffer *input, tiramisu::buffer *weights,
+                tiramisu::buffer *output, convolution_lowering_t l = convolution_auto);
+
+    /**
+      * Return the computations of the convolution, in the order of their execution.
+      */
+    const std::vector<tiramisu::computation *> &get_computations() const;
+
+    /**
+      * Return the first and the last computation of the convolution.
+      */
+    tiramisu::computation &get_first() const;
+    tiramisu::computation &get_last() const;
+
+    /**
+      * Return the lowering used by the convolution.
+      */
+    convolution_lowering_t get_lowering() const;
+
+    /**
+      * Print the estimated time of each applicable lowering and the lowering used.
+      */
+    void dump() const;
+};
+
+}
+
+#endif
@@ -11,7 +11,9 @@
 #include <isl/space.h>
 #include <isl/constraint.h>
 
+#include <functional>
 #include <map>
+#include <set>
 #include <string.h>
 #include <stdint.h>
 #include <unordered_map>
@@ -24,20 +26,38 @@
 #include <tiramisu/type.h>
 #include "cuda_ast.h"
 
+/**
+  * The alignment in bytes of the buffers carved from the workspace of a
+  * function (see function::enable_buffer_arena()).
+  */
+#define TIRAMISU_BUFFER_ARENA_ALIGNMENT 64
+
+/**
+  * The largest number of dimensions of a buffer streamed with
+  * computation::stream_input() or computation::stream_output().
+  */
+#define TIRAMISU_IO_STREAM_MAX_DIMS 4
+
+class tiramisu_timer;
+
 namespace tiramisu
 {
 class view;
 class input;
+class block;
+class sparse_computation;
 class function;
 class computation;
 class buffer;
 class constant;
 class generator;
 class computation_tester;
+class communicator;
 class send;
 class recv;
 class send_recv;
 class wait;
+class collective;
 class sync;
 class xfer_prop;
 
@@ -47,12 +67,17 @@ class syntax_tree;
 class ast_node;
 class computation_info;
 class evaluate_by_execution;
+class evaluate_by_learning_model;
 class dnn_access_matrix;
+class dnn_iterator;
 class simple_generator;
 class state_computation;
 class ml_model_schedules_generator;
+class legality_oracle;
 
 void unroll_innermost_levels(std::vector<tiramisu::computation*> const& comps_list, int unroll_fact);
+void apply_distribution(syntax_tree const& ast, bool generate_communication);
+void apply_local_transpositions(syntax_tree const& ast);
 }
 
 struct HalideCodegenOutput
@@ -69,6 +94,17 @@ struct HalideCodegenOutput
 
 Halide::Argument::Kind halide_argtype_from_tiramisu_argtype(tiramisu::argument_t type);
 
+/**
+  * Convert the lowered Halide pipeline \p s into the computations of \p func.
+  * The '.' and '$' of the Halide names are replaced by '_'.  The pure
+  * definition of a Halide function f is the computation f, its updates
+  * (including the reductions over an RDom) are the computations f_update_0,
+  * f_update_1, ... which are iterated over all their surrounding loops (the
+  * loops of the RDom included) and which write to the buffer of f.
+  * The computations are ordered as the stages of the pipeline, and the loop
+  * bounds known at compile time are added to the context of \p func, so
+  * that the function can be given to the auto-scheduler as it is.
+  */
 HalideCodegenOutput halide_pipeline_to_tiramisu_function(
     Halide::Internal::Stmt s,
     const std::vector<Halide::Internal::Function> &outputs,
@@ -95,7 +131,78 @@ enum xfer_attr {
     CPU2CPU,
     CPU2GPU,
     GPU2CPU,
-    GPU2GPU
+    GPU2GPU,
+    /**
+      * One-sided MPI transfer: the sender puts the message in a window of the receiver
+      * (see tiramisu_MPI_init_rma()) and notifies it, the receive waits for the
+      * notification. Only for blocking, contiguous transfers.
+      */
+    RMA
+};
+
+/**
+  * Reduction operators of the collective communications
+  * (allreduce and reduce_scatter).
+  */
+enum reduce_op {
+    REDUCE_SUM,
+    REDUCE_PROD,
+    REDUCE_MIN,
+    REDUCE_MAX
+};
+
+/**
+  * A producer-consumer fusion chosen by function::fuse_producer_consumer_chains().
+  */
+struct fusion_info
+{
+    tiramisu::computation *producer;
+    tiramisu::computation *consumer;
+
+    /**
+      * The consumer is executed after the producer at this loop level
+      * (computation::root_dimension if they were not fused before).
+      */
+    int previous_level;
+    int level;
+
+    /**
+      * The estimated memory traffic saved, in bytes (0 if the buffer of the
+      * producer does not have constant extents).
+      */
+    double saved_bytes;
+
+    /**
+      * The shifts of the loop levels 0 to level of the consumer that make the
+      * fusion legal (see function::fuse_with_shifting()), empty if the
+      * consumer is not shifted.
+      */
+    std::vector<int> shifts = {};
+
+    /**
+      * The iterations of the fused loops that do not execute both computations
+      * (the prologue and the epilogue of the fused loops, when the shifted
+      * bounds of the consumer differ from the bounds of the producer), -1 if
+      * the bounds are not constant.  No value is recomputed, unlike with
+      * compute_at().
+      */
+    double redundant_iterations = 0;
+};
+
+/**
+  * The cost of a phase of code generation, recorded by
+  * function::report_compile_time() (see function::get_compile_phases()).
+  */
+struct compile_phase
+{
+    std::string phase;
+    double milliseconds;
+    unsigned long isl_operations;
+
+    /**
+      * The peak resident memory of the process at the end of the phase, in KB.
+      */
+    long peak_memory_kb;
 };
 
 struct xfer {
@@ -138,6 +245,26 @@ void init();
  void codegen(const std::vector<tiramisu::buffer *> &arguments, const std::string obj_filename, const bool gen_cuda_stmt = false, bool gen_python = false);
  void codegen(const std::vector<tiramisu::buffer *> &arguments, const std::string obj_filename, const tiramisu::hardware_architecture_t gen_architecture_flag, bool gen_python = false);
 
+/**
+  * Compile the implicit function in memory with the Halide JIT
+  * (see function::jit()).
+  */
+Halide::Internal::JITModule jit(const std::vector<tiramisu::buffer *> &arguments);
+
+/**
+  * Generate the implicit function as a C source file
+  * (see function::codegen_c()).
+  */
+void codegen_c(const std::vector<tiramisu::buffer *> &arguments, const std::string &c_filename);
+
+/**
+  * Generate the implicit function and its initialization function
+  * (see function::codegen_with_init()).
+  */
+std::vector<tiramisu::buffer *> codegen_with_init(const std::vector<tiramisu::buffer *> &arguments,
+                                                  const std::string &obj_filename,
+                                                  const std::string &init_obj_filename);
+
 /**
  * Full check of schedule legality for this function using dependency analysis 
  * must be used after invoking : perform_full_dependency_analysis()
@@ -162,6 +289,25 @@ void perform_full_dependency_analysis();
  */
 void prepare_schedules_for_legality_checks(bool reset_static_dimesion = false);
 
+/**
+  * Fuse the producer-consumer chains of the implicit function
+  * (see function::fuse_producer_consumer_chains()).
+  */
+std::vector<tiramisu::fusion_info> fuse_producer_consumer_chains(bool apply = true);
+
+/**
+  * Fuse \p consumer with \p producer at the loop level \p level in the implicit
+  * function, shifting the consumer if needed (see function::fuse_with_shifting()).
+  */
+tiramisu::fusion_info fuse_with_shifting(tiramisu::computation *producer, tiramisu::computation *consumer,
+                                         int level, bool apply = true);
+
+/**
+  * Schedule the implicit function with the polyhedral scheduler of isl
+  * (see function::compute_polyhedral_schedule()).
+  */
+bool compute_polyhedral_schedule(int tile_size = 32, bool parallelize = true);
+
  /**
      * Checks if the given fused computations could legally have their loop level \p i as parallel using dependence analysis and legality check.
      * It relies fully on the dependence analysis result, so the  method \p perform_full_dependency_analysis() must be invoked before.
@@ -180,6 +326,14 @@ void prepare_schedules_for_legality_checks(bool reset_static_dimesion = false);
   */
   bool loop_vectorization_is_legal(tiramisu::var i, std::vector<tiramisu::computation *> fused_computations);
 
+  /**
+  * Checks if the loop levels from \p level of the loop nest shared by \p first_computations
+  * and \p second_computations could legally be distributed, the second computations being
+  * moved to their own loop nest after the first ones (see function::loop_distribution_is_legal()).
+  */
+  bool loop_distribution_is_legal(int level, std::vector<tiramisu::computation *> first_computations,
+                                  std::vector<tiramisu::computation *> second_computations);
+
 //*******************************************************
 
 /**
@@ -190,16 +344,21 @@ class function
 {
     // Friend classes.  They can access the private members of the "function" class.
     friend buffer;
+    friend block;
     friend computation;
     friend constant;
     friend generator;
+    friend input;
     friend tiramisu::wait;
     friend cuda_ast::generator;
     
     friend auto_scheduler::syntax_tree;
     friend auto_scheduler::evaluate_by_execution;
     friend auto_scheduler::dnn_access_matrix;
+    friend auto_scheduler::dnn_iterator;
     friend auto_scheduler::simple_generator;
+    friend auto_scheduler::legality_oracle;
+    friend void auto_scheduler::apply_distribution(auto_scheduler::syntax_tree const& ast, bool generate_communication);
 
 private:
     /**
@@ -284,6 +443,14 @@ private:
     */
     isl_union_map * live_out_access ;
 
+    /**
+      * The inputs of the last dependence analysis done by calculate_dep_flow() :
+      * the iteration domains, the access relations, the read accesses and the
+      * schedules of the computations. If they did not change since the last call,
+      * the dependences stored in the function are still valid and are not recomputed.
+      */
+    std::string dep_flow_signature;
+
     /**
       * An ISL AST representation of the function.
       * The ISL AST is generated by calling gen_isl_ast().
@@ -301,6 +468,89 @@ private:
       */
     std::vector<std::pair<std::string, int>> parallel_dimensions;
 
+    /**
+      * A vector representing the doacross dimensions around the computations
+      * of the function (see computation::parallelize_doacross()).
+      * A doacross dimension is identified using the tuple
+      * <computation_name, level, distance>, for example the tuple
+      * <S0, 0, 1> indicates that the loop with level 0 around S0 is
+      * parallel, and that each of its iterations waits, at each iteration
+      * of the loop level 1, for the previous iteration of the loop level 0.
+      * The loop level 0 must also be in parallel_dimensions.
+      */
+    std::vector<std::tuple<std::string, int, int>> doacross_dimensions;
+
+    /**
+      * A vector representing the loop levels split by runtime sizes
+      * (see computation::split_parametric() and computation::tile_parametric()).
+      * A parametric split is identified using the tuple
+      * <computation_name, level, sizes>, for example the tuple
+      * <S0, 1, {T}> indicates that the loop with level 1 around S0 is split
+      * by T, and the tuple <S0, 1, {T0, T1}> that the loop levels 1 and 2
+      * around S0 are tiled by T0 x T1.
+      */
+    std::vector<std::tuple<std::string, int, std::vector<tiramisu::expr>>> parametric_split_dimensions;
+
+    /**
+      * A vector representing the streaming loop levels whose body runs as a
+      * pipeline of stages (see computation::pipeline()).
+      * A pipeline dimension is identified using the tuple
+      * <computation_name, level, depth>, for example the tuple
+      * <S0, 0, 2> indicates that the statements in the body of the loop
+      * with level 0 around S0 run concurrently, and that the first stages
+      * can be at most 2 iterations ahead of the last one.
+      */
+    std::vector<std::tuple<std::string, int, int>> pipeline_dimensions;
+
+    /**
+      * A vector representing the parallel reduction dimensions around the
+      * computations of the function (see computation::parallelize_reduction()).
+      * A parallel reduction dimension is identified using the tuple
+      * <computation_name, level, strategy, nb_partials>, for example the tuple
+      * <S0, 1, reduction_privatized, 64> indicates that the loop with level 1
+      * around S0 is a reduction loop, parallelized by accumulating into 64
+      * partial results.  The loop level must also be in parallel_dimensions.
+      */
+    std::vector<std::tuple<std::string, int, tiramisu::reduction_strategy_t, int>> reduction_dimensions;
+
+    /**
+      * A vector representing the parallel scan dimensions around the
+      * computations of the function (see computation::parallelize_scan()).
+      * A parallel scan dimension is identified using the tuple
+      * <computation_name, level, nb_blocks>, for example the tuple
+      * <S0, 1, 64> indicates that the loop with level 1 around S0 is a scan
+      * loop, parallelized by scanning 64 blocks of iterations.  The loop level
+      * must also be in parallel_dimensions.
+      */
+    std::vector<std::tuple<std::string, int, int>> scan_dimensions;
+
+    /**
+      * A vector representing the software prefetches of the computations
+      * of the function (see computation::prefetch()).
+      * A prefetch is identified using the tuple
+      * <computation_name, buffer_name, level, distance>, for example the tuple
+      * <S0, b0, 1, 8> indicates that, at each iteration of S0, the elements
+      * of b0 that S0 accesses 8 iterations later of the loop level 1 are
+      * prefetched.
+      */
+    std::vector<std::tuple<std::string, std::string, int, int>> prefetch_dimensions;
+
+    /**
+      * The options of the isl AST generator for the loop levels of the
+      * computations (see computation::set_ast_option()), as tuples
+      * <computation_name, level, option>.
+      */
+    std::vector<std::tuple<std::string, int, tiramisu::ast_option_t>> ast_options;
+
+    /**
+      * The values of the ast_build_atomic_upper_bound, ast_build_detect_min_max
+      * and ast_build_allow_else options of isl when the AST of the function is
+      * generated (see set_ast_build_flags()).
+      */
+    bool ast_atomic_upper_bound = true;
+    bool ast_detect_min_max = true;
+    bool ast_allow_else = true;
+
     /**
       * A vector representing the vectorized dimensions around
       * the computations of the function.
@@ -312,6 +562,14 @@ private:
       */
     std::vector<std::tuple<std::string, int, int>> vector_dimensions;
 
+    /**
+      * The vectorized dimensions whose last vector is predicated instead of
+      * being computed by a scalar remainder loop (see
+      * computation::vectorize_predicated()), as <computation_name, level>
+      * pairs.
+      */
+    std::vector<std::pair<std::string, int>> predicated_vector_dimensions;
+
     /**
       * A vector representing the distributed dimensions around
       * the computations of the function.
@@ -323,6 +581,27 @@ private:
       */
     std::vector<std::pair<std::string, int>> distributed_dimensions;
 
+    /**
+      * The boundary conditions of the inputs (see input::set_boundary_condition()),
+      * indexed by the name of the input, with the value read outside of the
+      * input when the condition is boundary_constant.
+      */
+    std::map<std::string, std::pair<tiramisu::boundary_t, tiramisu::expr>> boundary_conditions;
+
+    /**
+      * A vector representing the dimensions whose iterations are distributed
+      * across the GPUs of the machine (see computation::tag_gpu_device_level()).
+      * They are identified using the pair <computation_name, level>.
+      */
+    std::vector<std::pair<std::string, int>> gpu_device_dimensions;
+
+    /**
+      * The loop levels executed inside a single persistent kernel
+      * (see computation::tag_gpu_persistent_level()), identified using the
+      * pair <computation_name, level>.
+      */
+    std::vector<std::pair<std::string, int>> gpu_persistent_dimensions;
+
     /**
       * A vector representing the GPU block dimensions around
       * the computations of the function.
@@ -345,6 +624,42 @@ private:
      */
     std::vector<std::pair<std::string, std::tuple<int, int, int>>> gpu_thread_dimensions;
 
+    /**
+      * The computations whose innermost tiles are computed with tensor cores,
+      * with the levels of the i, j and k loops of the tiles
+      * (see computation::tag_gpu_tensor_core()).
+      */
+    std::vector<std::pair<std::string, std::tuple<int, int, int>>> gpu_tensor_core_dimensions;
+
+    /**
+      * The shared memory copies issued asynchronously, without staging the
+      * values in registers (see the \p stages argument of
+      * computation::cache_shared()).
+      */
+    std::set<std::string> gpu_async_copies;
+
+    /**
+      * The barriers of pipelined shared memory copies, with the number of
+      * copy stages that are allowed to be still in flight when the barrier
+      * completes.
+      */
+    std::map<std::string, int> gpu_async_barriers;
+
+    /**
+      * The CUDA streams of the host/device copies and of the kernels
+      * (see computation::tag_gpu_stream()).  Computations that are not in
+      * this map use the default stream.
+      */
+    std::map<std::string, int> gpu_streams;
+
+    /**
+      * The host/device copies generated by Automatic_communication() that only
+      * move a sub-region of their buffers, mapped to the offset and the number
+      * of elements of that sub-region.  Copies that are not in this map copy
+      * the whole buffer.
+      */
+    std::map<std::string, std::pair<tiramisu::expr, tiramisu::expr>> gpu_copy_regions;
+
     /**
       * A vector representing the dimensions that should be unrolled
       * around the computations of the function.
@@ -365,6 +680,21 @@ private:
       */
     std::vector<computation *> body;
 
+    /**
+      * The computations of the blocks declared in the function (see
+      * tiramisu::block), in the order of declaration of the blocks.
+      */
+    std::vector<std::vector<computation *>> blocks;
+
+    /**
+      * The computations of the body indexed by name (in the order of the
+      * body), and the position of each computation in the body.  They are
+      * kept up to date by add_computation(), computation::set_name() and
+      * truncate_computations().
+      */
+    std::unordered_map<std::string, std::vector<computation *>> computations_by_name;
+    std::unordered_map<computation *, int> computation_positions;
+
     /**
       * A Halide statement that represents the whole function.
       * This value stored in halide_stmt is generated by the code generator
@@ -372,6 +702,125 @@ private:
       */
     Halide::Internal::Stmt halide_stmt;
 
+    /**
+      * The Halide statement of the inspector computations of the function,
+      * undefined if the function has no inspector (see
+      * computation::mark_as_inspector()).
+      */
+    Halide::Internal::Stmt inspector_halide_stmt;
+
+    /**
+      * The Halide statement of the entry point that maps the buffers from
+      * files, undefined if no argument of the function is mapped (see
+      * buffer::set_mapped_file()).
+      */
+    Halide::Internal::Stmt mapped_halide_stmt;
+
+    /**
+      * The modules compiled by jit(), indexed by the schedules signature of
+      * the function, by its arguments, by its buffers and by the code generator options.
+      */
+    std::unordered_map<std::string, Halide::Internal::JITModule> jit_cache;
+
+    /**
+      * True if the temporary buffers are carved from a single workspace
+      * (see enable_buffer_arena()).
+      */
+    bool use_buffer_arena = false;
+
+    /**
+      * The size in bytes of the workspace, computed by gen_halide_stmt().
+      */
+    int64_t buffer_arena_size = 0;
+
+    /**
+      * True if the GPU work of the function is captured in a CUDA graph and
+      * replayed (see enable_cuda_graph()).
+      */
+    bool use_cuda_graph = false;
+
+    /**
+      * True if the FlexNLP calls of the function are queued on the
+      * asynchronous FlexNLP runtime (see enable_flexnlp_async_runtime()).
+      */
+    bool use_flexnlp_async_runtime = false;
+
+    /**
+      * True if the code generator separates the full tiles of the loops from
+      * their partial tiles (see enable_full_tile_separation()).
+      */
+    bool separate_full_tiles = false;
+
+    /**
+      * Features added to the default features of the target of the generated
+      * code (see add_target_feature()).
+      */
+    std::vector<Halide::Target::Feature> target_features;
+
+    /**
+      * The target set with set_target(), or a target of unknown architecture
+      * for the host machine.
+      */
+    Halide::Target halide_target;
+
+    /**
+      * True if codegen() prints the time spent in each of its phases (see
+      * enable_compile_time_report()).
+      */
+    bool report_compile_times = false;
+
+    /**
+      * The phases of code generation of the function, in the order in which
+      * they ended (see get_compile_phases()).
+      */
+    mutable std::vector<tiramisu::compile_phase> compile_phases;
+
+    /**
+      * True if the outermost loop nests of the generated code are profiled
+      * (see enable_profiling()).
+      */
+    bool profile_loop_nests = false;
+
+    /**
+      * True if gen_halide_obj() also generates the entry point NAME_batched
+      * (see enable_batching()).
+      */
+    bool generate_batched_entry_point = false;
+
+    /**
+      * True if gen_halide_obj() also generates the entry point NAME_raw
+      * (see enable_raw_entry_point()).
+      */
+    bool generate_raw_entry_point = false;
+
+    /**
+      * The runtime of the parallel loops, and the chunk size of their
+      * iterations (see set_parallel_backend()).
+      */
+    tiramisu::parallel_backend_t parallel_backend = tiramisu::parallel_halide;
+    int parallel_chunk_size = 0;
+
+    /**
+      * The minimum number of blocks per multiprocessor given to the
+      * __launch_bounds__ of the GPU kernels, 0 if they have none (see
+      * set_gpu_launch_bounds()).
+      */
+    int gpu_launch_bounds_min_blocks = 0;
+
+    /**
+      * The size of the GPU constant memory that place_gpu_buffers() may use,
+      * -1 if the GPU buffers are not placed automatically (see
+      * enable_gpu_buffer_placement()).
+      */
+    int64_t gpu_constant_memory_bytes = -1;
+
+    /**
+      * True if the code generator swaps thread x and thread y of the GPU
+      * computations whose accesses to global memory are not coalesced (see
+      * set_gpu_coalescing_remap()).
+      */
+    bool gpu_coalescing_remap = false;
+
     /**
       * A map representing the buffers of the function. Some of these
       * buffers are passed to the function as arguments and some are
@@ -398,6 +847,29 @@ private:
 
     std::shared_ptr<cuda_ast::compiler> nvcc_compiler;
 
+    /**
+      * The C++ file of the OpenCL kernels and of their launchers, written
+      * next to the object file by gen_halide_obj() (see gen_opencl_stmt()).
+      */
+    std::string opencl_code;
+
+    /**
+      * Start timing a phase of code generation with \p timer and save in
+      * \p isl_operations the number of operations already performed by the
+      * isl context of the function (see report_compile_time()).
+      */
+    void start_compile_phase(tiramisu_timer &timer, unsigned long &isl_operations) const;
+
+    /**
+      * Report the time elapsed since \p timer was started and the number of
+      * isl operations performed since \p isl_operations was saved as the cost
+      * of the code generation phase \p phase, then start a new phase.
+      * The report is printed if it is enabled (see enable_compile_time_report()),
+      * added to the trace file named by TIRAMISU_COMPILE_TRACE if set, and
+      * recorded in the phases returned by get_compile_phases().
+      */
+    void report_compile_time(const std::string &phase, tiramisu_timer &timer, unsigned long &isl_operations) const;
+
     /**
       * Tag the dimension \p dim of the computation \p computation_name to
       * be parallelized.
@@ -406,6 +878,55 @@ private:
       */
     void add_parallel_dimension(std::string computation_name, int vec_dim);
 
+    /**
+      * Tag the dimension \p dim of the computation \p computation_name to
+      * be a doacross dimension with the distance \p distance
+      * (see computation::parallelize_doacross()).
+      */
+    void add_doacross_dimension(std::string computation_name, int dim, int distance);
+
+    /**
+      * Tag the dimension \p dim of the computation \p computation_name to
+      * be split by the runtime sizes \p sizes
+      * (see computation::split_parametric()).
+      */
+    void add_parametric_split_dimension(std::string computation_name, int dim, std::vector<tiramisu::expr> sizes);
+
+    /**
+      * Tag the dimension \p dim of the computation \p computation_name to
+      * be the streaming dimension of a pipeline of depth \p depth
+      * (see computation::pipeline()).
+      */
+    void add_pipeline_dimension(std::string computation_name, int dim, int depth);
+
+    /**
+      * Tag the dimension \p dim of the computation \p computation_name to
+      * be a parallel reduction dimension with the strategy \p strategy
+      * (see computation::parallelize_reduction()).
+      */
+    void add_reduction_dimension(std::string computation_name, int dim, tiramisu::reduction_strategy_t strategy,
+                                 int nb_partials);
+
+    /**
+      * Tag the dimension \p dim of the computation \p computation_name to
+      * be a parallel scan dimension with \p nb_blocks blocks
+      * (see computation::parallelize_scan()).
+      */
+    void add_scan_dimension(std::string computation_name, int dim, int nb_blocks);
+
+    /**
+      * Prefetch, in the computation \p computation_name, the elements of
+      * the buffer \p buffer_name accessed \p distance iterations ahead of
+      * the loop level \p dim (see computation::prefetch()).
+      */
+    void add_prefetch_dimension(std::string computation_name, std::string buffer_name, int dim, int distance);
+
+    /**
+      * Generate the loop level \p dim of the computation \p computation_name
+      * with the isl AST option \p option (see computation::set_ast_option()).
+      */
+    void add_ast_option(std::string computation_name, int dim, tiramisu::ast_option_t option);
+
     /**
       * Tag the dimension \p dim of the computation \p computation_name to
       * be vectorized. \p len is the vector length.
@@ -414,6 +935,12 @@ private:
       */
     void add_vector_dimension(std::string computation_name, int vec_dim, int len);
 
+    /**
+      * Predicate the last vector of the vectorized dimension \p dim of the
+      * computation \p computation_name (see computation::vectorize_predicated()).
+      */
+    void add_predicated_vector_dimension(std::string computation_name, int dim);
+
     /**
       * Tag the dimension \p dim of the computation \p computation_name to
       * be distributed.
@@ -422,6 +949,18 @@ private:
       */
     void add_distributed_dimension(std::string computation_name, int dim);
 
+    /**
+      * Tag the dimension \p dim of the computation \p computation_name to
+      * be distributed across the GPUs.
+      */
+    void add_gpu_device_dimension(std::string computation_name, int dim);
+
+    /**
+      * Tag the loop level \p dim of the computation \p computation_name to
+      * be executed inside a persistent kernel.
+      */
+    void add_gpu_persistent_dimension(std::string computation_name, int dim);
+
     /**
       * Tag the loop level \p L of the computation
       * \p computation_name to be unrolled.
@@ -559,6 +1098,25 @@ protected:
       */
     void add_computation(computation *cpt);
 
+    /**
+      * Add a block made of the computations \p children to the function.
+      * The blocks are only recorded: the scheduling commands of a block are
+      * applied to its computations by the block itself.
+      */
+    void add_block(const std::vector<computation *> &children);
+
+    /**
+      * Move \p comp, which was named \p old_name, to its new name in the
+      * index of the computations by name.
+      */
+    void update_computation_name(computation *comp, const std::string &old_name);
+
+    /**
+      * Remove the computations added after the first \p size computations
+      * of the body.
+      */
+    void truncate_computations(int size);
+
     /**
       * Tag the dimensions \p dim0, \p dim1 and \p dim2 of the computation
       * \p computation_name to be mapped to GPU blocks.
@@ -622,6 +1180,14 @@ protected:
       */
     isl_union_map *compute_dep_graph();
 
+    /**
+      * Return the schedules of the computations of the function, restricted to
+      * their iteration domains, with an anonymous range (e.g. C[i,j] -> [0,i,0,j,0]),
+      * so that the time stamps of different computations can be compared.
+      * The schedules must be aligned (see align_schedules()).
+      */
+    isl_union_map *get_time_stamp_schedules() const;
+
     /**
       * Get the arguments of the function.
       */
@@ -645,6 +1211,13 @@ protected:
       */
     const std::vector<computation *> &get_computations() const;
 
+    /**
+      * Return the computations of each block declared in the function
+      * (see tiramisu::block).  The auto-scheduler schedules the computations
+      * of a block together.
+      */
+    const std::vector<std::vector<computation *>> &get_blocks() const;
+
     /**
       * Return the computation of the function that has
       * the name \p str.
@@ -831,6 +1404,49 @@ protected:
       */
     bool should_parallelize(const std::string &comp, int lev) const;
 
+    /**
+      * Return the synchronization distance of the doacross loop level \p lev
+      * of the computation \p comp, or -1 if this loop level is not a
+      * doacross loop level.
+      */
+    int get_doacross_distance(const std::string &comp, int lev) const;
+
+    /**
+      * Return the runtime sizes by which the loop level \p lev of the
+      * computation \p comp is split (one size) or tiled with the loop level
+      * right inside it (two sizes), or an empty vector if this loop level is
+      * not split by runtime sizes.
+      */
+    std::vector<tiramisu::expr> get_parametric_split_sizes(const std::string &comp, int lev) const;
+
+    /**
+      * Return the depth of the pipeline whose streaming dimension is the loop
+      * level \p lev of the computation \p comp, or -1 if this loop level is
+      * not the streaming dimension of a pipeline.
+      */
+    int get_pipeline_depth(const std::string &comp, int lev) const;
+
+    /**
+      * Return true if the loop level \p lev of the computation \p comp is a
+      * parallel reduction loop level, and set \p strategy and \p nb_partials
+      * to its strategy and to its number of partial results.
+      */
+    bool get_reduction_strategy(const std::string &comp, int lev, tiramisu::reduction_strategy_t &strategy,
+                                int &nb_partials) const;
+
+    /**
+      * Return the number of blocks of the parallel scan loop level \p lev
+      * of the computation \p comp, or -1 if this loop level is not a
+      * parallel scan loop level.
+      */
+    int get_scan_blocks(const std::string &comp, int lev) const;
+
+    /**
+      * Return the software prefetches of the computation \p comp as
+      * <buffer_name, level, distance> tuples.
+      */
+    std::vector<std::tuple<std::string, int, int>> get_prefetch_dimensions(const std::string &comp) const;
+
     /**
       * Return true if the computation \p comp should be unrolled
       * at the loop level \p lev.
@@ -843,12 +1459,24 @@ protected:
       */
     bool should_vectorize(const std::string &comp, int lev) const;
 
+    /**
+      * Return true if the last vector of the vectorized loop level \p lev of
+      * the computation \p comp is predicated.
+      */
+    bool is_predicated_vector(const std::string &comp, int lev) const;
+
     /**
       * Return true if the computation \p comp should be distributed
       * at the loop level \p lev.
       */
     bool should_distribute(const std::string &comp, int lev) const;
 
+    /**
+      * Return true if the iterations of the loop level \p lev of the
+      * computation \p comp should be distributed across the GPUs.
+      */
+    bool should_distribute_to_gpus(const std::string &comp, int lev) const;
+
     /**
       * This computation requires a call to the MPI_Comm_rank function.
       */
@@ -859,11 +1487,32 @@ protected:
       */
     void lift_mpi_comp(tiramisu::computation *comp);
 
+    /**
+      * Switch the lifted point-to-point communication \p comm to the strided
+      * (MPI vector datatype) variant of its runtime function and fill the
+      * last two arguments of the call with its block length and stride.
+      */
+    void lift_mpi_strided_layout(tiramisu::communicator *comm);
+
+    /**
+      * Return the tag argument of the lifted point-to-point communication
+      * \p comm: \p msg_tag, with the communication channel of \p comm (if any)
+      * encoded in its high bits.
+      */
+    tiramisu::expr lift_mpi_tag(tiramisu::communicator *comm, tiramisu::expr msg_tag);
+
     /**
       * Lift certain computations for distributed execution to function calls.
       */
     void lift_dist_comps();
 
+    /**
+      * Replace the accesses to the inputs that have a boundary condition by
+      * accesses that stay inside the inputs, in all the computations except
+      * the interiors created by computation::separate_borders().
+      */
+    void lower_boundary_conditions();
+
     /**
       * The set of all computations that have no computation scheduled before them.
       * Does not include allocation computations created using
@@ -882,6 +1531,8 @@ protected:
      * \brief Generates the automatic communication CPU/GPU.
      * \details This fucntion takes two pointers to the first and the last computation
      *  of the fucntion.
+     *  The copies are only inserted where the data is not already up to date
+     *  on the side that accesses it, and only copy the accessed part of the buffers.
      *  C1 is the first computation, which means that it hasn't a predecessor.
      *  C2 is the last computation, which means that it hasn't a successor.
      */
@@ -989,6 +1640,263 @@ public:
      */
     void allocate_and_map_buffers_automatically();
 
+    /**
+     * \brief Reduce the memory used by the temporary buffers of the function.
+     *
+     * \details This method uses the dependence analysis, it must be called
+     * after the schedules of the computations are set and the computations are
+     * mapped to their buffers (e.g. after allocate_and_map_buffers_automatically()),
+     * and before code generation. It calls perform_full_dependency_analysis().
+     *
+     * Only the temporary buffers (a_temporary) that are allocated automatically,
+     * that have constant extents and that are only written by computations that
+     * do not have duplicates or updates are transformed :
+     *  - Each dimension of these buffers, from the outermost, is folded by the
+     *    smallest factor f (up to \p max_fold_factor) such that no element of the
+     *    buffer is overwritten while its value is still needed, i.e. the buffer
+     *    is contracted to the reuse distance of its values (see storage_fold()).
+     *    For example, a buffer that is produced and consumed in the same iteration
+     *    of a loop is contracted to a single element along that loop.
+     *  - Two temporary buffers that have the same type and the same sizes
+     *    (after folding) share the same allocation if all the accesses to one
+     *    of them happen before all the accesses to the other.
+     *
+     * Folding is checked exactly using the read after write dependences and the
+     * schedules, so the transformation does not change the result of the function.
+     */
+    void minimize_temporaries_storage(int max_fold_factor = 8);
+
+    /**
+     * \brief Compute once the values that several computations recompute
+     * with their indices renamed or permuted.
+     *
+     * \details This method uses the dependence analysis, it must be called
+     * after the schedules of the computations are set and the computations are
+     * mapped to their buffers, and before minimize_temporaries_storage() and
+     * code generation. It calls perform_full_dependency_analysis().
+     *
+     * The expressions of the computations are compared up to the renaming of
+     * their iterators and the order of the operands of the commutative
+     * operators: e.g. the products of propagator blocks
+     * B1(i, j, k) * B2(k, j, i) and B1(a, c, b) * B2(b, c, a) of two
+     * correlator computations are the same value, at permuted indices.  Only
+     * the subexpressions that cost at least \p min_cost operations (a
+     * division or a transcendental function counts as several operations)
+     * and that only read values that are never overwritten (each read
+     * computation is the only writer of its buffer and writes each element
+     * once) are considered.  Then, from the most expensive subexpressions:
+     *  - A subexpression that is the whole expression of another computation
+     *    is replaced with an access to that computation, if the value is
+     *    always computed before it is needed.
+     *  - The other subexpressions that occur in several computations are
+     *    computed once by a new computation (named after the first
+     *    computation that uses them, with the suffix _common<n>), in the
+     *    loops of the first computation, just before it, if the saved
+     *    operations are worth the additional store and loads.  The other
+     *    occurrences are replaced with accesses to the new computation.
+     *
+     * Return the number of subexpressions that are not computed anymore.
+     */
+    int eliminate_redundant_computations(int min_cost = 4);
+
+    /**
+     * \brief Store the producers of the copies into the buffers they are
+     * copied into, and remove the copies (e.g. the copies of the inputs of a
+     * concatenation into the concatenated buffer).
+     *
+     * \details This method must be called after the schedules of the
+     * computations are set and the computations are mapped to their buffers,
+     * and before code generation.
+     *
+     * A copy is a computation C whose expression is only an access to a
+     * computation P, e.g. C(i, j + 64) = P(i, j).  If the buffer of P is a
+     * temporary buffer and the elements of the buffer of C that C writes are
+     * not written by the other computations, then every access to the buffer
+     * of P (by P, by the computations that read it and by the views of the
+     * buffer) is replaced with an access to the element of the buffer of C
+     * where it is copied, the buffer of P is not allocated anymore and C is
+     * not scheduled anymore.  The offsets of the sub-regions written by the
+     * producers are derived from the access relation of C.  The computations
+     * scheduled after C are scheduled after the computation that precedes C.
+     *
+     * A producer can also write in a sub-region of a buffer explicitly, by
+     * storing it in a view of the buffer (see view::slice() and
+     * computation::store_in(view *)).
+     *
+     * Return the number of copies removed.
+     */
+    int concatenate_in_place();
+
+    /**
+     * \brief Fuse the chains of producers and consumers (e.g. conv-bn-relu,
+     * add-relu or conv-relu-maxpool) as deeply as possible without recomputation.
+     *
+     * \details This method uses the dependence analysis, it must be called
+     * after the computations are ordered (with then() or after()) and mapped to
+     * their buffers, and before the other scheduling commands (tile(), split(),
+     * interchange(), ...): the fused loop levels are the dimensions of the
+     * iteration domains. It calls perform_full_dependency_analysis().
+     *
+     * Each pair of computations where the consumer is the only computation
+     * ordered right after the producer, and reads values written by the
+     * producer (through any computation or view mapped to the buffer of the
+     * producer), is considered. The consumer is moved into the loop nest of
+     * the producer, at the deepest loop level L such that, for the loop levels
+     * 0 to L, the consumer only reads values produced at the same iteration
+     * (e.g. relu(n, f, y, x) reads conv(n, f, y, x) for every reduction
+     * index, so they are fused at x; maxpool(n, f, y, x) reads
+     * relu(n, f, 2*y + dy, 2*x + dx), so they are fused at f).  The producer
+     * is therefore never recomputed, unlike with compute_at(), whose overlapping
+     * regions are recomputed.  Each fusion is checked with the dependences of
+     * the function, and lowered to the deepest legal level.  Consecutive fused
+     * pairs form chains (conv-bn-relu is conv fused with bn, fused with relu).
+     *
+     * The saved memory traffic of a fusion is the size of the buffer of the
+     * producer, read from the cache instead of the memory, plus the same size
+     * again when the consumer is its only reader and the buffer is a temporary,
+     * which minimize_temporaries_storage() can then contract so that it is not
+     * written back either.
+     *
+     * The fusions are returned in the order of declaration of the producers.  If
+     * \p apply is false, the order of the computations is not modified and the
+     * fusions are only reported.
+     */
+    std::vector<tiramisu::fusion_info> fuse_producer_consumer_chains(bool apply = true);
+
+    /**
+     * \brief Fuse the GPU kernels of consecutive computations mapped to the
+     * same blocks and threads.
+     *
+     * \details Each computation mapped to the GPU (gpu_tile(),
+     * tag_gpu_level()) gets its own kernel unless it is ordered after its
+     * producer inside the thread levels, and the values it reads go through
+     * global memory.  This method considers each pair of computations where
+     * the consumer is the only computation ordered after the producer, both
+     * are mapped to the GPU with the same block and thread levels over the
+     * same grid, and each thread of the consumer only reads values that the
+     * same thread produced (e.g. Add-ReLU, or the ReLU of a convolution
+     * whose reduction loop is inside the threads).  The consumer is then
+     * ordered after the producer at the deepest such loop level, if the
+     * dependences of the function allow it, so that the two computations are
+     * in one kernel.
+     *
+     * When the two computations are fused at their innermost loop level, the
+     * consumer is the only reader of the buffer of the producer, and that
+     * buffer is a GPU temporary without a host copy (see add_mapping()), the
+     * producer is stored in a register instead, and the buffer is not
+     * allocated anymore.
+     *
+     * Consumers that read the values of neighbouring threads (stencils) are
+     * not fused: use cache_shared() for them.  Must be called after the
+     * computations are mapped to the GPU and before code generation.  It
+     * calls perform_full_dependency_analysis().  If \p apply is false, the
+     * fusions are only reported.
+     */
+    std::vector<tiramisu::fusion_info> fuse_gpu_kernels(bool apply = true);
+
+    /**
+     * \brief Fuse \p consumer with \p producer at the loop level \p level,
+     * shifting the loops of the consumer so that the fusion is legal.
+     *
+     * \details Stencil chains (e.g. a blur along x then along y, or an edge
+     * detector) read their producer at neighbouring points: the loops of the
+     * consumer cannot be fused with the loops of the producer as they are,
+     * but they can once the consumer is shifted by the reach of its reads.
+     * The shifts of the loop levels 0 to \p level of the consumer are computed
+     * from the dependences of the function (see compute_fusion_shifts()),
+     * then, if \p apply is true, the consumer is shifted (computation::shift())
+     * and ordered after the producer at \p level (computation::after()).
+     *
+     * This method uses the dependence analysis, it must be called after the
+     * computations are ordered and mapped to their buffers, and before the
+     * other scheduling commands. It calls perform_full_dependency_analysis().
+     *
+     * The returned fusion has the level \p level if the fusion is legal with
+     * shifts, and its previous level otherwise (nothing is changed then).  Its
+     * cost, redundant_iterations, is the number of iterations of the fused
+     * loops that only execute one of the two computations.
+     */
+    tiramisu::fusion_info fuse_with_shifting(tiramisu::computation *producer, tiramisu::computation *consumer,
+                                             int level, bool apply = true);
+
+    /**
+     * \brief Replace the schedules of the computations with a schedule computed
+     * by the polyhedral scheduler of isl.
+     *
+     * \details The scheduler looks for affine schedules that respect the
+     * dependences of the function (see perform_full_dependency_analysis()),
+     * while keeping the producers close to their consumers and exposing outer
+     * parallel loops (Pluto-style tiling hyperplanes).  It gives a baseline
+     * schedule for the functions that were not scheduled by hand or by the
+     * auto-scheduler.
+     *
+     * The permutable bands of at least two loops are tiled by \p tile_size
+     * (no tiling if \p tile_size is 1 or less), and if \p parallelize is
+     * true, the outermost parallel loop of each computation is tagged
+     * parallel.
+     *
+     * This method must be called after the computations are mapped to their
+     * buffers, instead of the other scheduling commands: the ordering of the
+     * computations is given by the new schedules, the ordering commands
+     * (computation::after(), ...) are discarded.  The loop levels of the new
+     * schedules have generated names.
+     *
+     * Return false, without changing the schedules, if isl does not find a
+     * schedule or if several computations have the same name.
+     *
+     * \code
+     * tiramisu::init("blur");
+     * ...
+     * tiramisu::compute_polyhedral_schedule(32);
+     * tiramisu::codegen({&b_input, &b_output}, "build/generated_fct_blur.o");
+     * \endcode
+     */
+    bool compute_polyhedral_schedule(int tile_size = 32, bool parallelize = true);
+
+    /**
+     * \brief Choose the order of the dimensions of the temporary buffers from
+     * the way they are read.
+     *
+     * \details This method uses the dependence analysis, it must be called
+     * after the schedules of the computations are set and the computations are
+     * mapped to their buffers, and before code generation. It calls
+     * perform_full_dependency_analysis().
+     *
+     * The temporary buffers are selected as in minimize_temporaries_storage().
+     * For each computation that reads values from such a buffer, the elements
+     * read by two successive iterations of its innermost loop are compared: if
+     * they only differ along one dimension of the buffer, the computation votes
+     * for that dimension. The dimension that gets the most votes becomes the
+     * innermost (contiguous) dimension of the buffer, if it gets more votes than
+     * the current innermost dimension; e.g. a temporary that is produced row by
+     * row but consumed column by column is transposed.
+     *
+     * The layout is changed by remapping the accesses of the computations that
+     * write the buffer (as store_in() does), so the computations that read it are
+     * not changed and no copy is added. This method should be called before
+     * minimize_temporaries_storage().
+     */
+    void optimize_temporaries_layout();
+
+    /**
+     * \brief Compute the intermediate integer values of the computations in
+     * the narrowest type that cannot overflow.
+     *
+     * \details Image pipelines on p_uint8 images usually promote their
+     * intermediate values to p_int32 (or p_uint32), which divides by four the
+     * number of lanes of a vector.  This method replaces the expression of
+     * each computation by narrow_integer_types() of it, e.g. the sum of
+     * three p_uint8 pixels promoted to p_int32 is computed in p_uint16.
+     *
+     * The ranges of the values come from the types of the inputs, from
+     * \p value_ranges (the ranges known for some inputs or computations, by
+     * name), and from the computations that are defined once and that were
+     * already narrowed: the computations are processed in the order of
+     * their declaration, so a consumer uses the range of the values of its
+     * producers.  It must be called before code generation.
+     */
+    void narrow_integer_types(const tiramisu::value_ranges_t &value_ranges = {});
+
     /**
       * \brief Compute the bounds of each computation.
       *
@@ -1070,6 +1978,15 @@ public:
       */
     void dump_iteration_domain() const;
 
+    /**
+      * \brief Dump the memory used by the compiler.
+      * \details Print the bytes allocated on the heap of the process (when
+      * the C library reports them) and the number of isl sets and maps held
+      * by the computations of the function.  Both should stay flat across
+      * reset_schedules() cycles, e.g. during auto-scheduling.
+      */
+    void dump_memory_usage() const;
+
     /**
       * \brief Dump the schedules of the computations of the function.
       * \details This function is mainly useful for debugging.
@@ -1125,6 +2042,12 @@ public:
       */
     void gen_flexnlp_autocopy();
 
+    /**
+      * \brief Replace the FlexNLP calls with the calls of the asynchronous
+      * FlexNLP runtime if it is enabled (see enable_flexnlp_async_runtime()).
+      */
+    void gen_flexnlp_async_calls();
+
     // TODO:FLEXNLP Add documentation
     void gen_halide_bug_workaround_computations();
 
@@ -1154,6 +2077,17 @@ public:
                         const tiramisu::hardware_architecture_t hw_architecture,
 			bool gen_python = false) const;
 
+    /**
+      * \overload
+      *
+      * Generate code for \p target with its own features (e.g. SVE2 with
+      * vector_bits, or RVV), instead of the default features of its architecture.
+      * Large buffers and the features added with add_target_feature() are enabled.
+      */
+    void gen_halide_obj(const std::string &obj_file_name, const Halide::Target &target,
+                        const tiramisu::hardware_architecture_t hw_architecture,
+                        bool gen_python = false) const;
+
     /**
       * \overload
       */
@@ -1175,8 +2109,408 @@ public:
       */
     void gen_halide_stmt();
 
+    /**
+      * \brief Carve the temporary buffers of the function from a single workspace.
+      *
+      * \details When enabled, gen_halide_stmt() allocates one workspace at the
+      * entry of the function, and each host temporary buffer that has constant
+      * extents becomes a sub-buffer at a fixed offset of the workspace (aligned
+      * to TIRAMISU_BUFFER_ARENA_ALIGNMENT bytes) instead of being allocated
+      * with malloc.  This includes the buffers allocated inside loops with
+      * computation::allocate_at(), which then do not call the allocator at each
+      * iteration.  The buffers allocated inside parallel loops keep their own
+      * allocation, since each thread needs a private copy.
+      *
+      * The object file generated by codegen() then also contains, assuming
+      * the function is named NAME:
+      *  - NAME_workspace_size(halide_buffer_t *size), that writes the size in
+      *    bytes of the workspace in the 0-dimensional int64 buffer \p size,
+      *  - NAME_with_workspace(arguments..., halide_buffer_t *workspace), that
+      *    computes the same thing as NAME, but uses the workspace given by the
+      *    caller (a 1-dimensional uint8 buffer of at least NAME_workspace_size()
+      *    bytes) instead of allocating it, so that it does not allocate the
+      *    temporary buffers that are carved from the workspace.
+      *
+      * Must be called before code generation.
+      */
+    void enable_buffer_arena(bool enable = true);
+
+    /**
+      * \brief Capture the GPU work of the function in a CUDA graph and replay
+      * it in the next calls.
+      *
+      * \details When enabled, the first call of the generated function with
+      * a given set of argument buffers (their addresses) and of values of the
+      * integer invariants (e.g. the sizes) records its kernel launches, its
+      * host/device copies and its device allocations in a CUDA graph instead
+      * of issuing them one by one, and then launches the graph.  The next
+      * calls with the same arguments only launch the graph again, which
+      * removes the CPU overhead of each kernel launch and copy.  The graph
+      * keeps the device buffers allocated during the capture, so the calls
+      * that replay it do not allocate.  tiramisu_cuda_graph_reset() (in the
+      * CUDA wrappers) destroys the graphs and frees their buffers, and
+      * setting TIRAMISU_CUDA_NO_GRAPH at run time disables the capture.
+      *
+      * Since host code is not replayed, all the computations of the function
+      * must run on the GPU, be host/device copies, or be calls to the CUDA
+      * libraries; a host temporary buffer or a host computation raises an
+      * error.  Streams (see computation::tag_gpu_stream()) are folded into
+      * the graph, in the order of the computations.
+      *
+      * Must be called before code generation, which must generate CUDA code.
+      */
+    void enable_cuda_graph(bool enable = true);
+
+    /**
+      * \brief Queue the FlexNLP calls of the function on the asynchronous
+      * FlexNLP runtime instead of running them one after the other.
+      *
+      * \details When enabled, codegen() with arch_flexnlp replaces each call
+      * of the FlexNLP wrappers (flexnlp_initialize(), flexnlp_load_weights(),
+      * flexnlp_lstm_cell(), ...) with the call of the same name prefixed with
+      * tiramisu_flexnlp_async_ in the runtime (src/tiramisu_flexnlp_runtime.cpp,
+      * built as the flexnlp_runtime library with USE_FLEXNLP).  The runtime
+      * queues the calls on their device and returns at once: each device has
+      * a worker for the transfers and a worker for the operators, so the host,
+      * the transfers and the operators of all the devices overlap.  The loads
+      * of the next operator of a device run while the current one computes
+      * (double buffering), and the commands that touch the same host memory
+      * (e.g. the output of a layer and the input of the next one) run in the
+      * order of the calls, even on different devices.
+      *
+      * flexnlp_lstm_cell() with a negative device runs on the device with the
+      * least queued work, and flexnlp_lstm_cell_balanced() splits its batch
+      * between all the devices, in proportion to their measured speed; these
+      * two need the runtime.  flexnlp_finalize() waits for all the queued
+      * commands, and the host computations that read the results of the
+      * accelerators before it must be preceded by flexnlp_synchronize().
+      *
+      * Must be called before code generation.
+      */
+    void enable_flexnlp_async_runtime(bool enable = true);
+
+    /**
+      * \brief Separate the full tiles of the loops from their partial tiles.
+      *
+      * \details When a loop is split or tiled by a size that does not
+      * divide its extent, the bounds of its inner loops are a min() of the
+      * tile size and of the remaining iterations, which prevents the inner
+      * loops from being vectorized or unrolled with constant bounds.  When
+      * enabled, the code generator asks isl to separate each loop level:
+      * the iterations of the full tiles are generated in a loop whose inner
+      * loops have constant trip counts, and the remaining iterations in a
+      * separate loop nest.  The computations of the function do not need any
+      * explicit separate().
+      *
+      * This duplicates the bodies of the loops that have partial tiles, so
+      * it increases the size of the generated code.  vectorize() and unroll()
+      * already separate the loop level they transform.  Must be called
+      * before code generation.
+      */
+    void enable_full_tile_separation(bool enable = true);
+
+    /**
+      * \brief Set the options of the isl AST generator for the whole function.
+      *
+      * \details By default, all are true.
+      *  - \p atomic_upper_bound: when the upper bound of a loop is the
+      * minimum of several expressions, generate a single loop with a min()
+      * bound rather than several loops.
+      *  - \p detect_min_max: simplify the bounds and the conditions into
+      * min() and max() expressions.  Disabling it gives bounds that are
+      * sometimes simpler for the compiler to analyze.
+      *  - \p allow_else: generate if-else statements; otherwise each branch
+      * gets its own condition.
+      *
+      * The options of specific loop levels are set with
+      * computation::set_ast_option().  Must be called before code generation.
+      */
+    void set_ast_build_flags(bool atomic_upper_bound, bool detect_min_max, bool allow_else);
+
+    /**
+      * \brief Print the time spent in each phase of code generation.
+      *
+      * \details When enabled, codegen() prints to the standard output the
+      * time spent in gen_time_space_domain(), gen_isl_ast(), gen_halide_stmt()
+      * and gen_halide_obj(), the latter being itself broken down into the
+      * lowering of the Halide statement, the generation of the object file
+      * by LLVM and, for GPU code, the compilation by nvcc.  This tells which
+      * phase to look at when the generation of a function is slow.
+      *
+      * The number of isl operations performed by each phase is printed too,
+      * which helps comparing the isl options of the code generator.
+      *
+      * The report can also be enabled without recompiling the generator by
+      * setting the environment variable TIRAMISU_COMPILE_TIME_REPORT.  When
+      * the environment variable TIRAMISU_COMPILE_TRACE is set to a file name,
+      * the phases (including perform_full_dependency_analysis()) of all the
+      * functions generated by the process are also written to that file in
+      * the Chrome trace event format, which chrome://tracing or Perfetto can
+      * display.
+      */
+    void enable_compile_time_report(bool enable = true);
+
+    /**
+      * Return the phases of code generation of the function performed so far
+      * (the dependence analysis, gen_ordering_schedules(), the phases of
+      * codegen() and of jit() listed in enable_compile_time_report(), ...),
+      * with their time, their number of isl operations and the peak memory of
+      * the process when they ended.  codegen() also records its total time as
+      * the phase "codegen", so the phases overlap.  Used by the compile time
+      * benchmark of utils/code_generator.
+      */
+    const std::vector<tiramisu::compile_phase> &get_compile_phases() const;
+
+    /**
+      * \brief Profile the loop nests of the generated code.
+      *
+      * \details When enabled, each outermost loop nest of the generated
+      * function is wrapped with calls to tiramisu_profiler_start() and
+      * tiramisu_profiler_stop() (see tiramisu/externs.h), which accumulate
+      * the cycles spent in the loop nest, and optionally its cache misses and
+      * instructions.  A loop nest is named after the function and the
+      * computations fused in it, e.g. "resnet:conv,relu".  After running the
+      * function, query the counters with tiramisu_profiler_get_region() or
+      * print them with tiramisu_profiler_print(), to find which stage of a
+      * pipeline is the bottleneck.
+      *
+      * The inner loops are not instrumented, so profiling costs two calls
+      * per execution of an outermost loop nest.  Must be called before code
+      * generation.
+      */
+    void enable_profiling(bool enable = true);
+
+    /**
+      * \brief Also generate an entry point that processes a batch of inputs.
+      *
+      * \details When enabled, gen_halide_obj() also generates the entry point
+      * NAME_batched, whose buffer arguments have one more dimension, outermost
+      * (the last dimension of the halide_buffer_t), that indexes the elements
+      * of the batch.  The elements are processed by a parallel loop around the
+      * body of the function, each with its own temporary buffers, so small
+      * requests (e.g. the inference of one image) can be coalesced into one
+      * call that uses all the cores (see tiramisu_batcher_create() in
+      * tiramisu/externs.h).  The arguments must all have the same batch size.
+      * The buffers passed as a whole to external calls (e.g. BLAS) cannot be
+      * batched.  Must be called before code generation.
+      */
+    void enable_batching(bool enable = true);
+
+    /**
+      * \brief Also generate an entry point that takes raw pointers instead of
+      * halide_buffer_t descriptors.
+      *
+      * \details When enabled, gen_halide_obj() also generates the entry point
+      * NAME_raw, whose arguments are pointers to the first elements of the
+      * arguments of the function, in the same order, and the header
+      * OBJ_FILE_NAME_raw.h, which declares a typed C++ wrapper of it, e.g.
+      *
+      * \code
+      * namespace tiramisu_raw { inline int blur(const float *input, float *output); }
+      * \endcode
+      *
+      * The buffers are dense arrays in row-major order (the first dimension of
+      * a tiramisu::buffer is the outermost) of the sizes declared in the
+      * buffers, which must all be constants.  Nothing is checked when the
+      * entry point is called, which removes the cost of filling and checking
+      * the buffer descriptors for the small kernels called very often.
+      *
+      * The function must not need the descriptors of its arguments: the
+      * arguments cannot be passed to external calls (e.g. BLAS), copied to
+      * a GPU, mapped from files or batched.  Must be called before code
+      * generation.
+      */
+    void enable_raw_entry_point(bool enable = true);
+
+    /**
+      * \brief Execute the parallel loops (see computation::tag_parallel_level())
+      * with OpenMP or oneTBB instead of the Halide thread pool.
+      *
+      * \details The generated function installs the do_par_for of \p backend
+      * (tiramisu_openmp_do_par_for() or tiramisu_tbb_do_par_for(), see
+      * tiramisu/externs.h) when it starts, and restores the previous one when
+      * it returns, so its parallel loops run in the thread pool shared with
+      * MKL and the rest of the application instead of oversubscribing the
+      * cores with a second pool.  The do_par_for of the Halide runtime is
+      * global, so functions that use different backends must not run
+      * concurrently.
+      *
+      * With OpenMP, \p chunk_size 0 is schedule(static) and a positive
+      * \p chunk_size is schedule(dynamic, chunk_size).  With TBB, it is the
+      * grain size of the range (0 lets TBB partition the range).  The backends
+      * are only available when Tiramisu is built with USE_OPENMP or USE_TBB,
+      * otherwise the parallel loops use the Halide runtime.  Must be called
+      * before code generation.
+      */
+    void set_parallel_backend(tiramisu::parallel_backend_t backend, int chunk_size = 0);
+
+    /**
+      * \brief Declare the GPU kernels with __launch_bounds__, so that nvcc
+      * limits their registers to run at least \p min_blocks_per_multiprocessor
+      * blocks on each multiprocessor.
+      *
+      * \details Only the kernels whose number of threads per block is a
+      * constant get launch bounds.  Limiting the registers raises the
+      * occupancy, but may make the kernels spill registers to local memory:
+      * check the resources of the kernels with get_gpu_kernel_resources().
+      * Must be called before code generation.
+      */
+    void set_gpu_launch_bounds(int min_blocks_per_multiprocessor = 1);
+
+    /**
+      * \brief Check that the GPU threads of each computation mapped to the
+      * GPU access the buffers in global memory with coalescing.
+      *
+      * \details The accesses are coalesced when consecutive threads along
+      * the thread x dimension access the same element, or consecutive
+      * elements of the contiguous (last) dimension of the buffer, as computed
+      * from the access relations and the sizes of the buffers (see
+      * computation::get_buffer_access_strides()).  A warning is printed for
+      * each access that is not coalesced, and returned.  When
+      * set_gpu_coalescing_remap() is enabled, thread x and thread y of a
+      * computation are swapped instead when this leaves fewer accesses
+      * uncoalesced.  The accesses that stay uncoalesced can be staged through
+      * shared memory with cache_shared().
+      *
+      * Called by the code generator, after the GPU mapping.
+      */
+    std::vector<std::string> check_gpu_coalescing();
+
+    /**
+      * Swap thread x and thread y of the GPU computations when this coalesces
+      * their accesses to global memory (see check_gpu_coalescing()).
+      * Must be called before code generation.
+      */
+    void set_gpu_coalescing_remap(bool remap = true);
+
+    /**
+      * \brief Place the GPU buffers in constant memory or in the read-only
+      * data cache from the accesses of the kernels.
+      *
+      * \details The GPU buffers that no computation writes (other than the
+      * host-device copies) are read-only.  A read-only GPU buffer of
+      * constant size, with a corresponding host buffer (see add_mapping()),
+      * whose accesses in the kernels are uniform, i.e. the same for all the
+      * threads of a block (the stride of the accesses at the thread levels
+      * is 0, see computation::get_buffer_access_strides()), is tagged
+      * with buffer::tag_gpu_constant() if it fits in the \p
+      * constant_memory_bytes bytes of constant memory, which are given to
+      * the smallest buffers first.  The other read-only buffers in global
+      * memory are tagged with buffer::tag_gpu_read_only().  The buffers
+      * that the user placed in constant memory count in the size limit.
+      *
+      * Typical candidates are the filters of convolutions and the lookup
+      * tables.  Called by codegen(), before the copies of
+      * Automatic_communication(), if enable_gpu_buffer_placement() was
+      * called.  Return the names of the buffers placed in constant memory.
+      */
+    std::vector<std::string> place_gpu_buffers(int64_t constant_memory_bytes = 65536);
+
+    /**
+      * Call place_gpu_buffers() with \p constant_memory_bytes when the code
+      * is generated.  Must be called before code generation.
+      */
+    void enable_gpu_buffer_placement(int64_t constant_memory_bytes = 65536);
+
+    /**
+      * \brief Return the resources used by each GPU kernel of the function:
+      * registers, shared memory, spills (reported by ptxas), and the occupancy
+      * of the multiprocessors that they allow.
+      *
+      * \details The resources are known once gen_halide_obj() has compiled the
+      * CUDA code.  The occupancy is computed for the architecture given by
+      * TIRAMISU_CUDA_ARCH (sm_70 by default), and only for the kernels whose
+      * number of threads per block is a constant.  It is the theoretical
+      * occupancy, which the achieved occupancy measured by a profiler cannot
+      * exceed.  Kernels that spill registers are reported on stderr.
+      */
+    std::vector<cuda_ast::kernel_resources> get_gpu_kernel_resources() const;
+
+    /**
+      * Add \p feature to the features of the target for which gen_halide_obj()
+      * generates code (by default AVX, SSE4.1 and large buffers).  For example,
+      * the dot product instructions of AVX512-VNNI and AVX512-BF16 are only
+      * used with Halide::Target::AVX512_SapphireRapids (see
+      * computation::vectorize_reduction()).  The generated code then only runs
+      * on the processors that have the feature.
+      */
+    void add_target_feature(Halide::Target::Feature feature);
+
+    /**
+      * Generate code for \p target instead of the host machine when codegen()
+      * is called, e.g. to cross-compile for
+      *  - Graviton 2/3 with NEON: Halide::Target("arm-64-linux-arm_dot_prod-arm_fp16"),
+      *  - A64FX with SVE: Halide::Target("arm-64-linux-sve2-vector_bits_512"),
+      *  - RISC-V with the V extension: Halide::Target("riscv-64-linux-rvv-vector_bits_256").
+      *
+      * Halide generates SVE and RVV code for the fixed vector length
+      * vector_bits, which must be the one of the machine.  The target also gives
+      * the default vector length of computation::vectorize(var) (see
+      * get_default_vector_length()), so it should be set before scheduling.
+      */
+    void set_target(const Halide::Target &target);
+
+    /**
+      * Return the target of the code generated by codegen(): the target given
+      * to set_target() or, by default, the host machine with AVX and SSE4.1
+      * on x86, with large buffers and the features added with
+      * add_target_feature().
+      */
+    Halide::Target get_target() const;
+
+    /**
+      * Return the number of elements of type \p type in a vector register of
+      * the target (see get_target()): e.g. 8 float32 with AVX, 4 with NEON,
+      * 16 with 512-bit SVE.
+      */
+    int get_default_vector_length(tiramisu::primitive_t type) const;
+
+    /**
+      * Return the size in bytes of the workspace used to allocate the temporary
+      * buffers (see enable_buffer_arena()).  It is computed by gen_halide_stmt(),
+      * and is 0 if no buffer is allocated in the workspace.
+      */
+    int64_t get_buffer_arena_size() const;
+
+    /**
+      * Return the name of the workspace (see enable_buffer_arena()).
+      */
+    std::string get_buffer_arena_name() const;
+
+    /**
+      * Choose the layout of the buffers in GPU shared memory whose layout is
+      * shared_auto (see buffer::set_shared_layout()).
+      */
+    void choose_gpu_shared_layouts();
+
     void gen_cuda_stmt();
 
+    /**
+      * Generate the GPU kernels in OpenCL C instead of CUDA, for the GPUs of
+      * AMD and Intel (codegen() with arch_opencl_gpu).
+      *
+      * The kernels are built from the same cuda_ast nodes as with
+      * gen_cuda_stmt(): the GPU block levels (tag_gpu_block_level()) are the
+      * work-groups, the GPU thread levels (tag_gpu_thread_level()) the
+      * work-items of a work-group, and the buffers in shared memory
+      * (tag_gpu_shared()) are in local memory.  gen_halide_obj() writes the
+      * kernels, and the wrappers that launch them with tiramisu_opencl_launch(),
+      * to OBJ_FILE_opencl.cpp, to be compiled and linked with the object file
+      * and the OpenCL wrappers of Tiramisu (built with USE_OPENCL), which also
+      * implement the GPU allocations and copies with shared virtual memory.
+      *
+      * Persistent kernels, tensor cores, asynchronous copies to shared memory,
+      * constant memory, complex numbers and bfloat16 are CUDA only.  Must be
+      * called after gen_isl_ast().
+      */
+    void gen_opencl_stmt();
+
+    /**
+      * Write the function as a C source file \p c_filename (see codegen_c()).
+      * gen_isl_ast() must be called before calling this function.
+      */
+    void gen_c_source(const std::string &c_filename);
+
     /**
       * Generate an isl AST that represents the function.
       */
@@ -1191,6 +2525,49 @@ public:
       */
     void gen_time_space_domain();
 
+    /**
+      * Return a string that identifies the current schedule of the function :
+      * the trimmed time-processor domain, the aligned identity schedules and
+      * the loop tags (parallel, reduction, scan, vector, unroll, GPU, persistent GPU, tensor core and distributed dimensions) and the isl AST build options.
+      * Two states of the function that have the same signature generate the same
+      * isl AST and the same Halide statement.
+      * gen_time_space_domain() must be called before calling this function.
+      */
+    std::string get_schedules_signature() const;
+
+    /**
+      * Save the schedule of the function in the text file \p filename, so that
+      * a schedule tuned once (by hand or by the auto-scheduler) can be applied
+      * again when the function is generated, with apply_schedule_file().
+      *
+      * The file stores, one per line, the schedule of each computation (an isl
+      * map, with its ordering) and the loop tags (parallel, vector, unroll, GPU
+      * and distributed dimensions):
+      * \code
+      * tiramisu_schedule 1
+      * schedule S0 0 { S0[i, j] -> S0[0, 0, i, 0, j, 0] }
+      * parallel S0 0
+      * vector S0 1 8
+      * \endcode
+      * Computations are identified by their name, and by their rank among the
+      * computations that have the same name.  Lines starting with '#' and lines
+      * whose keyword is unknown (e.g. the optimizations recorded by the
+      * auto-scheduler) are ignored.
+      */
+    void save_schedule_file(const std::string &filename);
+
+    /**
+      * Apply the schedule saved by save_schedule_file() in \p filename to the
+      * computations of the function, instead of their current schedules and
+      * loop tags.  The schedules are used as low-level schedules: the ordering
+      * commands (after(), then(), ...) are discarded.
+      *
+      * The computations created by scheduling commands (e.g. cache_shared_operation())
+      * are not recreated: the commands that create them must be called again
+      * before applying the file.
+      */
+    void apply_schedule_file(const std::string &filename);
+
     /**
       * Return the invariant of the function that has
       * the name \p str.
@@ -1215,6 +2592,67 @@ public:
     void codegen(const std::vector<tiramisu::buffer *> &arguments, const std::string obj_filename, const bool gen_cuda_stmt = false, bool gen_python = false);
     void codegen(const std::vector<tiramisu::buffer *> &arguments, const std::string obj_filename, const tiramisu::hardware_architecture_t gen_architecture_flag, bool gen_python = false);
 
+    /**
+     * Compile the function for the host in memory, with the Halide JIT, and
+     * return the compiled module.  Its entry point argv_function() takes the
+     * same arguments as NAME_argv in an object file generated by codegen():
+     * an array of pointers to the halide_buffer_t of \p arguments.
+     *
+     * The compiled modules are cached by schedule (see get_schedules_signature()):
+     * going back to a schedule that was already compiled, e.g. when trying
+     * several schedules, does not compile it again.  The key also holds the
+     * types and the sizes of the buffers and the options of the code generator.
+     * The expressions of the computations are not part of the key.
+     */
+    Halide::Internal::JITModule jit(const std::vector<tiramisu::buffer *> &arguments);
+
+    /**
+     * Generate the function as a C source file, for targets that cannot use
+     * the object files of codegen() (e.g. without an LLVM backend).  The file
+     * defines "void NAME(T *restrict arg, ...)", where the arguments are the
+     * buffers of \p arguments as flat arrays, and compiles as C99 or C++.
+     *
+     * The generated loops keep the optimizations of the schedule that do not
+     * need the Halide backend: the parallel levels get "#pragma omp parallel for",
+     * the vectorized levels get "#pragma omp simd simdlen(v)" (compile with
+     * -fopenmp or -fopenmp-simd), the buffer arguments are declared restrict
+     * (they must not alias) and the temporary buffers are allocated aligned to
+     * TIRAMISU_ALIGNMENT (64 bytes by default).  GPU and distributed
+     * computations are not supported.
+     */
+    void codegen_c(const std::vector<tiramisu::buffer *> &arguments, const std::string &c_filename);
+
+    /**
+     * Return the computations that only depend on constant buffers (see
+     * buffer::set_constant()): the computations whose right-hand side only
+     * reads constant buffers and buffers that are themselves only written by
+     * such computations.  Only the computations stored in temporary buffers
+     * are considered, in the order of their declaration.
+     */
+    std::vector<tiramisu::computation *> get_constant_computations();
+
+    /**
+     * Generate the function with its computations that only depend on
+     * constant buffers (see get_constant_computations()) moved to a separate
+     * initialization function, e.g. the folding of a batch normalization into
+     * the weights of a convolution, or the transforms of the weights of a
+     * Winograd convolution.
+     *
+     * \p init_obj_filename gets the function NAME_init, whose arguments are
+     * the constant buffers of \p arguments followed by the precomputed
+     * buffers (the buffers written by the constant computations).
+     * \p obj_filename gets the function NAME, whose arguments are
+     * \p arguments followed by the precomputed buffers, and that does not
+     * compute them again.  The caller allocates the precomputed buffers,
+     * calls NAME_init once, and then NAME at each call.
+     *
+     * Return the precomputed buffers, in the order of the arguments.
+     */
+    std::vector<tiramisu::buffer *> codegen_with_init(const std::vector<tiramisu::buffer *> &arguments,
+                                                      const std::string &obj_filename,
+                                                      const std::string &init_obj_filename);
+
+
     /**
      * \brief Set the context of the function.
      * \details A context is an ISL set that represents constraints over the
@@ -1263,6 +2701,12 @@ public:
     */
     void calculate_dep_flow() ;
 
+    /**
+     * Free the dependencies computed by calculate_dep_flow(), so that the next
+     * call to calculate_dep_flow() recomputes them.
+    */
+    void free_dependencies();
+
     /**
      * Align schedules dimensions and adds the computation's order to them. 
      * This is done to correctly invoke calculate_dep_flow() method that performs dependence analysis
@@ -1294,6 +2738,18 @@ public:
     */
     bool loop_vectorization_is_legal(tiramisu::var i, std::vector<tiramisu::computation *> fused_computations);
 
+    /**
+     * Checks if the loop levels from \p level of the loop nest shared by \p first_computations
+     * and \p second_computations could legally be distributed (loop fission): the second
+     * computations are moved to a copy of the loops from \p level, executed after the loops
+     * of the first computations in each iteration of the outer loops.
+     * This is legal if no dependence from a second computation to a first one is carried by
+     * the distributed loops (or is within the same iteration of all the shared loops).
+     * The same requirements as loop_parallelization_is_legal() apply.
+     */
+    bool loop_distribution_is_legal(int level, std::vector<tiramisu::computation *> first_computations,
+                                    std::vector<tiramisu::computation *> second_computations);
+
     /**
      * resets all the static beta dimensions in all the computations to Zero.
      * This would allow the execution of fuction.generate_ordering many times without issues.
@@ -1313,6 +2769,19 @@ public:
     */
     std::vector<std::tuple<tiramisu::var,int>> correcting_loop_fusion_with_shifting(std::vector<tiramisu::computation*> previous_computations, tiramisu::computation current, std::vector<tiramisu::var> vars_subjected_to_shifting);
 
+    /**
+     * Computes the shifts of the loop levels \p first_shifted_level to \p level of \p consumer
+     * that would allow to legally order it after \p producers at the loop level \p level
+     * (as consumer.after(*producers.back(), level) would), with correcting_loop_fusion_with_shifting().
+     * Only the dependences between the consumer and the producers are considered, and the
+     * schedules are not modified.
+     * Return false if the fusion is impossible; otherwise \p shifts holds the shift of each
+     * loop level from 0 to \p level (0 for the levels before \p first_shifted_level).
+     * The same requirements as correcting_loop_fusion_with_shifting() apply.
+    */
+    bool compute_fusion_shifts(std::vector<tiramisu::computation *> producers, tiramisu::computation *consumer,
+                               int level, std::vector<int> &shifts, int first_shifted_level = 0);
+
     /**
      * Uses the dependency analysis to check if the specified schedules of computations are legal.
      * This method only tests the dependencies between the computations specified in the input and ignore the rest.
@@ -1499,11 +2968,88 @@ private:
       */
     tiramisu::primitive_t type;
 
+    /**
+      * The complex type of the elements of the buffer if it was declared
+      * with p_complex64 or p_complex128 (see the constructor), p_none
+      * otherwise.
+      */
+    tiramisu::primitive_t complex_type = tiramisu::p_none;
+
     /**
      * The location of the buffer (host if in memory, else where on GPU).
      */
     cuda_ast::memory_location location;
 
+    /**
+     * The alignment in bytes of the first element of the buffer
+     * (0 if it is not specified).
+     */
+    int alignment = 0;
+
+    /**
+     * The placement of the pages of the buffer on the NUMA nodes, and the
+     * node used by numa_bind.
+     */
+    tiramisu::numa_placement_t numa_placement = tiramisu::numa_default;
+    int numa_node = 0;
+
+    /**
+     * The number of slices of the buffer that are placed on different GPUs
+     * (0 if the buffer is allocated on the current GPU).
+     */
+    int gpu_partitions = 0;
+
+    /**
+     * True if the GPU buffer is allocated in managed memory, with the advice
+     * managed_advice (see set_gpu_managed()).
+     */
+    bool gpu_managed = false;
+    tiramisu::managed_advice_t managed_advice = tiramisu::managed_auto;
+
+    /**
+     * True if the vector stores to the buffer are non-temporal.
+     */
+    bool streaming_stores = false;
+
+    /**
+     * True if the innermost dimension of the buffer holds the interleaved
+     * channels of a pixel (see set_interleaved()).
+     */
+    bool interleaved = false;
+
+    /**
+     * True if the contents of the buffer do not change between two calls of
+     * the function (see set_constant()).
+     */
+    bool constant_contents = false;
+
+    /**
+     * The storage format of the buffer if it stores the entries of a sparse
+     * matrix, and the buffers that index these entries.
+     */
+    tiramisu::sparse_format_t sparse_format = tiramisu::sparse_dense;
+    std::vector<tiramisu::buffer *> sparse_index_buffers;
+    int sparse_chunk_size = 0;
+
+    /**
+     * True if the buffer is mapped from a file, and how (see set_mapped_file()).
+     */
+    bool mapped_file = false;
+    tiramisu::mmap_advice_t mapped_file_advice = tiramisu::mmap_auto;
+    bool mapped_file_huge_pages = false;
+    bool mapped_file_by_fd = false;
+
+    /**
+     * The layout of the buffer if it is in GPU shared memory (see set_shared_layout()).
+     */
+    tiramisu::shared_layout_t shared_layout = tiramisu::shared_auto;
+
+    /**
+     * True if all the loads of the GPU kernels from the buffer go through the
+     * read-only data cache (see tag_gpu_read_only()).
+     */
+    bool gpu_read_only = false;
+
 protected:
     /**
      * Set the type of the argument. Three possible types exist:
@@ -1570,7 +3116,13 @@ public:
       * \p type is the type of the elements of the buffer.
       * It must be a primitive type (i.e. p_uint8, p_uint16, ...).
       * Possible types are declared in \ref tiramisu::primitive_t
-      * (in type.h).
+      * (in type.h).  A buffer of complex numbers (p_complex64 or
+      * p_complex128) stores the real and the imaginary part of each
+      * element next to each other, like an array of std::complex: it is
+      * a buffer of p_float32 (or p_float64) with an additional innermost
+      * dimension of size 2, e.g. a Halide::Buffer<float>(2, N1, N0) for
+      * the sizes {N0, N1}.  Computations still access it with one index
+      * per dimension of \p dim_sizes.
       *
       * \p argt indicates whether this buffer is an input or an output
       *  buffer and whether it should be allocated automatically by Tiramisu.
@@ -1784,6 +3336,14 @@ public:
       */
     tiramisu::primitive_t get_elements_type() const;
 
+    /**
+      * Return p_complex64 or p_complex128 if the buffer stores complex
+      * numbers, in which case its elements are their real and imaginary
+      * parts, and its last dimension is of size 2 (see the constructor).
+      * Return p_none otherwise.
+      */
+    tiramisu::primitive_t get_complex_type() const;
+
     /**
       * Return the sizes of the dimensions of the buffer.
       */
@@ -1809,6 +3369,284 @@ public:
       */
     void set_automatic_flexnlp_copy(bool automatic_flexnlp_copy);
 
+    /**
+     * Set the alignment in bytes (a power of two) of the first element
+     * of the buffer.
+     * For an input or an output buffer, this is a promise made by the caller
+     * of the generated function, that the code generator uses to emit aligned
+     * vector loads and stores.  For a temporary buffer carved from the
+     * workspace of the function (see function::enable_buffer_arena()), the
+     * offset of the buffer in the workspace is aligned accordingly.
+     */
+    void set_alignment(int alignment);
+
+    /**
+     * Return the alignment in bytes of the first element of the buffer
+     * (0 if it is not specified).
+     */
+    int get_alignment() const;
+
+    /**
+     * Set the placement of the pages of a temporary buffer on the NUMA nodes
+     * (\p node is the node used by numa_bind).
+     * With numa_first_touch, the buffer is not touched when it is allocated,
+     * so each page is placed on the node of the thread that writes it first:
+     * if the buffer is first written in a parallel loop, and later read in
+     * parallel loops that split the same dimension the same way (see
+     * tiramisu_numa_do_par_for() in externs.h), each thread mostly accesses
+     * local memory.
+     * The buffers that have a placement are not carved from the workspace
+     * of the function (see function::enable_buffer_arena()).
+     */
+    void set_numa_placement(tiramisu::numa_placement_t placement, int node = 0);
+
+    /**
+     * Return the placement of the pages of the buffer on the NUMA nodes.
+     */
+    tiramisu::numa_placement_t get_numa_placement() const;
+
+    /**
+     * Return the node used by the numa_bind placement.
+     */
+    int get_numa_node() const;
+
+    /**
+     * Split a GPU buffer (a buffer in cuda_ast::memory_location::global)
+     * into \p partitions slices of equal size along its outermost dimension,
+     * and place the slice p on the GPU p modulo the number of GPUs.
+     *
+     * The buffer is allocated in managed memory, so a single address is
+     * valid on every GPU: a kernel running on the GPU of a slice (see
+     * computation::tag_gpu_device_level()) accesses it in local memory, and
+     * reads the halo rows of the neighbouring slices directly from the other
+     * GPUs through peer-to-peer accesses.
+     */
+    void set_gpu_partitions(int partitions);
+
+    /**
+     * Return the number of slices of the buffer placed on different GPUs
+     * (0 if the buffer is not partitioned).
+     */
+    int get_gpu_partitions() const;
+
+    /**
+     * Allocate a GPU buffer (a buffer in cuda_ast::memory_location::global)
+     * in CUDA managed memory, so that the kernels can use more memory than
+     * the GPU has: the pages migrate between the host and the GPU, and are
+     * evicted from the GPU when it is full, instead of the allocation
+     * failing.
+     *
+     * The copies generated by Automatic_communication() are followed by a
+     * prefetch to the GPU (cudaMemPrefetchAsync()) of the part of the buffer
+     * that each group of GPU computations accesses, in the order of the
+     * schedule, so that the pages migrate in bulk before the kernels run
+     * instead of faulting one by one.  \p advice is given to the driver
+     * with cudaMemAdvise() when the buffer is allocated; managed_auto
+     * chooses it from the accesses of the GPU computations.
+     */
+    void set_gpu_managed(tiramisu::managed_advice_t advice = tiramisu::managed_auto);
+
+    /**
+     * Return true if the buffer is allocated in managed memory.
+     */
+    bool is_gpu_managed() const;
+
+    /**
+     * Return the advice given to the driver for a buffer in managed memory.
+     */
+    tiramisu::managed_advice_t get_gpu_managed_advice() const;
+
+    /**
+     * Write the buffer with non-temporal (streaming) stores, that bypass
+     * the caches.  This is useful for a large output that is written once
+     * and not read again by the function (the output of a resize or of a
+     * color conversion for example): its lines do not evict the lines of
+     * the inputs from the caches, and they are not read from memory before
+     * being written.
+     * Only the contiguous vector stores of 128 or 256 bits (i.e. the stores
+     * of a computation vectorized along the innermost dimension of the
+     * buffer) are streamed; a store that is not aligned on its size is a
+     * regular store.  A fence is issued after each loop that streams.
+     */
+    void set_streaming_stores(bool streaming_stores);
+
+    /**
+     * Return true if the vector stores to the buffer are non-temporal.
+     */
+    bool get_streaming_stores() const;
+
+    /**
+     * Declare that the innermost dimension of the buffer holds the 2, 3 or
+     * 4 interleaved channels of each element of the other dimensions, e.g.
+     * a packed RGB image declared as {height, width, 3}.  The extent of the
+     * innermost dimension must be a constant.
+     *
+     * A computation vectorized along the width reads such a buffer with a
+     * stride of 3 or 4 elements.  The serial loops over the channels that
+     * are next to a vectorized loop, around it or inside it, are unrolled
+     * (see generator::unroll_interleaved_channels()), so that Halide lowers
+     * the loads of the channels to dense vector loads followed by shuffles
+     * that deinterleave them, and the stores of the channels to shuffles
+     * that interleave them followed by one dense vector store, instead of
+     * gathers and scatters.
+     */
+    void set_interleaved(bool interleaved = true);
+
+    /**
+     * Return the number of interleaved channels of the buffer, or 0 if it
+     * is not interleaved (see set_interleaved()).
+     */
+    int get_interleaved_channels() const;
+
+    /**
+     * Declare that the contents of this input buffer are the same at every
+     * call of the function (e.g. the weights and the normalization parameters
+     * of a layer used for inference).
+     * The computations that only depend on constant buffers can then be
+     * moved to a separate initialization function, that is called once (see
+     * function::codegen_with_init()).
+     */
+    void set_constant(bool constant = true);
+
+    /**
+     * Return true if the buffer was declared constant with set_constant().
+     */
+    bool is_constant() const;
+
+    /**
+     * Map this input or output buffer from a file instead of receiving it as
+     * a halide_buffer_t, so that the caller does not have to read the whole
+     * file into memory before calling the function.
+     *
+     * Besides the usual entry point, codegen() then generates the entry point
+     * NAME_mapped, whose arguments are those of the function except that each
+     * mapped buffer is replaced by the path of its file (a const char *
+     * argument named after the buffer followed by "_path") or, if \p by_fd,
+     * by a file descriptor open on it (an int32_t argument followed by "_fd",
+     * not closed by the function).  The file stores the elements of the
+     * buffer contiguously, in the layout of the buffer, and is mapped in
+     * memory for the duration of the call: an output file is created (or
+     * resized) as needed and its pages are written back by the kernel.
+     *
+     * \p advice is passed to madvise: with mmap_auto, it is mmap_sequential
+     * if the outermost dimension of the buffer is traversed in increasing
+     * order by the outermost loop of each computation that accesses it, and
+     * mmap_random otherwise.  If \p huge_pages, transparent huge pages are
+     * requested for the mapping.
+     *
+     * The mapped buffer cannot be passed to the external functions that take
+     * a halide_buffer_t.
+     */
+    void set_mapped_file(bool mapped = true, tiramisu::mmap_advice_t advice = tiramisu::mmap_auto,
+                         bool huge_pages = false, bool by_fd = false);
+
+    /**
+     * Return true if the buffer is mapped from a file (see set_mapped_file()).
+     */
+    bool is_mapped_file() const;
+
+    /**
+     * Return the access pattern announced for the file of the buffer, whether
+     * huge pages are requested, and whether the file is passed as a file
+     * descriptor.
+     */
+    tiramisu::mmap_advice_t get_mapped_file_advice() const;
+    bool get_mapped_file_huge_pages() const;
+    bool get_mapped_file_by_fd() const;
+
+    /**
+     * Declare that this one-dimensional buffer stores the entries of a sparse
+     * matrix in the format \p format, indexed by the one-dimensional buffers
+     * \p index_buffers:
+     *  - sparse_csr: {pos, crd}, the entries of the row i are stored at the
+     *    positions pos[i] to pos[i+1]-1, and crd[p] is the column of the
+     *    entry stored at the position p.
+     *  - sparse_csc: {pos, crd}, the same for the columns: crd[p] is the row
+     *    of the entry stored at the position p.
+     *  - sparse_coo: {row, col}, the row and the column of each entry.
+     *  - sparse_sell: {slice_ptr, crd}, SELL-C-sigma with C = \p chunk_size:
+     *    the rows, sorted by decreasing length inside windows of sigma rows,
+     *    are grouped in slices of C rows.  The slice s is stored from
+     *    slice_ptr[s] to slice_ptr[s+1]-1, column by column: the k-th entry
+     *    of its r-th row is at the position slice_ptr[s] + k * C + r, and the
+     *    rows shorter than the longest row of the slice are padded with
+     *    zeros.  C consecutive rows are thus contiguous, so that a loop over
+     *    the rows of a slice is vectorized.  crd[p] is the column of the
+     *    entry stored at the position p.  ELLPACK is a single slice.
+     *    The matrix is converted from CSR with tiramisu_csr_to_sell(), and
+     *    its format, C and sigma can be chosen from the lengths of its rows
+     *    with tiramisu_choose_sparse_format() (see externs.h).
+     *
+     * The entries of the matrix are iterated with a
+     * tiramisu::sparse_computation.
+     */
+    void set_sparse_format(tiramisu::sparse_format_t format, std::vector<tiramisu::buffer *> index_buffers,
+                           int chunk_size = 0);
+
+    /**
+     * Return the storage format of the buffer (sparse_dense if the buffer
+     * does not store a sparse matrix).
+     */
+    tiramisu::sparse_format_t get_sparse_format() const;
+
+    /**
+     * Return the buffers that index the entries of a sparse buffer
+     * (see set_sparse_format()).
+     */
+    const std::vector<tiramisu::buffer *> &get_sparse_index_buffers() const;
+
+    /**
+     * Return the number of rows of the slices of a sparse_sell buffer
+     * (see set_sparse_format()).
+     */
+    int get_sparse_chunk_size() const;
+
+    /**
+     * Store the buffer as if its dimension \p dim had \p padding more
+     * elements. The padding elements are never accessed.
+     * Padding the innermost dimension changes the stride of the outer
+     * dimensions, e.g. to keep each row aligned for vector loads, or to
+     * avoid cache conflicts between rows when the size of a row is a
+     * multiple of 4KB.
+     * For an input or an output buffer, the caller of the generated function
+     * must pass a padded buffer.
+     */
+    void pad_dimension(int dim, int padding);
+
+    /**
+     * Set the layout of the buffer in GPU shared memory (see tag_gpu_shared()
+     * and computation::cache_shared()).  When the threads of a warp read a
+     * column of a buffer whose rows are a multiple of 32 4-byte words, all
+     * the reads go to the same memory bank and are serialized.  The layouts
+     * that avoid these bank conflicts are
+     *  - shared_padded: the innermost dimension is padded by one 4-byte
+     * word, so that consecutive rows start in different banks,
+     *  - shared_skewed: element (r, c) of the two innermost dimensions is
+     * stored at column (c + r) % n of row r, n being the size of a row, so
+     * that the elements of a column are in different banks, without using
+     * more memory.  The rows and the columns can both be read without
+     * conflicts, which suits the tiles of a transposition.
+     *
+     * With shared_auto (the default), the layout is chosen when the code is
+     * generated, from the accesses to the buffer along the GPU thread x
+     * dimension of the computations: shared_skewed if the threads read or
+     * write a column and the rows are a multiple of 32 words, shared_padded if
+     * they read or write a column and the rows are an even number of words,
+     * shared_dense otherwise.  Use shared_dense to keep the buffer as it is.
+     */
+    void set_shared_layout(tiramisu::shared_layout_t layout);
+
+    /**
+     * Return the layout of the buffer in GPU shared memory.
+     */
+    tiramisu::shared_layout_t get_shared_layout() const;
+
+    /**
+     * Return the indices \p indices of an element of the buffer rearranged
+     * according to its shared memory layout (see set_shared_layout()).
+     */
+    std::vector<tiramisu::expr> get_shared_layout_indices(const std::vector<tiramisu::expr> &indices) const;
+
     /**
      * Return true if all extents of the buffer are literal integer
      * contants (e.g., 4, 10, 100, ...).
@@ -1837,6 +3675,10 @@ public:
     void tag_gpu_local();
     /* Tag the buffer as located in the GPU constant memory. */
     void tag_gpu_constant();
+    /** Load the buffer, in the GPU global memory, through the read-only data
+      * cache (__ldg()) in all the kernels, and not only in the gathers.  The
+      * kernels must not write the buffer (see function::place_gpu_buffers()). */
+    void tag_gpu_read_only();
 };
 
 /**
@@ -1863,6 +3705,8 @@ public:
 class computation
 {
     friend input;
+    friend block;
+    friend sparse_computation;
     friend function;
     friend generator;
     friend buffer;
@@ -1876,10 +3720,14 @@ class computation
     friend auto_scheduler::syntax_tree;
     friend auto_scheduler::ast_node;
     friend auto_scheduler::computation_info;
+    friend auto_scheduler::dnn_iterator;
     friend auto_scheduler::evaluate_by_execution;
+    friend auto_scheduler::evaluate_by_learning_model;
     friend auto_scheduler::state_computation;
     friend auto_scheduler::ml_model_schedules_generator;
     friend void auto_scheduler::unroll_innermost_levels(std::vector<tiramisu::computation*> const& comps_list, int unroll_fact);
+    friend void auto_scheduler::apply_distribution(auto_scheduler::syntax_tree const& ast, bool generate_communication);
+    friend void auto_scheduler::apply_local_transpositions(auto_scheduler::syntax_tree const& ast);
 
 private:
 
@@ -1961,6 +3809,14 @@ private:
       */
     std::vector<isl_ast_expr *> index_expr;
 
+    /**
+      * The index expressions of the software prefetches of this computation
+      * (see prefetch()), paired with the name of the prefetched buffer.
+      * Like index_expr, they are computed after the scheduling is done; there
+      * is one vector of prefetches per AST leaf of the computation.
+      */
+    std::vector<std::vector<std::pair<std::string, isl_ast_expr *>>> prefetch_index_expr;
+
     /**
      * A map between the original names of the iterators of a computation
      * and their transformed form after schedule (also after renaming).
@@ -2015,6 +3871,12 @@ private:
     /* Is true if the the computation is inline. */
     bool is_inline;
 
+    /**
+      * The implementation of the transcendental operators of the expression
+      * of the computation (see set_math_precision()).
+      */
+    tiramisu::math_precision_t math_precision = tiramisu::math_precise;
+
     /**
       * Iteration domain of the computation.
       * In this representation, the order of execution of computations
@@ -2094,6 +3956,13 @@ private:
      */
     var drop_level;
 
+    /**
+      * True if the accesses of this computation to the inputs that have a
+      * boundary condition are known to be inside the inputs, or were already
+      * bounded (see separate_borders() and function::lower_boundary_conditions()).
+      */
+    bool accesses_in_bounds = false;
+
     /**
       * If the computation represents a library call, this will contain the
       * necessary arguments to the function.
@@ -2557,6 +4426,18 @@ private:
       */
     bool is_library_call() const;
 
+    /**
+      * Return true if this computation is part of the inspector of the
+      * function (see mark_as_inspector()).
+      */
+    bool is_inspector() const;
+
+    /**
+      * Return true if the vectorized loops of this computation are reductions
+      * (see vectorize_reduction()).
+      */
+    bool is_vector_reduction() const;
+
     /**
       * Return true if the rank loop iterator should be removed from linearization.
       */
@@ -2820,6 +4701,32 @@ private:
     void update_names(std::vector<std::string> original_loop_level_names, std::vector<std::string> new_names,
                       int start_erasing, int nb_loop_levels_to_erase);
 
+    /**
+      * Return the constant bounds of the loop level \p L in \p lower and \p upper, and
+      * in \p costs the cost of each of its iterations: the volume of the bounding box of
+      * its slice of the iteration domain if \p estimate (see distribute()), 1 otherwise.
+      */
+    void get_iteration_costs(int L, int64_t &lower, int64_t &upper, std::vector<double> &costs, bool estimate);
+
+    /**
+      * Replace the loop level \p L by the loop levels \p names (the rank and the local
+      * iterations): the rank r gets the iterations from \p bounds[r] to \p bounds[r + 1] - 1
+      * if \p bounds is not empty, or the blocks of \p block_size iterations dealt to the
+      * \p nb_ranks ranks in a round-robin fashion otherwise.
+      */
+    void distribute(int L, int nb_ranks, const std::vector<int64_t> &bounds, int block_size,
+                    std::vector<std::string> names);
+
+    /**
+      * Return the slope of the diamond tiles of time_tile() on the loop
+      * levels \p L_t and \p L_i: the smallest slope such that the diamond
+      * tiles respect the dependences of the computation on itself, or
+      * -1 if there is none.  If \p slope is not 0, only check whether
+      * \p slope is legal (and return it, or -1).
+      * Uses the results of function::perform_full_dependency_analysis().
+      */
+    int get_time_tile_slope(int L_t, int L_i, int slope);
+
     /**
       * A vector describing the access variables in the original definition of  a computation.
       * For every named dimension, a pair representing the index of the named dimension
@@ -2842,6 +4749,23 @@ private:
       */
     int get_distributed_dimension();
 
+    /**
+      * Return all the distributed dimensions of a computation, from the
+      * outermost to the innermost.
+      */
+    std::vector<int> get_distributed_dimensions();
+
+    /**
+      * Return the extents of the distributed loop levels of the computation
+      * (the shape of its grid of ranks), from the outermost to the innermost
+      * distributed level.
+      * When several loop levels are distributed, the ranks are numbered in
+      * row-major order over this grid: the iterator of the k-th distributed
+      * level is (rank / (extent_{k+1} * ... * extent_{n-1})) % extent_k.
+      * The time-processor domain of the computation must have been generated.
+      */
+    std::vector<int> get_rank_grid();
+
     /**
       * Return names of trimmed time space domain dimensions.
       */
@@ -2878,9 +4802,40 @@ private:
       *
       * Given the iteration domain of send and receive, this function creates xfers, schedules them,
       * and handles the storage of the receives.
-      * Currently, this process works for programs that distribute the outermost loop.
+      * All the ranks of the iteration domains exchange data with the neighbour at the same
+      * \p offset in the grid of ranks of the producer (coordinates of the sender minus
+      * coordinates of the receiver), so the innermost loop levels of the transfers are collapsed
+      * into a single contiguous (or strided) message whenever the exchanged region is a box.
+      * Currently, this process works for programs that distribute the outermost loops.
       */
-    void gen_communication_code(isl_set*recv_it, isl_set* send_it, int communication_id, std::string computation_name);
+    void gen_communication_code(isl_set*recv_it, isl_set* send_it, int communication_id, std::string computation_name,
+                                std::vector<int> offset);
+
+    /**
+      * Enlarge the buffer of \p producer so that it can hold the elements received by the
+      * receive iteration domains \p recv_iter_doms (one per neighbour \p offsets), on both
+      * sides of each dimension. When elements are received before the first element of a
+      * dimension, the accesses to the buffer of all the computations are shifted.
+      */
+    void allocate_halo(tiramisu::computation *producer, const std::vector<isl_set *> &recv_iter_doms,
+                       const std::vector<std::vector<int>> &offsets);
+
+    /**
+      * Return the map from the receive iteration domain \p recv_iter_dom of the neighbour at
+      * \p offset to the elements of \p producer that it receives, in the local coordinates of
+      * the receiver (i.e. the position they would have if the receiver had computed them).
+      */
+    isl_map *get_received_elements(tiramisu::computation *producer, isl_set *recv_iter_dom,
+                                   const std::vector<int> &offset);
+
+    /**
+      * Create a buffer of requests for the nonblocking operation \p op, indexed by the
+      * dimensions \p request_dims of its iteration domain (of sizes \p sizes), and a wait
+      * on these requests. The wait has the same schedule as \p op (including collapsed loop
+      * levels) and is distributed like it; it still has to be ordered after \p op.
+      */
+    static tiramisu::wait *create_wait(tiramisu::communicator *op, const std::vector<int> &request_dims,
+                                       std::vector<tiramisu::expr> sizes, tiramisu::function *fct);
 
 protected:
 
@@ -2910,6 +4865,17 @@ protected:
       */
     bool _is_library_call;
 
+    /**
+      * True if this computation is part of the inspector of the function.
+      */
+    bool _is_inspector = false;
+
+    /**
+      * True if the vectorized loops of this computation are reductions
+      * (see vectorize_reduction()).
+      */
+    bool _is_vector_reduction = false;
+
     /**
       * If the computation represents a library call, this is the name of the function.
       */
@@ -3115,6 +5081,44 @@ protected:
       * Collapse all the iterations of a loop into one single iteration.
       */
     void full_loop_level_collapse(int level, tiramisu::expr collapse_from_iter);
+
+    /**
+      * Schedule \p comp right before the first computation of the loop level
+      * \p level that contains this computation, or right after the last one
+      * if \p last is true.
+      */
+    void schedule_at_level_boundary(computation *comp, int level, bool last);
+
+    /**
+      * The union of the accesses of this computation to \p inp, restricted to
+      * the iteration domains of both computations, or NULL if this computation
+      * does not read \p inp.
+      */
+    isl_map *get_accesses_to(const computation &inp);
+
+    /**
+      * Return the accesses of this computation to the buffers: the reads,
+      * through the access relations of the computations that are read, and
+      * the write.
+      */
+    std::vector<isl_map *> get_buffer_accesses();
+
+    /**
+      * If one of the loops of this computation up to the loop level \p level is
+      * parallel, allocate \p buff inside the innermost such loop, before the
+      * first computation of that loop that precedes \p first, so that each
+      * thread gets its own copy of \p buff.  The first dimensions of \p domain
+      * are the loop levels of \p first up to \p level; the allocation is
+      * named \p name.
+      */
+    void allocate_per_thread(buffer *buff, computation *first, isl_set *domain, int level, const std::string &name);
+
+    /**
+      * Like pack_operand(), except that the dimension \p order[i] of \p inp
+      * is the dimension i of the panel.
+      */
+    computation *pack_operand(computation &inp, const var &level, std::vector<int> const &order);
+
     /**
       * \overload
       */
@@ -3378,6 +5382,8 @@ public:
 
     virtual bool is_wait() const;
 
+    virtual bool is_collective() const;
+
     /**
        * \brief Add a let statement that is associated to this computation.
        * \details The let statement will be executed before the computation
@@ -3780,6 +5786,16 @@ public:
      void store_in(buffer *buff, std::vector<expr> iterators);
      // }@
 
+    /**
+      * Store the computation in the elements of a view: C(i, j, ...) is
+      * stored in the element of the buffer of the view \p v that V(i, j, ...)
+      * designates.  The computation and the view must have the same number of
+      * dimensions.  For example, a convolution stored in a slice of the buffer
+      * of a concatenation (see view::slice()) writes its result in place,
+      * without a copy into the concatenation.
+      */
+    void store_in(view *v);
+
     /**
       * \brief Resize the implicit buffer and remap the computation.
       *
@@ -3824,28 +5840,240 @@ public:
      * It should have the same dimensionality as the input computation.
      *
      * \p copy_offsets is the offset of the values that should be copied
-     * from input computation at iteration of each \p level.
+     * from input computation at iteration of each \p level.  An element of
+     * the input is stored in the shared buffer at its index modulo
+     * \p buffer_shape, so the offsets do not need to be aligned on the buffer
+     * shape (e.g. the tile of a stencil can include a halo).
      *
      * If \p pad_buffer is true, the innermost dimension of shared memory buffer
      * is padded by 1 which might help reduce the shared memory bank conflicts.
+     * Otherwise the layout of the shared buffer is chosen from the accesses of
+     * the threads (see buffer::set_shared_layout()).
+     *
+     * If \p stages is greater than 1, the copy is pipelined: the shared
+     * buffer gets an outer dimension of size \p stages, and the copy of the
+     * tile of iteration t of \p level is issued at iteration t - stages + 1,
+     * i.e. while the previous tiles are being computed on.  The copies are
+     * asynchronous (cp.async on sm_80 and later, through the CUDA pipeline
+     * primitives) when the element size allows it, and a single barrier per
+     * iteration, which waits only for the tile needed next, replaces the
+     * two __syncthreads() of the default mode.  The tile index is taken from
+     * the copy offset that depends on \p level, which must be a multiple of
+     * the corresponding buffer dimension (e.g. k0 * 32 for a width of 32).
+     * Each stage adds a tile to the shared memory footprint.
      *
      * Returns the new access computation for input.
      *
-     * An example use case for GEMM:
+     * An example use case for GEMM:
+     *
+     * \code
+     * computation C({i, j, k}, C(i, j) + A(i, k) * B(k, j));
+     * C.gpu_tile(i, j, 16, 16, i0, j0, i1, j1);
+     * C.split(k, 32, k0, k1);
+     * C.cache_shared(A, k0, {16, 32}, {i0 * 16, k0 * 32});
+     * C.cache_shared(B, k0, {32, 16}, {k0 * 32, j0 * 16});
+     * \endcode
+     *
+     * Double buffering both operands is done with
+     *
+     * \code
+     * C.cache_shared(A, k0, {16, 32}, {i0 * 16, k0 * 32}, false, 2);
+     * C.cache_shared(B, k0, {32, 16}, {k0 * 32, j0 * 16}, false, 2);
+     * \endcode
+     *
+     */
+    computation *cache_shared(computation &inp, const var &level,
+                      const std::vector<int> buffer_shape,
+                      const std::vector<expr> copy_offsets,
+                      bool pad_buffer=false, int stages=1);
+
+    /**
+     * Pack the panel of \p inp read by this computation inside each iteration
+     * of the loop level \p level into a contiguous, aligned scratch buffer, and
+     * make this computation read the panel instead of \p inp.
+     *
+     * This is the CPU counterpart of cache_shared(), except that the panel is
+     * derived automatically: its shape is the largest extent of the footprint
+     * of the accesses to \p inp for a fixed iteration of the loops
+     * surrounding \p level (it must be a constant), and the copy computation
+     * iterates exactly over that footprint, so partial tiles are handled
+     * without padding.  Elements are stored in the panel modulo its shape.
+     *
+     * If one of the loops surrounding \p level is parallel, the panel is
+     * allocated inside the innermost such loop so that each thread packs
+     * into its own panel.
+     *
+     * Returns the copy computation.
+     */
+    computation *pack_operand(computation &inp, const var &level);
+
+    /**
+     * The stride, in elements of the buffer of \p inp, between the elements
+     * of \p inp read by two consecutive iterations of the loop level \p level
+     * of this computation, the largest over the accesses to \p inp.  It is
+     * computed from the access relations (the access of this computation to
+     * \p inp, then the access relation of \p inp), so that the strided
+     * accesses that waste the cache lines (a stride larger than a cache line
+     * in the innermost loop) can be detected.  Returns 0 if the level does not
+     * move the accesses, and -1 if the stride is not a constant (e.g. the level
+     * moves along a dimension of a buffer that has parametric sizes).
+     */
+    long get_access_stride(computation &inp, int level);
+
+    /**
+     * Return true if two consecutive iterations of the loop level \p level of
+     * this computation read or write two elements of the buffer \p buff that
+     * are in the same column (the same innermost index) of two different
+     * rows, e.g. the threads of a warp when \p level is the GPU thread x
+     * dimension (see buffer::set_shared_layout()).
+     */
+    bool accesses_column_of(const tiramisu::buffer &buff, int level);
+
+    /**
+     * Return, for each access of this computation to a buffer (the write and
+     * the reads, through the computations that are read), the name of the
+     * buffer and the stride, in elements, between the elements accessed by two
+     * consecutive iterations of the loop level \p level: 0 if the level does
+     * not move the access, 1 if it moves along the contiguous dimension of the
+     * buffer, and -1 if the stride is not a constant.  The accesses to a GPU
+     * buffer are coalesced when the stride at the GPU thread x level is 0 or 1
+     * (see function::check_gpu_coalescing()).
+     */
+    std::vector<std::pair<std::string, long>> get_buffer_access_strides(int level);
+
+    /**
+     * Pack the panel of \p inp read inside each iteration of the loop level
+     * \p level, like pack_operand(), but transposed: the outermost dimension of
+     * \p inp along which the innermost loop of this computation moves is
+     * stored last in the panel, so that the innermost loop reads the panel
+     * contiguously.  This is a blocked transposed copy for the consumers that
+     * read their producer column-wise (e.g. transposed convolutions or the
+     * backward pass of a convolution).
+     *
+     * \code
+     * computation out({i, j}, in(j, i) * 2);
+     * out.tile(i, j, 32, 32, i0, j0, i1, j1);
+     * out.transpose_operand(in, j0);
+     * \endcode
+     *
+     * Returns the copy computation.
+     */
+    computation *transpose_operand(computation &inp, const var &level);
+
+    /**
+     * Cache the elements of \p inp accessed by this computation inside each
+     * iteration of the loop level \p level in a small, contiguous and aligned
+     * scratch buffer.  This is the CPU counterpart of cache_shared(): it cuts
+     * the TLB and conflict misses of strided accesses (e.g. in convolutions
+     * and transpositions).  The shape of the scratch buffer is derived from
+     * the footprint of the accesses, like in pack_operand(), and elements are
+     * stored in it modulo its shape.
+     *
+     * If \p inp is another computation, its elements are copied into the
+     * scratch buffer before the first computation of \p level (this is
+     * pack_operand()).
+     *
+     * If \p inp is this computation, the tile that it writes inside \p level
+     * is cached: the writes, and the reads of this computation to itself (e.g.
+     * the accumulator of a reduction, copied in first), go to the scratch
+     * buffer, and the tile is written back to the buffer of the computation
+     * after the last computation of \p level if \p write_back is true.  The
+     * other computations that read this computation read the written-back
+     * values; if \p write_back is false, the tile is a temporary that is only
+     * read inside \p level.
+     *
+     * \code
+     * computation out({i, j}, in(j, i));
+     * out.tile(i, j, 32, 32, i0, j0, i1, j1);
+     * out.cache_local(out, j0);
+     * \endcode
+     *
+     * Returns the copy computation (the copy-out when caching this
+     * computation, or NULL if there is none).
+     */
+    computation *cache_local(computation &inp, const var &level, bool write_back = true);
+
+    /**
+     * Recognize a matrix-multiply-like reduction of the form
+     * C(...) = C(...) + A(...) * B(...) in this computation and pack its two
+     * operands with pack_operand(): \p A at the loop level \p a_level and
+     * \p B at the loop level \p b_level.
+     *
+     * \p A is the operand that shares its first index with the accumulator,
+     * otherwise the left operand of the multiplication.  Casts around the
+     * operands are allowed.  An error is raised if the expression does not
+     * match this pattern.
+     *
+     * An example use case for GEMM (BLIS-like blocking):
+     *
+     * \code
+     * computation C({i, j, k}, C(i, j) + A(i, k) * B(k, j));
+     * C.tile(i, j, 64, 256, i0, j0, i1, j1);
+     * C.split(k, 128, k0, k1);
+     * C.interchange(j1, k0);
+     * C.interchange(i1, k0);
+     * C.pack_gemm_operands(k0, k0);
+     * \endcode
+     */
+    void pack_gemm_operands(const var &a_level, const var &b_level);
+
+    /**
+     * Stream the elements of \p inp read by this computation from the I/O
+     * stream \p stream instead of reading them from the buffer of \p inp, so
+     * that \p inp does not have to fit in memory.
+     *
+     * The loop level \p level becomes the stream dimension: before each of
+     * its iterations, the chunk of \p inp read by this computation inside
+     * that iteration (its footprint, halo included, derived from the access
+     * relations) is transferred into a ring buffer whose shape is the largest
+     * extent of the union of the footprints of two consecutive iterations (it
+     * must be a constant).  Elements are stored in the ring modulo its shape,
+     * so the elements shared with the chunk of the previous iteration are not
+     * transferred again.  The transfer of the next chunk
+     * (tiramisu_io_stream_read()) is issued one iteration ahead and runs on
+     * the I/O thread of the stream while the current chunk is computed;
+     * tiramisu_io_stream_wait() is called before the first computation of
+     * the level.  \p inp can have at most TIRAMISU_IO_STREAM_MAX_DIMS
+     * dimensions and the loops up to \p level cannot be parallel.
+     *
+     * The stream is bound at run time, before calling the generated function,
+     * to a callback (tiramisu_io_stream_set_reader()) or to a file mapped in
+     * memory (tiramisu_io_stream_map_file()).  The buffer of \p inp is not
+     * read anymore by this computation: if no other computation reads it,
+     * it should not be an argument of the generated function.
      *
      * \code
-     * computation C({i, j, k}, C(i, j) + A(i, k) * B(k, j));
-     * C.gpu_tile(i, j, 16, 16, i0, j0, i1, j1);
-     * C.split(k, 32, k0, k1);
-     * C.cache_shared(A, k0, {16, 32}, {i0 * 16, k0 * 32});
-     * C.cache_shared(B, k0, {32, 16}, {k0 * 32, j0 * 16});
+     * computation blur({t, i, j}, (in(t, i - 1, j) + in(t, i, j) + in(t, i + 1, j)) / 3);
+     * blur.tile(i, j, 64, 64, i0, j0, i1, j1);
+     * blur.stream_input(in, i0, 0);
      * \endcode
      *
+     * Returns the computation that issues the transfers.
      */
-    computation *cache_shared(computation &inp, const var &level,
-                      const std::vector<int> buffer_shape,
-                      const std::vector<expr> copy_offsets,
-                      bool pad_buffer=false);
+    computation *stream_input(computation &inp, const var &level, int stream);
+
+    /**
+     * Write the elements stored by this computation to the I/O stream
+     * \p stream incrementally instead of keeping the whole output buffer in
+     * memory.
+     *
+     * The elements stored inside each iteration of the loop level \p level
+     * go to a ring buffer (with the same shape rules as in stream_input()),
+     * and are transferred (tiramisu_io_stream_write()) by the I/O thread of
+     * the stream after the last computation of the level, while the next
+     * iteration is computed.  Two consecutive iterations of \p level cannot
+     * store the same elements.  tiramisu_io_stream_flush() is called after the
+     * loop nest, so all the elements are written when the generated function
+     * returns.
+     *
+     * The stream is bound with tiramisu_io_stream_set_writer() or
+     * tiramisu_io_stream_map_file().  The output buffer of this computation
+     * is not allocated anymore, and should not be an argument of the
+     * generated function.
+     *
+     * Returns the computation that issues the transfers.
+     */
+    computation *stream_output(const var &level, int stream);
 
     /**
       * This function assumes that \p consumer consumes values produced by
@@ -3889,6 +6117,52 @@ public:
     void compute_at(computation &consumer, tiramisu::var L);
     void compute_at(computation &consumer, int L);
 
+    /**
+      * Compute, in each iteration of the loop level \p L of the \p consumer,
+      * exactly the elements of this computation that the iteration reads.
+      *
+      * Unlike compute_at(consumer, L), the region computed by each iteration
+      * is the exact footprint of the reads of the consumer, computed with isl,
+      * instead of a shifted copy of the box of this computation.  \p halo
+      * selects how the elements read by several iterations (the halos of
+      * stencils) are handled:
+      *     - halo_recompute: each iteration computes its whole footprint, the
+      *     halos are computed again by each iteration that reads them.  The
+      *     iterations are independent, \p L can be parallel.
+      *     - halo_sliding_window: each iteration computes the part of its
+      *     footprint that the previous iteration of \p L did not compute,
+      *     and reads the rest from the buffer.  Nothing is recomputed, but
+      *     the iterations of \p L must run in order (it cannot be parallel).
+      *     The storage can then be folded to the extent of the window
+      *     (see storage_fold()).
+      *
+      * This computation is computed by a new computation, scheduled at the
+      * beginning of the level \p L of the consumer, that writes in the buffer
+      * of this computation.  This computation itself is not scheduled
+      * anymore, so the consumer must be its only consumer.
+      *
+      * Return the new computation.
+      */
+    computation *compute_at(computation &consumer, tiramisu::var L, tiramisu::halo_t halo);
+
+    /**
+      * Store this computation in a circular line buffer, for pipelines that
+      * process images row by row (e.g. a blur read by an edge detection).
+      *
+      * This computation is computed at the level \p L of the \p consumer with
+      * halo_sliding_window: each iteration of \p L only computes the new rows
+      * of the window read by the consumer.  The dimension of the buffer along
+      * which the window slides is then folded (see storage_fold()) to the
+      * number of rows of the window, rounded up to a power of two, so that the
+      * buffer only holds the rows still needed instead of the whole image.
+      *
+      * The buffer must be a temporary buffer used by this computation only,
+      * and the window must slide along a single dimension of the buffer.
+      *
+      * Return the computation that computes the new rows.
+      */
+    computation *line_buffer(computation &consumer, tiramisu::var L);
+
     /**
       * Generates the time-space domain and construct an AST that scans that
       * time-space domain, then compute the depth of this AST.
@@ -4105,6 +6379,137 @@ public:
                           var L0_inner, var L1_inner, var L2_inner);
     // @}
 
+    /**
+      * Same as gpu_tile(L0, L1, sizeX, sizeY, L0_outer, L1_outer, L0_inner, L1_inner),
+      * except that each thread computes \p coarseningX x \p coarseningY points
+      * instead of one (thread coarsening).  A block of \p sizeX x \p sizeY
+      * threads covers a tile of (\p sizeX * \p coarseningX) x
+      * (\p sizeY * \p coarseningY) points, and the points of a thread are
+      * spaced by the block size, so that consecutive threads still access
+      * consecutive addresses.
+      *
+      * The loops over the points of a thread are created inside the thread
+      * levels, i.e. the loop nest becomes
+      *
+      * \code
+      * L0_outer, L1_outer, L0_inner, L1_inner, L0 coarsening loop, L1 coarsening loop
+      * \endcode
+      *
+      * where L0_outer and L1_outer are mapped to GPU blocks and L0_inner and
+      * L1_inner to GPU threads.
+      */
+    virtual void gpu_tile(var L0, var L1, int sizeX, int sizeY,
+                          int coarseningX, int coarseningY,
+                          var L0_outer, var L1_outer,
+                          var L0_inner, var L1_inner);
+
+    /**
+      * \brief Coarsen the GPU thread level \p L: each thread computes
+      * \p factor iterations of \p L instead of one.
+      *
+      * \details \p L must be a thread level of the computation (see
+      * gpu_tile() and tag_gpu_level()).  It is split into the thread level
+      * \p L_thread, with \p factor times fewer threads, and the coarsening
+      * loop \p L_coarse, which is moved inside all the thread levels.  The
+      * number of blocks does not change.
+      *
+      * If \p strided is true, the iterations of a thread are spaced by the
+      * new number of threads along \p L, so that consecutive threads still
+      * access consecutive addresses; this needs the number of threads of
+      * \p L, i.e. a computation mapped with gpu_tile().  Otherwise a thread
+      * computes \p factor consecutive iterations.
+      *
+      * If \p unroll is true, \p L_coarse is unrolled (\p L_coarse can also
+      * be unrolled later with tag_unroll_level()): the loads that are the
+      * same in the iterations of a thread, and the index computations, are
+      * then done once per thread by nvcc.  The shared memory copies of
+      * cache_shared() use the new number of threads, so cache_shared() must
+      * be called after gpu_coarsen().
+      *
+      * For example
+      *
+      * \code
+      * C.gpu_tile(i, j, 16, 32, i0, j0, i1, j1);
+      * C.gpu_coarsen(j1, 4, j2, j3);
+      * \endcode
+      *
+      * launches blocks of 16 x 8 threads, each computing 4 points of the
+      * tile, 8 columns apart.  The loop nest is i0, j0, i1, j2, j3.
+      */
+    // @{
+    virtual void gpu_coarsen(var L, int factor, bool strided = true, bool unroll = true);
+    virtual void gpu_coarsen(var L, int factor, var L_thread, var L_coarse,
+                             bool strided = true, bool unroll = true);
+    // @}
+
+    /**
+      * \brief Split the reduction loop \p L of this computation across GPU
+      * blocks (split-K).
+      *
+      * \details When the output of a reduction is small, e.g. a GEMM with a
+      * small M x N and a large K, mapping only the output to blocks does not
+      * fill the GPU.  This splits \p L, a sequential loop level inside the
+      * thread levels (see gpu_tile()), into chunks of \p chunk iterations:
+      * the loop over the chunks, \p L_block, becomes the innermost GPU block
+      * level, and \p L_chunk is the loop over the iterations of a chunk.
+      * The computation must not use three block dimensions already.
+      *
+      * The expression of the computation must be of the form
+      * C(..., k - 1) op e, op being +, *, min or max; as with
+      * parallelize_reduction(), calling this function declares that op is
+      * associative and commutative.  Each thread accumulates its chunk in a
+      * register initialized with the identity of op, then combines it into
+      * the buffer of the computation with one atomic update (see
+      * reduction_atomic).  The buffer must therefore be initialized before
+      * the kernel, e.g. by the computation that initializes the reduction.
+      *
+      * For example
+      *
+      * \code
+      * C.gpu_tile(i, j, 8, 32, i0, j0, i1, j1);
+      * C.gpu_split_reduction(k, 256, k0, k1);
+      * \endcode
+      *
+      * gives the loop nest i0, j0, k0, i1, j1, k1, where i0, j0 and k0 are
+      * mapped to blocks.  Must be called after the GPU mapping and the
+      * thread coarsening of the computation, and before the loop levels
+      * inside it are tagged.
+      */
+    // @{
+    virtual void gpu_split_reduction(var L, int chunk);
+    virtual void gpu_split_reduction(var L, int chunk, var L_block, var L_chunk);
+    // @}
+
+    /**
+      * \brief Split the iterations of this computation between the CPU and
+      * the GPU (co-execution).
+      *
+      * \details The iterations whose iterator \p i is smaller than \p split
+      * stay in this computation, to be computed on the CPU (e.g. with
+      * parallelize()); the others are computed by the returned computation,
+      * named NAME_gpu, to be mapped to the GPU (e.g. with gpu_tile()).  Both
+      * have the iteration domain, the expression and the predicate of this
+      * computation, but the GPU version reads and writes the GPU buffers
+      * that correspond to the host buffers of this computation (see
+      * function::add_mapping(), every buffer must have one).
+      *
+      * The GPU version is scheduled just before this computation, at the
+      * root level: its kernels are launched asynchronously, so the CPU
+      * computes its part while the GPU computes the other one.  The copies
+      * generated by Automatic_communication() only move the parts of the
+      * buffers that the GPU reads and writes; when \p i indexes the
+      * outermost dimension of the output, the results of the GPU are copied
+      * next to the results of the CPU, in the same host buffer, without any
+      * other copy.
+      *
+      * \p split can be a runtime value (e.g. a constant computed from an
+      * input scalar), so that the ratio of the work given to the GPU can be
+      * tuned from the measured time of the function, with a
+      * co_execution_tuner (see utils.h), or chosen by the caller for each
+      * input (e.g. from the density of the rows of a sparse matrix).
+      */
+    computation *co_execute_on_gpu(tiramisu::var i, tiramisu::expr split);
+
     /**
       * Return the buffer that was allocated automatically using
       * high level data mapping functions.
@@ -4123,6 +6528,44 @@ public:
       */
     virtual void interchange(int L0, int L1);
 
+    /**
+      * \brief Collapse the consecutive loop levels \p L0 and \p L1 into a
+      * single loop level \p L.
+      *
+      * \details The level \p L iterates over the iterations of \p L0 and
+      * \p L1 in the same order, e.g.
+      *
+      * \code
+      * for (n = 0; n < 4; n++)             for (nc = 0; nc < 4 * 64; nc++)
+      *   for (c = 0; c < 64; c++)     ->     S0(nc / 64, nc % 64);
+      *     S0(n, c);
+      * \endcode
+      *
+      * so that a loop nest whose outer levels have small extents (e.g. the
+      * batch of a layer of a neural network) can be parallelized over
+      * enough iterations for all the cores:
+      *
+      * \code
+      * S0.collapse(n, c, nc);
+      * S0.parallelize(nc);
+      * \endcode
+      *
+      * The extent of \p L1 must be a constant that does not depend on
+      * \p L0.  The iterators of \p L0 and \p L1 are recovered with a
+      * division and a modulo by this constant, which are computed once per
+      * iteration of \p L.  \p L1 is kept as a loop level of a single
+      * iteration, so that the numbers of the other loop levels do not change.
+      * The collapse does not change the order of the iterations, so it is
+      * always legal; the computations fused with this computation at \p L0
+      * or \p L1 must be collapsed too.
+      *
+      * If \p L is not given, the collapsed level keeps the name of \p L0.
+      */
+    // @{
+    void collapse(var L0, var L1);
+    void collapse(var L0, var L1, var L);
+    // @}
+
     /**
       * Mark this statement as a let statement.
       */
@@ -4133,6 +6576,32 @@ public:
       */
     void mark_as_library_call();
 
+    /**
+      * Mark this computation as part of the inspector of the function.
+      *
+      * The inspector computes, from the data of the function, values that
+      * the rest of the function (the executor) uses to run faster, such as a
+      * partition of the rows of a sparse matrix that balances the number of
+      * entries of each partition (see tiramisu_inspect_row_partition() in
+      * externs.h and sparse_computation), or a permutation of the rows.
+      *
+      * The inspector computations are not executed by the generated function
+      * NAME, but by a second generated function, NAME_inspector, that takes
+      * the same arguments.  The results of the inspector must be stored in
+      * buffers that are arguments of the function.  When the executor is
+      * called repeatedly on data that have the same structure (e.g. the
+      * iterations of a conjugate gradient), the caller runs the inspector
+      * once, and its cost is amortized over all the calls of the executor.
+      *
+      * \code
+      * computation partition_rows({var("d", 0, 1)},
+      *     expr(o_call, "tiramisu_inspect_row_partition",
+      *          {expr(o_address, var("row_ptr")), M, NB_PARTITIONS, expr(o_address, var("partition"))}, p_int32));
+      * partition_rows.mark_as_inspector();
+      * \endcode
+      */
+    void mark_as_inspector();
+
     /**
       * Tag the loop level \p L to be parallelized.
       *
@@ -4142,6 +6611,206 @@ public:
       */
     virtual void parallelize(var L);
 
+    /**
+      * Parallelize the loop level \p L0 as a doacross (wavefront) loop:
+      * the iterations of \p L0 run in parallel, and each one runs the
+      * iterations of the loop level \p L1 (which must be the loop level
+      * right inside \p L0) in order, waiting before each iteration j of \p L1
+      * until the previous iteration of \p L0 has executed all its iterations
+      * of \p L1 before j + \p distance.
+      *
+      * The synchronization is point-to-point: each iteration of \p L0
+      * publishes a counter of its progress along \p L1, and the next
+      * iteration of \p L0 waits on this counter only, instead of a barrier
+      * between wavefronts.  \p L0 and \p L1 are usually the two tile loops
+      * of a tiled loop nest, so that there is one counter per tile row
+      * and one synchronization per tile.
+      *
+      * The distance must cover the dependences carried by \p L0: if the
+      * iteration (i, j) uses a value produced by the iteration (i - 1, j + d),
+      * \p distance must be at least d + 1.  For example, a Gauss-Seidel
+      * sweep that reads (i - 1, j + 1) needs a distance of 2, a recursive
+      * filter that reads (i - 1, j) a distance of 1.
+      *
+      * The iterations of \p L0 must be claimed in increasing order by the
+      * parallel runtime, which is the case of the default Halide runtime
+      * and of tiramisu_work_stealing_do_par_for() with a grain size of 1.
+      */
+    void parallelize_doacross(tiramisu::var L0, tiramisu::var L1, int distance = 1);
+
+    /**
+      * Run the statements in the body of the loop level \p L (the
+      * streaming dimension, e.g. the frames of a video or the images of a
+      * batch) as the stages of a task pipeline: each stage runs all the
+      * iterations of \p L in its own thread, concurrently with the other
+      * stages, so that the stage k works on the iteration i while the
+      * stage k + 1 works on the iteration i - 1.  The stages are the
+      * computations (or loop nests) ordered with then() or after() at the
+      * level \p L, for example
+      *
+      * \code
+      * decode.then(filter, f).then(encode, f);
+      * decode.pipeline(f, 2);
+      * \endcode
+      *
+      * runs decode, filter and encode as three stages over the frames f.
+      * The throughput comes from the overlap of the stages, which is useful
+      * when the stages do not scale with loop-level parallelism; each stage
+      * can still parallelize its own loops.
+      *
+      * Before its iteration i of \p L, a stage waits until the previous
+      * stage has executed its iteration i.  The stage k must therefore only
+      * read what the stages before it produced in the iterations up to i,
+      * which is the case of the dependences of a streaming pipeline.
+      * If \p depth is positive, the stages before the last one also wait
+      * until the last stage has executed the iteration i - \p depth, so the
+      * buffers between the stages can be ring buffers of \p depth slots
+      * indexed by i % \p depth (see store_in()).  A \p depth of 0 does not
+      * bound how far a stage can be ahead of the next ones.
+      *
+      * The stages run in the threads of the parallel runtime, whose number
+      * of threads is raised to at least the number of stages.
+      */
+    void pipeline(tiramisu::var L, int depth = 0);
+
+    /**
+      * Parallelize the loop level \p L, a reduction loop of this computation.
+      *
+      * The computation must accumulate into an element that does not depend
+      * on \p L, with an update of the form acc = acc op e where op is +, *,
+      * min or max, e.g. a dot product
+      *
+      * \code
+      * computation dot({i}, dot(i - 1) + x(i) * y(i));
+      * dot.store_in(&b_dot, {0});
+      * dot.parallelize_reduction(i);
+      * \endcode
+      *
+      * Since parallelize() is illegal on such a loop (see
+      * function::loop_parallelization_is_legal()), calling this function
+      * declares that op is associative and commutative, so that the terms
+      * may be summed in any order.  The result may therefore differ for
+      * floating point types.  The strategies are
+      *  - reduction_privatized: the iterations of \p L are divided into
+      * \p nb_partials chunks, run in parallel, each accumulating into its
+      * own partial result (initialized with the identity of op); the
+      * partial results are then combined into the accumulator in order.
+      *  - reduction_tree: as reduction_privatized, but the partial results
+      * are combined pairwise, in log2(\p nb_partials) parallel steps.  This
+      * is worth it when the partial results are many or large.
+      *  - reduction_atomic: the iterations of \p L run in parallel and
+      * update the accumulator with atomic operations.  This needs no extra
+      * storage but serializes the updates, so it suits loops with a lot of
+      * work per update.
+      *
+      * \p nb_partials should be at least the number of threads.  The
+      * accumulator must not be accessed at another address in the loop.
+      *
+      * \p L may also be a GPU block or thread level (see tag_gpu_level()),
+      * e.g. to sum the rows of a matrix with one block per row
+      *
+      * \code
+      * computation sum({i, j}, sum(i, j - 1) + x(i, j));
+      * sum.store_in(&b_sum, {i});
+      * sum.tag_gpu_level(i, j);
+      * sum.parallelize_reduction(j);
+      * \endcode
+      *
+      * The threads then combine their terms with the warp shuffles of
+      * cooperative_groups::reduce(), and the first thread of each warp
+      * updates the accumulator with an atomic operation; with
+      * reduction_atomic, every thread updates the accumulator atomically.
+      * \p nb_partials is not used.  The accumulator must be a 32 or 64-bit
+      * number, and be initialized before the kernel.
+      */
+    void parallelize_reduction(tiramisu::var L,
+                               tiramisu::reduction_strategy_t strategy = tiramisu::reduction_privatized,
+                               int nb_partials = 64);
+
+    /**
+      * Parallelize the loop level \p L, along which this computation is a
+      * scan (a prefix sum), i.e. each iteration of \p L combines the value
+      * computed by the previous iteration with a new term, e.g. a cumulative
+      * sum or one row of an integral image
+      *
+      * \code
+      * computation cumsum({i, j}, cumsum(i, j - 1) + in(i, j));
+      * cumsum.parallelize_scan(j);
+      * \endcode
+      *
+      * The update must be of the form acc[j] = acc[j - 1] op e, where op is
+      * +, *, min or max and is declared associative by calling this
+      * function; the first element acc[j - 1] read by the loop must be
+      * initialized by a previous computation.  The loop is generated as a
+      * blocked scan in three passes:
+      *  - the iterations of \p L are divided into \p nb_blocks blocks, which
+      * are scanned in parallel, all but the first one from the identity of op;
+      *  - the last values of the blocks are scanned sequentially, which gives
+      * the carry of each block;
+      *  - the carries are combined in parallel with the elements of their block.
+      *
+      * This reads and writes the scanned elements twice instead of once, so
+      * it pays off when there are enough threads and the scan is long; an
+      * outer parallel loop, when there is one, is cheaper.  \p nb_blocks
+      * should be at least the number of threads.  Generating a scan for a
+      * GPU (e.g. a decoupled look-back scan) is not supported.
+      */
+    void parallelize_scan(tiramisu::var L, int nb_blocks = 64);
+
+    /**
+      * Prefetch the elements of the buffer \p b that this computation
+      * accesses \p distance iterations ahead of the loop level \p L.
+      *
+      * At each iteration, a software prefetch is issued for each access of
+      * this computation to \p b, at the address that the access has
+      * \p distance iterations later of \p L (all the other loop iterators
+      * being unchanged).  The address is derived from the access relation
+      * and the schedule, so \p L can be a tile loop: prefetching 1 iteration
+      * ahead of a tile loop of size 32 prefetches the element accessed 32
+      * iterations ahead in the original loop.
+      *
+      * Prefetches never fault, so the addresses past the end of the loop
+      * are not guarded.  The distance should cover the memory latency:
+      * usually a few hundred cycles divided by the cost of an iteration.
+      *
+      * Only affine accesses are supported: for an indirect access such as
+      * x[col[j]], prefetch the index array (col) and let the hardware
+      * handle the gather.
+      *
+      * \code
+      * computation y({i, j}, y(i) + A(i, j) * x(j));
+      * y.prefetch(b_A, j, 16);
+      * \endcode
+      */
+    void prefetch(tiramisu::buffer &b, tiramisu::var L, int distance);
+
+    /**
+      * \brief Set how the isl AST generator generates the loop level \p L
+      * of this computation.
+      *
+      * \details The option only applies to the iterations of this
+      * computation, the other computations of the loop are generated as
+      * usual.
+      *  - ast_separate: the iterations where all the statements of the loop
+      * body are executed (the full tiles) are generated in a loop without
+      * conditions, apart from the other iterations.  This is what
+      * function::enable_full_tile_separation() does for all the levels.
+      *  - ast_atomic: a single loop where each statement instance appears
+      * once, at the cost of min() and max() in the bounds; this keeps the
+      * code small, e.g. for the outer levels.
+      *  - ast_unroll: isl unrolls the loop completely, so the unrolled
+      * instances have constant bounds and no condition; the extent of the
+      * loop must be bounded.  Unlike tag_unroll_level(), the loop is
+      * unrolled before the Halide code is generated.
+      *  - ast_default: isl chooses, and the loop level is not separated by
+      * function::enable_full_tile_separation().
+      *
+      * The level is given by its position when this function is called,
+      * so it must be called after the transformations that change the loop
+      * levels, like tag_parallel_level().
+      */
+    void set_ast_option(tiramisu::var L, tiramisu::ast_option_t option);
+
     /**
        * Set the access relation of the computation.
        *
@@ -4183,6 +6852,33 @@ public:
        */
     const bool is_inline_computation() const;
 
+     /**
+       * \brief Set how the exponentials, logarithms, hyperbolic tangents,
+       * sines and cosines of the expression of this computation are computed.
+       *
+       * \details With math_precise (the default), they are calls to the math
+       * library, which are not vectorized: a vectorized loop calls the
+       * function once per lane.  With math_fast, the float32 operators are
+       * replaced by inlined polynomial approximations (after a range
+       * reduction) that are vectorized with the rest of the loop, and are
+       * within a few ulps of the exact result.  math_approx uses polynomials
+       * of lower degrees, with a relative error of about 1e-4, which is
+       * enough for activation functions (sigmoid, tanh) and softmax.
+       *
+       * The approximations assume finite inputs: the inputs of exp are
+       * clamped to the range where the result is a normal number, sin and
+       * cos lose precision for |x| larger than about 10^4, and the log of
+       * a denormal number is not exact.  The float64 operators and the CUDA
+       * code are not changed.
+       */
+     void set_math_precision(tiramisu::math_precision_t precision);
+
+     /**
+       * Return the implementation of the transcendental operators of this
+       * computation (see set_math_precision()).
+       */
+    tiramisu::math_precision_t get_math_precision() const;
+
      /**
        * Set the schedule indicated by \p map.
        *
@@ -4451,6 +7147,20 @@ public:
     virtual void skew(int i, int j, int alpha , int beta, int gamma , int sigma); 
     // @}
 
+    /**
+      * Apply the unimodular transformation \p matrix to the loop levels \p L
+      * to L + n - 1, where n is the size of the square matrix: the loop level
+      * L + i becomes the sum over j of matrix[i][j] times the loop level L + j.
+      * The determinant of the matrix must be 1 or -1.
+      *
+      * This command composes the skewings, interchanges and reversals of n
+      * loop levels into one transformation.  For example, the matrix
+      * {{1, 0, 0}, {1, 1, 0}, {1, 0, 1}} skews the two inner levels of a
+      * (t, i, j) stencil by the time loop, which makes the three levels
+      * tileable.  The loop levels keep their names.
+      */
+    virtual void unimodular_transform(int L, const std::vector<std::vector<int>> &matrix);
+
     /**
       * applied to a computation's loop level i : it inverts the execution order for this specific loop
       * i.e : original i : 0 -> n to :
@@ -4543,6 +7253,80 @@ public:
     void tag_gpu_level(tiramisu::var L0, tiramisu::var L1, tiramisu::var L2, tiramisu::var L3, tiramisu::var L4, tiramisu::var L5);
     // @}
 
+    /**
+      * Compute the tiles formed by the loop levels \p L_i, \p L_j and \p L_k
+      * of this computation with the tensor cores of the GPU.
+      *
+      * The computation must be a matrix multiplication C = C + A * B
+      * (casts around the operands are allowed) mapped to the GPU, and
+      * \p L_i, \p L_j and \p L_k must be its three innermost loop levels,
+      * inside the GPU thread loops, with 16 iterations each.  A is the
+      * operand that shares its first index with C.  The three buffers must
+      * be row major, with an innermost dimension that is a multiple of 8
+      * elements (16 bytes), and the tiles must start at a multiple of 16 bytes.
+      *
+      * The supported configurations are:
+      *  - A and B in p_float16, C in p_float16 or p_float32 (compute
+      *    capability 7.0),
+      *  - A and B in p_bfloat16, C in p_float32 (compute capability 8.0).
+      * The architecture given to nvcc is set with the environment variable
+      * TIRAMISU_CUDA_ARCH (e.g. sm_80).
+      *
+      * Each tile is computed with a WMMA 16x16x16 matrix multiply-accumulate,
+      * which is executed by a whole warp: each GPU thread of the kernel
+      * that contains this computation becomes a warp (the thread dimension
+      * x is multiplied by 32), and the other computations of the kernel are
+      * executed by the first thread of each warp.
+      *
+      * The operands can be staged in shared memory with cache_shared(); with
+      * \p pad_buffer, the rows of the shared buffers of a computation that
+      * uses tensor cores are padded by 16 bytes instead of one element, which
+      * keeps them aligned for the ldmatrix instructions of the fragment loads
+      * while avoiding shared memory bank conflicts.
+      *
+      * \code
+      * computation C({i, j, k}, C(i, j) + A(i, k) * B(k, j), p_float32);
+      * C.tile(i, j, 64, 64, i0, j0, i1, j1);
+      * C.split(k, 16, k0, k2);
+      * C.tile(i1, j1, 16, 16, ti, tj, i2, j2);
+      * C.interchange(j2, k0); // ...until the order is i0, j0, ti, tj, k0, i2, j2, k2
+      * C.tag_gpu_level(i0, j0, ti, tj);
+      * C.tag_gpu_tensor_core(i2, j2, k2);
+      * \endcode
+      */
+    void tag_gpu_tensor_core(tiramisu::var L_i, tiramisu::var L_j, tiramisu::var L_k);
+
+    /**
+      * Issue this computation asynchronously on the CUDA stream \p stream
+      * (a positive number; streams are created on first use).
+      *
+      * This computation must either be a copy (i.e. its expression is
+      * tiramisu::memcpy()) or be mapped to the GPU, in which
+      * case the kernel that it starts is launched on \p stream.  All the
+      * computations of a kernel should be tagged with the same stream.
+      *
+      * Copies on a stream are asynchronous, and the host buffers they read or
+      * write are page-locked on first use so that they can overlap with
+      * kernels running on other streams.  The order of the computations is
+      * preserved: before issuing an operation on a stream, the generated code
+      * makes that stream wait (with an event) for the work already issued on
+      * every other stream that uses one of the same buffers.  Untagged
+      * kernels run on the default stream of the calling thread and are
+      * ordered with the streams in the same way, and untagged copies are
+      * synchronous.  The generated function waits for all streams before it
+      * returns.
+      *
+      * For example, the copy of the next chunk of the input overlaps with
+      * the kernel working on the current one in:
+      *
+      * \code
+      * computation copy_in({c}, memcpy(b_host_chunk, b_device_chunk));
+      * copy_in.tag_gpu_stream(1);
+      * compute.tag_gpu_stream(2);
+      * \endcode
+      */
+    void tag_gpu_stream(int stream);
+
     /**
       * Tag the loop level \p L to be parallelized.
       */
@@ -4584,6 +7368,164 @@ public:
     void tag_distribute_level(int L);
     // @}
 
+    /**
+      * Distribute the iterations of the loop level \p L over \p nb_ranks ranks.
+      * \p L is replaced by the loop level \p L_rank, which iterates over the ranks
+      * and is tagged distributed (see tag_distribute_level()), and the loop level
+      * \p L_local, which iterates, in their original order, over the iterations of
+      * \p L given to the rank.  The bounds of \p L must be constant.
+      *
+      * - distribution_block: each rank gets a chunk of consecutive iterations, the
+      * chunks have the same size (like a split of \p L in chunks of ceil(N / nb_ranks)
+      * iterations).
+      * - distribution_weighted: each rank gets a chunk of consecutive iterations, the
+      * chunks have the same cost.  The cost of an iteration of \p L is the number of
+      * iterations of the loops nested in it (the volume of the bounding box of its
+      * slice of the iteration domain), so that, for example, the rows of a triangular
+      * domain are shared evenly.
+      * - distribution_cyclic: the iteration i goes to the rank i % nb_ranks.
+      * - distribution_block_cyclic: the blocks of \p block_size consecutive iterations
+      * are dealt to the ranks in a round-robin fashion.
+      *
+      * The placement is expressed in the schedule, so the sends and receives derived
+      * from the distribution (see gen_communication_code()) follow it.
+      */
+    void distribute(tiramisu::var L, int nb_ranks, tiramisu::distribution_t distribution,
+                    tiramisu::var L_rank, tiramisu::var L_local, int block_size = 1);
+
+    /**
+      * Distribute the iterations of the loop level \p L over \p nb_ranks ranks in chunks
+      * of consecutive iterations of the same cost, where \p weight(i) is the cost of the
+      * iteration i of \p L (e.g. the number of non-zeros of the row i of a sparse matrix).
+      * See distribute(tiramisu::var, int, tiramisu::distribution_t, tiramisu::var, tiramisu::var, int).
+      */
+    void distribute(tiramisu::var L, int nb_ranks, std::function<double(int64_t)> weight,
+                    tiramisu::var L_rank, tiramisu::var L_local);
+
+    /**
+      * Overlap the halo exchanges \p exchanges with this distributed computation.
+      *
+      * The computation is split into an interior part and a boundary part.
+      * The boundary is the set of iterations whose neighbours at a distance
+      * of at most \p halo along the iteration domain dimension \p dim are
+      * computed by another rank, i.e., the iterations that read the data
+      * received from the neighbours.  The sends and receives of \p exchanges
+      * are made non-blocking, and the computation is reordered at the loop
+      * level \p L as follows
+      *
+      * \code
+      * for L:
+      *   Isend/Irecv of the halos      (ordered before this computation by the user)
+      *   interior
+      *   wait for the sends/receives
+      *   boundary
+      * \endcode
+      *
+      * so that the communication latency is hidden behind the interior
+      * computation.  The exchanges must already be ordered before this
+      * computation at the loop level \p L and the interior must not overwrite
+      * the data being sent (e.g., the time steps alternate between two buffers).
+      * The buffers of the MPI requests are allocated automatically.
+      *
+      * The boundary part is a new definition of this computation and can be
+      * accessed with get_last_update().
+      */
+    void overlap_communication(std::vector<tiramisu::xfer> exchanges, tiramisu::var L,
+                               tiramisu::var dim, int halo);
+
+    /**
+      * Split this computation into an interior, where all its accesses to the
+      * inputs that have a boundary condition (see input::set_boundary_condition())
+      * are inside the inputs, and a border, where some are not.  The interior
+      * reads the inputs directly, and only the border evaluates the boundary
+      * condition (clamped, mirrored or wrapped indices, or the constant), e.g.
+      *
+      * \code
+      * input in("in", {i, j}, p_float32);
+      * in.set_boundary_condition(boundary_clamp);
+      * computation blur("blur", {i, j}, (in(i - 1, j) + in(i, j) + in(i + 1, j)) / 3.0f);
+      * blur.separate_borders();
+      * \endcode
+      *
+      * computes blur for 1 <= i < N-1 without clamps, then blur for i = 0 and
+      * i = N-1 with clamped accesses.  The border is a new definition of this
+      * computation (like in separate()), ordered after the interior at the loop
+      * level \p L (the root by default), and can be accessed with get_last_update().
+      * The scheduling commands applied to this computation afterwards are not
+      * applied to the border.
+      */
+    // @{
+    void separate_borders(tiramisu::var L);
+    void separate_borders(int L = computation::root_dimension);
+    // @}
+
+    /**
+      * Distribute the iterations of the loop level \p L across the GPUs of
+      * the machine: the iteration i runs on the GPU i modulo the number of
+      * GPUs, i.e. the kernels and the copies issued in that iteration run on
+      * that GPU and the GPU buffers allocated in it (see
+      * buffer::allocate_at()) are allocated in its memory.
+      *
+      * \p L must be a loop level of the host, outside the loops mapped to
+      * GPU blocks.  The loop itself runs on the host, so the GPUs run their
+      * iterations concurrently; tagging the copies and the kernels with
+      * streams (see tag_gpu_stream()) also overlaps the copies of an
+      * iteration with its kernels, since every GPU has its own streams.
+      * The loop starts once the work issued before it has completed, and
+      * the work issued in the loop has completed when the loop ends, so the
+      * data written by a GPU in a loop can be read by any GPU after it.
+      *
+      * Peer-to-peer access is enabled between all the GPUs that support it.
+      * The halo of a partition can either be read directly from a buffer
+      * partitioned across the GPUs (see buffer::set_gpu_partitions()), or
+      * be copied into a buffer of the GPU with tiramisu::memcpy() between two
+      * GPU buffers, which is a peer-to-peer copy.
+      *
+      * For example, with a buffer b_d partitioned in 4 slices along i0:
+      *
+      * \code
+      * b_d.set_gpu_partitions(4);
+      * comp.split(i, N / 4, i0, i1);
+      * comp.tag_gpu_level(i1, j);
+      * comp.tag_gpu_device_level(i0);
+      * \endcode
+      */
+    // @{
+    void tag_gpu_device_level(tiramisu::var L);
+    void tag_gpu_device_level(int L);
+    // @}
+
+    /**
+      * Execute the loop level \p L, and all the kernels in its body, in a
+      * single persistent kernel, instead of launching the kernels at each
+      * iteration.  This removes the launch latency of each iteration, which
+      * dominates the recurrent layers with a small batch (an LSTM launches
+      * its GEMMs and element-wise kernels at each time step).
+      *
+      * \p L must be a loop level outside the GPU block levels, and the body
+      * of the loop must only contain computations mapped to the GPU, with the
+      * same thread block dimensions.  The kernel is launched cooperatively
+      * with as many thread blocks as can be resident at the same time on the
+      * GPU (at most the largest number of blocks of its kernels): the blocks
+      * of each kernel of the body are distributed over them, and a grid-wide
+      * barrier separates the kernels, so that each kernel sees the results of
+      * the previous ones.  When the GPU can hold all the blocks of each
+      * kernel, a block computes the same tile at every iteration, so the
+      * data it reads at every iteration (e.g. its rows of the recurrent
+      * weights) stays in the caches of its multiprocessor.
+      *
+      * \code
+      * // m: time steps, the GEMMs and the cell update are tagged with tag_gpu_level()
+      * matmul.tag_gpu_persistent_level(m);
+      * \endcode
+      *
+      * Needs a GPU that supports cooperative launches (compute capability 6.0).
+      */
+    // @{
+    void tag_gpu_persistent_level(tiramisu::var L);
+    void tag_gpu_persistent_level(int L);
+    // @}
+
     /**
       * Tag the loop level \p L to be unrolled.
       *
@@ -4659,6 +7601,49 @@ public:
                       var L1_inner, var L2_inner);
     // @}
 
+    /**
+      * Split the loop level \p L0 by \p size, where \p size is an
+      * expression evaluated at runtime (usually a function-wide
+      * tiramisu::constant read from an input), so that the tile sizes
+      * can be tuned without generating and compiling the code again.
+      * For example
+      *
+      * \code
+      * constant T0("T0", sizes(0)), T1("T1", sizes(1));
+      * C.tile_parametric(i, j, T0, T1);
+      * \endcode
+      *
+      * generates the loops
+      *
+      * \code
+      * for (i_tile = 0; i_tile < (N + T0 - 1) / T0; i_tile++)
+      *   for (j_tile = 0; j_tile < (M + T1 - 1) / T1; j_tile++)
+      *     for (i_point = 0; i_point < min(T0, N - i_tile * T0); i_point++)
+      *       for (j_point = 0; j_point < min(T1, M - j_tile * T1); j_point++)
+      *         C(i_tile * T0 + i_point, j_tile * T1 + j_point) = ...
+      * \endcode
+      *
+      * A product of a size by an iterator cannot be represented in the
+      * polyhedral model, so unlike split() and tile(), the loop levels are
+      * split when the code is generated: the schedule of the computation
+      * still has the unsplit loop levels \p L0 (and \p L1), which can be
+      * parallelized and ordered like any loop level, but cannot be
+      * vectorized or unrolled.  The tile loops are named after the split
+      * loop level with the suffix "_tile", and the point loops with the
+      * suffix "_point".  The sizes must be positive.
+      *
+      * tile_parametric() tiles the loop levels \p L0 and \p L1, where
+      * \p L1 is the loop level right inside \p L0: the loop \p L1 must be
+      * the only statement in the body of the loop \p L0, and its bounds must
+      * not depend on \p L0.  Otherwise, the two loop levels are split
+      * without being interchanged.  Like tile(), the legality of the tiling
+      * is not checked.
+      */
+    // @{
+    void split_parametric(var L0, tiramisu::expr size);
+    void tile_parametric(var L0, var L1, tiramisu::expr sizeX, tiramisu::expr sizeY);
+    // @}
+
     /**
       * Tile the two loop levels \p L0 and \p L1 with rectangular
       * tiling. \p sizeX and \p sizeY represent the tile size.
@@ -4671,6 +7656,43 @@ public:
     virtual void tile(int L0, int L1, int L2, int sizeX, int sizeY, int sizeZ);
     // @}
 
+    /**
+      * Tile the time loop level \p t and the space loop level \p i of a
+      * time-iterated stencil with diamond tiles of width \p size, so that
+      * several tiles can start at the same time.
+      *
+      * The tiles are the cells of the grid formed by the lines
+      * slope*t + i = k*size and slope*t - i = k*size.  The loop nest (t, i)
+      * becomes (\p wavefront, \p tile, t, i), where \p wavefront enumerates
+      * the wavefronts of tiles in order, and \p tile enumerates the tiles
+      * of a wavefront.  The tiles of a wavefront are independent, so
+      * \p tile can be parallelized.  t and i keep their names and iterate
+      * over the points of a tile.
+      *
+      * \p slope is the number of points of i a value propagates to per
+      * iteration of t (the radius of the stencil).  It is derived from
+      * the dependences when it is 0, and checked against them otherwise,
+      * which requires function::perform_full_dependency_analysis() to have
+      * been called (before any schedule is applied); only a non-zero
+      * \p slope can be given without the dependence analysis.  Only the
+      * dependences of the computation on itself are taken into account.
+      *
+      * For example
+      *
+      * \code
+      * heat.time_tile(t, i, 32, w, b);
+      * heat.parallelize(b);
+      * \endcode
+      *
+      * runs the tiles of each wavefront of a 1D heat stencil in parallel.
+      * The space loop levels inside \p i can be tiled with tile() to
+      * get smaller tiles for 2D and 3D stencils.
+      */
+    // @{
+    virtual void time_tile(var t, var i, int size, var wavefront, var tile, int slope = 0);
+    virtual void time_tile(int t, int i, int size, int slope);
+    // @}
+
     /**
       * Unroll the loop level \p L with an unrolling factor \p fac.
       *
@@ -4733,9 +7755,52 @@ public:
       *
       */
     //@{
-    virtual void unroll(var L, int fac);
-    virtual void unroll(var L, int fac, var L_outer, var L_inner);
-    virtual void unroll(int L, int fac);
+    virtual void unroll(var L, int fac);
+    virtual void unroll(var L, int fac, var L_outer, var L_inner);
+    virtual void unroll(int L, int fac);
+    //@}
+
+    /**
+      * Unroll the loop level \p L by \p fac and jam the copies into the
+      * innermost loop body (register blocking).
+      *
+      * Like unroll(), the iteration domain is first separated into a full
+      * and a partial iteration domain and the full one is split by \p fac.
+      * The inner loop (of extent \p fac) is then sunk below all the loops
+      * that \p L encloses and tagged to be unrolled, so that the \p fac
+      * copies of the body share the loads of the values that do not depend
+      * on \p L.
+      *
+      * For example, for
+      *
+      * \code
+      * for (i=0; i<N; i++)
+      *   for (j=0; j<M; j++)
+      *     for (k=0; k<K; k++)
+      *       C[i][j] += A[i][k] * B[k][j];
+      * \endcode
+      *
+      * S0.unroll_and_jam(i, 4) generates
+      *
+      * \code
+      * for (i0=0; i0<N/4; i0++)
+      *   for (j=0; j<M; j++)
+      *     for (k=0; k<K; k++)
+      *       // unrolled
+      *       for (i1=0; i1<4; i1++)
+      *         C[4*i0+i1][j] += A[4*i0+i1][k] * B[k][j];
+      * \endcode
+      *
+      * followed by the remainder loop for the last N%4 iterations of i.
+      *
+      * This is an interchange: the caller is responsible for its legality
+      * (check_legality_of_function() can be used for this).
+      * If \p L is the innermost loop, this is equivalent to unroll().
+      */
+    //@{
+    virtual void unroll_and_jam(var L, int fac);
+    virtual void unroll_and_jam(var L, int fac, var L_outer, var L_inner);
+    virtual void unroll_and_jam(int L, int fac);
     //@}
 
     /**
@@ -4806,6 +7871,134 @@ public:
     virtual void vectorize(var L, int v, var L_outer, var L_inner);
     // @}
 
+    /**
+      * Vectorize the loop level \p L by the number of elements of the type
+      * of the computation in a vector register of the target of the function
+      * (see function::get_default_vector_length()).
+      */
+    void vectorize(var L);
+
+    /**
+      * Vectorize the loop level \p L by a vector length \p v, computing the
+      * last partial vector with masks instead of a scalar remainder loop.
+      *
+      * The loop level is split by \p v without being separated first (see
+      * vectorize()): the inner loop of \p v iterations is vectorized, and
+      * its statements are guarded by the original bound of the loop, e.g.
+      *
+      * \code
+      * for (j1 = 0; j1 < ceil(23 / 4); j1++)
+      *   for (j2 = 0; j2 < 4; j2++)         // vectorized
+      *     if (j1 * 4 + j2 < 23)
+      *       S0;
+      * \endcode
+      *
+      * The guard becomes a vector mask: the loads and the stores of the
+      * statements are masked, e.g. with the mask registers of AVX-512 and
+      * SVE, or the masked moves of AVX2 (vmaskmov).  The full vectors are
+      * computed with an all-true mask.  The statements must not have side
+      * effects other than their stores (calls to external functions are
+      * computed for all the lanes).
+      *
+      * This is useful when the extent of the loop is not known at compile
+      * time or is a little bigger than a multiple of \p v, e.g. odd image
+      * widths or numbers of channels, and the loop has a small extent, so
+      * that the remainder loop is a large part of it.
+      */
+    // @{
+    void vectorize_predicated(var L, int v);
+    void vectorize_predicated(var L, int v, var L_outer, var L_inner);
+    // @}
+
+    /**
+      * Vectorize the loop level \p L by a vector length \p v (see
+      * vectorize()), after peeling the first iterations of the loop so that
+      * the vectors of the dominant access start at aligned addresses.
+      *
+      * The dominant access is the access (load or store) that the most
+      * accesses of the computation share, with the same offset along \p L;
+      * the store wins the ties.  E.g. for
+      *
+      * \code
+      * computation out("out", {i, j}, (in(i, j - 1) + in(i, j) + in(i, j + 1)) / 3.0f);
+      * out.vectorize_aligned(j, 8);
+      * \endcode
+      *
+      * the store out(i, j) is dominant, and if j starts at 1, the iterations
+      * j < 8 are peeled in a scalar prologue, and the vectorized loop starts
+      * at j = 8.  The alignment of the base of the buffer must be known (see
+      * buffer::set_alignment()), the innermost index of the dominant access
+      * must be \p L plus a constant, and the size of the innermost dimension
+      * of its buffer must be a multiple of the aligned number of elements, so
+      * that all the rows start at aligned addresses.  The loop level \p L
+      * must be a dimension of the iteration domain that was not transformed,
+      * with a constant lower bound.  Otherwise, or if the loop already starts
+      * at an aligned address, the loop is vectorized without peeling.
+      *
+      * The prologue is a new definition of this computation (like in
+      * separate()), ordered before the vectorized loop at the loop level
+      * \p L, and the vectorized loop is the last definition
+      * (see get_last_update()).
+      */
+    // @{
+    void vectorize_aligned(var L, int v);
+    void vectorize_aligned(var L, int v, var L_outer, var L_inner);
+    // @}
+
+    /**
+      * Specialize the computation for the values of the invariants that
+      * satisfy \p condition, and return the specialized version.
+      *
+      * \p condition is a constraint on the invariants of the function in the
+      * isl syntax, e.g. "N % 8 = 0" or "N <= 64 and M = 3".  The computation
+      * is split into two versions that only differ by their schedule: the
+      * returned version runs when \p condition holds, and this computation
+      * runs when it does not.  The generated code tests the condition at run
+      * time, and the loop bounds of the specialized version are simplified
+      * with it, e.g.
+      *
+      * \code
+      * computation &S0_fast = S0.specialize("N % 8 = 0");
+      * S0_fast.split(j, 8);   // no remainder loop
+      * \endcode
+      *
+      * The specialized version is a new definition of the computation (see
+      * get_update()), executed after the loop nest of this computation; the
+      * computations scheduled after this computation at the root level are
+      * scheduled after it.  A computation fused with the computations that
+      * follow it cannot be specialized.  Specialize a computation several
+      * times to get a version for each common case.
+      *
+      * The loop transformations (split, tile, interchange...) of a version do
+      * not apply to the other.  The tags (parallelize, vectorize, unroll) are
+      * attached to the name of the computation, and so to the same loop levels
+      * in all the versions.
+      */
+    computation &specialize(const std::string &condition);
+
+    /**
+      * Vectorize the loop level \p L, a reduction loop of this computation,
+      * by a vector length \p v (see vectorize()).
+      *
+      * The computation must accumulate into an element that does not depend
+      * on \p L, e.g. a dot product
+      *
+      * \code
+      * computation C({i, j, k}, widening_mul_add(C(i, j, k - 1), A(i, k), B(j, k)));
+      * C.vectorize_reduction(k, 16);
+      * \endcode
+      *
+      * Each vector iteration computes \p v terms at once and adds their sum
+      * to the accumulator.  The sums of widening products (see widening_mul())
+      * are lowered to the dot product instructions of the target, e.g.
+      * vpdpbusd for products of uint8 and int8 accumulated in int32 with
+      * AVX512-VNNI (see function::add_target_feature()), and pmaddwd otherwise.
+      *
+      * The terms are summed in a different order, so the result may differ
+      * for floating point types.
+      */
+    void vectorize_reduction(var L, int v);
+
     /**
       * \brief Generate communication code for this computation
       *
@@ -4813,6 +8006,19 @@ public:
       * xfers, schedule the send, receive at root level if no computation was scheduled before,
       * map the received data to correct locations and allocate the required extra memory.
       *
+      * The exchanged sets are the exact regions read by this computation (from its access
+      * relations) that are computed by other ranks. They are exchanged with one message per
+      * producer and neighbouring rank: each region is sent with a nonblocking send as a single
+      * contiguous message, or as a strided message (MPI vector datatype) when it is a 2D box
+      * that does not span full rows of the buffer. Regions that are not boxes fall back to
+      * smaller messages.
+      *
+      * The distributed loops must be the outermost loops. Several of them can be distributed
+      * to get a multi-dimensional grid of ranks (see get_rank_grid()); the k-th distributed
+      * loop is assumed to partition the k-th dimension of the buffers into blocks. Halos are
+      * stored around the local block of the buffers, which are enlarged accordingly.
+      * With a grid, all the exchanges of a buffer should be generated by a single call, as
+      * the layout of the messages is computed from the size of the buffer at that point.
       */
     void gen_communication();
 
@@ -4822,6 +8028,17 @@ public:
       */
     void gen_communication(tiramisu::var l);
 
+    /**
+      * Estimate the communication generated by gen_communication() for this computation:
+      * get in \p nb_messages the number of messages received by a rank (one per producer
+      * and neighbouring rank), and in \p nb_bytes their total size. The sizes are averaged
+      * over the pairs of ranks that exchange data, so the ranks on the border of the grid,
+      * which have fewer neighbours, are not counted apart.
+      * The parameters of the sizes of the exchanged regions must have known values
+      * (in the context of the function, or as literal constants).
+      */
+    void get_communication_volume(int &nb_messages, int64_t &nb_bytes);
+
     /**
       * root_dimension is a number used to specify the dimension level
       * known as root.
@@ -5129,6 +8346,20 @@ public:
         input(generate_new_computation_name(), iterator_variables, t, cpu_buffer_to_map_to_device)
     {
     }
+
+    /**
+      * Set the values read outside of this input: the accesses of the
+      * computations to the input are bounded during code generation, by
+      * clamping (boundary_clamp), mirroring (boundary_mirror) or wrapping
+      * (boundary_wrap) their indices, or by replacing the accesses outside of
+      * the input by \p value (boundary_constant).  Types are defined in
+      * \ref tiramisu::boundary_t
+      *
+      * The bounds of the input are the bounds of its iterators.  Use
+      * computation::separate_borders() on the computations that read the
+      * input to only pay for the boundary condition on the borders.
+      */
+    void set_boundary_condition(tiramisu::boundary_t type, tiramisu::expr value = tiramisu::expr());
 };
 
 class Input: public input{
@@ -5198,6 +8429,206 @@ public:
    view(std::string name, std::vector<var> iterator_variables, primitive_t t):
 	computation(name, iterator_variables, expr(), false,t){}
 
+    /**
+      * \brief Declare a view of the buffer \p b.
+      *
+      * \details The element (i, j, ...) of the view, where i, j, ... are the
+      * \p iterator_variables, is the element \p buffer_indices of \p b
+      * (as in computation::store_in()).  The indices are affine functions of
+      * the iterators (or quasi-affine: divisions and modulos by constants).
+      * Nothing is copied: the computations that read the view read \p b, and
+      * the computations stored in the view (see computation::store_in(view *))
+      * write into \p b, so the dependence analysis and the legality checks see
+      * the accesses to the elements of \p b.
+      *
+      * \code
+      * var i("i", 0, 20), j("j", 0, 30);
+      * view T("T", {j, i}, buf, {i, j});   // T(j, i) is buf[i, j]
+      * \endcode
+      */
+    view(std::string name, std::vector<var> iterator_variables, tiramisu::buffer &b,
+         std::vector<tiramisu::expr> buffer_indices);
+
+    /**
+      * \brief Views of common layout changes, without copies.
+      *
+      * \details
+      *  - reshape(): the view has the sizes \p sizes and the same elements as
+      *    \p b in row-major order (e.g. a NCHW tensor seen as a NxCHW
+      *    matrix).  \p b must have constant extents and as many elements as
+      *    the view.
+      *  - flatten(): the dimensions \p first_dim to the last of \p b are
+      *    seen as a single dimension.  These dimensions must have constant
+      *    extents.
+      *  - slice(): the view is the box of sizes \p sizes of \p b that starts
+      *    at \p offsets, e.g. the channels of a layer in the buffer of a
+      *    concatenation (DenseNet): the layer stored in the slice writes
+      *    directly into the concatenation.
+      *  - transpose(): the dimension d of the view is the dimension
+      *    permutation[d] of \p b.
+      *
+      * The views are created in the function of \p b, with generated iterator
+      * names.
+      */
+    // @{
+    static view *reshape(std::string name, tiramisu::buffer &b, std::vector<int> sizes);
+    static view *flatten(std::string name, tiramisu::buffer &b, int first_dim);
+    static view *slice(std::string name, tiramisu::buffer &b, std::vector<tiramisu::expr> offsets,
+                       std::vector<tiramisu::expr> sizes);
+    static view *transpose(std::string name, tiramisu::buffer &b, std::vector<int> permutation);
+    // @}
+};
+
+/**
+  * A computation that iterates over the stored entries of a sparse matrix
+  * (see buffer::set_sparse_format()).
+  *
+  * Like the level formats of TACO, the iteration follows the format of the
+  * matrix.  For CSR (resp. CSC), the computation has two loops: a loop over
+  * the rows (resp. the columns) of the matrix, in the coordinate space, and
+  * a loop over the positions of the entries of the row (resp. the column),
+  * from pos[i] to pos[i+1]-1.  The bounds of the loop over the positions are
+  * computed by two constants at the beginning of each iteration of the outer
+  * loop.  For COO, the computation has a single loop over the positions
+  * of all the entries.  For SELL-C-sigma, the computation has three loops:
+  * a loop over the slices, a loop over the columns of the slice (from 0 to
+  * its width, computed at the beginning of each slice) and a loop over the
+  * C rows of the slice, which can be vectorized since the entries of these
+  * rows are contiguous.
+  *
+  * The expression of the computation reads the current entry with value()
+  * and its row and column with coordinate().  The accesses that use a
+  * coordinate (e.g. x(A.coordinate(1))) are indirect accesses.
+  *
+  * Example (CSR SpMV):
+  *
+  * \code
+  * var i("i", 0, M), p("p");
+  * b_A.set_sparse_format(sparse_csr, {&b_row_ptr, &b_col});
+  * sparse_computation y("y", {i, p}, b_A, p_float64);
+  * y.set_expression(y(i, p) + y.value() * x(y.coordinate(1)));
+  * y.store_in(&b_y, {i});
+  * \endcode
+  *
+  * Example (SELL-C-sigma SpMV, vectorized across the C = 8 rows of a slice):
+  *
+  * \code
+  * var s("s", 0, NB_SLICES), k("k"), r("r");
+  * b_A.set_sparse_format(sparse_sell, {&b_slice_ptr, &b_col}, 8);
+  * sparse_computation y_sorted("y_sorted", {s, k, r}, b_A, p_float64);
+  * y_sorted.set_expression(y_sorted(s, k, r) + y_sorted.value() * x(y_sorted.coordinate(1)));
+  * y_sorted.store_in(&b_y_sorted, {s, r});
+  * y_sorted.tag_vector_level(r, 8);
+  * \endcode
+  *
+  * The rows of a SELL-C-sigma matrix are sorted: coordinate(0) is the
+  * position s * C + r of the row in the sorted order, and the result is
+  * reordered with the row_order buffer of tiramisu_csr_to_sell(), e.g.
+  * y(i) = y_sorted(row_order(i) / C, row_order(i) % C).
+  *
+  * Scheduling: the loop over the positions of a row can be scheduled like
+  * any loop (e.g. split, unrolled or vectorized).  A split of the outer loop
+  * is also applied to the computations of the bounds.  The outer loop can be
+  * parallelized; the work of the threads is balanced when the rows have
+  * similar numbers of entries.  To order this computation after other
+  * computations, order get_first_computation() after them.
+  */
+class sparse_computation: public computation
+{
+private:
+    /**
+      * The sparse buffer whose entries are iterated.
+      */
+    tiramisu::buffer *sparse_buffer;
+
+    /**
+      * The loop iterators: {outer, position} for CSR and CSC, {position}
+      * for COO, {slice, column, row} for SELL.
+      */
+    std::vector<tiramisu::var> iterators;
+
+    /**
+      * The computations that read the entries and the index buffers of
+      * the sparse buffer.
+      */
+    tiramisu::computation *values;
+    std::vector<tiramisu::computation *> index_values;
+
+    /**
+      * The constants that compute the first and the last (excluded) positions
+      * of the entries of a row (CSR) or a column (CSC), or the first position
+      * and the width of a slice (SELL).
+      */
+    tiramisu::constant *begin = nullptr;
+    tiramisu::constant *end = nullptr;
+
+    /**
+      * Construct the iteration domain of the computation \p name that
+      * iterates over the entries of \p sparse_buffer.  The positions are
+      * not bounded yet.
+      */
+    static std::string construct_sparse_iteration_domain(std::string name, std::vector<var> iterator_variables,
+                                                         tiramisu::buffer &sparse_buffer);
+
+    /**
+      * Schedule the computations of the bounds, then this computation, in
+      * the loops that they share.
+      */
+    void order_bound_computations();
+
+    /**
+      * The position of the current entry of a SELL matrix: the first
+      * position of the slice + column * C + row.
+      */
+    tiramisu::expr sell_position();
+
+public:
+    /**
+      * \brief Constructor for a computation that iterates over a sparse matrix.
+      *
+      * \details
+      *
+      * \p name is the name of the computation.
+      *
+      * \p iterator_variables are the loop iterators: {outer, position} for
+      * CSR and CSC, where outer has the bounds of the rows (resp. columns)
+      * and position has no bounds, {position} for COO, and {slice, column,
+      * row} for SELL, where slice has the bounds of the slices and column
+      * and row have no bounds.
+      *
+      * \p sparse_buffer is the buffer that stores the entries of the sparse
+      * matrix.  Its format must be set before.
+      *
+      * \p t is the type of the computation.  Its expression is set later
+      * with computation::set_expression().
+      */
+    sparse_computation(std::string name, std::vector<var> iterator_variables,
+                       tiramisu::buffer &sparse_buffer, primitive_t t);
+
+    /**
+      * Return the value of the current entry of the sparse matrix.
+      */
+    tiramisu::expr value();
+
+    /**
+      * Return the coordinate of the current entry of the sparse matrix
+      * in the dimension \p dim (0 for its row, 1 for its column).
+      */
+    tiramisu::expr coordinate(int dim);
+
+    /**
+      * Return the first computation of the loop nest of this computation
+      * (the computation of the first position of a row for CSR and CSC).
+      */
+    tiramisu::computation &get_first_computation();
+
+    using computation::split;
+
+    /**
+      * Split the loop level \p L0; if this is the outer loop, split the
+      * computations of the bounds too.
+      */
+    void split(int L0, int sizeX) override;
 };
 
 
@@ -5437,6 +8868,157 @@ protected:
                                                     Halide::Internal::Stmt &stmt);
     static Halide::Internal::Stmt make_buffer_free(buffer *b);
 
+    /**
+     * Run \p stmt, the body of \p fct, only when its GPU work must be captured
+     * in a CUDA graph, and launch the graph (see
+     * function::enable_cuda_graph()).  The invariants of \p fct must be in
+     * scope.
+     */
+    static Halide::Internal::Stmt make_cuda_graph_guard(const tiramisu::function &fct, Halide::Internal::Stmt stmt);
+
+    /**
+     * Make an operation of \p fct issued on the CUDA stream \p stream and
+     * using the buffers \p buffers wait for the work already issued on the
+     * other streams that use one of these buffers, then run \p s
+     * (see computation::tag_gpu_stream()).
+     */
+    static Halide::Internal::Stmt wait_for_other_streams(const tiramisu::function &fct, int stream,
+                                                         const std::set<std::string> &buffers,
+                                                         Halide::Internal::Stmt s);
+
+    /**
+     * Turn the allocations of the host temporary buffers of \p fct that have
+     * constant extents and that are not inside a parallel loop into sub-buffers
+     * of the workspace of \p fct (see function::enable_buffer_arena()),
+     * and set the size of the workspace.  The workspace itself is not allocated.
+     */
+    static Halide::Internal::Stmt carve_buffers_from_arena(tiramisu::function &fct, const Halide::Internal::Stmt &stmt);
+
+    /**
+     * Return the access pattern of the buffer \p b mapped from a file, with
+     * mmap_auto resolved from the schedule of \p fct (see
+     * buffer::set_mapped_file()).
+     */
+    static tiramisu::mmap_advice_t get_mapped_file_advice(const tiramisu::function &fct, const tiramisu::buffer *b);
+
+    /**
+     * Wrap the body of the function \p stmt (inside the invariants) with the
+     * mappings of the arguments of \p fct that are mapped from files.
+     */
+    static Halide::Internal::Stmt map_buffers_from_files(tiramisu::function &fct, const Halide::Internal::Stmt &stmt);
+
+    /**
+     * Create the loop over \p iterator of a loop level distributed across
+     * the GPUs (see computation::tag_gpu_device_level()), with the body
+     * \p body.  Every iteration selects its GPU before running \p body.
+     */
+    static Halide::Internal::Stmt make_gpu_device_loop(const std::string &iterator, Halide::Expr min,
+                                                       Halide::Expr extent, Halide::Internal::Stmt body);
+
+    /**
+     * Create the parallel loop over \p iterator of a doacross loop level
+     * (see computation::parallelize_doacross()), with the body \p body.
+     * The loops at the top of \p body wait on the progress counter of the
+     * previous iteration, and post the progress of the current iteration.
+     * The counters are allocated and initialized around the loop.
+     */
+    static Halide::Internal::Stmt make_doacross_loop(const std::string &iterator, const Halide::Expr &min,
+                                                     const Halide::Expr &extent, const Halide::Internal::Stmt &body,
+                                                     int distance);
+
+    /**
+     * Create the loops over \p iterator of the streaming dimension of a
+     * pipeline (see computation::pipeline()), with the body \p body: a
+     * parallel loop over the statements of \p body, each running its own
+     * loop over \p iterator.  Each stage waits on the progress counter of
+     * the previous stage (and, if \p depth is positive, of the last stage),
+     * and posts its own progress.  The counters are allocated and
+     * initialized around the loops.
+     */
+    static Halide::Internal::Stmt make_pipeline_loop(const std::string &iterator, const Halide::Expr &min,
+                                                     const Halide::Expr &extent, const Halide::Internal::Stmt &body,
+                                                     int depth);
+
+    /**
+     * Create the loops over \p iterator of a loop level split by the runtime
+     * sizes \p sizes (see computation::split_parametric()), with the body
+     * \p body.  The tile loop has the type \p for_type.  If \p sizes has two
+     * elements and \p body is a loop whose bounds do not depend on
+     * \p iterator, this loop is split by sizes[1] and its tile loop is moved
+     * between the tile loop and the point loop of \p iterator.
+     */
+    static Halide::Internal::Stmt make_parametric_split_loop(const std::string &iterator, const Halide::Expr &min,
+                                                             const Halide::Expr &extent,
+                                                             const Halide::Internal::Stmt &body,
+                                                             const std::vector<Halide::Expr> &sizes,
+                                                             Halide::Internal::ForType for_type,
+                                                             Halide::DeviceAPI device_api);
+
+    /**
+     * Create the parallel loop over \p iterator of a parallel reduction loop
+     * level (see computation::parallelize_reduction()), with the body
+     * \p body, which updates the buffer \p accumulator.
+     */
+    static Halide::Internal::Stmt make_parallel_reduction_loop(const std::string &iterator, const Halide::Expr &min,
+                                                               const Halide::Expr &extent,
+                                                               const Halide::Internal::Stmt &body,
+                                                               const std::string &accumulator,
+                                                               tiramisu::reduction_strategy_t strategy,
+                                                               int nb_partials);
+
+    /**
+     * Create the three passes of a parallel scan loop level over \p iterator
+     * (see computation::parallelize_scan()), with the body \p body, which
+     * scans the buffer \p accumulator.
+     */
+    static Halide::Internal::Stmt make_parallel_scan_loop(const std::string &iterator, const Halide::Expr &min,
+                                                          const Halide::Expr &extent,
+                                                          const Halide::Internal::Stmt &body,
+                                                          const std::string &accumulator, int nb_blocks);
+
+    /**
+     * Wrap the outermost loop nest \p stmt generated for the isl AST node
+     * \p node with the calls that profile it (see function::enable_profiling()).
+     */
+    static Halide::Internal::Stmt make_profiled_loop_nest(const tiramisu::function &fct, isl_ast_node *node,
+                                                          const Halide::Internal::Stmt &stmt);
+
+    /**
+     * Keep the values accumulated into a loop-invariant address of a serial
+     * loop (e.g. C[i][j] in the k loop of a gemm) in a scalar for the duration
+     * of the loop: the value is loaded once before the loop and stored once
+     * after it.  Only the buffers accessed at a single address in the loop,
+     * and not otherwise referenced in it, are promoted.
+     */
+    static Halide::Internal::Stmt promote_reductions_to_registers(const Halide::Internal::Stmt &stmt);
+
+    /**
+      * Keep only the statements of the inspector computations of \p stmt
+      * if \p inspector is true, or remove them otherwise (see
+      * computation::mark_as_inspector()).
+      */
+    static Halide::Internal::Stmt split_inspector(const Halide::Internal::Stmt &stmt, bool inspector);
+
+    /**
+      * Mark the stores of the computations vectorized with
+      * computation::vectorize_reduction() that are in the vectorized loops of
+      * \p stmt as reductions, so that Halide computes them with horizontal
+      * vector reductions.
+      */
+    static Halide::Internal::Stmt mark_vector_reductions(const Halide::Internal::Stmt &stmt);
+
+    /**
+      * Unroll the serial loops of \p stmt whose constant extent is the
+      * number of channels of an interleaved buffer they access (\p buffers
+      * maps the names of the interleaved buffers to their number of
+      * channels, see buffer::set_interleaved()), when they are around or
+      * inside a vectorized loop.  The loads and the stores of the channels
+      * are then next to each other once the loops are vectorized, and Halide
+      * rewrites them as dense vector accesses and shuffles.
+      */
+    static Halide::Internal::Stmt unroll_interleaved_channels(const Halide::Internal::Stmt &stmt,
+                                                              const std::map<std::string, int> &buffers);
+
     /**
      * Create a Halide expression from a  Tiramisu expression.
      */
@@ -5591,7 +9173,7 @@ public:
     xfer_prop(tiramisu::primitive_t d_type, std::initializer_list<tiramisu::xfer_attr> attrs,
               int xfer_prop_id);
 
-    static std::set<int> xfer_prop_ids;
+    static thread_local std::set<int> xfer_prop_ids;
 
     static std::string attr_to_string(xfer_attr attr);
 
@@ -5605,6 +9187,8 @@ public:
 
     void add_attr(tiramisu::xfer_attr attr);
 
+    void remove_attr(tiramisu::xfer_attr attr);
+
 };
 
 class communicator : public computation {
@@ -5612,6 +9196,12 @@ private:
 
     std::vector<tiramisu::expr> dims;
 
+    tiramisu::expr stride;
+
+    tiramisu::expr block_length;
+
+    tiramisu::expr channel;
+
 protected:
 
     xfer_prop prop;
@@ -5629,10 +9219,48 @@ public:
 
     xfer_prop get_xfer_props() const;
 
+    void set_xfer_props(xfer_prop prop);
+
     tiramisu::expr get_num_elements() const;
 
     void add_dim(tiramisu::expr size);
 
+    /**
+      * Transfer the elements of the message as blocks of \p block_length
+      * contiguous elements, separated by \p stride elements in the buffer,
+      * instead of a single contiguous block.
+      * For MPI, the layout is described with a derived (vector) datatype so that
+      * strided halos, such as the column boundaries of a row-major array, are
+      * sent and received in place without pack/unpack copies.
+      * The number of elements of the message (get_num_elements()) must be a
+      * multiple of \p block_length.
+      */
+    void set_stride(tiramisu::expr stride, tiramisu::expr block_length = tiramisu::expr(1));
+
+    /**
+      * Return true if set_stride() was called on this communicator.
+      */
+    bool is_strided() const;
+
+    tiramisu::expr get_stride() const;
+
+    tiramisu::expr get_block_length() const;
+
+    /**
+      * Issue this transfer on the communication channel \p channel, typically
+      * the iterator of the parallel loop that contains it.
+      * When the MPI runtime is initialized with tiramisu_MPI_init_thread_multiple(),
+      * transfers on different channels use different MPI communicators, so the
+      * threads of a parallel loop can communicate concurrently without their
+      * messages being matched with one another. A send and its matching receive
+      * must use the same channel.
+      * The channel is encoded in the tag of the message (see mpi_comm.h), so the
+      * message tags must be smaller than 2^15 when channels are used.
+      */
+    void set_channel(tiramisu::expr channel);
+
+    tiramisu::expr get_channel() const;
+
     /**
       * Collapse a loop level.
       */
@@ -5647,6 +9275,8 @@ public:
 };
 
 class send : public communicator {
+    friend global;
+
 private:
 
     tiramisu::computation *producer = nullptr;
@@ -5659,7 +9289,7 @@ private:
 
     tiramisu::expr dest;
 
-    static int next_msg_tag;
+    static thread_local int next_msg_tag;
 
 public:
     // TODO (Jess) is producer ever used?
@@ -5765,6 +9395,111 @@ public:
 
 };
 
+/**
+  * A collective communication: all the ranks that execute an instance of
+  * this computation take part in the same MPI collective on MPI_COMM_WORLD.
+  * The RHS of the computation is the local data contributed by the rank and
+  * the access relation (set with set_access()) gives the buffer into which
+  * the result is stored. Both can be the same buffer, in which case the
+  * collective is done in place.
+  * The number of elements contributed by each rank is set with add_dim() or
+  * collapse_many(), as for the point-to-point communicators.
+  */
+class collective : public communicator {
+protected:
+
+    /**
+      * \p collective_name is the name of the collective in the runtime
+      * library, e.g. "Allreduce" for tiramisu_MPI_Allreduce_<type>.
+      */
+    collective(std::string iteration_domain_str, std::string collective_name, tiramisu::expr rhs,
+               xfer_prop prop, tiramisu::function *fct);
+
+public:
+
+    virtual bool is_collective() const override;
+
+    /**
+      * The argument passed between the number of elements and the data
+      * (the root of a broadcast or the reduction operator), or an
+      * undefined expression if the collective does not take one.
+      */
+    virtual tiramisu::expr get_collective_arg() const = 0;
+
+};
+
+/**
+  * Reduce the data of all the ranks with \p op and store the result on all
+  * the ranks.
+  */
+class allreduce : public collective {
+private:
+
+    tiramisu::reduce_op op;
+
+public:
+
+    allreduce(std::string iteration_domain_str, tiramisu::expr rhs, tiramisu::reduce_op op,
+              xfer_prop prop, tiramisu::function *fct);
+
+    virtual tiramisu::expr get_collective_arg() const override;
+
+};
+
+/**
+  * Gather the data of all the ranks, ordered by rank, on all the ranks.
+  * The output buffer holds CRANKS times the number of elements.
+  */
+class allgather : public collective {
+public:
+
+    allgather(std::string iteration_domain_str, tiramisu::expr rhs, xfer_prop prop,
+              tiramisu::function *fct);
+
+    virtual tiramisu::expr get_collective_arg() const override;
+
+};
+
+/**
+  * Broadcast the data of rank \p root to all the ranks.
+  */
+class broadcast : public collective {
+private:
+
+    tiramisu::expr root;
+
+public:
+
+    broadcast(std::string iteration_domain_str, tiramisu::expr rhs, tiramisu::expr root,
+              xfer_prop prop, tiramisu::function *fct);
+
+    virtual tiramisu::expr get_collective_arg() const override;
+
+};
+
+/**
+  * Reduce the data of all the ranks with \p op and scatter the result:
+  * rank r receives the r-th block of the number of elements of the
+  * communicator. The input buffer holds CRANKS such blocks.
+  */
+class reduce_scatter : public collective {
+private:
+
+    tiramisu::reduce_op op;
+
+public:
+
+    reduce_scatter(std::string iteration_domain_str, tiramisu::expr rhs, tiramisu::reduce_op op,
+                   xfer_prop prop, tiramisu::function *fct);
+
+    virtual tiramisu::expr get_collective_arg() const override;
+
+};
+
+std::string create_send_func_name(const xfer_prop chan);
+
+std::string create_recv_func_name(const xfer_prop chan);
+
 // Halide IR specific functions
 
 void halide_stmt_dump(Halide::Internal::Stmt s);
@@ -5774,7 +9509,34 @@ Halide::Module lower_halide_pipeline(
     const Halide::Target &t,
     const std::vector<Halide::Argument> &args,
     const Halide::LinkageType linkage_type,
-    Halide::Internal::Stmt s);
+    Halide::Internal::Stmt s,
+    const std::set<std::string> &streaming_buffers = {});
+
+/**
+  * The cache of the files generated by Halide (objects, headers...), shared
+  * by the builds of the machine: gen_halide_obj() and the auto-scheduler look
+  * up the statements they are about to lower, and copy the files of a
+  * previous build instead of lowering and compiling them again.
+  *
+  * The files are stored in $TIRAMISU_OBJECT_CACHE_DIR, or else in
+  * $XDG_CACHE_HOME/tiramisu/objects or ~/.cache/tiramisu/objects, and the
+  * cache is disabled if TIRAMISU_OBJECT_NO_CACHE is set.
+  *
+  * object_cache_key() returns the key of the files generated for the
+  * statements \p stmts of the pipeline \p pipeline_name, with the arguments
+  * \p args, for the target \p t; \p options holds everything else that changes
+  * the generated files.  It returns an empty string, which is never found,
+  * if the cache is disabled.  fetch_from_object_cache() copies the cached
+  * files to \p outputs and returns false if they are not all cached.
+  */
+std::string object_cache_key(const std::string &pipeline_name, const Halide::Target &t,
+                             const std::vector<Halide::Argument> &args,
+                             const std::vector<Halide::Internal::Stmt> &stmts,
+                             const std::string &options);
+bool fetch_from_object_cache(const std::string &key,
+                             const std::map<Halide::OutputFileType, std::string> &outputs);
+void store_in_object_cache(const std::string &key,
+                           const std::map<Halide::OutputFileType, std::string> &outputs);
 
 int loop_level_into_dynamic_dimension(int level);
 int loop_level_into_static_dimension(int level);
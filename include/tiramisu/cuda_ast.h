@@ -28,38 +28,17 @@
 #define FN_CALL_TYPED2(op, x, n, T) case op: return tiramisu::cuda_ast::op_data_t{false, (n), (x), (T)};
 
 #include <isl/id.h>
+#include <tiramisu/isl_ptr.h>
 #include <tiramisu/type.h>
+#include <atomic>
 #include <string>
+#include <tuple>
 #include <vector>
 #include "utils.h"
 
 namespace tiramisu
 {
 
-struct isl_ast_expr_deleter
-{
-    void operator()(isl_ast_expr * p) const {isl_ast_expr_free(p);}
-};
-typedef std::unique_ptr<isl_ast_expr, isl_ast_expr_deleter> isl_ast_expr_ptr;
-
-struct isl_id_deleter
-{
-    void operator()(isl_id * p) const {isl_id_free(p);}
-};
-typedef std::unique_ptr<isl_id, isl_id_deleter> isl_id_ptr;
-
-struct isl_ast_node_list_deleter
-{
-    void operator()(isl_ast_node_list * p) const {isl_ast_node_list_free(p);}
-};
-typedef std::unique_ptr<isl_ast_node_list, isl_ast_node_list_deleter> isl_ast_node_list_ptr;
-
-struct isl_val_deleter
-{
-    void operator()(isl_val * p) const {isl_val_free(p);}
-};
-typedef std::unique_ptr<isl_val, isl_val_deleter> isl_val_ptr;
-
 class function;
 
 namespace cuda_ast
@@ -177,6 +156,19 @@ const std::string tiramisu_type_to_cuda_type(tiramisu::primitive_t t);
 //            {p_float32, "float"},
 //            {p_float64, "double"},
 //    };
+/**
+  * The language in which the nodes are printed.  The kernels are printed in
+  * OpenCL C, and their launches as calls to tiramisu_opencl_launch(), by
+  * function::gen_opencl_stmt().
+  */
+enum class dialect_t
+{
+    cuda,
+    opencl
+};
+
+extern dialect_t print_dialect;
+
 enum class memory_location
 {
     host,
@@ -271,6 +263,11 @@ public:
     buffer(primitive_t type, const std::string &name, memory_location location, const std::vector<statement_ptr> &size, const std::vector<tiramisu::expr>& sizes_expr);
     void print(std::stringstream &ss, const std::string &base) override;
     void print_declaration(std::stringstream &ss, const std::string &base) override;
+    /**
+      * Print the declaration of a pointer to the buffer with a qualifier of the
+      * pointer (e.g. restrict).
+      */
+    void print_declaration(std::stringstream &ss, const std::string &base, const std::string &pointer_qualifier);
     void print_size(std::stringstream &ss, const std::string &base, const std::string &seperator);
     bool is_buffer() const override;
     std::vector<tiramisu::expr> sizes_expr() const { return m_sizes_expr; }
@@ -395,8 +392,11 @@ public:
 
 public:
     void print(std::stringstream &ss, const std::string &base) override;
+    /** A pragma printed before the loop (e.g. "#pragma omp parallel for"). */
+    void set_pragma(const std::string &pragma);
 
 private:
+    std::string pragma;
     statement_ptr initial_value;
     statement_ptr condition;
     statement_ptr incrementer;
@@ -422,7 +422,11 @@ private:
 class buffer_access : public statement
 {
 public:
-    buffer_access(buffer_ptr accessed, const std::vector<statement_ptr> &access);
+    /**
+      * If \p read_only_cache is true, the access is a load through the
+      * read-only data cache (__ldg()).
+      */
+    buffer_access(buffer_ptr accessed, const std::vector<statement_ptr> &access, bool read_only_cache = false);
 
 public:
     void print(std::stringstream &ss, const std::string &base) override;
@@ -432,6 +436,7 @@ public:
 private:
     buffer_ptr accessed;
     std::vector<cuda_ast::statement_ptr> access;
+    bool read_only_cache;
 };
 
 class op : public statement
@@ -509,8 +514,16 @@ private:
 class sync : public statement
 {
 public:
-    sync();
+    /**
+      * If \p in_flight_copy_stages is not negative, the pending asynchronous
+      * copies are committed as a new stage and the barrier waits until at
+      * most \p in_flight_copy_stages stages are still in flight.
+      */
+    explicit sync(int in_flight_copy_stages = -1);
     void print(std::stringstream &ss, const std::string &base) override;
+
+private:
+    int in_flight_copy_stages;
 };
 
 typedef std::unordered_map<std::string, std::pair<tiramisu::primitive_t, cuda_ast::memory_location> > scalar_data_t;
@@ -527,6 +540,9 @@ struct gpu_iterator
         z
     } dimension;
     statement_ptr size;
+    // Set for the blocks of a kernel executed by a persistent kernel, whose
+    // indices are read from _persistent_block instead of blockIdx
+    bool persistent = false;
     // returns a simplified name; __tx__, __ty__, __tz__, __bx__, __by__, __bz__
     std::string simplified_name();
 };
@@ -536,9 +552,11 @@ class gpu_iterator_read : public statement
 private:
     gpu_iterator it;
     bool simplified;
+    // Number of hardware threads per iteration (32 when a warp executes each iteration)
+    int lanes;
 public:
     explicit gpu_iterator_read(gpu_iterator it);
-    explicit gpu_iterator_read(gpu_iterator it, bool simplified);
+    explicit gpu_iterator_read(gpu_iterator it, bool simplified, int lanes = 1);
     void print(std::stringstream &ss, const std::string &base) override;
 };
 
@@ -560,9 +578,15 @@ public:
     host_function(primitive_t type, std::string name, const std::vector<abstract_identifier_ptr> &arguments, statement_ptr body);
     void print(std::stringstream &ss, const std::string &base) override;
     void set_pointer_return(bool val = true);
+    /** The linkage printed before the function, extern "C" by default. */
+    void set_linkage(const std::string &linkage);
+    /** A qualifier of the pointers to the buffer arguments (e.g. restrict). */
+    void set_pointer_qualifier(const std::string &qualifier);
 
 private:
     bool pointer_return;
+    std::string linkage = "extern \"C\"";
+    std::string pointer_qualifier;
     std::string name;
     statement_ptr body;
     std::vector<abstract_identifier_ptr> arguments;
@@ -572,6 +596,7 @@ class kernel
 {
     friend class kernel_call;
     friend class kernel_definition;
+    friend class persistent_part;
 private:
     struct dim3d_t
     {
@@ -586,8 +611,14 @@ private:
     std::map<std::string, scalar_ptr> used_constants;
     std::map<std::string, buffer_ptr> used_buffers;
     statement_ptr body;
-    static int kernel_count;
+    static std::atomic<int> kernel_count;
     int kernel_number;
+    int stream;
+    // The kernels executed one after the other, at each iteration of its
+    // body, by a persistent kernel (see computation::tag_gpu_persistent_level())
+    std::vector<std::shared_ptr<kernel>> parts;
+    // The minimum number of blocks per multiprocessor of __launch_bounds__, 0 for none
+    int min_blocks_per_multiprocessor = 0;
 public:
     kernel();
     void set_dimension(gpu_iterator dimension);
@@ -598,10 +629,42 @@ public:
     void add_used_scalar(scalar_ptr scalar);
     void add_used_buffer(buffer_ptr buffer);
     std::vector<abstract_identifier_ptr> get_arguments();
+    /** The CUDA stream the kernel is launched on, 0 for the default stream. */
+    void set_stream(int stream);
+    int get_stream() const;
+    /**
+      * Make \p part a kernel executed by this persistent kernel: its buffers
+      * and its scalars, except \p local_scalars (the iterators of the loops
+      * inside the persistent kernel), become arguments of this kernel.
+      */
+    void add_persistent_part(std::shared_ptr<kernel> part, const std::unordered_set<std::string> &local_scalars);
+    bool is_persistent() const;
+    /**
+      * Declare the kernel with __launch_bounds__(threads, min_blocks) if its
+      * number of threads per block is a constant (see function::set_gpu_launch_bounds()).
+      */
+    void set_launch_bounds(int min_blocks);
+    /** The number of threads per block if it is a constant, -1 otherwise. */
+    long get_constant_threads() const;
 };
 
 typedef std::shared_ptr<kernel> kernel_ptr;
 
+/**
+  * A kernel executed inside a persistent kernel: its blocks are distributed
+  * over the blocks of the persistent kernel, and a grid-wide barrier waits
+  * for all of them.
+  */
+class persistent_part : public statement
+{
+public:
+    explicit persistent_part(kernel_ptr kernel);
+    void print(std::stringstream &ss, const std::string &base) override;
+
+private:
+    kernel_ptr kernel;
+};
+
 class kernel_call : public statement
 {
 public:
@@ -636,11 +699,16 @@ private:
 class allocate : public statement
 {
 public:
-    allocate(buffer_ptr b);
+    /**
+      * If \p aligned is true, host memory is allocated with tiramisu_aligned_alloc()
+      * (defined by the prelude of the C backend) instead of malloc().
+      */
+    allocate(buffer_ptr b, bool aligned = false);
     void print(std::stringstream &ss, const std::string &base) override;
 
 private:
     buffer_ptr b;
+    bool aligned;
 };
 
 class free : public statement
@@ -676,11 +744,36 @@ private:
     std::unordered_map<std::string, cuda_ast::gpu_iterator> gpu_iterators;
     std::vector<cuda_ast::statement_ptr> gpu_conditions;
     std::unordered_set<std::string> gpu_local;
+    std::vector<isl_ast_node *> loop_node_stack;
+    // Set when each thread of the current kernel is a warp (see computation::tag_gpu_tensor_core())
+    bool warp_per_thread = false;
+    // Set inside a loop executed by a persistent kernel, whose iterator is at persistent_depth
+    // in iterator_stack (see computation::tag_gpu_persistent_level())
+    bool in_persistent = false;
+    kernel_ptr persistent_kernel;
+    int persistent_depth = -1;
+    bool is_persistent_loop(isl_ast_node *node, int level) const;
+    std::unordered_set<std::string> persistent_local_scalars() const;
+    const std::tuple<int, int, int> *get_tensor_core_levels(computation *comp) const;
+    computation *get_tensor_core_computation(isl_ast_node *node) const;
+    bool contains_tensor_core_computation(isl_ast_node *node) const;
+    statement_ptr cuda_stmt_tensor_core_call(computation *comp, const std::pair<tiramisu::expr, tiramisu::expr> &assignment);
+    statement_ptr first_lane_only(statement_ptr stmt);
+    // The update of the accumulator of a reduction parallelized over GPU blocks or threads
+    // (see computation::parallelize_reduction()), nullptr if comp is not such a reduction
+    statement_ptr cuda_stmt_gpu_reduction(computation *comp, const std::pair<tiramisu::expr, tiramisu::expr> &assignment);
     cuda_ast::gpu_iterator get_gpu_condition(gpu_iterator::type_t type, gpu_iterator::dimension_t dim,
                                                  cuda_ast::statement_ptr lower_bound,
                                                  cuda_ast::statement_ptr upper_bound);
     statement_ptr get_scalar_from_name(std::string name);
     std::unordered_map<computation *, std::vector<isl_ast_expr*>> index_exprs;
+    // Set by the C backend: host loops get OpenMP pragmas and host buffers are allocated aligned
+    bool c_backend = false;
+    std::string cpu_loop_pragma(isl_ast_node *body, int level) const;
+    // "#pragma unroll" for the loops of the kernels tagged with tag_unroll_level()
+    std::string kernel_loop_pragma(isl_ast_node *body, int level) const;
+    // True if no computation of the function stores into the buffer \p name (see expr::is_gather())
+    bool is_read_only_buffer(const std::string &name) const;
 public:
     explicit generator(tiramisu::function &fct);
 
@@ -713,18 +806,59 @@ struct exec_result {
 
 }
 
+/**
+  * The resources used by a kernel, reported by ptxas, and the occupancy of
+  * a multiprocessor that they allow (see function::get_gpu_kernel_resources()).
+  */
+struct kernel_resources
+{
+    std::string name;
+    int registers = 0;
+    // Bytes of static shared memory per block, of stack per thread, and of spills per thread
+    int shared_bytes = 0;
+    int stack_bytes = 0;
+    int spill_store_bytes = 0;
+    int spill_load_bytes = 0;
+    // The threads per block, -1 if they are not a constant
+    long threads = -1;
+    // The active warps over the maximum number of warps of a multiprocessor, -1 if unknown
+    float occupancy = -1;
+};
+
 class compiler
 {
     std::string code;
+    // The number of threads per block of the kernels, when it is a constant
+    std::map<std::string, long> kernel_threads;
+    mutable std::vector<kernel_resources> resources;
+
+    // Read the resources of the kernels from the output of ptxas -v
+    void parse_resources(const std::string &ptxas_output) const;
+    static std::string get_ptxas_output(const std::string &obj_name);
 
     bool compile_cpu_obj(const std::string &filename, const std::string &obj_name) const;
     bool compile_gpu_obj(const std::string &obj_name) const;
     static exec_result exec(const std::string &cmd);
+    static std::string nvcc_flags();
+
+    /**
+     * The objects compiled from a CUDA file are cached on disk, under a key
+     * that hashes the file, the nvcc path and the nvcc flags.  The cache
+     * directory is TIRAMISU_CUDA_CACHE_DIR, or tiramisu/cuda in the user
+     * cache directory; setting TIRAMISU_CUDA_NO_CACHE disables the cache.
+     * An empty key or directory means that the cache is not used.
+     */
+    static std::string cache_directory();
+    static std::string cache_key(const std::string &filename);
+    bool fetch_from_cache(const std::string &key, const std::string &obj_name) const;
+    void store_in_cache(const std::string &key, const std::string &obj_name) const;
 
 public:
     std::string get_cpu_obj(const std::string &obj_name) const;
     std::string get_gpu_obj(const std::string &obj_name) const;
-    explicit compiler(const std::string &code);
+    explicit compiler(const std::string &code, const std::map<std::string, long> &kernel_threads = {});
+    /** The resources of the kernels, once compile() succeeded. */
+    const std::vector<kernel_resources> &get_kernel_resources() const;
     bool compile(const std::string &obj_name) const;
 };
 
@@ -43,7 +43,7 @@ void str_dump(const std::string &str, const char *str2);
 void str_dump(const char *str, const char *str2);
 void print_indentation();
 
-extern int tiramisu_indentation;
+extern thread_local int tiramisu_indentation;
 
 } // namespace tiramisu
 
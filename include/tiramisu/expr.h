@@ -11,6 +11,7 @@
 #include <isl/space.h>
 
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 #include <string.h>
@@ -43,6 +44,11 @@ using only_integral = typename std::enable_if<std::is_integral<T>::value, expr>:
 /**
   * A class that holds all the global variables necessary for Tiramisu.
   * It also holds Tiramisu options.
+  *
+  * This state is per thread: several threads of a process can build and
+  * generate independent functions at the same time.  tiramisu::init(name)
+  * resets the state of the calling thread (see reset_state()), so a thread
+  * can build several functions one after the other.
   */
 class global
 {
@@ -50,12 +56,22 @@ private:
     /**
       * Perform automatic data mapping ?
       */
-    static bool auto_data_mapping;
+    static thread_local bool auto_data_mapping;
 
     /**
      * Type of the loop iterators to generate.
      */
-    static primitive_t loop_iterator_type;
+    static thread_local primitive_t loop_iterator_type;
+
+    /**
+      * Hoist loop invariant values and conditions during code generation ?
+      */
+    static thread_local bool loop_invariant_code_motion;
+
+    /**
+      * The number of buffer names generated by generate_new_buffer_name().
+      */
+    static thread_local int buffer_name_counter;
 
     /**
       * When Tiramisu is initialized, an implicit Tiramisu
@@ -64,7 +80,7 @@ private:
       * the user indicates otherwise using the Tiramisu API (by providing
       * a different function as input to the API).
       */
-    static function *implicit_fct;
+    static thread_local function *implicit_fct;
 
 public:
 
@@ -73,10 +89,20 @@ public:
       */
     static std::string generate_new_buffer_name()
     {
-        static int counter = 0;
-        return "b" + std::to_string(counter++);
+        return "b" + std::to_string(buffer_name_counter++);
     }
 
+    /**
+      * Forget the variables declared, the names generated and the options set
+      * by the calling thread for the previous functions, and set the default
+      * options.  The implicit function is not changed.
+      *
+      * The functions built before remain valid (they do not share any state
+      * with the next ones), but the generated names start again from the
+      * same values: they are unique in a function, not across functions.
+      */
+    static void reset_state();
+
     /**
       * Return the implicit function created during Tiramisu initialization.
       *
@@ -127,10 +153,29 @@ public:
         return global::auto_data_mapping;
     }
 
+    /**
+      * If this option is set to true, the code generator
+      * hoists the loop invariant values (for example the parts of the
+      * linearized buffer indices that do not depend on the inner loops)
+      * and the loop invariant conditions to the outermost loop where they
+      * are defined, after common subexpression elimination.
+      * It is disabled by default.
+      */
+    static void set_loop_invariant_code_motion(bool v)
+    {
+        global::loop_invariant_code_motion = v;
+    }
+
+    static bool is_loop_invariant_code_motion_set()
+    {
+        return global::loop_invariant_code_motion;
+    }
+
     static void set_default_tiramisu_options()
     {
         global::loop_iterator_type = p_int32;
         set_auto_data_mapping(true);
+        set_loop_invariant_code_motion(false);
     }
 
     static void set_loop_iterator_type(primitive_t t) {
@@ -150,11 +195,86 @@ public:
 
 
 
+/**
+  * The operands, the access indices or the arguments of a tiramisu::expr.
+  *
+  * The elements are stored in a node shared by all the copies of the list,
+  * so copying an expression is O(1) whatever the size of its tree.  A shared
+  * node is copied the first time the list is modified (copy on write): a
+  * reference returned by a non-const accessor is valid until the list is
+  * copied.  The lists built by the constructors of tiramisu::expr are
+  * hash-consed: equal lists of hash-consed operands share the same node, so
+  * identical subexpressions are stored once.
+  */
+class expr_list
+{
+    struct node : public std::enable_shared_from_this<node>
+    {
+        std::vector<tiramisu::expr> elements;
+
+        /**
+          * True if the node is in the hash-consing table (it is then never
+          * modified).
+          */
+        bool interned = false;
+
+        /**
+          * The hash of the elements, if it is computed.
+          */
+        mutable bool hashed = false;
+        mutable std::size_t hash = 0;
+    };
+
+    std::shared_ptr<node> shared;
+
+    /**
+      * Make the node of this list its own and modifiable.
+      */
+    void detach();
+
+    static const std::vector<tiramisu::expr> &empty_vector();
+
+public:
+    expr_list() {}
+    expr_list(const std::vector<tiramisu::expr> &vector);
+
+    operator const std::vector<tiramisu::expr> &() const;
+
+    size_t size() const;
+    bool empty() const;
+    const tiramisu::expr &operator[](size_t i) const;
+    tiramisu::expr &operator[](size_t i);
+    void push_back(const tiramisu::expr &e);
+
+    std::vector<tiramisu::expr>::const_iterator begin() const;
+    std::vector<tiramisu::expr>::const_iterator end() const;
+    std::vector<tiramisu::expr>::iterator begin();
+    std::vector<tiramisu::expr>::iterator end();
+
+    /**
+      * Return true if this list and \p other share the same node (they are
+      * then equal).
+      */
+    bool same_node(const expr_list &other) const;
+
+    /**
+      * Return a hash of the elements of the list (see expr::hash()).
+      */
+    std::size_t hash() const;
+
+    /**
+      * Share the node of an equal hash-consed list if there is one, or make
+      * the node of this list the hash-consed one.
+      */
+    void intern();
+};
+
 /**
   * A class to represent tiramisu expressions.
   */
 class expr
 {
+    friend class expr_list;
     friend class input;
     friend class var;
     friend class sync;
@@ -170,7 +290,7 @@ class expr
       * The value of the 1st, 2nd and 3rd operands of the expression.
       * op[0] is the 1st operand, op[1] is the 2nd, ...
       */
-    std::vector<tiramisu::expr> op;
+    tiramisu::expr_list op;
 
     /**
       * The value of the expression.
@@ -195,7 +315,7 @@ class expr
       * For example for the computation C0(i,j), the access is
       * the vector {i, j}.
       */
-    std::vector<tiramisu::expr> access_vector;
+    tiramisu::expr_list access_vector;
 
     /**
       * A vector of expressions representing arguments of an
@@ -206,7 +326,7 @@ class expr
       *     the computation C0 (i.e., its buffer).
       * \p vector should be {tiramisu::expr(1), C1(0,0), tiramisu::expr(o_address, tiramisu::var("C0"))}.
       */
-    std::vector<tiramisu::expr> argument_vector;
+    tiramisu::expr_list argument_vector;
 
     /**
       * Is this expression defined?
@@ -268,6 +388,7 @@ public:
         this->defined = true;
 
         this->op.push_back(expr0);
+        this->op.intern();
     }
 
     /**
@@ -277,7 +398,9 @@ public:
     {
         if ((o == tiramisu::o_floor) &&
             (expr0.get_data_type() != tiramisu::p_float32) &&
-            (expr0.get_data_type() != tiramisu::p_float64))
+            (expr0.get_data_type() != tiramisu::p_float64) &&
+            (expr0.get_data_type() != tiramisu::p_float16) &&
+            (expr0.get_data_type() != tiramisu::p_bfloat16))
                 expr0 = tiramisu::expr(tiramisu::o_cast, p_float32, expr0);
 
         this->_operator = o;
@@ -286,6 +409,7 @@ public:
         this->defined = true;
 
         this->op.push_back(expr0);
+        this->op.intern();
     }
 
     /**
@@ -339,6 +463,7 @@ public:
 
         this->op.push_back(expr0);
         this->op.push_back(expr1);
+        this->op.intern();
     }
 
     /**
@@ -357,6 +482,7 @@ public:
         this->op.push_back(expr0);
         this->op.push_back(expr1);
         this->op.push_back(expr2);
+        this->op.intern();
     }
 
     /**
@@ -832,6 +958,20 @@ public:
         return defined;
     }
 
+    /**
+      * Return a hash of the expression: equal expressions (see is_equal())
+      * have the same hash.  The hash of the operands is computed once for
+      * hash-consed operands, so this is cheap enough to index expressions
+      * in hash tables (e.g. to find common subexpressions).
+      */
+    std::size_t hash() const;
+
+    /**
+      * Return true if \p a and \p b are equal, comparing their operands by
+      * node (see expr_list::same_node()).
+      */
+    static bool shallow_equal(const tiramisu::expr &a, const tiramisu::expr &b);
+
     /**
       * Return true if \p e is identical to this expression.
       */
@@ -852,14 +992,18 @@ public:
             return equal;
         }
 
-        for (int i = 0; i < this->access_vector.size(); i++)
-            equal = equal && this->access_vector[i].is_equal(e.access_vector[i]);
+        // The lists that share their node are equal
+        if (!this->access_vector.same_node(e.access_vector))
+            for (int i = 0; i < this->access_vector.size(); i++)
+                equal = equal && this->access_vector[i].is_equal(e.access_vector[i]);
 
-        for (int i = 0; i < this->op.size(); i++)
-            equal = equal && this->op[i].is_equal(e.op[i]);
+        if (!this->op.same_node(e.op))
+            for (int i = 0; i < this->op.size(); i++)
+                equal = equal && this->op[i].is_equal(e.op[i]);
 
-        for (int i = 0; i < this->argument_vector.size(); i++)
-            equal = equal && this->argument_vector[i].is_equal(e.argument_vector[i]);
+        if (!this->argument_vector.same_node(e.argument_vector))
+            for (int i = 0; i < this->argument_vector.size(); i++)
+                equal = equal && this->argument_vector[i].is_equal(e.argument_vector[i]);
 
         if ((this->etype == e_val) && (e.etype == e_val))
         {
@@ -1015,6 +1159,7 @@ public:
     void set_access(std::vector<tiramisu::expr> vector)
     {
         access_vector = vector;
+        access_vector.intern();
     }
 
     /**
@@ -1035,6 +1180,7 @@ public:
     void set_arguments(std::vector<tiramisu::expr> vector)
     {
         argument_vector = vector;
+        argument_vector.intern();
     }
 
     /**
@@ -1190,6 +1336,20 @@ public:
             return false;
     }
 
+    /**
+      * Return true if this expression is an access whose indices depend on the
+      * values of other accesses or on floating point computations, e.g.
+      * in(cast(p_int32, floor(y)), x) or x(col(j)): the elements accessed by
+      * consecutive iterations are not contiguous (a gather).
+      *
+      * On GPUs, the gathers from the buffers that are never written by the
+      * function go through the read-only data cache (__ldg()).  On CPUs, the
+      * gathers of vectorized loops are generated as vector gather instructions
+      * (AVX2 and AVX-512 vpgather) by the C backend (see function::codegen_c()),
+      * the Halide backend loads their elements one by one.
+      */
+    bool is_gather() const;
+
     bool is_unbounded() const
     {
         if (this->get_name() == "_unbounded")
@@ -1705,6 +1865,65 @@ public:
     }
 };
 
+inline expr_list::operator const std::vector<tiramisu::expr> &() const
+{
+    return this->shared ? this->shared->elements : empty_vector();
+}
+
+inline size_t expr_list::size() const
+{
+    return this->shared ? this->shared->elements.size() : 0;
+}
+
+inline bool expr_list::empty() const
+{
+    return this->size() == 0;
+}
+
+inline const tiramisu::expr &expr_list::operator[](size_t i) const
+{
+    return this->shared->elements[i];
+}
+
+inline tiramisu::expr &expr_list::operator[](size_t i)
+{
+    this->detach();
+    return this->shared->elements[i];
+}
+
+inline void expr_list::push_back(const tiramisu::expr &e)
+{
+    this->detach();
+    this->shared->elements.push_back(e);
+}
+
+inline std::vector<tiramisu::expr>::const_iterator expr_list::begin() const
+{
+    return static_cast<const std::vector<tiramisu::expr> &>(*this).begin();
+}
+
+inline std::vector<tiramisu::expr>::const_iterator expr_list::end() const
+{
+    return static_cast<const std::vector<tiramisu::expr> &>(*this).end();
+}
+
+inline std::vector<tiramisu::expr>::iterator expr_list::begin()
+{
+    this->detach();
+    return this->shared->elements.begin();
+}
+
+inline std::vector<tiramisu::expr>::iterator expr_list::end()
+{
+    this->detach();
+    return this->shared->elements.end();
+}
+
+inline bool expr_list::same_node(const expr_list &other) const
+{
+    return this->shared == other.shared;
+}
+
 /**
   * A class that represents a synchronization object.
   * e.g. in the context of GPUs this will get transformed to
@@ -1729,6 +1948,7 @@ public:
 class var: public tiramisu::expr
 {
     friend computation;
+    friend global;
 private:
     // TODO if more than one scope, variables are to be declared per scope
     /**
@@ -1738,7 +1958,7 @@ private:
       * The point of this is to make sure that all variables with the same name have the same
       * type, and thus are equal.
       */
-    static std::unordered_map<std::string, var> declared_vars;
+    static thread_local std::unordered_map<std::string, var> declared_vars;
 
     /**
       * This has the same as the var(name), except that if \p save is false, then whatever
@@ -1884,6 +2104,112 @@ expr value_cast(primitive_t tT, cT val) {
   */
 expr cast(primitive_t tT, const expr & e);
 
+/**
+  * Returns the product of \p a and \p b computed in a type wide enough for
+  * the product to be exact: an integer type twice as wide as the operands
+  * (signed if one of them is signed, e.g. p_int16 for a p_uint8 times a
+  * p_int8), or p_float32 for p_float16 and p_bfloat16 operands.  If
+  * \p result_type is not p_none, the product is computed in \p result_type.
+  *
+  * Halide recognizes these widening multiplications; summed over a loop
+  * vectorized with computation::vectorize_reduction(), they are lowered to
+  * the dot product instructions of the target (pmaddwd, or the VNNI
+  * instructions with the AVX512_SapphireRapids target feature, see
+  * function::add_target_feature()).
+  */
+expr widening_mul(const expr &a, const expr &b, primitive_t result_type = p_none);
+
+/**
+  * Returns \p acc + widening_mul(\p a, \p b) computed in the type of \p acc,
+  * e.g. the accumulation of the product of two p_int8 in a p_int32, or of
+  * two p_bfloat16 in a p_float32.
+  */
+expr widening_mul_add(const expr &acc, const expr &a, const expr &b);
+
+/**
+  * The ranges of values known for some computations (or inputs), by name,
+  * e.g. {{"img", {0, 1023}}} for 10-bit pixels stored in p_uint16.
+  */
+typedef std::map<std::string, std::pair<int64_t, int64_t>> value_ranges_t;
+
+/**
+  * Compute in \p min and \p max the range of the values of the integer
+  * expression \p e, from the ranges of the types of its leaves, of the
+  * constants and of the accesses to the computations in \p ranges, through
+  * the arithmetic operators (+, -, *, / and % by a constant, shifts by a
+  * constant, min, max, select, casts).  When an operation can overflow its
+  * type, its range is the range of its type.  Returns false if \p e is not
+  * an integer expression or if its range is not bounded (p_uint64).
+  */
+bool get_value_range(const expr &e, int64_t &min, int64_t &max, const value_ranges_t &ranges = {});
+
+/**
+  * Returns \p e where the integer operations computed in a type wider than
+  * needed are computed in a narrower type (8 or 16 bits, or 32 bits for
+  * 64-bit operations), when get_value_range() proves that none of the
+  * intermediate values overflows the narrower type.  The result of the
+  * narrowed operations is cast back to their original type, so the type
+  * of \p e does not change.  For example, with p_uint8 inputs,
+  * \code
+  * cast(p_uint8, (cast(p_int32, a) + cast(p_int32, b) + cast(p_int32, c) + 1) / 3)
+  * \endcode
+  * is computed in p_uint16, so that a vector of the same size holds twice
+  * as many lanes as in p_int32.  Operations on unsigned types are only
+  * narrowed to unsigned types, so the wrap-around of unsigned arithmetic
+  * is never changed.
+  */
+expr narrow_integer_types(const expr &e, const value_ranges_t &ranges = {});
+
+/**
+  * Returns the complex number \p re + i * \p im, of type p_complex64 if
+  * \p re and \p im are p_float32 and p_complex128 if they are p_float64.
+  *
+  * The operators +, -, * and / of expressions of complex types compute
+  * complex additions, subtractions, multiplications and divisions, and
+  * a cast of a real number to a complex type has a null imaginary part.
+  * The two operands of a binary operator must have the same type, e.g.
+  * \code
+  * computation C({i, j}, A(i, j) * cast(p_complex64, alpha) + conjugate(B(i, j)), p_complex64);
+  * \endcode
+  * where the buffers of A, B and C are declared with the type p_complex64
+  * (see buffer::buffer()).  On CPUs, a complex value is a vector of its real
+  * and imaginary parts, so that the loops over complex numbers are
+  * vectorized with interleaved complex arithmetic.  On GPUs, it is a
+  * float2 (or a double2).
+  */
+expr make_complex(const expr &re, const expr &im);
+
+/**
+  * Returns the real part of the complex number \p e.
+  */
+expr real_part(const expr &e);
+
+/**
+  * Returns the imaginary part of the complex number \p e.
+  */
+expr imag_part(const expr &e);
+
+/**
+  * Returns the complex conjugate of the complex number \p e.
+  */
+expr conjugate(const expr &e);
+
+/**
+  * Returns the bilinear interpolation of \p in, a two-dimensional computation
+  * (or input) of \p height x \p width elements accessed as in(y, x), at the
+  * position (\p y, \p x) given by two p_float32 expressions, e.g. for an
+  * affine warp
+  * \code
+  * computation warp({i, j}, bilinear(in, a00 * i + a01 * j + b0, a10 * i + a11 * j + b1, N0, N1));
+  * \endcode
+  * The four neighbors are clamped to the borders of \p in and combined with
+  * o_lerp.  The floor and the fractional part of the position are computed
+  * once, and the four loads share their index computations, so that a
+  * vectorized loop computes a single vector of indices for the four gathers
+  * (see expr::is_gather()).  The result is a p_float32.
+  */
+expr bilinear(computation &in, const expr &y, const expr &x, const expr &height, const expr &width);
+
 
 template <typename T>
 only_integral<T> operator+(const tiramisu::expr &e, T val)
@@ -2046,6 +2372,43 @@ expr cblas_gemm(const buffer &A, const buffer &B, buffer &C,
                 expr offsetA = 0, expr offsetB = 0, expr offsetC = 0,
                 expr transposeA = false, expr transposeB = false);
 
+/**
+ * Does \p batch GEMM operations on row-major matrices using cuBLAS, in a
+ * single library call: for b in [0, batch),
+ * C_b = alpha x A_b x B_b + beta x C_b, where the matrices A_b, B_b and C_b
+ * start stride{A,B,C} x b elements after offset{A,B,C}.  The default stride
+ * 0 means that the matrices of a batch are tightly packed one after the
+ * other.  The other parameters are those of cublas_gemm().
+ *
+ * Many small GEMMs (e.g. the per-gate products of an LSTM, or independent
+ * products of the same shape) are much faster in one batched call than in
+ * a loop of cublas_gemm() calls.  Each thread uses its own cuBLAS handle, so
+ * batched and non-batched calls can be issued from parallel loops.
+ *
+ * \code
+ * computation gemms({var("d", 0, 1)},
+ *                   cublas_gemm_strided_batched(A, B, C, M, N, K, NB_GATES));
+ * \endcode
+ */
+expr cublas_gemm_strided_batched(const buffer &A, const buffer &B, buffer &C,
+                                 expr M, expr N, expr K, expr batch,
+                                 expr alpha = 1, expr beta = 0,
+                                 expr ldA = 0, expr ldB = 0, expr ldC = 0,
+                                 expr offsetA = 0, expr offsetB = 0, expr offsetC = 0,
+                                 expr strideA = 0, expr strideB = 0, expr strideC = 0,
+                                 expr transposeA = false, expr transposeB = false);
+
+/**
+ * The MKL counterpart of cublas_gemm_strided_batched().
+ */
+expr cblas_gemm_strided_batched(const buffer &A, const buffer &B, buffer &C,
+                                expr M, expr N, expr K, expr batch,
+                                expr alpha = 1, expr beta = 0,
+                                expr ldA = 0, expr ldB = 0, expr ldC = 0,
+                                expr offsetA = 0, expr offsetB = 0, expr offsetC = 0,
+                                expr strideA = 0, expr strideB = 0, expr strideC = 0,
+                                expr transposeA = false, expr transposeB = false);
+
 // Sparse matrix-vector multiplication
 expr spmv(expr transposeA,
           expr alpha,
@@ -2092,6 +2455,18 @@ expr flexnlp_lstm_cell_partitioned(const buffer &x_in, const buffer &W_in, const
 */
 expr flexnlp_lstm_cell_partitioned_multi_accelerator(const buffer &x_in, const buffer &W_in, const buffer &output, const buffer &h_out, expr layer_number);
 
+/**
+* Run a FlexNLP LSTM operator whose batch is split between all the accelerators
+* by the asynchronous runtime (see function::enable_flexnlp_async_runtime())
+*/
+expr flexnlp_lstm_cell_balanced(const buffer &x_in, const buffer &W_in, const buffer &output, const buffer &h_out, expr layer_number);
+
+/**
+* Wait for the commands queued on a FlexNLP device by the asynchronous runtime
+* (on all the devices if \p device_id is negative)
+*/
+expr flexnlp_synchronize(expr device_id = -1);
+
 /**
 * Initializes the FlexNLP context (pass how many FlexNLP devices to use)
 */
@@ -3,6 +3,10 @@
 
 #include "Halide.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 extern "C" {
 
 int8_t *tiramisu_address_of_int8(halide_buffer_t *buffer, unsigned long index);
@@ -29,6 +33,432 @@ double *tiramisu_address_of_float64(halide_buffer_t *buffer, unsigned long index
 void *tiramisu_address_of_wait(halide_buffer_t *buffer, unsigned long index);
 #endif
 
+/**
+  * Allocate \p size bytes with the given NUMA placement (a tiramisu::numa_placement_t),
+  * \p node is the node used by numa_bind. The memory is not touched.
+  * Used by the code generated for the buffers that have a NUMA placement.
+  */
+void *tiramisu_numa_malloc(uint64_t size, int32_t placement, int32_t node);
+
+/**
+  * Free memory allocated by tiramisu_numa_malloc().
+  */
+void tiramisu_numa_free(void *user_context, void *ptr);
+
+/**
+  * Map \p size bytes of the file \p path (or of the open file descriptor \p fd)
+  * in memory, with the access pattern \p advice (a tiramisu::mmap_advice_t)
+  * and, if \p huge_pages, transparent huge pages.  If \p writable, the file is
+  * created or extended to \p size bytes and the mapping is shared with it.
+  * Return NULL if the file cannot be mapped.
+  * Used by the code generated for the buffers mapped from files.
+  */
+void *tiramisu_map_file(const char *path, uint64_t size, int32_t writable, int32_t advice, int32_t huge_pages);
+void *tiramisu_map_fd(int32_t fd, uint64_t size, int32_t writable, int32_t advice, int32_t huge_pages);
+
+/**
+  * Unmap memory mapped by tiramisu_map_file() or tiramisu_map_fd().
+  */
+void tiramisu_unmap_file(void *user_context, void *ptr);
+
+/**
+  * A parallel runtime for the generated code, that splits each parallel loop
+  * into one contiguous chunk of iterations per thread, and always gives the same chunk
+  * to the same thread, each thread being pinned to a core. Successive parallel loops
+  * over the same dimension are then executed by the same cores, so the pages placed
+  * by the first touch (see tiramisu::numa_first_touch) stay local to the threads
+  * that use them.
+  *
+  * To use it, call halide_set_custom_do_par_for(tiramisu_numa_do_par_for) before
+  * calling the generated functions. The number of threads is given by the
+  * environment variable HL_NUM_THREADS (by default, the number of cores),
+  * and the thread i is pinned to the core i. Nested parallel loops are executed
+  * sequentially by the thread that executes the outer parallel loop.
+  */
+int tiramisu_numa_do_par_for(void *user_context, halide_task_t task, int min, int size, uint8_t *closure);
+
+/**
+  * A work-stealing parallel runtime for the generated code, for the parallel loops
+  * whose iterations have unbalanced costs (triangular domains, skewed wavefronts)
+  * and for nested parallel loops.
+  *
+  * The iterations of a parallel loop are claimed by chunks, by the thread that
+  * started the loop and by the idle threads. A nested parallel loop is queued by
+  * the thread that starts it, and the idle threads steal it, instead of being
+  * executed sequentially.
+  *
+  * To use it, call halide_set_custom_do_par_for(tiramisu_work_stealing_do_par_for)
+  * before calling the generated functions. The number of threads is given by the
+  * environment variable HL_NUM_THREADS (by default, the number of cores).
+  */
+int tiramisu_work_stealing_do_par_for(void *user_context, halide_task_t task, int min, int size, uint8_t *closure);
+
+/**
+  * A parallel runtime for the generated functions that are called concurrently
+  * by many threads (e.g. the request threads of a server), which contend for
+  * the single pool of the default runtime when they all run parallel loops.
+  *
+  * With N concurrent callers (see tiramisu_set_concurrent_callers()), the
+  * threads are split into N sub-pools of HL_NUM_THREADS / N threads pinned to
+  * consecutive cores, and each calling thread is assigned to a sub-pool the
+  * first time it runs a parallel loop; the parallel loops of a caller are then
+  * executed as with tiramisu_numa_do_par_for(), by its sub-pool only.
+  * With 0 callers (the default), the parallel loops are executed sequentially
+  * by their caller: each call is single-threaded, and the parallelism comes
+  * from the concurrent calls (throughput mode).
+  *
+  * To use it, call halide_set_custom_do_par_for(tiramisu_concurrent_do_par_for)
+  * before calling the generated functions.
+  */
+int tiramisu_concurrent_do_par_for(void *user_context, halide_task_t task, int min, int size, uint8_t *closure);
+
+/**
+  * Set the number of concurrent callers of tiramisu_concurrent_do_par_for(),
+  * before its first parallel loop.  Setting the environment variable
+  * TIRAMISU_CONCURRENT_CALLERS has the same effect.
+  */
+void tiramisu_set_concurrent_callers(int32_t nb_callers);
+
+/**
+  * The counters of the thread pools of tiramisu_numa_do_par_for() and
+  * tiramisu_concurrent_do_par_for().
+  */
+typedef struct tiramisu_thread_pool_counters
+{
+    /** The number of parallel loops executed by a thread pool. */
+    uint64_t parallel_loops;
+
+    /** The number of parallel loops executed sequentially by their caller (nested loops, throughput mode). */
+    uint64_t sequential_loops;
+
+    /** The number of parallel loops that waited for their pool, busy with the loop of another caller. */
+    uint64_t contended_loops;
+
+    /** The time spent waiting for a busy pool, in nanoseconds. */
+    uint64_t wait_ns;
+} tiramisu_thread_pool_counters;
+
+/**
+  * Store in \p counters the counters of the thread pools since the start of
+  * the process or the last call to tiramisu_thread_pool_counters_reset().
+  */
+void tiramisu_get_thread_pool_counters(tiramisu_thread_pool_counters *counters);
+
+void tiramisu_thread_pool_counters_reset();
+
+/**
+  * Coalesces the concurrent calls to a generated function into calls to its
+  * batched entry point (see function::enable_batching()).
+  */
+typedef struct tiramisu_batcher tiramisu_batcher;
+
+/**
+  * Create a batcher for the batched entry point \p batched_argv (the function
+  * NAME_batched_argv generated by Halide) described by \p metadata
+  * (NAME_batched_metadata()).  A batch is run when \p max_batch_size requests
+  * are waiting, or \p deadline_us microseconds after its first request.
+  */
+tiramisu_batcher *tiramisu_batcher_create(int (*batched_argv)(void **), const halide_filter_metadata_t *metadata,
+                                          int32_t max_batch_size, int64_t deadline_us);
+
+/**
+  * Run the function on \p buffers (the arguments of NAME, without the batch
+  * dimension) as part of a batch, and return its result once the outputs are
+  * written.  Called concurrently by the threads that serve the requests: the
+  * inputs of the requests that have the same shapes are gathered into the
+  * batch, and the outputs of the batch are scattered back to them.
+  */
+int32_t tiramisu_batcher_run(tiramisu_batcher *batcher, halide_buffer_t **buffers);
+
+/**
+  * Destroy a batcher that has no request in progress.
+  */
+void tiramisu_batcher_destroy(tiramisu_batcher *batcher);
+
+/**
+  * Parallel runtimes that execute the parallel loops with an OpenMP parallel
+  * for, or a oneTBB parallel_for, so that the generated code shares the
+  * thread pool of the application (see function::set_parallel_backend()).
+  * They are only available when Tiramisu is built with USE_OPENMP or
+  * USE_TBB; otherwise they use the default Halide runtime.
+  */
+int tiramisu_openmp_do_par_for(void *user_context, halide_task_t task, int min, int size, uint8_t *closure);
+
+int tiramisu_tbb_do_par_for(void *user_context, halide_task_t task, int min, int size, uint8_t *closure);
+
+/**
+  * Install the do_par_for of the parallel backend \p backend (a
+  * tiramisu::parallel_backend_t) with the chunk size \p chunk_size, and
+  * return the do_par_for it replaces, to be given to
+  * tiramisu_parallel_backend_end().  Used by the code generated for
+  * function::set_parallel_backend().
+  */
+void *tiramisu_parallel_backend_begin(int32_t backend, int32_t chunk_size);
+
+int32_t tiramisu_parallel_backend_end(void *previous);
+
+/**
+  * Set the number of iterations claimed at once by a thread in
+  * tiramisu_work_stealing_do_par_for(). With 0 (the default), the chunks are
+  * guided: a thread claims a fraction of the remaining iterations, so the
+  * chunks are large at the beginning of a loop and small at its end.
+  */
+void tiramisu_set_parallel_grain_size(int32_t grain_size);
+
+/**
+  * Wait until the progress counter \p counter of a doacross loop reaches \p value.
+  * Used by the code generated for computation::parallelize_doacross().
+  */
+int32_t tiramisu_doacross_wait(void *counter, int32_t value);
+
+/**
+  * Set the progress counter \p counter of a doacross loop to \p value, making the
+  * writes done before visible to the threads that wait on this counter.
+  * Used by the code generated for computation::parallelize_doacross().
+  */
+int32_t tiramisu_doacross_post(void *counter, int32_t value);
+
+/**
+  * Raise the number of threads of the Halide runtime to at least
+  * \p nb_threads, so that each stage of a pipeline runs in its own thread.
+  * Used by the code generated for computation::pipeline().
+  */
+int32_t tiramisu_pipeline_reserve_threads(int32_t nb_threads);
+
+/**
+  * Inspector of a CSR (or CSC) matrix of \p nb_rows rows whose row pointers
+  * are the int32 buffer \p pos (nb_rows + 1 elements).  Split the rows into
+  * \p nb_partitions contiguous partitions that have about the same number of
+  * entries, and store in the int32 buffer \p partition (nb_partitions + 1
+  * elements) the first row of each partition followed by nb_rows.  The rows
+  * [partition[q], partition[q + 1]) can then be given to the thread q, which
+  * balances the threads much better than an even split of the rows when
+  * their lengths vary (see computation::mark_as_inspector()).
+  */
+int32_t tiramisu_inspect_row_partition(halide_buffer_t *pos, int32_t nb_rows, int32_t nb_partitions,
+                                       halide_buffer_t *partition);
+
+/**
+  * Inspector of a CSR (or CSC) matrix of \p nb_rows rows whose row pointers
+  * are the int32 buffer \p pos.  Store in the int32 buffer \p permutation
+  * the rows sorted by decreasing number of entries (rows of the same length
+  * keep their order), so that a dynamically scheduled loop over the
+  * permutation starts with the longest rows.
+  */
+int32_t tiramisu_inspect_rows_by_length(halide_buffer_t *pos, int32_t nb_rows, halide_buffer_t *permutation);
+
+/**
+  * Choose the format of a CSR matrix of \p nb_rows rows whose row pointers
+  * are the int32 buffer \p pos, for an SpMV vectorized with \p vector_lanes
+  * lanes.  The number of vector iterations of a CSR SpMV vectorized along
+  * each row (the rows shorter than a vector waste most of its lanes) is
+  * compared with the number of iterations of a SELL-C-sigma SpMV with
+  * C = \p vector_lanes, for sigma in {1, C, 2C, 4C, ..., nb_rows} (a larger
+  * sigma pads less but reads x less locally, so the smallest sigma within
+  * 5% of the best padding is kept).  Return tiramisu::sparse_csr or
+  * tiramisu::sparse_sell, and store C and sigma in the int32 buffer
+  * \p parameters (2 elements).
+  */
+int32_t tiramisu_choose_sparse_format(halide_buffer_t *pos, int32_t nb_rows, int32_t vector_lanes,
+                                      halide_buffer_t *parameters);
+
+/**
+  * Return the number of entries, padding included, of the SELL-C-sigma
+  * matrix with \p chunk_size = C and \p sigma converted from the CSR matrix
+  * of \p nb_rows rows whose row pointers are the int32 buffer \p pos.
+  */
+int32_t tiramisu_sell_size(halide_buffer_t *pos, int32_t nb_rows, int32_t chunk_size, int32_t sigma);
+
+/**
+  * Convert the CSR matrix of \p nb_rows rows (the int32 buffers \p pos and
+  * \p crd, and the buffer \p values) to SELL-C-sigma with C = \p chunk_size
+  * (see buffer::set_sparse_format()).  The rows are sorted by decreasing
+  * length inside windows of \p sigma rows.  The int32 buffers \p slice_ptr
+  * (ceil(nb_rows / C) + 1 elements) and \p sell_crd, and \p sell_values (of
+  * the type of \p values), have the size returned by tiramisu_sell_size();
+  * the padding has the column 0 and the value 0.  The int32 buffer
+  * \p row_order (nb_rows elements) receives the position of each row in the
+  * sorted order (slice * C + row of the slice), to reorder the result.
+  */
+int32_t tiramisu_csr_to_sell(halide_buffer_t *pos, halide_buffer_t *crd, halide_buffer_t *values, int32_t nb_rows,
+                             int32_t chunk_size, int32_t sigma, halide_buffer_t *slice_ptr,
+                             halide_buffer_t *sell_crd, halide_buffer_t *sell_values, halide_buffer_t *row_order);
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+  * Non-temporal stores of a vector at \p address, used by the code generated
+  * for the buffers that have streaming stores (see buffer::set_streaming_stores()).
+  * An address that is not aligned on the size of the vector is written with
+  * a regular store. The integer functions are used for both signed and
+  * unsigned elements.
+  */
+int32_t tiramisu_stream_store_f32x4(void *address, __m128 value);
+
+int32_t tiramisu_stream_store_f64x2(void *address, __m128d value);
+
+int32_t tiramisu_stream_store_i8x16(void *address, __m128i value);
+
+int32_t tiramisu_stream_store_i16x8(void *address, __m128i value);
+
+int32_t tiramisu_stream_store_i32x4(void *address, __m128i value);
+
+int32_t tiramisu_stream_store_i64x2(void *address, __m128i value);
+
+// The 256-bit functions require AVX.
+int32_t tiramisu_stream_store_f32x8(void *address, __m256 value);
+
+int32_t tiramisu_stream_store_f64x4(void *address, __m256d value);
+
+int32_t tiramisu_stream_store_i8x32(void *address, __m256i value);
+
+int32_t tiramisu_stream_store_i16x16(void *address, __m256i value);
+
+int32_t tiramisu_stream_store_i32x8(void *address, __m256i value);
+
+int32_t tiramisu_stream_store_i64x4(void *address, __m256i value);
+
+/**
+  * Order the non-temporal stores issued by the calling thread before its
+  * following stores.
+  */
+int32_t tiramisu_stream_fence();
+#endif
+
+/**
+  * The counters of a loop nest profiled by the code generated for
+  * function::enable_profiling().
+  */
+typedef struct tiramisu_profile_counters
+{
+    /** The number of executions of the loop nest. */
+    uint64_t calls;
+
+    /** The time spent in the loop nest, in TSC cycles on x86 and in nanoseconds elsewhere. */
+    uint64_t cycles;
+
+    /**
+      * The last level cache misses and the instructions of the thread that
+      * executed the loop nest, or -1 if the hardware counters are not enabled
+      * (see tiramisu_profiler_enable_hardware_counters()) or not available.
+      */
+    int64_t cache_misses;
+    int64_t instructions;
+} tiramisu_profile_counters;
+
+/**
+  * Start profiling a loop nest, return the value of the cycle counter.
+  * Used by the code generated for function::enable_profiling().
+  */
+uint64_t tiramisu_profiler_start();
+
+/**
+  * Add the cycles elapsed since \p start, returned by the matching call to
+  * tiramisu_profiler_start(), to the counters of the loop nest \p region.
+  * Used by the code generated for function::enable_profiling().
+  */
+int32_t tiramisu_profiler_stop(const char *region, uint64_t start);
+
+/**
+  * Also count the cache misses and the instructions of the profiled loop
+  * nests (Linux perf events).  Setting the environment variable
+  * TIRAMISU_PROFILE_HW_COUNTERS has the same effect.  The counters are those
+  * of the thread that calls the generated function, so they do not include
+  * the work done by the other threads in parallel loops (set HL_NUM_THREADS=1
+  * to count everything).
+  */
+void tiramisu_profiler_enable_hardware_counters(int32_t enable);
+
+/**
+  * The number of loop nests profiled so far, in the order of their first execution.
+  */
+int32_t tiramisu_profiler_nb_regions();
+
+/**
+  * Store in \p name the name of the profiled loop nest \p region (the function
+  * and the computations of the loop nest, e.g. "resnet:conv,relu") and in
+  * \p counters its counters.  Return -1 if \p region does not exist.
+  */
+int32_t tiramisu_profiler_get_region(int32_t region, const char **name, tiramisu_profile_counters *counters);
+
+/**
+  * Reset the counters of all the profiled loop nests.
+  */
+void tiramisu_profiler_reset();
+
+/**
+  * Print the counters of the profiled loop nests on the standard error,
+  * from the most to the least expensive.
+  */
+void tiramisu_profiler_print();
+
+/**
+  * Transfer the elements of a chunk of a buffer streamed with
+  * computation::stream_input() or computation::stream_output(): \p chunk
+  * points to the elements (row-major, the last dimension is contiguous) whose
+  * indices are \p lower[d] to \p lower[d] + \p extent[d] - 1 along each of the
+  * \p nb_dims dimensions.  A reader fills the chunk, a writer consumes it.
+  * Return 0 on success.  Called on the I/O thread of the stream.
+  */
+typedef int32_t (*tiramisu_io_stream_callback)(void *user_data, void *chunk, const int64_t *lower,
+                                              const int64_t *extent, int32_t nb_dims);
+
+/**
+  * Bind the I/O stream \p stream to \p reader (or \p writer), called with
+  * \p user_data for each part of a chunk that is not in memory yet (or that
+  * was computed).  Must be called before the generated function.
+  */
+void tiramisu_io_stream_set_reader(int32_t stream, tiramisu_io_stream_callback reader, void *user_data);
+void tiramisu_io_stream_set_writer(int32_t stream, tiramisu_io_stream_callback writer, void *user_data);
+
+/**
+  * Bind the I/O stream \p stream to the file \p path, mapped in memory, that
+  * stores the whole buffer (row-major, \p nb_dims dimensions of \p extent[d]
+  * elements of \p element_size bytes).  If \p writable, the file is created or
+  * resized as needed.  Return -1 if the file cannot be mapped.
+  */
+int32_t tiramisu_io_stream_map_file(int32_t stream, const char *path, int32_t nb_dims, const int64_t *extent,
+                                    int32_t element_size, int32_t writable);
+
+/**
+  * Wait for the pending transfers of \p stream, then unbind it (and unmap its
+  * file).
+  */
+void tiramisu_io_stream_close(int32_t stream);
+
+/**
+  * Queue the transfer of the elements \p lower0..3 to \p upper0..3 (inclusive,
+  * \p nb_dims dimensions) of the buffer streamed through \p stream from (or
+  * to) \p chunk, a ring buffer of shape \p shape0..3 where each element is
+  * stored at its indices modulo the shape.  The elements of the previous read
+  * that are still in the ring are not read again.  Used by the code generated
+  * for computation::stream_input() and computation::stream_output().
+  */
+int32_t tiramisu_io_stream_read(int32_t stream, void *chunk, int32_t element_size, int32_t nb_dims,
+                                int64_t lower0, int64_t lower1, int64_t lower2, int64_t lower3,
+                                int64_t upper0, int64_t upper1, int64_t upper2, int64_t upper3,
+                                int64_t shape0, int64_t shape1, int64_t shape2, int64_t shape3);
+int32_t tiramisu_io_stream_write(int32_t stream, void *chunk, int32_t element_size, int32_t nb_dims,
+                                 int64_t lower0, int64_t lower1, int64_t lower2, int64_t lower3,
+                                 int64_t upper0, int64_t upper1, int64_t upper2, int64_t upper3,
+                                 int64_t shape0, int64_t shape1, int64_t shape2, int64_t shape3);
+
+/**
+  * Wait until the chunk \p lower0..3 to \p upper0..3 of \p stream can be
+  * used: until it is read, or until the ring positions it uses are written.
+  * Only the most recent transfer is left in flight, if it does not overlap
+  * the chunk in the ring.
+  */
+int32_t tiramisu_io_stream_wait(int32_t stream, void *chunk, int32_t element_size, int32_t nb_dims,
+                                int64_t lower0, int64_t lower1, int64_t lower2, int64_t lower3,
+                                int64_t upper0, int64_t upper1, int64_t upper2, int64_t upper3,
+                                int64_t shape0, int64_t shape1, int64_t shape2, int64_t shape3);
+
+/**
+  * Wait until all the transfers of \p stream are done (and the mapped file
+  * is synchronized), and forget the chunk in memory.
+  */
+int32_t tiramisu_io_stream_flush(int32_t stream);
+
 }
 
 #endif //TIRAMISU_EXTERNS_H
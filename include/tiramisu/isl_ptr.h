@@ -0,0 +1,52 @@
+#ifndef _H_TIRAMISU_ISL_PTR_
+#define _H_TIRAMISU_ISL_PTR_
+
+#include <isl/id.h>
+#include <isl/val.h>
+#include <isl/space.h>
+#include <isl/set.h>
+#include <isl/map.h>
+#include <isl/union_set.h>
+#include <isl/union_map.h>
+#include <isl/ast.h>
+#include <isl/ast_build.h>
+
+#include <memory>
+
+namespace tiramisu
+{
+
+/**
+  * Owning handles for isl objects: the object is freed when the handle goes
+  * out of scope.  get() lends the object to an isl function that takes it
+  * with __isl_keep, release() gives it to one that takes it with __isl_take.
+  *
+  * \code
+  * isl_set_ptr domain(comp->get_trimmed_time_processor_domain());
+  * isl_space *space = isl_set_get_space(domain.get());
+  * \endcode
+  */
+#define TIRAMISU_ISL_PTR(type)                                              \
+struct type##_deleter                                                       \
+{                                                                           \
+    void operator()(type *p) const {type##_free(p);}                        \
+};                                                                          \
+typedef std::unique_ptr<type, type##_deleter> type##_ptr;
+
+TIRAMISU_ISL_PTR(isl_id)
+TIRAMISU_ISL_PTR(isl_val)
+TIRAMISU_ISL_PTR(isl_space)
+TIRAMISU_ISL_PTR(isl_set)
+TIRAMISU_ISL_PTR(isl_map)
+TIRAMISU_ISL_PTR(isl_union_set)
+TIRAMISU_ISL_PTR(isl_union_map)
+TIRAMISU_ISL_PTR(isl_ast_expr)
+TIRAMISU_ISL_PTR(isl_ast_node)
+TIRAMISU_ISL_PTR(isl_ast_node_list)
+TIRAMISU_ISL_PTR(isl_ast_build)
+
+#undef TIRAMISU_ISL_PTR
+
+}
+
+#endif
@@ -4,7 +4,47 @@
 #ifdef WITH_MPI
 #include <mpi.h>
 
+/**
+  * The tag of a point-to-point communication holds the message tag in its low
+  * TIRAMISU_MPI_CHANNEL_SHIFT bits and the communication channel above them.
+  * The channel selects the communicator of the transfer when MPI is initialized
+  * with tiramisu_MPI_init_thread_multiple().
+  */
+#define TIRAMISU_MPI_CHANNEL_SHIFT 15
+
 int tiramisu_MPI_init();
+/**
+  * Initialize MPI with MPI_THREAD_MULTIPLE so that communications can be issued
+  * concurrently by the threads of parallel loops. \p num_channels communicators
+  * are created; a transfer on channel c uses the communicator c % num_channels
+  * (see communicator::set_channel()).
+  */
+int tiramisu_MPI_init_thread_multiple(int num_channels);
+/**
+  * Arrange the ranks in a Cartesian grid of \p ndims dimensions of extents \p dims
+  * (whose product must be the number of ranks) and use it for all the communications.
+  * The ranks are renumbered so that each node gets a block of neighbouring ranks of the
+  * grid (numbered in row-major order, like the iterations of the distributed loops), or,
+  * when the grid cannot be split evenly between the nodes, placed by the MPI library.
+  * Returns the new rank of the calling process. Must be called by all the ranks, after
+  * tiramisu_MPI_init() or tiramisu_MPI_init_thread_multiple() and before
+  * tiramisu_MPI_init_rma().
+  */
+int tiramisu_MPI_init_topology(int ndims, const int *dims);
+/**
+  * Allocate the windows of the one-sided (RMA) transfers (see the RMA attribute of
+  * xfer_prop), with \p bytes_per_source bytes for the messages put by each rank.
+  * Must be called by all the ranks, after tiramisu_MPI_init() or
+  * tiramisu_MPI_init_thread_multiple().
+  */
+void tiramisu_MPI_init_rma(long bytes_per_source);
+/**
+  * Finalize MPI. When the environment variable TIRAMISU_MPI_TRACE names a file, the
+  * communications of all the ranks (start and end, bytes, peer, tag and channel of each
+  * send, receive, one-sided transfer, collective and wait) are recorded from the
+  * initialization of MPI, and written to this file by the rank 0 as a Chrome trace
+  * (one process per rank, one thread per communication channel).
+  */
 void tiramisu_MPI_cleanup();
 void tiramisu_MPI_global_barrier();
 
@@ -12,6 +52,14 @@ extern "C" {
 
 inline void check_MPI_error(int ret_val);
 
+/**
+  * The communicator of all the ranks: MPI_COMM_WORLD, or the Cartesian communicator
+  * created by tiramisu_MPI_init_topology().
+  */
+MPI_Comm tiramisu_MPI_world();
+
+MPI_Comm tiramisu_MPI_comm(int tag);
+
 int tiramisu_MPI_Comm_rank(int offset);
 
 void tiramisu_MPI_Wait(void *request);
@@ -88,6 +136,244 @@ void tiramisu_MPI_Irecv_uint64(int count, int source, int tag, unsigned long *st
 void tiramisu_MPI_Irecv_f32(int count, int source, int tag, float *store_in, long *reqs);
 void tiramisu_MPI_Irecv_f64(int count, int source, int tag, double *store_in, long *reqs);
 
+/**
+  * Point-to-point transfers of GPU global buffers: \p data and \p store_in are device
+  * pointers. They are given to MPI as they are when tiramisu_MPI_cuda_aware() (CUDA-aware
+  * MPI, with GPUDirect RDMA when the network supports it), otherwise each transfer is
+  * staged through a host copy of the message (a nonblocking receive copies the message
+  * to the GPU in tiramisu_MPI_Wait()). The staging needs the CUDA runtime of tiramisu
+  * (tiramisu_cuda_wrappers.cpp).
+  */
+int tiramisu_MPI_cuda_aware();
+
+void tiramisu_MPI_Send_device(int count, int dest, int tag, void *data, MPI_Datatype type);
+void tiramisu_MPI_Send_device_int8(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Send_device_int16(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Send_device_int32(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Send_device_int64(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Send_device_uint8(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Send_device_uint16(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Send_device_uint32(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Send_device_uint64(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Send_device_f32(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Send_device_f64(int count, int dest, int tag, void *data);
+
+void tiramisu_MPI_Ssend_device(int count, int dest, int tag, void *data, MPI_Datatype type);
+void tiramisu_MPI_Ssend_device_int8(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Ssend_device_int16(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Ssend_device_int32(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Ssend_device_int64(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Ssend_device_uint8(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Ssend_device_uint16(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Ssend_device_uint32(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Ssend_device_uint64(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Ssend_device_f32(int count, int dest, int tag, void *data);
+void tiramisu_MPI_Ssend_device_f64(int count, int dest, int tag, void *data);
+
+void tiramisu_MPI_Isend_device(int count, int dest, int tag, void *data, MPI_Datatype type, long *reqs);
+void tiramisu_MPI_Isend_device_int8(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Isend_device_int16(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Isend_device_int32(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Isend_device_int64(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Isend_device_uint8(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Isend_device_uint16(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Isend_device_uint32(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Isend_device_uint64(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Isend_device_f32(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Isend_device_f64(int count, int dest, int tag, void *data, long *reqs);
+
+void tiramisu_MPI_Issend_device(int count, int dest, int tag, void *data, MPI_Datatype type, long *reqs);
+void tiramisu_MPI_Issend_device_int8(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Issend_device_int16(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Issend_device_int32(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Issend_device_int64(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Issend_device_uint8(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Issend_device_uint16(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Issend_device_uint32(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Issend_device_uint64(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Issend_device_f32(int count, int dest, int tag, void *data, long *reqs);
+void tiramisu_MPI_Issend_device_f64(int count, int dest, int tag, void *data, long *reqs);
+
+void tiramisu_MPI_Recv_device(int count, int source, int tag, void *store_in, MPI_Datatype type);
+void tiramisu_MPI_Recv_device_int8(int count, int source, int tag, void *store_in);
+void tiramisu_MPI_Recv_device_int16(int count, int source, int tag, void *store_in);
+void tiramisu_MPI_Recv_device_int32(int count, int source, int tag, void *store_in);
+void tiramisu_MPI_Recv_device_int64(int count, int source, int tag, void *store_in);
+void tiramisu_MPI_Recv_device_uint8(int count, int source, int tag, void *store_in);
+void tiramisu_MPI_Recv_device_uint16(int count, int source, int tag, void *store_in);
+void tiramisu_MPI_Recv_device_uint32(int count, int source, int tag, void *store_in);
+void tiramisu_MPI_Recv_device_uint64(int count, int source, int tag, void *store_in);
+void tiramisu_MPI_Recv_device_f32(int count, int source, int tag, void *store_in);
+void tiramisu_MPI_Recv_device_f64(int count, int source, int tag, void *store_in);
+
+void tiramisu_MPI_Irecv_device(int count, int source, int tag, void *store_in, MPI_Datatype type, long *reqs);
+void tiramisu_MPI_Irecv_device_int8(int count, int source, int tag, void *store_in, long *reqs);
+void tiramisu_MPI_Irecv_device_int16(int count, int source, int tag, void *store_in, long *reqs);
+void tiramisu_MPI_Irecv_device_int32(int count, int source, int tag, void *store_in, long *reqs);
+void tiramisu_MPI_Irecv_device_int64(int count, int source, int tag, void *store_in, long *reqs);
+void tiramisu_MPI_Irecv_device_uint8(int count, int source, int tag, void *store_in, long *reqs);
+void tiramisu_MPI_Irecv_device_uint16(int count, int source, int tag, void *store_in, long *reqs);
+void tiramisu_MPI_Irecv_device_uint32(int count, int source, int tag, void *store_in, long *reqs);
+void tiramisu_MPI_Irecv_device_uint64(int count, int source, int tag, void *store_in, long *reqs);
+void tiramisu_MPI_Irecv_device_f32(int count, int source, int tag, void *store_in, long *reqs);
+void tiramisu_MPI_Irecv_device_f64(int count, int source, int tag, void *store_in, long *reqs);
+
+/**
+  * Strided point-to-point communications. The message of count elements is made of
+  * count / block_length blocks of block_length contiguous elements, separated by stride
+  * elements in the buffer, and is described with an MPI vector datatype so that strided
+  * halos (e.g. column boundaries) do not need to be packed into a contiguous buffer.
+  */
+MPI_Datatype tiramisu_MPI_vector_type(int count, int block_length, int stride, MPI_Datatype type);
+
+void tiramisu_MPI_Send_vector_int8(int count, int dest, int tag, char *data, int block_length, int stride);
+void tiramisu_MPI_Send_vector_int16(int count, int dest, int tag, short *data, int block_length, int stride);
+void tiramisu_MPI_Send_vector_int32(int count, int dest, int tag, int *data, int block_length, int stride);
+void tiramisu_MPI_Send_vector_int64(int count, int dest, int tag, long *data, int block_length, int stride);
+void tiramisu_MPI_Send_vector_uint8(int count, int dest, int tag, unsigned char *data, int block_length, int stride);
+void tiramisu_MPI_Send_vector_uint16(int count, int dest, int tag, unsigned short *data, int block_length, int stride);
+void tiramisu_MPI_Send_vector_uint32(int count, int dest, int tag, unsigned int *data, int block_length, int stride);
+void tiramisu_MPI_Send_vector_uint64(int count, int dest, int tag, unsigned long *data, int block_length, int stride);
+void tiramisu_MPI_Send_vector_f32(int count, int dest, int tag, float *data, int block_length, int stride);
+void tiramisu_MPI_Send_vector_f64(int count, int dest, int tag, double *data, int block_length, int stride);
+
+void tiramisu_MPI_Ssend_vector_int8(int count, int dest, int tag, char *data, int block_length, int stride);
+void tiramisu_MPI_Ssend_vector_int16(int count, int dest, int tag, short *data, int block_length, int stride);
+void tiramisu_MPI_Ssend_vector_int32(int count, int dest, int tag, int *data, int block_length, int stride);
+void tiramisu_MPI_Ssend_vector_int64(int count, int dest, int tag, long *data, int block_length, int stride);
+void tiramisu_MPI_Ssend_vector_uint8(int count, int dest, int tag, unsigned char *data, int block_length, int stride);
+void tiramisu_MPI_Ssend_vector_uint16(int count, int dest, int tag, unsigned short *data, int block_length, int stride);
+void tiramisu_MPI_Ssend_vector_uint32(int count, int dest, int tag, unsigned int *data, int block_length, int stride);
+void tiramisu_MPI_Ssend_vector_uint64(int count, int dest, int tag, unsigned long *data, int block_length, int stride);
+void tiramisu_MPI_Ssend_vector_f32(int count, int dest, int tag, float *data, int block_length, int stride);
+void tiramisu_MPI_Ssend_vector_f64(int count, int dest, int tag, double *data, int block_length, int stride);
+
+void tiramisu_MPI_Isend_vector_int8(int count, int dest, int tag, char *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Isend_vector_int16(int count, int dest, int tag, short *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Isend_vector_int32(int count, int dest, int tag, int *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Isend_vector_int64(int count, int dest, int tag, long *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Isend_vector_uint8(int count, int dest, int tag, unsigned char *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Isend_vector_uint16(int count, int dest, int tag, unsigned short *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Isend_vector_uint32(int count, int dest, int tag, unsigned int *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Isend_vector_uint64(int count, int dest, int tag, unsigned long *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Isend_vector_f32(int count, int dest, int tag, float *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Isend_vector_f64(int count, int dest, int tag, double *data, long *reqs, int block_length, int stride);
+
+void tiramisu_MPI_Issend_vector_int8(int count, int dest, int tag, char *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Issend_vector_int16(int count, int dest, int tag, short *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Issend_vector_int32(int count, int dest, int tag, int *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Issend_vector_int64(int count, int dest, int tag, long *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Issend_vector_uint8(int count, int dest, int tag, unsigned char *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Issend_vector_uint16(int count, int dest, int tag, unsigned short *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Issend_vector_uint32(int count, int dest, int tag, unsigned int *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Issend_vector_uint64(int count, int dest, int tag, unsigned long *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Issend_vector_f32(int count, int dest, int tag, float *data, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Issend_vector_f64(int count, int dest, int tag, double *data, long *reqs, int block_length, int stride);
+
+void tiramisu_MPI_Recv_vector_int8(int count, int source, int tag, char *store_in, int block_length, int stride);
+void tiramisu_MPI_Recv_vector_int16(int count, int source, int tag, short *store_in, int block_length, int stride);
+void tiramisu_MPI_Recv_vector_int32(int count, int source, int tag, int *store_in, int block_length, int stride);
+void tiramisu_MPI_Recv_vector_int64(int count, int source, int tag, long *store_in, int block_length, int stride);
+void tiramisu_MPI_Recv_vector_uint8(int count, int source, int tag, unsigned char *store_in, int block_length, int stride);
+void tiramisu_MPI_Recv_vector_uint16(int count, int source, int tag, unsigned short *store_in, int block_length, int stride);
+void tiramisu_MPI_Recv_vector_uint32(int count, int source, int tag, unsigned int *store_in, int block_length, int stride);
+void tiramisu_MPI_Recv_vector_uint64(int count, int source, int tag, unsigned long *store_in, int block_length, int stride);
+void tiramisu_MPI_Recv_vector_f32(int count, int source, int tag, float *store_in, int block_length, int stride);
+void tiramisu_MPI_Recv_vector_f64(int count, int source, int tag, double *store_in, int block_length, int stride);
+
+void tiramisu_MPI_Irecv_vector_int8(int count, int source, int tag, char *store_in, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Irecv_vector_int16(int count, int source, int tag, short *store_in, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Irecv_vector_int32(int count, int source, int tag, int *store_in, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Irecv_vector_int64(int count, int source, int tag, long *store_in, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Irecv_vector_uint8(int count, int source, int tag, unsigned char *store_in, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Irecv_vector_uint16(int count, int source, int tag, unsigned short *store_in, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Irecv_vector_uint32(int count, int source, int tag, unsigned int *store_in, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Irecv_vector_uint64(int count, int source, int tag, unsigned long *store_in, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Irecv_vector_f32(int count, int source, int tag, float *store_in, long *reqs, int block_length, int stride);
+void tiramisu_MPI_Irecv_vector_f64(int count, int source, int tag, double *store_in, long *reqs, int block_length, int stride);
+
+/**
+  * One-sided transfers: the source puts the message in the window of the destination
+  * and notifies it; the destination waits for the notification and copies the message
+  * out of its window. The messages between two ranks are received in the order they
+  * are put (the tag is not matched). Not thread safe.
+  */
+void tiramisu_MPI_Put(int count, int dest, int tag, char *data, MPI_Datatype type);
+void tiramisu_MPI_Put_int8(int count, int dest, int tag, char *data);
+void tiramisu_MPI_Put_int16(int count, int dest, int tag, short *data);
+void tiramisu_MPI_Put_int32(int count, int dest, int tag, int *data);
+void tiramisu_MPI_Put_int64(int count, int dest, int tag, long *data);
+void tiramisu_MPI_Put_uint8(int count, int dest, int tag, unsigned char *data);
+void tiramisu_MPI_Put_uint16(int count, int dest, int tag, unsigned short *data);
+void tiramisu_MPI_Put_uint32(int count, int dest, int tag, unsigned int *data);
+void tiramisu_MPI_Put_uint64(int count, int dest, int tag, unsigned long *data);
+void tiramisu_MPI_Put_f32(int count, int dest, int tag, float *data);
+void tiramisu_MPI_Put_f64(int count, int dest, int tag, double *data);
+
+void tiramisu_MPI_Get(int count, int source, int tag, char *store_in, MPI_Datatype type);
+void tiramisu_MPI_Get_int8(int count, int source, int tag, char *store_in);
+void tiramisu_MPI_Get_int16(int count, int source, int tag, short *store_in);
+void tiramisu_MPI_Get_int32(int count, int source, int tag, int *store_in);
+void tiramisu_MPI_Get_int64(int count, int source, int tag, long *store_in);
+void tiramisu_MPI_Get_uint8(int count, int source, int tag, unsigned char *store_in);
+void tiramisu_MPI_Get_uint16(int count, int source, int tag, unsigned short *store_in);
+void tiramisu_MPI_Get_uint32(int count, int source, int tag, unsigned int *store_in);
+void tiramisu_MPI_Get_uint64(int count, int source, int tag, unsigned long *store_in);
+void tiramisu_MPI_Get_f32(int count, int source, int tag, float *store_in);
+void tiramisu_MPI_Get_f64(int count, int source, int tag, double *store_in);
+
+/**
+  * Collective communications on MPI_COMM_WORLD. count is the number of elements contributed
+  * (allreduce, allgather, broadcast) or received (reduce_scatter) by each rank, and op is a
+  * tiramisu::reduce_op. When data and store_in are the same buffer (or, for allgather, when data
+  * is the block of the calling rank in store_in), the collective is done in place.
+  */
+MPI_Op tiramisu_MPI_Op(int op);
+
+void tiramisu_MPI_Allreduce_int8(int count, int op, char *data, char *store_in);
+void tiramisu_MPI_Allreduce_int16(int count, int op, short *data, short *store_in);
+void tiramisu_MPI_Allreduce_int32(int count, int op, int *data, int *store_in);
+void tiramisu_MPI_Allreduce_int64(int count, int op, long *data, long *store_in);
+void tiramisu_MPI_Allreduce_uint8(int count, int op, unsigned char *data, unsigned char *store_in);
+void tiramisu_MPI_Allreduce_uint16(int count, int op, unsigned short *data, unsigned short *store_in);
+void tiramisu_MPI_Allreduce_uint32(int count, int op, unsigned int *data, unsigned int *store_in);
+void tiramisu_MPI_Allreduce_uint64(int count, int op, unsigned long *data, unsigned long *store_in);
+void tiramisu_MPI_Allreduce_f32(int count, int op, float *data, float *store_in);
+void tiramisu_MPI_Allreduce_f64(int count, int op, double *data, double *store_in);
+
+void tiramisu_MPI_Allgather_int8(int count, char *data, char *store_in);
+void tiramisu_MPI_Allgather_int16(int count, short *data, short *store_in);
+void tiramisu_MPI_Allgather_int32(int count, int *data, int *store_in);
+void tiramisu_MPI_Allgather_int64(int count, long *data, long *store_in);
+void tiramisu_MPI_Allgather_uint8(int count, unsigned char *data, unsigned char *store_in);
+void tiramisu_MPI_Allgather_uint16(int count, unsigned short *data, unsigned short *store_in);
+void tiramisu_MPI_Allgather_uint32(int count, unsigned int *data, unsigned int *store_in);
+void tiramisu_MPI_Allgather_uint64(int count, unsigned long *data, unsigned long *store_in);
+void tiramisu_MPI_Allgather_f32(int count, float *data, float *store_in);
+void tiramisu_MPI_Allgather_f64(int count, double *data, double *store_in);
+
+void tiramisu_MPI_Bcast_int8(int count, int root, char *data, char *store_in);
+void tiramisu_MPI_Bcast_int16(int count, int root, short *data, short *store_in);
+void tiramisu_MPI_Bcast_int32(int count, int root, int *data, int *store_in);
+void tiramisu_MPI_Bcast_int64(int count, int root, long *data, long *store_in);
+void tiramisu_MPI_Bcast_uint8(int count, int root, unsigned char *data, unsigned char *store_in);
+void tiramisu_MPI_Bcast_uint16(int count, int root, unsigned short *data, unsigned short *store_in);
+void tiramisu_MPI_Bcast_uint32(int count, int root, unsigned int *data, unsigned int *store_in);
+void tiramisu_MPI_Bcast_uint64(int count, int root, unsigned long *data, unsigned long *store_in);
+void tiramisu_MPI_Bcast_f32(int count, int root, float *data, float *store_in);
+void tiramisu_MPI_Bcast_f64(int count, int root, double *data, double *store_in);
+
+void tiramisu_MPI_Reduce_scatter_int8(int count, int op, char *data, char *store_in);
+void tiramisu_MPI_Reduce_scatter_int16(int count, int op, short *data, short *store_in);
+void tiramisu_MPI_Reduce_scatter_int32(int count, int op, int *data, int *store_in);
+void tiramisu_MPI_Reduce_scatter_int64(int count, int op, long *data, long *store_in);
+void tiramisu_MPI_Reduce_scatter_uint8(int count, int op, unsigned char *data, unsigned char *store_in);
+void tiramisu_MPI_Reduce_scatter_uint16(int count, int op, unsigned short *data, unsigned short *store_in);
+void tiramisu_MPI_Reduce_scatter_uint32(int count, int op, unsigned int *data, unsigned int *store_in);
+void tiramisu_MPI_Reduce_scatter_uint64(int count, int op, unsigned long *data, unsigned long *store_in);
+void tiramisu_MPI_Reduce_scatter_f32(int count, int op, float *data, float *store_in);
+void tiramisu_MPI_Reduce_scatter_f64(int count, int op, double *data, double *store_in);
+
 }
 #endif
 #endif
@@ -0,0 +1,255 @@
+#ifndef _H_TIRAMISU_ONNX_
+#define _H_TIRAMISU_ONNX_
+
+#include <tiramisu/core.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace onnx
+{
+class NodeProto;
+}
+
+namespace tiramisu {
+
+/**
+  * An ONNX model imported into the implicit function (tiramisu::init() must
+  * be called first).  Only available when Tiramisu is built with USE_ONNX.
+  *
+  * \code
+  * init("resnet");
+  * onnx_model model("resnet50.onnx", {{"batch_size", 8}});
+  * codegen(model.get_arguments(), "resnet.o");
+  * \endcode
+  *
+  * The shapes of the tensors are computed by the shape inference of ONNX,
+  * after the symbolic dimensions of the inputs of the graph are replaced with
+  * the values of \p dim_values: every shape must then be constant.
+  *
+  * Each tensor is stored in a buffer named "b_" followed by the name of the
+  * tensor (the characters that cannot appear in a C identifier are replaced
+  * with '_'): the inputs of the graph and the initializers (the weights) are
+  * a_input buffers, the outputs of the graph are a_output buffers and the
+  * other tensors are temporaries.
+  * The arguments of the generated function are the inputs, then the
+  * initializers, then the outputs (see get_arguments()); the values of the
+  * initializers are returned by get_initializer_data().  The initializers are
+  * declared constant (see buffer::set_constant()): with codegen_with_init(),
+  * what only depends on them (the folded parameters of the batch
+  * normalizations, the transformed weights of the Winograd and FFT
+  * convolutions) is computed once by the initialization function.
+  *
+  * The supported operators (float and double tensors) are
+  *  - Conv (2D, NCHW): with a stride and a dilation of 1 and square kernels,
+  * through tiramisu::convolution, which picks the direct, GEMM, Winograd or
+  * FFT lowering for the shape of the layer; otherwise (strides, dilations,
+  * groups) as a loop nest.  The padding is copied into a temporary buffer.
+  *  - Gemm and MatMul (2D, or batched with the same batch dimensions):
+  * through tiramisu::contraction.
+  *  - BatchNormalization (inference), Relu, Sigmoid, Tanh, Identity, Dropout
+  * (inference), and Add, Sub, Mul and Div with broadcasting.
+  *  - MaxPool, AveragePool (2D) and GlobalAveragePool.
+  *  - Flatten, and Reshape when it only merges consecutive dimensions (or
+  * adds or removes dimensions of size 1).
+  *  - LSTM (forward, with the default activations, without sequence_lens,
+  * peepholes or clipping).
+  *
+  * Each node of the graph becomes a sequence of computations (see
+  * get_layer()), ordered after the computations of the previous node.  If
+  * \p fuse is true, the producer-consumer chains are then fused (see
+  * function::fuse_producer_consumer_chains()).  The function can be scheduled
+  * by hand or by the auto-scheduler like any other function.
+  */
+class onnx_model
+{
+private:
+    std::string filename;
+
+    /**
+      * The shapes and element types of the tensors of the graph.
+      */
+    std::map<std::string, std::vector<int>> shapes;
+    std::map<std::string, tiramisu::primitive_t> types;
+
+    /**
+      * The buffer of each tensor.
+      */
+    std::map<std::string, tiramisu::buffer *> buffers;
+
+    /**
+      * The input computations through which the buffers are read.
+      */
+    std::map<tiramisu::buffer *, tiramisu::input *> inputs;
+
+    /**
+      * The number of temporary buffers created.
+      */
+    int temporaries = 0;
+
+    /**
+      * The arguments of the function, and the values of the initializers
+      * (in the layout of their buffers).
+      */
+    std::vector<tiramisu::buffer *> arguments;
+    std::map<std::string, std::vector<char>> initializers;
+
+    /**
+      * The computations of each node, and all the computations in the order
+      * of their execution.
+      */
+    std::map<std::string, std::vector<tiramisu::computation *>> layers;
+    std::vector<tiramisu::computation *> computations;
+
+    /**
+      * The fusions applied after the import.
+      */
+    std::vector<tiramisu::fusion_info> fusions;
+
+protected:
+    /**
+      * Return \p name with the characters that cannot appear in a C
+      * identifier replaced with '_'.
+      */
+    static std::string sanitize(const std::string &name);
+
+    /**
+      * Return the shape of the tensor \p tensor.
+      */
+    const std::vector<int> &get_shape(const std::string &tensor) const;
+
+    /**
+      * Return the element type of the tensor \p tensor.
+      */
+    tiramisu::primitive_t get_type(const std::string &tensor) const;
+
+    /**
+      * Return the buffer of the tensor \p tensor, created with the kind
+      * \p argument if it does not exist yet.
+      */
+    tiramisu::buffer *get_buffer(const std::string &tensor, tiramisu::argument_t argument);
+
+    /**
+      * Create a temporary buffer for the layer \p layer.
+      */
+    tiramisu::buffer *create_temporary(const std::string &layer, const std::vector<int> &sizes,
+                                       tiramisu::primitive_t type);
+
+    /**
+      * Return a var of the layer \p layer, from 0 to \p size.
+      */
+    static tiramisu::var make_var(const std::string &layer, const std::string &suffix, int size);
+
+    /**
+      * Return an access to the element \p indices of the buffer \p buf.
+      */
+    tiramisu::expr access(tiramisu::buffer *buf, const std::vector<tiramisu::expr> &indices);
+
+    /**
+      * Return an access to the tensor \p tensor at the element \p indices of
+      * the output of an operator, broadcast with the rules of numpy.
+      */
+    tiramisu::expr broadcast_access(const std::string &tensor, const std::vector<tiramisu::var> &indices);
+
+    /**
+      * Add \p comp to the computations of the layer \p layer, after the last
+      * computation of the model at the loop level \p level.
+      */
+    void add_computation(const std::string &layer, tiramisu::computation *comp,
+                         int level = computation::root_dimension);
+
+    /**
+      * Create a computation of the layer \p layer over \p iterators that
+      * computes \p e (only where \p predicate holds, if it is defined), store
+      * it at \p mapping in \p buf, and add it after the last computation.
+      */
+    tiramisu::computation *add_computation(const std::string &layer, const std::vector<tiramisu::var> &iterators,
+                                           const tiramisu::expr &e, tiramisu::buffer *buf,
+                                           const std::vector<tiramisu::expr> &mapping,
+                                           int level = computation::root_dimension,
+                                           const tiramisu::expr &predicate = tiramisu::expr());
+
+    /**
+      * Create a computation of the layer \p layer over \p iterators that
+      * combines the element \p mapping of \p buf with \p e using \p op
+      * (o_add or o_max), and add it after the last computation.
+      */
+    tiramisu::computation *add_update(const std::string &layer, const std::vector<tiramisu::var> &iterators,
+                                      const tiramisu::expr &e, tiramisu::buffer *buf,
+                                      const std::vector<tiramisu::expr> &mapping,
+                                      int level = computation::root_dimension,
+                                      tiramisu::op_t op = tiramisu::o_add);
+
+    /**
+      * Return \p buf padded with \p value: \p before[d] elements before and
+      * \p after[d] elements after each of its spatial dimensions (the
+      * dimensions 2 and 3).
+      */
+    tiramisu::buffer *pad(const std::string &layer, tiramisu::buffer *buf, const std::vector<int> &before,
+                          const std::vector<int> &after, double value);
+
+    void import_conv(const std::string &layer, const std::vector<std::string> &in,
+                     const std::vector<std::string> &out, const onnx::NodeProto &node);
+    void import_gemm(const std::string &layer, const std::vector<std::string> &in,
+                     const std::vector<std::string> &out, const onnx::NodeProto &node, bool matmul);
+    void import_batch_normalization(const std::string &layer, const std::vector<std::string> &in,
+                                    const std::vector<std::string> &out, const onnx::NodeProto &node);
+    void import_elementwise(const std::string &layer, const std::string &op, const std::vector<std::string> &in,
+                            const std::vector<std::string> &out);
+    void import_pool(const std::string &layer, const std::string &op, const std::vector<std::string> &in,
+                     const std::vector<std::string> &out, const onnx::NodeProto &node);
+    void import_reshape(const std::string &layer, const std::vector<std::string> &in,
+                        const std::vector<std::string> &out);
+    void import_lstm(const std::string &layer, const std::vector<std::string> &in,
+                     const std::vector<std::string> &out, const onnx::NodeProto &node);
+
+public:
+    /**
+      * Import the ONNX model stored in the file \p filename into the implicit
+      * function.
+      */
+    onnx_model(const std::string &filename, const std::map<std::string, int> &dim_values = {}, bool fuse = true);
+
+    /**
+      * Return the buffers to pass to codegen(): the inputs, the initializers
+      * and the outputs of the graph.
+      */
+    const std::vector<tiramisu::buffer *> &get_arguments() const;
+
+    /**
+      * Return the buffer of the tensor \p tensor.
+      */
+    tiramisu::buffer *get_buffer(const std::string &tensor) const;
+
+    /**
+      * Return the values of the initializer \p tensor, in the layout of its
+      * buffer.
+      */
+    const std::vector<char> &get_initializer_data(const std::string &tensor) const;
+
+    /**
+      * Return the computations of the node \p node (its name, or its operator
+      * followed by its index in the graph if it does not have a name).
+      */
+    const std::vector<tiramisu::computation *> &get_layer(const std::string &node) const;
+
+    /**
+      * Return the computations of the model, in the order of their execution.
+      */
+    const std::vector<tiramisu::computation *> &get_computations() const;
+
+    /**
+      * Return the fusions applied after the import.
+      */
+    const std::vector<tiramisu::fusion_info> &get_fusions() const;
+
+    /**
+      * Print the layers, their computations and the fusions.
+      */
+    void dump() const;
+};
+
+}
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef _H_TIRAMISU_SPECIALIZER_
+#define _H_TIRAMISU_SPECIALIZER_
+
+#include <tiramisu/core.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace tiramisu {
+
+/**
+  * Run a function with a version specialized for the shapes of its
+  * arguments, compiled the first time the shapes are seen.
+  *
+  * An object generated for any shape is slower than an object generated
+  * for constant shapes, and generating an object per shape ahead of time
+  * is not possible when the shapes are only known at runtime.  A specializer
+  * calls the generic version \p generic (the NAME_argv entry point of an
+  * object generated by codegen()) until the version specialized for the
+  * shapes of the arguments is compiled, then calls the specialized version.
+  *
+  * \code
+  * extern "C" int matmul_argv(void **args);
+  *
+  * specializer matmul("matmul", 3, [](const std::vector<std::vector<int>> &shapes) {
+  *     // Declare the function for the sizes shapes[0][0], shapes[0][1], shapes[1][1]
+  *     // and return its arguments
+  *     ...
+  *     return std::vector<buffer *>{&b_A, &b_B, &b_C};
+  * }, matmul_argv, "/var/cache/matmul");
+  * matmul.set_schedule_file("matmul.sched");
+  *
+  * void *args[3] = {A.raw_buffer(), B.raw_buffer(), C.raw_buffer()};
+  * matmul.run(args);
+  * \endcode
+  *
+  * The specialized versions are compiled in a background thread, one at a
+  * time, so run() never waits for a compilation.  The callback \p declare
+  * is called in this thread after tiramisu::init(\p fct_name): it declares
+  * the function in the implicit function for the shapes of the arguments
+  * (the extents of the dimensions of each argument, the outermost first)
+  * and schedules it, and returns the arguments of the function.  The
+  * schedule file given to set_schedule_file() (see
+  * function::save_schedule_file()), if any, is then applied, so a schedule
+  * tuned once (e.g. by the autoscheduler) is reused by every specialized
+  * version; the schedule file must match the computations declared for
+  * every shape.
+  *
+  * Without \p cache_dir, the versions are compiled in memory with
+  * function::jit().  With \p cache_dir, they are generated with codegen(),
+  * linked into shared libraries in \p cache_dir, and loaded: the libraries
+  * found in \p cache_dir are loaded without being compiled again, including
+  * by other processes.  The flags of the link can be given in the
+  * environment variable TIRAMISU_SPECIALIZER_LDFLAGS; the Halide runtime
+  * is resolved in the process that loads the libraries.
+  *
+  * run() can be called by several threads.  A version that failed to be
+  * compiled is not compiled again, the generic version is used instead.
+  */
+class specializer
+{
+public:
+    /**
+      * The NAME_argv entry point of a version of the function: an array of
+      * pointers to the halide_buffer_t of the arguments.
+      */
+    typedef int (*argv_function_t)(void **);
+
+    typedef std::function<std::vector<tiramisu::buffer *>(const std::vector<std::vector<int>> &)> declare_function_t;
+
+private:
+    std::string fct_name;
+    int nb_arguments;
+    declare_function_t declare;
+    argv_function_t generic;
+    std::string cache_dir;
+    std::string schedule_filename;
+
+    mutable std::mutex mutex;
+    std::condition_variable queue_not_empty;
+
+    /**
+      * The compiled versions, indexed by the key of their shapes (see get_key()).
+      */
+    std::unordered_map<std::string, argv_function_t> versions;
+
+    /**
+      * The keys of the versions queued, being compiled, or that failed to
+      * be compiled.
+      */
+    std::unordered_set<std::string> requested;
+
+    /**
+      * The versions to compile, with the shapes of their arguments.
+      */
+    std::deque<std::pair<std::string, std::vector<std::vector<int>>>> queue;
+    bool compiling = false;
+    bool stopping = false;
+    std::condition_variable queue_empty;
+    std::thread worker;
+
+    /**
+      * The modules compiled with function::jit() and the shared libraries
+      * loaded from \p cache_dir, kept alive until the specializer is destroyed.
+      */
+    std::vector<Halide::Internal::JITModule> modules;
+    std::vector<void *> libraries;
+
+    /**
+      * Return the key of the shapes \p shapes, e.g. "64x32_32x16".
+      */
+    static std::string get_key(const std::vector<std::vector<int>> &shapes);
+
+    /**
+      * Load the shared library \p filename and return its entry point,
+      * or nullptr if it cannot be loaded.
+      */
+    argv_function_t load_library(const std::string &filename);
+
+    /**
+      * Compile the version for the shapes \p shapes, return nullptr if the
+      * compilation failed.
+      */
+    argv_function_t compile(const std::string &key, const std::vector<std::vector<int>> &shapes);
+
+    /**
+      * The loop of the background thread.
+      */
+    void compile_queued_versions();
+
+public:
+    specializer(const std::string &fct_name, int nb_arguments, declare_function_t declare,
+                argv_function_t generic, const std::string &cache_dir = "");
+
+    /**
+      * Wait for the version being compiled, the queued versions are not
+      * compiled.
+      */
+    ~specializer();
+
+    /**
+      * Apply the schedule file \p filename to each specialized version.
+      */
+    void set_schedule_file(const std::string &filename);
+
+    /**
+      * Run the version specialized for the shapes of \p arguments (the
+      * pointers to the halide_buffer_t of the arguments of the function) if
+      * it is compiled, and the generic version otherwise.  The first call
+      * with new shapes queues the compilation of their version.
+      */
+    int run(void **arguments);
+
+    /**
+      * Return true if the version specialized for the shapes of
+      * \p arguments is compiled.
+      */
+    bool is_specialized(void **arguments) const;
+
+    /**
+      * Wait until the queued versions are compiled.
+      */
+    void wait();
+};
+
+}
+
+#endif
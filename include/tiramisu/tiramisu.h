@@ -3,6 +3,8 @@
 
 #include <tiramisu/core.h>
 #include <tiramisu/block.h>
+#include <tiramisu/contraction.h>
+#include <tiramisu/convolution.h>
 #include <tiramisu/debug.h>
 #include <tiramisu/macros.h>
 
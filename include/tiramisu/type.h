@@ -36,6 +36,10 @@ enum primitive_t
     p_int64,
     p_float32,
     p_float64,
+    p_float16,
+    p_bfloat16,
+    p_complex64,  // Complex number made of two p_float32 (see make_complex())
+    p_complex128, // Complex number made of two p_float64
     p_boolean,
     p_async,
     p_wait_ptr,
@@ -138,6 +142,154 @@ enum argument_t
     a_temporary
 };
 
+/**
+  * Placements of the pages of a buffer on the NUMA nodes.
+  * "numa_" stands for NUMA placement.
+  */
+enum numa_placement_t
+{
+    numa_default,       // the pages are placed by the allocator
+    numa_interleave,    // the pages are interleaved across all the nodes
+    numa_first_touch,   // the pages are placed on the node of the thread that writes them first
+    numa_bind           // the pages are placed on a given node
+};
+
+/**
+  * Access patterns announced to the kernel for a buffer mapped from a file
+  * (see buffer::set_mapped_file()).
+  * "mmap_" stands for memory-mapped file.
+  */
+enum mmap_advice_t
+{
+    mmap_auto,          // derived from the order in which the schedule accesses the buffer
+    mmap_normal,        // no advice
+    mmap_sequential,    // the pages are read ahead aggressively and dropped after being accessed
+    mmap_random         // the pages are not read ahead
+};
+
+/**
+  * Storage formats of the sparse matrices (see buffer::set_sparse_format()).
+  * "sparse_" stands for sparse format.
+  */
+enum sparse_format_t
+{
+    sparse_dense,       // the buffer is not sparse
+    sparse_csr,         // compressed rows: a dense level of rows, then a compressed level of columns
+    sparse_csc,         // compressed columns: a dense level of columns, then a compressed level of rows
+    sparse_coo,         // coordinates: the row and the column of each stored entry
+    sparse_sell         // sliced ELLPACK (SELL-C-sigma): slices of C rows stored column by column, padded
+                        // to their longest row; ELLPACK is a single slice of all the rows
+};
+
+/**
+  * Strategies of the parallel reductions (see computation::parallelize_reduction()).
+  * "reduction_" stands for reduction strategy.
+  */
+enum reduction_strategy_t
+{
+    reduction_privatized,   // each thread accumulates into a private partial result, the partial results are combined sequentially
+    reduction_tree,         // like reduction_privatized, but the partial results are combined pairwise in parallel
+    reduction_atomic        // the threads update the accumulator with atomic operations
+};
+
+/**
+  * Values read outside of an input (see input::set_boundary_condition()).
+  * "boundary_" stands for boundary condition.
+  */
+enum boundary_t
+{
+    boundary_constant,      // a constant value
+    boundary_clamp,         // the nearest element on the edge of the input
+    boundary_mirror,        // the input mirrored at its edges (the edges are repeated)
+    boundary_wrap           // the input repeated periodically
+};
+
+/**
+  * Handling of the halos of a producer computed inside the loops of its consumer
+  * (see computation::compute_at()).
+  * "halo_" stands for halo handling.
+  */
+enum halo_t
+{
+    halo_recompute,         // each iteration computes its whole footprint, the overlaps between iterations are recomputed
+    halo_sliding_window     // each iteration only computes what the previous iteration did not, the overlaps are reused
+};
+
+/**
+  * Runtimes that execute the parallel loops of the generated code
+  * (see function::set_parallel_backend()).
+  * "parallel_" stands for parallel runtime.
+  */
+enum parallel_backend_t
+{
+    parallel_halide,        // the do_par_for of the Halide runtime (or the one set with halide_set_custom_do_par_for())
+    parallel_openmp,        // an OpenMP parallel for, in the OpenMP thread pool of the application
+    parallel_tbb            // a oneTBB parallel_for, in the TBB arena of the application
+};
+
+/**
+  * Layouts of the buffers in GPU shared memory (see buffer::set_shared_layout()).
+  * "shared_" stands for shared memory layout.
+  */
+enum shared_layout_t
+{
+    shared_auto,            // chosen from the accesses of the GPU threads when the code is generated
+    shared_dense,           // the rows are stored contiguously
+    shared_padded,          // each row is followed by one 4-byte word of padding
+    shared_skewed           // the elements of row r are rotated by r in the row, without padding
+};
+
+/**
+  * Hints given to the CUDA driver for a GPU buffer in managed memory
+  * (see buffer::set_gpu_managed()).
+  * "managed_" stands for managed memory advice.
+  */
+enum managed_advice_t
+{
+    managed_auto,           // read_mostly if the GPU only reads the buffer, prefer_device otherwise
+    managed_default,        // no advice, the pages migrate on demand
+    managed_read_mostly,    // the pages are duplicated on the GPU that reads them instead of migrating
+    managed_prefer_device,  // the pages stay on the GPU while it has room, and are evicted to the host
+    managed_prefer_host     // the pages stay on the host and the GPU accesses them through the bus
+};
+
+/**
+  * Implementations of the transcendental operators (o_expo, o_log, o_tanh, o_sin,
+  * o_cos) of a computation (see computation::set_math_precision()).
+  * "math_" stands for math precision.
+  */
+enum math_precision_t
+{
+    math_precise,           // calls to the math library (at most 1 ulp of error), one call per lane of a vector
+    math_fast,              // inlined polynomial approximations, vectorized, within a few ulps
+    math_approx             // shorter polynomials, vectorized, relative error of about 1e-4
+};
+
+/**
+  * Options of the isl AST generator for a loop level (see computation::set_ast_option()).
+  * "ast_" stands for AST build option.
+  */
+enum ast_option_t
+{
+    ast_default,            // chosen by isl, without the separation of the full tiles of the function
+    ast_separate,           // the full iterations of the loop are generated apart from the partial ones
+    ast_atomic,             // a single loop, each statement instance once, with min/max bounds
+    ast_unroll              // the loop is completely unrolled by isl (its extent must be bounded)
+};
+
+/**
+  * Placements of the iterations of a distributed loop on the ranks
+  * (see computation::distribute()).
+  * "distribution_" stands for distribution.
+  */
+enum distribution_t
+{
+    distribution_block,         // one chunk of consecutive iterations per rank, the chunks have the same size
+    distribution_weighted,      // one chunk of consecutive iterations per rank, the chunks have the same estimated cost
+    distribution_cyclic,        // the iterations are dealt to the ranks in a round-robin fashion
+    distribution_block_cyclic   // blocks of consecutive iterations are dealt to the ranks in a round-robin fashion
+};
+
 /**
   * Types of ranks in a distributed communication
   * "r_" stands for rank.
@@ -160,7 +312,8 @@ enum class hardware_architecture_t
 {
     arch_cpu,
     arch_nvidia_gpu,
-    arch_flexnlp
+    arch_flexnlp,
+    arch_opencl_gpu     // OpenCL kernels, for the GPUs of the other vendors (see function::gen_opencl_stmt())
 };
 
 /**
@@ -169,6 +322,17 @@ enum class hardware_architecture_t
   */
 Halide::Type halide_type_from_tiramisu_type(tiramisu::primitive_t type);
 
+/**
+  * Return true if \p type is p_complex64 or p_complex128.
+  */
+bool is_complex_type(tiramisu::primitive_t type);
+
+/**
+  * Return the type of the real and imaginary parts of the complex type
+  * \p type (p_float32 for p_complex64 and p_float64 for p_complex128).
+  */
+tiramisu::primitive_t complex_component_type(tiramisu::primitive_t type);
+
 /**
   * Convert a Halide type into the equivalent Tiramisu type (if it exists),
   * otherwise show an error message (no automatic type conversion is performed).
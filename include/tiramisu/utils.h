@@ -11,10 +11,25 @@
 #include <vector>
 
 double median(std::vector<std::chrono::duration<double, std::milli>> scores);
+
+/**
+  * Print the times of a benchmark and append them to \p file_name.  When the
+  * environment variable TIRAMISU_BENCHMARK_JSON names a file, they are also
+  * appended to it as a JSON object, with the description of the machine, so
+  * that benchmarks/compare_benchmarks.py can compare them with a baseline.
+  */
 void print_time(const std::string &file_name, const std::string &kernel_name,
                 const std::vector<std::string> &header_text,
                 const std::vector<double> &time_vector);
 
+/**
+  * Return the problem sizes a benchmark with parametric generated code should
+  * run on: the comma separated list in the environment variable
+  * TIRAMISU_BENCHMARK_SIZES (e.g. "1024,4096,16384"), or \p default_sizes if
+  * it is not set.  benchmarks/sweep_benchmark.py sets it to sweep the sizes.
+  */
+std::vector<int> get_benchmark_sizes(const std::vector<int> &default_sizes);
+
 // TODO(psuriana): init_buffer, print_buffer, copy_buffers, and compare_buffers
 // assume the buffers can only be at most 3 dimensions. Make the functions
 // able to handle arbitrary buffer dimension.
@@ -272,6 +287,63 @@ public:
     }
 };
 
+/**
+  * Tune the share of the iterations given to the GPU by a computation
+  * split between the CPU and the GPU (see computation::co_execute_on_gpu())
+  * from the measured times of the function.  The CPU and the GPU run at the
+  * same time, so the time of the function is the largest of their times, and
+  * is the smallest when they finish together: the share is found with a
+  * golden-section search, one measurement per call.
+  *
+  * \code
+  * co_execution_tuner tuner;
+  * for (...) {
+  *     split(0) = tuner.split(N);
+  *     auto start = std::chrono::high_resolution_clock::now();
+  *     spmv(split.raw_buffer(), ...);
+  *     auto end = std::chrono::high_resolution_clock::now();
+  *     tuner.report(std::chrono::duration<double, std::milli>(end - start).count());
+  * }
+  * \endcode
+  */
+class co_execution_tuner
+{
+    // The search interval, its two probes, and their times (negative if not measured yet)
+    double low = 0, high = 1, probe[2], time[2] = {-1, -1};
+    int measured = 0;
+    double tolerance;
+
+public:
+    /**
+      * Stop the search when the share is known within \p tolerance.
+      */
+    co_execution_tuner(double tolerance = 0.02);
+
+    /**
+      * The first iteration computed by the GPU for \p n iterations, i.e. the
+      * split of co_execute_on_gpu(), for the share to measure next.
+      */
+    int64_t split(int64_t n) const;
+
+    /**
+      * Report the time of the call made with the last split().
+      */
+    void report(double milliseconds);
+
+    /**
+      * The share of the iterations given to the GPU (the best one found if
+      * the search converged).
+      */
+    double get_gpu_share() const;
+
+    bool converged() const;
+
+    /**
+      * Search again, e.g. when the inputs change.
+      */
+    void restart();
+};
+
 template <typename T>
 class optional
 {
@@ -0,0 +1,127 @@
+#include "PyAutoScheduler.h"
+#include <tiramisu/auto_scheduler/ast.h>
+#include <tiramisu/auto_scheduler/evaluator.h>
+#include <tiramisu/auto_scheduler/legality_oracle.h>
+#include <tiramisu/auto_scheduler/optimization_info.h>
+
+namespace tiramisu {
+  namespace PythonBindings {
+
+    void define_auto_scheduler(py::module &m){
+      using namespace tiramisu::auto_scheduler;
+
+      m.def("perform_full_dependency_analysis", &tiramisu::perform_full_dependency_analysis,
+            "Compute the dependences of the implicit function, needed by the legality checks");
+      m.def("check_legality_of_function", &tiramisu::check_legality_of_function);
+
+      py::module as = m.def_submodule("auto_scheduler", "Schedules, legality checks and evaluation of the auto-scheduler");
+
+      py::enum_<optimization_type>(as, "optimization_type")
+        .value("UNFUSE", optimization_type::UNFUSE)
+        .value("FUSION", optimization_type::FUSION)
+        .value("TILING", optimization_type::TILING)
+        .value("INTERCHANGE", optimization_type::INTERCHANGE)
+        .value("UNROLLING", optimization_type::UNROLLING)
+        .value("PARALLELIZE", optimization_type::PARALLELIZE)
+        .value("SKEWING", optimization_type::SKEWING)
+        .value("SKEWING_POSITIVE", optimization_type::SKEWING_POSITIVE)
+        .value("VECTORIZATION", optimization_type::VECTORIZATION)
+        .value("UNROLL_AND_JAM", optimization_type::UNROLL_AND_JAM)
+        .value("GPU_MAPPING", optimization_type::GPU_MAPPING)
+        .value("THREAD_COARSENING", optimization_type::THREAD_COARSENING)
+        .value("SHARED_MEMORY_CACHING", optimization_type::SHARED_MEMORY_CACHING)
+        .value("GPU_SPLIT_REDUCTION", optimization_type::GPU_SPLIT_REDUCTION)
+        .value("DISTRIBUTION", optimization_type::DISTRIBUTION)
+        .value("FISSION", optimization_type::FISSION)
+        .value("UNIMODULAR", optimization_type::UNIMODULAR)
+        .export_values();
+
+      // The nodes belong to their syntax tree
+      py::class_<ast_node, std::unique_ptr<ast_node, py::nodelete>>(as, "ast_node")
+        .def_readonly("depth", &ast_node::depth)
+        .def_readonly("name", &ast_node::name)
+        .def_readonly("low_bound", &ast_node::low_bound)
+        .def_readonly("up_bound", &ast_node::up_bound)
+        .def_readonly("unrolled", &ast_node::unrolled)
+        .def_readonly("parallelized", &ast_node::parallelized)
+        .def_readonly("skewed", &ast_node::skewed)
+        .def_readonly("vectorized", &ast_node::vectorized)
+        .def_readonly("children", &ast_node::children, py::return_value_policy::reference_internal);
+
+      py::class_<optimization_info>(as, "optimization_info")
+        .def(py::init<>())
+        .def_readwrite("type", &optimization_info::type)
+        .def_readwrite("comps", &optimization_info::comps, py::return_value_policy::reference)
+        .def_readwrite("node", &optimization_info::node, py::return_value_policy::reference)
+        .def_readwrite("nb_l", &optimization_info::nb_l)
+        .def_readwrite("l0", &optimization_info::l0)
+        .def_readwrite("l1", &optimization_info::l1)
+        .def_readwrite("l2", &optimization_info::l2)
+        .def_readwrite("l0_fact", &optimization_info::l0_fact)
+        .def_readwrite("l1_fact", &optimization_info::l1_fact)
+        .def_readwrite("l2_fact", &optimization_info::l2_fact)
+        .def_readwrite("l3_fact", &optimization_info::l3_fact)
+        .def_readwrite("matrix", &optimization_info::matrix);
+
+      py::class_<syntax_tree>(as, "syntax_tree")
+        .def(py::init<tiramisu::function *>(), py::keep_alive<1, 2>())
+        .def("copy", &syntax_tree::copy_ast, py::return_value_policy::take_ownership)
+        .def("apply", [](syntax_tree &ast, const optimization_info &optim) {
+               // The node of the optimization must belong to this tree
+               ast.new_optims.push_back(optim);
+               ast.transform_ast();
+             }, "Add the optimization to the schedule and transform the tree accordingly")
+        .def("clear_new_optimizations", &syntax_tree::clear_new_optimizations)
+        .def("is_legal", &syntax_tree::ast_is_legal,
+             "Check the legality of the schedule with the dependences of the function")
+        .def("find_node_by_level", &syntax_tree::find_node_by_level, py::return_value_policy::reference_internal)
+        .def("get_computations", &syntax_tree::get_computations, py::return_value_policy::reference)
+        .def_readonly("roots", &syntax_tree::roots, py::return_value_policy::reference_internal)
+        .def("get_schedule", &syntax_tree::get_schedule)
+        .def("get_schedule_str", &syntax_tree::get_schedule_str)
+        .def_readwrite("evaluation", &syntax_tree::evaluation)
+        .def("print_ast", &syntax_tree::print_ast);
+
+      as.def("apply_optimizations", py::overload_cast<syntax_tree const &>(&apply_optimizations),
+             "Apply the schedule of the tree to the computations of its function");
+
+      py::class_<evaluation_function>(as, "evaluation_function")
+        .def("evaluate", &evaluation_function::evaluate, py::call_guard<py::gil_scoped_release>())
+        .def("evaluate_batch", &evaluation_function::evaluate_batch, py::call_guard<py::gil_scoped_release>());
+
+      py::class_<evaluate_by_execution, evaluation_function>(as, "evaluate_by_execution")
+        .def(py::init([](const std::vector<tiramisu::buffer *> &arguments, const std::string &obj_filename,
+                         const std::string &wrapper_cmd, tiramisu::function *fct) {
+               return new evaluate_by_execution(arguments, obj_filename, wrapper_cmd,
+                                                fct ? fct : global::get_implicit_function());
+             }),
+             py::arg("arguments"), py::arg("obj_filename"), py::arg("wrapper_cmd"), py::arg("fct") = nullptr)
+        .def("get_measurements", &evaluate_by_execution::get_measurements,
+             py::arg("ast"), py::arg("exit_on_timeout") = false, py::arg("timeout") = 0,
+             py::call_guard<py::gil_scoped_release>());
+
+      py::class_<evaluate_by_jit, evaluate_by_execution>(as, "evaluate_by_jit")
+        .def(py::init([](const std::vector<tiramisu::buffer *> &arguments, int nb_warmups, tiramisu::function *fct) {
+               return new evaluate_by_jit(arguments, nb_warmups, fct ? fct : global::get_implicit_function());
+             }),
+             py::arg("arguments"), py::arg("nb_warmups") = 1, py::arg("fct") = nullptr);
+
+      py::class_<legality_oracle>(as, "legality_oracle")
+        .def(py::init([](tiramisu::function *fct) {
+               return new legality_oracle(fct ? fct : global::get_implicit_function());
+             }),
+             py::arg("fct") = nullptr)
+        .def("is_legal", &legality_oracle::is_legal,
+             "Check a sequence of optimizations against the dependences, without applying it",
+             py::call_guard<py::gil_scoped_release>())
+        .def("is_legal_batch", &legality_oracle::is_legal_batch,
+             py::arg("sequences"), py::arg("nb_threads") = 0,
+             py::call_guard<py::gil_scoped_release>())
+        .def("find_tiling_transformations", &legality_oracle::find_tiling_transformations,
+             "Find unimodular matrices that make a band of loops tileable",
+             py::arg("previous"), py::arg("comps"), py::arg("level"), py::arg("nb_levels"),
+             py::arg("max_coefficient") = 1, py::arg("nb_solutions") = 3);
+    }
+
+  }  // namespace PythonBindings
+}  // namespace tiramisu
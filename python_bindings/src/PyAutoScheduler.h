@@ -0,0 +1,13 @@
+#ifndef TIRAMISU_PYTHON_BINDINGS_PYAUTOSCHEDULER_H
+#define TIRAMISU_PYTHON_BINDINGS_PYAUTOSCHEDULER_H
+#include "PyTiramisu.h"
+
+namespace tiramisu {
+  namespace PythonBindings {
+
+    void define_auto_scheduler(py::module &m);
+
+  }  // namespace PythonBindings
+}  // namespace tiramisu
+
+#endif // TIRAMISU_PYTHON_BINDINGS_PYAUTOSCHEDULER_H
@@ -17,6 +17,11 @@ namespace tiramisu {
             return new buffer(name, dim_sizes, type, argt);
 		      }), py::return_value_policy::reference, py::keep_alive<0, 2>())
         .def("get_name", &buffer::get_name)
+        .def("set_constant", &buffer::set_constant, py::arg("constant") = true)
+        .def("is_constant", &buffer::is_constant)
+        .def("set_mapped_file", &buffer::set_mapped_file, py::arg("mapped") = true, py::arg("advice") = mmap_auto,
+             py::arg("huge_pages") = false, py::arg("by_fd") = false)
+        .def("is_mapped_file", &buffer::is_mapped_file)
         .def("dump", &buffer::dump);
 
       buffer_class.def("allocate_at", py::overload_cast<tiramisu::computation &, tiramisu::var>(&buffer::allocate_at), py::keep_alive<1, 1>());
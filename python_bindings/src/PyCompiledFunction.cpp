@@ -0,0 +1,300 @@
+#include "PyCompiledFunction.h"
+#include <HalideRuntime.h>
+#include <dlfcn.h>
+#include <cstring>
+#include <limits>
+
+// The DLPack ABI (https://github.com/dmlc/dlpack), as exported by
+// __dlpack__() of NumPy arrays, PyTorch tensors, CuPy arrays, ...
+struct DLDevice {
+  int32_t device_type;
+  int32_t device_id;
+};
+
+struct DLDataType {
+  uint8_t code;
+  uint8_t bits;
+  uint16_t lanes;
+};
+
+struct DLTensor {
+  void *data;
+  DLDevice device;
+  int32_t ndim;
+  DLDataType dtype;
+  int64_t *shape;
+  int64_t *strides;
+  uint64_t byte_offset;
+};
+
+struct DLManagedTensor {
+  DLTensor dl_tensor;
+  void *manager_ctx;
+  void (*deleter)(DLManagedTensor *self);
+};
+
+enum DLDeviceType {
+  kDLCPU = 1,
+  kDLCUDA = 2,
+  kDLCUDAHost = 3,
+  kDLCUDAManaged = 13
+};
+
+enum DLDataTypeCode {
+  kDLBool = 6
+};
+
+namespace tiramisu {
+  namespace PythonBindings {
+
+    namespace {
+
+      struct call_argument {
+        halide_buffer_t buf;
+        std::vector<halide_dimension_t> dims;
+        uint64_t scalar;
+        py::buffer_info info;
+        DLManagedTensor *managed = nullptr;
+      };
+
+      std::string type_name(halide_type_t type) {
+        std::string code = (type.code == halide_type_int) ? "int" :
+                           (type.code == halide_type_uint) ? "uint" :
+                           (type.code == halide_type_float) ? "float" :
+                           (type.code == halide_type_bfloat) ? "bfloat" : "handle";
+        return code + std::to_string(type.bits);
+      }
+
+      bool type_from_format(std::string format, ssize_t itemsize, halide_type_t &type) {
+        if (!format.empty() && std::strchr("@=<>!", format[0]))
+          format = format.substr(1);
+        if (format.size() != 1)
+          return false;
+
+        char c = format[0];
+        if (c == '?')
+          type = halide_type_t(halide_type_uint, 1);
+        else if (std::strchr("efd", c))
+          type = halide_type_t(halide_type_float, itemsize * 8);
+        else if (std::strchr("bhilq", c))
+          type = halide_type_t(halide_type_int, itemsize * 8);
+        else if (std::strchr("BHILQ", c))
+          type = halide_type_t(halide_type_uint, itemsize * 8);
+        else
+          return false;
+        return true;
+      }
+
+      // Tiramisu linearizes the accesses with the declared sizes of the
+      // buffers, so the strides must be those of a dense row-major array.
+      void set_dims(call_argument &arg, const compiled_function::argument_info &argument, const std::string &description,
+                    int ndim, const int64_t *shape, const int64_t *strides, int64_t unit) {
+        if (ndim != argument.dimensions)
+          throw py::value_error(description + " has " + std::to_string(ndim) + " dimensions instead of "
+                                + std::to_string(argument.dimensions));
+
+        arg.dims.resize(ndim);
+        int64_t expected = 1;
+        for (int d = ndim - 1; d >= 0; d--) {
+          if (shape[d] > std::numeric_limits<int32_t>::max())
+            throw py::value_error(description + " is too large");
+          if (strides != nullptr && shape[d] > 1 && strides[d] != expected * unit)
+            throw py::value_error(description + " is not a contiguous row-major array");
+
+          // Halide's dimension 0 is the innermost one
+          arg.dims[ndim - 1 - d] = halide_dimension_t(0, (int32_t) shape[d], (int32_t) expected);
+          expected *= shape[d];
+        }
+        arg.buf.dimensions = ndim;
+        arg.buf.dim = arg.dims.data();
+      }
+
+      void set_scalar(call_argument &arg, const compiled_function::argument_info &argument, const std::string &description,
+                      py::handle obj) {
+        halide_type_t type = argument.type;
+        auto store = [&](auto value) { std::memcpy(&arg.scalar, &value, sizeof(value)); };
+
+        if (type.code == halide_type_float && type.bits == 32)
+          store(obj.cast<float>());
+        else if (type.code == halide_type_float && type.bits == 64)
+          store(obj.cast<double>());
+        else if (type.code == halide_type_uint && type.bits == 1)
+          store(obj.cast<bool>());
+        else if (type.code == halide_type_int && type.bits == 8)
+          store(obj.cast<int8_t>());
+        else if (type.code == halide_type_int && type.bits == 16)
+          store(obj.cast<int16_t>());
+        else if (type.code == halide_type_int && type.bits == 32)
+          store(obj.cast<int32_t>());
+        else if (type.code == halide_type_int && type.bits == 64)
+          store(obj.cast<int64_t>());
+        else if (type.code == halide_type_uint && type.bits == 8)
+          store(obj.cast<uint8_t>());
+        else if (type.code == halide_type_uint && type.bits == 16)
+          store(obj.cast<uint16_t>());
+        else if (type.code == halide_type_uint && type.bits == 32)
+          store(obj.cast<uint32_t>());
+        else if (type.code == halide_type_uint && type.bits == 64)
+          store(obj.cast<uint64_t>());
+        else
+          throw py::type_error(description + " has the unsupported type " + type_name(type));
+      }
+
+      void set_buffer(call_argument &arg, const compiled_function::argument_info &argument, const std::string &description,
+                      py::handle obj) {
+        std::memset(&arg.buf, 0, sizeof(arg.buf));
+
+        // NumPy arrays (and anything else that supports the buffer protocol)
+        if (py::isinstance<py::buffer>(obj)) {
+          arg.info = py::reinterpret_borrow<py::buffer>(obj).request(argument.kind == halide_argument_kind_output_buffer);
+
+          halide_type_t type;
+          if (!type_from_format(arg.info.format, arg.info.itemsize, type) || type != argument.type)
+            throw py::type_error(description + " should be an array of " + type_name(argument.type)
+                                 + ", not of format " + arg.info.format);
+
+          std::vector<int64_t> shape(arg.info.shape.begin(), arg.info.shape.end());
+          std::vector<int64_t> strides(arg.info.strides.begin(), arg.info.strides.end());
+          set_dims(arg, argument, description, arg.info.ndim, shape.data(), strides.data(), arg.info.itemsize);
+
+          arg.buf.host = (uint8_t *) arg.info.ptr;
+          arg.buf.type = type;
+          return;
+        }
+
+        // DLPack capsules, and the tensors that export them (PyTorch, CuPy, ...)
+        py::object capsule;
+        if (PyCapsule_CheckExact(obj.ptr()))
+          capsule = py::reinterpret_borrow<py::object>(obj);
+        else if (py::hasattr(obj, "__dlpack__"))
+          capsule = obj.attr("__dlpack__")();
+        else
+          throw py::type_error(description + " should be an array, a tensor or a DLPack capsule");
+
+        arg.managed = (DLManagedTensor *) PyCapsule_GetPointer(capsule.ptr(), "dltensor");
+        if (arg.managed == nullptr)
+          throw py::error_already_set();
+        PyCapsule_SetName(capsule.ptr(), "used_dltensor");
+
+        // The DLPack type codes are those of Halide, except for booleans
+        const DLTensor &tensor = arg.managed->dl_tensor;
+        halide_type_t type(halide_type_code_t(tensor.dtype.code), tensor.dtype.bits, tensor.dtype.lanes);
+        if (tensor.dtype.code == kDLBool)
+          type = halide_type_t(halide_type_uint, 1);
+        if (type != argument.type)
+          throw py::type_error(description + " should be a tensor of " + type_name(argument.type)
+                               + ", not of " + type_name(type));
+
+        // Device pointers are passed as they are: the buffer must be tagged
+        // with tag_gpu_global() in the generator
+        if (tensor.device.device_type != kDLCPU && tensor.device.device_type != kDLCUDA &&
+            tensor.device.device_type != kDLCUDAHost && tensor.device.device_type != kDLCUDAManaged)
+          throw py::value_error(description + " is on an unsupported device");
+
+        set_dims(arg, argument, description, tensor.ndim, tensor.shape, tensor.strides, 1);
+
+        arg.buf.host = (uint8_t *) tensor.data + tensor.byte_offset;
+        arg.buf.type = type;
+      }
+
+    }  // namespace
+
+    compiled_function::compiled_function(const std::string &library, const std::string &name) : name(name) {
+      void *handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+      if (handle == nullptr)
+        throw std::runtime_error("Cannot load " + library + ": " + dlerror());
+
+      argv_fn = (int (*)(void **)) dlsym(handle, (name + "_argv").c_str());
+      auto metadata_fn = (const halide_filter_metadata_t *(*)()) dlsym(handle, (name + "_metadata").c_str());
+      if (argv_fn == nullptr || metadata_fn == nullptr)
+        throw std::runtime_error(library + " does not contain the function " + name);
+
+      const halide_filter_metadata_t *metadata = metadata_fn();
+      for (int i = 0; i < metadata->num_arguments; i++)
+        arguments.push_back({metadata->arguments[i].name, metadata->arguments[i].kind,
+                             metadata->arguments[i].dimensions, metadata->arguments[i].type});
+    }
+
+    compiled_function::compiled_function(const Halide::Internal::JITModule &jit_module, const std::string &name,
+                                         const std::vector<tiramisu::buffer *> &buffers)
+      : name(name), jit_module(jit_module) {
+      argv_fn = (int (*)(void **)) this->jit_module.argv_function();
+
+      for (tiramisu::buffer *buf : buffers)
+        arguments.push_back({buf->get_name(),
+                             (buf->get_argument_type() == tiramisu::a_output) ? halide_argument_kind_output_buffer
+                                                                              : halide_argument_kind_input_buffer,
+                             buf->get_n_dims(), halide_type_from_tiramisu_type(buf->get_elements_type())});
+    }
+
+    std::vector<std::string> compiled_function::get_arguments() const {
+      std::vector<std::string> names;
+      for (const argument_info &argument : arguments)
+        names.push_back(argument.name);
+      return names;
+    }
+
+    void compiled_function::call(py::args args) {
+      if (args.size() != arguments.size())
+        throw py::type_error(name + " takes " + std::to_string(arguments.size()) + " arguments, "
+                             + std::to_string(args.size()) + " given");
+
+      // Sized once, so that the addresses passed to the function are stable
+      std::vector<call_argument> call_arguments(arguments.size());
+      std::vector<void *> argv(arguments.size());
+
+      auto release = [&]() {
+        for (call_argument &arg : call_arguments)
+          if (arg.managed != nullptr && arg.managed->deleter != nullptr) {
+            arg.managed->deleter(arg.managed);
+            arg.managed = nullptr;
+          }
+      };
+
+      int result;
+      try {
+        for (int i = 0; i < arguments.size(); i++) {
+          std::string description = "argument " + std::to_string(i) + " (" + arguments[i].name + ") of " + name;
+          if (arguments[i].kind == halide_argument_kind_input_scalar) {
+            set_scalar(call_arguments[i], arguments[i], description, args[i]);
+            argv[i] = &call_arguments[i].scalar;
+          } else {
+            set_buffer(call_arguments[i], arguments[i], description, args[i]);
+            argv[i] = &call_arguments[i].buf;
+          }
+        }
+
+        py::gil_scoped_release no_gil;
+        result = argv_fn(argv.data());
+      } catch (...) {
+        release();
+        throw;
+      }
+      release();
+
+      if (result != 0)
+        throw std::runtime_error(name + " failed with the error " + std::to_string(result));
+    }
+
+    void define_compiled_function(py::module &m){
+      py::class_<compiled_function>(m, "compiled_function")
+        .def(py::init<std::string, std::string>(), py::arg("library"), py::arg("function_name"))
+        .def("get_arguments", &compiled_function::get_arguments)
+        .def("__call__", &compiled_function::call);
+
+      m.def("load_function", [](const std::string &library, const std::string &function_name) {
+              return new compiled_function(library, function_name);
+            },
+            "Load a generated function from a shared library (e.g. the extension built by pycodegen)",
+            py::arg("library"), py::arg("function_name"));
+
+      m.def("jit", [](const std::vector<tiramisu::buffer *> &buffs) {
+              function *fct = global::get_implicit_function();
+              return new compiled_function(fct->jit(buffs), fct->get_name(), buffs);
+            },
+            "Compile the implicit function in memory and return it as a callable",
+            py::arg("arguments"));
+    }
+
+  }  // namespace PythonBindings
+}  // namespace tiramisu
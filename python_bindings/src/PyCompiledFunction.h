@@ -0,0 +1,54 @@
+#ifndef TIRAMISU_PYTHON_BINDINGS_PYCOMPILEDFUNCTION_H
+#define TIRAMISU_PYTHON_BINDINGS_PYCOMPILEDFUNCTION_H
+#include "PyTiramisu.h"
+
+namespace tiramisu {
+  namespace PythonBindings {
+
+    /**
+     * A function generated by Tiramisu, called directly through its argv
+     * entry point.  The arguments are passed without any copy.
+     */
+    class compiled_function {
+    public:
+      struct argument_info {
+        std::string name;
+        int kind; // halide_argument_kind_t
+        int dimensions;
+        halide_type_t type;
+      };
+
+    private:
+      std::string name;
+      int (*argv_fn)(void **);
+      std::vector<argument_info> arguments;
+
+      /**
+       * Keeps the code of a JIT-compiled function alive.
+       */
+      Halide::Internal::JITModule jit_module;
+
+    public:
+      /**
+       * Load the function \p name from a shared library (e.g. the extension
+       * built by pycodegen).
+       */
+      compiled_function(const std::string &library, const std::string &name);
+
+      /**
+       * Wrap a function compiled by function::jit() with the given arguments.
+       */
+      compiled_function(const Halide::Internal::JITModule &jit_module, const std::string &name,
+                        const std::vector<tiramisu::buffer *> &arguments);
+
+      std::vector<std::string> get_arguments() const;
+
+      void call(py::args args);
+    };
+
+    void define_compiled_function(py::module &m);
+
+  }  // namespace PythonBindings
+}  // namespace tiramisu
+
+#endif // TIRAMISU_PYTHON_BINDINGS_PYCOMPILEDFUNCTION_H
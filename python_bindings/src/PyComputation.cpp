@@ -52,6 +52,9 @@ namespace tiramisu {
             throw std::invalid_argument("invalid number of arguments");
 	  }, py::return_value_policy::reference, py::keep_alive<0, 1>(), py::keep_alive<0, 2>())
         .def("parallelize", &computation::parallelize)
+        .def("parallelize_reduction", &computation::parallelize_reduction,
+             py::arg("L"), py::arg("strategy") = reduction_privatized, py::arg("nb_partials") = 64)
+        .def("parallelize_scan", &computation::parallelize_scan, py::arg("L"), py::arg("nb_blocks") = 64)
         .def("store_in", py::overload_cast<tiramisu::buffer*>(&computation::store_in),
 	     py::keep_alive<1, 2>())
         .def("store_in", py::overload_cast<tiramisu::buffer*, std::vector<tiramisu::expr>>(&computation::store_in),
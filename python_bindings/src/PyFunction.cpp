@@ -1,4 +1,5 @@
 #include "PyFunction.h"
+#include "PyCompiledFunction.h"
 #include <pybind11/embed.h> // everything needed for embedding
 #include <experimental/filesystem>
 
@@ -15,7 +16,39 @@ namespace tiramisu {
 	.def("dump", &function::dump)
 	.def("gen_c_code", &function::gen_c_code)
 	.def("dump_halide_stmt", &function::dump_halide_stmt)
-	.def("codegen", py::overload_cast<const std::vector<tiramisu::buffer *> &, const std::string, const bool, bool>(&tiramisu::function::codegen));
+	.def("dump_memory_usage", &function::dump_memory_usage)
+	.def("save_schedule_file", &function::save_schedule_file, py::arg("filename"))
+	.def("apply_schedule_file", &function::apply_schedule_file, py::arg("filename"))
+	.def("codegen", py::overload_cast<const std::vector<tiramisu::buffer *> &, const std::string, const bool, bool>(&tiramisu::function::codegen))
+	.def("codegen_c", &tiramisu::function::codegen_c, py::arg("arguments"), py::arg("c_filename"))
+	.def("codegen_with_init", &tiramisu::function::codegen_with_init, py::return_value_policy::reference,
+	     py::arg("arguments"), py::arg("obj_filename"), py::arg("init_obj_filename"))
+	.def("get_constant_computations", &tiramisu::function::get_constant_computations, py::return_value_policy::reference)
+	.def("jit", [](tiramisu::function &fct, const std::vector<tiramisu::buffer *> &buffs) {
+	       return new compiled_function(fct.jit(buffs), fct.get_name(), buffs);
+	     }, "Compile the function in memory and return it as a callable", py::arg("arguments"))
+	.def("fuse_producer_consumer_chains", &tiramisu::function::fuse_producer_consumer_chains, py::arg("apply") = true)
+	.def("fuse_with_shifting", &tiramisu::function::fuse_with_shifting, py::arg("producer"), py::arg("consumer"),
+	     py::arg("level"), py::arg("apply") = true)
+	.def("compute_polyhedral_schedule", &tiramisu::function::compute_polyhedral_schedule,
+	     py::arg("tile_size") = 32, py::arg("parallelize") = true);
+
+      py::class_<fusion_info>(m, "fusion_info")
+	.def_readonly("producer", &fusion_info::producer, py::return_value_policy::reference)
+	.def_readonly("consumer", &fusion_info::consumer, py::return_value_policy::reference)
+	.def_readonly("previous_level", &fusion_info::previous_level)
+	.def_readonly("level", &fusion_info::level)
+	.def_readonly("saved_bytes", &fusion_info::saved_bytes)
+	.def_readonly("shifts", &fusion_info::shifts)
+	.def_readonly("redundant_iterations", &fusion_info::redundant_iterations);
+
+      m.def("fuse_producer_consumer_chains", &tiramisu::fuse_producer_consumer_chains, py::arg("apply") = true,
+	    "Fuse the producer-consumer chains of the implicit function");
+      m.def("fuse_with_shifting", &tiramisu::fuse_with_shifting, py::arg("producer"), py::arg("consumer"),
+	    py::arg("level"), py::arg("apply") = true,
+	    "Fuse a consumer with its producer, shifting it if needed");
+      m.def("compute_polyhedral_schedule", &tiramisu::compute_polyhedral_schedule, py::arg("tile_size") = 32,
+	    py::arg("parallelize") = true, "Schedule the implicit function with the polyhedral scheduler of isl");
 
       function_class.def("pycodegen", [](tiramisu::function & fct, const std::vector<tiramisu::buffer *> & buffs, const std::string name, const bool cuda)
 	     -> void{
@@ -9,6 +9,8 @@
 #include "PyCodegen.h"
 #include "PyInput.h"
 #include "PyFunction.h"
+#include "PyCompiledFunction.h"
+#include "PyAutoScheduler.h"
 static_assert(PYBIND11_VERSION_MAJOR == 2 && PYBIND11_VERSION_MINOR >= 6,
               "Halide requires PyBind 2.6+");
 
@@ -32,4 +34,6 @@ PYBIND11_MODULE(TIRAMISU_PYBIND_MODULE_NAME, m) {
   define_codegen(m);
   define_input(m);
   define_function(m);
+  define_compiled_function(m);
+  define_auto_scheduler(m);
 }
@@ -24,6 +24,10 @@ namespace tiramisu {
 	.value("p_int64", p_int64)
 	.value("p_float32", p_float32)
 	.value("p_float64", p_float64)
+	.value("p_float16", p_float16)
+	.value("p_bfloat16", p_bfloat16)
+	.value("p_complex64", p_complex64)
+	.value("p_complex128", p_complex128)
 	.value("p_boolean", p_boolean)
 	.value("p_async", p_async)
 	.value("p_wait_ptr", p_wait_ptr)
@@ -97,11 +101,22 @@ namespace tiramisu {
 	.value("r_sender", tiramisu::rank_t::r_sender)
 	.value("r_receiver", tiramisu::rank_t::r_receiver).export_values();
 
+      auto reduction_strategy_t_enum = py::enum_<tiramisu::reduction_strategy_t>(m, "reduction_strategy_t")
+	.value("reduction_privatized", reduction_privatized)
+	.value("reduction_tree", reduction_tree)
+	.value("reduction_atomic", reduction_atomic).export_values();
+
       auto hardware_architecture_t_enum = py::enum_<tiramisu::hardware_architecture_t>(m, "hardware_architecture_t")
 	.value("arch_cpu", tiramisu::hardware_architecture_t::arch_cpu)
 	.value("arch_nvidia_gpu", tiramisu::hardware_architecture_t::arch_nvidia_gpu)
 	.value("arch_flexnlp", tiramisu::hardware_architecture_t::arch_flexnlp).export_values();
 
+      auto mmap_advice_t_enum = py::enum_<tiramisu::mmap_advice_t>(m, "mmap_advice_t")
+	.value("mmap_auto", mmap_auto)
+	.value("mmap_normal", mmap_normal)
+	.value("mmap_sequential", mmap_sequential)
+	.value("mmap_random", mmap_random).export_values();
+
     }
 
 
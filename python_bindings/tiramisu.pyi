@@ -13,6 +13,10 @@ e_op: expr_t
 e_sync: expr_t
 e_val: expr_t
 e_var: expr_t
+mmap_auto: mmap_advice_t
+mmap_normal: mmap_advice_t
+mmap_random: mmap_advice_t
+mmap_sequential: mmap_advice_t
 o_abs: op_t
 o_access: op_t
 o_acos: op_t
@@ -69,7 +73,11 @@ o_tanh: op_t
 o_trunc: op_t
 o_type: op_t
 p_async: primitive_t
+p_bfloat16: primitive_t
 p_boolean: primitive_t
+p_complex128: primitive_t
+p_complex64: primitive_t
+p_float16: primitive_t
 p_float32: primitive_t
 p_float64: primitive_t
 p_int16: primitive_t
@@ -85,6 +93,9 @@ p_void_ptr: primitive_t
 p_wait_ptr: primitive_t
 r_receiver: rank_t
 r_sender: rank_t
+reduction_atomic: reduction_strategy_t
+reduction_privatized: reduction_strategy_t
+reduction_tree: reduction_strategy_t
 
 class argument_t:
     __members__: ClassVar[dict] = ...  # read-only
@@ -115,6 +126,17 @@ class buffer:
     def allocate_at(self, *args, **kwargs) -> Any: ...
     def dump(self, arg0: bool) -> None: ...
     def get_name(self) -> str: ...
+    def is_constant(self) -> bool: ...
+    def is_mapped_file(self) -> bool: ...
+    def set_constant(self, constant: bool = ...) -> None: ...
+    def set_mapped_file(
+        self, mapped: bool = ..., advice: mmap_advice_t = ..., huge_pages: bool = ..., by_fd: bool = ...
+    ) -> None: ...
+
+class compiled_function:
+    def __init__(self, library: str, function_name: str) -> None: ...
+    def __call__(self, *args) -> None: ...
+    def get_arguments(self) -> List[str]: ...
 
 class computation:
     @overload
@@ -156,6 +178,8 @@ class computation:
         arg11,
     ) -> None: ...
     def parallelize(self, arg0) -> None: ...
+    def parallelize_reduction(self, L, strategy: reduction_strategy_t = ..., nb_partials: int = ...) -> None: ...
+    def parallelize_scan(self, L, nb_blocks: int = ...) -> None: ...
     def set_expression(self, arg0: expr) -> None: ...
     @overload
     def split(self, arg0, arg1: int) -> None: ...
@@ -302,11 +326,40 @@ class expr_t:
 
 class function:
     def __init__(self, arg0: str) -> None: ...
+    def apply_schedule_file(self, filename: str) -> None: ...
     def codegen(self, arg0: List[buffer], arg1: str, arg2: bool, arg3: bool) -> None: ...
+    def codegen_with_init(
+        self, arguments: List[buffer], obj_filename: str, init_obj_filename: str
+    ) -> List[buffer]: ...
+    def compute_polyhedral_schedule(self, tile_size: int = ..., parallelize: bool = ...) -> bool: ...
     def dump(self, arg0: bool) -> None: ...
     def dump_halide_stmt(self) -> None: ...
+    def dump_memory_usage(self) -> None: ...
+    def fuse_producer_consumer_chains(self, apply: bool = ...) -> List[fusion_info]: ...
+    def fuse_with_shifting(
+        self, producer: computation, consumer: computation, level: int, apply: bool = ...
+    ) -> fusion_info: ...
     def gen_c_code(self) -> None: ...
+    def get_constant_computations(self) -> List[computation]: ...
+    def jit(self, arguments: List[buffer]) -> compiled_function: ...
     def pycodegen(self, arg0: List[buffer], arg1: str, arg2: bool) -> None: ...
+    def save_schedule_file(self, filename: str) -> None: ...
+
+class fusion_info:
+    @property
+    def consumer(self) -> computation: ...
+    @property
+    def level(self) -> int: ...
+    @property
+    def previous_level(self) -> int: ...
+    @property
+    def producer(self) -> computation: ...
+    @property
+    def redundant_iterations(self) -> float: ...
+    @property
+    def saved_bytes(self) -> float: ...
+    @property
+    def shifts(self) -> List[int]: ...
 
 class hardware_architecture_t:
     __members__: ClassVar[dict] = ...  # read-only
@@ -343,6 +396,26 @@ class input(computation):
     @overload
     def store_in(self, arg0: buffer, arg1: List[expr]) -> None: ...
 
+class mmap_advice_t:
+    __members__: ClassVar[dict] = ...  # read-only
+    __entries: ClassVar[dict] = ...
+    mmap_auto: ClassVar[mmap_advice_t] = ...
+    mmap_normal: ClassVar[mmap_advice_t] = ...
+    mmap_random: ClassVar[mmap_advice_t] = ...
+    mmap_sequential: ClassVar[mmap_advice_t] = ...
+    def __init__(self, value: int) -> None: ...
+    def __eq__(self, other: object) -> bool: ...
+    def __getstate__(self) -> int: ...
+    def __hash__(self) -> int: ...
+    def __index__(self) -> int: ...
+    def __int__(self) -> int: ...
+    def __ne__(self, other: object) -> bool: ...
+    def __setstate__(self, state: int) -> None: ...
+    @property
+    def name(self) -> str: ...
+    @property
+    def value(self) -> int: ...
+
 class op_t:
     __members__: ClassVar[dict] = ...  # read-only
     __entries: ClassVar[dict] = ...
@@ -418,7 +491,11 @@ class primitive_t:
     __members__: ClassVar[dict] = ...  # read-only
     __entries: ClassVar[dict] = ...
     p_async: ClassVar[primitive_t] = ...
+    p_bfloat16: ClassVar[primitive_t] = ...
     p_boolean: ClassVar[primitive_t] = ...
+    p_complex128: ClassVar[primitive_t] = ...
+    p_complex64: ClassVar[primitive_t] = ...
+    p_float16: ClassVar[primitive_t] = ...
     p_float32: ClassVar[primitive_t] = ...
     p_float64: ClassVar[primitive_t] = ...
     p_int16: ClassVar[primitive_t] = ...
@@ -463,6 +540,25 @@ class rank_t:
     @property
     def value(self) -> int: ...
 
+class reduction_strategy_t:
+    __members__: ClassVar[dict] = ...  # read-only
+    __entries: ClassVar[dict] = ...
+    reduction_atomic: ClassVar[reduction_strategy_t] = ...
+    reduction_privatized: ClassVar[reduction_strategy_t] = ...
+    reduction_tree: ClassVar[reduction_strategy_t] = ...
+    def __init__(self, value: int) -> None: ...
+    def __eq__(self, other: object) -> bool: ...
+    def __getstate__(self) -> int: ...
+    def __hash__(self) -> int: ...
+    def __index__(self) -> int: ...
+    def __int__(self) -> int: ...
+    def __ne__(self, other: object) -> bool: ...
+    def __setstate__(self, state: int) -> None: ...
+    @property
+    def name(self) -> str: ...
+    @property
+    def value(self) -> int: ...
+
 class sync(expr):
     def __init__(self) -> None: ...
 
@@ -492,10 +588,23 @@ def codegen(
     gen_architecture_flag: hardware_architecture_t,
     gen_python: bool = ...,
 ) -> None: ...
+def codegen_c(arguments: List[buffer], c_filename: str) -> None: ...
+def codegen_with_init(
+    arguments: List[buffer], obj_filename: str, init_obj_filename: str
+) -> List[buffer]: ...
+def compute_polyhedral_schedule(tile_size: int = ..., parallelize: bool = ...) -> bool: ...
 def cuda_stream_synchronize() -> expr: ...
+def fuse_producer_consumer_chains(apply: bool = ...) -> List[fusion_info]: ...
+def fuse_with_shifting(
+    producer: computation, consumer: computation, level: int, apply: bool = ...
+) -> fusion_info: ...
 def get_implicit_function(*args, **kwargs) -> Any: ...
+def check_legality_of_function() -> bool: ...
 def init(arg0: str) -> None: ...
+def jit(arguments: List[buffer]) -> compiled_function: ...
+def load_function(library: str, function_name: str) -> compiled_function: ...
 def memcpy(arg0, arg1) -> expr: ...
+def perform_full_dependency_analysis() -> None: ...
 @overload
 def pycodegen(arg0: List[buffer], arg1: str, arg2: bool) -> None: ...
 @overload
@@ -1,12 +1,18 @@
 #include <tiramisu/auto_scheduler/ast.h>
 #include <tiramisu/auto_scheduler/evaluator.h>
 
+#include <isl/aff.h>
+#include <isl/ilp.h>
+
+#include <algorithm>
+#include <cmath>
+
 namespace tiramisu::auto_scheduler
 {
 
 computation_info::computation_info(tiramisu::computation *comp, syntax_tree *ast)
-    : comp_ptr(comp), iters(dnn_iterator::get_iterators_from_computation(*comp)),
-      accesses(comp, iters.size(), comp->get_function()), buffer_nb_dims(iters.size()),
+    : comp_ptr(comp), iters(std::make_shared<const std::vector<dnn_iterator>>(dnn_iterator::get_iterators_from_computation(*comp))),
+      accesses(std::make_shared<dnn_accesses>(comp, iters->size(), comp->get_function())), buffer_nb_dims(iters->size()),
       nb_additions(0), nb_substractions(0), nb_multiplications(0), nb_divisions(0)
 {
     get_info_from_expr(comp->get_expr());
@@ -21,14 +27,22 @@ computation_info::computation_info(tiramisu::computation *comp, syntax_tree *ast
     data_type_str = str_from_tiramisu_type_primitive(comp_ptr->get_data_type());
     data_type_size = get_data_type_size();
     
-    if (buffer_nb_dims < iters.size())
-        is_reduction = true;
-    else
-        is_reduction = false;
+    // The iterators that the write access does not use are the reduction levels
+    for (int i = 0; i < iters->size(); ++i)
+        if (!isl_map_involves_dims(storage_map, isl_dim_in, i, 1))
+            reduction_levels.push_back(i);
+
+    is_reduction = buffer_nb_dims < iters->size() || !reduction_levels.empty();
+    definition_id = comp->definition_ID;
+    is_update = false;
         
     // Get buffer_id for the accesses of this computation
-    for (dnn_access_matrix& matrix : accesses.accesses_list)
+    for (dnn_access_matrix& matrix : accesses->accesses_list)
+    {
         matrix.buffer_id = ast->get_buffer_id_from_computation_name(matrix.buffer_name);
+        if (matrix.buffer_id == storage_buffer_id)
+            is_update = true;
+    }
 }
 
 int computation_info::get_data_type_size(){
@@ -86,9 +100,18 @@ void computation_info::get_info_from_expr(tiramisu::expr const& e)
         get_info_from_expr(e.get_operand(i));
 }
 
+dnn_accesses& computation_info::get_mutable_accesses()
+{
+    if (accesses.use_count() > 1)
+        accesses = std::make_shared<dnn_accesses>(*accesses);
+
+    encodings = std::make_shared<computation_encodings>();
+    return *accesses;
+}
+
 void computation_info::set_accesses_changes_with_skewing(int first_node_depth,int alpha,int beta,int gamma,int sigma)
 {
-    this->accesses.modify_accesses_by_skewing(first_node_depth,alpha,beta,gamma,sigma);
+    get_mutable_accesses().modify_accesses_by_skewing(first_node_depth,alpha,beta,gamma,sigma);
 }
 
 // ---------------------------------------------------------------------------- //
@@ -121,6 +144,18 @@ syntax_tree::syntax_tree(tiramisu::function *fct)
         computations_mapping[comp] = node->get_leftmost_node();
     }
 
+    // The blocks are scheduled as a unit, only their computations that are in the AST matter
+    for (std::vector<tiramisu::computation*> const& block : fct->get_blocks())
+    {
+        std::vector<tiramisu::computation*> block_comps;
+        for (tiramisu::computation *comp : block)
+            if (std::find(computations_list.begin(), computations_list.end(), comp) != computations_list.end())
+                block_comps.push_back(comp);
+
+        if (block_comps.size() > 1)
+            blocks.push_back(block_comps);
+    }
+
     // Order the computations by the order specified by the user using "after" commands
     order_computations();
 
@@ -147,8 +182,7 @@ ast_node::ast_node(tiramisu::computation *comp, syntax_tree *ast)
     // The fist node is the one created by this constructor
     this->depth = 0;
     this->name = isl_set_get_dim_name(iter_domain, isl_dim_set, 0);
-    this->low_bound = utility::get_bound(iter_domain, 0, false).get_int_val();
-    this->up_bound = utility::get_bound(iter_domain, 0, true).get_int_val();
+    this->constant_bounds = dnn_iterator::get_estimated_bounds(*comp, 0, this->low_bound, this->up_bound);
 
     nodes.push_back(this);
         
@@ -159,8 +193,7 @@ ast_node::ast_node(tiramisu::computation *comp, syntax_tree *ast)
         
         node->depth = i;
         node->name = isl_set_get_dim_name(iter_domain, isl_dim_set, i);
-        node->low_bound = utility::get_bound(iter_domain, i, false).get_int_val();
-        node->up_bound = utility::get_bound(iter_domain, i, true).get_int_val();
+        node->constant_bounds = dnn_iterator::get_estimated_bounds(*comp, i, node->low_bound, node->up_bound);
         
         nodes.push_back(node);
     }
@@ -180,18 +213,12 @@ void syntax_tree::order_computations()
     if (roots.size() < 2)
         return ;
 
-    std::unordered_map<std::string,std::unordered_map<std::string,int>> sched_string;
-
     //Sort the scheduling graph (fct->sched_graph) into a list of tuples that represents the order of computations
     std::vector <tiramisu::computation*> rs_comps; //computations appearing on the right side of the ordering tuples
     std::vector <tiramisu::computation*> nrs_comps; //computations that never appear on the right side of the ordering tuples
     for (auto& sched_graph_node : fct->sched_graph)
         for (auto& sched_graph_child : sched_graph_node.second)
-        {
             rs_comps.push_back(sched_graph_child.first);
-
-            sched_string[sched_graph_node.first->get_name()][sched_graph_child.first->get_name()] = sched_graph_child.second;
-        }
             
 
     for(auto* comp:this->computations_list)
@@ -199,7 +226,7 @@ void syntax_tree::order_computations()
         bool found = false;
         for(auto& comp_rs:rs_comps)
         {
-            if(comp_rs->get_name() == comp->get_name())
+            if(comp_rs == comp)
             {
                 found = true;
                 break;
@@ -222,9 +249,10 @@ void syntax_tree::order_computations()
     //first computation
     tiramisu::computation* current_comp= nrs_comps[0];
 
-    while (sched_string.find(current_comp->get_name()) != sched_string.end()) 
+    // The definitions of a computation share its name, so they are identified by their pointer
+    while (fct->sched_graph.find(current_comp) != fct->sched_graph.end() && !fct->sched_graph[current_comp].empty())
     {
-        auto sched_graph_l = fct->sched_graph[fct->get_computation_by_name(current_comp->get_name())[0]];
+        auto sched_graph_l = fct->sched_graph[current_comp];
 
         sorted_sched_graph.push_back(std::make_pair(current_comp, sched_graph_l));
 
@@ -337,6 +365,39 @@ void syntax_tree::transform_ast(optimization_info const& opt)
             transform_ast_by_skewing_positive(opt);
             break;
 
+        case optimization_type::VECTORIZATION:
+            transform_ast_by_vectorization(opt);
+            break;
+
+        case optimization_type::UNROLL_AND_JAM:
+            transform_ast_by_unroll_and_jam(opt);
+            break;
+
+        case optimization_type::GPU_MAPPING:
+            transform_ast_by_gpu_mapping(opt);
+            break;
+
+        case optimization_type::THREAD_COARSENING:
+            transform_ast_by_thread_coarsening(opt);
+            break;
+
+        case optimization_type::GPU_SPLIT_REDUCTION:
+            transform_ast_by_gpu_split_reduction(opt);
+            break;
+
+        case optimization_type::DISTRIBUTION:
+            transform_ast_by_distribution(opt);
+            break;
+
+        case optimization_type::FISSION:
+            transform_ast_by_fission(opt);
+            break;
+
+        case optimization_type::UNIMODULAR:
+            transform_ast_by_unimodular(opt);
+            break;
+
+        // Shared memory caching does not change the loop structure
         default:
             break;
     }
@@ -354,6 +415,28 @@ void syntax_tree::transform_ast_by_fusion(optimization_info const& opt)
     ast_node *node1 = (*tree_level)[opt.l0];
     ast_node *node2 = (*tree_level)[opt.l1];
 
+    // Shift the computations of node2 so that the dependences are respected inside the fused loop
+    if (opt.l0_fact != 0)
+    {
+        stage_isl_states();
+
+        std::vector<computation_info*> shifted_comps;
+        node2->collect_all_computation(shifted_comps);
+
+        for (computation_info *comp_info : shifted_comps)
+        {
+            tiramisu::computation *comp = comp_info->comp_ptr;
+            comp->shift(var(comp->get_loop_level_names()[node2->depth]), opt.l0_fact);
+            comp_info->get_mutable_accesses().modify_accesses_by_shifting(node2->depth, opt.l0_fact);
+        }
+
+        recover_isl_states();
+    }
+
+    // The fused loop covers the iterations of both loops
+    node1->low_bound = std::min(node1->low_bound, node2->low_bound + opt.l0_fact);
+    node1->up_bound = std::max(node1->up_bound, node2->up_bound + opt.l0_fact);
+
     for (ast_node *child : node2->children)
         node1->children.push_back(child);
 
@@ -363,6 +446,9 @@ void syntax_tree::transform_ast_by_fusion(optimization_info const& opt)
         computations_mapping[comp_info.comp_ptr] = node1;
     }
 
+    for (auto state : node2->isl_states)
+        node1->isl_states.push_back(state);
+
     tree_level->erase(tree_level->begin() + opt.l1);
 }
 
@@ -642,6 +728,8 @@ void syntax_tree::transform_ast_by_interchange(optimization_info const& opt)
     node1->up_bound = node2->up_bound;
     node2->up_bound = tmp_int;
 
+    std::swap(node1->constant_bounds, node2->constant_bounds);
+
 
     /**
      * Applying to staging
@@ -728,9 +816,398 @@ void syntax_tree::transform_ast_by_unrolling(optimization_info const& opt)
     }
 }
 
+void syntax_tree::transform_ast_by_unroll_and_jam(optimization_info const& opt)
+{
+    ast_node *i_outer = opt.node;
+    std::string name = i_outer->name;
+
+    // The jammed copies are computed in a new unrolled loop under the innermost one
+    ast_node *innermost = i_outer;
+    while (!innermost->children.empty())
+        innermost = innermost->children[0];
+
+    ast_node *i_inner = new ast_node();
+    i_inner->computations = innermost->computations;
+    innermost->computations.clear();
+    innermost->children.push_back(i_inner);
+    i_inner->parent = innermost;
+
+    // Location of computations have changed, update computations_mapping
+    for (computation_info& comp_info : i_inner->computations)
+    {
+        computations_mapping[comp_info.comp_ptr] = i_inner;
+    }
+
+    // Rename the nodes
+    i_inner->name = name + "_inner";
+    i_outer->name = name + "_outer";
+
+    // Set lower and upper bounds
+    int extent = i_outer->get_extent();
+    i_outer->low_bound = 0;
+    i_outer->up_bound = extent / opt.l0_fact - 1;
+
+    i_inner->low_bound = 0;
+    i_inner->up_bound = opt.l0_fact - 1;
+
+    // Finalize unrolling
+    i_inner->unrolled = true;
+    i_inner->update_depth(innermost->depth + 1);
+}
+
+void syntax_tree::transform_ast_by_vectorization(const optimization_info &opt)
+{
+    ast_node *node = opt.node;
+
+    if (node->get_extent() <= opt.l0_fact)
+        node->vectorized = true;
+
+    else
+    {
+        // Create the new loop structure
+        ast_node *i_outer = node;
+        ast_node *i_inner = new ast_node();
+
+        // Chain the nodes
+        i_inner->computations = i_outer->computations;
+        i_inner->children = i_outer->children;
+
+        i_outer->computations.clear();
+        i_outer->children.clear();
+        i_outer->children.push_back(i_inner);
+
+        i_inner->parent = i_outer;
+
+        // Location of computations have changed, update computations_mapping
+        for (computation_info& comp_info : i_inner->computations)
+        {
+            computations_mapping[comp_info.comp_ptr] = i_inner;
+        }
+
+        // Rename the nodes
+        i_inner->name = i_outer->name + "_v_inner";
+        i_outer->name = i_outer->name + "_v_outer";
+
+        // Set lower and upper bounds
+        i_outer->low_bound = 0;
+        i_outer->up_bound = i_outer->get_extent() / opt.l0_fact - 1;
+
+        i_inner->low_bound = 0;
+        i_inner->up_bound = opt.l0_fact - 1;
+
+        // Finalize vectorization
+        i_inner->vectorized = true;
+        i_inner->update_depth(i_outer->depth + 1);
+    }
+}
+
+void syntax_tree::transform_ast_by_gpu_mapping(const optimization_info &opt)
+{
+    // The mapped levels are tiled, a tile is computed by a block of threads
+    transform_ast_by_tiling(opt);
+
+    ast_node *block_0 = opt.node;
+    ast_node *block_1 = block_0->children[0];
+    ast_node *thread_0 = block_1->children[0];
+    ast_node *thread_1 = thread_0->children[0];
+
+    block_0->gpu_block = true;
+    block_1->gpu_block = true;
+    thread_0->gpu_thread = true;
+    thread_1->gpu_thread = true;
+}
+
+void syntax_tree::transform_ast_by_thread_coarsening(const optimization_info &opt)
+{
+    ast_node *block_0 = opt.node;
+    ast_node *block_1 = block_0->children[0];
+    ast_node *thread_0 = block_1->children[0];
+    ast_node *thread_1 = thread_0->children[0];
+
+    // A block computes more points, so fewer blocks are needed
+    block_0->up_bound = block_0->get_extent() / opt.l0_fact - 1;
+    block_1->up_bound = block_1->get_extent() / opt.l1_fact - 1;
+
+    // The points of a thread are computed by two loops inside the thread levels
+    ast_node *coarse_0 = new ast_node();
+    ast_node *coarse_1 = new ast_node();
+
+    coarse_1->computations = thread_1->computations;
+    coarse_1->children = thread_1->children;
+    for (auto state : thread_1->isl_states)
+        coarse_1->isl_states.push_back(state);
+
+    thread_1->computations.clear();
+    thread_1->children.clear();
+    thread_1->isl_states.clear();
+
+    thread_1->children.push_back(coarse_0);
+    coarse_0->children.push_back(coarse_1);
+
+    coarse_0->parent = thread_1;
+    coarse_1->parent = coarse_0;
+    for (ast_node *child : coarse_1->children)
+        child->parent = coarse_1;
+
+    // Location of computations have changed, update computations_mapping
+    for (computation_info& comp_info : coarse_1->computations)
+        computations_mapping[comp_info.comp_ptr] = coarse_1;
+
+    coarse_0->name = thread_0->name + "_coarse";
+    coarse_1->name = thread_1->name + "_coarse";
+
+    coarse_0->low_bound = 0;
+    coarse_0->up_bound = opt.l0_fact - 1;
+
+    coarse_1->low_bound = 0;
+    coarse_1->up_bound = opt.l1_fact - 1;
+
+    coarse_0->update_depth(thread_1->depth + 1);
+}
+
+void syntax_tree::transform_ast_by_gpu_split_reduction(const optimization_info &opt)
+{
+    ast_node *reduction = opt.node;
+
+    // The innermost block level
+    ast_node *last_block = reduction->parent;
+    while (!last_block->gpu_block)
+        last_block = last_block->parent;
+
+    // The loop over the chunks is a block level, inside the other block levels
+    ast_node *chunks = new ast_node();
+    chunks->name = reduction->name + "_chunks";
+    chunks->low_bound = 0;
+    chunks->up_bound = opt.l1_fact - 1;
+    chunks->gpu_block = true;
+
+    ast_node *first_thread = last_block->children[0];
+    last_block->children[0] = chunks;
+    chunks->parent = last_block;
+    chunks->children.push_back(first_thread);
+    first_thread->parent = chunks;
+
+    reduction->name = reduction->name + "_chunk";
+    reduction->low_bound = 0;
+    reduction->up_bound = opt.l0_fact - 1;
+
+    chunks->update_depth(last_block->depth + 1);
+}
+
+void syntax_tree::transform_ast_by_distribution(const optimization_info &opt)
+{
+    stage_isl_states();
+
+    // The outermost level of each loop nest is split into a loop over the ranks
+    // and a loop over the block of a rank
+    for (ast_node *rank_node : roots)
+    {
+        ast_node *block_node = new ast_node();
+
+        block_node->computations = rank_node->computations;
+        block_node->children = rank_node->children;
+        for (auto state : rank_node->isl_states)
+            block_node->isl_states.push_back(state);
+
+        rank_node->computations.clear();
+        rank_node->children.clear();
+        rank_node->isl_states.clear();
+
+        rank_node->children.push_back(block_node);
+        block_node->parent = rank_node;
+        for (ast_node *child : block_node->children)
+            child->parent = block_node;
+
+        // Location of computations have changed, update computations_mapping
+        for (computation_info& comp_info : block_node->computations)
+            computations_mapping[comp_info.comp_ptr] = block_node;
+
+        block_node->name = rank_node->name + "_local";
+        rank_node->name = rank_node->name + "_rank";
+
+        block_node->low_bound = 0;
+        block_node->up_bound = opt.l1_fact - 1;
+
+        rank_node->low_bound = 0;
+        rank_node->up_bound = opt.l0_fact - 1;
+        rank_node->distributed = true;
+
+        std::vector<computation_info*> all_data;
+        block_node->collect_all_computation(all_data);
+
+        for (computation_info *info : all_data)
+            info->comp_ptr->split(opt.l0, opt.l1_fact);
+
+        rank_node->update_depth(rank_node->depth);
+    }
+
+    recover_isl_states();
+}
+
+void syntax_tree::transform_ast_by_fission(const optimization_info &opt)
+{
+    ast_node *body = opt.node;
+
+    // The outermost distributed loop
+    ast_node *head = body;
+    while (head->depth > opt.l0)
+        head = head->parent;
+
+    std::vector<ast_node*> *tree_level;
+    if (head->parent != nullptr)
+        tree_level = &head->parent->children;
+    else
+        tree_level = &roots;
+
+    // Copy the distributed loops after them, and split the body between the two loop nests
+    ast_node *new_head = new ast_node();
+    ast_node *new_body = head->copy_and_return_node(new_head, body);
+    new_head->parent = head->parent;
+
+    auto head_it = std::find(tree_level->begin(), tree_level->end(), head);
+    tree_level->insert(head_it + 1, new_head);
+
+    body->computations.erase(body->computations.begin() + opt.l1, body->computations.end());
+    for (ast_node *child : body->children)
+        delete child;
+    body->children.clear();
+
+    new_body->computations.erase(new_body->computations.begin(), new_body->computations.begin() + opt.l1);
+
+    head->filter_isl_states(opt.comps, false);
+    new_head->filter_isl_states(opt.comps, true);
+
+    recompute_computations_mapping();
+    tree_structure_json = evaluate_by_learning_model::get_tree_structure_json(*this);
+}
+
+/**
+ * Return the inverse of a unimodular matrix (its entries are integers).
+ */
+static std::vector<std::vector<int>> get_unimodular_inverse(std::vector<std::vector<int>> const& matrix)
+{
+    int n = matrix.size();
+    std::vector<std::vector<double>> m(n, std::vector<double>(2 * n, 0));
+
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+            m[i][j] = matrix[i][j];
+        m[i][n + i] = 1;
+    }
+
+    // Gauss-Jordan elimination with partial pivoting
+    for (int k = 0; k < n; ++k)
+    {
+        int pivot = k;
+        for (int i = k + 1; i < n; ++i)
+            if (std::abs(m[i][k]) > std::abs(m[pivot][k]))
+                pivot = i;
+
+        std::swap(m[k], m[pivot]);
+
+        double p = m[k][k];
+        for (int j = 0; j < 2 * n; ++j)
+            m[k][j] /= p;
+
+        for (int i = 0; i < n; ++i)
+            if (i != k && m[i][k] != 0)
+            {
+                double f = m[i][k];
+                for (int j = 0; j < 2 * n; ++j)
+                    m[i][j] -= f * m[k][j];
+            }
+    }
+
+    std::vector<std::vector<int>> inverse(n, std::vector<int>(n));
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            inverse[i][j] = std::lround(m[i][n + j]);
+
+    return inverse;
+}
+
+/**
+ * Get the constant bounds of the loop level of comp in its current schedule.
+ * Return false if they are not constant.
+ */
+static bool get_loop_level_bounds(tiramisu::computation *comp, int level, int& low, int& up)
+{
+    isl_set *range = isl_map_range(isl_map_intersect_domain(isl_map_copy(comp->get_schedule()),
+                                                            isl_set_copy(comp->get_iteration_domain())));
+
+    isl_aff *iterator = isl_aff_var_on_domain(isl_local_space_from_space(isl_set_get_space(range)), isl_dim_set,
+                                              tiramisu::loop_level_into_dynamic_dimension(level));
+    isl_val *min = isl_set_min_val(range, iterator);
+    isl_val *max = isl_set_max_val(range, iterator);
+
+    bool constant = isl_val_is_int(min) && isl_val_is_int(max);
+    if (constant)
+    {
+        low = isl_val_get_num_si(min);
+        up = isl_val_get_num_si(max);
+    }
+
+    isl_val_free(min);
+    isl_val_free(max);
+    isl_aff_free(iterator);
+    isl_set_free(range);
+
+    return constant;
+}
+
+void syntax_tree::transform_ast_by_unimodular(const optimization_info &opt)
+{
+    stage_isl_states();
+
+    std::vector<computation_info*> transformed_comps;
+    opt.node->collect_all_computation(transformed_comps);
+
+    std::vector<std::vector<int>> inverse = get_unimodular_inverse(opt.matrix);
+
+    for (computation_info *comp_info : transformed_comps)
+    {
+        comp_info->comp_ptr->unimodular_transform(opt.l0, opt.matrix);
+        comp_info->get_mutable_accesses().modify_accesses_by_unimodular(opt.l0, inverse);
+    }
+
+    // The bounds of the transformed loops are given by the new schedules
+    ast_node *node = opt.node;
+    for (int i = 0; i < opt.nb_l && node != nullptr; ++i)
+    {
+        bool first = true;
+        for (computation_info *comp_info : transformed_comps)
+        {
+            int low, up;
+            if (!get_loop_level_bounds(comp_info->comp_ptr, node->depth, low, up))
+                continue;
+
+            node->low_bound = first ? low : std::min(node->low_bound, low);
+            node->up_bound = first ? up : std::max(node->up_bound, up);
+            first = false;
+        }
+
+        node = (node->children.size() == 1) ? node->children[0] : nullptr;
+    }
+
+    recover_isl_states();
+}
+
 void syntax_tree::transform_ast_by_parallelism(const optimization_info &info) {
     // Just sets the parallelized tag to true
     info.node->parallelized = true;
+
+    // The collapsed inner level is left with a single iteration
+    if (info.nb_l == 2)
+    {
+        ast_node *inner = info.node->children[0];
+        int inner_extent = inner->get_extent();
+
+        info.node->low_bound = info.node->low_bound * inner_extent;
+        info.node->up_bound = info.node->up_bound * inner_extent + inner_extent - 1;
+        inner->low_bound = 0;
+        inner->up_bound = 0;
+    }
 }
 
 void syntax_tree::transform_ast_by_skewing(const optimization_info &info){
@@ -851,6 +1328,37 @@ void syntax_tree::transform_ast_by_skewing_positive(const optimization_info &inf
     recover_isl_states();
 }
 
+bool syntax_tree::splits_block(std::vector<tiramisu::computation*> const& comps) const
+{
+    for (std::vector<tiramisu::computation*> const& block : blocks)
+    {
+        int nb_in_comps = 0;
+        for (tiramisu::computation *comp : block)
+            if (std::find(comps.begin(), comps.end(), comp) != comps.end())
+                nb_in_comps++;
+
+        if (nb_in_comps != 0 && nb_in_comps != block.size())
+            return true;
+    }
+
+    return false;
+}
+
+bool syntax_tree::respects_blocks(optimization_info const& optim) const
+{
+    switch (optim.type)
+    {
+        case optimization_type::FUSION:
+        case optimization_type::SHARED_MEMORY_CACHING:
+        case optimization_type::LOCAL_TRANSPOSITION:
+        case optimization_type::DISTRIBUTION:
+            return true;
+
+        default:
+            return !splits_block(optim.comps);
+    }
+}
+
 syntax_tree* syntax_tree::copy_ast() const
 {
     syntax_tree *ast = new syntax_tree();
@@ -889,11 +1397,14 @@ ast_node* syntax_tree::copy_and_return_node(syntax_tree& new_ast, ast_node *node
     new_ast.computations_list = computations_list;
     new_ast.buffers_list = buffers_list;
     new_ast.buffers_mapping = buffers_mapping;
+    new_ast.blocks = blocks;
     
     new_ast.iterators_json = iterators_json;
     new_ast.tree_structure_json = tree_structure_json;
     
     new_ast.evaluation = evaluation;
+    new_ast.energy = energy;
+    new_ast.hardware_counters = hardware_counters;
     new_ast.search_depth = search_depth;
     new_ast.nb_explored_optims = nb_explored_optims;
     new_ast.previous_optims = previous_optims;
@@ -930,9 +1441,14 @@ ast_node* ast_node::copy_and_return_node(ast_node *new_node, ast_node *node_to_f
     new_node->name = name;
     new_node->low_bound = low_bound;
     new_node->up_bound = up_bound;
+    new_node->constant_bounds = constant_bounds;
     new_node->unrolled = unrolled;
     new_node->skewed = skewed;
     new_node->parallelized = parallelized;
+    new_node->vectorized = vectorized;
+    new_node->gpu_block = gpu_block;
+    new_node->gpu_thread = gpu_thread;
+    new_node->distributed = distributed;
     new_node->computations = computations;
 
     //new_node->isl_states = isl_states;
@@ -1159,12 +1675,41 @@ void ast_node::get_all_computations(std::vector<tiramisu::computation*>& comps)
         child->get_all_computations(comps);
 }
 
+bool ast_node::is_reduction_level() const
+{
+    std::vector<const ast_node*> to_visit = {this};
+    bool has_computations = false;
+
+    while (!to_visit.empty())
+    {
+        const ast_node *node = to_visit.back();
+        to_visit.pop_back();
+
+        // The loop is recognized by the name of its iterator, the loops created by a transformation are not reduction levels
+        for (computation_info const& comp_info : node->computations)
+        {
+            auto it = std::find_if(comp_info.reduction_levels.begin(), comp_info.reduction_levels.end(),
+                                   [&](int level) { return (*comp_info.iters)[level].name == name; });
+
+            if (it == comp_info.reduction_levels.end())
+                return false;
+
+            has_computations = true;
+        }
+
+        for (ast_node *child : node->children)
+            to_visit.push_back(child);
+    }
+
+    return has_computations;
+}
+
 int ast_node::get_loop_levels_chain_depth() const
 {
     int ret = depth + 1;
     const ast_node *node = this;
     
-    while (node->children.size() == 1 && node->computations.size() == 0 && !node->unrolled)
+    while (node->children.size() == 1 && node->computations.size() == 0 && !node->unrolled && !node->vectorized)
     {
         ret++;
         node = node->children[0];
@@ -1201,6 +1746,12 @@ void ast_node::print_node() const
         std::cout<<this->depth <<"- "<< "for " << low_bound << " <= " << name << " < " << up_bound + 1 << " | " << unrolled;
         if (parallelized)
             std::cout << " | P";
+        if (gpu_block)
+            std::cout << " | B";
+        if (gpu_thread)
+            std::cout << " | T";
+        if (distributed)
+            std::cout << " | D";
         std::cout << std::endl;
     }
     
@@ -1301,7 +1852,7 @@ void ast_node::print_computations_accesses() const
     std::cout<<"\n";
     for(auto const& comp:this->computations)
     {
-        comp.accesses.print_all_access();
+        comp.accesses->print_all_access();
     }
     for(ast_node* child:this->children)
     {
@@ -1428,6 +1979,23 @@ void ast_node::recover_isl_states()
 
 }
 
+void ast_node::filter_isl_states(std::vector<tiramisu::computation*> const& comps, bool keep)
+{
+    // The states are copied rather than erased : they own their schedule
+    std::vector<state_computation> kept_states;
+    for (state_computation const& state : isl_states)
+    {
+        bool found = std::find(comps.begin(), comps.end(), state.get_computation_unstated()) != comps.end();
+        if (found == keep)
+            kept_states.push_back(state);
+    }
+
+    isl_states.swap(kept_states);
+
+    for (ast_node *child : children)
+        child->filter_isl_states(comps, keep);
+}
+
 void ast_node::collect_all_computation(std::vector<computation_info*>& vector)
 {
     for(auto& info:this->computations)
@@ -1502,6 +2070,137 @@ void syntax_tree::print_computations_accesses() const
     }
 }
 
+float syntax_tree::get_memory_footprint() const
+{
+    float footprint = 0;
+
+    for (auto const& entry : fct->get_buffers())
+    {
+        tiramisu::buffer *buf = entry.second;
+        if (buf->get_argument_type() != tiramisu::a_temporary)
+            continue;
+
+        float size = halide_type_from_tiramisu_type(buf->get_elements_type()).bytes();
+        for (tiramisu::expr const& dim_size : buf->get_dim_sizes())
+        {
+            if (dim_size.get_expr_type() != tiramisu::e_val)
+            {
+                size = 0;
+                break;
+            }
+
+            size *= dim_size.get_int_val();
+        }
+
+        footprint += size;
+    }
+
+    return footprint;
+}
+
+/**
+ * Encode the optimization \p optim as a string, followed by a comma.
+ */
+static std::string get_optimization_str(optimization_info const& optim)
+{
+    std::string optim_str;
+
+    switch(optim.type) {
+        case optimization_type::FUSION:
+            optim_str += "F(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+"),";
+            break;
+
+        case optimization_type::UNFUSE:
+            optim_str += "F(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+"),";
+            break;
+
+        case optimization_type::INTERCHANGE:
+            optim_str += "I(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+"),";
+            break;
+
+        case optimization_type::TILING:
+            if (optim.nb_l == 2)
+                optim_str += "T2(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+","+
+                        std::to_string(optim.l0_fact)+","+std::to_string(optim.l1_fact)+"),";
+            else if (optim.nb_l == 3)
+                optim_str += "T3(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+",L"+std::to_string(optim.l2)+","+
+                        std::to_string(optim.l0_fact)+","+std::to_string(optim.l1_fact)+","+std::to_string(optim.l2_fact)+"),";
+            break;
+
+        case optimization_type::UNROLLING:
+            optim_str += "U(L"+std::to_string(optim.l0)+","+std::to_string(optim.l0_fact)+"),";
+            break;
+
+        case optimization_type::PARALLELIZE:
+            if (optim.nb_l == 2)
+                optim_str += "P(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+"),";
+            else
+                optim_str += "P(L"+std::to_string(optim.l0)+"),";
+            break;
+
+        case optimization_type::SKEWING:
+            optim_str += "S(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+","+
+                            std::to_string(optim.l0_fact)+","+std::to_string(optim.l1_fact)+"),";
+            break;
+        
+        case optimization_type::SKEWING_POSITIVE:
+            optim_str += "S(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+","+
+                            std::to_string(optim.l0_fact)+","+std::to_string(optim.l1_fact)+","+
+                            std::to_string(optim.l2_fact)+","+std::to_string(optim.l3_fact)+"),";
+            break;
+
+        case optimization_type::VECTORIZATION:
+            optim_str += "V(L"+std::to_string(optim.l0)+","+std::to_string(optim.l0_fact)+
+                            (optim.l1_fact == 1 ? ",A" : "")+"),";
+            break;
+
+        case optimization_type::GPU_MAPPING:
+            optim_str += "G(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+","+
+                            std::to_string(optim.l0_fact)+","+std::to_string(optim.l1_fact)+"),";
+            break;
+
+        case optimization_type::THREAD_COARSENING:
+            optim_str += "C(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+","+
+                            std::to_string(optim.l0_fact)+","+std::to_string(optim.l1_fact)+"),";
+            break;
+
+        case optimization_type::SHARED_MEMORY_CACHING:
+            optim_str += "SM("+optim.comps[0]->get_name()+","+std::to_string(optim.l0)+"),";
+            break;
+
+        case optimization_type::GPU_SPLIT_REDUCTION:
+            optim_str += "K(L"+std::to_string(optim.l0)+","+std::to_string(optim.l0_fact)+"),";
+            break;
+
+        case optimization_type::LOCAL_TRANSPOSITION:
+            optim_str += "LT("+optim.comps[0]->get_name()+","+std::to_string(optim.l0)+"),";
+            break;
+
+        case optimization_type::DISTRIBUTION:
+            optim_str += "D(L"+std::to_string(optim.l0)+","+std::to_string(optim.l0_fact)+"),";
+            break;
+
+        case optimization_type::FISSION:
+            optim_str += "X(L"+std::to_string(optim.l0)+","+std::to_string(optim.l1)+"),";
+            break;
+
+        case optimization_type::UNIMODULAR:
+        {
+            optim_str += "M(L"+std::to_string(optim.l0);
+            for (std::vector<int> const& row : optim.matrix)
+                for (int coefficient : row)
+                    optim_str += ","+std::to_string(coefficient);
+            optim_str += "),";
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return optim_str;
+}
+
 std::string syntax_tree::get_schedule_str()
 {
     std::vector<optimization_info> schedule_vect = this->get_schedule();
@@ -1509,55 +2208,83 @@ std::string syntax_tree::get_schedule_str()
 
     for (auto optim: schedule_vect)
     {
-        switch(optim.type) {
-            case optimization_type::FUSION:
-                schedule_str += "F(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+"),";
-                break;
+        schedule_str += get_optimization_str(optim);
+        if (!schedule_vect.empty())
+            schedule_str.pop_back(); // remove last comma
+    }
 
-            case optimization_type::UNFUSE:
-                schedule_str += "F(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+"),";
-                break;
+    return schedule_str;
+}
 
-            case optimization_type::INTERCHANGE:
-                schedule_str += "I(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+"),";
-                break;
+/**
+ * Encode the loop structure of the tree rooted at \p node: the iterators, their bounds and
+ * their tags, and the computations in the order in which they are computed.
+ */
+static void get_loop_structure_str(ast_node const *node, std::string &str)
+{
+    str += node->name + "[" + std::to_string(node->low_bound) + "," + std::to_string(node->up_bound) + "]";
+    if (node->parallelized) str += "P";
+    if (node->vectorized) str += "V";
+    if (node->unrolled) str += "U";
+    if (node->skewed) str += "S";
+    if (node->gpu_block) str += "B";
+    if (node->gpu_thread) str += "T";
+    if (node->distributed) str += "D";
 
-            case optimization_type::TILING:
-                if (optim.nb_l == 2)
-                    schedule_str += "T2(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+","+
-                            std::to_string(optim.l0_fact)+","+std::to_string(optim.l1_fact)+"),";
-                else if (optim.nb_l == 3)
-                    schedule_str += "T3(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+",L"+std::to_string(optim.l2)+","+
-                            std::to_string(optim.l0_fact)+","+std::to_string(optim.l1_fact)+","+std::to_string(optim.l2_fact)+"),";
-                break;
+    str += "{";
+    for (computation_info const& comp_info : node->computations)
+        str += comp_info.comp_ptr->get_name() + ";";
+    for (ast_node const *child : node->children)
+        get_loop_structure_str(child, str);
+    str += "}";
+}
+
+std::string syntax_tree::get_canonical_form() const
+{
+    std::string canonical_form;
+    for (ast_node const *root : roots)
+        get_loop_structure_str(root, canonical_form);
 
+    // The optimizations that only change the loop structure are described by it
+    for (optimization_info const& optim : this->get_schedule())
+    {
+        bool structural = false;
+        switch (optim.type)
+        {
+            case optimization_type::TILING:
+            case optimization_type::INTERCHANGE:
             case optimization_type::UNROLLING:
-                schedule_str += "U(L"+std::to_string(optim.l0)+","+std::to_string(optim.l0_fact)+"),";
+            case optimization_type::UNFUSE:
+                structural = true;
                 break;
 
-            case optimization_type::PARALLELIZE:
-                schedule_str += "P(L"+std::to_string(optim.l0)+"),";
+            case optimization_type::VECTORIZATION:
+                structural = (optim.l1_fact == 0);
                 break;
 
-            case optimization_type::SKEWING:
-                schedule_str += "S(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+","+
-                                std::to_string(optim.l0_fact)+","+std::to_string(optim.l1_fact)+"),";
+            case optimization_type::FUSION:
+                structural = (optim.l0_fact == 0);
                 break;
-            
-            case optimization_type::SKEWING_POSITIVE:
-                schedule_str += "S(L"+std::to_string(optim.l0)+",L"+std::to_string(optim.l1)+","+
-                                std::to_string(optim.l0_fact)+","+std::to_string(optim.l1_fact)+","+
-                                std::to_string(optim.l2_fact)+","+std::to_string(optim.l3_fact)+"),";
+
+            case optimization_type::PARALLELIZE:
+                structural = (optim.nb_l == 1);
                 break;
 
             default:
                 break;
         }
-        if (!schedule_vect.empty())
-            schedule_str.pop_back(); // remove last comma
+
+        if (structural)
+            continue;
+
+        canonical_form += "|" + std::to_string(optim.type) + ":" + get_optimization_str(optim);
+        for (int value : {optim.nb_l, optim.l0, optim.l1, optim.l2, optim.l0_fact, optim.l1_fact, optim.l2_fact, optim.l3_fact})
+            canonical_form += std::to_string(value) + ",";
+        for (tiramisu::computation *comp : optim.comps)
+            canonical_form += comp->get_name() + ",";
     }
 
-    return schedule_str;
+    return canonical_form;
 }
 
 bool syntax_tree::schedule_is_prunable()
@@ -1617,6 +2344,7 @@ bool syntax_tree::can_set_default_evaluation()
     this->exploration_depth = ast->search_depth+1;
     this->candidate_id = candidate_id;
     this->schedule_str = ast->get_schedule_str();
+    this->hardware_counters = ast->hardware_counters;
 }
 
 candidate_trace::~candidate_trace() {
@@ -1636,8 +2364,12 @@ std::string candidate_trace::get_exploration_trace_json()
     std::string trace_json = "{ \"id\": "+std::to_string(this->candidate_id)+
             ", \"schedule\": \"" + this->schedule_str + "\"" +
             ", \"depth\": " + std::to_string(this->exploration_depth) +
-            ", \"evaluation\": " + std::to_string(this->evaluation) +
-            ", \"children\": [";
+            ", \"evaluation\": " + std::to_string(this->evaluation);
+
+    if (!this->hardware_counters.empty())
+        trace_json += ", \"hardware_counters\": " + counters_to_str(this->hardware_counters);
+
+    trace_json += ", \"children\": [";
 
     if (!this->child_candidates.empty())
     {
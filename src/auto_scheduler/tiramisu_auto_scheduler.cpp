@@ -1,8 +1,11 @@
 #include <tiramisu/auto_scheduler/auto_scheduler.h>
 #include <tiramisu/auto_scheduler/evaluator.h>
+#include <tiramisu/auto_scheduler/schedule_database.h>
 #include <tiramisu/auto_scheduler/search_method.h>
 
 #include <chrono>
+#include <cstdio>
+#include <fstream>
 
 namespace tiramisu::auto_scheduler
 {
@@ -15,9 +18,85 @@ auto_scheduler::auto_scheduler(search_method *searcher, evaluation_function *eva
     searcher->set_eval_func(eval_func);
 }
 
-void auto_scheduler::sample_search_space(std::string filename, bool timeout_schedules)
+auto_scheduler::~auto_scheduler()
+{
+    // Deleting the caches saves them
+    for (evaluation_cache *cache : checkpoint_caches)
+        delete cache;
+
+    delete sched_db;
+}
+
+void auto_scheduler::set_schedule_database(std::string const& filename, int nb_seeds)
+{
+    delete sched_db;
+    sched_db = new schedule_database(filename);
+    this->nb_seeds = nb_seeds;
+}
+
+void auto_scheduler::set_budget(float time_budget, int schedules_budget)
+{
+    searcher->set_budget(time_budget, schedules_budget);
+}
+
+void auto_scheduler::set_checkpoint(std::string const& filename, int period)
+{
+    checkpoint_filename = filename;
+    searcher->set_checkpoint(filename, period);
+
+    if (eval_func->get_cache() == nullptr)
+    {
+        checkpoint_caches.push_back(new evaluation_cache(filename + ".eval_cache"));
+        eval_func->set_cache(checkpoint_caches.back());
+    }
+
+    if (exec_evaluator != nullptr && exec_evaluator->get_cache() == nullptr)
+    {
+        checkpoint_caches.push_back(new evaluation_cache(filename + ".exec_cache"));
+        exec_evaluator->set_cache(checkpoint_caches.back());
+    }
+}
+
+void auto_scheduler::prepare_checkpointed_search(bool resume)
+{
+    if (checkpoint_filename.empty())
+    {
+        if (resume)
+        {
+            std::cerr << "error: set_checkpoint() must be called to resume a search" << std::endl;
+            exit(1);
+        }
+
+        return ;
+    }
+
+    int nb_explored_schedules = 0;
+    float best_evaluation = 0;
+    std::string best_schedule;
+    bool has_checkpoint = search_method::read_checkpoint(checkpoint_filename, nb_explored_schedules, best_evaluation, best_schedule);
+
+    if (resume)
+    {
+        if (has_checkpoint)
+            std::cout << "Resuming the search from " << checkpoint_filename << " : " << nb_explored_schedules
+                      << " schedules already explored, best evaluation " << best_evaluation << " (" << best_schedule << ")" << std::endl;
+        else
+            std::cout << "No checkpoint found in " << checkpoint_filename << ", starting a new search" << std::endl;
+
+        return ;
+    }
+
+    // Start from scratch : forget the evaluations of the previous checkpointed search
+    for (evaluation_cache *cache : checkpoint_caches)
+        cache->clear();
+
+    remove(checkpoint_filename.c_str());
+}
+
+void auto_scheduler::sample_search_space(std::string filename, bool timeout_schedules, bool resume)
 {
     std::chrono::steady_clock::time_point sampling_start = std::chrono::steady_clock::now();
+    prepare_checkpointed_search(resume);
     fct->reset_schedules();
 
     setenv("INIT_EXEC_TIME", "0", true); // set the INIT_EXEC_TIME to 0 meaning that it's the non scheduled version
@@ -60,6 +139,7 @@ void auto_scheduler::sample_search_space(std::string filename, bool timeout_sche
     }
 
     searcher->set_exec_eval(exec_evaluator);
+    searcher->start_budget();
     searcher->search_save(ast, &schedules_annotations, &exploration_trace_root, schedule_timeout);
 
     std::string output_json;
@@ -72,7 +152,10 @@ void auto_scheduler::sample_search_space(std::string filename, bool timeout_sche
                   "\n\t\"node_name\" : \"" + read_env_var("SLURMD_NODENAME") + "\"," +
                   "\n\t\"parameters\" : {" +
                   "\n\t\t\"beam_size\" : " + read_env_var("BEAM_SIZE") + ", " +
-                  "\n\t\t\"max_depth\" : " + read_env_var("MAX_DEPTH") +
+                  "\n\t\t\"max_depth\" : " + read_env_var("MAX_DEPTH") + ", " +
+                  "\n\t\t\"halide_target\" : \"" + exec_evaluator->get_halide_target().to_string() + "\", " +
+                  "\n\t\t\"machine_profile\" : " + (machine_profile::get_host_profile() != nullptr ?
+                                                        machine_profile::get_host_profile()->get_json() : "null") +
 //                  "\n\t\t\"nb_exec\" : " + nb_exec +
                   "\n\t}, " +
                   "\n\t\"program_annotation\" : " + program_json + ", " +
@@ -91,6 +174,16 @@ void auto_scheduler::sample_search_space(std::string filename, bool timeout_sche
 
     output_json += "\"exploration_trace\": " + exploration_trace_root.get_exploration_trace_json();
 
+    if (exec_evaluator->get_cache() != nullptr)
+        output_json += ", \n\"evaluation_cache\" : " + exec_evaluator->get_cache()->get_stats_json();
+
+    schedules_generator *scheds_gen = searcher->get_schedules_generator();
+    if (scheds_gen != nullptr && scheds_gen->get_candidate_pruner() != nullptr)
+        output_json += ", \n\"candidate_pruner\" : " + scheds_gen->get_candidate_pruner()->get_stats_json();
+
+    if (searcher->get_pareto_front() != nullptr)
+        output_json += ", \n\"pareto_front\" : " + searcher->get_pareto_front()->get_json();
+
     output_json += " \n}\n";
 
     std::ofstream file(filename);
@@ -104,8 +197,9 @@ void auto_scheduler::sample_search_space(std::string filename, bool timeout_sche
     }
 }
 
-void auto_scheduler::find_schedule()
+void auto_scheduler::find_schedule(bool resume)
 {
+    prepare_checkpointed_search(resume);
     fct->reset_schedules();
     if (exec_evaluator != nullptr)
         initial_exec_time = exec_evaluator->evaluate(ast);
@@ -114,9 +208,30 @@ void auto_scheduler::find_schedule()
     
     // Get the initial evaluation, and start the search.
     ast.evaluation = eval_func->evaluate(ast);
+
+    // Start from the schedules of the most similar tuned programs
+    if (sched_db != nullptr)
+    {
+        std::vector<syntax_tree*> seeds;
+        for (std::vector<optimization_info> const& schedule : sched_db->find_nearest_schedules(ast, nb_seeds))
+            seeds.push_back(searcher->replay_schedule(ast, schedule));
+
+        if (std::atoi(read_env_var("AS_VERBOSE")) == 1)
+            std::cout << "Schedules found in the database : " << seeds.size() << std::endl;
+
+        searcher->set_seeds(seeds);
+    }
+
+    searcher->start_budget();
     searcher->search(ast);
     
     std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    if (sched_db != nullptr && searcher->get_best_ast() != nullptr)
+    {
+        sched_db->add_schedule(ast, searcher->get_best_ast()->get_schedule());
+        sched_db->save();
+    }
     
     // Print some info about the search
     std::cout << "NB explored schedules : " << searcher->get_nb_explored_schedules() << std::endl;
@@ -127,11 +242,26 @@ void auto_scheduler::find_schedule()
         
     std::cout << "Initial evaluation : " << ast.evaluation << std::endl;
     std::cout << "Search time : " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms " << std::endl;  
+
+    if (eval_func->get_cache() != nullptr)
+        std::cout << "Evaluation cache : " << eval_func->get_cache()->get_stats_json() << std::endl;
+
+    schedules_generator *scheds_gen = searcher->get_schedules_generator();
+    if (scheds_gen != nullptr && scheds_gen->get_candidate_pruner() != nullptr)
+        std::cout << "Pruned candidates : " << scheds_gen->get_candidate_pruner()->get_stats_json() << std::endl;
+
+    if (searcher->get_pareto_front() != nullptr)
+        std::cout << "Pareto front : " << searcher->get_pareto_front()->get_json() << std::endl;
 }
 
 void auto_scheduler::apply_best_schedule()
 {
     syntax_tree *best_ast = searcher->get_best_ast();
+
+    // The search was stopped (by its budget) before finding a better schedule
+    if (best_ast == nullptr)
+        best_ast = &ast;
+
     best_ast->print_ast();
     
     // To apply the best schedule, we need to use exec_evaluator.
@@ -145,4 +275,19 @@ void auto_scheduler::apply_best_schedule()
     }
 }
 
+void auto_scheduler::save_best_schedule(std::string const& filename)
+{
+    syntax_tree *best_ast = searcher->get_best_ast();
+    if (best_ast == nullptr)
+        best_ast = &ast;
+
+    fct->reset_schedules();
+    apply_optimizations(*best_ast);
+    fct->save_schedule_file(filename);
+
+    // Keep the optimizations, so that the schedule can also seed a search (see schedule_database::deserialize_schedule())
+    std::ofstream file(filename, std::ios::app);
+    file << "optimizations " << schedule_database::serialize_schedule(best_ast->get_schedule()) << "\n";
+}
+
 }
@@ -1,5 +1,10 @@
 #include <tiramisu/auto_scheduler/dnn_accesses.h>
 
+#include <isl/aff.h>
+#include <isl/ilp.h>
+
+#include <algorithm>
+
 namespace tiramisu::auto_scheduler
 {
 
@@ -15,15 +20,75 @@ dnn_iterator::get_iterators_from_computation(tiramisu::computation const& comp)
     for (int i = 0; i < nb_iterators; ++i)
     {
         std::string name = isl_set_get_dim_name(iter_domain, isl_dim_set, i);
-        int low_bound = utility::get_bound(iter_domain, i, false).get_int_val();
-        int up_bound = utility::get_bound(iter_domain, i, true).get_int_val();
+        int low_bound, up_bound;
+        bool constant_bounds = get_estimated_bounds(comp, i, low_bound, up_bound);
         
-        iters_list.push_back(dnn_iterator(name, low_bound, up_bound));
+        iters_list.push_back(dnn_iterator(name, low_bound, up_bound, constant_bounds));
     }
     
     return iters_list;
 }
 
+bool dnn_iterator::get_estimated_bounds(tiramisu::computation const& comp, int dim, int& low_bound, int& up_bound)
+{
+    isl_set *iter_domain = comp.get_iteration_domain();
+
+    tiramisu::expr low = utility::get_bound(iter_domain, dim, false);
+    tiramisu::expr up = utility::get_bound(iter_domain, dim, true);
+
+    if (low.get_expr_type() == tiramisu::e_val && up.get_expr_type() == tiramisu::e_val)
+    {
+        low_bound = low.get_int_val();
+        up_bound = up.get_int_val();
+        return true;
+    }
+
+    isl_set *domain = isl_set_copy(iter_domain);
+    isl_set *context = comp.get_function()->get_program_context();
+    if (context != NULL)
+        domain = isl_set_intersect_params(domain, context);
+
+    // The parameters become dimensions of the domain, so that they can be bounded
+    int nb_dims = isl_set_dim(domain, isl_dim_set);
+    int nb_params = isl_set_dim(domain, isl_dim_param);
+    domain = isl_set_move_dims(domain, isl_dim_set, nb_dims, isl_dim_param, 0, nb_params);
+
+    for (int i = nb_dims; i < nb_dims + nb_params; ++i)
+    {
+        isl_aff *param = isl_aff_var_on_domain(isl_local_space_from_space(isl_set_get_space(domain)), isl_dim_set, i);
+        isl_val *min = isl_set_min_val(domain, param);
+        isl_val *max = isl_set_max_val(domain, param);
+
+        if (!isl_val_is_int(max))
+        {
+            long value = DEFAULT_PARAMETER_ESTIMATE;
+            if (isl_val_is_int(min))
+                value = std::max(value, isl_val_get_num_si(min));
+
+            domain = isl_set_fix_si(domain, isl_dim_set, i, value);
+        }
+
+        isl_val_free(min);
+        isl_val_free(max);
+        isl_aff_free(param);
+    }
+
+    // The bounds of the rectangular hull of the loop
+    isl_aff *iterator = isl_aff_var_on_domain(isl_local_space_from_space(isl_set_get_space(domain)), isl_dim_set, dim);
+    isl_val *min = isl_set_min_val(domain, iterator);
+    isl_val *max = isl_set_max_val(domain, iterator);
+
+    low_bound = isl_val_is_int(min) ? isl_val_get_num_si(min) : 0;
+    up_bound = isl_val_is_int(max) ? isl_val_get_num_si(max) : low_bound + DEFAULT_PARAMETER_ESTIMATE - 1;
+
+    isl_val_free(min);
+    isl_val_free(max);
+    isl_aff_free(iterator);
+    isl_set_free(domain);
+
+    return false;
+}
+
 dnn_access_matrix::dnn_access_matrix(int nb_iterators, int nb_dims)
     : nb_iterators(nb_iterators), nb_dims(nb_dims), matrix(nb_dims), buffer_id(0)
 {
@@ -63,6 +128,32 @@ void dnn_access_matrix::print_access_matrix() const
     std::cout<<"\n";
 }
 
+void dnn_access_matrix::transform_matrix_by_shifting(int depth, int shift)
+{
+    // The shifted iterator is i' = i + shift, the accesses are rewritten with i = i' - shift
+    for (std::vector<int>& row : matrix)
+        row.back() -= row[depth] * shift;
+}
+
+void dnn_access_matrix::transform_matrix_by_unimodular(int depth, std::vector<std::vector<int>> const& inverse)
+{
+    // The old iterators are i = inverse * i', the coefficients of i' are row * inverse
+    int n = inverse.size();
+    if (depth + n > nb_iterators)
+        return ;
+
+    for (std::vector<int>& row : matrix)
+    {
+        std::vector<int> coefficients(row.begin() + depth, row.begin() + depth + n);
+        for (int j = 0; j < n; ++j)
+        {
+            row[depth + j] = 0;
+            for (int k = 0; k < n; ++k)
+                row[depth + j] += coefficients[k] * inverse[k][j];
+        }
+    }
+}
+
 void dnn_access_matrix::transform_matrix_by_skewing(int first_node_depth,int alpha,int beta,int gamma,int sigma)
 {
     
@@ -259,4 +350,16 @@ void dnn_accesses::modify_accesses_by_skewing(int first_node_depth,int alpha,int
     }
 }
 
+void dnn_accesses::modify_accesses_by_shifting(int depth, int shift)
+{
+    for (dnn_access_matrix& access : accesses_list)
+        access.transform_matrix_by_shifting(depth, shift);
+}
+
+void dnn_accesses::modify_accesses_by_unimodular(int depth, std::vector<std::vector<int>> const& inverse)
+{
+    for (dnn_access_matrix& access : accesses_list)
+        access.transform_matrix_by_unimodular(depth, inverse);
+}
+
 }
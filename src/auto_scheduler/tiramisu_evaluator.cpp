@@ -3,24 +3,157 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <sys/file.h>
 
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <sys/prctl.h>
+#include <asm/hwcap.h>
+#endif
+
+#if defined(__riscv) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <chrono>
+#include <fstream>
+#include <sstream>
 
 namespace tiramisu::auto_scheduler
 {
 
+// 64-bit FNV-1a, which is stable across runs and builds, so the cache file
+// can be reused by another build of the auto-scheduler
+static std::string stable_hash(std::string const& contents)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : contents)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+
+    std::ostringstream key;
+    key << std::hex << hash;
+    return key.str();
+}
+
+evaluation_cache::evaluation_cache(std::string const& filename, int max_nb_entries)
+    : filename(filename), max_nb_entries(max_nb_entries)
+{
+    // Each line of the file contains : key nb_measurements measurement_1 ... measurement_n
+    // Lines are sorted from the least to the most recently used entry.
+    std::ifstream file(filename);
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        std::istringstream iss(line);
+        std::string key;
+        int nb_measurements = 0;
+
+        if (!(iss >> key >> nb_measurements))
+            continue;
+
+        cache_entry entry;
+        for (int i = 0; i < nb_measurements; ++i)
+        {
+            std::string measure;
+            iss >> measure;
+            entry.measurements.push_back(std::stof(measure));
+        }
+
+        entry.last_use = clock++;
+        entries[key] = entry;
+    }
+}
+
+std::string evaluation_cache::get_key(syntax_tree& ast, std::string const& evaluator_id)
+{
+    std::string canonical = evaluate_by_learning_model::get_program_json(ast) +
+                            evaluate_by_learning_model::get_schedule_json(ast) +
+                            ast.get_schedule_str() + evaluator_id;
+
+    return stable_hash(canonical);
+}
+
+std::string evaluation_cache::get_key(std::string const& program_json, std::string const& schedule_json,
+                                      std::string const& evaluator_id)
+{
+    return stable_hash(program_json + schedule_json + evaluator_id);
+}
+
+bool evaluation_cache::lookup(std::string const& key, std::vector<float>& measurements)
+{
+    auto it = entries.find(key);
+    if (it == entries.end())
+    {
+        nb_misses++;
+        return false;
+    }
+
+    nb_hits++;
+    it->second.last_use = clock++;
+    measurements = it->second.measurements;
+
+    return true;
+}
+
+void evaluation_cache::insert(std::string const& key, std::vector<float> const& measurements)
+{
+    cache_entry& entry = entries[key];
+    entry.measurements = measurements;
+    entry.last_use = clock++;
+}
+
+void evaluation_cache::save()
+{
+    std::vector<std::pair<long, std::string>> keys_by_use;
+    for (auto const& entry : entries)
+        keys_by_use.push_back({entry.second.last_use, entry.first});
+
+    std::sort(keys_by_use.begin(), keys_by_use.end());
+
+    // Evict the least recently used entries
+    int nb_evicted = std::max((int)keys_by_use.size() - max_nb_entries, 0);
+    for (int i = 0; i < nb_evicted; ++i)
+        entries.erase(keys_by_use[i].second);
+
+    // Write to a temporary file, so that an interruption never leaves a truncated cache
+    std::string tmp_filename = filename + ".tmp";
+    std::ofstream file(tmp_filename);
+    for (int i = nb_evicted; i < keys_by_use.size(); ++i)
+    {
+        std::vector<float> const& measurements = entries[keys_by_use[i].second].measurements;
+
+        file << keys_by_use[i].second << " " << measurements.size();
+        for (float measure : measurements)
+            file << " " << measure;
+        file << "\n";
+    }
+
+    file.close();
+    rename(tmp_filename.c_str(), filename.c_str());
+}
+
+std::string evaluation_cache::get_stats_json() const
+{
+    return "{\"hits\" : " + std::to_string(nb_hits) + ", \"misses\" : " + std::to_string(nb_misses) + "}";
+}
+
 evaluate_by_execution::evaluate_by_execution(std::vector<tiramisu::buffer*> const& arguments, 
                                              std::string const& obj_filename, 
                                              std::string const& wrapper_cmd,
-                                             tiramisu::function *fct)
-    : evaluation_function(), fct(fct), obj_filename(obj_filename), wrapper_cmd(wrapper_cmd)
+                                             tiramisu::function *fct,
+                                             Halide::Target const& target)
+    : evaluation_function(), halide_target(target), fct(fct), obj_filename(obj_filename), wrapper_cmd(wrapper_cmd)
 {
-    // Set Halide compilation features
-    halide_target = Halide::get_host_target();
-    halide_target.set_features(halide_features);
-    
     // Set input and output buffers
     fct->set_arguments(arguments);
     for (auto const& buf : arguments)
@@ -35,26 +168,185 @@ evaluate_by_execution::evaluate_by_execution(std::vector<tiramisu::buffer*> cons
     }
 }
 
-float evaluate_by_execution::evaluate(syntax_tree& ast)
+Halide::Target evaluate_by_execution::get_host_halide_target()
+{
+    if (std::getenv("HL_TARGET") != nullptr)
+        return Halide::get_target_from_environment().with_feature(Halide::Target::LargeBuffers);
+
+    // On x86, Halide detects SSE4.1, AVX, AVX2, FMA, F16C and the AVX-512 variants with cpuid
+    Halide::Target target = Halide::get_host_target();
+
+#if defined(__aarch64__) && defined(__linux__)
+    // On ARM, NEON is always available, read the other extensions from the kernel
+    unsigned long hwcaps = getauxval(AT_HWCAP);
+    unsigned long hwcaps2 = getauxval(AT_HWCAP2);
+
+#ifdef HWCAP_ASIMDDP
+    if (hwcaps & HWCAP_ASIMDDP)
+        target.set_feature(Halide::Target::ARMDotProd);
+#endif
+
+#ifdef HWCAP_FPHP
+    if (hwcaps & HWCAP_FPHP)
+        target.set_feature(Halide::Target::ARMFp16);
+#endif
+
+#ifdef HWCAP_SVE
+    if (hwcaps & HWCAP_SVE)
+        target.set_feature(Halide::Target::SVE);
+#endif
+
+#ifdef HWCAP2_SVE2
+    if (hwcaps2 & HWCAP2_SVE2)
+        target.set_feature(Halide::Target::SVE2);
+#endif
+
+#ifdef PR_SVE_GET_VL
+    // Halide generates SVE code for the vector length of the machine
+    int sve_vl = prctl(PR_SVE_GET_VL);
+    if (target.has_feature(Halide::Target::SVE) && sve_vl > 0)
+        target.vector_bits = (sve_vl & PR_SVE_VL_LEN_MASK) * 8;
+#endif
+#endif
+
+#if defined(__riscv) && defined(__linux__) && defined(__riscv_vector)
+    // The V extension is the bit of the letter V in the ISA bits of AT_HWCAP
+    if (getauxval(AT_HWCAP) & (1UL << ('V' - 'A')))
+    {
+        unsigned long vlenb;
+        asm volatile ("csrr %0, vlenb" : "=r"(vlenb));
+
+        target.set_feature(Halide::Target::RVV);
+        target.vector_bits = vlenb * 8;
+    }
+#endif
+
+    target.set_feature(Halide::Target::LargeBuffers);
+
+    return target;
+}
+
+void evaluate_by_execution::gen_halide_stmt(syntax_tree& ast)
 {
     // Apply all the optimizations
     apply_optimizations(ast);
 
-    // Compile the program to an object file
+    // Generate the Halide statement of the program
     fct->lift_dist_comps();
     fct->gen_time_space_domain();
-    fct->gen_isl_ast();
-    fct->gen_halide_stmt();
-    
-    Halide::Module m = lower_halide_pipeline(fct->get_name(), halide_target, halide_arguments,
-                                             Halide::Internal::LoweredFunc::External,
-                                             fct->get_halide_stmt());
-                                             
-    m.compile(Halide::Outputs().object(obj_filename));
-    
+
+    // The isl AST and the Halide statement only depend on the schedule,
+    // reuse them if this schedule has already been lowered.
+    std::string signature = fct->get_schedules_signature();
+    auto it = lowering_memo.find(signature);
+
+    if (it != lowering_memo.end())
+        fct->halide_stmt = it->second;
+
+    else
+    {
+        fct->gen_isl_ast();
+        fct->gen_halide_stmt();
+
+        if (lowering_memo.size() >= DEFAULT_LOWERING_MEMO_SIZE)
+            lowering_memo.clear();
+
+        lowering_memo[signature] = fct->get_halide_stmt();
+    }
+}
+
+Halide::Module evaluate_by_execution::lower_to_halide_module(syntax_tree& ast)
+{
+    gen_halide_stmt(ast);
+
+    return lower_halide_stmt();
+}
+
+Halide::Module evaluate_by_execution::lower_halide_stmt() const
+{
+    std::set<std::string> streaming_buffers;
+    for (const auto &b : fct->get_buffers())
+        if (b.second->get_streaming_stores())
+            streaming_buffers.insert(b.first);
+
+    return lower_halide_pipeline(fct->get_name(), halide_target, halide_arguments,
+                                 Halide::Internal::LoweredFunc::External,
+                                 fct->get_halide_stmt(), streaming_buffers);
+}
+
+void evaluate_by_execution::compile_to_shared_library(syntax_tree& ast, std::string const& obj_filename)
+{
+    // Compile the program to an object file
+    gen_halide_stmt(ast);
+
+    std::map<Halide::OutputFileType, std::string> outputs = {{Halide::OutputFileType::object, obj_filename}};
+    std::string cache_key = object_cache_key(fct->get_name(), halide_target, halide_arguments,
+                                             {fct->get_halide_stmt()}, "evaluate_by_execution");
+
+    if (!fetch_from_object_cache(cache_key, outputs))
+    {
+        Halide::Module m = lower_halide_stmt();
+        m.compile(outputs);
+        store_in_object_cache(cache_key, outputs);
+    }
+
     // Turn the object file to a shared library
     std::string gcc_cmd = "g++ -shared -o " + obj_filename + ".so " + obj_filename;
     int status = system(gcc_cmd.c_str());
+}
+
+void evaluate_by_execution::save_program()
+{
+    nb_program_computations = fct->body.size();
+
+    program_expressions.clear();
+    for (tiramisu::computation *comp : fct->body)
+        program_expressions.push_back(comp->get_expr());
+
+    program_buffers.clear();
+    for (auto const& buf : fct->get_buffers())
+        program_buffers.insert(buf.first);
+}
+
+void evaluate_by_execution::restore_program()
+{
+    // The added computations and buffers are only removed from the program :
+    // the scheduling graph and the tags that refer to them are cleared by reset_schedules()
+    fct->truncate_computations(nb_program_computations);
+
+    for (auto it = fct->buffers_list.begin(); it != fct->buffers_list.end();)
+    {
+        if (program_buffers.count(it->first) == 0)
+            it = fct->buffers_list.erase(it);
+        else
+            ++it;
+    }
+
+    for (int i = 0; i < nb_program_computations; ++i)
+        fct->body[i]->set_expression(program_expressions[i]);
+
+    fct->nvcc_compiler.reset();
+    fct->iterator_to_kernel_map.clear();
+}
+
+std::string evaluate_by_execution::get_cache_id() const
+{
+    return halide_target.to_string() + ":" + wrapper_cmd;
+}
+
+float evaluate_by_execution::evaluate(syntax_tree& ast)
+{
+    std::vector<float> cached_measurements;
+    std::string cache_key;
+
+    if (cache != nullptr)
+    {
+        cache_key = evaluation_cache::get_key(ast, get_cache_id() + ":evaluate");
+        if (cache->lookup(cache_key, cached_measurements))
+            return cached_measurements[0];
+    }
+
+    compile_to_shared_library(ast, obj_filename);
     
     // Execute the wrapper and get execution time
     double exec_time = std::numeric_limits<double>::infinity();
@@ -65,65 +357,96 @@ float evaluate_by_execution::evaluate(syntax_tree& ast)
     
     // Remove all the optimizations
     fct->reset_schedules();
+
+    if (cache != nullptr)
+        cache->insert(cache_key, {(float)exec_time});
     
     return exec_time;
 }
 
-std::vector<float> evaluate_by_execution::get_measurements(syntax_tree& ast, bool exit_on_timeout, float timeout)
+int evaluate_by_execution::acquire_measurement_lock() const
 {
-    // Apply all the optimizations
-    apply_optimizations(ast);
+    if (measurement_lock_path.empty())
+        return -1;
 
-    // Compile the program to an object file
-    fct->lift_dist_comps();
-    fct->gen_time_space_domain();
-    fct->gen_isl_ast();
-    fct->gen_halide_stmt();
+    int lock_fd = open(measurement_lock_path.c_str(), O_CREAT | O_RDWR, 0666);
+    if (lock_fd != -1)
+        flock(lock_fd, LOCK_EX);
+
+    return lock_fd;
+}
+
+void evaluate_by_execution::release_measurement_lock(int lock_fd) const
+{
+    if (lock_fd == -1)
+        return;
 
-    Halide::Module m = lower_halide_pipeline(fct->get_name(), halide_target, halide_arguments,
-                                             Halide::Internal::LoweredFunc::External,
-                                             fct->get_halide_stmt());
+    flock(lock_fd, LOCK_UN);
+    close(lock_fd);
+}
 
-    m.compile(Halide::Outputs().object(obj_filename));
+std::vector<float> evaluate_by_execution::get_measurements(syntax_tree& ast, bool exit_on_timeout, float timeout)
+{
+    std::vector<float> cached_measurements;
+    std::string cache_key;
 
-    // Turn the object file to a shared library
-    std::string gcc_cmd = "g++ -shared -o " + obj_filename + ".so " + obj_filename;
-    int status = system(gcc_cmd.c_str());
+    if (cache != nullptr)
+    {
+        cache_key = get_measurements_cache_key(ast);
+        if (cache->lookup(cache_key, cached_measurements))
+            return cached_measurements;
+    }
+
+    // Compile the program to an object file
+    std::string worker_obj_filename = obj_filename + worker_suffix;
+    compile_to_shared_library(ast, worker_obj_filename);
+
+    // Only one worker at a time can time its schedule.
+    // The wrapper loads obj_filename.so, so the worker's library is moved there.
+    int lock_fd = acquire_measurement_lock();
+    if (!worker_suffix.empty())
+        rename((worker_obj_filename + ".so").c_str(), (obj_filename + ".so").c_str());
 
     // define the execution command of the wrapper
-    std::string cmd = wrapper_cmd;
+    std::string cmd = harness.get_pinning_cmd_prefix() + wrapper_cmd;
 
     float cumulative_timeout;
     if (timeout!=0) {// check if a timeout is defined for the execution time
-        int nb_exec = 30; //by default
-        if (std::getenv("MAX_RUNS")!=NULL)
-            nb_exec = std::stoi(std::getenv("MAX_RUNS"));
-        cumulative_timeout = timeout * nb_exec; // the timeout for the total number of executions
-        cmd = std::string("timeout ") + std::to_string(cumulative_timeout) + std::string(" ") + wrapper_cmd;
+        cumulative_timeout = timeout * harness.max_runs; // the timeout for the total number of executions
+        cmd = std::string("timeout ") + std::to_string(cumulative_timeout) + std::string(" ") + cmd;
     }
 
+    int returnCode = 0;
+    std::vector<float> measurements = harness.measure_batch([&]() {
+        // execute the command
+        FILE *pipe = popen(cmd.c_str(), "r");
+
+        // read the output into a string
+        char buf[100];
+        std::string output;
+        while (fgets(buf, 100, pipe))
+            output += buf;
+
+        // close the pipe and check if the timeout has been reached
+        returnCode = pclose(pipe)/256;
+
+        // parse the output into a vector of floats
+        std::vector<float> wrapper_measurements;
+        std::istringstream iss(output);
+        std::copy(std::istream_iterator<float>(iss), std::istream_iterator<float>(), std::back_inserter(wrapper_measurements));
 
-    // execute the command
-    FILE *pipe = popen(cmd.c_str(), "r");
+        return wrapper_measurements;
+    });
+    ast.energy = harness.last_energy;
+    ast.hardware_counters = harness.last_counters;
 
-    // read the output into a string
-    char buf[100];
-    std::string output;
-    while (fgets(buf, 100, pipe))
-        output += buf;
+    release_measurement_lock(lock_fd);
 
-    // close the pipe and check if the timeout has been reached
-    auto returnCode = pclose(pipe)/256;
     if (exit_on_timeout && (timeout!=0) && (returnCode == 124)){ // a potential issue here is that the 124 exit code is returned by another error
-        std::cerr << "error: Execution time exceeded the defined timeout "<< timeout << "s *"<< std::getenv("MAX_RUNS") << "execution" << std::endl;
+        std::cerr << "error: Execution time exceeded the defined timeout "<< timeout << "s *"<< harness.max_runs << "execution" << std::endl;
         exit(1);
     }
 
-    // parse the output into a vector of floats
-    std::vector<float> measurements;
-    std::istringstream iss(output);
-    std::copy(std::istream_iterator<float>(iss), std::istream_iterator<float>(), std::back_inserter(measurements));
-
     if (measurements.empty() && (returnCode != 124)) // if there is no output and the cmd didn't timeout, this means that the execution failed
         measurements.push_back(std::numeric_limits<float>::infinity());
 
@@ -136,12 +459,206 @@ std::vector<float> evaluate_by_execution::get_measurements(syntax_tree& ast, boo
     // Remove all the optimizations
     fct->reset_schedules();
 
+    if (cache != nullptr)
+        cache->insert(cache_key, measurements);
+
+    return measurements;
+}
+
+evaluate_by_cuda::evaluate_by_cuda(std::vector<tiramisu::buffer*> const& arguments,
+                                   std::string const& obj_filename,
+                                   std::string const& wrapper_cmd,
+                                   tiramisu::function *fct)
+    : evaluate_by_execution(arguments, obj_filename, wrapper_cmd, fct)
+{
+    // The CUDA libraries are next to the bin directory of nvcc
+    std::string nvcc_path = NVCC_PATH;
+    std::size_t bin_pos = nvcc_path.rfind("/bin/");
+    if (bin_pos != std::string::npos)
+        cuda_link_flags = " -L" + nvcc_path.substr(0, bin_pos) + "/lib64";
+
+    cuda_link_flags += " -lcudart";
+}
+
+void evaluate_by_cuda::compile_to_shared_library(syntax_tree& ast, std::string const& obj_filename)
+{
+    save_program();
+    apply_optimizations(ast);
+
+    // The CUDA code is generated from the isl AST, so the lowering memo is not used
+    fct->lift_dist_comps();
+    fct->gen_time_space_domain();
+    fct->gen_isl_ast();
+    fct->gen_cuda_stmt();
+    fct->gen_halide_stmt();
+
+    // Generates obj_filename, and the objects of the GPU code obj_filename_cpu.o and obj_filename_gpu.o
+    fct->gen_halide_obj(obj_filename);
+
+    restore_program();
+
+    // The schedules whose kernels spill registers are not executed: without the
+    // shared library, their execution fails and they are evaluated as infinitely slow
+    std::remove((obj_filename + ".so").c_str());
+    if (reject_spilling_kernels)
+        for (auto const& kernel : fct->get_gpu_kernel_resources())
+            if (kernel.spill_store_bytes > 0 || kernel.spill_load_bytes > 0)
+            {
+                std::cout << "The kernel " << kernel.name << " spills registers, the schedule is not executed" << std::endl;
+                return;
+            }
+
+    std::string gcc_cmd = "g++ -shared -o " + obj_filename + ".so " + obj_filename + " " +
+                          obj_filename + "_cpu.o " + obj_filename + "_gpu.o" + cuda_link_flags;
+    int status = system(gcc_cmd.c_str());
+}
+
+std::string evaluate_by_cuda::get_cache_id() const
+{
+    return (reject_spilling_kernels ? "cuda:" : "cuda_spilling:") + evaluate_by_execution::get_cache_id();
+}
+
+namespace
+{
+
+/**
+ * Fill a resident buffer with ones, so that floating point inputs
+ * do not contain NaNs or denormals that would bias the measurements.
+ */
+template <typename T>
+void fill_resident_buffer(Halide::Runtime::Buffer<>& buf)
+{
+    buf.as<T>().fill((T)1);
+}
+
+void init_resident_buffer(Halide::Runtime::Buffer<>& buf, tiramisu::primitive_t type)
+{
+    switch (type)
+    {
+        case p_uint8: fill_resident_buffer<uint8_t>(buf); break;
+        case p_uint16: fill_resident_buffer<uint16_t>(buf); break;
+        case p_uint32: fill_resident_buffer<uint32_t>(buf); break;
+        case p_uint64: fill_resident_buffer<uint64_t>(buf); break;
+        case p_int8: fill_resident_buffer<int8_t>(buf); break;
+        case p_int16: fill_resident_buffer<int16_t>(buf); break;
+        case p_int32: fill_resident_buffer<int32_t>(buf); break;
+        case p_int64: fill_resident_buffer<int64_t>(buf); break;
+        case p_float32: fill_resident_buffer<float>(buf); break;
+        case p_float64: fill_resident_buffer<double>(buf); break;
+        case p_float16: fill_resident_buffer<Halide::float16_t>(buf); break;
+        case p_bfloat16: fill_resident_buffer<Halide::bfloat16_t>(buf); break;
+        case p_boolean: fill_resident_buffer<bool>(buf); break;
+        default:
+            std::cerr << "error: evaluate_by_jit does not support this buffer type" << std::endl;
+            exit(1);
+    }
+}
+
+}
+
+evaluate_by_jit::evaluate_by_jit(std::vector<tiramisu::buffer*> const& arguments,
+                                 int nb_warmups,
+                                 tiramisu::function *fct,
+                                 Halide::Target const& target)
+    : evaluate_by_execution(arguments, "", "", fct, target)
+{
+    harness.nb_warmups = nb_warmups;
+
+    // The code is compiled in memory and linked against Halide's JIT runtime
+    halide_target = halide_target.with_feature(Halide::Target::JIT);
+
+    // Allocate the buffers once, they are shared by all the evaluations
+    for (tiramisu::buffer *buf : arguments)
+    {
+        if (!buf->has_constant_extents())
+        {
+            std::cerr << "error: evaluate_by_jit needs buffers with constant extents (" << buf->get_name() << ")" << std::endl;
+            exit(1);
+        }
+
+        // Tiramisu orders dimensions from the outermost to the innermost,
+        // Halide orders them from the innermost to the outermost.
+        std::vector<int> sizes;
+        for (auto it = buf->get_dim_sizes().rbegin(); it != buf->get_dim_sizes().rend(); ++it)
+            sizes.push_back((int)it->get_int_val());
+
+        resident_buffers.emplace_back(halide_type_from_tiramisu_type(buf->get_elements_type()), sizes);
+        init_resident_buffer(resident_buffers.back(), buf->get_elements_type());
+    }
+
+    for (Halide::Runtime::Buffer<>& buf : resident_buffers)
+        jit_args.push_back(buf.raw_buffer());
+}
+
+float evaluate_by_jit::evaluate(syntax_tree& ast)
+{
+    return min_eval(get_measurements(ast));
+}
+
+std::vector<float> evaluate_by_jit::get_measurements(syntax_tree& ast, bool exit_on_timeout, float timeout)
+{
+    std::vector<float> measurements;
+    std::string cache_key;
+
+    if (cache != nullptr)
+    {
+        cache_key = get_measurements_cache_key(ast);
+        if (cache->lookup(cache_key, measurements))
+            return measurements;
+    }
+
+    // the timeout for the total number of executions (in ms)
+    float cumulative_timeout = timeout * harness.max_runs * 1000;
+
+    try
+    {
+        Halide::Module m = lower_to_halide_module(ast);
+
+        Halide::Internal::JITModule jit_module(m, m.get_function_by_name(fct->get_name()));
+        auto argv_function = jit_module.argv_function();
+
+        // Only one worker at a time can time its schedule
+        int lock_fd = acquire_measurement_lock();
+
+        bool timed_out;
+        measurements = harness.measure([&]() { return argv_function(jit_args.data()); }, cumulative_timeout, timed_out);
+        ast.energy = harness.last_energy;
+        ast.hardware_counters = harness.last_counters;
+
+        release_measurement_lock(lock_fd);
+
+        if (exit_on_timeout && timeout != 0 && timed_out)
+        {
+            std::cerr << "error: Execution time exceeded the defined timeout "<< timeout << "s *"<< harness.max_runs << "execution" << std::endl;
+            exit(1);
+        }
+    }
+    catch (Halide::Error const& e)
+    {
+        std::cerr << "JIT evaluation failed : " << e.what() << std::endl;
+        measurements.clear();
+    }
+
+    // if there is no measurement, this means that the compilation or the execution failed
+    if (measurements.empty())
+        measurements.push_back(std::numeric_limits<float>::infinity());
+
+    // Remove all the optimizations
+    fct->reset_schedules();
+
+    if (cache != nullptr)
+        cache->insert(cache_key, measurements);
+
     return measurements;
 }
 
 evaluate_by_learning_model::evaluate_by_learning_model(std::string const& cmd_path, std::vector<std::string> const& cmd_args)
     : evaluation_function()
 {
+    model_cmd = cmd_path;
+    for (std::string const& arg : cmd_args)
+        model_cmd += " " + arg;
+
     // Create the pipe
     pid_t pid = 0;
     int inpipe_fd[2];
@@ -186,6 +703,16 @@ evaluate_by_learning_model::evaluate_by_learning_model(std::string const& cmd_pa
 
 float evaluate_by_learning_model::evaluate(syntax_tree& ast)
 {
+    std::vector<float> cached_prediction;
+    std::string cache_key;
+
+    if (cache != nullptr)
+    {
+        cache_key = evaluation_cache::get_key(ast, get_cache_id());
+        if (cache->lookup(cache_key, cached_prediction))
+            return -cached_prediction[0];
+    }
+
     // Get JSON representations for the program, and for the schedule
     std::string prog_json = get_program_json(ast);
     std::string sched_json = get_schedule_json(ast);
@@ -198,10 +725,114 @@ float evaluate_by_learning_model::evaluate(syntax_tree& ast)
     // Read the evaluation from model_read.
     float speedup = 0.f;
     fscanf(model_read, "%f", &speedup);
+
+    if (cache != nullptr)
+        cache->insert(cache_key, {speedup});
     
     return -speedup;
 }
 
+std::vector<float> evaluate_by_learning_model::evaluate_batch(std::vector<syntax_tree*> const& asts)
+{
+    std::vector<float> evaluations(asts.size());
+    std::vector<std::string> cache_keys(asts.size());
+    std::vector<int> to_evaluate;
+
+    // Only the schedules that are not in the cache are sent to the model
+    for (int i = 0; i < asts.size(); ++i)
+    {
+        std::vector<float> cached_prediction;
+        if (cache != nullptr)
+        {
+            cache_keys[i] = evaluation_cache::get_key(*asts[i], get_cache_id());
+            if (cache->lookup(cache_keys[i], cached_prediction))
+            {
+                evaluations[i] = -cached_prediction[0];
+                continue;
+            }
+        }
+
+        to_evaluate.push_back(i);
+    }
+
+    if (to_evaluate.empty())
+        return evaluations;
+
+    // Write the batch header, and then the program JSON and the schedule JSON of each schedule
+    std::string batch_header = "batch " + std::to_string(to_evaluate.size()) + "\n";
+    fputs(batch_header.c_str(), model_write);
+
+    for (int i : to_evaluate)
+    {
+        fputs(get_program_json(*asts[i]).c_str(), model_write);
+        fputs(get_schedule_json(*asts[i]).c_str(), model_write);
+    }
+    fflush(model_write);
+
+    // Read the evaluations from model_read, in the order of the batch
+    for (int i : to_evaluate)
+    {
+        float speedup = 0.f;
+        fscanf(model_read, "%f", &speedup);
+
+        if (cache != nullptr)
+            cache->insert(cache_keys[i], {speedup});
+
+        evaluations[i] = -speedup;
+    }
+
+    return evaluations;
+}
+
+std::vector<float> evaluate_by_learning_model::evaluate_json_batch(std::vector<std::pair<std::string, std::string>> const& schedules)
+{
+    std::vector<float> evaluations(schedules.size());
+    std::vector<std::string> cache_keys(schedules.size());
+    std::vector<int> to_evaluate;
+
+    for (int i = 0; i < schedules.size(); ++i)
+    {
+        std::vector<float> cached_prediction;
+        if (cache != nullptr)
+        {
+            cache_keys[i] = evaluation_cache::get_key(schedules[i].first, schedules[i].second, get_cache_id());
+            if (cache->lookup(cache_keys[i], cached_prediction))
+            {
+                evaluations[i] = -cached_prediction[0];
+                continue;
+            }
+        }
+
+        to_evaluate.push_back(i);
+    }
+
+    if (to_evaluate.empty())
+        return evaluations;
+
+    std::string batch_header = "batch " + std::to_string(to_evaluate.size()) + "\n";
+    fputs(batch_header.c_str(), model_write);
+
+    for (int i : to_evaluate)
+    {
+        fputs(schedules[i].first.c_str(), model_write);
+        fputs(schedules[i].second.c_str(), model_write);
+    }
+    fflush(model_write);
+
+    for (int i : to_evaluate)
+    {
+        float speedup = 0.f;
+        fscanf(model_read, "%f", &speedup);
+
+        if (cache != nullptr)
+            cache->insert(cache_keys[i], {speedup});
+
+        evaluations[i] = -speedup;
+    }
+
+    return evaluations;
+}
+
 std::string evaluate_by_learning_model::get_program_json(syntax_tree const& ast)
 {
     // Get the memory size allocated by the program, if declared
@@ -224,96 +855,128 @@ std::string evaluate_by_learning_model::get_program_json(syntax_tree const& ast)
     return "{" + mem_size_json + "," + iterators_json + "," + computations_json + "}\n";
 }
 
-void evaluate_by_learning_model::represent_computations_from_nodes(ast_node *node, std::string& computations_json, int& comp_absolute_order)
+/**
+ * Return the JSON of the given computation, without its absolute order.
+ */
+static std::string get_computation_json(computation_info const& comp_info)
 {
-    // Build the JSON for the computations stored in "node".
-    for (computation_info const& comp_info : node->computations)
+    std::string comp_json;
+
+    comp_json += "\"iterators\" : [";
+    
+    for (int i = 0; i < comp_info.iters->size(); ++i)
     {
-        std::string comp_json = "\"absolute_order\" : " + std::to_string(comp_absolute_order) + ","; 
-        comp_absolute_order++;
-        
-        comp_json += "\"iterators\" : [";
-        
-        for (int i = 0; i < comp_info.iters.size(); ++i)
-        {
-            comp_json += "\"" + comp_info.iters[i].name + "\"";
-            if (i != comp_info.iters.size() - 1)
-                comp_json += ",";
-        }
-        
-        comp_json += "],";
-        
+        comp_json += "\"" + (*comp_info.iters)[i].name + "\"";
+        if (i != comp_info.iters->size() - 1)
+            comp_json += ",";
+    }
+    
+    comp_json += "],";
+    
 //        comp_json += "\"real_dimensions\" : [";
 //
 //        for (int i = 0; i < comp_info.buffer_nb_dims; ++i)
 //        {
-//            comp_json += "\"" + comp_info.iters[i].name + "\"";
+//            comp_json += "\"" + (*comp_info.iters)[i].name + "\"";
 //            if (i != comp_info.buffer_nb_dims - 1)
 //                comp_json += ",";
 //        }
 //
 //        comp_json += "],";
+    
+    comp_json += "\"comp_is_reduction\" : ";
+    if (comp_info.is_reduction)
+        comp_json += "true,";
+    else
+        comp_json += "false,";
+
+    comp_json += "\"reduction_iterators\" : [";
+    for (int i = 0; i < comp_info.reduction_levels.size(); ++i)
+    {
+        comp_json += "\"" + (*comp_info.iters)[comp_info.reduction_levels[i]].name + "\"";
+        if (i != comp_info.reduction_levels.size() - 1)
+            comp_json += ",";
+    }
+
+    comp_json += "],";
+
+    comp_json += "\"comp_is_update\" : ";
+    if (comp_info.is_update)
+        comp_json += "true,";
+    else
+        comp_json += "false,";
+
+    comp_json += "\"definition_id\" : " + std::to_string(comp_info.definition_id) + ",";
+        
+    comp_json += "\"number_of_additions\" : " + std::to_string(comp_info.nb_additions) + ",";
+    comp_json += "\"number_of_subtraction\" : " + std::to_string(comp_info.nb_substractions) + ",";
+    comp_json += "\"number_of_multiplication\" : " + std::to_string(comp_info.nb_multiplications) + ",";
+    comp_json += "\"number_of_division\" : " + std::to_string(comp_info.nb_divisions) + ",";
+
+    comp_json += "\"write_access_relation\" : \"" +  comp_info.write_access_relation + "\",";
+    comp_json += "\"write_buffer_id\" : " +  std::to_string(comp_info.storage_buffer_id) + ",";
+    comp_json += "\"data_type\" : \"" +  comp_info.data_type_str + "\",";
+    comp_json += "\"data_type_size\" : " +  std::to_string(comp_info.data_type_size) + ",";
+    
+    // Build JSON for the accesses of this computation
+    comp_json += "\"accesses\" : [";
+
+    for (int i = 0; i < comp_info.accesses->accesses_list.size(); ++i)
+    {
+        dnn_access_matrix const& matrix  = comp_info.accesses->accesses_list[i];
         
-        comp_json += "\"comp_is_reduction\" : ";
-        if (comp_info.is_reduction)
+        comp_json += "{";
+        
+        comp_json += "\"access_is_reduction\" : ";
+        if (comp_info.storage_buffer_id==matrix.buffer_id)
             comp_json += "true,";
         else
             comp_json += "false,";
             
-        comp_json += "\"number_of_additions\" : " + std::to_string(comp_info.nb_additions) + ",";
-        comp_json += "\"number_of_subtraction\" : " + std::to_string(comp_info.nb_substractions) + ",";
-        comp_json += "\"number_of_multiplication\" : " + std::to_string(comp_info.nb_multiplications) + ",";
-        comp_json += "\"number_of_division\" : " + std::to_string(comp_info.nb_divisions) + ",";
-
-        comp_json += "\"write_access_relation\" : \"" +  comp_info.write_access_relation + "\",";
-        comp_json += "\"write_buffer_id\" : " +  std::to_string(comp_info.storage_buffer_id) + ",";
-        comp_json += "\"data_type\" : \"" +  comp_info.data_type_str + "\",";
-        comp_json += "\"data_type_size\" : " +  std::to_string(comp_info.data_type_size) + ",";
+        comp_json += "\"buffer_id\" : " + std::to_string(matrix.buffer_id) + ",";
+        comp_json += "\"access_matrix\" : [";
         
-        // Build JSON for the accesses of this computation
-        comp_json += "\"accesses\" : [";
-
-        for (int i = 0; i < comp_info.accesses.accesses_list.size(); ++i)
+        for (int x = 0; x < matrix.matrix.size(); ++x)
         {
-            dnn_access_matrix const& matrix  = comp_info.accesses.accesses_list[i];
-            
-            comp_json += "{";
-            
-            comp_json += "\"access_is_reduction\" : ";
-            if (comp_info.storage_buffer_id==matrix.buffer_id)
-                comp_json += "true,";
-            else
-                comp_json += "false,";
-                
-            comp_json += "\"buffer_id\" : " + std::to_string(matrix.buffer_id) + ",";
-            comp_json += "\"access_matrix\" : [";
-            
-            for (int x = 0; x < matrix.matrix.size(); ++x)
+            comp_json += "[";
+            for (int y = 0; y < matrix.matrix[x].size(); ++y)
             {
-                comp_json += "[";
-                for (int y = 0; y < matrix.matrix[x].size(); ++y)
-                {
-                    comp_json += std::to_string(matrix.matrix[x][y]);
-                    if (y != matrix.matrix[x].size() - 1)
-                        comp_json += ", ";
-                }
-                
-                comp_json += "]";
-                if (x != matrix.matrix.size() - 1)
-                    comp_json += ",";
+                comp_json += std::to_string(matrix.matrix[x][y]);
+                if (y != matrix.matrix[x].size() - 1)
+                    comp_json += ", ";
             }
             
             comp_json += "]";
-            
-            comp_json += "}";
-            
-            if (i != comp_info.accesses.accesses_list.size() - 1)
+            if (x != matrix.matrix.size() - 1)
                 comp_json += ",";
         }
         
         comp_json += "]";
+        
+        comp_json += "}";
+        
+        if (i != comp_info.accesses->accesses_list.size() - 1)
+            comp_json += ",";
+    }
     
-        computations_json += "\"" + comp_info.comp_ptr->get_name() + "\" : {" + comp_json + "},";
+    comp_json += "]";
+
+    return comp_json;
+}
+
+void evaluate_by_learning_model::represent_computations_from_nodes(ast_node *node, std::string& computations_json, int& comp_absolute_order)
+{
+    // Build the JSON for the computations stored in "node".
+    // The JSON of a computation is built once and shared by the copies of the AST.
+    for (computation_info const& comp_info : node->computations)
+    {
+        computation_encodings& encodings = *comp_info.encodings;
+        std::call_once(encodings.json_once, [&]() { encodings.json = get_computation_json(comp_info); });
+
+        std::string comp_json = "\"absolute_order\" : " + std::to_string(comp_absolute_order) + ",";
+        comp_absolute_order++;
+
+        computations_json += "\"" + get_computation_key(comp_info.comp_ptr) + "\" : {" + comp_json + encodings.json + "},";
     }
     
     // Recursively get JSON for the rest of computations
@@ -321,6 +984,14 @@ void evaluate_by_learning_model::represent_computations_from_nodes(ast_node *nod
         represent_computations_from_nodes(child, computations_json, comp_absolute_order);
 }
 
+std::string evaluate_by_learning_model::get_computation_key(tiramisu::computation *comp)
+{
+    if (comp->definition_ID == 0)
+        return comp->get_name();
+
+    return comp->get_name() + "_update_" + std::to_string(comp->definition_ID);
+}
+
 std::string evaluate_by_learning_model::get_schedule_json(syntax_tree const& ast)
 {
     bool interchanged = false;
@@ -328,6 +999,7 @@ std::string evaluate_by_learning_model::get_schedule_json(syntax_tree const& ast
     bool unrolled = false;
     bool skewed = false;
     bool parallelized = false;
+    bool vectorized = false;
     
     int unfuse_l0 = -1;
     int int_l0, int_l1;
@@ -337,6 +1009,7 @@ std::string evaluate_by_learning_model::get_schedule_json(syntax_tree const& ast
     int skewing_l0, skewing_l1;
     int skew_extent_l0, skew_extent_l1;
     int parallelized_level;
+    int vectorized_level, vectorization_fact;
     
     // Get information about the schedule
     for (optimization_info const& optim_info : ast.new_optims)
@@ -383,6 +1056,12 @@ std::string evaluate_by_learning_model::get_schedule_json(syntax_tree const& ast
                 parallelized_level = optim_info.l0;
                 break;
 
+            case optimization_type::VECTORIZATION:
+                vectorized = true;
+                vectorized_level = optim_info.l0;
+                vectorization_fact = optim_info.l0_fact;
+                break;
+
             case optimization_type::SKEWING:
                 skewed = true;
                 skewing_fact_l0 = optim_info.l0_fact;
@@ -499,6 +1178,19 @@ std::string evaluate_by_learning_model::get_schedule_json(syntax_tree const& ast
 
         }
 
+        // Vectorization tag : the vectorized loop level (after the other transformations are applied)
+        // and the vector length
+        comp_sched_json += "\"vectorization\" : ";
+        if (vectorized)
+        {
+            comp_sched_json += "{\"vectorized_level\" : " + std::to_string(vectorized_level) + ", ";
+            comp_sched_json += "\"vectorization_factor\" : " + std::to_string(vectorization_fact) + "},";
+        }
+        else
+        {
+            comp_sched_json += "null, ";
+        }
+
         // Skewing info
         comp_sched_json += "\"skewing\" : ";
         if (skewed)
@@ -516,7 +1208,7 @@ std::string evaluate_by_learning_model::get_schedule_json(syntax_tree const& ast
             {
                 if (comp_i.comp_ptr == comp)
                 {
-                    comp_accesses_list = comp_i.accesses.accesses_list;
+                    comp_accesses_list = comp_i.accesses->accesses_list;
                     break;
                 }
             }
@@ -563,7 +1255,7 @@ std::string evaluate_by_learning_model::get_schedule_json(syntax_tree const& ast
             comp_sched_json += "null";
         }
         
-        sched_json += "\"" + comp->get_name() + "\" : {" + comp_sched_json + "},";
+        sched_json += "\"" + get_computation_key(comp) + "\" : {" + comp_sched_json + "},";
     }
     
     // Write JSON information about unfused iterators (not specific to a computation)
@@ -583,6 +1275,119 @@ std::string evaluate_by_learning_model::get_schedule_json(syntax_tree const& ast
     return sched_json;
 }
 
+namespace
+{
+
+/**
+ * Append the features of the computations of the given subtree (in absolute order).
+ */
+void append_computations_features(ast_node *node, std::vector<float>& features, int& nb_computations)
+{
+    for (computation_info const& comp_info : node->computations)
+    {
+        nb_computations++;
+
+        // The features of a computation are built once and shared by the copies of the AST
+        computation_encodings& encodings = *comp_info.encodings;
+        std::call_once(encodings.features_once, [&]() {
+            std::vector<float>& encoding = encodings.features;
+            encoding.push_back(comp_info.iters->size());
+            for (dnn_iterator const& it : *comp_info.iters)
+            {
+                encoding.push_back(it.low_bound);
+                encoding.push_back(it.up_bound);
+            }
+
+            encoding.push_back(comp_info.is_reduction);
+            encoding.push_back(comp_info.nb_additions);
+            encoding.push_back(comp_info.nb_substractions);
+            encoding.push_back(comp_info.nb_multiplications);
+            encoding.push_back(comp_info.nb_divisions);
+            encoding.push_back(comp_info.storage_buffer_id);
+            encoding.push_back(comp_info.data_type_size);
+
+            encoding.push_back(comp_info.accesses->accesses_list.size());
+            for (dnn_access_matrix const& matrix : comp_info.accesses->accesses_list)
+            {
+                encoding.push_back(matrix.buffer_id);
+                encoding.push_back(matrix.matrix.size());
+                encoding.push_back(matrix.matrix.empty() ? 0 : matrix.matrix[0].size());
+
+                for (std::vector<int> const& row : matrix.matrix)
+                    for (int coeff : row)
+                        encoding.push_back(coeff);
+            }
+        });
+
+        features.insert(features.end(), encodings.features.begin(), encodings.features.end());
+    }
+
+    for (ast_node *child : node->children)
+        append_computations_features(child, features, nb_computations);
+}
+
+/**
+ * Append the features of the loop levels of the given subtree (in depth-first order).
+ */
+void append_loops_features(ast_node *node, std::vector<float>& features, int& nb_loops)
+{
+    nb_loops++;
+
+    features.push_back(node->depth);
+    features.push_back(node->low_bound);
+    features.push_back(node->up_bound);
+    features.push_back(node->children.size());
+    features.push_back(node->computations.size());
+
+    for (ast_node *child : node->children)
+        append_loops_features(child, features, nb_loops);
+}
+
+}
+
+void evaluate_by_learning_model::get_program_features(syntax_tree const& ast, std::vector<float>& features)
+{
+    // The counters are written first, so their position is reserved
+    int nb_computations = 0;
+    int nb_computations_pos = features.size();
+    features.push_back(0);
+
+    for (ast_node *node : ast.roots)
+        append_computations_features(node, features, nb_computations);
+
+    features[nb_computations_pos] = nb_computations;
+
+    int nb_loops = 0;
+    int nb_loops_pos = features.size();
+    features.push_back(0);
+
+    for (ast_node *node : ast.roots)
+        append_loops_features(node, features, nb_loops);
+
+    features[nb_loops_pos] = nb_loops;
+}
+
+void evaluate_by_learning_model::get_schedule_features(syntax_tree const& ast, std::vector<float>& features)
+{
+    features.push_back(ast.previous_optims.size() + ast.new_optims.size());
+
+    for (auto const* optims_list : {&ast.previous_optims, &ast.new_optims})
+    {
+        for (optimization_info const& optim_info : *optims_list)
+        {
+            features.push_back(optim_info.type);
+            features.push_back(optim_info.nb_l);
+            features.push_back(optim_info.l0);
+            features.push_back(optim_info.l1);
+            features.push_back(optim_info.l2);
+            features.push_back(optim_info.l0_fact);
+            features.push_back(optim_info.l1_fact);
+            features.push_back(optim_info.l2_fact);
+            features.push_back(optim_info.l3_fact);
+        }
+    }
+}
+
 // ------------------------------------------------------------------------------------------ //
 
 void evaluate_by_learning_model::represent_iterators_from_nodes(ast_node *node, std::string& iterators_json)
@@ -595,6 +1400,12 @@ void evaluate_by_learning_model::represent_iterators_from_nodes(ast_node *node,
     // Represent basic information about this iterator
     iter_json += "\"lower_bound\" : " + std::to_string(node->low_bound) + ",";
     iter_json += "\"upper_bound\" : " + std::to_string(node->up_bound + 1) + ",";
+
+    iter_json += "\"constant_bounds\" : ";
+    if (node->constant_bounds)
+        iter_json += "true,";
+    else
+        iter_json += "false,";
         
     iter_json += "\"parent_iterator\" : ";
     if (node->parent == nullptr)
@@ -624,7 +1435,7 @@ void evaluate_by_learning_model::represent_iterators_from_nodes(ast_node *node,
     
     for (int i = 0; i < node->computations.size(); ++i)
     {
-        iter_json += "\"" + node->computations[i].comp_ptr->get_name() + "\",";
+        iter_json += "\"" + get_computation_key(node->computations[i].comp_ptr) + "\",";
         has_computations = true;
     }
     
@@ -636,7 +1447,7 @@ void evaluate_by_learning_model::represent_iterators_from_nodes(ast_node *node,
         ast_node *dummy_child = node->children[i];
         for (int j = 0; j < dummy_child->computations.size(); ++j)
         {
-            iter_json += "\"" + dummy_child->computations[j].comp_ptr->get_name() + "\",";
+            iter_json += "\"" + get_computation_key(dummy_child->computations[j].comp_ptr) + "\",";
             has_computations = true;
         }
     }
@@ -671,7 +1482,7 @@ std::string evaluate_by_learning_model::get_tree_structure_json(ast_node *node)
     
     std::vector<std::string> comps_list;
     for (computation_info const& comp_info : node->computations)
-        comps_list.push_back(comp_info.comp_ptr->get_name());
+        comps_list.push_back(get_computation_key(comp_info.comp_ptr));
         
     for (ast_node *child : node->children)
     {
@@ -679,7 +1490,7 @@ std::string evaluate_by_learning_model::get_tree_structure_json(ast_node *node)
             continue;
             
         for (int j = 0; j < child->computations.size(); ++j)
-            comps_list.push_back(child->computations[j].comp_ptr->get_name());
+            comps_list.push_back(get_computation_key(child->computations[j].comp_ptr));
     }
     
     for (std::string comp_name : comps_list)
@@ -711,4 +1522,253 @@ std::string evaluate_by_learning_model::get_tree_structure_json(ast_node *node)
     return json;
 }
 
+evaluate_distributed::evaluate_distributed(evaluation_function *compute_eval, float message_latency,
+                                           float network_bandwidth, float reference_time, tiramisu::function *fct)
+    : compute_eval(compute_eval), fct(fct), message_latency(message_latency),
+      network_bandwidth(network_bandwidth), reference_time(reference_time)
+{
+}
+
+float evaluate_distributed::get_computation_time(float evaluation) const
+{
+    if (evaluation >= 0)
+        return evaluation;
+
+    return reference_time / -evaluation;
+}
+
+float evaluate_distributed::get_communication_time(syntax_tree const& ast, optimization_info const& distribution)
+{
+    auto it = communication_times.find(distribution.l0_fact);
+    if (it != communication_times.end())
+        return it->second;
+
+    // Distribute the computations to get the sets exchanged by the ranks
+    fct->reset_schedules();
+    apply_optimizations(distribution);
+    apply_distribution(ast, false);
+    fct->gen_time_space_domain();
+
+    int nb_messages = 0;
+    int64_t nb_bytes = 0;
+
+    for (tiramisu::computation *comp : distribution.comps)
+    {
+        int comp_nb_messages;
+        int64_t comp_nb_bytes;
+        comp->get_communication_volume(comp_nb_messages, comp_nb_bytes);
+
+        nb_messages += comp_nb_messages;
+        nb_bytes += comp_nb_bytes;
+    }
+
+    fct->reset_schedules();
+
+    float communication_time = nb_messages * message_latency + nb_bytes / network_bandwidth;
+    communication_times[distribution.l0_fact] = communication_time;
+
+    return communication_time;
+}
+
+float evaluate_distributed::get_distributed_time(syntax_tree const& ast, float evaluation)
+{
+    float computation_time = get_computation_time(evaluation);
+
+    optimization_info distribution;
+    if (!get_distribution(ast, distribution))
+        return computation_time;
+
+    return computation_time / distribution.l0_fact + get_communication_time(ast, distribution);
+}
+
+float evaluate_distributed::evaluate(syntax_tree& ast)
+{
+    return get_distributed_time(ast, compute_eval->evaluate(ast));
+}
+
+std::vector<float> evaluate_distributed::evaluate_batch(std::vector<syntax_tree*> const& asts)
+{
+    std::vector<float> evaluations = compute_eval->evaluate_batch(asts);
+
+    for (int i = 0; i < asts.size(); ++i)
+        evaluations[i] = get_distributed_time(*asts[i], evaluations[i]);
+
+    return evaluations;
+}
+
+std::string evaluate_distributed::get_cache_id() const
+{
+    return compute_eval->get_cache_id() + ":distributed:" + std::to_string(message_latency) + ":" +
+           std::to_string(network_bandwidth) + ":" + std::to_string(reference_time);
+}
+
+
+evaluate_hybrid::evaluate_hybrid(std::vector<evaluation_function*> const& models, evaluate_by_execution *exec_eval,
+                                 int nb_executed_best, int nb_executed_uncertain, float uncertainty_threshold,
+                                 float reference_time, std::string const& log_filename)
+    : models(models), exec_eval(exec_eval), nb_executed_best(nb_executed_best),
+      nb_executed_uncertain(nb_executed_uncertain), uncertainty_threshold(uncertainty_threshold),
+      reference_time(reference_time), log_filename(log_filename)
+{
+}
+
+float evaluate_hybrid::get_reference_time(std::vector<syntax_tree*> const& asts)
+{
+    if (reference_time > 0)
+        return reference_time;
+
+    reference_time = std::atof(read_env_var("INIT_EXEC_TIME"));
+    if (reference_time > 0)
+        return reference_time;
+
+    // Execute the initial program if it is evaluated
+    reference_time = 0;
+    for (syntax_tree *ast : asts)
+        if (ast->get_schedule().empty())
+        {
+            float exec_time = exec_eval->evaluate(*ast);
+            if (!std::isinf(exec_time))
+                reference_time = exec_time;
+
+            break;
+        }
+
+    return reference_time;
+}
+
+void evaluate_hybrid::log_execution(syntax_tree const& ast, float predicted_speedup, float uncertainty,
+                                    float measured_speedup, float exec_time) const
+{
+    if (log_filename.empty())
+        return;
+
+    std::string prog_json = evaluate_by_learning_model::get_program_json(ast);
+    std::string sched_json = evaluate_by_learning_model::get_schedule_json(ast);
+
+    // One line per schedule
+    std::replace(prog_json.begin(), prog_json.end(), '\n', ' ');
+    std::replace(sched_json.begin(), sched_json.end(), '\n', ' ');
+
+    std::ofstream log(log_filename, std::ios::app);
+    log << "{\"program\" : " << prog_json << ", \"schedule\" : " << sched_json
+        << ", \"predicted_speedup\" : " << predicted_speedup << ", \"uncertainty\" : " << uncertainty
+        << ", \"measured_speedup\" : " << measured_speedup << ", \"execution_time\" : " << exec_time << "}\n";
+}
+
+float evaluate_hybrid::evaluate(syntax_tree& ast)
+{
+    return evaluate_batch({&ast})[0];
+}
+
+std::vector<float> evaluate_hybrid::evaluate_batch(std::vector<syntax_tree*> const& asts)
+{
+    std::vector<float> evaluations(asts.size());
+    std::vector<std::string> cache_keys(asts.size());
+    std::vector<syntax_tree*> to_evaluate;
+    std::vector<int> indices;
+
+    // The schedules already executed are in the cache
+    for (int i = 0; i < asts.size(); ++i)
+    {
+        std::vector<float> cached_speedup;
+        if (cache != nullptr)
+        {
+            cache_keys[i] = evaluation_cache::get_key(*asts[i], get_cache_id());
+            if (cache->lookup(cache_keys[i], cached_speedup))
+            {
+                evaluations[i] = -cached_speedup[0];
+                continue;
+            }
+        }
+
+        to_evaluate.push_back(asts[i]);
+        indices.push_back(i);
+    }
+
+    if (to_evaluate.empty())
+        return evaluations;
+
+    int n = to_evaluate.size();
+    std::vector<float> means(n, 0.f), uncertainties(n, 0.f);
+    std::vector<std::vector<float>> speedups;
+
+    for (evaluation_function *model : models)
+    {
+        std::vector<float> model_evaluations = model->evaluate_batch(to_evaluate);
+        for (float& evaluation : model_evaluations)
+            evaluation = -evaluation;
+
+        speedups.push_back(model_evaluations);
+    }
+
+    for (int k = 0; k < n; ++k)
+    {
+        for (std::vector<float> const& model_speedups : speedups)
+            means[k] += model_speedups[k] / speedups.size();
+
+        float variance = 0.f;
+        for (std::vector<float> const& model_speedups : speedups)
+            variance += (model_speedups[k] - means[k]) * (model_speedups[k] - means[k]) / speedups.size();
+
+        uncertainties[k] = (means[k] > 0) ? std::sqrt(variance) / means[k] : 0.f;
+        evaluations[indices[k]] = -means[k];
+    }
+
+    nb_predicted += n;
+
+    if (exec_eval == nullptr || get_reference_time(to_evaluate) <= 0)
+        return evaluations;
+
+    // Select the best predicted schedules, then the most uncertain ones
+    std::vector<int> order(n);
+    for (int k = 0; k < n; ++k)
+        order[k] = k;
+
+    std::vector<bool> selected(n, false);
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return means[a] > means[b]; });
+    for (int k = 0; k < n && k < nb_executed_best; ++k)
+        selected[order[k]] = true;
+
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return uncertainties[a] > uncertainties[b]; });
+    for (int k = 0, nb_uncertain = 0; k < n && nb_uncertain < nb_executed_uncertain; ++k)
+    {
+        if (uncertainties[order[k]] <= uncertainty_threshold)
+            break;
+
+        if (!selected[order[k]])
+        {
+            selected[order[k]] = true;
+            nb_uncertain++;
+        }
+    }
+
+    for (int k = 0; k < n; ++k)
+    {
+        if (!selected[k])
+            continue;
+
+        float exec_time = exec_eval->evaluate(*to_evaluate[k]);
+        float measured_speedup = std::isinf(exec_time) ? 0.f : reference_time / exec_time;
+
+        log_execution(*to_evaluate[k], means[k], uncertainties[k], measured_speedup, exec_time);
+
+        if (cache != nullptr)
+            cache->insert(cache_keys[indices[k]], {measured_speedup});
+
+        evaluations[indices[k]] = -measured_speedup;
+        nb_executed++;
+    }
+
+    return evaluations;
+}
+
+std::string evaluate_hybrid::get_cache_id() const
+{
+    std::string id = "hybrid:";
+    for (evaluation_function *model : models)
+        id += model->get_cache_id() + ":";
+
+    return id + (exec_eval != nullptr ? exec_eval->get_cache_id() : "");
+}
+
 }
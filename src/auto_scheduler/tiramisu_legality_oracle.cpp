@@ -0,0 +1,693 @@
+#include <tiramisu/auto_scheduler/legality_oracle.h>
+
+#include <isl/map.h>
+#include <isl/point.h>
+#include <isl/set.h>
+#include <isl/union_map.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+namespace tiramisu::auto_scheduler
+{
+
+static std::atomic<int> next_oracle_id(0);
+
+/**
+ * The isl context of a thread, and the distance sets parsed in it.
+ */
+struct thread_isl_context
+{
+    isl_ctx *ctx = isl_ctx_alloc();
+    std::unordered_map<std::string, isl_set*> distances;
+
+    ~thread_isl_context()
+    {
+        for (auto& d : distances)
+            isl_set_free(d.second);
+
+        isl_ctx_free(ctx);
+    }
+};
+
+static thread_local thread_isl_context thread_context;
+
+/**
+ * Return "[d0, d1, ...]" with n dimensions.
+ */
+static std::string dims_str(int n)
+{
+    std::string str = "[";
+    for (int i = 0; i < n; ++i)
+        str += ((i > 0) ? ", d" : "d") + std::to_string(i);
+
+    return str + "]";
+}
+
+/**
+ * Return the conditions "d0 = 0 and ... and d(n-1) = 0", or "" if n is 0.
+ */
+static std::string zero_prefix_str(int n)
+{
+    std::string str;
+    for (int i = 0; i < n; ++i)
+        str += ((i > 0) ? " and d" : "d") + std::to_string(i) + " = 0";
+
+    return str;
+}
+
+/**
+ * Return true if no distance of the set is in the set described by conditions.
+ * The distances are not freed.
+ */
+static bool has_no_distance_in(isl_set *distances, int depth, std::string const& conditions)
+{
+    std::string str = "{ " + dims_str(depth) + " : " + conditions + " }";
+    isl_set *violations = isl_set_read_from_str(thread_context.ctx, str.c_str());
+
+    violations = isl_set_intersect(violations, isl_set_copy(distances));
+    bool empty = isl_set_is_empty(violations) == isl_bool_true;
+    isl_set_free(violations);
+
+    return empty;
+}
+
+/**
+ * Apply the matrix T to the distances (which are not freed).
+ */
+static isl_set *transform_distances(isl_set *distances, std::vector<std::vector<long>> const& T)
+{
+    int depth = T.size();
+    std::string str = "{ " + dims_str(depth) + " -> [";
+
+    for (int i = 0; i < depth; ++i)
+    {
+        str += (i > 0) ? ", " : "";
+        str += "0";
+        for (int j = 0; j < depth; ++j)
+            if (T[i][j] != 0)
+                str += " + " + std::to_string(T[i][j]) + "*d" + std::to_string(j);
+    }
+    str += "] }";
+
+    isl_map *transformation = isl_map_read_from_str(thread_context.ctx, str.c_str());
+    return isl_set_apply(isl_set_copy(distances), transformation);
+}
+
+/**
+ * Compute the second row (gamma, sigma) of the skewing of factors (f_i, f_j),
+ * like computation::skew(int, int, int, int).  Return false if the skewing is not valid.
+ */
+static bool get_skewing_factors(int f_i, int f_j, long& a, long& b, long& gamma, long& sigma)
+{
+    if (f_j == 0 || f_i <= 0)
+        return false;
+
+    int n1 = std::abs(f_i), n2 = std::abs(f_j);
+    while (n1 != n2)
+    {
+        if (n1 > n2)
+            n1 -= n2;
+        else
+            n2 -= n1;
+    }
+
+    a = f_i / n1;
+    b = f_j / n1;
+    gamma = 0;
+    sigma = 1;
+
+    if (b == 1 || a == 1)
+        gamma = a - 1;
+
+    else if (b == -1 && a > 1)
+    {
+        gamma = 1;
+        sigma = 0;
+    }
+
+    else
+    {
+        bool found = false;
+        for (int i = 0; i < 100 && !found; ++i)
+        {
+            if ((sigma * a) % std::abs(b) == 1)
+                found = true;
+            else
+                sigma++;
+        }
+
+        if (!found)
+            return false;
+
+        gamma = (sigma * a - 1) / b;
+    }
+
+    return true;
+}
+
+/**
+ * Multiply the transformation matrix T by the matrix of optim, an INTERCHANGE,
+ * a SKEWING, a SKEWING_POSITIVE or a UNIMODULAR.  Return false if the
+ * transformation is not valid.
+ */
+static bool update_transformation_matrix(optimization_info const& optim, std::vector<std::vector<long>>& T)
+{
+    int depth = T.size();
+
+    switch (optim.type)
+    {
+        case optimization_type::INTERCHANGE:
+            if (optim.l0 < 0 || optim.l1 < 0 || optim.l0 >= depth || optim.l1 >= depth)
+                return false;
+
+            std::swap(T[optim.l0], T[optim.l1]);
+            return true;
+
+        case optimization_type::SKEWING:
+        case optimization_type::SKEWING_POSITIVE:
+        {
+            long a = optim.l0_fact, b = optim.l1_fact, gamma = optim.l2_fact, sigma = optim.l3_fact;
+
+            if (optim.l0 < 0 || optim.l0 + 1 != optim.l1 || optim.l1 >= depth)
+                return false;
+            else if (optim.type == optimization_type::SKEWING)
+            {
+                if (!get_skewing_factors(optim.l0_fact, optim.l1_fact, a, b, gamma, sigma))
+                    return false;
+            }
+            else if (std::abs(a * sigma - gamma * b) != 1)
+                return false;
+
+            std::vector<long> row0 = T[optim.l0], row1 = T[optim.l1];
+            for (int j = 0; j < depth; ++j)
+            {
+                T[optim.l0][j] = a * row0[j] + b * row1[j];
+                T[optim.l1][j] = gamma * row0[j] + sigma * row1[j];
+            }
+            return true;
+        }
+
+        case optimization_type::UNIMODULAR:
+        {
+            int n = optim.matrix.size();
+            if (optim.l0 < 0 || n == 0 || optim.l0 + n > depth)
+                return false;
+
+            std::vector<std::vector<long>> rows(T.begin() + optim.l0, T.begin() + optim.l0 + n);
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < depth; ++j)
+                {
+                    T[optim.l0 + i][j] = 0;
+                    for (int k = 0; k < n; ++k)
+                        T[optim.l0 + i][j] += optim.matrix[i][k] * rows[k][j];
+                }
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+legality_oracle::legality_oracle(tiramisu::function *fct) : id(next_oracle_id++)
+{
+    if (fct->dep_read_after_write == NULL)
+        ERROR("perform_full_dependency_analysis() must be called before creating a legality_oracle.", true);
+
+    for (tiramisu::computation *comp : fct->get_computations())
+        depths[comp->get_name()] = isl_set_dim(comp->get_iteration_domain(), isl_dim_set);
+
+    // The dependences from a computation to another, as in check_legality_for_function()
+    isl_union_map *deps = isl_union_map_range_factor_domain(isl_union_map_copy(fct->dep_read_after_write));
+    deps = isl_union_map_union(deps, isl_union_map_range_factor_domain(isl_union_map_copy(fct->dep_write_after_read)));
+    deps = isl_union_map_union(deps, isl_union_map_range_factor_domain(isl_union_map_copy(fct->dep_write_after_write)));
+
+    std::vector<isl_map*> deps_list;
+    isl_union_map_foreach_map(deps, [](isl_map *dep, void *user) {
+        ((std::vector<isl_map*>*)user)->push_back(dep);
+        return isl_stat_ok;
+    }, &deps_list);
+    isl_union_map_free(deps);
+
+    std::map<std::pair<std::string, std::string>, isl_set*> distance_sets;
+    for (isl_map *dep : deps_list)
+    {
+        std::pair<std::string, std::string> key(isl_map_get_tuple_name(dep, isl_dim_in),
+                                                isl_map_get_tuple_name(dep, isl_dim_out));
+
+        // Keep the shared loop levels
+        int dims_in = isl_map_dim(dep, isl_dim_in), dims_out = isl_map_dim(dep, isl_dim_out);
+        int depth = std::min(dims_in, dims_out);
+
+        dep = isl_map_project_out(dep, isl_dim_in, depth, dims_in - depth);
+        dep = isl_map_project_out(dep, isl_dim_out, depth, dims_out - depth);
+        dep = isl_map_reset_tuple_id(dep, isl_dim_in);
+        dep = isl_map_reset_tuple_id(dep, isl_dim_out);
+
+        isl_set *delta = isl_map_deltas(dep);
+
+        auto it = distance_sets.find(key);
+        if (it == distance_sets.end())
+            distance_sets[key] = delta;
+        else
+            it->second = isl_set_union(it->second, delta);
+    }
+
+    for (auto& d : distance_sets)
+    {
+        char *str = isl_set_to_str(d.second);
+        distances[d.first] = str;
+
+        free(str);
+        isl_set_free(d.second);
+    }
+}
+
+isl_set* legality_oracle::get_distances(std::vector<std::string> const& comps, int depth) const
+{
+    std::string key = std::to_string(id) + ":" + std::to_string(depth);
+    for (std::string const& name : comps)
+        key += ":" + name;
+
+    auto cached = thread_context.distances.find(key);
+    if (cached != thread_context.distances.end())
+        return isl_set_copy(cached->second);
+
+    std::string empty = "{ " + dims_str(depth) + " : 1 = 0 }";
+    isl_set *result = isl_set_read_from_str(thread_context.ctx, empty.c_str());
+
+    for (std::string const& source : comps)
+        for (std::string const& sink : comps)
+        {
+            auto it = distances.find({source, sink});
+            if (it == distances.end())
+                continue;
+
+            isl_set *pair_distances = isl_set_read_from_str(thread_context.ctx, it->second.c_str());
+            int pair_depth = isl_set_dim(pair_distances, isl_dim_set);
+            pair_distances = isl_set_project_out(pair_distances, isl_dim_set, depth, pair_depth - depth);
+
+            result = isl_set_union(result, pair_distances);
+        }
+
+    result = isl_set_coalesce(result);
+    thread_context.distances[key] = result;
+
+    return isl_set_copy(result);
+}
+
+bool legality_oracle::is_legal(std::vector<optimization_info> const& transformations) const
+{
+    if (transformations.empty())
+        return true;
+
+    std::vector<std::string> comps;
+    for (tiramisu::computation *comp : transformations[0].comps)
+        comps.push_back(comp->get_name());
+
+    std::sort(comps.begin(), comps.end());
+    comps.erase(std::unique(comps.begin(), comps.end()), comps.end());
+
+    // The levels shared by all the computations
+    int depth = std::numeric_limits<int>::max();
+    for (std::string const& name : comps)
+    {
+        auto it = depths.find(name);
+        if (it == depths.end())
+            return false;
+
+        depth = std::min(depth, it->second);
+    }
+
+    if (comps.empty() || depth == 0)
+        return false;
+
+    isl_set *distances = get_distances(comps, depth);
+
+    // The transformation matrix of the sequence
+    std::vector<std::vector<long>> T(depth, std::vector<long>(depth, 0));
+    for (int i = 0; i < depth; ++i)
+        T[i][i] = 1;
+
+    isl_set *transformed = isl_set_copy(distances);
+    bool legal = true;
+
+    for (optimization_info const& optim : transformations)
+    {
+        bool changes_matrix = false;
+
+        switch (optim.type)
+        {
+            case optimization_type::INTERCHANGE:
+            case optimization_type::SKEWING:
+            case optimization_type::SKEWING_POSITIVE:
+            case optimization_type::UNIMODULAR:
+                legal = update_transformation_matrix(optim, T);
+                changes_matrix = true;
+                break;
+
+            case optimization_type::TILING:
+            {
+                // The tiled band must be fully permutable
+                if (optim.l0 < 0 || optim.l0 + optim.nb_l > depth)
+                {
+                    legal = false;
+                    break;
+                }
+
+                std::string negative;
+                for (int l = optim.l0; l < optim.l0 + optim.nb_l; ++l)
+                    negative += ((l > optim.l0) ? " or d" : "d") + std::to_string(l) + " < 0";
+
+                std::string prefix = zero_prefix_str(optim.l0);
+                legal = has_no_distance_in(transformed, depth, (prefix.empty() ? "" : prefix + " and ") + "(" + negative + ")");
+                break;
+            }
+
+            case optimization_type::PARALLELIZE:
+            case optimization_type::VECTORIZATION:
+            {
+                // No dependence may be carried by the level (by the two levels of a collapsed parallelization)
+                int nb_levels = (optim.type == optimization_type::PARALLELIZE && optim.nb_l == 2) ? 2 : 1;
+                if (optim.l0 < 0 || optim.l0 + nb_levels > depth)
+                {
+                    legal = false;
+                    break;
+                }
+
+                std::string carried;
+                for (int l = optim.l0; l < optim.l0 + nb_levels; ++l)
+                    carried += ((l > optim.l0) ? " or d" : "d") + std::to_string(l) + " < 0 or d" + std::to_string(l) + " > 0";
+
+                std::string prefix = zero_prefix_str(optim.l0);
+                legal = has_no_distance_in(transformed, depth, (prefix.empty() ? "" : prefix + " and ") + "(" + carried + ")");
+                break;
+            }
+
+            case optimization_type::UNROLLING:
+                break;
+
+            default:
+                legal = false;
+        }
+
+        if (!legal)
+            break;
+
+        if (changes_matrix)
+        {
+            isl_set_free(transformed);
+            transformed = transform_distances(distances, T);
+        }
+    }
+
+    // The transformed distances must stay lexicographically non negative
+    if (legal)
+    {
+        std::string negative;
+        for (int l = 0; l < depth; ++l)
+        {
+            std::string prefix = zero_prefix_str(l);
+            negative += ((l > 0) ? " or (" : "(") + (prefix.empty() ? "" : prefix + " and ") + "d" + std::to_string(l) + " < 0)";
+        }
+
+        legal = has_no_distance_in(transformed, depth, negative);
+    }
+
+    isl_set_free(transformed);
+    isl_set_free(distances);
+
+    return legal;
+}
+
+std::vector<bool> legality_oracle::is_legal_batch(std::vector<std::vector<optimization_info>> const& sequences,
+                                                  int nb_threads) const
+{
+    if (nb_threads <= 0)
+        nb_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Not a vector<bool>, whose elements cannot be written concurrently
+    std::vector<char> results(sequences.size());
+    std::atomic<size_t> next(0);
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < sequences.size(); i = next++)
+            results[i] = is_legal(sequences[i]);
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < nb_threads && t < sequences.size(); ++t)
+        threads.emplace_back(worker);
+
+    worker();
+
+    for (std::thread& t : threads)
+        t.join();
+
+    return std::vector<bool>(results.begin(), results.end());
+}
+
+
+/**
+ * Return the unimodular matrices L.P.R of size n, where L is unit lower
+ * triangular with coefficients between 0 and max_coefficient, P is a
+ * permutation and R reverses at most one loop.
+ */
+static std::vector<std::vector<std::vector<int>>> get_candidate_matrices(int n, int max_coefficient)
+{
+    std::vector<std::vector<int>> permutations;
+    std::vector<int> permutation(n);
+    for (int i = 0; i < n; ++i)
+        permutation[i] = i;
+
+    do
+        permutations.push_back(permutation);
+    while (std::next_permutation(permutation.begin(), permutation.end()));
+
+    std::vector<std::pair<int, int>> lower;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < i; ++j)
+            lower.push_back({i, j});
+
+    std::set<std::vector<std::vector<int>>> matrices;
+    std::vector<int> coefficients(lower.size(), 0);
+
+    while (true)
+    {
+        std::vector<std::vector<int>> L(n, std::vector<int>(n, 0));
+        for (int i = 0; i < n; ++i)
+            L[i][i] = 1;
+        for (int k = 0; k < lower.size(); ++k)
+            L[lower[k].first][lower[k].second] = coefficients[k];
+
+        for (std::vector<int> const& p : permutations)
+            for (int reversed = -1; reversed < n; ++reversed)
+            {
+                // Column j of L.P.R is column p[j] of L, negated if j is reversed
+                std::vector<std::vector<int>> M(n, std::vector<int>(n));
+                for (int i = 0; i < n; ++i)
+                    for (int j = 0; j < n; ++j)
+                        M[i][j] = (j == reversed ? -1 : 1) * L[i][p[j]];
+
+                matrices.insert(M);
+            }
+
+        int k = 0;
+        while (k < coefficients.size() && coefficients[k] == max_coefficient)
+            coefficients[k++] = 0;
+
+        if (k == coefficients.size())
+            break;
+
+        coefficients[k]++;
+    }
+
+    return std::vector<std::vector<std::vector<int>>>(matrices.begin(), matrices.end());
+}
+
+std::vector<std::vector<std::vector<int>>> legality_oracle::find_tiling_transformations(std::vector<optimization_info> const& previous,
+                                                                                      std::vector<tiramisu::computation*> const& comps,
+                                                                                      int level, int nb_levels,
+                                                                                      int max_coefficient, int nb_solutions) const
+{
+    std::vector<std::vector<std::vector<int>>> solutions;
+
+    std::vector<std::string> names;
+    for (tiramisu::computation *comp : comps)
+        names.push_back(comp->get_name());
+
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+
+    int depth = std::numeric_limits<int>::max();
+    for (std::string const& name : names)
+    {
+        auto it = depths.find(name);
+        if (it == depths.end())
+            return solutions;
+
+        depth = std::min(depth, it->second);
+    }
+
+    if (names.empty() || level < 0 || nb_levels < 2 || level + nb_levels > depth)
+        return solutions;
+
+    // The matrix of the transformations already applied to the computations
+    std::vector<std::vector<long>> T(depth, std::vector<long>(depth, 0));
+    for (int i = 0; i < depth; ++i)
+        T[i][i] = 1;
+
+    for (optimization_info const& optim : previous)
+    {
+        bool involved = false;
+        for (tiramisu::computation *comp : optim.comps)
+            if (std::find(names.begin(), names.end(), comp->get_name()) != names.end())
+                involved = true;
+
+        if (!involved)
+            continue;
+
+        switch (optim.type)
+        {
+            case optimization_type::INTERCHANGE:
+            case optimization_type::SKEWING:
+            case optimization_type::SKEWING_POSITIVE:
+            case optimization_type::UNIMODULAR:
+                if (!update_transformation_matrix(optim, T))
+                    return solutions;
+                break;
+
+            // They do not change the loop levels
+            case optimization_type::UNFUSE:
+            case optimization_type::FISSION:
+            case optimization_type::PARALLELIZE:
+                break;
+
+            // A fusion with a shift changes the distances
+            case optimization_type::FUSION:
+                if (optim.l0_fact != 0)
+                    return solutions;
+                break;
+
+            default:
+                return solutions;
+        }
+    }
+
+    // The distances not carried by the outer levels, over the levels of the band
+    isl_set *distances = get_distances(names, depth);
+    isl_set *band = transform_distances(distances, T);
+    isl_set_free(distances);
+
+    std::string prefix = zero_prefix_str(level);
+    if (!prefix.empty())
+    {
+        std::string str = "{ " + dims_str(depth) + " : " + prefix + " }";
+        band = isl_set_intersect(band, isl_set_read_from_str(thread_context.ctx, str.c_str()));
+    }
+
+    band = isl_set_project_out(band, isl_dim_set, level + nb_levels, depth - level - nb_levels);
+    band = isl_set_project_out(band, isl_dim_set, 0, level);
+    band = isl_set_project_out(band, isl_dim_param, 0, isl_set_dim(band, isl_dim_param));
+    band = isl_set_coalesce(band);
+
+    // A bounded set with few points is checked without isl
+    std::vector<std::vector<long>> points;
+    bool enumerated = false;
+
+    if (isl_set_is_bounded(band) == isl_bool_true)
+    {
+        struct points_collector { std::vector<std::vector<long>> *points; int n; } collector = {&points, nb_levels};
+
+        enumerated = isl_set_foreach_point(band, [](isl_point *pnt, void *user) {
+            points_collector *collector = (points_collector*)user;
+            if (collector->points->size() >= 1024)
+            {
+                isl_point_free(pnt);
+                return isl_stat_error;
+            }
+
+            std::vector<long> point;
+            for (int i = 0; i < collector->n; ++i)
+            {
+                isl_val *v = isl_point_get_coordinate_val(pnt, isl_dim_set, i);
+                point.push_back(isl_val_get_num_si(v));
+                isl_val_free(v);
+            }
+
+            collector->points->push_back(point);
+            isl_point_free(pnt);
+            return isl_stat_ok;
+        }, &collector) == isl_stat_ok;
+    }
+
+    std::string negative;
+    for (int l = 0; l < nb_levels; ++l)
+        negative += ((l > 0) ? " or d" : "d") + std::to_string(l) + " < 0";
+
+    auto is_permutable = [&](std::vector<std::vector<int>> const& M) {
+        if (enumerated)
+        {
+            for (std::vector<long> const& point : points)
+                for (int i = 0; i < nb_levels; ++i)
+                {
+                    long d = 0;
+                    for (int j = 0; j < nb_levels; ++j)
+                        d += M[i][j] * point[j];
+
+                    if (d < 0)
+                        return false;
+                }
+
+            return true;
+        }
+
+        std::vector<std::vector<long>> M_long(nb_levels, std::vector<long>(nb_levels));
+        for (int i = 0; i < nb_levels; ++i)
+            for (int j = 0; j < nb_levels; ++j)
+                M_long[i][j] = M[i][j];
+
+        isl_set *transformed = transform_distances(band, M_long);
+        bool result = has_no_distance_in(transformed, nb_levels, negative);
+        isl_set_free(transformed);
+
+        return result;
+    };
+
+    std::vector<std::vector<int>> identity(nb_levels, std::vector<int>(nb_levels, 0));
+    for (int i = 0; i < nb_levels; ++i)
+        identity[i][i] = 1;
+
+    // Nothing to do if the band can already be tiled
+    if (!is_permutable(identity))
+    {
+        std::vector<std::pair<int, std::vector<std::vector<int>>>> found;
+        for (std::vector<std::vector<int>> const& M : get_candidate_matrices(nb_levels, max_coefficient))
+        {
+            if (M == identity || !is_permutable(M))
+                continue;
+
+            int cost = 0;
+            for (int i = 0; i < nb_levels; ++i)
+                for (int j = 0; j < nb_levels; ++j)
+                    cost += std::abs(M[i][j] - identity[i][j]);
+
+            found.push_back({cost, M});
+        }
+
+        std::sort(found.begin(), found.end());
+        for (int i = 0; i < found.size() && i < nb_solutions; ++i)
+            solutions.push_back(found[i].second);
+    }
+
+    isl_set_free(band);
+    return solutions;
+}
+
+}
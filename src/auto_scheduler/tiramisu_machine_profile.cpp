@@ -0,0 +1,488 @@
+#include <tiramisu/auto_scheduler/machine_profile.h>
+#include <tiramisu/auto_scheduler/schedules_generator.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace tiramisu::auto_scheduler
+{
+
+// The number of independent accumulators of the FLOP kernels, enough to hide
+// the latency of the FMA units
+const int NB_ACCUMULATORS = 12;
+const long FLOP_KERNEL_ITERATIONS = 20 * 1000 * 1000;
+const double MIN_MEASUREMENT_TIME = 0.1;
+
+// The results of the kernels are stored here so that they are not removed
+static volatile float sink;
+
+static double now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Read the sizes of the data caches of the first CPU from sysfs.
+ */
+static std::vector<long> read_cache_sizes()
+{
+    std::vector<std::pair<int, long>> caches;
+    for (int index = 0; index < 8; index++)
+    {
+        std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+        std::ifstream level_file(dir + "level"), type_file(dir + "type"), size_file(dir + "size");
+        int level;
+        std::string type, size;
+        if (!(level_file >> level) || !(type_file >> type) || !(size_file >> size))
+            break;
+        if (type == "Instruction")
+            continue;
+
+        long bytes = std::atol(size.c_str());
+        if (size.back() == 'K')
+            bytes *= 1024;
+        else if (size.back() == 'M')
+            bytes *= 1024 * 1024;
+        caches.push_back({level, bytes});
+    }
+
+    std::sort(caches.begin(), caches.end());
+    std::vector<long> sizes;
+    for (auto const& cache : caches)
+        sizes.push_back(cache.second);
+    return sizes;
+}
+
+/**
+ * Run "kernel(thread)" on nb_threads threads at the same time, and return the
+ * time of the slowest one.
+ */
+template <typename F>
+static double run_on_threads(int nb_threads, F const& kernel)
+{
+    std::vector<double> times(nb_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nb_threads; t++)
+        threads.emplace_back([&, t]() {
+            double start = now();
+            kernel(t);
+            times[t] = now() - start;
+        });
+    for (std::thread& thread : threads)
+        thread.join();
+
+    return *std::max_element(times.begin(), times.end());
+}
+
+/**
+ * The bandwidth in GB/s of nb_threads threads running a STREAM triad
+ * on a working set of "bytes" bytes each.
+ */
+static double measure_bandwidth(long bytes, int nb_threads)
+{
+    long n = std::max(bytes / (3 * (long) sizeof(float)), 16L);
+    std::vector<std::vector<float>> a(nb_threads), b(nb_threads), c(nb_threads);
+    for (int t = 0; t < nb_threads; t++)
+    {
+        a[t].assign(n, 0);
+        b[t].assign(n, 1);
+        c[t].assign(n, 2);
+    }
+
+    auto triad = [&](long repetitions) {
+        return run_on_threads(nb_threads, [&](int t) {
+            float *pa = a[t].data(), *pb = b[t].data(), *pc = c[t].data();
+            for (long r = 0; r < repetitions; r++)
+            {
+                float s = 1.0f + r * 1e-7f;
+                for (long i = 0; i < n; i++)
+                    pa[i] = pb[i] + s * pc[i];
+            }
+        });
+    };
+
+    // Repeat the triad on small working sets so that each measurement lasts long enough
+    double first_time = triad(1);
+    long repetitions = std::max(1L, (long) (MIN_MEASUREMENT_TIME / std::max(first_time, 1e-6)));
+
+    double best = 0;
+    for (int run = 0; run < 3; run++)
+        best = std::max(best, 3.0 * sizeof(float) * n * repetitions * nb_threads / triad(repetitions) / 1e9);
+    sink = a[0][n - 1];
+
+    return best;
+}
+
+/**
+ * The latency in ns of a load in a working set of "bytes" bytes, measured
+ * by chasing pointers in a random cycle of cache lines.
+ */
+static double measure_latency(long bytes)
+{
+    const long line = 64 / sizeof(void*);
+    long nb_lines = std::max(bytes / 64, 2L);
+
+    std::vector<long> order(nb_lines);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin() + 1, order.end(), std::mt19937(0));
+
+    std::vector<void*> chain(nb_lines * line);
+    for (long i = 0; i < nb_lines; i++)
+        chain[order[i] * line] = &chain[order[(i + 1) % nb_lines] * line];
+
+    long steps = 10 * 1000 * 1000;
+    void **p = (void**) chain[0];
+    double start = now();
+    for (long i = 0; i < steps; i++)
+        p = (void**) *p;
+    double time = now() - start;
+
+    sink = (p == nullptr);
+
+    return time / steps * 1e9;
+}
+
+static float scalar_kernel(long iterations)
+{
+    float acc[NB_ACCUMULATORS], b = 0.999f, c = 0.001f;
+    for (int k = 0; k < NB_ACCUMULATORS; k++)
+        acc[k] = k;
+    for (long i = 0; i < iterations; i++)
+        for (int k = 0; k < NB_ACCUMULATORS; k++)
+            acc[k] = acc[k] * b + c;
+    return std::accumulate(acc, acc + NB_ACCUMULATORS, 0.0f);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2")))
+static float sse_kernel(long iterations)
+{
+    __m128 acc[NB_ACCUMULATORS], b = _mm_set1_ps(0.999f), c = _mm_set1_ps(0.001f);
+    for (int k = 0; k < NB_ACCUMULATORS; k++)
+        acc[k] = _mm_set1_ps(k);
+    for (long i = 0; i < iterations; i++)
+        for (int k = 0; k < NB_ACCUMULATORS; k++)
+            acc[k] = _mm_add_ps(_mm_mul_ps(acc[k], b), c);
+    float sum = 0;
+    for (int k = 0; k < NB_ACCUMULATORS; k++)
+        sum += _mm_cvtss_f32(acc[k]);
+    return sum;
+}
+
+__attribute__((target("avx")))
+static float avx_kernel(long iterations)
+{
+    __m256 acc[NB_ACCUMULATORS], b = _mm256_set1_ps(0.999f), c = _mm256_set1_ps(0.001f);
+    for (int k = 0; k < NB_ACCUMULATORS; k++)
+        acc[k] = _mm256_set1_ps(k);
+    for (long i = 0; i < iterations; i++)
+        for (int k = 0; k < NB_ACCUMULATORS; k++)
+            acc[k] = _mm256_add_ps(_mm256_mul_ps(acc[k], b), c);
+    float sum = 0;
+    for (int k = 0; k < NB_ACCUMULATORS; k++)
+        sum += _mm256_cvtss_f32(acc[k]);
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static float avx2_fma_kernel(long iterations)
+{
+    __m256 acc[NB_ACCUMULATORS], b = _mm256_set1_ps(0.999f), c = _mm256_set1_ps(0.001f);
+    for (int k = 0; k < NB_ACCUMULATORS; k++)
+        acc[k] = _mm256_set1_ps(k);
+    for (long i = 0; i < iterations; i++)
+        for (int k = 0; k < NB_ACCUMULATORS; k++)
+            acc[k] = _mm256_fmadd_ps(acc[k], b, c);
+    float sum = 0;
+    for (int k = 0; k < NB_ACCUMULATORS; k++)
+        sum += _mm256_cvtss_f32(acc[k]);
+    return sum;
+}
+
+__attribute__((target("avx512f")))
+static float avx512_kernel(long iterations)
+{
+    __m512 acc[NB_ACCUMULATORS], b = _mm512_set1_ps(0.999f), c = _mm512_set1_ps(0.001f);
+    for (int k = 0; k < NB_ACCUMULATORS; k++)
+        acc[k] = _mm512_set1_ps(k);
+    for (long i = 0; i < iterations; i++)
+        for (int k = 0; k < NB_ACCUMULATORS; k++)
+            acc[k] = _mm512_fmadd_ps(acc[k], b, c);
+    float sum = 0;
+    for (int k = 0; k < NB_ACCUMULATORS; k++)
+        sum += _mm512_reduce_add_ps(acc[k]);
+    return sum;
+}
+#elif defined(__aarch64__)
+static float neon_kernel(long iterations)
+{
+    float32x4_t acc[NB_ACCUMULATORS], b = vdupq_n_f32(0.999f), c = vdupq_n_f32(0.001f);
+    for (int k = 0; k < NB_ACCUMULATORS; k++)
+        acc[k] = vdupq_n_f32(k);
+    for (long i = 0; i < iterations; i++)
+        for (int k = 0; k < NB_ACCUMULATORS; k++)
+            acc[k] = vfmaq_f32(c, acc[k], b);
+    float sum = 0;
+    for (int k = 0; k < NB_ACCUMULATORS; k++)
+        sum += vaddvq_f32(acc[k]);
+    return sum;
+}
+#endif
+
+/**
+ * A FLOP kernel : its name, the function, and the FLOPs of one iteration.
+ */
+struct flop_kernel
+{
+    std::string isa;
+    float (*kernel)(long);
+    double flops_per_iteration;
+};
+
+/**
+ * The FLOP kernels of the instruction sets supported by the CPU.
+ */
+static std::vector<flop_kernel> get_flop_kernels()
+{
+    std::vector<flop_kernel> kernels = {{"scalar", scalar_kernel, 2.0 * NB_ACCUMULATORS}};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        kernels.push_back({"sse", sse_kernel, 2.0 * 4 * NB_ACCUMULATORS});
+    if (__builtin_cpu_supports("avx"))
+        kernels.push_back({"avx", avx_kernel, 2.0 * 8 * NB_ACCUMULATORS});
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        kernels.push_back({"avx2_fma", avx2_fma_kernel, 2.0 * 8 * NB_ACCUMULATORS});
+    if (__builtin_cpu_supports("avx512f"))
+        kernels.push_back({"avx512", avx512_kernel, 2.0 * 16 * NB_ACCUMULATORS});
+#elif defined(__aarch64__)
+    kernels.push_back({"neon", neon_kernel, 2.0 * 4 * NB_ACCUMULATORS});
+#endif
+    return kernels;
+}
+
+/**
+ * The GFLOP/s of nb_threads threads running the given kernel.
+ */
+static double measure_gflops(flop_kernel const& kernel, int nb_threads)
+{
+    std::vector<float> results(nb_threads);
+    double best = 0;
+    for (int run = 0; run < 3; run++)
+    {
+        double time = run_on_threads(nb_threads, [&](int t) {
+            results[t] = kernel.kernel(FLOP_KERNEL_ITERATIONS);
+        });
+        best = std::max(best, kernel.flops_per_iteration * FLOP_KERNEL_ITERATIONS * nb_threads / time / 1e9);
+    }
+
+    sink = results[0];
+
+    return best;
+}
+
+machine_profile machine_profile::characterize(int nb_threads)
+{
+    machine_profile profile;
+
+    char host_name[256] = "";
+    gethostname(host_name, sizeof(host_name) - 1);
+    profile.host_name = host_name;
+
+    profile.nb_cores = (nb_threads > 0) ? nb_threads : std::max(1, (int) std::thread::hardware_concurrency());
+
+    profile.cache_sizes = read_cache_sizes();
+    if (profile.cache_sizes.empty())
+        profile.cache_sizes = CACHE_SIZES_DEFAULT_LIST;
+
+    // Half of each cache, so that the working set is not evicted by the other data
+    for (long cache_size : profile.cache_sizes)
+    {
+        profile.cache_bandwidths.push_back(measure_bandwidth(cache_size / 2, 1));
+        profile.cache_latencies.push_back(measure_latency(cache_size / 2));
+    }
+
+    long memory_bytes = std::max(8 * profile.cache_sizes.back(), 256L * 1024 * 1024);
+    profile.memory_latency = measure_latency(memory_bytes);
+
+    for (int threads = 1; ; threads = std::min(2 * threads, profile.nb_cores))
+    {
+        double bandwidth = measure_bandwidth(memory_bytes / threads, threads);
+        profile.memory_bandwidth_scaling.push_back({threads, bandwidth});
+        if (threads == profile.nb_cores)
+            break;
+    }
+    profile.memory_bandwidth = profile.memory_bandwidth_scaling.back().second;
+
+    flop_kernel const* best_kernel = nullptr;
+    double best_gflops = 0;
+    std::vector<flop_kernel> kernels = get_flop_kernels();
+    for (flop_kernel const& kernel : kernels)
+    {
+        double gflops = measure_gflops(kernel, 1);
+        profile.core_peak_gflops.push_back({kernel.isa, gflops});
+        if (gflops > best_gflops)
+        {
+            best_gflops = gflops;
+            best_kernel = &kernel;
+        }
+    }
+    profile.peak_gflops = measure_gflops(*best_kernel, profile.nb_cores);
+
+    return profile;
+}
+
+bool machine_profile::save(std::string const& filename) const
+{
+    std::ofstream file(filename);
+    if (!file)
+        return false;
+
+    file << "tiramisu_machine_profile 1\n";
+    file << "host_name " << host_name << "\n";
+    file << "nb_cores " << nb_cores << "\n";
+    for (size_t i = 0; i < cache_sizes.size(); i++)
+        file << "cache " << cache_sizes[i] << " " << cache_bandwidths[i] << " " << cache_latencies[i] << "\n";
+    file << "memory_latency " << memory_latency << "\n";
+    for (auto const& scaling : memory_bandwidth_scaling)
+        file << "memory_bandwidth " << scaling.first << " " << scaling.second << "\n";
+    for (auto const& peak : core_peak_gflops)
+        file << "core_peak_gflops " << peak.first << " " << peak.second << "\n";
+    file << "peak_gflops " << peak_gflops << "\n";
+
+    return (bool) file;
+}
+
+bool machine_profile::load(std::string const& filename)
+{
+    std::ifstream file(filename);
+    std::string line;
+    if (!std::getline(file, line) || line.rfind("tiramisu_machine_profile", 0) != 0)
+        return false;
+
+    *this = machine_profile();
+    while (std::getline(file, line))
+    {
+        std::istringstream fields(line);
+        std::string keyword;
+        if (!(fields >> keyword))
+            continue;
+
+        bool valid = true;
+        if (keyword == "host_name")
+            valid = (bool) (fields >> host_name);
+        else if (keyword == "nb_cores")
+            valid = (bool) (fields >> nb_cores);
+        else if (keyword == "cache")
+        {
+            long size;
+            double bandwidth, latency;
+            valid = (bool) (fields >> size >> bandwidth >> latency);
+            cache_sizes.push_back(size);
+            cache_bandwidths.push_back(bandwidth);
+            cache_latencies.push_back(latency);
+        }
+        else if (keyword == "memory_latency")
+            valid = (bool) (fields >> memory_latency);
+        else if (keyword == "memory_bandwidth")
+        {
+            int threads;
+            double bandwidth;
+            valid = (bool) (fields >> threads >> bandwidth);
+            memory_bandwidth_scaling.push_back({threads, bandwidth});
+            memory_bandwidth = bandwidth;
+        }
+        else if (keyword == "core_peak_gflops")
+        {
+            std::string isa;
+            double gflops;
+            valid = (bool) (fields >> isa >> gflops);
+            core_peak_gflops.push_back({isa, gflops});
+        }
+        else if (keyword == "peak_gflops")
+            valid = (bool) (fields >> peak_gflops);
+
+        if (!valid)
+            return false;
+    }
+
+    return !cache_sizes.empty() && peak_gflops > 0 && memory_bandwidth > 0;
+}
+
+std::string machine_profile::get_json() const
+{
+    auto list = [](auto const& values) {
+        std::string json = "[";
+        for (size_t i = 0; i < values.size(); i++)
+            json += (i == 0 ? "" : ", ") + std::to_string(values[i]);
+        return json + "]";
+    };
+
+    std::string json = "{\"host_name\" : \"" + host_name + "\", \"nb_cores\" : " + std::to_string(nb_cores) +
+                       ", \"cache_sizes\" : " + list(cache_sizes) +
+                       ", \"cache_bandwidths\" : " + list(cache_bandwidths) +
+                       ", \"cache_latencies\" : " + list(cache_latencies) +
+                       ", \"memory_latency\" : " + std::to_string(memory_latency) +
+                       ", \"memory_bandwidth_scaling\" : {";
+    for (size_t i = 0; i < memory_bandwidth_scaling.size(); i++)
+        json += (i == 0 ? "\"" : ", \"") + std::to_string(memory_bandwidth_scaling[i].first) + "\" : " +
+                std::to_string(memory_bandwidth_scaling[i].second);
+
+    json += "}, \"core_peak_gflops\" : {";
+    for (size_t i = 0; i < core_peak_gflops.size(); i++)
+        json += (i == 0 ? "\"" : ", \"") + core_peak_gflops[i].first + "\" : " + std::to_string(core_peak_gflops[i].second);
+
+    return json + "}, \"peak_gflops\" : " + std::to_string(peak_gflops) + "}";
+}
+
+std::vector<float> machine_profile::get_features() const
+{
+    std::vector<float> features = {(float) nb_cores};
+    for (int level = 0; level < 3; level++)
+        features.push_back(level < cache_sizes.size() ? std::log2((float) cache_sizes[level]) : 0);
+    for (int level = 0; level < 3; level++)
+        features.push_back(level < cache_bandwidths.size() ? cache_bandwidths[level] : 0);
+    features.push_back(cache_latencies.empty() ? 0 : cache_latencies.back());
+    features.push_back(memory_bandwidth);
+    features.push_back(memory_latency);
+
+    double core_peak = 0;
+    for (auto const& peak : core_peak_gflops)
+        core_peak = std::max(core_peak, peak.second);
+    features.push_back(core_peak);
+    features.push_back(peak_gflops);
+
+    return features;
+}
+
+machine_profile const* machine_profile::get_host_profile()
+{
+    static machine_profile profile;
+    static bool loaded = (std::getenv("AS_MACHINE_PROFILE") != nullptr) && profile.load(std::getenv("AS_MACHINE_PROFILE"));
+
+    return loaded ? &profile : nullptr;
+}
+
+std::vector<long> get_default_cache_sizes()
+{
+    machine_profile const* profile = machine_profile::get_host_profile();
+    return (profile != nullptr) ? profile->cache_sizes : CACHE_SIZES_DEFAULT_LIST;
+}
+
+}
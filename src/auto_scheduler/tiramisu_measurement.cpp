@@ -0,0 +1,453 @@
+#include <tiramisu/auto_scheduler/measurement.h>
+#include <tiramisu/auto_scheduler/utils.h>
+
+#include <sched.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace tiramisu::auto_scheduler
+{
+
+perf_counters::perf_counters(std::string const& raw_events)
+{
+#ifdef __linux__
+    open_counter("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    open_counter("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    open_counter("l1d_misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    open_counter("llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    open_counter("stalled_cycles_frontend", PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND);
+    open_counter("stalled_cycles_backend", PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND);
+
+    std::istringstream iss(raw_events);
+    std::string event;
+
+    while (std::getline(iss, event, ','))
+    {
+        size_t equal = event.find('=');
+        if (equal == std::string::npos)
+            continue;
+
+        open_counter(event.substr(0, equal), PERF_TYPE_RAW, std::stoull(event.substr(equal + 1), nullptr, 16));
+    }
+#endif
+}
+
+perf_counters::~perf_counters()
+{
+    for (auto const& counter : counters)
+        close(counter.second);
+}
+
+void perf_counters::open_counter(std::string const& name, unsigned int type, unsigned long long config)
+{
+#ifdef __linux__
+    perf_event_attr attr = {};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    int fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd != -1)
+        counters.push_back({name, fd});
+#endif
+}
+
+void perf_counters::reset()
+{
+#ifdef __linux__
+    for (auto const& counter : counters)
+        ioctl(counter.second, PERF_EVENT_IOC_RESET, 0);
+#endif
+}
+
+void perf_counters::enable()
+{
+#ifdef __linux__
+    for (auto const& counter : counters)
+        ioctl(counter.second, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+}
+
+void perf_counters::disable()
+{
+#ifdef __linux__
+    for (auto const& counter : counters)
+        ioctl(counter.second, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+}
+
+std::map<std::string, double> perf_counters::read(int nb_runs) const
+{
+    std::map<std::string, double> values;
+    if (nb_runs == 0)
+        return values;
+
+    for (auto const& counter : counters)
+    {
+        // The value, the time the counter was enabled and the time it was counting
+        unsigned long long data[3];
+        if (::read(counter.second, data, sizeof(data)) != sizeof(data) || data[2] == 0)
+            continue;
+
+        values[counter.first] = (double)data[0] * data[1] / data[2] / nb_runs;
+    }
+
+    return values;
+}
+
+// ---------------------------------------------------------------------------- //
+
+measurement_harness::measurement_harness()
+{
+    if (std::getenv("MAX_RUNS") != nullptr)
+        max_runs = std::max(1, std::atoi(std::getenv("MAX_RUNS")));
+
+    if (std::getenv("MIN_RUNS") != nullptr)
+        min_runs = std::max(1, std::atoi(std::getenv("MIN_RUNS")));
+
+    min_runs = std::min(min_runs, max_runs);
+
+    flush_cache = std::atoi(read_env_var("AS_FLUSH_CACHE")) == 1;
+    measure_energy = std::atoi(read_env_var("AS_MEASURE_ENERGY")) == 1;
+    measure_counters = std::atoi(read_env_var("AS_MEASURE_COUNTERS")) == 1;
+    pinned_cores = parse_cores_list(read_env_var("AS_PIN_CORES"));
+}
+
+std::vector<int> measurement_harness::parse_cores_list(std::string const& cores_list)
+{
+    std::vector<int> cores;
+    std::istringstream iss(cores_list);
+    std::string range;
+
+    while (std::getline(iss, range, ','))
+    {
+        if (range.empty())
+            continue;
+
+        size_t dash = range.find('-');
+        int first = std::atoi(range.substr(0, dash).c_str());
+        int last = (dash == std::string::npos) ? first : std::atoi(range.substr(dash + 1).c_str());
+
+        for (int core = first; core <= last; ++core)
+            cores.push_back(core);
+    }
+
+    return cores;
+}
+
+std::string measurement_harness::get_pinning_cmd_prefix() const
+{
+    if (pinned_cores.empty())
+        return "";
+
+    std::string cores_list;
+    for (int core : pinned_cores)
+        cores_list += std::to_string(core) + ",";
+
+    cores_list.pop_back();
+    return "taskset -c " + cores_list + " ";
+}
+
+void measurement_harness::pin_to_cores()
+{
+    if (pinned || pinned_cores.empty())
+        return;
+
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+
+    for (int core : pinned_cores)
+        CPU_SET(core, &cpu_set);
+
+    if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0)
+        std::cerr << "warning: could not pin the measurements to the cores " << read_env_var("AS_PIN_CORES") << std::endl;
+#endif
+
+    pinned = true;
+}
+
+std::vector<std::pair<long long, long long>> measurement_harness::read_energy_counters()
+{
+    std::vector<std::pair<long long, long long>> counters;
+
+    // The package domains are intel-rapl:0, intel-rapl:1, ... (their subdomains are intel-rapl:N:M)
+    for (int package = 0; ; ++package)
+    {
+        std::string domain = "/sys/class/powercap/intel-rapl:" + std::to_string(package) + "/";
+        std::ifstream energy_file(domain + "energy_uj");
+        std::ifstream range_file(domain + "max_energy_range_uj");
+
+        long long energy = 0, range = 0;
+        if (!(energy_file >> energy) || !(range_file >> range))
+            break;
+
+        counters.push_back({energy, range});
+    }
+
+    return counters;
+}
+
+float measurement_harness::get_run_energy(std::vector<std::pair<long long, long long>> const& counters_before, int nb_runs)
+{
+    std::vector<std::pair<long long, long long>> counters_after = read_energy_counters();
+    if (nb_runs == 0 || counters_before.empty() || counters_after.size() != counters_before.size())
+        return std::numeric_limits<float>::quiet_NaN();
+
+    double energy = 0;
+    for (int i = 0; i < counters_before.size(); ++i)
+    {
+        long long delta = counters_after[i].first - counters_before[i].first;
+        if (delta < 0)
+            delta += counters_before[i].second;
+
+        energy += delta;
+    }
+
+    return energy / 1000 / nb_runs;
+}
+
+perf_counters* measurement_harness::get_counters()
+{
+    if (!measure_counters)
+        return nullptr;
+
+    if (counters == nullptr)
+    {
+        counters = std::make_shared<perf_counters>(read_env_var("AS_PERF_EVENTS"));
+        if (!counters->is_available())
+            std::cerr << "warning: the hardware counters cannot be read (see /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+    }
+
+    return counters->is_available() ? counters.get() : nullptr;
+}
+
+void measurement_harness::flush_caches()
+{
+    if (flush_buffer.size() != cache_flush_size)
+        flush_buffer.resize(cache_flush_size);
+
+    // Write one byte per cache line
+    volatile char *data = flush_buffer.data();
+    for (size_t i = 0; i < flush_buffer.size(); i += 64)
+        data[i] = data[i] + 1;
+}
+
+double measurement_harness::time_calibration_workload()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // A chain of dependent integer operations, its speed only depends on the core frequency
+    volatile unsigned long seed = 1;
+    unsigned long x = seed;
+    for (int i = 0; i < 2000000; ++i)
+        x = x * 6364136223846793005UL + 1442695040888963407UL;
+
+    seed = x;
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void measurement_harness::reject_outliers(std::vector<float>& measurements)
+{
+    if (measurements.size() < 3)
+        return;
+
+    std::vector<float> sorted = measurements;
+    std::sort(sorted.begin(), sorted.end());
+    float median = sorted[sorted.size() / 2];
+
+    std::vector<float> deviations;
+    for (float measure : measurements)
+        deviations.push_back(std::abs(measure - median));
+
+    std::sort(deviations.begin(), deviations.end());
+    float mad = deviations[deviations.size() / 2];
+
+    // All the measurements are (almost) equal
+    if (mad == 0)
+        return;
+
+    measurements.erase(std::remove_if(measurements.begin(), measurements.end(), [&](float measure) {
+        return std::abs(measure - median) > 3 * mad;
+    }), measurements.end());
+}
+
+bool measurement_harness::is_precise_enough(std::vector<float> const& measurements) const
+{
+    if (measurements.size() < 2)
+        return false;
+
+    double mean = 0;
+    for (float measure : measurements)
+        mean += measure;
+
+    mean /= measurements.size();
+
+    double variance = 0;
+    for (float measure : measurements)
+        variance += (measure - mean) * (measure - mean);
+
+    variance /= measurements.size() - 1;
+
+    double half_width = 1.96 * std::sqrt(variance / measurements.size());
+    return half_width <= target_confidence * mean;
+}
+
+std::vector<float> measurement_harness::measure(std::function<int()> const& run, float timeout, bool& timed_out)
+{
+    std::vector<float> measurements;
+    timed_out = false;
+    last_energy = std::numeric_limits<float>::quiet_NaN();
+    last_counters.clear();
+
+    pin_to_cores();
+    perf_counters *hw_counters = get_counters();
+
+    for (int i = 0; i < nb_warmups; ++i)
+        if (run() != 0)
+            return {};
+
+    for (int attempt = 0; attempt <= nb_noise_retries; ++attempt)
+    {
+        measurements.clear();
+        double elapsed = 0;
+        double calibration_before = time_calibration_workload();
+
+        std::vector<std::pair<long long, long long>> energy_counters;
+        if (measure_energy)
+            energy_counters = read_energy_counters();
+
+        if (hw_counters != nullptr)
+            hw_counters->reset();
+
+        while (measurements.size() < max_runs)
+        {
+            if (flush_cache)
+                flush_caches();
+
+            if (hw_counters != nullptr)
+                hw_counters->enable();
+
+            auto start = std::chrono::steady_clock::now();
+            int status = run();
+            auto end = std::chrono::steady_clock::now();
+
+            if (hw_counters != nullptr)
+                hw_counters->disable();
+
+            if (status != 0)
+                return {};
+
+            double duration = std::chrono::duration<double, std::milli>(end - start).count();
+            measurements.push_back(duration);
+            elapsed += duration;
+
+            if (timeout != 0 && elapsed > timeout)
+            {
+                if (measure_energy)
+                    last_energy = get_run_energy(energy_counters, measurements.size());
+
+                if (hw_counters != nullptr)
+                    last_counters = hw_counters->read(measurements.size());
+
+                timed_out = true;
+                return measurements;
+            }
+
+            if (measurements.size() >= min_runs && target_confidence > 0 && is_precise_enough(measurements))
+                break;
+        }
+
+        if (measure_energy)
+            last_energy = get_run_energy(energy_counters, measurements.size());
+
+        if (hw_counters != nullptr)
+            last_counters = hw_counters->read(measurements.size());
+
+        double calibration_after = time_calibration_workload();
+        last_measurement_noisy = std::abs(calibration_after - calibration_before) > noise_threshold * calibration_before;
+
+        if (!last_measurement_noisy)
+            break;
+
+        if (std::atoi(read_env_var("AS_VERBOSE")) == 1)
+            std::cout << "Noisy measurement detected, measuring again" << std::endl;
+    }
+
+    reject_outliers(measurements);
+    return measurements;
+}
+
+std::vector<float> measurement_harness::measure_batch(std::function<std::vector<float>()> const& run_all)
+{
+    std::vector<float> measurements;
+    last_energy = std::numeric_limits<float>::quiet_NaN();
+    last_counters.clear();
+
+    perf_counters *hw_counters = get_counters();
+
+    for (int attempt = 0; attempt <= nb_noise_retries; ++attempt)
+    {
+        double calibration_before = time_calibration_workload();
+
+        std::vector<std::pair<long long, long long>> energy_counters;
+        if (measure_energy)
+            energy_counters = read_energy_counters();
+
+        if (hw_counters != nullptr)
+        {
+            hw_counters->reset();
+            hw_counters->enable();
+        }
+
+        measurements = run_all();
+
+        if (hw_counters != nullptr)
+        {
+            hw_counters->disable();
+            last_counters = hw_counters->read(measurements.size());
+        }
+
+        if (measure_energy)
+            last_energy = get_run_energy(energy_counters, measurements.size());
+
+        double calibration_after = time_calibration_workload();
+
+        if (measurements.empty())
+            return measurements;
+
+        last_measurement_noisy = std::abs(calibration_after - calibration_before) > noise_threshold * calibration_before;
+
+        if (!last_measurement_noisy)
+            break;
+
+        if (std::atoi(read_env_var("AS_VERBOSE")) == 1)
+            std::cout << "Noisy measurement detected, measuring again" << std::endl;
+    }
+
+    reject_outliers(measurements);
+    return measurements;
+}
+
+}
@@ -2,6 +2,8 @@
 #include <tiramisu/auto_scheduler/ast.h>
 #include <tiramisu/block.h>
 
+#include <algorithm>
+
 namespace tiramisu::auto_scheduler
 {
 
@@ -27,10 +29,20 @@ void unroll_innermost_levels(std::vector<tiramisu::computation*> const& comps_li
 void apply_optimizations(syntax_tree const& ast)
 {
     // Check ast.h for the difference between ast.previous_optims and ast.new_optims
-    for (optimization_info const& optim_info : ast.previous_optims)
-        apply_optimizations(optim_info);
-        
-    for (optimization_info const& optim_info : ast.new_optims)
+    std::vector<optimization_info> schedule = ast.get_schedule();
+
+    // Thread coarsening is applied with the GPU mapping of the same computations :
+    // its factors are given to the mapping in l2_fact and l3_fact.
+    for (optimization_info& optim_info : schedule)
+        if (optim_info.type == optimization_type::GPU_MAPPING)
+            for (optimization_info const& coarsening : schedule)
+                if (coarsening.type == optimization_type::THREAD_COARSENING && coarsening.comps == optim_info.comps)
+                {
+                    optim_info.l2_fact = coarsening.l0_fact;
+                    optim_info.l3_fact = coarsening.l1_fact;
+                }
+
+    for (optimization_info const& optim_info : schedule)
         apply_optimizations(optim_info);
 
     // Fusion is a particular case, and we use apply_fusions() to apply it.
@@ -40,6 +52,9 @@ void apply_optimizations(syntax_tree const& ast)
     // Parallelization needs to be applied after the other transformations in order to have the accurate loop depth of
     // the tagged ast_nodes
     apply_parallelization(ast);
+
+    apply_shared_memory_caching(ast);
+    apply_local_transpositions(ast);
 }
 
 void apply_optimizations(optimization_info const& optim_info)
@@ -49,6 +64,13 @@ void apply_optimizations(optimization_info const& optim_info)
         
     switch (optim_info.type)
     {
+        // The fused computations are ordered by apply_fusions(), only the shift is applied here
+        case optimization_type::FUSION:
+            if (optim_info.l0_fact != 0)
+                for (tiramisu::computation *comp : optim_info.comps)
+                    comp->shift(tiramisu::var(comp->get_loop_level_names()[optim_info.l2]), optim_info.l0_fact);
+            break;
+
         case optimization_type::TILING:
             if (optim_info.nb_l == 2)
                 block.tile(optim_info.l0, optim_info.l1, 
@@ -57,6 +79,12 @@ void apply_optimizations(optimization_info const& optim_info)
             else if (optim_info.nb_l == 3)
                 block.tile(optim_info.l0, optim_info.l1, optim_info.l2,
                            optim_info.l0_fact, optim_info.l1_fact, optim_info.l2_fact);
+
+            // The factors may not divide the extents (see ml_model_schedules_generator) : the full tiles
+            // are generated apart, with constant bounds for the inner levels
+            for (tiramisu::computation *comp : optim_info.comps)
+                for (int l = optim_info.l0 + optim_info.nb_l; l < optim_info.l0 + 2 * optim_info.nb_l; ++l)
+                    comp->set_ast_option(tiramisu::var(comp->get_loop_level_names()[l]), tiramisu::ast_separate);
             break;
                 
         case optimization_type::INTERCHANGE:
@@ -82,6 +110,62 @@ void apply_optimizations(optimization_info const& optim_info)
                 optim_info.l0_fact, optim_info.l1_fact, optim_info.l2_fact, optim_info.l3_fact);
             break;
 
+        case optimization_type::VECTORIZATION:
+            // The computations share the vectorized level, get its name from the first one
+            if (optim_info.l1_fact == 1 && optim_info.comps.size() == 1)
+                optim_info.comps[0]->vectorize_aligned(tiramisu::var(optim_info.comps[0]->get_loop_level_names()[optim_info.l0]),
+                                                       optim_info.l0_fact);
+            else
+                block.vectorize(tiramisu::var(optim_info.comps[0]->get_loop_level_names()[optim_info.l0]), optim_info.l0_fact);
+            break;
+
+        case optimization_type::UNROLL_AND_JAM:
+            block.unroll_and_jam(optim_info.l0, optim_info.l0_fact);
+            break;
+
+        case optimization_type::GPU_MAPPING:
+        {
+            // The computations share the mapped levels, get their names from the first one
+            std::string l0_name = optim_info.comps[0]->get_loop_level_names()[optim_info.l0];
+            std::string l1_name = optim_info.comps[0]->get_loop_level_names()[optim_info.l1];
+
+            if (optim_info.l2_fact > 1 || optim_info.l3_fact > 1)
+                block.gpu_tile(tiramisu::var(l0_name), tiramisu::var(l1_name), optim_info.l0_fact, optim_info.l1_fact,
+                               std::max(optim_info.l2_fact, 1), std::max(optim_info.l3_fact, 1),
+                               tiramisu::var(l0_name + "_outer"), tiramisu::var(l1_name + "_outer"),
+                               tiramisu::var(l0_name + "_inner"), tiramisu::var(l1_name + "_inner"));
+            else
+                block.gpu_tile(tiramisu::var(l0_name), tiramisu::var(l1_name), optim_info.l0_fact, optim_info.l1_fact,
+                               tiramisu::var(l0_name + "_outer"), tiramisu::var(l1_name + "_outer"),
+                               tiramisu::var(l0_name + "_inner"), tiramisu::var(l1_name + "_inner"));
+            break;
+        }
+
+        case optimization_type::UNIMODULAR:
+            block.unimodular_transform(optim_info.l0, optim_info.matrix);
+            break;
+
+        // The collapsed level is tagged by apply_parallelization()
+        case optimization_type::PARALLELIZE:
+            if (optim_info.nb_l == 2)
+                for (tiramisu::computation *comp : optim_info.comps)
+                    comp->collapse(tiramisu::var(comp->get_loop_level_names()[optim_info.l0]),
+                                   tiramisu::var(comp->get_loop_level_names()[optim_info.l1]));
+            break;
+
+        // Applied after the GPU mapping and the thread coarsening of the computations
+        case optimization_type::GPU_SPLIT_REDUCTION:
+            for (tiramisu::computation *comp : optim_info.comps)
+                comp->gpu_split_reduction(tiramisu::var(comp->get_loop_level_names()[optim_info.l0]), optim_info.l0_fact);
+            break;
+
+        // The loops over the ranks are tagged by apply_distribution()
+        case optimization_type::DISTRIBUTION:
+            block.split(optim_info.l0, optim_info.l1_fact);
+            break;
+
+        // THREAD_COARSENING is applied with GPU_MAPPING, SHARED_MEMORY_CACHING
+        // by apply_shared_memory_caching() and LOCAL_TRANSPOSITION by apply_local_transpositions()
         default:
             break;
     }
@@ -150,11 +234,335 @@ void apply_parallelization(ast_node* node)
 
 }
 
+bool get_shared_memory_footprint(syntax_tree const& ast, tiramisu::computation *comp,
+                                 int access_index, shared_memory_footprint& footprint)
+{
+    std::vector<optimization_info> schedule = ast.get_schedule();
+
+    // Get the GPU mapping of comp, and its thread coarsening
+    optimization_info const *mapping = nullptr;
+    int coarsening[2] = {1, 1};
+
+    for (optimization_info const& optim_info : schedule)
+    {
+        if (std::find(optim_info.comps.begin(), optim_info.comps.end(), comp) == optim_info.comps.end())
+            continue;
+
+        if (optim_info.type == optimization_type::GPU_MAPPING)
+            mapping = &optim_info;
+
+        else if (optim_info.type == optimization_type::THREAD_COARSENING)
+        {
+            coarsening[0] = optim_info.l0_fact;
+            coarsening[1] = optim_info.l1_fact;
+        }
+    }
+
+    auto node_it = ast.computations_mapping.find(comp);
+    if (mapping == nullptr || node_it == ast.computations_mapping.end())
+        return false;
+
+    computation_info const *comp_info = nullptr;
+    for (computation_info const& info : node_it->second->computations)
+        if (info.comp_ptr == comp)
+            comp_info = &info;
+
+    if (comp_info == nullptr || access_index >= comp_info->accesses->accesses_list.size())
+        return false;
+
+    std::vector<dnn_access_matrix> const& accesses = comp_info->accesses->accesses_list;
+    std::vector<dnn_iterator> const& iters = *comp_info->iters;
+    dnn_access_matrix const& access = accesses[access_index];
+
+    // The input must be computed before the kernel
+    for (tiramisu::computation *mapped_comp : mapping->comps)
+        if (mapped_comp->get_name() == access.buffer_name)
+            return false;
+
+    std::vector<tiramisu::computation*> inputs = ast.fct->get_computation_by_name(access.buffer_name);
+    if (inputs.empty())
+        return false;
+
+    // Number of points computed by a block along each mapped level
+    int mapped_levels[2] = {mapping->l0, mapping->l1};
+    int block_extents[2] = {mapping->l0_fact * coarsening[0], mapping->l1_fact * coarsening[1]};
+
+    // The blocks must cover the mapped levels exactly, so that the part read
+    // by a block does not go past the accessed elements
+    for (int i = 0; i < 2; ++i)
+    {
+        dnn_iterator const& it = iters[mapped_levels[i]];
+        if (it.low_bound != 0 || (it.up_bound + 1) % block_extents[i] != 0)
+            return false;
+    }
+
+    // Number of elements read by a block
+    long nb_reads = (long)block_extents[0] * block_extents[1];
+    for (int k = mapping->l1 + 1; k < iters.size(); ++k)
+        nb_reads *= iters[k].up_bound - iters[k].low_bound + 1;
+
+    footprint.input_name = access.buffer_name;
+    footprint.shape.clear();
+    footprint.offsets.clear();
+    footprint.copy_level = iters[mapping->l1].name + "_inner";
+
+    long nb_elements = 1;
+    int nb_accesses = std::count_if(accesses.begin(), accesses.end(), [&](dnn_access_matrix const& other) {
+        return other.buffer_name == access.buffer_name;
+    });
+
+    for (int d = 0; d < access.nb_dims; ++d)
+    {
+        std::vector<int> const& row = access.matrix[d];
+
+        // The accesses to the input must be translations of each other,
+        // the shared buffer contains all of them
+        int min_cst = row.back(), max_cst = row.back();
+
+        for (dnn_access_matrix const& other : accesses)
+        {
+            if (other.buffer_name != access.buffer_name)
+                continue;
+
+            if (other.nb_dims != access.nb_dims ||
+                !std::equal(row.begin(), row.end() - 1, other.matrix[d].begin()))
+                return false;
+
+            min_cst = std::min(min_cst, other.matrix[d].back());
+            max_cst = std::max(max_cst, other.matrix[d].back());
+        }
+
+        if (min_cst < 0)
+            return false;
+
+        int extent = max_cst - min_cst + 1;
+        tiramisu::expr offset = tiramisu::expr(min_cst);
+
+        for (int k = 0; k < access.nb_iterators && k < iters.size(); ++k)
+        {
+            int coeff = row[k];
+            if (coeff == 0)
+                continue;
+
+            if (coeff < 0)
+                return false;
+
+            // Outer loops are fixed inside a block
+            if (k < mapping->l0)
+                offset = offset + tiramisu::expr(coeff) * tiramisu::var(iters[k].name, false);
+
+            // A block covers block_extents points of the mapped levels
+            else if (k == mapping->l0 || k == mapping->l1)
+            {
+                int block_extent = block_extents[k == mapping->l0 ? 0 : 1];
+                offset = offset + tiramisu::expr(coeff * block_extent) * tiramisu::var(iters[k].name + "_outer", false);
+                extent += coeff * (block_extent - 1);
+            }
+
+            // and all the iterations of the inner loops
+            else
+            {
+                offset = offset + tiramisu::expr(coeff * iters[k].low_bound);
+                extent += coeff * (iters[k].up_bound - iters[k].low_bound);
+            }
+        }
+
+        footprint.shape.push_back(extent);
+        footprint.offsets.push_back(offset);
+        nb_elements *= extent;
+    }
+
+    footprint.size = nb_elements * halide_type_from_tiramisu_type(inputs[0]->get_data_type()).bytes();
+
+    return footprint.size <= GPU_SHARED_MEMORY_SIZE && nb_elements < nb_reads * nb_accesses;
+}
+
+void apply_shared_memory_caching(syntax_tree const& ast)
+{
+    for (optimization_info const& optim_info : ast.get_schedule())
+    {
+        if (optim_info.type != optimization_type::SHARED_MEMORY_CACHING)
+            continue;
+
+        shared_memory_footprint footprint;
+        if (!get_shared_memory_footprint(ast, optim_info.comps[0], optim_info.l0, footprint))
+            continue;
+
+        tiramisu::computation *input = ast.fct->get_computation_by_name(footprint.input_name)[0];
+        optim_info.comps[0]->cache_shared(*input, tiramisu::var(footprint.copy_level, false),
+                                          footprint.shape, footprint.offsets);
+    }
+}
+
+bool get_local_transposition(syntax_tree const& ast, tiramisu::computation *comp, int access_index,
+                             std::string& input_name, int& level)
+{
+    for (optimization_info const& optim_info : ast.get_schedule())
+        if ((optim_info.type == optimization_type::SKEWING || optim_info.type == optimization_type::UNIMODULAR) &&
+            std::find(optim_info.comps.begin(), optim_info.comps.end(), comp) != optim_info.comps.end())
+            return false;
+
+    auto node_it = ast.computations_mapping.find(comp);
+    if (node_it == ast.computations_mapping.end())
+        return false;
+
+    ast_node *innermost = node_it->second;
+
+    computation_info const *comp_info = nullptr;
+    for (computation_info const& info : innermost->computations)
+        if (info.comp_ptr == comp)
+            comp_info = &info;
+
+    if (comp_info == nullptr || access_index >= comp_info->accesses->accesses_list.size())
+        return false;
+
+    dnn_access_matrix const& access = comp_info->accesses->accesses_list[access_index];
+    std::vector<tiramisu::computation*> inputs = ast.fct->get_computation_by_name(access.buffer_name);
+    if (inputs.empty() || access.nb_dims < 2)
+        return false;
+
+    // The producer must be computed before the loop nest
+    ast_node *root = innermost;
+    while (root->parent != nullptr)
+        root = root->parent;
+
+    std::vector<tiramisu::computation*> nest_comps;
+    root->get_all_computations(nest_comps);
+    for (tiramisu::computation *nest_comp : nest_comps)
+        if (nest_comp->get_name() == access.buffer_name)
+            return false;
+
+    // The iterator of the innermost loop, before tiling and vectorization
+    std::string it_name = innermost->name;
+    for (std::string suffix : {"_v_inner", "_inner", "_outer"})
+        while (it_name.size() > suffix.size() &&
+               it_name.compare(it_name.size() - suffix.size(), suffix.size(), suffix) == 0)
+            it_name = it_name.substr(0, it_name.size() - suffix.size());
+
+    std::vector<dnn_iterator> const& iters = *comp_info->iters;
+    int it = -1;
+    for (int i = 0; i < iters.size(); ++i)
+        if (iters[i].name == it_name)
+            it = i;
+
+    if (it == -1 || access.matrix.back()[it] != 0)
+        return false;
+
+    bool column_wise = false;
+    for (int i = 0; i < access.nb_dims - 1; ++i)
+        column_wise = column_wise || access.matrix[i][it] != 0;
+
+    if (!column_wise)
+        return false;
+
+    // The panel covers the inner loops with constant bounds, while it fits the cache
+    long element_size = halide_type_from_tiramisu_type(inputs[0]->get_data_type()).bytes();
+    long nb_elements = 1;
+    level = innermost->depth;
+    for (ast_node *node = innermost; node != nullptr && node->constant_bounds; node = node->parent)
+    {
+        if (nb_elements * node->get_extent() * element_size > LOCAL_TRANSPOSITION_MAX_SIZE)
+            break;
+
+        nb_elements *= node->get_extent();
+        level = node->depth - 1;
+    }
+
+    input_name = access.buffer_name;
+    return level >= 0 && level < innermost->depth - 1;
+}
+
+void apply_local_transpositions(syntax_tree const& ast)
+{
+    for (optimization_info const& optim_info : ast.get_schedule())
+    {
+        if (optim_info.type != optimization_type::LOCAL_TRANSPOSITION)
+            continue;
+
+        std::string input_name;
+        int level;
+        if (!get_local_transposition(ast, optim_info.comps[0], optim_info.l0, input_name, level))
+            continue;
+
+        tiramisu::computation *comp = optim_info.comps[0];
+        tiramisu::computation *input = ast.fct->get_computation_by_name(input_name)[0];
+
+        // The stride is not known if the producer has parametric sizes
+        long stride = comp->get_access_stride(*input, comp->get_loop_levels_number() - 1);
+        if (stride >= 0 && stride * halide_type_from_tiramisu_type(input->get_data_type()).bytes() < CACHE_LINE_SIZE)
+            continue;
+
+        comp->transpose_operand(*input, tiramisu::var(comp->get_loop_level_names()[level], false));
+    }
+}
+
+bool get_distribution(syntax_tree const& ast, optimization_info& distribution)
+{
+    for (optimization_info const& optim_info : ast.get_schedule())
+        if (optim_info.type == optimization_type::DISTRIBUTION)
+        {
+            distribution = optim_info;
+            return true;
+        }
+
+    return false;
+}
+
+void apply_distribution(syntax_tree const& ast, bool generate_communication)
+{
+    optimization_info distribution;
+    if (!get_distribution(ast, distribution))
+        return ;
+
+    // The inputs of the program are partitioned like the computations
+    std::vector<tiramisu::computation*> distributed_comps = distribution.comps;
+    int extent = distribution.l0_fact * distribution.l1_fact;
+
+    for (tiramisu::computation *comp : ast.fct->get_computations())
+    {
+        if (comp->get_expr().is_defined() || isl_set_dim(comp->get_iteration_domain(), isl_dim_set) == 0 ||
+            std::find(distributed_comps.begin(), distributed_comps.end(), comp) != distributed_comps.end() ||
+            tiramisu::utility::get_extent(comp->get_iteration_domain(), 0) != extent)
+            continue;
+
+        comp->split(distribution.l0, distribution.l1_fact);
+        distributed_comps.push_back(comp);
+    }
+
+    for (tiramisu::computation *comp : distributed_comps)
+    {
+        comp->tag_distribute_level(distribution.l0);
+
+        if (!generate_communication)
+            continue;
+
+        comp->drop_rank_iter(tiramisu::var(comp->get_loop_level_names()[distribution.l0]));
+
+        // A rank only stores its block
+        if (comp->get_access_relation() == nullptr)
+            continue;
+
+        std::string buffer_name = isl_map_get_tuple_name(comp->get_access_relation(), isl_dim_out);
+        tiramisu::buffer *buf = ast.fct->get_buffers().at(buffer_name);
+        tiramisu::expr const& size = buf->get_dim_sizes()[0];
+
+        if (size.get_expr_type() == tiramisu::e_val && size.is_integer() && size.get_int_val() == extent)
+            buf->set_dim_size(0, distribution.l1_fact);
+    }
+
+    if (generate_communication)
+        for (tiramisu::computation *comp : distribution.comps)
+            comp->gen_communication();
+}
+
 void print_optim(optimization_info optim)
 {
     switch(optim.type) {
         case optimization_type::FUSION:
-            std::cout << "Fusion" << " L" << optim.l0 << " " << " L" << optim.l1 << std::endl;
+            std::cout << "Fusion" << " L" << optim.l0 << " " << " L" << optim.l1;
+            if (optim.l0_fact != 0)
+                std::cout << " shift L" << optim.l2 << " " << optim.l0_fact;
+            std::cout << std::endl;
             break;
 
         case optimization_type::UNFUSE:
@@ -177,7 +585,10 @@ void print_optim(optimization_info optim)
             break;
 
         case optimization_type::PARALLELIZE:
-            std::cout << "Parallelize" << " L" << optim.l0 << std::endl;
+            std::cout << "Parallelize" << " L" << optim.l0;
+            if (optim.nb_l == 2)
+                std::cout << " collapsed with L" << optim.l1;
+            std::cout << std::endl;
             break;
 
         case optimization_type::SKEWING:
@@ -188,6 +599,55 @@ void print_optim(optimization_info optim)
                 << optim.l0_fact << " " << optim.l1_fact << " "<< optim.l2_fact << " " << optim.l3_fact << std::endl;
             break;
 
+        case optimization_type::VECTORIZATION:
+            std::cout << "Vectorization" << " L" << optim.l0 << " " << optim.l0_fact
+                      << (optim.l1_fact == 1 ? " peeled for alignment" : "") << std::endl;
+            break;
+
+        case optimization_type::UNROLL_AND_JAM:
+            std::cout << "Unroll-and-jam" << " L" << optim.l0 << " " << optim.l0_fact << std::endl;
+            break;
+
+        case optimization_type::GPU_MAPPING:
+            std::cout << "GPU mapping" << " L" << optim.l0 << " " << optim.l0_fact << " L" << optim.l1 << " " << optim.l1_fact << std::endl;
+            break;
+
+        case optimization_type::THREAD_COARSENING:
+            std::cout << "Thread coarsening" << " L" << optim.l0 << " " << optim.l0_fact << " L" << optim.l1 << " " << optim.l1_fact << std::endl;
+            break;
+
+        case optimization_type::SHARED_MEMORY_CACHING:
+            std::cout << "Shared memory caching " << optim.comps[0]->get_name() << " access " << optim.l0 << std::endl;
+            break;
+
+        case optimization_type::GPU_SPLIT_REDUCTION:
+            std::cout << "GPU split reduction" << " L" << optim.l0 << " " << optim.l1_fact << " chunks of " << optim.l0_fact << std::endl;
+            break;
+
+        case optimization_type::LOCAL_TRANSPOSITION:
+            std::cout << "Local transposition " << optim.comps[0]->get_name() << " access " << optim.l0 << std::endl;
+            break;
+
+        case optimization_type::DISTRIBUTION:
+            std::cout << "Distribution" << " L" << optim.l0 << " " << optim.l0_fact << " ranks" << std::endl;
+            break;
+
+        case optimization_type::FISSION:
+            std::cout << "Fission" << " L" << optim.l0 << " before " << optim.comps[0]->get_name() << std::endl;
+            break;
+
+        case optimization_type::UNIMODULAR:
+            std::cout << "Unimodular" << " L" << optim.l0;
+            for (std::vector<int> const& row : optim.matrix)
+            {
+                std::cout << " [";
+                for (int j = 0; j < row.size(); ++j)
+                    std::cout << ((j > 0) ? " " : "") << row[j];
+                std::cout << "]";
+            }
+            std::cout << std::endl;
+            break;
+
         default:
             break;
     }
@@ -0,0 +1,260 @@
+#include <tiramisu/auto_scheduler/roofline.h>
+#include <tiramisu/auto_scheduler/machine_profile.h>
+#include <tiramisu/externs.h>
+
+#include <isl/aff.h>
+#include <isl/ilp.h>
+#include <isl/local_space.h>
+#include <isl/val.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace tiramisu::auto_scheduler
+{
+
+double roofline_analysis::get_footprint(computation_info const& comp, std::vector<int> const& elements_sizes, int depth)
+{
+    std::vector<dnn_iterator> const& iters = *comp.iters;
+    std::vector<dnn_access_matrix> const& accesses = comp.accesses->accesses_list;
+
+    // The bounding box of the elements of each buffer read by the iteration
+    std::map<std::string, std::vector<std::pair<long, long>>> boxes;
+    std::map<std::string, int> buffers_elements_sizes;
+
+    for (int i = 0; i < accesses.size(); ++i)
+    {
+        dnn_access_matrix const& access = accesses[i];
+        std::vector<std::pair<long, long>> box;
+
+        for (std::vector<int> const& row : access.matrix)
+        {
+            long min = row[access.nb_iterators], max = row[access.nb_iterators];
+
+            for (int j = 0; j < access.nb_iterators && j < iters.size(); ++j)
+            {
+                // The iterators of the enclosing levels are fixed
+                long low = iters[j].low_bound;
+                long up = (j <= depth) ? low : iters[j].up_bound;
+
+                min += std::min(row[j] * low, row[j] * up);
+                max += std::max(row[j] * low, row[j] * up);
+            }
+
+            box.push_back({min, max});
+        }
+
+        auto it = boxes.find(access.buffer_name);
+        if (it == boxes.end() || it->second.size() != box.size())
+            boxes[access.buffer_name] = box;
+        else
+            for (int d = 0; d < box.size(); ++d)
+                it->second[d] = {std::min(it->second[d].first, box[d].first),
+                                 std::max(it->second[d].second, box[d].second)};
+
+        buffers_elements_sizes[access.buffer_name] = elements_sizes[i];
+    }
+
+    double footprint = 0;
+    for (auto const& box : boxes)
+    {
+        double nb_elements = 1;
+        for (auto const& range : box.second)
+            nb_elements *= range.second - range.first + 1;
+
+        footprint += nb_elements * buffers_elements_sizes[box.first];
+    }
+
+    // The written elements, from the write access relation
+    isl_set *domain = isl_set_copy(comp.comp_ptr->get_iteration_domain());
+    isl_map *write = isl_map_read_from_str(isl_set_get_ctx(domain), comp.write_access_relation.c_str());
+
+    for (int j = 0; j <= depth && j < iters.size(); ++j)
+        domain = isl_set_fix_si(domain, isl_dim_set, j, iters[j].low_bound);
+
+    isl_set *written = isl_set_apply(domain, write);
+    isl_local_space *ls = isl_local_space_from_space(isl_set_get_space(written));
+
+    double nb_written = 1;
+    for (int d = 0; d < isl_set_dim(written, isl_dim_set); ++d)
+    {
+        isl_aff *dim = isl_aff_var_on_domain(isl_local_space_copy(ls), isl_dim_set, d);
+        isl_val *min = isl_set_min_val(written, dim);
+        isl_val *max = isl_set_max_val(written, dim);
+
+        // Parametric bounds are ignored
+        if (isl_val_is_int(min) && isl_val_is_int(max))
+            nb_written *= isl_val_get_num_si(max) - isl_val_get_num_si(min) + 1;
+
+        isl_val_free(min);
+        isl_val_free(max);
+        isl_aff_free(dim);
+    }
+
+    isl_local_space_free(ls);
+    isl_set_free(written);
+
+    // The written elements are already counted if they are also read (e.g. by a reduction)
+    if (boxes.find(comp.comp_ptr->get_name()) == boxes.end())
+        footprint += nb_written * elements_sizes.back();
+
+    return footprint;
+}
+
+roofline_analysis::roofline_analysis(syntax_tree const& ast, double peak_gflops, double memory_bandwidth)
+    : peak_gflops(peak_gflops), memory_bandwidth(memory_bandwidth)
+{
+    machine_profile const* profile = machine_profile::get_host_profile();
+
+    if (this->peak_gflops < 0)
+        this->peak_gflops = (std::getenv("ROOFLINE_PEAK_GFLOPS") != nullptr) ?
+                            std::atof(std::getenv("ROOFLINE_PEAK_GFLOPS")) :
+                            (profile != nullptr) ? profile->peak_gflops : DEFAULT_PEAK_GFLOPS;
+
+    if (this->memory_bandwidth < 0)
+        this->memory_bandwidth = (std::getenv("ROOFLINE_MEMORY_BANDWIDTH") != nullptr) ?
+                                 std::atof(std::getenv("ROOFLINE_MEMORY_BANDWIDTH")) :
+                                 (profile != nullptr) ? profile->memory_bandwidth : DEFAULT_MEMORY_BANDWIDTH;
+
+    std::vector<computation_info const*> comps;
+    std::function<void(ast_node const*)> collect = [&](ast_node const* node) {
+        for (computation_info const& comp : node->computations)
+            comps.push_back(&comp);
+        for (ast_node const* child : node->children)
+            collect(child);
+    };
+
+    for (ast_node const* root : ast.roots)
+        collect(root);
+
+    for (computation_info const* comp : comps)
+    {
+        std::vector<dnn_iterator> const& iters = *comp->iters;
+        int comp_element_size = halide_type_from_tiramisu_type(comp->comp_ptr->get_data_type()).bytes();
+
+        // The size of the elements of each access, then of the written elements
+        std::vector<int> elements_sizes;
+        for (dnn_access_matrix const& access : comp->accesses->accesses_list)
+        {
+            int element_size = comp_element_size;
+            for (tiramisu::computation *c : ast.get_computations())
+                if (c->get_name() == access.buffer_name)
+                    element_size = halide_type_from_tiramisu_type(c->get_data_type()).bytes();
+            elements_sizes.push_back(element_size);
+        }
+        elements_sizes.push_back(comp_element_size);
+
+        double flops_per_iteration = comp->nb_additions + comp->nb_substractions +
+                                     comp->nb_multiplications + comp->nb_divisions;
+
+        roofline_computation result;
+        result.name = comp->comp_ptr->get_name();
+
+        // The levels from the innermost, so that the number of iterations of
+        // the loops nested in a level is a running product
+        double nb_iterations = 1;
+        for (int depth = iters.size() - 1; depth >= -1; --depth)
+        {
+            double footprint = get_footprint(*comp, elements_sizes, depth);
+            double flops = flops_per_iteration * nb_iterations;
+            double intensity = (footprint > 0) ? flops / footprint : 0;
+
+            if (depth >= 0)
+            {
+                result.levels.insert(result.levels.begin(), {depth, iters[depth].name, flops, footprint, intensity});
+                nb_iterations *= iters[depth].up_bound - iters[depth].low_bound + 1;
+            }
+            else
+            {
+                result.flops = flops;
+                result.footprint = footprint;
+                result.arithmetic_intensity = intensity;
+            }
+        }
+
+        computations.push_back(result);
+    }
+}
+
+double roofline_analysis::get_attainable_gflops(double arithmetic_intensity) const
+{
+    return std::min(peak_gflops, arithmetic_intensity * memory_bandwidth);
+}
+
+bool roofline_analysis::is_memory_bound(double arithmetic_intensity) const
+{
+    return arithmetic_intensity * memory_bandwidth < peak_gflops;
+}
+
+double roofline_analysis::get_efficiency(std::vector<std::string> const& comps, double time_ms) const
+{
+    // The footprints of fused computations are added, which overestimates
+    // the traffic of the buffers they share
+    double flops = 0, footprint = 0;
+    bool found = false;
+
+    for (roofline_computation const& comp : computations)
+        if (std::find(comps.begin(), comps.end(), comp.name) != comps.end())
+        {
+            flops += comp.flops;
+            footprint += comp.footprint;
+            found = true;
+        }
+
+    if (!found || time_ms <= 0 || footprint <= 0)
+        return -1;
+
+    double achieved_gflops = flops / (time_ms * 1e6);
+    return achieved_gflops / get_attainable_gflops(flops / footprint);
+}
+
+void roofline_analysis::print() const
+{
+    std::cout << "Roofline : peak " << peak_gflops << " GFLOP/s, bandwidth " << memory_bandwidth
+              << " GB/s, ridge point " << peak_gflops / memory_bandwidth << " FLOP/B" << std::endl;
+
+    for (roofline_computation const& comp : computations)
+    {
+        std::cout << comp.name << " : " << comp.flops << " FLOP, " << comp.footprint << " B, "
+                  << comp.arithmetic_intensity << " FLOP/B, "
+                  << (is_memory_bound(comp.arithmetic_intensity) ? "memory" : "compute") << " bound, at most "
+                  << get_attainable_gflops(comp.arithmetic_intensity) << " GFLOP/s" << std::endl;
+
+        for (roofline_level const& level : comp.levels)
+            std::cout << "    level " << level.depth << " (" << level.iterator << ") : working set "
+                      << level.footprint << " B, " << level.arithmetic_intensity << " FLOP/B" << std::endl;
+    }
+}
+
+void roofline_analysis::print_with_profile(double cycles_per_ms) const
+{
+    for (int region = 0; region < tiramisu_profiler_nb_regions(); ++region)
+    {
+        const char *name;
+        tiramisu_profile_counters counters;
+        if (tiramisu_profiler_get_region(region, &name, &counters) != 0 || counters.calls == 0)
+            continue;
+
+        // The regions are named "function:comp1,comp2"
+        std::string region_name(name);
+        std::vector<std::string> comps;
+        std::istringstream iss(region_name.substr(region_name.find(':') + 1));
+        std::string comp;
+        while (std::getline(iss, comp, ','))
+            comps.push_back(comp);
+
+        double time_ms = counters.cycles / cycles_per_ms / counters.calls;
+        double efficiency = get_efficiency(comps, time_ms);
+        if (efficiency < 0)
+            continue;
+
+        std::cout << region_name << " : " << time_ms << " ms, " << efficiency * 100
+                  << "% of the roofline" << std::endl;
+    }
+}
+
+}
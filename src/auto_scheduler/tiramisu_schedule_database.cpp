@@ -0,0 +1,232 @@
+#include <tiramisu/auto_scheduler/schedule_database.h>
+#include <tiramisu/auto_scheduler/evaluator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace tiramisu::auto_scheduler
+{
+
+schedule_database::schedule_database(std::string const& filename)
+    : filename(filename)
+{
+    std::ifstream file(filename);
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        size_t first_sep = line.find('|');
+        size_t second_sep = line.find('|', first_sep + 1);
+
+        if (first_sep == std::string::npos || second_sep == std::string::npos)
+            continue;
+
+        entry e;
+        e.structure = line.substr(0, first_sep);
+        e.schedule = line.substr(second_sep + 1);
+
+        std::istringstream extents_stream(line.substr(first_sep + 1, second_sep - first_sep - 1));
+        float extent;
+        while (extents_stream >> extent)
+            e.extents.push_back(extent);
+
+        entries.push_back(e);
+    }
+}
+
+void schedule_database::save() const
+{
+    // Write to a temporary file, so that an interruption does not corrupt the database
+    std::string tmp_filename = filename + ".tmp";
+    std::ofstream file(tmp_filename);
+
+    for (entry const& e : entries)
+    {
+        file << e.structure << "|";
+        for (float extent : e.extents)
+            file << extent << " ";
+
+        file << "|" << e.schedule << "\n";
+    }
+
+    file.close();
+    if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+        std::cerr << "warning: could not save the schedule database " << filename << std::endl;
+}
+
+void schedule_database::append_structure_signature(ast_node const *node, std::string& signature, std::vector<float>& extents)
+{
+    signature += "L";
+    extents.push_back(std::log2((float)std::max(node->get_extent(), 1)));
+
+    for (computation_info const& comp_info : node->computations)
+    {
+        signature += "C" + std::to_string(comp_info.accesses->accesses_list.size());
+
+        // The constant terms depend on the shape (e.g. the padding), they are not part of the structure
+        for (dnn_access_matrix const& matrix : comp_info.accesses->accesses_list)
+        {
+            signature += "[";
+            for (std::vector<int> const& row : matrix.matrix)
+            {
+                for (int j = 0; j < (int)row.size() - 1; ++j)
+                    signature += std::to_string(row[j]) + ",";
+
+                signature += "/";
+            }
+            signature += "]";
+        }
+    }
+
+    signature += "(";
+    for (ast_node const *child : node->children)
+        append_structure_signature(child, signature, extents);
+
+    signature += ")";
+}
+
+void schedule_database::get_signatures(syntax_tree const& ast, std::string& structure, std::vector<float>& extents)
+{
+    structure.clear();
+    extents.clear();
+
+    for (ast_node const *root : ast.roots)
+        append_structure_signature(root, structure, extents);
+}
+
+std::string schedule_database::serialize_schedule(std::vector<optimization_info> const& schedule)
+{
+    std::string schedule_str;
+
+    for (optimization_info const& optim : schedule)
+    {
+        schedule_str += std::to_string(optim.type) + " " + std::to_string(optim.nb_l) + " " +
+                        std::to_string(optim.l0) + " " + std::to_string(optim.l1) + " " + std::to_string(optim.l2) + " " +
+                        std::to_string(optim.l0_fact) + " " + std::to_string(optim.l1_fact) + " " +
+                        std::to_string(optim.l2_fact) + " " + std::to_string(optim.l3_fact) + " " +
+                        std::to_string(optim.comps.size());
+
+        for (tiramisu::computation *comp : optim.comps)
+            schedule_str += " " + evaluate_by_learning_model::get_computation_key(comp);
+
+        for (std::vector<int> const& row : optim.matrix)
+            for (int coeff : row)
+                schedule_str += " " + std::to_string(coeff);
+
+        schedule_str += ";";
+    }
+
+    return schedule_str;
+}
+
+std::vector<optimization_info> schedule_database::deserialize_schedule(std::string const& schedule_str, syntax_tree const& ast)
+{
+    std::vector<optimization_info> schedule;
+    std::istringstream schedule_stream(schedule_str);
+    std::string optim_str;
+
+    while (std::getline(schedule_stream, optim_str, ';'))
+    {
+        std::istringstream iss(optim_str);
+        optimization_info optim;
+        int type, nb_comps;
+
+        if (!(iss >> type >> optim.nb_l >> optim.l0 >> optim.l1 >> optim.l2
+                  >> optim.l0_fact >> optim.l1_fact >> optim.l2_fact >> optim.l3_fact >> nb_comps))
+            continue;
+
+        optim.type = (optimization_type)type;
+        optim.node = nullptr;
+
+        bool comps_found = true;
+        for (int i = 0; i < nb_comps; ++i)
+        {
+            std::string name;
+            iss >> name;
+
+            auto it = std::find_if(ast.get_computations().begin(), ast.get_computations().end(), [&](tiramisu::computation *comp) {
+                return evaluate_by_learning_model::get_computation_key(comp) == name;
+            });
+
+            if (it == ast.get_computations().end())
+                comps_found = false;
+            else
+                optim.comps.push_back(*it);
+        }
+
+        if (optim.type == optimization_type::UNIMODULAR && optim.nb_l > 0)
+        {
+            optim.matrix.assign(optim.nb_l, std::vector<int>(optim.nb_l, 0));
+            for (std::vector<int>& row : optim.matrix)
+                for (int& coeff : row)
+                    if (!(iss >> coeff))
+                        comps_found = false;
+        }
+
+        if (comps_found)
+            schedule.push_back(optim);
+    }
+
+    return schedule;
+}
+
+std::vector<std::vector<optimization_info>> schedule_database::find_nearest_schedules(syntax_tree const& ast, int nb_schedules) const
+{
+    std::string structure;
+    std::vector<float> extents;
+    get_signatures(ast, structure, extents);
+
+    std::vector<std::pair<float, int>> candidates;
+    for (int i = 0; i < entries.size(); ++i)
+    {
+        if (entries[i].structure != structure || entries[i].extents.size() != extents.size())
+            continue;
+
+        float distance = 0;
+        for (int j = 0; j < extents.size(); ++j)
+            distance += (entries[i].extents[j] - extents[j]) * (entries[i].extents[j] - extents[j]);
+
+        candidates.push_back({distance, i});
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    std::vector<std::vector<optimization_info>> schedules;
+    for (int i = 0; i < candidates.size() && schedules.size() < nb_schedules; ++i)
+        schedules.push_back(deserialize_schedule(entries[candidates[i].second].schedule, ast));
+
+    return schedules;
+}
+
+void schedule_database::add_schedule(syntax_tree const& ast, std::vector<optimization_info> const& schedule)
+{
+    entry e;
+    get_signatures(ast, e.structure, e.extents);
+    e.schedule = serialize_schedule(schedule);
+
+    for (entry& existing : entries)
+    {
+        if (existing.structure != e.structure || existing.extents.size() != e.extents.size())
+            continue;
+
+        // The extents are read back from text, compare them with a tolerance
+        bool same_extents = true;
+        for (int i = 0; i < e.extents.size(); ++i)
+            if (std::abs(existing.extents[i] - e.extents[i]) > 1e-3)
+                same_extents = false;
+
+        if (same_extents)
+        {
+            existing.schedule = e.schedule;
+            return ;
+        }
+    }
+
+    entries.push_back(e);
+}
+
+}
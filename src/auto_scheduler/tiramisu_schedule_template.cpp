@@ -0,0 +1,538 @@
+#include <tiramisu/auto_scheduler/schedule_template.h>
+#include <tiramisu/auto_scheduler/evaluator.h>
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+
+namespace tiramisu::auto_scheduler
+{
+
+/**
+ * The length scale of the kernel of the gaussian process, and the variance of the
+ * noise of the measurements, in the normalized spaces of the knobs and of the times.
+ */
+const double GP_LENGTH_SCALE = 0.25;
+const double GP_NOISE_VARIANCE = 0.01;
+
+static std::string get_configuration_key(schedule_template::knob_values const& values)
+{
+    std::string key;
+    for (auto const& knob : values)
+        key += knob.first + "=" + std::to_string(knob.second) + ";";
+
+    return key;
+}
+
+/**
+ * A gaussian process with a squared exponential kernel, fitted on the points x
+ * (in [0, 1]^d) and the values y.
+ */
+class gaussian_process
+{
+protected:
+    std::vector<std::vector<double>> x;
+
+    /**
+     * The lower triangular Cholesky factor of the kernel matrix, and its inverse
+     * applied to the normalized values.
+     */
+    std::vector<std::vector<double>> chol;
+    std::vector<double> alpha;
+
+    double y_mean = 0, y_std = 1;
+
+    static double kernel(std::vector<double> const& a, std::vector<double> const& b)
+    {
+        double dist = 0;
+        for (size_t i = 0; i < a.size(); ++i)
+            dist += (a[i] - b[i]) * (a[i] - b[i]);
+
+        return std::exp(-dist / (2 * GP_LENGTH_SCALE * GP_LENGTH_SCALE));
+    }
+
+    /**
+     * Solve chol * r = v.
+     */
+    std::vector<double> solve_lower(std::vector<double> v) const
+    {
+        for (size_t i = 0; i < v.size(); ++i)
+        {
+            for (size_t j = 0; j < i; ++j)
+                v[i] -= chol[i][j] * v[j];
+            v[i] /= chol[i][i];
+        }
+
+        return v;
+    }
+
+public:
+    gaussian_process(std::vector<std::vector<double>> const& x, std::vector<double> const& y)
+        : x(x)
+    {
+        int n = x.size();
+
+        for (double v : y)
+            y_mean += v / n;
+        double var = 0;
+        for (double v : y)
+            var += (v - y_mean) * (v - y_mean) / n;
+        y_std = std::max(std::sqrt(var), 1e-6);
+
+        chol.assign(n, std::vector<double>(n, 0));
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j <= i; ++j)
+            {
+                double sum = kernel(x[i], x[j]) + (i == j ? GP_NOISE_VARIANCE : 0);
+                for (int k = 0; k < j; ++k)
+                    sum -= chol[i][k] * chol[j][k];
+
+                chol[i][j] = (i == j) ? std::sqrt(std::max(sum, 1e-9)) : sum / chol[j][j];
+            }
+
+        std::vector<double> y_normalized(n);
+        for (int i = 0; i < n; ++i)
+            y_normalized[i] = (y[i] - y_mean) / y_std;
+
+        // alpha = chol^-T chol^-1 y
+        alpha = solve_lower(y_normalized);
+        for (int i = n - 1; i >= 0; --i)
+        {
+            for (int j = i + 1; j < n; ++j)
+                alpha[i] -= chol[j][i] * alpha[j];
+            alpha[i] /= chol[i][i];
+        }
+    }
+
+    /**
+     * Return the mean and the standard deviation of the prediction at p.
+     */
+    std::pair<double, double> predict(std::vector<double> const& p) const
+    {
+        std::vector<double> k(x.size());
+        for (size_t i = 0; i < x.size(); ++i)
+            k[i] = kernel(x[i], p);
+
+        double mean = 0;
+        for (size_t i = 0; i < x.size(); ++i)
+            mean += k[i] * alpha[i];
+
+        std::vector<double> v = solve_lower(k);
+        double var = 1;
+        for (double vi : v)
+            var -= vi * vi;
+
+        return {y_mean + mean * y_std, std::sqrt(std::max(var, 1e-12)) * y_std};
+    }
+};
+
+schedule_template::schedule_template(schedule_function const& apply_schedule, tiramisu::function *fct)
+    : fct(fct), apply_schedule(apply_schedule)
+{
+    assert(fct != nullptr);
+}
+
+void schedule_template::add_knob(std::string const& name, std::vector<int> const& values)
+{
+    assert(!values.empty());
+    for (auto const& knob : knobs)
+        if (knob.first == name)
+            ERROR("The knob " + name + " is already defined.", true);
+
+    knobs.push_back({name, values});
+}
+
+void schedule_template::add_power_of_two_knob(std::string const& name, int min_value, int max_value)
+{
+    assert(min_value > 0 && min_value <= max_value);
+
+    std::vector<int> values;
+    for (long v = 1; v <= max_value; v *= 2)
+        if (v >= min_value)
+            values.push_back(v);
+
+    add_knob(name, values);
+}
+
+schedule_template::knob_values schedule_template::get_configuration(std::vector<int> const& indices) const
+{
+    knob_values values;
+    for (size_t i = 0; i < knobs.size(); ++i)
+        values[knobs[i].first] = knobs[i].second[indices[i]];
+
+    return values;
+}
+
+long schedule_template::get_nb_configurations() const
+{
+    long nb = 1;
+    for (auto const& knob : knobs)
+        nb = std::min(nb * (long)knob.second.size(), (long)INT_MAX);
+
+    return nb;
+}
+
+void schedule_template::apply(knob_values const& values)
+{
+    knob_values complete = values;
+    for (auto const& knob : knobs)
+        complete.insert({knob.first, knob.second[0]});
+
+    fct->reset_schedules();
+    apply_schedule(complete);
+}
+
+std::vector<float> schedule_template::measure(knob_values const& values, std::vector<const void*> const& args,
+                                              int min_runs, int max_runs)
+{
+    std::vector<float> measurements;
+    int saved_min_runs = harness.min_runs, saved_max_runs = harness.max_runs;
+    harness.min_runs = min_runs;
+    harness.max_runs = max_runs;
+
+    try
+    {
+        apply(values);
+
+        // The arguments of the function are set by jit()
+        Halide::Internal::JITModule jit_module = fct->jit(fct->get_arguments());
+        auto argv_function = jit_module.argv_function();
+
+        bool timed_out;
+        measurements = harness.measure([&]() { return argv_function(args.data()); }, 0, timed_out);
+    }
+    catch (Halide::Error const& e)
+    {
+        std::cerr << "The configuration " << get_configuration_key(values) << " failed : " << e.what() << std::endl;
+        measurements.clear();
+    }
+
+    harness.min_runs = saved_min_runs;
+    harness.max_runs = saved_max_runs;
+
+    if (measurements.empty())
+        measurements.push_back(std::numeric_limits<float>::infinity());
+
+    return measurements;
+}
+
+schedule_template::knob_values schedule_template::tune(std::vector<tiramisu::buffer*> const& arguments,
+                                                       template_tuning_method method, int budget, unsigned int seed)
+{
+    assert(budget > 0);
+
+    // The buffers are allocated once, they are shared by all the configurations
+    std::vector<Halide::Runtime::Buffer<>> buffers;
+    for (tiramisu::buffer *buf : arguments)
+    {
+        if (!buf->has_constant_extents())
+            ERROR("schedule_template::tune() needs buffers with constant extents (" + buf->get_name() + ").", true);
+
+        std::vector<int> sizes;
+        for (auto it = buf->get_dim_sizes().rbegin(); it != buf->get_dim_sizes().rend(); ++it)
+            sizes.push_back((int)it->get_int_val());
+
+        buffers.emplace_back(halide_type_from_tiramisu_type(buf->get_elements_type()), sizes);
+        init_resident_buffer(buffers.back(), buf->get_elements_type());
+    }
+
+    std::vector<const void*> args;
+    for (Halide::Runtime::Buffer<>& buf : buffers)
+        args.push_back(buf.raw_buffer());
+
+    fct->set_arguments(arguments);
+    explored.clear();
+    best_values.clear();
+    best_time = std::numeric_limits<float>::infinity();
+
+    switch (method)
+    {
+        case BAYESIAN_OPTIMIZATION:
+            tune_bayesian(args, budget, seed);
+            break;
+
+        case SUCCESSIVE_HALVING:
+            tune_successive_halving(args, budget, seed);
+            break;
+
+        default:
+            tune_exhaustive(args, budget);
+    }
+
+    if (best_values.empty())
+    {
+        std::cerr << "error: no configuration of the schedule template could be executed" << std::endl;
+        apply({});
+    }
+    else
+        apply(best_values);
+
+    return best_values;
+}
+
+void schedule_template::tune_exhaustive(std::vector<const void*> const& args, int budget)
+{
+    std::vector<int> indices(knobs.size(), 0);
+    long nb_configurations = std::min(get_nb_configurations(), (long)budget);
+
+    for (long c = 0; c < nb_configurations; ++c)
+    {
+        knob_values values = get_configuration(indices);
+        std::vector<float> times = measure(values, args, harness.min_runs, harness.max_runs);
+        float time = *std::min_element(times.begin(), times.end());
+
+        explored.push_back({values, time});
+        if (time < best_time)
+        {
+            best_time = time;
+            best_values = values;
+        }
+
+        // The next configuration, the last knob varying the fastest
+        for (int i = knobs.size() - 1; i >= 0; --i)
+        {
+            if (++indices[i] < (int)knobs[i].second.size())
+                break;
+            indices[i] = 0;
+        }
+    }
+}
+
+void schedule_template::tune_successive_halving(std::vector<const void*> const& args, int budget, unsigned int seed)
+{
+    std::default_random_engine rand_generator(seed);
+    std::set<std::string> drawn;
+    std::vector<knob_values> survivors;
+
+    // Draw distinct configurations, at most a few times more draws than the budget
+    int nb_configurations = std::min(get_nb_configurations(), (long)budget);
+    for (int attempt = 0; (int)survivors.size() < nb_configurations && attempt < 10 * budget; ++attempt)
+    {
+        std::vector<int> indices;
+        for (auto const& knob : knobs)
+            indices.push_back(std::uniform_int_distribution<int>(0, knob.second.size() - 1)(rand_generator));
+
+        knob_values values = get_configuration(indices);
+        if (drawn.insert(get_configuration_key(values)).second)
+            survivors.push_back(values);
+    }
+
+    // The configurations with their time in their last round
+    int nb_runs = 1;
+    std::map<std::string, std::pair<knob_values, float>> last_times;
+    while (!survivors.empty())
+    {
+        std::vector<std::pair<float, int>> ranking;
+        for (size_t i = 0; i < survivors.size(); ++i)
+        {
+            std::vector<float> times = measure(survivors[i], args, nb_runs, nb_runs);
+            float time = *std::min_element(times.begin(), times.end());
+
+            last_times[get_configuration_key(survivors[i])] = {survivors[i], time};
+            ranking.push_back({time, i});
+        }
+
+        std::stable_sort(ranking.begin(), ranking.end());
+        if (survivors.size() == 1)
+            break;
+
+        std::vector<knob_values> next;
+        for (size_t i = 0; i < (survivors.size() + DEFAULT_HALVING_ETA - 1) / DEFAULT_HALVING_ETA; ++i)
+            if (std::isfinite(ranking[i].first))
+                next.push_back(survivors[ranking[i].second]);
+
+        survivors = next;
+        nb_runs = std::min(nb_runs * DEFAULT_HALVING_ETA, std::max(harness.max_runs, 1));
+    }
+
+    for (auto const& result : last_times)
+        explored.push_back(result.second);
+
+    if (!survivors.empty() && std::isfinite(last_times[get_configuration_key(survivors[0])].second))
+    {
+        best_values = survivors[0];
+        best_time = last_times[get_configuration_key(best_values)].second;
+    }
+}
+
+void schedule_template::tune_bayesian(std::vector<const void*> const& args, int budget, unsigned int seed)
+{
+    std::default_random_engine rand_generator(seed);
+    std::set<std::string> measured;
+
+    // The position of the configuration in the normalized space of the knobs
+    auto get_point = [&](std::vector<int> const& indices) {
+        std::vector<double> p;
+        for (size_t i = 0; i < knobs.size(); ++i)
+            p.push_back(knobs[i].second.size() > 1 ? (double)indices[i] / (knobs[i].second.size() - 1) : 0);
+        return p;
+    };
+
+    auto draw_indices = [&]() {
+        std::vector<int> indices;
+        for (auto const& knob : knobs)
+            indices.push_back(std::uniform_int_distribution<int>(0, knob.second.size() - 1)(rand_generator));
+        return indices;
+    };
+
+    // The candidates of the acquisition : all the configurations if there are few of them
+    long nb_configurations = get_nb_configurations();
+    std::vector<std::vector<int>> all_indices;
+    if (nb_configurations <= DEFAULT_NB_EI_CANDIDATES)
+    {
+        std::vector<int> indices(knobs.size(), 0);
+        for (long c = 0; c < nb_configurations; ++c)
+        {
+            all_indices.push_back(indices);
+            for (int i = knobs.size() - 1; i >= 0; --i)
+            {
+                if (++indices[i] < (int)knobs[i].second.size())
+                    break;
+                indices[i] = 0;
+            }
+        }
+    }
+
+    std::vector<std::vector<double>> points;
+    std::vector<float> times;
+    budget = std::min((long)budget, nb_configurations);
+
+    for (int iteration = 0; iteration < budget; ++iteration)
+    {
+        std::vector<int> next;
+
+        if (iteration < DEFAULT_NB_INITIAL_SAMPLES || points.size() < 2)
+        {
+            for (int attempt = 0; attempt < 100; ++attempt)
+            {
+                next = draw_indices();
+                if (measured.count(get_configuration_key(get_configuration(next))) == 0)
+                    break;
+            }
+        }
+        else
+        {
+            // The failed configurations are modeled as slower than the slowest one
+            float worst = 0;
+            for (float t : times)
+                if (std::isfinite(t))
+                    worst = std::max(worst, t);
+
+            std::vector<double> y;
+            for (float t : times)
+                y.push_back(std::log(std::isfinite(t) ? std::max(t, 1e-6f) : 2 * std::max(worst, 1e-6f)));
+
+            gaussian_process gp(points, y);
+            double best_y = *std::min_element(y.begin(), y.end());
+
+            std::vector<std::vector<int>> candidates = all_indices;
+            if (candidates.empty())
+                for (int c = 0; c < DEFAULT_NB_EI_CANDIDATES; ++c)
+                    candidates.push_back(draw_indices());
+
+            double best_ei = -1;
+            for (std::vector<int> const& candidate : candidates)
+            {
+                if (measured.count(get_configuration_key(get_configuration(candidate))) != 0)
+                    continue;
+
+                // Expected improvement of a minimization
+                std::pair<double, double> prediction = gp.predict(get_point(candidate));
+                double z = (best_y - prediction.first) / prediction.second;
+                double ei = (best_y - prediction.first) * 0.5 * std::erfc(-z / std::sqrt(2)) +
+                            prediction.second * std::exp(-z * z / 2) / std::sqrt(2 * M_PI);
+
+                if (ei > best_ei)
+                {
+                    best_ei = ei;
+                    next = candidate;
+                }
+            }
+
+            if (next.empty())
+                break;
+        }
+
+        knob_values values = get_configuration(next);
+        if (!measured.insert(get_configuration_key(values)).second)
+            break;
+
+        std::vector<float> measurements = measure(values, args, harness.min_runs, harness.max_runs);
+        float time = *std::min_element(measurements.begin(), measurements.end());
+
+        points.push_back(get_point(next));
+        times.push_back(time);
+        explored.push_back({values, time});
+
+        if (time < best_time)
+        {
+            best_time = time;
+            best_values = values;
+        }
+    }
+}
+
+void schedule_template::save_schedule_file(std::string const& filename)
+{
+    save_schedule_file(filename, best_values);
+}
+
+void schedule_template::save_schedule_file(std::string const& filename, knob_values const& values)
+{
+    apply(values);
+    fct->save_schedule_file(filename);
+
+    std::ofstream file(filename, std::ios::app);
+    if (!file)
+        ERROR("Cannot write the schedule file " + filename + ".", true);
+
+    for (auto const& knob : knobs)
+    {
+        auto value = values.find(knob.first);
+        file << "knob " << knob.first << " " << (value != values.end() ? value->second : knob.second[0]) << "\n";
+    }
+}
+
+bool schedule_template::load_knob_values(std::string const& filename, knob_values& values) const
+{
+    std::ifstream file(filename);
+    if (!file)
+        return false;
+
+    knob_values loaded;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream iss(line);
+        std::string keyword, name;
+        int value;
+        if ((iss >> keyword >> name >> value) && keyword == "knob")
+            loaded[name] = value;
+    }
+
+    for (auto const& knob : knobs)
+        if (loaded.count(knob.first) == 0)
+            return false;
+
+    values = loaded;
+    return true;
+}
+
+bool schedule_template::apply_schedule_file(std::string const& filename)
+{
+    knob_values values;
+    if (!load_knob_values(filename, values))
+        return false;
+
+    best_values = values;
+    apply(values);
+    return true;
+}
+
+}
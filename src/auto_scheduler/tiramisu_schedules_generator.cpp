@@ -1,12 +1,145 @@
 #include <tiramisu/auto_scheduler/schedules_generator.h>
 #include <tiramisu/auto_scheduler/evaluator.h>
 
+#include <algorithm>
+#include <cstdlib>
+
 namespace tiramisu::auto_scheduler
 {
 
+namespace
+{
+
+/**
+ * Return true if an optimization, other than fusion and the optimizations of "allowed",
+ * has been applied to one of the given computations.
+ */
+bool is_transformed(syntax_tree const& ast, std::vector<tiramisu::computation*> const& comps,
+                    std::vector<optimization_type> const& allowed)
+{
+    for (optimization_info const& optim_info : ast.get_schedule())
+    {
+        if (std::find(allowed.begin(), allowed.end(), optim_info.type) != allowed.end())
+            continue;
+
+        for (tiramisu::computation *comp : optim_info.comps)
+            if (std::find(comps.begin(), comps.end(), comp) != comps.end())
+                return true;
+    }
+
+    return false;
+}
+
+/**
+ * Return the number of iterations of the computations enclosed by the given loop,
+ * the loops outside it counting for one iteration.
+ */
+long get_nb_enclosed_iterations(ast_node *node)
+{
+    long nb_iterations = 0;
+
+    std::vector<ast_node*> to_visit = {node};
+    while (!to_visit.empty())
+    {
+        ast_node *current = to_visit.back();
+        to_visit.pop_back();
+
+        for (ast_node *child : current->children)
+            to_visit.push_back(child);
+
+        for (computation_info const& comp_info : current->computations)
+        {
+            long comp_iterations = 1;
+            for (int j = node->depth; j < comp_info.iters->size(); ++j)
+                comp_iterations *= (*comp_info.iters)[j].up_bound - (*comp_info.iters)[j].low_bound + 1;
+
+            nb_iterations += comp_iterations;
+        }
+    }
+
+    return nb_iterations;
+}
+
+}
+
+void schedules_generator::set_cpu_target(Halide::Target const& target)
+{
+    int vector_length = target.natural_vector_size(Halide::Float(32));
+    vectorization_factors_list = {vector_length, 2 * vector_length, 4 * vector_length};
+}
+
+void schedules_generator::generate_unimodular_transformations(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast)
+{
+    int nb_levels = std::min(node->get_loop_levels_chain_depth() - node->depth, unimodular_max_depth);
+
+    if (nb_levels < 3 || node->unrolled || node->distributed || node->gpu_block || node->gpu_thread)
+    {
+        for (ast_node *child : node->children)
+            generate_unimodular_transformations(child, states, ast);
+
+        return;
+    }
+
+    if (oracle == nullptr || oracle_function != ast.fct)
+    {
+        oracle = std::make_shared<legality_oracle>(ast.fct);
+        oracle_function = ast.fct;
+    }
+
+    std::vector<tiramisu::computation*> involved_computations;
+    node->get_all_computations(involved_computations);
+
+    std::vector<std::vector<std::vector<int>>> matrices =
+        oracle->find_tiling_transformations(ast.get_schedule(), involved_computations, node->depth, nb_levels,
+                                            unimodular_max_coefficient, unimodular_solutions_number);
+
+    for (std::vector<std::vector<int>> const& matrix : matrices)
+    {
+        // Copy the AST, and add the transformation to the list of optimizations
+        syntax_tree* new_ast = new syntax_tree();
+        ast_node *new_node = ast.copy_and_return_node(*new_ast, node);
+
+        optimization_info optim_info;
+        optim_info.type = optimization_type::UNIMODULAR;
+        optim_info.node = new_node;
+
+        optim_info.nb_l = nb_levels;
+        optim_info.l0 = node->depth;
+        optim_info.matrix = matrix;
+        optim_info.comps = involved_computations;
+
+        new_ast->new_optims.push_back(optim_info);
+        states.push_back(new_ast);
+    }
+}
+
+std::vector<syntax_tree*> schedules_generator::prune_schedules(std::vector<syntax_tree*>& states)
+{
+    // The computations of a block are transformed together
+    states.erase(std::remove_if(states.begin(), states.end(), [](syntax_tree *state) {
+        if (state->new_optims.empty() || state->respects_blocks(state->new_optims.back()))
+            return false;
+
+        delete state;
+        return true;
+    }), states.end());
+
+    if (pruner != nullptr)
+        pruner->prune(states);
+
+    return states;
+}
+
 std::vector<syntax_tree*> exhaustive_generator::generate_schedules(syntax_tree const& ast, optimization_type optim)
 {
     std::vector<syntax_tree*> states;
+
+    // On GPUs, the loops are parallelized by mapping them to blocks and threads,
+    // which is done on the loop levels of the original program.
+    if (gpu_target && (optim == optimization_type::TILING || optim == optimization_type::INTERCHANGE ||
+                       optim == optimization_type::UNIMODULAR || optim == optimization_type::UNROLL_AND_JAM ||
+                       optim == optimization_type::VECTORIZATION))
+        return states;
     
     switch(optim)
     {
@@ -14,6 +147,12 @@ std::vector<syntax_tree*> exhaustive_generator::generate_schedules(syntax_tree c
             generate_fusions(ast.roots, states, ast);
             break;
 
+        case optimization_type::FISSION:
+            for (ast_node *root : ast.roots)
+                generate_fissions(root, states, ast);
+
+            break;
+
         case optimization_type::TILING:
             for (ast_node *root : ast.roots)
                 generate_tilings(root, states, ast);
@@ -26,29 +165,86 @@ std::vector<syntax_tree*> exhaustive_generator::generate_schedules(syntax_tree c
                     
             break;
 
+        case optimization_type::UNIMODULAR:
+            for (ast_node *root : ast.roots)
+                generate_unimodular_transformations(root, states, ast);
+
+            break;
+
         case optimization_type::UNROLLING:
             for (ast_node *root : ast.roots)
                 generate_unrollings(root, states, ast);
                     
             break;
 
+        case optimization_type::UNROLL_AND_JAM:
+            for (ast_node *root : ast.roots)
+                generate_unroll_and_jams(root, states, ast);
+
+            break;
+
+        case optimization_type::VECTORIZATION:
+            for (ast_node *root : ast.roots)
+                generate_vectorizations(root, states, ast);
+                    
+            break;
+
+        case optimization_type::GPU_MAPPING:
+            if (gpu_target)
+                for (ast_node *root : ast.roots)
+                    generate_gpu_mappings(root, states, ast);
+
+            break;
+
+        case optimization_type::THREAD_COARSENING:
+            if (gpu_target)
+                for (ast_node *root : ast.roots)
+                    generate_thread_coarsenings(root, states, ast);
+
+            break;
+
+        case optimization_type::GPU_SPLIT_REDUCTION:
+            if (gpu_target)
+                for (ast_node *root : ast.roots)
+                    generate_gpu_split_reductions(root, states, ast);
+
+            break;
+
+        case optimization_type::SHARED_MEMORY_CACHING:
+            if (gpu_target)
+                generate_shared_memory_cachings(states, ast);
+
+            break;
+
+        case optimization_type::LOCAL_TRANSPOSITION:
+            if (!gpu_target)
+                generate_local_transpositions(states, ast);
+
+            break;
+
+        case optimization_type::DISTRIBUTION:
+            if (nb_ranks > 1)
+                generate_distributions(states, ast);
+
+            break;
+
         default:
             break;
     }
     
-    return states;
+    return prune_schedules(states);
 }
 
 void exhaustive_generator::generate_fusions(std::vector<ast_node*> const& tree_level, std::vector<syntax_tree*>& states, syntax_tree const& ast)
 {
     for (int i = 0; i < tree_level.size(); ++i)
     {
-        if (tree_level[i]->unrolled || tree_level[i]->get_extent() <= 1)
+        if (tree_level[i]->unrolled || tree_level[i]->gpu_block || tree_level[i]->get_extent() <= 1)
             continue;
 
         for (int j = i + 1; j < tree_level.size(); ++j)
         {
-            if (tree_level[j]->unrolled || tree_level[j]->get_extent() <= 1)
+            if (tree_level[j]->unrolled || tree_level[j]->gpu_block || tree_level[j]->get_extent() <= 1)
                 continue;
 
             if (tree_level[i]->name == tree_level[j]->name &&
@@ -70,6 +266,32 @@ void exhaustive_generator::generate_fusions(std::vector<ast_node*> const& tree_l
                 
                 states.push_back(new_ast);
             }
+
+            // Otherwise, look for a shift of the second loop that makes the fusion legal
+            else
+            {
+                int shift;
+                std::vector<tiramisu::computation*> consumers;
+                if (!get_fusion_shift(tree_level[i], tree_level[j], ast, shift, consumers))
+                    continue;
+
+                syntax_tree* new_ast = new syntax_tree();
+                ast_node *new_node = ast.copy_and_return_node(*new_ast, tree_level[i]);
+
+                optimization_info optim_info;
+                optim_info.type = optimization_type::FUSION;
+                optim_info.node = new_node;
+
+                optim_info.nb_l = 2;
+                optim_info.l0 = i;
+                optim_info.l1 = j;
+                optim_info.l2 = tree_level[i]->depth;
+                optim_info.l0_fact = shift;
+                optim_info.comps = consumers;
+                new_ast->new_optims.push_back(optim_info);
+
+                states.push_back(new_ast);
+            }
         }
     }
 
@@ -77,10 +299,151 @@ void exhaustive_generator::generate_fusions(std::vector<ast_node*> const& tree_l
         generate_fusions(node->children, states, ast);
 }
 
+bool exhaustive_generator::get_fusion_shift(ast_node *node1, ast_node *node2, syntax_tree const& ast, int& shift,
+                                            std::vector<tiramisu::computation*>& consumers)
+{
+    std::vector<tiramisu::computation*> producers;
+    node1->get_all_computations(producers);
+    node2->get_all_computations(consumers);
+
+    if (producers.empty() || consumers.empty())
+        return false;
+
+    ast.stage_isl_states();
+    ast.fct->prepare_schedules_for_legality_checks(false);
+
+    // The consumers are shifted together : they must all need the same shift
+    bool result = true;
+    for (int k = 0; k < consumers.size() && result; ++k)
+    {
+        std::vector<int> shifts;
+        result = ast.fct->compute_fusion_shifts(producers, consumers[k], node1->depth, shifts, node1->depth);
+
+        if (result && k == 0)
+            shift = shifts[node1->depth];
+        else if (result)
+            result = shifts[node1->depth] == shift;
+    }
+
+    ast.recover_isl_states();
+
+    return result;
+}
+
+void exhaustive_generator::generate_fissions(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast)
+{
+    int nb_comps = node->computations.size();
+    int nb_parts = nb_comps + (node->children.empty() ? 0 : 1);
+
+    for (int split = 1; split < nb_parts; ++split)
+    {
+        // The computations before split stay in the loop nest, the others and the children are moved
+        std::vector<tiramisu::computation*> first_comps, second_comps;
+        for (int i = 0; i < nb_comps; ++i)
+        {
+            if (i < split)
+                first_comps.push_back(node->computations[i].comp_ptr);
+            else
+                second_comps.push_back(node->computations[i].comp_ptr);
+        }
+
+        for (ast_node *child : node->children)
+            child->get_all_computations(second_comps);
+
+        if (ast.splits_block(second_comps))
+            continue;
+
+        for (ast_node *head = node; ; head = head->parent)
+        {
+            if (head->unrolled || head->vectorized || head->gpu_block || head->gpu_thread || head->distributed)
+                break;
+
+            ast.stage_isl_states();
+            bool result = ast.fct->loop_distribution_is_legal(head->depth, first_comps, second_comps);
+            ast.recover_isl_states();
+
+            if (result)
+            {
+                // Copy the AST, and add fission to the list of optimizations
+                syntax_tree* new_ast = new syntax_tree();
+                ast_node *new_node = ast.copy_and_return_node(*new_ast, node);
+
+                optimization_info optim_info;
+                optim_info.type = optimization_type::FISSION;
+                optim_info.node = new_node;
+
+                optim_info.nb_l = node->depth - head->depth + 1;
+                optim_info.l0 = head->depth;
+                optim_info.l1 = split;
+                optim_info.comps = second_comps;
+
+                new_ast->new_optims.push_back(optim_info);
+                states.push_back(new_ast);
+            }
+
+            // The loops above head are also distributed if they only enclose head
+            if (head->parent == nullptr || head->parent->children.size() != 1 || !head->parent->computations.empty())
+                break;
+        }
+    }
+
+    for (ast_node *child : node->children)
+        generate_fissions(child, states, ast);
+}
+
 void exhaustive_generator::generate_tilings(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast)
 {
     int branch_depth = node->get_loop_levels_chain_depth();
+
+    // The loops over the ranks are not tiled
+    if (node->distributed)
+    {
+        for (ast_node *child : node->children)
+            generate_tilings(child, states, ast);
+
+        return ;
+    }
     
+    // Let the explorer choose the tiling factors
+    if (tile_explorer != nullptr)
+    {
+        for (int nb_tiled_loops = 2; nb_tiled_loops <= 3 && node->depth + nb_tiled_loops - 1 < branch_depth; ++nb_tiled_loops)
+        {
+            for (std::vector<int> const& tile_sizes : tile_explorer->explore_tile_sizes(node, nb_tiled_loops))
+            {
+                // Copy the AST, and add tiling to the list of optimizations
+                syntax_tree *new_ast = new syntax_tree();
+                ast_node *new_node = ast.copy_and_return_node(*new_ast, node);
+                    
+                optimization_info optim_info;
+                optim_info.type = optimization_type::TILING;
+                optim_info.node = new_node;
+                
+                optim_info.nb_l = nb_tiled_loops;
+                optim_info.l0 = node->depth;
+                optim_info.l1 = node->depth + 1;
+                optim_info.l0_fact = tile_sizes[0];
+                optim_info.l1_fact = tile_sizes[1];
+
+                if (nb_tiled_loops == 3)
+                {
+                    optim_info.l2 = node->depth + 2;
+                    optim_info.l2_fact = tile_sizes[2];
+                }
+                
+                new_node->get_all_computations(optim_info.comps);
+                
+                new_ast->new_optims.push_back(optim_info);
+                states.push_back(new_ast);
+            }
+        }
+
+        for (ast_node *child : node->children)
+            generate_tilings(child, states, ast);
+
+        return ;
+    }
+
     // Generate tiling with dimension 2
     if (node->depth + 1 < branch_depth)
     {
@@ -157,7 +520,7 @@ void exhaustive_generator::generate_tilings(ast_node *node, std::vector<syntax_t
 
 void exhaustive_generator::generate_interchanges(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast)
 {
-    if (!node->unrolled && node->get_extent() > 1)
+    if (!node->unrolled && !node->distributed && node->get_extent() > 1)
     {
         int branch_depth = node->get_loop_levels_chain_depth();
         
@@ -180,41 +543,485 @@ void exhaustive_generator::generate_interchanges(ast_node *node, std::vector<syn
             states.push_back(new_ast);
         }
     }
-    
-    for (ast_node *child : node->children)
-        generate_interchanges(child, states, ast);
-}
+    
+    for (ast_node *child : node->children)
+        generate_interchanges(child, states, ast);
+}
+
+void exhaustive_generator::generate_unrollings(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast)
+{
+    if (!node->unrolled && !node->gpu_block && !node->gpu_thread && !node->distributed && node->get_extent() > 1)
+    {
+        for (int unrolling_factor : unrolling_factors_list)
+        {
+            if (node->get_extent() != unrolling_factor && 
+                !can_split_iterator(node->get_extent(), unrolling_factor))
+                continue;
+                
+            // Copy the AST, and add unrolling to the list of optimizations
+            syntax_tree* new_ast = new syntax_tree();
+            ast_node *new_node = ast.copy_and_return_node(*new_ast, node);
+
+            optimization_info optim_info;
+            optim_info.type = optimization_type::UNROLLING;
+            optim_info.node = new_node;
+                
+            optim_info.nb_l = 1;
+            optim_info.l0 = node->depth;
+            optim_info.l0_fact = unrolling_factor;
+            new_node->get_all_computations(optim_info.comps);
+                
+            new_ast->new_optims.push_back(optim_info);
+            states.push_back(new_ast);
+        }
+    }
+    
+    for (ast_node *child : node->children)
+        generate_unrollings(child, states, ast);
+}
+
+void exhaustive_generator::generate_unroll_and_jams(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast)
+{
+    // The copies can only be jammed into the body of a perfect loop nest
+    ast_node *innermost = node;
+    while (innermost->children.size() == 1 && innermost->computations.empty())
+        innermost = innermost->children[0];
+
+    bool perfect_nest = innermost != node && innermost->children.empty() &&
+                        !innermost->unrolled && !innermost->vectorized;
+
+    if (perfect_nest && !node->unrolled && !node->distributed && node->get_extent() > 1)
+    {
+        for (int unrolling_factor : unrolling_factors_list)
+        {
+            if (!can_split_iterator(node->get_extent(), unrolling_factor))
+                continue;
+
+            // Copy the AST, and add unroll-and-jam to the list of optimizations
+            syntax_tree* new_ast = new syntax_tree();
+            ast_node *new_node = ast.copy_and_return_node(*new_ast, node);
+
+            optimization_info optim_info;
+            optim_info.type = optimization_type::UNROLL_AND_JAM;
+            optim_info.node = new_node;
+
+            optim_info.nb_l = 1;
+            optim_info.l0 = node->depth;
+            optim_info.l0_fact = unrolling_factor;
+            new_node->get_all_computations(optim_info.comps);
+
+            new_ast->new_optims.push_back(optim_info);
+            states.push_back(new_ast);
+        }
+    }
+
+    for (ast_node *child : node->children)
+        generate_unroll_and_jams(child, states, ast);
+}
+
+void exhaustive_generator::generate_vectorizations(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast)
+{
+    // Only innermost loop levels are vectorized
+    if (node->children.empty() && !node->unrolled && !node->vectorized && node->get_extent() > 1)
+    {
+        std::vector<tiramisu::computation*> involved_computations;
+        node->get_all_computations(involved_computations);
+
+        ast.stage_isl_states();
+
+        std::string loop_name = involved_computations[0]->get_loop_level_names()[node->depth];
+        bool result = ast.fct->loop_vectorization_is_legal(var(loop_name), involved_computations);
+
+        ast.recover_isl_states();
+
+        if (result)
+        {
+            for (int vectorization_factor : vectorization_factors_list)
+            {
+                if (node->get_extent() != vectorization_factor &&
+                    !can_split_iterator(node->get_extent(), vectorization_factor))
+                    continue;
+
+                // Copy the AST, and add vectorization to the list of optimizations
+                syntax_tree* new_ast = new syntax_tree();
+                ast_node *new_node = ast.copy_and_return_node(*new_ast, node);
+
+                optimization_info optim_info;
+                optim_info.type = optimization_type::VECTORIZATION;
+                optim_info.node = new_node;
+
+                optim_info.nb_l = 1;
+                optim_info.l0 = node->depth;
+                optim_info.l0_fact = vectorization_factor;
+                new_node->get_all_computations(optim_info.comps);
+
+                new_ast->new_optims.push_back(optim_info);
+                states.push_back(new_ast);
+
+                if (vectorization_peeling && involved_computations.size() == 1)
+                {
+                    syntax_tree* peeled_ast = new syntax_tree();
+                    ast_node *peeled_node = ast.copy_and_return_node(*peeled_ast, node);
+
+                    optim_info.node = peeled_node;
+                    optim_info.l1_fact = 1;
+                    optim_info.comps.clear();
+                    peeled_node->get_all_computations(optim_info.comps);
+
+                    peeled_ast->new_optims.push_back(optim_info);
+                    states.push_back(peeled_ast);
+                }
+            }
+        }
+    }
+
+    for (ast_node *child : node->children)
+        generate_vectorizations(child, states, ast);
+}
+
+void exhaustive_generator::generate_gpu_mappings(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast)
+{
+    std::vector<tiramisu::computation*> involved_computations;
+    node->get_all_computations(involved_computations);
+
+    if (node->depth + 1 < node->get_loop_levels_chain_depth() && node->get_extent() > 1 &&
+        !is_transformed(ast, involved_computations, {}))
+    {
+        ast_node *node2 = node->children[0];
+
+        ast.stage_isl_states();
+
+        std::vector<std::string> loop_names = involved_computations[0]->get_loop_level_names();
+        bool result = ast.fct->loop_parallelization_is_legal(var(loop_names[node->depth]), involved_computations) &&
+                      ast.fct->loop_parallelization_is_legal(var(loop_names[node2->depth]), involved_computations);
+
+        ast.recover_isl_states();
+
+        if (result)
+        {
+            for (std::tuple<int,int> const& block_size : gpu_block_sizes_list)
+            {
+                if (!can_split_iterator(node->get_extent(), std::get<0>(block_size)) ||
+                    !can_split_iterator(node2->get_extent(), std::get<1>(block_size)))
+                    continue;
+
+                // Copy the AST, and add GPU mapping to the list of optimizations
+                syntax_tree* new_ast = new syntax_tree();
+                ast_node *new_node = ast.copy_and_return_node(*new_ast, node);
+
+                optimization_info optim_info;
+                optim_info.type = optimization_type::GPU_MAPPING;
+                optim_info.node = new_node;
+
+                optim_info.nb_l = 2;
+                optim_info.l0 = node->depth;
+                optim_info.l1 = node->depth + 1;
+                optim_info.l0_fact = std::get<0>(block_size);
+                optim_info.l1_fact = std::get<1>(block_size);
+                new_node->get_all_computations(optim_info.comps);
+
+                new_ast->new_optims.push_back(optim_info);
+                states.push_back(new_ast);
+            }
+
+            // The loops inside the mapped levels are run by the threads
+            return ;
+        }
+    }
+
+    for (ast_node *child : node->children)
+        generate_gpu_mappings(child, states, ast);
+}
+
+void exhaustive_generator::generate_thread_coarsenings(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast)
+{
+    if (node->gpu_block && node->children[0]->gpu_block)
+    {
+        std::vector<tiramisu::computation*> involved_computations;
+        node->get_all_computations(involved_computations);
+
+        if (is_transformed(ast, involved_computations, {optimization_type::GPU_MAPPING}))
+            return ;
+
+        ast_node *node2 = node->children[0];
+        for (std::tuple<int,int> const& factors : thread_coarsening_factors_list)
+        {
+            if ((std::get<0>(factors) > 1 && !can_split_iterator(node->get_extent(), std::get<0>(factors))) ||
+                (std::get<1>(factors) > 1 && !can_split_iterator(node2->get_extent(), std::get<1>(factors))))
+                continue;
+
+            // Copy the AST, and add thread coarsening to the list of optimizations
+            syntax_tree* new_ast = new syntax_tree();
+            ast_node *new_node = ast.copy_and_return_node(*new_ast, node);
+
+            optimization_info optim_info;
+            optim_info.type = optimization_type::THREAD_COARSENING;
+            optim_info.node = new_node;
+
+            optim_info.nb_l = 2;
+            optim_info.l0 = node->depth;
+            optim_info.l1 = node->depth + 1;
+            optim_info.l0_fact = std::get<0>(factors);
+            optim_info.l1_fact = std::get<1>(factors);
+            optim_info.comps = involved_computations;
+
+            new_ast->new_optims.push_back(optim_info);
+            states.push_back(new_ast);
+        }
+
+        return ;
+    }
+
+    for (ast_node *child : node->children)
+        generate_thread_coarsenings(child, states, ast);
+}
+
+void exhaustive_generator::generate_gpu_split_reductions(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast)
+{
+    if (node->gpu_block && !node->children[0]->gpu_block)
+    {
+        std::vector<tiramisu::computation*> involved_computations;
+        node->get_all_computations(involved_computations);
+
+        // The block levels of a single computation, the third block dimension being free
+        if (involved_computations.size() != 1 || (node->parent != nullptr && node->parent->parent != nullptr &&
+                                                  node->parent->parent->gpu_block) ||
+            is_transformed(ast, involved_computations, {optimization_type::GPU_MAPPING, optimization_type::THREAD_COARSENING}))
+            return ;
+
+        tiramisu::computation *comp = involved_computations[0];
+        ast_node *reduction = ast.computations_mapping.at(comp);
+        if (reduction->gpu_thread || reduction->get_extent() < 2 * GPU_SPLIT_REDUCTION_MIN_CHUNK)
+            return ;
+
+        // The update must be acc = acc op term
+        tiramisu::expr update = comp->get_expr();
+        auto is_accumulator = [comp](tiramisu::expr const& e) {
+            return e.get_expr_type() == e_op && e.get_op_type() == o_access && e.get_name() == comp->get_name();
+        };
+        if (update.get_expr_type() != e_op || update.get_n_arg() != 2 ||
+            (update.get_op_type() != o_add && update.get_op_type() != o_mul &&
+             update.get_op_type() != o_min && update.get_op_type() != o_max) ||
+            is_accumulator(update.get_operand(0)) == is_accumulator(update.get_operand(1)))
+            return ;
+
+        // The loop must carry the reduction, the other loops inside the threads are coarsening loops
+        ast.stage_isl_states();
+        bool parallel = ast.fct->loop_parallelization_is_legal(var(comp->get_loop_level_names()[reduction->depth]), {comp});
+        ast.recover_isl_states();
+        if (parallel)
+            return ;
+
+        for (int nb_chunks : gpu_split_reduction_factors_list)
+        {
+            if (!can_split_iterator(reduction->get_extent(), nb_chunks) ||
+                reduction->get_extent() / nb_chunks < GPU_SPLIT_REDUCTION_MIN_CHUNK)
+                continue;
+
+            // Copy the AST, and add the split reduction to the list of optimizations
+            syntax_tree* new_ast = new syntax_tree();
+            ast_node *new_node = ast.copy_and_return_node(*new_ast, reduction);
+
+            optimization_info optim_info;
+            optim_info.type = optimization_type::GPU_SPLIT_REDUCTION;
+            optim_info.node = new_node;
+
+            optim_info.nb_l = 1;
+            optim_info.l0 = reduction->depth;
+            optim_info.l0_fact = reduction->get_extent() / nb_chunks;
+            optim_info.l1_fact = nb_chunks;
+            optim_info.comps = involved_computations;
+
+            new_ast->new_optims.push_back(optim_info);
+            states.push_back(new_ast);
+        }
+
+        return ;
+    }
+
+    for (ast_node *child : node->children)
+        generate_gpu_split_reductions(child, states, ast);
+}
+
+void exhaustive_generator::generate_shared_memory_cachings(std::vector<syntax_tree*>& states, syntax_tree const& ast)
+{
+    std::vector<optimization_info> schedule = ast.get_schedule();
+
+    for (optimization_info const& mapping : schedule)
+    {
+        if (mapping.type != optimization_type::GPU_MAPPING)
+            continue;
+
+        for (tiramisu::computation *comp : mapping.comps)
+        {
+            if (is_transformed(ast, {comp}, {optimization_type::GPU_MAPPING, optimization_type::THREAD_COARSENING,
+                                             optimization_type::SHARED_MEMORY_CACHING}))
+                continue;
+
+            // The inputs already cached by comp, and the shared memory they use
+            std::vector<std::string> cached_inputs;
+            long used_size = 0;
+
+            for (optimization_info const& optim_info : schedule)
+            {
+                shared_memory_footprint footprint;
+                if (optim_info.type == optimization_type::SHARED_MEMORY_CACHING && optim_info.comps[0] == comp &&
+                    get_shared_memory_footprint(ast, comp, optim_info.l0, footprint))
+                {
+                    cached_inputs.push_back(footprint.input_name);
+                    used_size += footprint.size;
+                }
+            }
+
+            std::shared_ptr<dnn_accesses> comp_accesses;
+            for (computation_info const& comp_info : ast.computations_mapping.at(comp)->computations)
+                if (comp_info.comp_ptr == comp)
+                    comp_accesses = comp_info.accesses;
+
+            std::vector<dnn_access_matrix> const& accesses = comp_accesses->accesses_list;
+            for (int i = 0; i < accesses.size(); ++i)
+            {
+                shared_memory_footprint footprint;
+                if (std::find(cached_inputs.begin(), cached_inputs.end(), accesses[i].buffer_name) != cached_inputs.end() ||
+                    !get_shared_memory_footprint(ast, comp, i, footprint) ||
+                    used_size + footprint.size > GPU_SHARED_MEMORY_SIZE)
+                    continue;
+
+                // All the accesses to the input are cached together
+                cached_inputs.push_back(footprint.input_name);
+
+                // Copy the AST, and add shared memory caching to the list of optimizations
+                syntax_tree* new_ast = ast.copy_ast();
+
+                optimization_info optim_info;
+                optim_info.type = optimization_type::SHARED_MEMORY_CACHING;
+                optim_info.node = nullptr;
+
+                optim_info.nb_l = 1;
+                optim_info.l0 = i;
+                optim_info.comps = {comp};
+
+                new_ast->new_optims.push_back(optim_info);
+                states.push_back(new_ast);
+            }
+        }
+    }
+}
+
+void exhaustive_generator::generate_local_transpositions(std::vector<syntax_tree*>& states, syntax_tree const& ast)
+{
+    std::vector<optimization_info> schedule = ast.get_schedule();
+
+    for (tiramisu::computation *comp : ast.computations_list)
+    {
+        if (ast.computations_mapping.find(comp) == ast.computations_mapping.end())
+            continue;
+
+
+        // The producers already transposed for comp
+        std::vector<std::string> transposed_inputs;
+        for (optimization_info const& optim_info : schedule)
+        {
+            std::string input_name;
+            int level;
+            if (optim_info.type == optimization_type::LOCAL_TRANSPOSITION && optim_info.comps[0] == comp &&
+                get_local_transposition(ast, comp, optim_info.l0, input_name, level))
+                transposed_inputs.push_back(input_name);
+        }
+
+        for (computation_info const& comp_info : ast.computations_mapping.at(comp)->computations)
+        {
+            if (comp_info.comp_ptr != comp)
+                continue;
+
+            for (int i = 0; i < comp_info.accesses->accesses_list.size(); ++i)
+            {
+                std::string input_name;
+                int level;
+                if (!get_local_transposition(ast, comp, i, input_name, level) ||
+                    std::find(transposed_inputs.begin(), transposed_inputs.end(), input_name) != transposed_inputs.end())
+                    continue;
+
+                // All the accesses to the producer read the same panel
+                transposed_inputs.push_back(input_name);
+
+                syntax_tree* new_ast = ast.copy_ast();
+
+                optimization_info optim_info;
+                optim_info.type = optimization_type::LOCAL_TRANSPOSITION;
+                optim_info.node = nullptr;
+
+                optim_info.nb_l = 1;
+                optim_info.l0 = i;
+                optim_info.comps = {comp};
+
+                new_ast->new_optims.push_back(optim_info);
+                states.push_back(new_ast);
+            }
+        }
+    }
+}
+
+void exhaustive_generator::generate_distributions(std::vector<syntax_tree*>& states, syntax_tree const& ast)
+{
+    if (ast.roots.empty())
+        return ;
+
+    // All the loop nests are distributed along the same blocks
+    ast_node *first_root = ast.roots[0];
+    std::vector<tiramisu::computation*> involved_computations;
+
+    for (ast_node *root : ast.roots)
+    {
+        if (root->distributed || root->low_bound != 0 || root->up_bound != first_root->up_bound)
+            return ;
+
+        root->get_all_computations(involved_computations);
+    }
+
+    if (is_transformed(ast, involved_computations, {}))
+        return ;
+
+    // The ranks compute their blocks in parallel
+    ast.stage_isl_states();
+
+    bool result = true;
+    for (ast_node *root : ast.roots)
+    {
+        std::vector<tiramisu::computation*> root_computations;
+        root->get_all_computations(root_computations);
+
+        std::vector<std::string> loop_names = root_computations[0]->get_loop_level_names();
+        result = result && ast.fct->loop_parallelization_is_legal(var(loop_names[0]), root_computations);
+    }
 
-void exhaustive_generator::generate_unrollings(ast_node *node, std::vector<syntax_tree*>& states, syntax_tree const& ast)
-{
-    if (!node->unrolled && node->get_extent() > 1)
+    ast.recover_isl_states();
+
+    if (!result)
+        return ;
+
+    for (int nb_used_ranks = 2; nb_used_ranks <= nb_ranks; ++nb_used_ranks)
     {
-        for (int unrolling_factor : unrolling_factors_list)
-        {
-            if (node->get_extent() != unrolling_factor && 
-                !can_split_iterator(node->get_extent(), unrolling_factor))
-                continue;
-                
-            // Copy the AST, and add unrolling to the list of optimizations
-            syntax_tree* new_ast = new syntax_tree();
-            ast_node *new_node = ast.copy_and_return_node(*new_ast, node);
+        if (nb_ranks % nb_used_ranks != 0 || first_root->get_extent() % nb_used_ranks != 0)
+            continue;
 
-            optimization_info optim_info;
-            optim_info.type = optimization_type::UNROLLING;
-            optim_info.node = new_node;
-                
-            optim_info.nb_l = 1;
-            optim_info.l0 = node->depth;
-            optim_info.l0_fact = unrolling_factor;
-            new_node->get_all_computations(optim_info.comps);
-                
-            new_ast->new_optims.push_back(optim_info);
-            states.push_back(new_ast);
-        }
+        // Copy the AST, and add distribution to the list of optimizations
+        syntax_tree* new_ast = new syntax_tree();
+        ast_node *new_node = ast.copy_and_return_node(*new_ast, first_root);
+
+        optimization_info optim_info;
+        optim_info.type = optimization_type::DISTRIBUTION;
+        optim_info.node = new_node;
+
+        optim_info.nb_l = 1;
+        optim_info.l0 = 0;
+        optim_info.l0_fact = nb_used_ranks;
+        optim_info.l1_fact = first_root->get_extent() / nb_used_ranks;
+        optim_info.comps = involved_computations;
+
+        new_ast->new_optims.push_back(optim_info);
+        states.push_back(new_ast);
     }
-    
-    for (ast_node *child : node->children)
-        generate_unrollings(child, states, ast);
 }
 
 std::vector<syntax_tree*> ml_model_schedules_generator::generate_schedules(syntax_tree const& ast, optimization_type optim)
@@ -286,6 +1093,48 @@ std::vector<syntax_tree*> ml_model_schedules_generator::generate_schedules(synta
             // use nb try as to count if we reached last commun possible node (to disable 3layers tiling);
             nb_try = 0;
             
+            // Let the explorer choose the tiling factors
+            if (tile_explorer != nullptr)
+            {
+                for (auto& node_iterator:shared_nodes)
+                {
+                    int max_nb_tiled_loops = ((nb_try + 1) < shared_nodes.size()) ? 3 : 2;
+
+                    for (int nb_tiled_loops = 2; nb_tiled_loops <= max_nb_tiled_loops; ++nb_tiled_loops)
+                    {
+                        for (std::vector<int> const& tile_sizes : tile_explorer->explore_tile_sizes(node_iterator, nb_tiled_loops))
+                        {
+                            // Copy the AST and add tiling to the list of optimizations
+                            syntax_tree* new_ast = new syntax_tree();
+                            ast_node *new_node = ast.copy_and_return_node(*new_ast, node_iterator);
+                            
+                            optimization_info optim_info;
+                            optim_info.type = optimization_type::TILING;
+                            optim_info.node = new_node;
+                            optim_info.nb_l = nb_tiled_loops;
+                            optim_info.l0 = node_iterator->depth;
+                            optim_info.l1 = node_iterator->depth + 1;
+                            optim_info.l0_fact = tile_sizes[0];
+                            optim_info.l1_fact = tile_sizes[1];
+
+                            if (nb_tiled_loops == 3)
+                            {
+                                optim_info.l2 = node_iterator->depth + 2;
+                                optim_info.l2_fact = tile_sizes[2];
+                            }
+
+                            optim_info.comps = new_ast->computations_list;
+                            new_ast->new_optims.push_back(optim_info);
+                            states.push_back(new_ast);
+                        }
+                    }
+
+                    nb_try++;
+                }
+
+                break;
+            }
+
             for (auto& node_iterator:shared_nodes)
             {
                 for (int tiling_size1 : tiling_factors_list)
@@ -460,6 +1309,69 @@ std::vector<syntax_tree*> ml_model_schedules_generator::generate_schedules(synta
             ast.recover_isl_states();
 
     
+            break;
+
+        case optimization_type::VECTORIZATION:
+
+            ast.stage_isl_states();
+
+            node->get_innermost_nodes(innermost_nodes);
+
+            // Search for possible vectorizations from the bottom loop
+            std::reverse(innermost_nodes.begin(),innermost_nodes.end());
+
+            for (ast_node* inner_most_node: innermost_nodes)
+            {
+                if (nb_try == this->vectorization_search_depth)
+                    break;
+
+                nb_try++;
+
+                if (inner_most_node->unrolled || inner_most_node->vectorized)
+                    continue;
+
+                std::vector<tiramisu::computation*> involved_computations;
+                inner_most_node->get_all_computations(involved_computations);
+
+                std::vector<std::string> loop_names = involved_computations[0]->get_loop_level_names();
+
+                std::string loop_name = loop_names[inner_most_node->depth];
+
+                bool result = ast.fct->loop_vectorization_is_legal(var(loop_name),involved_computations);
+
+                if(result) // vectorizable: test all possible vector lengths
+                {
+                    ast.recover_isl_states();
+
+                    for (int vectorization_fact : vectorization_factors_list)
+                    {
+                        if (inner_most_node->get_extent() != vectorization_fact &&
+                            !can_split_iterator(inner_most_node->get_extent(), vectorization_fact))
+                            continue;
+
+                        // Copy the AST and add vectorization to the list of optimizations
+                        syntax_tree* new_ast = new syntax_tree();
+                        ast_node *new_node = ast.copy_and_return_node(*new_ast, inner_most_node);
+
+                        optimization_info optim_info;
+                        optim_info.type = optimization_type::VECTORIZATION;
+                        optim_info.nb_l = 1;
+
+                        optim_info.l0 = new_node->depth;
+                        optim_info.l0_fact = vectorization_fact;
+                        // select this node
+                        optim_info.node = new_node;
+                        new_node->get_all_computations(optim_info.comps);
+                        new_ast->new_optims.push_back(optim_info);
+                        states.push_back(new_ast);
+                    }
+
+                    ast.stage_isl_states();
+                }
+            }
+
+            ast.recover_isl_states();
+
             break;
 
         case optimization_type::PARALLELIZE:
@@ -492,6 +1404,16 @@ std::vector<syntax_tree*> ml_model_schedules_generator::generate_schedules(synta
                 
                 bool result = ast.fct->loop_parallelization_is_legal(var(loop_name),involved_computations);
 
+                // A level of few iterations can be collapsed with the next shared level if
+                // that one has constant bounds and can be parallelized too
+                ast_node *inner_node = (commun_node->children.size() == 1) ? commun_node->children[0] : nullptr;
+                bool collapse = result && commun_node->get_extent() < this->parallel_collapse_max_extent &&
+                                commun_node->computations.empty() && inner_node != nullptr &&
+                                inner_node->constant_bounds && inner_node->get_extent() > 1 &&
+                                std::find(shared_nodes.begin(), shared_nodes.end(), inner_node) != shared_nodes.end() &&
+                                ast.fct->loop_parallelization_is_legal(var(loop_names[inner_node->depth]),
+                                                                       involved_computations);
+
                 if(result) // unrollable: test all possible values
                 {
                     ast.recover_isl_states();
@@ -512,7 +1434,18 @@ std::vector<syntax_tree*> ml_model_schedules_generator::generate_schedules(synta
                     optim_info.comps = involved_computations;
                     new_ast->new_optims.push_back(optim_info);
                     states.push_back(new_ast);
-                
+
+                    if (collapse)
+                    {
+                        syntax_tree* collapsed_ast = new syntax_tree();
+                        ast_node *collapsed_node = ast.copy_and_return_node(*collapsed_ast, commun_node);
+
+                        optim_info.nb_l = 2;
+                        optim_info.l1 = collapsed_node->depth + 1;
+                        optim_info.node = collapsed_node;
+                        collapsed_ast->new_optims.push_back(optim_info);
+                        states.push_back(collapsed_ast);
+                    }
 
                     ast.stage_isl_states();
                     
@@ -693,10 +1626,342 @@ std::vector<syntax_tree*> ml_model_schedules_generator::generate_schedules(synta
             ast.recover_isl_states();
             break;
 
+        case optimization_type::UNIMODULAR:
+            generate_unimodular_transformations(node, states, ast);
+            break;
+
         default:
             break;
     }
     
+    return prune_schedules(states);
+}
+
+std::vector<int> tile_size_explorer::get_candidate_sizes(int extent) const
+{
+    std::vector<int> sizes;
+
+    // Divisors of the extent, and powers of two
+    for (int size = min_tile_size; size < extent; ++size)
+        if (extent % size == 0 || (size & (size - 1)) == 0)
+            sizes.push_back(size);
+
+    return sizes;
+}
+
+long tile_size_explorer::get_tile_footprint(ast_node *node, std::vector<int> const& tile_sizes)
+{
+    long footprint = 0;
+    int band_begin = node->depth;
+    int band_end = node->depth + tile_sizes.size();
+
+    std::vector<ast_node*> to_visit = {node};
+    while (!to_visit.empty())
+    {
+        ast_node *current = to_visit.back();
+        to_visit.pop_back();
+
+        for (ast_node *child : current->children)
+            to_visit.push_back(child);
+
+        for (computation_info const& comp_info : current->computations)
+        {
+            // Number of iterations of each iterator inside a tile
+            std::vector<long> extents;
+            for (int j = 0; j < comp_info.iters->size(); ++j)
+            {
+                long extent = (*comp_info.iters)[j].up_bound - (*comp_info.iters)[j].low_bound + 1;
+
+                if (j < band_begin)
+                    extent = 1;
+                else if (j < band_end)
+                    extent = std::min(extent, (long)tile_sizes[j - band_begin]);
+
+                extents.push_back(extent);
+            }
+
+            // Elements read by each access :
+            // a dimension of the buffer spans sum(|coeff| * (extent - 1)) + 1 elements
+            for (dnn_access_matrix const& access : comp_info.accesses->accesses_list)
+            {
+                long nb_elements = 1;
+                for (std::vector<int> const& row : access.matrix)
+                {
+                    long dim_extent = 1;
+                    for (int j = 0; j < access.nb_iterators && j < extents.size(); ++j)
+                        dim_extent += std::abs(row[j]) * (extents[j] - 1);
+
+                    nb_elements *= dim_extent;
+                }
+
+                footprint += nb_elements * comp_info.data_type_size;
+            }
+
+            // Elements written : the output buffer is indexed by the outermost iterators
+            long nb_elements = 1;
+            for (int j = 0; j < comp_info.buffer_nb_dims && j < extents.size(); ++j)
+                nb_elements *= extents[j];
+
+            footprint += nb_elements * comp_info.data_type_size;
+        }
+    }
+
+    return footprint;
+}
+
+std::vector<std::vector<int>> tile_size_explorer::explore_tile_sizes(ast_node *node, int nb_tiled_loops) const
+{
+    // Get the candidate sizes of each loop of the band
+    std::vector<std::vector<int>> candidates;
+    ast_node *current = node;
+
+    for (int i = 0; i < nb_tiled_loops; ++i)
+    {
+        if (current == nullptr)
+            return {};
+
+        candidates.push_back(get_candidate_sizes(current->get_extent()));
+        if (candidates.back().empty())
+            return {};
+
+        current = current->children.empty() ? nullptr : current->children[0];
+    }
+
+    // Compute the footprint of all the combinations of candidate sizes
+    std::vector<std::pair<long, std::vector<int>>> tilings;
+    std::vector<int> index(nb_tiled_loops, 0);
+
+    while (true)
+    {
+        std::vector<int> tile_sizes(nb_tiled_loops);
+        for (int i = 0; i < nb_tiled_loops; ++i)
+            tile_sizes[i] = candidates[i][index[i]];
+
+        tilings.push_back({get_tile_footprint(node, tile_sizes), tile_sizes});
+
+        int i = nb_tiled_loops - 1;
+        while (i >= 0 && ++index[i] == candidates[i].size())
+        {
+            index[i] = 0;
+            i--;
+        }
+
+        if (i < 0)
+            break;
+    }
+
+    // Biggest footprints first, and for the same footprint, the most square tiles first
+    std::sort(tilings.begin(), tilings.end(), [](std::pair<long, std::vector<int>> const& a, std::pair<long, std::vector<int>> const& b) {
+        if (a.first != b.first)
+            return a.first > b.first;
+
+        return *std::max_element(a.second.begin(), a.second.end()) < *std::max_element(b.second.begin(), b.second.end());
+    });
+
+    // For each cache level, propose the biggest tiles that fit in the cache
+    std::vector<std::vector<int>> proposals;
+    for (long cache_size : cache_sizes)
+    {
+        int nb_proposed = 0;
+        for (auto const& tiling : tilings)
+        {
+            if (nb_proposed >= nb_tile_sizes_per_level)
+                break;
+
+            if (tiling.first > cache_size)
+                continue;
+
+            if (std::find(proposals.begin(), proposals.end(), tiling.second) != proposals.end())
+                continue;
+
+            proposals.push_back(tiling.second);
+            nb_proposed++;
+        }
+    }
+
+    return proposals;
+}
+
+
+bool candidate_pruner::is_pruned_by_rules(syntax_tree const& ast) const
+{
+    if (ast.new_optims.empty())
+        return false;
+
+    optimization_info const& optim_info = ast.new_optims.back();
+    ast_node *node = optim_info.node;
+
+    // The rules only look at the loop the optimization starts at
+    if (node == nullptr || node->depth != optim_info.l0)
+        return false;
+
+    switch (optim_info.type)
+    {
+        case optimization_type::TILING:
+        {
+            std::vector<int> tile_sizes = {optim_info.l0_fact, optim_info.l1_fact};
+            if (optim_info.nb_l == 3)
+                tile_sizes.push_back(optim_info.l2_fact);
+
+            // A tile that covers its whole loop does not tile it
+            ast_node *tiled_node = node;
+            for (int i = 0; i < tile_sizes.size() && tiled_node != nullptr; ++i)
+            {
+                if (tile_sizes[i] >= tiled_node->get_extent())
+                    return true;
+
+                tiled_node = tiled_node->children.empty() ? nullptr : tiled_node->children[0];
+            }
+
+            return tile_size_explorer::get_tile_footprint(node, tile_sizes) > cache_sizes.back() / aggressiveness;
+        }
+
+        // The iterations of a reduction level all write the same elements
+        case optimization_type::PARALLELIZE:
+            return node->get_extent() < 2 || get_nb_enclosed_iterations(node) < aggressiveness * min_parallel_iterations ||
+                   node->is_reduction_level();
+
+        case optimization_type::VECTORIZATION:
+            return optim_info.l0_fact > node->get_extent() || node->is_reduction_level();
+
+        case optimization_type::UNROLLING:
+        case optimization_type::UNROLL_AND_JAM:
+            return optim_info.l0_fact > node->get_extent();
+
+        default:
+            return false;
+    }
+}
+
+void candidate_pruner::prune(std::vector<syntax_tree*>& candidates)
+{
+    nb_candidates += candidates.size();
+
+    if (aggressiveness <= 0)
+        return;
+
+    std::vector<syntax_tree*> kept;
+    for (syntax_tree *candidate : candidates)
+    {
+        if (is_pruned_by_rules(*candidate))
+        {
+            nb_pruned_by_rules++;
+            delete candidate;
+        }
+
+        else
+            kept.push_back(candidate);
+    }
+
+    candidates = kept;
+
+    if (classifier == nullptr || candidates.size() <= 1)
+        return;
+
+    // The classifier evaluates transformed copies of the candidates,
+    // the candidates themselves are transformed by the search method.
+    std::vector<syntax_tree*> transformed;
+    for (syntax_tree *candidate : candidates)
+    {
+        syntax_tree *copy = new syntax_tree();
+        ast_node *node = candidate->copy_and_return_node(*copy, candidate->new_optims.back().node);
+
+        copy->new_optims.back().node = node;
+        copy->transform_ast();
+
+        transformed.push_back(copy);
+    }
+
+    std::vector<float> evaluations = classifier->evaluate_batch(transformed);
+    for (syntax_tree *copy : transformed)
+        delete copy;
+
+    int best = std::min_element(evaluations.begin(), evaluations.end()) - evaluations.begin();
+
+    kept.clear();
+    for (int i = 0; i < candidates.size(); ++i)
+    {
+        if (i != best && -evaluations[i] < min_predicted_speedup)
+        {
+            nb_pruned_by_classifier++;
+            delete candidates[i];
+        }
+
+        else
+            kept.push_back(candidates[i]);
+    }
+
+    candidates = kept;
+}
+
+std::string candidate_pruner::get_stats_json() const
+{
+    return "{\"nb_candidates\" : " + std::to_string(nb_candidates) +
+           ", \"nb_pruned_by_rules\" : " + std::to_string(nb_pruned_by_rules) +
+           ", \"nb_pruned_by_classifier\" : " + std::to_string(nb_pruned_by_classifier) + "}";
+}
+
+bool nest_schedules_generator::is_in_nest(ast_node *node) const
+{
+    while (node->parent != nullptr)
+        node = node->parent;
+
+    std::vector<tiramisu::computation*> comps;
+    node->get_all_computations(comps);
+
+    for (tiramisu::computation *comp : comps)
+        if (nest_comps.find(comp) == nest_comps.end())
+            return false;
+
+    return true;
+}
+
+std::vector<syntax_tree*> nest_schedules_generator::generate_schedules(syntax_tree const& ast, optimization_type optim)
+{
+    std::vector<syntax_tree*> states;
+
+    // The distribution applies to all the loop nests at once
+    if (optim == optimization_type::DISTRIBUTION || (nest_comps.empty() && optim != optimization_type::FUSION))
+        return states;
+
+    states = generator->generate_schedules(ast, optim);
+
+    auto iterator = states.begin();
+    while (iterator != states.end())
+    {
+        syntax_tree *state = *iterator;
+        bool kept = !state->new_optims.empty();
+
+        if (kept)
+        {
+            optimization_info const& optim_info = state->new_optims.back();
+            bool fuses_roots = optim_info.type == optimization_type::FUSION && optim_info.node != nullptr &&
+                               optim_info.node->parent == nullptr;
+
+            if (nest_comps.empty())
+                kept = fuses_roots;
+            else
+            {
+                if (optim_info.node != nullptr)
+                    kept = is_in_nest(optim_info.node);
+
+                if (kept && fuses_roots)
+                    kept = is_in_nest(state->roots[optim_info.l1]);
+
+                for (tiramisu::computation *comp : optim_info.comps)
+                    kept = kept && nest_comps.find(comp) != nest_comps.end();
+            }
+        }
+
+        if (!kept)
+        {
+            delete state;
+            iterator = states.erase(iterator);
+        }
+        else
+            ++iterator;
+    }
+
     return states;
 }
 
@@ -1,9 +1,414 @@
 #include <tiramisu/auto_scheduler/search_method.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
 #include <random>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 namespace tiramisu::auto_scheduler
 {
 
+float search_method::get_remaining_budget() const
+{
+    float remaining = 1;
+
+    if (time_budget > 0)
+    {
+        float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - budget_start).count();
+        remaining = std::min(remaining, 1 - elapsed / time_budget);
+    }
+
+    if (schedules_budget > 0)
+        remaining = std::min(remaining, 1 - (float)nb_explored_schedules / schedules_budget);
+
+    return std::max(remaining, 0.f);
+}
+
+int search_method::get_budgeted_beam_size(int beam_size) const
+{
+    float remaining = get_remaining_budget();
+    if (remaining >= LOW_BUDGET_FRACTION)
+        return beam_size;
+
+    return std::max(1, (int)std::ceil(beam_size * remaining / LOW_BUDGET_FRACTION));
+}
+
+bool pareto_front::dominates(std::vector<float> const& a, std::vector<float> const& b)
+{
+    bool better = false;
+    for (int i = 0; i < a.size() && i < b.size(); ++i)
+    {
+        if (std::isnan(a[i]) || std::isnan(b[i]))
+            continue;
+
+        if (a[i] > b[i])
+            return false;
+
+        if (a[i] < b[i])
+            better = true;
+    }
+
+    return better;
+}
+
+bool pareto_front::insert(syntax_tree& ast, std::vector<float> const& metrics)
+{
+    // The schedule is not added if a point is at least as good on all the metrics
+    for (pareto_point const& point : points)
+    {
+        bool at_least_as_good = true;
+        for (int i = 0; i < metrics.size() && i < point.metrics.size(); ++i)
+            if (!std::isnan(metrics[i]) && !std::isnan(point.metrics[i]) && point.metrics[i] > metrics[i])
+                at_least_as_good = false;
+
+        if (at_least_as_good)
+            return false;
+    }
+
+    points.erase(std::remove_if(points.begin(), points.end(), [&](pareto_point& point) {
+        if (!dominates(metrics, point.metrics))
+            return false;
+
+        delete point.ast;
+        return true;
+    }), points.end());
+
+    points.push_back({metrics, ast.copy_ast(), ast.get_schedule_str()});
+    return true;
+}
+
+std::string pareto_front::get_json() const
+{
+    std::string json = "[";
+    for (pareto_point const& point : points)
+    {
+        json += "{\"latency\" : " + std::to_string(point.metrics[LATENCY]) +
+                ", \"memory_footprint\" : " + std::to_string(point.metrics[MEMORY_FOOTPRINT]) +
+                ", \"energy\" : " + (std::isnan(point.metrics[ENERGY]) ? "null" : std::to_string(point.metrics[ENERGY])) +
+                ", \"schedule\" : \"" + point.schedule_str + "\"},";
+    }
+
+    if (!points.empty())
+        json.pop_back();
+
+    return json + "]";
+}
+
+bool search_method::satisfies_constraints(std::vector<float> const& metrics) const
+{
+    for (int i = 0; i < NB_SCHEDULE_METRICS; ++i)
+        if (constraints[i] != FLT_MAX && !(metrics[i] <= constraints[i]))
+            return false;
+
+    return true;
+}
+
+void search_method::update_best_ast(syntax_tree *ast)
+{
+    if (front != nullptr || constrained)
+    {
+        std::vector<float> metrics = get_metrics(*ast);
+
+        if (front != nullptr)
+            front->insert(*ast, metrics);
+
+        if (!satisfies_constraints(metrics))
+            return ;
+    }
+
+    if (ast->evaluation >= best_evaluation)
+        return ;
+
+    if (owns_best_ast)
+        delete best_ast;
+
+    best_evaluation = ast->evaluation;
+    best_ast = ast->copy_ast();
+    owns_best_ast = true;
+}
+
+syntax_tree* search_method::replay_schedule(syntax_tree const& ast, std::vector<optimization_info> const& schedule)
+{
+    syntax_tree *current = ast.copy_ast();
+    int step = current->nb_explored_optims;
+
+    for (optimization_info const& optim : schedule)
+    {
+        // Go to the next step where this type of optimization is explored
+        int nb_steps = 0;
+        while (nb_steps < NB_OPTIMIZATIONS && DEFAULT_OPTIMIZATIONS_ORDER[(step + nb_steps) % NB_OPTIMIZATIONS] != optim.type)
+            nb_steps++;
+
+        if (nb_steps == NB_OPTIMIZATIONS)
+            continue;
+
+        for (int i = 0; i <= nb_steps; ++i)
+            if ((step + i) % NB_OPTIMIZATIONS == 0)
+                current->clear_new_optimizations();
+
+        step += nb_steps;
+        std::vector<syntax_tree*> candidates = scheds_gen->generate_schedules(*current, optim.type);
+        step++;
+
+        // Find the candidate on the same loop levels with the nearest factors
+        syntax_tree *chosen = nullptr;
+        float best_distance = FLT_MAX;
+
+        for (syntax_tree *candidate : candidates)
+        {
+            optimization_info const& cand_optim = candidate->new_optims.back();
+            if (cand_optim.type != optim.type || cand_optim.nb_l != optim.nb_l || cand_optim.l0 != optim.l0 || 
+                cand_optim.l1 != optim.l1 || cand_optim.l2 != optim.l2 || cand_optim.comps != optim.comps)
+                continue;
+
+            float distance = std::abs(std::log2((cand_optim.l0_fact + 1.f) / (optim.l0_fact + 1.f))) +
+                             std::abs(std::log2((cand_optim.l1_fact + 1.f) / (optim.l1_fact + 1.f))) +
+                             std::abs(std::log2((cand_optim.l2_fact + 1.f) / (optim.l2_fact + 1.f))) +
+                             std::abs(std::log2((cand_optim.l3_fact + 1.f) / (optim.l3_fact + 1.f)));
+
+            if (cand_optim.matrix != optim.matrix)
+                distance += 1;
+
+            if (distance < best_distance)
+            {
+                best_distance = distance;
+                chosen = candidate;
+            }
+        }
+
+        for (syntax_tree *candidate : candidates)
+            if (candidate != chosen)
+                delete candidate;
+
+        if (chosen == nullptr)
+            continue;
+
+        chosen->transform_ast();
+        if (!chosen->ast_is_legal())
+        {
+            delete chosen;
+            continue;
+        }
+
+        delete current;
+        current = chosen;
+    }
+
+    current->nb_explored_optims = step;
+    return current;
+}
+
+void search_method::checkpoint()
+{
+    // Save the evaluations first : they are what allows to replay the search
+    if (eval_func != nullptr && eval_func->get_cache() != nullptr)
+        eval_func->get_cache()->save();
+
+    if (exec_eval != nullptr && exec_eval->get_cache() != nullptr && (eval_func == nullptr || exec_eval->get_cache() != eval_func->get_cache()))
+        exec_eval->get_cache()->save();
+
+    // Each line of the file contains : key value
+    std::string tmp_filename = checkpoint_filename + ".tmp";
+    std::ofstream file(tmp_filename);
+
+    file << "nb_explored_schedules " << nb_explored_schedules << "\n";
+    file << "best_evaluation " << best_evaluation << "\n";
+    if (best_ast != nullptr)
+        file << "best_schedule " << best_ast->get_schedule_str() << "\n";
+
+    file.close();
+
+    // Replace the previous checkpoint only once the new one is complete
+    rename(tmp_filename.c_str(), checkpoint_filename.c_str());
+    last_checkpoint = nb_explored_schedules;
+
+    if (std::atoi(read_env_var("AS_VERBOSE"))==1)
+        std::cout << "Checkpoint saved after " << nb_explored_schedules << " explored schedules" << std::endl;
+}
+
+bool search_method::read_checkpoint(std::string const& filename, int& nb_explored_schedules, float& best_evaluation, std::string& best_schedule)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream iss(line);
+        std::string key;
+        iss >> key;
+
+        if (key == "nb_explored_schedules")
+            iss >> nb_explored_schedules;
+        else if (key == "best_evaluation")
+            iss >> best_evaluation;
+        else if (key == "best_schedule")
+            iss >> best_schedule;
+    }
+
+    return true;
+}
+
+std::vector<std::vector<float>> search_method::parallel_measurements(std::vector<syntax_tree*> const& asts, evaluate_by_execution *evaluator, float schedule_timeout)
+{
+    std::vector<std::vector<float>> results(asts.size());
+    std::string lock_path = evaluator->get_obj_filename() + ".lock";
+
+    // Each running worker occupies a slot, the slot gives the worker its private files
+    std::vector<int> slots_ast(nb_workers, -1);
+    std::vector<pid_t> slots_pid(nb_workers, -1);
+    std::vector<int> slots_pipe(nb_workers, -1);
+    std::vector<std::string> slots_output(nb_workers);
+
+    // Parse the measurements sent by the worker of the given slot, reap the worker and free the slot
+    auto collect = [&](int slot) {
+        // Retry if interrupted by a signal, stop if the worker was already reaped (ECHILD)
+        while (waitpid(slots_pid[slot], nullptr, 0) == -1 && errno == EINTR)
+            ;
+
+        std::istringstream output(slots_output[slot]);
+        int nb_measurements = 0;
+        std::vector<float> measurements;
+
+        if (output >> nb_measurements)
+        {
+            for (int i = 0; i < nb_measurements; ++i)
+            {
+                float measure;
+                if (output >> measure)
+                    measurements.push_back(measure);
+            }
+        }
+
+        // The worker crashed before sending its measurements
+        if (measurements.empty())
+            measurements.push_back(std::numeric_limits<float>::infinity());
+
+        close(slots_pipe[slot]);
+        results[slots_ast[slot]] = measurements;
+        if (evaluator->get_cache() != nullptr)
+            evaluator->get_cache()->insert(evaluator->get_measurements_cache_key(*asts[slots_ast[slot]]), measurements);
+
+        slots_ast[slot] = -1;
+        slots_pid[slot] = -1;
+        slots_pipe[slot] = -1;
+        slots_output[slot].clear();
+    };
+
+    // Read the pipes of the running workers as their output arrives, so that a worker
+    // never blocks on a full pipe, and return the slot of the first worker that
+    // closed its pipe (i.e. that sent all its measurements, or crashed)
+    auto wait_worker = [&]() {
+        while (true)
+        {
+            std::vector<pollfd> fds;
+            std::vector<int> fds_slot;
+            for (int slot = 0; slot < nb_workers; ++slot)
+                if (slots_pid[slot] != -1)
+                {
+                    fds.push_back({slots_pipe[slot], POLLIN, 0});
+                    fds_slot.push_back(slot);
+                }
+
+            if (poll(fds.data(), fds.size(), -1) == -1)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                // Cannot wait on the pipes, collect the first worker
+                return fds_slot[0];
+            }
+
+            for (int i = 0; i < fds.size(); ++i)
+            {
+                if (fds[i].revents == 0)
+                    continue;
+
+                char buffer[4096];
+                ssize_t nb_bytes = read(fds[i].fd, buffer, sizeof(buffer));
+                if (nb_bytes > 0)
+                    slots_output[fds_slot[i]].append(buffer, nb_bytes);
+                else if (nb_bytes == 0 || errno != EINTR)
+                    return fds_slot[i];
+            }
+        }
+    };
+
+    std::fflush(stdout);
+
+    for (int i = 0; i < asts.size(); ++i)
+    {
+        // The workers are forked processes, so the cache is only read and updated here
+        if (evaluator->get_cache() != nullptr &&
+            evaluator->get_cache()->lookup(evaluator->get_measurements_cache_key(*asts[i]), results[i]))
+            continue;
+
+        int slot = std::find(slots_ast.begin(), slots_ast.end(), -1) - slots_ast.begin();
+        if (slot == nb_workers)
+        {
+            slot = wait_worker();
+            collect(slot);
+        }
+
+        int pipe_fd[2];
+        pipe(pipe_fd);
+
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            // Here we are in the worker, it has its own copy of the program
+            close(pipe_fd[0]);
+            evaluator->set_worker(slot, lock_path);
+            std::vector<float> measurements = evaluator->get_measurements(*asts[i], false, schedule_timeout);
+
+            FILE *out = fdopen(pipe_fd[1], "w");
+            fprintf(out, "%d", (int)measurements.size());
+            for (float measure : measurements)
+                fprintf(out, " %.9g", measure);
+            fprintf(out, "\n");
+            fclose(out);
+
+            std::fflush(stdout);
+            _exit(0);
+        }
+
+        close(pipe_fd[1]);
+        slots_ast[slot] = i;
+        slots_pid[slot] = pid;
+        slots_pipe[slot] = pipe_fd[0];
+    }
+
+    // Wait for the remaining workers
+    while (std::count(slots_pid.begin(), slots_pid.end(), -1) != nb_workers)
+        collect(wait_worker());
+
+    return results;
+}
+
+void beam_search::remove_duplicate_schedules(std::vector<syntax_tree*>& children)
+{
+    auto iterator = children.begin();
+    while (iterator != children.end())
+    {
+        if (!evaluated_schedules.insert((*iterator)->get_canonical_form()).second)
+        {
+            delete (*iterator);
+            iterator = children.erase(iterator);
+        }
+        else
+            ++iterator;
+    }
+}
+
 void beam_search::search(syntax_tree& ast)
 {
     if (ast.nb_explored_optims % NB_OPTIMIZATIONS == 0)
@@ -31,7 +436,7 @@ void beam_search::search(syntax_tree& ast)
     // Evaluate children and sort them from smallest to highest evaluation
     
 
-   // evaluate while removing illegal versions
+   // remove illegal versions
     auto iterator = children.begin();
     while (iterator != children.end())
     {
@@ -49,34 +454,66 @@ void beam_search::search(syntax_tree& ast)
             std::cout << "\n<illegal>\n";
             delete (*iterator);
             iterator = children.erase(iterator);
+            nb_explored_schedules++;
         }
-        else {
+        else
+            ++iterator;
+    }
 
-            // evaluate and print Ast 
-            (*iterator)->evaluation = eval_func->evaluate(*(*iterator));
+    // The seeds compete with the children of the initial AST
+    if (ast.search_depth == 0)
+    {
+        children.insert(children.end(), seeds.begin(), seeds.end());
+        seeds.clear();
+    }
 
-            (*iterator)->print_previous_optims();
-            std::cout << "\n-----------" << std::endl;
-            (*iterator)->print_new_optims();
-            (*iterator)->print_ast();
-            std::cout << "Evaluation : " << (*iterator)->evaluation << std::endl << std::endl;
-            (*iterator)->print_isl_states();
-            (*iterator)->print_computations_accesses();
-            std::cout << "\n<legal>\n";
+    // Different orders of optimizations often give the same loop structure,
+    // which is evaluated only once
+    remove_duplicate_schedules(children);
 
-            if ((*iterator)->evaluation < best_evaluation)
-            {
-                best_evaluation = (*iterator)->evaluation;
-                best_ast = (*iterator);
-            }
+    // When the evaluation function executes the program, the legal children
+    // can be compiled and executed by parallel workers.
+    evaluate_by_execution *parallel_eval = dynamic_cast<evaluate_by_execution*>(eval_func);
+    if (nb_workers > 1 && parallel_eval != nullptr)
+    {
+        std::vector<std::vector<float>> measurements = parallel_measurements(children, parallel_eval);
+        for (int i = 0; i < children.size(); ++i)
+            children[i]->evaluation = min_eval(measurements[i]);
+    }
+    else
+    {
+        std::vector<float> evaluations = eval_func->evaluate_batch(children);
+        for (int i = 0; i < children.size(); ++i)
+            children[i]->evaluation = evaluations[i];
+    }
 
-            ++iterator;
+    // print the evaluated Asts
+    for (syntax_tree *child : children)
+    {
+        child->print_previous_optims();
+        std::cout << "\n-----------" << std::endl;
+        child->print_new_optims();
+        child->print_ast();
+        std::cout << "Evaluation : " << child->evaluation << std::endl << std::endl;
+        child->print_isl_states();
+        child->print_computations_accesses();
+        std::cout << "\n<legal>\n";
 
-        }
-        
+        update_best_ast(child);
         nb_explored_schedules++;
     }
 
+    checkpoint_if_needed();
+
+    // Stop if the budget is exhausted, best_ast holds the best schedule found so far
+    if (budget_exhausted())
+    {
+        for (syntax_tree *child : children)
+            delete child;
+
+        return ;
+    }
+
     // Stop if we reached the maximum depth
     if (nb_explored_optims >= max_depth)
         return ;
@@ -92,15 +529,19 @@ void beam_search::search(syntax_tree& ast)
         return a->evaluation < b->evaluation;
     });
 
-    // keep the top 'beam_size' children and delete the rest
-    for (int i = beam_size; i < children.size(); ++i)
+    // keep the top 'beam_size' children (narrowed when the budget runs low) and delete the rest
+    int budgeted_beam_size = get_budgeted_beam_size(beam_size);
+    for (int i = budgeted_beam_size; i < children.size(); ++i)
         delete children[i];
 
-    children.resize(std::min(beam_size, (int)children.size()));
+    children.resize(std::min(budgeted_beam_size, (int)children.size()));
 
     // Search recursively on the best children
     for (syntax_tree *child : children)
     {
+        if (budget_exhausted())
+            break;
+
         child->search_depth = ast.search_depth + 1;        
         search(*child);
     }
@@ -133,7 +574,7 @@ void beam_search::search_save(syntax_tree& ast, std::vector<std::string> *schedu
         return ;
 
     // Evaluate children and sort them from smallest to highest evaluation
-    // evaluate while removing illegal versions
+    // First remove illegal and pruned versions
     auto iterator = children.begin();
     while (iterator != children.end())
     {
@@ -152,6 +593,7 @@ void beam_search::search_save(syntax_tree& ast, std::vector<std::string> *schedu
             }
             delete child;
             iterator = children.erase(iterator);
+            nb_explored_schedules++;
         }
 
         else if (!child->ast_is_legal()) {
@@ -166,68 +608,98 @@ void beam_search::search_save(syntax_tree& ast, std::vector<std::string> *schedu
             }
             delete child;
             iterator = children.erase(iterator);
+            nb_explored_schedules++;
         }
-        else {
-
-            // print and evaluate Ast
+        else
+            ++iterator;
+    }
 
-            if (std::atoi(read_env_var("AS_VERBOSE"))==1){
-                child->print_previous_optims();
-                std::cout << "\n-----------" << std::endl;
-                child->print_new_optims();
-                child->print_ast();
-                child->print_isl_states();
-                std::cout << "\n<legal>\n";
-                child->print_computations_accesses();
-            }
+    // Then execute the legal versions, using parallel workers if requested
+    std::vector<std::vector<float>> children_measurements(children.size());
+    std::vector<syntax_tree*> children_to_execute;
+    std::vector<int> children_to_execute_ids;
 
-            std::vector<float> measurements;
-            if (child->can_set_default_evaluation()) { // if yes the child's evaluation is set to a default value
-                measurements = {child->evaluation};
-            }
-            else{
-                measurements = exec_eval->get_measurements(*child, false, schedule_timeout);
-                child->evaluation = min_eval(measurements);
-            }
+    for (int i = 0; i < children.size(); ++i)
+    {
+        syntax_tree *child = children[i];
+        if (std::atoi(read_env_var("AS_VERBOSE"))==1){
+            child->print_previous_optims();
+            std::cout << "\n-----------" << std::endl;
+            child->print_new_optims();
+            child->print_ast();
+            child->print_isl_states();
+            std::cout << "\n<legal>\n";
+            child->print_computations_accesses();
+        }
 
-            parent_trace->add_child_path(child, schedules_annotations->size());
+        if (child->can_set_default_evaluation()) // if yes the child's evaluation is set to a default value
+            children_measurements[i] = {child->evaluation};
+        else if (nb_workers > 1)
+        {
+            children_to_execute.push_back(child);
+            children_to_execute_ids.push_back(i);
+        }
+        else
+            children_measurements[i] = exec_eval->get_measurements(*child, false, schedule_timeout);
+    }
 
-            std::string schedule_annot = evaluate_by_learning_model::get_schedule_json(*child);
+    if (!children_to_execute.empty())
+    {
+        std::vector<std::vector<float>> measurements = parallel_measurements(children_to_execute, exec_eval, schedule_timeout);
+        for (int i = 0; i < children_to_execute.size(); ++i)
+            children_measurements[children_to_execute_ids[i]] = measurements[i];
+    }
 
-            //remove the last two characters }\n
-            schedule_annot.pop_back();
-            schedule_annot.pop_back();
+    // Finally record the evaluated versions, in the order in which they were generated
+    for (int i = 0; i < children.size(); ++i)
+    {
+        syntax_tree *child = children[i];
+        std::vector<float> const& measurements = children_measurements[i];
+        child->evaluation = min_eval(measurements);
 
-            if (std::isfinite(child->evaluation)) // the evaluation is not finite mean that the schedule didn't run
-                schedule_annot += ", \n\"execution_times\" : " + measurements_to_str(measurements) + "\n}\n";
-            else
-                schedule_annot += ", \n\"execution_times\" : null\n}\n";
+        parent_trace->add_child_path(child, schedules_annotations->size());
 
-            schedules_annotations->push_back(schedule_annot);
+        std::string schedule_annot = evaluate_by_learning_model::get_schedule_json(*child);
 
-            if (std::atoi(read_env_var("AS_VERBOSE"))==1){
-                std::cout << "Schedule number "<< schedules_annotations->size() << std::endl;
-                std::cout << "Evaluation : " << child->evaluation << std::endl;
-                std::cout << "Number of measurements : " << measurements.size() << std::endl;
-                std::cout << "===================================" << std::endl << std::endl;
-            }
+        //remove the last two characters }\n
+        schedule_annot.pop_back();
+        schedule_annot.pop_back();
 
-            if (std::isinf(child->evaluation))
-                std::cerr<< "Evaluation of schedule "<< schedules_annotations->size() <<" failed "<< std::endl;
+        if (!child->hardware_counters.empty())
+            schedule_annot += ", \n\"hardware_counters\" : " + counters_to_str(child->hardware_counters);
 
-            if (child->evaluation < best_evaluation)
-            {
-                best_evaluation = child->evaluation;
-                best_ast = child;
-            }
+        if (std::isfinite(child->evaluation)) // the evaluation is not finite mean that the schedule didn't run
+            schedule_annot += ", \n\"execution_times\" : " + measurements_to_str(measurements) + "\n}\n";
+        else
+            schedule_annot += ", \n\"execution_times\" : null\n}\n";
 
-            ++iterator;
+        schedules_annotations->push_back(schedule_annot);
 
+        if (std::atoi(read_env_var("AS_VERBOSE"))==1){
+            std::cout << "Schedule number "<< schedules_annotations->size() << std::endl;
+            std::cout << "Evaluation : " << child->evaluation << std::endl;
+            std::cout << "Number of measurements : " << measurements.size() << std::endl;
+            std::cout << "===================================" << std::endl << std::endl;
         }
 
+        if (std::isinf(child->evaluation))
+            std::cerr<< "Evaluation of schedule "<< schedules_annotations->size() <<" failed "<< std::endl;
+
+        update_best_ast(child);
         nb_explored_schedules++;
     }
 
+    checkpoint_if_needed();
+
+    // Stop if the budget is exhausted, best_ast holds the best schedule found so far
+    if (budget_exhausted())
+    {
+        for (syntax_tree *child : children)
+            delete child;
+
+        return ;
+    }
+
     // Stop if we reached the maximum depth
     if (nb_explored_optims >= max_depth)
         return ;
@@ -245,15 +717,19 @@ void beam_search::search_save(syntax_tree& ast, std::vector<std::string> *schedu
     // shuffle the children so that they are selected a random
     std::shuffle(std::begin(children), std::end(children), rand_generator);
 
-    // keep the top 'beam_size' children and delete the rest
-    for (int i = beam_size; i < children.size(); ++i)
+    // keep the top 'beam_size' children (narrowed when the budget runs low) and delete the rest
+    int budgeted_beam_size = get_budgeted_beam_size(beam_size);
+    for (int i = budgeted_beam_size; i < children.size(); ++i)
         delete children[i];
 
-    children.resize(std::min(beam_size, (int)children.size()));
+    children.resize(std::min(budgeted_beam_size, (int)children.size()));
 
     // Search recursively on the best children
     for (syntax_tree *child : children)
     {
+        if (budget_exhausted())
+            break;
+
         child->search_depth = ast.search_depth + 1;
         search_save(*child, schedules_annotations, parent_trace->child_mappings[child], schedule_timeout);
     }
@@ -331,42 +807,374 @@ void mcts::search_save(syntax_tree& ast, std::vector<std::string> *schedules_ann
 
 // -------------------------------------------------------------------------- //
 
-void beam_search_topk::search(syntax_tree& ast)
+/**
+ * Atomically add delta to value (std::atomic<float> has no fetch_add before C++20).
+ */
+static void atomic_add(std::atomic<float>& value, float delta)
 {
-    // Do a beam search
-    beam_search_subroutine(ast);
-    
-    // Sort schedules found
-    std::sort(schedules.begin(), schedules.end(), [](syntax_tree *a, syntax_tree *b) {
-        return a->evaluation < b->evaluation;
-    });
-    
-    // Execute top-k schedules to find the best
-    for (int i = 0; i < topk; ++i)
-    {
-        float exec_time = exec_eval->evaluate(*schedules[i]);
-        if (exec_time < best_evaluation)
-        {
-            best_evaluation = exec_time;
-            best_ast = schedules[i];
-        }
-    }
+    float current = value.load();
+    while (!value.compare_exchange_weak(current, current + delta))
+        ;
 }
 
-void beam_search_topk::search_save(syntax_tree& ast, std::vector<std::string> *schedules_annotations, candidate_trace *parent_trace, float schedule_timeout)
+float parallel_mcts::get_reward(float evaluation) const
 {
-    std::cerr<< "beam_search_topk::search_save not yet implemented" << std::endl;
-    exit(1);
+    if (!std::isfinite(evaluation) || evaluation == 0 || !std::isfinite(initial_evaluation) || initial_evaluation == 0)
+        return 0;
+
+    // Execution times
+    if (evaluation > 0)
+        return initial_evaluation / evaluation;
+
+    // The model returns the opposite of the speedup
+    return evaluation / initial_evaluation;
 }
 
-void beam_search_topk::beam_search_subroutine(syntax_tree& ast)
+parallel_mcts::tree_node* parallel_mcts::select_leaf(tree_node *root)
 {
-    if (ast.nb_explored_optims % NB_OPTIMIZATIONS == 0)
-        ast.clear_new_optimizations();
-       
-    std::vector<syntax_tree*> children;
-        
-    // Look for an optimization that can be applied
+    tree_node *node = root;
+    node->virtual_loss++;
+
+    // children is only read once expanded is set, and is not modified afterwards
+    while (node->expanded && !node->children.empty())
+    {
+        int parent_visits = node->nb_visits + node->virtual_loss;
+
+        tree_node *best_child = nullptr;
+        float best_score = -FLT_MAX;
+
+        for (tree_node *child : node->children)
+        {
+            if (child->exhausted)
+                continue;
+
+            int visits = child->nb_visits + child->virtual_loss;
+            float score = FLT_MAX;
+
+            if (visits > 0)
+                score = child->total_reward / visits + exploration * std::sqrt(std::log((float)parent_visits) / visits);
+
+            if (score > best_score)
+            {
+                best_score = score;
+                best_child = child;
+            }
+        }
+
+        if (best_child == nullptr)
+            break;
+
+        node = best_child;
+        node->virtual_loss++;
+    }
+
+    return node;
+}
+
+std::vector<float> parallel_mcts::expand(tree_node *leaf)
+{
+    syntax_tree& ast = *leaf->ast;
+    std::vector<float> rewards;
+
+    if (ast.nb_explored_optims % NB_OPTIMIZATIONS == 0)
+        ast.clear_new_optimizations();
+
+    std::vector<syntax_tree*> children;
+
+    // Look for an optimization that can be applied
+    int nb_optims_tried = 0;
+    int nb_explored_optims = ast.nb_explored_optims;
+
+    while (children.size() == 0 && nb_optims_tried < NB_OPTIMIZATIONS && nb_explored_optims < max_depth)
+    {
+        optimization_type optim_type = DEFAULT_OPTIMIZATIONS_ORDER[nb_explored_optims % NB_OPTIMIZATIONS];
+        children = scheds_gen->generate_schedules(ast, optim_type);
+
+        nb_explored_optims++;
+        nb_optims_tried++;
+    }
+
+    // Remove the illegal children
+    auto iterator = children.begin();
+    while (iterator != children.end())
+    {
+        (*iterator)->nb_explored_optims = nb_explored_optims;
+        (*iterator)->transform_ast();
+
+        if (!(*iterator)->ast_is_legal())
+        {
+            delete (*iterator);
+            iterator = children.erase(iterator);
+        }
+        else
+            ++iterator;
+
+        nb_explored_schedules++;
+    }
+
+    if (!children.empty())
+    {
+        std::vector<float> evaluations = eval_func->evaluate_batch(children);
+
+        for (int i = 0; i < children.size(); ++i)
+        {
+            children[i]->evaluation = evaluations[i];
+            if (exec_eval == nullptr)
+                update_best_ast(children[i]);
+
+            // The evaluation of a child counts as its first visit
+            tree_node *child_node = new tree_node(children[i], leaf);
+            child_node->nb_visits = 1;
+            child_node->total_reward = get_reward(evaluations[i]);
+
+            rewards.push_back(child_node->total_reward);
+            leaf->children.push_back(child_node);
+        }
+
+        // The current AST, to continue with the next optimizations without applying this one
+        if (nb_explored_optims < max_depth)
+        {
+            syntax_tree *ast_copy = ast.copy_ast();
+            ast_copy->nb_explored_optims = nb_explored_optims;
+            leaf->children.push_back(new tree_node(ast_copy, leaf));
+        }
+    }
+
+    leaf->expanded = true;
+
+    // Mark the leaf, and the ancestors whose children are all exhausted
+    if (leaf->children.empty())
+    {
+        for (tree_node *node = leaf; node != nullptr; node = node->parent)
+        {
+            bool all_exhausted = std::all_of(node->children.begin(), node->children.end(), [](tree_node *child) {
+                return child->exhausted.load();
+            });
+
+            if (!all_exhausted)
+                break;
+
+            node->exhausted = true;
+        }
+    }
+
+    return rewards;
+}
+
+void parallel_mcts::backpropagate(tree_node *leaf, std::vector<float> const& rewards)
+{
+    float rewards_sum = 0;
+    for (float reward : rewards)
+        rewards_sum += reward;
+
+    for (tree_node *node = leaf; node != nullptr; node = node->parent)
+    {
+        node->nb_visits += (int)rewards.size();
+        atomic_add(node->total_reward, rewards_sum);
+        node->virtual_loss--;
+    }
+}
+
+void parallel_mcts::worker(tree_node *root)
+{
+    while (!stop_search && !root->exhausted)
+    {
+        tree_node *leaf = select_leaf(root);
+        std::vector<float> rewards;
+
+        {
+            std::lock_guard<std::mutex> lock(expansion_mutex);
+
+            // Another thread may have expanded the leaf in the meantime
+            if (!leaf->expanded && !stop_search)
+            {
+                if (nb_expansions >= nb_samples || budget_exhausted())
+                    stop_search = true;
+
+                else
+                {
+                    rewards = expand(leaf);
+                    nb_expansions++;
+                    checkpoint_if_needed();
+                }
+            }
+        }
+
+        // Nothing new was evaluated, visit the leaf again
+        if (rewards.empty())
+            rewards.push_back(get_reward(leaf->ast->evaluation));
+
+        backpropagate(leaf, rewards);
+    }
+}
+
+void parallel_mcts::collect_nodes(tree_node *node, std::vector<tree_node*>& nodes)
+{
+    nodes.push_back(node);
+    for (tree_node *child : node->children)
+        collect_nodes(child, nodes);
+}
+
+void parallel_mcts::search(syntax_tree& ast)
+{
+    initial_evaluation = ast.evaluation;
+    nb_expansions = 0;
+    stop_search = false;
+
+    tree_node *root = new tree_node(ast.copy_ast(), nullptr);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < nb_threads; ++i)
+        threads.emplace_back(&parallel_mcts::worker, this, root);
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    if (std::atoi(read_env_var("AS_VERBOSE")) == 1)
+        std::cout << "Parallel MCTS : " << nb_expansions << " expansions, " << root->nb_visits << " visits" << std::endl;
+
+    // Execute the top-k distinct schedules and return the best
+    if (exec_eval != nullptr)
+    {
+        std::vector<tree_node*> nodes;
+        collect_nodes(root, nodes);
+
+        std::sort(nodes.begin(), nodes.end(), [](tree_node *a, tree_node *b) {
+            return a->ast->evaluation < b->ast->evaluation;
+        });
+
+        std::unordered_set<std::string> executed_schedules;
+        for (int i = 0; i < nodes.size() && executed_schedules.size() < topk; ++i)
+        {
+            if (!executed_schedules.insert(nodes[i]->ast->get_schedule_str()).second)
+                continue;
+
+            nodes[i]->ast->evaluation = exec_eval->evaluate(*nodes[i]->ast);
+            update_best_ast(nodes[i]->ast);
+        }
+    }
+
+    delete root;
+}
+
+void parallel_mcts::search_save(syntax_tree& ast, std::vector<std::string> *schedules_annotations, candidate_trace *parent_trace, float schedule_timeout)
+{
+    std::cerr<< "parallel_mcts::search_save not yet implemented" << std::endl;
+    exit(1);
+}
+
+// -------------------------------------------------------------------------- //
+
+void beam_search_topk::search(syntax_tree& ast)
+{
+    // Do a beam search
+    beam_search_subroutine(ast);
+    
+    // Sort schedules found
+    std::sort(schedules.begin(), schedules.end(), [](syntax_tree *a, syntax_tree *b) {
+        return a->evaluation < b->evaluation;
+    });
+    
+    // Execute top-k schedules to find the best
+    for (int i = 0; i < topk; ++i)
+    {
+        float exec_time = exec_eval->evaluate(*schedules[i]);
+        if (exec_time < best_evaluation)
+        {
+            best_evaluation = exec_time;
+            best_ast = schedules[i];
+        }
+    }
+}
+
+syntax_tree* decomposed_search::search_with(syntax_tree const& ast, schedules_generator *generator)
+{
+    beam_search bs(beam_size, max_depth, eval_func, generator);
+    bs.set_exec_eval(exec_eval);
+    bs.set_nb_workers(nb_workers);
+    if (time_budget > 0 || schedules_budget > 0)
+        bs.set_budget(time_budget * get_remaining_budget(),
+                      schedules_budget > 0 ? std::max(schedules_budget - nb_explored_schedules, 1) : 0);
+
+    syntax_tree *start = ast.copy_ast();
+    start->nb_explored_optims = 0;
+    start->search_depth = 0;
+    bs.search(*start);
+    delete start;
+
+    nb_explored_schedules += bs.get_nb_explored_schedules();
+    if (bs.get_best_ast() == nullptr)
+        return nullptr;
+
+    syntax_tree *best = bs.get_best_ast()->copy_ast();
+    best->evaluation = bs.get_best_evaluation();
+    update_best_ast(best);
+
+    return best;
+}
+
+void decomposed_search::search(syntax_tree& ast)
+{
+    // Search the optimizations of each loop nest separately
+    std::vector<optimization_info> schedule;
+    for (ast_node *root : ast.roots)
+    {
+        if (budget_exhausted())
+            break;
+
+        std::vector<tiramisu::computation*> nest_comps;
+        root->get_all_computations(nest_comps);
+
+        nest_schedules_generator nest_gen(scheds_gen, nest_comps);
+        syntax_tree *nest_best = search_with(ast, &nest_gen);
+        if (nest_best == nullptr)
+            continue;
+
+        std::vector<optimization_info> nest_schedule = nest_best->get_schedule();
+        schedule.insert(schedule.end(), nest_schedule.begin(), nest_schedule.end());
+        delete nest_best;
+    }
+
+    // Apply the best schedules of all the loop nests together
+    syntax_tree *combined = replay_schedule(ast, schedule);
+    combined->evaluation = eval_func->evaluate(*combined);
+    nb_explored_schedules++;
+    update_best_ast(combined);
+
+    std::cout << "Combined schedule of the loop nests : " << combined->get_schedule_str()
+              << "\nEvaluation : " << combined->evaluation << std::endl;
+
+    // Then only explore the fusions of the loop nests
+    if (!budget_exhausted() && combined->roots.size() > 1)
+    {
+        nest_schedules_generator fusion_gen(scheds_gen);
+        delete search_with(*combined, &fusion_gen);
+    }
+
+    delete combined;
+    checkpoint_if_needed();
+}
+
+void decomposed_search::search_save(syntax_tree& ast, std::vector<std::string> *schedules_annotations, candidate_trace *parent_trace, float schedule_timeout)
+{
+    std::cerr<< "decomposed_search::search_save not yet implemented" << std::endl;
+    exit(1);
+}
+
+void beam_search_topk::search_save(syntax_tree& ast, std::vector<std::string> *schedules_annotations, candidate_trace *parent_trace, float schedule_timeout)
+{
+    std::cerr<< "beam_search_topk::search_save not yet implemented" << std::endl;
+    exit(1);
+}
+
+void beam_search_topk::beam_search_subroutine(syntax_tree& ast)
+{
+    if (ast.nb_explored_optims % NB_OPTIMIZATIONS == 0)
+        ast.clear_new_optimizations();
+       
+    std::vector<syntax_tree*> children;
+        
+    // Look for an optimization that can be applied
     int nb_optims_tried = 0;
     int nb_explored_optims = ast.nb_explored_optims;
     
@@ -388,11 +1196,14 @@ void beam_search_topk::beam_search_subroutine(syntax_tree& ast)
     {
         child->nb_explored_optims = nb_explored_optims;
         child->transform_ast();
-            
-        child->evaluation = eval_func->evaluate(*child);
         
         nb_explored_schedules++;
     }
+
+    // All the children of this level are evaluated in one batch
+    std::vector<float> evaluations = eval_func->evaluate_batch(children);
+    for (int i = 0; i < children.size(); ++i)
+        children[i]->evaluation = evaluations[i];
         
     // Add the current AST to the list of children
     syntax_tree *ast_copy = ast.copy_ast();
@@ -496,4 +1307,347 @@ void beam_search_accuracy_evaluator::search(syntax_tree& ast)
     }
 }
 
+// -------------------------------------------------------------------------- //
+
+int evolutionary_search::random_gene()
+{
+    std::bernoulli_distribution apply_dist(0.5);
+    if (!apply_dist(rand_generator))
+        return -1;
+
+    std::uniform_int_distribution<int> gene_dist(0, INT_MAX);
+    return gene_dist(rand_generator);
+}
+
+syntax_tree* evolutionary_search::decode(syntax_tree const& ast, std::vector<int> const& genes)
+{
+    syntax_tree *current = ast.copy_ast();
+
+    for (int i = 0; i < genes.size(); ++i)
+    {
+        if (i % NB_OPTIMIZATIONS == 0)
+            current->clear_new_optimizations();
+
+        if (genes[i] < 0)
+            continue;
+
+        std::vector<syntax_tree*> candidates = scheds_gen->generate_schedules(*current, DEFAULT_OPTIMIZATIONS_ORDER[i % NB_OPTIMIZATIONS]);
+        if (candidates.empty())
+            continue;
+
+        syntax_tree *chosen = candidates[genes[i] % candidates.size()];
+        for (syntax_tree *candidate : candidates)
+            if (candidate != chosen)
+                delete candidate;
+
+        // Skip the optimization if it is illegal
+        chosen->transform_ast();
+        if (!chosen->ast_is_legal())
+        {
+            delete chosen;
+            continue;
+        }
+
+        delete current;
+        current = chosen;
+    }
+
+    current->nb_explored_optims = genes.size();
+    return current;
+}
+
+void evolutionary_search::evaluate_individual(syntax_tree const& ast, individual& ind)
+{
+    ind.ast = decode(ast, ind.genes);
+    ind.evaluation = eval_func->evaluate(*ind.ast);
+    ind.ast->evaluation = ind.evaluation;
+
+    // Without execution, the evaluation of eval_func is the one to minimize
+    if (exec_eval == nullptr)
+        update_best_ast(ind.ast);
+
+    nb_explored_schedules++;
+}
+
+evolutionary_search::individual const& evolutionary_search::tournament_selection(std::vector<individual> const& population)
+{
+    std::uniform_int_distribution<int> index_dist(0, population.size() - 1);
+
+    int best_index = index_dist(rand_generator);
+    for (int i = 1; i < DEFAULT_TOURNAMENT_SIZE; ++i)
+    {
+        int index = index_dist(rand_generator);
+        if (population[index].evaluation < population[best_index].evaluation)
+            best_index = index;
+    }
+
+    return population[best_index];
+}
+
+void evolutionary_search::search(syntax_tree& ast)
+{
+    auto by_evaluation = [](individual const& a, individual const& b) {
+        return a.evaluation < b.evaluation;
+    };
+
+    std::vector<individual> population;
+
+    // The initial schedule is part of the population
+    individual initial;
+    initial.genes.assign(max_depth, -1);
+    initial.ast = ast.copy_ast();
+    initial.evaluation = ast.evaluation;
+    population.push_back(initial);
+
+    // Create the initial population
+    while (population.size() < population_size && !budget_exhausted())
+    {
+        individual ind;
+        for (int i = 0; i < max_depth; ++i)
+            ind.genes.push_back(random_gene());
+
+        evaluate_individual(ast, ind);
+        population.push_back(ind);
+    }
+
+    checkpoint_if_needed();
+
+    std::uniform_real_distribution<float> proba_dist(0, 1);
+    for (int generation = 0; generation < nb_generations && !budget_exhausted(); ++generation)
+    {
+        std::sort(population.begin(), population.end(), by_evaluation);
+
+        // Keep the elites unchanged
+        int nb_kept = std::min(nb_elites, (int)population.size());
+        std::vector<individual> next_population(population.begin(), population.begin() + nb_kept);
+
+        while (next_population.size() < population_size && !budget_exhausted())
+        {
+            individual child;
+            individual const& parent1 = tournament_selection(population);
+
+            // One-point crossover
+            if (max_depth > 1 && proba_dist(rand_generator) < crossover_rate)
+            {
+                individual const& parent2 = tournament_selection(population);
+                std::uniform_int_distribution<int> cut_dist(1, max_depth - 1);
+                int cut = cut_dist(rand_generator);
+
+                child.genes.insert(child.genes.end(), parent1.genes.begin(), parent1.genes.begin() + cut);
+                child.genes.insert(child.genes.end(), parent2.genes.begin() + cut, parent2.genes.end());
+            }
+            else
+                child.genes = parent1.genes;
+
+            // Mutation
+            for (int& gene : child.genes)
+                if (proba_dist(rand_generator) < mutation_rate)
+                    gene = random_gene();
+
+            evaluate_individual(ast, child);
+            next_population.push_back(child);
+        }
+
+        for (int i = nb_kept; i < population.size(); ++i)
+            delete population[i].ast;
+
+        population = next_population;
+        checkpoint_if_needed();
+
+        if (std::atoi(read_env_var("AS_VERBOSE")) == 1)
+            std::cout << "Generation " << generation << ", best evaluation : " << population[0].evaluation << std::endl;
+    }
+
+    std::sort(population.begin(), population.end(), by_evaluation);
+
+    // Execute the elites and return the best
+    if (exec_eval != nullptr)
+    {
+        for (int i = 0; i < nb_elites && i < population.size(); ++i)
+        {
+            population[i].ast->evaluation = exec_eval->evaluate(*population[i].ast);
+            update_best_ast(population[i].ast);
+        }
+    }
+
+    for (individual& ind : population)
+        delete ind.ast;
+}
+
+void evolutionary_search::search_save(syntax_tree& ast, std::vector<std::string> *schedules_annotations, candidate_trace *parent_trace, float schedule_timeout)
+{
+    std::cerr<< "evolutionary_search::search_save not yet implemented" << std::endl;
+    exit(1);
+}
+
+
+syntax_tree* random_schedule_sampler::sample(syntax_tree const& ast, std::unordered_set<std::string>& sampled)
+{
+    std::uniform_real_distribution<float> probability_dist(0, 1);
+    syntax_tree *current = ast.copy_ast();
+
+    for (int i = 0; i < max_depth; ++i)
+    {
+        if (i % NB_OPTIMIZATIONS == 0)
+            current->clear_new_optimizations();
+
+        optimization_type optim_type = DEFAULT_OPTIMIZATIONS_ORDER[i % NB_OPTIMIZATIONS];
+
+        auto it = optimization_probabilities.find(optim_type);
+        float probability = (it != optimization_probabilities.end()) ? it->second : DEFAULT_OPTIMIZATION_PROBABILITY;
+        if (probability_dist(rand_generator) >= probability)
+            continue;
+
+        std::vector<syntax_tree*> candidates = scheds_gen->generate_schedules(*current, optim_type);
+        if (candidates.empty())
+            continue;
+
+        std::vector<float> weights;
+        for (syntax_tree *candidate : candidates)
+            weights.push_back(candidate_weights ? std::max(candidate_weights(candidate->new_optims.back()), 0.f) : 1.f);
+
+        syntax_tree *chosen = nullptr;
+        if (std::any_of(weights.begin(), weights.end(), [](float w) { return w > 0; }))
+        {
+            std::discrete_distribution<int> candidate_dist(weights.begin(), weights.end());
+            chosen = candidates[candidate_dist(rand_generator)];
+        }
+
+        for (syntax_tree *candidate : candidates)
+            if (candidate != chosen)
+                delete candidate;
+
+        if (chosen == nullptr)
+            continue;
+
+        // Skip the optimization if it is illegal
+        chosen->transform_ast();
+        if (!chosen->ast_is_legal())
+        {
+            delete chosen;
+            continue;
+        }
+
+        delete current;
+        current = chosen;
+    }
+
+    current->nb_explored_optims = max_depth;
+
+    if (!sampled.insert(current->get_schedule_str()).second)
+    {
+        delete current;
+        return nullptr;
+    }
+
+    return current;
+}
+
+std::vector<syntax_tree*> random_schedule_sampler::sample_batch(syntax_tree const& ast, int n, std::unordered_set<std::string>& sampled)
+{
+    std::vector<syntax_tree*> samples;
+
+    // Give up when the draws keep giving schedules that were already sampled
+    int nb_failures = 0;
+    while (samples.size() < n && nb_failures < 10 * n && !budget_exhausted())
+    {
+        syntax_tree *new_sample = sample(ast, sampled);
+        if (new_sample == nullptr)
+            nb_failures++;
+        else
+            samples.push_back(new_sample);
+    }
+
+    return samples;
+}
+
+void random_schedule_sampler::search(syntax_tree& ast)
+{
+    std::unordered_set<std::string> sampled;
+
+    while (samples_json.size() < nb_samples && !budget_exhausted())
+    {
+        int batch_size = std::min(DEFAULT_SAMPLES_BATCH_SIZE, nb_samples - (int)samples_json.size());
+        std::vector<syntax_tree*> samples = sample_batch(ast, batch_size, sampled);
+        if (samples.empty())
+            break;
+
+        std::vector<float> evaluations;
+        if (eval_func != nullptr)
+            evaluations = eval_func->evaluate_batch(samples);
+
+        for (int i = 0; i < samples.size(); ++i)
+        {
+            samples[i]->evaluation = (eval_func != nullptr) ? evaluations[i] : FLT_MAX;
+            samples_json.push_back(evaluate_by_learning_model::get_schedule_json(*samples[i]));
+            samples_evaluations.push_back(samples[i]->evaluation);
+
+            update_best_ast(samples[i]);
+            nb_explored_schedules++;
+
+            delete samples[i];
+        }
+
+        checkpoint_if_needed();
+    }
+}
+
+void random_schedule_sampler::search_save(syntax_tree& ast, std::vector<std::string> *schedules_annotations, candidate_trace *parent_trace, float schedule_timeout)
+{
+    std::unordered_set<std::string> sampled;
+
+    while (samples_json.size() < nb_samples && !budget_exhausted())
+    {
+        int batch_size = std::min(DEFAULT_SAMPLES_BATCH_SIZE, nb_samples - (int)samples_json.size());
+        std::vector<syntax_tree*> samples = sample_batch(ast, batch_size, sampled);
+        if (samples.empty())
+            break;
+
+        std::vector<std::vector<float>> samples_measurements(samples.size());
+        if (nb_workers > 1)
+            samples_measurements = parallel_measurements(samples, exec_eval, schedule_timeout);
+        else
+            for (int i = 0; i < samples.size(); ++i)
+                samples_measurements[i] = exec_eval->get_measurements(*samples[i], false, schedule_timeout);
+
+        for (int i = 0; i < samples.size(); ++i)
+        {
+            syntax_tree *sample = samples[i];
+            std::vector<float> const& measurements = samples_measurements[i];
+            sample->evaluation = min_eval(measurements);
+
+            parent_trace->add_child_path(sample, schedules_annotations->size());
+
+            std::string schedule_json = evaluate_by_learning_model::get_schedule_json(*sample);
+            std::string schedule_annot = schedule_json;
+
+            //remove the last two characters }\n
+            schedule_annot.pop_back();
+            schedule_annot.pop_back();
+
+            if (!sample->hardware_counters.empty())
+                schedule_annot += ", \n\"hardware_counters\" : " + counters_to_str(sample->hardware_counters);
+
+            if (std::isfinite(sample->evaluation))
+                schedule_annot += ", \n\"execution_times\" : " + measurements_to_str(measurements) + "\n}\n";
+            else
+                schedule_annot += ", \n\"execution_times\" : null\n}\n";
+
+            schedules_annotations->push_back(schedule_annot);
+            samples_json.push_back(schedule_json);
+            samples_evaluations.push_back(sample->evaluation);
+
+            if (std::isinf(sample->evaluation))
+                std::cerr<< "Evaluation of schedule "<< schedules_annotations->size() <<" failed "<< std::endl;
+
+            update_best_ast(sample);
+            nb_explored_schedules++;
+
+            delete sample;
+        }
+
+        checkpoint_if_needed();
+    }
+}
+
 }
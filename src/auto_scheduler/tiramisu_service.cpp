@@ -0,0 +1,556 @@
+#include <tiramisu/auto_scheduler/service.h>
+
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+namespace tiramisu::auto_scheduler
+{
+
+namespace
+{
+
+std::string get_absolute_path(std::string const& path)
+{
+    if (!path.empty() && path[0] == '/')
+        return path;
+
+    char cwd[PATH_MAX];
+    if (getcwd(cwd, sizeof(cwd)) == nullptr)
+        return path;
+
+    return std::string(cwd) + "/" + path;
+}
+
+/**
+ * Remove the first line from buffer and store it in line, without the new line.
+ * Return false if the buffer does not contain a complete line.
+ */
+bool pop_line(std::string& buffer, std::string& line)
+{
+    size_t end = buffer.find('\n');
+    if (end == std::string::npos)
+        return false;
+
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+
+    return true;
+}
+
+}
+
+autoscheduling_service::autoscheduling_service(std::string const& socket_path, evaluate_by_learning_model *model, int nb_workers)
+    : socket_path(get_absolute_path(socket_path)), model(model), nb_workers(std::max(nb_workers, 1))
+{
+    lock_path = this->socket_path + ".lock";
+
+    for (int i = this->nb_workers - 1; i >= 0; --i)
+        free_workers.push_back(i);
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (this->socket_path.size() >= sizeof(addr.sun_path))
+    {
+        std::cerr << "error: the socket path " << this->socket_path << " is too long" << std::endl;
+        exit(1);
+    }
+
+    strcpy(addr.sun_path, this->socket_path.c_str());
+    unlink(this->socket_path.c_str());
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd == -1 || bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) == -1 || listen(listen_fd, SOMAXCONN) == -1)
+    {
+        std::cerr << "error: could not listen on " << this->socket_path << " : " << strerror(errno) << std::endl;
+        exit(1);
+    }
+
+    fcntl(listen_fd, F_SETFD, FD_CLOEXEC);
+}
+
+autoscheduling_service::~autoscheduling_service()
+{
+    for (auto const& client : clients)
+        close(client.first);
+
+    if (listen_fd != -1)
+    {
+        close(listen_fd);
+        unlink(socket_path.c_str());
+    }
+}
+
+void autoscheduling_service::run()
+{
+    while (true)
+    {
+        collect_jobs();
+        start_jobs();
+
+        bool jobs_left = false;
+        for (auto const& job : jobs)
+            if (job.second.state != service_job::DONE)
+                jobs_left = true;
+
+        if (shutting_down && !jobs_left)
+            break;
+
+        std::vector<pollfd> fds = {{listen_fd, POLLIN, 0}};
+        for (auto const& client : clients)
+            fds.push_back({client.first, POLLIN, 0});
+
+        // Wake up regularly to collect the jobs that have exited
+        if (poll(fds.data(), fds.size(), 100) <= 0)
+            continue;
+
+        if (fds[0].revents & POLLIN)
+        {
+            int client_fd = accept(listen_fd, nullptr, nullptr);
+            if (client_fd != -1)
+            {
+                fcntl(client_fd, F_SETFD, FD_CLOEXEC);
+                clients[client_fd] = "";
+            }
+        }
+
+        // The evaluate requests of all the clients are given to the model in one batch
+        std::vector<std::pair<int, std::vector<std::pair<std::string, std::string>>>> eval_requests;
+
+        for (int i = 1; i < fds.size(); ++i)
+        {
+            if (fds[i].revents == 0)
+                continue;
+
+            char buffer[65536];
+            ssize_t nb_read = read(fds[i].fd, buffer, sizeof(buffer));
+
+            if (nb_read <= 0)
+            {
+                close(fds[i].fd);
+                clients.erase(fds[i].fd);
+                continue;
+            }
+
+            clients[fds[i].fd].append(buffer, nb_read);
+            handle_requests(fds[i].fd, eval_requests);
+        }
+
+        if (eval_requests.empty())
+            continue;
+
+        std::vector<std::pair<std::string, std::string>> schedules;
+        for (auto const& request : eval_requests)
+            schedules.insert(schedules.end(), request.second.begin(), request.second.end());
+
+        std::vector<float> evaluations = model->evaluate_json_batch(schedules);
+        nb_evaluated_schedules += schedules.size();
+        nb_model_batches++;
+
+        int index = 0;
+        for (auto const& request : eval_requests)
+        {
+            std::string answer;
+            for (int i = 0; i < request.second.size(); ++i)
+                answer += std::to_string(evaluations[index++]) + "\n";
+
+            answer.pop_back();
+            send_line(request.first, answer);
+        }
+    }
+}
+
+void autoscheduling_service::handle_requests(int client_fd, std::vector<std::pair<int, std::vector<std::pair<std::string, std::string>>>>& eval_requests)
+{
+    std::string& buffer = clients[client_fd];
+
+    while (true)
+    {
+        size_t end = buffer.find('\n');
+        if (end == std::string::npos)
+            return;
+
+        if (buffer.compare(0, 9, "evaluate ") != 0)
+        {
+            std::string request;
+            pop_line(buffer, request);
+            handle_request(client_fd, request);
+
+            // The client may have been disconnected
+            if (clients.find(client_fd) == clients.end())
+                return;
+
+            continue;
+        }
+
+        // Wait for the program JSON and the schedule JSON of all the schedules
+        int nb_schedules = std::atoi(buffer.substr(9, end - 9).c_str());
+        size_t request_end = end;
+        for (int i = 0; i < 2 * nb_schedules && request_end != std::string::npos; ++i)
+            request_end = buffer.find('\n', request_end + 1);
+
+        if (request_end == std::string::npos)
+            return;
+
+        std::string header;
+        pop_line(buffer, header);
+
+        std::vector<std::pair<std::string, std::string>> schedules(nb_schedules);
+        for (auto& schedule : schedules)
+        {
+            pop_line(buffer, schedule.first);
+            pop_line(buffer, schedule.second);
+
+            // The model reads one line per JSON
+            schedule.first += "\n";
+            schedule.second += "\n";
+        }
+
+        eval_requests.push_back({client_fd, schedules});
+    }
+}
+
+void autoscheduling_service::handle_request(int client_fd, std::string const& request)
+{
+    std::istringstream stream(request);
+    std::string command;
+    stream >> command;
+
+    if (command == "submit")
+    {
+        if (shutting_down)
+        {
+            send_line(client_fd, "error shutting down");
+            return;
+        }
+
+        service_job job;
+        job.id = next_job_id++;
+        stream >> job.directory;
+        std::getline(stream >> std::ws, job.command);
+
+        if (job.command.empty())
+        {
+            send_line(client_fd, "error usage : submit DIRECTORY COMMAND");
+            return;
+        }
+
+        jobs[job.id] = job;
+        send_line(client_fd, "job " + std::to_string(job.id));
+    }
+
+    else if (command == "status" || command == "wait")
+    {
+        int id = -1;
+        stream >> id;
+
+        auto job = jobs.find(id);
+        if (job == jobs.end())
+            send_line(client_fd, "unknown");
+
+        else if (command == "wait" && job->second.state != service_job::DONE)
+            job->second.waiting_clients.push_back(client_fd);
+
+        else
+            send_line(client_fd, get_job_status(job->second));
+    }
+
+    else if (command == "result")
+    {
+        int id = -1;
+        stream >> id;
+
+        auto job = jobs.find(id);
+        if (job != jobs.end())
+            std::getline(stream >> std::ws, job->second.schedule);
+
+        send_line(client_fd, "ok");
+    }
+
+    else if (command == "stats")
+        send_line(client_fd, get_stats_json());
+
+    else if (command == "shutdown")
+    {
+        shutting_down = true;
+        send_line(client_fd, "ok");
+    }
+
+    else
+        send_line(client_fd, "error unknown request " + command);
+}
+
+void autoscheduling_service::start_jobs()
+{
+    for (auto& entry : jobs)
+    {
+        service_job& job = entry.second;
+        if (job.state != service_job::QUEUED)
+            continue;
+
+        if (free_workers.empty())
+            return;
+
+        job.worker_id = free_workers.back();
+        free_workers.pop_back();
+
+        job.pid = fork();
+        if (job.pid == 0)
+        {
+            if (!job.directory.empty() && chdir(job.directory.c_str()) != 0)
+                _exit(1);
+
+            std::string log_filename = "as_job_" + std::to_string(job.id) + ".log";
+            int log_fd = open(log_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (log_fd != -1)
+            {
+                dup2(log_fd, STDOUT_FILENO);
+                dup2(log_fd, STDERR_FILENO);
+                close(log_fd);
+            }
+
+            setenv("AS_SERVICE_SOCKET", socket_path.c_str(), 1);
+            setenv("AS_SERVICE_JOB", std::to_string(job.id).c_str(), 1);
+            setenv("AS_WORKER_ID", std::to_string(job.worker_id).c_str(), 1);
+            setenv("AS_WORKER_LOCK", lock_path.c_str(), 1);
+
+            execl("/bin/sh", "sh", "-c", job.command.c_str(), (char *) nullptr);
+            _exit(1);
+        }
+
+        if (job.pid == -1)
+        {
+            free_workers.push_back(job.worker_id);
+            return;
+        }
+
+        job.state = service_job::RUNNING;
+    }
+}
+
+void autoscheduling_service::collect_jobs()
+{
+    int status;
+    pid_t pid;
+
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+    {
+        for (auto& entry : jobs)
+        {
+            service_job& job = entry.second;
+            if (job.state != service_job::RUNNING || job.pid != pid)
+                continue;
+
+            job.state = service_job::DONE;
+            job.exit_status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+            free_workers.push_back(job.worker_id);
+
+            for (int client_fd : job.waiting_clients)
+                if (clients.find(client_fd) != clients.end())
+                    send_line(client_fd, get_job_status(job));
+
+            job.waiting_clients.clear();
+        }
+    }
+}
+
+std::string autoscheduling_service::get_job_status(service_job const& job) const
+{
+    switch (job.state)
+    {
+        case service_job::QUEUED:
+            return "queued";
+
+        case service_job::RUNNING:
+            return "running";
+
+        default:
+            return "done " + std::to_string(job.exit_status) + " " + job.schedule;
+    }
+}
+
+void autoscheduling_service::send_line(int client_fd, std::string const& line)
+{
+    std::string message = line + "\n";
+    size_t sent = 0;
+
+    while (sent < message.size())
+    {
+        ssize_t nb_sent = send(client_fd, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+        if (nb_sent <= 0)
+        {
+            close(client_fd);
+            clients.erase(client_fd);
+            return;
+        }
+
+        sent += nb_sent;
+    }
+}
+
+std::string autoscheduling_service::get_stats_json() const
+{
+    int nb_queued = 0, nb_running = 0, nb_done = 0;
+    for (auto const& job : jobs)
+    {
+        if (job.second.state == service_job::QUEUED)
+            nb_queued++;
+        else if (job.second.state == service_job::RUNNING)
+            nb_running++;
+        else
+            nb_done++;
+    }
+
+    std::string stats_json = "{\"queued\" : " + std::to_string(nb_queued) +
+                             ", \"running\" : " + std::to_string(nb_running) +
+                             ", \"done\" : " + std::to_string(nb_done) +
+                             ", \"evaluated_schedules\" : " + std::to_string(nb_evaluated_schedules) +
+                             ", \"model_batches\" : " + std::to_string(nb_model_batches);
+
+    if (model->get_cache() != nullptr)
+        stats_json += ", \"evaluation_cache\" : " + model->get_cache()->get_stats_json();
+
+    return stats_json + "}";
+}
+
+evaluate_by_service::evaluate_by_service(std::string const& socket_path)
+    : evaluation_function()
+{
+    std::string path = socket_path;
+    if (path.empty() && getenv("AS_SERVICE_SOCKET") != nullptr)
+        path = getenv("AS_SERVICE_SOCKET");
+
+    if (getenv("AS_SERVICE_JOB") != nullptr)
+        job_id = std::atoi(getenv("AS_SERVICE_JOB"));
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (path.empty() || socket_fd == -1 || connect(socket_fd, (sockaddr*)&addr, sizeof(addr)) == -1)
+    {
+        std::cerr << "error: could not connect to the autoscheduling service " << path << std::endl;
+        exit(1);
+    }
+}
+
+evaluate_by_service::~evaluate_by_service()
+{
+    if (socket_fd != -1)
+        close(socket_fd);
+}
+
+std::string evaluate_by_service::read_line()
+{
+    std::string line;
+    while (!pop_line(read_buffer, line))
+    {
+        char buffer[4096];
+        ssize_t nb_read = read(socket_fd, buffer, sizeof(buffer));
+
+        if (nb_read <= 0)
+        {
+            std::cerr << "error: the autoscheduling service closed the connection" << std::endl;
+            exit(1);
+        }
+
+        read_buffer.append(buffer, nb_read);
+    }
+
+    return line;
+}
+
+float evaluate_by_service::evaluate(syntax_tree& ast)
+{
+    return evaluate_batch({&ast})[0];
+}
+
+std::vector<float> evaluate_by_service::evaluate_batch(std::vector<syntax_tree*> const& asts)
+{
+    std::vector<float> evaluations(asts.size());
+    std::vector<std::string> cache_keys(asts.size());
+    std::vector<int> to_evaluate;
+
+    for (int i = 0; i < asts.size(); ++i)
+    {
+        std::vector<float> cached_evaluation;
+        if (cache != nullptr)
+        {
+            cache_keys[i] = evaluation_cache::get_key(*asts[i], get_cache_id());
+            if (cache->lookup(cache_keys[i], cached_evaluation))
+            {
+                evaluations[i] = cached_evaluation[0];
+                continue;
+            }
+        }
+
+        to_evaluate.push_back(i);
+    }
+
+    if (to_evaluate.empty())
+        return evaluations;
+
+    std::string request = "evaluate " + std::to_string(to_evaluate.size()) + "\n";
+    for (int i : to_evaluate)
+        request += evaluate_by_learning_model::get_program_json(*asts[i]) +
+                   evaluate_by_learning_model::get_schedule_json(*asts[i]);
+
+    size_t sent = 0;
+    while (sent < request.size())
+    {
+        ssize_t nb_sent = write(socket_fd, request.data() + sent, request.size() - sent);
+        if (nb_sent <= 0)
+        {
+            std::cerr << "error: could not send the schedules to the autoscheduling service" << std::endl;
+            exit(1);
+        }
+
+        sent += nb_sent;
+    }
+
+    for (int i : to_evaluate)
+    {
+        evaluations[i] = std::stof(read_line());
+
+        if (cache != nullptr)
+            cache->insert(cache_keys[i], {evaluations[i]});
+    }
+
+    return evaluations;
+}
+
+void evaluate_by_service::configure_worker(evaluate_by_execution& exec_eval) const
+{
+    if (getenv("AS_WORKER_ID") != nullptr && getenv("AS_WORKER_LOCK") != nullptr)
+        exec_eval.set_worker(std::atoi(getenv("AS_WORKER_ID")), getenv("AS_WORKER_LOCK"));
+}
+
+void evaluate_by_service::report_schedule(syntax_tree& best_ast)
+{
+    if (job_id == -1)
+        return;
+
+    std::string schedule_json = evaluate_by_learning_model::get_schedule_json(best_ast);
+    if (!schedule_json.empty() && schedule_json.back() == '\n')
+        schedule_json.pop_back();
+
+    std::string request = "result " + std::to_string(job_id) + " " + schedule_json + "\n";
+    if (write(socket_fd, request.data(), request.size()) != request.size())
+        return;
+
+    read_line();
+}
+
+}
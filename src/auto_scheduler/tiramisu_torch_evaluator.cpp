@@ -0,0 +1,114 @@
+#include <tiramisu/auto_scheduler/torch_evaluator.h>
+
+#include <torch/script.h>
+
+#include <iostream>
+
+namespace tiramisu::auto_scheduler
+{
+
+evaluate_by_torch_model::evaluate_by_torch_model(std::string const& model_path, std::string const& device,
+                                                 int max_batch_size)
+    : model_path(model_path), device(device), max_batch_size(std::max(max_batch_size, 1))
+{
+    try
+    {
+        module = std::make_unique<torch::jit::Module>(torch::jit::load(model_path, torch::Device(device)));
+        module->eval();
+    }
+    catch (c10::Error const& e)
+    {
+        std::cerr << "error: could not load the model " << model_path << " : " << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+evaluate_by_torch_model::~evaluate_by_torch_model()
+{
+}
+
+std::vector<float> evaluate_by_torch_model::predict(std::vector<syntax_tree*> const& asts)
+{
+    torch::NoGradGuard no_grad;
+    torch::Device torch_device(device);
+
+    std::vector<float> speedups;
+
+    for (int start = 0; start < asts.size(); start += max_batch_size)
+    {
+        int end = std::min((int)asts.size(), start + max_batch_size);
+
+        c10::List<at::Tensor> programs, schedules;
+        for (int i = start; i < end; ++i)
+        {
+            std::vector<float> prog_features, sched_features;
+            evaluate_by_learning_model::get_program_features(*asts[i], prog_features);
+            evaluate_by_learning_model::get_schedule_features(*asts[i], sched_features);
+
+            programs.push_back(torch::tensor(prog_features).to(torch_device));
+            schedules.push_back(torch::tensor(sched_features).to(torch_device));
+        }
+
+        at::Tensor output = module->forward({programs, schedules}).toTensor();
+        output = output.to(torch::kCPU, torch::kFloat32).contiguous().view(-1);
+
+        if (output.numel() != end - start)
+        {
+            std::cerr << "error: the model " << model_path << " returned " << output.numel()
+                      << " speedups for " << end - start << " schedules" << std::endl;
+            exit(1);
+        }
+
+        float const *data = output.data_ptr<float>();
+        speedups.insert(speedups.end(), data, data + output.numel());
+    }
+
+    return speedups;
+}
+
+float evaluate_by_torch_model::evaluate(syntax_tree& ast)
+{
+    return evaluate_batch({&ast})[0];
+}
+
+std::vector<float> evaluate_by_torch_model::evaluate_batch(std::vector<syntax_tree*> const& asts)
+{
+    std::vector<float> evaluations(asts.size());
+    std::vector<std::string> cache_keys(asts.size());
+    std::vector<syntax_tree*> to_evaluate;
+    std::vector<int> indices;
+
+    // Only the schedules that are not in the cache are given to the model
+    for (int i = 0; i < asts.size(); ++i)
+    {
+        std::vector<float> cached_prediction;
+        if (cache != nullptr)
+        {
+            cache_keys[i] = evaluation_cache::get_key(*asts[i], get_cache_id());
+            if (cache->lookup(cache_keys[i], cached_prediction))
+            {
+                evaluations[i] = -cached_prediction[0];
+                continue;
+            }
+        }
+
+        to_evaluate.push_back(asts[i]);
+        indices.push_back(i);
+    }
+
+    if (to_evaluate.empty())
+        return evaluations;
+
+    std::vector<float> speedups = predict(to_evaluate);
+    for (int k = 0; k < indices.size(); ++k)
+    {
+        if (cache != nullptr)
+            cache->insert(cache_keys[indices[k]], {speedups[k]});
+
+        evaluations[indices[k]] = -speedups[k];
+    }
+
+    return evaluations;
+}
+
+}
@@ -0,0 +1,157 @@
+#include <tiramisu/auto_scheduler/variants.h>
+#include <tiramisu/auto_scheduler/utils.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace tiramisu::auto_scheduler
+{
+
+variants_generator::variants_generator(std::string const& fct_name, int nb_arguments, std::vector<variant_parameter> const& params,
+                                       std::vector<std::vector<int>> const& variants_values, bool generic_variants)
+    : fct_name(fct_name), nb_arguments(nb_arguments), params(params),
+      variants_values(variants_values), generic_variants(generic_variants)
+{
+    for (std::vector<int> const& values : variants_values)
+    {
+        if (values.size() != params.size())
+        {
+            std::cerr << "error: each variant of " << fct_name << " must give one value per parameter" << std::endl;
+            exit(1);
+        }
+    }
+}
+
+bool variants_generator::tune_variants(std::function<int(std::vector<int> const&, std::string const&, std::string const&)> const& generate_variant) const
+{
+    for (int i = 0; i < variants_values.size(); ++i)
+    {
+        if (std::atoi(read_env_var("AS_VERBOSE")) == 1)
+            std::cout << "Generating the variant " << get_variant_name(i) << std::endl;
+
+        std::fflush(stdout);
+        pid_t pid = fork();
+
+        if (pid == -1)
+        {
+            std::cerr << "error: could not create a process to generate " << get_variant_name(i) << std::endl;
+            return false;
+        }
+
+        if (pid == 0)
+            _exit(generate_variant(variants_values[i], get_variant_name(i), get_variant_obj_filename(i)));
+
+        int status;
+        waitpid(pid, &status, 0);
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            std::cerr << "error: the generation of " << get_variant_name(i) << " failed" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::string variants_generator::get_dispatcher_code() const
+{
+    std::string args_decl, args_names;
+    for (int i = 0; i < nb_arguments; ++i)
+    {
+        args_decl += "halide_buffer_t *buf" + std::to_string(i);
+        args_names += "buf" + std::to_string(i);
+
+        if (i != nb_arguments - 1)
+        {
+            args_decl += ", ";
+            args_names += ", ";
+        }
+    }
+
+    std::string code = "#include <HalideRuntime.h>\n#include <cmath>\n\nextern \"C\" {\n\n";
+
+    for (int i = 0; i < variants_values.size(); ++i)
+        code += "int " + get_variant_name(i) + "(" + args_decl + ");\n";
+
+    code += "\nstatic const int variants_values[" + std::to_string(variants_values.size()) + "][" + std::to_string(params.size()) + "] = {\n";
+    for (std::vector<int> const& values : variants_values)
+    {
+        code += "    {";
+        for (int value : values)
+            code += std::to_string(value) + ", ";
+
+        code += "},\n";
+    }
+    code += "};\n\n";
+
+    code += "int " + fct_name + "(" + args_decl + ")\n{\n";
+    code += "    halide_buffer_t *args[] = {" + args_names + "};\n";
+
+    // Halide orders the dimensions from the innermost to the outermost
+    code += "    int values[] = {";
+    for (variant_parameter const& param : params)
+        code += "args[" + std::to_string(param.argument_index) + "]->dim[args[" + std::to_string(param.argument_index) +
+                "]->dimensions - 1 - " + std::to_string(param.dim) + "].extent, ";
+    code += "};\n\n";
+
+    code += "    int best_variant = -1;\n";
+    code += "    double best_distance = 0;\n\n";
+    code += "    for (int i = 0; i < " + std::to_string(variants_values.size()) + "; ++i)\n    {\n";
+    code += "        double distance = 0;\n";
+    code += "        for (int j = 0; j < " + std::to_string(params.size()) + "; ++j)\n";
+    code += "            distance += std::fabs(std::log2((double)variants_values[i][j] / values[j]));\n\n";
+
+    if (!generic_variants)
+        code += "        if (distance != 0)\n            continue;\n\n";
+
+    code += "        if (best_variant == -1 || distance < best_distance)\n        {\n";
+    code += "            best_variant = i;\n            best_distance = distance;\n        }\n    }\n\n";
+
+    code += "    switch (best_variant)\n    {\n";
+    for (int i = 0; i < variants_values.size(); ++i)
+        code += "        case " + std::to_string(i) + ": return " + get_variant_name(i) + "(" + args_names + ");\n";
+
+    code += "        default: return -1;\n    }\n}\n\n}\n";
+
+    return code;
+}
+
+bool variants_generator::generate_object(std::string const& obj_filename) const
+{
+    std::string dispatcher_filename = fct_name + "_dispatcher.cpp";
+
+    std::ofstream dispatcher_file(dispatcher_filename);
+    dispatcher_file << get_dispatcher_code();
+    dispatcher_file.close();
+
+    std::string compile_cmd = "g++ -std=c++11 -O2 -fPIC -c " + std::string(read_env_var("AS_DISPATCHER_FLAGS")) + " " +
+                              dispatcher_filename + " -o " + fct_name + "_dispatcher.o";
+
+    if (system(compile_cmd.c_str()) != 0)
+    {
+        std::cerr << "error: could not compile the dispatcher of " << fct_name << std::endl;
+        return false;
+    }
+
+    // Link the dispatcher and the variants into a single relocatable object
+    std::string link_cmd = "ld -r -o " + obj_filename + " " + fct_name + "_dispatcher.o";
+    for (int i = 0; i < variants_values.size(); ++i)
+        link_cmd += " " + get_variant_obj_filename(i);
+
+    if (system(link_cmd.c_str()) != 0)
+    {
+        std::cerr << "error: could not link the variants of " << fct_name << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+}
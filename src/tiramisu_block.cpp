@@ -4,6 +4,9 @@ namespace tiramisu {
 
 block::block(const std::vector<computation *> children) : children(children) {
     // Block is a special child of computation. Don't call parent constructor.
+    if (!children.empty()) {
+        children[0]->get_function()->add_block(children);
+    }
 }
 
 // Overloads of scheduling commands.
@@ -35,6 +38,15 @@ void block::gpu_tile(var L0, var L1, var L2, int sizeX, int sizeY, int sizeZ,
     }
 }
 
+void block::gpu_tile(var L0, var L1, int sizeX, int sizeY,
+                     int coarseningX, int coarseningY,
+                     var L0_outer, var L1_outer, var L0_inner, var L1_inner) {
+    for (auto &child : this->children) {
+        child->gpu_tile(L0, L1, sizeX, sizeY, coarseningX, coarseningY,
+                        L0_outer, L1_outer, L0_inner, L1_inner);
+    }
+}
+
 void block::interchange(var L0, var L1) {
     for (auto &child : this->children) {
         child->interchange(L0, L1);
@@ -140,6 +152,12 @@ void block::skew(int i, int j, int a, int b, int c, int d) {
     }
 }
 
+void block::unimodular_transform(int L, const std::vector<std::vector<int>> &matrix) {
+    for (auto &child : this->children) {
+        child->unimodular_transform(L, matrix);
+    }
+}
+
 void block::split(var L0, int sizeX) {
     for (auto &child : this->children) {
         child->split(L0, sizeX);
@@ -222,6 +240,24 @@ void block::unroll(int L, int fac) {
     }
 }
 
+void block::unroll_and_jam(var L, int fac) {
+    for (auto &child : this->children) {
+        child->unroll_and_jam(L, fac);
+    }
+}
+
+void block::unroll_and_jam(var L, int fac, var L_outer, var L_inner) {
+    for (auto &child : this->children) {
+        child->unroll_and_jam(L, fac, L_outer, L_inner);
+    }
+}
+
+void block::unroll_and_jam(int L, int fac) {
+    for (auto &child : this->children) {
+        child->unroll_and_jam(L, fac);
+    }
+}
+
 void block::vectorize(var L, int v) {
     for (auto &child : this->children) {
         child->vectorize(L, v);
@@ -9,7 +9,9 @@
 
 #include <tiramisu/debug.h>
 #include <tiramisu/core.h>
+#include <tiramisu/cuda_ast.h>
 
+#include <fstream>
 #include <string>
 
 
@@ -24,3 +26,109 @@ void tiramisu::function::gen_c_code() const
     isl_printer_free(p);
     tiramisu::str_dump("\n\n");
 }
+
+// Included at the beginning of the C files generated by function::codegen_c()
+static const char *c_source_prelude = R"(#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+#define TIRAMISU_LINKAGE extern "C"
+#define TIRAMISU_RESTRICT __restrict__
+#else
+#define TIRAMISU_LINKAGE
+#define TIRAMISU_RESTRICT restrict
+#endif
+
+#ifndef TIRAMISU_ALIGNMENT
+#define TIRAMISU_ALIGNMENT 64
+#endif
+
+#ifndef min
+#define min(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+#ifndef max
+#define max(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+#ifndef lerp
+#define lerp(a, b, w) ((a) + ((b) - (a)) * (w))
+#endif
+
+static inline void *tiramisu_aligned_alloc(size_t size)
+{
+    // aligned_alloc() needs a multiple of the alignment
+    return aligned_alloc(TIRAMISU_ALIGNMENT, (size + TIRAMISU_ALIGNMENT - 1) / TIRAMISU_ALIGNMENT * TIRAMISU_ALIGNMENT);
+}
+
+)";
+
+void tiramisu::function::gen_c_source(const std::string &c_filename)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    if (!this->gpu_block_dimensions.empty() || !this->gpu_thread_dimensions.empty())
+        ERROR("The C backend does not support GPU computations.", true);
+    if (!this->distributed_dimensions.empty())
+        ERROR("The C backend does not support distributed computations.", true);
+
+    cuda_ast::generator generator{*this};
+    generator.c_backend = true;
+
+    auto main_body = generator.cuda_stmt_from_isl_node(this->get_isl_ast());
+
+    auto function_body = new cuda_ast::block;
+
+    for (auto &invariant: this->get_invariants()) {
+        std::vector<isl_ast_expr*> ie{};
+        auto rhs = generator.parse_tiramisu(generator::replace_accesses(this, ie, invariant.get_expr()));
+        auto scalar = cuda_ast::scalar_ptr{
+                new cuda_ast::scalar{rhs->get_type(), invariant.get_name(), cuda_ast::memory_location::reg, true}};
+        function_body->add_statement(
+                cuda_ast::statement_ptr{new cuda_ast::declaration{
+                        cuda_ast::assignment_ptr{new cuda_ast::scalar_assignment{scalar, rhs}}}});
+    }
+
+    // The temporary buffers are local to the function, so that it is reentrant
+    std::vector<cuda_ast::statement_ptr> frees;
+    for (const auto &b : this->get_buffers()) {
+        tiramisu::buffer *buf = b.second;
+        if (buf->get_argument_type() != tiramisu::a_temporary || buf->get_location() != cuda_ast::memory_location::host)
+            continue;
+
+        auto c_buffer = generator.get_buffer(buf->get_name());
+        function_body->add_statement(cuda_ast::statement_ptr{new cuda_ast::declaration{c_buffer}});
+
+        if (buf->get_auto_allocate()) {
+            function_body->add_statement(cuda_ast::statement_ptr{new cuda_ast::allocate(c_buffer, true)});
+            buf->mark_as_allocated();
+        }
+
+        if (buf->get_auto_deallocate())
+            frees.push_back(cuda_ast::statement_ptr{new cuda_ast::free(c_buffer)});
+    }
+
+    function_body->add_statement(main_body);
+    for (auto &f : frees)
+        function_body->add_statement(f);
+
+    std::vector<cuda_ast::abstract_identifier_ptr> arguments;
+    for (auto &b : this->get_arguments())
+        arguments.push_back(generator.get_buffer(b->get_name()));
+
+    cuda_ast::host_function c_function{p_none, this->get_name(), arguments, cuda_ast::statement_ptr{function_body}};
+    c_function.set_pointer_return(false);
+    c_function.set_linkage("TIRAMISU_LINKAGE");
+    c_function.set_pointer_qualifier("TIRAMISU_RESTRICT");
+
+    std::string code = static_cast<cuda_ast::statement &>(c_function).print();
+    DEBUG(3, tiramisu::str_dump("Generated C code:\n" + code));
+
+    std::ofstream c_file(c_filename);
+    if (!c_file)
+        ERROR("Cannot write the C file " + c_filename + ".", true);
+    c_file << c_source_prelude << code << std::endl;
+
+    DEBUG_INDENT(-4);
+}
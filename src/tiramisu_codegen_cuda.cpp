@@ -26,8 +26,11 @@
 #include <isl/ast_type.h>
 #include <isl/ast.h>
 
+#include <cstdio>
 #include <fstream>
+#include <regex>
 #include <memory>
+#include <sys/stat.h>
 
 #ifdef _WIN32
 #define popen _popen
@@ -35,6 +38,11 @@
 
 #include <direct.h>
 #define getcwd _getcwd
+#define mkdir(path, mode) _mkdir(path)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
 #endif
 
 namespace tiramisu {
@@ -148,6 +156,14 @@ const std::string cuda_ast::tiramisu_type_to_cuda_type(tiramisu::primitive_t t)
             return "float";
         case tiramisu::p_float64:
             return "double";
+        case tiramisu::p_float16:
+            return "__half";
+        case tiramisu::p_bfloat16:
+            return "__nv_bfloat16";
+        case tiramisu::p_complex64:
+            return "float2";
+        case tiramisu::p_complex128:
+            return "double2";
         default: {
             assert(false);
             return "";
@@ -253,6 +269,14 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
 
         statement_ptr result;
 
+        // The loop, with the kernels in its body, is a single persistent kernel
+        bool persistent = !in_kernel && !in_persistent && is_persistent_loop(node, (int) iterator_stack.size());
+        if (persistent) {
+            in_persistent = true;
+            persistent_depth = (int) iterator_stack.size();
+            persistent_kernel = kernel_ptr{new kernel};
+        }
+
         m_scalar_data.insert(
                 std::make_pair(iterator_name,
                                std::make_pair(tiramisu::global::get_loop_iterator_data_type(),
@@ -262,9 +286,18 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         iterator_upper_bound.push_back(cuda_stmt_val_from_for_condition(condition, node));
         iterator_lower_bound.push_back(initializer_stmt);
 
+        // The loops of a tile computed with tensor cores are replaced by one
+        // matrix multiply-accumulate at the first iteration of the tile
+        bool tensor_core_loop = false;
+        if (computation *tc = get_tensor_core_computation(body)) {
+            tensor_core_loop = (int) iterator_stack.size() - 1 >= std::get<0>(*get_tensor_core_levels(tc));
+        }
+
+        loop_node_stack.push_back(node);
         this->loop_level ++;
         auto body_statement = cuda_stmt_from_isl_node(body);
         this->loop_level --;
+        loop_node_stack.pop_back();
 
         // Check if GPU
         auto gpu_it = gpu_iterators.find(iterator_name);
@@ -290,11 +323,17 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
                             *it,
                             cuda_ast::memory_location::reg}});
                 }
-                kernels.push_back(current_kernel);
-                result = statement_ptr{new kernel_call{current_kernel}};
-                iterator_to_kernel_map[node] = current_kernel;
+                if (in_persistent) {
+                    persistent_kernel->add_persistent_part(current_kernel, persistent_local_scalars());
+                    result = statement_ptr{new persistent_part{current_kernel}};
+                } else {
+                    kernels.push_back(current_kernel);
+                    result = statement_ptr{new kernel_call{current_kernel}};
+                    iterator_to_kernel_map[node] = current_kernel;
+                }
                 current_kernel.reset();
                 in_kernel = false;
+                warp_per_thread = false;
             } else {
                 result = body_statement;
             }
@@ -302,17 +341,29 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
             auto it = std::static_pointer_cast<cuda_ast::scalar>(cuda_stmt_handle_isl_expr(iterator, node));
             auto initializer_statement = statement_ptr{new declaration{
                     assignment_ptr{new scalar_assignment{it, initializer_stmt}}}};
-            auto condition_statement = cuda_stmt_handle_isl_expr(condition, node);
-            auto incrementor_statement = statement_ptr{new binary{it->get_type(), it, cuda_stmt_handle_isl_expr(incrementor, node), "+="}};
-
-            // TODO get loop bound in the core
-
-
-            result = statement_ptr{new cuda_ast::for_loop{
-                    initializer_statement,
-                    condition_statement,
-                    incrementor_statement,
-                    body_statement}};
+            if (tensor_core_loop) {
+                auto *tile = new cuda_ast::block;
+                tile->add_statement(initializer_statement);
+                tile->add_statement(body_statement);
+                result = statement_ptr{tile};
+            } else {
+                auto condition_statement = cuda_stmt_handle_isl_expr(condition, node);
+                auto incrementor_statement = statement_ptr{new binary{it->get_type(), it, cuda_stmt_handle_isl_expr(incrementor, node), "+="}};
+
+                // TODO get loop bound in the core
+
+
+                auto *loop = new cuda_ast::for_loop{
+                        initializer_statement,
+                        condition_statement,
+                        incrementor_statement,
+                        body_statement};
+                if (c_backend && !in_kernel)
+                    loop->set_pragma(cpu_loop_pragma(body, (int) iterator_stack.size() - 1));
+                else if (in_kernel)
+                    loop->set_pragma(kernel_loop_pragma(body, (int) iterator_stack.size() - 1));
+                result = statement_ptr{loop};
+            }
         }
 
 
@@ -322,6 +373,20 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         iterator_upper_bound.pop_back();
         iterator_stack.pop_back();
 
+        if (persistent) {
+            if (!persistent_kernel->is_persistent())
+                ERROR("The persistent loop " + iterator_name + " does not contain any kernel.", true);
+            auto *kernel_body = new cuda_ast::block;
+            kernel_body->add_statement(result);
+            persistent_kernel->set_body(statement_ptr{kernel_body});
+            kernels.push_back(persistent_kernel);
+            result = statement_ptr{new kernel_call{persistent_kernel}};
+            iterator_to_kernel_map[node] = persistent_kernel;
+            persistent_kernel.reset();
+            in_persistent = false;
+            persistent_depth = -1;
+        }
+
         return result;
     }
 
@@ -387,7 +452,8 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
                             bool failed = false;
                             tiramisu::expr linear_access = 0;
                             tiramisu::expr multiplier = 1;
-                            auto accesses = tiramisu_expr.get_access();
+                            auto accesses = this->m_fct.get_buffers().at(b->get_name())->get_shared_layout_indices(
+                                    tiramisu_expr.get_access());
                             std::vector<tiramisu::expr> buffer_size = b->sizes_expr();
                             for (int i = accesses.size() - 1; i >= 0; --i)
                             {
@@ -406,8 +472,14 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
                             }
                             if (!failed) 
                             {
-                                
-                                buffer_access *access = new buffer_access{b, indices};
+                                // The gathers from buffers that the kernels never write go through the read-only data cache
+                                auto tagged = m_fct.get_buffers().find(b->get_name());
+                                bool read_only_cache = in_kernel && b->get_location() == memory_location::global &&
+                                                       b->get_type() != p_boolean && is_read_only_buffer(b->get_name()) &&
+                                                       (tiramisu_expr.is_gather() ||
+                                                        (tagged != m_fct.get_buffers().end() && tagged->second->gpu_read_only));
+
+                                buffer_access *access = new buffer_access{b, indices, read_only_cache};
                                 ret = statement_ptr{access};
                             }
                         }
@@ -424,6 +496,13 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
                                 new function_call{tiramisu_expr.get_data_type(), tiramisu_expr.get_name(), operands}};
                     }
                     case o_cast: {
+                        // A real number is cast to a complex number with a null imaginary part
+                        if (is_complex_type(tiramisu_expr.get_data_type()) &&
+                            !is_complex_type(tiramisu_expr.get_operand(0).get_data_type())) {
+                            primitive_t component = complex_component_type(tiramisu_expr.get_data_type());
+                            return parse_tiramisu(make_complex(cast(component, tiramisu_expr.get_operand(0)),
+                                                               cast(component, tiramisu::expr(0.0f))));
+                        }
                         // Add a cast statement only if necessary
                         if (tiramisu_expr.get_data_type() != tiramisu_expr.get_operand(0).get_data_type()) {
                             return statement_ptr{new cuda_ast::cast{tiramisu_expr.get_data_type(),
@@ -495,13 +574,21 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
             buffer = it->second;
         } else {
             auto tiramisu_buffer = this->m_fct.get_buffers().at(name);
+            // A buffer of complex numbers is an array of float2 (or double2),
+            // without the innermost dimension of their real and imaginary parts
+            primitive_t type = tiramisu_buffer->get_elements_type();
+            std::vector<tiramisu::expr> dim_sizes = tiramisu_buffer->get_dim_sizes();
+            if (tiramisu_buffer->get_complex_type() != p_none) {
+                type = tiramisu_buffer->get_complex_type();
+                dim_sizes.pop_back();
+            }
             std::vector<cuda_ast::statement_ptr> sizes;
-            for (auto &dim : tiramisu_buffer->get_dim_sizes()) {
+            for (auto &dim : dim_sizes) {
 
                 sizes.push_back(this->parse_tiramisu(dim));
             }
-            buffer = buffer_ptr{new cuda_ast::buffer{tiramisu_buffer->get_elements_type(), tiramisu_buffer->get_name(),
-                                                     tiramisu_buffer->location, sizes, tiramisu_buffer->get_dim_sizes()}};
+            buffer = buffer_ptr{new cuda_ast::buffer{type, tiramisu_buffer->get_name(),
+                                                     tiramisu_buffer->location, sizes, dim_sizes}};
             m_buffers[name] = buffer;
         }
         if (in_kernel && gpu_local.find(name) == gpu_local.end()) {
@@ -523,7 +610,17 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         gpu_iterator result{type, dim, statement_ptr{new binary{actual_bound->get_type(),
                                                                 actual_bound,
                                                                 statement_ptr{new value{value_cast(actual_bound->get_type(), 1)}},
-                                                                "+"}}};
+                                                                "+"}},
+                            in_persistent && type == gpu_iterator::type_t::BLOCK};
+        // When each iteration is executed by a warp, the threads x of a warp
+        // execute the same iteration
+        int lanes = 1;
+        if (warp_per_thread && type == gpu_iterator::type_t::THREAD && dim == gpu_iterator::dimension_t::x) {
+            lanes = 32;
+            result.size = statement_ptr{new binary{result.size->get_type(), result.size,
+                                                   statement_ptr{new value{value_cast(result.size->get_type(), lanes)}},
+                                                   "*"}};
+        }
         if (min_cap.first) {
             statement_ptr it_access{new gpu_iterator_read{result}};
             gpu_conditions.push_back(
@@ -537,7 +634,7 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
                         scalar_ptr{new scalar{lower_bound->get_type(), result.simplified_name(), memory_location::reg, true}},
                         statement_ptr { new binary{
                                 lower_bound->get_type(),
-                                statement_ptr{new gpu_iterator_read{result, false}},
+                                statement_ptr{new gpu_iterator_read{result, false, lanes}},
                                 lower_bound->replace_iterators(gpu_iterators),
                                 "+"
                         }}
@@ -553,10 +650,12 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
             auto *comp = get_computation_annotated_in_a_node(node);
             // TODO use lower bound
             if (!this->in_kernel) {
+                int kernel_level = -1;
                 for (auto &comp_gpu_pair : this->m_fct.gpu_block_dimensions) {
                     if (comp_gpu_pair.first == comp->get_name()) {
                         int level;
                         this->in_kernel = true;
+                        kernel_level = std::get<0>(comp_gpu_pair.second);
                         // We are assigning x, y, z from inner to outer loop:
                         gpu_iterator::dimension_t dims[] = { gpu_iterator::dimension_t::x,
                                                              gpu_iterator::dimension_t::y,
@@ -586,6 +685,8 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
 
 
                 if (in_kernel) {
+                    // Tensor cores are used by whole warps
+                    this->warp_per_thread = contains_tensor_core_computation(loop_node_stack[kernel_level]);
                     for (auto &comp_gpu_pair : this->m_fct.gpu_thread_dimensions) {
                         if (comp_gpu_pair.first == comp->get_name()) {
                             int level;
@@ -616,10 +717,16 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
                                         iterator_upper_bound[level]);
                             }
                             this->current_kernel = kernel_ptr{new kernel};
+                            auto stream = this->m_fct.gpu_streams.find(comp->get_name());
+                            if (stream != this->m_fct.gpu_streams.end())
+                                this->current_kernel->set_stream(stream->second);
                             break;
                         }
                     }
                 }
+                if (in_persistent && !in_kernel)
+                    ERROR("The computation " + comp->get_name() + " is not mapped to the GPU: it cannot be in the body " +
+                          "of the persistent loop " + iterator_stack[persistent_depth] + ".", true);
                 for (auto &it : gpu_conditions) {
                     auto used_scalars = it->extract_scalars();
                     for (auto &scalar: used_scalars) {
@@ -632,6 +739,9 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
                 }
             }
             if (comp->get_expr().get_expr_type() == e_sync) {
+                auto barrier = this->m_fct.gpu_async_barriers.find(comp->get_name());
+                if (barrier != this->m_fct.gpu_async_barriers.end())
+                    return statement_ptr{new cuda_ast::sync{barrier->second}};
                 return statement_ptr{new cuda_ast::sync};
             } else if (comp->get_expr().get_op_type() == o_memcpy) {
                 return statement_ptr{parse_tiramisu(comp->get_expr())};
@@ -653,7 +763,7 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
                 for (const auto &arg : e.get_arguments()) {
                     arguments.push_back(parse_tiramisu(replace_original_indices_with_transformed_indices(arg, comp->get_iterators_map())));
                 }
-                return statement_ptr{new cuda_ast::function_call{e.get_data_type(), e.get_name(), arguments}};
+                return first_lane_only(statement_ptr{new cuda_ast::function_call{e.get_data_type(), e.get_name(), arguments}});
             } else {
                 auto &associated_lets = comp->get_associated_let_stmts();
                 for (auto &statement: associated_lets) {
@@ -664,7 +774,9 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
                     index_exprs[comp] = comp->index_expr;
                 auto result = comp->create_tiramisu_assignment(index_exprs[comp]);
                 statement_ptr asgmnt;
-                if (result.first.get_expr_type() == e_var) {
+                if (get_tensor_core_levels(comp) != nullptr) {
+                    asgmnt = cuda_stmt_tensor_core_call(comp, result);
+                } else if (result.first.get_expr_type() == e_var) {
                     cuda_ast::scalar_ptr s = scalar_ptr{new scalar{result.first.get_data_type(), result.first.get_name(), memory_location::reg, true}};
                     // TODO associated let statement doesn't work well with declaration
                     asgmnt = statement_ptr{new declaration{assignment_ptr{new scalar_assignment{s, parse_tiramisu(result.second)}}}};
@@ -673,8 +785,21 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
                     gpu_local.insert(result.first.get_name());
                 } else {
                     cuda_ast::buffer_ptr b = this->get_buffer(result.first.get_name());
-                    asgmnt = statement_ptr{new buffer_assignment{b, parse_tiramisu(result.first.get_access()[0]),
-                                                                  parse_tiramisu(result.second)}};
+                    int bytes = halide_type_from_tiramisu_type(b->get_type()).bytes();
+                    if (this->m_fct.gpu_async_copies.count(comp->get_name()) != 0
+                            && result.second.get_expr_type() == e_op && result.second.get_op_type() == o_access
+                            && (bytes == 4 || bytes == 8 || bytes == 16)) {
+                        // The pipeline primitives only copy 4, 8 or 16 bytes
+                        statement_ptr destination{new buffer_access{b, {parse_tiramisu(result.first.get_access()[0])}}};
+                        std::vector<statement_ptr> arguments{
+                                statement_ptr{new unary{b->get_type(), destination, "&"}},
+                                statement_ptr{new unary{b->get_type(), parse_tiramisu(result.second), "&"}},
+                                statement_ptr{new value{value_cast(p_int32, bytes)}}};
+                        asgmnt = statement_ptr{new function_call{p_none, "__pipeline_memcpy_async", arguments}};
+                    } else if (!(asgmnt = cuda_stmt_gpu_reduction(comp, result))) {
+                        asgmnt = statement_ptr{new buffer_assignment{b, parse_tiramisu(result.first.get_access()[0]),
+                                                                      parse_tiramisu(result.second)}};
+                    }
                 }
                 if (comp->get_predicate().is_defined()) {
 
@@ -684,6 +809,9 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
                             comp->get_iterators_map());
                     asgmnt = statement_ptr{new if_condition{parse_tiramisu(tiramisu_predicate), asgmnt}};
                 }
+                if (get_tensor_core_levels(comp) == nullptr && result.first.get_expr_type() != e_var) {
+                    asgmnt = first_lane_only(asgmnt);
+                }
                 if (associated_lets.empty()) {
                     return asgmnt;
                 } else {
@@ -750,7 +878,7 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
             if ( !buf->get_auto_allocate() )
             {
                 std::cout << "DEBUG: returning cuda_ast for ALLOC of " << buf->get_name() << "\n";
-                return cuda_ast::statement_ptr{ new cuda_ast::allocate(cuda_ast_buffer) };
+                return cuda_ast::statement_ptr{ new cuda_ast::allocate(cuda_ast_buffer, c_backend) };
             }
         }
         if ( get_computation_annotated_in_a_node(node)->get_expr().get_op_type() == tiramisu::o_free )
@@ -771,10 +899,238 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         return cuda_stmt_handle_isl_expr(expr, node);
     }
 
+    const std::tuple<int, int, int> *cuda_ast::generator::get_tensor_core_levels(computation *comp) const {
+        for (const auto &dims : this->m_fct.gpu_tensor_core_dimensions)
+            if (dims.first == comp->get_name())
+                return &dims.second;
+        return nullptr;
+    }
+
+    namespace {
+        isl_bool collect_computation(isl_ast_node *node, void *user) {
+            if (isl_ast_node_get_type(node) == isl_ast_node_user)
+                ((std::unordered_set<computation *> *) user)->insert(get_computation_annotated_in_a_node(node));
+            return isl_bool_true;
+        }
+
+        std::unordered_set<computation *> computations_in(isl_ast_node *node) {
+            std::unordered_set<computation *> computations;
+            isl_ast_node_foreach_descendant_top_down(node, &collect_computation, &computations);
+            return computations;
+        }
+    }
+
+    tiramisu::computation *cuda_ast::generator::get_tensor_core_computation(isl_ast_node *node) const {
+        auto computations = computations_in(node);
+        if (computations.size() == 1 && get_tensor_core_levels(*computations.begin()) != nullptr)
+            return *computations.begin();
+        return nullptr;
+    }
+
+    bool cuda_ast::generator::contains_tensor_core_computation(isl_ast_node *node) const {
+        for (auto *comp : computations_in(node))
+            if (get_tensor_core_levels(comp) != nullptr)
+                return true;
+        return false;
+    }
+
+    bool cuda_ast::generator::is_persistent_loop(isl_ast_node *node, int level) const {
+        for (auto *comp : computations_in(node))
+            for (const auto &dim : this->m_fct.gpu_persistent_dimensions)
+                if (dim.first == comp->get_name() && dim.second == level)
+                    return true;
+        return false;
+    }
+
+    std::unordered_set<std::string> cuda_ast::generator::persistent_local_scalars() const {
+        std::unordered_set<std::string> result;
+        if (in_persistent)
+            result.insert(iterator_stack.begin() + persistent_depth, iterator_stack.end());
+        return result;
+    }
+
+    std::string cuda_ast::generator::cpu_loop_pragma(isl_ast_node *body, int level) const {
+        std::string pragma;
+        for (auto *comp : computations_in(body)) {
+            if (this->m_fct.should_parallelize(comp->get_name(), level))
+                return "#pragma omp parallel for";
+            if (this->m_fct.should_vectorize(comp->get_name(), level))
+                pragma = "#pragma omp simd simdlen(" +
+                         std::to_string(this->m_fct.get_vector_length(comp->get_name(), level)) + ")";
+        }
+        return pragma;
+    }
+
+    std::string cuda_ast::generator::kernel_loop_pragma(isl_ast_node *body, int level) const {
+        for (auto *comp : computations_in(body)) {
+            if (!this->m_fct.should_unroll(comp->get_name(), level))
+                continue;
+            int factor = this->m_fct.get_unrolling_factor(comp->get_name(), level);
+            return (factor > 0) ? "#pragma unroll " + std::to_string(factor) : "#pragma unroll";
+        }
+        return "";
+    }
+
+    bool cuda_ast::generator::is_read_only_buffer(const std::string &name) const {
+        for (auto *comp : this->m_fct.get_computations()) {
+            const tiramisu::expr &e = comp->get_expr();
+            if (e.get_expr_type() == e_none)
+                continue;
+            if (e.get_expr_type() == e_op && (e.get_op_type() == o_memcpy || e.get_op_type() == o_allocate))
+                continue;
+            isl_map *access = comp->get_access_relation();
+            if (access != nullptr && isl_map_has_tuple_name(access, isl_dim_out) &&
+                name == isl_map_get_tuple_name(access, isl_dim_out))
+                return false;
+        }
+        return true;
+    }
+
+    cuda_ast::statement_ptr cuda_ast::generator::first_lane_only(statement_ptr stmt) {
+        if (!this->warp_per_thread)
+            return stmt;
+
+        gpu_iterator thread_x{gpu_iterator::type_t::THREAD, gpu_iterator::dimension_t::x, nullptr};
+        auto lane = statement_ptr{new binary{p_int32, statement_ptr{new gpu_iterator_read{thread_x, false}},
+                                             statement_ptr{new value{value_cast(p_int32, 32)}}, "%"}};
+        return statement_ptr{new if_condition{
+                statement_ptr{new binary{p_boolean, lane, statement_ptr{new value{value_cast(p_int32, 0)}}, "=="}},
+                stmt}};
+    }
+
+    cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_gpu_reduction(computation *comp,
+                                                                         const std::pair<tiramisu::expr, tiramisu::expr> &assignment) {
+        tiramisu::reduction_strategy_t strategy;
+        int nb_partials;
+        bool reduction = false;
+        for (const auto &dims : {this->m_fct.gpu_block_dimensions, this->m_fct.gpu_thread_dimensions})
+            for (const auto &d : dims)
+                if (d.first == comp->get_name())
+                    for (int level : {std::get<0>(d.second), std::get<1>(d.second), std::get<2>(d.second)})
+                        if (level != -1 && this->m_fct.get_reduction_strategy(comp->get_name(), level, strategy, nb_partials))
+                            reduction = true;
+        if (!reduction)
+            return nullptr;
+
+        // The update must be acc = acc op term
+        const std::string &accumulator = assignment.first.get_name();
+        const tiramisu::expr &update = assignment.second;
+        auto is_accumulator = [&](const tiramisu::expr &e) {
+            return e.get_expr_type() == e_op && e.get_op_type() == o_access && e.get_name() == accumulator;
+        };
+        std::string op;
+        if (update.get_expr_type() == e_op && update.get_n_arg() == 2 &&
+            is_accumulator(update.get_operand(0)) != is_accumulator(update.get_operand(1))) {
+            switch (update.get_op_type()) {
+                case o_add: op = "add"; break;
+                case o_mul: op = "mul"; break;
+                case o_min: op = "min"; break;
+                case o_max: op = "max"; break;
+                default: break;
+            }
+        }
+        if (op.empty())
+            ERROR("The updates of the accumulator " + accumulator + " of the GPU reduction " + comp->get_name() +
+                  " must be of the form acc = acc op e, op being +, *, min or max.", true);
+
+        cuda_ast::buffer_ptr b = this->get_buffer(accumulator);
+        int bytes = halide_type_from_tiramisu_type(b->get_type()).bytes();
+        if (is_complex_type(b->get_type()) || (bytes != 4 && bytes != 8))
+            ERROR("The accumulator " + accumulator + " of the GPU reduction " + comp->get_name() +
+                  " must be a 32-bit or a 64-bit number.", true);
+
+        const tiramisu::expr &term = is_accumulator(update.get_operand(0)) ? update.get_operand(1) : update.get_operand(0);
+        std::string type = tiramisu_type_to_cuda_type(b->get_type());
+        std::string op_type = "tiramisu_reduction::" + op + "<" + type + ">";
+        // With reduction_atomic, each thread updates the accumulator.  Otherwise the
+        // threads of a warp first combine their terms with shuffles, and one atomic
+        // update is made per warp.
+        std::string name = (strategy == tiramisu::reduction_atomic)
+                           ? "tiramisu_reduction::atomic<" + type + ", " + op_type + ">::update"
+                           : "tiramisu_reduction::warp_update<" + type + ", " + op_type + ">";
+        statement_ptr destination{new buffer_access{b, {parse_tiramisu(assignment.first.get_access()[0])}}};
+        std::vector<statement_ptr> arguments{statement_ptr{new unary{b->get_type(), destination, "&"}},
+                                             statement_ptr{new cuda_ast::cast{b->get_type(), parse_tiramisu(term)}}};
+        return statement_ptr{new function_call{p_none, name, arguments}};
+    }
+
+    cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_tensor_core_call(computation *comp,
+                                                                            const std::pair<tiramisu::expr, tiramisu::expr> &assignment) {
+        auto strip_casts = [](const tiramisu::expr &e) {
+            tiramisu::expr r = e;
+            while (r.get_expr_type() == e_op && r.get_op_type() == o_cast)
+                r = r.get_operand(0);
+            return r;
+        };
+        auto is_access = [](const tiramisu::expr &e) {
+            return e.get_expr_type() == e_op && e.get_op_type() == o_access;
+        };
+        // Return (C, A * B) if e is C + A * B, where C is an access to acc_name
+        auto match = [&](const tiramisu::expr &e, const std::string &acc_name) {
+            std::pair<tiramisu::expr, tiramisu::expr> result;
+            tiramisu::expr sum = strip_casts(e);
+            if (sum.get_expr_type() == e_op && sum.get_op_type() == o_add) {
+                for (int i = 0; i < 2; i++) {
+                    tiramisu::expr acc = strip_casts(sum.get_operand(i));
+                    tiramisu::expr prod = strip_casts(sum.get_operand(1 - i));
+                    if (is_access(acc) && acc.get_name() == acc_name &&
+                        prod.get_expr_type() == e_op && prod.get_op_type() == o_mul &&
+                        is_access(strip_casts(prod.get_operand(0))) && is_access(strip_casts(prod.get_operand(1))))
+                        result = std::make_pair(acc, prod);
+                }
+            }
+            if (!result.second.is_defined())
+                ERROR("Computation " + comp->get_name() + " is not of the form C = C + A * B and cannot use tensor cores.", true);
+            return result;
+        };
+
+        // Find A, the operand that shares its first index with C, in the
+        // original expression (see computation::pack_gemm_operands())
+        auto original = match(comp->get_expr(), comp->get_name());
+        tiramisu::expr a = strip_casts(original.second.get_operand(0));
+        tiramisu::expr b = strip_casts(original.second.get_operand(1));
+        bool swap = !original.first.get_access().empty() && !b.get_access().empty() &&
+                    b.get_access()[0].is_equal(original.first.get_access()[0]) &&
+                    (a.get_access().empty() || !a.get_access()[0].is_equal(original.first.get_access()[0]));
+
+        // The operands after their accesses were replaced by buffer accesses
+        auto transformed = match(assignment.second, assignment.first.get_name());
+        tiramisu::expr a_access = strip_casts(transformed.second.get_operand(swap ? 1 : 0));
+        tiramisu::expr b_access = strip_casts(transformed.second.get_operand(swap ? 0 : 1));
+
+        primitive_t a_type = m_fct.get_buffers().at(a_access.get_name())->get_elements_type();
+        primitive_t b_type = m_fct.get_buffers().at(b_access.get_name())->get_elements_type();
+        primitive_t c_type = m_fct.get_buffers().at(assignment.first.get_name())->get_elements_type();
+        if (a_type != b_type || (a_type != p_float16 && a_type != p_bfloat16) ||
+            (c_type != p_float32 && !(c_type == p_float16 && a_type == p_float16)))
+            ERROR("Tensor cores of " + comp->get_name() + " support float16 operands with a float16 or float32 "
+                  "accumulator, and bfloat16 operands with a float32 accumulator.", true);
+
+        // &buffer[index] and the size of the innermost dimension of buffer
+        auto address = [&](const tiramisu::expr &access, primitive_t type) {
+            return statement_ptr{new unary{type, parse_tiramisu(access), "&"}};
+        };
+        auto leading_dimension = [&](const std::string &name) {
+            return parse_tiramisu(get_buffer(name)->sizes_expr().back());
+        };
+
+        auto c_buffer = get_buffer(assignment.first.get_name());
+        auto c_address = statement_ptr{new unary{c_type, statement_ptr{new buffer_access{
+                c_buffer, {parse_tiramisu(assignment.first.get_access()[0])}}}, "&"}};
+
+        return statement_ptr{new function_call{p_none, "tiramisu_wmma_m16n16k16", {
+                c_address, leading_dimension(assignment.first.get_name()),
+                address(a_access, a_type), leading_dimension(a_access.get_name()),
+                address(b_access, b_type), leading_dimension(b_access.get_name())}}};
+    }
+
     void tiramisu::function::gen_cuda_stmt() {
         DEBUG_FCT_NAME(3);
         DEBUG_INDENT(4);
 
+        this->check_gpu_coalescing();
+        this->choose_gpu_shared_layouts();
+
         DEBUG(3, this->gen_c_code());
 
         cuda_ast::generator generator{*this};
@@ -849,7 +1205,11 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
             resulting_file->add_statement(s);
 
 
+        std::map<std::string, long> kernel_threads;
         for (auto &kernel: generator.kernels) {
+            kernel->set_launch_bounds(this->gpu_launch_bounds_min_blocks);
+            if (kernel->get_constant_threads() > 0 && !kernel->is_persistent())
+                kernel_threads[kernel->get_name()] = kernel->get_constant_threads();
             resulting_file->add_statement(cuda_ast::statement_ptr{new cuda_ast::kernel_definition{kernel}});
 
             std::shared_ptr<cuda_ast::block> wrapper_block{new cuda_ast::block};
@@ -868,9 +1228,9 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
 
 
         std::string code = std::static_pointer_cast<cuda_ast::statement>(resulting_file)->print();
-        std::cout << code << std::endl;
+        DEBUG(3, tiramisu::str_dump("Generated CUDA code:\n" + code));
 
-        nvcc_compiler = std::shared_ptr<cuda_ast::compiler>{new cuda_ast::compiler{code}};
+        nvcc_compiler = std::shared_ptr<cuda_ast::compiler>{new cuda_ast::compiler{code, kernel_threads}};
 
         this->iterator_to_kernel_map = generator.iterator_to_kernel_map;
 
@@ -878,6 +1238,248 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         DEBUG_INDENT(-4);
     }
 
+    // Included at the beginning of the OpenCL kernels generated by function::gen_opencl_stmt()
+    static const char *opencl_kernels_prelude = R"(#pragma OPENCL EXTENSION cl_khr_fp16 : enable
+typedef char int8_t;
+typedef uchar uint8_t;
+typedef short int16_t;
+typedef ushort uint16_t;
+typedef int int32_t;
+typedef uint uint32_t;
+typedef long int64_t;
+typedef ulong uint64_t;
+typedef half __half;
+#define lerp(a, b, w) mix(a, b, w)
+
+)";
+
+    std::vector<std::string> tiramisu::function::check_gpu_coalescing() {
+        // The number of accesses of comp to the buffers in global memory whose
+        // stride at level is neither 0 nor 1
+        auto uncoalesced = [this](tiramisu::computation *comp, int level, std::vector<std::string> *names) {
+            int count = 0;
+            for (const auto &access : comp->get_buffer_access_strides(level)) {
+                if (this->get_buffers().at(access.first)->location != cuda_ast::memory_location::global ||
+                    access.second == 0 || access.second == 1)
+                    continue;
+                count++;
+                if (names != nullptr)
+                    names->push_back(access.first + " (stride " +
+                                     (access.second < 0 ? std::string{"unknown"} : std::to_string(access.second)) + ")");
+            }
+            return count;
+        };
+
+        std::vector<std::string> warnings;
+        for (auto &dims : this->gpu_thread_dimensions) {
+            // The thread levels, from x to z
+            std::vector<int *> levels;
+            for (int *level : {&std::get<2>(dims.second), &std::get<1>(dims.second), &std::get<0>(dims.second)})
+                if (*level != -1)
+                    levels.push_back(level);
+            if (levels.empty())
+                continue;
+
+            for (auto *comp : this->get_computation_by_name(dims.first)) {
+                int x_cost = uncoalesced(comp, *levels[0], nullptr);
+                if (x_cost == 0)
+                    continue;
+
+                if (this->gpu_coalescing_remap && levels.size() > 1 && uncoalesced(comp, *levels[1], nullptr) < x_cost) {
+                    std::swap(*levels[0], *levels[1]);
+                    DEBUG(3, tiramisu::str_dump("Thread x and thread y of " + dims.first + " swapped to coalesce its accesses."));
+                    continue;
+                }
+
+                std::vector<std::string> names;
+                uncoalesced(comp, *levels[0], &names);
+                for (const auto &name : names) {
+                    std::string warning = "The GPU threads of " + comp->get_name() + " access the buffer " + name +
+                                          " in global memory without coalescing: the thread x dimension does not"
+                                          " index its contiguous dimension.";
+                    warning += (levels.size() > 1) ? " Swap thread x and thread y (set_gpu_coalescing_remap())"
+                                                     " or stage the accesses through shared memory (cache_shared())." :
+                                                     " Stage the accesses through shared memory (cache_shared()).";
+                    std::cerr << "Warning: " << warning << std::endl;
+                    warnings.push_back(warning);
+                }
+                break;
+            }
+        }
+
+        return warnings;
+    }
+
+    std::vector<std::string> tiramisu::function::place_gpu_buffers(int64_t constant_memory_bytes) {
+        // The buffers written by the computations other than the copies
+        std::unordered_set<std::string> written;
+        for (auto *comp : this->get_computations()) {
+            const tiramisu::expr &e = comp->get_expr();
+            if (e.get_expr_type() == e_none ||
+                (e.get_expr_type() == e_op && (e.get_op_type() == o_memcpy || e.get_op_type() == o_allocate)))
+                continue;
+            isl_map *access = comp->get_access_relation();
+            if (access != nullptr && isl_map_has_tuple_name(access, isl_dim_out) == isl_bool_true)
+                written.insert(isl_map_get_tuple_name(access, isl_dim_out));
+        }
+
+        // The read-only GPU buffers, and whether all their accesses in the kernels are uniform
+        std::map<std::string, bool> uniform;
+        for (const auto &dims : this->gpu_thread_dimensions) {
+            std::vector<int> levels;
+            for (int level : {std::get<0>(dims.second), std::get<1>(dims.second), std::get<2>(dims.second)})
+                if (level != -1)
+                    levels.push_back(level);
+            for (auto *comp : this->get_computation_by_name(dims.first)) {
+                if (!comp->get_expr().is_defined())
+                    continue;
+                for (int level : levels)
+                    for (const auto &access : comp->get_buffer_access_strides(level)) {
+                        tiramisu::buffer *buf = this->get_buffers().at(access.first);
+                        if (written.count(access.first) != 0 ||
+                            (buf->location != cuda_ast::memory_location::global &&
+                             buf->location != cuda_ast::memory_location::constant))
+                            continue;
+                        auto u = uniform.insert({access.first, true}).first;
+                        u->second = u->second && access.second == 0;
+                    }
+            }
+        }
+
+        // The uniform buffers that can be copied to constant memory, by size
+        std::set<std::string> mapped;
+        for (const auto &m : this->mapping)
+            if (m.second->automatic_gpu_copy)
+                mapped.insert(m.second->get_name());
+        std::vector<std::pair<int64_t, tiramisu::buffer *>> candidates;
+        for (const auto &u : uniform) {
+            tiramisu::buffer *buf = this->get_buffers().at(u.first);
+            int64_t bytes = halide_type_from_tiramisu_type(buf->get_elements_type()).bytes();
+            for (const auto &size : buf->get_dim_sizes())
+                bytes = (bytes < 0 || size.get_expr_type() != e_val) ? -1 : bytes * size.get_int_val();
+            if (buf->location == cuda_ast::memory_location::constant)
+                constant_memory_bytes -= std::max<int64_t>(bytes, 0);
+            else if (u.second && bytes >= 0 && mapped.count(u.first) != 0 &&
+                     buf->get_argument_type() == tiramisu::a_temporary && buf->get_auto_allocate())
+                candidates.push_back({bytes, buf});
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const std::pair<int64_t, tiramisu::buffer *> &a, const std::pair<int64_t, tiramisu::buffer *> &b) {
+                      return a.first < b.first;
+                  });
+
+        std::vector<std::string> constant;
+        for (const auto &c : candidates)
+            if (c.first <= constant_memory_bytes) {
+                constant_memory_bytes -= c.first;
+                c.second->tag_gpu_constant();
+                constant.push_back(c.second->get_name());
+            }
+        for (const auto &u : uniform) {
+            tiramisu::buffer *buf = this->get_buffers().at(u.first);
+            if (buf->location == cuda_ast::memory_location::global)
+                buf->tag_gpu_read_only();
+            DEBUG(3, tiramisu::str_dump("The read-only GPU buffer " + u.first + " is placed in " +
+                                        (buf->location == cuda_ast::memory_location::constant ?
+                                         "constant memory." : "the read-only data cache.")));
+        }
+
+        return constant;
+    }
+
+    void tiramisu::function::choose_gpu_shared_layouts() {
+        for (const auto &b : this->get_buffers()) {
+            tiramisu::buffer *buf = b.second;
+            if (buf->location != cuda_ast::memory_location::shared || buf->get_shared_layout() != tiramisu::shared_auto)
+                continue;
+            const tiramisu::expr &row = buf->get_dim_sizes().back();
+            int bytes = halide_type_from_tiramisu_type(buf->get_elements_type()).bytes();
+            if (buf->get_n_dims() < 2 || row.get_expr_type() != e_val) {
+                buf->set_shared_layout(tiramisu::shared_dense);
+                continue;
+            }
+
+            // The threads of a warp are consecutive along the thread x dimension
+            bool column = false;
+            for (const auto &dims : this->gpu_thread_dimensions) {
+                int x = (std::get<2>(dims.second) != -1) ? std::get<2>(dims.second) :
+                        (std::get<1>(dims.second) != -1) ? std::get<1>(dims.second) : std::get<0>(dims.second);
+                for (auto *comp : this->get_computation_by_name(dims.first))
+                    column = column || comp->accesses_column_of(*buf, x);
+            }
+
+            long row_bytes = row.get_int_val() * bytes;
+            if (column && row_bytes % 128 == 0)
+                buf->set_shared_layout(tiramisu::shared_skewed);
+            else if (column && row_bytes % 8 == 0)
+                buf->set_shared_layout(tiramisu::shared_padded);
+            else
+                buf->set_shared_layout(tiramisu::shared_dense);
+            DEBUG(3, tiramisu::str_dump("Layout of the shared buffer " + buf->get_name() + ": " +
+                                        std::to_string(buf->get_shared_layout())));
+        }
+    }
+
+    void tiramisu::function::gen_opencl_stmt() {
+        DEBUG_FCT_NAME(3);
+        DEBUG_INDENT(4);
+
+        for (const auto &b : this->get_buffers())
+            if (b.second->location == cuda_ast::memory_location::constant)
+                ERROR("The buffer " + b.first + " is in constant memory, which is not supported by the OpenCL backend.", true);
+
+        this->check_gpu_coalescing();
+        this->choose_gpu_shared_layouts();
+        cuda_ast::print_dialect = cuda_ast::dialect_t::opencl;
+
+        cuda_ast::generator generator{*this};
+        generator.cuda_stmt_from_isl_node(this->get_isl_ast());
+
+        std::shared_ptr<cuda_ast::block> kernels{new cuda_ast::block};
+        std::shared_ptr<cuda_ast::block> wrappers{new cuda_ast::block};
+        for (auto &kernel : generator.kernels) {
+            if (kernel->is_persistent())
+                ERROR("Persistent kernels are not supported by the OpenCL backend.", true);
+
+            kernels->add_statement(cuda_ast::statement_ptr{new cuda_ast::kernel_definition{kernel}});
+
+            std::shared_ptr<cuda_ast::block> wrapper_block{new cuda_ast::block};
+            wrapper_block->add_statement(cuda_ast::statement_ptr{new cuda_ast::kernel_call{kernel}});
+            wrapper_block->add_statement(cuda_ast::statement_ptr{
+                    new cuda_ast::return_statement{
+                            cuda_ast::statement_ptr{new cuda_ast::value(value_cast(cuda_ast::kernel::wrapper_return_type, 0))}
+                    }
+            });
+            wrappers->add_statement(
+                    cuda_ast::statement_ptr{new cuda_ast::host_function{cuda_ast::kernel::wrapper_return_type,
+                                                                        kernel->get_wrapper_name(), kernel->get_arguments(),
+                                                                        std::static_pointer_cast<cuda_ast::statement>(wrapper_block)}}
+            );
+        }
+
+        std::string kernels_code = std::static_pointer_cast<cuda_ast::statement>(kernels)->print();
+        std::string wrappers_code = std::static_pointer_cast<cuda_ast::statement>(wrappers)->print();
+        cuda_ast::print_dialect = cuda_ast::dialect_t::cuda;
+
+        for (const std::string unsupported : {"__pipeline_", "tiramisu_wmma_m16n16k16", "tiramisu_reduction::",
+                                              "float2", "double2", "__nv_bfloat16"})
+            if (kernels_code.find(unsupported) != std::string::npos)
+                ERROR("The kernels use " + unsupported + ", which is not supported by the OpenCL backend.", true);
+
+        DEBUG(3, tiramisu::str_dump("Generated OpenCL code:\n" + kernels_code));
+
+        this->opencl_code = std::string("#include <stddef.h>\n#include <stdint.h>\n\n") +
+                "extern \"C\" int32_t tiramisu_opencl_launch(const char *source, const char *kernel, const size_t *blocks,\n"
+                "                                          const size_t *threads, int32_t nb_arguments, void **arguments,\n"
+                "                                          const size_t *sizes, const int32_t *is_buffer);\n\n" +
+                "static const char *_opencl_kernels_source = R\"tiramisu(" + opencl_kernels_prelude + kernels_code +
+                ")tiramisu\";\n\n" + wrappers_code;
+
+        this->iterator_to_kernel_map = generator.iterator_to_kernel_map;
+
+        DEBUG_INDENT(-4);
+    }
+
     cuda_ast::generator::generator(tiramisu::function &fct) : m_fct(fct) {
         for (const tiramisu::constant &invariant : fct.get_invariants()) {
             m_scalar_data.insert(std::make_pair(invariant.get_name(),
@@ -954,10 +1556,11 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
     }
 
     cuda_ast::buffer_access::buffer_access(cuda_ast::buffer_ptr accessed,
-                                           const std::vector<cuda_ast::statement_ptr> &access) : statement(
-            accessed->get_type()),
-                                                                                                 accessed(accessed),
-                                                                                                 access(access) {}
+                                           const std::vector<cuda_ast::statement_ptr> &access,
+                                           bool read_only_cache) : statement(accessed->get_type()),
+                                                                   accessed(accessed),
+                                                                   access(access),
+                                                                   read_only_cache(read_only_cache) {}
 
     cuda_ast::op::op(primitive_t type, const std::vector<statement_ptr> &operands) : statement(type),
                                                                                      m_operands(operands) {}
@@ -1114,7 +1717,13 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         ss << ")";
     }
 
+    void cuda_ast::for_loop::set_pragma(const std::string &pragma) {
+        this->pragma = pragma;
+    }
+
     void cuda_ast::for_loop::print(std::stringstream &ss, const std::string &base) {
+        if (!pragma.empty())
+            ss << pragma << "\n" << base;
         ss << "for (";
         initial_value->print(ss, base);
         ss << "; ";
@@ -1137,6 +1746,9 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
     }
 
     void cuda_ast::buffer_access::print(std::stringstream &ss, const std::string &base) {
+        bool ldg = read_only_cache && print_dialect == dialect_t::cuda;
+        if (ldg)
+            ss << "__ldg(&";
         ss << accessed->get_name();
         if (accessed->get_location() != memory_location::reg) {
             ss << "[";
@@ -1150,6 +1762,8 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
             }
             ss << "]";
         }
+        if (ldg)
+            ss << ")";
     }
 
     void cuda_ast::unary::print(std::stringstream &ss, const std::string &base) {
@@ -1187,10 +1801,10 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         } else {
             switch (id->get_location()) {
                 case cuda_ast::memory_location::shared:
-                    ss << "__shared__ ";
+                    ss << (print_dialect == dialect_t::opencl ? "__local " : "__shared__ ");
                     break;
                 case cuda_ast::memory_location::constant:
-                    ss << "__constant__ ";
+                    ss << (print_dialect == dialect_t::opencl ? "__constant " : "__constant__ ");
                     break;
                 default:
                     break;
@@ -1207,9 +1821,14 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
     }
 
     void cuda_ast::buffer::print_declaration(std::stringstream &ss, const std::string &base) {
+        print_declaration(ss, base, "");
+    }
+
+    void cuda_ast::buffer::print_declaration(std::stringstream &ss, const std::string &base,
+                                             const std::string &pointer_qualifier) {
         ss << tiramisu_type_to_cuda_type(get_type()) << " ";
         if (this->get_location() == memory_location::global || this->get_location() == memory_location::host) {
-            ss << "*" << get_name();
+            ss << "*" << (pointer_qualifier.empty() ? "" : pointer_qualifier + " ") << get_name();
         } else if (this->get_location() == memory_location::reg) {
             ss << get_name();
         } else {
@@ -1235,10 +1854,14 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         print(ss, base);
     }
 
-    cuda_ast::sync::sync() : statement(p_none) {}
+    cuda_ast::sync::sync(int in_flight_copy_stages) : statement(p_none), in_flight_copy_stages(in_flight_copy_stages) {}
 
     void cuda_ast::sync::print(std::stringstream &ss, const std::string &base) {
-        ss << "__syncthreads()";
+        if (in_flight_copy_stages >= 0) {
+            ss << "__pipeline_commit();\n" << base;
+            ss << "__pipeline_wait_prior(" << in_flight_copy_stages << ");\n" << base;
+        }
+        ss << (print_dialect == dialect_t::opencl ? "barrier(CLK_LOCAL_MEM_FENCE)" : "__syncthreads()");
     }
 
     cuda_ast::kernel::dim3d_t::dim3d_t() {
@@ -1263,7 +1886,15 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
     }
 
 
-    cuda_ast::kernel::kernel() : kernel_number(kernel_count++) {}
+    cuda_ast::kernel::kernel() : kernel_number(kernel_count++), stream(0) {}
+
+    void cuda_ast::kernel::set_stream(int stream) {
+        this->stream = stream;
+    }
+
+    int cuda_ast::kernel::get_stream() const {
+        return stream;
+    }
 
     void cuda_ast::kernel::set_dimension(gpu_iterator dimension){
         if (dimension.type == gpu_iterator::type_t::BLOCK)
@@ -1284,10 +1915,192 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         return this->get_name() + "_wrapper";
     }
 
+    void cuda_ast::kernel::add_persistent_part(kernel_ptr part, const std::unordered_set<std::string> &local_scalars) {
+        // The blocks of the parts are distributed over the blocks of the
+        // persistent kernel, but their threads are the threads of its blocks
+        if (parts.empty()) {
+            thread_dimensions = part->thread_dimensions;
+            stream = part->stream;
+        } else {
+            for (auto dims : {std::make_pair(thread_dimensions.x, part->thread_dimensions.x),
+                              std::make_pair(thread_dimensions.y, part->thread_dimensions.y),
+                              std::make_pair(thread_dimensions.z, part->thread_dimensions.z)})
+                if (dims.first->print() != dims.second->print())
+                    ERROR("The kernels of a persistent loop must have the same thread block dimensions.", true);
+        }
+        for (auto &dim : {part->block_dimensions.x, part->block_dimensions.y, part->block_dimensions.z})
+            for (auto &scalar : dim->extract_scalars())
+                if (local_scalars.count(scalar) != 0)
+                    ERROR("The number of blocks of a kernel of a persistent loop cannot depend on the iterator " +
+                          scalar + " of the loop.", true);
+
+        parts.push_back(part);
+        for (auto &c : part->used_constants)
+            if (local_scalars.count(c.first) == 0)
+                used_constants[c.first] = c.second;
+        for (auto &b : part->used_buffers)
+            used_buffers[b.first] = b.second;
+    }
+
+    bool cuda_ast::kernel::is_persistent() const {
+        return !parts.empty();
+    }
+
+    void cuda_ast::kernel::set_launch_bounds(int min_blocks) {
+        min_blocks_per_multiprocessor = min_blocks;
+    }
+
+    namespace {
+        // The value of an integer expression printed by the nodes (e.g. "(15 + 1)"),
+        // -1 if it is not a constant
+        long constant_value(const std::string &printed) {
+            std::string e = std::regex_replace(printed, std::regex("\\(u?int(8|16|32|64)_t\\)|\\s"), "");
+            size_t pos = 0;
+            std::function<long(int)> parse = [&](int precedence) -> long {
+                long value;
+                if (pos < e.size() && e[pos] == '(') {
+                    pos++;
+                    value = parse(0);
+                    if (value < 0 || pos >= e.size() || e[pos++] != ')')
+                        return -1;
+                } else if (pos < e.size() && std::isdigit(e[pos])) {
+                    value = 0;
+                    while (pos < e.size() && std::isdigit(e[pos]))
+                        value = value * 10 + (e[pos++] - '0');
+                } else {
+                    return -1;
+                }
+                while (pos < e.size() && value >= 0) {
+                    char op = e[pos];
+                    int op_precedence = (op == '+' || op == '-') ? 1 : (op == '*' || op == '/') ? 2 : 0;
+                    if (op_precedence == 0 || op_precedence <= precedence)
+                        break;
+                    pos++;
+                    long rhs = parse(op_precedence);
+                    if (rhs < 0 || (op == '/' && rhs == 0))
+                        return -1;
+                    value = (op == '+') ? value + rhs : (op == '-') ? value - rhs : (op == '*') ? value * rhs : value / rhs;
+                }
+                return value;
+            };
+            long value = parse(0);
+            return (pos == e.size()) ? value : -1;
+        }
+    }
+
+    long cuda_ast::kernel::get_constant_threads() const {
+        long threads = 1;
+        for (auto &dim : {thread_dimensions.x, thread_dimensions.y, thread_dimensions.z}) {
+            std::stringstream ss;
+            dim->print(ss, "");
+            long size = constant_value(ss.str());
+            if (size <= 0)
+                return -1;
+            threads *= size;
+        }
+        return threads;
+    }
+
+    cuda_ast::persistent_part::persistent_part(kernel_ptr kernel) : statement(p_none), kernel(kernel){}
+
+    void cuda_ast::persistent_part::print(std::stringstream &ss, const std::string &base) {
+        std::stringstream x, y;
+        ss << "for (int _persistent_block_index = blockIdx.x; _persistent_block_index < ";
+        kernel->block_dimensions.x->print(x, base);
+        kernel->block_dimensions.y->print(y, base);
+        ss << "(" << x.str() << ") * (" << y.str() << ") * (";
+        kernel->block_dimensions.z->print(ss, base);
+        ss << "); _persistent_block_index += gridDim.x)\n";
+        ss << base << "{\n";
+        ss << base << "\tconst uint3 _persistent_block = make_uint3(_persistent_block_index % (" << x.str() << "), "
+           << "_persistent_block_index / (" << x.str() << ") % (" << y.str() << "), "
+           << "_persistent_block_index / ((" << x.str() << ") * (" << y.str() << ")));\n";
+        ss << base << "\t";
+        kernel->body->print(ss, base + "\t");
+        ss << ";\n" << base << "}\n";
+        ss << base << "cooperative_groups::this_grid().sync()";
+    }
+
     cuda_ast::kernel_call::kernel_call(kernel_ptr kernel) : statement(p_none), kernel(kernel){}
     void cuda_ast::kernel_call::print(std::stringstream &ss, const std::string &base) {
         ss << "{\n";
         auto new_base = base + "\t";
+        if (print_dialect == dialect_t::opencl) {
+            // The work-groups, and the work-items of each work-group
+            auto arguments = kernel->get_arguments();
+            ss << new_base << "const size_t blocks[3] = {(size_t) (";
+            kernel->block_dimensions.x->print(ss, base);
+            ss << "), (size_t) (";
+            kernel->block_dimensions.y->print(ss, base);
+            ss << "), (size_t) (";
+            kernel->block_dimensions.z->print(ss, base);
+            ss << ")};\n";
+            ss << new_base << "const size_t threads[3] = {(size_t) (";
+            kernel->thread_dimensions.x->print(ss, base);
+            ss << "), (size_t) (";
+            kernel->thread_dimensions.y->print(ss, base);
+            ss << "), (size_t) (";
+            kernel->thread_dimensions.z->print(ss, base);
+            ss << ")};\n";
+            std::stringstream values, sizes, is_buffer;
+            for (auto it = arguments.begin(); it != arguments.end(); ++it) {
+                std::string separator = (it == arguments.begin()) ? "" : ", ";
+                values << separator << ((*it)->is_buffer() ? "(void *) " : "(void *) &") << (*it)->get_name();
+                sizes << separator << "sizeof(" << (*it)->get_name() << ")";
+                is_buffer << separator << ((*it)->is_buffer() ? 1 : 0);
+            }
+            if (arguments.empty()) {
+                values << "nullptr";
+                sizes << "0";
+                is_buffer << "0";
+            }
+            ss << new_base << "void *arguments[] = {" << values.str() << "};\n";
+            ss << new_base << "const size_t sizes[] = {" << sizes.str() << "};\n";
+            ss << new_base << "const int32_t is_buffer[] = {" << is_buffer.str() << "};\n";
+            ss << new_base << "tiramisu_opencl_launch(_opencl_kernels_source, \"" << kernel->get_name()
+               << "\", blocks, threads, " << arguments.size() << ", arguments, sizes, is_buffer);\n";
+            ss << base << "}";
+            return;
+        }
+        if (kernel->is_persistent()) {
+            // As many blocks as can be resident at the same time, at most the
+            // number of blocks of the largest part
+            ss << new_base << "dim3 threads(";
+            kernel->thread_dimensions.x->print(ss, base);
+            ss << ", ";
+            kernel->thread_dimensions.y->print(ss, base);
+            ss << ", ";
+            kernel->thread_dimensions.z->print(ss, base);
+            ss << ");\n";
+            ss << new_base << "int64_t parts_blocks = 1;\n";
+            for (auto &part : kernel->parts) {
+                ss << new_base << "parts_blocks = std::max<int64_t>(parts_blocks, (int64_t) (";
+                part->block_dimensions.x->print(ss, base);
+                ss << ") * (";
+                part->block_dimensions.y->print(ss, base);
+                ss << ") * (";
+                part->block_dimensions.z->print(ss, base);
+                ss << "));\n";
+            }
+            ss << new_base << "dim3 blocks(tiramisu_cuda_persistent_blocks((const void *) " << kernel->get_name()
+               << ", threads.x * threads.y * threads.z, parts_blocks));\n";
+            ss << new_base << "void *arguments[] = {";
+            auto arguments = kernel->get_arguments();
+            if (arguments.empty())
+                ss << "nullptr";
+            for (auto it = arguments.begin(); it != arguments.end();) {
+                ss << "(void *) &";
+                (*it)->print(ss, base);
+                if (++it != arguments.end()) {
+                    ss << ", ";
+                }
+            }
+            ss << "};\n";
+            ss << new_base << "cudaLaunchCooperativeKernel((const void *) " << kernel->get_name()
+               << ", blocks, threads, arguments, 0, tiramisu_cuda_get_stream(" << kernel->stream << "));\n";
+            ss << base << "}";
+            return;
+        }
         ss << new_base << "dim3 blocks(";
         kernel->block_dimensions.x->print(ss, base);
         ss << ", ";
@@ -1302,7 +2115,10 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         ss << ", ";
         kernel->thread_dimensions.z->print(ss, base);
         ss << ");\n";
-        ss << new_base << kernel->get_name() << "<<<blocks, threads>>>(";
+        // Stream 0 is the default stream of the thread, unless the launch is
+        // captured in a CUDA graph
+        ss << new_base << kernel->get_name() << "<<<blocks, threads, 0, tiramisu_cuda_get_stream("
+           << kernel->stream << ")>>>(";
         std::vector<abstract_identifier_ptr> arguments;
         for (auto &c: kernel->used_constants)
             arguments.push_back(c.second);
@@ -1317,7 +2133,9 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         ss << ");\n" << base << "}";
     }
 
-    int cuda_ast::kernel::kernel_count = 0;
+    std::atomic<int> cuda_ast::kernel::kernel_count{0};
+
+    cuda_ast::dialect_t cuda_ast::print_dialect = cuda_ast::dialect_t::cuda;
 
     cuda_ast::kernel_definition::kernel_definition(kernel_ptr kernel) : statement(p_none), kernel(kernel){}
 
@@ -1333,9 +2151,16 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
 
 
     void cuda_ast::kernel_definition::print(std::stringstream &ss, const std::string &base) {
-        ss << "static __global__ void " << kernel->get_name() << "(";
+        bool opencl = (print_dialect == dialect_t::opencl);
+        ss << (opencl ? "__kernel void " : "static __global__ void ");
+        long threads = kernel->get_constant_threads();
+        if (!opencl && kernel->min_blocks_per_multiprocessor > 0 && threads > 0 && !kernel->is_persistent())
+            ss << "__launch_bounds__(" << threads << ", " << kernel->min_blocks_per_multiprocessor << ") ";
+        ss << kernel->get_name() << "(";
         auto arguments = kernel->get_arguments();
         for (auto it = arguments.begin(); it != arguments.end();) {
+            if (opencl && (*it)->is_buffer())
+                ss << "__global ";
             (*it)->print_declaration(ss, base);
             if (++it != arguments.end()) {
                 ss << ", ";
@@ -1346,16 +2171,25 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
     }
 
 
-    cuda_ast::gpu_iterator_read::gpu_iterator_read(gpu_iterator it) : statement(global::get_loop_iterator_data_type()), it(it), simplified(true){}
-    cuda_ast::gpu_iterator_read::gpu_iterator_read(gpu_iterator it, bool simplified) : statement(global::get_loop_iterator_data_type()), it(it), simplified(simplified){}
+    cuda_ast::gpu_iterator_read::gpu_iterator_read(gpu_iterator it) : statement(global::get_loop_iterator_data_type()), it(it), simplified(true), lanes(1){}
+    cuda_ast::gpu_iterator_read::gpu_iterator_read(gpu_iterator it, bool simplified, int lanes) : statement(global::get_loop_iterator_data_type()), it(it), simplified(simplified), lanes(lanes){}
 
     void cuda_ast::gpu_iterator_read::print(std::stringstream &ss, const std::string &base) {
         if (simplified) {
             ss << it.simplified_name();
         } else {
+            if (lanes > 1)
+                ss << "(";
+            if (print_dialect == dialect_t::opencl) {
+                ss << ((it.type == gpu_iterator::type_t::BLOCK) ? "get_group_id(" : "get_local_id(")
+                   << static_cast<int>(it.dimension) << ")";
+                if (lanes > 1)
+                    ss << " / " << lanes << ")";
+                return;
+            }
             switch (it.type) {
                 case gpu_iterator::type_t::BLOCK:
-                    ss << "blockIdx";
+                    ss << (it.persistent ? "_persistent_block" : "blockIdx");
                     break;
                 case gpu_iterator::type_t::THREAD:
                     ss << "threadIdx";
@@ -1373,6 +2207,8 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
                     ss << 'z';
                     break;
             }
+            if (lanes > 1)
+                ss << " / " << lanes << ")";
         }
     }
 
@@ -1391,13 +2227,26 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
     cuda_ast::host_function::host_function(primitive_t type, std::string name, const std::vector<abstract_identifier_ptr> &arguments, statement_ptr body) :
             statement(type), name(name), body(body), arguments(arguments){}
 
+    void cuda_ast::host_function::set_linkage(const std::string &linkage) {
+        this->linkage = linkage;
+    }
+
+    void cuda_ast::host_function::set_pointer_qualifier(const std::string &qualifier) {
+        this->pointer_qualifier = qualifier;
+    }
+
     void cuda_ast::host_function::print(std::stringstream &ss, const std::string &base) {
-        ss << "extern \"C\" " << tiramisu_type_to_cuda_type(this->get_type());
+        if (!linkage.empty())
+            ss << linkage << " ";
+        ss << tiramisu_type_to_cuda_type(this->get_type());
         if (pointer_return)
             ss << "*";
         ss << " " << name << "(";
         for (int i = 0; i < arguments.size();) {
-            arguments[i]->print_declaration(ss, base);
+            if (arguments[i]->is_buffer())
+                std::static_pointer_cast<cuda_ast::buffer>(arguments[i])->print_declaration(ss, base, pointer_qualifier);
+            else
+                arguments[i]->print_declaration(ss, base);
             if (++i < arguments.size()) {
                 ss << ", ";
             }
@@ -1420,13 +2269,14 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         ss << ")";
     }
 
-    cuda_ast::allocate::allocate(buffer_ptr b) : statement(p_none), b(b){}
+    cuda_ast::allocate::allocate(buffer_ptr b, bool aligned) : statement(p_none), b(b), aligned(aligned){}
     cuda_ast::free::free(buffer_ptr b) : statement(p_none), b(b){}
 
     void cuda_ast::allocate::print(std::stringstream &ss, const std::string &base) {
         switch(b->get_location()) {
             case memory_location::host:
-                ss << b->get_name() << " = (" << tiramisu_type_to_cuda_type(b->get_type()) << "*)malloc(";
+                ss << b->get_name() << " = (" << tiramisu_type_to_cuda_type(b->get_type()) << "*)"
+                   << (aligned ? "tiramisu_aligned_alloc(" : "malloc(");
                 break;
             case memory_location::global:
                 ss << "cudaMalloc(&" << b->get_name() << ", ";
@@ -1584,7 +2434,7 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         std::vector<cuda_ast::statement_ptr> new_access;
         for (auto &a: access)
             new_access.push_back(a->replace_iterators(iterators));
-        return statement_ptr{new buffer_access{accessed, new_access}};
+        return statement_ptr{new buffer_access{accessed, new_access, read_only_cache}};
     }
 
     std::unordered_set<std::string> cuda_ast::buffer_access::extract_scalars() {
@@ -1655,6 +2505,9 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
                 }
                 if (!defined_inside)
                     this->current_kernel->add_used_scalar(used_scalar);
+            } else if (this->in_persistent && persistent_local_scalars().count(name) == 0) {
+                // The bounds of the loops of the persistent kernel
+                this->persistent_kernel->add_used_scalar(used_scalar);
             }
             return used_scalar;
         } else {
@@ -1700,7 +2553,106 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
 
     }
 
-    cuda_ast::compiler::compiler(const std::string &code) : code(code){}
+    cuda_ast::compiler::compiler(const std::string &code, const std::map<std::string, long> &kernel_threads)
+            : code(code), kernel_threads(kernel_threads) {}
+
+    const std::vector<cuda_ast::kernel_resources> &cuda_ast::compiler::get_kernel_resources() const {
+        return resources;
+    }
+
+    std::string cuda_ast::compiler::get_ptxas_output(const std::string &obj_name) {
+        return obj_name + "_ptxas.txt";
+    }
+
+    namespace {
+        // The limits of a multiprocessor of the architecture sm_<arch> used to compute
+        // the occupancy: warps, blocks, registers and bytes of shared memory
+        struct multiprocessor_limits {
+            int warps, blocks, registers, shared_bytes;
+        };
+
+        multiprocessor_limits get_multiprocessor_limits(int arch) {
+            if (arch >= 90)
+                return {64, 32, 65536, 227 * 1024};
+            if (arch == 86 || arch == 87 || arch == 89)
+                return {48, 16, 65536, 99 * 1024};
+            if (arch >= 80)
+                return {64, 32, 65536, 163 * 1024};
+            if (arch == 75)
+                return {32, 16, 65536, 64 * 1024};
+            return {64, 32, 65536, 96 * 1024};
+        }
+
+        float get_occupancy(const cuda_ast::kernel_resources &r) {
+            int arch = 70;
+            if (getenv("TIRAMISU_CUDA_ARCH"))
+                std::sscanf(getenv("TIRAMISU_CUDA_ARCH"), "sm_%d", &arch);
+            multiprocessor_limits limits = get_multiprocessor_limits(arch);
+
+            long warps_per_block = (r.threads + 31) / 32;
+            if (r.threads <= 0 || warps_per_block > limits.warps)
+                return -1;
+            long blocks = std::min<long>(limits.blocks, limits.warps / warps_per_block);
+            // The registers are allocated by warp, by chunks of 256
+            long registers_per_warp = (r.registers * 32 + 255) / 256 * 256;
+            if (registers_per_warp > 0)
+                blocks = std::min<long>(blocks, limits.registers / (registers_per_warp * warps_per_block));
+            if (r.shared_bytes > 0)
+                blocks = std::min<long>(blocks, limits.shared_bytes / r.shared_bytes);
+            return (float) (blocks * warps_per_block) / limits.warps;
+        }
+    }
+
+    void cuda_ast::compiler::parse_resources(const std::string &ptxas_output) const {
+        resources.clear();
+        std::regex kernel_name("_kernel_[0-9]+");
+        std::stringstream lines(ptxas_output);
+        std::string line;
+        kernel_resources *current = nullptr;
+        while (std::getline(lines, line)) {
+            std::smatch name;
+            if ((line.find("Compiling entry function") != std::string::npos ||
+                 line.find("Function properties for") != std::string::npos) &&
+                std::regex_search(line, name, kernel_name)) {
+                current = nullptr;
+                for (auto &r : resources)
+                    if (r.name == name.str())
+                        current = &r;
+                if (current == nullptr) {
+                    resources.emplace_back();
+                    current = &resources.back();
+                    current->name = name.str();
+                }
+                continue;
+            }
+            if (current == nullptr)
+                continue;
+            std::smatch m;
+            if (std::regex_search(line, m, std::regex("([0-9]+) bytes stack frame, ([0-9]+) bytes spill stores, ([0-9]+) bytes spill loads"))) {
+                current->stack_bytes = std::stoi(m[1]);
+                current->spill_store_bytes = std::stoi(m[2]);
+                current->spill_load_bytes = std::stoi(m[3]);
+            }
+            if (std::regex_search(line, m, std::regex("Used ([0-9]+) registers")))
+                current->registers = std::stoi(m[1]);
+            if (std::regex_search(line, m, std::regex("([0-9]+) bytes smem")))
+                current->shared_bytes = std::stoi(m[1]);
+        }
+
+        for (auto &r : resources) {
+            auto threads = kernel_threads.find(r.name);
+            if (threads != kernel_threads.end())
+                r.threads = threads->second;
+            r.occupancy = get_occupancy(r);
+            DEBUG(3, tiramisu::str_dump("Kernel " + r.name + ": " + std::to_string(r.registers) + " registers, " +
+                                        std::to_string(r.shared_bytes) + " bytes of shared memory, " +
+                                        std::to_string(r.spill_store_bytes) + " bytes of spill stores, occupancy " +
+                                        std::to_string(r.occupancy)));
+            if (r.spill_store_bytes > 0 || r.spill_load_bytes > 0)
+                std::cerr << "The GPU kernel " << r.name << " spills registers (" << r.spill_store_bytes
+                          << " bytes of spill stores, " << r.spill_load_bytes << " bytes of spill loads)." << std::endl;
+        }
+    }
 
     std::string cuda_ast::compiler::get_cpu_obj(const std::string &obj_name) const {
         return obj_name + "_cpu.o";
@@ -1734,15 +2686,113 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         return exec_result{true, pclose(file), out.str(), err.str()};
     }
 
+    std::string cuda_ast::compiler::nvcc_flags() {
+        std::stringstream flags;
+        // Basic streaming for parallelization
+        flags << " --default-stream per-thread";
+        // Position independent code, so that the objects can be linked in
+        // shared libraries (e.g. by auto_scheduler::evaluate_by_cuda)
+        flags << " -Xcompiler -fPIC";
+        // Target architecture, e.g. sm_80 (tensor cores need at least sm_70)
+        if (getenv("TIRAMISU_CUDA_ARCH"))
+            flags << " -arch=" << getenv("TIRAMISU_CUDA_ARCH");
+        return flags.str();
+    }
+
+    std::string cuda_ast::compiler::cache_directory() {
+        if (getenv("TIRAMISU_CUDA_NO_CACHE"))
+            return "";
+        if (getenv("TIRAMISU_CUDA_CACHE_DIR"))
+            return getenv("TIRAMISU_CUDA_CACHE_DIR");
+        if (getenv("XDG_CACHE_HOME"))
+            return std::string(getenv("XDG_CACHE_HOME")) + "/tiramisu/cuda";
+        if (getenv("HOME"))
+            return std::string(getenv("HOME")) + "/.cache/tiramisu/cuda";
+        return "";
+    }
+
+    std::string cuda_ast::compiler::cache_key(const std::string &filename) {
+        std::ifstream file(filename, std::ios::binary);
+        if (file.fail())
+            return "";
+        std::stringstream contents;
+        contents << file.rdbuf() << NVCC_PATH << nvcc_flags();
+
+        // 64-bit FNV-1a, which is stable across runs and builds
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : contents.str()) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        std::stringstream key;
+        key << std::hex << hash;
+        return key.str();
+    }
+
+    namespace {
+        bool copy_file(const std::string &from, const std::string &to) {
+            std::ifstream in(from, std::ios::binary);
+            if (in.fail())
+                return false;
+            // Write to a temporary file first so that concurrent builds never
+            // see a partial object
+            std::string tmp = to + ".tmp" + std::to_string(getpid());
+            {
+                std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+                out << in.rdbuf();
+                if (out.fail())
+                    return false;
+            }
+            return std::rename(tmp.c_str(), to.c_str()) == 0;
+        }
+
+        void make_directories(const std::string &path) {
+            for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+                mkdir(path.substr(0, pos).c_str(), 0755);
+                if (pos == std::string::npos)
+                    break;
+            }
+        }
+    }
+
+    bool cuda_ast::compiler::fetch_from_cache(const std::string &key, const std::string &obj_name) const {
+        std::string dir = cache_directory();
+        if (key.empty() || dir.empty())
+            return false;
+        std::string prefix = dir + "/" + key;
+        if (!copy_file(prefix + "_cpu.o", get_cpu_obj(obj_name))
+                || !copy_file(prefix + "_gpu.o", get_gpu_obj(obj_name)))
+            return false;
+        // The resources of the kernels are reported as when they were compiled
+        if (copy_file(prefix + "_ptxas.txt", get_ptxas_output(obj_name))) {
+            std::ifstream ptxas_output(get_ptxas_output(obj_name));
+            std::stringstream contents;
+            contents << ptxas_output.rdbuf();
+            parse_resources(contents.str());
+        }
+        DEBUG(3, tiramisu::str_dump("Reused the CUDA objects cached in " + prefix));
+        return true;
+    }
+
+    void cuda_ast::compiler::store_in_cache(const std::string &key, const std::string &obj_name) const {
+        std::string dir = cache_directory();
+        if (key.empty() || dir.empty())
+            return;
+        make_directories(dir);
+        std::string prefix = dir + "/" + key;
+        // The CPU object is looked up first when fetching, so store it last
+        copy_file(get_ptxas_output(obj_name), prefix + "_ptxas.txt");
+        copy_file(get_gpu_obj(obj_name), prefix + "_gpu.o");
+        copy_file(get_cpu_obj(obj_name), prefix + "_cpu.o");
+    }
+
     bool cuda_ast::compiler::compile_cpu_obj(const std::string &filename, const std::string &obj_name) const {
         using namespace std;
         DEBUG_FCT_NAME(3);
         DEBUG_INDENT(4);
 
         stringstream command;
-        command << NVCC_PATH;
-        // Basic streaming for parallelization
-        command << " --default-stream per-thread";
+        command << NVCC_PATH << nvcc_flags();
         // Say that this is actually cuda code
         command << " -x cu";
         // Create a .o file
@@ -1753,15 +2803,22 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         command << " " << filename;
         // Specify output name
         command << " -o " << get_cpu_obj(obj_name);
+        // Report the resources of the kernels (see parse_resources())
+        command << " -Xptxas -v 2>&1";
 
         DEBUG(3, cout << "The command to compile the CPU object is : " << command.str());
 
         auto result = exec(command.str());
 
         if (result.fail()) {
+            std::cerr << result.std_out;
             ERROR("Failed to compile the CPU object for the GPU code.", true);
         }
 
+        std::ofstream ptxas_output(get_ptxas_output(obj_name), std::ios::trunc);
+        ptxas_output << result.std_out;
+        parse_resources(result.std_out);
+
         DEBUG_INDENT(-4);
 
         return result.succeed();
@@ -1773,9 +2830,7 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         DEBUG_INDENT(4);
 
         stringstream command;
-        command << NVCC_PATH;
-        // Basic streaming for parallelization
-        command << " --default-stream per-thread";
+        command << NVCC_PATH << nvcc_flags();
         // Link device object code
         command << " -dlink";
         // Specify input file name
@@ -1796,13 +2851,108 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
         return result.succeed();
     }
 
+    // Matrix multiply-accumulate of a 16x16x16 tile by a warp (see computation::tag_gpu_tensor_core())
+    // The arithmetic on complex numbers, stored in float2 and double2 (see make_complex())
+    static const char *complex_helpers = R"(#define TIRAMISU_COMPLEX_OPERATORS(T, R) \
+static __host__ __device__ __forceinline__ T tiramisu_complex(R re, R im) { T c; c.x = re; c.y = im; return c; } \
+static __host__ __device__ __forceinline__ R tiramisu_real(T a) { return a.x; } \
+static __host__ __device__ __forceinline__ R tiramisu_imag(T a) { return a.y; } \
+static __host__ __device__ __forceinline__ T tiramisu_conj(T a) { return tiramisu_complex(a.x, -a.y); } \
+static __host__ __device__ __forceinline__ T operator-(T a) { return tiramisu_complex(-a.x, -a.y); } \
+static __host__ __device__ __forceinline__ T operator+(T a, T b) { return tiramisu_complex(a.x + b.x, a.y + b.y); } \
+static __host__ __device__ __forceinline__ T operator-(T a, T b) { return tiramisu_complex(a.x - b.x, a.y - b.y); } \
+static __host__ __device__ __forceinline__ T operator*(T a, T b) \
+{ return tiramisu_complex(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x); } \
+static __host__ __device__ __forceinline__ T operator/(T a, T b) \
+{ R n = b.x * b.x + b.y * b.y; return tiramisu_complex((a.x * b.x + a.y * b.y) / n, (a.y * b.x - a.x * b.y) / n); }
+TIRAMISU_COMPLEX_OPERATORS(float2, float)
+TIRAMISU_COMPLEX_OPERATORS(double2, double)
+)";
+
+    // The linear interpolation of o_lerp (see bilinear())
+    static const char *lerp_helpers = R"(static __host__ __device__ __forceinline__ float lerp(float a, float b, float w) { return fmaf(w, b - a, a); }
+static __host__ __device__ __forceinline__ double lerp(double a, double b, double w) { return fma(w, b - a, a); }
+)";
+
+    // The reductions over GPU blocks or threads (see computation::parallelize_reduction()):
+    // the accumulator is updated with atomicAdd() when the hardware supports it, with
+    // atomicCAS() otherwise, and the terms of a warp are combined with shuffles first
+    static const char *reduction_helpers = R"(#include <cooperative_groups.h>
+#include <cooperative_groups/reduce.h>
+#include <type_traits>
+namespace tiramisu_reduction
+{
+template <typename T> struct add { __device__ __forceinline__ T operator()(T a, T b) const { return a + b; } };
+template <typename T> struct mul { __device__ __forceinline__ T operator()(T a, T b) const { return a * b; } };
+template <typename T> struct min { __device__ __forceinline__ T operator()(T a, T b) const { return (b < a) ? b : a; } };
+template <typename T> struct max { __device__ __forceinline__ T operator()(T a, T b) const { return (a < b) ? b : a; } };
+template <typename T, typename Op> struct atomic
+{
+    static __device__ __forceinline__ void update(T *acc, T v)
+    {
+        using U = typename std::conditional<sizeof(T) == 4, unsigned int, unsigned long long>::type;
+        U *address = reinterpret_cast<U *>(acc);
+        U old = *address, assumed;
+        do {
+            assumed = old;
+            T updated = Op()(*reinterpret_cast<T *>(&assumed), v);
+            old = atomicCAS(address, assumed, *reinterpret_cast<U *>(&updated));
+        } while (assumed != old);
+    }
+};
+#define TIRAMISU_ATOMIC_ADD(T) template <> struct atomic<T, add<T>> \
+{ static __device__ __forceinline__ void update(T *acc, T v) { atomicAdd(acc, v); } };
+TIRAMISU_ATOMIC_ADD(float)
+TIRAMISU_ATOMIC_ADD(int32_t)
+TIRAMISU_ATOMIC_ADD(uint32_t)
+#if !defined(__CUDA_ARCH__) || __CUDA_ARCH__ >= 600
+TIRAMISU_ATOMIC_ADD(double)
+#endif
+template <typename T, typename Op> static __device__ __forceinline__ void warp_update(T *acc, T v)
+{
+    cooperative_groups::coalesced_group active = cooperative_groups::coalesced_threads();
+    T partial = cooperative_groups::reduce(active, v, Op());
+    if (active.thread_rank() == 0)
+        atomic<T, Op>::update(acc, partial);
+}
+}
+)";
+
+    static const char *tensor_core_helpers = R"(#include <mma.h>
+template <typename T, typename Acc>
+static __device__ __forceinline__ void tiramisu_wmma_m16n16k16(Acc *c, int ldc, const T *a, int lda, const T *b, int ldb)
+{
+    using namespace nvcuda;
+    wmma::fragment<wmma::matrix_a, 16, 16, 16, T, wmma::row_major> a_fragment;
+    wmma::fragment<wmma::matrix_b, 16, 16, 16, T, wmma::row_major> b_fragment;
+    wmma::fragment<wmma::accumulator, 16, 16, 16, Acc> c_fragment;
+    wmma::load_matrix_sync(a_fragment, a, lda);
+    wmma::load_matrix_sync(b_fragment, b, ldb);
+    wmma::load_matrix_sync(c_fragment, c, ldc, wmma::mem_row_major);
+    wmma::mma_sync(c_fragment, a_fragment, b_fragment, c_fragment);
+    wmma::store_matrix_sync(c, c_fragment, ldc, wmma::mem_row_major);
+}
+)";
+
+    static const char *persistent_kernel_helpers = R"(#include <cooperative_groups.h>
+#include <algorithm>
+static int tiramisu_cuda_persistent_blocks(const void *kernel, int threads, int64_t wanted)
+{
+    int device, multiprocessors, blocks_per_multiprocessor;
+    cudaGetDevice(&device);
+    cudaDeviceGetAttribute(&multiprocessors, cudaDevAttrMultiProcessorCount, device);
+    cudaOccupancyMaxActiveBlocksPerMultiprocessor(&blocks_per_multiprocessor, kernel, threads, 0);
+    return (int) std::max<int64_t>(1, std::min<int64_t>(wanted, (int64_t) multiprocessors * blocks_per_multiprocessor));
+}
+)";
+
     bool cuda_ast::compiler::compile(const std::string & obj_name) const {
         using namespace std;
         DEBUG_FCT_NAME(3);
         DEBUG_INDENT(4);
         char cwd[500];
         getcwd(cwd, 500);
-        cout << cwd << endl;
+        DEBUG(3, cout << "Compiling the GPU code in " << cwd);
         ofstream code_file;
         string filename = obj_name + ".cu";
         if (!getenv("CUDA_NO_OVERWRITE")) {
@@ -1813,6 +2963,22 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
             }
             DEBUG(3, cout << "Opened file " << filename << " for writing.");
             code_file << "#include <stdint.h>\n";
+            code_file << "#include <cuda_fp16.h>\n";
+            code_file << "#include <cuda_bf16.h>\n";
+            if (code.find("__pipeline_") != std::string::npos)
+                code_file << "#include <cuda_pipeline.h>\n";
+            if (code.find("tiramisu_cuda_get_stream") != std::string::npos)
+                code_file << "extern \"C\" cudaStream_t tiramisu_cuda_get_stream(int32_t stream);\n";
+            if (code.find("tiramisu_wmma_m16n16k16") != std::string::npos)
+                code_file << tensor_core_helpers;
+            if (code.find("tiramisu_cuda_persistent_blocks") != std::string::npos)
+                code_file << persistent_kernel_helpers;
+            if (code.find("float2") != std::string::npos || code.find("double2") != std::string::npos)
+                code_file << complex_helpers;
+            if (code.find("lerp(") != std::string::npos)
+                code_file << lerp_helpers;
+            if (code.find("tiramisu_reduction::") != std::string::npos)
+                code_file << reduction_helpers;
             code_file << code;
             code_file.flush();
             if (code_file.fail()) {
@@ -1821,9 +2987,20 @@ cuda_ast::statement_ptr cuda_ast::generator::cuda_stmt_handle_isl_if(isl_ast_nod
             }
         }
 
+        // Skip nvcc when the same code was already compiled with the same flags
+        std::string key = cache_key(filename);
+        if (fetch_from_cache(key, obj_name)) {
+            DEBUG_INDENT(-4);
+            return true;
+        }
+
+        bool result = compile_cpu_obj(filename, obj_name) && compile_gpu_obj(obj_name);
+        if (result)
+            store_in_cache(key, obj_name);
+
         DEBUG_INDENT(-4);
 
-        return compile_cpu_obj(filename, obj_name) && compile_gpu_obj(obj_name);
+        return result;
     }
 
 bool cuda_ast::abstract_identifier::is_buffer() const {
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <sstream>
 
@@ -69,9 +70,14 @@ tiramisu::primitive_t halide_type_to_tiramisu_type(Type type)
         {
             return tiramisu::p_float64;
         }
+        else if (type.bits() == 16)
+        {
+            // is_float() is also true for bfloat16
+            return type.is_bfloat() ? tiramisu::p_bfloat16 : tiramisu::p_float16;
+        }
         else
         {
-            ERROR("Floats other than 32 and 64 bits are not suppored in Tiramisu.", true);
+            ERROR("Floats other than 16, 32 and 64 bits are not suppored in Tiramisu.", true);
         }
     }
     else if (type.is_bool())
@@ -88,13 +94,65 @@ tiramisu::primitive_t halide_type_to_tiramisu_type(Type type)
 namespace
 {
 
+// Halide names contain '.' and '$' (e.g. "f.s1.r$x"), which are not valid
+// in the isl strings and in the generated code.
+std::string sanitize_name(const std::string &name)
+{
+    std::string sanitized = name;
+    for (char &c : sanitized)
+    {
+        if (!isalnum(c) && (c != '_'))
+        {
+            c = '_';
+        }
+    }
+    return sanitized;
+}
+
+class SanitizeNames : public IRMutator
+{
+public:
+    using IRMutator::visit;
+
+    Expr visit(const Variable *op) override
+    {
+        return Variable::make(op->type, sanitize_name(op->name));
+    }
+};
+
+Expr sanitize_names(const Expr &e)
+{
+    return SanitizeNames().mutate(e);
+}
+
+// True if the expression reads a Halide function, in which case it is not
+// an affine function of the loop variables.
+class FindCalls : public IRVisitor
+{
+public:
+    using IRVisitor::visit;
+    bool found = false;
+
+    void visit(const Call *op) override
+    {
+        found = true;
+    }
+};
+
+bool has_calls(const Expr &e)
+{
+    FindCalls finder;
+    e.accept(&finder);
+    return finder.found;
+}
+
 std::string to_string(const std::vector<Expr> &v)
 {
     std::ostringstream stream;
     stream << "[";
     for (size_t i = 0; i < v.size(); ++i)
     {
-        stream << v[i];
+        stream << sanitize_names(v[i]);
         if (i != v.size() - 1)
         {
             stream << ", ";
@@ -136,7 +194,7 @@ private:
         stream << "[";
         for (size_t i = 0; i < loop_dims.size(); ++i)
         {
-            stream << loop_dims[i].min << ", " << loop_dims[i].extent;
+            stream << sanitize_names(loop_dims[i].min) << ", " << sanitize_names(loop_dims[i].extent);
             if (i != loop_dims.size() - 1)
             {
                 stream << ", ";
@@ -162,8 +220,30 @@ private:
         return stream.str();
     }
 
+    string get_loop_names() const
+    {
+        std::ostringstream stream;
+        stream << "[";
+        for (size_t i = 0; i < loop_dims.size(); ++i)
+        {
+            stream << sanitize_name(loop_dims[i].name);
+            if (i != loop_dims.size() - 1)
+            {
+                stream << ", ";
+            }
+        }
+        stream << "]";
+        return stream.str();
+    }
+
     void define_constant(const string &name, Expr value);
 
+    // The last computation created, the stages are ordered as in the Halide
+    // pipeline
+    tiramisu::computation *last_computation = NULL;
+    // The number of updates of each Halide function
+    map<string, int> nb_updates;
+
 public:
     tiramisu::expr expr;
     map<string, tiramisu::computation *> computation_list;
@@ -178,7 +258,7 @@ public:
         {
             std::ostringstream stream;
             Expr max = simplify(min + extent - 1);
-            stream << min << " <= " << name << " <= " << max;
+            stream << sanitize_names(min) << " <= " << sanitize_name(name) << " <= " << sanitize_names(max);
             return stream.str();
         }
     };
@@ -327,7 +407,7 @@ void HalideToTiramisu::visit(const Variable *op)
     assert(!op->param.defined() && "Can only handle simple variable for now.\n");
     assert(!op->image.defined() && "Can only handle simple variable for now.\n");
 
-    const auto &iter = constant_list.find(op->name);
+    const auto &iter = constant_list.find(sanitize_name(op->name));
     if (iter != constant_list.end())
     {
         // It is a reference to variable defined in Let/LetStmt
@@ -337,7 +417,7 @@ void HalideToTiramisu::visit(const Variable *op)
     else
     {
         // It is presumably a reference to loop variable
-        expr = tiramisu::var(op->name);
+        expr = tiramisu::var(sanitize_name(op->name));
     }
 }
 
@@ -474,8 +554,7 @@ void HalideToTiramisu::visit(const LetStmt *op)
 
 void HalideToTiramisu::visit(const ProducerConsumer *op)
 {
-    assert((op->body.as<Block>() == NULL) && "Does not currently handle update.\n");
-    assert((!op->is_producer || (computation_list.find(op->name) == computation_list.end())) &&
+    assert((!op->is_producer || (computation_list.find(sanitize_name(op->name)) == computation_list.end())) &&
            "Found another computation with the same name.\n");
 
     vector<Loop> old_loop_dims = loop_dims;
@@ -483,8 +562,9 @@ void HalideToTiramisu::visit(const ProducerConsumer *op)
     loop_dims = old_loop_dims;
 }
 
-void HalideToTiramisu::define_constant(const string &name, Expr val)
+void HalideToTiramisu::define_constant(const string &halide_name, Expr val)
 {
+    string name = sanitize_name(halide_name);
     assert((constant_list.find(name) == constant_list.end()) &&
            "Redefinition of lets is not supported right now.\n");
 
@@ -493,6 +573,13 @@ void HalideToTiramisu::define_constant(const string &name, Expr val)
     tiramisu::constant *c_const = new tiramisu::constant(name, value,
             halide_type_to_tiramisu_type(val.type()), true, NULL, 0, func);
     constant_list.emplace(name, c_const);
+
+    // The loop bounds known at compile time are added to the context, so that
+    // the auto-scheduler sees the extents of the loops.
+    if (const IntImm *v = val.as<IntImm>())
+    {
+        func->add_context_constraints("[" + name + "]->{: " + name + " = " + std::to_string(v->value) + "}");
+    }
 }
 
 void HalideToTiramisu::visit(const For *op)
@@ -544,15 +631,20 @@ void HalideToTiramisu::visit(const Load *op)
 
 void HalideToTiramisu::visit(const Provide *op)
 {
-    assert((computation_list.find(op->name) == computation_list.end())
-           && "Duplicate computation is not currently supported.\n");
-    assert((temporary_buffers.count("buff_" + op->name) || output_buffers.count("buff_" + op->name))
+    string name = sanitize_name(op->name);
+    string buffer_name = "buff_" + name;
+    assert((temporary_buffers.count(buffer_name) || output_buffers.count(buffer_name))
            && "The buffer should have been allocated previously.\n");
 
+    // The first Provide to a function is its pure definition, the following
+    // ones are its updates (the reductions of Halide)
+    bool is_update = (computation_list.find(name) != computation_list.end());
+
     for (size_t i = 0; i < op->args.size(); ++i)
     {
-        assert((op->args[i].as<Variable>() != NULL)
-               && "Expect args of provide to be loop dims for now (doesn't currently handle update).\n");
+        assert((is_update || (op->args[i].as<Variable>() != NULL))
+               && "Expect args of the pure definition to be loop dims.\n");
+        assert(!has_calls(op->args[i]) && "Expect args of provide to be affine in the loop dims.\n");
     }
 
     assert((op->values.size() == 1) && "Expect 1D store (no tuple) in the Provide node for now.\n");
@@ -562,24 +654,42 @@ void HalideToTiramisu::visit(const Provide *op)
         values[i] = mutate(op->values[i]);
     }
 
+    // The pure definition is iterated over its arguments.  An update is
+    // iterated over all the surrounding loops, which include the loops of
+    // its reduction domain.
     string dims_str = to_string(op->args);
-    string iter_space_str = get_loop_bound_vars() + "->{" + op->name + dims_str + ": " +
+    string computation_name = name;
+    string iter_dims_str = dims_str;
+    if (is_update)
+    {
+        computation_name = name + "_update_" + std::to_string(nb_updates[name]++);
+        iter_dims_str = get_loop_names();
+    }
+
+    string iter_space_str = get_loop_bound_vars() + "->{" + computation_name + iter_dims_str + ": " +
                             get_loop_bounds() + "}";
     tiramisu::computation *compute = new tiramisu::computation(
         iter_space_str, values[0], true, halide_type_to_tiramisu_type(op->values[0].type()), func);
 
-    // 1-to-1 mapping to buffer
-    string access_str = "{" + op->name + dims_str + "->" + "buff_" + op->name + dims_str + "}";
+    // 1-to-1 mapping to buffer for the pure definition, the arguments of the
+    // update select the element of the buffer it updates
+    string access_str = "{" + computation_name + iter_dims_str + "->" + buffer_name + dims_str + "}";
     compute->set_access(access_str);
 
-    computation_list.emplace(op->name, compute);
+    if (last_computation != NULL)
+    {
+        compute->after(*last_computation, tiramisu::computation::root);
+    }
+    last_computation = compute;
+
+    computation_list.emplace(computation_name, compute);
 }
 
 void HalideToTiramisu::visit(const Realize *op)
 {
     // We will ignore the condition on the Realize node for now.
 
-    assert((temporary_buffers.find("buff_" + op->name) == temporary_buffers.end())
+    assert((temporary_buffers.find("buff_" + sanitize_name(op->name)) == temporary_buffers.end())
            && "Duplicate allocation (i.e. duplicate compute) is not currently supported.\n");
 
     const auto iter = env.find(op->name);
@@ -612,7 +722,7 @@ void HalideToTiramisu::visit(const Realize *op)
         extents[i] = mutate(op->bounds[i].extent);
     }
 
-    string buffer_name = "buff_" + op->name;
+    string buffer_name = "buff_" + sanitize_name(op->name);
     tiramisu::buffer *produce_buffer = new tiramisu::buffer(
         buffer_name, extents,
         halide_type_to_tiramisu_type(op->types[0]), a_temporary, func);
@@ -625,7 +735,7 @@ void HalideToTiramisu::visit(const Call *op)
 {
     assert((op->call_type == Call::CallType::Halide) && "Only handle call to halide func for now.\n");
 
-    const auto iter = computation_list.find(op->name);
+    const auto iter = computation_list.find(sanitize_name(op->name));
     assert(iter != computation_list.end() && "Call to computation that does not exist.\n");
 
     vector<tiramisu::expr> args(op->args.size());
@@ -668,7 +778,7 @@ tiramisu::HalideCodegenOutput halide_pipeline_to_tiramisu_function(
         }
         assert(sizes.size() == f.args().size());
 
-        string buffer_name = "buff_" + f.name();
+        string buffer_name = "buff_" + sanitize_name(f.name());
         // TODO(psuriana): should make the buffer data type variable instead of uint8_t always
         tiramisu::buffer *output_buffer = new tiramisu::buffer(
             buffer_name, sizes, p_uint8, a_output, func);
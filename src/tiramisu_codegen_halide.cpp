@@ -1,4 +1,5 @@
 #include <map>
+#include <limits>
 #include <isl/aff.h>
 #include <isl/set.h>
 #include <isl/constraint.h>
@@ -9,6 +10,7 @@
 #include <isl/ast_build.h>
 #include <isl/schedule.h>
 #include <isl/schedule_node.h>
+#include <isl/ilp.h>
 
 #include <tiramisu/debug.h>
 #include <tiramisu/core.h>
@@ -16,10 +18,13 @@
 #include <tiramisu/expr.h>
 
 #include <string>
+#include <future>
+#include <sys/resource.h>
 #include "../include/tiramisu/expr.h"
 #include "Halide.h"
 #include "../include/tiramisu/debug.h"
 #include "../include/tiramisu/core.h"
+#include "../include/tiramisu/utils.h"
 
 namespace tiramisu
 {
@@ -28,6 +33,213 @@ std::string generate_new_variable_name();
 Halide::Expr make_comm_call(Halide::Type type, std::string func_name, std::vector<Halide::Expr> args);
 Halide::Expr halide_expr_from_tiramisu_type(tiramisu::primitive_t ptype);
 
+// Name of the LetStmt that marks the statements of the inspector computations
+#define INSPECTOR_MARKER "_tiramisu_inspector"
+
+// The accesses to a buffer of complex numbers have no index for its innermost
+// dimension, which holds the real and imaginary parts of the elements.
+static int get_accessed_dims(const tiramisu::buffer *b)
+{
+    return b->get_dim_sizes().size() - ((b->get_complex_type() != p_none) ? 1 : 0);
+}
+
+// A complex value is a vector of its real and imaginary parts: a complex
+// access loads or stores both parts, starting at the linearized index of the
+// real part.
+static Halide::Expr complex_access_index(const tiramisu::buffer *b, const Halide::Expr &index)
+{
+    if (b->get_complex_type() == p_none)
+        return index;
+
+    return Halide::Internal::Ramp::make(index, Halide::cast(index.type(), 1), 2);
+}
+
+// (ar, ai) * (br, bi) = (ar, ar) * (br, bi) + (ai, ai) * (-bi, br), which is
+// vectorized as an interleaved complex multiplication (two vector products and
+// an addsub).
+static Halide::Expr complex_mul(const Halide::Expr &a, const Halide::Expr &b)
+{
+    Halide::Type t = a.type().element_of();
+    Halide::Expr sign = Halide::Internal::Shuffle::make_interleave({Halide::Internal::make_const(t, -1),
+                                                                    Halide::Internal::make_const(t, 1)});
+
+    return Halide::Internal::Shuffle::make({a}, {0, 0}) * b +
+           Halide::Internal::Shuffle::make({a}, {1, 1}) * (Halide::Internal::Shuffle::make({b}, {1, 0}) * sign);
+}
+
+static Halide::Expr complex_conj(const Halide::Expr &a)
+{
+    Halide::Type t = a.type().element_of();
+
+    return a * Halide::Internal::Shuffle::make_interleave({Halide::Internal::make_const(t, 1),
+                                                           Halide::Internal::make_const(t, -1)});
+}
+
+// a / b = a * conj(b) / |b|^2
+static Halide::Expr complex_div(const Halide::Expr &a, const Halide::Expr &b)
+{
+    Halide::Expr b2 = b * b;
+    Halide::Expr norm = Halide::Internal::Shuffle::make({b2}, {0, 0}) + Halide::Internal::Shuffle::make({b2}, {1, 1});
+
+    return complex_mul(a, complex_conj(b)) / norm;
+}
+
+// The vectorized float32 math functions (see computation::set_math_precision()).
+// They follow the range reductions and the polynomials of the Cephes library;
+// math_approx truncates the polynomials.
+static Halide::Expr horner(const Halide::Expr &x, const std::vector<float> &coefficients)
+{
+    Halide::Expr result = coefficients[0];
+    for (int i = 1; i < coefficients.size(); i++)
+        result = result * x + coefficients[i];
+    return result;
+}
+
+// exp(x) = 2^n * exp(r), with n = round(x / log(2)) and |r| <= log(2) / 2
+static Halide::Expr vector_exp(Halide::Expr x, tiramisu::math_precision_t precision)
+{
+    x = Halide::clamp(x, -87.3f, 88.7f);
+    Halide::Expr n = Halide::round(x * 1.44269504f);
+    Halide::Expr r = x - n * 0.693359375f + n * 2.12194440e-4f;
+
+    Halide::Expr p = (precision == tiramisu::math_fast)
+                     ? horner(r, {1.9875691500e-4f, 1.3981999507e-3f, 8.3334519073e-3f, 4.1665795894e-2f,
+                                  1.6666665459e-1f, 5.0000001201e-1f})
+                     : horner(r, {1.0f / 24, 1.0f / 6, 0.5f});
+    Halide::Expr scale = Halide::reinterpret(Halide::Float(32, x.type().lanes()),
+                                             (Halide::cast(Halide::Int(32, x.type().lanes()), n) + 127) << 23);
+
+    return (p * r * r + r + 1.0f) * scale;
+}
+
+// log(x) = e * log(2) + log(1 + m), with x = 2^e * (1 + m) and sqrt(2) / 2 <= 1 + m < sqrt(2)
+static Halide::Expr vector_log(const Halide::Expr &x, tiramisu::math_precision_t precision)
+{
+    Halide::Type i32 = Halide::Int(32, x.type().lanes());
+    Halide::Type f32 = Halide::Float(32, x.type().lanes());
+    Halide::Expr bits = Halide::reinterpret(i32, x);
+    Halide::Expr e = Halide::cast(f32, (bits >> 23) - 126);
+    Halide::Expr m = Halide::reinterpret(f32, (bits & 0x807fffff) | 0x3f000000);
+    Halide::Expr small = m < 0.707106781f;
+    e = Halide::select(small, e - 1.0f, e);
+    m = Halide::select(small, m + m, m) - 1.0f;
+
+    Halide::Expr z = m * m;
+    Halide::Expr p = (precision == tiramisu::math_fast)
+                     ? horner(m, {7.0376836292e-2f, -1.1514610310e-1f, 1.1676998740e-1f, -1.2420140846e-1f,
+                                  1.4249322787e-1f, -1.6668057665e-1f, 2.0000714765e-1f, -2.4999993993e-1f,
+                                  3.3333331174e-1f})
+                     : horner(m, {-1.2420140846e-1f, 1.4249322787e-1f, -1.6668057665e-1f, 2.0000714765e-1f,
+                                  -2.4999993993e-1f, 3.3333331174e-1f});
+    Halide::Expr result = m + (m * z * p - 2.12194440e-4f * e - 0.5f * z) + 0.693359375f * e;
+
+    return Halide::select(x > 0.0f, result,
+                          x == 0.0f, Halide::Internal::make_const(f32, -std::numeric_limits<float>::infinity()),
+                          Halide::Internal::make_const(f32, std::numeric_limits<float>::quiet_NaN()));
+}
+
+// tanh(x) = x + x^3 * P(x^2) for |x| < 0.625, 1 - 2 / (exp(2|x|) + 1) otherwise
+static Halide::Expr vector_tanh(const Halide::Expr &x, tiramisu::math_precision_t precision)
+{
+    Halide::Expr ax = Halide::abs(x);
+    Halide::Expr z = x * x;
+    Halide::Expr p = (precision == tiramisu::math_fast)
+                     ? horner(z, {-5.70498872745e-3f, 2.06390887954e-2f, -5.37397155531e-2f, 1.33314422036e-1f,
+                                  -3.33332819422e-1f})
+                     : horner(z, {-5.37397155531e-2f, 1.33314422036e-1f, -3.33332819422e-1f});
+    Halide::Expr large = 1.0f - 2.0f / (vector_exp(2.0f * Halide::min(ax, 9.0f), precision) + 1.0f);
+
+    return Halide::select(ax < 0.625f, x + x * z * p, Halide::select(x < 0.0f, -large, large));
+}
+
+// sin(x) and cos(x) from sin(y) and cos(y), with x = j * pi / 2 + y and |y| <= pi / 4
+static Halide::Expr vector_sin_cos(const Halide::Expr &x, bool cosine, tiramisu::math_precision_t precision)
+{
+    Halide::Expr j = Halide::round(x * 0.636619772f);
+    Halide::Expr y = x - j * 1.5703125f - j * 4.837512969970703125e-4f - j * 7.54978995489188216e-8f;
+    Halide::Expr z = y * y;
+
+    Halide::Expr sin_y, cos_y;
+    if (precision == tiramisu::math_fast)
+    {
+        sin_y = y + y * z * horner(z, {-1.9515295891e-4f, 8.3321608736e-3f, -1.6666654611e-1f});
+        cos_y = 1.0f - 0.5f * z + z * z * horner(z, {2.443315711809948e-5f, -1.388731625493765e-3f,
+                                                     4.166664568298827e-2f});
+    }
+    else
+    {
+        sin_y = y + y * z * horner(z, {1.0f / 120, -1.0f / 6});
+        cos_y = 1.0f - 0.5f * z + z * z * horner(z, {-1.0f / 720, 1.0f / 24});
+    }
+
+    // The quadrant of x, cos(x) being sin(x + pi / 2)
+    Halide::Expr q = (Halide::cast(Halide::Int(32, x.type().lanes()), j) + (cosine ? 1 : 0)) & 3;
+
+    return Halide::select(q == 0, sin_y, q == 1, cos_y, q == 2, -sin_y, -cos_y);
+}
+
+/**
+  * The vectorized implementation of the operator \p op applied to \p x with
+  * the precision \p precision, or an undefined expression if the math library
+  * is used.
+  */
+static Halide::Expr vector_math(tiramisu::op_t op, const Halide::Expr &x, tiramisu::math_precision_t precision)
+{
+    if (precision == tiramisu::math_precise || !x.type().is_float() || x.type().bits() != 32)
+        return Halide::Expr();
+
+    switch (op)
+    {
+        case tiramisu::o_expo: return vector_exp(x, precision);
+        case tiramisu::o_log: return vector_log(x, precision);
+        case tiramisu::o_tanh: return vector_tanh(x, precision);
+        case tiramisu::o_sin: return vector_sin_cos(x, false, precision);
+        case tiramisu::o_cos: return vector_sin_cos(x, true, precision);
+        default: return Halide::Expr();
+    }
+}
+
+// A GPU global buffer is a device pointer in the host code (it has no
+// halide_buffer_t): the address of one of its elements is an offset of that
+// pointer.
+static Halide::Expr device_address_of(const tiramisu::buffer *b, const Halide::Expr &index)
+{
+    Halide::Expr device_buffer = Halide::Internal::Variable::make(Halide::type_of<void *>(), b->get_name());
+    int bytes = halide_type_from_tiramisu_type(b->get_elements_type()).bytes();
+
+    return Halide::Internal::Call::make(Halide::type_of<void *>(), "tiramisu_cuda_offset_pointer",
+                                        {device_buffer, Halide::cast(Halide::type_of<uint64_t>(), index * bytes)},
+                                        Halide::Internal::Call::Extern);
+}
+
+static bool is_device_address(const Halide::Expr &e)
+{
+    const Halide::Internal::Call *call = e.as<Halide::Internal::Call>();
+    return (call != nullptr) && (call->name == "tiramisu_cuda_offset_pointer");
+}
+
+// The point-to-point transfers of GPU global buffers pass the device pointers
+// to the _device variants of the MPI runtime (e.g. tiramisu_MPI_Isend_f32
+// becomes tiramisu_MPI_Isend_device_f32), which give them to a CUDA-aware MPI
+// library or stage them through the host.
+static std::string comm_call_name(const tiramisu::computation *comp, const std::string &name,
+                                  const std::vector<Halide::Expr> &args)
+{
+    if (!std::any_of(args.begin(), args.end(), is_device_address))
+        return name;
+
+    if (!comp->is_send() && !comp->is_recv())
+        ERROR("Only the sends and the receives of " + comp->get_name() + " can access GPU buffers (" + name + ").", true);
+    if (name.find("_vector_") != std::string::npos)
+        ERROR("The strided transfers of GPU buffers are not supported (" + comp->get_name() + ").", true);
+    if (name.find("_Put_") != std::string::npos || name.find("_Get_") != std::string::npos)
+        ERROR("The one-sided transfers of GPU buffers are not supported (" + comp->get_name() + ").", true);
+
+    std::string device_name = name;
+    device_name.insert(name.rfind('_'), "_device");
+    return device_name;
+}
+
 Halide::Argument::Kind halide_argtype_from_tiramisu_argtype(tiramisu::argument_t type)
 {
     Halide::Argument::Kind res;
@@ -56,26 +268,17 @@ std::vector<computation *> function::get_computation_by_name(std::string name) c
 
     DEBUG(10, tiramisu::str_dump("Searching computation " + name));
 
-    std::vector<tiramisu::computation *> res_comp;
-
-    for (const auto &comp : this->get_computations())
-    {
-        if (name == comp->get_name())
-        {
-            res_comp.push_back(comp);
-        }
-    }
+    auto it = this->computations_by_name.find(name);
 
-    if (res_comp.empty())
+    if (it == this->computations_by_name.end())
     {
         DEBUG(10, tiramisu::str_dump("Computation not found."));
+        return {};
     }
-    else
-    {
-        DEBUG(10, tiramisu::str_dump("Computation found."));
-    }
 
-    return res_comp;
+    DEBUG(10, tiramisu::str_dump("Computation found."));
+
+    return it->second;
 }
 
 std::vector<tiramisu::computation *> generator::get_computation_by_node(tiramisu::function *fct,
@@ -689,7 +892,7 @@ void generator::traverse_expr_and_extract_accesses(const tiramisu::function *fct
                 DEBUG(3, tiramisu::str_dump("Trimmed schedule:",
                                             isl_map_to_str(comp->get_trimmed_union_of_schedules())));
                 access_to_buff = isl_map_apply_domain(access_to_buff,
-                                                      isl_map_copy(comp->get_trimmed_union_of_schedules()));
+                                                      comp->get_trimmed_union_of_schedules());
                 DEBUG(3, tiramisu::str_dump("Result: ", isl_map_to_str(access_to_buff)));
             }
 
@@ -1252,7 +1455,7 @@ std::map<std::string, isl_ast_expr *> generator::compute_iterators_map(tiramisu:
      */
     isl_set *dom = isl_set_copy(comp->get_iteration_domain());
     isl_map *identity = isl_set_identity(isl_set_copy(dom));
-    isl_map *schedule = isl_map_copy(comp->get_trimmed_union_of_schedules()); //isl_map_copy(isl_map_from_union_map(isl_ast_build_get_schedule(build)));
+    isl_map *schedule = comp->get_trimmed_union_of_schedules(); //isl_map_copy(isl_map_from_union_map(isl_ast_build_get_schedule(build)));
     identity = isl_map_apply_domain(identity, schedule);
 
     DEBUG(3, tiramisu::str_dump("Creating an isl_ast_index_expression for the access :",
@@ -1364,6 +1567,59 @@ isl_ast_node *generator::stmt_code_generator(isl_ast_node *node, isl_ast_build *
         std::map<std::string, isl_ast_expr *> iterators_map = generator::compute_iterators_map(comp, build);
         comp->set_iterators_map(iterators_map);
 
+        // Compute the index expressions of the software prefetches of the
+        // computation.  Each access to a prefetched buffer is shifted by the
+        // prefetch distance along the prefetched loop level.
+        std::vector<std::tuple<std::string, int, int>> prefetches = func->get_prefetch_dimensions(comp->get_name());
+        if (!prefetches.empty() && comp->has_accesses())
+        {
+            std::vector<isl_map *> rhs_accesses;
+            generator::get_rhs_accesses(func, comp, rhs_accesses, true);
+
+            std::vector<std::pair<std::string, isl_ast_expr *>> prefetch_index_expressions;
+            for (const auto &pf : prefetches)
+            {
+                const std::string &buffer_name = std::get<0>(pf);
+                // The accesses are in the time-processor domain, which does
+                // not have the duplicate dimension.
+                int dim = loop_level_into_dynamic_dimension(std::get<1>(pf)) - 1;
+                bool found = false;
+
+                for (isl_map *acc : rhs_accesses)
+                {
+                    if ((acc == NULL) || (isl_map_has_tuple_name(acc, isl_dim_out) != isl_bool_true) ||
+                        (std::string(isl_map_get_tuple_name(acc, isl_dim_out)) != buffer_name))
+                        continue;
+
+                    found = true;
+
+                    isl_set *domain = isl_map_domain(isl_map_copy(acc));
+                    isl_map *shifted = isl_map_gist_domain(isl_map_copy(acc), isl_set_copy(domain));
+                    isl_multi_aff *shift = isl_multi_aff_identity(isl_space_map_from_set(isl_set_get_space(domain)));
+                    isl_aff *shifted_dim = isl_multi_aff_get_aff(shift, dim);
+                    shifted_dim = isl_aff_add_constant_si(shifted_dim, std::get<2>(pf));
+                    shift = isl_multi_aff_set_aff(shift, dim, shifted_dim);
+                    shifted = isl_map_apply_range(isl_map_from_multi_aff(shift), shifted);
+                    shifted = isl_map_intersect_domain(shifted, domain);
+
+                    DEBUG(3, tiramisu::str_dump("Prefetched access:", isl_map_to_str(shifted)));
+
+                    prefetch_index_expressions.push_back(std::make_pair(buffer_name,
+                        create_isl_ast_index_expression(build, shifted, comp->get_level_to_drop())));
+                    isl_map_free(shifted);
+                }
+
+                if (!found)
+                    ERROR("The computation " + comp->get_name() + " does not access the buffer " +
+                          buffer_name + " that it prefetches.", true);
+            }
+
+            for (isl_map *acc : rhs_accesses)
+                isl_map_free(acc);
+
+            comp->prefetch_index_expr.insert(comp->prefetch_index_expr.begin(), prefetch_index_expressions);
+        }
+
         if (!accesses.empty())
         {
             DEBUG(3, tiramisu::str_dump("Generated RHS access maps:"));
@@ -1699,6 +1955,12 @@ void tiramisu::generator::extract_tags_from_isl_node(const tiramisu::function &f
                 tagged_stmts.push_back(std::pair<std::string, std::string>(computation_name, "unroll"));
             if (fct.should_distribute(computation_name, l))
                 tagged_stmts.push_back(std::pair<std::string, std::string>(computation_name, "distribute"));
+            if (fct.should_distribute_to_gpus(computation_name, l))
+                tagged_stmts.push_back(std::pair<std::string, std::string>(computation_name, "gpu_device"));
+            if (!fct.get_parametric_split_sizes(computation_name, l).empty())
+                tagged_stmts.push_back(std::pair<std::string, std::string>(computation_name, "parametric_split"));
+            if (fct.get_pipeline_depth(computation_name, l) >= 0)
+                tagged_stmts.push_back(std::pair<std::string, std::string>(computation_name, "pipeline"));
         }
     }
     else if (isl_ast_node_get_type(node) == isl_ast_node_if)
@@ -1720,6 +1982,108 @@ void tiramisu::generator::extract_tags_from_isl_node(const tiramisu::function &f
     DEBUG_INDENT(-4);
 }
 
+Halide::Internal::Stmt generator::wait_for_other_streams(const tiramisu::function &fct, int stream,
+                                                        const std::set<std::string> &buffers,
+                                                        Halide::Internal::Stmt s)
+{
+    // The stream and the buffers of every operation issued on a stream
+    std::vector<std::pair<int, std::set<std::string>>> operations;
+    for (const auto &k : fct.iterator_to_kernel_map)
+    {
+        std::set<std::string> used;
+        for (const auto &id : k.second->get_arguments())
+            if (id->is_buffer())
+                used.insert(id->get_name());
+        operations.push_back(std::make_pair(k.second->get_stream(), used));
+    }
+    for (const auto &comp : fct.get_computations())
+    {
+        const tiramisu::expr &e = comp->get_expr();
+        auto it = fct.gpu_streams.find(comp->get_name());
+        if (it != fct.gpu_streams.end() && e.get_expr_type() == tiramisu::e_op && e.get_op_type() == tiramisu::o_memcpy)
+            operations.push_back(std::make_pair(it->second, std::set<std::string>{e.get_operand(0).get_name(),
+                                                                                  e.get_operand(1).get_name()}));
+    }
+
+    std::set<int> signaling;
+    for (const auto &op : operations)
+        if (op.first != stream)
+            for (const auto &b : op.second)
+                if (buffers.count(b) != 0)
+                    signaling.insert(op.first);
+
+    for (auto it = signaling.rbegin(); it != signaling.rend(); ++it)
+        s = Halide::Internal::Block::make(
+                Halide::Internal::Evaluate::make(Halide::Internal::Call::make(
+                        Halide::Int(32), "tiramisu_cuda_stream_wait",
+                        {Halide::Expr(stream), Halide::Expr(*it)}, Halide::Internal::Call::Extern)),
+                s);
+    return s;
+}
+
+Halide::Internal::Stmt generator::make_gpu_device_loop(const std::string &iterator, Halide::Expr min,
+                                                      Halide::Expr extent, Halide::Internal::Stmt body)
+{
+    auto device_call = [](const std::string &function, Halide::Expr arg) {
+        return Halide::Internal::Evaluate::make(
+                Halide::Internal::Call::make(Halide::Int(32), function, {arg}, Halide::Internal::Call::Extern));
+    };
+
+    // Every iteration issues its work on its own GPU; since kernel launches
+    // and stream copies return immediately, the GPUs run concurrently.
+    Halide::Expr iteration = Halide::Internal::Variable::make(min.type(), iterator);
+    body = Halide::Internal::Block::make(
+            device_call("tiramisu_cuda_set_device", Halide::cast(Halide::Int(32), iteration)), body);
+    Halide::Internal::Stmt loop = Halide::Internal::For::make(iterator, min, extent,
+                                                              Halide::Internal::ForType::Serial,
+                                                              Halide::DeviceAPI::Host, body);
+
+    return Halide::Internal::Block::make({device_call("tiramisu_cuda_device_loop_begin", Halide::Expr(0)),
+                                          loop,
+                                          device_call("tiramisu_cuda_device_loop_end", Halide::Expr(0))});
+}
+
+Halide::Internal::Stmt generator::make_cuda_graph_guard(const tiramisu::function &fct, Halide::Internal::Stmt stmt)
+{
+    // A graph is only valid for the buffers and the sizes it was captured with
+    Halide::Expr key = Halide::Internal::make_zero(Halide::UInt(64));
+    for (const auto &buf : fct.function_arguments)
+    {
+        Halide::Expr address = Halide::Internal::Call::make(
+                Halide::Handle(1, halide_type_from_tiramisu_type(buf->get_elements_type()).handle_type),
+                "tiramisu_address_of_" + str_from_tiramisu_type_primitive(buf->get_elements_type()),
+                {Halide::Internal::Variable::make(Halide::type_of<struct halide_buffer_t *>(), buf->get_name() + ".buffer"),
+                 Halide::Expr(0)},
+                Halide::Internal::Call::Extern);
+        key = Halide::Internal::Call::make(Halide::UInt(64), "tiramisu_cuda_graph_hash_pointer",
+                                           {key, address}, Halide::Internal::Call::Extern);
+    }
+    for (const auto &param : fct.get_invariants())
+    {
+        Halide::Type t = halide_type_from_tiramisu_type(param.get_data_type());
+        if (!t.is_int() && !t.is_uint())
+            continue;
+        key = Halide::Internal::Call::make(Halide::UInt(64), "tiramisu_cuda_graph_hash_int",
+                                           {key, Halide::cast(Halide::Int(64), Halide::Internal::Variable::make(t, param.get_name()))},
+                                           Halide::Internal::Call::Extern);
+    }
+
+    std::string key_name = "_" + fct.get_name() + "_cuda_graph_key";
+    Halide::Expr key_var = Halide::Internal::Variable::make(Halide::UInt(64), key_name);
+    Halide::Expr name = Halide::Internal::StringImm::make(fct.get_name());
+    auto graph_call = [&](const std::string &function) {
+        return Halide::Internal::Call::make(Halide::Int(32), function, {name, key_var}, Halide::Internal::Call::Extern);
+    };
+
+    // Capture the body when there is no graph for these arguments yet, then
+    // launch the graph
+    stmt = Halide::Internal::IfThenElse::make(
+            graph_call("tiramisu_cuda_graph_begin") != 0,
+            Halide::Internal::Block::make(stmt, Halide::Internal::Evaluate::make(graph_call("tiramisu_cuda_graph_end"))));
+    stmt = Halide::Internal::Block::make(stmt, Halide::Internal::Evaluate::make(graph_call("tiramisu_cuda_graph_launch")));
+    return Halide::Internal::LetStmt::make(key_name, key, stmt);
+}
+
 Halide::Internal::Stmt
 tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, isl_ast_node *node, int level,
                                                std::vector<std::pair<std::string, std::string>> &tagged_stmts,
@@ -1776,8 +2140,20 @@ tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, is
                     auto buffer_1 = fct.get_buffers().at(e.get_operand(0).get_name());
                     auto buffer_2 = fct.get_buffers().at(e.get_operand(1).get_name());
                     buffer * device_b, * host_b;
-                    bool to_host = false, from_host = false;
-                    if (buffer_1->location != cuda_ast::memory_location::host && buffer_2->location == cuda_ast::memory_location::host) {
+                    bool to_host = false, from_host = false, peer = false, prefetch = false;
+                    if (buffer_1 == buffer_2 && buffer_1->is_gpu_managed()) {
+                        // A prefetch to the GPU of a buffer in managed memory (see Automatic_communication())
+                        device_b = host_b = buffer_1;
+                        prefetch = true;
+                    }
+                    else if (buffer_1->location == cuda_ast::memory_location::global && buffer_2->location == cuda_ast::memory_location::global) {
+                        // A copy between two GPU buffers, possibly on different GPUs;
+                        // its size is the size of the source buffer
+                        device_b = buffer_2;
+                        host_b = buffer_1;
+                        peer = true;
+                    }
+                    else if (buffer_1->location != cuda_ast::memory_location::host && buffer_2->location == cuda_ast::memory_location::host) {
                         device_b = buffer_1;
                         host_b = buffer_2;
                         to_host = true;
@@ -1787,7 +2163,7 @@ tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, is
                         host_b = buffer_1;
                         from_host = true;
                     }
-                    assert(from_host || to_host);
+                    assert(from_host || to_host || peer || prefetch);
                     // Tiramisu buffer is from outermost to innermost, whereas Halide buffer is from innermost
                     // to outermost; thus, we need to reverse the order
                     // TODO: refactor
@@ -1815,6 +2191,15 @@ tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, is
                         }
                     }
                     auto h_type = halide_type_from_tiramisu_type(host_b->get_elements_type());
+                    // Copies of a sub-region only move the elements [offset, offset + count)
+                    auto region = fct.gpu_copy_regions.find(comp->get_name());
+                    Halide::Expr region_offset = Halide::Expr(0);
+                    if (region != fct.gpu_copy_regions.end() && !peer)
+                    {
+                        std::vector<isl_ast_expr *> empty_index_expr;
+                        region_offset = generator::halide_expr_from_tiramisu_expr(&fct, empty_index_expr, region->second.first);
+                        stride_expr = generator::halide_expr_from_tiramisu_expr(&fct, empty_index_expr, region->second.second);
+                    }
                     auto size = Halide::cast(Halide::type_of<uint64_t >(), stride_expr * h_type.bytes());
                     Halide::Internal::Parameter param =
                             Halide::Internal::Parameter{h_type,
@@ -1827,16 +2212,51 @@ tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, is
                     Halide::Expr buffer_address = Halide::Internal::Call::make(Halide::Handle(1, h_type.handle_type),
                                                           "tiramisu_address_of_" +
                                                           str_from_tiramisu_type_primitive(host_b->get_elements_type()),
-                                                          {loaded_symbol, Halide::Expr(0)},
+                                                          {loaded_symbol, region_offset},
                                                           Halide::Internal::Call::Extern);
 
                     auto device_buffer = (device_b->location == cuda_ast::memory_location::constant)
                                       ? Halide::Internal::Call::make(Halide::type_of<void *>(), device_b->get_name() + "_get_symbol", {}, Halide::Internal::Call::Extern)
                                       : Halide::Internal::Variable::make(Halide::type_of<void *>(), device_b->get_name());
+                    if (region != fct.gpu_copy_regions.end() && !peer)
+                        device_buffer = Halide::Internal::Call::make(Halide::type_of<void *>(), "tiramisu_cuda_offset_pointer",
+                                                                     {device_buffer, Halide::cast(Halide::type_of<uint64_t>(), region_offset * h_type.bytes())},
+                                                                     Halide::Internal::Call::Extern);
                     auto host_result_buffer = Halide::Internal::Variable::make(Halide::type_of<struct halide_buffer_t *>(),
                                                                                host_b->get_name() + ".buffer");
 
-                    if (to_host){
+                    auto stream = fct.gpu_streams.find(comp->get_name());
+                    if (prefetch){
+                      int prefetch_stream = (stream != fct.gpu_streams.end()) ? stream->second : 0;
+                      block = Halide::Internal::Evaluate::make(
+                              Halide::Internal::Call::make(Halide::Int(32), "tiramisu_cuda_prefetch_to_device",
+                                                           {device_buffer, size, Halide::Expr(prefetch_stream)},
+                                                           Halide::Internal::Call::Extern)
+                      );
+                    }
+                    else if (peer){
+                      auto source_buffer = Halide::Internal::Variable::make(Halide::type_of<void *>(), host_b->get_name());
+                      int peer_stream = (stream != fct.gpu_streams.end()) ? stream->second : 0;
+                      block = Halide::Internal::Evaluate::make(
+                              Halide::Internal::Call::make(Halide::Int(32), "tiramisu_cuda_memcpy_peer_async",
+                                                           {device_buffer, source_buffer, size, Halide::Expr(peer_stream)},
+                                                           Halide::Internal::Call::Extern)
+                      );
+                      block = generator::wait_for_other_streams(fct, peer_stream, {buffer_1->get_name(), buffer_2->get_name()}, block);
+                    }
+                    else if (stream != fct.gpu_streams.end() && device_b->location != cuda_ast::memory_location::constant){
+                      // Asynchronous copy on the stream of the computation
+                      block = Halide::Internal::Evaluate::make(
+                              Halide::Internal::Call::make(Halide::Int(32),
+                                                           to_host ? "tiramisu_cuda_memcpy_to_host_async"
+                                                                   : "tiramisu_cuda_memcpy_to_device_async",
+                                                           to_host ? std::vector<Halide::Expr>{buffer_address, device_buffer, size, Halide::Expr(stream->second)}
+                                                                   : std::vector<Halide::Expr>{device_buffer, buffer_address, size, Halide::Expr(stream->second)},
+                                                           Halide::Internal::Call::Extern)
+                      );
+                      block = generator::wait_for_other_streams(fct, stream->second, {buffer_1->get_name(), buffer_2->get_name()}, block);
+                    }
+                    else if (to_host){
                       block = Halide::Internal::Evaluate::make(
                               Halide::Internal::Call::make(Halide::Int(32), "tiramisu_cuda_memcpy_to_host",
                                                            {buffer_address, device_buffer, size}, Halide::Internal::Call::Extern)
@@ -2017,8 +2437,11 @@ tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, is
         {
             auto k = it_kernel->second;
             std::vector<Halide::Expr> args;
+            std::set<std::string> used_buffers;
             for (const auto &id : k->get_arguments())
             {
+                if (id->is_buffer())
+                    used_buffers.insert(id->get_name());
                 Halide::Type t;
                 if (id->is_buffer()) {
                     // For buffers use void* to make it compatible with cuda_malloc
@@ -2033,6 +2456,7 @@ tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, is
                     Halide::Internal::Call::make(
                             halide_type_from_tiramisu_type(cuda_ast::kernel::wrapper_return_type),
                             k->get_wrapper_name(), args, Halide::Internal::Call::Extern));
+            result = generator::wait_for_other_streams(fct, k->get_stream(), used_buffers, result);
 
             // The body of the for loop will not be traversed. Extract tags of
             // computations inside:
@@ -2108,11 +2532,52 @@ tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, is
             // current level was marked as such.
             size_t tt = 0;
             bool convert_to_conditional = false;
+            std::string distributed_comp;
+            bool distribute_to_gpus = false;
+            int doacross_distance = -1;
+            bool parallel_reduction = false;
+            tiramisu::reduction_strategy_t reduction_strategy = tiramisu::reduction_privatized;
+            int nb_partials = 0;
+            int scan_blocks = -1;
+            std::string accumulator;
+
+            // A parametric split can be combined with the other tags of the
+            // loop level, look for it first.
+            std::vector<Halide::Expr> parametric_sizes;
+            for (auto &ts : tagged_stmts) {
+                if (ts.first != "" && ts.second == "parametric_split" &&
+                    !fct.get_parametric_split_sizes(ts.first, level).empty()) {
+                    for (const tiramisu::expr &size : fct.get_parametric_split_sizes(ts.first, level)) {
+                        std::vector<isl_ast_expr *> no_index;
+                        parametric_sizes.push_back(generator::halide_expr_from_tiramisu_expr(&fct, no_index, size));
+                    }
+                    ts.first = "";
+                    break;
+                }
+            }
+
+            int pipeline_depth = -1;
+            for (auto &ts : tagged_stmts) {
+                if (ts.first != "" && ts.second == "pipeline" && fct.get_pipeline_depth(ts.first, level) >= 0) {
+                    pipeline_depth = fct.get_pipeline_depth(ts.first, level);
+                    ts.first = "";
+                    break;
+                }
+            }
+
             while (tt < tagged_stmts.size()) {
                 if (tagged_stmts[tt].first != "") {
                     if (tagged_stmts[tt].second == "parallelize" &&
                         fct.should_parallelize(tagged_stmts[tt].first, level)) {
                         fortype = Halide::Internal::ForType::Parallel;
+                        doacross_distance = fct.get_doacross_distance(tagged_stmts[tt].first, level);
+                        parallel_reduction = fct.get_reduction_strategy(tagged_stmts[tt].first, level,
+                                                                        reduction_strategy, nb_partials);
+                        scan_blocks = fct.get_scan_blocks(tagged_stmts[tt].first, level);
+                        if (parallel_reduction || scan_blocks > 0)
+                            accumulator = isl_map_get_tuple_name(
+                                    fct.get_computation_by_name(tagged_stmts[tt].first)[0]->get_access_relation(),
+                                    isl_dim_out);
                         // Since this statement is treated, remove it from the list of
                         // tagged statements so that it does not get treated again later.
                         tagged_stmts[tt].first = "";
@@ -2144,6 +2609,19 @@ tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, is
                         DEBUG(3, tiramisu::str_dump("Vector length = ");
                                 tiramisu::str_dump(std::to_string(vector_length)));
 
+                        // The last partial vector of a predicated vector loop is
+                        // masked by the original bound of the loop (Halide turns
+                        // the guard into predicated loads and stores).
+                        if (fct.is_predicated_vector(tagged_stmts[tt].first, level))
+                        {
+                            Halide::Expr iterator = Halide::Internal::Variable::make(
+                                    halide_type_from_tiramisu_type(global::get_loop_iterator_data_type()),
+                                    iterator_str);
+                            halide_body = Halide::Internal::IfThenElse::make(
+                                    iterator < cond_upper_bound_halide_format, halide_body);
+                            DEBUG(3, tiramisu::str_dump("The last vector is predicated"));
+                        }
+
                         // Currently we assume that when vectorization is used,
                         // then the original loop extent is > vector_length.
                         cond_upper_bound_halide_format = Halide::Expr(vector_length);
@@ -2255,6 +2733,12 @@ tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, is
                                fct.should_distribute(tagged_stmts[tt].first, level)) {
                         // Change this loop into an if statement instead
                         convert_to_conditional = true;
+                        distributed_comp = tagged_stmts[tt].first;
+                        tagged_stmts[tt].first = "";
+                        break;
+                    } else if (tagged_stmts[tt].second == "gpu_device" &&
+                               fct.should_distribute_to_gpus(tagged_stmts[tt].first, level)) {
+                        distribute_to_gpus = true;
                         tagged_stmts[tt].first = "";
                         break;
                     }
@@ -2271,12 +2755,73 @@ tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, is
                 Halide::Expr rank_var =
                         Halide::Internal::Variable::make(
                                 halide_type_from_tiramisu_type(global::get_loop_iterator_data_type()), "rank");
+                // When several loop levels are distributed, the ranks form a grid numbered in
+                // row-major order and this loop iterates over the coordinate of the rank
+                // along its level.
+                tiramisu::computation *dist_comp = fct.get_computation_by_name(distributed_comp)[0];
+                int position = 0, nb_distributed = 0;
+                for (int l = 0; l < dist_comp->get_loop_levels_number(); l++)
+                {
+                    if (fct.should_distribute(distributed_comp, l))
+                    {
+                        if (l < level)
+                            position++;
+                        nb_distributed++;
+                    }
+                }
+                if (nb_distributed > 1)
+                {
+                    std::vector<int> grid = dist_comp->get_rank_grid();
+                    int stride = 1;
+                    for (int k = position + 1; k < (int) grid.size(); k++)
+                        stride *= grid[k];
+                    rank_var = Halide::Internal::Mod::make(
+                            Halide::Internal::Div::make(rank_var, Halide::cast(rank_var.type(), stride)),
+                            Halide::cast(rank_var.type(), grid[position]));
+                }
                 Halide::Expr condition = rank_var >= init_expr;
                 condition = condition && (rank_var < cond_upper_bound_halide_format);
                 Halide::Internal::Stmt else_s;
                 // We need a reference still to this iterator name, so set it equal to the rank
                 halide_body = Halide::Internal::LetStmt::make(iterator_str, rank_var, halide_body);
                 result = Halide::Internal::IfThenElse::make(condition, halide_body, else_s);
+            } else if (pipeline_depth >= 0) {
+                DEBUG(3, tiramisu::str_dump("Creating the pipeline loops."));
+                result = generator::make_pipeline_loop(iterator_str, init_expr,
+                                                       cond_upper_bound_halide_format - init_expr,
+                                                       halide_body, pipeline_depth);
+                DEBUG(10, std::cout << result);
+            } else if (doacross_distance >= 0) {
+                DEBUG(3, tiramisu::str_dump("Creating the doacross loop."));
+                result = generator::make_doacross_loop(iterator_str, init_expr,
+                                                       cond_upper_bound_halide_format - init_expr,
+                                                       halide_body, doacross_distance);
+                DEBUG(10, std::cout << result);
+            } else if (scan_blocks > 0) {
+                DEBUG(3, tiramisu::str_dump("Creating the parallel scan loop."));
+                result = generator::make_parallel_scan_loop(iterator_str, init_expr,
+                                                            cond_upper_bound_halide_format - init_expr,
+                                                            halide_body, accumulator, scan_blocks);
+                DEBUG(10, std::cout << result);
+            } else if (parallel_reduction) {
+                DEBUG(3, tiramisu::str_dump("Creating the parallel reduction loop."));
+                result = generator::make_parallel_reduction_loop(iterator_str, init_expr,
+                                                                 cond_upper_bound_halide_format - init_expr,
+                                                                 halide_body, accumulator, reduction_strategy,
+                                                                 nb_partials);
+                DEBUG(10, std::cout << result);
+            } else if (distribute_to_gpus) {
+                DEBUG(3, tiramisu::str_dump("Creating the loop over the GPUs."));
+                result = generator::make_gpu_device_loop(iterator_str, init_expr,
+                                                         cond_upper_bound_halide_format - init_expr,
+                                                         halide_body);
+                DEBUG(10, std::cout << result);
+            } else if (!parametric_sizes.empty()) {
+                DEBUG(3, tiramisu::str_dump("Creating the loops split by runtime sizes."));
+                result = generator::make_parametric_split_loop(iterator_str, init_expr,
+                                                               cond_upper_bound_halide_format - init_expr,
+                                                               halide_body, parametric_sizes, fortype, dev_api);
+                DEBUG(10, std::cout << result);
             } else {
                 DEBUG(3, tiramisu::str_dump("Creating the for loop."));
                 result = Halide::Internal::For::make(iterator_str, init_expr,
@@ -2294,6 +2839,9 @@ tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, is
         }
         isl_ast_expr_free(iter);
         free(cstr);
+
+        if (level == 0 && fct.profile_loop_nests && result.defined())
+            result = generator::make_profiled_loop_nest(fct, node, result);
     }
     else if (isl_ast_node_get_type(node) == isl_ast_node_user)
     {
@@ -2341,6 +2889,8 @@ tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, is
                     tagged_stmts.push_back(std::pair<std::string, std::string>(computation_name, "unroll"));
                 if (fct.should_distribute(computation_name, l))
                     tagged_stmts.push_back(std::pair<std::string, std::string>(computation_name, "distribute"));
+                if (fct.should_distribute_to_gpus(computation_name, l))
+                    tagged_stmts.push_back(std::pair<std::string, std::string>(computation_name, "gpu_device"));
 
                 DEBUG(10, tiramisu::str_dump("The full list of tagged statements is now"));
                 for (const auto &ts: tagged_stmts)
@@ -2354,6 +2904,40 @@ tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, is
             comp->create_halide_assignment();
             result = comp->get_generated_halide_stmt();
 
+            // Issue the software prefetches of the computation before it.
+            if (!comp->prefetch_index_expr.empty())
+            {
+                for (const auto &pf : comp->prefetch_index_expr[0])
+                {
+                    const auto &tiramisu_buffer = fct.get_buffers().find(pf.first)->second;
+
+                    std::vector<isl_ast_expr *> empty_index_expr;
+                    std::vector<Halide::Expr> strides_vector;
+                    Halide::Expr stride_expr = Halide::Expr(1);
+                    for (int i = 0; i < tiramisu_buffer->get_dim_sizes().size(); i++)
+                    {
+                        int dim_idx = tiramisu_buffer->get_dim_sizes().size() - i - 1;
+                        strides_vector.push_back(stride_expr);
+                        stride_expr = stride_expr * generator::halide_expr_from_tiramisu_expr(&fct, empty_index_expr, tiramisu_buffer->get_dim_sizes()[dim_idx], comp);
+                    }
+                    // The prefetch of a complex element starts at its real part
+                    int dims = get_accessed_dims(tiramisu_buffer);
+                    strides_vector.erase(strides_vector.begin(), strides_vector.end() - dims);
+                    Halide::Expr index = tiramisu::generator::linearize_access(dims, strides_vector, pf.second);
+
+                    Halide::Type type = halide_type_from_tiramisu_type(tiramisu_buffer->get_elements_type());
+                    Halide::Expr prefetch = Halide::Internal::Call::make(
+                            type, Halide::Internal::Call::prefetch,
+                            {Halide::Internal::Variable::make(Halide::Handle(), tiramisu_buffer->get_name()), index, 1, 1},
+                            Halide::Internal::Call::Intrinsic);
+
+                    DEBUG(3, tiramisu::str_dump("Generated prefetch: "); std::cout << prefetch);
+
+                    result = Halide::Internal::Block::make(Halide::Internal::Evaluate::make(prefetch), result);
+                }
+                comp->prefetch_index_expr.erase(comp->prefetch_index_expr.begin());
+            }
+
 
             for (const auto &l_stmt : comp->get_associated_let_stmts())
             {
@@ -2392,6 +2976,11 @@ tiramisu::generator::halide_stmt_from_isl_node(const tiramisu::function &fct, is
                 result = Halide::Internal::IfThenElse::make(predicate, if_s, else_s);
                 DEBUG(10, tiramisu::str_dump("The predicated statement is "); std::cout << result);
             }
+
+            // Mark the statement so that it can be moved to the inspector
+            // (see generator::split_inspector()).
+            if (comp->is_inspector())
+                result = Halide::Internal::LetStmt::make(INSPECTOR_MARKER, 0, result);
         }
     }
     else if (isl_ast_node_get_type(node) == isl_ast_node_if)
@@ -2483,87 +3072,207 @@ void function::gen_halide_stmt()
     // Generate the statement that represents the whole function
     stmt = tiramisu::generator::halide_stmt_from_isl_node(*this, this->get_isl_ast(), 0, generated_stmts, false);
 
-    DEBUG(3, tiramisu::str_dump("The following Halide statement was generated:\n"); std::cout << stmt << std::endl);
+    bool has_inspector = false;
+    for (const auto &comp : this->get_computations())
+        has_inspector = has_inspector || comp->is_inspector();
+
+    bool has_vector_reduction = false;
+    for (const auto &comp : this->get_computations())
+        has_vector_reduction = has_vector_reduction || comp->is_vector_reduction();
+
+    if (has_vector_reduction)
+        stmt = generator::mark_vector_reductions(stmt);
 
-    Halide::Internal::Stmt freestmts;
+    std::map<std::string, int> interleaved_buffers;
     for (const auto &b : this->get_buffers())
+        if (b.second->get_interleaved_channels() > 0)
+            interleaved_buffers[b.first] = b.second->get_interleaved_channels();
+
+    if (!interleaved_buffers.empty())
+        stmt = generator::unroll_interleaved_channels(stmt, interleaved_buffers);
+
+    // Move the inspector computations to their own statement
+    this->inspector_halide_stmt = Halide::Internal::Stmt();
+    if (has_inspector)
+    {
+        this->inspector_halide_stmt = generator::split_inspector(stmt, true);
+        stmt = generator::split_inspector(stmt, false);
+    }
+
+    // Keep the accumulations of the innermost loops in registers
+    stmt = generator::promote_reductions_to_registers(stmt);
+
+    // Wait for the copies and kernels issued on CUDA streams before returning
+    if (!this->gpu_streams.empty())
+        stmt = Halide::Internal::Block::make(stmt, Halide::Internal::Evaluate::make(
+                Halide::Internal::Call::make(Halide::Int(32), "tiramisu_cuda_stream_synchronize",
+                                             {Halide::Expr(0)}, Halide::Internal::Call::Extern)));
+
+    DEBUG(3, tiramisu::str_dump("The following Halide statement was generated:\n"); std::cout << stmt << std::endl);
+
+    // Since host code is not replayed by a CUDA graph, everything must be on the GPU
+    if (this->use_cuda_graph)
     {
-        tiramisu::buffer *buf = b.second;
-        if (buf->get_argument_type() == tiramisu::a_temporary && buf->get_auto_allocate() == true && (buf->location == cuda_ast::memory_location::global))
+        if (!this->gpu_device_dimensions.empty())
+            ERROR("A function distributed across several GPUs cannot be captured in a CUDA graph.", true);
+
+        for (const auto &b : this->get_buffers())
+            if (b.second->get_argument_type() == tiramisu::a_temporary && b.second->get_auto_allocate()
+                    && b.second->location == cuda_ast::memory_location::host)
+                ERROR("The host temporary buffer " + b.first + " cannot be used in a function captured in a CUDA graph.", true);
+
+        for (const auto &comp : this->get_computations())
         {
-            auto free = generator::make_buffer_free(buf);
-            if (freestmts.defined())
-                freestmts = Halide::Internal::Block::make(free, freestmts);
-            else
-                freestmts = free;
+            const tiramisu::expr &e = comp->get_expr();
+            if (!e.is_defined() || comp->is_let_stmt() || !comp->should_schedule_this_computation())
+                continue;
+            bool on_gpu = (e.get_expr_type() == tiramisu::e_op) &&
+                          (e.get_op_type() == tiramisu::o_memcpy || e.get_op_type() == tiramisu::o_call ||
+                           e.get_op_type() == tiramisu::o_allocate || e.get_op_type() == tiramisu::o_free);
+            for (const auto &dims : this->gpu_block_dimensions)
+                on_gpu = on_gpu || (dims.first == comp->get_name());
+            if (!on_gpu)
+                ERROR("The host computation " + comp->get_name() + " cannot be captured in a CUDA graph.", true);
         }
     }
 
-    if (freestmts.defined())
-        stmt = Halide::Internal::Block::make(stmt, freestmts);
+    // Allocate the temporary buffers and compute the invariants around the
+    // body of a function.  The temporary buffers of the inspector are not carved
+    // from the workspace, whose size is that of the executor, and the inspector
+    // is not captured in a CUDA graph.
+    auto wrap_function_body = [&](Halide::Internal::Stmt stmt, bool executor) {
+        Halide::Internal::Stmt freestmts;
+        for (const auto &b : this->get_buffers())
+        {
+            tiramisu::buffer *buf = b.second;
+            if (buf->get_argument_type() == tiramisu::a_temporary && buf->get_auto_allocate() == true && (buf->location == cuda_ast::memory_location::global))
+            {
+                auto free = generator::make_buffer_free(buf);
+                if (freestmts.defined())
+                    freestmts = Halide::Internal::Block::make(free, freestmts);
+                else
+                    freestmts = free;
+            }
+        }
+
+        if (freestmts.defined())
+            stmt = Halide::Internal::Block::make(stmt, freestmts);
 
-    // Allocate buffers that are not passed as an argument to the function
-    for (const auto &b : this->get_buffers())
-    {
-        tiramisu::buffer *buf = b.second;
-        // Allocate only arrays that are not passed to the function as arguments.
-        if (buf->get_argument_type() == tiramisu::a_temporary && buf->get_auto_allocate() == true)
+        // Allocate buffers that are not passed as an argument to the function
+        for (const auto &b : this->get_buffers())
         {
-            std::vector<Halide::Expr> halide_dim_sizes;
-            // Create a vector indicating the size that should be allocated.
-            // Tiramisu buffer is defined from outermost to innermost, whereas Halide is from
-            // innermost to outermost; thus, we need to reverse the order.
-            for (int i = buf->get_dim_sizes().size() - 1; i >= 0; --i)
+            tiramisu::buffer *buf = b.second;
+            // Allocate only arrays that are not passed to the function as arguments.
+            if (buf->get_argument_type() == tiramisu::a_temporary && buf->get_auto_allocate() == true)
             {
-                const auto sz = buf->get_dim_sizes()[i];
-                std::vector<isl_ast_expr *> ie = {};
-                halide_dim_sizes.push_back(generator::halide_expr_from_tiramisu_expr(this, ie, sz));
+                std::vector<Halide::Expr> halide_dim_sizes;
+                // Create a vector indicating the size that should be allocated.
+                // Tiramisu buffer is defined from outermost to innermost, whereas Halide is from
+                // innermost to outermost; thus, we need to reverse the order.
+                for (int i = buf->get_dim_sizes().size() - 1; i >= 0; --i)
+                {
+                    const auto sz = buf->get_dim_sizes()[i];
+                    std::vector<isl_ast_expr *> ie = {};
+                    halide_dim_sizes.push_back(generator::halide_expr_from_tiramisu_expr(this, ie, sz));
+                }
+                stmt = generator::make_buffer_alloc(buf, halide_dim_sizes, stmt);
+//                stmt = Halide::Internal::Allocate::make(
+//                           buf->get_name(),
+//                           halide_type_from_tiramisu_type(buf->get_elements_type()),
+//                           halide_dim_sizes, Halide::Internal::const_true(), stmt);
+
+                buf->mark_as_allocated();
             }
-            stmt = generator::make_buffer_alloc(buf, halide_dim_sizes, stmt);
-//            stmt = Halide::Internal::Allocate::make(
-//                       buf->get_name(),
-//                       halide_type_from_tiramisu_type(buf->get_elements_type()),
-//                       halide_dim_sizes, Halide::Internal::const_true(), stmt);
+        }
+
+        if (this->use_buffer_arena && executor)
+        {
+            stmt = generator::carve_buffers_from_arena(*this, stmt);
 
-            buf->mark_as_allocated();
+            if (this->buffer_arena_size > 0)
+                stmt = Halide::Internal::Allocate::make(
+                        this->get_buffer_arena_name(), Halide::UInt(8), Halide::MemoryType::Heap,
+                        {Halide::Expr(static_cast<int32_t>(this->buffer_arena_size))},
+                        Halide::Internal::const_true(), stmt);
         }
-    }
 
-    const auto &invariant_vector = this->get_invariants();
+        // The allocations are captured as well, so that the graph keeps its buffers
+        if (this->use_cuda_graph && executor)
+            stmt = generator::make_cuda_graph_guard(*this, stmt);
+
+        // Install the do_par_for of the backend for the duration of the call
+        if (this->parallel_backend != tiramisu::parallel_halide && executor)
+        {
+            std::string previous = "_" + this->get_name() + "_previous_do_par_for";
+            Halide::Expr begin = Halide::Internal::Call::make(
+                    Halide::type_of<void *>(), "tiramisu_parallel_backend_begin",
+                    {Halide::Expr(static_cast<int32_t>(this->parallel_backend)),
+                     Halide::Expr(static_cast<int32_t>(this->parallel_chunk_size))},
+                    Halide::Internal::Call::Extern);
+            Halide::Internal::Stmt end = Halide::Internal::Evaluate::make(Halide::Internal::Call::make(
+                    Halide::Int(32), "tiramisu_parallel_backend_end",
+                    {Halide::Internal::Variable::make(Halide::type_of<void *>(), previous)},
+                    Halide::Internal::Call::Extern));
+            stmt = Halide::Internal::LetStmt::make(previous, begin, Halide::Internal::Block::make(stmt, end));
+        }
+
+        const auto &invariant_vector = this->get_invariants();
+
+        // Generate the invariants of the function.
+        // Traverse the vector of invariants in reverse order (this because
+        // invariants are added at the beginning of the invariant vector so
+        // the first vector element actually should be visited last because
+        // it was added last).
+        // We need to do this because usually for vectorization, the separation
+        // invariant which is an expression that uses the loop parameters needs
+        // to come after the initialization of those parameters, that is, it should
+        // come last (when we are sure all the other parameters are already
+        // initialized).
+        for (int i = invariant_vector.size() - 1; i >= 0; i--)
+        {
+            const auto &param = invariant_vector[i]; // Get the i'th invariant
+            std::vector<isl_ast_expr *> ie = {};
+            stmt = Halide::Internal::LetStmt::make(
+                    param.get_name(),
+                    generator::halide_expr_from_tiramisu_expr(this, ie, param.get_expr()),
+                    stmt);
+        }
+
+        if (this->_needs_rank_call) {
+            // add a call to MPI rank to the beginning of the function
+            Halide::Expr mpi_rank_var =
+                    Halide::Internal::Variable::make(halide_type_from_tiramisu_type(tiramisu::p_int32), "rank");
+            Halide::Expr mpi_rank = Halide::cast(halide_type_from_tiramisu_type(global::get_loop_iterator_data_type()),
+                                                 Halide::Internal::Call::make(Halide::Int(32), "tiramisu_MPI_Comm_rank",
+                                                                              {this->rank_offset},
+                                                                              Halide::Internal::Call::Extern));
+            stmt = Halide::Internal::LetStmt::make("rank", mpi_rank, stmt);
+        }
+
+        // Add producer tag
+        stmt = Halide::Internal::ProducerConsumer::make_produce("", stmt);
+
+        return stmt;
+    };
 
-    // Generate the invariants of the function.
-    // Traverse the vector of invariants in reverse order (this because
-    // invariants are added at the beginning of the invariant vector so
-    // the first vector element actually should be visited last because
-    // it was added last).
-    // We need to do this because usually for vectorization, the separation
-    // invariant which is an expression that uses the loop parameters needs
-    // to come after the initialization of those parameters, that is, it should
-    // come last (when we are sure all the other parameters are already
-    // initialized).
-    for (int i = invariant_vector.size() - 1; i >= 0; i--)
+    stmt = wrap_function_body(stmt, true);
+
+    if (has_inspector)
     {
-        const auto &param = invariant_vector[i]; // Get the i'th invariant
-        std::vector<isl_ast_expr *> ie = {};
-        stmt = Halide::Internal::LetStmt::make(
-                param.get_name(),
-                generator::halide_expr_from_tiramisu_expr(this, ie, param.get_expr()),
-                stmt);
-    }
+        Halide::Internal::Stmt inspector = generator::promote_reductions_to_registers(this->inspector_halide_stmt);
+        this->inspector_halide_stmt = wrap_function_body(inspector, false);
 
-    if (this->_needs_rank_call) {
-        // add a call to MPI rank to the beginning of the function
-        Halide::Expr mpi_rank_var =
-                Halide::Internal::Variable::make(halide_type_from_tiramisu_type(tiramisu::p_int32), "rank");
-        Halide::Expr mpi_rank = Halide::cast(halide_type_from_tiramisu_type(global::get_loop_iterator_data_type()),
-                                             Halide::Internal::Call::make(Halide::Int(32), "tiramisu_MPI_Comm_rank",
-                                                                          {this->rank_offset},
-                                                                          Halide::Internal::Call::Extern));
-        stmt = Halide::Internal::LetStmt::make("rank", mpi_rank, stmt);
+        DEBUG(3, tiramisu::str_dump("\n\nGenerated Halide stmt of the inspector before lowering:"));
+        DEBUG(3, std::cout << this->inspector_halide_stmt);
     }
 
-    // Add producer tag
-    stmt = Halide::Internal::ProducerConsumer::make_produce("", stmt);
+    this->mapped_halide_stmt = Halide::Internal::Stmt();
+    for (const auto &buf : this->function_arguments)
+        if (buf->is_mapped_file())
+        {
+            this->mapped_halide_stmt = generator::map_buffers_from_files(*this, stmt);
+            break;
+        }
 
     this->halide_stmt = stmt;
 
@@ -2577,7 +3286,25 @@ Halide::Internal::Stmt generator::make_buffer_alloc(buffer *b, const std::vector
                                                     Halide::Internal::Stmt &stmt) {
     using cuda_ast::memory_location;
     auto h_type = halide_type_from_tiramisu_type(b->get_elements_type());
-    if (b->location == memory_location::host)
+    if (b->location == memory_location::host && b->get_numa_placement() != tiramisu::numa_default)
+    {
+        Halide::Expr size = Halide::cast(Halide::UInt(64), extents[0]);
+        for (int i = 1; i < extents.size(); i++)
+        {
+            size = size * Halide::cast(Halide::UInt(64), extents[i]);
+        }
+
+        Halide::Expr numa_alloc = Halide::Internal::Call::make(
+                Halide::type_of<void *>(), "tiramisu_numa_malloc",
+                {size * h_type.bytes(), Halide::Expr(static_cast<int32_t>(b->get_numa_placement())),
+                 Halide::Expr(static_cast<int32_t>(b->get_numa_node()))},
+                Halide::Internal::Call::Extern);
+
+        return Halide::Internal::Allocate::make(
+                b->get_name(), h_type, Halide::MemoryType::Heap, extents, Halide::Internal::const_true(), stmt,
+                numa_alloc, "tiramisu_numa_free");
+    }
+    else if (b->location == memory_location::host)
       {//Note: When this was created originally, Halide didn't have a memory type, but now it does - I think setting this to heap best resembles the old semantics
       return Halide::Internal::Allocate::make(
                 b->get_name(),
@@ -2593,12 +3320,17 @@ Halide::Internal::Stmt generator::make_buffer_alloc(buffer *b, const std::vector
             size = size * extents[i];
         }
 	//This should potentially be something else
-        return Halide::Internal::LetStmt::make(
-                b->get_name(),
-                Halide::Internal::Call::make(Halide::type_of<void *>(), "tiramisu_cuda_malloc",
-                                             {Halide::cast(Halide::UInt(64), size * h_type.bytes())}, Halide::Internal::Call::Extern),
-                stmt
-        );
+        Halide::Expr bytes = Halide::cast(Halide::UInt(64), size * h_type.bytes());
+        Halide::Expr alloc = (b->get_gpu_partitions() > 0)
+                ? Halide::Internal::Call::make(Halide::type_of<void *>(), "tiramisu_cuda_malloc_partitioned",
+                                               {bytes, Halide::Expr(b->get_gpu_partitions())}, Halide::Internal::Call::Extern)
+                : b->is_gpu_managed()
+                ? Halide::Internal::Call::make(Halide::type_of<void *>(), "tiramisu_cuda_malloc_managed",
+                                               {bytes, Halide::Expr(static_cast<int32_t>(b->get_gpu_managed_advice()))},
+                                               Halide::Internal::Call::Extern)
+                : Halide::Internal::Call::make(Halide::type_of<void *>(), "tiramisu_cuda_malloc",
+                                               {bytes}, Halide::Internal::Call::Extern);
+        return Halide::Internal::LetStmt::make(b->get_name(), alloc, stmt);
 
     }
 
@@ -2606,39 +3338,1686 @@ Halide::Internal::Stmt generator::make_buffer_alloc(buffer *b, const std::vector
 
 }
 
-isl_ast_node *for_code_generator_after_for(isl_ast_node *node, isl_ast_build *build, void *user)
+void function::enable_buffer_arena(bool enable)
 {
-    return node;
+    this->use_buffer_arena = enable;
 }
 
-/**
-  * Linearize a multidimensional access to a Halide buffer.
-  * Supposing that we have buf[N1][N2][N3], transform buf[i][j][k]
-  * into buf[k + j*N3 + i*N3*N2].
-  * Note that the first arg in index_expr is the buffer name.  The other args
-  * are the indices for each dimension of the buffer.
-  */
+void function::enable_cuda_graph(bool enable)
+{
+    this->use_cuda_graph = enable;
+}
 
+void function::enable_full_tile_separation(bool enable)
+{
+    this->separate_full_tiles = enable;
+}
 
-static inline Halide::Expr empty_index()
+void function::set_ast_build_flags(bool atomic_upper_bound, bool detect_min_max, bool allow_else)
 {
-    if (global::get_loop_iterator_data_type() == p_int32)
-        return Halide::Expr(static_cast<int32_t >(0));
-    else
-        return Halide::Expr(static_cast<int64_t >(0));
+    this->ast_atomic_upper_bound = atomic_upper_bound;
+    this->ast_detect_min_max = detect_min_max;
+    this->ast_allow_else = allow_else;
 }
 
-Halide::Expr generator::linearize_access(int dims, const halide_dimension_t *shape, isl_ast_expr *index_expr)
+void function::enable_compile_time_report(bool enable)
 {
-    assert(isl_ast_expr_get_op_n_arg(index_expr) > 1);
+    this->report_compile_times = enable;
+}
 
-    DEBUG_FCT_NAME(3);
-    DEBUG_INDENT(4);
+void function::enable_profiling(bool enable)
+{
+    this->profile_loop_nests = enable;
+}
 
-    // ISL dimension is ordered from outermost to innermost.
+void function::enable_batching(bool enable)
+{
+    this->generate_batched_entry_point = enable;
+}
+
+void function::enable_raw_entry_point(bool enable)
+{
+    this->generate_raw_entry_point = enable;
+}
+
+void function::set_parallel_backend(tiramisu::parallel_backend_t backend, int chunk_size)
+{
+    assert(chunk_size >= 0);
+
+    this->parallel_backend = backend;
+    this->parallel_chunk_size = chunk_size;
+}
+
+void function::set_gpu_launch_bounds(int min_blocks_per_multiprocessor)
+{
+    assert(min_blocks_per_multiprocessor >= 0);
+
+    this->gpu_launch_bounds_min_blocks = min_blocks_per_multiprocessor;
+}
+
+void function::set_gpu_coalescing_remap(bool remap)
+{
+    this->gpu_coalescing_remap = remap;
+}
+
+void function::enable_gpu_buffer_placement(int64_t constant_memory_bytes)
+{
+    assert(constant_memory_bytes >= 0);
+
+    this->gpu_constant_memory_bytes = constant_memory_bytes;
+}
+
+std::vector<cuda_ast::kernel_resources> function::get_gpu_kernel_resources() const
+{
+    if (!this->nvcc_compiler)
+        return {};
+    return this->nvcc_compiler->get_kernel_resources();
+}
+
+void function::start_compile_phase(tiramisu_timer &timer, unsigned long &isl_operations) const
+{
+    isl_operations = isl_ctx_get_operations(this->get_isl_ctx());
+    timer.start();
+}
+
+namespace
+{
+    // A phase of code generation (see function::report_compile_time())
+    struct compile_trace_event
+    {
+        std::string function_name;
+        std::string phase;
+        double start;
+        double duration;
+        unsigned long isl_operations;
+    };
+
+    const std::chrono::system_clock::time_point compile_trace_origin = std::chrono::system_clock::now();
+    std::vector<compile_trace_event> compile_trace;
+
+    // The trace is rewritten after each phase so that it is complete even
+    // if code generation fails later
+    void write_compile_trace(const std::string &file_name)
+    {
+        std::ofstream trace(file_name, std::ios::trunc);
+        trace << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        for (size_t i = 0; i < compile_trace.size(); i++)
+        {
+            const compile_trace_event &event = compile_trace[i];
+            trace << "  {\"name\": \"" << event.phase << "\", \"cat\": \"" << event.function_name
+                  << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0, \"ts\": " << (int64_t) event.start
+                  << ", \"dur\": " << (int64_t) event.duration
+                  << ", \"args\": {\"function\": \"" << event.function_name
+                  << "\", \"isl_operations\": " << event.isl_operations << "}}"
+                  << ((i + 1 < compile_trace.size()) ? ",\n" : "\n");
+        }
+        trace << "]}\n";
+    }
+}
+
+void function::report_compile_time(const std::string &phase, tiramisu_timer &timer, unsigned long &isl_operations) const
+{
+    timer.stop();
+    unsigned long operations = isl_ctx_get_operations(this->get_isl_ctx()) - isl_operations;
+    std::chrono::duration<double, std::micro> start = timer.start_timing - compile_trace_origin;
+    std::chrono::duration<double, std::micro> duration = timer.end_timing - timer.start_timing;
+
+    if (this->report_compile_times || getenv("TIRAMISU_COMPILE_TIME_REPORT"))
+        std::cout << "Compile time of " << this->get_name() << ", " << phase << ": "
+                  << duration.count() / 1000 << " ms, " << operations << " isl operations" << std::endl;
+
+    if (getenv("TIRAMISU_COMPILE_TRACE"))
+    {
+        compile_trace.push_back({this->get_name(), phase, start.count(), duration.count(), operations});
+        write_compile_trace(getenv("TIRAMISU_COMPILE_TRACE"));
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    this->compile_phases.push_back({phase, duration.count() / 1000, operations, usage.ru_maxrss});
+
+    this->start_compile_phase(timer, isl_operations);
+}
+
+const std::vector<tiramisu::compile_phase> &function::get_compile_phases() const
+{
+    return this->compile_phases;
+}
+
+void function::add_target_feature(Halide::Target::Feature feature)
+{
+    this->target_features.push_back(feature);
+}
+
+void function::set_target(const Halide::Target &target)
+{
+    this->halide_target = target;
+}
+
+Halide::Target function::get_target() const
+{
+    Halide::Target target = this->halide_target;
+    if (target.arch == Halide::Target::ArchUnknown)
+    {
+        Halide::Target host = Halide::get_host_target();
+        target = Halide::Target(host.os, host.arch, host.bits);
+        if (host.arch == Halide::Target::X86)
+            target = target.with_feature(Halide::Target::AVX).with_feature(Halide::Target::SSE41);
+    }
+
+    target.set_feature(Halide::Target::LargeBuffers);
+    for (const auto &feature : this->target_features)
+        target.set_feature(feature);
+
+    return target;
+}
+
+int function::get_default_vector_length(tiramisu::primitive_t type) const
+{
+    return this->get_target().natural_vector_size(halide_type_from_tiramisu_type(type));
+}
+
+int64_t function::get_buffer_arena_size() const
+{
+    return this->buffer_arena_size;
+}
+
+std::string function::get_buffer_arena_name() const
+{
+    return "_" + this->get_name() + "_workspace";
+}
+
+namespace
+{
+
+/**
+  * Give to each eligible allocation a slot of the workspace (see
+  * generator::carve_buffers_from_arena()).
+  */
+class buffer_arena_allocator : public Halide::Internal::IRMutator
+{
+    using Halide::Internal::IRMutator::visit;
+
+    const tiramisu::function &fct;
+    int parallel_depth = 0;
+
+    Halide::Internal::Stmt visit(const Halide::Internal::For *op) override
+    {
+        bool parallel = (op->for_type == Halide::Internal::ForType::Parallel);
+
+        parallel_depth += parallel;
+        Halide::Internal::Stmt stmt = Halide::Internal::IRMutator::visit(op);
+        parallel_depth -= parallel;
+
+        return stmt;
+    }
+
+    Halide::Internal::Stmt visit(const Halide::Internal::Allocate *op) override
+    {
+        Halide::Internal::Stmt body = mutate(op->body);
+
+        auto buff_it = fct.get_buffers().find(op->name);
+        bool eligible = (parallel_depth == 0) && !op->new_expr.defined() &&
+                        (op->memory_type == Halide::MemoryType::Heap) &&
+                        (buff_it != fct.get_buffers().end()) &&
+                        (buff_it->second->get_argument_type() == tiramisu::a_temporary) &&
+                        (buff_it->second->get_location() == cuda_ast::memory_location::host);
+
+        int64_t size = op->type.bytes();
+        for (const auto &extent : op->extents)
+        {
+            const int64_t *constant_extent = Halide::Internal::as_const_int(extent);
+
+            if (constant_extent == nullptr)
+                eligible = false;
+            else
+                size *= *constant_extent;
+        }
+
+        if (!eligible)
+            return Halide::Internal::Allocate::make(op->name, op->type, op->memory_type, op->extents,
+                                                    op->condition, body, op->new_expr, op->free_function);
+
+        // A buffer is given a single slot, even if it is allocated at several places
+        if (offsets.find(op->name) == offsets.end())
+        {
+            int64_t alignment = std::max(TIRAMISU_BUFFER_ARENA_ALIGNMENT, buff_it->second->get_alignment());
+
+            offsets[op->name] = (arena_size + alignment - 1) / alignment * alignment;
+            arena_size = offsets[op->name] + size;
+        }
+
+        Halide::Expr slot = Halide::Internal::Call::make(
+                Halide::Handle(), Halide::Internal::Call::address_of,
+                {Halide::Internal::Load::make(Halide::UInt(8), fct.get_buffer_arena_name(),
+                                              Halide::Expr(static_cast<int32_t>(offsets[op->name])),
+                                              Halide::Buffer<>(), Halide::Internal::Parameter(),
+                                              Halide::Internal::const_true(), Halide::Internal::ModulusRemainder())},
+                Halide::Internal::Call::Intrinsic);
+
+        // The workspace is freed as a whole
+        return Halide::Internal::Allocate::make(op->name, op->type, op->memory_type, op->extents,
+                                                op->condition, body, slot, "halide_device_host_nop_free");
+    }
+
+public:
+    std::map<std::string, int64_t> offsets;
+    int64_t arena_size = 0;
+
+    buffer_arena_allocator(const tiramisu::function &fct) : fct(fct) {}
+};
+
+/**
+  * Remove the allocation of a buffer (keep the statements where it is used).
+  */
+class allocation_remover : public Halide::Internal::IRMutator
+{
+    using Halide::Internal::IRMutator::visit;
+
+    std::string name;
+
+    Halide::Internal::Stmt visit(const Halide::Internal::Allocate *op) override
+    {
+        if (op->name == name)
+            return mutate(op->body);
+
+        return Halide::Internal::IRMutator::visit(op);
+    }
+
+public:
+    allocation_remover(const std::string &name) : name(name) {}
+};
+
+/**
+  * Check that the statement of a function does not use the descriptors of
+  * its arguments, which the entry point NAME_raw does not have (see
+  * function::enable_raw_entry_point()).
+  */
+class buffer_descriptor_checker : public Halide::Internal::IRVisitor
+{
+    using Halide::Internal::IRVisitor::visit;
+
+    std::set<std::string> descriptors;
+
+    void visit(const Halide::Internal::Variable *op) override
+    {
+        if (descriptors.count(op->name) > 0)
+            ERROR("The buffer " + op->name.substr(0, op->name.size() - std::string(".buffer").size()) +
+                  " is used through its descriptor (e.g. passed to an external call or copied to a GPU), " +
+                  "the raw entry point cannot be generated.", true);
+    }
+
+public:
+    buffer_descriptor_checker(const std::vector<tiramisu::buffer *> &arguments)
+    {
+        for (const auto &buf : arguments)
+            descriptors.insert(buf->get_name() + ".buffer");
+    }
+};
+
+/**
+  * Write the header \p file_name, with the typed C++ wrapper of the entry
+  * point NAME_raw of the function \p name, of arguments \p arguments (see
+  * function::enable_raw_entry_point()).  \p halide_header is the header of
+  * the entry points generated by Halide.
+  */
+static void write_raw_entry_point_header(const std::string &name, const std::vector<tiramisu::buffer *> &arguments,
+                                         const std::string &file_name, const std::string &halide_header)
+{
+    std::string guard = "TIRAMISU_RAW_" + name + "_H";
+    std::transform(guard.begin(), guard.end(), guard.begin(), ::toupper);
+
+    std::string parameters, call_arguments, sizes;
+    for (const auto &buf : arguments)
+    {
+        tiramisu::primitive_t type = buf->get_elements_type();
+        std::string c_type = (type == tiramisu::p_float16 || type == tiramisu::p_bfloat16) ? "uint16_t" :
+                             (type == tiramisu::p_complex64 || type == tiramisu::p_complex128) ? "void" :
+                             tiramisu::cuda_ast::tiramisu_type_to_cuda_type(type);
+        std::string dims;
+        for (const auto &size : buf->get_dim_sizes())
+            dims += "[" + std::to_string(size.get_int_val()) + "]";
+
+        bool input = (buf->get_argument_type() == tiramisu::a_input);
+        parameters += std::string(parameters.empty() ? "" : ", ") + (input ? "const " : "") + c_type + " *" + buf->get_name();
+        call_arguments += std::string(call_arguments.empty() ? "" : ", ") + "(void *) " + buf->get_name();
+        sizes += " * " + buf->get_name() + ": " + (input ? "input" : "output") + " " + c_type + dims + "\n";
+    }
+
+    std::ofstream file(file_name);
+    if (!file)
+        ERROR("Cannot write the header " + file_name + ".", true);
+
+    file << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+         << "#include <stdint.h>\n#include \"" << halide_header << "\"\n\n"
+         << "namespace tiramisu_raw\n{\n\n"
+         << "/**\n * Call " << name << " with raw pointers to dense row-major arrays\n"
+         << " * (nothing is checked):\n" << sizes << " */\n"
+         << "inline int " << name << "(" << parameters << ")\n{\n"
+         << "    return ::" << name << "_raw(" << call_arguments << ");\n}\n\n"
+         << "}\n\n#endif\n";
+}
+
+/**
+  * Offset the accesses to the arguments of a function by the element of the
+  * batch processed by the current iteration of the batch loop (see
+  * function::enable_batching()).
+  */
+class batch_offsetter : public Halide::Internal::IRMutator
+{
+    using Halide::Internal::IRMutator::visit;
+
+    std::map<std::string, Halide::Expr> offsets;
+
+    Halide::Expr offset_index(const std::string &name, const Halide::Expr &index)
+    {
+        Halide::Expr offset = Halide::cast(index.type().element_of(), offsets.at(name));
+        if (index.type().is_vector())
+            offset = Halide::Internal::Broadcast::make(offset, index.type().lanes());
+
+        return index + offset;
+    }
+
+    Halide::Expr visit(const Halide::Internal::Load *op) override
+    {
+        if (offsets.count(op->name) == 0)
+            return Halide::Internal::IRMutator::visit(op);
+
+        return Halide::Internal::Load::make(op->type, op->name, offset_index(op->name, mutate(op->index)),
+                                            op->image, op->param, mutate(op->predicate),
+                                            Halide::Internal::ModulusRemainder());
+    }
+
+    Halide::Internal::Stmt visit(const Halide::Internal::Store *op) override
+    {
+        if (offsets.count(op->name) == 0)
+            return Halide::Internal::IRMutator::visit(op);
+
+        return Halide::Internal::Store::make(op->name, mutate(op->value), offset_index(op->name, mutate(op->index)),
+                                             op->param, mutate(op->predicate), Halide::Internal::ModulusRemainder());
+    }
+
+    Halide::Expr visit(const Halide::Internal::Variable *op) override
+    {
+        // The whole buffer would be given to the callee, instead of the element of the batch
+        for (const auto &offset : offsets)
+            if (op->name == offset.first + ".buffer")
+                ERROR("The buffer " + offset.first + " is passed to an external call, it cannot be batched.", true);
+
+        return Halide::Internal::IRMutator::visit(op);
+    }
+
+public:
+    /**
+      * \p batch is the iterator of the batch loop, and the batch is the
+      * outermost dimension of the arguments of \p fct.
+      */
+    batch_offsetter(const tiramisu::function &fct, const Halide::Expr &batch)
+    {
+        for (const auto &buf : fct.get_arguments())
+        {
+            Halide::Expr buffer_var = Halide::Internal::Variable::make(Halide::type_of<struct halide_buffer_t *>(),
+                                                                       buf->get_name() + ".buffer");
+            Halide::Expr stride = Halide::Internal::Call::make(Halide::Int(32), Halide::Internal::Call::buffer_get_stride,
+                                                               {buffer_var, buf->get_n_dims()},
+                                                               Halide::Internal::Call::Extern);
+            offsets[buf->get_name()] = Halide::cast(Halide::Int(64), batch) * Halide::cast(Halide::Int(64), stride);
+        }
+    }
+};
+
+/**
+  * Add the waits and the posts of a doacross loop (see
+  * generator::make_doacross_loop()) around the iterations of the loops
+  * at the top of the body of the doacross loop.
+  */
+class doacross_synchronizer : public Halide::Internal::IRMutator
+{
+    using Halide::Internal::IRMutator::visit;
+
+    Halide::Expr previous_counter, current_counter;
+    Halide::Expr is_first_iteration;
+    int distance;
+
+    Halide::Internal::Stmt visit(const Halide::Internal::For *op) override
+    {
+        nb_loops++;
+
+        Halide::Expr j = Halide::Internal::Variable::make(Halide::Int(32), op->name);
+
+        Halide::Internal::Stmt wait = Halide::Internal::IfThenElse::make(
+                !is_first_iteration,
+                Halide::Internal::Evaluate::make(Halide::Internal::Call::make(
+                        Halide::Int(32), "tiramisu_doacross_wait", {previous_counter, j + distance},
+                        Halide::Internal::Call::Extern)));
+
+        Halide::Internal::Stmt post = Halide::Internal::Evaluate::make(Halide::Internal::Call::make(
+                Halide::Int(32), "tiramisu_doacross_post", {current_counter, j + 1},
+                Halide::Internal::Call::Extern));
+
+        // The loops nested in this loop are left untouched
+        return Halide::Internal::For::make(op->name, op->min, op->extent, op->for_type, op->device_api,
+                                           Halide::Internal::Block::make({wait, op->body, post}));
+    }
+
+public:
+    int nb_loops = 0;
+
+    doacross_synchronizer(const Halide::Expr &previous_counter, const Halide::Expr &current_counter,
+                          const Halide::Expr &is_first_iteration, int distance)
+        : previous_counter(previous_counter), current_counter(current_counter),
+          is_first_iteration(is_first_iteration), distance(distance) {}
+};
+
+/**
+  * Gather the accesses to each buffer in a loop body, and what prevents
+  * keeping them in a register (see generator::promote_reductions_to_registers()).
+  */
+class loop_body_accesses : public Halide::Internal::IRVisitor
+{
+    using Halide::Internal::IRVisitor::visit;
+
+    int address_of_depth = 0;
+
+    void visit(const Halide::Internal::Load *op) override
+    {
+        access &a = accesses[op->name];
+        a.indices.push_back(op->index);
+        a.types.push_back(op->type);
+        if (address_of_depth > 0 || !Halide::Internal::is_const_one(op->predicate))
+            a.escapes = true;
+        if (!a.load.defined())
+            a.load = op;
+        Halide::Internal::IRVisitor::visit(op);
+    }
+
+    void visit(const Halide::Internal::Store *op) override
+    {
+        access &a = accesses[op->name];
+        a.indices.push_back(op->index);
+        a.types.push_back(op->value.type());
+        if (!Halide::Internal::is_const_one(op->predicate))
+            a.escapes = true;
+        a.stored = true;
+        a.param = op->param;
+        Halide::Internal::IRVisitor::visit(op);
+    }
+
+    void visit(const Halide::Internal::Call *op) override
+    {
+        if (op->is_intrinsic(Halide::Internal::Call::address_of))
+        {
+            address_of_depth++;
+            Halide::Internal::IRVisitor::visit(op);
+            address_of_depth--;
+            return;
+        }
+        if (op->call_type == Halide::Internal::Call::Extern ||
+            op->call_type == Halide::Internal::Call::ExternCPlusPlus)
+            has_side_effects = true;
+        Halide::Internal::IRVisitor::visit(op);
+    }
+
+    void visit(const Halide::Internal::Variable *op) override
+    {
+        referenced.insert(op->name);
+    }
+
+    void visit(const Halide::Internal::LetStmt *op) override
+    {
+        defined.insert(op->name);
+        Halide::Internal::IRVisitor::visit(op);
+    }
+
+    void visit(const Halide::Internal::Let *op) override
+    {
+        defined.insert(op->name);
+        Halide::Internal::IRVisitor::visit(op);
+    }
+
+    void visit(const Halide::Internal::For *op) override
+    {
+        defined.insert(op->name);
+        Halide::Internal::IRVisitor::visit(op);
+    }
+
+    void visit(const Halide::Internal::Allocate *op) override
+    {
+        defined.insert(op->name);
+        Halide::Internal::IRVisitor::visit(op);
+    }
+
+public:
+    struct access
+    {
+        std::vector<Halide::Expr> indices;
+        std::vector<Halide::Type> types;
+        Halide::Expr load;
+        Halide::Internal::Parameter param;
+        bool stored = false;
+        bool escapes = false;
+    };
+
+    std::map<std::string, access> accesses;
+    std::set<std::string> defined;
+    std::set<std::string> referenced;
+    bool has_side_effects = false;
+
+    /**
+      * Return true if all the accesses to \p name are scalar accesses to the
+      * same address, which does not change during the loop over \p iterator.
+      */
+    bool is_promotable(const std::string &name, const std::string &iterator) const
+    {
+        const access &a = accesses.at(name);
+
+        if (!a.stored || a.escapes || defined.count(name) > 0 ||
+            referenced.count(name) > 0 || referenced.count(name + ".buffer") > 0)
+            return false;
+
+        const Halide::Expr &index = a.indices[0];
+        if (index.type().lanes() != 1 || a.types[0].lanes() != 1)
+            return false;
+
+        for (int i = 1; i < a.indices.size(); i++)
+            if (!Halide::Internal::equal(a.indices[i], index) || a.types[i] != a.types[0])
+                return false;
+
+        if (Halide::Internal::expr_uses_var(index, iterator))
+            return false;
+        for (const auto &var : defined)
+            if (Halide::Internal::expr_uses_var(index, var))
+                return false;
+
+        return true;
+    }
+};
+
+/**
+  * Redirect the accesses to the buffer \p name to the scalar \p scalar.
+  */
+class access_redirector : public Halide::Internal::IRMutator
+{
+    using Halide::Internal::IRMutator::visit;
+
+    std::string name, scalar;
+    Halide::Expr index;
+
+    Halide::Expr visit(const Halide::Internal::Load *op) override
+    {
+        if (op->name != name)
+            return Halide::Internal::IRMutator::visit(op);
+
+        return Halide::Internal::Load::make(op->type, scalar, index, Halide::Buffer<>(), Halide::Internal::Parameter(),
+                                            Halide::Internal::const_true(), Halide::Internal::ModulusRemainder());
+    }
+
+    Halide::Internal::Stmt visit(const Halide::Internal::Store *op) override
+    {
+        if (op->name != name)
+            return Halide::Internal::IRMutator::visit(op);
+
+        return Halide::Internal::Store::make(scalar, mutate(op->value), index, Halide::Internal::Parameter(),
+                                             Halide::Internal::const_true(), Halide::Internal::ModulusRemainder());
+    }
+
+public:
+    /**
+      * Redirect the accesses to the element \p index of \p scalar instead.
+      */
+    access_redirector(const std::string &name, const std::string &scalar, const Halide::Expr &index = 0)
+        : name(name), scalar(scalar), index(index) {}
+};
+
+/**
+  * Promote the accumulations of the serial loops, innermost loops first
+  * (see generator::promote_reductions_to_registers()).
+  */
+class reduction_promoter : public Halide::Internal::IRMutator
+{
+    using Halide::Internal::IRMutator::visit;
+
+    Halide::Internal::Stmt visit(const Halide::Internal::For *op) override
+    {
+        Halide::Internal::Stmt body = mutate(op->body);
+
+        if (op->for_type != Halide::Internal::ForType::Serial)
+            return Halide::Internal::For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+
+        loop_body_accesses body_accesses;
+        body.accept(&body_accesses);
+
+        std::vector<std::string> promoted;
+        if (!body_accesses.has_side_effects)
+            for (const auto &a : body_accesses.accesses)
+                if (body_accesses.is_promotable(a.first, op->name))
+                    promoted.push_back(a.first);
+
+        for (const auto &name : promoted)
+            body = access_redirector(name, name + "_" + op->name + "_register").mutate(body);
+
+        Halide::Internal::Stmt result = Halide::Internal::For::make(op->name, op->min, op->extent, op->for_type,
+                                                                    op->device_api, body);
+        if (promoted.empty())
+            return result;
+
+        for (const auto &name : promoted)
+        {
+            const loop_body_accesses::access &a = body_accesses.accesses.at(name);
+            std::string scalar = name + "_" + op->name + "_register";
+            Halide::Type type = a.types[0];
+            const Halide::Expr &index = a.indices[0];
+
+            DEBUG(3, tiramisu::str_dump("Promoting the accesses to " + name + " in the loop " + op->name +
+                                        " to the register " + scalar));
+
+            Halide::Expr initial_value = a.load.defined() ? a.load :
+                    Halide::Internal::Load::make(type, name, index, Halide::Buffer<>(), a.param,
+                                                 Halide::Internal::const_true(), Halide::Internal::ModulusRemainder());
+            Halide::Expr final_value = Halide::Internal::Load::make(
+                    type, scalar, 0, Halide::Buffer<>(), Halide::Internal::Parameter(),
+                    Halide::Internal::const_true(), Halide::Internal::ModulusRemainder());
+
+            result = Halide::Internal::Block::make({
+                    Halide::Internal::Store::make(scalar, initial_value, 0, Halide::Internal::Parameter(),
+                                                  Halide::Internal::const_true(), Halide::Internal::ModulusRemainder()),
+                    result,
+                    Halide::Internal::Store::make(name, final_value, index, a.param,
+                                                  Halide::Internal::const_true(), Halide::Internal::ModulusRemainder())});
+            result = Halide::Internal::Allocate::make(scalar, type, Halide::MemoryType::Stack, {1},
+                                                      Halide::Internal::const_true(), result);
+        }
+
+        // The address may only be valid when the loop runs
+        if (!Halide::Internal::is_positive_const(op->extent))
+            result = Halide::Internal::IfThenElse::make(op->extent > 0, result);
+
+        return result;
+    }
+};
+
+/**
+  * Gather the values stored into the accumulator of a parallel reduction
+  * or scan, and their indices (see generator::make_parallel_reduction_loop()).
+  */
+class accumulator_updates : public Halide::Internal::IRVisitor
+{
+    using Halide::Internal::IRVisitor::visit;
+
+    const std::string &name;
+
+    void visit(const Halide::Internal::Store *op) override
+    {
+        if (op->name == name)
+        {
+            values.push_back(op->value);
+            indices.push_back(op->index);
+        }
+        Halide::Internal::IRVisitor::visit(op);
+    }
+
+public:
+    std::vector<Halide::Expr> values;
+    std::vector<Halide::Expr> indices;
+
+    accumulator_updates(const std::string &name) : name(name) {}
+};
+
+/**
+  * Wrap the stores to the accumulator of a parallel reduction in atomic
+  * nodes (see generator::make_parallel_reduction_loop()).
+  */
+class atomic_update_marker : public Halide::Internal::IRMutator
+{
+    using Halide::Internal::IRMutator::visit;
+
+    const std::string &name;
+
+    Halide::Internal::Stmt visit(const Halide::Internal::Store *op) override
+    {
+        if (op->name != name)
+            return op;
+
+        return Halide::Internal::Atomic::make("", "", op);
+    }
+
+public:
+    atomic_update_marker(const std::string &name) : name(name) {}
+};
+
+/**
+  * Return the operator of the update \p value of the accumulator \p name
+  * of a parallel reduction (+, *, min or max applied to the accumulator and
+  * to another term), or an empty string if \p value is not such an update.
+  */
+std::string reduction_operator(const Halide::Expr &value, const std::string &name)
+{
+    auto is_accumulator = [&](const Halide::Expr &e) {
+        const Halide::Internal::Load *load = e.as<Halide::Internal::Load>();
+        return (load != nullptr) && (load->name == name);
+    };
+    auto updates = [&](const auto *op) {
+        return (op != nullptr) && (is_accumulator(op->a) != is_accumulator(op->b));
+    };
+
+    if (updates(value.as<Halide::Internal::Add>()))
+        return "+";
+    if (updates(value.as<Halide::Internal::Mul>()))
+        return "*";
+    if (updates(value.as<Halide::Internal::Min>()))
+        return "min";
+    if (updates(value.as<Halide::Internal::Max>()))
+        return "max";
+    return "";
+}
+
+/**
+  * Return \p x \p op \p y, \p op being an operator returned by reduction_operator().
+  */
+Halide::Expr combine_with_operator(const std::string &op, const Halide::Expr &x, const Halide::Expr &y)
+{
+    if (op == "+")
+        return x + y;
+    if (op == "*")
+        return x * y;
+    if (op == "min")
+        return Halide::min(x, y);
+    return Halide::max(x, y);
+}
+
+/**
+  * Return the identity of \p op, an operator returned by reduction_operator(),
+  * for the type \p type.
+  */
+Halide::Expr operator_identity(const std::string &op, Halide::Type type)
+{
+    return (op == "+") ? Halide::Internal::make_zero(type) :
+           (op == "*") ? Halide::Internal::make_one(type) :
+           (op == "min") ? type.max() : type.min();
+}
+
+/**
+  * Make the loads of the previous element of a scan return the identity
+  * when \p restart holds, i.e. at the first iteration of each block but the
+  * first one (see generator::make_parallel_scan_loop()).
+  */
+class scan_restarter : public Halide::Internal::IRMutator
+{
+    using Halide::Internal::IRMutator::visit;
+
+    const std::string &name;
+    Halide::Expr restart, identity;
+
+    Halide::Expr visit(const Halide::Internal::Load *op) override
+    {
+        if (op->name != name)
+            return Halide::Internal::IRMutator::visit(op);
+
+        return Halide::Internal::Select::make(restart, identity, op);
+    }
+
+public:
+    scan_restarter(const std::string &name, const Halide::Expr &restart, const Halide::Expr &identity)
+        : name(name), restart(restart), identity(identity) {}
+};
+
+/**
+  * Keep only the statements marked as part of the inspector, or remove them
+  * (see generator::split_inspector()).
+  */
+class inspector_splitter : public Halide::Internal::IRMutator
+{
+    using Halide::Internal::IRMutator::visit;
+
+    bool inspector;
+
+    Halide::Internal::Stmt visit(const Halide::Internal::LetStmt *op) override
+    {
+        if (op->name != INSPECTOR_MARKER)
+            return Halide::Internal::IRMutator::visit(op);
+
+        return inspector ? op->body : Halide::Internal::Evaluate::make(0);
+    }
+
+    Halide::Internal::Stmt visit(const Halide::Internal::Store *op) override
+    {
+        return inspector ? Halide::Internal::Evaluate::make(0) : Halide::Internal::Stmt(op);
+    }
+
+    Halide::Internal::Stmt visit(const Halide::Internal::Evaluate *op) override
+    {
+        return inspector ? Halide::Internal::Evaluate::make(0) : Halide::Internal::Stmt(op);
+    }
+
+public:
+    inspector_splitter(bool inspector) : inspector(inspector) {}
+};
+
+/**
+  * The producer name of the atomic nodes that wrap the stores of the
+  * computations marked with computation::vectorize_reduction(), until
+  * generator::mark_vector_reductions() lowers them.
+  */
+static const std::string vector_reduction_tag = "tiramisu_vector_reduction";
+
+/**
+  * Turn the tagged stores (see vector_reduction_tag) in the vectorized loops
+  * into atomic nodes, which Halide vectorizes as horizontal reductions, and
+  * untag the other ones (see generator::mark_vector_reductions()).
+  */
+class vector_reduction_marker : public Halide::Internal::IRMutator
+{
+    using Halide::Internal::IRMutator::visit;
+
+    int vectorized_depth = 0;
+
+    Halide::Internal::Stmt visit(const Halide::Internal::For *op) override
+    {
+        bool vectorized = (op->for_type == Halide::Internal::ForType::Vectorized);
+
+        vectorized_depth += vectorized;
+        Halide::Internal::Stmt result = Halide::Internal::IRMutator::visit(op);
+        vectorized_depth -= vectorized;
+
+        return result;
+    }
+
+    Halide::Internal::Stmt visit(const Halide::Internal::Atomic *op) override
+    {
+        if (op->producer_name != vector_reduction_tag)
+            return Halide::Internal::IRMutator::visit(op);
+
+        Halide::Internal::Stmt body = mutate(op->body);
+        if (vectorized_depth == 0)
+            return body;
+
+        return Halide::Internal::Atomic::make("", "", body);
+    }
+};
+
+/**
+  * Find the buffers accessed in a statement and whether it contains a
+  * vectorized loop.
+  */
+class interleaved_access_finder : public Halide::Internal::IRVisitor
+{
+    using Halide::Internal::IRVisitor::visit;
+
+    void visit(const Halide::Internal::For *op) override
+    {
+        has_vectorized_loop = has_vectorized_loop || (op->for_type == Halide::Internal::ForType::Vectorized);
+        Halide::Internal::IRVisitor::visit(op);
+    }
+
+    void visit(const Halide::Internal::Load *op) override
+    {
+        accessed_buffers.insert(op->name);
+        Halide::Internal::IRVisitor::visit(op);
+    }
+
+    void visit(const Halide::Internal::Store *op) override
+    {
+        accessed_buffers.insert(op->name);
+        Halide::Internal::IRVisitor::visit(op);
+    }
+
+public:
+    bool has_vectorized_loop = false;
+    std::set<std::string> accessed_buffers;
+};
+
+/**
+  * Unroll the loops over the channels of the interleaved buffers next to
+  * the vectorized loops (see generator::unroll_interleaved_channels()).
+  */
+class interleaved_channel_unroller : public Halide::Internal::IRMutator
+{
+    using Halide::Internal::IRMutator::visit;
+
+    const std::map<std::string, int> &buffers;
+    int vectorized_depth = 0;
+
+    Halide::Internal::Stmt visit(const Halide::Internal::For *op) override
+    {
+        bool vectorized = (op->for_type == Halide::Internal::ForType::Vectorized);
+
+        vectorized_depth += vectorized;
+        Halide::Internal::Stmt result = Halide::Internal::IRMutator::visit(op);
+        vectorized_depth -= vectorized;
+
+        const int64_t *extent = Halide::Internal::as_const_int(Halide::Internal::simplify(op->extent));
+        if (op->for_type != Halide::Internal::ForType::Serial || extent == nullptr)
+            return result;
+
+        const Halide::Internal::For *loop = result.as<Halide::Internal::For>();
+        interleaved_access_finder finder;
+        loop->body.accept(&finder);
+        if (vectorized_depth == 0 && !finder.has_vectorized_loop)
+            return result;
+
+        for (const std::string &name : finder.accessed_buffers)
+        {
+            auto channels = buffers.find(name);
+            if (channels != buffers.end() && channels->second == *extent)
+            {
+                DEBUG(3, tiramisu::str_dump("Unrolling the loop " + op->name + " over the channels of " + name));
+                return Halide::Internal::For::make(loop->name, loop->min,
+                                                   Halide::Internal::make_const(loop->extent.type(), *extent),
+                                                   Halide::Internal::ForType::Unrolled, loop->device_api,
+                                                   loop->body);
+            }
+        }
+
+        return result;
+    }
+
+public:
+    interleaved_channel_unroller(const std::map<std::string, int> &buffers) : buffers(buffers) {}
+};
+
+} // anonymous namespace
+
+Halide::Internal::Stmt generator::carve_buffers_from_arena(tiramisu::function &fct, const Halide::Internal::Stmt &stmt)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    buffer_arena_allocator allocator(fct);
+    Halide::Internal::Stmt result = allocator.mutate(stmt);
+
+    for (const auto &offset : allocator.offsets)
+        DEBUG(3, tiramisu::str_dump("Buffer " + offset.first + " allocated at offset " +
+                                    std::to_string(offset.second) + " of the workspace"));
+
+    fct.buffer_arena_size = allocator.arena_size;
+
+    DEBUG(3, tiramisu::str_dump("Size of the workspace: " + std::to_string(fct.buffer_arena_size) + " bytes"));
+
+    DEBUG_INDENT(-4);
+
+    return result;
+}
+
+namespace
+{
+
+/**
+  * True if the bound \p bound (from the outermost loop to a row of the
+  * buffer) decreases between two iterations of the loop.
+  */
+bool decreases(isl_pw_aff *bound)
+{
+    isl_map *rows = isl_map_from_pw_aff(bound);
+    isl_map *later = isl_map_lex_lt(isl_space_domain(isl_map_get_space(rows)));
+    isl_map *pairs = isl_map_apply_range(isl_map_apply_range(isl_map_reverse(isl_map_copy(rows)), later), rows);
+    isl_set *deltas = isl_map_deltas(pairs);
+    isl_aff *dim = isl_aff_var_on_domain(isl_local_space_from_space(isl_set_get_space(deltas)), isl_dim_set, 0);
+    isl_val *min = isl_set_min_val(deltas, dim);
+    bool result = !isl_val_is_nan(min) && isl_val_is_neg(min);
+    isl_val_free(min);
+    isl_aff_free(dim);
+    isl_set_free(deltas);
+
+    return result;
+}
+
+}
+
+tiramisu::mmap_advice_t generator::get_mapped_file_advice(const tiramisu::function &fct, const tiramisu::buffer *b)
+{
+    if (b->get_mapped_file_advice() != tiramisu::mmap_auto)
+        return b->get_mapped_file_advice();
+
+    for (tiramisu::computation *comp : fct.get_computations())
+    {
+        if (!comp->should_schedule_this_computation() || !comp->get_expr().is_defined())
+            continue;
+
+        std::vector<isl_map *> accesses;
+        generator::traverse_expr_and_extract_accesses(&fct, comp, comp->get_expr(), accesses, true);
+        if (comp->get_access_relation() != NULL)
+            accesses.push_back(isl_map_copy(comp->get_access_relation()));
+
+        bool sequential = true;
+        for (isl_map *access : accesses)
+        {
+            const char *accessed = isl_map_get_tuple_name(access, isl_dim_out);
+            if (!sequential || accessed == NULL || std::string(accessed) != b->get_name() ||
+                isl_map_dim(access, isl_dim_out) == 0 || isl_map_dim(comp->get_schedule(), isl_dim_out) < 3)
+            {
+                isl_map_free(access);
+                continue;
+            }
+
+            // The rows of the buffer accessed by each iteration of the outermost loop
+            isl_map *schedule = isl_map_intersect_domain(isl_map_copy(comp->get_schedule()),
+                                                         isl_set_copy(comp->get_iteration_domain()));
+            isl_map *rows = isl_map_apply_range(isl_map_reverse(schedule), access);
+            rows = isl_map_project_out(rows, isl_dim_in, 3, isl_map_dim(rows, isl_dim_in) - 3);
+            rows = isl_map_project_out(rows, isl_dim_in, 0, 2);
+            rows = isl_map_project_out(rows, isl_dim_out, 1, isl_map_dim(rows, isl_dim_out) - 1);
+
+            sequential = !decreases(isl_map_dim_min(isl_map_copy(rows), 0)) &&
+                         !decreases(isl_map_dim_max(rows, 0));
+        }
+
+        if (!sequential)
+        {
+            DEBUG(3, tiramisu::str_dump("Random accesses of " + comp->get_name() + " to the mapped buffer " +
+                                        b->get_name()));
+            return tiramisu::mmap_random;
+        }
+    }
+
+    return tiramisu::mmap_sequential;
+}
+
+Halide::Internal::Stmt generator::map_buffers_from_files(tiramisu::function &fct, const Halide::Internal::Stmt &stmt)
+{
+    if (const Halide::Internal::LetStmt *let = stmt.as<Halide::Internal::LetStmt>())
+        return Halide::Internal::LetStmt::make(let->name, let->value, map_buffers_from_files(fct, let->body));
+    if (const Halide::Internal::ProducerConsumer *pc = stmt.as<Halide::Internal::ProducerConsumer>())
+        return Halide::Internal::ProducerConsumer::make(pc->name, pc->is_producer,
+                                                        map_buffers_from_files(fct, pc->body));
+
+    Halide::Internal::Stmt result = stmt;
+    for (tiramisu::buffer *buf : fct.function_arguments)
+    {
+        if (!buf->is_mapped_file())
+            continue;
+
+        auto h_type = halide_type_from_tiramisu_type(buf->get_elements_type());
+        std::vector<Halide::Expr> extents;
+        Halide::Expr size = Halide::Expr((uint64_t) h_type.bytes());
+        for (int i = buf->get_dim_sizes().size() - 1; i >= 0; --i)
+        {
+            std::vector<isl_ast_expr *> ie = {};
+            extents.push_back(generator::halide_expr_from_tiramisu_expr(&fct, ie, buf->get_dim_sizes()[i]));
+            size = size * Halide::cast(Halide::UInt(64), extents.back());
+        }
+
+        tiramisu::mmap_advice_t advice = generator::get_mapped_file_advice(fct, buf);
+        DEBUG(3, tiramisu::str_dump("Buffer " + buf->get_name() + " mapped from a file, advice " +
+                                    std::to_string(advice)));
+
+        Halide::Expr file = buf->get_mapped_file_by_fd()
+                ? Halide::Internal::Variable::make(Halide::Int(32), buf->get_name() + "_fd")
+                : Halide::Internal::Variable::make(Halide::Handle(), buf->get_name() + "_path");
+        Halide::Expr mapping = Halide::Internal::Call::make(
+                Halide::type_of<void *>(), buf->get_mapped_file_by_fd() ? "tiramisu_map_fd" : "tiramisu_map_file",
+                {file, size, Halide::Expr(static_cast<int32_t>(buf->get_argument_type() == tiramisu::a_output)),
+                 Halide::Expr(static_cast<int32_t>(advice)),
+                 Halide::Expr(static_cast<int32_t>(buf->get_mapped_file_huge_pages()))},
+                Halide::Internal::Call::Extern);
+
+        result = Halide::Internal::Allocate::make(buf->get_name(), h_type, Halide::MemoryType::Heap, extents,
+                                                  Halide::Internal::const_true(), result, mapping,
+                                                  "tiramisu_unmap_file");
+    }
+
+    return result;
+}
+
+Halide::Internal::Stmt generator::make_doacross_loop(const std::string &iterator, const Halide::Expr &min,
+                                                     const Halide::Expr &extent, const Halide::Internal::Stmt &body,
+                                                     int distance)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    // One progress counter per iteration of the doacross loop: the counter of
+    // the iteration i is j + 1 once i has executed all its iterations up to j.
+    std::string counters = iterator + "_doacross_counters";
+    Halide::Expr i = Halide::Internal::Variable::make(Halide::Int(32), iterator);
+
+    auto counter_address = [&](const Halide::Expr &index) {
+        return Halide::Internal::Call::make(
+                Halide::Handle(), Halide::Internal::Call::address_of,
+                {Halide::Internal::Load::make(Halide::Int(32), counters, index, Halide::Buffer<>(),
+                                              Halide::Internal::Parameter(), Halide::Internal::const_true(),
+                                              Halide::Internal::ModulusRemainder())},
+                Halide::Internal::Call::Intrinsic);
+    };
+
+    doacross_synchronizer synchronizer(counter_address(i - min - 1), counter_address(i - min), i == min, distance);
+    Halide::Internal::Stmt synchronized_body = synchronizer.mutate(body);
+
+    if (synchronizer.nb_loops != 1)
+        ERROR("The body of the doacross loop " + iterator + " must contain exactly one loop, found " +
+              std::to_string(synchronizer.nb_loops) + ".", true);
+
+    // Once an iteration is done, the next one does not wait anymore, whatever
+    // the bounds of its inner loop
+    Halide::Internal::Stmt done = Halide::Internal::Evaluate::make(Halide::Internal::Call::make(
+            Halide::Int(32), "tiramisu_doacross_post", {counter_address(i - min), Halide::Int(32).max()},
+            Halide::Internal::Call::Extern));
+
+    Halide::Internal::Stmt loop = Halide::Internal::For::make(
+            iterator, min, extent, Halide::Internal::ForType::Parallel, Halide::DeviceAPI::Host,
+            Halide::Internal::Block::make(synchronized_body, done));
+
+    std::string init_iterator = counters + "_init";
+    Halide::Internal::Stmt init = Halide::Internal::For::make(
+            init_iterator, 0, extent, Halide::Internal::ForType::Serial, Halide::DeviceAPI::Host,
+            Halide::Internal::Store::make(counters, Halide::Int(32).min(),
+                                          Halide::Internal::Variable::make(Halide::Int(32), init_iterator),
+                                          Halide::Internal::Parameter(), Halide::Internal::const_true(),
+                                          Halide::Internal::ModulusRemainder()));
+
+    DEBUG_INDENT(-4);
+
+    return Halide::Internal::Allocate::make(counters, Halide::Int(32), Halide::MemoryType::Heap, {extent},
+                                            Halide::Internal::const_true(), Halide::Internal::Block::make(init, loop));
+}
+
+/**
+  * Append the statements of the blocks of \p s to \p stmts.
+  */
+static void flatten_blocks(const Halide::Internal::Stmt &s, std::vector<Halide::Internal::Stmt> &stmts)
+{
+    if (const Halide::Internal::Block *block = s.as<Halide::Internal::Block>())
+    {
+        flatten_blocks(block->first, stmts);
+        flatten_blocks(block->rest, stmts);
+    }
+    else if (s.defined())
+        stmts.push_back(s);
+}
+
+Halide::Internal::Stmt generator::make_pipeline_loop(const std::string &iterator, const Halide::Expr &min,
+                                                     const Halide::Expr &extent, const Halide::Internal::Stmt &body,
+                                                     int depth)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    std::vector<Halide::Internal::Stmt> stages;
+    flatten_blocks(body, stages);
+    int nb_stages = stages.size();
+
+    if (nb_stages < 2)
+        ERROR("The body of the streaming loop " + iterator + " of a pipeline must contain at least two "
+              "statements, found " + std::to_string(nb_stages) + ".", true);
+
+    // One progress counter per stage: the counter of the stage k is i - min + 1
+    // once k has executed all its iterations up to i.
+    std::string counters = iterator + "_pipeline_counters";
+    Halide::Expr i = Halide::Internal::Variable::make(Halide::Int(32), iterator);
+
+    auto counter_address = [&](int stage) {
+        return Halide::Internal::Call::make(
+                Halide::Handle(), Halide::Internal::Call::address_of,
+                {Halide::Internal::Load::make(Halide::Int(32), counters, stage, Halide::Buffer<>(),
+                                              Halide::Internal::Parameter(), Halide::Internal::const_true(),
+                                              Halide::Internal::ModulusRemainder())},
+                Halide::Internal::Call::Intrinsic);
+    };
+    auto wait = [&](int stage, const Halide::Expr &value) {
+        return Halide::Internal::Evaluate::make(Halide::Internal::Call::make(
+                Halide::Int(32), "tiramisu_doacross_wait", {counter_address(stage), value},
+                Halide::Internal::Call::Extern));
+    };
+
+    std::string stage_iterator = iterator + "_stage";
+    Halide::Expr stage_var = Halide::Internal::Variable::make(Halide::Int(32), stage_iterator);
+
+    Halide::Internal::Stmt stage_loops;
+    for (int k = nb_stages - 1; k >= 0; k--)
+    {
+        std::vector<Halide::Internal::Stmt> iteration;
+        if (k > 0)
+            iteration.push_back(wait(k - 1, i - min + 1));
+        // The last stage frees the slot of the ring buffers used depth iterations ago
+        if (depth > 0 && k < nb_stages - 1)
+            iteration.push_back(Halide::Internal::IfThenElse::make(
+                    i - min >= depth, wait(nb_stages - 1, i - min + 1 - depth)));
+        iteration.push_back(stages[k]);
+        iteration.push_back(Halide::Internal::Evaluate::make(Halide::Internal::Call::make(
+                Halide::Int(32), "tiramisu_doacross_post", {counter_address(k), i - min + 1},
+                Halide::Internal::Call::Extern)));
+
+        Halide::Internal::Stmt stage_loop = Halide::Internal::For::make(
+                iterator, min, extent, Halide::Internal::ForType::Serial, Halide::DeviceAPI::Host,
+                Halide::Internal::Block::make(iteration));
+        stage_loops = Halide::Internal::IfThenElse::make(stage_var == k, stage_loop, stage_loops);
+    }
+
+    Halide::Internal::Stmt loop = Halide::Internal::For::make(
+            stage_iterator, 0, nb_stages, Halide::Internal::ForType::Parallel, Halide::DeviceAPI::Host,
+            stage_loops);
+
+    std::vector<Halide::Internal::Stmt> init;
+    init.push_back(Halide::Internal::Evaluate::make(Halide::Internal::Call::make(
+            Halide::Int(32), "tiramisu_pipeline_reserve_threads", {nb_stages},
+            Halide::Internal::Call::Extern)));
+    for (int k = 0; k < nb_stages; k++)
+        init.push_back(Halide::Internal::Store::make(counters, 0, k, Halide::Internal::Parameter(),
+                                                     Halide::Internal::const_true(),
+                                                     Halide::Internal::ModulusRemainder()));
+    init.push_back(loop);
+
+    DEBUG_INDENT(-4);
+
+    return Halide::Internal::Allocate::make(counters, Halide::Int(32), Halide::MemoryType::Heap, {nb_stages},
+                                            Halide::Internal::const_true(), Halide::Internal::Block::make(init));
+}
+
+Halide::Internal::Stmt generator::make_parametric_split_loop(const std::string &iterator, const Halide::Expr &min,
+                                                             const Halide::Expr &extent,
+                                                             const Halide::Internal::Stmt &body,
+                                                             const std::vector<Halide::Expr> &sizes,
+                                                             Halide::Internal::ForType for_type,
+                                                             Halide::DeviceAPI device_api)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    Halide::Type type = min.type();
+
+    // The number of tiles of a loop, and the loop over the points of a tile,
+    // the last tile can be partial
+    auto nb_tiles = [&](const Halide::Expr &loop_extent, const Halide::Expr &size) {
+        return (loop_extent + Halide::cast(type, size) - 1) / Halide::cast(type, size);
+    };
+    auto point_loop = [&](const std::string &name, const Halide::Expr &loop_min, const Halide::Expr &loop_extent,
+                          const Halide::Expr &size, Halide::Internal::ForType point_type,
+                          Halide::DeviceAPI point_api, const Halide::Internal::Stmt &loop_body) {
+        Halide::Expr tile_size = Halide::cast(type, size);
+        Halide::Expr tile = Halide::Internal::Variable::make(type, name + "_tile");
+        Halide::Expr point = Halide::Internal::Variable::make(type, name + "_point");
+        return Halide::Internal::For::make(
+                name + "_point", 0, Halide::min(tile_size, loop_extent - tile * tile_size), point_type, point_api,
+                Halide::Internal::LetStmt::make(name, loop_min + tile * tile_size + point, loop_body));
+    };
+
+    const Halide::Internal::For *inner = (sizes.size() == 2) ? body.as<Halide::Internal::For>() : nullptr;
+    bool tiled = (inner != nullptr) &&
+                 !Halide::Internal::expr_uses_var(inner->min, iterator) &&
+                 !Halide::Internal::expr_uses_var(inner->extent, iterator);
+
+    Halide::Internal::Stmt result;
+    if (tiled)
+    {
+        // iterator_tile, inner_tile, iterator_point, inner_point
+        Halide::Internal::Stmt points = point_loop(
+                iterator, min, extent, sizes[0], Halide::Internal::ForType::Serial, Halide::DeviceAPI::Host,
+                point_loop(inner->name, inner->min, inner->extent, sizes[1], inner->for_type, inner->device_api,
+                           inner->body));
+        result = Halide::Internal::For::make(
+                inner->name + "_tile", 0, nb_tiles(inner->extent, sizes[1]), Halide::Internal::ForType::Serial,
+                Halide::DeviceAPI::Host, points);
+    }
+    else
+    {
+        Halide::Internal::Stmt loop_body = body;
+        if (inner != nullptr)
+        {
+            DEBUG(3, tiramisu::str_dump("The bounds of the loop " + inner->name + " depend on " + iterator +
+                                        ", the two loops are split without being interchanged."));
+            loop_body = Halide::Internal::For::make(
+                    inner->name + "_tile", 0, nb_tiles(inner->extent, sizes[1]), Halide::Internal::ForType::Serial,
+                    Halide::DeviceAPI::Host,
+                    point_loop(inner->name, inner->min, inner->extent, sizes[1], inner->for_type, inner->device_api,
+                               inner->body));
+        }
+        else if (sizes.size() == 2)
+        {
+            DEBUG(3, tiramisu::str_dump("The body of the loop " + iterator + " is not a loop, only " +
+                                        iterator + " is split."));
+        }
+        result = point_loop(iterator, min, extent, sizes[0], Halide::Internal::ForType::Serial, Halide::DeviceAPI::Host,
+                            loop_body);
+    }
+    result = Halide::Internal::For::make(iterator + "_tile", 0, nb_tiles(extent, sizes[0]), for_type, device_api,
+                                         result);
+
+    DEBUG_INDENT(-4);
+
+    return result;
+}
+
+Halide::Internal::Stmt generator::make_parallel_reduction_loop(const std::string &iterator, const Halide::Expr &min,
+                                                               const Halide::Expr &extent,
+                                                               const Halide::Internal::Stmt &body,
+                                                               const std::string &accumulator,
+                                                               tiramisu::reduction_strategy_t strategy,
+                                                               int nb_partials)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    if (strategy == tiramisu::reduction_atomic)
+    {
+        DEBUG_INDENT(-4);
+        return Halide::Internal::For::make(iterator, min, extent, Halide::Internal::ForType::Parallel,
+                                           Halide::DeviceAPI::Host, atomic_update_marker(accumulator).mutate(body));
+    }
+
+    loop_body_accesses body_accesses;
+    body.accept(&body_accesses);
+    if (body_accesses.accesses.count(accumulator) == 0 || !body_accesses.is_promotable(accumulator, iterator))
+        ERROR("The accumulator " + accumulator + " of the parallel reduction over " + iterator +
+              " must be accessed at a single address that does not depend on the reduction loop.", true);
+
+    accumulator_updates updates(accumulator);
+    body.accept(&updates);
+
+    std::string op;
+    for (const auto &value : updates.values)
+    {
+        std::string value_op = reduction_operator(value, accumulator);
+        if (value_op.empty() || (!op.empty() && value_op != op))
+            ERROR("The updates of the accumulator " + accumulator + " of the parallel reduction over " + iterator +
+                  " must all be of the form " + accumulator + " = " + accumulator + " op e, with op one of +, *, min and max.", true);
+        op = value_op;
+    }
+
+    const loop_body_accesses::access &a = body_accesses.accesses.at(accumulator);
+    Halide::Type type = a.types[0];
+    const Halide::Expr &index = a.indices[0];
+
+    auto combine = [&](const Halide::Expr &x, const Halide::Expr &y) {
+        return combine_with_operator(op, x, y);
+    };
+    Halide::Expr identity = operator_identity(op, type);
+
+    // The partial results are a cache line apart, so that the threads do
+    // not share the lines they update
+    std::string partials = accumulator + "_" + iterator + "_partials";
+    int stride = std::max(1, 64 / type.bytes());
+    auto partial = [&](const Halide::Expr &chunk) {
+        return Halide::Internal::Load::make(type, partials, chunk * stride, Halide::Buffer<>(),
+                                            Halide::Internal::Parameter(), Halide::Internal::const_true(),
+                                            Halide::Internal::ModulusRemainder());
+    };
+    auto store_partial = [&](const Halide::Expr &value, const Halide::Expr &chunk) {
+        return Halide::Internal::Store::make(partials, value, chunk * stride, Halide::Internal::Parameter(),
+                                             Halide::Internal::const_true(), Halide::Internal::ModulusRemainder());
+    };
+
+    // Each chunk of iterations accumulates into its own partial result
+    std::string chunk_name = iterator + "_chunk";
+    Halide::Expr chunk = Halide::Internal::Variable::make(min.type(), chunk_name);
+    Halide::Expr chunk_size = (extent + (nb_partials - 1)) / nb_partials;
+    Halide::Expr chunk_min = min + chunk * chunk_size;
+    Halide::Expr chunk_extent = Halide::max(Halide::min(chunk_size, min + extent - chunk_min), 0);
+
+    Halide::Internal::Stmt chunk_loop = Halide::Internal::For::make(
+            iterator, chunk_min, chunk_extent, Halide::Internal::ForType::Serial, Halide::DeviceAPI::Host,
+            access_redirector(accumulator, partials, chunk * stride).mutate(body));
+    std::vector<Halide::Internal::Stmt> stmts = {Halide::Internal::For::make(
+            chunk_name, Halide::cast(min.type(), 0), Halide::cast(min.type(), nb_partials),
+            Halide::Internal::ForType::Parallel, Halide::DeviceAPI::Host,
+            Halide::Internal::Block::make(store_partial(identity, chunk), chunk_loop))};
+
+    Halide::Expr accumulated = a.load.defined() ? a.load :
+            Halide::Internal::Load::make(type, accumulator, index, Halide::Buffer<>(), a.param,
+                                         Halide::Internal::const_true(), Halide::Internal::ModulusRemainder());
+    auto store_accumulator = [&](const Halide::Expr &value) {
+        return Halide::Internal::Store::make(accumulator, value, index, a.param, Halide::Internal::const_true(),
+                                             Halide::Internal::ModulusRemainder());
+    };
+
+    if (strategy == tiramisu::reduction_tree)
+    {
+        // At the step s, the partial result 2*s*t absorbs the partial result 2*s*t + s
+        std::string step_name = iterator + "_step";
+        Halide::Expr t = Halide::Internal::Variable::make(min.type(), step_name);
+        for (int s = 1; s < nb_partials; s *= 2)
+            stmts.push_back(Halide::Internal::For::make(
+                    step_name, Halide::cast(min.type(), 0), Halide::cast(min.type(), (nb_partials + s - 1) / (2 * s)),
+                    Halide::Internal::ForType::Parallel, Halide::DeviceAPI::Host,
+                    store_partial(combine(partial(t * (2 * s)), partial(t * (2 * s) + s)), t * (2 * s))));
+        stmts.push_back(store_accumulator(combine(accumulated, partial(Halide::cast(min.type(), 0)))));
+    }
+    else
+    {
+        std::string combine_name = iterator + "_combine";
+        Halide::Expr c = Halide::Internal::Variable::make(min.type(), combine_name);
+        stmts.push_back(Halide::Internal::For::make(
+                combine_name, Halide::cast(min.type(), 0), Halide::cast(min.type(), nb_partials),
+                Halide::Internal::ForType::Serial, Halide::DeviceAPI::Host,
+                store_accumulator(combine(accumulated, partial(c)))));
+    }
+
+    DEBUG(3, tiramisu::str_dump("Parallel reduction over " + iterator + " into " + accumulator + " with the operator " +
+                                op + " and " + std::to_string(nb_partials) + " partial results"));
+
+    DEBUG_INDENT(-4);
+
+    return Halide::Internal::Allocate::make(partials, type, Halide::MemoryType::Heap, {nb_partials * stride},
+                                            Halide::Internal::const_true(), Halide::Internal::Block::make(stmts));
+}
+
+Halide::Internal::Stmt generator::make_parallel_scan_loop(const std::string &iterator, const Halide::Expr &min,
+                                                          const Halide::Expr &extent,
+                                                          const Halide::Internal::Stmt &body,
+                                                          const std::string &accumulator, int nb_blocks)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    loop_body_accesses body_accesses;
+    body.accept(&body_accesses);
+    accumulator_updates updates(accumulator);
+    body.accept(&updates);
+
+    std::string op = (updates.values.size() == 1) ? reduction_operator(updates.values[0], accumulator) : "";
+    if (op.empty())
+        ERROR("The scan over " + iterator + " must update " + accumulator + " once, with " + accumulator + "[i] = " +
+              accumulator + "[i - 1] op e, and op one of +, *, min and max.", true);
+
+    // The body must only read the element written by the previous iteration
+    const loop_body_accesses::access &a = body_accesses.accesses.at(accumulator);
+    Halide::Type type = a.types[0];
+    Halide::Expr index = updates.indices[0];
+    Halide::Expr i = Halide::Internal::Variable::make(min.type(), iterator);
+    Halide::Expr previous_index = Halide::Internal::simplify(Halide::Internal::substitute(iterator, i - 1, index));
+
+    bool is_scan = !a.escapes && (index.type().lanes() == 1) && Halide::Internal::expr_uses_var(index, iterator);
+    for (const auto &access_index : a.indices)
+        is_scan = is_scan && (Halide::Internal::equal(access_index, index) ||
+                              Halide::Internal::equal(Halide::Internal::simplify(access_index), previous_index));
+    for (const auto &var : body_accesses.defined)
+        is_scan = is_scan && !Halide::Internal::expr_uses_var(index, var);
+    if (!is_scan)
+        ERROR("The scan over " + iterator + " must only access " + accumulator +
+              " at the elements written by the current and by the previous iteration.", true);
+
+    Halide::Expr identity = operator_identity(op, type);
+    auto combine = [&](const Halide::Expr &x, const Halide::Expr &y) {
+        return combine_with_operator(op, x, y);
+    };
+
+    std::string sums = accumulator + "_" + iterator + "_block_sums";
+    std::string carries = accumulator + "_" + iterator + "_block_carries";
+    auto load = [&](const std::string &name, const Halide::Expr &block) {
+        return Halide::Internal::Load::make(type, name, block, Halide::Buffer<>(), Halide::Internal::Parameter(),
+                                            Halide::Internal::const_true(), Halide::Internal::ModulusRemainder());
+    };
+    auto store = [&](const std::string &name, const Halide::Expr &value, const Halide::Expr &block) {
+        return Halide::Internal::Store::make(name, value, block, Halide::Internal::Parameter(),
+                                             Halide::Internal::const_true(), Halide::Internal::ModulusRemainder());
+    };
+
+    std::string block_name = iterator + "_block";
+    Halide::Expr block = Halide::Internal::Variable::make(min.type(), block_name);
+    Halide::Expr block_size = (extent + (nb_blocks - 1)) / nb_blocks;
+    Halide::Expr block_min = min + block * block_size;
+    Halide::Expr block_extent = Halide::max(Halide::min(block_size, min + extent - block_min), 0);
+    Halide::Expr zero = Halide::cast(min.type(), 0), one = Halide::cast(min.type(), 1);
+
+    // First pass: the blocks are scanned independently, all but the first
+    // one from the identity, and their last elements are kept
+    Halide::Internal::Stmt local_scan = Halide::Internal::For::make(
+            iterator, block_min, block_extent, Halide::Internal::ForType::Serial, Halide::DeviceAPI::Host,
+            scan_restarter(accumulator, (block > 0) && (i == block_min), identity).mutate(body));
+    Halide::Expr last = Halide::Internal::Load::make(
+            type, accumulator, Halide::Internal::substitute(iterator, block_min + block_extent - 1, index),
+            Halide::Buffer<>(), a.param, Halide::Internal::const_true(), Halide::Internal::ModulusRemainder());
+    std::vector<Halide::Internal::Stmt> stmts = {Halide::Internal::For::make(
+            block_name, zero, Halide::cast(min.type(), nb_blocks), Halide::Internal::ForType::Parallel,
+            Halide::DeviceAPI::Host,
+            Halide::Internal::Block::make({store(sums, identity, block), local_scan,
+                                           Halide::Internal::IfThenElse::make(block_extent > 0,
+                                                                              store(sums, last, block))}))};
+
+    // Second pass: the carry of a block combines the last elements of the blocks before it
+    stmts.push_back(store(carries, identity, zero));
+    stmts.push_back(Halide::Internal::For::make(
+            block_name, one, Halide::cast(min.type(), nb_blocks - 1), Halide::Internal::ForType::Serial,
+            Halide::DeviceAPI::Host, store(carries, combine(load(carries, block - 1), load(sums, block - 1)), block)));
+
+    // Third pass: the carries are combined with the elements of their block
+    Halide::Expr current = Halide::Internal::Load::make(type, accumulator, index, Halide::Buffer<>(), a.param,
+                                                        Halide::Internal::const_true(),
+                                                        Halide::Internal::ModulusRemainder());
+    stmts.push_back(Halide::Internal::For::make(
+            block_name, one, Halide::cast(min.type(), nb_blocks - 1), Halide::Internal::ForType::Parallel,
+            Halide::DeviceAPI::Host,
+            Halide::Internal::For::make(iterator, block_min, block_extent, Halide::Internal::ForType::Serial,
+                                        Halide::DeviceAPI::Host,
+                                        Halide::Internal::Store::make(accumulator, combine(load(carries, block), current),
+                                                                      index, a.param, Halide::Internal::const_true(),
+                                                                      Halide::Internal::ModulusRemainder()))));
+
+    DEBUG(3, tiramisu::str_dump("Parallel scan over " + iterator + " of " + accumulator + " with the operator " +
+                                op + " and " + std::to_string(nb_blocks) + " blocks"));
+
+    DEBUG_INDENT(-4);
+
+    Halide::Internal::Stmt result = Halide::Internal::Block::make(stmts);
+    result = Halide::Internal::Allocate::make(carries, type, Halide::MemoryType::Heap, {nb_blocks},
+                                              Halide::Internal::const_true(), result);
+    return Halide::Internal::Allocate::make(sums, type, Halide::MemoryType::Heap, {nb_blocks},
+                                            Halide::Internal::const_true(), result);
+}
+
+Halide::Internal::Stmt generator::make_profiled_loop_nest(const tiramisu::function &fct, isl_ast_node *node,
+                                                          const Halide::Internal::Stmt &stmt)
+{
+    // Name the loop nest after the computations fused in it
+    std::vector<std::string> computations;
+    isl_ast_node_foreach_descendant_top_down(node, [](isl_ast_node *descendant, void *user) {
+        if (isl_ast_node_get_type(descendant) == isl_ast_node_user)
+        {
+            auto computations = (std::vector<std::string> *) user;
+            isl_ast_expr *expr = isl_ast_node_user_get_expr(descendant);
+            isl_ast_expr *arg = isl_ast_expr_get_op_arg(expr, 0);
+            isl_id *id = isl_ast_expr_get_id(arg);
+            std::string name(isl_id_get_name(id));
+            if (std::find(computations->begin(), computations->end(), name) == computations->end())
+                computations->push_back(name);
+            isl_id_free(id);
+            isl_ast_expr_free(arg);
+            isl_ast_expr_free(expr);
+        }
+        return isl_bool_true;
+    }, &computations);
+
+    std::string region = fct.get_name() + ":";
+    for (size_t i = 0; i < computations.size(); i++)
+        region += ((i > 0) ? "," : "") + computations[i];
+
+    DEBUG(3, tiramisu::str_dump("Profiling the loop nest " + region));
+
+    std::string start = generate_new_variable_name();
+    Halide::Internal::Stmt stop = Halide::Internal::Evaluate::make(Halide::Internal::Call::make(
+            Halide::Int(32), "tiramisu_profiler_stop",
+            {Halide::Expr(region), Halide::Internal::Variable::make(Halide::UInt(64), start)},
+            Halide::Internal::Call::Extern));
+
+    return Halide::Internal::LetStmt::make(
+            start, Halide::Internal::Call::make(Halide::UInt(64), "tiramisu_profiler_start", {}, Halide::Internal::Call::Extern),
+            Halide::Internal::Block::make(stmt, stop));
+}
+
+Halide::Internal::Stmt generator::mark_vector_reductions(const Halide::Internal::Stmt &stmt)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    Halide::Internal::Stmt result = vector_reduction_marker().mutate(stmt);
+
+    DEBUG_INDENT(-4);
+
+    return result;
+}
+
+Halide::Internal::Stmt generator::unroll_interleaved_channels(const Halide::Internal::Stmt &stmt,
+                                                              const std::map<std::string, int> &buffers)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    Halide::Internal::Stmt result = interleaved_channel_unroller(buffers).mutate(stmt);
+
+    DEBUG_INDENT(-4);
+
+    return result;
+}
+
+Halide::Internal::Stmt generator::split_inspector(const Halide::Internal::Stmt &stmt, bool inspector)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    Halide::Internal::Stmt result = inspector_splitter(inspector).mutate(stmt);
+
+    DEBUG_INDENT(-4);
+
+    return result;
+}
+
+Halide::Internal::Stmt generator::promote_reductions_to_registers(const Halide::Internal::Stmt &stmt)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    Halide::Internal::Stmt result = reduction_promoter().mutate(stmt);
+
+    DEBUG_INDENT(-4);
+
+    return result;
+}
+
+isl_ast_node *for_code_generator_after_for(isl_ast_node *node, isl_ast_build *build, void *user)
+{
+    return node;
+}
+
+/**
+  * Linearize a multidimensional access to a Halide buffer.
+  * Supposing that we have buf[N1][N2][N3], transform buf[i][j][k]
+  * into buf[k + j*N3 + i*N3*N2].
+  * Note that the first arg in index_expr is the buffer name.  The other args
+  * are the indices for each dimension of the buffer.
+  */
+
+
+static inline Halide::Expr empty_index()
+{
+    if (global::get_loop_iterator_data_type() == p_int32)
+        return Halide::Expr(static_cast<int32_t >(0));
+    else
+        return Halide::Expr(static_cast<int64_t >(0));
+}
+
+Halide::Expr generator::linearize_access(int dims, const halide_dimension_t *shape, isl_ast_expr *index_expr)
+{
+    assert(isl_ast_expr_get_op_n_arg(index_expr) > 1);
+
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    // ISL dimension is ordered from outermost to innermost.
+    // The terms are summed from the outermost to the innermost dimension, so that the
+    // terms of the outer dimensions form a subexpression that is invariant in the innermost
+    // loop (hoisted by loop invariant code motion and shared by CSE between the accesses
+    // to the same buffer), and the innermost loop only adds its own term to it.
 
     Halide::Expr index {empty_index()};
-    for (int i = dims; i >= 1; --i)
+    for (int i = 1; i <= dims; ++i)
     {
         isl_ast_expr *operand = isl_ast_expr_get_op_arg(index_expr, i);
         Halide::Expr operand_h = halide_expr_from_isl_ast_expr(operand);
@@ -2659,9 +5038,10 @@ Halide::Expr generator::linearize_access(int dims, const halide_dimension_t *sha
     assert(index_expr.size() > 0);
 
     // ISL dimension is ordered from outermost to innermost.
+    // The terms are summed from the outermost dimension (see the first linearize_access()).
 
     Halide::Expr index {empty_index()};
-    for (int i = dims; i >= 1; --i)
+    for (int i = 1; i <= dims; ++i)
     {
         std::vector<isl_ast_expr *> ie = {};
         Halide::Expr operand_h = generator::halide_expr_from_tiramisu_expr(NULL, ie, index_expr[i-1]);
@@ -2681,9 +5061,10 @@ Halide::Expr generator::linearize_access(int dims, std::vector<Halide::Expr> &st
     assert(index_expr.size() > 0);
 
     // ISL dimension is ordered from outermost to innermost.
+    // The terms are summed from the outermost dimension (see the first linearize_access()).
 
     Halide::Expr index {empty_index()};
-    for (int i = dims; i >= 1; --i)
+    for (int i = 1; i <= dims; ++i)
     {
         std::vector<isl_ast_expr *> ie = {};
         Halide::Expr operand_h = generator::halide_expr_from_tiramisu_expr(NULL, ie, index_expr[i-1]);
@@ -2703,9 +5084,10 @@ Halide::Expr generator::linearize_access(int dims, std::vector<Halide::Expr> &st
     DEBUG_INDENT(4);
 
     // ISL dimension is ordered from outermost to innermost.
+    // The terms are summed from the outermost dimension (see the first linearize_access()).
 
     Halide::Expr index {empty_index()};
-    for (int i = dims; i >= 1; --i)
+    for (int i = 1; i <= dims; ++i)
     {
         isl_ast_expr *operand = isl_ast_expr_get_op_arg(index_expr, i);
         Halide::Expr operand_h = halide_expr_from_isl_ast_expr(operand);
@@ -2750,9 +5132,10 @@ tiramisu::expr generator::linearize_access(int dims, std::vector<tiramisu::expr>
     DEBUG_INDENT(4);
 
     // ISL dimension is ordered from outermost to innermost.
+    // The terms are summed from the outermost dimension (see the first linearize_access()).
 
     tiramisu::expr index = value_cast(global::get_loop_iterator_data_type(), 0);
-    for (int i = dims; i >= 1; --i)
+    for (int i = 1; i <= dims; ++i)
     {
         isl_ast_expr *operand = isl_ast_expr_get_op_arg(index_expr, i);
         tiramisu::expr operand_h = tiramisu_expr_from_isl_ast_expr(operand);
@@ -2829,14 +5212,29 @@ tiramisu::expr generator::comp_to_buffer(tiramisu::computation *comp, std::vecto
             // assert(expr->get_access()[i].is_constant() && "Only constant accesses are supported.");
         }
 
-        index = tiramisu::generator::linearize_access((int) dim_sizes.size(), strides, expr->get_access());
+        index = tiramisu::generator::linearize_access((int) dim_sizes.size(), strides,
+                                                      tiramisu_buffer->get_shared_layout_indices(expr->get_access()));
     }
     else
     {
         assert(index_expr[0] != nullptr);
         DEBUG(3, tiramisu::str_dump("Linearizing access of the LHS index expression."));
 
-        index = tiramisu::generator::linearize_access((int) dim_sizes.size(), strides, index_expr[0]);
+        if (tiramisu_buffer->get_shared_layout() == tiramisu::shared_skewed)
+        {
+            // The indices are rearranged before being linearized
+            std::vector<tiramisu::expr> indices;
+            for (int i = 1; i <= (int) dim_sizes.size(); i++)
+            {
+                isl_ast_expr *operand = isl_ast_expr_get_op_arg(index_expr[0], i);
+                indices.push_back(tiramisu_expr_from_isl_ast_expr(operand));
+                isl_ast_expr_free(operand);
+            }
+            index = tiramisu::generator::linearize_access((int) dim_sizes.size(), strides,
+                                                          tiramisu_buffer->get_shared_layout_indices(indices));
+        }
+        else
+            index = tiramisu::generator::linearize_access((int) dim_sizes.size(), strides, index_expr[0]);
 
         DEBUG(3, tiramisu::str_dump("After linearization: ");
                 std::cout << index.to_str() << std::endl);
@@ -2996,6 +5394,14 @@ void computation::create_halide_assignment()
           // This is the iterator, but it is still in the user's form. Transform it.
           this->library_call_args[1] = replace_original_indices_with_transformed_indices(this->library_call_args[1],
                                                                                            this->get_iterators_map());
+          // The tag holds the communication channel, usually an iterator of a parallel loop.
+          this->library_call_args[2] = replace_original_indices_with_transformed_indices(this->library_call_args[2],
+                                                                                           this->get_iterators_map());
+        }
+        if (this->is_collective() && this->rhs_argument_idx == 2) {
+          // The root of a broadcast may also be expressed with the iterators of the user.
+          this->library_call_args[1] = replace_original_indices_with_transformed_indices(this->library_call_args[1],
+                                                                                           this->get_iterators_map());
         }
         // The majority of code generation for computations will fall into this first if statement as they are not library calls. This is the original code
         // Some library calls take the usual lhs as an actual argument however, so we may need to compute it anyway for some library calls
@@ -3056,17 +5462,24 @@ void computation::create_halide_assignment()
             }
 
             // The number of dimensions in the Halide buffer should be equal to
-            // the number of dimensions of the access function.
-            assert(buf_dims == access_dims);
+            // the number of dimensions of the access function (but for the
+            // dimension of the parts of complex numbers).
+            int accessed_dims = get_accessed_dims(tiramisu_buffer);
+            assert(accessed_dims == access_dims);
             assert(this->index_expr[0] != NULL);
             DEBUG(3, tiramisu::str_dump("Linearizing access of the LHS index expression."));
 
 
             Halide::Expr index;
             if (tiramisu_buffer->has_constant_extents())
-                index = tiramisu::generator::linearize_access(buf_dims, shape, this->index_expr[0]);
+                index = tiramisu::generator::linearize_access(accessed_dims, shape + (buf_dims - accessed_dims),
+                                                              this->index_expr[0]);
             else
-                index = tiramisu::generator::linearize_access(buf_dims, strides_vector, this->index_expr[0]);
+            {
+                strides_vector.erase(strides_vector.begin(), strides_vector.end() - accessed_dims);
+                index = tiramisu::generator::linearize_access(accessed_dims, strides_vector, this->index_expr[0]);
+            }
+            index = complex_access_index(tiramisu_buffer, index);
 
             DEBUG(3, tiramisu::str_dump("After linearization: ");
                     std::cout << index << std::endl);
@@ -3094,6 +5507,8 @@ void computation::create_halide_assignment()
                                         tiramisu_buffer->get_name());
                         param = Halide::Internal::Parameter(buffer.type(), true, buffer.dimensions(), buffer.name());
                         param.set_buffer(buffer);
+                        if (tiramisu_buffer->get_alignment() > 0)
+                            param.set_host_alignment(tiramisu_buffer->get_alignment());
                         DEBUG(3, tiramisu::str_dump(
                                 "Halide buffer object created.  This object will be passed to the Halide function that creates an assignment to a buffer."));
                     } else {
@@ -3102,6 +5517,8 @@ void computation::create_halide_assignment()
                                 true,
                                 tiramisu_buffer->get_dim_sizes().size(),
                                 tiramisu_buffer->get_name());
+                        if (tiramisu_buffer->get_alignment() > 0)
+                            param.set_host_alignment(tiramisu_buffer->get_alignment());
                         std::vector<isl_ast_expr *> empty_index_expr;
                         Halide::Expr stride_expr = Halide::Expr(1);
                         for (int i = 0; i < tiramisu_buffer->get_dim_sizes().size(); i++) {
@@ -3137,6 +5554,11 @@ void computation::create_halide_assignment()
                         index, param, Halide::Internal::const_true(type.lanes()),
 			Halide::Internal::ModulusRemainder()); //ModulusRemainder has been added here but this might be wrong
 
+                // Only the stores of this computation become horizontal reductions,
+                // not the other stores to the same buffer
+                if (this->is_vector_reduction())
+                    this->stmt = Halide::Internal::Atomic::make(vector_reduction_tag, "", this->stmt);
+
                 DEBUG(3, tiramisu::str_dump("Halide::Internal::Store::make statement created."));
             } else if (this->is_library_call()) {
               // We need to make sure to process all of the other arguments for this library call
@@ -3159,6 +5581,8 @@ void computation::create_halide_assignment()
                     Halide::Expr result2;
                     if (this->lhs_access_type == tiramisu::o_lin_index) { // pass in the index directly
                         result = index;
+                    } else if (tiramisu_buffer->get_location() == tiramisu::cuda_ast::memory_location::global) {
+                        result = tiramisu::device_address_of(tiramisu_buffer, index);
                     } else { // pass in LHS index and buffer into address_of extern function
                         result = Halide::Internal::Variable::make(Halide::type_of<struct halide_buffer_t *>(),
                                                                   tiramisu_buffer->get_name() + ".buffer");
@@ -3205,7 +5629,6 @@ void computation::create_halide_assignment()
             }
             // Defines writing into the wait buffer when a transfer is initiated (for nonblocking operations)
             if (this->wait_argument_idx != -1) {
-                ERROR("Nonblocking not currently supported", 0);
                 assert((this->is_recv() || this->is_send_recv()) && "This should be a recv or one-sided operation.");
                 assert(this->wait_access_map && "A wait access map must be provided.");
                 // We treat this like another LHS access, so we'll recompute the LHS access using the req access map.
@@ -3261,7 +5684,9 @@ void computation::create_halide_assignment()
             }
             if (this->is_library_call()) {
                 // Now, create the library call and evaluate it. This becomes the Halide stmt.
-                this->stmt = Halide::Internal::Evaluate::make(make_comm_call(Halide::Bool(), this->library_call_name,
+                this->stmt = Halide::Internal::Evaluate::make(make_comm_call(Halide::Bool(),
+                                                                             tiramisu::comm_call_name(this, this->library_call_name,
+                                                                                            halide_call_args),
                                                                              halide_call_args));
             }
             delete[] shape;
@@ -3284,7 +5709,6 @@ void computation::create_halide_assignment()
                                                                                                this->get_expr(), this);
             }
             if (this->wait_argument_idx != -1) {
-                ERROR("Nonblocking not currently supported", 0);
                 assert(this->is_send() && "This should be a send operation.");
                 assert(this->wait_access_map && "A request access map must be provided.");
                 // We treat this like another LHS access, so we'll recompute the LHS access using the req access map.
@@ -3324,7 +5748,9 @@ void computation::create_halide_assignment()
                 halide_call_args[wait_argument_idx] = result;
             }
             // Create the library call (assumed to be a communication call for right now)
-            this->stmt = Halide::Internal::Evaluate::make(make_comm_call(Halide::Bool(), this->library_call_name,
+            this->stmt = Halide::Internal::Evaluate::make(make_comm_call(Halide::Bool(),
+                                                                         tiramisu::comm_call_name(this, this->library_call_name,
+                                                                                        halide_call_args),
                                                                          halide_call_args));
 
         }
@@ -3526,6 +5952,12 @@ Halide::Expr generator::halide_expr_from_tiramisu_expr(const tiramisu::function
             op2 = generator::halide_expr_from_tiramisu_expr(fct, index_expr, expr2, comp);
         }
 
+        // The vectorized approximations of the transcendental operators
+        // (undefined if the math library is used)
+        Halide::Expr approximation;
+        if ((comp != NULL) && (tiramisu_expr.get_n_arg() == 1))
+            approximation = vector_math(tiramisu_expr.get_op_type(), op0, comp->get_math_precision());
+
         switch (tiramisu_expr.get_op_type())
         {
             case tiramisu::o_logical_and:
@@ -3557,11 +5989,17 @@ Halide::Expr generator::halide_expr_from_tiramisu_expr(const tiramisu::function
                 DEBUG(10, tiramisu::str_dump("op type: o_sub"));
                 break;
             case tiramisu::o_mul:
-                result = Halide::Internal::Mul::make(op0, op1);
+                if (is_complex_type(tiramisu_expr.get_data_type()))
+                    result = complex_mul(op0, op1);
+                else
+                    result = Halide::Internal::Mul::make(op0, op1);
                 DEBUG(10, tiramisu::str_dump("op type: o_mul"));
                 break;
             case tiramisu::o_div:
-                result = Halide::Internal::Div::make(op0, op1);
+                if (is_complex_type(tiramisu_expr.get_data_type()))
+                    result = complex_div(op0, op1);
+                else
+                    result = Halide::Internal::Div::make(op0, op1);
                 DEBUG(10, tiramisu::str_dump("op type: o_div"));
                 break;
             case tiramisu::o_mod:
@@ -3685,6 +6123,10 @@ Halide::Expr generator::halide_expr_from_tiramisu_expr(const tiramisu::function
                 const auto &tiramisu_buffer = buffer_entry->second;
 
                 Halide::Type type = halide_type_from_tiramisu_type(tiramisu_buffer->get_elements_type());
+                if (tiramisu_buffer->get_complex_type() != p_none && tiramisu_expr.get_op_type() == tiramisu::o_access)
+                    type = halide_type_from_tiramisu_type(tiramisu_buffer->get_complex_type());
+                int accessed_dims = get_accessed_dims(tiramisu_buffer);
+                int complex_dims = tiramisu_buffer->get_dim_sizes().size() - accessed_dims;
 
                 // Tiramisu buffer is from outermost to innermost, whereas Halide buffer is from innermost
                 // to outermost; thus, we need to reverse the order
@@ -3715,6 +6157,7 @@ Halide::Expr generator::halide_expr_from_tiramisu_expr(const tiramisu::function
                         strides_vector.push_back(stride_expr);
                         stride_expr = stride_expr * generator::halide_expr_from_tiramisu_expr(fct, empty_index_expr, tiramisu_buffer->get_dim_sizes()[dim_idx], comp);
                     }
+                    strides_vector.erase(strides_vector.begin(), strides_vector.begin() + complex_dims);
                 }
                 DEBUG(10, tiramisu::str_dump("Buffer strides have been computed."));
 
@@ -3740,7 +6183,7 @@ Halide::Expr generator::halide_expr_from_tiramisu_expr(const tiramisu::function
                     {
                         DEBUG(10, tiramisu::str_dump("index_expr is empty. Retrieving access indices directly from the tiramisu access expression without scheduling."));
 
-                        for (int i = 0; i < tiramisu_buffer->get_dim_sizes().size(); i++)
+                        for (int i = 0; i < accessed_dims; i++)
                         {
 			    // Actually any computation access that does not require
 			    // scheduling is supported.
@@ -3761,20 +6204,23 @@ Halide::Expr generator::halide_expr_from_tiramisu_expr(const tiramisu::function
                         }
 
                         if (tiramisu_buffer->has_constant_extents())
-                            index = tiramisu::generator::linearize_access(tiramisu_buffer->get_dim_sizes().size(), shape, tiramisu_expr.get_access());
+                            index = tiramisu::generator::linearize_access(accessed_dims, shape + complex_dims, tiramisu_expr.get_access());
                         else
-                            index = tiramisu::generator::linearize_access(tiramisu_buffer->get_dim_sizes().size(), strides_vector, tiramisu_expr.get_access());
+                            index = tiramisu::generator::linearize_access(accessed_dims, strides_vector, tiramisu_expr.get_access());
                     }
                     else
                     {
                         DEBUG(10, tiramisu::str_dump("index_expr is NOT empty. Retrieving access indices from index_expr (i.e., retrieving indices adapted to the schedule)."));
                         if (tiramisu_buffer->has_constant_extents())
-                            index = tiramisu::generator::linearize_access(tiramisu_buffer->get_dim_sizes().size(), shape, index_expr[0]);
+                            index = tiramisu::generator::linearize_access(accessed_dims, shape + complex_dims, index_expr[0]);
                         else
-                            index = tiramisu::generator::linearize_access(tiramisu_buffer->get_dim_sizes().size(), strides_vector, index_expr[0]);
+                            index = tiramisu::generator::linearize_access(accessed_dims, strides_vector, index_expr[0]);
 
                         index_expr.erase(index_expr.begin());
                     }
+                    if (tiramisu_expr.get_op_type() == tiramisu::o_access)
+                        index = complex_access_index(tiramisu_buffer, index);
+
                     if (tiramisu_expr.get_op_type() == tiramisu::o_lin_index) {
                         result = index;
                     }
@@ -3792,6 +6238,8 @@ Halide::Expr generator::halide_expr_from_tiramisu_expr(const tiramisu::function
                                                             true,
                                                             tiramisu_buffer->get_dim_sizes().size(),
                                                             tiramisu_buffer->get_name());
+                        if (tiramisu_buffer->get_alignment() > 0)
+                            param.set_host_alignment(tiramisu_buffer->get_alignment());
 
                         // TODO(psuriana): ImageParam is not currently supported.
                         if (tiramisu_expr.get_op_type() != tiramisu::o_address_of) {
@@ -3816,6 +6264,8 @@ Halide::Expr generator::halide_expr_from_tiramisu_expr(const tiramisu::function
                                     type, tiramisu_buffer->get_name(), index, Halide::Buffer<>(),
                                     Halide::Internal::Parameter(), Halide::Internal::const_true(type.lanes()),
 				    Halide::Internal::ModulusRemainder());
+                        } else if (tiramisu_buffer->get_location() == cuda_ast::memory_location::global) {
+                            result = device_address_of(tiramisu_buffer, index);
                         } else {
                             result = Halide::Internal::Variable::make(Halide::type_of<struct halide_buffer_t *>(),
                                                                       tiramisu_buffer->get_name() + ".buffer");
@@ -3849,15 +6299,22 @@ Halide::Expr generator::halide_expr_from_tiramisu_expr(const tiramisu::function
                 DEBUG(10, tiramisu::str_dump("op type: o_floor"));
                 break;
             case tiramisu::o_cast:
-                result = Halide::cast(halide_type_from_tiramisu_type(tiramisu_expr.get_data_type()), op0);
+                // A real number is cast to a complex number with a null imaginary part
+                if (is_complex_type(tiramisu_expr.get_data_type()) && op0.type().is_scalar())
+                {
+                    Halide::Type t = halide_type_from_tiramisu_type(complex_component_type(tiramisu_expr.get_data_type()));
+                    result = Halide::Internal::Shuffle::make_interleave({Halide::cast(t, op0), Halide::Internal::make_zero(t)});
+                }
+                else
+                    result = Halide::cast(halide_type_from_tiramisu_type(tiramisu_expr.get_data_type()), op0);
                 DEBUG(10, tiramisu::str_dump("op type: o_cast"));
                 break;
             case tiramisu::o_sin:
-                result = Halide::sin(op0);
+                result = approximation.defined() ? approximation : Halide::sin(op0);
                 DEBUG(10, tiramisu::str_dump("op type: o_sin"));
                 break;
             case tiramisu::o_cos:
-                result = Halide::cos(op0);
+                result = approximation.defined() ? approximation : Halide::cos(op0);
                 DEBUG(10, tiramisu::str_dump("op type: o_cos"));
                 break;
             case tiramisu::o_tan:
@@ -3885,7 +6342,7 @@ Halide::Expr generator::halide_expr_from_tiramisu_expr(const tiramisu::function
                 DEBUG(10, tiramisu::str_dump("op type: o_cosh"));
                 break;
             case tiramisu::o_tanh:
-                result = Halide::tanh(op0);
+                result = approximation.defined() ? approximation : Halide::tanh(op0);
                 DEBUG(10, tiramisu::str_dump("op type: o_tanh"));
                 break;
             case tiramisu::o_asinh:
@@ -3909,11 +6366,11 @@ Halide::Expr generator::halide_expr_from_tiramisu_expr(const tiramisu::function
                 DEBUG(10, tiramisu::str_dump("op type: o_sqrt"));
                 break;
             case tiramisu::o_expo:
-                result = Halide::exp(op0);
+                result = approximation.defined() ? approximation : Halide::exp(op0);
                 DEBUG(10, tiramisu::str_dump("op type: o_expo"));
                 break;
             case tiramisu::o_log:
-                result = Halide::log(op0);
+                result = approximation.defined() ? approximation : Halide::log(op0);
                 DEBUG(10, tiramisu::str_dump("op type: o_log"));
                 break;
             case tiramisu::o_ceil:
@@ -3936,10 +6393,20 @@ Halide::Expr generator::halide_expr_from_tiramisu_expr(const tiramisu::function
                     Halide::Expr he = generator::halide_expr_from_tiramisu_expr(fct, index_expr, e, comp);
                     vec.push_back(he);
                 }
-                result = Halide::Internal::Call::make(halide_type_from_tiramisu_type(tiramisu_expr.get_data_type()),
-                                                      tiramisu_expr.get_name(),
-                                                      vec,
-                                                      Halide::Internal::Call::CallType::Extern);
+                // The operations on complex numbers (see make_complex())
+                if (tiramisu_expr.get_name() == "tiramisu_complex")
+                    result = Halide::Internal::Shuffle::make_interleave(vec);
+                else if (tiramisu_expr.get_name() == "tiramisu_real")
+                    result = Halide::Internal::Shuffle::make_extract_element(vec[0], 0);
+                else if (tiramisu_expr.get_name() == "tiramisu_imag")
+                    result = Halide::Internal::Shuffle::make_extract_element(vec[0], 1);
+                else if (tiramisu_expr.get_name() == "tiramisu_conj")
+                    result = complex_conj(vec[0]);
+                else
+                    result = Halide::Internal::Call::make(halide_type_from_tiramisu_type(tiramisu_expr.get_data_type()),
+                                                          tiramisu_expr.get_name(),
+                                                          vec,
+                                                          Halide::Internal::Call::CallType::Extern);
                 DEBUG(10, tiramisu::str_dump("op type: o_call"));
                 break;
             }
@@ -3985,16 +6452,24 @@ void function::gen_halide_obj(const std::string &obj_file_name, Halide::Target::
     // Halide::Target::OpenCL, etc.
     // Note: "make test" fails on Travis machines when AVX2 is used.
     //       Disable travis tests in .travis.yml if you switch to AVX2.
-    std::vector<Halide::Target::Feature> features =
-            {
-                    Halide::Target::AVX,
-                    Halide::Target::SSE41,
-                    //Halide::Target::AVX2,
-                    //Halide::Target::FMA,
-                    Halide::Target::LargeBuffers
-            };
+    // NEON is the baseline of 64-bit ARM, other architectures get no extension.
+    std::vector<Halide::Target::Feature> features;
+    if (arch == Halide::Target::X86)
+        features = {Halide::Target::AVX, Halide::Target::SSE41};
+
+    gen_halide_obj(obj_file_name, Halide::Target(os, arch, bits, features), hw_architecture, gen_python);
+}
+
+void function::gen_halide_obj(const std::string &obj_file_name, const Halide::Target &base_target,
+                              const tiramisu::hardware_architecture_t hw_architecture, bool gen_python) const
+{
+    Halide::Target target = base_target.with_feature(Halide::Target::LargeBuffers);
+    for (const auto &feature : this->target_features)
+        target.set_feature(feature);
 
-    Halide::Target target(os, arch, bits, features);
+    tiramisu_timer timer;
+    unsigned long isl_operations;
+    this->start_compile_phase(timer, isl_operations);
 
     std::vector<Halide::Argument> fct_arguments;
 
@@ -4009,24 +6484,205 @@ void function::gen_halide_obj(const std::string &obj_file_name, Halide::Target::
         fct_arguments.push_back(buffer_arg);
     }
 
-
-    Halide::Module m = lower_halide_pipeline(this->get_name(), target, fct_arguments,
-                                             Halide::LinkageType::ExternalPlusMetadata,
-                                             this->get_halide_stmt());
+    std::set<std::string> streaming_buffers;
+    for (const auto &b : this->get_buffers())
+        if (b.second->get_streaming_stores())
+            streaming_buffers.insert(b.first);
 
     std::map<Halide::OutputFileType, std::string> omap = {{Halide::OutputFileType::object, obj_file_name}, {Halide::OutputFileType::c_header, obj_file_name + ".h"},};
    
     //    m.compile(Halide::Output().c_header(obj_file_name + ".h"));
     if (hw_architecture == tiramisu::hardware_architecture_t::arch_flexnlp)
       omap[Halide::OutputFileType::c_source] = obj_file_name + "_generated.c";
+    if (hw_architecture == tiramisu::hardware_architecture_t::arch_opencl_gpu && !this->opencl_code.empty())
+    {
+        std::ofstream opencl_file(obj_file_name + "_opencl.cpp");
+        if (!opencl_file)
+            ERROR("Cannot write the OpenCL file " + obj_file_name + "_opencl.cpp.", true);
+        opencl_file << this->opencl_code << std::endl;
+    }
       //m.compile(Halide::Output().c_source2587(obj_file_name + "_generated.c"));
+    if (this->generate_raw_entry_point)
+    {
+        for (const auto &buf : this->function_arguments)
+            for (const auto &size : buf->get_dim_sizes())
+                if (size.get_expr_type() != tiramisu::e_val)
+                    ERROR("The size of the buffer " + buf->get_name() + " is not a constant, " +
+                          "the raw entry point cannot be generated.", true);
+
+        buffer_descriptor_checker checker(this->function_arguments);
+        this->get_halide_stmt().accept(&checker);
+
+        std::string halide_header = obj_file_name.substr(obj_file_name.find_last_of('/') + 1) + ".h";
+        write_raw_entry_point_header(this->get_name(), this->function_arguments, obj_file_name + "_raw.h", halide_header);
+    }
     if (gen_python){
       omap[Halide::OutputFileType::python_extension] = obj_file_name + ".py.cpp";
     }
 
-    m.compile(omap);
+    // nvcc runs in its own process and only needs the CUDA code, so overlap
+    // it with the generation of the host object by LLVM
+    std::future<bool> gpu_compilation;
     if (nvcc_compiler) {
-        nvcc_compiler->compile(obj_file_name);
+        std::shared_ptr<cuda_ast::compiler> compiler = nvcc_compiler;
+        gpu_compilation = std::async(std::launch::async, [compiler, obj_file_name]() {
+            return compiler->compile(obj_file_name);
+        });
+    }
+
+    // The generated files only depend on the statements of the entry points,
+    // their arguments and the target (the file names appear in the header)
+    std::ostringstream cache_options;
+    cache_options << obj_file_name << " " << (int) hw_architecture << " " << this->use_buffer_arena << " "
+                  << this->buffer_arena_size << " " << this->get_buffer_arena_name();
+    for (const auto &name : streaming_buffers)
+        cache_options << " " << name;
+    for (const auto &buf : this->function_arguments)
+        cache_options << " " << buf->is_mapped_file() << buf->get_mapped_file_by_fd();
+    cache_options << " " << this->generate_batched_entry_point << this->generate_raw_entry_point;
+    std::string cache_key = object_cache_key(this->get_name(), target, fct_arguments,
+                                             {this->get_halide_stmt(), this->inspector_halide_stmt, this->mapped_halide_stmt},
+                                             cache_options.str());
+
+    if (fetch_from_object_cache(cache_key, omap))
+    {
+        report_compile_time("gen_halide_obj (cached)", timer, isl_operations);
+        if (gpu_compilation.valid()) {
+            gpu_compilation.get();
+            report_compile_time("gen_halide_obj (nvcc)", timer, isl_operations);
+        }
+        return;
+    }
+
+    Halide::Module m = lower_halide_pipeline(this->get_name(), target, fct_arguments,
+                                             Halide::LinkageType::ExternalPlusMetadata,
+                                             this->get_halide_stmt(), streaming_buffers);
+
+    // When the temporary buffers are carved from a workspace, also generate the
+    // entry points NAME_workspace_size and NAME_with_workspace (see function::enable_buffer_arena()).
+    if (this->use_buffer_arena && this->buffer_arena_size > 0)
+    {
+        Halide::Argument size_arg("size", Halide::Argument::Kind::OutputBuffer, Halide::Int(64), 0, Halide::ArgumentEstimates{});
+
+        Halide::Internal::Stmt size_stmt = Halide::Internal::Store::make(
+                "size", Halide::Expr(this->buffer_arena_size), Halide::Expr(0), Halide::Internal::Parameter(),
+                Halide::Internal::const_true(), Halide::Internal::ModulusRemainder());
+
+        Halide::Module size_module = lower_halide_pipeline(this->get_name() + "_workspace_size", target, {size_arg},
+                                                           Halide::LinkageType::ExternalPlusMetadata, size_stmt);
+
+        std::vector<Halide::Argument> workspace_fct_arguments = fct_arguments;
+        workspace_fct_arguments.push_back(Halide::Argument(this->get_buffer_arena_name(), Halide::Argument::Kind::InputBuffer,
+                                                           Halide::UInt(8), 1, Halide::ArgumentEstimates{}));
+
+        Halide::Module workspace_module = lower_halide_pipeline(
+                this->get_name() + "_with_workspace", target, workspace_fct_arguments, Halide::LinkageType::ExternalPlusMetadata,
+                allocation_remover(this->get_buffer_arena_name()).mutate(this->get_halide_stmt()), streaming_buffers);
+
+        for (const auto &lowered_func : size_module.functions())
+            m.append(lowered_func);
+
+        for (const auto &lowered_func : workspace_module.functions())
+            m.append(lowered_func);
+    }
+
+    // The inspector computations are run by the entry point NAME_inspector
+    // (see computation::mark_as_inspector()).
+    if (this->inspector_halide_stmt.defined())
+    {
+        Halide::Module inspector_module = lower_halide_pipeline(
+                this->get_name() + "_inspector", target, fct_arguments, Halide::LinkageType::ExternalPlusMetadata,
+                this->inspector_halide_stmt);
+
+        for (const auto &lowered_func : inspector_module.functions())
+            m.append(lowered_func);
+    }
+
+    // The entry point NAME_mapped takes the files of the buffers mapped from
+    // files instead of these buffers (see buffer::set_mapped_file()).
+    if (this->mapped_halide_stmt.defined())
+    {
+        std::vector<Halide::Argument> mapped_fct_arguments;
+        for (int i = 0; i < this->function_arguments.size(); i++)
+        {
+            const tiramisu::buffer *buf = this->function_arguments[i];
+            if (!buf->is_mapped_file())
+                mapped_fct_arguments.push_back(fct_arguments[i]);
+            else if (buf->get_mapped_file_by_fd())
+                mapped_fct_arguments.push_back(Halide::Argument(buf->get_name() + "_fd", Halide::Argument::InputScalar,
+                                                                Halide::Int(32), 0, Halide::ArgumentEstimates{}));
+            else
+                mapped_fct_arguments.push_back(Halide::Argument(buf->get_name() + "_path", Halide::Argument::InputScalar,
+                                                                Halide::Handle(), 0, Halide::ArgumentEstimates{}));
+        }
+
+        Halide::Module mapped_module = lower_halide_pipeline(
+                this->get_name() + "_mapped", target, mapped_fct_arguments, Halide::LinkageType::ExternalPlusMetadata,
+                this->mapped_halide_stmt, streaming_buffers);
+
+        for (const auto &lowered_func : mapped_module.functions())
+            m.append(lowered_func);
+    }
+
+    // The entry point NAME_batched takes a batch of arguments, as an outermost
+    // dimension, and processes its elements in parallel (see function::enable_batching()).
+    if (this->generate_batched_entry_point && !this->function_arguments.empty())
+    {
+        std::vector<Halide::Argument> batched_fct_arguments;
+        for (const auto &buf : this->function_arguments)
+            batched_fct_arguments.push_back(Halide::Argument(
+                    buf->get_name(), halide_argtype_from_tiramisu_argtype(buf->get_argument_type()),
+                    halide_type_from_tiramisu_type(buf->get_elements_type()), buf->get_n_dims() + 1,
+                    Halide::ArgumentEstimates{}));
+
+        const tiramisu::buffer *first = this->function_arguments[0];
+        std::string batch_name = this->get_name() + "_batch";
+        Halide::Expr batch = Halide::Internal::Variable::make(Halide::Int(32), batch_name);
+        Halide::Expr batch_size = Halide::Internal::Call::make(
+                Halide::Int(32), Halide::Internal::Call::buffer_get_extent,
+                {Halide::Internal::Variable::make(Halide::type_of<struct halide_buffer_t *>(), first->get_name() + ".buffer"),
+                 first->get_n_dims()},
+                Halide::Internal::Call::Extern);
+
+        // The allocations of the body are inside the loop, so each element has its own temporaries
+        Halide::Internal::Stmt batched_stmt = Halide::Internal::For::make(
+                batch_name, 0, batch_size, Halide::Internal::ForType::Parallel, Halide::DeviceAPI::Host,
+                batch_offsetter(*this, batch).mutate(this->get_halide_stmt()));
+
+        Halide::Module batched_module = lower_halide_pipeline(
+                this->get_name() + "_batched", target, batched_fct_arguments, Halide::LinkageType::ExternalPlusMetadata,
+                batched_stmt, streaming_buffers);
+
+        for (const auto &lowered_func : batched_module.functions())
+            m.append(lowered_func);
+    }
+
+    // The entry point NAME_raw takes pointers to the arguments instead of
+    // their descriptors (see function::enable_raw_entry_point()).
+    if (this->generate_raw_entry_point)
+    {
+        std::vector<Halide::Argument> raw_fct_arguments;
+        for (const auto &buf : this->function_arguments)
+            raw_fct_arguments.push_back(Halide::Argument(buf->get_name(), Halide::Argument::InputScalar,
+                                                         Halide::Handle(), 0, Halide::ArgumentEstimates{}));
+
+        Halide::Module raw_module = lower_halide_pipeline(
+                this->get_name() + "_raw", target, raw_fct_arguments, Halide::LinkageType::External,
+                this->get_halide_stmt(), streaming_buffers);
+
+        for (const auto &lowered_func : raw_module.functions())
+            m.append(lowered_func);
+    }
+
+    report_compile_time("gen_halide_obj (Halide lowering)", timer, isl_operations);
+
+    m.compile(omap);
+    store_in_object_cache(cache_key, omap);
+    report_compile_time("gen_halide_obj (LLVM)", timer, isl_operations);
+
+    if (gpu_compilation.valid()) {
+        gpu_compilation.get();
+        report_compile_time("gen_halide_obj (nvcc, not overlapped with LLVM)", timer, isl_operations);
     }
 }
 
@@ -4161,6 +6817,10 @@ Halide::Expr halide_expr_from_tiramisu_type(tiramisu::primitive_t ptype) {
         case p_int64: return Halide::Expr((int64_t)0);
         case p_float32: return Halide::Expr((float)0);
         case p_float64: return Halide::Expr((double)0);
+        case p_float16: return Halide::Expr(Halide::float16_t(0.0));
+        case p_bfloat16: return Halide::Expr(Halide::bfloat16_t(0.0));
+        case p_complex64:
+        case p_complex128: return Halide::Internal::make_zero(halide_type_from_tiramisu_type(ptype));
         default: { assert(false && "Bad type specified"); return Halide::Expr(); }
     }
 }
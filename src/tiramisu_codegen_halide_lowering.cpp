@@ -1,7 +1,15 @@
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <set>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <tiramisu/debug.h>
+#include <tiramisu/expr.h>
 #include <Halide.h>
 
 using namespace Halide;
@@ -24,13 +32,97 @@ string stmt_to_string(const string &str, const Stmt &s)
     return stream.str();
 }
 
+/**
+  * Replace the contiguous vector stores of 128 or 256 bits to the buffers
+  * that have streaming stores by calls to the non-temporal store functions
+  * of the runtime (tiramisu_stream_store_*() in externs.h), and issue a
+  * fence after each loop that contains such stores.
+  */
+class inject_streaming_stores : public IRMutator
+{
+    const std::set<string> &streaming_buffers;
+
+    /**
+      * True if a streaming store was injected since the last fence.
+      */
+    bool needs_fence = false;
+
+    Stmt fence()
+    {
+        return Evaluate::make(Call::make(Int(32), "tiramisu_stream_fence", {}, Call::Extern));
+    }
+
+    using IRMutator::visit;
+
+    Stmt visit(const Store *op) override
+    {
+        const Ramp *ramp = op->index.as<Ramp>();
+        Type t = op->value.type();
+
+        if ((streaming_buffers.count(op->name) == 0) || (ramp == nullptr) ||
+            !is_const_one(ramp->stride) || !is_const_one(op->predicate) ||
+            ((t.bits() * t.lanes() != 128) && (t.bits() * t.lanes() != 256)) ||
+            !(t.is_float() || t.is_int() || t.is_uint()) || (t.bits() < 8))
+            return IRMutator::visit(op);
+
+        // Signed and unsigned integers have the same LLVM type, so they share a function
+        string name = "tiramisu_stream_store_" + string(t.is_float() ? "f" : "i") +
+                      std::to_string(t.bits()) + "x" + std::to_string(t.lanes());
+
+        Expr address = Call::make(Handle(), Call::address_of,
+                                  {Load::make(t.element_of(), op->name, ramp->base, Buffer<>(), op->param,
+                                              const_true(), op->alignment)},
+                                  Call::Intrinsic);
+
+        needs_fence = true;
+
+        return Evaluate::make(Call::make(Int(32), name, {address, mutate(op->value)}, Call::Extern));
+    }
+
+    Stmt visit(const For *op) override
+    {
+        bool outer_needs_fence = needs_fence;
+        needs_fence = false;
+
+        Stmt body = mutate(op->body);
+
+        // The stores of a parallel loop are fenced by the thread that executes them
+        if (needs_fence && (op->for_type == ForType::Parallel))
+        {
+            body = Block::make(body, fence());
+            needs_fence = false;
+        }
+
+        Stmt result = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+
+        if (needs_fence)
+            result = Block::make(result, fence());
+
+        needs_fence = outer_needs_fence;
+
+        return result;
+    }
+
+public:
+    inject_streaming_stores(const std::set<string> &streaming_buffers) : streaming_buffers(streaming_buffers) {}
+
+    Stmt run(const Stmt &s)
+    {
+        Stmt result = mutate(s);
+        if (needs_fence)
+            result = Block::make(result, fence());
+        return result;
+    }
+};
+
 } // anonymous namespace
 
 Module lower_halide_pipeline(const string &pipeline_name,
                              const Target &t,
                              const vector<Argument> &args,
                              const Halide::LinkageType linkage_type,
-                             Stmt s) //missing output_funcs, requirmenets, trace_pipeline, custom_passses, result_module
+                             Stmt s,
+                             const std::set<string> &streaming_buffers) //missing output_funcs, requirmenets, trace_pipeline, custom_passses, result_module
 {
   Module result_module(pipeline_name, t); //    Module result_module{extract_namespaces(pipeline_name), t};
 
@@ -278,6 +370,12 @@ Module lower_halide_pipeline(const string &pipeline_name,
     s = simplify(s);
     //log("Lowering after rewriting vector interleavings:", s);
 
+    if (!streaming_buffers.empty() && (t.arch == Target::X86))
+    {
+        s = inject_streaming_stores(streaming_buffers).run(s);
+        //log("Lowering after injecting streaming stores:", s);
+    }
+
     // debug(1) << "Partitioning loops to simplify boundary conditions...\n";
     s = partition_loops(s);
     s = simplify(s);
@@ -347,9 +445,11 @@ Module lower_halide_pipeline(const string &pipeline_name,
     // debug(1) << "Removing dead allocations and moving loop invariant code...\n";
     s = remove_dead_allocations(s);
     s = simplify(s);
-    //Removed because Tiramisu previously removed loop_invariant code motion
-    //    s = hoist_loop_invariant_values(s);
-    //    s = hoist_loop_invariant_if_statements(s);
+    if (tiramisu::global::is_loop_invariant_code_motion_set())
+    {
+        s = hoist_loop_invariant_values(s);
+        s = hoist_loop_invariant_if_statements(s);
+    }
     //log("Lowering after removing dead allocations and hoisting loop invariants:", s);
 
     // debug(1) << "Finding intrinsics...\n";
@@ -498,4 +598,117 @@ Module lower_halide_pipeline(const string &pipeline_name,
     return result_module;
 }
 
+namespace
+{
+
+string object_cache_directory()
+{
+    if (getenv("TIRAMISU_OBJECT_NO_CACHE"))
+        return "";
+    if (getenv("TIRAMISU_OBJECT_CACHE_DIR"))
+        return getenv("TIRAMISU_OBJECT_CACHE_DIR");
+    if (getenv("XDG_CACHE_HOME"))
+        return string(getenv("XDG_CACHE_HOME")) + "/tiramisu/objects";
+    if (getenv("HOME"))
+        return string(getenv("HOME")) + "/.cache/tiramisu/objects";
+    return "";
+}
+
+string object_cache_file(const string &key, OutputFileType type)
+{
+    return object_cache_directory() + "/" + key + "." + std::to_string((int) type);
+}
+
+bool copy_cached_file(const string &from, const string &to)
+{
+    std::ifstream in(from, std::ios::binary);
+    if (in.fail())
+        return false;
+    // Write to a temporary file first so that concurrent builds never see a
+    // partial file
+    string tmp = to + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out << in.rdbuf();
+        if (out.fail())
+            return false;
+    }
+    return std::rename(tmp.c_str(), to.c_str()) == 0;
+}
+
+} // anonymous namespace
+
+string object_cache_key(const string &pipeline_name, const Target &t, const vector<Argument> &args,
+                        const vector<Stmt> &stmts, const string &options)
+{
+    if (object_cache_directory().empty())
+        return "";
+
+    // The lowering passes depend on the build of the library and on the
+    // global options, not only on the statements
+    std::ostringstream contents;
+    contents << __DATE__ << " " << __TIME__ << "\n"
+             << pipeline_name << "\n" << t.to_string() << "\n"
+             << tiramisu::global::is_loop_invariant_code_motion_set() << "\n" << options << "\n";
+    for (const auto &arg : args)
+        contents << arg.name << " " << (int) arg.kind << " " << arg.type << " " << (int) arg.dimensions << "\n";
+    for (const auto &s : stmts)
+    {
+        if (s.defined())
+            contents << s;
+        contents << "\n--\n";
+    }
+
+    // 64-bit FNV-1a, which is stable across runs and builds
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : contents.str())
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    std::ostringstream key;
+    key << std::hex << hash;
+    return key.str();
+}
+
+bool fetch_from_object_cache(const string &key, const map<OutputFileType, string> &outputs)
+{
+    if (key.empty())
+        return false;
+
+    // The object is stored last, so if it is there, the other files are too
+    auto object = outputs.find(OutputFileType::object);
+    if (object != outputs.end() && !copy_cached_file(object_cache_file(key, object->first), object->second))
+        return false;
+
+    for (const auto &output : outputs)
+        if (output.first != OutputFileType::object && !copy_cached_file(object_cache_file(key, output.first), output.second))
+            return false;
+
+    DEBUG(3, tiramisu::str_dump("Reused the object files cached with the key " + key));
+    return true;
+}
+
+void store_in_object_cache(const string &key, const map<OutputFileType, string> &outputs)
+{
+    if (key.empty())
+        return;
+
+    string dir = object_cache_directory();
+    for (size_t pos = dir.find('/', 1); ; pos = dir.find('/', pos + 1))
+    {
+        mkdir(dir.substr(0, pos).c_str(), 0755);
+        if (pos == string::npos)
+            break;
+    }
+
+    for (const auto &output : outputs)
+        if (output.first != OutputFileType::object)
+            copy_cached_file(output.second, object_cache_file(key, output.first));
+
+    auto object = outputs.find(OutputFileType::object);
+    if (object != outputs.end())
+        copy_cached_file(object->second, object_cache_file(key, object->first));
+}
+
 }
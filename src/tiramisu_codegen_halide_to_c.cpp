@@ -69,9 +69,14 @@ string halide_type_to_tiramisu_type_str(Type type)
         {
             return "tiramisu::p_float64";
         }
+        else if (type.bits() == 16)
+        {
+            // is_float() is also true for bfloat16
+            return type.is_bfloat() ? "tiramisu::p_bfloat16" : "tiramisu::p_float16";
+        }
         else
         {
-            ERROR("Floats other than 32 and 64 bits are not suppored in Tiramisu.", true);
+            ERROR("Floats other than 16, 32 and 64 bits are not suppored in Tiramisu.", true);
         }
     }
     else if (type.is_bool())
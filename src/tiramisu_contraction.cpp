@@ -0,0 +1,390 @@
+#include <tiramisu/contraction.h>
+#include <tiramisu/debug.h>
+
+#include <algorithm>
+#include <iostream>
+
+namespace tiramisu {
+
+contraction::contraction(const std::string &name, const std::string &spec,
+                         const std::vector<tiramisu::buffer *> &operands, tiramisu::buffer *result,
+                         contraction_lowering_t lowering) : name(name)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    // Parse "ij,jk->ik"
+    size_t arrow = spec.find("->");
+    if (arrow == std::string::npos)
+        ERROR("The contraction " + spec + " has no \"->\".", true);
+
+    std::vector<std::string> operands_indices;
+    split_string(spec.substr(0, arrow), ",", operands_indices);
+    std::string result_indices = spec.substr(arrow + 2);
+
+    if (operands_indices.size() != operands.size())
+        ERROR("The contraction " + spec + " does not have " + std::to_string(operands.size()) + " operands.", true);
+    if (result_indices.empty())
+        ERROR("The result of the contraction " + spec + " should have at least one dimension.", true);
+
+    std::vector<tensor> tensors;
+    for (int i = 0; i <= operands.size(); i++)
+    {
+        tensor t = (i < operands.size()) ? tensor{operands[i], operands_indices[i]} : tensor{result, result_indices};
+        if (t.indices.size() != t.buf->get_n_dims())
+            ERROR("The indices " + t.indices + " do not match the dimensions of the buffer " + t.buf->get_name() + ".", true);
+
+        for (int d = 0; d < t.indices.size(); d++)
+            if (sizes.count(t.indices[d]) == 0)
+            {
+                sizes.insert({t.indices[d], t.buf->get_dim_sizes()[d]});
+                vars.insert({t.indices[d], var(name + "_" + t.indices[d], 0, t.buf->get_dim_sizes()[d])});
+            }
+
+        if (i < operands.size())
+            tensors.push_back(t);
+    }
+
+    for (char index : result_indices)
+        if (std::count(spec.begin(), spec.begin() + arrow, index) == 0)
+            ERROR(std::string("The index ") + index + " of the result is not an index of the operands.", true);
+
+    if (tensors.size() == 1)
+        this->lower_to_loop_nest(tensors[0], nullptr, {result, result_indices});
+
+    while (tensors.size() > 1)
+    {
+        // The indices that are still needed after a product: those of the
+        // result and of the other operands
+        auto needed_indices = [&](int a, int b) {
+            std::string needed = result_indices;
+            for (int t = 0; t < tensors.size(); t++)
+                if (t != a && t != b)
+                    needed += tensors[t].indices;
+            return needed;
+        };
+
+        // Pick the product that needs the fewest operations, then that has
+        // the smallest result
+        int best_a = 0, best_b = 1;
+        double best_flops = -1, best_size = -1;
+        for (int a = 0; a < tensors.size(); a++)
+            for (int b = a + 1; b < tensors.size(); b++)
+            {
+                std::string all = tensors[a].indices, kept;
+                for (char index : tensors[b].indices)
+                    if (all.find(index) == std::string::npos)
+                        all += index;
+
+                std::string needed = needed_indices(a, b);
+                for (char index : all)
+                    if (needed.find(index) != std::string::npos)
+                        kept += index;
+
+                double product_flops = 2 * get_estimated_size(all);
+                double product_size = get_estimated_size(kept);
+                if (best_flops < 0 || product_flops < best_flops ||
+                    (product_flops == best_flops && product_size < best_size))
+                {
+                    best_a = a;
+                    best_b = b;
+                    best_flops = product_flops;
+                    best_size = product_size;
+                }
+            }
+
+        const tensor a = tensors[best_a];
+        const tensor b = tensors[best_b];
+        std::string needed = needed_indices(best_a, best_b);
+
+        // The layout of an intermediate result is that of the result of a GEMM:
+        // the indices shared by a and b, then those of a, then those of b
+        tensor product;
+        if (tensors.size() == 2)
+            product = tensor{result, result_indices};
+        else
+        {
+            std::string batch, rows, columns;
+            for (char index : a.indices)
+                if (needed.find(index) != std::string::npos && (batch + rows).find(index) == std::string::npos)
+                    (b.indices.find(index) != std::string::npos ? batch : rows) += index;
+            for (char index : b.indices)
+                if (needed.find(index) != std::string::npos && (batch + rows + columns).find(index) == std::string::npos)
+                    columns += index;
+
+            product = tensor{nullptr, batch + rows + columns};
+            product.buf = create_temporary(product.indices, result->get_elements_type());
+        }
+
+        double loop_cost = best_flops / (CONTRACTION_LOOP_GFLOPS * 1e3);
+        double ttgt_cost = 0;
+        bool ttgt = (lowering != contraction_loop_nest) && this->lower_to_ttgt(a, b, product, true, ttgt_cost);
+        if (lowering == contraction_auto)
+            ttgt = ttgt && (ttgt_cost < loop_cost);
+
+        if (ttgt)
+            this->lower_to_ttgt(a, b, product, false, ttgt_cost);
+        else
+            this->lower_to_loop_nest(a, &b, product);
+
+        products.push_back(a.indices + "," + b.indices + "->" + product.indices + (ttgt ? " (TTGT, " : " (loop nest, ") +
+                           std::to_string(ttgt ? ttgt_cost : loop_cost) + " us)");
+        flops += best_flops;
+
+        tensors.erase(tensors.begin() + best_b);
+        tensors.erase(tensors.begin() + best_a);
+        tensors.push_back(product);
+    }
+
+    DEBUG(3, this->dump());
+
+    DEBUG_INDENT(-4);
+}
+
+double contraction::get_estimated_size(char index) const
+{
+    const tiramisu::expr &size = sizes.at(index);
+    if (size.get_expr_type() == tiramisu::e_val)
+        return size.get_int_val();
+    else
+        return CONTRACTION_DEFAULT_DIM_SIZE;
+}
+
+double contraction::get_estimated_size(const std::string &indices) const
+{
+    double size = 1;
+    for (char index : indices)
+        size *= get_estimated_size(index);
+    return size;
+}
+
+tiramisu::expr contraction::get_size(const std::string &indices) const
+{
+    tiramisu::expr size = 1;
+    for (char index : indices)
+        size = size * cast(p_int32, sizes.at(index));
+    return size;
+}
+
+void contraction::add_computation(tiramisu::computation *comp)
+{
+    if (!computations.empty())
+        computations.back()->then(*comp, computation::root);
+    computations.push_back(comp);
+}
+
+tiramisu::expr contraction::access(const tensor &t)
+{
+    auto it = inputs.find(t.buf);
+    if (it == inputs.end())
+    {
+        std::vector<tiramisu::var> iterators;
+        for (int d = 0; d < t.buf->get_n_dims(); d++)
+            iterators.push_back(var(name + "_" + t.buf->get_name() + "_" + std::to_string(d), 0, t.buf->get_dim_sizes()[d]));
+
+        tiramisu::input *in = new tiramisu::input(name + "_" + t.buf->get_name(), iterators, t.buf->get_elements_type());
+        in->store_in(t.buf);
+        it = inputs.insert({t.buf, in}).first;
+    }
+
+    std::vector<tiramisu::expr> indices;
+    for (char index : t.indices)
+        indices.push_back(vars.at(index));
+
+    return tiramisu::expr(tiramisu::o_access, it->second->get_name(), indices, t.buf->get_elements_type());
+}
+
+tiramisu::buffer *contraction::create_temporary(const std::string &indices, tiramisu::primitive_t type)
+{
+    std::vector<tiramisu::expr> dim_sizes;
+    for (char index : indices)
+        dim_sizes.push_back(sizes.at(index));
+
+    tiramisu::buffer *buf = new tiramisu::buffer("_" + name + "_tmp_" + std::to_string(temporaries.size()),
+                                                 dim_sizes, type, tiramisu::a_temporary);
+    temporaries.push_back(buf);
+    return buf;
+}
+
+contraction::tensor contraction::transpose(const tensor &t, const std::string &indices, tiramisu::buffer *destination)
+{
+    tensor transposed{destination, indices};
+    if (transposed.buf == nullptr)
+        transposed.buf = create_temporary(indices, t.buf->get_elements_type());
+
+    std::vector<tiramisu::var> iterators;
+    std::vector<tiramisu::expr> mapping;
+    for (char index : indices)
+    {
+        iterators.push_back(vars.at(index));
+        mapping.push_back(vars.at(index));
+    }
+
+    tiramisu::computation *copy = new tiramisu::computation(name + "_" + std::to_string(computations.size()),
+                                                            iterators, this->access(t));
+    copy->store_in(transposed.buf, mapping);
+    this->add_computation(copy);
+
+    return transposed;
+}
+
+void contraction::lower_to_loop_nest(const tensor &a, const tensor *b, const tensor &result)
+{
+    std::string summed;
+    for (char index : a.indices + (b ? b->indices : ""))
+        if (result.indices.find(index) == std::string::npos && summed.find(index) == std::string::npos)
+            summed += index;
+
+    tiramisu::expr value = this->access(a);
+    if (b != nullptr)
+        value = value * this->access(*b);
+
+    std::vector<tiramisu::var> result_iterators;
+    std::vector<tiramisu::expr> mapping;
+    for (char index : result.indices)
+    {
+        result_iterators.push_back(vars.at(index));
+        mapping.push_back(vars.at(index));
+    }
+
+    if (summed.empty())
+    {
+        tiramisu::computation *comp = new tiramisu::computation(name + "_" + std::to_string(computations.size()),
+                                                                result_iterators, value);
+        comp->store_in(result.buf, mapping);
+        this->add_computation(comp);
+        return;
+    }
+
+    tiramisu::computation *init = new tiramisu::computation(name + "_" + std::to_string(computations.size()),
+                                                            result_iterators,
+                                                            cast(result.buf->get_elements_type(), 0));
+    init->store_in(result.buf, mapping);
+    this->add_computation(init);
+
+    // The summed loops are between the outer loops of the result and its
+    // innermost loop, so that the innermost loop has unit stride in the result
+    std::string order = result.indices.substr(0, result.indices.size() - 1) + summed + result.indices.back();
+
+    std::vector<tiramisu::var> iterators;
+    std::vector<tiramisu::expr> self;
+    for (char index : order)
+    {
+        iterators.push_back(vars.at(index));
+        self.push_back(vars.at(index));
+    }
+
+    tiramisu::computation *update = new tiramisu::computation(name + "_" + std::to_string(computations.size()),
+                                                              iterators, result.buf->get_elements_type());
+    update->set_expression(tiramisu::expr(tiramisu::o_access, update->get_name(), self, result.buf->get_elements_type()) +
+                           cast(result.buf->get_elements_type(), value));
+    update->store_in(result.buf, mapping);
+    this->add_computation(update);
+}
+
+bool contraction::lower_to_ttgt(const tensor &a, const tensor &b, const tensor &result, bool dry_run, double &cost)
+{
+    tiramisu::primitive_t type = result.buf->get_elements_type();
+    if ((type != p_float32 && type != p_float64) ||
+        a.buf->get_elements_type() != type || b.buf->get_elements_type() != type)
+        return false;
+
+    // The batch (shared and kept), row (of a), column (of b) and summed indices
+    std::string batch, rows, columns, summed;
+    for (char index : a.indices)
+    {
+        bool in_b = (b.indices.find(index) != std::string::npos);
+        bool kept = (result.indices.find(index) != std::string::npos);
+        if (std::count(a.indices.begin(), a.indices.end(), index) > 1)
+            return false;
+        else if (in_b && kept)
+            batch += index;
+        else if (kept)
+            rows += index;
+        else if (in_b)
+            summed += index;
+        else
+            return false; // Summed over a only
+    }
+    for (char index : b.indices)
+    {
+        bool in_a = (a.indices.find(index) != std::string::npos);
+        bool kept = (result.indices.find(index) != std::string::npos);
+        if (std::count(b.indices.begin(), b.indices.end(), index) > 1 || (!in_a && !kept))
+            return false;
+        else if (!in_a)
+            columns += index;
+    }
+    if (result.indices.size() != batch.size() + rows.size() + columns.size())
+        return false;
+
+    // The operands are used in place if they are (possibly transposed) matrices
+    bool transpose_a = (a.indices == batch + summed + rows) && (a.indices != batch + rows + summed);
+    bool copy_a = (a.indices != batch + rows + summed) && !transpose_a;
+    bool transpose_b = (b.indices == batch + columns + summed) && (b.indices != batch + summed + columns);
+    bool copy_b = (b.indices != batch + summed + columns) && !transpose_b;
+    bool copy_result = (result.indices != batch + rows + columns);
+
+    double copied = (copy_a ? get_estimated_size(a.indices) : 0) + (copy_b ? get_estimated_size(b.indices) : 0) +
+                    (copy_result ? get_estimated_size(result.indices) : 0);
+    double bytes = 2 * copied * halide_type_from_tiramisu_type(type).bytes();
+
+    // The GEMM is less efficient on thin matrices
+    double smallest = std::min(get_estimated_size(rows), std::min(get_estimated_size(columns), get_estimated_size(summed)));
+    double efficiency = std::max(0.05, std::min(1.0, smallest / 64));
+    double gemm_flops = 2 * get_estimated_size(batch + rows + columns + summed);
+
+    cost = gemm_flops / (CONTRACTION_GEMM_GFLOPS * efficiency * 1e3) + bytes / (CONTRACTION_COPY_BANDWIDTH * 1e3) +
+           CONTRACTION_CALL_OVERHEAD;
+
+    if (dry_run)
+        return true;
+
+    tensor ga = copy_a ? this->transpose(a, batch + rows + summed) : a;
+    tensor gb = copy_b ? this->transpose(b, batch + summed + columns) : b;
+    tensor gc = copy_result ? tensor{create_temporary(batch + rows + columns, type), batch + rows + columns} : result;
+
+    tiramisu::expr gemm;
+    if (batch.empty())
+        gemm = cblas_gemm(*ga.buf, *gb.buf, *gc.buf, get_size(rows), get_size(columns), get_size(summed),
+                          1, 0, 0, 0, 0, 0, 0, 0, transpose_a, transpose_b);
+    else
+        gemm = cblas_gemm_strided_batched(*ga.buf, *gb.buf, *gc.buf, get_size(rows), get_size(columns), get_size(summed),
+                                          get_size(batch), 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, transpose_a, transpose_b);
+
+    this->add_computation(new tiramisu::computation(name + "_" + std::to_string(computations.size()), {}, gemm));
+
+    if (copy_result)
+        this->transpose(gc, result.indices, result.buf);
+
+    return true;
+}
+
+const std::vector<tiramisu::computation *> &contraction::get_computations() const
+{
+    return computations;
+}
+
+tiramisu::computation &contraction::get_first() const
+{
+    return *computations.front();
+}
+
+tiramisu::computation &contraction::get_last() const
+{
+    return *computations.back();
+}
+
+double contraction::get_flops() const
+{
+    return flops;
+}
+
+void contraction::dump() const
+{
+    std::cout << "Contraction " << name << " (" << flops << " FLOP):" << std::endl;
+    for (const std::string &product : products)
+        std::cout << "    " << product << std::endl;
+}
+
+}
@@ -0,0 +1,574 @@
+#include <tiramisu/convolution.h>
+#include <tiramisu/debug.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace tiramisu {
+
+namespace {
+
+bool get_constant(const tiramisu::expr &e, int64_t &value)
+{
+    if (e.get_expr_type() != tiramisu::e_val)
+        return false;
+    value = e.get_int_val();
+    return true;
+}
+
+std::string lowering_name(convolution_lowering_t l)
+{
+    switch (l)
+    {
+    case convolution_direct:
+        return "direct";
+    case convolution_gemm:
+        return "im2col + GEMM";
+    case convolution_winograd_2x2:
+        return "Winograd F(2x2, 3x3)";
+    case convolution_winograd_4x4:
+        return "Winograd F(4x4, 3x3)";
+    case convolution_fft:
+        return "FFT";
+    default:
+        return "auto";
+    }
+}
+
+/**
+  * The efficiency of a GEMM whose smallest dimension is \p smallest
+  * (see contraction::lower_to_ttgt()).
+  */
+double gemm_efficiency(double smallest)
+{
+    return std::max(0.05, std::min(1.0, smallest / 64));
+}
+
+}
+
+convolution::convolution(const std::string &name, tiramisu::buffer *input, tiramisu::buffer *weights,
+                         tiramisu::buffer *output, convolution_lowering_t l)
+    : name(name), input(input), weights(weights), output(output), lowering(l)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    if (input->get_n_dims() != 4 || weights->get_n_dims() != 4 || output->get_n_dims() != 4)
+        ERROR("The input, the weights and the output of the convolution " + name + " must have 4 dimensions.", true);
+
+    N = input->get_dim_sizes()[0];
+    C = input->get_dim_sizes()[1];
+    H = input->get_dim_sizes()[2];
+    W = input->get_dim_sizes()[3];
+    F = weights->get_dim_sizes()[0];
+    K = weights->get_dim_sizes()[2];
+    OH = output->get_dim_sizes()[2];
+    OW = output->get_dim_sizes()[3];
+
+    int64_t h, w, k, k2, oh, ow;
+    if (get_constant(K, k) && get_constant(weights->get_dim_sizes()[3], k2) && k != k2)
+        ERROR("The kernels of the convolution " + name + " must be square.", true);
+    if (get_constant(H, h) && get_constant(K, k) && get_constant(OH, oh) && oh != h - k + 1)
+        ERROR("The height of the output of the convolution " + name + " must be the height of the input - " +
+              "the size of the kernel + 1.", true);
+    if (get_constant(W, w) && get_constant(K, k) && get_constant(OW, ow) && ow != w - k + 1)
+        ERROR("The width of the output of the convolution " + name + " must be the width of the input - " +
+              "the size of the kernel + 1.", true);
+
+    if (lowering == convolution_auto)
+    {
+        double best_cost = -1;
+        for (convolution_lowering_t candidate : {convolution_direct, convolution_gemm, convolution_winograd_2x2,
+                                                 convolution_winograd_4x4, convolution_fft})
+            if (this->is_applicable(candidate))
+            {
+                double cost = this->estimate_cost(candidate);
+                if (best_cost < 0 || cost < best_cost)
+                {
+                    lowering = candidate;
+                    best_cost = cost;
+                }
+            }
+    }
+    else if (!this->is_applicable(lowering))
+        ERROR("The convolution " + name + " cannot be lowered with " + lowering_name(lowering) +
+              " (it needs constant spatial sizes, floating point elements, and 3x3 kernels for Winograd).", true);
+
+    int output_tile, input_tile;
+    switch (lowering)
+    {
+    case convolution_direct:
+        this->lower_to_direct();
+        break;
+    case convolution_gemm:
+        this->lower_to_gemm();
+        break;
+    case convolution_winograd_2x2:
+    case convolution_winograd_4x4:
+        this->get_tile_sizes(lowering, output_tile, input_tile);
+        this->lower_to_winograd(output_tile);
+        break;
+    default:
+        this->get_tile_sizes(lowering, output_tile, input_tile);
+        this->lower_to_fft(input_tile);
+        break;
+    }
+
+    DEBUG(3, this->dump());
+
+    DEBUG_INDENT(-4);
+}
+
+double convolution::get_estimated_size(const tiramisu::expr &size)
+{
+    int64_t value;
+    return get_constant(size, value) ? value : CONTRACTION_DEFAULT_DIM_SIZE;
+}
+
+bool convolution::is_applicable(convolution_lowering_t l) const
+{
+    if (l == convolution_direct)
+        return true;
+
+    tiramisu::primitive_t type = output->get_elements_type();
+    if ((type != p_float32 && type != p_float64) ||
+        input->get_elements_type() != type || weights->get_elements_type() != type)
+        return false;
+    if (l == convolution_gemm)
+        return true;
+
+    int64_t h, w, k;
+    if (!get_constant(H, h) || !get_constant(W, w) || !get_constant(K, k))
+        return false;
+    if (l == convolution_fft)
+        return k <= 15;
+    return k == 3;
+}
+
+void convolution::get_tile_sizes(convolution_lowering_t l, int &output_tile, int &input_tile) const
+{
+    int64_t k = 3;
+    get_constant(K, k);
+
+    if (l == convolution_fft)
+    {
+        input_tile = (k <= 4) ? 8 : 16;
+        output_tile = input_tile - k + 1;
+    }
+    else
+    {
+        output_tile = (l == convolution_winograd_2x2) ? 2 : 4;
+        input_tile = output_tile + 2;
+    }
+}
+
+double convolution::estimate_cost(convolution_lowering_t l) const
+{
+    double n = get_estimated_size(N), c = get_estimated_size(C), f = get_estimated_size(F);
+    double k = get_estimated_size(K), oh = get_estimated_size(OH), ow = get_estimated_size(OW);
+    double bytes = halide_type_from_tiramisu_type(output->get_elements_type()).bytes();
+    double flops = 2 * n * f * c * oh * ow * k * k;
+
+    if (l == convolution_direct)
+        return flops / (CONTRACTION_LOOP_GFLOPS * 1e3);
+
+    if (l == convolution_gemm)
+    {
+        // The im2col matrix is written and read, and the product is
+        // transposed into the layout of the output
+        double copied = 2 * c * k * k * n * oh * ow + 2 * n * f * oh * ow;
+        double smallest = std::min(f, std::min(n * oh * ow, c * k * k));
+        return flops / (CONTRACTION_GEMM_GFLOPS * gemm_efficiency(smallest) * 1e3) +
+               copied * bytes / (CONTRACTION_COPY_BANDWIDTH * 1e3) + CONTRACTION_CALL_OVERHEAD;
+    }
+
+    int m, a;
+    this->get_tile_sizes(l, m, a);
+    double tiles = n * std::ceil(oh / m) * std::ceil(ow / m);
+
+    // The FFT multiplies complex numbers, with real matrices twice as large
+    double complex = (l == convolution_fft) ? 2 : 1;
+    double gemm_flops = 2 * a * a * (complex * f) * (complex * c) * tiles;
+    double smallest = std::min(complex * f, std::min(tiles, complex * c));
+
+    // Each transform is two products by a small matrix, with complex
+    // numbers (two products each) for the FFT
+    double transform_flops = 2 * complex * complex * (c * tiles * 2 * a * a * a +
+                                                      f * tiles * (a * a * m + a * m * m) +
+                                                      f * c * (a * k * k + a * a * k));
+    double copied = 2 * a * a * complex * (c + f) * tiles;
+
+    return gemm_flops / (CONTRACTION_GEMM_GFLOPS * gemm_efficiency(smallest) * 1e3) +
+           transform_flops / (CONTRACTION_LOOP_GFLOPS * 1e3) +
+           copied * bytes / (CONTRACTION_COPY_BANDWIDTH * 1e3) + CONTRACTION_CALL_OVERHEAD;
+}
+
+void convolution::add_computation(tiramisu::computation *comp)
+{
+    if (!computations.empty())
+        computations.back()->then(*comp, computation::root);
+    computations.push_back(comp);
+}
+
+tiramisu::computation *convolution::add_computation(const std::vector<tiramisu::var> &iterators,
+                                                    const tiramisu::expr &e, tiramisu::buffer *buf,
+                                                    const std::vector<tiramisu::expr> &mapping,
+                                                    const tiramisu::expr &predicate)
+{
+    std::string comp_name = name + "_" + std::to_string(computations.size());
+    tiramisu::computation *comp = predicate.is_defined() ?
+                                  new tiramisu::computation(comp_name, iterators, predicate, e) :
+                                  new tiramisu::computation(comp_name, iterators, e);
+    comp->store_in(buf, mapping);
+    this->add_computation(comp);
+    return comp;
+}
+
+tiramisu::var convolution::make_var(const std::string &suffix, const tiramisu::expr &size) const
+{
+    return var(name + "_" + suffix, 0, size);
+}
+
+tiramisu::expr convolution::access(tiramisu::buffer *buf, const std::vector<tiramisu::expr> &indices)
+{
+    auto it = inputs.find(buf);
+    if (it == inputs.end())
+    {
+        std::vector<tiramisu::var> iterators;
+        for (int d = 0; d < buf->get_n_dims(); d++)
+            iterators.push_back(var(name + "_" + buf->get_name() + "_" + std::to_string(d), 0, buf->get_dim_sizes()[d]));
+
+        tiramisu::input *in = new tiramisu::input(name + "_" + buf->get_name(), iterators, buf->get_elements_type());
+        in->store_in(buf);
+        it = inputs.insert({buf, in}).first;
+    }
+
+    return tiramisu::expr(tiramisu::o_access, it->second->get_name(), indices, buf->get_elements_type());
+}
+
+tiramisu::expr convolution::access(const tiramisu::computation *comp, const std::vector<tiramisu::expr> &indices)
+{
+    return tiramisu::expr(tiramisu::o_access, comp->get_name(), indices, comp->get_data_type());
+}
+
+tiramisu::expr convolution::constant(double value) const
+{
+    if (output->get_elements_type() == p_float32)
+        return tiramisu::expr((float) value);
+    return tiramisu::expr(value);
+}
+
+tiramisu::buffer *convolution::create_temporary(const std::vector<tiramisu::expr> &sizes)
+{
+    tiramisu::buffer *buf = new tiramisu::buffer("_" + name + "_tmp_" + std::to_string(temporaries.size()),
+                                                 sizes, output->get_elements_type(), tiramisu::a_temporary);
+    temporaries.push_back(buf);
+    return buf;
+}
+
+tiramisu::computation *convolution::create_matrix(const std::vector<std::vector<double>> &values)
+{
+    int rows = values.size(), columns = values[0].size();
+    std::string suffix = "m" + std::to_string(temporaries.size());
+    tiramisu::var i = make_var(suffix + "_i", rows), j = make_var(suffix + "_j", columns);
+
+    tiramisu::expr value = constant(0);
+    for (int r = 0; r < rows; r++)
+        for (int c = 0; c < columns; c++)
+            if (values[r][c] != 0)
+                value = tiramisu::expr(tiramisu::o_select, (i == r) && (j == c), constant(values[r][c]), value);
+
+    return this->add_computation({i, j}, value, create_temporary({rows, columns}), {i, j});
+}
+
+tiramisu::buffer *convolution::pad_input(int64_t height, int64_t width)
+{
+    int64_t h, w;
+    get_constant(H, h);
+    get_constant(W, w);
+    if (height <= h && width <= w)
+        return input;
+
+    height = std::max(height, h);
+    width = std::max(width, w);
+
+    tiramisu::buffer *padded = create_temporary({N, C, (int32_t) height, (int32_t) width});
+    tiramisu::var n = make_var("pad_n", N), c = make_var("pad_c", C);
+    tiramisu::var y = make_var("pad_y", (int32_t) height), x = make_var("pad_x", (int32_t) width);
+    tiramisu::var iy = make_var("pad_iy", H), ix = make_var("pad_ix", W);
+
+    this->add_computation({n, c, y, x}, constant(0), padded, {n, c, y, x});
+    this->add_computation({n, c, iy, ix}, access(input, {n, c, iy, ix}), padded, {n, c, iy, ix});
+
+    return padded;
+}
+
+void convolution::multiply_tiles(tiramisu::buffer *transformed_weights, tiramisu::buffer *transformed_input,
+                                 tiramisu::buffer *product)
+{
+    gemm = new tiramisu::contraction(name + "_gemm", "uvfc,uvcntw->uvfntw", {transformed_weights, transformed_input},
+                                     product);
+    for (tiramisu::computation *comp : gemm->get_computations())
+        this->add_computation(comp);
+}
+
+void convolution::lower_to_direct()
+{
+    tiramisu::primitive_t type = output->get_elements_type();
+    tiramisu::var n = make_var("n", N), f = make_var("f", F), y = make_var("y", OH), x = make_var("x", OW);
+    tiramisu::var c = make_var("c", C), ky = make_var("ky", K), kx = make_var("kx", K);
+
+    this->add_computation({n, f, y, x}, cast(type, 0), output, {n, f, y, x});
+
+    // The reduction loops are between y and x, so that the innermost loop
+    // has unit stride in the input and in the output
+    tiramisu::computation *update = new tiramisu::computation(name + "_" + std::to_string(computations.size()),
+                                                              {n, f, y, c, ky, kx, x}, type);
+    update->set_expression(access(update, {n, f, y, c, ky, kx, x}) +
+                           cast(type, access(input, {n, c, y + ky, x + kx}) * access(weights, {f, c, ky, kx})));
+    update->store_in(output, {n, f, y, x});
+    this->add_computation(update);
+}
+
+void convolution::lower_to_gemm()
+{
+    tiramisu::var n = make_var("n", N), y = make_var("y", OH), x = make_var("x", OW);
+    tiramisu::var c = make_var("c", C), ky = make_var("ky", K), kx = make_var("kx", K);
+
+    tiramisu::buffer *columns = create_temporary({C, K, K, N, OH, OW});
+    this->add_computation({c, ky, kx, n, y, x}, access(input, {n, c, y + ky, x + kx}), columns, {c, ky, kx, n, y, x});
+
+    gemm = new tiramisu::contraction(name + "_gemm", "fcab,cabnhw->nfhw", {weights, columns}, output);
+    for (tiramisu::computation *comp : gemm->get_computations())
+        this->add_computation(comp);
+}
+
+void convolution::lower_to_winograd(int m)
+{
+    int a = m + 2;
+    int64_t oh, ow;
+    get_constant(OH, oh);
+    get_constant(OW, ow);
+    int th = (oh + m - 1) / m, tw = (ow + m - 1) / m;
+
+    std::vector<std::vector<double>> bt_values, g_values, at_values;
+    if (m == 2)
+    {
+        bt_values = {{1, 0, -1, 0}, {0, 1, 1, 0}, {0, -1, 1, 0}, {0, 1, 0, -1}};
+        g_values = {{1, 0, 0}, {0.5, 0.5, 0.5}, {0.5, -0.5, 0.5}, {0, 0, 1}};
+        at_values = {{1, 1, 1, 0}, {0, 1, -1, -1}};
+    }
+    else
+    {
+        bt_values = {{4, 0, -5, 0, 1, 0}, {0, -4, -4, 1, 1, 0}, {0, 4, -4, -1, 1, 0},
+                     {0, -2, -1, 2, 1, 0}, {0, 2, -1, -2, 1, 0}, {0, 4, 0, -5, 0, 1}};
+        g_values = {{1.0 / 4, 0, 0}, {-1.0 / 6, -1.0 / 6, -1.0 / 6}, {-1.0 / 6, 1.0 / 6, -1.0 / 6},
+                    {1.0 / 24, 1.0 / 12, 1.0 / 6}, {1.0 / 24, -1.0 / 12, 1.0 / 6}, {0, 0, 1}};
+        at_values = {{1, 1, 1, 1, 1, 0}, {0, 1, -1, 2, -2, 0}, {0, 1, 1, 4, 4, 0}, {0, 1, -1, 8, -8, 1}};
+    }
+
+    tiramisu::buffer *tiled_input = this->pad_input((th - 1) * m + a, (tw - 1) * m + a);
+    tiramisu::computation *bt = create_matrix(bt_values);
+    tiramisu::computation *g = create_matrix(g_values);
+    tiramisu::computation *at = create_matrix(at_values);
+
+    tiramisu::var n = make_var("n", N), f = make_var("f", F), c = make_var("c", C);
+    tiramisu::var ty = make_var("ty", th), tx = make_var("tx", tw);
+    tiramisu::var u = make_var("u", a), v = make_var("v", a), j = make_var("j", a);
+    tiramisu::var k = make_var("k", 3), y = make_var("y", m), x = make_var("x", m);
+
+    // Weights: U = G g G^T
+    tiramisu::expr value = constant(0);
+    for (int i = 0; i < 3; i++)
+        value = value + access(g, {u, i}) * access(weights, {f, c, i, k});
+    tiramisu::computation *gw = this->add_computation({f, c, u, k}, value, create_temporary({F, C, a, 3}), {f, c, u, k});
+
+    tiramisu::buffer *transformed_weights = create_temporary({a, a, F, C});
+    value = constant(0);
+    for (int i = 0; i < 3; i++)
+        value = value + access(gw, {f, c, u, i}) * access(g, {v, i});
+    this->add_computation({u, v, f, c}, value, transformed_weights, {u, v, f, c});
+
+    // Input tiles: V = B^T d B
+    value = constant(0);
+    for (int i = 0; i < a; i++)
+        value = value + access(bt, {u, i}) * access(tiled_input, {n, c, ty * m + i, tx * m + j});
+    tiramisu::computation *btd = this->add_computation({n, c, ty, tx, u, j}, value,
+                                                       create_temporary({N, C, th, tw, a, a}), {n, c, ty, tx, u, j});
+
+    tiramisu::buffer *transformed_input = create_temporary({a, a, C, N, th, tw});
+    value = constant(0);
+    for (int i = 0; i < a; i++)
+        value = value + access(btd, {n, c, ty, tx, u, i}) * access(bt, {v, i});
+    this->add_computation({u, v, c, n, ty, tx}, value, transformed_input, {u, v, c, n, ty, tx});
+
+    // M[u, v] = sum over c of U[u, v] * V[u, v]
+    tiramisu::buffer *product = create_temporary({a, a, F, N, th, tw});
+    this->multiply_tiles(transformed_weights, transformed_input, product);
+
+    // Output tiles: Y = A^T M A
+    value = constant(0);
+    for (int i = 0; i < a; i++)
+        value = value + access(at, {y, i}) * access(product, {i, v, f, n, ty, tx});
+    tiramisu::computation *atm = this->add_computation({n, f, ty, tx, y, v}, value,
+                                                       create_temporary({N, F, th, tw, m, a}), {n, f, ty, tx, y, v});
+
+    value = constant(0);
+    for (int i = 0; i < a; i++)
+        value = value + access(atm, {n, f, ty, tx, y, i}) * access(at, {x, i});
+    tiramisu::expr inside;
+    if (oh % m != 0 || ow % m != 0)
+        inside = (ty * m + y < (int32_t) oh) && (tx * m + x < (int32_t) ow);
+    this->add_computation({n, f, ty, tx, y, x}, value, output, {n, f, ty * m + y, tx * m + x}, inside);
+}
+
+void convolution::lower_to_fft(int a)
+{
+    int64_t oh, ow, k;
+    get_constant(OH, oh);
+    get_constant(OW, ow);
+    get_constant(K, k);
+    int m = a - k + 1;
+    int th = (oh + m - 1) / m, tw = (ow + m - 1) / m;
+
+    // The DFT matrix, F[u, i] = exp(-2 pi i u i / a) = fr[u, i] + i fi[u, i]
+    std::vector<std::vector<double>> fr_values(a, std::vector<double>(a)), fi_values(a, std::vector<double>(a));
+    for (int u = 0; u < a; u++)
+        for (int i = 0; i < a; i++)
+        {
+            double angle = 2 * M_PI * ((u * i) % a) / a;
+            fr_values[u][i] = std::cos(angle);
+            fi_values[u][i] = -std::sin(angle);
+        }
+
+    tiramisu::buffer *tiled_input = this->pad_input((th - 1) * m + a, (tw - 1) * m + a);
+    tiramisu::computation *fr = create_matrix(fr_values);
+    tiramisu::computation *fi = create_matrix(fi_values);
+
+    tiramisu::expr F2 = (int32_t) (2 * get_estimated_size(F)), C2 = (int32_t) (2 * get_estimated_size(C));
+    int64_t value_f, value_c;
+    if (!get_constant(F, value_f))
+        F2 = 2 * F;
+    if (!get_constant(C, value_c))
+        C2 = 2 * C;
+
+    tiramisu::var n = make_var("n", N), f = make_var("f", F), c = make_var("c", C);
+    tiramisu::var ty = make_var("ty", th), tx = make_var("tx", tw);
+    tiramisu::var u = make_var("u", a), v = make_var("v", a), j = make_var("j", a);
+    tiramisu::var kj = make_var("k", (int32_t) k), x = make_var("x", m), y = make_var("y", m);
+
+    // Weights: G = F g F^T, stored as the real matrix [Gr Gi; -Gi Gr] so
+    // that the GEMM computes the product of the tiles by the conjugate of G
+    // (the convolution of CNNs is a correlation)
+    tiramisu::expr qr = constant(0), qi = constant(0);
+    for (int i = 0; i < k; i++)
+    {
+        qr = qr + access(fr, {u, i}) * access(weights, {f, c, i, kj});
+        qi = qi + access(fi, {u, i}) * access(weights, {f, c, i, kj});
+    }
+    tiramisu::computation *wr = this->add_computation({f, c, u, kj}, qr, create_temporary({F, C, a, (int32_t) k}),
+                                                      {f, c, u, kj});
+    tiramisu::computation *wi = this->add_computation({f, c, u, kj}, qi, create_temporary({F, C, a, (int32_t) k}),
+                                                      {f, c, u, kj});
+
+    tiramisu::buffer *transformed_weights = create_temporary({a, a, F2, C2});
+    tiramisu::expr gr = constant(0), gi = constant(0);
+    for (int i = 0; i < k; i++)
+    {
+        gr = gr + access(wr, {f, c, u, i}) * access(fr, {v, i}) - access(wi, {f, c, u, i}) * access(fi, {v, i});
+        gi = gi + access(wr, {f, c, u, i}) * access(fi, {v, i}) + access(wi, {f, c, u, i}) * access(fr, {v, i});
+    }
+    tiramisu::computation *gwr = this->add_computation({u, v, f, c}, gr, transformed_weights, {u, v, f, c});
+    tiramisu::computation *gwi = this->add_computation({u, v, f, c}, gi, transformed_weights, {u, v, f, C + c});
+    this->add_computation({u, v, f, c}, -access(gwi, {u, v, f, c}), transformed_weights, {u, v, F + f, c});
+    this->add_computation({u, v, f, c}, access(gwr, {u, v, f, c}), transformed_weights, {u, v, F + f, C + c});
+
+    // Input tiles: D = F d F^T, stored as [Dr; Di]
+    tiramisu::expr pr = constant(0), pi = constant(0);
+    for (int i = 0; i < a; i++)
+    {
+        tiramisu::expr d = access(tiled_input, {n, c, ty * m + i, tx * m + j});
+        pr = pr + access(fr, {u, i}) * d;
+        pi = pi + access(fi, {u, i}) * d;
+    }
+    tiramisu::computation *dr = this->add_computation({n, c, ty, tx, u, j}, pr, create_temporary({N, C, th, tw, a, a}),
+                                                      {n, c, ty, tx, u, j});
+    tiramisu::computation *di = this->add_computation({n, c, ty, tx, u, j}, pi, create_temporary({N, C, th, tw, a, a}),
+                                                      {n, c, ty, tx, u, j});
+
+    tiramisu::buffer *transformed_input = create_temporary({a, a, C2, N, th, tw});
+    tiramisu::expr vr = constant(0), vi = constant(0);
+    for (int i = 0; i < a; i++)
+    {
+        tiramisu::expr r = access(dr, {n, c, ty, tx, u, i}), im = access(di, {n, c, ty, tx, u, i});
+        vr = vr + r * access(fr, {v, i}) - im * access(fi, {v, i});
+        vi = vi + r * access(fi, {v, i}) + im * access(fr, {v, i});
+    }
+    this->add_computation({u, v, c, n, ty, tx}, vr, transformed_input, {u, v, c, n, ty, tx});
+    this->add_computation({u, v, c, n, ty, tx}, vi, transformed_input, {u, v, C + c, n, ty, tx});
+
+    // M = D * conj(G), the real parts in the rows [0, F) and the imaginary
+    // parts in the rows [F, 2F)
+    tiramisu::buffer *product = create_temporary({a, a, F2, N, th, tw});
+    this->multiply_tiles(transformed_weights, transformed_input, product);
+
+    // Output tiles: the real part of the inverse DFT of M, at [0, m) x [0, m)
+    tiramisu::expr er = constant(0), ei = constant(0);
+    for (int i = 0; i < a; i++)
+    {
+        tiramisu::expr r = access(product, {u, i, f, n, ty, tx}), im = access(product, {u, i, F + f, n, ty, tx});
+        er = er + r * access(fr, {i, x}) + im * access(fi, {i, x});
+        ei = ei + im * access(fr, {i, x}) - r * access(fi, {i, x});
+    }
+    tiramisu::computation *inverse_r = this->add_computation({n, f, ty, tx, u, x}, er,
+                                                             create_temporary({N, F, th, tw, a, m}),
+                                                             {n, f, ty, tx, u, x});
+    tiramisu::computation *inverse_i = this->add_computation({n, f, ty, tx, u, x}, ei,
+                                                             create_temporary({N, F, th, tw, a, m}),
+                                                             {n, f, ty, tx, u, x});
+
+    tiramisu::expr value = constant(0);
+    for (int i = 0; i < a; i++)
+        value = value + access(inverse_r, {n, f, ty, tx, i, x}) * access(fr, {i, y}) +
+                        access(inverse_i, {n, f, ty, tx, i, x}) * access(fi, {i, y});
+    tiramisu::expr inside;
+    if (oh % m != 0 || ow % m != 0)
+        inside = (ty * m + y < (int32_t) oh) && (tx * m + x < (int32_t) ow);
+    this->add_computation({n, f, ty, tx, y, x}, value * constant(1.0 / (a * a)), output,
+                          {n, f, ty * m + y, tx * m + x}, inside);
+}
+
+const std::vector<tiramisu::computation *> &convolution::get_computations() const
+{
+    return computations;
+}
+
+tiramisu::computation &convolution::get_first() const
+{
+    return *computations.front();
+}
+
+tiramisu::computation &convolution::get_last() const
+{
+    return *computations.back();
+}
+
+convolution_lowering_t convolution::get_lowering() const
+{
+    return lowering;
+}
+
+void convolution::dump() const
+{
+    std::cout << "Convolution " << name << ":" << std::endl;
+    for (convolution_lowering_t l : {convolution_direct, convolution_gemm, convolution_winograd_2x2,
+                                     convolution_winograd_4x4, convolution_fft})
+        if (this->is_applicable(l))
+            std::cout << "    " << lowering_name(l) << ": " << this->estimate_cost(l) << " us"
+                      << ((l == lowering) ? " (used)" : "") << std::endl;
+    if (gemm != nullptr)
+        gemm->dump();
+}
+
+}
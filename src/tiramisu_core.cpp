@@ -7,26 +7,31 @@
 #include <isl/union_map.h>
 #include <isl/union_set.h>
 #include <isl/ast_build.h>
+#include <isl/ilp.h>
 
 #include <tiramisu/debug.h>
 #include <tiramisu/core.h>
 
+#include <limits>
+
 #ifdef _WIN32
 #include <iso646.h>
 #endif
 
 namespace tiramisu
 {
-int send::next_msg_tag = 0;
-std::set<int> tiramisu::xfer_prop::xfer_prop_ids;
+thread_local int send::next_msg_tag = 0;
+thread_local std::set<int> tiramisu::xfer_prop::xfer_prop_ids;
 // Used for the generation of new variable names.
-int id_counter = 0;
-static int next_dim_name = 0;
-
-bool global::auto_data_mapping = false;
-primitive_t global::loop_iterator_type = p_int32;
-function *global::implicit_fct;
-std::unordered_map<std::string, var> var::declared_vars;
+static thread_local int id_counter = 0;
+static thread_local int next_dim_name = 0;
+
+thread_local bool global::auto_data_mapping = false;
+thread_local primitive_t global::loop_iterator_type = p_int32;
+thread_local bool global::loop_invariant_code_motion = false;
+thread_local int global::buffer_name_counter = 0;
+thread_local function *global::implicit_fct = NULL;
+thread_local std::unordered_map<std::string, var> var::declared_vars;
 const var computation::root = var("root");
 
 std::string generate_new_variable_name();
@@ -69,8 +74,22 @@ isl_map *add_ineq_to_schedule_map(int duplicate_ID, int dim0, int in_dim_coeffic
 
 //********************************************************
 
+void global::reset_state()
+{
+    var::declared_vars.clear();
+    send::next_msg_tag = 0;
+    xfer_prop::xfer_prop_ids.clear();
+    id_counter = 0;
+    next_dim_name = 0;
+    global::buffer_name_counter = 0;
+    tiramisu_indentation = 0;
+    set_default_tiramisu_options();
+}
+
 void init(std::string fct_name)
 {
+    global::reset_state();
+
     function *fct = new function(fct_name);
     global::set_implicit_function(fct);
 
@@ -97,6 +116,26 @@ void init()
     fct->codegen(arguments, obj_filename, gen_architecture_flag, gen_python = gen_python);
 }
 
+Halide::Internal::JITModule jit(const std::vector<tiramisu::buffer *> &arguments)
+{
+    function *fct = global::get_implicit_function();
+    return fct->jit(arguments);
+}
+
+void codegen_c(const std::vector<tiramisu::buffer *> &arguments, const std::string &c_filename)
+{
+    function *fct = global::get_implicit_function();
+    fct->codegen_c(arguments, c_filename);
+}
+
+std::vector<tiramisu::buffer *> codegen_with_init(const std::vector<tiramisu::buffer *> &arguments,
+                                                  const std::string &obj_filename,
+                                                  const std::string &init_obj_filename)
+{
+    function *fct = global::get_implicit_function();
+    return fct->codegen_with_init(arguments, obj_filename, init_obj_filename);
+}
+
 bool check_legality_of_function()
 {
     function *fct = global::get_implicit_function();
@@ -116,6 +155,25 @@ void prepare_schedules_for_legality_checks(bool reset_static_dimesion)
     fct->prepare_schedules_for_legality_checks(reset_static_dimesion);
 }
 
+std::vector<tiramisu::fusion_info> fuse_producer_consumer_chains(bool apply)
+{
+    function *fct = global::get_implicit_function();
+    return fct->fuse_producer_consumer_chains(apply);
+}
+
+tiramisu::fusion_info fuse_with_shifting(tiramisu::computation *producer, tiramisu::computation *consumer,
+                                         int level, bool apply)
+{
+    function *fct = global::get_implicit_function();
+    return fct->fuse_with_shifting(producer, consumer, level, apply);
+}
+
+bool compute_polyhedral_schedule(int tile_size, bool parallelize)
+{
+    function *fct = global::get_implicit_function();
+    return fct->compute_polyhedral_schedule(tile_size, parallelize);
+}
+
 bool loop_parallelization_is_legal(tiramisu::var i, std::vector<tiramisu::computation *> fused_computations)
 {
     function *fct = global::get_implicit_function();
@@ -134,6 +192,13 @@ bool loop_vectorization_is_legal(tiramisu::var i, std::vector<tiramisu::computat
     return fct->loop_vectorization_is_legal(i,fused_computations);
 }
 
+bool loop_distribution_is_legal(int level, std::vector<tiramisu::computation *> first_computations,
+                                std::vector<tiramisu::computation *> second_computations)
+{
+    function *fct = global::get_implicit_function();
+    return fct->loop_distribution_is_legal(level, first_computations, second_computations);
+}
+
 
 //********************************************************
 
@@ -332,6 +397,15 @@ void tiramisu::computation::rename_computation(std::string new_name)
     for (auto &pd : this->get_function()->parallel_dimensions)
         if (pd.first == old_name)
             pd.first = new_name;
+    for (auto &pd : this->get_function()->doacross_dimensions)
+        if (std::get<0>(pd) == old_name)
+            std::get<0>(pd) = new_name;
+    for (auto &pd : this->get_function()->pipeline_dimensions)
+        if (std::get<0>(pd) == old_name)
+            std::get<0>(pd) = new_name;
+    for (auto &pd : this->get_function()->prefetch_dimensions)
+        if (std::get<0>(pd) == old_name)
+            std::get<0>(pd) = new_name;
     for (auto &pd : this->get_function()->gpu_block_dimensions)
         if (pd.first == old_name)
             pd.first = new_name;
@@ -429,6 +503,57 @@ void computation::tag_gpu_level(tiramisu::var L0_var, tiramisu::var L1_var,
     DEBUG_INDENT(-4);
 }
 
+void computation::tag_gpu_tensor_core(tiramisu::var L_i, tiramisu::var L_j, tiramisu::var L_k)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L_i.get_name().length() > 0);
+    assert(L_j.get_name().length() > 0);
+    assert(L_k.get_name().length() > 0);
+
+    std::vector<int> dimensions =
+    this->get_loop_level_numbers_from_dimension_names({L_i.get_name(), L_j.get_name(), L_k.get_name()});
+    this->check_dimensions_validity(dimensions);
+
+    int depth = this->get_loop_levels_number();
+    if (dimensions[0] != depth - 3 || dimensions[1] != depth - 2 || dimensions[2] != depth - 1)
+        ERROR("The tensor core levels of " + this->get_name() + " must be its three innermost loop levels, in order.", true);
+
+    bool on_gpu = false;
+    for (const auto &dims : this->get_function()->gpu_thread_dimensions)
+        if (dims.first == this->get_name())
+            on_gpu = std::max({std::get<0>(dims.second), std::get<1>(dims.second), std::get<2>(dims.second)}) < dimensions[0];
+    if (!on_gpu)
+        ERROR("The tensor core levels of " + this->get_name() + " must be inside its GPU thread levels.", true);
+
+    this->get_function()->gpu_tensor_core_dimensions.push_back(
+            std::make_pair(this->get_name(), std::make_tuple(dimensions[0], dimensions[1], dimensions[2])));
+
+    DEBUG_INDENT(-4);
+}
+
+void computation::tag_gpu_stream(int stream)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    if (stream <= 0)
+        ERROR("The stream of " + this->get_name() + " must be positive, the default stream is used otherwise.", true);
+
+    bool on_gpu = (this->get_expr().get_expr_type() == e_op) && (this->get_expr().get_op_type() == o_memcpy);
+    for (const auto &dims : this->get_function()->gpu_block_dimensions)
+        if (dims.first == this->get_name())
+            on_gpu = true;
+    if (!on_gpu)
+        ERROR("Only host/device copies and computations mapped to the GPU can be tagged with a stream: "
+              + this->get_name() + ".", true);
+
+    this->get_function()->gpu_streams[this->get_name()] = stream;
+
+    DEBUG_INDENT(-4);
+}
+
 /**
   * Methods for the computation class.
   */
@@ -451,6 +576,205 @@ void tiramisu::computation::parallelize(tiramisu::var par_dim_var)
     DEBUG_INDENT(-4);
 }
 
+void tiramisu::computation::split_parametric(tiramisu::var L0_var, tiramisu::expr size)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L0_var.get_name().length() > 0);
+    assert(size.is_defined());
+    assert(this->get_function() != NULL);
+
+    std::vector<int> dimensions =
+        this->get_loop_level_numbers_from_dimension_names({L0_var.get_name()});
+    this->check_dimensions_validity(dimensions);
+
+    this->get_function()->add_parametric_split_dimension(this->get_name(), dimensions[0], {size});
+
+    DEBUG(3, tiramisu::str_dump("Loop level " + std::to_string(dimensions[0]) + " of " + this->get_name() +
+                                " split by " + size.to_str()));
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::tile_parametric(tiramisu::var L0_var, tiramisu::var L1_var,
+                                            tiramisu::expr sizeX, tiramisu::expr sizeY)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L0_var.get_name().length() > 0);
+    assert(L1_var.get_name().length() > 0);
+    assert(sizeX.is_defined() && sizeY.is_defined());
+    assert(this->get_function() != NULL);
+
+    std::vector<int> dimensions =
+        this->get_loop_level_numbers_from_dimension_names({L0_var.get_name(), L1_var.get_name()});
+    this->check_dimensions_validity(dimensions);
+
+    if (dimensions[1] != dimensions[0] + 1)
+        ERROR("The loop level " + L1_var.get_name() + " must be the loop level right inside " +
+              L0_var.get_name() + " to tile them.", true);
+
+    this->get_function()->add_parametric_split_dimension(this->get_name(), dimensions[0], {sizeX, sizeY});
+
+    DEBUG(3, tiramisu::str_dump("Loop levels " + std::to_string(dimensions[0]) + " and " +
+                                std::to_string(dimensions[1]) + " of " + this->get_name() + " tiled by " +
+                                sizeX.to_str() + " x " + sizeY.to_str()));
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::parallelize_doacross(tiramisu::var L0_var, tiramisu::var L1_var, int distance)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L0_var.get_name().length() > 0);
+    assert(L1_var.get_name().length() > 0);
+    assert(distance >= 0);
+    assert(!this->get_name().empty());
+    assert(this->get_function() != NULL);
+
+    std::vector<int> dimensions =
+        this->get_loop_level_numbers_from_dimension_names({L0_var.get_name(), L1_var.get_name()});
+    this->check_dimensions_validity(dimensions);
+
+    if (dimensions[1] != dimensions[0] + 1)
+        ERROR("The loop level " + L1_var.get_name() + " must be the loop level right inside " +
+              L0_var.get_name() + " to parallelize it as a doacross loop.", true);
+
+    this->tag_parallel_level(dimensions[0]);
+    this->get_function()->add_doacross_dimension(this->get_name(), dimensions[0], distance);
+
+    DEBUG(3, tiramisu::str_dump("Loop level " + std::to_string(dimensions[0]) + " of " + this->get_name() +
+                                " parallelized as a doacross loop with a distance of " + std::to_string(distance)));
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::pipeline(tiramisu::var L_var, int depth)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L_var.get_name().length() > 0);
+    assert(depth >= 0);
+    assert(!this->get_name().empty());
+    assert(this->get_function() != NULL);
+
+    std::vector<int> dimensions =
+        this->get_loop_level_numbers_from_dimension_names({L_var.get_name()});
+    this->check_dimensions_validity(dimensions);
+
+    this->get_function()->add_pipeline_dimension(this->get_name(), dimensions[0], depth);
+
+    DEBUG(3, tiramisu::str_dump("The body of the loop level " + std::to_string(dimensions[0]) + " of " +
+                                this->get_name() + " runs as a pipeline of depth " + std::to_string(depth)));
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::parallelize_reduction(tiramisu::var L_var, tiramisu::reduction_strategy_t strategy,
+                                                  int nb_partials)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L_var.get_name().length() > 0);
+    assert(nb_partials > 0);
+    assert(!this->get_name().empty());
+    assert(this->get_function() != NULL);
+
+    std::vector<int> dimensions =
+        this->get_loop_level_numbers_from_dimension_names({L_var.get_name()});
+    this->check_dimensions_validity(dimensions);
+
+    if (this->get_access_relation() == NULL)
+        ERROR("The computation " + this->get_name() + " must be stored in a buffer to parallelize its reduction.", true);
+
+    this->tag_parallel_level(dimensions[0]);
+    this->get_function()->add_reduction_dimension(this->get_name(), dimensions[0], strategy, nb_partials);
+
+    DEBUG(3, tiramisu::str_dump("Loop level " + std::to_string(dimensions[0]) + " of " + this->get_name() +
+                                " parallelized as a reduction loop"));
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::parallelize_scan(tiramisu::var L_var, int nb_blocks)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L_var.get_name().length() > 0);
+    assert(nb_blocks > 0);
+    assert(!this->get_name().empty());
+    assert(this->get_function() != NULL);
+
+    std::vector<int> dimensions =
+        this->get_loop_level_numbers_from_dimension_names({L_var.get_name()});
+    this->check_dimensions_validity(dimensions);
+
+    if (this->get_access_relation() == NULL)
+        ERROR("The computation " + this->get_name() + " must be stored in a buffer to parallelize its scan.", true);
+
+    this->tag_parallel_level(dimensions[0]);
+    this->get_function()->add_scan_dimension(this->get_name(), dimensions[0], nb_blocks);
+
+    DEBUG(3, tiramisu::str_dump("Loop level " + std::to_string(dimensions[0]) + " of " + this->get_name() +
+                                " parallelized as a scan loop with " + std::to_string(nb_blocks) + " blocks"));
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::prefetch(tiramisu::buffer &b, tiramisu::var L_var, int distance)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L_var.get_name().length() > 0);
+    assert(!this->get_name().empty());
+    assert(this->get_function() != NULL);
+
+    if (distance <= 0)
+        ERROR("The prefetch distance of " + b.get_name() + " in " + this->get_name() +
+              " must be positive.", true);
+
+    std::vector<int> dimensions =
+        this->get_loop_level_numbers_from_dimension_names({L_var.get_name()});
+    this->check_dimensions_validity(dimensions);
+
+    this->get_function()->add_prefetch_dimension(this->get_name(), b.get_name(), dimensions[0], distance);
+
+    DEBUG(3, tiramisu::str_dump("The buffer " + b.get_name() + " is prefetched in " + this->get_name() +
+                                " " + std::to_string(distance) + " iterations ahead of the loop level " +
+                                std::to_string(dimensions[0])));
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::set_ast_option(tiramisu::var L_var, tiramisu::ast_option_t option)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L_var.get_name().length() > 0);
+    assert(!this->get_name().empty());
+    assert(this->get_function() != NULL);
+
+    std::vector<int> dimensions =
+        this->get_loop_level_numbers_from_dimension_names({L_var.get_name()});
+    this->check_dimensions_validity(dimensions);
+
+    this->get_function()->add_ast_option(this->get_name(), dimensions[0], option);
+
+    DEBUG(3, tiramisu::str_dump("Loop level " + std::to_string(dimensions[0]) + " of " + this->get_name() +
+                                " generated with the AST option " + std::to_string(option)));
+
+    DEBUG_INDENT(-4);
+}
+
 
 void tiramisu::computation::tag_parallel_level(int par_dim)
 {
@@ -627,6 +951,85 @@ void tiramisu::computation::tag_distribute_level(int L)
     DEBUG_INDENT(-4);
 }
 
+void tiramisu::computation::tag_gpu_device_level(tiramisu::var L)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L.get_name().length() > 0);
+    std::vector<int> dimensions =
+            this->get_loop_level_numbers_from_dimension_names({L.get_name()});
+    this->check_dimensions_validity(dimensions);
+
+    this->tag_gpu_device_level(dimensions[0]);
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::tag_gpu_device_level(int L)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L >= 0);
+    assert(!this->get_name().empty());
+    assert(this->get_function() != NULL);
+
+    for (const auto &dims : this->get_function()->gpu_block_dimensions)
+        if (dims.first == this->get_name() && std::get<0>(dims.second) <= L)
+            ERROR("The GPU device level of " + this->get_name() + " must be outside its GPU block levels.", true);
+    for (const auto &dim : this->get_function()->gpu_device_dimensions)
+        if (dim.first == this->get_name())
+            ERROR("The computation " + this->get_name() + " can only be distributed across the GPUs at one level.", true);
+
+    this->get_function()->add_gpu_device_dimension(this->get_name(), L);
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::tag_gpu_persistent_level(tiramisu::var L)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L.get_name().length() > 0);
+    std::vector<int> dimensions =
+            this->get_loop_level_numbers_from_dimension_names({L.get_name()});
+    this->check_dimensions_validity(dimensions);
+
+    this->tag_gpu_persistent_level(dimensions[0]);
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::tag_gpu_persistent_level(int L)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L >= 0);
+    assert(!this->get_name().empty());
+    assert(this->get_function() != NULL);
+
+    bool on_gpu = false;
+    for (const auto &dims : this->get_function()->gpu_block_dimensions)
+        if (dims.first == this->get_name())
+        {
+            on_gpu = true;
+            if (std::get<0>(dims.second) <= L)
+                ERROR("The persistent level of " + this->get_name() + " must be outside its GPU block levels.", true);
+        }
+    if (!on_gpu)
+        ERROR("Only a computation mapped to the GPU can be tagged with a persistent level: " + this->get_name() + ".", true);
+    for (const auto &dim : this->get_function()->gpu_device_dimensions)
+        if (dim.first == this->get_name() && dim.second >= L)
+            ERROR("The persistent level of " + this->get_name() + " must be inside its GPU device level.", true);
+
+    this->get_function()->add_gpu_persistent_dimension(this->get_name(), L);
+
+    DEBUG_INDENT(-4);
+}
+
 void tiramisu::computation::tag_parallel_level(tiramisu::var L0_var)
 {
     DEBUG_FCT_NAME(3);
@@ -1181,14 +1584,301 @@ void tiramisu::computation::vectorize(tiramisu::var L0_var, int v)
     DEBUG_INDENT(-4);
 }
 
-void computation::update_names(std::vector<std::string> original_loop_level_names, std::vector<std::string> new_names,
-                               int erase_from, int nb_loop_levels_to_erase)
+void tiramisu::computation::vectorize(tiramisu::var L0_var)
+{
+    this->vectorize(L0_var, this->get_function()->get_default_vector_length(this->get_data_type()));
+}
+
+void tiramisu::computation::vectorize_predicated(tiramisu::var L0_var, int v)
 {
     DEBUG_FCT_NAME(3);
     DEBUG_INDENT(4);
 
-    DEBUG_NO_NEWLINE(3, tiramisu::str_dump("Original loop level names: "));
-    for (auto n: original_loop_level_names)
+    tiramisu::var L0_outer = tiramisu::var(generate_new_variable_name());
+    tiramisu::var L0_inner = tiramisu::var(generate_new_variable_name());
+    this->vectorize_predicated(L0_var, v, L0_outer, L0_inner);
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::vectorize_predicated(tiramisu::var L0_var, int v,
+                                                 tiramisu::var L0_outer, tiramisu::var L0_inner)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L0_var.get_name().length() > 0);
+    assert(v > 1);
+    std::vector<int> dimensions =
+        this->get_loop_level_numbers_from_dimension_names({L0_var.get_name()});
+    this->check_dimensions_validity(dimensions);
+    int L0 = dimensions[0];
+
+    // No separation: the inner loop keeps the bound of the last partial
+    // vector, which becomes the mask of the vector loop.
+    this->split(L0_var, v, L0_outer, L0_inner);
+    this->tag_vector_level(L0 + 1, v);
+    this->get_function()->add_predicated_vector_dimension(this->get_name(), L0 + 1);
+
+    this->get_function()->align_schedules();
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::vectorize_aligned(tiramisu::var L0_var, int v)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    tiramisu::var L0_outer = tiramisu::var(generate_new_variable_name());
+    tiramisu::var L0_inner = tiramisu::var(generate_new_variable_name());
+    this->vectorize_aligned(L0_var, v, L0_outer, L0_inner);
+
+    DEBUG_INDENT(-4);
+}
+
+/**
+ * Return the constant offset c such that the innermost index of the buffer
+ * element accessed by \p access (a map from the iteration domain to the
+ * buffer) is the iterator number \p dim plus c, or false if there is none.
+ */
+static bool get_innermost_offset(isl_map *access, int dim, long &offset)
+{
+    int n_out = isl_map_dim(access, isl_dim_out);
+    if (n_out < 1 || isl_map_is_single_valued(access) != isl_bool_true)
+        return false;
+
+    isl_map *innermost = isl_map_project_out(isl_map_copy(access), isl_dim_out, 0, n_out - 1);
+
+    // iteration -> its iterator number dim, in the space of innermost
+    isl_map *iterator = isl_map_identity(isl_space_map_from_set(isl_space_domain(isl_map_get_space(innermost))));
+    int n_in = isl_map_dim(iterator, isl_dim_out);
+    iterator = isl_map_project_out(iterator, isl_dim_out, dim + 1, n_in - dim - 1);
+    iterator = isl_map_project_out(iterator, isl_dim_out, 0, dim);
+    iterator = isl_map_intersect_domain(iterator, isl_map_domain(isl_map_copy(innermost)));
+    iterator = isl_map_set_tuple_id(iterator, isl_dim_out, isl_map_get_tuple_id(innermost, isl_dim_out));
+
+    isl_set *offsets = isl_map_range(isl_map_sum(innermost, isl_map_neg(iterator)));
+    isl_val *value = isl_set_plain_get_val_if_fixed(offsets, isl_dim_set, 0);
+    isl_set_free(offsets);
+
+    bool fixed = (value != NULL) && isl_val_is_int(value);
+    if (fixed)
+        offset = isl_val_get_num_si(value);
+    isl_val_free(value);
+
+    return fixed;
+}
+
+void tiramisu::computation::vectorize_aligned(tiramisu::var L0_var, int v,
+                                              tiramisu::var L0_outer, tiramisu::var L0_inner)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L0_var.get_name().length() > 0);
+    std::vector<int> dimensions =
+        this->get_loop_level_numbers_from_dimension_names({L0_var.get_name()});
+    this->check_dimensions_validity(dimensions);
+    int L0 = dimensions[0];
+
+    std::vector<std::string> iterators = this->get_iteration_domain_dimension_names();
+    int dim = std::find(iterators.begin(), iterators.end(), L0_var.get_name()) - iterators.begin();
+
+    this->gen_time_space_domain();
+    tiramisu::expr lower = tiramisu::utility::get_bound(this->get_trimmed_time_processor_domain(), L0, false).simplify();
+    tiramisu::expr upper = tiramisu::utility::get_bound(this->get_trimmed_time_processor_domain(), L0, true).simplify();
+    while (lower.get_expr_type() == tiramisu::e_op && lower.get_op_type() == tiramisu::o_cast)
+        lower = lower.get_operand(0);
+    while (upper.get_expr_type() == tiramisu::e_op && upper.get_op_type() == tiramisu::o_cast)
+        upper = upper.get_operand(0);
+
+    // The accesses of the computation, as maps from its iteration domain to the
+    // buffers, with the store first.
+    std::vector<isl_map *> accesses;
+    if (dim < (int) iterators.size() && lower.get_expr_type() == tiramisu::e_val && this->get_access_relation() != NULL)
+    {
+        accesses.push_back(isl_map_intersect_domain(isl_map_copy(this->get_access_relation()),
+                                                    isl_set_copy(this->get_iteration_domain())));
+
+        std::string params = "[" + utility::get_parameters_list(this->get_iteration_domain()) + "] -> ";
+        std::string domain = this->get_name() + "[";
+        for (size_t i = 0; i < iterators.size(); i++)
+            domain += (i == 0 ? "" : ", ") + iterators[i];
+        domain += "]";
+
+        std::function<tiramisu::expr(const tiramisu::expr &)> find_loads = [&](const tiramisu::expr &e) {
+            if (e.get_expr_type() == tiramisu::e_op && e.get_op_type() == tiramisu::o_access)
+            {
+                std::vector<tiramisu::computation *> producers = this->get_function()->get_computation_by_name(e.get_name());
+                if (!producers.empty() && producers[0]->get_access_relation() != NULL)
+                {
+                    std::string load_str = params + "{" + domain + " -> " + e.get_name() + "[";
+                    for (size_t i = 0; i < e.get_access().size(); i++)
+                        load_str += (i == 0 ? "" : ", ") + e.get_access()[i].to_str();
+                    load_str += "]}";
+
+                    isl_map *load = isl_map_read_from_str(this->get_ctx(), load_str.c_str());
+                    if (load != NULL)
+                    {
+                        load = isl_map_intersect_domain(load, isl_set_copy(this->get_iteration_domain()));
+                        accesses.push_back(isl_map_apply_range(load, isl_map_copy(producers[0]->get_access_relation())));
+                    }
+                }
+            }
+            return e.apply_to_operands(find_loads);
+        };
+        find_loads(this->get_expr());
+    }
+
+    // The dominant access: the (buffer, offset) shared by the most accesses
+    std::map<std::pair<std::string, long>, int> occurrences;
+    std::pair<std::string, long> dominant;
+    int dominant_count = 0;
+    for (isl_map *access : accesses)
+    {
+        long offset;
+        if (get_innermost_offset(access, dim, offset))
+        {
+            std::pair<std::string, long> key(isl_map_get_tuple_name(access, isl_dim_out), offset);
+            if (++occurrences[key] > dominant_count)
+            {
+                dominant = key;
+                dominant_count = occurrences[key];
+            }
+        }
+        isl_map_free(access);
+    }
+
+    int peeled = 0;
+    if (dominant_count > 0)
+    {
+        tiramisu::buffer *buf = this->get_function()->get_buffers().count(dominant.first) ?
+                                this->get_function()->get_buffers().at(dominant.first) : nullptr;
+        int element_size = (buf != nullptr) ? halide_type_from_tiramisu_type(buf->get_elements_type()).bytes() : 0;
+
+        // The number of elements between two aligned addresses
+        int aligned_elements = 0;
+        if (buf != nullptr && buf->get_alignment() > 0 && buf->get_alignment() % element_size == 0)
+            aligned_elements = std::min(buf->get_alignment() / element_size, v);
+
+        bool rows_aligned = (aligned_elements > 0) && (v % aligned_elements == 0);
+        if (rows_aligned && buf->get_n_dims() > 1)
+        {
+            const tiramisu::expr &row_size = buf->get_dim_sizes().back();
+            rows_aligned = (row_size.get_expr_type() == tiramisu::e_val) &&
+                           (row_size.get_int_val() % aligned_elements == 0);
+        }
+
+        if (rows_aligned)
+        {
+            long first = lower.get_int_val() + dominant.second;
+            peeled = (int) (((-first) % aligned_elements + aligned_elements) % aligned_elements);
+            if (upper.get_expr_type() == tiramisu::e_val && upper.get_int_val() - lower.get_int_val() + 1 <= peeled)
+                peeled = 0;
+        }
+
+        DEBUG(3, tiramisu::str_dump("Dominant access to " + dominant.first + " at offset " + std::to_string(dominant.second) +
+                                    ", " + std::to_string(peeled) + " iterations peeled."));
+    }
+
+    if (peeled == 0)
+    {
+        this->vectorize(L0_var, v, L0_outer, L0_inner);
+        DEBUG_INDENT(-4);
+        return;
+    }
+
+    // The prologue keeps the first iterations, the last definition the others
+    this->separate(L0, tiramisu::expr((int32_t) peeled), 1, lower);
+    this->get_function()->align_schedules();
+    this->get_last_update().vectorize(L0_var, v, L0_outer, L0_inner);
+
+    DEBUG_INDENT(-4);
+}
+
+tiramisu::computation &tiramisu::computation::specialize(const std::string &condition)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    tiramisu::function *fct = this->get_function();
+
+    // The successors of this computation are moved after the specialized version
+    std::vector<std::pair<computation *, int>> successors(fct->sched_graph[this].begin(),
+                                                          fct->sched_graph[this].end());
+    for (const auto &successor : successors)
+        if (successor.second != computation::root_dimension)
+            ERROR("Cannot specialize " + this->get_name() + " which is fused with " +
+                  successor.first->get_name() + ".", true);
+
+    std::string params;
+    for (const auto &invariant : fct->get_invariants())
+        params += (params.empty() ? "" : ",") + invariant.get_name();
+
+    std::string condition_str = "[" + params + "]->{: " + condition + "}";
+    DEBUG(3, tiramisu::str_dump("The condition is: " + condition_str));
+
+    isl_set *condition_isl = isl_set_read_from_str(this->get_ctx(), condition_str.c_str());
+    if (condition_isl == NULL)
+        ERROR("Cannot parse the condition " + condition + " of specialize().", true);
+
+    isl_map *specialized_schedule = isl_map_intersect_params(isl_map_copy(this->get_schedule()),
+                                                             isl_set_copy(condition_isl));
+    if (isl_map_is_empty(specialized_schedule))
+        ERROR("The condition " + condition + " of specialize() never holds for " + this->get_name() + ".", true);
+
+    std::string domain_str = std::string(isl_set_to_str(this->get_iteration_domain()));
+    this->add_definitions(domain_str,
+        this->get_expr(),
+        this->should_schedule_this_computation(),
+        this->get_data_type(),
+        fct);
+
+    computation &specialized = this->get_last_update();
+    specialized.set_schedule(specialized_schedule);
+    if (this->get_access_relation() != NULL)
+        specialized.set_access(isl_map_copy(this->get_access_relation()));
+
+    this->set_schedule(isl_map_intersect_params(isl_map_copy(this->get_schedule()),
+                                                isl_set_complement(condition_isl)));
+
+    for (const auto &successor : successors)
+    {
+        fct->sched_graph[this].erase(successor.first);
+        fct->sched_graph_reversed[successor.first].erase(this);
+    }
+
+    specialized.after(*this, computation::root_dimension);
+    for (const auto &successor : successors)
+        successor.first->after(specialized, computation::root_dimension);
+
+    DEBUG(3, tiramisu::str_dump("The specialized computation:"); specialized.dump());
+
+    DEBUG_INDENT(-4);
+
+    return specialized;
+}
+
+void tiramisu::computation::vectorize_reduction(tiramisu::var L0_var, int v)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    this->vectorize(L0_var, v);
+    this->_is_vector_reduction = true;
+
+    DEBUG_INDENT(-4);
+}
+
+void computation::update_names(std::vector<std::string> original_loop_level_names, std::vector<std::string> new_names,
+                               int erase_from, int nb_loop_levels_to_erase)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    DEBUG_NO_NEWLINE(3, tiramisu::str_dump("Original loop level names: "));
+    for (auto n: original_loop_level_names)
     {
         DEBUG_NO_NEWLINE_NO_INDENT(3, tiramisu::str_dump(n + " "));
     }
@@ -1369,6 +2059,90 @@ void tiramisu::computation::unroll(int L0, int v)
     DEBUG_INDENT(-4);
 }
 
+void tiramisu::computation::unroll_and_jam(tiramisu::var L0_var, int v)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    tiramisu::var L0_outer = tiramisu::var(generate_new_variable_name());
+    tiramisu::var L0_inner = tiramisu::var(generate_new_variable_name());
+    this->unroll_and_jam(L0_var, v, L0_outer, L0_inner);
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::unroll_and_jam(tiramisu::var L0_var, int v, tiramisu::var L0_outer, tiramisu::var L0_inner)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    std::vector<std::string> original_loop_level_names = this->get_loop_level_names();
+
+    assert(L0_var.get_name().length() > 0);
+    std::vector<int> dimensions =
+        this->get_loop_level_numbers_from_dimension_names({L0_var.get_name()});
+    this->check_dimensions_validity(dimensions);
+    int L0 = dimensions[0];
+
+    if (L0 == this->get_loop_levels_number() - 1)
+    {
+        this->unroll(L0_var, v, L0_outer, L0_inner);
+        DEBUG_INDENT(-4);
+        return;
+    }
+
+    int L_unrolled;
+    bool split_happened = this->separateAndSplit(L0_var, v, L0_outer, L0_inner);
+
+    if (split_happened)
+    {
+        this->update_names(original_loop_level_names, {L0_outer.get_name(), L0_inner.get_name()}, L0, 1);
+        L_unrolled = L0 + 1;
+    }
+    else
+    {
+        this->set_loop_level_names({L0}, {L0_outer.get_name()});
+        this->update_names(original_loop_level_names, {L0_inner.get_name()}, L0, 1);
+        L_unrolled = L0;
+    }
+
+    // Jam: sink the unrolled loop below the loops it encloses.
+    int innermost = this->get_loop_levels_number() - 1;
+    for (int l = L_unrolled; l < innermost; l++)
+        this->get_update(0).interchange(l, l + 1);
+    this->get_update(0).tag_unroll_level(innermost, v);
+
+    this->get_function()->align_schedules();
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::unroll_and_jam(int L0, int v)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    if (L0 == this->get_loop_levels_number() - 1)
+    {
+        this->unroll(L0, v);
+        DEBUG_INDENT(-4);
+        return;
+    }
+
+    bool split_happened = this->separateAndSplit(L0, v);
+    int L_unrolled = split_happened ? L0 + 1 : L0;
+
+    // Jam: sink the unrolled loop below the loops it encloses.
+    int innermost = this->get_loop_levels_number() - 1;
+    for (int l = L_unrolled; l < innermost; l++)
+        this->get_update(0).interchange(l, l + 1);
+    this->get_update(0).tag_unroll_level(innermost, v);
+
+    this->get_function()->align_schedules();
+
+    DEBUG_INDENT(-4);
+}
+
 void computation::dump_iteration_domain() const
 {
     if (ENABLE_DEBUG)
@@ -1640,87 +2414,308 @@ bool buffer::get_auto_allocate()
     return this->auto_allocate;
 }
 
-void buffer::set_auto_deallocate(bool auto_deallocation)
+void buffer::set_alignment(int alignment)
 {
-    this->auto_deallocate = auto_deallocation;
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "The alignment must be a power of two.");
+
+    this->alignment = alignment;
 }
 
-bool buffer::get_auto_deallocate()
+int buffer::get_alignment() const
 {
-    return this->auto_deallocate;
+    return this->alignment;
 }
 
-void computation::set_schedule(std::string map_str)
+void buffer::set_numa_placement(tiramisu::numa_placement_t placement, int node)
 {
-    assert(!map_str.empty());
-    assert(this->ctx != NULL);
-
-    isl_map *map = isl_map_read_from_str(this->ctx, map_str.c_str());
-    assert(map != NULL);
+    assert(node >= 0);
 
-    this->set_schedule(map);
+    this->numa_placement = placement;
+    this->numa_node = node;
 }
 
-void computation::apply_transformation_on_schedule(std::string map_str)
+tiramisu::numa_placement_t buffer::get_numa_placement() const
 {
-    DEBUG_FCT_NAME(3);
-    DEBUG_INDENT(4);
+    return this->numa_placement;
+}
 
-    assert(!map_str.empty());
-    assert(this->ctx != NULL);
+int buffer::get_numa_node() const
+{
+    return this->numa_node;
+}
 
-    isl_map *map = isl_map_read_from_str(this->ctx, map_str.c_str());
-    assert(map != NULL);
+void buffer::set_gpu_partitions(int partitions)
+{
+    assert(partitions > 0);
 
-    DEBUG(3, tiramisu::str_dump("Applying the following transformation on the schedule : "));
-    DEBUG(3, tiramisu::str_dump(isl_map_to_str(map)));
+    if (this->location != cuda_ast::memory_location::global)
+        ERROR("Only the buffers in GPU global memory can be partitioned across the GPUs: " + this->get_name() + ".", true);
 
-    isl_map *sched = this->get_schedule();
-    sched = isl_map_apply_range(isl_map_copy(sched), isl_map_copy(map));
-    this->set_schedule(sched);
+    this->gpu_partitions = partitions;
+}
 
-    DEBUG(3, tiramisu::str_dump("Schedule after transformation : "));
-    DEBUG(3, tiramisu::str_dump(isl_map_to_str(this->get_schedule())));
+int buffer::get_gpu_partitions() const
+{
+    return this->gpu_partitions;
+}
 
-    this->name_unnamed_time_space_dimensions();
+void buffer::set_gpu_managed(tiramisu::managed_advice_t advice)
+{
+    if (this->location != cuda_ast::memory_location::global)
+        ERROR("Only the buffers in GPU global memory can be allocated in managed memory: " + this->get_name() + ".", true);
 
-    DEBUG_INDENT(-4);
+    this->gpu_managed = true;
+    this->managed_advice = advice;
 }
 
-void computation::apply_transformation_on_schedule_domain(std::string map_str)
+bool buffer::is_gpu_managed() const
 {
-    DEBUG_FCT_NAME(3);
-    DEBUG_INDENT(4);
+    return this->gpu_managed;
+}
 
-    assert(!map_str.empty());
-    assert(this->ctx != NULL);
+tiramisu::managed_advice_t buffer::get_gpu_managed_advice() const
+{
+    return this->managed_advice;
+}
 
-    isl_map *map = isl_map_read_from_str(this->ctx, map_str.c_str());
-    assert(map != NULL);
+void buffer::set_streaming_stores(bool streaming_stores)
+{
+    this->streaming_stores = streaming_stores;
+}
 
-    DEBUG(3, tiramisu::str_dump("Applying the following transformation on the domain of the schedule : "));
-    DEBUG(3, tiramisu::str_dump(isl_map_to_str(map)));
+bool buffer::get_streaming_stores() const
+{
+    return this->streaming_stores;
+}
 
-    isl_map *sched = this->get_schedule();
-    sched = isl_map_apply_domain(isl_map_copy(sched), isl_map_copy(map));
+void buffer::set_interleaved(bool interleaved)
+{
+    if (interleaved)
+    {
+        const tiramisu::expr &channels = this->get_dim_sizes().back();
+        if (!channels.is_integer() || channels.get_int_val() < 2 || channels.get_int_val() > 4)
+            ERROR("The innermost dimension of the interleaved buffer " + this->get_name() +
+                  " must have a constant extent of 2, 3 or 4.", true);
+    }
 
-    this->set_schedule(sched);
+    this->interleaved = interleaved;
+}
 
-    DEBUG(3, tiramisu::str_dump("Schedule after transformation : "));
-    DEBUG(3, tiramisu::str_dump(isl_map_to_str(this->get_schedule())));
+int buffer::get_interleaved_channels() const
+{
+    if (!this->interleaved)
+        return 0;
 
-    DEBUG_INDENT(-4);
+    return this->get_dim_sizes().back().get_int_val();
 }
 
-void computation::add_schedule_constraint(std::string domain_constraints,
-        std::string range_constraints)
+void buffer::set_constant(bool constant)
 {
-    DEBUG_FCT_NAME(3);
-    DEBUG_INDENT(4);
+    if (constant && this->get_argument_type() == a_output)
+        ERROR("An output buffer cannot be declared constant: " + this->get_name() + ".", true);
 
+    this->constant_contents = constant;
+}
+
+bool buffer::is_constant() const
+{
+    return this->constant_contents;
+}
+
+void buffer::set_mapped_file(bool mapped, tiramisu::mmap_advice_t advice, bool huge_pages, bool by_fd)
+{
+    if (mapped && this->get_argument_type() == a_temporary)
+        ERROR("Only the input and output buffers can be mapped from files: " + this->get_name() + ".", true);
+
+    this->mapped_file = mapped;
+    this->mapped_file_advice = advice;
+    this->mapped_file_huge_pages = huge_pages;
+    this->mapped_file_by_fd = by_fd;
+}
+
+bool buffer::is_mapped_file() const
+{
+    return this->mapped_file;
+}
+
+tiramisu::mmap_advice_t buffer::get_mapped_file_advice() const
+{
+    return this->mapped_file_advice;
+}
+
+bool buffer::get_mapped_file_huge_pages() const
+{
+    return this->mapped_file_huge_pages;
+}
+
+bool buffer::get_mapped_file_by_fd() const
+{
+    return this->mapped_file_by_fd;
+}
+
+void buffer::set_sparse_format(tiramisu::sparse_format_t format, std::vector<tiramisu::buffer *> index_buffers,
+                               int chunk_size)
+{
+    assert((format == tiramisu::sparse_dense) || (index_buffers.size() == 2));
+
+    if ((format == tiramisu::sparse_sell) && (chunk_size <= 0))
+        ERROR("The SELL buffer " + this->get_name() + " must have a positive chunk size.", true);
+
+    if ((format != tiramisu::sparse_dense) && (this->get_n_dims() != 1))
+        ERROR("The sparse buffer " + this->get_name() + " must have one dimension (the number of stored entries).", true);
+
+    for (auto b : index_buffers)
+        if ((b == nullptr) || (b->get_n_dims() != 1))
+            ERROR("The index buffers of the sparse buffer " + this->get_name() + " must have one dimension.", true);
+
+    this->sparse_format = format;
+    this->sparse_index_buffers = index_buffers;
+    this->sparse_chunk_size = (format == tiramisu::sparse_sell) ? chunk_size : 0;
+}
+
+tiramisu::sparse_format_t buffer::get_sparse_format() const
+{
+    return this->sparse_format;
+}
+
+const std::vector<tiramisu::buffer *> &buffer::get_sparse_index_buffers() const
+{
+    return this->sparse_index_buffers;
+}
+
+int buffer::get_sparse_chunk_size() const
+{
+    return this->sparse_chunk_size;
+}
+
+void buffer::pad_dimension(int dim, int padding)
+{
+    assert(dim >= 0);
+    assert(dim < this->dim_sizes.size());
+    assert(padding >= 0);
+
+    // Keep constant sizes constant, so that the strides stay known at compile time
+    if (this->dim_sizes[dim].get_expr_type() == tiramisu::e_val)
+        this->dim_sizes[dim] = value_cast(this->dim_sizes[dim].get_data_type(),
+                                          this->dim_sizes[dim].get_int_val() + padding);
+    else
+        this->dim_sizes[dim] = this->dim_sizes[dim] + padding;
+}
+
+void buffer::set_shared_layout(tiramisu::shared_layout_t layout)
+{
+    if (layout != tiramisu::shared_auto && layout != tiramisu::shared_dense && this->get_n_dims() < 2)
+        ERROR("The buffer " + this->get_name() + " needs at least two dimensions to be padded or skewed.", true);
+    if (layout == tiramisu::shared_skewed && this->dim_sizes.back().get_expr_type() != tiramisu::e_val)
+        ERROR("The rows of the buffer " + this->get_name() + " must have a constant size to be skewed.", true);
+    if (this->shared_layout == tiramisu::shared_padded)
+        ERROR("The layout of the buffer " + this->get_name() + " cannot be changed once it is padded.", true);
+
+    // A padding of one 4-byte word
+    if (layout == tiramisu::shared_padded)
+        this->pad_dimension(this->get_n_dims() - 1,
+                            std::max(1, 4 / (int) halide_type_from_tiramisu_type(this->get_elements_type()).bytes()));
+    this->shared_layout = layout;
+}
+
+tiramisu::shared_layout_t buffer::get_shared_layout() const
+{
+    return this->shared_layout;
+}
+
+std::vector<tiramisu::expr> buffer::get_shared_layout_indices(const std::vector<tiramisu::expr> &indices) const
+{
+    if (this->shared_layout != tiramisu::shared_skewed || indices.size() < 2)
+        return indices;
+
+    std::vector<tiramisu::expr> result = indices;
+    tiramisu::expr row = indices[indices.size() - 2];
+    tiramisu::expr &column = result.back();
+    column = (column + row) % value_cast(column.get_data_type(), this->dim_sizes.back().get_int_val());
+    return result;
+}
+
+void buffer::set_auto_deallocate(bool auto_deallocation)
+{
+    this->auto_deallocate = auto_deallocation;
+}
+
+bool buffer::get_auto_deallocate()
+{
+    return this->auto_deallocate;
+}
+
+void computation::set_schedule(std::string map_str)
+{
+    assert(!map_str.empty());
+    assert(this->ctx != NULL);
+
+    isl_map *map = isl_map_read_from_str(this->ctx, map_str.c_str());
+    assert(map != NULL);
+
+    this->set_schedule(map);
+}
+
+void computation::apply_transformation_on_schedule(std::string map_str)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(!map_str.empty());
+    assert(this->ctx != NULL);
+
+    isl_map *map = isl_map_read_from_str(this->ctx, map_str.c_str());
+    assert(map != NULL);
+
+    DEBUG(3, tiramisu::str_dump("Applying the following transformation on the schedule : "));
+    DEBUG(3, tiramisu::str_dump(isl_map_to_str(map)));
+
+    isl_map *sched = this->get_schedule();
+    sched = isl_map_apply_range(isl_map_copy(sched), isl_map_copy(map));
+    this->set_schedule(sched);
+
+    DEBUG(3, tiramisu::str_dump("Schedule after transformation : "));
+    DEBUG(3, tiramisu::str_dump(isl_map_to_str(this->get_schedule())));
+
+    this->name_unnamed_time_space_dimensions();
+
+    DEBUG_INDENT(-4);
+}
+
+void computation::apply_transformation_on_schedule_domain(std::string map_str)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(!map_str.empty());
+    assert(this->ctx != NULL);
+
+    isl_map *map = isl_map_read_from_str(this->ctx, map_str.c_str());
+    assert(map != NULL);
+
+    DEBUG(3, tiramisu::str_dump("Applying the following transformation on the domain of the schedule : "));
+    DEBUG(3, tiramisu::str_dump(isl_map_to_str(map)));
+
+    isl_map *sched = this->get_schedule();
+    sched = isl_map_apply_domain(isl_map_copy(sched), isl_map_copy(map));
+
+    this->set_schedule(sched);
+
+    DEBUG(3, tiramisu::str_dump("Schedule after transformation : "));
+    DEBUG(3, tiramisu::str_dump(isl_map_to_str(this->get_schedule())));
+
+    DEBUG_INDENT(-4);
+}
+
+void computation::add_schedule_constraint(std::string domain_constraints,
+        std::string range_constraints)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
 
-    assert(this->ctx != NULL);
-    isl_map *sched = this->get_schedule();
+
+    assert(this->ctx != NULL);
+    isl_map *sched = this->get_schedule();
 
     if (!domain_constraints.empty())
     {
@@ -2534,6 +3529,386 @@ void computation::gpu_tile(tiramisu::var L0, tiramisu::var L1, int sizeX, int si
     this->thread_block_shape.push_back(sizeY);
 }
 
+void computation::gpu_tile(tiramisu::var L0, tiramisu::var L1, int sizeX, int sizeY,
+                           int coarseningX, int coarseningY,
+                           tiramisu::var L0_outer, tiramisu::var L1_outer,
+                           tiramisu::var L0_inner, tiramisu::var L1_inner)
+{
+    assert(coarseningX > 0);
+    assert(coarseningY > 0);
+
+    tiramisu::var L0_tile(generate_new_variable_name());
+    tiramisu::var L1_tile(generate_new_variable_name());
+    tiramisu::var L0_coarse(generate_new_variable_name());
+    tiramisu::var L1_coarse(generate_new_variable_name());
+
+    this->tile(L0, L1, sizeX * coarseningX, sizeY * coarseningY, L0_outer, L1_outer, L0_tile, L1_tile);
+    this->split(L0_tile, sizeX, L0_coarse, L0_inner);
+    this->split(L1_tile, sizeY, L1_coarse, L1_inner);
+
+    // The loop nest is now L0_outer, L1_outer, L0_coarse, L0_inner, L1_coarse, L1_inner.
+
+    // Move the coarsening loops inside the thread loops:
+    // L0_outer, L1_outer, L0_inner, L1_inner, L0_coarse, L1_coarse
+    this->interchange(L0_coarse, L0_inner);
+    this->interchange(L0_coarse, L1_inner);
+    this->interchange(L0_coarse, L1_coarse);
+
+    this->tag_gpu_level(L0_outer, L1_outer, L0_inner, L1_inner);
+    this->thread_block_shape.push_back(sizeX);
+    this->thread_block_shape.push_back(sizeY);
+}
+
+void computation::gpu_coarsen(tiramisu::var L, int factor, bool strided, bool unroll)
+{
+    tiramisu::var L_thread(generate_new_variable_name());
+    tiramisu::var L_coarse(generate_new_variable_name());
+    this->gpu_coarsen(L, factor, L_thread, L_coarse, strided, unroll);
+}
+
+void computation::gpu_coarsen(tiramisu::var L, int factor, tiramisu::var L_thread, tiramisu::var L_coarse,
+                              bool strided, bool unroll)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L.get_name().length() > 0);
+    assert(factor > 0);
+
+    function *fn = this->get_function();
+    std::vector<int> dimensions = this->get_loop_level_numbers_from_dimension_names({L.get_name()});
+    this->check_dimensions_validity(dimensions);
+    int level = dimensions[0];
+
+    // The thread levels of the computation, from the outermost
+    std::tuple<int, int, int> *thread_dims = nullptr;
+    for (auto &dims : fn->gpu_thread_dimensions)
+        if (dims.first == this->get_name())
+            thread_dims = &dims.second;
+    std::vector<int *> thread_levels;
+    if (thread_dims != nullptr)
+        for (int *l : {&std::get<0>(*thread_dims), &std::get<1>(*thread_dims), &std::get<2>(*thread_dims)})
+            if (*l != -1)
+                thread_levels.push_back(l);
+    int index = 0;
+    while (index < thread_levels.size() && *thread_levels[index] != level)
+        index++;
+    if (index == thread_levels.size())
+        ERROR(L.get_name() + " is not a GPU thread level of " + this->get_name() + ".", true);
+
+    // The number of threads along L, if the computation was mapped with gpu_tile()
+    int threads = (index < this->thread_block_shape.size()) ? this->thread_block_shape[index] : -1;
+    if (strided && threads == -1)
+        ERROR("The strided coarsening of " + this->get_name() + " needs the thread block shape given by gpu_tile().", true);
+    if (threads != -1 && threads % factor != 0)
+        ERROR("The " + std::to_string(threads) + " threads of " + L.get_name() + " are not a multiple of the "
+              "coarsening factor " + std::to_string(factor) + ".", true);
+
+    // The iterations of a thread are spaced by the new number of threads
+    // (strided), or consecutive
+    if (strided)
+        this->split(L, threads / factor, L_coarse, L_thread);
+    else
+        this->split(L, factor, L_thread, L_coarse);
+
+    // Move the coarsening loop inside the thread levels
+    std::vector<std::string> names = this->get_loop_level_names();
+    std::vector<std::string> thread_names;
+    for (int i = 0; i < thread_levels.size(); i++)
+        if (i > index || (i == index && strided))
+            thread_names.push_back((i == index) ? L_thread.get_name() : names[*thread_levels[i] + 1]);
+    for (const auto &name : thread_names)
+        this->interchange(L_coarse, tiramisu::var(name));
+
+    for (int i = 0; i < thread_levels.size(); i++)
+    {
+        std::string name = (i == index) ? L_thread.get_name() :
+                           (i < index) ? names[*thread_levels[i]] : names[*thread_levels[i] + 1];
+        *thread_levels[i] = this->get_loop_level_numbers_from_dimension_names({name})[0];
+    }
+    if (threads != -1)
+        this->thread_block_shape[index] = threads / factor;
+
+    if (unroll)
+        this->tag_unroll_level(L_coarse, factor);
+
+    DEBUG_INDENT(-4);
+}
+
+template <typename T> static tiramisu::expr get_type_limit(bool largest)
+{
+    return largest ? tiramisu::expr(std::numeric_limits<T>::max()) : tiramisu::expr(std::numeric_limits<T>::lowest());
+}
+
+/**
+  * Return the identity of the reduction operator \p op (o_add, o_mul, o_min or o_max)
+  * for the type \p type.
+  */
+static tiramisu::expr get_reduction_identity(tiramisu::op_t op, tiramisu::primitive_t type)
+{
+    if (op == o_add)
+        return value_cast(type, 0);
+    if (op == o_mul)
+        return value_cast(type, 1);
+
+    bool largest = (op == o_min);
+    switch (type)
+    {
+        case p_uint8: return get_type_limit<uint8_t>(largest);
+        case p_uint16: return get_type_limit<uint16_t>(largest);
+        case p_uint32: return get_type_limit<uint32_t>(largest);
+        case p_uint64: return get_type_limit<uint64_t>(largest);
+        case p_int8: return get_type_limit<int8_t>(largest);
+        case p_int16: return get_type_limit<int16_t>(largest);
+        case p_int32: return get_type_limit<int32_t>(largest);
+        case p_int64: return get_type_limit<int64_t>(largest);
+        case p_float32: return get_type_limit<float>(largest);
+        case p_float64: return get_type_limit<double>(largest);
+        default:
+            ERROR("No identity of min and max for the type " + str_from_tiramisu_type_primitive(type) + ".", true);
+    }
+    return tiramisu::expr();
+}
+
+void computation::gpu_split_reduction(tiramisu::var L, int chunk)
+{
+    tiramisu::var L_block(generate_new_variable_name());
+    tiramisu::var L_chunk(generate_new_variable_name());
+    this->gpu_split_reduction(L, chunk, L_block, L_chunk);
+}
+
+void computation::gpu_split_reduction(tiramisu::var L, int chunk, tiramisu::var L_block, tiramisu::var L_chunk)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L.get_name().length() > 0);
+    assert(chunk > 0);
+
+    function *fn = this->get_function();
+    std::vector<int> dimensions = this->get_loop_level_numbers_from_dimension_names({L.get_name()});
+    this->check_dimensions_validity(dimensions);
+    int level = dimensions[0];
+
+    std::tuple<int, int, int> *block_dims = nullptr, *thread_dims = nullptr;
+    for (auto &dims : fn->gpu_block_dimensions)
+        if (dims.first == this->get_name())
+            block_dims = &dims.second;
+    for (auto &dims : fn->gpu_thread_dimensions)
+        if (dims.first == this->get_name())
+            thread_dims = &dims.second;
+    if (block_dims == nullptr || thread_dims == nullptr)
+        ERROR(this->get_name() + " must be mapped to the GPU (see gpu_tile()) to split its reduction.", true);
+    if (std::get<2>(*block_dims) != -1)
+        ERROR(this->get_name() + " already uses the three GPU block dimensions.", true);
+
+    int last_block = std::max(std::get<0>(*block_dims), std::get<1>(*block_dims));
+    int last_thread = std::max({std::get<0>(*thread_dims), std::get<1>(*thread_dims), std::get<2>(*thread_dims)});
+    if (level <= last_thread)
+        ERROR(L.get_name() + " must be a loop level of " + this->get_name() + " inside its GPU thread levels.", true);
+
+    // The update must be acc = acc op term
+    tiramisu::expr update = this->get_expr();
+    auto is_accumulator = [this](const tiramisu::expr &e) {
+        return e.get_expr_type() == e_op && e.get_op_type() == o_access && e.get_name() == this->get_name();
+    };
+    if (update.get_expr_type() != e_op || update.get_n_arg() != 2 ||
+        (update.get_op_type() != o_add && update.get_op_type() != o_mul &&
+         update.get_op_type() != o_min && update.get_op_type() != o_max) ||
+        is_accumulator(update.get_operand(0)) == is_accumulator(update.get_operand(1)))
+        ERROR("The expression of " + this->get_name() + " must be of the form " + this->get_name() +
+              "(..., " + L.get_name() + " - 1) op e, op being +, *, min or max, to split its reduction.", true);
+
+    if (this->get_access_relation() == NULL)
+        ERROR("The computation " + this->get_name() + " must be stored in a buffer to split its reduction.", true);
+    isl_map *accumulator_access = isl_map_copy(this->get_access_relation());
+
+    // L_block, L_chunk, then L_block is moved just inside the block levels
+    this->split(L, chunk, L_block, L_chunk);
+    std::vector<std::string> names = this->get_loop_level_names();
+    for (int l = level - 1; l > last_block; l--)
+        this->interchange(L_block, tiramisu::var(names[l]));
+
+    // L_block is the innermost GPU block level, the thread levels are one level deeper
+    if (std::get<1>(*block_dims) == -1)
+        std::get<1>(*block_dims) = last_block + 1;
+    else
+        std::get<2>(*block_dims) = last_block + 1;
+    for (int *l : {&std::get<0>(*thread_dims), &std::get<1>(*thread_dims), &std::get<2>(*thread_dims)})
+        if (*l != -1)
+            (*l)++;
+
+    // Each thread accumulates its chunk in a register
+    std::string partial_name = "_" + this->get_name() + "_partial";
+    tiramisu::buffer *partial = new tiramisu::buffer(partial_name, {1}, this->get_data_type(),
+                                                     tiramisu::a_temporary, fn);
+    partial->tag_gpu_register();
+    this->store_in(partial, {0});
+
+    // The iterations of this computation that start and end each chunk
+    isl_map *times = isl_map_intersect_domain(isl_map_copy(this->get_schedule()),
+                                              isl_set_copy(this->get_iteration_domain()));
+    int chunk_dim = loop_level_into_dynamic_dimension(level + 1);
+    auto chunk_bound = [&](bool last, const std::string &name) {
+        isl_map *inner = isl_map_from_range(isl_map_range(isl_map_copy(times)));
+        inner = isl_map_move_dims(inner, isl_dim_in, 0, isl_dim_out, 0, chunk_dim);
+        inner = last ? isl_map_lexmax(inner) : isl_map_lexmin(inner);
+        isl_set *bound = isl_set_flatten(isl_map_wrap(inner));
+        bound = isl_set_set_tuple_name(bound, isl_map_get_tuple_name(times, isl_dim_out));
+        bound = isl_set_apply(bound, isl_map_reverse(isl_map_copy(times)));
+        return isl_set_set_tuple_name(bound, name.c_str());
+    };
+
+    std::vector<tiramisu::var> iterators;
+    for (const auto &name : this->get_iteration_domain_dimension_names())
+        iterators.push_back(tiramisu::var(name));
+
+    isl_set *first = chunk_bound(false, partial_name + "_dec");
+    tiramisu::computation *dec = new tiramisu::computation(isl_set_to_str(first), allocate(*partial),
+                                                           true, p_none, fn);
+    first = isl_set_set_tuple_name(first, (partial_name + "_init").c_str());
+    tiramisu::computation *init = new tiramisu::computation(isl_set_to_str(first),
+                                                            get_reduction_identity(update.get_op_type(),
+                                                                                   this->get_data_type()),
+                                                            true, this->get_data_type(), fn);
+    isl_set_free(first);
+    init->store_in(partial, {0});
+
+    // The partial result of the thread is combined with the accumulator after the chunk
+    std::string combine_name = this->get_name() + "_combine";
+    std::vector<tiramisu::expr> indices(iterators.begin(), iterators.end());
+    tiramisu::expr combined(update.get_op_type(),
+                            tiramisu::expr(o_access, combine_name, indices, this->get_data_type()),
+                            tiramisu::expr(o_access, this->get_name(), indices, this->get_data_type()));
+    isl_set *last = chunk_bound(true, combine_name);
+    tiramisu::computation *combine = new tiramisu::computation(isl_set_to_str(last), combined, true,
+                                                               this->get_data_type(), fn);
+    isl_set_free(last);
+    isl_map_free(times);
+    accumulator_access = isl_map_set_tuple_name(accumulator_access, isl_dim_in, combine->get_name().c_str());
+    combine->set_access(accumulator_access);
+    isl_map_free(accumulator_access);
+
+    std::tuple<int, int, int> blocks = *block_dims, threads = *thread_dims;
+    for (tiramisu::computation *comp : {dec, init, combine})
+    {
+        isl_map *schedule = isl_map_set_tuple_name(isl_map_copy(this->get_schedule()), isl_dim_in,
+                                                   comp->get_name().c_str());
+        comp->set_schedule(isl_map_set_tuple_name(schedule, isl_dim_out, comp->get_name().c_str()));
+        fn->gpu_block_dimensions.push_back(std::make_pair(comp->get_name(), blocks));
+        fn->gpu_thread_dimensions.push_back(std::make_pair(comp->get_name(), threads));
+        comp->thread_block_shape = this->thread_block_shape;
+    }
+
+    // dec, init, this computation, combine, inside the loop level that encloses L_chunk
+    tiramisu::computation *pred = this->get_predecessor();
+    tiramisu::computation *succ = this->get_successor();
+    int succ_level = (succ != nullptr) ? fn->sched_graph[this][succ] : computation::root_dimension;
+    if (pred != nullptr)
+        dec->between(*pred, fn->sched_graph[pred][this], *this, level);
+    else
+        dec->before(*this, level);
+    init->between(*dec, level, *this, level);
+    if (succ != nullptr)
+        combine->between(*this, level, *succ, succ_level);
+    else
+        combine->after(*this, level);
+
+    // One atomic update of the accumulator per thread and chunk
+    fn->add_reduction_dimension(combine->get_name(), last_block + 1, tiramisu::reduction_atomic, 1);
+
+    DEBUG(3, tiramisu::str_dump("The reduction level " + L.get_name() + " of " + this->get_name() +
+                                " is split in chunks of " + std::to_string(chunk) + " iterations, one per GPU block"));
+
+    DEBUG_INDENT(-4);
+}
+
+computation *computation::co_execute_on_gpu(tiramisu::var i, tiramisu::expr split)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    function *fn = this->get_function();
+
+    // The GPU buffer that corresponds to a host buffer (see function::add_mapping())
+    auto device_buffer = [fn](isl_map *access) -> tiramisu::buffer * {
+        const char *host = (access == NULL) ? NULL : isl_map_get_tuple_name(access, isl_dim_out);
+        auto mapped = (host == NULL) ? fn->mapping.end() : fn->mapping.find(host);
+        return (mapped == fn->mapping.end()) ? nullptr : mapped->second;
+    };
+
+    tiramisu::buffer *output = device_buffer(this->get_access_relation());
+    if (output == nullptr)
+        ERROR("The buffer of " + this->get_name() + " has no corresponding GPU buffer (see function::add_mapping()).", true);
+
+    // The GPU version reads the GPU buffers that correspond to the host buffers read by this computation
+    std::set<std::string> read;
+    std::function<expr(const expr &)> find_reads = [&](const expr &e) {
+        if (e.get_expr_type() == e_op && e.get_op_type() == o_access)
+            read.insert(e.get_name());
+        return e.apply_to_operands(find_reads);
+    };
+    find_reads(this->get_expr());
+
+    tiramisu::expr gpu_expr = this->get_expr();
+    for (const auto &name : read)
+    {
+        computation *inp = fn->get_computation_by_name(name)[0];
+        tiramisu::buffer *device = device_buffer(inp->get_access_relation());
+        if (device == nullptr)
+            ERROR("The buffer of " + name + ", read by " + this->get_name() +
+                  ", has no corresponding GPU buffer (see function::add_mapping()).", true);
+
+        // Shared by the computations co-executed on the GPU that read the same buffer
+        if (fn->get_computation_by_name(name + "_gpu").empty())
+        {
+            std::vector<var> iterators;
+            for (int d = 0; d < isl_set_dim(inp->get_iteration_domain(), isl_dim_set); d++)
+                iterators.push_back(var(generate_new_variable_name(), false));
+            input *device_inp = new input(name + "_gpu", iterators, inp->get_data_type());
+            isl_map *access = isl_map_set_tuple_name(isl_map_copy(inp->get_access_relation()), isl_dim_in,
+                                                     device_inp->get_name().c_str());
+            access = isl_map_set_tuple_name(access, isl_dim_out, device->get_name().c_str());
+            device_inp->set_access(access);
+            isl_map_free(access);
+        }
+        gpu_expr = gpu_expr.substitute_access(name, name + "_gpu");
+    }
+
+    std::string gpu_name = this->get_name() + "_gpu";
+    isl_set *domain = isl_set_set_tuple_name(isl_set_copy(this->get_iteration_domain()), gpu_name.c_str());
+    computation *gpu = new computation(isl_set_to_str(domain), gpu_expr, true, this->get_data_type(), fn);
+    isl_set_free(domain);
+    isl_map *access = isl_map_set_tuple_name(isl_map_copy(this->get_access_relation()), isl_dim_in, gpu_name.c_str());
+    access = isl_map_set_tuple_name(access, isl_dim_out, output->get_name().c_str());
+    gpu->set_access(access);
+    isl_map_free(access);
+
+    // The iterations of i before split run on the CPU, the others on the GPU
+    tiramisu::expr cpu_part = (i < split);
+    tiramisu::expr gpu_part = (i >= split);
+    if (this->predicate.is_defined())
+    {
+        cpu_part = (this->predicate && cpu_part);
+        gpu_part = (this->predicate && gpu_part);
+    }
+    this->add_predicate(cpu_part);
+    gpu->add_predicate(gpu_part);
+
+    // The kernels are launched asynchronously: the GPU part runs while the CPU part runs
+    computation *pred = this->get_predecessor();
+    if (pred != nullptr)
+        gpu->between(*pred, fn->sched_graph[pred][this], *this, computation::root_dimension);
+    else
+        gpu->before(*this, computation::root_dimension);
+
+    DEBUG(3, tiramisu::str_dump("The iterations of " + this->get_name() + " from " + split.to_str() +
+                                " along " + i.get_name() + " are computed by " + gpu_name + " on the GPU."));
+    DEBUG_INDENT(-4);
+
+    return gpu;
+}
+
 void computation::gpu_tile(tiramisu::var L0_var, tiramisu::var L1_var, tiramisu::var L2_var, int sizeX, int sizeY, int sizeZ)
 {
     assert(L0_var.get_name().length() > 0);
@@ -3084,41 +4459,250 @@ void computation::interchange(tiramisu::var L0_var, tiramisu::var L1_var)
  * This function modifies the schedule of the computation so that the two loop
  * levels L0 and L1 are interchanged (swapped).
  */
-void computation::interchange(int L0, int L1)
+void computation::time_tile(tiramisu::var t, tiramisu::var i, int size,
+                            tiramisu::var wavefront, tiramisu::var tile, int slope)
 {
     DEBUG_FCT_NAME(3);
     DEBUG_INDENT(4);
 
-    int inDim0 = loop_level_into_dynamic_dimension(L0);
-    int inDim1 = loop_level_into_dynamic_dimension(L1);
+    assert(t.get_name().length() > 0);
+    assert(i.get_name().length() > 0);
+    assert(wavefront.get_name().length() > 0);
+    assert(tile.get_name().length() > 0);
 
-    assert(inDim0 >= 0);
-    assert(inDim0 < isl_space_dim(isl_map_get_space(this->get_schedule()),
-                                  isl_dim_out));
-    assert(inDim1 >= 0);
-    assert(inDim1 < isl_space_dim(isl_map_get_space(this->get_schedule()),
-                                  isl_dim_out));
+    std::vector<std::string> original_loop_level_names = this->get_loop_level_names();
 
-    isl_map *schedule = this->get_schedule();
+    this->assert_names_not_assigned({wavefront.get_name(), tile.get_name()});
 
-    DEBUG(3, tiramisu::str_dump("Original schedule: ", isl_map_to_str(schedule)));
-    DEBUG(3, tiramisu::str_dump("Interchanging the dimensions " + std::to_string(
-                                    L0) + " and " + std::to_string(L1)));
+    std::vector<int> dimensions =
+        this->get_loop_level_numbers_from_dimension_names({t.get_name(), i.get_name()});
+    this->check_dimensions_validity(dimensions);
 
-    int n_dims = isl_map_dim(schedule, isl_dim_out);
+    this->time_tile(dimensions[0], dimensions[1], size, slope);
 
-    std::string inDim0_str = isl_map_get_dim_name(schedule, isl_dim_out, inDim0);
-    std::string inDim1_str = isl_map_get_dim_name(schedule, isl_dim_out, inDim1);
+    // The loop levels t and i keep their names inside the tiles
+    this->update_names(original_loop_level_names, {wavefront.get_name(), tile.get_name(),
+                                                   t.get_name(), i.get_name()}, dimensions[0], 2);
 
-    std::vector<isl_id *> dimensions;
+    DEBUG_INDENT(-4);
+}
 
-    // ------------------------------------------------------------
-    // Create a map for the duplicate schedule.
-    // ------------------------------------------------------------
+void computation::time_tile(int L_t, int L_i, int size, int slope)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
 
-    std::string map = "{ " + this->get_name() + "[";
+    assert(size >= 1);
+    assert(slope >= 0);
 
-    for (int i = 0; i < n_dims; i++)
+    if (L_i != L_t + 1)
+        ERROR("The space loop level of time_tile() must be the loop level right inside the time loop level.", true);
+
+    if (this->get_function()->dep_read_after_write != NULL)
+    {
+        int legal_slope = this->get_time_tile_slope(L_t, L_i, slope);
+
+        if (legal_slope < 0)
+            ERROR("The diamond tiling of " + this->get_name() + " is not legal" +
+                  ((slope != 0) ? " with a slope of " + std::to_string(slope) : "") + ".", true);
+
+        slope = legal_slope;
+    }
+    else if (slope == 0)
+    {
+        ERROR("time_tile() needs the dependence analysis (function::perform_full_dependency_analysis()) "
+              "to derive the slope of the tiles of " + this->get_name() + ".", true);
+    }
+
+    int dim_t = loop_level_into_dynamic_dimension(L_t);
+    int dim_i = loop_level_into_dynamic_dimension(L_i);
+
+    isl_map *schedule = this->get_schedule();
+    int duplicate_ID = isl_map_get_static_dim(schedule, 0);
+
+    schedule = isl_map_copy(schedule);
+    schedule = isl_map_set_tuple_id(schedule, isl_dim_out,
+                                    isl_id_alloc(this->get_ctx(), this->get_name().c_str(), NULL));
+
+    DEBUG(3, tiramisu::str_dump("Original schedule: ", isl_map_to_str(schedule)));
+    DEBUG(3, tiramisu::str_dump("Diamond tiling of the dimensions " + std::to_string(dim_t) + " and " +
+                                std::to_string(dim_i) + " with a size of " + std::to_string(size) +
+                                " and a slope of " + std::to_string(slope)));
+
+    std::string wavefront_str = generate_new_variable_name();
+    std::string tile_str = generate_new_variable_name();
+    std::string static_dim0_str = generate_new_variable_name();
+    std::string static_dim1_str = generate_new_variable_name();
+
+    int n_dims = isl_map_dim(this->get_schedule(), isl_dim_out);
+    std::vector<isl_id *> dimensions;
+    std::vector<std::string> dimensions_str;
+
+    for (int d = 0; d < n_dims; d++)
+        dimensions_str.push_back(generate_new_variable_name());
+
+    std::string map = "{" + this->get_name() + "[";
+    for (int d = 0; d < n_dims; d++)
+        map = map + dimensions_str[d] + ((d != n_dims - 1) ? "," : "");
+
+    // The tile loop levels are inserted before t: [..., t, s, i, ...] -> [..., w, 0, b, 0, t, s, i, ...]
+    map = map + "] -> " + this->get_name() + "[";
+    for (int d = 0; d < n_dims; d++)
+    {
+        if (d == dim_t)
+        {
+            map = map + wavefront_str + "," + static_dim0_str + "," + tile_str + "," + static_dim1_str + ",";
+            for (const auto &name : {wavefront_str, static_dim0_str, tile_str, static_dim1_str})
+                dimensions.push_back(isl_id_alloc(this->get_ctx(), name.c_str(), NULL));
+        }
+
+        map = map + dimensions_str[d] + ((d != n_dims - 1) ? "," : "");
+        dimensions.push_back(isl_id_alloc(this->get_ctx(), dimensions_str[d].c_str(), NULL));
+    }
+
+    std::string forward = "(" + std::to_string(slope) + "*" + dimensions_str[dim_t] + " + " + dimensions_str[dim_i] + ")";
+    std::string backward = "(" + std::to_string(slope) + "*" + dimensions_str[dim_t] + " - " + dimensions_str[dim_i] + ")";
+
+    map = map + "] : " + dimensions_str[0] + " = " + std::to_string(duplicate_ID) + " and " +
+          wavefront_str + " = floor(" + forward + "/" + std::to_string(size) + ") + floor(" +
+          backward + "/" + std::to_string(size) + ") and " +
+          tile_str + " = floor(" + forward + "/" + std::to_string(size) + ") and " +
+          static_dim0_str + " = 0 and " + static_dim1_str + " = 0}";
+
+    DEBUG(3, tiramisu::str_dump("Transformation map (string format) : " + map));
+
+    isl_map *transformation_map = isl_map_read_from_str(this->get_ctx(), map.c_str());
+
+    for (int d = 0; d < dimensions.size(); d++)
+        transformation_map = isl_map_set_dim_id(
+                                 transformation_map, isl_dim_out, d, isl_id_copy(dimensions[d]));
+
+    transformation_map = isl_map_set_tuple_id(
+                             transformation_map, isl_dim_in,
+                             isl_map_get_tuple_id(isl_map_copy(schedule), isl_dim_out));
+    isl_id *id_range = isl_id_alloc(this->get_ctx(), this->get_name().c_str(), NULL);
+    transformation_map = isl_map_set_tuple_id(transformation_map, isl_dim_out, id_range);
+
+    DEBUG(3, tiramisu::str_dump("Transformation map : ",
+                                isl_map_to_str(transformation_map)));
+
+    schedule = isl_map_apply_range(isl_map_copy(schedule), isl_map_copy(transformation_map));
+
+    DEBUG(3, tiramisu::str_dump("Schedule after diamond tiling: ", isl_map_to_str(schedule)));
+
+    this->set_schedule(schedule);
+
+    DEBUG_INDENT(-4);
+}
+
+int computation::get_time_tile_slope(int L_t, int L_i, int slope)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(this->get_function()->dep_read_after_write != NULL);
+
+    int dim_t = loop_level_into_dynamic_dimension(L_t);
+    int dim_i = loop_level_into_dynamic_dimension(L_i);
+
+    // The dependences of the computation on itself
+    isl_space *space = isl_space_map_from_set(isl_set_get_space(this->get_iteration_domain()));
+    isl_map *self_deps = isl_map_empty(isl_space_copy(space));
+
+    for (isl_union_map *deps : {this->get_function()->dep_read_after_write,
+                                this->get_function()->dep_write_after_read,
+                                this->get_function()->dep_write_after_write})
+    {
+        if (deps == NULL)
+            continue;
+
+        isl_union_map *simple_deps = isl_union_map_range_factor_domain(isl_union_map_copy(deps));
+        self_deps = isl_map_union(self_deps, isl_union_map_extract_map(simple_deps, isl_space_copy(space)));
+        isl_union_map_free(simple_deps);
+    }
+    isl_space_free(space);
+
+    // The distance vectors of the dependences in the time-space of the current schedule
+    isl_map *schedule = isl_map_copy(this->get_schedule());
+    isl_map *time_deps = isl_map_apply_range(isl_map_apply_domain(self_deps, isl_map_copy(schedule)), schedule);
+    isl_set *deltas = isl_map_deltas(time_deps);
+
+    // The dependences carried by the loop levels outside t are not affected
+    for (int d = 0; d < dim_t; d++)
+        deltas = isl_set_fix_si(deltas, isl_dim_set, d, 0);
+
+    DEBUG(3, tiramisu::str_dump("Dependence distances inside the loop level " + std::to_string(L_t) + ": ",
+                                isl_set_to_str(deltas)));
+
+    // The tiles respect a dependence of distance (dt, di) if slope*dt + di >= 0 and slope*dt - di >= 0
+    int min_slope = (slope != 0) ? slope : 1;
+    int max_slope = (slope != 0) ? slope : 16;
+    int result = -1;
+
+    for (int candidate = min_slope; candidate <= max_slope && result < 0; candidate++)
+    {
+        isl_local_space *lsp = isl_local_space_from_space(isl_set_get_space(deltas));
+        isl_set *cone = isl_set_universe(isl_set_get_space(deltas));
+
+        for (int sign : {1, -1})
+        {
+            isl_constraint *cst = isl_constraint_alloc_inequality(isl_local_space_copy(lsp));
+            cst = isl_constraint_set_coefficient_si(cst, isl_dim_set, dim_t, candidate);
+            cst = isl_constraint_set_coefficient_si(cst, isl_dim_set, dim_i, sign);
+            cone = isl_set_add_constraint(cone, cst);
+        }
+
+        if (isl_set_is_subset(deltas, cone) == isl_bool_true)
+            result = candidate;
+
+        isl_set_free(cone);
+        isl_local_space_free(lsp);
+    }
+
+    isl_set_free(deltas);
+
+    DEBUG(3, tiramisu::str_dump("Slope of the diamond tiles: " + std::to_string(result)));
+
+    DEBUG_INDENT(-4);
+
+    return result;
+}
+
+void computation::interchange(int L0, int L1)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    int inDim0 = loop_level_into_dynamic_dimension(L0);
+    int inDim1 = loop_level_into_dynamic_dimension(L1);
+
+    assert(inDim0 >= 0);
+    assert(inDim0 < isl_space_dim(isl_map_get_space(this->get_schedule()),
+                                  isl_dim_out));
+    assert(inDim1 >= 0);
+    assert(inDim1 < isl_space_dim(isl_map_get_space(this->get_schedule()),
+                                  isl_dim_out));
+
+    isl_map *schedule = this->get_schedule();
+
+    DEBUG(3, tiramisu::str_dump("Original schedule: ", isl_map_to_str(schedule)));
+    DEBUG(3, tiramisu::str_dump("Interchanging the dimensions " + std::to_string(
+                                    L0) + " and " + std::to_string(L1)));
+
+    int n_dims = isl_map_dim(schedule, isl_dim_out);
+
+    std::string inDim0_str = isl_map_get_dim_name(schedule, isl_dim_out, inDim0);
+    std::string inDim1_str = isl_map_get_dim_name(schedule, isl_dim_out, inDim1);
+
+    std::vector<isl_id *> dimensions;
+
+    // ------------------------------------------------------------
+    // Create a map for the duplicate schedule.
+    // ------------------------------------------------------------
+
+    std::string map = "{ " + this->get_name() + "[";
+
+    for (int i = 0; i < n_dims; i++)
     {
         if (i == 0)
         {
@@ -4691,6 +6275,109 @@ void computation::skew(int L0 , int L1, int alpha , int beta, int gamma , int si
     this->set_schedule(schedule);
 }
 
+/**
+ * Return the determinant of the square integer matrix \p m (Bareiss algorithm).
+ */
+static long integer_determinant(std::vector<std::vector<long>> m)
+{
+    int n = m.size();
+    long sign = 1, previous = 1;
+
+    for (int k = 0; k < n - 1; k++)
+    {
+        if (m[k][k] == 0)
+        {
+            int pivot = k + 1;
+            while (pivot < n && m[pivot][k] == 0)
+                pivot++;
+
+            if (pivot == n)
+                return 0;
+
+            std::swap(m[k], m[pivot]);
+            sign = -sign;
+        }
+
+        for (int i = k + 1; i < n; i++)
+            for (int j = k + 1; j < n; j++)
+                m[i][j] = (m[i][j] * m[k][k] - m[i][k] * m[k][j]) / previous;
+
+        previous = m[k][k];
+    }
+
+    return (n == 0) ? 1 : sign * m[n - 1][n - 1];
+}
+
+void computation::unimodular_transform(int L, const std::vector<std::vector<int>> &matrix)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    int n = matrix.size();
+    assert(n > 0);
+
+    std::vector<std::vector<long>> m(n);
+    for (int i = 0; i < n; i++)
+    {
+        assert(matrix[i].size() == n);
+        m[i].assign(matrix[i].begin(), matrix[i].end());
+    }
+
+    if (std::abs(integer_determinant(m)) != 1)
+        ERROR("The transformation matrix must be unimodular (its determinant must be 1 or -1).", true);
+
+    this->check_dimensions_validity({L, L + n - 1});
+
+    isl_map *schedule = isl_map_copy(this->get_schedule());
+    schedule = isl_map_set_tuple_id(schedule, isl_dim_out,
+                                    isl_id_alloc(this->get_ctx(), this->get_name().c_str(), NULL));
+
+    int n_dims = isl_map_dim(schedule, isl_dim_out);
+    std::string in_dims, out_dims;
+
+    for (int i = 0; i < n_dims; i++)
+    {
+        std::string separator = (i > 0) ? ", " : "";
+        in_dims += separator + "t" + std::to_string(i);
+
+        int k = 0;
+        while (k < n && loop_level_into_dynamic_dimension(L + k) != i)
+            k++;
+
+        if (k == n)
+        {
+            out_dims += separator + "t" + std::to_string(i);
+            continue;
+        }
+
+        out_dims += separator + "0";
+        for (int j = 0; j < n; j++)
+            if (matrix[k][j] != 0)
+                out_dims += " + " + std::to_string(matrix[k][j]) + "*t" +
+                            std::to_string(loop_level_into_dynamic_dimension(L + j));
+    }
+
+    std::string map = "{" + this->get_name() + "[" + in_dims + "] -> " + this->get_name() + "[" + out_dims + "]}";
+
+    DEBUG(3, tiramisu::str_dump("Transformation map (string format) : " + map));
+
+    isl_map *transformation = isl_map_read_from_str(this->get_ctx(), map.c_str());
+
+    // The loop levels keep their names
+    for (int i = 0; i < n_dims; i++)
+        if (isl_map_has_dim_id(schedule, isl_dim_out, i) == isl_bool_true)
+            transformation = isl_map_set_dim_id(transformation, isl_dim_out, i,
+                                                isl_map_get_dim_id(schedule, isl_dim_out, i));
+
+    schedule = isl_map_apply_range(schedule, transformation);
+
+    DEBUG(3, tiramisu::str_dump("Schedule after transformation : ", isl_map_to_str(schedule)));
+
+    this->set_schedule(schedule);
+
+    DEBUG_INDENT(-4);
+}
+
 
 bool tiramisu::computation::involved_subset_of_dependencies_is_legal(tiramisu::computation * second)
 {
@@ -6736,6 +8423,14 @@ std::string str_from_tiramisu_type_primitive(tiramisu::primitive_t type)
         return "float32";
     case tiramisu::p_float64:
         return "float64";
+    case tiramisu::p_float16:
+        return "float16";
+    case tiramisu::p_bfloat16:
+        return "bfloat16";
+    case tiramisu::p_complex64:
+        return "complex64";
+    case tiramisu::p_complex128:
+        return "complex128";
     case tiramisu::p_boolean:
         return "bool";
     case tiramisu::p_wait_ptr:
@@ -6770,6 +8465,14 @@ tiramisu::buffer::buffer(std::string name, std::vector<tiramisu::expr> dim_sizes
     assert(!name.empty() && "Empty buffer name");
     assert(fct != NULL && "Input function is NULL");
 
+    // Complex numbers are stored as pairs of reals in an innermost dimension
+    if (is_complex_type(type))
+    {
+        this->complex_type = type;
+        this->type = complex_component_type(type);
+        this->dim_sizes.push_back(tiramisu::expr((int32_t) 2));
+    }
+
     // Check that the buffer does not already exist.
     assert((fct->get_buffers().count(name) == 0) && ("Buffer already exists"));
     if(corr.compare("") != 0)
@@ -6845,6 +8548,11 @@ tiramisu::primitive_t buffer::get_elements_type() const
     return type;
 }
 
+tiramisu::primitive_t buffer::get_complex_type() const
+{
+    return complex_type;
+}
+
 /**
   * Return the sizes of the dimensions of the buffer.
   * Assuming the following buffer: buf[N0][N1][N2].  The first
@@ -6922,6 +8630,19 @@ Halide::Type halide_type_from_tiramisu_type(tiramisu::primitive_t type)
     case tiramisu::p_float64:
         t = Halide::Float(64);
         break;
+    case tiramisu::p_float16:
+        t = Halide::Float(16);
+        break;
+    case tiramisu::p_bfloat16:
+        t = Halide::BFloat(16);
+        break;
+    // The values of complex types are vectors of their real and imaginary parts
+    case tiramisu::p_complex64:
+        t = Halide::Float(32, 2);
+        break;
+    case tiramisu::p_complex128:
+        t = Halide::Float(64, 2);
+        break;
     case tiramisu::p_boolean:
         t = Halide::Bool();
         break;
@@ -6937,6 +8658,18 @@ Halide::Type halide_type_from_tiramisu_type(tiramisu::primitive_t type)
     return t;
 }
 
+bool is_complex_type(tiramisu::primitive_t type)
+{
+    return (type == tiramisu::p_complex64) || (type == tiramisu::p_complex128);
+}
+
+tiramisu::primitive_t complex_component_type(tiramisu::primitive_t type)
+{
+    assert(is_complex_type(type) && "Not a complex type.");
+
+    return (type == tiramisu::p_complex64) ? tiramisu::p_float32 : tiramisu::p_float64;
+}
+
 //----------------
 
 std::map<std::string, isl_ast_expr *> tiramisu::computation::get_iterators_map()
@@ -7314,7 +9047,7 @@ isl_map *tiramisu::computation::get_access_relation_adapted_to_time_processor_do
                                              isl_map_to_str(this->get_trimmed_union_of_schedules())));
                 access = isl_map_apply_domain(
                              isl_map_copy(access),
-                             isl_map_copy(this->get_trimmed_union_of_schedules()));
+                             this->get_trimmed_union_of_schedules());
                 DEBUG(10, tiramisu::str_dump("Transformed access:", isl_map_to_str(access)));
             }
             else
@@ -7435,6 +9168,16 @@ bool tiramisu::computation::is_library_call() const
     return this->_is_library_call;
 }
 
+bool tiramisu::computation::is_inspector() const
+{
+    return this->_is_inspector;
+}
+
+bool tiramisu::computation::is_vector_reduction() const
+{
+    return this->_is_vector_reduction;
+}
+
 bool tiramisu::computation::should_drop_rank_iter() const
 {
     return this->_drop_rank_iter;
@@ -7552,6 +9295,7 @@ void tiramisu::computation::gen_time_space_domain()
 
     DEBUG(3, tiramisu::str_dump("Iteration domain Intersect context:", isl_set_to_str(iter)));
 
+    isl_set_free(time_processor_domain);
     time_processor_domain = isl_set_apply(
                                 iter,
                                 isl_map_copy(this->get_schedule()));
@@ -7663,8 +9407,8 @@ isl_map *tiramisu::computation::gen_identity_schedule_for_iteration_domain()
 
 isl_set *tiramisu::computation::get_trimmed_time_processor_domain()
 {
-    isl_set *tp_domain = isl_set_copy(this->get_time_processor_domain());
-    const char *name = isl_set_get_tuple_name(isl_set_copy(tp_domain));
+    isl_set *tp_domain = this->get_time_processor_domain();
+    const char *name = isl_set_get_tuple_name(tp_domain);
     isl_set *tp_domain_without_duplicate_dim =
         isl_set_project_out(isl_set_copy(tp_domain), isl_dim_set, 0, 1);
     tp_domain_without_duplicate_dim = isl_set_set_tuple_name(tp_domain_without_duplicate_dim, name);
@@ -7686,8 +9430,7 @@ isl_map *tiramisu::computation::gen_identity_schedule_for_time_space_domain()
     isl_set *tp_domain = this->get_trimmed_time_processor_domain();
     isl_space *sp = isl_set_get_space(tp_domain);
     isl_map *sched = isl_map_identity(isl_space_map_from_set(sp));
-    sched = isl_map_intersect_domain(
-                sched, isl_set_copy(this->get_trimmed_time_processor_domain()));
+    sched = isl_map_intersect_domain(sched, tp_domain);
     sched = isl_map_set_tuple_name(sched, isl_dim_out, "");
     sched = isl_map_coalesce(sched);
 
@@ -7707,10 +9450,12 @@ void tiramisu::computation::set_identity_schedule_based_on_iteration_domain()
     DEBUG_FCT_NAME(3);
     DEBUG_INDENT(4);
 
+    isl_map *old_sched = this->get_schedule();
     isl_map *sched = this->gen_identity_schedule_for_iteration_domain();
     DEBUG(3, tiramisu::str_dump("The following identity schedule is generated (setting schedule 0): "));
     DEBUG(3, tiramisu::str_dump(isl_map_to_str(sched)));
     this->set_schedule(sched);
+    isl_map_free(old_sched);
     DEBUG(3, tiramisu::str_dump("The identity schedule for the original computation is set."));
 
     DEBUG_INDENT(-4);
@@ -7788,6 +9533,11 @@ bool tiramisu::computation::is_wait() const
   return false;
 }
 
+bool tiramisu::computation::is_collective() const
+{
+  return false;
+}
+
 const std::vector<std::pair<std::string, tiramisu::expr>>
         &tiramisu::computation::get_associated_let_stmts() const
 {
@@ -7842,12 +9592,24 @@ const bool tiramisu::computation::is_inline_computation() const {
     return this->is_inline;
 }
 
+void tiramisu::computation::set_math_precision(tiramisu::math_precision_t precision) {
+    this->math_precision = precision;
+}
+
+tiramisu::math_precision_t tiramisu::computation::get_math_precision() const {
+    return this->math_precision;
+}
+
 /**
  * Set the name of the computation.
  */
 void tiramisu::computation::set_name(const std::string &n)
 {
+    std::string old_name = this->name;
     this->name = n;
+
+    if (this->fct != NULL && old_name != n)
+        this->fct->update_computation_name(this, old_name);
 }
 
 /**
@@ -7924,6 +9686,36 @@ void tiramisu::computation::store_in(buffer *buff, std::vector<tiramisu::expr> i
     DEBUG_INDENT(-4);
 }
 
+void tiramisu::computation::store_in(view *v)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(v != NULL);
+
+    if (v->get_access_relation() == NULL)
+        ERROR("The view " + v->get_name() + " is not mapped to a buffer.", true);
+    if (isl_set_dim(this->get_iteration_domain(), isl_dim_set) != isl_set_dim(v->get_iteration_domain(), isl_dim_set))
+        ERROR("The computation " + this->get_name() + " and the view " + v->get_name() +
+              " do not have the same number of dimensions.", true);
+
+    // C[i, j, ...] -> V[i, j, ...] -> element of the buffer of V
+    isl_space *sp = isl_set_get_space(this->get_iteration_domain());
+    isl_map *map = isl_map_identity(isl_space_map_from_set(sp));
+    map = isl_map_set_tuple_name(map, isl_dim_out, v->get_name().c_str());
+    map = isl_map_apply_range(map, isl_map_copy(v->get_access_relation()));
+    map = isl_map_coalesce(map);
+
+    DEBUG(3, tiramisu::str_dump("Binding. The following access function is set: ",
+                                isl_map_to_str(map)));
+
+    this->set_access(map);
+
+    isl_map_free(map);
+
+    DEBUG_INDENT(-4);
+}
+
 void computation::store_in(std::vector<expr> mapping, std::vector<expr> sizes) {
     DEBUG_FCT_NAME(3);
     DEBUG_INDENT(4);
@@ -7949,6 +9741,11 @@ void tiramisu::computation::mark_as_library_call()
     this->_is_library_call = true;
 }
 
+void tiramisu::computation::mark_as_inspector()
+{
+    this->_is_inspector = true;
+}
+
 /****************************************************************************
  ****************************************************************************
  ***************************** Constant class *******************************
@@ -8139,32 +9936,246 @@ tiramisu::constant::constant(
     DEBUG_INDENT(-4);
 }
 
-void tiramisu::constant::dump(bool exhaustive) const
+std::string tiramisu::sparse_computation::construct_sparse_iteration_domain(std::string name, std::vector<var> iterator_variables,
+                                                                            tiramisu::buffer &sparse_buffer)
 {
-    if (ENABLE_DEBUG)
-    {
-        std::cout << "Invariant \"" << this->get_name() << "\"" << std::endl;
-        std::cout << "Expression: ";
-        this->get_expr().dump(false);
-        std::cout << std::endl;
-    }
-}
+    tiramisu::function *fct = global::get_implicit_function();
 
-tiramisu::constant::operator expr()
-{
-    return var(this->get_data_type(), this->get_name());
-    // return this->get_expr();
-}
+    if (fct == NULL)
+        ERROR("An implicit function has to be created by providing a function name to init(NAME).", true);
 
-void tiramisu::buffer::set_dim_size(int dim, int size)
-{
-    assert(dim >= 0);
-    assert(dim < this->dim_sizes.size());
-    assert(this->dim_sizes.size() > 0);
-    assert(size > 0);
+    std::vector<std::string> params = fct->get_invariant_names();
+    std::string domain;
 
-    this->dim_sizes[dim] = size;
-}
+    switch (sparse_buffer.get_sparse_format())
+    {
+        case tiramisu::sparse_csr:
+        case tiramisu::sparse_csc:
+        {
+            if (iterator_variables.size() != 2)
+                ERROR("A computation that iterates over the CSR or CSC matrix " + sparse_buffer.get_name() +
+                      " must have two iterators (the outer loop and the positions).", true);
+
+            const var &outer = iterator_variables[0];
+            if (!outer.lower.is_defined() || !outer.upper.is_defined())
+                ERROR("The outer iterator " + outer.get_name() + " of " + name + " must have bounds.", true);
+
+            params.push_back(name + "_begin");
+            params.push_back(name + "_end");
+            domain = "{" + name + "[" + outer.get_name() + ", " + iterator_variables[1].get_name() + "]: " +
+                     outer.lower.to_str() + "<=" + outer.get_name() + "<" + outer.upper.to_str() + "}";
+            break;
+        }
+        case tiramisu::sparse_coo:
+        {
+            if (iterator_variables.size() != 1)
+                ERROR("A computation that iterates over the COO matrix " + sparse_buffer.get_name() +
+                      " must have one iterator (the positions).", true);
+
+            const std::string &p = iterator_variables[0].get_name();
+            domain = "{" + name + "[" + p + "]: 0<=" + p + "<" + sparse_buffer.get_dim_sizes()[0].to_str() + "}";
+            break;
+        }
+        case tiramisu::sparse_sell:
+        {
+            if (iterator_variables.size() != 3)
+                ERROR("A computation that iterates over the SELL matrix " + sparse_buffer.get_name() +
+                      " must have three iterators (the slices, the columns and the rows of a slice).", true);
+
+            const var &slice = iterator_variables[0];
+            if (!slice.lower.is_defined() || !slice.upper.is_defined())
+                ERROR("The slice iterator " + slice.get_name() + " of " + name + " must have bounds.", true);
+
+            params.push_back(name + "_begin");
+            params.push_back(name + "_end");
+            domain = "{" + name + "[" + slice.get_name() + ", " + iterator_variables[1].get_name() + ", " +
+                     iterator_variables[2].get_name() + "]: " +
+                     slice.lower.to_str() + "<=" + slice.get_name() + "<" + slice.upper.to_str() + "}";
+            break;
+        }
+        default:
+            ERROR("The buffer " + sparse_buffer.get_name() + " is not sparse.", true);
+    }
+
+    std::string params_str;
+    for (size_t i = 0; i < params.size(); i++)
+        params_str += params[i] + ((i < params.size() - 1) ? ", " : "");
+
+    return (params.empty() ? "" : "[" + params_str + "]->") + domain;
+}
+
+tiramisu::sparse_computation::sparse_computation(std::string name, std::vector<var> iterator_variables,
+                                                 tiramisu::buffer &sparse_buffer, primitive_t t)
+    : computation(construct_sparse_iteration_domain(name, iterator_variables, sparse_buffer),
+                  tiramisu::expr(), true, t, global::get_implicit_function()),
+      sparse_buffer(&sparse_buffer), iterators(iterator_variables)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    tiramisu::function *fct = this->get_function();
+    std::string params_str = utility::get_parameters_list(this->get_iteration_domain());
+    params_str = params_str.empty() ? "" : "[" + params_str + "]->";
+
+    // The computations that read the entries and the index buffers
+    auto read_buffer = [&](tiramisu::buffer *b, const std::string &input_name)
+    {
+        tiramisu::computation *c = new tiramisu::computation(
+            params_str + "{" + input_name + "[p]: 0<=p<" + b->get_dim_sizes()[0].to_str() + "}",
+            tiramisu::expr(), false, b->get_elements_type(), fct);
+        c->store_in(b);
+        return c;
+    };
+
+    this->values = read_buffer(&sparse_buffer, "_" + name + "_values");
+    for (size_t i = 0; i < sparse_buffer.get_sparse_index_buffers().size(); i++)
+        this->index_values.push_back(read_buffer(sparse_buffer.get_sparse_index_buffers()[i],
+                                                 "_" + name + "_index_" + std::to_string(i)));
+
+    if (sparse_buffer.get_sparse_format() == tiramisu::sparse_sell)
+    {
+        const var &slice = this->iterators[0];
+        const var &column = this->iterators[1];
+        const var &row = this->iterators[2];
+        primitive_t pos_type = sparse_buffer.get_sparse_index_buffers()[0]->get_elements_type();
+        int chunk_size = sparse_buffer.get_sparse_chunk_size();
+
+        // The first position and the width of the slice are computed at each
+        // iteration of the loop over the slices.
+        tiramisu::expr width = ((*this->index_values[0])(slice + 1) - (*this->index_values[0])(slice)) /
+                               tiramisu::expr(tiramisu::o_cast, pos_type, chunk_size);
+        this->end = new tiramisu::constant(name + "_end", width, pos_type, false, this, 0, fct);
+        this->begin = new tiramisu::constant(name + "_begin", (*this->index_values[0])(slice), pos_type, false, this->end, 0, fct);
+
+        isl_set *entries = isl_set_read_from_str(fct->get_isl_ctx(),
+            ("[" + name + "_begin, " + name + "_end]->{" + name + "[" + slice.get_name() + ", " + column.get_name() + ", " +
+             row.get_name() + "]: 0<=" + column.get_name() + "<" + name + "_end and 0<=" + row.get_name() + "<" +
+             std::to_string(chunk_size) + "}").c_str());
+        this->set_iteration_domain(isl_set_intersect(this->get_iteration_domain(), entries));
+
+        DEBUG(3, tiramisu::str_dump("Iteration domain of the sparse computation:",
+                                    isl_set_to_str(this->get_iteration_domain())));
+    }
+    else if (sparse_buffer.get_sparse_format() != tiramisu::sparse_coo)
+    {
+        const var &outer = this->iterators[0];
+        const var &position = this->iterators[1];
+        primitive_t pos_type = sparse_buffer.get_sparse_index_buffers()[0]->get_elements_type();
+
+        // The bounds are computed at each iteration of the outer loop, before the loop over the
+        // positions, and they are projected from the domain before the positions are bounded.
+        this->end = new tiramisu::constant(name + "_end", (*this->index_values[0])(outer + 1), pos_type, false, this, 0, fct);
+        this->begin = new tiramisu::constant(name + "_begin", (*this->index_values[0])(outer), pos_type, false, this->end, 0, fct);
+
+        isl_set *positions = isl_set_read_from_str(fct->get_isl_ctx(),
+            ("[" + name + "_begin, " + name + "_end]->{" + name + "[" + outer.get_name() + ", " + position.get_name() + "]: " +
+             name + "_begin<=" + position.get_name() + "<" + name + "_end}").c_str());
+        this->set_iteration_domain(isl_set_intersect(this->get_iteration_domain(), positions));
+
+        DEBUG(3, tiramisu::str_dump("Iteration domain of the sparse computation:",
+                                    isl_set_to_str(this->get_iteration_domain())));
+    }
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::sparse_computation::order_bound_computations()
+{
+    int level = this->begin->get_loop_levels_number() - 1;
+
+    this->end->after(*this->begin, level);
+    this->after(*this->end, level);
+}
+
+tiramisu::expr tiramisu::sparse_computation::sell_position()
+{
+    int chunk_size = this->sparse_buffer->get_sparse_chunk_size();
+
+    return tiramisu::expr(*this->begin) + this->iterators[1] * chunk_size + this->iterators[2];
+}
+
+tiramisu::expr tiramisu::sparse_computation::value()
+{
+    if (this->sparse_buffer->get_sparse_format() == tiramisu::sparse_sell)
+        return (*this->values)(this->sell_position());
+
+    return (*this->values)(this->iterators.back());
+}
+
+tiramisu::expr tiramisu::sparse_computation::coordinate(int dim)
+{
+    assert((dim == 0) || (dim == 1));
+
+    const var &position = this->iterators.back();
+
+    switch (this->sparse_buffer->get_sparse_format())
+    {
+        case tiramisu::sparse_csr:
+            return (dim == 0) ? tiramisu::expr(this->iterators[0]) : (*this->index_values[1])(position);
+        case tiramisu::sparse_csc:
+            return (dim == 0) ? (*this->index_values[1])(position) : tiramisu::expr(this->iterators[0]);
+        case tiramisu::sparse_sell:
+            return (dim == 0) ? this->iterators[0] * this->sparse_buffer->get_sparse_chunk_size() + this->iterators[2]
+                              : (*this->index_values[1])(this->sell_position());
+        default:
+            return (*this->index_values[dim])(position);
+    }
+}
+
+tiramisu::computation &tiramisu::sparse_computation::get_first_computation()
+{
+    if (this->begin != nullptr)
+        return *this->begin;
+
+    return *this;
+}
+
+void tiramisu::sparse_computation::split(int L0, int sizeX)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    int shared_levels = (this->begin != nullptr) ? this->begin->get_loop_levels_number() : 0;
+
+    computation::split(L0, sizeX);
+
+    // The loops around the positions are shared with the computations of the bounds
+    if (L0 < shared_levels)
+    {
+        this->begin->split(L0, sizeX);
+        this->end->split(L0, sizeX);
+        this->order_bound_computations();
+    }
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::constant::dump(bool exhaustive) const
+{
+    if (ENABLE_DEBUG)
+    {
+        std::cout << "Invariant \"" << this->get_name() << "\"" << std::endl;
+        std::cout << "Expression: ";
+        this->get_expr().dump(false);
+        std::cout << std::endl;
+    }
+}
+
+tiramisu::constant::operator expr()
+{
+    return var(this->get_data_type(), this->get_name());
+    // return this->get_expr();
+}
+
+void tiramisu::buffer::set_dim_size(int dim, int size)
+{
+    assert(dim >= 0);
+    assert(dim < this->dim_sizes.size());
+    assert(this->dim_sizes.size() > 0);
+    assert(size > 0);
+
+    this->dim_sizes[dim] = size;
+}
 
 void tiramisu::computation::storage_fold(tiramisu::var L0_var, int factor)
 {
@@ -8311,6 +10322,7 @@ std::string tiramisu::xfer_prop::attr_to_string(tiramisu::xfer_attr attr) {
         case ASYNC: return "ASYNC";
         case MPI: return "MPI";
         case CUDA: return "CUDA";
+        case RMA: return "RMA";
         case BLOCK: return "BLOCK";
         case NONBLOCK: return "NONBLOCK";
         default: {
@@ -8328,6 +10340,10 @@ void tiramisu::xfer_prop::add_attr(tiramisu::xfer_attr attr) {
     attrs.push_back(attr);
 }
 
+void tiramisu::xfer_prop::remove_attr(tiramisu::xfer_attr attr) {
+    attrs.erase(std::remove(attrs.begin(), attrs.end(), attr), attrs.end());
+}
+
 bool tiramisu::xfer_prop::contains_attr(tiramisu::xfer_attr attr) const {
     return attrs.end() != std::find(attrs.begin(), attrs.end(), attr);
 }
@@ -8363,6 +10379,39 @@ void tiramisu::communicator::add_dim(tiramisu::expr dim)
     this->dims.push_back(dim);
 }
 
+void tiramisu::communicator::set_stride(tiramisu::expr stride, tiramisu::expr block_length)
+{
+    assert(this->get_xfer_props().contains_attr(MPI) && "Strided transfers are only supported with MPI.");
+    this->stride = stride;
+    this->block_length = block_length;
+}
+
+bool tiramisu::communicator::is_strided() const
+{
+    return this->stride.is_defined();
+}
+
+tiramisu::expr tiramisu::communicator::get_stride() const
+{
+    return this->stride;
+}
+
+tiramisu::expr tiramisu::communicator::get_block_length() const
+{
+    return this->block_length;
+}
+
+void tiramisu::communicator::set_channel(tiramisu::expr channel)
+{
+    assert(this->get_xfer_props().contains_attr(MPI) && "Communication channels are only supported with MPI.");
+    this->channel = channel;
+}
+
+tiramisu::expr tiramisu::communicator::get_channel() const
+{
+    return this->channel;
+}
+
 tiramisu::expr tiramisu::communicator::get_num_elements() const
 {
     tiramisu::expr num = expr(1);
@@ -8380,6 +10429,11 @@ xfer_prop tiramisu::communicator::get_xfer_props() const
     return prop;
 }
 
+void tiramisu::communicator::set_xfer_props(xfer_prop prop)
+{
+    this->prop = prop;
+}
+
 std::vector<communicator *> tiramisu::communicator::collapse(int level, tiramisu::expr collapse_from_iter,
                                                              tiramisu::expr collapse_until_iter,
                                                              tiramisu::expr num_collapsed)
@@ -8397,11 +10451,47 @@ std::vector<communicator *> tiramisu::communicator::collapse(int level, tiramisu
     return ret;
 }
 
+/**
+  * Suffix of the MPI runtime functions (see mpi_comm.h) for elements of type \p dtype.
+  */
+static std::string create_mpi_type_suffix(tiramisu::primitive_t dtype)
+{
+    switch (dtype) {
+        case p_uint8:
+            return "_uint8";
+        case p_uint16:
+            return "_uint16";
+        case p_uint32:
+            return "_uint32";
+        case p_uint64:
+            return "_uint64";
+        case p_int8:
+            return "_int8";
+        case p_int16:
+            return "_int16";
+        case p_int32:
+            return "_int32";
+        case p_int64:
+            return "_int64";
+        case p_float32:
+            return "_f32";
+        case p_float64:
+            return "_f64";
+        default:
+            ERROR("Channel type not allowed.", 27);
+            return "";
+    }
+}
+
 std::string create_send_func_name(const xfer_prop chan)
 {
     if (chan.contains_attr(MPI)) {
         std::string name = "tiramisu_MPI";
-        if (chan.contains_attr(SYNC) && chan.contains_attr(BLOCK)) {
+        if (chan.contains_attr(RMA)) {
+            if (chan.contains_attr(NONBLOCK))
+                ERROR("One-sided (RMA) transfers are blocking.", true);
+            name += "_Put";
+        } else if (chan.contains_attr(SYNC) && chan.contains_attr(BLOCK)) {
             name += "_Ssend";
         } else if (chan.contains_attr(SYNC) && chan.contains_attr(NONBLOCK)) {
             name += "_Issend";
@@ -8410,42 +10500,7 @@ std::string create_send_func_name(const xfer_prop chan)
         } else if (chan.contains_attr(ASYNC) && chan.contains_attr(NONBLOCK)) {
             name += "_Isend";
         }
-        switch (chan.get_dtype()) {
-            case p_uint8:
-                name += "_uint8";
-                break;
-            case p_uint16:
-                name += "_uint16";
-                break;
-            case p_uint32:
-                name += "_uint32";
-                break;
-            case p_uint64:
-                name += "_uint64";
-                break;
-            case p_int8:
-                name += "_int8";
-                break;
-            case p_int16:
-                name += "_int16";
-                break;
-            case p_int32:
-                name += "_int32";
-                break;
-            case p_int64:
-                name += "_int64";
-                break;
-            case p_float32:
-                name += "_f32";
-                break;
-            case p_float64:
-                name += "_f64";
-                break;
-            default: {
-                ERROR("Channel not allowed", 27);
-                break;
-            }
-        }
+        name += create_mpi_type_suffix(chan.get_dtype());
         return name;
     } else if (chan.contains_attr(CUDA)) {
         std::string name = "tiramisu_cudad_memcpy";
@@ -8551,45 +10606,16 @@ std::string create_recv_func_name(const xfer_prop chan)
 
     if (chan.contains_attr(MPI)) {
         std::string name = "tiramisu_MPI";
-        if (chan.contains_attr(BLOCK)) {
+        if (chan.contains_attr(RMA)) {
+            if (chan.contains_attr(NONBLOCK))
+                ERROR("One-sided (RMA) transfers are blocking.", true);
+            name += "_Get";
+        } else if (chan.contains_attr(BLOCK)) {
             name += "_Recv";
         } else if (chan.contains_attr(NONBLOCK)) {
             name += "_Irecv";
         }
-        switch (chan.get_dtype()) {
-            case p_uint8:
-                name += "_uint8";
-                break;
-            case p_uint16:
-                name += "_uint16";
-                break;
-            case p_uint32:
-                name += "_uint32";
-                break;
-            case p_uint64:
-                name += "_uint64";
-                break;
-            case p_int8:
-                name += "_int8";
-                break;
-            case p_int16:
-                name += "_int16";
-                break;
-            case p_int32:
-                name += "_int32";
-                break;
-            case p_int64:
-                name += "_int64";
-                break;
-            case p_float32:
-                name += "_f32";
-                break;
-            case p_float64:
-                name += "_f64";
-                break;
-            default:
-                ERROR("Channel type not allowed.", 27);
-        }
+        name += create_mpi_type_suffix(chan.get_dtype());
         return name;
     } else {
         assert(false);
@@ -8737,6 +10763,59 @@ void tiramisu::wait::add_definitions(std::string iteration_domain_str,
     this->updates.push_back(new_c);
 }
 
+tiramisu::collective::collective(std::string iteration_domain_str, std::string collective_name,
+                                 tiramisu::expr rhs, xfer_prop prop, tiramisu::function *fct) :
+        communicator(iteration_domain_str, rhs, true, prop.get_dtype(), prop, fct)
+{
+    assert(prop.contains_attr(MPI) && "Collectives are only supported with MPI.");
+    assert(rhs.get_op_type() == tiramisu::o_access && "The RHS of a collective should be an access!");
+    _is_library_call = true;
+    library_call_name = "tiramisu_MPI_" + collective_name + create_mpi_type_suffix(prop.get_dtype());
+    expr mod_rhs(tiramisu::o_address_of, rhs.get_name(), rhs.get_access(), rhs.get_data_type());
+    set_expression(mod_rhs);
+}
+
+bool tiramisu::collective::is_collective() const
+{
+    return true;
+}
+
+tiramisu::allreduce::allreduce(std::string iteration_domain_str, tiramisu::expr rhs, tiramisu::reduce_op op,
+                               xfer_prop prop, tiramisu::function *fct) :
+        collective(iteration_domain_str, "Allreduce", rhs, prop, fct), op(op) {}
+
+tiramisu::expr tiramisu::allreduce::get_collective_arg() const
+{
+    return tiramisu::expr((int32_t) this->op);
+}
+
+tiramisu::allgather::allgather(std::string iteration_domain_str, tiramisu::expr rhs, xfer_prop prop,
+                               tiramisu::function *fct) :
+        collective(iteration_domain_str, "Allgather", rhs, prop, fct) {}
+
+tiramisu::expr tiramisu::allgather::get_collective_arg() const
+{
+    return tiramisu::expr();
+}
+
+tiramisu::broadcast::broadcast(std::string iteration_domain_str, tiramisu::expr rhs, tiramisu::expr root,
+                               xfer_prop prop, tiramisu::function *fct) :
+        collective(iteration_domain_str, "Bcast", rhs, prop, fct), root(root) {}
+
+tiramisu::expr tiramisu::broadcast::get_collective_arg() const
+{
+    return this->root;
+}
+
+tiramisu::reduce_scatter::reduce_scatter(std::string iteration_domain_str, tiramisu::expr rhs,
+                                         tiramisu::reduce_op op, xfer_prop prop, tiramisu::function *fct) :
+        collective(iteration_domain_str, "Reduce_scatter", rhs, prop, fct), op(op) {}
+
+tiramisu::expr tiramisu::reduce_scatter::get_collective_arg() const
+{
+    return tiramisu::expr((int32_t) this->op);
+}
+
 void tiramisu::computation::full_loop_level_collapse(int level, tiramisu::expr collapse_from_iter)
 {
     std::string collapse_from_iter_repr;
@@ -8834,80 +10913,506 @@ xfer tiramisu::computation::create_xfer(std::string iter_domain_str, xfer_prop p
     return c;
 }
 
-void split_string(std::string str, std::string delimiter, std::vector<std::string> &vector)
+tiramisu::wait *tiramisu::computation::create_wait(tiramisu::communicator *op, const std::vector<int> &request_dims,
+                                                   std::vector<tiramisu::expr> sizes, tiramisu::function *fct)
 {
-    size_t pos = 0;
-    std::string token;
-    while ((pos = str.find(delimiter)) != std::string::npos) {
-        token = str.substr(0, pos);
-        vector.push_back(token);
-        str.erase(0, pos + delimiter.length());
+    isl_set *op_domain = op->get_iteration_domain();
+    int n_dims = isl_set_dim(op_domain, isl_dim_set);
+
+    isl_map *requests_access = isl_map_identity(isl_space_map_from_set(isl_set_get_space(op_domain)));
+    for (int i = n_dims - 1; i >= 0; i--)
+        if (std::find(request_dims.begin(), request_dims.end(), i) == request_dims.end())
+            requests_access = isl_map_project_out(requests_access, isl_dim_out, i, 1);
+    if (sizes.empty())
+    {
+        sizes.push_back(1);
+        requests_access = isl_map_add_dims(requests_access, isl_dim_out, 1);
+        requests_access = isl_map_fix_si(requests_access, isl_dim_out, 0, 0);
     }
-    token = str.substr(0, pos);
-    vector.push_back(token);
-}
+    tiramisu::buffer *requests = new tiramisu::buffer("_" + op->get_name() + "_requests", sizes,
+                                                      p_wait_ptr, a_temporary, fct);
+    requests_access = isl_map_set_tuple_name(requests_access, isl_dim_out, requests->get_name().c_str());
+    op->set_wait_access(requests_access);
 
-isl_map *isl_map_add_free_var(const std::string &free_var_name, isl_map *map, isl_ctx *ctx) {
-    isl_map *final_map = nullptr;
+    std::vector<tiramisu::expr> iterators;
+    for (int i = 0; i < n_dims; i++)
+        iterators.push_back(tiramisu::var(isl_set_get_dim_name(op_domain, isl_dim_set, i)));
+    tiramisu::wait *w = new tiramisu::wait(tiramisu::expr(tiramisu::o_access, op->get_name(), iterators,
+                                                          op->get_data_type()),
+                                           xfer_prop(p_wait_ptr, {MPI}), fct);
 
-    // first, check to see if this variable is actually a free variable. If not, then we don't need to add it.
-    int num_domain_dims = isl_map_dim(map, isl_dim_in);
-    for (int i = 0; i < num_domain_dims; i++) {
-        if (std::strcmp(isl_map_get_dim_name(map, isl_dim_in, i), free_var_name.c_str()) == 0) {
-            return map;
-        }
-    }
-    int num_range_dims = isl_map_dim(map, isl_dim_out);
-    for (int i = 0; i < num_range_dims; i++) {
-        if (std::strcmp(isl_map_get_dim_name(map, isl_dim_out, i), free_var_name.c_str()) == 0) {
-            return map;
-        }
-    }
+    // The wait has the same schedule as the operation it waits on
+    // (including collapsed loop levels).
+    isl_map *wait_sched = isl_map_copy(op->get_schedule());
+    wait_sched = isl_map_set_tuple_name(wait_sched, isl_dim_in, w->get_name().c_str());
+    wait_sched = isl_map_set_tuple_name(wait_sched, isl_dim_out, w->get_name().c_str());
+    w->set_schedule(wait_sched);
 
-    std::string map_str = isl_map_to_str(map);
-    std::vector<std::string> parts;
-    split_string(map_str, "{", parts);
-    if (parts[0] != "") { // A free variable already exists, so add this variable to that box
-        std::vector<std::string> free_parts;
-        split_string(parts[0], "[", free_parts);
-        // remove the right bracket
-        std::vector<std::string> tmp;
-        split_string(free_parts[free_parts.size() - 1], "]", tmp);
-        free_parts.insert(free_parts.end(), tmp[0]);
-        std::string free_vars = "";
-        int ctr = 0;
-        for (auto s: free_parts) {
-            if (s == free_var_name) {
-                // The variable name was already in the box, so we don't actually need to do anything
-                return map;
-            }
-            free_vars += ctr++ == 0 ? s : "," + s;
-        }
-        free_vars += "," + free_var_name;
-        free_vars = "[" + free_vars + "]" + "{" + parts[1];
-        final_map = isl_map_read_from_str(ctx, free_vars.c_str());
-    } else {
-        std::string m = "[" + free_var_name + "]->{" + parts[1];
-        final_map = isl_map_read_from_str(ctx, m.c_str());
-    }
-    assert(final_map && "Adding free param to map resulted in a null isl_map");
-    return final_map;
-}
+    std::vector<int> distributed_levels;
+    for (const auto &d : fct->distributed_dimensions)
+        if (d.first == op->get_name())
+            distributed_levels.push_back(d.second);
+    for (int d : distributed_levels)
+        w->tag_distribute_level(d);
 
+    return w;
+}
 
-expr tiramisu::computation::get_span(int level)
+void tiramisu::computation::overlap_communication(std::vector<tiramisu::xfer> exchanges, tiramisu::var L,
+                                                  tiramisu::var dim, int halo)
 {
-    this->check_dimensions_validity({level});
-    tiramisu::expr loop_upper_bound =
-            tiramisu::utility::get_bound(this->get_trimmed_time_processor_domain(),
-                                         level, true);
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
 
-    tiramisu::expr loop_lower_bound =
-            tiramisu::utility::get_bound(this->get_trimmed_time_processor_domain(),
-                                         level, false);
+    assert(L.get_name().length() > 0);
+    assert(dim.get_name().length() > 0);
+    assert(halo > 0);
 
-    tiramisu::expr loop_bound = loop_upper_bound - loop_lower_bound + value_cast(global::get_loop_iterator_data_type(), 1);
-    return loop_bound.simplify();
+    tiramisu::function *fct = this->get_function();
+    std::vector<int> dimensions = this->get_loop_level_numbers_from_dimension_names({L.get_name()});
+    this->check_dimensions_validity(dimensions);
+    int level = dimensions[0];
+
+    int dim_pos = isl_set_find_dim_by_name(this->get_iteration_domain(), isl_dim_set, dim.get_name().c_str());
+    if (dim_pos < 0)
+        ERROR("The dimension " + dim.get_name() + " is not a dimension of the iteration domain of " +
+              this->get_name() + ".", true);
+
+    DEBUG(3, tiramisu::str_dump("Overlapping the communication of " + this->get_name() +
+                                " at level " + L.get_name() + " (halo of " + std::to_string(halo) +
+                                " along " + dim.get_name() + ")"));
+
+    // The interior is the set of iterations whose neighbours at a distance of
+    // halo along dim are computed by the same rank.
+    isl_map *sched = isl_map_intersect_domain(isl_map_copy(this->get_schedule()),
+                                              isl_set_copy(this->get_iteration_domain()));
+    isl_set *range = isl_map_range(isl_map_copy(sched));
+    isl_set *interior = isl_set_copy(range);
+    for (int shift : {-halo, halo})
+    {
+        isl_multi_aff *ma = isl_multi_aff_identity(isl_space_map_from_set(isl_set_get_space(this->get_iteration_domain())));
+        isl_aff *a = isl_multi_aff_get_aff(ma, dim_pos);
+        ma = isl_multi_aff_set_aff(ma, dim_pos, isl_aff_add_constant_si(a, shift));
+
+        // {time-space point -> time-space point of its neighbour}
+        isl_map *neighbour = isl_map_apply_range(isl_map_apply_range(isl_map_reverse(isl_map_copy(sched)),
+                                                                     isl_map_from_multi_aff(ma)),
+                                                 isl_map_copy(sched));
+        for (const auto &d : fct->distributed_dimensions)
+            if (d.first == this->get_name())
+            {
+                int pos = loop_level_into_dynamic_dimension(d.second);
+                neighbour = isl_map_equate(neighbour, isl_dim_in, pos, isl_dim_out, pos);
+            }
+        interior = isl_set_intersect(interior, isl_map_domain(neighbour));
+    }
+    isl_map_free(sched);
+
+    isl_set *boundary = isl_set_subtract(range, isl_set_copy(interior));
+
+    // The ordering of the computations is only set during code generation, so do
+    // not constrain the static dimensions (except the duplicate dimension).
+    for (int i = 1; i < isl_set_dim(interior, isl_dim_set); i += 2)
+    {
+        interior = isl_set_drop_constraints_involving_dims(interior, isl_dim_set, i, 1);
+        boundary = isl_set_drop_constraints_involving_dims(boundary, isl_dim_set, i, 1);
+    }
+    DEBUG(3, tiramisu::str_dump("Interior: ", isl_set_to_str(interior)));
+    DEBUG(3, tiramisu::str_dump("Boundary: ", isl_set_to_str(boundary)));
+
+    if (isl_set_is_empty(boundary) == isl_bool_true)
+    {
+        DEBUG(3, tiramisu::str_dump("The boundary is empty, there is nothing to overlap."));
+        isl_set_free(interior);
+        isl_set_free(boundary);
+        DEBUG_INDENT(-4);
+        return;
+    }
+
+    // Create the boundary computation (a new definition of this computation,
+    // like in separate()) and restrict this computation to the interior.
+    std::string domain_str = std::string(isl_set_to_str(this->get_iteration_domain()));
+    this->add_definitions(domain_str,
+                          this->get_expr(),
+                          this->should_schedule_this_computation(),
+                          this->get_data_type(),
+                          fct);
+    tiramisu::computation &boundary_comp = this->get_last_update();
+    boundary_comp.set_schedule(isl_map_intersect_range(isl_map_copy(this->get_schedule()), boundary));
+    if (this->get_access_relation() != NULL)
+        boundary_comp.set_access(isl_map_copy(this->get_access_relation()));
+    boundary_comp._drop_rank_iter = this->_drop_rank_iter;
+    boundary_comp.drop_level = this->drop_level;
+    this->set_schedule(isl_map_intersect_range(this->get_schedule(), interior));
+
+    // Insert the waits then the boundary after the interior at level L.
+    tiramisu::computation *succ = this->get_successor();
+    int succ_level = (succ != nullptr) ? fct->sched_graph[this][succ] : computation::root_dimension;
+    tiramisu::computation *prev = this;
+    auto append = [&](tiramisu::computation *c) {
+        if (succ != nullptr)
+            c->between(*prev, level, *succ, succ_level);
+        else
+            c->after(*prev, level);
+        prev = c;
+    };
+
+    for (const tiramisu::xfer &exchange : exchanges)
+    {
+        assert(exchange.sr == nullptr && "Only exchanges with a separate send and receive can be overlapped.");
+        for (tiramisu::communicator *op : {(tiramisu::communicator *) exchange.s, (tiramisu::communicator *) exchange.r})
+        {
+            xfer_prop prop = op->get_xfer_props();
+            assert(prop.contains_attr(MPI) && "Only MPI communication can be overlapped.");
+            prop.remove_attr(BLOCK);
+            if (!prop.contains_attr(NONBLOCK))
+                prop.add_attr(NONBLOCK);
+            op->set_xfer_props(prop);
+
+            // One request per message sent or received during an iteration of L
+            // (the requests are waited on in the same iteration).
+            isl_set *op_domain = op->get_iteration_domain();
+            int n_dims = isl_set_dim(op_domain, isl_dim_set);
+            int outer = op->get_loop_level_numbers_from_dimension_names({L.get_name()})[0] + 1;
+            std::vector<int> request_dims;
+            std::vector<tiramisu::expr> sizes;
+            for (int i = outer; i < n_dims; i++)
+            {
+                request_dims.push_back(i);
+                sizes.push_back(utility::get_bound(isl_set_copy(op_domain), i, true) + 1);
+            }
+            tiramisu::wait *w = create_wait(op, request_dims, sizes, fct);
+
+            append(w);
+        }
+    }
+
+    append(&boundary_comp);
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::separate_borders(tiramisu::var L)
+{
+    assert(L.get_name().length() > 0);
+
+    std::vector<int> dimensions = this->get_loop_level_numbers_from_dimension_names({L.get_name()});
+    this->check_dimensions_validity(dimensions);
+
+    this->separate_borders(dimensions[0]);
+}
+
+void tiramisu::computation::separate_borders(int L)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    tiramisu::function *fct = this->get_function();
+    this->gen_time_space_domain();
+
+    // The interior is the set of iterations where all the accesses to the
+    // inputs that have a boundary condition are inside the inputs.
+    std::vector<isl_map *> accesses;
+    generator::get_rhs_accesses(fct, this, accesses, false);
+
+    isl_set *interior_domain = isl_set_copy(this->get_iteration_domain());
+    bool reads_boundary_input = false;
+    for (isl_map *access : accesses)
+    {
+        if (isl_map_has_tuple_name(access, isl_dim_out) == isl_bool_true &&
+            fct->boundary_conditions.count(isl_map_get_tuple_name(access, isl_dim_out)) != 0)
+        {
+            tiramisu::computation *in = fct->get_computation_by_name(isl_map_get_tuple_name(access, isl_dim_out))[0];
+            access = isl_map_intersect_range(access, isl_set_copy(in->get_iteration_domain()));
+            interior_domain = isl_set_intersect(interior_domain, isl_map_domain(access));
+            reads_boundary_input = true;
+        }
+        else
+            isl_map_free(access);
+    }
+
+    if (!reads_boundary_input)
+    {
+        DEBUG(3, tiramisu::str_dump(this->get_name() + " does not read an input that has a boundary condition."));
+        isl_set_free(interior_domain);
+        DEBUG_INDENT(-4);
+        return;
+    }
+
+    isl_map *sched = isl_map_intersect_domain(isl_map_copy(this->get_schedule()),
+                                              isl_set_copy(this->get_iteration_domain()));
+    isl_set *range = isl_map_range(isl_map_copy(sched));
+    isl_set *interior = isl_set_apply(interior_domain, sched);
+    isl_set *border = isl_set_subtract(range, isl_set_copy(interior));
+
+    // Like in overlap_communication(), do not constrain the static dimensions.
+    for (int i = 1; i < isl_set_dim(interior, isl_dim_set); i += 2)
+    {
+        interior = isl_set_drop_constraints_involving_dims(interior, isl_dim_set, i, 1);
+        border = isl_set_drop_constraints_involving_dims(border, isl_dim_set, i, 1);
+    }
+    DEBUG(3, tiramisu::str_dump("Interior: ", isl_set_to_str(interior)));
+    DEBUG(3, tiramisu::str_dump("Border: ", isl_set_to_str(border)));
+
+    if (isl_set_is_empty(border) == isl_bool_true || isl_set_is_empty(interior) == isl_bool_true)
+    {
+        DEBUG(3, tiramisu::str_dump("The interior or the border is empty, the computation is not split."));
+        this->accesses_in_bounds = (isl_set_is_empty(border) == isl_bool_true);
+        isl_set_free(interior);
+        isl_set_free(border);
+        DEBUG_INDENT(-4);
+        return;
+    }
+
+    // The border is a new definition of this computation, the boundary
+    // conditions are only applied to it.
+    std::string domain_str = std::string(isl_set_to_str(this->get_iteration_domain()));
+    this->add_definitions(domain_str,
+                          this->get_expr(),
+                          this->should_schedule_this_computation(),
+                          this->get_data_type(),
+                          fct);
+    tiramisu::computation &border_comp = this->get_last_update();
+    border_comp.set_schedule(isl_map_intersect_range(isl_map_copy(this->get_schedule()), border));
+    if (this->get_access_relation() != NULL)
+        border_comp.set_access(isl_map_copy(this->get_access_relation()));
+    this->set_schedule(isl_map_intersect_range(this->get_schedule(), interior));
+    this->accesses_in_bounds = true;
+
+    tiramisu::computation *succ = this->get_successor();
+    if (succ != nullptr)
+        border_comp.between(*this, L, *succ, fct->sched_graph[this][succ]);
+    else
+        border_comp.after(*this, L);
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::input::set_boundary_condition(tiramisu::boundary_t type, tiramisu::expr value)
+{
+    assert((type != tiramisu::boundary_constant || value.is_defined()) &&
+           "A constant boundary condition needs a value.");
+
+    this->get_function()->boundary_conditions[this->get_name()] = {type, value};
+}
+
+tiramisu::view::view(std::string name, std::vector<tiramisu::var> iterator_variables, tiramisu::buffer &b,
+                     std::vector<tiramisu::expr> buffer_indices)
+    : computation(name, iterator_variables, expr(), false, b.get_elements_type())
+{
+    this->store_in(&b, buffer_indices);
+}
+
+/**
+ * Declare a view of \p b whose dimensions have the sizes \p sizes, and whose
+ * element (i0, i1, ...) is the element of \p b given by \p buffer_indices
+ * from the names of i0, i1, ...
+ */
+static tiramisu::view *new_view_of_buffer(std::string name, tiramisu::buffer &b, std::vector<tiramisu::expr> sizes,
+                                          std::function<std::vector<std::string>(const std::vector<std::string> &)> buffer_indices)
+{
+    std::vector<tiramisu::var> iterators;
+    std::vector<std::string> names;
+    for (auto &size : sizes)
+    {
+        iterators.push_back(tiramisu::var(tiramisu::generate_new_computation_name(), 0, size));
+        names.push_back(iterators.back().get_name());
+    }
+
+    tiramisu::view *v = new tiramisu::view(name, iterators, b.get_elements_type());
+
+    std::string map_str = "[" + utility::get_parameters_list(v->get_iteration_domain()) + "] -> ";
+    map_str += "{" + name + "[";
+    for (size_t d = 0; d < names.size(); d++)
+        map_str += (d == 0 ? "" : ", ") + names[d];
+    map_str += "] -> " + b.get_name() + "[";
+    std::vector<std::string> indices = buffer_indices(names);
+    for (size_t d = 0; d < indices.size(); d++)
+        map_str += (d == 0 ? "" : ", ") + indices[d];
+    map_str += "]}";
+
+    DEBUG(3, tiramisu::str_dump("View " + name + " of " + b.get_name() + ": " + map_str));
+
+    v->set_access(map_str);
+    return v;
+}
+
+/**
+ * The indices of the element of \p b whose linear index (in row-major order)
+ * is \p linear, along the dimensions \p first_dim to the last of \p b.
+ */
+static std::vector<std::string> delinearize(tiramisu::buffer &b, int first_dim, std::string linear)
+{
+    std::vector<std::string> indices(b.get_n_dims() - first_dim);
+    int64_t stride = 1;
+    for (int d = b.get_n_dims() - 1; d >= first_dim; d--)
+    {
+        int64_t size = b.get_dim_sizes()[d].get_int_val();
+        std::string index = "floor((" + linear + ")/" + std::to_string(stride) + ")";
+        indices[d - first_dim] = (d == first_dim) ? index : "(" + index + ") mod " + std::to_string(size);
+        stride *= size;
+    }
+    return indices;
+}
+
+static bool has_constant_dims(tiramisu::buffer &b, int first_dim)
+{
+    for (int d = first_dim; d < b.get_n_dims(); d++)
+        if (b.get_dim_sizes()[d].get_expr_type() != tiramisu::e_val)
+            return false;
+    return true;
+}
+
+tiramisu::view *tiramisu::view::reshape(std::string name, tiramisu::buffer &b, std::vector<int> sizes)
+{
+    if (!has_constant_dims(b, 0))
+        ERROR("The buffer " + b.get_name() + " of the reshape " + name + " must have constant extents.", true);
+
+    int64_t nb_elements = 1, nb_buffer_elements = 1;
+    for (int size : sizes)
+        nb_elements *= size;
+    for (auto &size : b.get_dim_sizes())
+        nb_buffer_elements *= size.get_int_val();
+    if (nb_elements != nb_buffer_elements)
+        ERROR("The reshape " + name + " and its buffer " + b.get_name() + " do not have the same number of elements.", true);
+
+    std::vector<tiramisu::expr> view_sizes;
+    for (int size : sizes)
+        view_sizes.push_back(tiramisu::expr(size));
+
+    return new_view_of_buffer(name, b, view_sizes, [&](const std::vector<std::string> &names) {
+        // The row-major linear index of the element of the view
+        std::string linear = "0";
+        for (size_t d = 0; d < names.size(); d++)
+            linear = "(" + linear + ")*" + std::to_string(sizes[d]) + " + " + names[d];
+        return delinearize(b, 0, linear);
+    });
+}
+
+tiramisu::view *tiramisu::view::flatten(std::string name, tiramisu::buffer &b, int first_dim)
+{
+    assert(first_dim >= 0 && first_dim < b.get_n_dims());
+
+    if (!has_constant_dims(b, first_dim))
+        ERROR("The flattened dimensions of the buffer " + b.get_name() + " of " + name + " must have constant extents.", true);
+
+    std::vector<tiramisu::expr> sizes(b.get_dim_sizes().begin(), b.get_dim_sizes().begin() + first_dim);
+    int64_t flattened = 1;
+    for (int d = first_dim; d < b.get_n_dims(); d++)
+        flattened *= b.get_dim_sizes()[d].get_int_val();
+    sizes.push_back(tiramisu::expr((int32_t) flattened));
+
+    return new_view_of_buffer(name, b, sizes, [&](const std::vector<std::string> &names) {
+        std::vector<std::string> indices(names.begin(), names.begin() + first_dim);
+        std::vector<std::string> flattened_indices = delinearize(b, first_dim, names.back());
+        indices.insert(indices.end(), flattened_indices.begin(), flattened_indices.end());
+        return indices;
+    });
+}
+
+tiramisu::view *tiramisu::view::slice(std::string name, tiramisu::buffer &b, std::vector<tiramisu::expr> offsets,
+                                      std::vector<tiramisu::expr> sizes)
+{
+    assert(offsets.size() == b.get_n_dims() && sizes.size() == b.get_n_dims());
+
+    return new_view_of_buffer(name, b, sizes, [&](const std::vector<std::string> &names) {
+        std::vector<std::string> indices;
+        for (size_t d = 0; d < names.size(); d++)
+            indices.push_back(names[d] + " + (" + offsets[d].to_str() + ")");
+        return indices;
+    });
+}
+
+tiramisu::view *tiramisu::view::transpose(std::string name, tiramisu::buffer &b, std::vector<int> permutation)
+{
+    assert(permutation.size() == b.get_n_dims());
+
+    std::vector<tiramisu::expr> sizes;
+    for (int d : permutation)
+        sizes.push_back(b.get_dim_sizes()[d]);
+
+    return new_view_of_buffer(name, b, sizes, [&](const std::vector<std::string> &names) {
+        std::vector<std::string> indices(names.size());
+        for (size_t d = 0; d < names.size(); d++)
+            indices[permutation[d]] = names[d];
+        return indices;
+    });
+}
+
+void split_string(std::string str, std::string delimiter, std::vector<std::string> &vector)
+{
+    size_t pos = 0;
+    std::string token;
+    while ((pos = str.find(delimiter)) != std::string::npos) {
+        token = str.substr(0, pos);
+        vector.push_back(token);
+        str.erase(0, pos + delimiter.length());
+    }
+    token = str.substr(0, pos);
+    vector.push_back(token);
+}
+
+isl_map *isl_map_add_free_var(const std::string &free_var_name, isl_map *map, isl_ctx *ctx) {
+    isl_map *final_map = nullptr;
+
+    // first, check to see if this variable is actually a free variable. If not, then we don't need to add it.
+    int num_domain_dims = isl_map_dim(map, isl_dim_in);
+    for (int i = 0; i < num_domain_dims; i++) {
+        if (std::strcmp(isl_map_get_dim_name(map, isl_dim_in, i), free_var_name.c_str()) == 0) {
+            return map;
+        }
+    }
+    int num_range_dims = isl_map_dim(map, isl_dim_out);
+    for (int i = 0; i < num_range_dims; i++) {
+        if (std::strcmp(isl_map_get_dim_name(map, isl_dim_out, i), free_var_name.c_str()) == 0) {
+            return map;
+        }
+    }
+
+    std::string map_str = isl_map_to_str(map);
+    std::vector<std::string> parts;
+    split_string(map_str, "{", parts);
+    if (parts[0] != "") { // A free variable already exists, so add this variable to that box
+        std::vector<std::string> free_parts;
+        split_string(parts[0], "[", free_parts);
+        // remove the right bracket
+        std::vector<std::string> tmp;
+        split_string(free_parts[free_parts.size() - 1], "]", tmp);
+        free_parts.insert(free_parts.end(), tmp[0]);
+        std::string free_vars = "";
+        int ctr = 0;
+        for (auto s: free_parts) {
+            if (s == free_var_name) {
+                // The variable name was already in the box, so we don't actually need to do anything
+                return map;
+            }
+            free_vars += ctr++ == 0 ? s : "," + s;
+        }
+        free_vars += "," + free_var_name;
+        free_vars = "[" + free_vars + "]" + "{" + parts[1];
+        final_map = isl_map_read_from_str(ctx, free_vars.c_str());
+    } else {
+        std::string m = "[" + free_var_name + "]->{" + parts[1];
+        final_map = isl_map_read_from_str(ctx, m.c_str());
+    }
+    assert(final_map && "Adding free param to map resulted in a null isl_map");
+    return final_map;
+}
+
+
+expr tiramisu::computation::get_span(int level)
+{
+    this->check_dimensions_validity({level});
+    tiramisu::expr loop_upper_bound =
+            tiramisu::utility::get_bound(this->get_trimmed_time_processor_domain(),
+                                         level, true);
+
+    tiramisu::expr loop_lower_bound =
+            tiramisu::utility::get_bound(this->get_trimmed_time_processor_domain(),
+                                         level, false);
+
+    tiramisu::expr loop_bound = loop_upper_bound - loop_lower_bound + value_cast(global::get_loop_iterator_data_type(), 1);
+    return loop_bound.simplify();
 }
 
 void tiramisu::buffer::tag_gpu_shared() {
@@ -8919,6 +11424,10 @@ void tiramisu::buffer::tag_gpu_constant() {
     location = cuda_ast::memory_location::constant;
 }
 
+void tiramisu::buffer::tag_gpu_read_only() {
+    gpu_read_only = true;
+}
+
 void tiramisu::buffer::tag_gpu_global() {
     location = cuda_ast::memory_location::global;
 }
@@ -8976,64 +11485,623 @@ std::vector<std::string> computation::get_trimmed_time_space_domain_dimension_na
     return dimensions_names;
 }
 
-int computation::get_distributed_dimension()
+/**
+  * Get in \p value the value of \p pa if it is an integer constant (consumes \p pa).
+  */
+static bool get_constant_value(isl_pw_aff *pa, int64_t &value)
+{
+    struct piece_data
+    {
+        bool ok;
+        bool found;
+        int64_t value;
+    } data = {true, false, 0};
+
+    isl_pw_aff_foreach_piece(pa, [](isl_set *set, isl_aff *aff, void *user) -> isl_stat {
+        piece_data *d = (piece_data *) user;
+        isl_val *v = isl_aff_get_constant_val(aff);
+        if (isl_aff_is_cst(aff) != isl_bool_true || isl_val_is_int(v) != isl_bool_true ||
+            (d->found && isl_val_get_num_si(v) != d->value))
+            d->ok = false;
+        d->found = true;
+        d->value = isl_val_get_num_si(v);
+        isl_val_free(v);
+        isl_set_free(set);
+        isl_aff_free(aff);
+        return isl_stat_ok;
+    }, &data);
+    isl_pw_aff_free(pa);
+
+    value = data.value;
+    return data.ok && data.found;
+}
+
+/**
+  * Return true if, for each value of its \p first outermost dimensions, \p set is a box
+  * of constant bounds along its other dimensions, and get these bounds in \p lower and \p upper.
+  */
+static bool get_constant_box(isl_set *set, int first, std::vector<int64_t> &lower, std::vector<int64_t> &upper)
 {
-    this->gen_time_space_domain();
+    int n = isl_set_dim(set, isl_dim_set);
+    isl_set *inner = isl_set_move_dims(isl_set_copy(set), isl_dim_param, isl_set_dim(set, isl_dim_param),
+                                       isl_dim_set, 0, first);
+    isl_set *box = isl_set_universe(isl_set_get_space(inner));
 
-    int number_of_dimensions = isl_set_dim(this->get_trimmed_time_processor_domain(), isl_dim_set);
+    for (int k = 0; k < n - first; k++)
+    {
+        int64_t lo, hi;
+        if (!get_constant_value(isl_set_dim_min(isl_set_copy(inner), k), lo) ||
+            !get_constant_value(isl_set_dim_max(isl_set_copy(inner), k), hi))
+        {
+            isl_set_free(inner);
+            isl_set_free(box);
+            return false;
+        }
+        lower.push_back(lo);
+        upper.push_back(hi);
+        box = isl_set_lower_bound_si(box, isl_dim_set, k, lo);
+        box = isl_set_upper_bound_si(box, isl_dim_set, k, hi);
+    }
+    box = isl_set_intersect_params(box, isl_set_params(isl_set_copy(inner)));
 
-    int distributed_dimension = 0;
+    bool is_box = (isl_set_is_equal(inner, box) == isl_bool_true);
+    isl_set_free(inner);
+    isl_set_free(box);
 
-    while (distributed_dimension < number_of_dimensions and
-         !this->get_function()->should_distribute(this->get_name(), distributed_dimension))
-        distributed_dimension++;
+    return is_box;
+}
 
-    if (distributed_dimension < number_of_dimensions)
-        return distributed_dimension;
-    else
-        return -1;//no distributed dimension
+void tiramisu::computation::collapse(tiramisu::var L0_var, tiramisu::var L1_var)
+{
+    this->collapse(L0_var, L1_var, L0_var);
 }
 
-isl_map* computation::construct_distribution_map(tiramisu::rank_t rank_type)
+void tiramisu::computation::collapse(tiramisu::var L0_var, tiramisu::var L1_var, tiramisu::var L_var)
 {
-    DEBUG_FCT_NAME(10);
+    DEBUG_FCT_NAME(3);
     DEBUG_INDENT(4);
 
-    std::vector<std::string> dimensions_names = this->get_trimmed_time_space_domain_dimension_names();
+    assert(L0_var.get_name().length() > 0);
+    assert(L1_var.get_name().length() > 0);
+    std::vector<int> dimensions =
+        this->get_loop_level_numbers_from_dimension_names({L0_var.get_name(), L1_var.get_name()});
+    this->check_dimensions_validity(dimensions);
+    int L0 = dimensions[0];
+    if (dimensions[1] != L0 + 1)
+        ERROR("The loop levels " + L0_var.get_name() + " and " + L1_var.get_name() +
+              " of " + this->get_name() + " cannot be collapsed: they are not consecutive.", true);
+    if (L_var.get_name() != L0_var.get_name())
+        this->assert_names_not_assigned({L_var.get_name()});
 
-    int distributed_dimension = this->get_distributed_dimension();
+    this->get_function()->align_schedules();
 
-    if (distributed_dimension == -1)
-        ERROR("Computation " + this->get_name() + "isn't tagged distributed and used gen_communication().",true);
+    int dim0 = loop_level_into_dynamic_dimension(L0);
+    int dim1 = loop_level_into_dynamic_dimension(L0 + 1);
+
+    // The bounds of L1, which must not depend on the outer levels
+    isl_set *time = isl_set_apply(isl_set_copy(this->get_iteration_domain()), isl_map_copy(this->get_schedule()));
+    int n = isl_set_dim(time, isl_dim_set);
+    time = isl_set_project_out(time, isl_dim_set, dim1 + 1, n - dim1 - 1);
+    std::vector<int64_t> lower, upper;
+    bool constant = get_constant_box(time, dim1, lower, upper);
+    isl_set_free(time);
+    if (!constant)
+        ERROR("The loop levels " + L0_var.get_name() + " and " + L1_var.get_name() +
+              " of " + this->get_name() + " cannot be collapsed: the extent of " + L1_var.get_name() +
+              " is not a constant.", true);
+    int64_t extent = upper[0] - lower[0] + 1;
+
+    DEBUG(3, tiramisu::str_dump("Collapsing the loop levels " + std::to_string(L0) + " and " +
+                                std::to_string(L0 + 1) + ", the extent of the inner level is " +
+                                std::to_string(extent)));
+
+    // L = L0 * extent + (L1 - lower), and L1 = 0
+    isl_space *space = isl_space_map_from_set(isl_space_range(isl_map_get_space(this->get_schedule())));
+    isl_map *transform = isl_map_universe(isl_space_copy(space));
+    isl_local_space *ls = isl_local_space_from_space(space);
+    for (int k = 0; k < n; k++)
+    {
+        isl_constraint *cst = isl_constraint_alloc_equality(isl_local_space_copy(ls));
+        if (k == dim0)
+        {
+            cst = isl_constraint_set_coefficient_si(cst, isl_dim_in, dim0, extent);
+            cst = isl_constraint_set_coefficient_si(cst, isl_dim_in, dim1, 1);
+            cst = isl_constraint_set_constant_si(cst, -lower[0]);
+        }
+        else if (k != dim1)
+            cst = isl_constraint_set_coefficient_si(cst, isl_dim_in, k, 1);
+        cst = isl_constraint_set_coefficient_si(cst, isl_dim_out, k, -1);
+        transform = isl_map_add_constraint(transform, cst);
+    }
+    isl_local_space_free(ls);
+
+    this->set_schedule(isl_map_apply_range(isl_map_copy(this->get_schedule()), transform));
+    DEBUG(3, tiramisu::str_dump("Schedule after collapsing: ", isl_map_to_str(this->get_schedule())));
+
+    if (L_var.get_name() != L0_var.get_name())
+        this->set_loop_level_names({L0}, {L_var.get_name()});
 
-    if(distributed_dimension > 0)
-        ERROR("Generating communication code automatically for inner distributed loops is currently not supported.",true);
+    DEBUG_INDENT(-4);
+}
 
-    //get the extent of the distributed loop, the number od available ranks should be equal to it
-    this->simplify(this->get_iteration_domain());
-    isl_set * it_dom = this->get_trimmed_time_processor_domain();
-    project_out_static_dimensions(it_dom);
-    int number_of_ranks = tiramisu::utility::get_extent(it_dom, distributed_dimension);
+/**
+  * Return the first iteration of the chunk of each of the \p nb_ranks ranks, followed by
+  * the end of the loop, so that the chunks of the iterations of costs \p costs (the first
+  * iteration being \p lower) have the same cost.
+  */
+static std::vector<int64_t> balanced_bounds(int64_t lower, const std::vector<double> &costs, int nb_ranks)
+{
+    double total = 0;
+    for (double c : costs)
+        total += c;
 
-    std::string dimensions_string = "";
-    for (int i = 0; i < dimensions_names.size(); i++)
+    std::vector<int64_t> bounds = {lower};
+    double prefix = 0;
+    int64_t i = 0;
+    for (int r = 1; r < nb_ranks; r++)
     {
-        dimensions_string += dimensions_names[i];
-        if (i < dimensions_names.size()-1)
-            dimensions_string += ",";
+        double target = total * r / nb_ranks;
+        // Stop at the iteration that brings the chunk closest to its share.
+        while (i < (int64_t) costs.size() && prefix + costs[i] / 2 < target)
+            prefix += costs[i++];
+        bounds.push_back(lower + i);
     }
-    //TODO : this won't give a correct result if distributed_stride%number_of_nodes!=0
-    //should be corrected
-    std::string rank_name = get_rank_string_type(rank_type);
-    std::string params = "[" + rank_name + "]";
-    std::string ranks_definition = "0<=" + rank_name + "<" + std::to_string(number_of_ranks);
+    bounds.push_back(lower + costs.size());
 
-    std::string domain = this->get_name() + "[" + dimensions_string + "]";
+    return bounds;
+}
+
+void tiramisu::computation::get_iteration_costs(int L, int64_t &lower, int64_t &upper, std::vector<double> &costs,
+                                                bool estimate)
+{
+    int dim = loop_level_into_dynamic_dimension(L);
+    isl_set *time = isl_set_apply(isl_set_copy(this->get_iteration_domain()), isl_map_copy(this->get_schedule()));
+    int n = isl_set_dim(time, isl_dim_set);
+
+    isl_set *level = isl_set_project_out(isl_set_copy(time), isl_dim_set, dim + 1, n - dim - 1);
+    level = isl_set_project_out(level, isl_dim_set, 0, dim);
+    bool constant = get_constant_value(isl_set_dim_min(isl_set_copy(level), 0), lower) &&
+                    get_constant_value(isl_set_dim_max(level, 0), upper);
+    if (!constant)
+    {
+        isl_set_free(time);
+        ERROR("The loop level " + std::to_string(L) + " of " + this->get_name() +
+              " cannot be distributed: its bounds are not constant.", true);
+    }
+
+    costs.assign(upper - lower + 1, 1.0);
+    for (int64_t i = lower; i <= upper && estimate; i++)
+    {
+        isl_set *slice = isl_set_fix_si(isl_set_copy(time), isl_dim_set, dim, i);
+        double cost = 1;
+        for (int k = 0; k < n && cost > 0; k++)
+        {
+            int64_t lo, hi;
+            if (isl_set_is_empty(slice) == isl_bool_true)
+                cost = 0;
+            else if (get_constant_value(isl_set_dim_min(isl_set_copy(slice), k), lo) &&
+                     get_constant_value(isl_set_dim_max(isl_set_copy(slice), k), hi))
+                cost *= hi - lo + 1;
+        }
+        isl_set_free(slice);
+        costs[i - lower] = cost;
+    }
+    isl_set_free(time);
+}
+
+void tiramisu::computation::distribute(tiramisu::var L_var, int nb_ranks, tiramisu::distribution_t distribution,
+                                       tiramisu::var L_rank, tiramisu::var L_local, int block_size)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L_var.get_name().length() > 0);
+    assert(nb_ranks >= 1);
+    assert(block_size >= 1);
+    std::vector<int> dimensions = this->get_loop_level_numbers_from_dimension_names({L_var.get_name()});
+    this->check_dimensions_validity(dimensions);
+    int L = dimensions[0];
+    this->assert_names_not_assigned({L_rank.get_name(), L_local.get_name()});
+
+    this->get_function()->align_schedules();
+
+    std::vector<int64_t> bounds;
+    if (distribution == tiramisu::distribution_block || distribution == tiramisu::distribution_weighted)
+    {
+        int64_t lower, upper;
+        std::vector<double> costs;
+        this->get_iteration_costs(L, lower, upper, costs, distribution == tiramisu::distribution_weighted);
+        bounds = balanced_bounds(lower, costs, nb_ranks);
+    }
+    else if (distribution == tiramisu::distribution_cyclic)
+        block_size = 1;
+
+    this->distribute(L, nb_ranks, bounds, block_size, {L_rank.get_name(), L_local.get_name()});
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::distribute(tiramisu::var L_var, int nb_ranks, std::function<double(int64_t)> weight,
+                                       tiramisu::var L_rank, tiramisu::var L_local)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(L_var.get_name().length() > 0);
+    assert(nb_ranks >= 1);
+    std::vector<int> dimensions = this->get_loop_level_numbers_from_dimension_names({L_var.get_name()});
+    this->check_dimensions_validity(dimensions);
+    int L = dimensions[0];
+    this->assert_names_not_assigned({L_rank.get_name(), L_local.get_name()});
+
+    this->get_function()->align_schedules();
+
+    int64_t lower, upper;
+    std::vector<double> costs;
+    this->get_iteration_costs(L, lower, upper, costs, false);
+    for (int64_t i = lower; i <= upper; i++)
+    {
+        costs[i - lower] = weight(i);
+        if (costs[i - lower] < 0)
+            ERROR("The weight of the iteration " + std::to_string(i) + " of " + L_var.get_name() +
+                  " is negative.", true);
+    }
+
+    this->distribute(L, nb_ranks, balanced_bounds(lower, costs, nb_ranks), 1,
+                     {L_rank.get_name(), L_local.get_name()});
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::computation::distribute(int L, int nb_ranks, const std::vector<int64_t> &bounds, int block_size,
+                                       std::vector<std::string> names)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    std::vector<std::string> original_loop_level_names = this->get_loop_level_names();
+
+    // The loop level L becomes the outer level of a split by 1 (whose inner level is 0),
+    // then the outer level becomes the rank and the inner level the local iterations.
+    this->split(L, 1);
+    this->update_names(original_loop_level_names, names, L, 1);
+
+    int dim_rank = loop_level_into_dynamic_dimension(L);
+    int dim_local = loop_level_into_dynamic_dimension(L + 1);
+    isl_map *schedule = this->get_schedule();
+    int n = isl_map_dim(schedule, isl_dim_out);
+
+    std::string in = "", out = "";
+    for (int k = 0; k < n; k++)
+    {
+        std::string sep = (k == 0) ? "" : ",";
+        in += sep + "c" + std::to_string(k);
+        out += sep + ((k == dim_rank) ? "r" : (k == dim_local) ? "j" : "c" + std::to_string(k));
+    }
+    std::string i = "c" + std::to_string(dim_rank);
+
+    std::string placement;
+    if (!bounds.empty())
+    {
+        for (int r = 0; r < nb_ranks; r++)
+            if (bounds[r] < bounds[r + 1])
+                placement += std::string(placement.empty() ? "" : " or ") + "(r = " + std::to_string(r) +
+                             " and " + std::to_string(bounds[r]) + " <= " + i + " < " + std::to_string(bounds[r + 1]) + ")";
+        placement = "j = " + i + " and (" + placement + ")";
+    }
+    else
+    {
+        // i = (k * nb_ranks + r) * block_size + q, and the local iteration is k * block_size + q
+        std::string b = std::to_string(block_size);
+        placement = "exists (k, q : " + i + " = " + std::to_string((int64_t) nb_ranks * block_size) + "k + " +
+                    b + "r + q and 0 <= q < " + b + " and 0 <= r < " + std::to_string(nb_ranks) +
+                    " and j = " + b + "k + q)";
+    }
+
+    std::string map = "{" + this->get_name() + "[" + in + "] -> " + this->get_name() + "[" + out + "] : " + placement + "}";
+    isl_map *transformation_map = isl_map_read_from_str(this->get_ctx(), map.c_str());
+    for (int k = 0; k < n; k++)
+        if (isl_map_has_dim_id(schedule, isl_dim_out, k) == isl_bool_true)
+            transformation_map = isl_map_set_dim_id(transformation_map, isl_dim_out, k,
+                                                    isl_map_get_dim_id(schedule, isl_dim_out, k));
+    transformation_map = isl_map_set_tuple_id(transformation_map, isl_dim_in,
+                                              isl_map_get_tuple_id(schedule, isl_dim_out));
+    transformation_map = isl_map_set_tuple_id(transformation_map, isl_dim_out,
+                                              isl_map_get_tuple_id(schedule, isl_dim_out));
+
+    DEBUG(3, tiramisu::str_dump("Distribution map: ", isl_map_to_str(transformation_map)));
+
+    this->set_schedule(isl_map_apply_range(isl_map_copy(schedule), transformation_map));
+    this->tag_distribute_level(L);
+
+    DEBUG(3, tiramisu::str_dump("Schedule after the distribution: ", isl_map_to_str(this->get_schedule())));
+
+    DEBUG_INDENT(-4);
+}
+
+/**
+  * Get in \p value the value of \p e if it is an integer expression made of literals.
+  */
+static bool get_constant_int_value(const tiramisu::expr &e, int64_t &value)
+{
+    if (e.get_expr_type() == tiramisu::e_val)
+    {
+        if (!e.is_integer())
+            return false;
+        value = e.get_int_val();
+        return true;
+    }
+
+    int64_t a, b;
+    if (e.get_expr_type() != tiramisu::e_op || e.get_n_arg() != 2 ||
+        !get_constant_int_value(e.get_operand(0), a) || !get_constant_int_value(e.get_operand(1), b))
+        return false;
+
+    switch (e.get_op_type())
+    {
+        case tiramisu::o_add:
+            value = a + b;
+            return true;
+        case tiramisu::o_sub:
+            value = a - b;
+            return true;
+        case tiramisu::o_mul:
+            value = a * b;
+            return true;
+        case tiramisu::o_div:
+            if (b == 0)
+                return false;
+            value = a / b;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+  * Return the context of the parameters of \p fct, including the values of
+  * its constants that are literals.
+  */
+static isl_set *get_parameter_values_context(tiramisu::function *fct, isl_ctx *ctx)
+{
+    isl_set *context = fct->get_program_context();
+    if (context == NULL)
+        context = isl_set_read_from_str(ctx, "{:}");
+
+    for (const tiramisu::constant &cst : fct->get_invariants())
+    {
+        int64_t value;
+        if (get_constant_int_value(cst.get_expr(), value))
+        {
+            std::string param = "[" + cst.get_name() + "]->{: " + cst.get_name() + " = " + std::to_string(value) + "}";
+            context = isl_set_intersect_params(context, isl_set_read_from_str(ctx, param.c_str()));
+        }
+    }
+
+    return context;
+}
+
+/**
+  * Return the coordinate of the rank \p rank along the \p k-th dimension of the
+  * grid of ranks \p grid (numbered in row-major order), as an ISL expression.
+  */
+static std::string get_rank_coordinate(const std::string &rank, const std::vector<int> &grid, int k)
+{
+    if (grid.size() == 1)
+        return rank;
+
+    int stride = 1;
+    for (int l = k + 1; l < grid.size(); l++)
+        stride *= grid[l];
+
+    return "(floor(" + rank + "/" + std::to_string(stride) + ") mod " + std::to_string(grid[k]) + ")";
+}
+
+/**
+  * Return the ISL constraints stating that the offset between the rank of the dimension
+  * \p sender and the rank of the dimension \p receiver (i.e. the coordinates of the sender
+  * minus the coordinates of the receiver) in \p grid is \p offset. The dimensions of the
+  * ISL set are named d0, d1, ...
+  */
+static std::string get_offset_constraints(int sender, int receiver, const std::vector<int> &grid,
+                                          const std::vector<std::string> &offset)
+{
+    std::string constraints = "";
+    for (int k = 0; k < grid.size(); k++)
+    {
+        if (k > 0)
+            constraints += " and ";
+        constraints += offset[k] + " = " + get_rank_coordinate("d" + std::to_string(sender), grid, k) + " - " +
+                       get_rank_coordinate("d" + std::to_string(receiver), grid, k);
+    }
+    return constraints;
+}
+
+static std::string get_set_dimensions(isl_set *set)
+{
+    std::string dims = "";
+    for (int d = 0; d < isl_set_dim(set, isl_dim_set); d++)
+        dims += (d > 0 ? ",d" : "d") + std::to_string(d);
+    return dims;
+}
+
+/**
+  * Return the offsets in \p grid between the senders and the receivers of the
+  * send iteration domain \p send_iter_dom (whose two outermost dimensions are
+  * the sender and the receiver).
+  */
+static std::vector<std::vector<int>> get_neighbour_offsets(isl_set *send_iter_dom, const std::vector<int> &grid,
+                                                           isl_set *context)
+{
+    std::vector<std::string> offset;
+    std::string offset_dims = "";
+    for (int k = 0; k < grid.size(); k++)
+    {
+        offset.push_back("o" + std::to_string(k));
+        offset_dims += (k > 0 ? "," : "") + offset[k];
+    }
+
+    std::string map_str = "{" + std::string(isl_set_get_tuple_name(send_iter_dom)) + "[" +
+                          get_set_dimensions(send_iter_dom) + "]->[" + offset_dims + "]: " +
+                          get_offset_constraints(0, 1, grid, offset) + "}";
+    isl_set *offsets = isl_set_apply(isl_set_intersect_params(isl_set_copy(send_iter_dom), context),
+                                     isl_map_read_from_str(isl_set_get_ctx(send_iter_dom), map_str.c_str()));
+    offsets = isl_set_project_out(offsets, isl_dim_param, 0, isl_set_dim(offsets, isl_dim_param));
+
+    std::vector<std::vector<int>> result;
+    isl_set_foreach_point(offsets, [](isl_point *pnt, void *user) -> isl_stat {
+        std::vector<std::vector<int>> *result = (std::vector<std::vector<int>> *) user;
+        std::vector<int> offset;
+        isl_space *space = isl_point_get_space(pnt);
+        int n = isl_space_dim(space, isl_dim_set);
+        isl_space_free(space);
+        for (int k = 0; k < n; k++)
+        {
+            isl_val *v = isl_point_get_coordinate_val(pnt, isl_dim_set, k);
+            offset.push_back(isl_val_get_num_si(v));
+            isl_val_free(v);
+        }
+        result->push_back(offset);
+        isl_point_free(pnt);
+        return isl_stat_ok;
+    }, &result);
+    isl_set_free(offsets);
+
+    return result;
+}
+
+/**
+  * Restrict \p set (whose dimensions \p sender and \p receiver are ranks) to the
+  * pairs of ranks at the offset \p offset in \p grid.
+  */
+static isl_set *restrict_to_offset(isl_set *set, int sender, int receiver, const std::vector<int> &grid,
+                                   const std::vector<int> &offset)
+{
+    std::vector<std::string> offset_str;
+    for (int o : offset)
+        offset_str.push_back("(" + std::to_string(o) + ")");
+
+    std::string set_str = "{" + std::string(isl_set_get_tuple_name(set)) + "[" + get_set_dimensions(set) + "]: " +
+                          get_offset_constraints(sender, receiver, grid, offset_str) + "}";
+
+    return isl_set_intersect(set, isl_set_read_from_str(isl_set_get_ctx(set), set_str.c_str()));
+}
+
+/**
+  * Return true if \p access maps each element to an element at a constant offset
+  * of the same dimension (e.g. {C[i,j]->b[i+1,j]}).
+  */
+static bool is_translation(isl_map *access)
+{
+    if (isl_map_dim(access, isl_dim_in) != isl_map_dim(access, isl_dim_out))
+        return false;
+
+    isl_map *m = isl_map_reset_tuple_id(isl_map_copy(access), isl_dim_in);
+    m = isl_map_reset_tuple_id(m, isl_dim_out);
+    isl_set *deltas = isl_map_deltas(m);
+
+    std::vector<int64_t> lower, upper;
+    bool translation = get_constant_box(deltas, 0, lower, upper) && (lower == upper);
+    isl_set_free(deltas);
+
+    return translation;
+}
+
+int computation::get_distributed_dimension()
+{
+    this->gen_time_space_domain();
+
+    int number_of_dimensions = isl_set_dim(this->get_trimmed_time_processor_domain(), isl_dim_set);
+
+    int distributed_dimension = 0;
+
+    while (distributed_dimension < number_of_dimensions and
+         !this->get_function()->should_distribute(this->get_name(), distributed_dimension))
+        distributed_dimension++;
+
+    if (distributed_dimension < number_of_dimensions)
+        return distributed_dimension;
+    else
+        return -1;//no distributed dimension
+}
+
+std::vector<int> computation::get_distributed_dimensions()
+{
+    this->gen_time_space_domain();
+
+    int number_of_dimensions = isl_set_dim(this->get_trimmed_time_processor_domain(), isl_dim_set);
+
+    std::vector<int> distributed_dimensions;
+    for (int d = 0; d < number_of_dimensions; d++)
+        if (this->get_function()->should_distribute(this->get_name(), d))
+            distributed_dimensions.push_back(d);
+
+    return distributed_dimensions;
+}
+
+std::vector<int> computation::get_rank_grid()
+{
+    isl_set *it_dom = this->get_trimmed_time_processor_domain();
+    project_out_static_dimensions(it_dom);
+
+    std::vector<int> grid;
+    for (int d = 0; d < isl_set_dim(it_dom, isl_dim_set); d++)
+        if (this->get_function()->should_distribute(this->get_name(), d))
+            grid.push_back(tiramisu::utility::get_extent(it_dom, d));
+    isl_set_free(it_dom);
+
+    return grid;
+}
+
+isl_map* computation::construct_distribution_map(tiramisu::rank_t rank_type)
+{
+    DEBUG_FCT_NAME(10);
+    DEBUG_INDENT(4);
+
+    std::vector<std::string> dimensions_names = this->get_trimmed_time_space_domain_dimension_names();
+
+    std::vector<int> distributed_dimensions = this->get_distributed_dimensions();
+
+    if (distributed_dimensions.empty())
+        ERROR("Computation " + this->get_name() + "isn't tagged distributed and used gen_communication().",true);
+
+    for (int k = 0; k < distributed_dimensions.size(); k++)
+        if (distributed_dimensions[k] != k)
+            ERROR("Generating communication code automatically for inner distributed loops is currently not supported.",true);
+
+    //get the extents of the distributed loops, the number of available ranks should be equal to their product
+    std::vector<int> grid = this->get_rank_grid();
+
+    std::string dimensions_string = "";
+    for (int i = 0; i < dimensions_names.size(); i++)
+    {
+        dimensions_string += dimensions_names[i];
+        if (i < dimensions_names.size()-1)
+            dimensions_string += ",";
+    }
+    //TODO : this won't give a correct result if distributed_stride%number_of_nodes!=0
+    //should be corrected
+    std::string rank_name = get_rank_string_type(rank_type);
+    std::string params = "[" + rank_name + "]";
+
+    //The ranks are numbered in row-major order over the grid of distributed loops
+    int number_of_ranks = 1;
+    std::string linear_rank = "";
+    for (int k = grid.size() - 1; k >= 0; k--)
+    {
+        std::string term = std::to_string(number_of_ranks) + "*" +
+                           this->get_dimension_name_for_loop_level(distributed_dimensions[k]);
+        linear_rank = (linear_rank == "") ? term : term + " + " + linear_rank;
+        number_of_ranks *= grid[k];
+    }
+    std::string ranks_definition = "0<=" + rank_name + "<" + std::to_string(number_of_ranks);
+
+    std::string domain = this->get_name() + "[" + dimensions_string + "]";
 
-    std::string constraint_on_distributed_dimension = rank_name + "<=" + this->get_dimension_name_for_loop_level(distributed_dimension) + "<" + "(" + rank_name + "+1)";
+    std::string constraint_on_distributed_dimensions = rank_name + " = " + linear_rank;
 
     std::string distribution_map_string = params + "->{" + domain +"->" + domain + ":"
-    + ranks_definition + " and " + constraint_on_distributed_dimension + "}";
+    + ranks_definition + " and " + constraint_on_distributed_dimensions + "}";
 
     isl_map* distribution_map = isl_map_read_from_str(this->get_ctx(), distribution_map_string.c_str());
 
@@ -9050,47 +12118,27 @@ std::string computation::get_comm_id(rank_t rank_type, int i)
 
 isl_set* computation::construct_comm_set(isl_set* set, rank_t rank_type, int comm_id)
 {
-    int dist_dim = this->get_distributed_dimension();
-
-    set = isl_set_insert_dims(set, isl_dim_set, 0, 1);
-    set = isl_set_insert_dims(set, isl_dim_set, 1, 1);
+    std::vector<int> distributed_dimensions = this->get_distributed_dimensions();
 
     // If the rank is a receiver, this means that in the set, the iterators will be in
-    // this order: dist_dim, r_receiver, r_sender, iterators
-    if (rank_type == rank_t::r_receiver)
-    {
-        set = isl_set_set_dim_name(set, isl_dim_set, 0, get_rank_string_type(rank_t::r_receiver).c_str());
-        set = isl_set_set_dim_name(set, isl_dim_set, 1, get_rank_string_type(rank_t::r_sender).c_str());
-    }
+    // this order: r_receiver, r_sender, iterators
     // If the rank is a sender, this means that in the set, the iterators will be in
-    // this order: dist_dim, r_sender, r_receiver, iterators
-    else
+    // this order: r_sender, r_receiver, iterators
+    rank_t first = rank_type;
+    rank_t second = (rank_type == rank_t::r_receiver) ? rank_t::r_sender : rank_t::r_receiver;
+
+    //Turn the rank parameters into the outermost dimensions
+    for (rank_t r : {second, first})
     {
-        set = isl_set_set_dim_name(set, isl_dim_set, 1, get_rank_string_type(rank_t::r_receiver).c_str());
-        set = isl_set_set_dim_name(set, isl_dim_set, 0, get_rank_string_type(rank_t::r_sender).c_str());
+        int idx = isl_set_find_dim_by_name(set, isl_dim_param, get_rank_string_type(r).c_str());
+        if (idx < 0)
+            ERROR("The exchanged set does not depend on " + get_rank_string_type(r) + ".", true);
+        set = isl_set_move_dims(set, isl_dim_set, 0, isl_dim_param, idx, 1);
     }
 
-    //Add constraints to create a relation between the dim_params and dim_sets
-    std::vector <std::string> set_parts;
-    split_string(isl_set_to_str(set), "}", set_parts);
-    set_parts[0] += " and " + get_rank_string_type(rank_t::r_sender) + "'=" + get_rank_string_type(rank_t::r_sender);
-    set_parts[0] += " and " + get_rank_string_type(rank_t::r_receiver) + "'=" + get_rank_string_type(rank_t::r_receiver) + "}";
-    set = isl_set_read_from_str(isl_set_get_ctx(set), set_parts[0].c_str());
-
-    //Project out the distributed dimension
-    set = isl_set_project_out(set, isl_dim_set, dist_dim + 2, 1);
-
-    //Project out r_receiver from isl_dim_param
-    int idx_rrcv= 0;
-    while(idx_rrcv < isl_set_dim(set,isl_dim_param) and
-        isl_set_get_dim_name(set,isl_dim_param,idx_rrcv) != get_rank_string_type(rank_t::r_receiver)) idx_rrcv++;
-    set = isl_set_project_out(set, isl_dim_param, idx_rrcv, 1);
-
-    //Project out r_sender from isl_dim_param
-    int idx_rsnd = 0;
-    while(idx_rsnd < isl_set_dim(set,isl_dim_param) and
-        isl_set_get_dim_name(set,isl_dim_param,idx_rsnd) != get_rank_string_type(rank_t::r_sender)) idx_rsnd++;
-    set = isl_set_project_out(set, isl_dim_param, idx_rsnd, 1);
+    //Project out the distributed dimensions
+    for (int k = distributed_dimensions.size() - 1; k >= 0; k--)
+        set = isl_set_project_out(set, isl_dim_set, distributed_dimensions[k] + 2, 1);
 
     //Set the name of the set to:
     //If it's a send --> b_r_snd_compName_seqId
@@ -9119,10 +12167,10 @@ std::unordered_map<std::string, isl_set*> computation::construct_exchange_sets()
         //get the name of the producer
         std::string comp_name = isl_map_get_tuple_name(rhs_access, isl_dim_out);
         //apply schedule to consumer
-        rhs_access = isl_map_apply_domain(rhs_access, isl_map_copy(get_trimmed_union_of_schedules()));
+        rhs_access = isl_map_apply_domain(rhs_access, get_trimmed_union_of_schedules());
         //apply schedule to producer
         computation* producer = get_function()->get_computation_by_name(comp_name)[0];
-        rhs_access = isl_map_apply_range(rhs_access, isl_map_copy(producer->get_trimmed_union_of_schedules()));
+        rhs_access = isl_map_apply_range(rhs_access, producer->get_trimmed_union_of_schedules());
         //tiramisu::str_dump("rhs_access after applying schedule ");isl_map_dump(rhs_access);
         //apply rhs_access
         isl_set* needed_set = isl_set_apply(isl_set_copy(receiver_to_compute_set), rhs_access);
@@ -9171,12 +12219,124 @@ std::unordered_map<std::string, isl_set*> computation::construct_exchange_sets()
     return to_exchange_sets;
 }
 
-void computation::gen_communication_code(isl_set*recv_iter_dom, isl_set* send_iter_dom, int comm_id, std::string comp_name)
+isl_map *computation::get_received_elements(computation *producer, isl_set *recv_iter_dom,
+                                            const std::vector<int> &offset)
+{
+    //Extents of the local blocks of the producer along its non distributed dimensions
+    std::vector<int> distributed_dimensions = producer->get_distributed_dimensions();
+    isl_set *local_dom = producer->get_trimmed_time_processor_domain();
+    project_out_static_dimensions(local_dom);
+    for (int k = distributed_dimensions.size() - 1; k >= 0; k--)
+        local_dom = isl_set_project_out(local_dom, isl_dim_set, distributed_dimensions[k], 1);
+
+    int n = isl_set_dim(recv_iter_dom, isl_dim_set) - 2;
+    if (n != isl_set_dim(local_dom, isl_dim_set) || n != isl_set_dim(producer->get_iteration_domain(), isl_dim_set))
+        ERROR("Generating communication code automatically requires the distributed loops of " +
+              producer->get_name() + " to be split from the dimensions of its iteration domain.", true);
+
+    //The element x received from the neighbour at offset o is the element x + o*extent
+    //of the receiver (in its local coordinates)
+    std::string it_string = "";
+    std::string element_string = "";
+    for (int d = 0; d < n; d++)
+    {
+        std::string x = "x" + std::to_string(d);
+        it_string += "," + x;
+        element_string += (d > 0 ? "," : "") + x;
+        if (d < offset.size() && offset[d] != 0)
+            element_string += " + (" + std::to_string(offset[d] * tiramisu::utility::get_extent(local_dom, d)) + ")";
+    }
+    isl_set_free(local_dom);
+
+    std::string map_string = "{" + std::string(isl_set_get_tuple_name(recv_iter_dom)) + "[r0,r1" + it_string + "]->" +
+                             producer->get_name() + "[" + element_string + "]}";
+    isl_map *received = isl_map_read_from_str(this->get_ctx(), map_string.c_str());
+
+    return isl_map_apply_range(received, isl_map_copy(producer->get_access_relation()));
+}
+
+void computation::allocate_halo(computation *producer, const std::vector<isl_set *> &recv_iter_doms,
+                                const std::vector<std::vector<int>> &offsets)
+{
+    tiramisu::function *fct = this->get_function();
+    std::string buffer_name = isl_map_get_tuple_name(producer->get_access_relation(), isl_dim_out);
+    tiramisu::buffer *buff = fct->get_buffers().find(buffer_name)->second;
+    int n = buff->get_dim_sizes().size();
+    isl_set *context = get_parameter_values_context(fct, this->get_ctx());
+
+    //Number of elements received before the first element and after the last element of each dimension
+    std::vector<int64_t> sizes(n), low_halo(n, 0), high_halo(n, 0);
+    for (int b = 0; b < n; b++)
+        if (!get_constant_int_value(buff->get_dim_sizes()[b], sizes[b]))
+            ERROR("The size of the dimension " + std::to_string(b) + " of the buffer " + buffer_name +
+                  " should be a constant to receive data.", true);
+
+    for (int i = 0; i < recv_iter_doms.size(); i++)
+    {
+        isl_set *received = isl_set_apply(isl_set_copy(recv_iter_doms[i]),
+                                          this->get_received_elements(producer, recv_iter_doms[i], offsets[i]));
+        received = isl_set_intersect_params(received, isl_set_copy(context));
+        DEBUG(3, tiramisu::str_dump("Elements of " + buffer_name + " received:"); isl_set_dump(received));
+
+        for (int b = 0; b < n; b++)
+        {
+            int64_t lo, hi;
+            if (!get_constant_value(isl_set_dim_min(isl_set_copy(received), b), lo) ||
+                !get_constant_value(isl_set_dim_max(isl_set_copy(received), b), hi))
+                ERROR("Could not compute the halo of the buffer " + buffer_name +
+                      ", check if the context is set for the constants.", true);
+            low_halo[b] = std::max(low_halo[b], -lo);
+            high_halo[b] = std::max(high_halo[b], hi - sizes[b] + 1);
+        }
+        isl_set_free(received);
+    }
+    isl_set_free(context);
+
+    //adapt buffer size
+    bool shift = false;
+    std::string it_string = "";
+    std::string shifted_string = "";
+    for (int b = 0; b < n; b++)
+    {
+        if (low_halo[b] > 0 || high_halo[b] > 0)
+            buff->set_dim_size(b, sizes[b] + low_halo[b] + high_halo[b]);
+        shift = shift || (low_halo[b] > 0);
+        it_string += (b > 0 ? ",b" : "b") + std::to_string(b);
+        shifted_string += (b > 0 ? ",b" : "b") + std::to_string(b) + " + " + std::to_string(low_halo[b]);
+    }
+
+    //Shift the accesses to the buffer so that the elements received before the
+    //first element are stored at its beginning
+    if (shift)
+    {
+        std::string shift_string = "{" + buffer_name + "[" + it_string + "]->" + buffer_name + "[" + shifted_string + "]}";
+        isl_map *shift_map = isl_map_read_from_str(this->get_ctx(), shift_string.c_str());
+        for (computation *comp : fct->get_computations())
+        {
+            isl_map *access = comp->get_access_relation();
+            if (access == NULL || isl_map_has_tuple_name(access, isl_dim_out) != isl_bool_true ||
+                buffer_name != isl_map_get_tuple_name(access, isl_dim_out))
+                continue;
+            comp->set_access(isl_map_apply_range(isl_map_copy(access), isl_map_copy(shift_map)));
+        }
+        isl_map_free(shift_map);
+    }
+}
+
+void computation::gen_communication_code(isl_set*recv_iter_dom, isl_set* send_iter_dom, int comm_id, std::string comp_name,
+                                         std::vector<int> offset)
 {
+    tiramisu::function *fct = this->get_function();
+    computation *producer = fct->get_computation_by_name(comp_name)[0];
+    auto data_type = producer->get_data_type();
+
     //creating access_variables
     var r_snd(get_rank_string_type(rank_t::r_sender).c_str());
     var r_rcv(get_rank_string_type(rank_t::r_receiver).c_str());
 
+    recv_iter_dom = isl_set_set_tuple_name(recv_iter_dom, get_comm_id(rank_t::r_receiver, comm_id).c_str());
+    send_iter_dom = isl_set_set_tuple_name(send_iter_dom, get_comm_id(rank_t::r_sender, comm_id).c_str());
+
     //creating new iterators
     std::vector<tiramisu::expr> iterators;
     int idx = 2;
@@ -9189,23 +12349,88 @@ void computation::gen_communication_code(isl_set*recv_iter_dom, isl_set* send_it
     }
 
     //creating access
-    tiramisu::expr access = tiramisu::expr(op_t::o_access, comp_name,iterators,
-    get_function()->get_computation_by_name(comp_name)[0]->get_data_type());
-
-    auto data_type = get_function()->get_computation_by_name(comp_name)[0]->get_data_type();
+    tiramisu::expr access = tiramisu::expr(op_t::o_access, comp_name, iterators, data_type);
+
+    //Find the innermost levels along which the exchanged region is a box of constant
+    //extents that is contiguous in the buffer (or strided for two levels): they are
+    //collapsed into a single message
+    tiramisu::buffer *buff = fct->get_buffers().find(isl_map_get_tuple_name(producer->get_access_relation(),
+                                                                             isl_dim_out))->second;
+    int n = iterators.size();
+    std::vector<int64_t> buffer_sizes(buff->get_dim_sizes().size());
+    bool same_layout = is_translation(producer->get_access_relation()) && (buffer_sizes.size() == n);
+    for (int b = 0; b < buffer_sizes.size(); b++)
+        same_layout = same_layout && get_constant_int_value(buff->get_dim_sizes()[b], buffer_sizes[b]);
+
+    isl_set *send_region = isl_set_intersect_params(isl_set_copy(send_iter_dom),
+                                                    get_parameter_values_context(fct, this->get_ctx()));
+    int collapse_from = n;
+    bool strided = false;
+    std::vector<int64_t> lower, upper;
+    for (int k = n - 1; k >= 0 && same_layout; k--)
+    {
+        std::vector<int64_t> lo, hi;
+        if (!get_constant_box(send_region, k + 2, lo, hi))
+            break;
+        bool contiguous = true;
+        for (int l = k + 1; l < n; l++)
+            contiguous = contiguous && (hi[l - k] - lo[l - k] + 1 == buffer_sizes[l]);
+        if (!contiguous && k != n - 2)
+            break;
+        collapse_from = k;
+        lower = lo;
+        upper = hi;
+        if (!contiguous)
+        {
+            strided = true;
+            break;
+        }
+    }
+    DEBUG(3, tiramisu::str_dump("Collapsing the communication from level " + std::to_string(collapse_from + 2) +
+                                (strided ? " (strided)" : "")));
 
+    //The sends are nonblocking so that all the ranks can send before receiving
     xfer data_transfer = computation::create_xfer(
         isl_set_to_str(send_iter_dom),
         isl_set_to_str(recv_iter_dom),
         r_rcv, r_snd,
+        xfer_prop(data_type, {MPI, NONBLOCK, ASYNC}),
         xfer_prop(data_type, {MPI, BLOCK, ASYNC}),
-        xfer_prop(data_type, {MPI, BLOCK, ASYNC}),
-        access, get_function());
+        access, fct);
 
     data_transfer.s->tag_distribute_level(r_snd);
     data_transfer.r->tag_distribute_level(r_rcv);
 
-    computation *c = get_function()->get_computation_by_name(this->get_name())[0];
+    for (int k = n - 1; k >= collapse_from; k--)
+    {
+        int64_t extent = upper[k - collapse_from] - lower[k - collapse_from] + 1;
+        for (communicator *op : {(communicator *) data_transfer.s, (communicator *) data_transfer.r})
+            op->collapse(k + 2, value_cast(global::get_loop_iterator_data_type(), lower[k - collapse_from]),
+                         tiramisu::expr((int32_t) -1), tiramisu::expr((int32_t) extent));
+    }
+    if (strided)
+    {
+        int64_t block_length = upper[1] - lower[1] + 1;
+        for (communicator *op : {(communicator *) data_transfer.s, (communicator *) data_transfer.r})
+            op->set_stride(tiramisu::expr((int32_t) buffer_sizes[n - 1]), tiramisu::expr((int32_t) block_length));
+    }
+
+    //One request per receiver and message
+    std::vector<int> request_dims;
+    std::vector<tiramisu::expr> request_sizes;
+    for (int d = 1; d < collapse_from + 2; d++)
+    {
+        int64_t max_value;
+        if (!get_constant_value(isl_set_dim_max(isl_set_copy(send_region), d), max_value))
+            ERROR("Could not bound the number of messages sent by " + data_transfer.s->get_name() +
+                  ", check if the context is set for the constants.", true);
+        request_dims.push_back(d);
+        request_sizes.push_back(tiramisu::expr((int32_t) (max_value + 1)));
+    }
+    isl_set_free(send_region);
+    tiramisu::wait *send_wait = create_wait(data_transfer.s, request_dims, request_sizes, fct);
+
+    computation *c = fct->get_computation_by_name(this->get_name())[0];
 
     //schedule communications
     assert(this->get_function()->sched_graph_reversed[this].size() <= 1 &&
@@ -9220,51 +12445,19 @@ void computation::gen_communication_code(isl_set*recv_iter_dom, isl_set* send_it
         computation *pred = this->get_predecessor();
         data_transfer.s->between(*pred, level, *c, level);
         data_transfer.r->between(*data_transfer.s, level, *c, level);
+        send_wait->between(*data_transfer.r, level, *c, level);
     }
     else
     {
         DEBUG(3, tiramisu::str_dump("Communication of "+ this->get_name()+" has no predecessor"));
         data_transfer.s->before(*data_transfer.r, computation::root);
-        data_transfer.r->before(*c, computation::root);
+        data_transfer.r->before(*send_wait, computation::root);
+        send_wait->before(*c, computation::root);
     }
 
-    //create send _access_string
-    std::string it_string = "";
-    for (int i = 0; i < iterators.size(); i++)
-    {
-        it_string += iterators[i].get_name();
-        if(i < iterators.size() - 1) it_string += ',';
-    }
-
-    //Each rank will process dim_extent/nb_ranks
-    //To fix and test
-    int distributed_dimension = this->get_distributed_dimension();
-    this->simplify(this->get_iteration_domain());
-    isl_set * s= this->get_trimmed_time_processor_domain();
-    project_out_static_dimensions(s);
-    s = isl_set_project_out(s, isl_dim_set, distributed_dimension, 1);
-    int extent = tiramisu::utility::get_extent(s, distributed_dimension);
-
-    //construct string access
-    std::string access_string = "{" + get_comm_id(rank_t::r_receiver,comm_id) + "[" + get_rank_string_type(rank_t::r_receiver)
-    + "," + get_rank_string_type(rank_t::r_sender) + "," + it_string + "]->" +
-    isl_map_get_tuple_name(get_function()->get_computation_by_name(comp_name)[0]->get_access_relation(), isl_dim_out);
-    access_string += "[" + std::to_string(extent) + "+" +it_string + "]}";
-    data_transfer.r->set_access(access_string);
-
-    /***This works only for outermost loops***/
-    //To do: make it work on any level
-    //Important : get_bound doesn't work for dim more than one, that's why we project out all other dim
-    recv_iter_dom = isl_set_project_out(recv_iter_dom, isl_dim_set, 0, 2);
-
-    //adapt buffer size
-    int additional_space = tiramisu::utility::get_extent(recv_iter_dom, 0);
-
-    tiramisu::buffer *buff = this->get_function()->get_buffers().find(isl_map_get_tuple_name(
-    get_function()->get_computation_by_name(comp_name)[0]->get_access_relation(), isl_dim_out))->second;
-
-    int size = buff->get_dim_sizes()[0].get_int_val() + additional_space;
-    buff->set_dim_size(0, size);
+    //The received elements are stored where the receiver would have computed them,
+    //in the halo of the buffer
+    data_transfer.r->set_access(this->get_received_elements(producer, recv_iter_dom, offset));
 }
 
 void computation::gen_communication()
@@ -9282,27 +12475,110 @@ void computation::gen_communication()
 
         if(isl_set_is_empty(set.second)) continue;
 
+        computation *producer = this->get_function()->get_computation_by_name(set.first)[0];
+        std::vector<int> grid = producer->get_rank_grid();
+
         isl_set* recv_iter_dom = construct_comm_set(isl_set_copy(set.second), rank_t::r_receiver, comm_id);
         isl_set* send_iter_dom = construct_comm_set(set.second, rank_t::r_sender, comm_id);
 
         DEBUG(3, tiramisu::str_dump("Send iteration domain:"); isl_set_dump(send_iter_dom));
         DEBUG(3, tiramisu::str_dump("Receive iteration domain:"); isl_set_dump(recv_iter_dom));
 
-        gen_communication_code(recv_iter_dom, send_iter_dom, comm_id, set.first);
+        //Exchange the data with each neighbour separately: the region sent to the neighbour at
+        //a given offset in the grid of ranks has the same shape on all the ranks, so it can be
+        //sent as a single message
+        std::vector<std::vector<int>> offsets = get_neighbour_offsets(
+                send_iter_dom, grid, get_parameter_values_context(this->get_function(), this->get_ctx()));
+        std::vector<isl_set *> recv_iter_doms, send_iter_doms;
+        for (const auto &offset : offsets)
+        {
+            recv_iter_doms.push_back(restrict_to_offset(isl_set_copy(recv_iter_dom), 1, 0, grid, offset));
+            send_iter_doms.push_back(restrict_to_offset(isl_set_copy(send_iter_dom), 0, 1, grid, offset));
+        }
+        isl_set_free(recv_iter_dom);
+        isl_set_free(send_iter_dom);
+
+        //Allocate the halos for all the neighbours before generating the communication,
+        //as the layout of the messages depends on the size of the buffer
+        this->allocate_halo(producer, recv_iter_doms, offsets);
+
+        for (int i = 0; i < offsets.size(); i++)
+        {
+            gen_communication_code(recv_iter_doms[i], send_iter_doms[i], comm_id, set.first, offsets[i]);
+            comm_id++;
+        }
+    }
+}
+
+void computation::get_communication_volume(int &nb_messages, int64_t &nb_bytes)
+{
+    nb_messages = 0;
+    nb_bytes = 0;
+
+    isl_set *context = get_parameter_values_context(this->get_function(), this->get_ctx());
+
+    //Sets that needs to be exchanged between ranks sender, receiver
+    std::unordered_map<std::string, isl_set*>  to_receive_sets = construct_exchange_sets ();
+
+    for (auto set : to_receive_sets)
+    {
+        project_out_static_dimensions(set.second);
+
+        if(isl_set_is_empty(set.second))
+        {
+            isl_set_free(set.second);
+            continue;
+        }
+
+        computation *producer = this->get_function()->get_computation_by_name(set.first)[0];
+        std::vector<int> grid = producer->get_rank_grid();
+        int element_size = halide_type_from_tiramisu_type(producer->get_data_type()).bytes();
+
+        isl_set* recv_iter_dom = construct_comm_set(isl_set_copy(set.second), rank_t::r_receiver, 0);
+        isl_set* send_iter_dom = construct_comm_set(set.second, rank_t::r_sender, 0);
+
+        //gen_communication() sends a single message to each neighbour
+        std::vector<std::vector<int>> offsets = get_neighbour_offsets(send_iter_dom, grid, isl_set_copy(context));
+        isl_set_free(send_iter_dom);
 
-        comm_id++;
+        for (const auto &offset : offsets)
+        {
+            isl_set *region = restrict_to_offset(isl_set_copy(recv_iter_dom), 1, 0, grid, offset);
+            region = isl_set_intersect_params(region, isl_set_copy(context));
+            region = isl_set_project_out(region, isl_dim_param, 0, isl_set_dim(region, isl_dim_param));
+            if (isl_set_is_bounded(region) != isl_bool_true)
+                ERROR("The size of the data received by " + this->get_name() + " from " + producer->get_name() +
+                      " depends on parameters of unknown value.", true);
+
+            //Average size of the message of a pair of ranks at this offset
+            isl_set *pairs = isl_set_project_out(isl_set_copy(region), isl_dim_set, 2, isl_set_dim(region, isl_dim_set) - 2);
+            isl_val *nb_elements = isl_set_count_val(region);
+            isl_val *nb_pairs = isl_set_count_val(pairs);
+            if (isl_val_is_pos(nb_pairs) == isl_bool_true)
+            {
+                nb_messages++;
+                nb_bytes += element_size * (isl_val_get_num_si(nb_elements) / isl_val_get_num_si(nb_pairs));
+            }
+            isl_val_free(nb_elements);
+            isl_val_free(nb_pairs);
+            isl_set_free(pairs);
+            isl_set_free(region);
+        }
+        isl_set_free(recv_iter_dom);
     }
+    isl_set_free(context);
 }
 
 computation *computation::cache_shared(computation &inp, const var &level,
                   const std::vector<int> buffer_shape,
                   const std::vector<expr> copy_offsets,
-                  bool pad_buffer)
+                  bool pad_buffer, int stages)
 {
     assert(inp.access_variables.size() == buffer_shape.size() &&
            "Buffer shape should be same as input!");
     assert(inp.access_variables.size() == copy_offsets.size() &&
            "Copy offsets should be same size as input!");
+    assert(stages >= 1 && "The number of copy stages should be positive!");
 
     function *fn = this->get_function();
 
@@ -9325,15 +12601,49 @@ computation *computation::cache_shared(computation &inp, const var &level,
     }
     assert(std::get<0>(block_dims) != -1 && "Computation is not mapped to GPU!");
 
+    // With several stages, the tiles are stored in slots indexed by the tile
+    // number along the dimension whose offset moves with the copy level
+    int tile_dim = -1;
+    if (stages > 1) {
+        for (int i = 0; i < copy_offsets.size(); i++) {
+            bool uses_level = false;
+            std::function<expr(const expr &)> find_level = [&](const expr &e) {
+                if (e.get_expr_type() == e_var && e.get_name() == level.get_name())
+                    uses_level = true;
+                return e.apply_to_operands(find_level);
+            };
+            find_level(copy_offsets[i]);
+            if (uses_level) {
+                if (tile_dim != -1)
+                    ERROR("Pipelined copies to shared memory need exactly one copy offset that depends on "
+                          + level.get_name() + ".", true);
+                tile_dim = i;
+            }
+        }
+        if (tile_dim == -1)
+            ERROR("Pipelined copies to shared memory need exactly one copy offset that depends on "
+                  + level.get_name() + ".", true);
+    }
+
     // Create shared buffer
     std::string name_prefix = "_" + this->get_name() + "_" + inp.get_name();
     std::vector<expr> buff_shape(buffer_shape.begin(), buffer_shape.end());
     if (pad_buffer) {
-        buff_shape[buff_shape.size() - 1] = buff_shape[buff_shape.size() - 1] + 1;
+        // The fragment loads of tensor cores need rows aligned on 16 bytes
+        int padding = 1;
+        for (const auto &dims : fn->gpu_tensor_core_dimensions)
+            if (dims.first == this->get_name())
+                padding = std::max(1, 16 / (int) halide_type_from_tiramisu_type(inp.get_data_type()).bytes());
+        buff_shape[buff_shape.size() - 1] = buff_shape[buff_shape.size() - 1] + padding;
+    }
+    if (stages > 1) {
+        buff_shape.insert(buff_shape.begin(), expr(stages));
     }
     buffer *buff = new buffer(name_prefix + "_shared",
             buff_shape, inp.get_data_type(), a_temporary, fn);
     buff->tag_gpu_shared();
+    if (pad_buffer)
+        buff->set_shared_layout(tiramisu::shared_dense);
 
     // Create new access computation and replace mapping
     std::vector<var> access_variables;
@@ -9343,6 +12653,10 @@ computation *computation::cache_shared(computation &inp, const var &level,
         access_variables.push_back(v);
         access_exprs.push_back(v % buffer_shape[i]);
     }
+    if (stages > 1) {
+        var v = var(inp.access_variables[tile_dim].second, false);
+        access_exprs.insert(access_exprs.begin(), v / buffer_shape[tile_dim] % stages);
+    }
     input *new_access = new input(name_prefix + "_access", access_variables, inp.get_data_type());
     new_access->store_in(buff, access_exprs);
     this->set_expression(this->expression.substitute_access(inp.get_name(), new_access->get_name()));
@@ -9452,9 +12766,16 @@ computation *computation::cache_shared(computation &inp, const var &level,
     std::vector<expr> buf_access;
     std::vector<expr> inp_access;
     for (int i = 0; i < buffer_shape.size(); i++) {
-        buf_access.push_back(var(copy_index_regs[i]->get_buffer()->get_name(), false));
+        // The accesses of this computation read the element at index % buffer_shape
+        if (stages == 1)
+            buf_access.push_back((var(copy_index_regs[i]->get_buffer()->get_name(), false) + copy_offsets[i]) % buffer_shape[i]);
+        else
+            buf_access.push_back(var(copy_index_regs[i]->get_buffer()->get_name(), false));
         inp_access.push_back(var(copy_index_regs[i]->get_buffer()->get_name(), false) + copy_offsets[i]);
     }
+    if (stages > 1) {
+        buf_access.insert(buf_access.begin(), copy_offsets[tile_dim] / buffer_shape[tile_dim] % stages);
+    }
 
     // Add names of index variables as params to copy domain
     for (int i = 0; i < copy_index_regs.size(); i++) {
@@ -9476,42 +12797,101 @@ computation *computation::cache_shared(computation &inp, const var &level,
     fn->gpu_thread_dimensions.push_back(std::make_pair(copy_computation->get_name(), thread_dims));
     isl_set_free(copy_domain);
 
-    // Synchronization
-    computation *c_sync1 = new computation(
-            isl_set_to_str(isl_set_set_tuple_name(isl_set_copy(sync_domain), (name_prefix + "_sync1").c_str())),
-            tiramisu::sync(), true, p_int32, fn);
-    computation *c_sync2 = new computation(
-            isl_set_to_str(isl_set_set_tuple_name(isl_set_copy(sync_domain), (name_prefix + "_sync2").c_str())),
-            tiramisu::sync(), true, p_int32, fn);
-    fn->gpu_block_dimensions.push_back(std::make_pair(c_sync1->get_name(), block_dims));
-    fn->gpu_thread_dimensions.push_back(std::make_pair(c_sync1->get_name(), thread_dims));
-    fn->gpu_block_dimensions.push_back(std::make_pair(c_sync2->get_name(), block_dims));
-    fn->gpu_thread_dimensions.push_back(std::make_pair(c_sync2->get_name(), thread_dims));
-
-    // Schedule computations
-    {
-        // Traverse schedule tree up and find the first computation in the given level
-        computation *curr = this;
-        computation *pred = curr->get_predecessor();
-        while (pred != nullptr && fn->sched_graph[pred][curr] >= copy_level) {
-            curr = pred;
-            pred = curr->get_predecessor();
-        }
-        // Schedule
+    // Schedule the copy before the first computation in the given level
+    computation *first = this;
+    computation *pred = first->get_predecessor();
+    while (pred != nullptr && fn->sched_graph[pred][first] >= copy_level) {
+        first = pred;
+        pred = first->get_predecessor();
+    }
+    if (stages == 1) {
+        // Synchronization
+        computation *c_sync1 = new computation(
+                isl_set_to_str(isl_set_set_tuple_name(isl_set_copy(sync_domain), (name_prefix + "_sync1").c_str())),
+                tiramisu::sync(), true, p_int32, fn);
+        computation *c_sync2 = new computation(
+                isl_set_to_str(isl_set_set_tuple_name(isl_set_copy(sync_domain), (name_prefix + "_sync2").c_str())),
+                tiramisu::sync(), true, p_int32, fn);
+        fn->gpu_block_dimensions.push_back(std::make_pair(c_sync1->get_name(), block_dims));
+        fn->gpu_thread_dimensions.push_back(std::make_pair(c_sync1->get_name(), thread_dims));
+        fn->gpu_block_dimensions.push_back(std::make_pair(c_sync2->get_name(), block_dims));
+        fn->gpu_thread_dimensions.push_back(std::make_pair(c_sync2->get_name(), thread_dims));
+
         if (pred != nullptr) {
-            c_sync1->between(*pred, fn->sched_graph[pred][curr], *curr, copy_level);
+            c_sync1->between(*pred, fn->sched_graph[pred][first], *first, copy_level);
         } else {
-            c_sync1->before(*curr, copy_level);
+            c_sync1->before(*first, copy_level);
         }
-        c_sync2->between(*c_sync1, copy_level, *curr, copy_level);
+        c_sync2->between(*c_sync1, copy_level, *first, copy_level);
         copy_computation->between(*c_sync1, copy_level, *c_sync2, copy_level);
-        copy_index_decs[0]->between(*copy_computation->get_predecessor(), copy_level, *copy_computation, copy_level + 1);
-        for (int i = 1; i < copy_index_decs.size(); i++) {
-            copy_index_decs[i]->between(*copy_computation->get_predecessor(), copy_level + 1, *copy_computation, copy_level + 1);
+    } else {
+        // A single barrier at the end of each iteration makes the next tile
+        // visible and protects the slot that the next copy overwrites. It
+        // also runs during the prologue, where only copies are issued, so
+        // its domain spans the shifted iterations of the copy as well.
+        isl_map *extend = isl_map_identity(isl_space_map_from_set(isl_set_get_space(sync_domain)));
+        extend = isl_map_project_out(extend, isl_dim_out, copy_level, 1);
+        extend = isl_map_insert_dims(extend, isl_dim_out, copy_level, 1);
+        isl_constraint *lower = isl_constraint_alloc_inequality(isl_local_space_from_space(isl_map_get_space(extend)));
+        lower = isl_constraint_set_coefficient_si(lower, isl_dim_out, copy_level, 1);
+        lower = isl_constraint_set_coefficient_si(lower, isl_dim_in, copy_level, -1);
+        lower = isl_constraint_set_constant_si(lower, stages - 1);
+        extend = isl_map_add_constraint(extend, lower);
+        isl_constraint *upper = isl_constraint_alloc_inequality(isl_local_space_from_space(isl_map_get_space(extend)));
+        upper = isl_constraint_set_coefficient_si(upper, isl_dim_out, copy_level, -1);
+        upper = isl_constraint_set_coefficient_si(upper, isl_dim_in, copy_level, 1);
+        extend = isl_map_add_constraint(extend, upper);
+        isl_set *barrier_domain = isl_set_apply(isl_set_copy(sync_domain), extend);
+        for (int i = 0; i <= copy_level; i++)
+            barrier_domain = isl_set_set_dim_name(barrier_domain, isl_dim_set, i,
+                    isl_set_get_dim_name(sync_domain, isl_dim_set, i));
+        barrier_domain = isl_set_set_tuple_name(barrier_domain, (name_prefix + "_barrier").c_str());
+        computation *c_barrier = new computation(isl_set_to_str(barrier_domain), tiramisu::sync(), true, p_int32, fn);
+        isl_set_free(barrier_domain);
+        fn->gpu_block_dimensions.push_back(std::make_pair(c_barrier->get_name(), block_dims));
+        fn->gpu_thread_dimensions.push_back(std::make_pair(c_barrier->get_name(), thread_dims));
+        // The tile needed by the next iteration was issued stages - 1
+        // iterations ago, so stages - 2 groups of copies may stay in flight
+        fn->gpu_async_barriers[c_barrier->get_name()] = stages - 2;
+        fn->gpu_async_copies.insert(copy_computation->get_name());
+
+        if (pred != nullptr) {
+            copy_computation->between(*pred, fn->sched_graph[pred][first], *first, copy_level);
+        } else {
+            copy_computation->before(*first, copy_level);
         }
-        for (int i = 0; i < copy_index_regs.size(); i++) {
-            copy_index_regs[i]->between(*copy_computation->get_predecessor(), copy_level + 1, *copy_computation, copy_level + 1);
+        computation *last = this;
+        computation *succ = last->get_successor();
+        while (succ != nullptr && fn->sched_graph[last][succ] >= copy_level) {
+            last = succ;
+            succ = last->get_successor();
         }
+        if (succ != nullptr) {
+            c_barrier->between(*last, copy_level, *succ, fn->sched_graph[last][succ]);
+        } else {
+            c_barrier->after(*last, copy_level);
+        }
+    }
+    isl_set_free(sync_domain);
+    computation *copy_pred = copy_computation->get_predecessor();
+    if (copy_pred != nullptr) {
+        copy_index_decs[0]->between(*copy_pred, fn->sched_graph[copy_pred][copy_computation], *copy_computation, copy_level + 1);
+    } else {
+        copy_index_decs[0]->before(*copy_computation, copy_level + 1);
+    }
+    for (int i = 1; i < copy_index_decs.size(); i++) {
+        copy_index_decs[i]->between(*copy_computation->get_predecessor(), copy_level + 1, *copy_computation, copy_level + 1);
+    }
+    for (int i = 0; i < copy_index_regs.size(); i++) {
+        copy_index_regs[i]->between(*copy_computation->get_predecessor(), copy_level + 1, *copy_computation, copy_level + 1);
+    }
+    if (stages > 1) {
+        // Issue the copy of each tile stages - 1 iterations ahead
+        copy_computation->shift(copy_level, -(stages - 1));
+        for (auto *c : copy_index_decs)
+            c->shift(copy_level, -(stages - 1));
+        for (auto *c : copy_index_regs)
+            c->shift(copy_level, -(stages - 1));
     }
     // Schedule buffer declaration
     {
@@ -9533,4 +12913,1128 @@ computation *computation::cache_shared(computation &inp, const var &level,
     return new_access;
 }
 
+namespace
+{
+
+/**
+  * The elements accessed through \p access by each iteration of the loops of
+  * \p comp up to the loop level \p level: apply the schedule, then keep only
+  * the dynamic dimensions up to \p level (named).  Takes \p access.
+  */
+isl_map *footprint_at_level(const computation *comp, isl_map *access, int level)
+{
+    isl_map *schedule = isl_map_intersect_domain(isl_map_copy(comp->get_schedule()),
+                                                 isl_set_copy(comp->get_iteration_domain()));
+    isl_map *footprint = isl_map_apply_domain(access, schedule);
+    footprint = isl_map_project_out(footprint, isl_dim_in, 0, 1);
+    for (int i = isl_map_dim(footprint, isl_dim_in) - 1; i >= 0; i -= 2)
+        footprint = isl_map_project_out(footprint, isl_dim_in, i, 1);
+    footprint = isl_map_project_out(footprint, isl_dim_in, level + 1,
+                                    isl_map_dim(footprint, isl_dim_in) - level - 1);
+    for (int i = 0; i < isl_map_dim(footprint, isl_dim_in); i++)
+        if (!isl_map_has_dim_name(footprint, isl_dim_in, i))
+            footprint = isl_map_set_dim_name(footprint, isl_dim_in, i, generate_new_variable_name().c_str());
+
+    return footprint;
+}
+
+/**
+  * The differences between the elements accessed through \p access by two
+  * consecutive iterations of the loop level \p level of \p comp, the other
+  * loop levels being fixed.  Takes \p access.
+  */
+isl_set *access_deltas_at_level(const computation *comp, isl_map *access, int level)
+{
+    isl_map *schedule = isl_map_intersect_domain(isl_map_copy(comp->get_schedule()),
+                                                 isl_set_copy(comp->get_iteration_domain()));
+    isl_map *accessed = isl_map_apply_domain(access, schedule);
+
+    int dim = loop_level_into_dynamic_dimension(level);
+    isl_space *space = isl_space_map_from_set(isl_space_domain(isl_map_get_space(accessed)));
+    isl_map *next = isl_map_universe(isl_space_copy(space));
+    isl_local_space *ls = isl_local_space_from_space(space);
+    for (int i = 0; i < isl_map_dim(accessed, isl_dim_in); i++)
+    {
+        isl_constraint *c = isl_constraint_alloc_equality(isl_local_space_copy(ls));
+        c = isl_constraint_set_coefficient_si(c, isl_dim_in, i, 1);
+        c = isl_constraint_set_coefficient_si(c, isl_dim_out, i, -1);
+        if (i == dim)
+            c = isl_constraint_set_constant_si(c, 1);
+        next = isl_map_add_constraint(next, c);
+    }
+    isl_local_space_free(ls);
+
+    isl_map *pairs = isl_map_apply_range(isl_map_apply_range(isl_map_reverse(isl_map_copy(accessed)), next),
+                                         accessed);
+
+    return isl_map_deltas(pairs);
+}
+
+/**
+  * Set \p low and \p up to the bounds of the dimension \p dim of \p deltas.
+  * Return false if one of them is not a constant.
+  */
+bool delta_bounds(isl_set *deltas, int dim, long &low, long &up)
+{
+    isl_aff *aff = isl_aff_var_on_domain(isl_local_space_from_space(isl_set_get_space(deltas)),
+                                         isl_dim_set, dim);
+    isl_val *min = isl_set_min_val(deltas, aff);
+    isl_val *max = isl_set_max_val(deltas, aff);
+    isl_aff_free(aff);
+
+    bool constant = isl_val_is_int(min) && isl_val_is_int(max);
+    if (constant)
+    {
+        low = isl_val_get_num_si(min);
+        up = isl_val_get_num_si(max);
+    }
+    isl_val_free(min);
+    isl_val_free(max);
+
+    return constant;
+}
+
+/**
+  * Set \p extents to the largest distance (plus one) between two elements of
+  * the same footprint along each dimension.  Return false if one of them is
+  * not a constant.
+  */
+bool footprint_extents(isl_map *footprint, std::vector<int> &extents)
+{
+    isl_set *deltas = isl_map_deltas(isl_map_apply_range(isl_map_reverse(isl_map_copy(footprint)),
+                                                         isl_map_copy(footprint)));
+    extents.clear();
+    for (int i = 0; i < isl_set_dim(deltas, isl_dim_set); i++)
+    {
+        isl_aff *dim = isl_aff_var_on_domain(isl_local_space_from_space(isl_set_get_space(deltas)),
+                                             isl_dim_set, i);
+        isl_val *extent = isl_set_max_val(deltas, dim);
+        isl_aff_free(dim);
+        bool constant = isl_val_is_int(extent);
+        if (constant)
+            extents.push_back(isl_val_get_num_si(extent) + 1);
+        isl_val_free(extent);
+        if (!constant)
+        {
+            isl_set_free(deltas);
+            return false;
+        }
+    }
+    isl_set_free(deltas);
+
+    return true;
+}
+
+/**
+  * The footprint of the next iteration of the innermost loop of
+  * \p footprint: [o, t] -> elements of [o, t + distance].
+  */
+isl_map *next_footprint(isl_map *footprint, int distance = 1)
+{
+    int n = isl_map_dim(footprint, isl_dim_in);
+    isl_space *space = isl_space_map_from_set(isl_space_domain(isl_map_get_space(footprint)));
+    isl_map *next = isl_map_universe(isl_space_copy(space));
+    isl_local_space *ls = isl_local_space_from_space(space);
+    for (int i = 0; i < n; i++)
+    {
+        isl_constraint *c = isl_constraint_alloc_equality(isl_local_space_copy(ls));
+        c = isl_constraint_set_coefficient_si(c, isl_dim_in, i, 1);
+        c = isl_constraint_set_coefficient_si(c, isl_dim_out, i, -1);
+        if (i == n - 1)
+            c = isl_constraint_set_constant_si(c, distance);
+        next = isl_map_add_constraint(next, c);
+    }
+    isl_local_space_free(ls);
+
+    return isl_map_apply_range(next, isl_map_copy(footprint));
+}
+
+/**
+  * The lower (or upper) bound of the dimension \p dim of \p footprint, as an
+  * expression of the loop iterators and of the parameters.
+  */
+expr footprint_bound(isl_map *footprint, int dim, bool upper)
+{
+    isl_pw_aff *bound = upper ? isl_map_dim_max(isl_map_copy(footprint), dim)
+                              : isl_map_dim_min(isl_map_copy(footprint), dim);
+    int n_params = isl_pw_aff_dim(bound, isl_dim_param);
+    int n_in = isl_pw_aff_dim(bound, isl_dim_in);
+    bound = isl_pw_aff_move_dims(bound, isl_dim_param, n_params, isl_dim_in, 0, n_in);
+    bound = isl_pw_aff_coalesce(isl_pw_aff_project_domain_on_params(bound));
+
+    isl_set *context = isl_map_domain(isl_map_copy(footprint));
+    context = isl_set_params(isl_set_move_dims(context, isl_dim_param, n_params, isl_dim_set, 0, n_in));
+    isl_ast_build *build = isl_ast_build_from_context(context);
+    isl_ast_expr *ast = isl_ast_build_expr_from_pw_aff(build, bound);
+    expr result = tiramisu_expr_from_isl_ast_expr(ast);
+    isl_ast_expr_free(ast);
+    isl_ast_build_free(build);
+
+    return result;
+}
+
+/**
+  * A call to the I/O stream function \p fname that transfers the elements of
+  * \p footprint between the stream \p stream and the ring buffer \p chunk of
+  * shape \p chunk_shape.
+  */
+expr io_stream_call(const std::string &fname, int stream, buffer *chunk, isl_map *footprint,
+                    const std::vector<int> &chunk_shape)
+{
+    int n = chunk_shape.size();
+    std::vector<expr> args = {expr((int32_t) stream), var(p_void_ptr, chunk->get_name()),
+                              expr((int32_t) halide_type_from_tiramisu_type(chunk->get_elements_type()).bytes()),
+                              expr((int32_t) n)};
+    for (int d = 0; d < TIRAMISU_IO_STREAM_MAX_DIMS; d++)
+        args.push_back(d < n ? cast(p_int64, footprint_bound(footprint, d, false)) : expr((int64_t) 0));
+    for (int d = 0; d < TIRAMISU_IO_STREAM_MAX_DIMS; d++)
+        args.push_back(d < n ? cast(p_int64, footprint_bound(footprint, d, true)) : expr((int64_t) 0));
+    for (int d = 0; d < TIRAMISU_IO_STREAM_MAX_DIMS; d++)
+        args.push_back(expr((int64_t) (d < n ? chunk_shape[d] : 1)));
+
+    return expr(o_call, fname, args, p_int32);
+}
+
+/**
+  * Create the computation of \p fn that calls the I/O stream function
+  * \p call over \p domain (its tuple renamed to \p name).
+  */
+computation *io_stream_computation(function *fn, const std::string &name, isl_set *domain,
+                                   const expr &call, buffer *status)
+{
+    domain = isl_set_set_tuple_name(isl_set_copy(domain), name.c_str());
+    computation *io = new computation(isl_set_to_str(domain), call, true, p_int32, fn);
+    io->store_in(status, {0});
+    isl_set_free(domain);
+
+    return io;
+}
+
+}
+
+computation *computation::pack_operand(computation &inp, const var &level)
+{
+    std::vector<int> order;
+    for (int i = 0; i < inp.access_variables.size(); i++)
+        order.push_back(i);
+
+    return this->pack_operand(inp, level, order);
+}
+
+computation *computation::pack_operand(computation &inp, const var &level, std::vector<int> const &order)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    function *fn = this->get_function();
+
+    std::vector<int> dimensions = this->get_loop_level_numbers_from_dimension_names({level.get_name()});
+    assert(dimensions.size() == 1);
+    int pack_level = dimensions[0];
+
+    // Collect the accesses of this computation to the operand.
+    std::vector<isl_map *> accesses;
+    generator::traverse_expr_and_extract_accesses(fn, this, this->get_expr(), accesses, false);
+    isl_map *access = NULL;
+    for (isl_map *acc : accesses)
+    {
+        const char *accessed = isl_map_get_tuple_name(acc, isl_dim_out);
+        if (accessed != NULL && std::string(accessed) == inp.get_name())
+            access = (access == NULL) ? acc : isl_map_union(access, acc);
+        else
+            isl_map_free(acc);
+    }
+    if (access == NULL)
+        ERROR("Computation " + this->get_name() + " does not access " + inp.get_name() + ".", true);
+    access = isl_map_intersect_domain(access, isl_set_copy(this->get_iteration_domain()));
+
+    isl_map *footprint = footprint_at_level(this, access, pack_level);
+
+    DEBUG(3, tiramisu::str_dump("Footprint of the packed operand: ", isl_map_to_str(footprint)));
+
+    std::vector<int> panel_shape;
+    if (!footprint_extents(footprint, panel_shape))
+    {
+        isl_map_free(footprint);
+        ERROR("The panel of " + inp.get_name() + " packed at level " + level.get_name() +
+              " does not have a constant size.", true);
+    }
+
+    DEBUG(3, tiramisu::str_dump("Panel shape: ");
+             for (int s : panel_shape) tiramisu::str_dump(std::to_string(s) + " "));
+
+    // Create the panel
+    std::string name_prefix = "_" + this->get_name() + "_" + inp.get_name();
+    std::vector<expr> buff_shape;
+    for (int i : order)
+        buff_shape.push_back(panel_shape[i]);
+    buffer *buff = new buffer(name_prefix + "_packed", buff_shape, inp.get_data_type(), a_temporary, fn);
+    buff->set_alignment(64);
+
+    // Create new access computation and replace mapping
+    std::vector<var> access_variables;
+    std::vector<expr> access_exprs;
+    for (int i = 0; i < inp.access_variables.size(); i++)
+        access_variables.push_back(var(inp.access_variables[i].second, false));
+    for (int i : order)
+        access_exprs.push_back(access_variables[i] % panel_shape[i]);
+    input *new_access = new input(name_prefix + "_panel", access_variables, inp.get_data_type());
+    new_access->store_in(buff, access_exprs);
+    this->set_expression(this->expression.substitute_access(inp.get_name(), new_access->get_name()));
+
+    // The copy iterates over the loops up to pack_level and, inside, over the footprint.
+    std::vector<expr> inp_access;
+    std::vector<expr> buf_access;
+    int n_outer = isl_map_dim(footprint, isl_dim_in);
+    for (int i = 0; i < panel_shape.size(); i++)
+    {
+        std::string it_name = name_prefix + "_pack_" + std::to_string(i);
+        footprint = isl_map_set_dim_name(footprint, isl_dim_out, i, it_name.c_str());
+        inp_access.push_back(var(it_name, false));
+    }
+    for (int i : order)
+        buf_access.push_back(inp_access[i] % panel_shape[i]);
+    isl_set *copy_domain = isl_set_flatten(isl_map_wrap(footprint));
+    copy_domain = isl_set_set_tuple_name(copy_domain, (name_prefix + "_pack").c_str());
+    std::string copy_domain_str = isl_set_to_str(copy_domain);
+    DEBUG(3, tiramisu::str_dump("Generated iteration domain for packing: " + copy_domain_str));
+    computation *copy_computation = new computation(copy_domain_str,
+            expr(o_access, inp.get_name(), inp_access, inp.get_data_type()),
+            true, inp.get_data_type(), fn);
+    copy_computation->store_in(buff, buf_access);
+
+    // Schedule the copy right before the first computation in the level
+    {
+        computation *curr = this;
+        computation *pred = curr->get_predecessor();
+        while (pred != nullptr && fn->sched_graph[pred][curr] >= pack_level) {
+            curr = pred;
+            pred = curr->get_predecessor();
+        }
+        if (pred != nullptr) {
+            copy_computation->between(*pred, fn->sched_graph[pred][curr], *curr, pack_level);
+        } else {
+            copy_computation->before(*curr, pack_level);
+        }
+    }
+
+    // Give each thread its own panel
+    this->allocate_per_thread(buff, copy_computation, copy_domain, pack_level, name_prefix + "_pack_dec");
+    isl_set_free(copy_domain);
+
+    DEBUG_INDENT(-4);
+
+    return copy_computation;
+}
+
+long computation::get_access_stride(computation &inp, int level)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    function *fn = this->get_function();
+    if (inp.get_access_relation() == NULL)
+    {
+        DEBUG_INDENT(-4);
+        return -1;
+    }
+
+    // The strides of the dimensions of the buffer of inp, -1 if unknown.
+    buffer *buff = fn->get_buffers().at(isl_map_get_tuple_name(inp.get_access_relation(), isl_dim_out));
+    std::vector<long> dim_strides(buff->get_n_dims(), 1);
+    for (int i = buff->get_n_dims() - 2; i >= 0; i--)
+    {
+        expr size = buff->get_dim_sizes()[i + 1];
+        dim_strides[i] = (dim_strides[i + 1] >= 0 && size.get_expr_type() == e_val) ?
+                         dim_strides[i + 1] * size.get_int_val() : -1;
+    }
+
+    std::vector<isl_map *> accesses;
+    generator::traverse_expr_and_extract_accesses(fn, this, this->get_expr(), accesses, false);
+    long stride = 0;
+    for (isl_map *acc : accesses)
+    {
+        const char *accessed = isl_map_get_tuple_name(acc, isl_dim_out);
+        if (accessed == NULL || std::string(accessed) != inp.get_name() || stride < 0)
+        {
+            isl_map_free(acc);
+            continue;
+        }
+
+        acc = isl_map_apply_range(acc, isl_map_copy(inp.get_access_relation()));
+        isl_set *deltas = access_deltas_at_level(this, acc, level);
+        if (isl_set_is_empty(deltas) == isl_bool_true)
+        {
+            isl_set_free(deltas);
+            continue;
+        }
+
+        long access_stride = 0;
+        for (int i = 0; i < isl_set_dim(deltas, isl_dim_set) && access_stride >= 0; i++)
+        {
+            long low, up;
+            if (!delta_bounds(deltas, i, low, up) || ((low != 0 || up != 0) && dim_strides[i] < 0))
+                access_stride = -1;
+            else
+                access_stride += std::max(std::abs(low), std::abs(up)) * dim_strides[i];
+        }
+        isl_set_free(deltas);
+
+        stride = (access_stride < 0) ? -1 : std::max(stride, access_stride);
+    }
+
+    DEBUG(3, tiramisu::str_dump("Stride of the accesses of " + this->get_name() + " to " + inp.get_name() +
+                                " at level " + std::to_string(level) + ": " + std::to_string(stride)));
+    DEBUG_INDENT(-4);
+
+    return stride;
+}
+
+std::vector<isl_map *> computation::get_buffer_accesses()
+{
+    function *fn = this->get_function();
+
+    // The reads, through the computations that are read, then the write
+    std::vector<isl_map *> accesses;
+    std::vector<isl_map *> reads;
+    generator::traverse_expr_and_extract_accesses(fn, this, this->get_expr(), reads, false);
+    for (isl_map *acc : reads)
+    {
+        const char *accessed = isl_map_get_tuple_name(acc, isl_dim_out);
+        std::vector<computation *> inps;
+        if (accessed != NULL)
+            inps = fn->get_computation_by_name(accessed);
+        if (inps.empty() || inps[0]->get_access_relation() == NULL)
+            isl_map_free(acc);
+        else
+            accesses.push_back(isl_map_apply_range(acc, isl_map_copy(inps[0]->get_access_relation())));
+    }
+    if (this->get_access_relation() != NULL)
+        accesses.push_back(isl_map_copy(this->get_access_relation()));
+
+    return accesses;
+}
+
+bool computation::accesses_column_of(const tiramisu::buffer &buff, int level)
+{
+    bool column = false;
+    for (isl_map *acc : this->get_buffer_accesses())
+    {
+        if (column || isl_map_get_tuple_name(acc, isl_dim_out) == NULL ||
+            buff.get_name() != isl_map_get_tuple_name(acc, isl_dim_out) || isl_map_dim(acc, isl_dim_out) < 2)
+        {
+            isl_map_free(acc);
+            continue;
+        }
+
+        isl_set *deltas = access_deltas_at_level(this, acc, level);
+        int n = isl_set_dim(deltas, isl_dim_set);
+        long low, up, row_low, row_up;
+        column = !isl_set_is_empty(deltas) &&
+                 delta_bounds(deltas, n - 1, low, up) && low == 0 && up == 0 &&
+                 (!delta_bounds(deltas, n - 2, row_low, row_up) || row_low != 0 || row_up != 0);
+        isl_set_free(deltas);
+    }
+
+    DEBUG(3, tiramisu::str_dump("The accesses of " + this->get_name() + " to the buffer " + buff.get_name() +
+                                " at level " + std::to_string(level) + (column ? " read a column." : " do not read a column.")));
+
+    return column;
+}
+
+std::vector<std::pair<std::string, long>> computation::get_buffer_access_strides(int level)
+{
+    function *fn = this->get_function();
+    std::vector<std::pair<std::string, long>> strides;
+    for (isl_map *acc : this->get_buffer_accesses())
+    {
+        const char *name = isl_map_get_tuple_name(acc, isl_dim_out);
+        if (name == NULL || fn->get_buffers().count(name) == 0)
+        {
+            isl_map_free(acc);
+            continue;
+        }
+
+        // The strides of the dimensions of the buffer, -1 if unknown
+        buffer *buff = fn->get_buffers().at(name);
+        std::vector<long> dim_strides(buff->get_n_dims(), 1);
+        for (int i = buff->get_n_dims() - 2; i >= 0; i--)
+        {
+            expr size = buff->get_dim_sizes()[i + 1];
+            dim_strides[i] = (dim_strides[i + 1] >= 0 && size.get_expr_type() == e_val) ?
+                             dim_strides[i + 1] * size.get_int_val() : -1;
+        }
+
+        isl_set *deltas = access_deltas_at_level(this, acc, level);
+        if (isl_set_is_empty(deltas) == isl_bool_true || isl_set_dim(deltas, isl_dim_set) != buff->get_n_dims())
+        {
+            isl_set_free(deltas);
+            continue;
+        }
+
+        long stride = 0;
+        for (int i = 0; i < isl_set_dim(deltas, isl_dim_set) && stride >= 0; i++)
+        {
+            long low, up;
+            if (!delta_bounds(deltas, i, low, up))
+                stride = -1;
+            else if (low != 0 || up != 0)
+                stride = (dim_strides[i] < 0) ? -1 : stride + std::max(std::abs(low), std::abs(up)) * dim_strides[i];
+        }
+        isl_set_free(deltas);
+        strides.push_back({name, stride});
+    }
+
+    return strides;
+}
+
+computation *computation::transpose_operand(computation &inp, const var &level)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    function *fn = this->get_function();
+    int innermost = this->get_loop_levels_number() - 1;
+
+    // Move to the end of the panel the outermost dimension of inp that the
+    // innermost loop of this computation moves along.
+    std::vector<isl_map *> accesses;
+    generator::traverse_expr_and_extract_accesses(fn, this, this->get_expr(), accesses, false);
+    int n_dims = inp.access_variables.size();
+    int strided_dim = n_dims - 1;
+    for (isl_map *acc : accesses)
+    {
+        const char *accessed = isl_map_get_tuple_name(acc, isl_dim_out);
+        if (accessed == NULL || std::string(accessed) != inp.get_name())
+        {
+            isl_map_free(acc);
+            continue;
+        }
+
+        isl_set *deltas = access_deltas_at_level(this, acc, innermost);
+        for (int i = 0; i < strided_dim; i++)
+        {
+            long low, up;
+            if (!delta_bounds(deltas, i, low, up) || low != 0 || up != 0)
+                strided_dim = i;
+        }
+        isl_set_free(deltas);
+    }
+
+    std::vector<int> order;
+    for (int i = 0; i < n_dims; i++)
+        if (i != strided_dim)
+            order.push_back(i);
+    order.push_back(strided_dim);
+
+    DEBUG(3, tiramisu::str_dump("Dimension of " + inp.get_name() + " moved last in the panel: " +
+                                std::to_string(strided_dim)));
+    DEBUG_INDENT(-4);
+
+    return this->pack_operand(inp, level, order);
+}
+
+void computation::allocate_per_thread(buffer *buff, computation *first, isl_set *domain, int level,
+                                      const std::string &name)
+{
+    function *fn = this->get_function();
+
+    int alloc_level = -1;
+    for (int l = 0; l <= level; l++)
+        if (fn->should_parallelize(this->get_name(), l))
+            alloc_level = l;
+    if (alloc_level < 0)
+        return;
+
+    isl_set *dec_domain = isl_set_project_out(isl_set_copy(domain), isl_dim_set, alloc_level + 1,
+                                              isl_set_dim(domain, isl_dim_set) - alloc_level - 1);
+    dec_domain = isl_set_set_tuple_name(dec_domain, name.c_str());
+    computation *buf_dec = new computation(isl_set_to_str(dec_domain), allocate(*buff), true, p_none, fn);
+    buff->set_auto_allocate(false);
+    isl_set_free(dec_domain);
+
+    computation *curr = first;
+    computation *pred = curr->get_predecessor();
+    while (pred != nullptr && fn->sched_graph[pred][curr] >= alloc_level) {
+        curr = pred;
+        pred = curr->get_predecessor();
+    }
+    if (pred != nullptr) {
+        buf_dec->between(*pred, fn->sched_graph[pred][curr], *curr, alloc_level);
+    } else {
+        buf_dec->before(*curr, alloc_level);
+    }
+}
+
+computation *computation::cache_local(computation &inp, const var &level, bool write_back)
+{
+    if (&inp != this)
+        return this->pack_operand(inp, level);
+
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    function *fn = this->get_function();
+
+    std::vector<int> dimensions = this->get_loop_level_numbers_from_dimension_names({level.get_name()});
+    assert(dimensions.size() == 1);
+    int cache_level = dimensions[0];
+
+    assert(this->get_access_relation() != NULL && "The computation must be stored in a buffer.");
+    isl_map *original_access = isl_map_copy(this->get_access_relation());
+    std::string buffer_name = isl_map_get_tuple_name(original_access, isl_dim_out);
+    buffer *orig_buff = fn->get_buffers().at(buffer_name);
+
+    // The tile written inside each iteration of the level.
+    isl_map *footprint = footprint_at_level(this, isl_map_intersect_domain(isl_map_copy(original_access),
+                                                                           isl_set_copy(this->get_iteration_domain())),
+                                            cache_level);
+
+    DEBUG(3, tiramisu::str_dump("Footprint of the cached tile: ", isl_map_to_str(footprint)));
+
+    std::vector<int> tile_shape;
+    if (!footprint_extents(footprint, tile_shape))
+    {
+        isl_map_free(footprint);
+        isl_map_free(original_access);
+        ERROR("The tile of " + this->get_name() + " cached at level " + level.get_name() +
+              " does not have a constant size.", true);
+    }
+
+    std::string name_prefix = "_" + this->get_name() + "_" + buffer_name;
+    std::vector<expr> buff_shape(tile_shape.begin(), tile_shape.end());
+    buffer *buff = new buffer(name_prefix + "_local", buff_shape, this->get_data_type(), a_temporary, fn);
+    buff->set_alignment(64);
+
+    // The other computations that read this computation read the buffer of the
+    // computation, through a new access computation.
+    bool reads_itself = false;
+    std::vector<var> access_variables;
+    for (int i = 0; i < this->access_variables.size(); i++)
+        access_variables.push_back(var(this->access_variables[i].second, false));
+    input *result = new input(name_prefix + "_result", access_variables, this->get_data_type());
+    result->set_access(isl_map_set_tuple_name(isl_map_copy(original_access), isl_dim_in, result->get_name().c_str()));
+    for (auto &comp : fn->get_computations())
+    {
+        if (!comp->get_expr().is_defined())
+            continue;
+
+        std::vector<isl_map *> accesses;
+        generator::traverse_expr_and_extract_accesses(fn, comp, comp->get_expr(), accesses, false);
+        bool reads_this = false;
+        for (isl_map *acc : accesses)
+        {
+            const char *accessed = isl_map_get_tuple_name(acc, isl_dim_out);
+            reads_this = reads_this || (accessed != NULL && std::string(accessed) == this->get_name());
+            isl_map_free(acc);
+        }
+
+        if (!reads_this)
+            continue;
+        else if (comp == this)
+            reads_itself = true;
+        else if (comp->get_name() != this->get_name())
+            comp->set_expression(comp->get_expr().substitute_access(this->get_name(), result->get_name()));
+    }
+
+    // Redirect the writes of this computation, and its reads of itself, to the tile.
+    std::string local_str = "{" + buffer_name + "[";
+    std::string constraints;
+    for (int i = 0; i < tile_shape.size(); i++)
+    {
+        local_str += std::string(i == 0 ? "" : ",") + "b" + std::to_string(i);
+        constraints += std::string(i == 0 ? "" : " and ") + "l" + std::to_string(i) + " = b" +
+                       std::to_string(i) + " mod " + std::to_string(tile_shape[i]);
+    }
+    local_str += "] -> " + buff->get_name() + "[";
+    for (int i = 0; i < tile_shape.size(); i++)
+        local_str += std::string(i == 0 ? "" : ",") + "l" + std::to_string(i);
+    local_str += "]: " + constraints + "}";
+    this->set_access(isl_map_apply_range(original_access,
+                                         isl_map_read_from_str(this->get_ctx(), local_str.c_str())));
+
+    // The copies iterate over the loops up to cache_level and, inside, over the tile.
+    std::vector<var> tile_variables;
+    std::vector<expr> global_access;
+    std::vector<expr> local_access;
+    for (int i = 0; i < tile_shape.size(); i++)
+    {
+        std::string it_name = name_prefix + "_cache_" + std::to_string(i);
+        footprint = isl_map_set_dim_name(footprint, isl_dim_out, i, it_name.c_str());
+        tile_variables.push_back(var(it_name, false));
+        global_access.push_back(var(it_name, false));
+        local_access.push_back(var(it_name, false) % tile_shape[i]);
+    }
+    isl_set *copy_domain = isl_set_flatten(isl_map_wrap(footprint));
+
+    input *global = new input(name_prefix + "_global", tile_variables, this->get_data_type());
+    global->store_in(orig_buff, global_access);
+    input *tile = new input(name_prefix + "_tile", tile_variables, this->get_data_type());
+    tile->store_in(buff, local_access);
+
+    computation *copy_in = NULL;
+    if (reads_itself)
+    {
+        isl_set *in_domain = isl_set_set_tuple_name(isl_set_copy(copy_domain), (name_prefix + "_copy_in").c_str());
+        copy_in = new computation(isl_set_to_str(in_domain),
+                                  expr(o_access, global->get_name(), global_access, this->get_data_type()),
+                                  true, this->get_data_type(), fn);
+        copy_in->store_in(buff, local_access);
+        isl_set_free(in_domain);
+        this->schedule_at_level_boundary(copy_in, cache_level, false);
+    }
+
+    computation *copy_out = NULL;
+    if (write_back)
+    {
+        isl_set *out_domain = isl_set_set_tuple_name(isl_set_copy(copy_domain), (name_prefix + "_copy_out").c_str());
+        copy_out = new computation(isl_set_to_str(out_domain),
+                                   expr(o_access, tile->get_name(), global_access, this->get_data_type()),
+                                   true, this->get_data_type(), fn);
+        copy_out->store_in(orig_buff, global_access);
+        isl_set_free(out_domain);
+        this->schedule_at_level_boundary(copy_out, cache_level, true);
+    }
+
+    // Give each thread its own tile
+    this->allocate_per_thread(buff, (copy_in != NULL) ? copy_in : this, copy_domain, cache_level,
+                              name_prefix + "_local_dec");
+    isl_set_free(copy_domain);
+
+    DEBUG_INDENT(-4);
+
+    return copy_out;
+}
+
+void computation::pack_gemm_operands(const var &a_level, const var &b_level)
+{
+    auto strip_casts = [](const expr &e) {
+        expr r = e;
+        while (r.get_expr_type() == e_op && r.get_op_type() == o_cast)
+            r = r.get_operand(0);
+        return r;
+    };
+    auto is_access = [](const expr &e) {
+        return e.get_expr_type() == e_op && e.get_op_type() == o_access;
+    };
+
+    expr e = strip_casts(this->get_expr());
+    expr acc, prod;
+    if (e.get_expr_type() == e_op && e.get_op_type() == o_add)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            expr lhs = strip_casts(e.get_operand(i));
+            expr rhs = strip_casts(e.get_operand(1 - i));
+            if (is_access(lhs) && lhs.get_name() == this->get_name() &&
+                rhs.get_expr_type() == e_op && rhs.get_op_type() == o_mul)
+            {
+                acc = lhs;
+                prod = rhs;
+            }
+        }
+    }
+    if (!prod.is_defined() ||
+        !is_access(strip_casts(prod.get_operand(0))) || !is_access(strip_casts(prod.get_operand(1))))
+        ERROR("Computation " + this->get_name() + " is not of the form C = C + A * B.", true);
+
+    expr a = strip_casts(prod.get_operand(0));
+    expr b = strip_casts(prod.get_operand(1));
+    if (!acc.get_access().empty() && !b.get_access().empty() &&
+        b.get_access()[0].is_equal(acc.get_access()[0]) &&
+        (a.get_access().empty() || !a.get_access()[0].is_equal(acc.get_access()[0])))
+        std::swap(a, b);
+    if (a.get_name() == b.get_name())
+        ERROR("Both operands of " + this->get_name() + " read " + a.get_name() + ".", true);
+
+    DEBUG(3, tiramisu::str_dump("Packing " + a.get_name() + " at " + a_level.get_name() +
+                                " and " + b.get_name() + " at " + b_level.get_name()));
+
+    this->pack_operand(*this->get_function()->get_computation_by_name(a.get_name())[0], a_level);
+    this->pack_operand(*this->get_function()->get_computation_by_name(b.get_name())[0], b_level);
+}
+
+void computation::schedule_at_level_boundary(computation *comp, int level, bool last)
+{
+    function *fn = this->get_function();
+    computation *curr = this;
+    if (!last)
+    {
+        computation *pred = curr->get_predecessor();
+        while (pred != nullptr && fn->sched_graph[pred][curr] >= level) {
+            curr = pred;
+            pred = curr->get_predecessor();
+        }
+        if (pred != nullptr) {
+            comp->between(*pred, fn->sched_graph[pred][curr], *curr, level);
+        } else {
+            comp->before(*curr, level);
+        }
+    }
+    else
+    {
+        computation *succ = curr->get_successor();
+        while (succ != nullptr && fn->sched_graph[curr][succ] >= level) {
+            curr = succ;
+            succ = curr->get_successor();
+        }
+        if (succ != nullptr) {
+            comp->between(*curr, level, *succ, fn->sched_graph[curr][succ]);
+        } else {
+            comp->after(*curr, level);
+        }
+    }
+}
+
+computation *computation::compute_at(computation &consumer, tiramisu::var L, tiramisu::halo_t halo)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    function *fn = this->get_function();
+
+    std::vector<int> dimensions = consumer.get_loop_level_numbers_from_dimension_names({L.get_name()});
+    assert(dimensions.size() == 1);
+    int level = dimensions[0];
+
+    assert(this->get_access_relation() != NULL && "The computation must be stored in a buffer.");
+
+    isl_map *access = consumer.get_accesses_to(*this);
+    if (access == NULL)
+        ERROR("Computation " + consumer.get_name() + " does not access " + this->get_name() + ".", true);
+
+    isl_map *footprint = footprint_at_level(&consumer, access, level);
+
+    if (halo == halo_sliding_window)
+    {
+        for (int i = 0; i <= level; i++)
+            if (fn->should_parallelize(consumer.get_name(), i) || fn->should_vectorize(consumer.get_name(), i))
+            {
+                isl_map_free(footprint);
+                ERROR("The loops of " + consumer.get_name() + " up to " + L.get_name() +
+                      " must be sequential to slide a window over " + this->get_name() + ".", true);
+            }
+
+        // The elements already computed by the previous iteration of the level.
+        footprint = isl_map_subtract(footprint, next_footprint(footprint, -1));
+        footprint = isl_map_coalesce(footprint);
+    }
+
+    DEBUG(3, tiramisu::str_dump("Region computed in each iteration: ", isl_map_to_str(footprint)));
+
+    // The new computation iterates over the loops up to the level and, inside,
+    // over the region, using the names of the iterators of this computation.
+    std::set<std::string> names;
+    for (int i = 0; i < isl_map_dim(footprint, isl_dim_out); i++)
+    {
+        const char *name = isl_set_get_dim_name(this->get_iteration_domain(), isl_dim_set, i);
+        footprint = isl_map_set_dim_name(footprint, isl_dim_out, i, name);
+        names.insert(name);
+    }
+    for (int i = 0; i < isl_map_dim(footprint, isl_dim_in); i++)
+        if (names.count(isl_map_get_dim_name(footprint, isl_dim_in, i)) != 0)
+            footprint = isl_map_set_dim_name(footprint, isl_dim_in, i, generate_new_variable_name().c_str());
+
+    std::string name = "_" + this->get_name() + "_at_" + consumer.get_name();
+    isl_map *to_this = isl_map_flatten_domain(isl_map_range_map(isl_map_copy(footprint)));
+    to_this = isl_map_set_tuple_name(to_this, isl_dim_in, name.c_str());
+    isl_set *domain = isl_map_domain(isl_map_copy(to_this));
+
+    computation *comp = new computation(isl_set_to_str(domain), this->get_expr(), true,
+                                        this->get_data_type(), fn);
+    comp->set_access(isl_map_apply_range(to_this, isl_map_copy(this->get_access_relation())));
+    isl_set_free(domain);
+    isl_map_free(footprint);
+
+    this->schedule_this_computation = false;
+    consumer.schedule_at_level_boundary(comp, level, false);
+
+    DEBUG_INDENT(-4);
+
+    return comp;
+}
+
+computation *computation::line_buffer(computation &consumer, tiramisu::var L)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    function *fn = this->get_function();
+
+    std::vector<int> dimensions = consumer.get_loop_level_numbers_from_dimension_names({L.get_name()});
+    assert(dimensions.size() == 1);
+    int level = dimensions[0];
+
+    assert(this->get_access_relation() != NULL && "The computation must be stored in a buffer.");
+    std::string buffer_name = isl_map_get_tuple_name(this->get_access_relation(), isl_dim_out);
+    buffer *buff = fn->get_buffers().at(buffer_name);
+    if (buff->get_argument_type() != a_temporary)
+        ERROR("The buffer " + buffer_name + " of " + this->get_name() + " is not a temporary buffer.", true);
+
+    isl_map *access = consumer.get_accesses_to(*this);
+    if (access == NULL)
+        ERROR("Computation " + consumer.get_name() + " does not access " + this->get_name() + ".", true);
+
+    // The rows of the buffer read by each iteration of the level, and by two
+    // consecutive iterations: the window slides along the dimension whose
+    // extent grows.
+    isl_map *footprint = footprint_at_level(&consumer, isl_map_apply_range(access,
+                                                                           isl_map_copy(this->get_access_relation())),
+                                            level);
+    isl_map *consecutive = isl_map_union(isl_map_copy(footprint), next_footprint(footprint));
+    std::vector<int> window, slide;
+    bool constant = footprint_extents(footprint, window) && footprint_extents(consecutive, slide);
+    isl_map_free(footprint);
+    isl_map_free(consecutive);
+    if (!constant)
+        ERROR("The window of " + this->get_name() + " read by " + consumer.get_name() +
+              " does not have a constant size.", true);
+
+    int dim = -1;
+    for (int i = 0; i < window.size(); i++)
+        if (slide[i] != window[i])
+        {
+            if (dim != -1)
+                ERROR("The window of " + this->get_name() + " slides along several dimensions.", true);
+            dim = i;
+        }
+    if (dim == -1)
+        ERROR("The window of " + this->get_name() + " does not slide along " + L.get_name() + ".", true);
+
+    int rows = 1;
+    while (rows < window[dim])
+        rows *= 2;
+
+    DEBUG(3, tiramisu::str_dump("Folding the dimension " + std::to_string(dim) + " of " + buffer_name +
+                                " to " + std::to_string(rows) + " rows."));
+
+    // Fold the buffer before the computation of the new rows, which writes
+    // through the access relation of this computation.
+    std::string fold_str = "{" + buffer_name + "[";
+    for (int i = 0; i < window.size(); i++)
+        fold_str += std::string(i == 0 ? "" : ",") + "b" + std::to_string(i);
+    fold_str += "] -> " + buffer_name + "[";
+    for (int i = 0; i < window.size(); i++)
+        fold_str += std::string(i == 0 ? "" : ",") + ((i == dim) ? "f" : "b" + std::to_string(i));
+    fold_str += "]: f = b" + std::to_string(dim) + " mod " + std::to_string(rows) + "}";
+    this->set_access(isl_map_apply_range(isl_map_copy(this->get_access_relation()),
+                                         isl_map_read_from_str(this->get_ctx(), fold_str.c_str())));
+    buff->set_dim_size(dim, rows);
+
+    computation *rows_comp = this->compute_at(consumer, L, halo_sliding_window);
+
+    DEBUG_INDENT(-4);
+
+    return rows_comp;
+}
+
+isl_map *computation::get_accesses_to(const computation &inp)
+{
+    std::vector<isl_map *> accesses;
+    generator::traverse_expr_and_extract_accesses(this->get_function(), this, this->get_expr(), accesses, false);
+    isl_map *access = NULL;
+    for (isl_map *acc : accesses)
+    {
+        const char *accessed = isl_map_get_tuple_name(acc, isl_dim_out);
+        if (accessed != NULL && std::string(accessed) == inp.get_name())
+            access = (access == NULL) ? acc : isl_map_union(access, acc);
+        else
+            isl_map_free(acc);
+    }
+    if (access == NULL)
+        return NULL;
+
+    access = isl_map_intersect_domain(access, isl_set_copy(this->get_iteration_domain()));
+    return isl_map_intersect_range(access, isl_set_copy(inp.get_iteration_domain()));
+}
+
+computation *computation::stream_input(computation &inp, const var &level, int stream)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    function *fn = this->get_function();
+
+    std::vector<int> dimensions = this->get_loop_level_numbers_from_dimension_names({level.get_name()});
+    assert(dimensions.size() == 1);
+    int stream_level = dimensions[0];
+    for (int l = 0; l <= stream_level; l++)
+        if (fn->should_parallelize(this->get_name(), l))
+            ERROR("The loops of " + this->get_name() + " up to the stream level " + level.get_name() +
+                  " cannot be parallel.", true);
+    if (inp.access_variables.size() > TIRAMISU_IO_STREAM_MAX_DIMS)
+        ERROR("Cannot stream " + inp.get_name() + ": it has more than " +
+              std::to_string(TIRAMISU_IO_STREAM_MAX_DIMS) + " dimensions.", true);
+
+    // Collect the accesses of this computation to the streamed input.
+    std::vector<isl_map *> accesses;
+    generator::traverse_expr_and_extract_accesses(fn, this, this->get_expr(), accesses, false);
+    isl_map *access = NULL;
+    for (isl_map *acc : accesses)
+    {
+        const char *accessed = isl_map_get_tuple_name(acc, isl_dim_out);
+        if (accessed != NULL && std::string(accessed) == inp.get_name())
+            access = (access == NULL) ? acc : isl_map_union(access, acc);
+        else
+            isl_map_free(acc);
+    }
+    if (access == NULL)
+        ERROR("Computation " + this->get_name() + " does not access " + inp.get_name() + ".", true);
+    access = isl_map_intersect_domain(access, isl_set_copy(this->get_iteration_domain()));
+
+    isl_map *footprint = footprint_at_level(this, access, stream_level);
+
+    DEBUG(3, tiramisu::str_dump("Footprint of the streamed input: ", isl_map_to_str(footprint)));
+
+    // The ring holds the chunks of two consecutive iterations.
+    std::vector<int> chunk_shape;
+    isl_map *consecutive = isl_map_union(isl_map_copy(footprint), next_footprint(footprint));
+    bool constant = footprint_extents(consecutive, chunk_shape);
+    isl_map_free(consecutive);
+    if (!constant)
+    {
+        isl_map_free(footprint);
+        ERROR("The chunks of " + inp.get_name() + " streamed at level " + level.get_name() +
+              " do not have a constant size.", true);
+    }
+
+    DEBUG(3, tiramisu::str_dump("Chunk shape: ");
+             for (int s : chunk_shape) tiramisu::str_dump(std::to_string(s) + " "));
+
+    std::string name_prefix = "_" + this->get_name() + "_" + inp.get_name();
+    std::vector<expr> buff_shape(chunk_shape.begin(), chunk_shape.end());
+    buffer *chunk = new buffer(name_prefix + "_chunk", buff_shape, inp.get_data_type(), a_temporary, fn);
+    buffer *status = new buffer(name_prefix + "_io_status", {1}, p_int32, a_temporary, fn);
+
+    // Read the ring instead of the input
+    std::vector<var> access_variables;
+    std::vector<expr> access_exprs;
+    for (int i = 0; i < inp.access_variables.size(); i++) {
+        var v = var(inp.access_variables[i].second, false);
+        access_variables.push_back(v);
+        access_exprs.push_back(v % chunk_shape[i]);
+    }
+    input *new_access = new input(name_prefix + "_streamed", access_variables, inp.get_data_type());
+    new_access->store_in(chunk, access_exprs);
+    this->set_expression(this->expression.substitute_access(inp.get_name(), new_access->get_name()));
+
+    // Wait for the chunk before the first computation in the level, and issue
+    // the read of the chunk of the next iteration before the wait.
+    isl_set *domain = isl_map_domain(isl_map_copy(footprint));
+    computation *wait = io_stream_computation(fn, name_prefix + "_stream_wait", domain,
+            io_stream_call("tiramisu_io_stream_wait", stream, chunk, footprint, chunk_shape), status);
+    computation *read = io_stream_computation(fn, name_prefix + "_stream_read", domain,
+            io_stream_call("tiramisu_io_stream_read", stream, chunk, footprint, chunk_shape), status);
+    computation *flush = new computation("{" + name_prefix + "_stream_flush[0]}",
+            expr(o_call, "tiramisu_io_stream_flush", {expr((int32_t) stream)}, p_int32), true, p_int32, fn);
+    flush->store_in(status, {0});
+    isl_set_free(domain);
+    isl_map_free(footprint);
+
+    this->schedule_at_level_boundary(wait, stream_level, false);
+    wait->schedule_at_level_boundary(read, stream_level, false);
+    read->shift(stream_level, -1);
+    this->schedule_at_level_boundary(flush, computation::root_dimension, true);
+
+    DEBUG_INDENT(-4);
+
+    return read;
+}
+
+computation *computation::stream_output(const var &level, int stream)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    function *fn = this->get_function();
+
+    std::vector<int> dimensions = this->get_loop_level_numbers_from_dimension_names({level.get_name()});
+    assert(dimensions.size() == 1);
+    int stream_level = dimensions[0];
+    for (int l = 0; l <= stream_level; l++)
+        if (fn->should_parallelize(this->get_name(), l))
+            ERROR("The loops of " + this->get_name() + " up to the stream level " + level.get_name() +
+                  " cannot be parallel.", true);
+
+    isl_map *access = isl_map_intersect_domain(isl_map_copy(this->get_access_relation()),
+                                               isl_set_copy(this->get_iteration_domain()));
+    std::string sink_name = isl_map_get_tuple_name(access, isl_dim_out);
+    int n_dims = isl_map_dim(access, isl_dim_out);
+    if (n_dims > TIRAMISU_IO_STREAM_MAX_DIMS)
+        ERROR("Cannot stream " + sink_name + ": it has more than " +
+              std::to_string(TIRAMISU_IO_STREAM_MAX_DIMS) + " dimensions.", true);
+    buffer *sink = fn->get_buffers().at(sink_name);
+
+    isl_map *footprint = footprint_at_level(this, access, stream_level);
+
+    DEBUG(3, tiramisu::str_dump("Footprint of the streamed output: ", isl_map_to_str(footprint)));
+
+    // The chunk of an iteration is written while the next one is computed.
+    isl_map *consecutive = isl_map_intersect(isl_map_copy(footprint), next_footprint(footprint));
+    bool disjoint = isl_map_is_empty(consecutive);
+    isl_map_free(consecutive);
+    if (!disjoint)
+    {
+        isl_map_free(footprint);
+        ERROR("Consecutive iterations of the stream level " + level.get_name() + " of " +
+              this->get_name() + " store the same elements of " + sink_name + ".", true);
+    }
+
+    std::vector<int> chunk_shape;
+    consecutive = isl_map_union(isl_map_copy(footprint), next_footprint(footprint));
+    bool constant = footprint_extents(consecutive, chunk_shape);
+    isl_map_free(consecutive);
+    if (!constant)
+    {
+        isl_map_free(footprint);
+        ERROR("The chunks of " + sink_name + " streamed at level " + level.get_name() +
+              " do not have a constant size.", true);
+    }
+
+    DEBUG(3, tiramisu::str_dump("Chunk shape: ");
+             for (int s : chunk_shape) tiramisu::str_dump(std::to_string(s) + " "));
+
+    std::string name_prefix = "_" + this->get_name() + "_" + sink_name;
+    std::vector<expr> buff_shape(chunk_shape.begin(), chunk_shape.end());
+    buffer *chunk = new buffer(name_prefix + "_chunk", buff_shape, sink->get_elements_type(), a_temporary, fn);
+    buffer *status = new buffer(name_prefix + "_io_status", {1}, p_int32, a_temporary, fn);
+    if (sink->get_argument_type() == a_temporary)
+        sink->set_auto_allocate(false);
+
+    // Store into the ring instead of the output buffer
+    std::string in_dims, out_dims;
+    for (int i = 0; i < n_dims; i++)
+    {
+        std::string x = "x" + std::to_string(i);
+        in_dims += (i > 0 ? ", " : "") + x;
+        out_dims += (i > 0 ? ", " : "") + x + " mod " + std::to_string(chunk_shape[i]);
+    }
+    isl_map *to_chunk = isl_map_read_from_str(this->get_ctx(),
+            ("{" + sink_name + "[" + in_dims + "] -> " + chunk->get_name() + "[" + out_dims + "]}").c_str());
+    isl_map *new_access = isl_map_apply_range(isl_map_copy(this->get_access_relation()), to_chunk);
+    this->set_access(new_access);
+    isl_map_free(new_access);
+
+    // Wait until the ring positions of the iteration are free before the
+    // first computation in the level, and write the chunk after the last one.
+    isl_set *domain = isl_map_domain(isl_map_copy(footprint));
+    computation *wait = io_stream_computation(fn, name_prefix + "_stream_wait", domain,
+            io_stream_call("tiramisu_io_stream_wait", stream, chunk, footprint, chunk_shape), status);
+    computation *write = io_stream_computation(fn, name_prefix + "_stream_write", domain,
+            io_stream_call("tiramisu_io_stream_write", stream, chunk, footprint, chunk_shape), status);
+    computation *flush = new computation("{" + name_prefix + "_stream_flush[0]}",
+            expr(o_call, "tiramisu_io_stream_flush", {expr((int32_t) stream)}, p_int32), true, p_int32, fn);
+    flush->store_in(status, {0});
+    isl_set_free(domain);
+    isl_map_free(footprint);
+
+    this->schedule_at_level_boundary(wait, stream_level, false);
+    this->schedule_at_level_boundary(write, stream_level, true);
+    write->schedule_at_level_boundary(flush, computation::root_dimension, true);
+
+    DEBUG_INDENT(-4);
+
+    return write;
+}
+
 }
@@ -6,6 +6,13 @@
 #include <cstdint>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
 #include "cublas_v2.h"
 
 using size_type = uint64_t;
@@ -29,11 +36,134 @@ namespace {
             exit(1);
         }
     }
+
+    std::mutex streams_mutex;
+    // The streams of every GPU, indexed by <device, stream number>
+    std::map<std::pair<int, int32_t>, cudaStream_t> streams;
+    std::set<int> used_devices;
+    std::set<void *> pinned_buffers;
+
+    inline int current_device()
+    {
+        int device;
+        handle_cuda_error(cudaGetDevice(&device), "cudaGetDevice");
+        return device;
+    }
+
+    // The number of GPUs.  Peer-to-peer access is enabled between all the
+    // GPUs that support it the first time it is called.
+    int device_count()
+    {
+        static std::once_flag initialized;
+        static int count = 1;
+        std::call_once(initialized, [] {
+            handle_cuda_error(cudaGetDeviceCount(&count), "cudaGetDeviceCount");
+            int caller = current_device();
+            for (int i = 0; i < count; i++)
+            {
+                handle_cuda_error(cudaSetDevice(i), "cudaSetDevice");
+                for (int j = 0; j < count; j++)
+                {
+                    int can_access = 0;
+                    if (i != j && cudaDeviceCanAccessPeer(&can_access, i, j) == cudaSuccess && can_access)
+                    {
+                        // Peer access may already have been enabled by the user program
+                        if (cudaDeviceEnablePeerAccess(j, 0) != cudaSuccess)
+                            cudaGetLastError();
+                    }
+                }
+            }
+            handle_cuda_error(cudaSetDevice(caller), "cudaSetDevice");
+        });
+        return count;
+    }
+
+    // Page-lock a host buffer the first time it is copied asynchronously, so
+    // that the copy does not go through a pageable staging buffer.
+    void pin_host_buffer(void * ptr, uint64_t size)
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex);
+        if (pinned_buffers.insert(ptr).second)
+        {
+            // Buffers that are already page-locked (or cannot be) are copied as is.
+            // They are page-locked for all the GPUs, which may all copy them.
+            if (cudaHostRegister(ptr, size, cudaHostRegisterPortable) != cudaSuccess)
+                cudaGetLastError();
+        }
+    }
+
+    // The CUDA graph being captured by the calling thread, if any (see
+    // tiramisu_cuda_graph_begin()), with the device buffers freed during the
+    // capture, which are used by the graph.
+    struct graph_capture
+    {
+        cudaStream_t stream;
+        std::vector<void *> retained;
+    };
+    thread_local graph_capture * capture = nullptr;
+}
+
+/**
+ * Returns the CUDA stream number \p stream of the current GPU, creating it on
+ * first use.  Stream 0 is the default stream of the calling thread.  While the
+ * thread captures a CUDA graph, all the streams are the capturing stream.
+ */
+extern "C"
+cudaStream_t tiramisu_cuda_get_stream(int32_t stream)
+{
+    if (capture != nullptr)
+        return capture->stream;
+    if (stream == 0)
+        return cudaStreamPerThread;
+    auto key = std::make_pair(current_device(), stream);
+    std::lock_guard<std::mutex> lock(streams_mutex);
+    auto it = streams.find(key);
+    if (it == streams.end())
+    {
+        cudaStream_t s;
+        handle_cuda_error(cudaStreamCreate(&s), __FUNCTION__);
+        it = streams.insert(std::make_pair(key, s)).first;
+    }
+    return it->second;
+}
+
+/**
+ * Make \p waiting wait for the work issued so far on \p signaling.
+ */
+extern "C"
+int32_t tiramisu_cuda_stream_wait(int32_t waiting, int32_t signaling)
+{
+    // The captured work is already ordered on a single stream
+    if (capture != nullptr)
+        return 0;
+    cudaEvent_t event;
+    handle_cuda_error(cudaEventCreateWithFlags(&event, cudaEventDisableTiming), __FUNCTION__);
+    handle_cuda_error(cudaEventRecord(event, tiramisu_cuda_get_stream(signaling)), __FUNCTION__);
+    handle_cuda_error(cudaStreamWaitEvent(tiramisu_cuda_get_stream(waiting), event, 0), __FUNCTION__);
+    handle_cuda_error(cudaEventDestroy(event), __FUNCTION__);
+    return 0;
+}
+
+/**
+ * Return the address \p offset bytes after the GPU buffer \p ptr; used by
+ * the copies of a sub-region of a buffer.
+ */
+extern "C"
+void * tiramisu_cuda_offset_pointer(void * ptr, uint64_t offset)
+{
+    return static_cast<char *>(ptr) + offset;
 }
 
 extern "C"
 int tiramisu_cuda_memcpy_to_device(void * to, void * from, uint64_t size)
 {
+   // Synchronous copies cannot be captured in a graph
+   if (capture != nullptr)
+   {
+       pin_host_buffer(from, size);
+       handle_cuda_error(cudaMemcpyAsync(to, from, size, cudaMemcpyKind::cudaMemcpyHostToDevice, capture->stream), __FUNCTION__);
+       return 0;
+   }
    handle_cuda_error(cudaMemcpy(to, from, size, cudaMemcpyKind::cudaMemcpyHostToDevice), __FUNCTION__);
    return 0;
 }
@@ -41,32 +171,464 @@ int tiramisu_cuda_memcpy_to_device(void * to, void * from, uint64_t size)
 extern "C"
 int tiramisu_cuda_memcpy_to_host(void * to, void * from, uint64_t size)
 {
+    if (capture != nullptr)
+    {
+        pin_host_buffer(to, size);
+        handle_cuda_error(cudaMemcpyAsync(to, from, size, cudaMemcpyKind::cudaMemcpyDeviceToHost, capture->stream), __FUNCTION__);
+        return 0;
+    }
     handle_cuda_error(cudaMemcpy(to, from, size, cudaMemcpyKind::cudaMemcpyDeviceToHost), __FUNCTION__);
     return 0;
 }
 
+extern "C"
+int tiramisu_cuda_memcpy_to_device_async(void * to, void * from, uint64_t size, int32_t stream)
+{
+    pin_host_buffer(from, size);
+    handle_cuda_error(cudaMemcpyAsync(to, from, size, cudaMemcpyKind::cudaMemcpyHostToDevice,
+                                      tiramisu_cuda_get_stream(stream)), __FUNCTION__);
+    return 0;
+}
+
+extern "C"
+int tiramisu_cuda_memcpy_to_host_async(void * to, void * from, uint64_t size, int32_t stream)
+{
+    pin_host_buffer(to, size);
+    handle_cuda_error(cudaMemcpyAsync(to, from, size, cudaMemcpyKind::cudaMemcpyDeviceToHost,
+                                      tiramisu_cuda_get_stream(stream)), __FUNCTION__);
+    return 0;
+}
+
+/**
+ * Copy \p size bytes between two GPU buffers on the stream \p stream of the
+ * current GPU.  The buffers may be on different GPUs, in which case this is a
+ * peer-to-peer copy.
+ */
+extern "C"
+int tiramisu_cuda_memcpy_peer_async(void * to, void * from, uint64_t size, int32_t stream)
+{
+    handle_cuda_error(cudaMemcpyAsync(to, from, size, cudaMemcpyKind::cudaMemcpyDefault,
+                                      tiramisu_cuda_get_stream(stream)), __FUNCTION__);
+    return 0;
+}
+
 extern "C"
 int tiramisu_cuda_memcpy_to_symbol(void * to, void * from, uint64_t size)
 {
+    if (capture != nullptr)
+    {
+        pin_host_buffer(from, size);
+        handle_cuda_error(cudaMemcpyToSymbolAsync(to, from, size, 0, cudaMemcpyKind::cudaMemcpyHostToDevice, capture->stream),
+                          __FUNCTION__);
+        return 0;
+    }
     handle_cuda_error(cudaMemcpyToSymbol(to, from, size), __FUNCTION__);
     return 0;
 }
 
+namespace {
+    /**
+     * A caching allocator for device memory.  Freed blocks are kept in bins
+     * of rounded sizes and handed out again instead of calling cudaMalloc and
+     * cudaFree, which synchronize the device.
+     *
+     * A freed block may still be used by work in flight, so an event is
+     * recorded on the legacy default stream when it is freed; that event
+     * completes after all the work issued before on the blocking streams, and
+     * the block is only reused once the event has completed.  The blocks of
+     * every GPU are cached separately.
+     *
+     * Setting TIRAMISU_CUDA_MALLOC_ASYNC uses the stream-ordered allocator of
+     * the CUDA runtime (cudaMallocAsync) instead, with a memory pool that keeps
+     * freed memory.  Setting TIRAMISU_CUDA_NO_POOL calls cudaMalloc and
+     * cudaFree directly.
+     */
+    class device_memory_pool
+    {
+        struct block
+        {
+            uint64_t size;
+            cudaEvent_t freed;
+            int device;
+            // In managed memory, see allocate_partitioned() and allocate_managed()
+            bool managed;
+        };
+
+        enum class backend_t {pool, malloc_async, direct};
+
+        std::mutex mutex;
+        backend_t backend;
+        std::unordered_map<void *, block> blocks;
+        // The free blocks of every GPU, indexed by <device, bin size>
+        std::map<std::pair<int, uint64_t>, std::vector<void *>> free_blocks;
+        uint64_t in_use = 0, peak = 0, reserved = 0, device_allocations = 0;
+
+        // Sizes are rounded up to a power of two up to 1 MB, and to a
+        // multiple of 1 MB above, so that blocks are reused across calls
+        // whose buffer sizes differ slightly.
+        static uint64_t bin_size(uint64_t size)
+        {
+            const uint64_t large = 1 << 20;
+            if (size >= large)
+                return (size + large - 1) / large * large;
+            uint64_t bin = 256;
+            while (bin < size)
+                bin *= 2;
+            return bin;
+        }
+
+        void * allocate_on_device(uint64_t size)
+        {
+            void * result;
+            cudaError_t e = cudaMalloc(&result, size);
+            if (e == cudaErrorMemoryAllocation)
+            {
+                // Give the cached blocks back and try again
+                cudaGetLastError();
+                release_locked();
+                e = cudaMalloc(&result, size);
+            }
+            handle_cuda_error(e, "tiramisu_cuda_malloc");
+            device_allocations++;
+            return result;
+        }
+
+        void release_locked()
+        {
+            for (auto &bin : free_blocks)
+            {
+                for (void * ptr : bin.second)
+                {
+                    cudaEventSynchronize(blocks[ptr].freed);
+                    cudaEventDestroy(blocks[ptr].freed);
+                    handle_cuda_error(cudaFree(ptr), "tiramisu_cuda_release_cached_memory");
+                    reserved -= bin.first.second;
+                    blocks.erase(ptr);
+                }
+            }
+            free_blocks.clear();
+        }
+
+    public:
+        device_memory_pool()
+        {
+            backend = backend_t::pool;
+            if (getenv("TIRAMISU_CUDA_NO_POOL"))
+                backend = backend_t::direct;
+#if CUDART_VERSION >= 11020
+            else if (getenv("TIRAMISU_CUDA_MALLOC_ASYNC"))
+            {
+                int device, supported = 0;
+                cudaGetDevice(&device);
+                cudaDeviceGetAttribute(&supported, cudaDevAttrMemoryPoolsSupported, device);
+                if (supported)
+                {
+                    cudaMemPool_t pool;
+                    cudaDeviceGetDefaultMemPool(&pool, device);
+                    uint64_t threshold = UINT64_MAX;
+                    cudaMemPoolSetAttribute(pool, cudaMemPoolAttrReleaseThreshold, &threshold);
+                    backend = backend_t::malloc_async;
+                }
+            }
+#endif
+        }
+
+        void * allocate(uint64_t size)
+        {
+            int device = current_device();
+            std::lock_guard<std::mutex> lock(mutex);
+            void * result = nullptr;
+            uint64_t bin = bin_size(size);
+            switch (backend)
+            {
+                case backend_t::direct:
+                    result = allocate_on_device(size);
+                    bin = size;
+                    reserved += size;
+                    break;
+#if CUDART_VERSION >= 11020
+                case backend_t::malloc_async:
+                    handle_cuda_error(cudaMallocAsync(&result, size, 0), "tiramisu_cuda_malloc");
+                    bin = size;
+                    break;
+#endif
+                default:
+                {
+                    auto &candidates = free_blocks[std::make_pair(device, bin)];
+                    for (auto it = candidates.begin(); it != candidates.end(); ++it)
+                    {
+                        if (cudaEventQuery(blocks[*it].freed) == cudaSuccess)
+                        {
+                            result = *it;
+                            candidates.erase(it);
+                            break;
+                        }
+                    }
+                    if (result == nullptr)
+                    {
+                        result = allocate_on_device(bin);
+                        block b;
+                        b.size = bin;
+                        b.device = device;
+                        b.managed = false;
+                        handle_cuda_error(cudaEventCreateWithFlags(&b.freed, cudaEventDisableTiming), "tiramisu_cuda_malloc");
+                        blocks[result] = b;
+                        reserved += bin;
+                    }
+                }
+            }
+            if (backend != backend_t::pool)
+                blocks[result] = block{bin, nullptr, device, false};
+            in_use += bin;
+            peak = std::max(peak, in_use);
+            return result;
+        }
+
+        // Allocate managed memory split in \p partitions slices of equal size,
+        // the slice p being placed on the GPU p modulo the number of GPUs and
+        // mapped on the other GPUs, so that they read it without migrating
+        // its pages.  These blocks are not cached.
+        void * allocate_partitioned(uint64_t size, int partitions)
+        {
+            int count = device_count();
+            std::lock_guard<std::mutex> lock(mutex);
+            char * result;
+            handle_cuda_error(cudaMallocManaged((void **) &result, size), "tiramisu_cuda_malloc_partitioned");
+            uint64_t slice = (size + partitions - 1) / partitions;
+            for (int p = 0; p < partitions && p * slice < size; p++)
+            {
+                uint64_t length = std::min(slice, size - p * slice);
+                int device = p % count;
+                handle_cuda_error(cudaMemAdvise(result + p * slice, length, cudaMemAdviseSetPreferredLocation, device),
+                                  "tiramisu_cuda_malloc_partitioned");
+                for (int d = 0; d < count; d++)
+                    handle_cuda_error(cudaMemAdvise(result + p * slice, length, cudaMemAdviseSetAccessedBy, d),
+                                      "tiramisu_cuda_malloc_partitioned");
+                handle_cuda_error(cudaMemPrefetchAsync(result + p * slice, length, device, 0),
+                                  "tiramisu_cuda_malloc_partitioned");
+            }
+            blocks[result] = block{size, nullptr, -1, true};
+            device_allocations++;
+            reserved += size;
+            in_use += size;
+            peak = std::max(peak, in_use);
+            return result;
+        }
+
+        // Allocate managed memory, with the advice \p advice (a
+        // tiramisu::managed_advice_t) for the current GPU.  These blocks
+        // are not cached either.
+        void * allocate_managed(uint64_t size, int32_t advice)
+        {
+            int device = current_device();
+            std::lock_guard<std::mutex> lock(mutex);
+            void * result;
+            handle_cuda_error(cudaMallocManaged(&result, size), "tiramisu_cuda_malloc_managed");
+            switch (advice)
+            {
+                case 2: // managed_read_mostly
+                    handle_cuda_error(cudaMemAdvise(result, size, cudaMemAdviseSetReadMostly, device),
+                                      "tiramisu_cuda_malloc_managed");
+                    break;
+                case 3: // managed_prefer_device
+                    handle_cuda_error(cudaMemAdvise(result, size, cudaMemAdviseSetPreferredLocation, device),
+                                      "tiramisu_cuda_malloc_managed");
+                    break;
+                case 4: // managed_prefer_host
+                    handle_cuda_error(cudaMemAdvise(result, size, cudaMemAdviseSetPreferredLocation, cudaCpuDeviceId),
+                                      "tiramisu_cuda_malloc_managed");
+                    handle_cuda_error(cudaMemAdvise(result, size, cudaMemAdviseSetAccessedBy, device),
+                                      "tiramisu_cuda_malloc_managed");
+                    break;
+                default:
+                    break;
+            }
+            blocks[result] = block{size, nullptr, device, true};
+            device_allocations++;
+            reserved += size;
+            in_use += size;
+            peak = std::max(peak, in_use);
+            return result;
+        }
+
+        void free(void * ptr)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = blocks.find(ptr);
+            if (it == blocks.end())
+            {
+                std::cerr << "Error at tiramisu_cuda_free: " << ptr << " was not allocated by tiramisu_cuda_malloc." << std::endl;
+                exit(1);
+            }
+            in_use -= it->second.size;
+            if (it->second.managed)
+            {
+                handle_cuda_error(cudaFree(ptr), "tiramisu_cuda_free");
+                reserved -= it->second.size;
+                blocks.erase(it);
+                return;
+            }
+            switch (backend)
+            {
+                case backend_t::direct:
+                    handle_cuda_error(cudaFree(ptr), "tiramisu_cuda_free");
+                    reserved -= it->second.size;
+                    blocks.erase(it);
+                    break;
+#if CUDART_VERSION >= 11020
+                case backend_t::malloc_async:
+                    handle_cuda_error(cudaFreeAsync(ptr, 0), "tiramisu_cuda_free");
+                    blocks.erase(it);
+                    break;
+#endif
+                default:
+                {
+                    // The event and the legacy stream must be those of the GPU of the block
+                    int device = current_device();
+                    if (device != it->second.device)
+                        handle_cuda_error(cudaSetDevice(it->second.device), "tiramisu_cuda_free");
+                    handle_cuda_error(cudaEventRecord(it->second.freed, 0), "tiramisu_cuda_free");
+                    if (device != it->second.device)
+                        handle_cuda_error(cudaSetDevice(device), "tiramisu_cuda_free");
+                    free_blocks[std::make_pair(it->second.device, it->second.size)].push_back(ptr);
+                }
+            }
+        }
+
+        void release()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            release_locked();
+        }
+
+        void stats(uint64_t * in_use, uint64_t * peak, uint64_t * reserved, uint64_t * device_allocations)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            *in_use = this->in_use;
+            *peak = this->peak;
+            *reserved = this->reserved;
+            *device_allocations = this->device_allocations;
+        }
+    };
+
+    // Never destroyed: blocks may be freed by static destructors of the user
+    // program, and the CUDA runtime may already be torn down at exit.
+    device_memory_pool & get_device_memory_pool()
+    {
+        static device_memory_pool * pool = new device_memory_pool;
+        return *pool;
+    }
+}
+
 extern "C"
 void * tiramisu_cuda_malloc(uint64_t size)
 {
-    void * result;
-    handle_cuda_error(cudaMalloc(&result, size), __FUNCTION__);
-    return result;
+    return get_device_memory_pool().allocate(size);
+}
+
+/**
+ * Allocate \p size bytes of GPU memory split in \p partitions slices placed on
+ * the different GPUs (see buffer::set_gpu_partitions()).  The memory is freed
+ * by tiramisu_cuda_free().
+ */
+extern "C"
+void * tiramisu_cuda_malloc_partitioned(uint64_t size, int32_t partitions)
+{
+    return get_device_memory_pool().allocate_partitioned(size, partitions);
+}
+
+/**
+ * Allocate \p size bytes of managed memory, with the cudaMemAdvise() hint
+ * \p advice (see buffer::set_gpu_managed()).  The memory is freed by
+ * tiramisu_cuda_free().
+ */
+extern "C"
+void * tiramisu_cuda_malloc_managed(uint64_t size, int32_t advice)
+{
+    return get_device_memory_pool().allocate_managed(size, advice);
+}
+
+/**
+ * Migrate the \p size bytes of managed memory at \p ptr to the current GPU,
+ * asynchronously on the stream \p stream.  Devices without concurrent
+ * managed access ignore the prefetch, their pages migrate on demand.
+ */
+extern "C"
+int tiramisu_cuda_prefetch_to_device(void * ptr, uint64_t size, int32_t stream)
+{
+    int device = current_device();
+    int concurrent = 0;
+    cudaDeviceGetAttribute(&concurrent, cudaDevAttrConcurrentManagedAccess, device);
+    if (concurrent && size > 0)
+        handle_cuda_error(cudaMemPrefetchAsync(ptr, size, device, tiramisu_cuda_get_stream(stream)), __FUNCTION__);
+    return 0;
 }
 
 extern "C"
 int tiramisu_cuda_free(void * ptr)
 {
-    handle_cuda_error(cudaFree(ptr), __FUNCTION__);
+    // The buffers of a graph live as long as the graph
+    if (capture != nullptr)
+    {
+        capture->retained.push_back(ptr);
+        return 0;
+    }
+    get_device_memory_pool().free(ptr);
+    return 0;
+}
+
+/**
+ * Free the device memory cached by tiramisu_cuda_free().
+ */
+extern "C"
+int tiramisu_cuda_release_cached_memory()
+{
+    get_device_memory_pool().release();
+    return 0;
+}
+
+/**
+ * Statistics of the device memory allocated by tiramisu_cuda_malloc(), in
+ * bytes: the memory currently allocated, its peak, the memory reserved on the
+ * device (allocated or cached), and the number of actual device allocations.
+ * With TIRAMISU_CUDA_MALLOC_ASYNC, the reserved memory and the device
+ * allocations are managed by the CUDA runtime and are not counted.
+ */
+extern "C"
+int tiramisu_cuda_memory_stats(uint64_t * in_use, uint64_t * peak, uint64_t * reserved, uint64_t * device_allocations)
+{
+    get_device_memory_pool().stats(in_use, peak, reserved, device_allocations);
     return 0;
 }
 
+namespace {
+    // cuBLAS handles must not be used by several threads at the same time, so
+    // each thread creates its own, bound to its default stream.  A handle is
+    // tied to the GPU it was created on, so there is one per GPU.
+    struct cublas_handle_holder
+    {
+        std::map<int, cublasHandle_t> handles;
+        ~cublas_handle_holder()
+        {
+            for (auto &h : handles)
+                cublasDestroy(h.second);
+        }
+    };
+
+    cublasHandle_t get_cublas_handle()
+    {
+        thread_local cublas_handle_holder holder;
+        cublasHandle_t &handle = holder.handles[current_device()];
+        if (handle == nullptr)
+        {
+            handle_cublas_error(cublasCreate(&handle), "cublasCreate");
+        }
+        // The default stream of the thread, or the stream of a graph capture
+        cublasSetStream(handle, tiramisu_cuda_get_stream(0));
+        return handle;
+    }
+}
+
 /**
  * This is a reduced interface for the cuBLAS GEMM API.
  * It multiplies row-major matrices A and B of size MxK and KxN.
@@ -79,13 +641,7 @@ int tiramisu_cublas_sgemm(float *A, float *B, float *C,
                           uint64_t offsetA, uint64_t offsetB, uint64_t offsetC,
                           bool transposeA, bool transposeB)
 {
-    // TODO: Destroy the handle.
-    static bool handle_created = false;
-    static cublasHandle_t handle;
-    if (!handle_created) {
-        cublasCreate(&handle);
-        handle_created = true;
-    }
+    cublasHandle_t handle = get_cublas_handle();
     // Default values for tight packing:
     if (ldA == 0) {
         ldA = transposeA ? M : K;
@@ -102,7 +658,6 @@ int tiramisu_cublas_sgemm(float *A, float *B, float *C,
     // transposes the output again: cublas(A, B) = ((A^T)x(B^T))^T = BxA
     // So it is actually equivalent to row-major GEMM with inputs swapped.
     // We need to reorder the size parameters as well to make it work:
-    cublasSetStream(handle, cudaStreamPerThread);
     handle_cublas_error(
         cublasSgemm(handle,
                     transposeB ? CUBLAS_OP_T : CUBLAS_OP_N,
@@ -126,13 +681,7 @@ int tiramisu_cublas_dgemm(double *A, double *B, double *C,
                           uint64_t offsetA, uint64_t offsetB, uint64_t offsetC,
                           bool transposeA, bool transposeB)
 {
-    // TODO: Destroy the handle.
-    static bool handle_created = false;
-    static cublasHandle_t handle;
-    if (!handle_created) {
-        cublasCreate(&handle);
-        handle_created = true;
-    }
+    cublasHandle_t handle = get_cublas_handle();
     // Default values for tight packing:
     if (ldA == 0) {
         ldA = transposeA ? M : K;
@@ -149,7 +698,6 @@ int tiramisu_cublas_dgemm(double *A, double *B, double *C,
     // transposes the output again: cublas(A, B) = ((A^T)x(B^T))^T = BxA
     // So it is actually equivalent to row-major GEMM with inputs swapped.
     // We need to reorder the size parameters as well to make it work:
-    cublasSetStream(handle, cudaStreamPerThread);
     handle_cublas_error(
         cublasDgemm(handle,
                     transposeB ? CUBLAS_OP_T : CUBLAS_OP_N,
@@ -161,10 +709,330 @@ int tiramisu_cublas_dgemm(double *A, double *B, double *C,
     return 0;
 }
 
+/**
+ * This is a reduced interface for the cuBLAS strided batched GEMM API.
+ * It multiplies \p batch pairs of row-major matrices A and B of size MxK and
+ * KxN; the matrices of a batch start \p strideA, \p strideB and \p strideC
+ * elements after those of the previous one (0 means tightly packed).
+ */
+extern "C"
+int tiramisu_cublas_sgemm_strided_batched(float *A, float *B, float *C,
+                                          uint64_t M, uint64_t N, uint64_t K,
+                                          float alpha, float beta,
+                                          uint64_t ldA, uint64_t ldB, uint64_t ldC,
+                                          uint64_t offsetA, uint64_t offsetB, uint64_t offsetC,
+                                          uint64_t strideA, uint64_t strideB, uint64_t strideC,
+                                          uint64_t batch,
+                                          bool transposeA, bool transposeB)
+{
+    cublasHandle_t handle = get_cublas_handle();
+    // Default values for tight packing:
+    if (ldA == 0) {
+        ldA = transposeA ? M : K;
+    }
+    if (ldB == 0) {
+        ldB = transposeB ? K : N;
+    }
+    if (ldC == 0) {
+        ldC = N;
+    }
+    if (strideA == 0) {
+        strideA = (transposeA ? K : M) * ldA;
+    }
+    if (strideB == 0) {
+        strideB = (transposeB ? N : K) * ldB;
+    }
+    if (strideC == 0) {
+        strideC = M * ldC;
+    }
+    // Row-major GEMM with inputs swapped, see tiramisu_cublas_sgemm.
+    handle_cublas_error(
+        cublasSgemmStridedBatched(handle,
+                                  transposeB ? CUBLAS_OP_T : CUBLAS_OP_N,
+                                  transposeA ? CUBLAS_OP_T : CUBLAS_OP_N,
+                                  N, M, K,
+                                  &alpha, B + offsetB, ldB, strideB, A + offsetA, ldA, strideA,
+                                  &beta, C + offsetC, ldC, strideC, batch),
+         __FUNCTION__);
+    return 0;
+}
+
+/**
+ * This is a reduced interface for the cuBLAS strided batched GEMM API.
+ * It multiplies \p batch pairs of row-major matrices A and B of size MxK and
+ * KxN; the matrices of a batch start \p strideA, \p strideB and \p strideC
+ * elements after those of the previous one (0 means tightly packed).
+ */
+extern "C"
+int tiramisu_cublas_dgemm_strided_batched(double *A, double *B, double *C,
+                                          uint64_t M, uint64_t N, uint64_t K,
+                                          double alpha, double beta,
+                                          uint64_t ldA, uint64_t ldB, uint64_t ldC,
+                                          uint64_t offsetA, uint64_t offsetB, uint64_t offsetC,
+                                          uint64_t strideA, uint64_t strideB, uint64_t strideC,
+                                          uint64_t batch,
+                                          bool transposeA, bool transposeB)
+{
+    cublasHandle_t handle = get_cublas_handle();
+    // Default values for tight packing:
+    if (ldA == 0) {
+        ldA = transposeA ? M : K;
+    }
+    if (ldB == 0) {
+        ldB = transposeB ? K : N;
+    }
+    if (ldC == 0) {
+        ldC = N;
+    }
+    if (strideA == 0) {
+        strideA = (transposeA ? K : M) * ldA;
+    }
+    if (strideB == 0) {
+        strideB = (transposeB ? N : K) * ldB;
+    }
+    if (strideC == 0) {
+        strideC = M * ldC;
+    }
+    // Row-major GEMM with inputs swapped, see tiramisu_cublas_sgemm.
+    handle_cublas_error(
+        cublasDgemmStridedBatched(handle,
+                                  transposeB ? CUBLAS_OP_T : CUBLAS_OP_N,
+                                  transposeA ? CUBLAS_OP_T : CUBLAS_OP_N,
+                                  N, M, K,
+                                  &alpha, B + offsetB, ldB, strideB, A + offsetA, ldA, strideA,
+                                  &beta, C + offsetC, ldC, strideC, batch),
+         __FUNCTION__);
+    return 0;
+}
+
+namespace {
+    // Wait for the work issued on the streams of every GPU used so far, and
+    // on the default streams of the calling thread.
+    void synchronize_devices()
+    {
+        int caller = current_device();
+        std::set<int> devices = {caller};
+        {
+            std::lock_guard<std::mutex> lock(streams_mutex);
+            for (auto &s : streams)
+                handle_cuda_error(cudaStreamSynchronize(s.second), "tiramisu_cuda_stream_synchronize");
+            devices.insert(used_devices.begin(), used_devices.end());
+        }
+        for (int device : devices)
+        {
+            handle_cuda_error(cudaSetDevice(device), "tiramisu_cuda_stream_synchronize");
+            handle_cuda_error(cudaStreamSynchronize(cudaStreamPerThread), "tiramisu_cuda_stream_synchronize");
+            handle_cuda_error(cudaStreamSynchronize(0), "tiramisu_cuda_stream_synchronize");
+        }
+        handle_cuda_error(cudaSetDevice(caller), "tiramisu_cuda_stream_synchronize");
+    }
+}
+
 extern "C"
 int32_t tiramisu_cuda_stream_synchronize(int32_t dummy)
 {
-    cudaStreamSynchronize(0);
+    // The host waits for the captured work when the graph is launched
+    if (capture != nullptr)
+        return 0;
+    synchronize_devices();
+    return 0;
+}
+
+namespace {
+    // The GPU of the calling thread before it entered a loop distributed
+    // across the GPUs
+    thread_local int device_loop_caller = -1;
+}
+
+/**
+ * Start a loop distributed across the GPUs (see
+ * computation::tag_gpu_device_level()): wait for the work issued before it,
+ * which may have been issued on another GPU than the one of an iteration.
+ */
+extern "C"
+int32_t tiramisu_cuda_device_loop_begin(int32_t dummy)
+{
+    device_loop_caller = current_device();
+    synchronize_devices();
+    return 0;
+}
+
+/**
+ * Run the next iterations of a loop distributed across the GPUs on the GPU
+ * \p iteration modulo the number of GPUs.
+ */
+extern "C"
+int32_t tiramisu_cuda_set_device(int32_t iteration)
+{
+    int count = device_count();
+    int device = (iteration % count + count) % count;
+    handle_cuda_error(cudaSetDevice(device), __FUNCTION__);
+    std::lock_guard<std::mutex> lock(streams_mutex);
+    used_devices.insert(device);
+    return 0;
+}
+
+/**
+ * End a loop distributed across the GPUs: wait for the work issued on every
+ * GPU, and go back to the GPU that was used before the loop.
+ */
+extern "C"
+int32_t tiramisu_cuda_device_loop_end(int32_t dummy)
+{
+    synchronize_devices();
+    handle_cuda_error(cudaSetDevice(device_loop_caller), __FUNCTION__);
+    device_loop_caller = -1;
+    return 0;
+}
+
+
+namespace {
+    // The events of tiramisu_cuda_timer_start() and tiramisu_cuda_timer_stop()
+    thread_local cudaEvent_t timer_start_event = nullptr;
+    thread_local cudaEvent_t timer_stop_event = nullptr;
+}
+
+/**
+ * Start measuring the time spent on the GPU, e.g. in the wrappers used by
+ * auto_scheduler::evaluate_by_cuda: wait for the work issued before, and
+ * record an event on the default stream of the calling thread.
+ */
+extern "C"
+int32_t tiramisu_cuda_timer_start(int32_t dummy)
+{
+    if (timer_start_event == nullptr)
+    {
+        handle_cuda_error(cudaEventCreate(&timer_start_event), __FUNCTION__);
+        handle_cuda_error(cudaEventCreate(&timer_stop_event), __FUNCTION__);
+    }
+    synchronize_devices();
+    handle_cuda_error(cudaEventRecord(timer_start_event, cudaStreamPerThread), __FUNCTION__);
+    return 0;
+}
+
+/**
+ * Return the time in milliseconds elapsed on the GPU since the last call to
+ * tiramisu_cuda_timer_start(), once the work issued on every stream is done.
+ */
+extern "C"
+float tiramisu_cuda_timer_stop(int32_t dummy)
+{
+    float milliseconds = 0;
+    synchronize_devices();
+    handle_cuda_error(cudaEventRecord(timer_stop_event, cudaStreamPerThread), __FUNCTION__);
+    handle_cuda_error(cudaEventSynchronize(timer_stop_event), __FUNCTION__);
+    handle_cuda_error(cudaEventElapsedTime(&milliseconds, timer_start_event, timer_stop_event), __FUNCTION__);
+    return milliseconds;
+}
+
+namespace {
+    struct cuda_graph
+    {
+        cudaGraphExec_t exec;
+        std::vector<void *> retained;
+    };
+
+    std::mutex graphs_mutex;
+    std::map<std::pair<std::string, uint64_t>, cuda_graph> graphs;
+}
+
+/**
+ * Combine \p seed with a pointer or an integer, to compute the key of the
+ * CUDA graph of a call (see function::enable_cuda_graph()).
+ */
+extern "C"
+uint64_t tiramisu_cuda_graph_hash_pointer(uint64_t seed, void * ptr)
+{
+    return (seed ^ reinterpret_cast<uintptr_t>(ptr)) * 1099511628211ULL + 0x9e3779b97f4a7c15ULL;
+}
+
+extern "C"
+uint64_t tiramisu_cuda_graph_hash_int(uint64_t seed, int64_t value)
+{
+    return (seed ^ static_cast<uint64_t>(value)) * 1099511628211ULL + 0x9e3779b97f4a7c15ULL;
+}
+
+/**
+ * Returns 0 if the CUDA graph \p key of the function \p name exists, in which
+ * case the function only launches it.  Otherwise, starts capturing the work
+ * of the calling thread, and returns 1 so that the function issues it.
+ * With TIRAMISU_CUDA_NO_GRAPH, nothing is captured and 1 is returned.
+ */
+extern "C"
+int32_t tiramisu_cuda_graph_begin(const char * name, uint64_t key)
+{
+    if (getenv("TIRAMISU_CUDA_NO_GRAPH") || capture != nullptr)
+        return 1;
+    {
+        std::lock_guard<std::mutex> lock(graphs_mutex);
+        if (graphs.find(std::make_pair(std::string(name), key)) != graphs.end())
+            return 0;
+    }
+    capture = new graph_capture;
+    handle_cuda_error(cudaStreamCreateWithFlags(&capture->stream, cudaStreamNonBlocking), __FUNCTION__);
+    // The device allocations of the function are made while capturing
+    handle_cuda_error(cudaStreamBeginCapture(capture->stream, cudaStreamCaptureModeRelaxed), __FUNCTION__);
+    return 1;
+}
+
+/**
+ * Ends the capture started by tiramisu_cuda_graph_begin() and instantiates
+ * the graph.
+ */
+extern "C"
+int32_t tiramisu_cuda_graph_end(const char * name, uint64_t key)
+{
+    if (capture == nullptr)
+        return 0;
+    cudaGraph_t graph;
+    cuda_graph result;
+    handle_cuda_error(cudaStreamEndCapture(capture->stream, &graph), __FUNCTION__);
+    handle_cuda_error(cudaGraphInstantiate(&result.exec, graph, nullptr, nullptr, 0), __FUNCTION__);
+    handle_cuda_error(cudaGraphDestroy(graph), __FUNCTION__);
+    handle_cuda_error(cudaStreamDestroy(capture->stream), __FUNCTION__);
+    result.retained = std::move(capture->retained);
+    delete capture;
+    capture = nullptr;
+
+    std::lock_guard<std::mutex> lock(graphs_mutex);
+    graphs[std::make_pair(std::string(name), key)] = std::move(result);
+    return 0;
+}
+
+/**
+ * Launches the CUDA graph \p key of the function \p name, if any, on the
+ * default stream of the thread and waits for it.
+ */
+extern "C"
+int32_t tiramisu_cuda_graph_launch(const char * name, uint64_t key)
+{
+    cudaGraphExec_t exec;
+    {
+        std::lock_guard<std::mutex> lock(graphs_mutex);
+        auto it = graphs.find(std::make_pair(std::string(name), key));
+        if (it == graphs.end())
+            return 0;
+        exec = it->second.exec;
+    }
+    handle_cuda_error(cudaGraphLaunch(exec, cudaStreamPerThread), __FUNCTION__);
+    handle_cuda_error(cudaStreamSynchronize(cudaStreamPerThread), __FUNCTION__);
     return 0;
 }
 
+/**
+ * Destroys all the CUDA graphs and frees the device buffers they use.
+ */
+extern "C"
+int32_t tiramisu_cuda_graph_reset()
+{
+    std::lock_guard<std::mutex> lock(graphs_mutex);
+    handle_cuda_error(cudaDeviceSynchronize(), __FUNCTION__);
+    for (auto &g : graphs)
+    {
+        handle_cuda_error(cudaGraphExecDestroy(g.second.exec), __FUNCTION__);
+        for (void * ptr : g.second.retained)
+            get_device_memory_pool().free(ptr);
+    }
+    graphs.clear();
+    return 0;
+}
@@ -4,7 +4,7 @@
 namespace tiramisu
 {
 
-int tiramisu_indentation = 0;
+thread_local int tiramisu_indentation = 0;
 
 void str_dump(const std::string &str)
 {
@@ -1,6 +1,9 @@
 #include <tiramisu/expr.h>
 #include <tiramisu/core.h>
 
+#include <functional>
+#include <mutex>
+
 namespace tiramisu
 {
 
@@ -147,6 +150,239 @@ tiramisu::expr tiramisu::expr::copy() const
     return (*this);
 }
 
+namespace
+{
+
+/**
+  * The hash-consed nodes of the expression lists, indexed by their hash.
+  */
+std::mutex &expr_list_table_mutex()
+{
+    // Never destroyed: expressions may be destroyed until the process exits
+    static std::mutex *mutex = new std::mutex();
+    return *mutex;
+}
+
+template <typename T>
+std::unordered_multimap<std::size_t, T *> &expr_list_table()
+{
+    static std::unordered_multimap<std::size_t, T *> *table = new std::unordered_multimap<std::size_t, T *>();
+    return *table;
+}
+
+void hash_combine(std::size_t &h, std::size_t v)
+{
+    h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2);
+}
+
+}
+
+expr_list::expr_list(const std::vector<tiramisu::expr> &vector)
+{
+    if (!vector.empty())
+    {
+        this->shared = std::make_shared<node>();
+        this->shared->elements = vector;
+    }
+}
+
+const std::vector<tiramisu::expr> &expr_list::empty_vector()
+{
+    static const std::vector<tiramisu::expr> *empty = new std::vector<tiramisu::expr>();
+    return *empty;
+}
+
+void expr_list::detach()
+{
+    if (!this->shared)
+        this->shared = std::make_shared<node>();
+    else if (this->shared->interned || this->shared.use_count() > 1)
+    {
+        std::shared_ptr<node> copy = std::make_shared<node>();
+        copy->elements = this->shared->elements;
+        this->shared = copy;
+    }
+    this->shared->hashed = false;
+}
+
+std::size_t expr_list::hash() const
+{
+    if (!this->shared)
+        return 0;
+
+    if (!this->shared->hashed)
+    {
+        std::size_t h = this->shared->elements.size();
+        for (const auto &e : this->shared->elements)
+            hash_combine(h, e.hash());
+        this->shared->hash = h;
+        this->shared->hashed = true;
+    }
+
+    return this->shared->hash;
+}
+
+void expr_list::intern()
+{
+    if (!this->shared || this->shared->interned)
+        return;
+
+    std::size_t h = this->hash();
+
+    // The candidates are compared and released outside of the lock, since
+    // releasing a node may destroy hash-consed nodes (a node being destroyed
+    // cannot be shared anymore).
+    std::vector<std::shared_ptr<node>> candidates;
+    {
+        std::lock_guard<std::mutex> lock(expr_list_table_mutex());
+        auto range = expr_list_table<node>().equal_range(h);
+        for (auto candidate = range.first; candidate != range.second; candidate++)
+            if (std::shared_ptr<node> other = candidate->second->weak_from_this().lock())
+                candidates.push_back(other);
+    }
+
+    std::shared_ptr<node> found;
+    for (const auto &other : candidates)
+    {
+        if (found || other->elements.size() != this->shared->elements.size())
+            continue;
+        bool equal = true;
+        for (size_t i = 0; i < other->elements.size() && equal; i++)
+            equal = expr::shallow_equal(other->elements[i], this->shared->elements[i]);
+        if (equal)
+            found = other;
+    }
+
+    if (!found)
+    {
+        // The hash-consed nodes leave the table when they are destroyed
+        found = std::shared_ptr<node>(new node(), [](node *n) {
+            {
+                std::lock_guard<std::mutex> lock(expr_list_table_mutex());
+                auto range = expr_list_table<node>().equal_range(n->hash);
+                for (auto entry = range.first; entry != range.second; entry++)
+                    if (entry->second == n)
+                    {
+                        expr_list_table<node>().erase(entry);
+                        break;
+                    }
+            }
+            delete n;
+        });
+        found->elements = this->shared->elements;
+        found->hash = h;
+        found->hashed = true;
+        found->interned = true;
+
+        std::lock_guard<std::mutex> lock(expr_list_table_mutex());
+        expr_list_table<node>().insert({h, found.get()});
+    }
+
+    this->shared = found;
+}
+
+bool expr::is_gather() const
+{
+    if (this->etype != tiramisu::e_op || this->_operator != tiramisu::o_access)
+        return false;
+
+    // Look for a load or a floating point computation in the indices
+    std::function<bool(const expr &)> is_data_dependent = [&](const expr &e) {
+        if (e.get_expr_type() != tiramisu::e_op)
+            return false;
+
+        if (e.get_op_type() == tiramisu::o_access || e.get_op_type() == tiramisu::o_call ||
+            e.get_op_type() == tiramisu::o_floor || e.get_op_type() == tiramisu::o_ceil ||
+            e.get_op_type() == tiramisu::o_round || e.get_op_type() == tiramisu::o_trunc)
+            return true;
+
+        if (e.get_op_type() == tiramisu::o_cast &&
+            (e.get_operand(0).get_data_type() == tiramisu::p_float32 ||
+             e.get_operand(0).get_data_type() == tiramisu::p_float64))
+            return true;
+
+        for (int i = 0; i < e.get_n_arg(); i++)
+            if (is_data_dependent(e.get_operand(i)))
+                return true;
+
+        return false;
+    };
+
+    for (const expr &index : this->get_access())
+        if (is_data_dependent(index))
+            return true;
+
+    return false;
+}
+
+expr bilinear(computation &in, const expr &y, const expr &x, const expr &height, const expr &width) {
+    expr y_floor = expr(o_floor, y);
+    expr x_floor = expr(o_floor, x);
+    expr y_frac = y - y_floor;
+    expr x_frac = x - x_floor;
+
+    expr y0 = expr(o_cast, p_int32, y_floor);
+    expr x0 = expr(o_cast, p_int32, x_floor);
+
+    auto clamp_to = [](const expr &e, const expr &size) {
+        return expr(o_max, expr(o_min, e, expr(o_cast, p_int32, size) - 1), expr((int32_t) 0));
+    };
+
+    expr r0 = clamp_to(y0, height), r1 = clamp_to(y0 + 1, height);
+    expr c0 = clamp_to(x0, width), c1 = clamp_to(x0 + 1, width);
+
+    auto load = [&](const expr &r, const expr &c) {
+        return expr(o_cast, p_float32, in(r, c));
+    };
+
+    expr top = expr(o_lerp, load(r0, c0), load(r0, c1), x_frac);
+    expr bottom = expr(o_lerp, load(r1, c0), load(r1, c1), x_frac);
+
+    return expr(o_lerp, top, bottom, y_frac);
+}
+
+std::size_t expr::hash() const
+{
+    std::size_t h = std::hash<std::string>()(this->name);
+    hash_combine(h, this->_operator);
+    hash_combine(h, this->etype);
+    hash_combine(h, this->dtype);
+    hash_combine(h, this->defined);
+
+    if (this->etype == tiramisu::e_val)
+    {
+        if ((this->dtype == tiramisu::p_float32) || (this->dtype == tiramisu::p_float64))
+            hash_combine(h, std::hash<double>()(this->get_double_val()));
+        else if (this->dtype != tiramisu::p_none && this->dtype != tiramisu::p_boolean)
+            hash_combine(h, std::hash<int64_t>()(this->get_int_val()));
+    }
+
+    hash_combine(h, this->op.hash());
+    hash_combine(h, this->access_vector.hash());
+    hash_combine(h, this->argument_vector.hash());
+
+    return h;
+}
+
+bool expr::shallow_equal(const tiramisu::expr &a, const tiramisu::expr &b)
+{
+    if ((a._operator != b._operator) || (a.defined != b.defined) || (a.name != b.name) ||
+        (a.dtype != b.dtype) || (a.etype != b.etype) ||
+        !a.op.same_node(b.op) || !a.access_vector.same_node(b.access_vector) ||
+        !a.argument_vector.same_node(b.argument_vector))
+        return false;
+
+    if (a.etype == tiramisu::e_val)
+    {
+        if ((a.dtype == tiramisu::p_float32) || (a.dtype == tiramisu::p_float64))
+            return a.get_double_val() == b.get_double_val();
+        else if (a.dtype != tiramisu::p_none && a.dtype != tiramisu::p_boolean)
+            return a.get_int_val() == b.get_int_val();
+    }
+
+    return true;
+}
+
 //std::unordered_map<std::string, var> tiramisu::var::declared_vars;
 
 expr cast(primitive_t tT, const expr & e) {
@@ -155,6 +391,348 @@ expr cast(primitive_t tT, const expr & e) {
     return expr{o_cast, tT, e};
 }
 
+expr widening_mul(const expr &a, const expr &b, primitive_t result_type) {
+    if (result_type == p_none)
+    {
+        primitive_t ta = a.get_data_type();
+        primitive_t tb = b.get_data_type();
+        bool is_signed = !(ta == p_uint8 || ta == p_uint16 || ta == p_uint32) ||
+                         !(tb == p_uint8 || tb == p_uint16 || tb == p_uint32);
+
+        switch (std::max(halide_type_from_tiramisu_type(ta).bytes(), halide_type_from_tiramisu_type(tb).bytes()))
+        {
+            case 1:
+                result_type = is_signed ? p_int16 : p_uint16;
+                break;
+            case 2:
+                if (ta == p_float16 || ta == p_bfloat16 || tb == p_float16 || tb == p_bfloat16)
+                    result_type = p_float32;
+                else
+                    result_type = is_signed ? p_int32 : p_uint32;
+                break;
+            case 4:
+                if (ta == p_float32 || tb == p_float32)
+                    result_type = p_float64;
+                else
+                    result_type = is_signed ? p_int64 : p_uint64;
+                break;
+            default:
+                ERROR("No wider type for the product of " + str_from_tiramisu_type_primitive(ta) + " and " +
+                      str_from_tiramisu_type_primitive(tb) + ".", true);
+        }
+    }
+
+    return cast(result_type, a) * cast(result_type, b);
+}
+
+expr widening_mul_add(const expr &acc, const expr &a, const expr &b) {
+    return acc + widening_mul(a, b, acc.get_data_type());
+}
+
+/**
+  * Set \p min and \p max to the range of the integer type \p t, return false
+  * if \p t is not an integer type whose range fits in an int64_t.
+  */
+static bool get_type_range(primitive_t t, __int128 &min, __int128 &max) {
+    switch (t)
+    {
+        case p_uint8: min = 0; max = UINT8_MAX; return true;
+        case p_int8: min = INT8_MIN; max = INT8_MAX; return true;
+        case p_uint16: min = 0; max = UINT16_MAX; return true;
+        case p_int16: min = INT16_MIN; max = INT16_MAX; return true;
+        case p_uint32: min = 0; max = UINT32_MAX; return true;
+        case p_int32: min = INT32_MIN; max = INT32_MAX; return true;
+        case p_int64: min = INT64_MIN; max = INT64_MAX; return true;
+        default: return false;
+    }
+}
+
+static bool is_unsigned_type(primitive_t t) {
+    return t == p_uint8 || t == p_uint16 || t == p_uint32 || t == p_uint64;
+}
+
+static __int128 floor_div(__int128 a, __int128 b) {
+    __int128 q = a / b;
+    return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+static bool get_range(const expr &e, const value_ranges_t &ranges, __int128 &min, __int128 &max);
+
+/**
+  * The range of the values of the operation \p e computed from the ranges of
+  * its operands, before the wrap-around to the type of \p e.
+  */
+static bool get_operation_range(const expr &e, const value_ranges_t &ranges, __int128 &min, __int128 &max) {
+    if (e.get_expr_type() == e_val)
+    {
+        if (!e.is_integer())
+            return false;
+        min = max = e.get_int_val();
+        return true;
+    }
+    if (e.get_expr_type() != e_op)
+        return false;
+
+    // The divisor, the modulus and the shifts must be constants
+    auto constant = [](const expr &c, __int128 &value) {
+        if (!c.is_integer())
+            return false;
+        value = c.get_int_val();
+        return true;
+    };
+
+    __int128 min0, max0, min1, max1, c;
+    switch (e.get_op_type())
+    {
+        case o_access:
+        {
+            auto range = ranges.find(e.get_name());
+            if (range == ranges.end())
+                return false;
+            min = range->second.first;
+            max = range->second.second;
+            return true;
+        }
+        case o_cast:
+            return get_range(e.get_operand(0), ranges, min, max);
+        case o_minus:
+            if (!get_range(e.get_operand(0), ranges, min0, max0))
+                return false;
+            min = -max0;
+            max = -min0;
+            return true;
+        case o_add:
+        case o_sub:
+        case o_mul:
+        case o_min:
+        case o_max:
+        {
+            if (!get_range(e.get_operand(0), ranges, min0, max0) || !get_range(e.get_operand(1), ranges, min1, max1))
+                return false;
+            if (e.get_op_type() == o_add)
+            {
+                min = min0 + min1;
+                max = max0 + max1;
+            }
+            else if (e.get_op_type() == o_sub)
+            {
+                min = min0 - max1;
+                max = max0 - min1;
+            }
+            else if (e.get_op_type() == o_mul)
+            {
+                __int128 products[4] = {min0 * min1, min0 * max1, max0 * min1, max0 * max1};
+                min = *std::min_element(products, products + 4);
+                max = *std::max_element(products, products + 4);
+            }
+            else
+            {
+                min = (e.get_op_type() == o_min) ? std::min(min0, min1) : std::max(min0, min1);
+                max = (e.get_op_type() == o_min) ? std::min(max0, max1) : std::max(max0, max1);
+            }
+            return true;
+        }
+        case o_div:
+        case o_right_shift:
+        case o_left_shift:
+            if (!get_range(e.get_operand(0), ranges, min0, max0) || !constant(e.get_operand(1), c))
+                return false;
+            if (e.get_op_type() == o_left_shift)
+            {
+                if (c < 0 || c > 62)
+                    return false;
+                min = min0 * ((__int128) 1 << c);
+                max = max0 * ((__int128) 1 << c);
+                return true;
+            }
+            if (e.get_op_type() == o_right_shift)
+            {
+                if (c < 0 || c > 62)
+                    return false;
+                c = (__int128) 1 << c;
+            }
+            if (c == 0)
+                return false;
+            // The integer division of Halide is euclidean: it rounds towards
+            // minus infinity when the divisor is positive
+            min = (c > 0) ? floor_div(min0, c) : -floor_div(max0, -c);
+            max = (c > 0) ? floor_div(max0, c) : -floor_div(min0, -c);
+            return true;
+        case o_mod:
+            if (!get_range(e.get_operand(0), ranges, min0, max0) || !constant(e.get_operand(1), c) || c == 0)
+                return false;
+            c = (c > 0) ? c : -c;
+            min = (min0 >= 0 && max0 < c) ? min0 : 0;
+            max = (min0 >= 0 && max0 < c) ? max0 : c - 1;
+            return true;
+        case o_select:
+        case o_cond:
+            if (!get_range(e.get_operand(1), ranges, min0, max0) || !get_range(e.get_operand(2), ranges, min1, max1))
+                return false;
+            min = std::min(min0, min1);
+            max = std::max(max0, max1);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+  * The range of the values of \p e: the range of its operation if it fits in
+  * the type of \p e, the range of this type otherwise.
+  */
+static bool get_range(const expr &e, const value_ranges_t &ranges, __int128 &min, __int128 &max) {
+    if (e.get_expr_type() == e_op)
+        switch (e.get_op_type())
+        {
+            case o_logical_and: case o_logical_or: case o_logical_not:
+            case o_eq: case o_ne: case o_le: case o_lt: case o_ge: case o_gt:
+                min = 0;
+                max = 1;
+                return true;
+            default:
+                break;
+        }
+
+    __int128 type_min, type_max;
+    if (!get_type_range(e.get_data_type(), type_min, type_max))
+        return false;
+    if (!get_operation_range(e, ranges, min, max) || min < type_min || max > type_max)
+    {
+        min = type_min;
+        max = type_max;
+    }
+    return true;
+}
+
+bool get_value_range(const expr &e, int64_t &min, int64_t &max, const value_ranges_t &ranges) {
+    __int128 min128, max128;
+    if (!get_range(e, ranges, min128, max128))
+        return false;
+    min = (int64_t) min128;
+    max = (int64_t) max128;
+    return true;
+}
+
+static bool is_narrowable_operation(const expr &e) {
+    if (e.get_expr_type() != e_op)
+        return false;
+    switch (e.get_op_type())
+    {
+        case o_add: case o_sub: case o_mul: case o_div: case o_mod: case o_min: case o_max:
+        case o_right_shift: case o_left_shift: case o_minus: case o_select:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+  * Return true if \p e and all its intermediate values can be computed in
+  * the type \p t without overflow.
+  */
+static bool fits_in_type(const expr &e, primitive_t t, const value_ranges_t &ranges) {
+    __int128 type_min, type_max, min, max;
+    get_type_range(t, type_min, type_max);
+
+    if (!is_narrowable_operation(e))
+        return get_range(e, ranges, min, max) && min >= type_min && max <= type_max;
+
+    if (!get_operation_range(e, ranges, min, max) || min < type_min || max > type_max)
+        return false;
+    for (int i = (e.get_op_type() == o_select) ? 1 : 0; i < e.get_n_arg(); i++)
+        if (!fits_in_type(e.get_operand(i), t, ranges))
+            return false;
+    return true;
+}
+
+/**
+  * Return \p e computed in the type \p t (see fits_in_type()).
+  */
+static expr retype(const expr &e, primitive_t t, const value_ranges_t &ranges) {
+    if (!is_narrowable_operation(e))
+    {
+        if (e.get_expr_type() == e_val)
+            return value_cast(t, e.get_int_val());
+        // A widening cast of a value that fits in t is not needed anymore
+        __int128 type_min, type_max, min, max;
+        get_type_range(t, type_min, type_max);
+        if (e.get_expr_type() == e_op && e.get_op_type() == o_cast &&
+            get_range(e.get_operand(0), ranges, min, max) && min >= type_min && max <= type_max)
+            return cast(t, e.get_operand(0));
+        return cast(t, e);
+    }
+
+    if (e.get_op_type() == o_minus)
+        return expr(o_minus, retype(e.get_operand(0), t, ranges));
+    if (e.get_op_type() == o_select)
+        return expr(o_select, e.get_operand(0), retype(e.get_operand(1), t, ranges),
+                    retype(e.get_operand(2), t, ranges));
+    return expr(e.get_op_type(), retype(e.get_operand(0), t, ranges), retype(e.get_operand(1), t, ranges));
+}
+
+expr narrow_integer_types(const expr &e, const value_ranges_t &ranges) {
+    if (!e.is_defined())
+        return e;
+
+    primitive_t type = e.get_data_type();
+    __int128 type_min, type_max;
+    if (is_narrowable_operation(e) && get_type_range(type, type_min, type_max))
+    {
+        int bits = halide_type_from_tiramisu_type(type).bits();
+        std::vector<primitive_t> narrower_types = {p_uint8, p_int8, p_uint16, p_int16, p_uint32, p_int32};
+        for (primitive_t t : narrower_types)
+            if (halide_type_from_tiramisu_type(t).bits() < bits &&
+                (!is_unsigned_type(type) || is_unsigned_type(t)) && fits_in_type(e, t, ranges))
+                return cast(type, retype(e, t, ranges));
+    }
+
+    // The indices of the accesses are not narrowed
+    if (e.get_expr_type() != e_op || e.get_op_type() == o_access || e.get_op_type() == o_address_of ||
+        e.get_op_type() == o_lin_index || e.get_op_type() == o_buffer)
+        return e;
+
+    expr narrowed = e.apply_to_operands([&](const expr &operand) { return narrow_integer_types(operand, ranges); });
+
+    // A cast of a narrowed operation does not need to widen it first:
+    // cast(t, cast(wide, x)) is cast(t, x) when the cast to wide is exact
+    if (narrowed.get_op_type() == o_cast && narrowed.get_operand(0).get_expr_type() == e_op &&
+        narrowed.get_operand(0).get_op_type() == o_cast)
+    {
+        primitive_t wide = narrowed.get_operand(0).get_data_type();
+        const expr &x = narrowed.get_operand(0).get_operand(0);
+        __int128 wide_min, wide_max, x_min, x_max;
+        if (get_type_range(wide, wide_min, wide_max) && get_type_range(x.get_data_type(), x_min, x_max) &&
+            x_min >= wide_min && x_max <= wide_max &&
+            (get_type_range(type, type_min, type_max) || type == p_float32 || type == p_float64))
+            return cast(type, x);
+    }
+
+    return narrowed;
+}
+
+expr make_complex(const expr &re, const expr &im) {
+    assert(re.get_data_type() == im.get_data_type() && "The real and imaginary parts should be of the same type.");
+    assert((re.get_data_type() == p_float32 || re.get_data_type() == p_float64) &&
+           "The parts of a complex number should be p_float32 or p_float64.");
+
+    primitive_t type = (re.get_data_type() == p_float32) ? p_complex64 : p_complex128;
+    return expr(o_call, "tiramisu_complex", {re, im}, type);
+}
+
+expr real_part(const expr &e) {
+    return expr(o_call, "tiramisu_real", {e}, complex_component_type(e.get_data_type()));
+}
+
+expr imag_part(const expr &e) {
+    return expr(o_call, "tiramisu_imag", {e}, complex_component_type(e.get_data_type()));
+}
+
+expr conjugate(const expr &e) {
+    assert(is_complex_type(e.get_data_type()) && "Not a complex number.");
+    return expr(o_call, "tiramisu_conj", {e}, e.get_data_type());
+}
+
 expr tiramisu::expr::operator+(tiramisu::expr other) const {
     return tiramisu::expr{o_add, *this, other};
 }
@@ -280,6 +858,95 @@ expr cblas_gemm(const buffer &A, const buffer &B, buffer &C,
             tiramisu::p_uint8);
 }
 
+expr cublas_gemm_strided_batched(const buffer &A, const buffer &B, buffer &C,
+                                 expr M, expr N, expr K, expr batch,
+                                 expr alpha, expr beta,
+                                 expr ldA, expr ldB, expr ldC,
+                                 expr offsetA, expr offsetB, expr offsetC,
+                                 expr strideA, expr strideB, expr strideC,
+                                 expr transposeA, expr transposeB)
+{
+    if (A.get_location() != cuda_ast::memory_location::global ||
+        B.get_location() != cuda_ast::memory_location::global ||
+        C.get_location() != cuda_ast::memory_location::global) {
+        ERROR("Buffers must be on GPU global memory", true);
+    }
+    std::string fname;
+    expr alpha_expr;
+    expr beta_expr;
+    if (A.get_elements_type() == p_float32 &&
+        B.get_elements_type() == p_float32 &&
+        C.get_elements_type() == p_float32) {
+        fname = "tiramisu_cublas_sgemm_strided_batched";
+        alpha_expr = cast(p_float32, alpha);
+        beta_expr = cast(p_float32, beta);
+    } else if (A.get_elements_type() == p_float64 &&
+               B.get_elements_type() == p_float64 &&
+               C.get_elements_type() == p_float64) {
+        fname = "tiramisu_cublas_dgemm_strided_batched";
+        alpha_expr = cast(p_float64, alpha);
+        beta_expr = cast(p_float64, beta);
+    } else {
+        ERROR("All input buffers should be of same type and either p_float32 or p_float64", true);
+    }
+    return expr(o_call, fname,
+            {
+                var(p_void_ptr, A.get_name()),
+                var(p_void_ptr, B.get_name()),
+                var(p_void_ptr, C.get_name()),
+                cast(p_uint64, M), cast(p_uint64, N), cast(p_uint64, K),
+                alpha_expr, beta_expr,
+                cast(p_uint64, ldA), cast(p_uint64, ldB), cast(p_uint64, ldC),
+                cast(p_uint64, offsetA), cast(p_uint64, offsetB), cast(p_uint64, offsetC),
+                cast(p_uint64, strideA), cast(p_uint64, strideB), cast(p_uint64, strideC),
+                cast(p_uint64, batch),
+                cast(p_boolean, transposeA), cast(p_boolean, transposeB)
+            },
+            tiramisu::p_uint8);
+}
+
+expr cblas_gemm_strided_batched(const buffer &A, const buffer &B, buffer &C,
+                                expr M, expr N, expr K, expr batch,
+                                expr alpha, expr beta,
+                                expr ldA, expr ldB, expr ldC,
+                                expr offsetA, expr offsetB, expr offsetC,
+                                expr strideA, expr strideB, expr strideC,
+                                expr transposeA, expr transposeB)
+{
+    std::string fname;
+    expr alpha_expr;
+    expr beta_expr;
+    if (A.get_elements_type() == p_float32 &&
+        B.get_elements_type() == p_float32 &&
+        C.get_elements_type() == p_float32) {
+        fname = "tiramisu_cblas_sgemm_strided_batched";
+        alpha_expr = cast(p_float32, alpha);
+        beta_expr = cast(p_float32, beta);
+    } else if (A.get_elements_type() == p_float64 &&
+               B.get_elements_type() == p_float64 &&
+               C.get_elements_type() == p_float64) {
+        fname = "tiramisu_cblas_dgemm_strided_batched";
+        alpha_expr = cast(p_float64, alpha);
+        beta_expr = cast(p_float64, beta);
+    } else {
+        ERROR("All input buffers should be of same type and either p_float32 or p_float64", true);
+    }
+    return expr(o_call, fname,
+            {
+                var(p_void_ptr, A.get_name()),
+                var(p_void_ptr, B.get_name()),
+                var(p_void_ptr, C.get_name()),
+                cast(p_int32, M), cast(p_int32, N), cast(p_int32, K),
+                alpha_expr, beta_expr,
+                cast(p_int32, ldA), cast(p_int32, ldB), cast(p_int32, ldC),
+                cast(p_int32, offsetA), cast(p_int32, offsetB), cast(p_int32, offsetC),
+                cast(p_int32, strideA), cast(p_int32, strideB), cast(p_int32, strideC),
+                cast(p_int32, batch),
+                cast(p_boolean, transposeA), cast(p_boolean, transposeB)
+            },
+            tiramisu::p_uint8);
+}
+
 expr spmv(expr transposeA,
           expr alpha,
           const buffer &csrA,
@@ -584,6 +1251,63 @@ expr flexnlp_lstm_cell_partitioned_multi_accelerator(const buffer &x_in, const b
             tiramisu::p_int32);
 }
 
+/**
+  Run an LSTM Cell inference whose batch is split among all the accelerators
+*/
+expr flexnlp_lstm_cell_balanced(const buffer &x_in, const buffer &W_in, const buffer &output, const buffer &h_out, expr layer_number)
+{
+    std::string fname;
+    fname = "tiramisu_flexnlp_async_run_lstm_balanced";
+
+    std::vector<expr> sizes_X_in = x_in.get_dim_sizes();
+    std::vector<expr> sizes_W_in = W_in.get_dim_sizes();
+    std::vector<expr> sizes_output = output.get_dim_sizes();
+
+    expr batch_size = sizes_X_in[0];
+    expr timesteps = sizes_X_in[1];
+    expr input_size = sizes_X_in[2];
+
+    expr hidden_size = sizes_output[2];
+
+    expr output_size;
+    if (sizes_W_in.size()<4){ // One single layer
+      output_size = sizes_W_in[1];
+      layer_number = expr(-1);
+    }
+    else{
+      output_size = sizes_W_in[2];
+    }
+
+    return expr(o_call, fname,
+            {
+                var(p_void_ptr, x_in.get_name()),
+                var(p_void_ptr, W_in.get_name()),
+                var(p_void_ptr, output.get_name()),
+                var(p_void_ptr, h_out.get_name()),
+
+                cast(p_int32, input_size),
+                cast(p_int32, hidden_size),
+                cast(p_int32, output_size),
+                cast(p_int32, timesteps),
+                cast(p_int32, batch_size),
+
+                cast(p_int32, layer_number)
+            },
+            tiramisu::p_int32);
+}
+
+expr flexnlp_synchronize(expr device_id)
+{
+    std::string fname;
+    fname = "tiramisu_flexnlp_async_synchronize";
+
+    return expr(o_call, fname,
+            {
+                cast(p_int32, device_id)
+            },
+            tiramisu::p_int32);
+}
+
 expr flexnlp_initialize(expr number_of_devices)
 {
     std::string fname;
@@ -1,10 +1,1763 @@
 #include "tiramisu/externs.h"
+#include "tiramisu/type.h"
 #ifdef WITH_MPI
 #include <mpi.h>
 #endif
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+#ifdef WITH_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace
+{
+
+/**
+  * The mask of the online NUMA nodes (at most 64 nodes), read from sysfs.
+  */
+unsigned long numa_online_nodes_mask()
+{
+    unsigned long mask = 0;
+    std::ifstream online_file("/sys/devices/system/node/online");
+    std::string range;
+
+    // The file contains a list of ranges, e.g. "0-1,3"
+    while (std::getline(online_file, range, ','))
+    {
+        size_t dash = range.find('-');
+        int first = std::atoi(range.substr(0, dash).c_str());
+        int last = (dash == std::string::npos) ? first : std::atoi(range.substr(dash + 1).c_str());
+
+        for (int node = first; node <= last && node < 64; ++node)
+            mask |= 1UL << node;
+    }
+
+    return (mask == 0) ? 1 : mask;
+}
+
+/**
+  * The counters of the thread pools (see tiramisu_get_thread_pool_counters()).
+  */
+std::atomic<uint64_t> pool_parallel_loops(0);
+std::atomic<uint64_t> pool_sequential_loops(0);
+std::atomic<uint64_t> pool_contended_loops(0);
+std::atomic<uint64_t> pool_wait_ns(0);
+
+/**
+  * The chunk size of the parallel loops of tiramisu_openmp_do_par_for() and
+  * tiramisu_tbb_do_par_for().
+  */
+std::atomic<int> parallel_backend_chunk_size(0);
+
+int run_sequentially(void *user_context, halide_task_t task, int min, int size, uint8_t *closure)
+{
+    if (size > 1)
+        pool_sequential_loops++;
+
+    for (int i = min; i < min + size; ++i)
+    {
+        int result = task(user_context, i, closure);
+        if (result != 0)
+            return result;
+    }
+
+    return 0;
+}
+
+/**
+  * The threads used by tiramisu_numa_do_par_for(), and the sub-pools of
+  * tiramisu_concurrent_do_par_for(). Each thread executes the same chunk of
+  * each parallel loop.
+  */
+class numa_thread_pool
+{
+private:
+    int first_core;
+    int nb_threads;
+    std::vector<std::thread> workers;
+
+    std::mutex loop_mutex;
+    std::mutex state_mutex;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+
+    // The parallel loop being executed
+    void *user_context;
+    halide_task_t task;
+    int min, size;
+    uint8_t *closure;
+
+    int generation = 0;
+    int nb_running = 0;
+    int result = 0;
+
+    void worker_loop(int thread_id)
+    {
+        is_worker = true;
+
+#ifdef __linux__
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET((first_core + thread_id) % std::thread::hardware_concurrency(), &cpu_set);
+        sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+#endif
+
+        int seen_generation = 0;
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            work_available.wait(lock, [&] { return generation != seen_generation; });
+            seen_generation = generation;
+            lock.unlock();
+
+            int begin = min + (int)((long)size * thread_id / nb_threads);
+            int end = min + (int)((long)size * (thread_id + 1) / nb_threads);
+
+            int chunk_result = 0;
+            for (int i = begin; i < end && chunk_result == 0; ++i)
+                chunk_result = task(user_context, i, closure);
+
+            lock.lock();
+            if (chunk_result != 0 && result == 0)
+                result = chunk_result;
+
+            if (--nb_running == 0)
+                work_done.notify_one();
+        }
+    }
+
+public:
+    static thread_local bool is_worker;
+
+    /**
+      * The number of threads given by HL_NUM_THREADS, by default the number of cores.
+      */
+    static int default_nb_threads()
+    {
+        int nb_threads = std::thread::hardware_concurrency();
+        if (std::getenv("HL_NUM_THREADS") != nullptr)
+            nb_threads = std::atoi(std::getenv("HL_NUM_THREADS"));
+
+        return std::max(nb_threads, 1);
+    }
+
+    /**
+      * \p nb_threads threads pinned to the cores \p first_core and the following ones.
+      */
+    numa_thread_pool(int first_core = 0, int nb_threads = default_nb_threads())
+        : first_core(first_core), nb_threads(std::max(nb_threads, 1))
+    {
+        for (int i = 0; i < this->nb_threads; ++i)
+        {
+            workers.emplace_back(&numa_thread_pool::worker_loop, this, i);
+            workers.back().detach();
+        }
+    }
+
+    int run(void *user_context, halide_task_t task, int min, int size, uint8_t *closure)
+    {
+        // One parallel loop at a time
+        std::unique_lock<std::mutex> loop_lock(loop_mutex, std::try_to_lock);
+        if (!loop_lock.owns_lock())
+        {
+            auto start = std::chrono::steady_clock::now();
+            loop_lock.lock();
+            pool_contended_loops++;
+            pool_wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        }
+        pool_parallel_loops++;
+        std::unique_lock<std::mutex> lock(state_mutex);
+
+        this->user_context = user_context;
+        this->task = task;
+        this->min = min;
+        this->size = size;
+        this->closure = closure;
+
+        result = 0;
+        nb_running = nb_threads;
+        generation++;
+
+        work_available.notify_all();
+        work_done.wait(lock, [&] { return nb_running == 0; });
+
+        return result;
+    }
+};
+
+thread_local bool numa_thread_pool::is_worker = false;
+
+/**
+  * The sub-pools of tiramisu_concurrent_do_par_for(), one per concurrent caller.
+  */
+class concurrent_thread_pools
+{
+private:
+    std::vector<numa_thread_pool *> pools;
+    std::atomic<int> next_pool;
+
+public:
+    static thread_local int pool_id;
+    static std::atomic<int> nb_callers;
+
+    concurrent_thread_pools(int nb_callers) : next_pool(0)
+    {
+        int nb_threads = numa_thread_pool::default_nb_threads();
+        int pool_size = std::max(nb_threads / nb_callers, 1);
+
+        // Never destroyed: the detached threads use the pools until the process exits
+        for (int i = 0; i < nb_callers; ++i)
+            pools.push_back(new numa_thread_pool(i * pool_size, pool_size));
+    }
+
+    int run(void *user_context, halide_task_t task, int min, int size, uint8_t *closure)
+    {
+        // The callers are spread over the sub-pools in the order of their first loop
+        if (pool_id == -1)
+            pool_id = next_pool++ % pools.size();
+
+        return pools[pool_id]->run(user_context, task, min, size, closure);
+    }
+};
+
+thread_local int concurrent_thread_pools::pool_id = -1;
+std::atomic<int> concurrent_thread_pools::nb_callers(
+    std::getenv("TIRAMISU_CONCURRENT_CALLERS") ? std::max(std::atoi(std::getenv("TIRAMISU_CONCURRENT_CALLERS")), 0) : 0);
+
+/**
+  * A request waiting in a tiramisu_batcher.
+  */
+struct batch_request
+{
+    halide_buffer_t **buffers;
+    int result = 0;
+    bool done = false;
+};
+
+/**
+  * Copy the elements of \p buf from (or to, if \p to_buffer) the dense
+  * memory \p dense, one dimension at a time from the outermost.
+  */
+void copy_dense(halide_buffer_t *buf, uint8_t *dense, bool to_buffer)
+{
+    int elem_size = buf->type.bytes();
+    std::vector<int> position(buf->dimensions, 0);
+    int64_t dense_offset = 0;
+
+    while (true)
+    {
+        int64_t offset = 0;
+        for (int d = 0; d < buf->dimensions; ++d)
+            offset += (int64_t) position[d] * buf->dim[d].stride;
+
+        // The innermost dimension is copied as a whole when it is contiguous
+        int n = (buf->dimensions > 0 && buf->dim[0].stride == 1) ? buf->dim[0].extent : 1;
+        uint8_t *element = buf->host + offset * elem_size;
+        if (to_buffer)
+            std::memcpy(element, dense + dense_offset, n * elem_size);
+        else
+            std::memcpy(dense + dense_offset, element, n * elem_size);
+        dense_offset += (int64_t) n * elem_size;
+
+        int d = (n > 1) ? 1 : 0;
+        if (n > 1)
+            position[0] = 0;
+        for (; d < buf->dimensions; ++d)
+        {
+            if (++position[d] < buf->dim[d].extent)
+                break;
+            position[d] = 0;
+        }
+        if (d >= buf->dimensions)
+            break;
+    }
+}
+
+bool same_shape(const halide_buffer_t *a, const halide_buffer_t *b)
+{
+    if (a->dimensions != b->dimensions || a->type.bits != b->type.bits)
+        return false;
+
+    for (int d = 0; d < a->dimensions; ++d)
+        if (a->dim[d].min != b->dim[d].min || a->dim[d].extent != b->dim[d].extent)
+            return false;
+
+    return true;
+}
+
+/**
+  * The sizes of the mappings made by tiramisu_map_fd().
+  */
+std::mutex file_mappings_mutex;
+std::map<void *, size_t> file_mappings;
+
+/**
+  * A parallel loop executed by tiramisu_work_stealing_do_par_for(). The
+  * iterations are claimed by chunks, by any thread that holds the loop.
+  */
+struct work_stealing_loop
+{
+    void *user_context;
+    halide_task_t task;
+    uint8_t *closure;
+    int end;
+
+    std::atomic<int> next;      // The first iteration not claimed yet
+    std::atomic<int> pending;   // The number of iterations not executed yet
+    std::atomic<int> users;     // The number of threads (other than the caller) holding the loop
+    std::atomic<int> result;
+
+    bool exhausted() const
+    {
+        return next.load() >= end;
+    }
+};
+
+/**
+  * The threads used by tiramisu_work_stealing_do_par_for(). Each thread has
+  * a queue of the parallel loops it started; an idle thread takes a loop from
+  * the back of its own queue, or steals one from the front of the queue of
+  * another thread. The threads that are not workers share one more queue.
+  */
+class work_stealing_thread_pool
+{
+private:
+    struct loop_queue
+    {
+        std::mutex mutex;
+        std::deque<work_stealing_loop *> loops;
+    };
+
+    int nb_threads;
+    std::vector<loop_queue> queues;
+
+    std::mutex sleep_mutex;
+    std::condition_variable work_available;
+    std::atomic<int> generation;
+
+    // Signaled when the last iteration of a loop is executed, or its last user leaves it
+    std::mutex done_mutex;
+    std::condition_variable loop_done;
+
+    void signal_loop_done()
+    {
+        std::lock_guard<std::mutex> lock(done_mutex);
+        loop_done.notify_all();
+    }
+
+    /**
+      * Take a loop that still has unclaimed iterations, and register the
+      * current thread as one of its users. Exhausted loops are removed from
+      * the queues on the way. Return nullptr if there is no such loop.
+      */
+    work_stealing_loop *find_loop(int thread_id)
+    {
+        for (int i = 0; i < (int) queues.size(); ++i)
+        {
+            int queue_id = (thread_id + i) % queues.size();
+            loop_queue &queue = queues[queue_id];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            while (!queue.loops.empty())
+            {
+                // The owner takes its most recent (innermost) loop, the thieves the oldest one
+                bool own = (queue_id == thread_id);
+                work_stealing_loop *loop = own ? queue.loops.back() : queue.loops.front();
+
+                if (loop->exhausted())
+                {
+                    if (own)
+                        queue.loops.pop_back();
+                    else
+                        queue.loops.pop_front();
+                    continue;
+                }
+
+                loop->users++;
+                return loop;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void worker_loop(int thread_id)
+    {
+        worker_id = thread_id;
+
+        while (true)
+        {
+            int seen_generation = generation.load();
+            work_stealing_loop *loop = find_loop(thread_id);
+
+            if (loop != nullptr)
+            {
+                run_chunks(loop);
+                // The loop may be destroyed by its caller as soon as it has no user
+                if (--loop->users == 0)
+                    signal_loop_done();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            work_available.wait_for(lock, std::chrono::milliseconds(10),
+                                    [&] { return generation.load() != seen_generation; });
+        }
+    }
+
+public:
+    static thread_local int worker_id;
+    static std::atomic<int> grain_size;
+
+    work_stealing_thread_pool() : generation(0)
+    {
+        nb_threads = std::thread::hardware_concurrency();
+        if (std::getenv("HL_NUM_THREADS") != nullptr)
+            nb_threads = std::atoi(std::getenv("HL_NUM_THREADS"));
+
+        nb_threads = std::max(nb_threads, 1);
+
+        // The caller of a parallel loop also executes it, so one thread less is needed
+        queues = std::vector<loop_queue>(nb_threads);
+        for (int i = 0; i < nb_threads - 1; ++i)
+            std::thread(&work_stealing_thread_pool::worker_loop, this, i).detach();
+    }
+
+    /**
+      * Claim and execute chunks of \p loop until all its iterations are claimed.
+      * With a grain size of 0, the chunks are guided: each chunk is a fraction
+      * of the remaining iterations, so the chunks get smaller towards the end
+      * of the loop and the imbalance of non-rectangular domains is absorbed.
+      */
+    void run_chunks(work_stealing_loop *loop)
+    {
+        int grain = grain_size.load();
+
+        while (true)
+        {
+            int remaining = loop->end - loop->next.load();
+            if (remaining <= 0)
+                break;
+
+            int chunk = (grain > 0) ? grain : std::max(remaining / (2 * nb_threads), 1);
+            int begin = loop->next.fetch_add(chunk);
+            if (begin >= loop->end)
+                break;
+
+            int end = std::min(begin + chunk, loop->end);
+            for (int i = begin; i < end && loop->result.load() == 0; ++i)
+            {
+                int result = loop->task(loop->user_context, i, loop->closure);
+                if (result != 0)
+                {
+                    int no_error = 0;
+                    loop->result.compare_exchange_strong(no_error, result);
+                }
+            }
+
+            if ((loop->pending -= end - begin) == 0)
+                signal_loop_done();
+        }
+    }
+
+    int run(void *user_context, halide_task_t task, int min, int size, uint8_t *closure)
+    {
+        work_stealing_loop loop;
+        loop.user_context = user_context;
+        loop.task = task;
+        loop.closure = closure;
+        loop.end = min + size;
+        loop.next = min;
+        loop.pending = size;
+        loop.users = 0;
+        loop.result = 0;
+
+        // The threads that are not workers use the last queue
+        loop_queue &queue = queues[(worker_id >= 0) ? worker_id : nb_threads - 1];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.loops.push_back(&loop);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            generation++;
+        }
+        work_available.notify_all();
+
+        run_chunks(&loop);
+
+        // No thread can take the loop once it is out of the queue
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            auto it = std::find(queue.loops.begin(), queue.loops.end(), &loop);
+            if (it != queue.loops.end())
+                queue.loops.erase(it);
+        }
+
+        // All the iterations are claimed: wait for the last chunks executed by the other threads
+        auto loop_finished = [&] { return loop.pending.load() == 0 && loop.users.load() == 0; };
+        for (int spin = 0; spin < 64 && !loop_finished(); ++spin)
+            std::this_thread::yield();
+
+        if (!loop_finished())
+        {
+            std::unique_lock<std::mutex> lock(done_mutex);
+            loop_done.wait(lock, loop_finished);
+        }
+
+        return loop.result.load();
+    }
+};
+
+thread_local int work_stealing_thread_pool::worker_id = -1;
+std::atomic<int> work_stealing_thread_pool::grain_size(0);
+
+/**
+  * The counters of the loop nests profiled by tiramisu_profiler_start() and
+  * tiramisu_profiler_stop().
+  */
+class profiler
+{
+public:
+    struct region
+    {
+        std::string name;
+        tiramisu_profile_counters counters;
+    };
+
+    static std::atomic<bool> hardware_counters;
+
+    std::mutex mutex;
+    std::vector<region> regions;
+    std::map<std::string, size_t> region_ids;
+
+    static profiler &get()
+    {
+        // Never destroyed: the generated code may run until the process exits
+        static profiler *instance = new profiler();
+        return *instance;
+    }
+
+    static uint64_t cycles()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /**
+      * The cache misses and the instructions of the calling thread so far,
+      * or -1 if they are not counted.
+      */
+    static std::pair<int64_t, int64_t> read_hardware_counters()
+    {
+        if (!hardware_counters)
+            return {-1, -1};
+
+#ifdef __linux__
+        // The counters of a thread are opened the first time it needs them
+        thread_local int cache_misses_fd = open_counter(PERF_COUNT_HW_CACHE_MISSES);
+        thread_local int instructions_fd = open_counter(PERF_COUNT_HW_INSTRUCTIONS);
+        return {read_counter(cache_misses_fd), read_counter(instructions_fd)};
+#else
+        return {-1, -1};
+#endif
+    }
+
+private:
+#ifdef __linux__
+    static int open_counter(uint64_t config)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        // Fails (e.g. because of perf_event_paranoid), the counter is then not counted
+        return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    static int64_t read_counter(int fd)
+    {
+        int64_t value;
+        if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value))
+            return -1;
+        return value;
+    }
+#endif
+};
+
+std::atomic<bool> profiler::hardware_counters(getenv("TIRAMISU_PROFILE_HW_COUNTERS") != nullptr);
+
+/**
+  * The hardware counters at the start of the loop nests being profiled by
+  * the calling thread.
+  */
+thread_local std::vector<std::pair<int64_t, int64_t>> profiler_hardware_counters_at_start;
+
+/**
+  * A box of elements of a streamed buffer (inclusive bounds).
+  */
+struct io_box
+{
+    int32_t nb_dims = 0;
+    int64_t lower[4] = {0, 0, 0, 0};
+    int64_t upper[4] = {0, 0, 0, 0};
+
+    bool empty() const
+    {
+        for (int d = 0; d < nb_dims; d++)
+            if (lower[d] > upper[d])
+                return true;
+        return false;
+    }
+
+    int64_t size() const
+    {
+        int64_t n = 1;
+        for (int d = 0; d < nb_dims; d++)
+            n *= upper[d] - lower[d] + 1;
+        return n;
+    }
+
+    bool operator==(const io_box &other) const
+    {
+        return nb_dims == other.nb_dims && std::equal(lower, lower + nb_dims, other.lower) &&
+               std::equal(upper, upper + nb_dims, other.upper);
+    }
+};
+
+/**
+  * A transfer between a ring buffer and a streamed buffer.
+  */
+struct io_transfer
+{
+    bool write;
+    char *chunk;
+    int32_t element_size;
+    io_box box;
+    int64_t shape[4];
+
+    /**
+      * True if the elements of box and of \p other have different positions in the ring.
+      */
+    bool fits_with(const io_box &other) const
+    {
+        if (other.nb_dims != box.nb_dims)
+            return false;
+        for (int d = 0; d < box.nb_dims; d++)
+            if (std::max(box.upper[d], other.upper[d]) - std::min(box.lower[d], other.lower[d]) + 1 > shape[d])
+                return false;
+        return true;
+    }
+};
+
+/**
+  * An I/O stream of computation::stream_input() or computation::stream_output():
+  * the transfers are done in order by a thread of the stream, while the
+  * generated code computes.
+  */
+class io_stream
+{
+public:
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    // A callback, or a file mapped in memory
+    tiramisu_io_stream_callback callback = nullptr;
+    void *user_data = nullptr;
+    char *mapping = nullptr;
+    size_t mapping_size = 0;
+    int64_t file_extent[4] = {1, 1, 1, 1};
+
+    std::deque<io_transfer> pending;    // The front one is being done
+    bool stopping = false;
+    std::thread thread;
+
+    // The last read, whose elements are still in the ring
+    bool has_previous = false;
+    io_transfer previous;
+
+    static io_stream &get(int32_t stream)
+    {
+        // Never destroyed: the generated code may run until the process exits
+        static std::mutex streams_mutex;
+        static std::map<int32_t, io_stream *> *streams = new std::map<int32_t, io_stream *>();
+
+        std::lock_guard<std::mutex> lock(streams_mutex);
+        io_stream *&s = (*streams)[stream];
+        if (s == nullptr)
+            s = new io_stream();
+        return *s;
+    }
+
+    void enqueue(const io_transfer &t)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (callback == nullptr && mapping == nullptr)
+        {
+            std::cerr << "tiramisu: an I/O stream is used without being bound to a callback or a file." << std::endl;
+            abort();
+        }
+        if (!thread.joinable())
+            thread = std::thread([this] { run(); });
+        pending.push_back(t);
+        changed.notify_all();
+    }
+
+    void wait(const io_box &box)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] {
+            return pending.empty() ||
+                   (pending.size() == 1 && !(pending.front().box == box) && pending.front().fits_with(box));
+        });
+    }
+
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return pending.empty(); });
+        if (mapping != nullptr)
+            msync(mapping, mapping_size, MS_SYNC);
+        has_previous = false;
+    }
+
+    void unbind()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return pending.empty(); });
+            stopping = true;
+            changed.notify_all();
+        }
+        if (thread.joinable())
+            thread.join();
+
+        if (mapping != nullptr)
+            munmap(mapping, mapping_size);
+        mapping = nullptr;
+        mapping_size = 0;
+        callback = nullptr;
+        user_data = nullptr;
+        has_previous = false;
+        stopping = false;
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            changed.wait(lock, [&] { return stopping || !pending.empty(); });
+            if (pending.empty())
+                return;
+
+            io_transfer t = pending.front();
+            lock.unlock();
+            execute(t);
+            lock.lock();
+            pending.pop_front();
+            changed.notify_all();
+        }
+    }
+
+    /**
+      * Only the thread of the stream touches previous.
+      */
+    void execute(const io_transfer &t)
+    {
+        if (t.write)
+        {
+            transfer(t, t.box);
+            return;
+        }
+
+        // Read what is not in the ring yet: the box minus the previous box,
+        // split into disjoint boxes one dimension at a time.
+        io_box rest = t.box;
+        if (has_previous && previous.chunk == t.chunk && t.fits_with(previous.box))
+        {
+            for (int d = 0; d < rest.nb_dims && !rest.empty(); d++)
+            {
+                io_box below = rest, above = rest;
+                below.upper[d] = std::min(rest.upper[d], previous.box.lower[d] - 1);
+                above.lower[d] = std::max(rest.lower[d], previous.box.upper[d] + 1);
+                if (!below.empty())
+                    transfer(t, below);
+                if (!above.empty())
+                    transfer(t, above);
+                rest.lower[d] = std::max(rest.lower[d], previous.box.lower[d]);
+                rest.upper[d] = std::min(rest.upper[d], previous.box.upper[d]);
+            }
+        }
+        else
+            transfer(t, rest);
+
+        previous = t;
+        has_previous = true;
+    }
+
+    /**
+      * Copy the elements of \p box between the ring of \p t and the stream.
+      */
+    void transfer(const io_transfer &t, const io_box &box)
+    {
+        if (box.empty())
+            return;
+
+        int n = box.nb_dims;
+        std::vector<char> staging;
+        if (callback != nullptr)
+        {
+            staging.resize(box.size() * t.element_size);
+            if (!t.write)
+                call(box, staging.data());
+        }
+
+        // Copy the runs of the last dimension that are contiguous in the ring.
+        int64_t index[4];
+        std::copy(box.lower, box.lower + 4, index);
+        int64_t staged = 0;
+        while (true)
+        {
+            int64_t ring_offset = 0, file_offset = 0;
+            for (int d = 0; d < n; d++)
+            {
+                ring_offset = ring_offset * t.shape[d] + (index[d] % t.shape[d] + t.shape[d]) % t.shape[d];
+                file_offset = file_offset * file_extent[d] + index[d];
+            }
+            int64_t position = (index[n - 1] % t.shape[n - 1] + t.shape[n - 1]) % t.shape[n - 1];
+            int64_t run = std::min(box.upper[n - 1] - index[n - 1] + 1, t.shape[n - 1] - position);
+            size_t bytes = run * t.element_size;
+
+            char *ring = t.chunk + ring_offset * t.element_size;
+            char *other = (callback != nullptr) ? staging.data() + staged * t.element_size
+                                                : mapping + file_offset * t.element_size;
+            if (t.write)
+                memcpy(other, ring, bytes);
+            else
+                memcpy(ring, other, bytes);
+            staged += run;
+
+            index[n - 1] += run;
+            int d = n - 1;
+            while (d > 0 && index[d] > box.upper[d])
+            {
+                index[d] = box.lower[d];
+                index[--d]++;
+            }
+            if (index[0] > box.upper[0])
+                break;
+        }
+
+        if (callback != nullptr && t.write)
+            call(box, staging.data());
+    }
+
+    void call(const io_box &box, char *data)
+    {
+        int64_t extent[4];
+        for (int d = 0; d < box.nb_dims; d++)
+            extent[d] = box.upper[d] - box.lower[d] + 1;
+        if (callback(user_data, data, box.lower, extent, box.nb_dims) != 0)
+        {
+            std::cerr << "tiramisu: an I/O stream callback failed." << std::endl;
+            abort();
+        }
+    }
+};
+
+/**
+  * The transfer described by the arguments of tiramisu_io_stream_read() and
+  * tiramisu_io_stream_write().
+  */
+io_transfer make_io_transfer(bool write, void *chunk, int32_t element_size, int32_t nb_dims,
+                             const int64_t *lower, const int64_t *upper, const int64_t *shape)
+{
+    io_transfer t;
+    t.write = write;
+    t.chunk = (char *) chunk;
+    t.element_size = element_size;
+    t.box.nb_dims = nb_dims;
+    std::copy(lower, lower + 4, t.box.lower);
+    std::copy(upper, upper + 4, t.box.upper);
+    std::copy(shape, shape + 4, t.shape);
+
+    return t;
+}
+
+}
 
 extern "C" {
 
+void *tiramisu_numa_malloc(uint64_t size, int32_t placement, int32_t node)
+{
+    // The first page stores the size of the mapping, the data starts at the second page
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t mapping_size = size + page_size;
+
+    void *mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED)
+        return nullptr;
+
+    *((size_t *)mapping) = mapping_size;
+    uint8_t *data = (uint8_t *)mapping + page_size;
+
+#ifdef __linux__
+    // The placement is a hint : the allocation does not fail if it is not possible
+    const int mpol_bind = 2, mpol_interleave = 3;
+
+    if (placement == tiramisu::numa_interleave)
+    {
+        unsigned long nodes_mask = numa_online_nodes_mask();
+        syscall(SYS_mbind, data, size, mpol_interleave, &nodes_mask, sizeof(nodes_mask) * 8, 0);
+    }
+    else if (placement == tiramisu::numa_bind && node < 64)
+    {
+        unsigned long nodes_mask = 1UL << node;
+        syscall(SYS_mbind, data, size, mpol_bind, &nodes_mask, sizeof(nodes_mask) * 8, 0);
+    }
+#endif
+
+    return data;
+}
+
+void tiramisu_numa_free(void *user_context, void *ptr)
+{
+    if (ptr == nullptr)
+        return;
+
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    uint8_t *mapping = (uint8_t *)ptr - page_size;
+
+    munmap(mapping, *((size_t *)mapping));
+}
+
+void *tiramisu_map_fd(int32_t fd, uint64_t size, int32_t writable, int32_t advice, int32_t huge_pages)
+{
+    struct stat status;
+    if (fd < 0 || fstat(fd, &status) != 0)
+        return nullptr;
+    if ((uint64_t) status.st_size < size && (!writable || ftruncate(fd, size) != 0))
+    {
+        std::cerr << "tiramisu: a mapped file is smaller than its buffer." << std::endl;
+        return nullptr;
+    }
+
+    void *mapping = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+        return nullptr;
+
+    // The advice and the huge pages are hints: the mapping does not fail if they are not possible
+    if (advice == tiramisu::mmap_sequential)
+        madvise(mapping, size, MADV_SEQUENTIAL);
+    else if (advice == tiramisu::mmap_random)
+        madvise(mapping, size, MADV_RANDOM);
+#ifdef MADV_HUGEPAGE
+    if (huge_pages)
+        madvise(mapping, size, MADV_HUGEPAGE);
+#endif
+
+    std::lock_guard<std::mutex> lock(file_mappings_mutex);
+    file_mappings[mapping] = size;
+
+    return mapping;
+}
+
+void *tiramisu_map_file(const char *path, uint64_t size, int32_t writable, int32_t advice, int32_t huge_pages)
+{
+    int fd = open(path, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "tiramisu: cannot open " << path << "." << std::endl;
+        return nullptr;
+    }
+
+    // The mapping stays valid after the file is closed
+    void *mapping = tiramisu_map_fd(fd, size, writable, advice, huge_pages);
+    close(fd);
+
+    return mapping;
+}
+
+void tiramisu_unmap_file(void *user_context, void *ptr)
+{
+    if (ptr == nullptr)
+        return;
+
+    size_t size;
+    {
+        std::lock_guard<std::mutex> lock(file_mappings_mutex);
+        auto mapping = file_mappings.find(ptr);
+        if (mapping == file_mappings.end())
+            return;
+        size = mapping->second;
+        file_mappings.erase(mapping);
+    }
+
+    munmap(ptr, size);
+}
+
+struct tiramisu_batcher
+{
+    int (*batched_argv)(void **);
+    const halide_filter_metadata_t *metadata;
+    int max_batch_size;
+    std::chrono::microseconds deadline;
+
+    std::mutex mutex;
+    std::condition_variable requests_changed;
+    std::deque<batch_request *> queue;
+    bool has_leader = false;
+};
+
+namespace
+{
+
+/**
+  * Run the requests of \p batch, that have the same shapes, with one call
+  * to the batched entry point.
+  */
+int run_batch(tiramisu_batcher *batcher, const std::vector<batch_request *> &batch)
+{
+    int nb_args = batcher->metadata->num_arguments;
+    std::vector<halide_buffer_t> buffers(nb_args);
+    std::vector<std::vector<halide_dimension_t>> dims(nb_args);
+    std::vector<std::vector<uint8_t>> data(nb_args);
+    std::vector<void *> args(nb_args);
+
+    for (int i = 0; i < nb_args; ++i)
+    {
+        const halide_buffer_t *first = batch[0]->buffers[i];
+        int64_t size = first->type.bytes();
+        for (int d = 0; d < first->dimensions; ++d)
+        {
+            dims[i].push_back({first->dim[d].min, first->dim[d].extent, (int32_t) (size / first->type.bytes()), 0});
+            size *= first->dim[d].extent;
+        }
+        // The batch is the outermost dimension
+        dims[i].push_back({0, (int32_t) batch.size(), (int32_t) (size / first->type.bytes()), 0});
+
+        data[i].resize(size * batch.size());
+        if (batcher->metadata->arguments[i].kind == halide_argument_kind_input_buffer)
+            for (int b = 0; b < batch.size(); ++b)
+                copy_dense(batch[b]->buffers[i], data[i].data() + b * size, false);
+
+        buffers[i] = halide_buffer_t();
+        buffers[i].host = data[i].data();
+        buffers[i].type = first->type;
+        buffers[i].dimensions = first->dimensions + 1;
+        buffers[i].dim = dims[i].data();
+        args[i] = &buffers[i];
+    }
+
+    int result = batcher->batched_argv(args.data());
+
+    for (int i = 0; i < nb_args && result == 0; ++i)
+        if (batcher->metadata->arguments[i].kind == halide_argument_kind_output_buffer)
+        {
+            int64_t size = data[i].size() / batch.size();
+            for (int b = 0; b < batch.size(); ++b)
+                copy_dense(batch[b]->buffers[i], data[i].data() + b * size, true);
+        }
+
+    return result;
+}
+
+}
+
+tiramisu_batcher *tiramisu_batcher_create(int (*batched_argv)(void **), const halide_filter_metadata_t *metadata,
+                                          int32_t max_batch_size, int64_t deadline_us)
+{
+    tiramisu_batcher *batcher = new tiramisu_batcher();
+    batcher->batched_argv = batched_argv;
+    batcher->metadata = metadata;
+    batcher->max_batch_size = std::max(max_batch_size, 1);
+    batcher->deadline = std::chrono::microseconds(std::max(deadline_us, (int64_t) 0));
+
+    return batcher;
+}
+
+int32_t tiramisu_batcher_run(tiramisu_batcher *batcher, halide_buffer_t **buffers)
+{
+    batch_request request;
+    request.buffers = buffers;
+
+    std::unique_lock<std::mutex> lock(batcher->mutex);
+    batcher->queue.push_back(&request);
+    batcher->requests_changed.notify_all();
+
+    while (!request.done)
+    {
+        if (batcher->has_leader)
+        {
+            batcher->requests_changed.wait(lock);
+            continue;
+        }
+
+        // This thread collects the next batch and runs it
+        batcher->has_leader = true;
+        auto deadline = std::chrono::steady_clock::now() + batcher->deadline;
+        batcher->requests_changed.wait_until(lock, deadline, [&] {
+            return batcher->queue.size() >= batcher->max_batch_size;
+        });
+
+        // The requests that have the shapes of the oldest one; the others wait for the next batch
+        std::vector<batch_request *> batch;
+        for (auto it = batcher->queue.begin(); it != batcher->queue.end() && batch.size() < batcher->max_batch_size;)
+        {
+            bool same = true;
+            for (int i = 0; i < batcher->metadata->num_arguments && !batch.empty(); ++i)
+                same = same && same_shape((*it)->buffers[i], batch[0]->buffers[i]);
+
+            if (same)
+            {
+                batch.push_back(*it);
+                it = batcher->queue.erase(it);
+            }
+            else
+                ++it;
+        }
+
+        lock.unlock();
+        int result = run_batch(batcher, batch);
+        lock.lock();
+
+        for (batch_request *r : batch)
+        {
+            r->result = result;
+            r->done = true;
+        }
+        batcher->has_leader = false;
+        batcher->requests_changed.notify_all();
+    }
+
+    return request.result;
+}
+
+void tiramisu_batcher_destroy(tiramisu_batcher *batcher)
+{
+    delete batcher;
+}
+
+int tiramisu_numa_do_par_for(void *user_context, halide_task_t task, int min, int size, uint8_t *closure)
+{
+    if (numa_thread_pool::is_worker || size <= 1)
+        return run_sequentially(user_context, task, min, size, closure);
+
+    // Never destroyed: the detached threads use the pool until the process exits
+    static numa_thread_pool *pool = new numa_thread_pool();
+    return pool->run(user_context, task, min, size, closure);
+}
+
+int tiramisu_concurrent_do_par_for(void *user_context, halide_task_t task, int min, int size, uint8_t *closure)
+{
+    int nb_callers = concurrent_thread_pools::nb_callers.load();
+    if (numa_thread_pool::is_worker || size <= 1 || nb_callers == 0)
+        return run_sequentially(user_context, task, min, size, closure);
+
+    static concurrent_thread_pools *pools = new concurrent_thread_pools(nb_callers);
+    return pools->run(user_context, task, min, size, closure);
+}
+
+void tiramisu_set_concurrent_callers(int32_t nb_callers)
+{
+    concurrent_thread_pools::nb_callers = std::max(nb_callers, 0);
+}
+
+void tiramisu_get_thread_pool_counters(tiramisu_thread_pool_counters *counters)
+{
+    counters->parallel_loops = pool_parallel_loops.load();
+    counters->sequential_loops = pool_sequential_loops.load();
+    counters->contended_loops = pool_contended_loops.load();
+    counters->wait_ns = pool_wait_ns.load();
+}
+
+void tiramisu_thread_pool_counters_reset()
+{
+    pool_parallel_loops = 0;
+    pool_sequential_loops = 0;
+    pool_contended_loops = 0;
+    pool_wait_ns = 0;
+}
+
+int tiramisu_work_stealing_do_par_for(void *user_context, halide_task_t task, int min, int size, uint8_t *closure)
+{
+    if (size <= 0)
+        return 0;
+
+    // Never destroyed: the detached threads use the pool until the process exits
+    static work_stealing_thread_pool *pool = new work_stealing_thread_pool();
+    return pool->run(user_context, task, min, size, closure);
+}
+
+int tiramisu_openmp_do_par_for(void *user_context, halide_task_t task, int min, int size, uint8_t *closure)
+{
+#ifdef WITH_OPENMP
+    if (size <= 1 || omp_in_parallel())
+        return run_sequentially(user_context, task, min, size, closure);
+
+    std::atomic<int> result(0);
+    int chunk_size = parallel_backend_chunk_size.load();
+    pool_parallel_loops++;
+
+    if (chunk_size > 0)
+    {
+        #pragma omp parallel for schedule(dynamic, chunk_size)
+        for (int i = min; i < min + size; ++i)
+            if (result.load() == 0)
+            {
+                int r = task(user_context, i, closure);
+                if (r != 0)
+                    result = r;
+            }
+    }
+    else
+    {
+        #pragma omp parallel for schedule(static)
+        for (int i = min; i < min + size; ++i)
+            if (result.load() == 0)
+            {
+                int r = task(user_context, i, closure);
+                if (r != 0)
+                    result = r;
+            }
+    }
+
+    return result.load();
+#else
+    return halide_default_do_par_for(user_context, task, min, size, closure);
+#endif
+}
+
+int tiramisu_tbb_do_par_for(void *user_context, halide_task_t task, int min, int size, uint8_t *closure)
+{
+#ifdef WITH_TBB
+    if (size <= 1)
+        return run_sequentially(user_context, task, min, size, closure);
+
+    std::atomic<int> result(0);
+    int grain_size = std::max(parallel_backend_chunk_size.load(), 1);
+    pool_parallel_loops++;
+
+    // Nested parallel loops are nested parallel_for, scheduled by TBB
+    tbb::parallel_for(tbb::blocked_range<int>(min, min + size, grain_size), [&](const tbb::blocked_range<int> &range) {
+        for (int i = range.begin(); i != range.end() && result.load() == 0; ++i)
+        {
+            int r = task(user_context, i, closure);
+            if (r != 0)
+                result = r;
+        }
+    });
+
+    return result.load();
+#else
+    return halide_default_do_par_for(user_context, task, min, size, closure);
+#endif
+}
+
+void *tiramisu_parallel_backend_begin(int32_t backend, int32_t chunk_size)
+{
+    parallel_backend_chunk_size = chunk_size;
+
+    halide_do_par_for_t do_par_for = halide_default_do_par_for;
+    if (backend == tiramisu::parallel_openmp)
+        do_par_for = tiramisu_openmp_do_par_for;
+    else if (backend == tiramisu::parallel_tbb)
+        do_par_for = tiramisu_tbb_do_par_for;
+
+    return (void *) halide_set_custom_do_par_for(do_par_for);
+}
+
+int32_t tiramisu_parallel_backend_end(void *previous)
+{
+    halide_set_custom_do_par_for((halide_do_par_for_t) previous);
+
+    return 0;
+}
+
+void tiramisu_set_parallel_grain_size(int32_t grain_size)
+{
+    work_stealing_thread_pool::grain_size = std::max(grain_size, 0);
+}
+
+int32_t tiramisu_doacross_wait(void *counter, int32_t value)
+{
+    // The wait is usually short (one tile of the previous row): spin, then yield
+    // the core in case the thread that must post is not running
+    for (int spin = 0; __atomic_load_n((int32_t *) counter, __ATOMIC_ACQUIRE) < value; ++spin)
+        if (spin >= 1024)
+            std::this_thread::yield();
+
+    return 0;
+}
+
+int32_t tiramisu_doacross_post(void *counter, int32_t value)
+{
+    __atomic_store_n((int32_t *) counter, value, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+int32_t tiramisu_pipeline_reserve_threads(int32_t nb_threads)
+{
+    // The stages wait for each other: they would deadlock if some of them
+    // could not get a thread. The main thread runs one of the stages.
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    int previous = halide_set_num_threads(0);
+    halide_set_num_threads(std::max(previous, (int) nb_threads));
+
+    return 0;
+}
+
+int32_t tiramisu_inspect_row_partition(halide_buffer_t *pos, int32_t nb_rows, int32_t nb_partitions,
+                                       halide_buffer_t *partition)
+{
+    const int32_t *row_ptr = (const int32_t *) pos->host;
+    int32_t *first_row = (int32_t *) partition->host;
+    int64_t nnz = row_ptr[nb_rows] - row_ptr[0];
+
+    // The partition q starts at the first row that starts after q * nnz / nb_partitions
+    // entries; the rows are never split
+    for (int32_t q = 0; q < nb_partitions; q++)
+    {
+        int32_t target = row_ptr[0] + (int32_t) (q * nnz / nb_partitions);
+        first_row[q] = std::lower_bound(row_ptr, row_ptr + nb_rows, target) - row_ptr;
+    }
+    first_row[nb_partitions] = nb_rows;
+
+    return 0;
+}
+
+int32_t tiramisu_inspect_rows_by_length(halide_buffer_t *pos, int32_t nb_rows, halide_buffer_t *permutation)
+{
+    const int32_t *row_ptr = (const int32_t *) pos->host;
+    int32_t *rows = (int32_t *) permutation->host;
+
+    std::iota(rows, rows + nb_rows, 0);
+    std::stable_sort(rows, rows + nb_rows, [row_ptr](int32_t a, int32_t b) {
+        return row_ptr[a + 1] - row_ptr[a] > row_ptr[b + 1] - row_ptr[b];
+    });
+
+    return 0;
+}
+
+/**
+  * The rows of a CSR matrix sorted by decreasing length inside windows of
+  * sigma rows, the order of the rows of its SELL-C-sigma conversion.
+  */
+static std::vector<int32_t> get_sell_row_order(const int32_t *row_ptr, int32_t nb_rows, int32_t sigma)
+{
+    std::vector<int32_t> rows(nb_rows);
+    std::iota(rows.begin(), rows.end(), 0);
+
+    for (int32_t first = 0; first < nb_rows; first += sigma)
+        std::stable_sort(rows.begin() + first, rows.begin() + std::min(first + sigma, nb_rows),
+                         [row_ptr](int32_t a, int32_t b) {
+                             return row_ptr[a + 1] - row_ptr[a] > row_ptr[b + 1] - row_ptr[b];
+                         });
+
+    return rows;
+}
+
+/**
+  * The width (the length of the longest row) of each slice of the
+  * SELL-C-sigma conversion of a CSR matrix.
+  */
+static std::vector<int32_t> get_sell_widths(const int32_t *row_ptr, const std::vector<int32_t> &rows, int32_t chunk_size)
+{
+    int32_t nb_rows = rows.size();
+    std::vector<int32_t> widths((nb_rows + chunk_size - 1) / chunk_size, 0);
+
+    for (int32_t i = 0; i < nb_rows; i++)
+        widths[i / chunk_size] = std::max(widths[i / chunk_size], row_ptr[rows[i] + 1] - row_ptr[rows[i]]);
+
+    return widths;
+}
+
+int32_t tiramisu_choose_sparse_format(halide_buffer_t *pos, int32_t nb_rows, int32_t vector_lanes,
+                                      halide_buffer_t *parameters)
+{
+    const int32_t *row_ptr = (const int32_t *) pos->host;
+    int32_t *chosen = (int32_t *) parameters->host;
+    assert(vector_lanes > 0);
+
+    // One vector iteration per vector_lanes entries of a row, and the
+    // reduction of the vector at the end of the row
+    int64_t csr_cost = 0;
+    for (int32_t i = 0; i < nb_rows; i++)
+        csr_cost += (row_ptr[i + 1] - row_ptr[i] + vector_lanes - 1) / vector_lanes + 2;
+
+    // One vector iteration per column of a slice, and the loads of the bounds of the slice
+    std::vector<std::pair<int32_t, int64_t>> sell_costs;
+    for (int64_t sigma = 1; ; sigma = (sigma < vector_lanes) ? vector_lanes : 2 * sigma)
+    {
+        int32_t s = std::min<int64_t>(sigma, std::max(nb_rows, 1));
+        std::vector<int32_t> widths = get_sell_widths(row_ptr, get_sell_row_order(row_ptr, nb_rows, s), vector_lanes);
+        sell_costs.push_back({s, std::accumulate(widths.begin(), widths.end(), (int64_t) 0) + (int64_t) widths.size()});
+        if (sigma >= nb_rows)
+            break;
+    }
+
+    int64_t best_cost = sell_costs[0].second;
+    for (const auto &c : sell_costs)
+        best_cost = std::min(best_cost, c.second);
+
+    int32_t best_sigma = sell_costs.back().first;
+    for (const auto &c : sell_costs)
+        if (c.second <= best_cost + best_cost / 20)
+        {
+            best_sigma = c.first;
+            break;
+        }
+
+    chosen[0] = vector_lanes;
+    chosen[1] = best_sigma;
+
+    return (best_cost < csr_cost) ? tiramisu::sparse_sell : tiramisu::sparse_csr;
+}
+
+int32_t tiramisu_sell_size(halide_buffer_t *pos, int32_t nb_rows, int32_t chunk_size, int32_t sigma)
+{
+    const int32_t *row_ptr = (const int32_t *) pos->host;
+    assert((chunk_size > 0) && (sigma > 0));
+
+    std::vector<int32_t> widths = get_sell_widths(row_ptr, get_sell_row_order(row_ptr, nb_rows, sigma), chunk_size);
+
+    return std::accumulate(widths.begin(), widths.end(), 0) * chunk_size;
+}
+
+int32_t tiramisu_csr_to_sell(halide_buffer_t *pos, halide_buffer_t *crd, halide_buffer_t *values, int32_t nb_rows,
+                             int32_t chunk_size, int32_t sigma, halide_buffer_t *slice_ptr,
+                             halide_buffer_t *sell_crd, halide_buffer_t *sell_values, halide_buffer_t *row_order)
+{
+    const int32_t *row_ptr = (const int32_t *) pos->host;
+    const int32_t *col = (const int32_t *) crd->host;
+    const uint8_t *val = values->host;
+    int32_t *first = (int32_t *) slice_ptr->host;
+    int32_t *sell_col = (int32_t *) sell_crd->host;
+    uint8_t *sell_val = sell_values->host;
+    int32_t *order = (int32_t *) row_order->host;
+    assert((chunk_size > 0) && (sigma > 0));
+    assert(values->type.bytes() == sell_values->type.bytes());
+
+    size_t bytes = values->type.bytes();
+    std::vector<int32_t> rows = get_sell_row_order(row_ptr, nb_rows, sigma);
+    std::vector<int32_t> widths = get_sell_widths(row_ptr, rows, chunk_size);
+
+    first[0] = 0;
+    for (size_t s = 0; s < widths.size(); s++)
+        first[s + 1] = first[s] + widths[s] * chunk_size;
+
+    std::fill(sell_col, sell_col + first[widths.size()], 0);
+    std::memset(sell_val, 0, first[widths.size()] * bytes);
+
+    for (int32_t i = 0; i < nb_rows; i++)
+    {
+        int32_t row = rows[i];
+        int32_t s = i / chunk_size, r = i % chunk_size;
+        order[row] = i;
+
+        for (int32_t k = 0; k < row_ptr[row + 1] - row_ptr[row]; k++)
+        {
+            int32_t p = first[s] + k * chunk_size + r;
+            sell_col[p] = col[row_ptr[row] + k];
+            std::memcpy(sell_val + p * bytes, val + (row_ptr[row] + k) * bytes, bytes);
+        }
+    }
+
+    return 0;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TIRAMISU_STREAM_STORE(NAME, VECTOR_TYPE, TARGET, STREAM, STOREU, ELEMENT_TYPE)             \
+    __attribute__((target(TARGET)))                                                             \
+    int32_t tiramisu_stream_store_##NAME(void *address, VECTOR_TYPE value)                      \
+    {                                                                                           \
+        if (((uintptr_t) address & (sizeof(VECTOR_TYPE) - 1)) == 0)                             \
+            STREAM((ELEMENT_TYPE *) address, value);                                            \
+        else                                                                                    \
+            STOREU((ELEMENT_TYPE *) address, value);                                            \
+        return 0;                                                                               \
+    }
+
+TIRAMISU_STREAM_STORE(f32x4, __m128, "sse2", _mm_stream_ps, _mm_storeu_ps, float)
+TIRAMISU_STREAM_STORE(f64x2, __m128d, "sse2", _mm_stream_pd, _mm_storeu_pd, double)
+TIRAMISU_STREAM_STORE(i8x16, __m128i, "sse2", _mm_stream_si128, _mm_storeu_si128, __m128i)
+TIRAMISU_STREAM_STORE(i16x8, __m128i, "sse2", _mm_stream_si128, _mm_storeu_si128, __m128i)
+TIRAMISU_STREAM_STORE(i32x4, __m128i, "sse2", _mm_stream_si128, _mm_storeu_si128, __m128i)
+TIRAMISU_STREAM_STORE(i64x2, __m128i, "sse2", _mm_stream_si128, _mm_storeu_si128, __m128i)
+TIRAMISU_STREAM_STORE(f32x8, __m256, "avx", _mm256_stream_ps, _mm256_storeu_ps, float)
+TIRAMISU_STREAM_STORE(f64x4, __m256d, "avx", _mm256_stream_pd, _mm256_storeu_pd, double)
+TIRAMISU_STREAM_STORE(i8x32, __m256i, "avx", _mm256_stream_si256, _mm256_storeu_si256, __m256i)
+TIRAMISU_STREAM_STORE(i16x16, __m256i, "avx", _mm256_stream_si256, _mm256_storeu_si256, __m256i)
+TIRAMISU_STREAM_STORE(i32x8, __m256i, "avx", _mm256_stream_si256, _mm256_storeu_si256, __m256i)
+TIRAMISU_STREAM_STORE(i64x4, __m256i, "avx", _mm256_stream_si256, _mm256_storeu_si256, __m256i)
+
+#undef TIRAMISU_STREAM_STORE
+
+int32_t tiramisu_stream_fence()
+{
+    _mm_sfence();
+
+    return 0;
+}
+#endif
+
+uint64_t tiramisu_profiler_start()
+{
+    profiler_hardware_counters_at_start.push_back(profiler::read_hardware_counters());
+
+    return profiler::cycles();
+}
+
+int32_t tiramisu_profiler_stop(const char *region, uint64_t start)
+{
+    uint64_t cycles = profiler::cycles() - start;
+
+    std::pair<int64_t, int64_t> hardware_counters = profiler::read_hardware_counters();
+    std::pair<int64_t, int64_t> hardware_counters_at_start = {-1, -1};
+    if (!profiler_hardware_counters_at_start.empty())
+    {
+        hardware_counters_at_start = profiler_hardware_counters_at_start.back();
+        profiler_hardware_counters_at_start.pop_back();
+    }
+
+    profiler &p = profiler::get();
+    std::lock_guard<std::mutex> lock(p.mutex);
+
+    auto id = p.region_ids.find(region);
+    if (id == p.region_ids.end())
+    {
+        id = p.region_ids.insert({region, p.regions.size()}).first;
+        p.regions.push_back({region, {0, 0, -1, -1}});
+    }
+
+    tiramisu_profile_counters &counters = p.regions[id->second].counters;
+    counters.calls++;
+    counters.cycles += cycles;
+
+    if (hardware_counters.first >= 0 && hardware_counters_at_start.first >= 0)
+        counters.cache_misses = std::max<int64_t>(counters.cache_misses, 0) +
+                                hardware_counters.first - hardware_counters_at_start.first;
+    if (hardware_counters.second >= 0 && hardware_counters_at_start.second >= 0)
+        counters.instructions = std::max<int64_t>(counters.instructions, 0) +
+                                hardware_counters.second - hardware_counters_at_start.second;
+
+    return 0;
+}
+
+void tiramisu_profiler_enable_hardware_counters(int32_t enable)
+{
+    profiler::hardware_counters = (enable != 0);
+}
+
+int32_t tiramisu_profiler_nb_regions()
+{
+    profiler &p = profiler::get();
+    std::lock_guard<std::mutex> lock(p.mutex);
+
+    return p.regions.size();
+}
+
+int32_t tiramisu_profiler_get_region(int32_t region, const char **name, tiramisu_profile_counters *counters)
+{
+    profiler &p = profiler::get();
+    std::lock_guard<std::mutex> lock(p.mutex);
+
+    if (region < 0 || region >= (int32_t) p.regions.size())
+        return -1;
+
+    // The regions are never removed, so the name stays valid
+    *name = p.regions[region].name.c_str();
+    *counters = p.regions[region].counters;
+
+    return 0;
+}
+
+void tiramisu_profiler_reset()
+{
+    profiler &p = profiler::get();
+    std::lock_guard<std::mutex> lock(p.mutex);
+
+    for (auto &r : p.regions)
+        r.counters = {0, 0, -1, -1};
+}
+
+void tiramisu_profiler_print()
+{
+    profiler &p = profiler::get();
+    std::lock_guard<std::mutex> lock(p.mutex);
+
+    std::vector<profiler::region> regions = p.regions;
+    std::stable_sort(regions.begin(), regions.end(), [](const profiler::region &a, const profiler::region &b) {
+        return a.counters.cycles > b.counters.cycles;
+    });
+
+    uint64_t total = 0;
+    for (const auto &r : regions)
+        total += r.counters.cycles;
+
+    std::stringstream report;
+    for (const auto &r : regions)
+    {
+        report << r.name << ": " << r.counters.calls << " calls, " << r.counters.cycles << " cycles ("
+               << (total > 0 ? 100.0 * r.counters.cycles / total : 0.0) << "%)";
+        if (r.counters.cache_misses >= 0)
+            report << ", " << r.counters.cache_misses << " cache misses";
+        if (r.counters.instructions >= 0)
+            report << ", " << r.counters.instructions << " instructions";
+        report << "\n";
+    }
+
+    std::cerr << report.str();
+}
+
+void tiramisu_io_stream_set_reader(int32_t stream, tiramisu_io_stream_callback reader, void *user_data)
+{
+    io_stream &s = io_stream::get(stream);
+    s.unbind();
+    s.callback = reader;
+    s.user_data = user_data;
+}
+
+void tiramisu_io_stream_set_writer(int32_t stream, tiramisu_io_stream_callback writer, void *user_data)
+{
+    tiramisu_io_stream_set_reader(stream, writer, user_data);
+}
+
+int32_t tiramisu_io_stream_map_file(int32_t stream, const char *path, int32_t nb_dims, const int64_t *extent,
+                                    int32_t element_size, int32_t writable)
+{
+    io_stream &s = io_stream::get(stream);
+    s.unbind();
+
+    size_t size = element_size;
+    for (int d = 0; d < nb_dims; d++)
+    {
+        s.file_extent[d] = extent[d];
+        size *= extent[d];
+    }
+
+    int fd = open(path, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (fd < 0)
+        return -1;
+    if (writable && ftruncate(fd, size) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    void *mapping = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return -1;
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    s.mapping = (char *) mapping;
+    s.mapping_size = size;
+
+    return 0;
+}
+
+void tiramisu_io_stream_close(int32_t stream)
+{
+    io_stream::get(stream).unbind();
+}
+
+int32_t tiramisu_io_stream_read(int32_t stream, void *chunk, int32_t element_size, int32_t nb_dims,
+                                int64_t lower0, int64_t lower1, int64_t lower2, int64_t lower3,
+                                int64_t upper0, int64_t upper1, int64_t upper2, int64_t upper3,
+                                int64_t shape0, int64_t shape1, int64_t shape2, int64_t shape3)
+{
+    int64_t lower[4] = {lower0, lower1, lower2, lower3};
+    int64_t upper[4] = {upper0, upper1, upper2, upper3};
+    int64_t shape[4] = {shape0, shape1, shape2, shape3};
+    io_stream::get(stream).enqueue(make_io_transfer(false, chunk, element_size, nb_dims, lower, upper, shape));
+
+    return 0;
+}
+
+int32_t tiramisu_io_stream_write(int32_t stream, void *chunk, int32_t element_size, int32_t nb_dims,
+                                 int64_t lower0, int64_t lower1, int64_t lower2, int64_t lower3,
+                                 int64_t upper0, int64_t upper1, int64_t upper2, int64_t upper3,
+                                 int64_t shape0, int64_t shape1, int64_t shape2, int64_t shape3)
+{
+    int64_t lower[4] = {lower0, lower1, lower2, lower3};
+    int64_t upper[4] = {upper0, upper1, upper2, upper3};
+    int64_t shape[4] = {shape0, shape1, shape2, shape3};
+    io_stream::get(stream).enqueue(make_io_transfer(true, chunk, element_size, nb_dims, lower, upper, shape));
+
+    return 0;
+}
+
+int32_t tiramisu_io_stream_wait(int32_t stream, void *chunk, int32_t element_size, int32_t nb_dims,
+                                int64_t lower0, int64_t lower1, int64_t lower2, int64_t lower3,
+                                int64_t upper0, int64_t upper1, int64_t upper2, int64_t upper3,
+                                int64_t shape0, int64_t shape1, int64_t shape2, int64_t shape3)
+{
+    io_box box;
+    box.nb_dims = nb_dims;
+    int64_t lower[4] = {lower0, lower1, lower2, lower3};
+    int64_t upper[4] = {upper0, upper1, upper2, upper3};
+    std::copy(lower, lower + 4, box.lower);
+    std::copy(upper, upper + 4, box.upper);
+    io_stream::get(stream).wait(box);
+
+    return 0;
+}
+
+int32_t tiramisu_io_stream_flush(int32_t stream)
+{
+    io_stream::get(stream).flush();
+
+    return 0;
+}
+
 int8_t *tiramisu_address_of_int8(halide_buffer_t *buffer, unsigned long index) {
     return &(((int8_t*)(buffer->host))[index]);
 }
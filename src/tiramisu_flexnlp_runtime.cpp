@@ -0,0 +1,578 @@
+//
+// Asynchronous runtime for the FlexNLP accelerators.
+//
+// The calls are queued per device and run by two workers per device: one for
+// the transfers and one for the operators, so that the host, the transfers
+// and the operators of the different accelerators overlap.  The runtime only
+// calls the synchronous entry points of the FlexNLP wrappers, whose elements
+// are int8.
+//
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+extern "C" {
+int32_t tiramisu_flexnlp_initialize(int32_t number_of_devices);
+int32_t tiramisu_flexnlp_finalize(int32_t);
+int32_t tiramisu_flexnlp_load_weights(void *host_data, int32_t offset, int32_t num_elem, int32_t device_id);
+int32_t tiramisu_flexnlp_load_input(void *host_data, int32_t offset, int32_t num_elem, int32_t device_id);
+int32_t tiramisu_flexnlp_store_output(void *host_data, int32_t offset, int32_t num_elem, int32_t device_id);
+int32_t tiramisu_flexnlp_run_lstm(void *x_in, void *W_in, void *output, void *h_out,
+                                  int32_t input_size, int32_t hidden_size, int32_t output_size,
+                                  int32_t timesteps, int32_t batch_size, int32_t layer_number,
+                                  int32_t load_weight, int32_t device_id);
+int32_t tiramisu_flexnlp_run_lstm_manual(void *x_in, void *W_in, void *output, void *h_out,
+                                         int32_t input_size, int32_t hidden_size, int32_t output_size,
+                                         int32_t timesteps, int32_t batch_size, int32_t layer_number,
+                                         int32_t device_id);
+int32_t tiramisu_flexnlp_run_partitioned_lstm(void *x_in, void *W_in, void *output, void *h_out,
+                                              int32_t input_size, int32_t hidden_size, int32_t output_size,
+                                              int32_t timesteps, int32_t batch_size, int32_t layer_number,
+                                              int32_t load_weight, int32_t device_id);
+int32_t tiramisu_flexnlp_run_partitioned_lstm_multi(void *x_in, void *W_in, void *output, void *h_out,
+                                                    int32_t input_size, int32_t hidden_size, int32_t output_size,
+                                                    int32_t timesteps, int32_t batch_size, int32_t layer_number);
+}
+
+namespace {
+    // The number of operators whose data can be on a device at the same time:
+    // the transfers of the next operator run while the current one computes.
+    // Set to 1 if the wrappers cannot transfer while an operator runs.
+    constexpr size_t buffers_per_device = 2;
+
+    // The time per batch row of an operator before any has been measured.
+    constexpr double default_seconds_per_row = 1e-3;
+
+    enum class command_kind { load, store, compute, exclusive };
+
+    struct host_range
+    {
+        const char *begin;
+        const char *end;
+        bool write;
+    };
+
+    struct command
+    {
+        uint64_t id;
+        int device;
+        command_kind kind;
+        // The commands that must be finished before this one starts.
+        std::vector<uint64_t> dependencies;
+        // The host memory read or written by the command.
+        std::vector<host_range> ranges;
+        // The number of batch rows of an operator, to measure the devices.
+        int64_t rows;
+        double estimated_seconds;
+        std::function<int32_t()> run;
+    };
+
+    struct device_state
+    {
+        std::list<std::shared_ptr<command>> transfers, computes;
+        // The ids of the commands of the device, in the order of enqueueing.
+        std::vector<uint64_t> loads, stores, operators;
+        double pending_seconds = 0;
+        double seconds_per_row = default_seconds_per_row;
+        std::thread transfer_worker, compute_worker;
+    };
+
+    struct staging_buffer
+    {
+        std::vector<int8_t> data;
+        // The command that last used the buffer.
+        uint64_t last_use = 0;
+    };
+
+    std::mutex runtime_mutex;
+    std::condition_variable runtime_changed;
+    std::vector<std::unique_ptr<device_state>> devices;
+    // Two staging buffers per device for the hidden states of the batch
+    // slices of tiramisu_flexnlp_async_run_lstm_balanced().
+    std::vector<std::array<staging_buffer, 2>> staging;
+    std::vector<int> next_staging;
+    std::list<std::shared_ptr<command>> unfinished;
+    std::unordered_set<uint64_t> unfinished_ids;
+    uint64_t next_id = 1;
+    uint64_t last_exclusive = 0;
+    int32_t first_error = 0;
+    bool stopping = false;
+
+    inline bool overlap(const host_range &a, const host_range &b)
+    {
+        return (a.write || b.write) && a.begin < b.end && b.begin < a.end;
+    }
+
+    inline host_range range(void *ptr, int64_t offset, int64_t size, bool write)
+    {
+        const char *begin = static_cast<const char *>(ptr) + offset;
+        return {begin, begin + size, write};
+    }
+
+    bool is_ready(const command &c)
+    {
+        for (uint64_t d : c.dependencies)
+            if (unfinished_ids.count(d) > 0)
+                return false;
+        return true;
+    }
+
+    // Must be called with runtime_mutex held.
+    uint64_t enqueue(int device, command_kind kind, std::vector<host_range> ranges, int64_t rows,
+                     std::function<int32_t()> run)
+    {
+        if (devices.empty())
+        {
+            std::cerr << "The FlexNLP asynchronous runtime is not initialized "
+                      << "(tiramisu_flexnlp_async_initialize)." << std::endl;
+            exit(1);
+        }
+        if (device < 0 || device >= (int) devices.size())
+        {
+            std::cerr << "Invalid FlexNLP device " << device << "." << std::endl;
+            exit(1);
+        }
+
+        auto c = std::make_shared<command>();
+        c->id = next_id++;
+        c->device = device;
+        c->kind = kind;
+        c->ranges = std::move(ranges);
+        c->rows = rows;
+        c->run = std::move(run);
+
+        device_state &state = *devices[device];
+        c->estimated_seconds = rows * state.seconds_per_row;
+
+        // Hazards on the host memory with the commands of all the devices
+        for (const auto &other : unfinished)
+        {
+            bool conflict = (kind == command_kind::exclusive);
+            for (size_t i = 0; i < c->ranges.size() && !conflict; i++)
+                for (const auto &r : other->ranges)
+                    if (overlap(c->ranges[i], r))
+                    {
+                        conflict = true;
+                        break;
+                    }
+            if (conflict)
+                c->dependencies.push_back(other->id);
+        }
+        if (last_exclusive != 0)
+            c->dependencies.push_back(last_exclusive);
+
+        // The order of the commands on the device: an operator uses the data
+        // loaded before it, and the data of an operator stays on the device
+        // until it is stored, so a load or an operator only waits for the
+        // operator (or store) that used the same buffer of the device.
+        switch (kind)
+        {
+        case command_kind::load:
+            if (!state.loads.empty())
+                c->dependencies.push_back(state.loads.back());
+            if (state.operators.size() >= buffers_per_device)
+                c->dependencies.push_back(state.operators[state.operators.size() - buffers_per_device]);
+            state.loads.push_back(c->id);
+            break;
+        case command_kind::store:
+            if (!state.stores.empty())
+                c->dependencies.push_back(state.stores.back());
+            if (!state.operators.empty())
+                c->dependencies.push_back(state.operators.back());
+            state.stores.push_back(c->id);
+            break;
+        case command_kind::compute:
+        case command_kind::exclusive:
+            if (!state.operators.empty())
+                c->dependencies.push_back(state.operators.back());
+            if (!state.loads.empty())
+                c->dependencies.push_back(state.loads.back());
+            if (state.stores.size() >= buffers_per_device)
+                c->dependencies.push_back(state.stores[state.stores.size() - buffers_per_device]);
+            state.operators.push_back(c->id);
+            state.pending_seconds += c->estimated_seconds;
+            break;
+        }
+        if (kind == command_kind::exclusive)
+            last_exclusive = c->id;
+
+        if (kind == command_kind::load || kind == command_kind::store)
+            state.transfers.push_back(c);
+        else
+            state.computes.push_back(c);
+        unfinished.push_back(c);
+        unfinished_ids.insert(c->id);
+
+        runtime_changed.notify_all();
+        return c->id;
+    }
+
+    // Run the transfers (or the operators) of the device \p device: the
+    // first one that is ready in the order of the queue.
+    void worker(int device, bool transfers)
+    {
+        std::unique_lock<std::mutex> lock(runtime_mutex);
+        while (true)
+        {
+            device_state &state = *devices[device];
+            auto &queue = transfers ? state.transfers : state.computes;
+
+            auto ready = std::find_if(queue.begin(), queue.end(),
+                                      [](const std::shared_ptr<command> &c) { return is_ready(*c); });
+            if (ready == queue.end())
+            {
+                if (stopping && queue.empty())
+                    return;
+                runtime_changed.wait(lock);
+                continue;
+            }
+
+            std::shared_ptr<command> c = *ready;
+            queue.erase(ready);
+
+            lock.unlock();
+            auto start = std::chrono::steady_clock::now();
+            int32_t status = c->run();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            lock.lock();
+
+            if (status != 0 && first_error == 0)
+            {
+                std::cerr << "FlexNLP command failed on device " << device << " with status " << status << std::endl;
+                first_error = status;
+            }
+            if (c->kind == command_kind::compute || c->kind == command_kind::exclusive)
+            {
+                state.pending_seconds = std::max(0.0, state.pending_seconds - c->estimated_seconds);
+                if (c->rows > 0)
+                    state.seconds_per_row = 0.5 * state.seconds_per_row + 0.5 * elapsed.count() / c->rows;
+            }
+            unfinished.remove(c);
+            unfinished_ids.erase(c->id);
+            runtime_changed.notify_all();
+        }
+    }
+
+    // Must be called with runtime_mutex held.
+    int least_loaded_device(int64_t rows)
+    {
+        int best = 0;
+        for (int d = 1; d < (int) devices.size(); d++)
+            if (devices[d]->pending_seconds + rows * devices[d]->seconds_per_row <
+                devices[best]->pending_seconds + rows * devices[best]->seconds_per_row)
+                best = d;
+        return best;
+    }
+
+    // Split \p rows between the devices so that they all finish their
+    // pending work and their slice at about the same time.  Must be called
+    // with runtime_mutex held.
+    std::vector<int64_t> balance_rows(int64_t rows)
+    {
+        size_t n = devices.size();
+        double low = 0, high = 0;
+        for (const auto &d : devices)
+            high = std::max(high, d->pending_seconds + rows * d->seconds_per_row);
+
+        // The earliest time by which all the rows can be finished
+        for (int iteration = 0; iteration < 64; iteration++)
+        {
+            double finish = (low + high) / 2;
+            double capacity = 0;
+            for (const auto &d : devices)
+                capacity += std::max(0.0, (finish - d->pending_seconds) / d->seconds_per_row);
+            if (capacity >= rows)
+                high = finish;
+            else
+                low = finish;
+        }
+
+        std::vector<int64_t> slices(n, 0);
+        int64_t assigned = 0;
+        for (size_t d = 0; d < n; d++)
+        {
+            slices[d] = std::min<int64_t>(rows - assigned, std::max(0.0, (high - devices[d]->pending_seconds) /
+                                                                          devices[d]->seconds_per_row));
+            assigned += slices[d];
+        }
+        // The rows lost by the rounding go to the devices that finish first
+        while (assigned < rows)
+        {
+            size_t best = 0;
+            for (size_t d = 1; d < n; d++)
+                if (devices[d]->pending_seconds + (slices[d] + 1) * devices[d]->seconds_per_row <
+                    devices[best]->pending_seconds + (slices[best] + 1) * devices[best]->seconds_per_row)
+                    best = d;
+            slices[best]++;
+            assigned++;
+        }
+        return slices;
+    }
+
+    // The host memory of an LSTM operator: the input and the output of
+    // batch_size x timesteps rows, the hidden states and the weights of the
+    // layers up to layer_number.
+    std::vector<host_range> lstm_ranges(void *x_in, void *W_in, void *output, void *h_out,
+                                        int32_t input_size, int32_t hidden_size,
+                                        int32_t timesteps, int32_t batch_size, int32_t layer_number)
+    {
+        int64_t layers = std::max(layer_number, 0) + 1;
+        return {range(x_in, 0, (int64_t) timesteps * batch_size * input_size, false),
+                range(W_in, 0, layers * 4 * hidden_size * (input_size + hidden_size), false),
+                range(output, 0, (int64_t) timesteps * batch_size * hidden_size, true),
+                range(h_out, 0, layers * batch_size * hidden_size, true)};
+    }
+
+    // Wait until the commands of \p device (of all the devices if it is
+    // negative) are finished.  Must be called with \p lock held.
+    void wait_for(std::unique_lock<std::mutex> &lock, int device)
+    {
+        runtime_changed.wait(lock, [device] {
+            for (const auto &c : unfinished)
+                if (device < 0 || c->device == device)
+                    return false;
+            return true;
+        });
+    }
+}
+
+extern "C"
+int32_t tiramisu_flexnlp_async_initialize(int32_t number_of_devices)
+{
+    int32_t status = tiramisu_flexnlp_initialize(number_of_devices);
+
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    stopping = false;
+    first_error = 0;
+    last_exclusive = 0;
+    staging.resize(number_of_devices);
+    next_staging.assign(number_of_devices, 0);
+    for (int d = 0; d < number_of_devices; d++)
+    {
+        devices.emplace_back(new device_state());
+        devices[d]->transfer_worker = std::thread(worker, d, true);
+        devices[d]->compute_worker = std::thread(worker, d, false);
+    }
+    return status;
+}
+
+extern "C"
+int32_t tiramisu_flexnlp_async_synchronize(int32_t device_id)
+{
+    std::unique_lock<std::mutex> lock(runtime_mutex);
+    wait_for(lock, device_id);
+    int32_t status = first_error;
+    first_error = 0;
+    return status;
+}
+
+extern "C"
+int32_t tiramisu_flexnlp_async_finalize(int32_t)
+{
+    int32_t status = tiramisu_flexnlp_async_synchronize(-1);
+    {
+        std::lock_guard<std::mutex> lock(runtime_mutex);
+        stopping = true;
+        runtime_changed.notify_all();
+    }
+    for (auto &d : devices)
+    {
+        d->transfer_worker.join();
+        d->compute_worker.join();
+    }
+    devices.clear();
+    staging.clear();
+    next_staging.clear();
+
+    int32_t finalize_status = tiramisu_flexnlp_finalize(0);
+    return status != 0 ? status : finalize_status;
+}
+
+extern "C"
+int32_t tiramisu_flexnlp_async_load_weights(void *host_data, int32_t offset, int32_t num_elem, int32_t device_id)
+{
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    enqueue(device_id, command_kind::load, {range(host_data, offset, num_elem, false)}, 0,
+            [=] { return tiramisu_flexnlp_load_weights(host_data, offset, num_elem, device_id); });
+    return 0;
+}
+
+extern "C"
+int32_t tiramisu_flexnlp_async_load_input(void *host_data, int32_t offset, int32_t num_elem, int32_t device_id)
+{
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    enqueue(device_id, command_kind::load, {range(host_data, offset, num_elem, false)}, 0,
+            [=] { return tiramisu_flexnlp_load_input(host_data, offset, num_elem, device_id); });
+    return 0;
+}
+
+extern "C"
+int32_t tiramisu_flexnlp_async_store_output(void *host_data, int32_t offset, int32_t num_elem, int32_t device_id)
+{
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    enqueue(device_id, command_kind::store, {range(host_data, offset, num_elem, true)}, 0,
+            [=] { return tiramisu_flexnlp_store_output(host_data, offset, num_elem, device_id); });
+    return 0;
+}
+
+extern "C"
+int32_t tiramisu_flexnlp_async_run_lstm(void *x_in, void *W_in, void *output, void *h_out,
+                                        int32_t input_size, int32_t hidden_size, int32_t output_size,
+                                        int32_t timesteps, int32_t batch_size, int32_t layer_number,
+                                        int32_t load_weight, int32_t device_id)
+{
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    // Without the weights, the operator needs the device that holds them
+    if (device_id < 0)
+        device_id = load_weight ? least_loaded_device(batch_size) : 0;
+    enqueue(device_id, command_kind::compute,
+            lstm_ranges(x_in, W_in, output, h_out, input_size, hidden_size, timesteps, batch_size, layer_number),
+            batch_size,
+            [=] {
+                return tiramisu_flexnlp_run_lstm(x_in, W_in, output, h_out, input_size, hidden_size, output_size,
+                                                 timesteps, batch_size, layer_number, load_weight, device_id);
+            });
+    return 0;
+}
+
+extern "C"
+int32_t tiramisu_flexnlp_async_run_lstm_manual(void *x_in, void *W_in, void *output, void *h_out,
+                                               int32_t input_size, int32_t hidden_size, int32_t output_size,
+                                               int32_t timesteps, int32_t batch_size, int32_t layer_number,
+                                               int32_t device_id)
+{
+    // The data of the operator is loaded and stored by separate commands
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    enqueue(device_id, command_kind::compute, {}, batch_size,
+            [=] {
+                return tiramisu_flexnlp_run_lstm_manual(x_in, W_in, output, h_out, input_size, hidden_size,
+                                                        output_size, timesteps, batch_size, layer_number,
+                                                        device_id);
+            });
+    return 0;
+}
+
+extern "C"
+int32_t tiramisu_flexnlp_async_run_partitioned_lstm(void *x_in, void *W_in, void *output, void *h_out,
+                                                    int32_t input_size, int32_t hidden_size, int32_t output_size,
+                                                    int32_t timesteps, int32_t batch_size, int32_t layer_number,
+                                                    int32_t load_weight, int32_t device_id)
+{
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    enqueue(device_id, command_kind::compute,
+            lstm_ranges(x_in, W_in, output, h_out, input_size, hidden_size, timesteps, batch_size, layer_number),
+            batch_size,
+            [=] {
+                return tiramisu_flexnlp_run_partitioned_lstm(x_in, W_in, output, h_out, input_size, hidden_size,
+                                                             output_size, timesteps, batch_size, layer_number,
+                                                             load_weight, device_id);
+            });
+    return 0;
+}
+
+extern "C"
+int32_t tiramisu_flexnlp_async_run_partitioned_lstm_multi(void *x_in, void *W_in, void *output, void *h_out,
+                                                          int32_t input_size, int32_t hidden_size,
+                                                          int32_t output_size, int32_t timesteps,
+                                                          int32_t batch_size, int32_t layer_number)
+{
+    // The wrapper drives all the devices itself: it runs alone
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    enqueue(0, command_kind::exclusive,
+            lstm_ranges(x_in, W_in, output, h_out, input_size, hidden_size, timesteps, batch_size, layer_number),
+            0,
+            [=] {
+                return tiramisu_flexnlp_run_partitioned_lstm_multi(x_in, W_in, output, h_out, input_size,
+                                                                   hidden_size, output_size, timesteps,
+                                                                   batch_size, layer_number);
+            });
+    return 0;
+}
+
+/**
+ * Run an LSTM operator whose batch is split between all the devices, in
+ * slices proportional to the measured speed of each device and to the work
+ * already queued on it.  The rows of the batch are the outermost dimension of
+ * x_in and of output, so the slices of the input and of the output are
+ * contiguous; the slices of the hidden states are gathered into one of the
+ * two staging buffers of each device, and scattered back by the transfer
+ * worker of the device once its operator is finished.
+ */
+extern "C"
+int32_t tiramisu_flexnlp_async_run_lstm_balanced(void *x_in, void *W_in, void *output, void *h_out,
+                                                 int32_t input_size, int32_t hidden_size, int32_t output_size,
+                                                 int32_t timesteps, int32_t batch_size, int32_t layer_number)
+{
+    std::unique_lock<std::mutex> lock(runtime_mutex);
+    std::vector<int64_t> slices = balance_rows(batch_size);
+
+    int64_t layers = std::max(layer_number, 0) + 1;
+    int64_t first_row = 0;
+    for (int d = 0; d < (int) devices.size(); d++)
+    {
+        int64_t rows = slices[d];
+        if (rows == 0)
+            continue;
+
+        int8_t *x_slice = static_cast<int8_t *>(x_in) + first_row * timesteps * input_size;
+        int8_t *output_slice = static_cast<int8_t *>(output) + first_row * timesteps * hidden_size;
+        int8_t *h_out_rows = static_cast<int8_t *>(h_out) + first_row * hidden_size;
+
+        // Reuse the staging buffer of the device once the command that last
+        // used it is finished (double buffering)
+        staging_buffer &buffer = staging[d][next_staging[d]];
+        next_staging[d] = 1 - next_staging[d];
+        uint64_t previous_use = buffer.last_use;
+        runtime_changed.wait(lock, [previous_use] { return unfinished_ids.count(previous_use) == 0; });
+        buffer.data.resize(layers * rows * hidden_size);
+        int8_t *h_staging = buffer.data.data();
+
+        std::vector<host_range> h_rows;
+        for (int64_t l = 0; l < layers; l++)
+            h_rows.push_back(range(h_out_rows, l * batch_size * hidden_size, rows * hidden_size, true));
+
+        auto gather_ranges = h_rows;
+        for (auto &r : gather_ranges)
+            r.write = false;
+        enqueue(d, command_kind::load, gather_ranges, 0, [=] {
+            for (int64_t l = 0; l < layers; l++)
+                memcpy(h_staging + l * rows * hidden_size, h_out_rows + l * batch_size * hidden_size,
+                       rows * hidden_size);
+            return 0;
+        });
+
+        enqueue(d, command_kind::compute,
+                {range(x_slice, 0, rows * timesteps * input_size, false),
+                 range(W_in, 0, layers * 4 * hidden_size * (input_size + hidden_size), false),
+                 range(output_slice, 0, rows * timesteps * hidden_size, true)},
+                rows,
+                [=] {
+                    return tiramisu_flexnlp_run_lstm(x_slice, W_in, output_slice, h_staging, input_size,
+                                                     hidden_size, output_size, timesteps, rows, layer_number,
+                                                     1, d);
+                });
+
+        buffer.last_use = enqueue(d, command_kind::store, h_rows, 0, [=] {
+            for (int64_t l = 0; l < layers; l++)
+                memcpy(h_out_rows + l * batch_size * hidden_size, h_staging + l * rows * hidden_size,
+                       rows * hidden_size);
+            return 0;
+        });
+
+        first_row += rows;
+    }
+    return 0;
+}
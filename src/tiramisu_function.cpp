@@ -9,9 +9,20 @@
 #include <isl/union_set.h>
 #include <isl/ast_build.h>
 #include <isl/ilp.h>
+#include <isl/schedule.h>
+#include <isl/schedule_node.h>
 
 #include <tiramisu/debug.h>
 #include <tiramisu/core.h>
+#include <tiramisu/utils.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
 
 namespace tiramisu
 {
@@ -23,6 +34,13 @@ namespace tiramisu
 isl_ast_node *for_code_generator_after_for(
         isl_ast_node *node, isl_ast_build *build, void *user);
 
+int isl_map_get_static_dim(isl_map *map, int dim_pos);
+
+isl_map *add_eq_to_schedule_map(int dim0, int in_dim_coefficient, int out_dim_coefficient,
+                                int const_conefficient, isl_map *sched);
+
+isl_map *isl_map_add_dim_and_eq_constraint(isl_map *map, int dim_pos, int constant);
+
 isl_map *isl_map_align_range_dims(isl_map *map, int max_dim)
 {
     DEBUG_FCT_NAME(10);
@@ -92,6 +110,11 @@ function::function(std::string name)
     this->halide_stmt = Halide::Internal::Stmt();
     this->ast = NULL;
     this->context_set = NULL;
+    this->dep_read_after_write = NULL;
+    this->dep_write_after_write = NULL;
+    this->dep_write_after_read = NULL;
+    this->live_in_access = NULL;
+    this->live_out_access = NULL;
     this->use_low_level_scheduling_commands = false;
     this->_needs_rank_call = false;
 
@@ -174,6 +197,42 @@ void tiramisu::function::calculate_dep_flow()
 
     isl_union_map * ref_res = this->compute_dep_graph();
 
+    // The dependences only change if the domains, the accesses or the schedules
+    // used for the analysis change : reuse the previous result otherwise.
+    auto append_str = [](std::string &signature, char *str)
+    {
+        signature += std::string(str) + "\n";
+        free(str);
+    };
+
+    std::string signature;
+
+    if (ref_res != NULL)
+        append_str(signature, isl_union_map_to_str(ref_res));
+
+    for(auto& comput : this->get_computations())
+    {
+        signature += comput->get_name() + "\n";
+        append_str(signature, isl_set_to_str(comput->get_iteration_domain()));
+        append_str(signature, isl_map_to_str(comput->get_access_relation()));
+        append_str(signature, isl_map_to_str(comput->get_schedule()));
+    }
+
+    if ((this->dep_read_after_write != NULL) && (signature == this->dep_flow_signature))
+    {
+        DEBUG(3, tiramisu::str_dump(" Inputs of the dependence analysis did not change, reusing previous dependencies "));
+
+        if (ref_res != NULL)
+            isl_union_map_free(ref_res);
+
+        DEBUG_INDENT(-4);
+
+        return ;
+    }
+
+    this->free_dependencies();
+    this->dep_flow_signature = signature;
+
     if(ref_res == NULL)
     {
         // no deps fill with empty union maps
@@ -356,6 +415,21 @@ void tiramisu::function::calculate_dep_flow()
 
 }
 
+void tiramisu::function::free_dependencies()
+{
+    for (isl_union_map **dep : {&this->dep_read_after_write, &this->dep_write_after_write,
+                                &this->dep_write_after_read, &this->live_in_access,
+                                &this->live_out_access})
+    {
+        if (*dep != NULL)
+            isl_union_map_free(*dep);
+
+        *dep = NULL;
+    }
+
+    this->dep_flow_signature.clear();
+}
+
 const std::map<std::string, tiramisu::buffer *> tiramisu::function::get_mapping() const
 {
   return this->mapping;
@@ -366,14 +440,70 @@ void  tiramisu::function::add_mapping(std::pair<std::string,tiramisu::buffer *>
   this->mapping.insert(p);
 }
 
+/**
+ * Return the contiguous range of elements (in row-major order) of the buffer
+ * \p b that contains the region \p region, as an element offset and a number
+ * of elements.  Return false if the range cannot be computed statically or if
+ * it covers the whole buffer, in which case the whole buffer should be copied.
+ */
+static bool get_contiguous_copy_range(tiramisu::buffer *b, isl_union_set *region, int64_t &offset, int64_t &count)
+{
+    if (!b->has_constant_extents() || isl_union_set_is_empty(region) == isl_bool_true)
+        return false;
+
+    isl_set *s = isl_set_from_union_set(isl_union_set_copy(region));
+    int n_dims = b->get_dim_sizes().size();
+    if (isl_set_dim(s, isl_dim_set) != n_dims)
+    {
+        isl_set_free(s);
+        return false;
+    }
+
+    // The linear index of an element is sum(i_k * stride_k), where the
+    // innermost dimension is the last one.
+    isl_aff *index = isl_aff_zero_on_domain(isl_local_space_from_space(isl_set_get_space(s)));
+    int64_t stride = 1;
+    for (int i = n_dims - 1; i >= 0; i--)
+    {
+        index = isl_aff_set_coefficient_si(index, isl_dim_in, i, stride);
+        stride *= b->get_dim_sizes()[i].get_int_val();
+    }
+
+    isl_val *min = isl_set_min_val(s, index);
+    isl_val *max = isl_set_max_val(s, index);
+    bool bounded = isl_val_is_int(min) && isl_val_is_int(max);
+    if (bounded)
+    {
+        offset = std::max<int64_t>(isl_val_get_num_si(min), 0);
+        count = std::min<int64_t>(isl_val_get_num_si(max) + 1, stride) - offset;
+    }
+    isl_val_free(min);
+    isl_val_free(max);
+    isl_aff_free(index);
+    isl_set_free(s);
+
+    return bounded && count > 0 && count < stride;
+}
+
 /**
  * This function takes computation pts to C1 and C2 which are the first and the last computation
  * of the fucntion.
  * Automatic_communication fonction verifies if the user wants to manage the copies manually or not.
- * By default, the data management will be done automatically, and the copies will be inserted
- * in the beginning and at the end of the gpu funcion.
- * The inputs of the function will be copied to the device before the computations, and the
- * outputs of the functions will be copied back to the host at the end.
+ * By default, the data management will be done automatically.
+ *
+ * The copies are placed by a data-movement analysis that tracks, for each CPU buffer that has a
+ * corresponding GPU buffer, which elements are up to date on the device and which elements of the
+ * host copy are stale.  The computations of the function are visited in their execution order,
+ * grouped in the sequences of computations that are fused below the root level:
+ *  - a group that reads the GPU buffer is preceded by a host-to-device copy of the elements it
+ *    reads and that are not already on the device (nothing is copied if an earlier GPU
+ *    computation produced them or if they were already copied),
+ *  - a group that accesses the CPU buffer is preceded by a device-to-host copy of the elements
+ *    written by the GPU that it reads,
+ *  - the elements of output buffers written by the GPU and not copied back yet are copied to
+ *    the host at the end of the function.
+ * Each copy only moves the contiguous range of elements that contains the accessed region,
+ * which is computed from the access relations of the computations (see gpu_copy_regions).
  * We have two cases copies to constant memory and the default case which is copies to the global memory.
  */
 void function::Automatic_communication(tiramisu::computation* c1, tiramisu::computation* c2)
@@ -387,8 +517,57 @@ void function::Automatic_communication(tiramisu::computation* c1, tiramisu::comp
     std::map<std::string, tiramisu::buffer*>::iterator it;
     std::string name, cpt_name;
     int i = 1;
-    tiramisu::computation* first_cpt = c1;
-    tiramisu::computation* last_cpt = c2;
+
+    // Group the computations in their execution order: a new group starts
+    // whenever a computation is ordered after its predecessor at the root level.
+    std::vector<std::vector<tiramisu::computation *>> groups;
+    for (tiramisu::computation *c = c1; c != nullptr; c = c->get_successor())
+    {
+        tiramisu::computation *pred = c->get_predecessor();
+        if (pred == nullptr || this->sched_graph[pred][c] == computation::root_dimension)
+            groups.push_back({});
+        groups.back().push_back(c);
+    }
+
+    // The regions of each buffer that are read and written by each group.
+    std::vector<std::map<std::string, isl_union_set *>> reads(groups.size()), writes(groups.size());
+    auto add_region = [](std::map<std::string, isl_union_set *> &regions, isl_set *region) {
+        std::string buffer_name = isl_set_get_tuple_name(region);
+        isl_union_set *r = isl_union_set_from_set(region);
+        if (regions.count(buffer_name) != 0)
+            r = isl_union_set_union(regions[buffer_name], r);
+        regions[buffer_name] = r;
+    };
+    for (size_t g = 0; g < groups.size(); g++)
+        for (tiramisu::computation *c : groups[g])
+        {
+            if (!c->get_expr().is_defined() || c->is_let_stmt() || c->get_access_relation() == nullptr)
+                continue;
+            add_region(writes[g], isl_set_apply(isl_set_copy(c->get_iteration_domain()),
+                                                isl_map_copy(c->get_access_relation())));
+            std::vector<isl_map *> accesses;
+            generator::get_rhs_accesses(this, c, accesses, true);
+            for (isl_map *access : accesses)
+                if (isl_map_has_tuple_name(access, isl_dim_out) == isl_bool_true)
+                    add_region(reads[g], isl_set_apply(isl_set_copy(c->get_iteration_domain()), access));
+                else
+                    isl_map_free(access);
+        }
+
+    // Returns the region of the buffer \p buffer_name accessed in \p regions,
+    // renamed to \p name so that host and device regions can be compared.
+    auto get_region = [](std::map<std::string, isl_union_set *> &regions, const std::string &buffer_name,
+                         const std::string &name) -> isl_union_set * {
+        auto r = regions.find(buffer_name);
+        if (r == regions.end())
+            return nullptr;
+        isl_set *s = isl_set_from_union_set(isl_union_set_copy(r->second));
+        return isl_union_set_from_set(isl_set_set_tuple_name(s, name.c_str()));
+    };
+
+    // The copies to insert before each group, and at the end of the function.
+    std::vector<std::vector<tiramisu::computation *>> copies_before(groups.size());
+    std::vector<tiramisu::computation *> copies_at_end;
 
     for (it = mp.begin(); it != mp.end(); ++it)
     {
@@ -396,42 +575,156 @@ void function::Automatic_communication(tiramisu::computation* c1, tiramisu::comp
         assert(it->second->get_argument_type() == tiramisu::a_temporary  && "Mapping field should contain a string corresponding to the name of a cpu buffer and a ptr to the corresponding gpu buffer ");
         if (it->second->automatic_gpu_copy == true)
         {
-            cpt_name= "cpt" + std::to_string(i);
-            i++;
-            switch (it->second->location)
+            tiramisu::buffer *host_b = buff.find(name)->second;
+            tiramisu::buffer *device_b = it->second;
+            bool constant = (device_b->location == cuda_ast::memory_location::constant);
+            // The host buffer holds meaningful data only if it is an input or an output of
+            // the function (outputs may be updated in place), or once a CPU computation wrote it.
+            bool host_defined = (host_b->get_argument_type() != tiramisu::a_temporary);
+            isl_union_set *device_valid = nullptr;
+            isl_union_set *host_stale = nullptr;
+
+            // Creates a copy of (the contiguous range containing) \p region.
+            auto make_copy = [&](isl_union_set *region, bool to_host) -> tiramisu::computation * {
+                cpt_name = "cpt" + std::to_string(i);
+                i++;
+                tiramisu::computation *c = to_host ?
+                    new tiramisu::computation(cpt_name, {}, memcpy(*device_b, *host_b)) :
+                    new tiramisu::computation(cpt_name, {}, memcpy(*host_b, *device_b));
+                int64_t offset, count;
+                if (!constant && region != nullptr && get_contiguous_copy_range(host_b, region, offset, count))
+                {
+                    DEBUG(3, tiramisu::str_dump("Copying " + std::to_string(count) + " elements of " + name +
+                                                " starting at element " + std::to_string(offset)));
+                    this->gpu_copy_regions[cpt_name] = std::make_pair(tiramisu::expr((int64_t) offset),
+                                                                      tiramisu::expr((int64_t) count));
+                }
+                return c;
+            };
+
+            // Prefetches to the GPU the part of a buffer in managed memory that \p region is in.
+            bool device_written = false;
+            auto make_prefetch = [&](isl_union_set *region) -> tiramisu::computation * {
+                cpt_name = "cpt" + std::to_string(i);
+                i++;
+                tiramisu::computation *c = new tiramisu::computation(cpt_name, {}, memcpy(*device_b, *device_b));
+                int64_t offset, count;
+                if (get_contiguous_copy_range(host_b, region, offset, count))
+                    this->gpu_copy_regions[cpt_name] = std::make_pair(tiramisu::expr((int64_t) offset),
+                                                                      tiramisu::expr((int64_t) count));
+                return c;
+            };
+
+            for (size_t g = 0; g < groups.size(); g++)
             {
-                case cuda_ast::memory_location::constant:
-                    if (buff.find(name)->second->get_argument_type() == tiramisu::a_input)
-                    {
-                        tiramisu::computation* c =  new tiramisu::computation(cpt_name, {},
-                            memcpy(*(buff.find(name)->second),(*(it->second))));
-                        (*c).then((*first_cpt), computation::root);
-                        first_cpt = c;
-                    }
-                    break;
-                default:
-                    if (buff.find(name)->second->get_argument_type() == tiramisu::a_input)
-                    {
-                        tiramisu::computation* c =  new tiramisu::computation(cpt_name, {},
-                            memcpy(*(buff.find(name)->second),(*(it->second))));
-                        (*c).then((*first_cpt), computation::root);
-                        first_cpt = c;
-                    }
-                    if (buff.find(name)->second->get_argument_type() == tiramisu::a_output)
+                isl_union_set *device_read = get_region(reads[g], device_b->get_name(), name);
+                isl_union_set *device_write = get_region(writes[g], device_b->get_name(), name);
+                isl_union_set *host_read = get_region(reads[g], name, name);
+                isl_union_set *host_write = get_region(writes[g], name, name);
+
+                // Elements read on the device and that are not there yet.
+                if (device_read != nullptr && host_defined)
+                {
+                    isl_union_set *missing = isl_union_set_copy(device_read);
+                    if (device_valid != nullptr)
+                        missing = isl_union_set_subtract(missing, isl_union_set_copy(device_valid));
+                    if (isl_union_set_is_empty(missing) == isl_bool_false)
+                        copies_before[g].push_back(make_copy(missing, false));
+                    isl_union_set_free(missing);
+                    device_valid = (device_valid == nullptr) ? isl_union_set_copy(device_read) :
+                                   isl_union_set_union(device_valid, isl_union_set_copy(device_read));
+                }
+
+                // Elements accessed on the host that were last written by the device.  Elements
+                // written by the host are also copied back so that a partial write does not
+                // lose the values produced by the device.
+                if ((host_read != nullptr || host_write != nullptr) && host_stale != nullptr && !constant)
+                {
+                    isl_union_set *accessed = (host_read != nullptr) ? isl_union_set_copy(host_read) :
+                                              isl_union_set_copy(host_write);
+                    if (host_read != nullptr && host_write != nullptr)
+                        accessed = isl_union_set_union(accessed, isl_union_set_copy(host_write));
+                    isl_union_set *missing = isl_union_set_intersect(accessed, isl_union_set_copy(host_stale));
+                    if (isl_union_set_is_empty(missing) == isl_bool_false)
                     {
-                        tiramisu::computation* c =  new tiramisu::computation(cpt_name, {},
-                            memcpy((*(it->second)),*(buff.find(name)->second)));
-                        (*last_cpt).then((*c), computation::root);
-                        last_cpt = c;
+                        copies_before[g].push_back(make_copy(missing, true));
+                        host_stale = isl_union_set_subtract(host_stale, isl_union_set_copy(missing));
                     }
-                    break;
+                    isl_union_set_free(missing);
+                }
+
+                if (device_b->is_gpu_managed() && (device_read != nullptr || device_write != nullptr))
+                {
+                    isl_union_set *accessed = (device_read != nullptr) ? isl_union_set_copy(device_read) :
+                                              isl_union_set_copy(device_write);
+                    if (device_read != nullptr && device_write != nullptr)
+                        accessed = isl_union_set_union(accessed, isl_union_set_copy(device_write));
+                    copies_before[g].push_back(make_prefetch(accessed));
+                    isl_union_set_free(accessed);
+                    device_written = device_written || device_write != nullptr;
+                }
+
+                if (device_write != nullptr)
+                {
+                    device_valid = (device_valid == nullptr) ? isl_union_set_copy(device_write) :
+                                   isl_union_set_union(device_valid, isl_union_set_copy(device_write));
+                    host_stale = (host_stale == nullptr) ? isl_union_set_copy(device_write) :
+                                 isl_union_set_union(host_stale, isl_union_set_copy(device_write));
+                }
+                if (host_write != nullptr)
+                {
+                    host_defined = true;
+                    if (device_valid != nullptr)
+                        device_valid = isl_union_set_subtract(device_valid, isl_union_set_copy(host_write));
+                }
+
+                for (isl_union_set *r : {device_read, device_write, host_read, host_write})
+                    if (r != nullptr)
+                        isl_union_set_free(r);
+            }
+
+            if (host_stale != nullptr)
+            {
+                if (host_b->get_argument_type() == tiramisu::a_output && !constant &&
+                    isl_union_set_is_empty(host_stale) == isl_bool_false)
+                    copies_at_end.push_back(make_copy(host_stale, true));
+                isl_union_set_free(host_stale);
             }
+            if (device_valid != nullptr)
+                isl_union_set_free(device_valid);
+            if (device_b->is_gpu_managed() && device_b->get_gpu_managed_advice() == tiramisu::managed_auto)
+                device_b->managed_advice = device_written ? tiramisu::managed_prefer_device : tiramisu::managed_read_mostly;
         }
         else
         {
             DEBUG(3, tiramisu::str_dump("Communication should be done manually !"));
         }
     }
+
+    for (auto *regions : {&reads, &writes})
+        for (auto &group_regions : *regions)
+            for (auto &r : group_regions)
+                isl_union_set_free(r.second);
+
+    // Schedule the copies.
+    for (size_t g = 0; g < groups.size(); g++)
+    {
+        tiramisu::computation *first = groups[g].front();
+        for (tiramisu::computation *c : copies_before[g])
+        {
+            tiramisu::computation *pred = first->get_predecessor();
+            if (pred == nullptr)
+                (*c).then(*first, computation::root);
+            else
+                (*c).between(*pred, computation::root_dimension, *first, computation::root_dimension);
+        }
+    }
+    tiramisu::computation* last_cpt = c2;
+    for (tiramisu::computation *c : copies_at_end)
+    {
+        (*last_cpt).then((*c), computation::root);
+        last_cpt = c;
+    }
 }
 
 // TODO: get_live_in_computations() does not consider the case of "maybe"
@@ -857,16 +1150,25 @@ void function::dump_sched_graph()
 bool function::is_sched_graph_tree_dfs(computation * comp,
                                        std::unordered_set<computation *> &visited)
 {
-    // Do not visit anything that was already returned
-    if (visited.find(comp) != visited.end())
-        return false;
-
-    visited.insert(comp);
+    // The graph is walked with an explicit stack: the chains of computations
+    // ordered with after() can be thousands of computations long.
+    std::vector<computation *> stack = {comp};
 
-    for (auto &edge: this->sched_graph[comp])
+    while (!stack.empty())
     {
-        if (!is_sched_graph_tree_dfs(edge.first, visited))
+        computation *c = stack.back();
+        stack.pop_back();
+
+        // Do not visit anything that was already returned
+        if (visited.find(c) != visited.end())
             return false;
+
+        visited.insert(c);
+
+        auto edges = this->sched_graph.find(c);
+        if (edges != this->sched_graph.end())
+            for (auto &edge: edges->second)
+                stack.push_back(edge.first);
     }
 
     return true;
@@ -941,6 +1243,11 @@ const std::vector<computation *> &function::get_computations() const
 {
     return body;
 }
+
+const std::vector<std::vector<computation *>> &function::get_blocks() const
+{
+    return blocks;
+}
 // @}
 
 /**
@@ -1103,6 +1410,83 @@ int function::get_unrolling_factor(const std::string &comp, int lev) const
     return unrolling_factor;
 }
 
+int function::get_doacross_distance(const std::string &comp, int lev) const
+{
+    assert(!comp.empty());
+    assert(lev >= 0);
+
+    for (const auto &dd : this->doacross_dimensions)
+        if ((std::get<0>(dd) == comp) && (std::get<1>(dd) == lev))
+            return std::get<2>(dd);
+
+    return -1;
+}
+
+int function::get_pipeline_depth(const std::string &comp, int lev) const
+{
+    assert(!comp.empty());
+    assert(lev >= 0);
+
+    for (const auto &pd : this->pipeline_dimensions)
+        if ((std::get<0>(pd) == comp) && (std::get<1>(pd) == lev))
+            return std::get<2>(pd);
+
+    return -1;
+}
+
+std::vector<tiramisu::expr> function::get_parametric_split_sizes(const std::string &comp, int lev) const
+{
+    assert(!comp.empty());
+    assert(lev >= 0);
+
+    for (const auto &ps : this->parametric_split_dimensions)
+        if ((std::get<0>(ps) == comp) && (std::get<1>(ps) == lev))
+            return std::get<2>(ps);
+
+    return {};
+}
+
+bool function::get_reduction_strategy(const std::string &comp, int lev, tiramisu::reduction_strategy_t &strategy,
+                                      int &nb_partials) const
+{
+    assert(!comp.empty());
+    assert(lev >= 0);
+
+    for (const auto &rd : this->reduction_dimensions)
+        if ((std::get<0>(rd) == comp) && (std::get<1>(rd) == lev))
+        {
+            strategy = std::get<2>(rd);
+            nb_partials = std::get<3>(rd);
+            return true;
+        }
+
+    return false;
+}
+
+int function::get_scan_blocks(const std::string &comp, int lev) const
+{
+    assert(!comp.empty());
+    assert(lev >= 0);
+
+    for (const auto &sd : this->scan_dimensions)
+        if ((std::get<0>(sd) == comp) && (std::get<1>(sd) == lev))
+            return std::get<2>(sd);
+
+    return -1;
+}
+
+std::vector<std::tuple<std::string, int, int>> function::get_prefetch_dimensions(const std::string &comp) const
+{
+    assert(!comp.empty());
+
+    std::vector<std::tuple<std::string, int, int>> prefetches;
+    for (const auto &pd : this->prefetch_dimensions)
+        if (std::get<0>(pd) == comp)
+            prefetches.push_back(std::make_tuple(std::get<1>(pd), std::get<2>(pd), std::get<3>(pd)));
+
+    return prefetches;
+}
+
 /**
 * Return the vector length of the computation \p comp at
 * at the loop level \p lev.
@@ -1138,6 +1522,15 @@ int function::get_vector_length(const std::string &comp, int lev) const
     return vector_length;
 }
 
+bool function::is_predicated_vector(const std::string &comp, int lev) const
+{
+    for (const auto &pd : this->predicated_vector_dimensions)
+        if ((pd.first == comp) && (pd.second == lev))
+            return true;
+
+    return false;
+}
+
 computation * function::get_first_cpt() {
     if (this->is_sched_graph_tree()) {
         tiramisu::computation* cpt = this->sched_graph.begin()->first;
@@ -1237,6 +1630,18 @@ bool function::should_distribute(const std::string &comp, int lev) const
     return found;
 }
 
+bool function::should_distribute_to_gpus(const std::string &comp, int lev) const
+{
+    assert(!comp.empty());
+    assert(lev >= 0);
+
+    for (const auto &pd : this->gpu_device_dimensions)
+        if ((pd.first == comp) && (pd.second == lev))
+            return true;
+
+    return false;
+}
+
 bool tiramisu::function::needs_rank_call() const
 {
     return _needs_rank_call;
@@ -1307,20 +1712,17 @@ void function::add_iterator_name(const std::string &iteratorName)
 
 void function::gen_halide_obj(const std::string &obj_file_name, Halide::Target::OS os, Halide::Target::Arch arch, int bits, bool gen_python) const
 {
-  Halide::Target target = Halide::get_host_target();
-  gen_halide_obj(obj_file_name, target.os, target.arch, target.bits, tiramisu::hardware_architecture_t::arch_cpu, gen_python = gen_python);
+  gen_halide_obj(obj_file_name, os, arch, bits, tiramisu::hardware_architecture_t::arch_cpu, gen_python = gen_python);
 }
 
 void function::gen_halide_obj(const std::string &obj_file_name, bool gen_python) const
 {
-    Halide::Target target = Halide::get_host_target();
-    gen_halide_obj(obj_file_name, target.os, target.arch, target.bits, gen_python);
+    gen_halide_obj(obj_file_name, tiramisu::hardware_architecture_t::arch_cpu, gen_python);
 }
 
 void function::gen_halide_obj(const std::string &obj_file_name, const tiramisu::hardware_architecture_t hw_architecture, bool gen_python) const
 {
-  Halide::Target target = Halide::get_host_target();
-  gen_halide_obj(obj_file_name, target.os, target.arch, target.bits, hw_architecture, gen_python = gen_python);
+  gen_halide_obj(obj_file_name, this->get_target(), hw_architecture, gen_python = gen_python);
 }
 
 
@@ -1378,8 +1780,10 @@ void function::gen_isl_ast()
     DEBUG_INDENT(4);
 
     // Check that time_processor representation has already been computed,
-    assert(this->get_trimmed_time_processor_domain() != NULL);
-    assert(this->get_aligned_identity_schedules() != NULL);
+    isl_union_set_ptr trimmed_domain(this->get_trimmed_time_processor_domain());
+    isl_union_map_ptr identity_schedules(this->get_aligned_identity_schedules());
+    assert(trimmed_domain != NULL);
+    assert(identity_schedules != NULL);
 
     isl_ctx *ctx = this->get_isl_ctx();
     assert(ctx != NULL);
@@ -1400,9 +1804,11 @@ void function::gen_isl_ast()
         ast_build = isl_ast_build_from_context(isl_set_copy(this->get_program_context()));
     }
 
-    isl_options_set_ast_build_atomic_upper_bound(ctx, 1);
+    isl_options_set_ast_build_atomic_upper_bound(ctx, this->ast_atomic_upper_bound);
     isl_options_get_ast_build_exploit_nested_bounds(ctx);
     isl_options_set_ast_build_group_coscheduled(ctx, 1);
+    isl_options_set_ast_build_detect_min_max(ctx, this->ast_detect_min_max);
+    isl_options_set_ast_build_allow_else(ctx, this->ast_allow_else);
 
     ast_build = isl_ast_build_set_after_each_for(ast_build, &tiramisu::for_code_generator_after_for,
                 NULL);
@@ -1431,23 +1837,86 @@ void function::gen_isl_ast()
         ast_build = isl_ast_build_set_iterators(ast_build, iterators);
     }
 
+    // The options of the loop levels of the computations (see computation::set_ast_option()),
+    // as maps from the time-processor points of a computation to an option of a dimension
+    isl_union_map *options = isl_union_map_empty(isl_union_map_get_space(identity_schedules.get()));
+    std::map<int, isl_union_set *> explicit_points;
+    const char *option_names[] = {"", "separate", "atomic", "unroll"};
+    for (const auto &option : this->ast_options)
+    {
+        int dim = 2 * std::get<1>(option) + 1;
+        for (auto &comp : this->get_computation_by_name(std::get<0>(option)))
+        {
+            if (!comp->should_schedule_this_computation())
+                continue;
+
+            isl_map *sched = isl_map_align_range_dims(comp->gen_identity_schedule_for_time_space_domain(),
+                                                      this->get_max_identity_schedules_range_dim());
+            isl_set *points = isl_set_apply(comp->get_trimmed_time_processor_domain(), sched);
+            if (explicit_points.count(dim) == 0)
+                explicit_points[dim] = isl_union_set_empty(isl_set_get_space(points));
+            explicit_points[dim] = isl_union_set_union(explicit_points[dim],
+                                                       isl_union_set_from_set(isl_set_copy(points)));
+
+            if (std::get<2>(option) == tiramisu::ast_default)
+            {
+                isl_set_free(points);
+                continue;
+            }
+            std::string range = "{ " + std::string(option_names[std::get<2>(option)]) + "[" + std::to_string(dim) + "] }";
+            isl_map *map = isl_map_from_domain_and_range(points, isl_set_read_from_str(ctx, range.c_str()));
+            options = isl_union_map_union(options, isl_union_map_from_map(map));
+        }
+    }
+
+    // Separate the full tiles from the partial tiles at each loop level,
+    // i.e. each dynamic dimension of the trimmed time-processor space,
+    // except where a computation has its own option
+    if (this->separate_full_tiles && this->get_iterator_names().size() > 0)
+    {
+        int n_dims = 2 * this->get_iterator_names().size() + 1;
+        std::string dims;
+        for (int i = 0; i < n_dims; i++)
+            dims += ((i == 0) ? "" : ",") + std::string("t") + std::to_string(i);
+
+        for (int i = 1; i < n_dims; i += 2)
+        {
+            std::string separate = "{ [" + dims + "] -> separate[" + std::to_string(i) + "] }";
+            isl_union_map *map = isl_union_map_read_from_str(ctx, separate.c_str());
+            if (explicit_points.count(i) > 0)
+                map = isl_union_map_subtract_domain(map, isl_union_set_copy(explicit_points[i]));
+            options = isl_union_map_union(options, map);
+        }
+    }
+    for (auto &points : explicit_points)
+        isl_union_set_free(points.second);
+
+    if (isl_union_map_is_empty(options) == isl_bool_false)
+    {
+        DEBUG(3, tiramisu::str_dump("AST build options: ", isl_union_map_to_str(options)));
+        ast_build = isl_ast_build_set_options(ast_build, options);
+    }
+    else
+        isl_union_map_free(options);
+
     // Intersect the iteration domain with the domain of the schedule.
     isl_union_map *umap =
         isl_union_map_intersect_domain(
-            isl_union_map_copy(this->get_aligned_identity_schedules()),
-            isl_union_set_copy(this->get_trimmed_time_processor_domain()));
+            isl_union_map_copy(identity_schedules.get()),
+            isl_union_set_copy(trimmed_domain.get()));
 
     DEBUG(3, tiramisu::str_dump("Schedule:", isl_union_map_to_str(this->get_schedule())));
     DEBUG(3, tiramisu::str_dump("Iteration domain:",
                                 isl_union_set_to_str(this->get_iteration_domain())));
     DEBUG(3, tiramisu::str_dump("Trimmed Time-Processor domain:",
-                                isl_union_set_to_str(this->get_trimmed_time_processor_domain())));
+                                isl_union_set_to_str(trimmed_domain.get())));
     DEBUG(3, tiramisu::str_dump("Trimmed Time-Processor aligned identity schedule:",
-                                isl_union_map_to_str(this->get_aligned_identity_schedules())));
+                                isl_union_map_to_str(identity_schedules.get())));
     DEBUG(3, tiramisu::str_dump("Identity schedule intersect trimmed Time-Processor domain:",
                                 isl_union_map_to_str(umap)));
     DEBUG(3, tiramisu::str_dump("\n"));
 
+    isl_ast_node_free(this->ast);
     this->ast = isl_ast_build_node_from_schedule_map(ast_build, umap);
 
     isl_ast_build_free(ast_build);
@@ -1510,84 +1979,1744 @@ void tiramisu::function::allocate_and_map_buffers_automatically()
     DEBUG_INDENT(-4);
 }
 
-std::string tiramisu::function::get_gpu_thread_iterator(const std::string &comp, int lev0) const
+isl_union_map *tiramisu::function::get_time_stamp_schedules() const
 {
-    assert(!comp.empty());
-    assert(lev0 >= 0);
+    assert(this->get_computations().size() > 0);
 
-    DEBUG_FCT_NAME(3);
-    DEBUG_INDENT(4);
+    int time_space_dim = isl_map_dim(this->get_computations()[0]->get_schedule(), isl_dim_out);
 
-    std::string res = "";
+    std::string time_space_str = "[";
+    for (int i = 0; i < time_space_dim; i++)
+    {
+        time_space_str += "t" + std::to_string(i);
 
-    for (const auto &pd : this->gpu_thread_dimensions)
+        if (i != time_space_dim - 1)
+            time_space_str += ",";
+    }
+    time_space_str += "]";
+
+    isl_union_map *time_stamps = isl_union_map_read_from_str(this->get_isl_ctx(), "{}");
+
+    for (auto &comput : this->get_computations())
     {
-        if ((pd.first == comp) && ((std::get<0>(pd.second) == lev0) || (std::get<1>(pd.second) == lev0) ||
-                                   (std::get<2>(pd.second) == lev0)))
-        {
-            if (lev0 == std::get<0>(pd.second))
-            {
-                res = ".__thread_id_z";
-            }
-            else if (lev0 == std::get<1>(pd.second))
-            {
-                res = ".__thread_id_y";
-            }
-            else if (lev0 == std::get<2>(pd.second))
-            {
-                res = ".__thread_id_x";
-            }
-            else
-            {
-                ERROR("Level not mapped to GPU.", true);
-            }
+        std::string identity = "{" + comput->get_name() + time_space_str + "->" + time_space_str + "}";
+        isl_map *isl_identity = isl_map_read_from_str(this->get_isl_ctx(), identity.c_str());
 
-            std::string str = "Dimension " + std::to_string(lev0) +
-                              " should be mapped to iterator " + res;
-            str = str + ". It was compared against: " + std::to_string(std::get<0>(pd.second)) +
-                  ", " + std::to_string(std::get<1>(pd.second)) + " and " +
-                  std::to_string(std::get<2>(pd.second));
-            DEBUG(3, tiramisu::str_dump(str));
-        }
+        isl_map *time_stamp = isl_map_apply_range(isl_map_copy(comput->get_schedule()), isl_identity);
+        time_stamps = isl_union_map_union(time_stamps, isl_union_map_from_map(time_stamp));
     }
 
-    DEBUG_INDENT(-4);
-    return res;
+    return isl_union_map_intersect_domain(time_stamps, this->get_iteration_domain());
 }
 
-std::string tiramisu::function::get_gpu_block_iterator(const std::string &comp, int lev0) const
+void tiramisu::function::minimize_temporaries_storage(int max_fold_factor)
 {
-    assert(!comp.empty());
-    assert(lev0 >= 0);
-
     DEBUG_FCT_NAME(3);
     DEBUG_INDENT(4);
 
-    std::string res = "";;
+    assert(max_fold_factor > 0);
 
-    for (const auto &pd : this->gpu_block_dimensions)
+    if (this->get_computations().empty())
     {
-        if ((pd.first == comp) && ((std::get<0>(pd.second) == lev0) || (std::get<1>(pd.second) == lev0) ||
-                                   (std::get<2>(pd.second) == lev0)))
-        {
-            if (lev0 == std::get<0>(pd.second))
-            {
-                res = ".__block_id_z";
-            }
-            else if (lev0 == std::get<1>(pd.second))
-            {
-                res = ".__block_id_y";
-            }
-            else if (lev0 == std::get<2>(pd.second))
-            {
-                res = ".__block_id_x";
-            }
-            else
-            {
-                ERROR("Level not mapped to GPU.", true);
-            }
+        DEBUG_INDENT(-4);
+        return ;
+    }
 
-            std::string str = "Dimension " + std::to_string(lev0) +
+    this->perform_full_dependency_analysis();
+
+    // The buffers that can be transformed, in the order of their first writer,
+    // and the computations that write into each of them.
+    std::vector<tiramisu::buffer *> temporaries;
+    std::map<std::string, std::vector<tiramisu::computation *>> writers;
+    std::unordered_set<std::string> rejected;
+
+    for (auto &comput : this->get_computations())
+    {
+        if (comput->is_inline_computation() || comput->get_access_relation() == NULL)
+            continue;
+
+        std::string buffer_name = isl_map_get_tuple_name(comput->get_access_relation(), isl_dim_out);
+        auto buff_it = this->get_buffers().find(buffer_name);
+
+        if (buff_it == this->get_buffers().end())
+            continue;
+
+        tiramisu::buffer *buff = buff_it->second;
+
+        if (buff->get_argument_type() != tiramisu::a_temporary || !buff->get_auto_allocate() ||
+            buff->get_location() != cuda_ast::memory_location::host || !buff->has_constant_extents() ||
+            this->get_computation_by_name(comput->get_name()).size() > 1)
+            rejected.insert(buffer_name);
+
+        if (writers.find(buffer_name) == writers.end())
+            temporaries.push_back(buff);
+
+        writers[buffer_name].push_back(comput);
+    }
+
+    temporaries.erase(std::remove_if(temporaries.begin(), temporaries.end(), [&](tiramisu::buffer *buff) {
+        return rejected.find(buff->get_name()) != rejected.end();
+    }), temporaries.end());
+
+    isl_union_map *time_stamps = this->get_time_stamp_schedules();
+
+    // write -> read, for each read of a value
+    isl_union_map *value_reads = isl_union_map_range_factor_domain(isl_union_map_copy(this->dep_read_after_write));
+
+    // The instances that write into each buffer (with the map to the written elements),
+    // and the instances that read the written values.
+    std::map<std::string, isl_union_map *> write_accesses;
+    std::map<std::string, isl_union_map *> buffer_reads;
+
+    for (tiramisu::buffer *buff : temporaries)
+    {
+        isl_union_map *write_access = isl_union_map_read_from_str(this->get_isl_ctx(), "{}");
+
+        for (tiramisu::computation *comput : writers[buff->get_name()])
+            write_access = isl_union_map_union(write_access,
+                                               isl_union_map_from_map(isl_map_copy(comput->get_access_relation())));
+
+        write_access = isl_union_map_intersect_domain(write_access, this->get_iteration_domain());
+
+        write_accesses[buff->get_name()] = write_access;
+        buffer_reads[buff->get_name()] = isl_union_map_intersect_domain(isl_union_map_copy(value_reads),
+                                                                        isl_union_map_domain(isl_union_map_copy(write_access)));
+    }
+
+    // -----------------------------------------------------------------
+    // Contract the temporaries to the reuse distance of their values.
+    // -----------------------------------------------------------------
+
+    for (tiramisu::buffer *buff : temporaries)
+    {
+        std::string buffer_name = buff->get_name();
+        isl_union_map *write_access = write_accesses[buffer_name];
+        isl_union_map *reads = buffer_reads[buffer_name];
+
+        isl_union_map *writes_time_stamps = isl_union_map_intersect_domain(isl_union_map_copy(time_stamps),
+                                                                           isl_union_map_domain(isl_union_map_copy(write_access)));
+
+        // w1 -> w2 : w1 is executed before w2
+        isl_union_map *writes_order = isl_union_map_lex_lt_union_map(isl_union_map_copy(writes_time_stamps),
+                                                                     isl_union_map_copy(writes_time_stamps));
+
+        // w1 -> w2 : a value written by w1 is read after w2
+        isl_union_map *still_needed = isl_union_map_apply_range(isl_union_map_copy(reads),
+                                                                isl_union_map_lex_gt_union_map(isl_union_map_copy(time_stamps),
+                                                                                               writes_time_stamps));
+
+        isl_union_map *conflicts_candidates = isl_union_map_intersect(writes_order, still_needed);
+
+        int n_dims = buff->get_n_dims();
+        std::vector<int> fold_factors(n_dims, 0);
+
+        // Fold the storage with the given factors (0 : the dimension is not folded),
+        // or check that two writes that share an element after folding are safe.
+        auto get_fold_str = [&](std::vector<int> const& factors, bool slot_equality)
+        {
+            std::string in_str, out_str, constraints_str, differ_str;
+
+            for (int i = 0; i < n_dims; i++)
+            {
+                std::string x = "x" + std::to_string(i), y = "y" + std::to_string(i);
+                in_str += x + ((i != n_dims - 1) ? "," : "");
+
+                if (!slot_equality)
+                {
+                    out_str += (factors[i] == 0 ? x : "(" + x + ") mod " + std::to_string(factors[i]));
+                    out_str += (i != n_dims - 1) ? "," : "";
+                    continue;
+                }
+
+                out_str += y + ((i != n_dims - 1) ? "," : "");
+
+                if (factors[i] == 0)
+                    constraints_str += " and " + y + " = " + x;
+                else
+                {
+                    if (factors[i] != 1)
+                        constraints_str += " and " + x + " mod " + std::to_string(factors[i]) + " = " +
+                                           y + " mod " + std::to_string(factors[i]);
+
+                    differ_str += (differ_str.empty() ? "" : " or ") + x + " != " + y;
+                }
+            }
+
+            std::string map_str = "{" + buffer_name + "[" + in_str + "] -> " + buffer_name + "[" + out_str + "]";
+            if (slot_equality)
+                map_str += " : (" + differ_str + ")" + constraints_str;
+
+            return map_str + "}";
+        };
+
+        auto fold_is_legal = [&](std::vector<int> const& factors)
+        {
+            isl_union_map *slot_equality = isl_union_map_read_from_str(this->get_isl_ctx(),
+                                                                       get_fold_str(factors, true).c_str());
+
+            // w1 -> w2 : w1 and w2 write different elements into the same folded element
+            isl_union_map *same_slot = isl_union_map_apply_range(isl_union_map_copy(write_access), slot_equality);
+            same_slot = isl_union_map_apply_range(same_slot, isl_union_map_reverse(isl_union_map_copy(write_access)));
+
+            same_slot = isl_union_map_intersect(same_slot, isl_union_map_copy(conflicts_candidates));
+            bool legal = isl_union_map_is_empty(same_slot);
+
+            isl_union_map_free(same_slot);
+            return legal;
+        };
+
+        bool folded = false;
+
+        for (int i = 0; i < n_dims; i++)
+        {
+            int extent = buff->get_dim_sizes()[i].get_int_val();
+
+            for (int factor = 1; factor <= max_fold_factor && factor < extent; factor++)
+            {
+                fold_factors[i] = factor;
+
+                if (fold_is_legal(fold_factors))
+                {
+                    folded = true;
+                    break;
+                }
+
+                fold_factors[i] = 0;
+            }
+        }
+
+        isl_union_map_free(conflicts_candidates);
+
+        if (!folded)
+            continue;
+
+        DEBUG(3, tiramisu::str_dump("Folding the temporary buffer " + buffer_name + " with " + get_fold_str(fold_factors, false)));
+
+        isl_map *fold = isl_map_read_from_str(this->get_isl_ctx(), get_fold_str(fold_factors, false).c_str());
+
+        for (tiramisu::computation *comput : writers[buffer_name])
+        {
+            isl_map *access = isl_map_apply_range(isl_map_copy(comput->get_access_relation()), isl_map_copy(fold));
+            comput->set_access(access);
+            isl_map_free(access);
+        }
+
+        isl_map_free(fold);
+
+        for (int i = 0; i < n_dims; i++)
+            if (fold_factors[i] != 0)
+                buff->set_dim_size(i, fold_factors[i]);
+    }
+
+    // -----------------------------------------------------------------
+    // Share the allocations of the temporaries that are not live
+    // at the same time.
+    // -----------------------------------------------------------------
+
+    // Each allocation, with the instances that access it
+    std::vector<std::pair<tiramisu::buffer *, isl_union_set *>> allocations;
+
+    for (tiramisu::buffer *buff : temporaries)
+    {
+        std::string buffer_name = buff->get_name();
+
+        isl_union_set *instances = isl_union_set_union(isl_union_map_domain(isl_union_map_copy(write_accesses[buffer_name])),
+                                                       isl_union_map_range(isl_union_map_copy(buffer_reads[buffer_name])));
+
+        isl_union_map *instances_time_stamps = isl_union_map_intersect_domain(isl_union_map_copy(time_stamps),
+                                                                              isl_union_set_copy(instances));
+
+        bool shared = false;
+
+        for (auto &allocation : allocations)
+        {
+            tiramisu::buffer *alloc_buff = allocation.first;
+
+            if (alloc_buff->get_elements_type() != buff->get_elements_type() ||
+                alloc_buff->get_n_dims() != buff->get_n_dims())
+                continue;
+
+            bool same_sizes = true;
+            for (int i = 0; i < buff->get_n_dims(); i++)
+                if (alloc_buff->get_dim_sizes()[i].get_int_val() != buff->get_dim_sizes()[i].get_int_val())
+                    same_sizes = false;
+
+            if (!same_sizes)
+                continue;
+
+            // All the accesses to the allocation must happen before the accesses to the buffer
+            isl_union_map *overlap = isl_union_map_lex_ge_union_map(
+                isl_union_map_intersect_domain(isl_union_map_copy(time_stamps), isl_union_set_copy(allocation.second)),
+                isl_union_map_copy(instances_time_stamps));
+
+            bool disjoint_live_ranges = isl_union_map_is_empty(overlap);
+            isl_union_map_free(overlap);
+
+            if (!disjoint_live_ranges)
+                continue;
+
+            DEBUG(3, tiramisu::str_dump("The temporary buffer " + buffer_name + " shares the allocation of " + alloc_buff->get_name()));
+
+            for (tiramisu::computation *comput : writers[buffer_name])
+            {
+                isl_map *access = isl_map_set_tuple_name(isl_map_copy(comput->get_access_relation()),
+                                                         isl_dim_out, alloc_buff->get_name().c_str());
+                comput->set_access(access);
+                isl_map_free(access);
+            }
+
+            buff->set_auto_allocate(false);
+            allocation.second = isl_union_set_union(allocation.second, isl_union_set_copy(instances));
+
+            shared = true;
+            break;
+        }
+
+        if (!shared)
+            allocations.push_back({buff, isl_union_set_copy(instances)});
+
+        isl_union_set_free(instances);
+        isl_union_map_free(instances_time_stamps);
+    }
+
+    for (auto &allocation : allocations)
+        isl_union_set_free(allocation.second);
+
+    for (tiramisu::buffer *buff : temporaries)
+    {
+        isl_union_map_free(write_accesses[buff->get_name()]);
+        isl_union_map_free(buffer_reads[buff->get_name()]);
+    }
+
+    isl_union_map_free(value_reads);
+    isl_union_map_free(time_stamps);
+
+    DEBUG_INDENT(-4);
+}
+
+/**
+ * Return true if \p e only uses arithmetic, math, select and cast operators
+ * and accesses to computations (no call, memcpy, allocation, ...).
+ */
+static bool is_pure_expression(const tiramisu::expr &e)
+{
+    if (e.get_expr_type() == tiramisu::e_val || e.get_expr_type() == tiramisu::e_var)
+        return true;
+
+    if (e.get_expr_type() != tiramisu::e_op)
+        return false;
+
+    switch (e.get_op_type())
+    {
+    case tiramisu::o_allocate:
+    case tiramisu::o_free:
+    case tiramisu::o_address:
+    case tiramisu::o_memcpy:
+    case tiramisu::o_call:
+    case tiramisu::o_address_of:
+    case tiramisu::o_lin_index:
+    case tiramisu::o_type:
+    case tiramisu::o_dummy:
+    case tiramisu::o_buffer:
+    case tiramisu::o_none:
+        return false;
+    default:
+        break;
+    }
+
+    bool pure = true;
+    e.apply_to_operands([&pure](const tiramisu::expr &operand) {
+        pure = pure && is_pure_expression(operand);
+        return operand;
+    });
+
+    return pure;
+}
+
+/**
+ * The names of the buffers passed to the calls, memcpy, ... of \p computations:
+ * their accesses are not described by access relations.
+ */
+static std::unordered_set<std::string> get_escaped_buffers(const std::vector<tiramisu::computation *> &computations)
+{
+    std::unordered_set<std::string> escaped;
+
+    for (auto &comput : computations)
+    {
+        if (!comput->get_expr().is_defined() || is_pure_expression(comput->get_expr()))
+            continue;
+
+        std::function<tiramisu::expr(const tiramisu::expr &)> find_names = [&](const tiramisu::expr &e) {
+            if (e.get_expr_type() == tiramisu::e_var || e.get_op_type() == tiramisu::o_access ||
+                e.get_op_type() == tiramisu::o_allocate || e.get_op_type() == tiramisu::o_buffer)
+                escaped.insert(e.get_name());
+            return e.apply_to_operands(find_names);
+        };
+        find_names(comput->get_expr());
+    }
+
+    return escaped;
+}
+
+/**
+ * The number of arithmetic operations needed to evaluate \p e.  The index
+ * expressions of the accesses are not counted, the divisions and the
+ * transcendental functions count as several operations.
+ */
+static int expression_cost(const tiramisu::expr &e)
+{
+    if (e.get_expr_type() != tiramisu::e_op || e.get_op_type() == tiramisu::o_access)
+        return 0;
+
+    int cost = 1;
+
+    switch (e.get_op_type())
+    {
+    case tiramisu::o_cast:
+        cost = 0;
+        break;
+    case tiramisu::o_div:
+    case tiramisu::o_mod:
+        cost = 4;
+        break;
+    case tiramisu::o_sin:
+    case tiramisu::o_cos:
+    case tiramisu::o_tan:
+    case tiramisu::o_asin:
+    case tiramisu::o_acos:
+    case tiramisu::o_atan:
+    case tiramisu::o_sinh:
+    case tiramisu::o_cosh:
+    case tiramisu::o_tanh:
+    case tiramisu::o_asinh:
+    case tiramisu::o_acosh:
+    case tiramisu::o_atanh:
+    case tiramisu::o_sqrt:
+    case tiramisu::o_expo:
+    case tiramisu::o_log:
+        cost = 8;
+        break;
+    default:
+        break;
+    }
+
+    for (int i = 0; i < e.get_n_arg(); i++)
+        cost += expression_cost(e.get_operand(i));
+
+    return cost;
+}
+
+/**
+ * The number of nodes of \p e.
+ */
+static int expression_size(const tiramisu::expr &e)
+{
+    int size = 1;
+    e.apply_to_operands([&size](const tiramisu::expr &operand) {
+        size += expression_size(operand);
+        return operand;
+    });
+
+    return size;
+}
+
+/**
+ * A string that is the same for two expressions that compute the same value
+ * up to a renaming of the \p iterators.  The iterators are numbered in the
+ * order of their first appearance, and \p order receives their names in that
+ * order; if \p order is NULL, the iterators are not numbered.
+ */
+static std::string redundancy_key(const tiramisu::expr &e, const std::vector<std::string> &iterators,
+                                  std::vector<std::string> *order)
+{
+    std::string type = tiramisu::str_from_tiramisu_type_primitive(e.get_data_type());
+
+    if (e.get_expr_type() == tiramisu::e_val)
+    {
+        std::ostringstream value;
+        if (e.get_data_type() == tiramisu::p_float32 || e.get_data_type() == tiramisu::p_float64)
+        {
+            value.precision(17);
+            value << e.get_double_val();
+        }
+        else
+            value << e.to_str();
+        return type + ":" + value.str();
+    }
+
+    if (e.get_expr_type() == tiramisu::e_var)
+    {
+        if (std::find(iterators.begin(), iterators.end(), e.get_name()) == iterators.end())
+            return e.get_name();
+        if (order == NULL)
+            return "$";
+
+        auto pos = std::find(order->begin(), order->end(), e.get_name());
+        if (pos == order->end())
+            pos = order->insert(order->end(), e.get_name());
+        return "$" + std::to_string(pos - order->begin());
+    }
+
+    std::string key = tiramisu::str_tiramisu_type_op(e.get_op_type()) + ":" + type;
+    if (e.get_op_type() == tiramisu::o_access)
+        key += ":" + e.get_name();
+
+    key += "(";
+    e.apply_to_operands([&](const tiramisu::expr &operand) {
+        key += redundancy_key(operand, iterators, order) + ",";
+        return operand;
+    });
+
+    return key + ")";
+}
+
+/**
+ * Order the operands of the commutative operators of \p e by their key (see
+ * redundancy_key()), so that a + b and b + a have the same key.
+ */
+static tiramisu::expr sort_commutative_operands(const tiramisu::expr &e, const std::vector<std::string> &iterators)
+{
+    tiramisu::expr sorted = e.apply_to_operands([&iterators](const tiramisu::expr &operand) {
+        return sort_commutative_operands(operand, iterators);
+    });
+
+    if (sorted.get_expr_type() != tiramisu::e_op || sorted.get_n_arg() != 2 ||
+        sorted.get_operand(0).get_data_type() != sorted.get_operand(1).get_data_type())
+        return sorted;
+
+    switch (sorted.get_op_type())
+    {
+    case tiramisu::o_add:
+    case tiramisu::o_mul:
+    case tiramisu::o_max:
+    case tiramisu::o_min:
+    case tiramisu::o_eq:
+    case tiramisu::o_ne:
+    case tiramisu::o_logical_and:
+    case tiramisu::o_logical_or:
+        if (redundancy_key(sorted.get_operand(1), iterators, NULL) < redundancy_key(sorted.get_operand(0), iterators, NULL))
+            return tiramisu::expr(sorted.get_op_type(), sorted.get_operand(1), sorted.get_operand(0));
+        break;
+    default:
+        break;
+    }
+
+    return sorted;
+}
+
+int tiramisu::function::eliminate_redundant_computations(int min_cost)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(min_cost > 0);
+
+    if (this->get_computations().empty())
+    {
+        DEBUG_INDENT(-4);
+        return 0;
+    }
+
+    this->perform_full_dependency_analysis();
+
+    // The computations that write into each buffer, and the buffers whose
+    // writes are not described by access relations.
+    std::map<std::string, std::vector<tiramisu::computation *>> writers;
+    std::unordered_set<std::string> escaped = get_escaped_buffers(this->get_computations());
+
+    for (auto &comput : this->get_computations())
+        if (comput->get_expr().is_defined() && !comput->is_inline_computation() &&
+            comput->get_access_relation() != NULL)
+            writers[isl_map_get_tuple_name(comput->get_access_relation(), isl_dim_out)].push_back(comput);
+
+    // A value of a computation does not change after it is computed if the
+    // computation writes each element of its buffer once and is the only
+    // computation that writes into that buffer (or nothing writes into it).
+    std::map<std::string, bool> single_assignment;
+    auto is_single_assignment = [&](const std::string &name) {
+        auto known = single_assignment.find(name);
+        if (known != single_assignment.end())
+            return known->second;
+
+        bool result = false;
+        std::vector<tiramisu::computation *> defs = this->get_computation_by_name(name);
+
+        if (defs.size() == 1 && !defs[0]->is_inline_computation() && defs[0]->get_access_relation() != NULL)
+        {
+            tiramisu::computation *comput = defs[0];
+            std::string buffer_name = isl_map_get_tuple_name(comput->get_access_relation(), isl_dim_out);
+            auto buff_it = this->get_buffers().find(buffer_name);
+            std::vector<tiramisu::computation *> &buffer_writers = writers[buffer_name];
+
+            if (buff_it != this->get_buffers().end() &&
+                buff_it->second->get_location() == cuda_ast::memory_location::host &&
+                escaped.find(buffer_name) == escaped.end())
+            {
+                if (buffer_writers.empty())
+                    result = true;
+                else if (buffer_writers.size() == 1 && buffer_writers[0] == comput)
+                {
+                    isl_map *written = isl_map_intersect_domain(isl_map_copy(comput->get_access_relation()),
+                                                                isl_set_copy(comput->get_iteration_domain()));
+                    result = (isl_map_is_injective(written) == isl_bool_true);
+                    isl_map_free(written);
+                }
+            }
+        }
+
+        single_assignment[name] = result;
+        return result;
+    };
+
+    std::vector<std::string> invariants = this->get_invariant_names();
+
+    // A subexpression can be computed once and reused if it only reads values
+    // that do not change, and only uses the iterators of its computation and
+    // the invariants of the function.
+    std::function<bool(const tiramisu::expr &, const std::vector<std::string> &)> is_reusable =
+        [&](const tiramisu::expr &e, const std::vector<std::string> &iterators) {
+            if (e.get_expr_type() == tiramisu::e_var)
+                return std::find(iterators.begin(), iterators.end(), e.get_name()) != iterators.end() ||
+                       std::find(invariants.begin(), invariants.end(), e.get_name()) != invariants.end();
+
+            if (e.get_expr_type() == tiramisu::e_op && e.get_op_type() == tiramisu::o_access &&
+                !is_single_assignment(e.get_name()))
+                return false;
+
+            bool reusable = true;
+            e.apply_to_operands([&](const tiramisu::expr &operand) {
+                reusable = reusable && is_reusable(operand, iterators);
+                return operand;
+            });
+            return reusable;
+        };
+
+    // The subexpressions that cost at least min_cost, grouped by key.  An
+    // occurrence is identified by the position of its root in the pre-order
+    // traversal of the expression of its computation.
+    struct occurrence
+    {
+        tiramisu::computation *comput;
+        tiramisu::expr value;
+        int index, size, cost;
+        std::vector<std::string> iterators;  // the iterators of comput in the order of the key
+    };
+
+    std::map<std::string, std::vector<occurrence>> occurrences;
+    std::map<tiramisu::computation *, tiramisu::expr> expressions;
+    std::map<tiramisu::computation *, std::vector<std::string>> dimension_names;
+
+    for (auto &comput : this->get_computations())
+    {
+        if (comput->is_inline_computation() || comput->get_access_relation() == NULL ||
+            !comput->get_expr().is_defined() || !comput->should_schedule_this_computation() ||
+            !is_pure_expression(comput->get_expr()) ||
+            this->get_computation_by_name(comput->get_name()).size() > 1)
+            continue;
+
+        auto buff_it = this->get_buffers().find(isl_map_get_tuple_name(comput->get_access_relation(), isl_dim_out));
+        if (buff_it == this->get_buffers().end() ||
+            buff_it->second->get_location() != cuda_ast::memory_location::host)
+            continue;
+
+        std::vector<std::string> iterators = comput->get_iteration_domain_dimension_names();
+        tiramisu::expr e = sort_commutative_operands(comput->get_expr(), iterators);
+        expressions[comput] = e;
+        dimension_names[comput] = iterators;
+
+        int index = 0;
+        std::function<tiramisu::expr(const tiramisu::expr &)> visit = [&](const tiramisu::expr &s) {
+            if (s.get_expr_type() == tiramisu::e_op && s.get_op_type() == tiramisu::o_access)
+            {
+                index += expression_size(s);
+                return s;
+            }
+
+            int cost = expression_cost(s);
+            if (cost >= min_cost && is_reusable(s, iterators))
+            {
+                occurrence o{comput, s, index, expression_size(s), cost, {}};
+                std::string key = redundancy_key(s, iterators, &o.iterators);
+                occurrences[key].push_back(o);
+            }
+
+            index++;
+            return s.apply_to_operands(visit);
+        };
+        visit(e);
+    }
+
+    isl_union_map *time_stamps = this->get_time_stamp_schedules();
+
+    // a -> b : a is executed after b
+    isl_union_map *executed_after = isl_union_map_lex_gt_union_map(isl_union_map_copy(time_stamps),
+                                                                   isl_union_map_copy(time_stamps));
+
+    // Return true if, for every instance of the computation of \p o, the
+    // computation of \p source computes the value of \p o before that
+    // instance.  \p access receives the indices of that value.
+    auto can_reuse = [&](const occurrence &o, const occurrence &source, std::vector<tiramisu::expr> &access) {
+        const std::vector<std::string> &source_dims = dimension_names[source.comput];
+        std::vector<std::string> indices(source_dims.size());
+
+        for (size_t k = 0; k < source.iterators.size(); k++)
+        {
+            auto pos = std::find(source_dims.begin(), source_dims.end(), source.iterators[k]);
+            indices[pos - source_dims.begin()] = o.iterators[k];
+        }
+
+        std::string map_str = "{" + o.comput->get_name() + "[";
+        for (size_t d = 0; d < dimension_names[o.comput].size(); d++)
+            map_str += (d == 0 ? "" : ",") + dimension_names[o.comput][d];
+        map_str += "] -> " + source.comput->get_name() + "[";
+        for (size_t d = 0; d < indices.size(); d++)
+            map_str += (d == 0 ? "" : ",") + indices[d];
+        map_str += "]}";
+
+        isl_map *instances = isl_map_intersect_domain(isl_map_read_from_str(this->get_isl_ctx(), map_str.c_str()),
+                                                      isl_set_copy(o.comput->get_iteration_domain()));
+
+        isl_set *reused = isl_map_range(isl_map_copy(instances));
+        bool computed = isl_set_is_subset(reused, source.comput->get_iteration_domain()) == isl_bool_true;
+        isl_set_free(reused);
+
+        isl_union_map *pairs = isl_union_map_from_map(instances);
+        bool legal = computed && isl_union_map_is_subset(pairs, executed_after) == isl_bool_true;
+        isl_union_map_free(pairs);
+
+        access.clear();
+        for (const std::string &index : indices)
+            access.push_back(tiramisu::var(index));
+
+        return legal;
+    };
+
+    // The subexpressions already replaced or reused, in each computation
+    std::map<tiramisu::computation *, std::vector<std::pair<int, int>>> taken;
+    std::map<tiramisu::computation *, std::map<int, tiramisu::expr>> replacements;
+    int eliminated = 0;
+
+    auto is_taken = [&](const occurrence &o) {
+        for (auto &range : taken[o.comput])
+            if (o.index < range.second && range.first < o.index + o.size)
+                return true;
+        return false;
+    };
+
+    auto replace = [&](const occurrence &o, const std::string &name, const std::vector<tiramisu::expr> &access) {
+        replacements[o.comput][o.index] = tiramisu::expr(tiramisu::o_access, name, access, o.value.get_data_type());
+        taken[o.comput].push_back({o.index, o.index + o.size});
+    };
+
+    // The most expensive subexpressions first, so that a subexpression is
+    // not reused when an enclosing expression can be reused.
+    std::vector<std::string> keys;
+    for (auto &group : occurrences)
+        if (group.second.size() > 1)
+            keys.push_back(group.first);
+    std::stable_sort(keys.begin(), keys.end(), [&](const std::string &a, const std::string &b) {
+        return occurrences[a][0].cost > occurrences[b][0].cost;
+    });
+
+    for (const std::string &key : keys)
+    {
+        std::vector<occurrence> &group = occurrences[key];
+
+        // The computations that already compute the value (their whole
+        // expression) for all their iterators.
+        std::vector<const occurrence *> producers;
+        for (const occurrence &o : group)
+            if (o.index == 0 && o.iterators.size() == dimension_names[o.comput].size() &&
+                is_single_assignment(o.comput->get_name()))
+                producers.push_back(&o);
+
+        std::vector<const occurrence *> pending;
+        for (const occurrence &o : group)
+        {
+            if (is_taken(o))
+                continue;
+
+            bool reused = false;
+            for (const occurrence *producer : producers)
+            {
+                if (producer->comput == o.comput)
+                    continue;
+
+                std::vector<tiramisu::expr> access;
+                if (can_reuse(o, *producer, access))
+                {
+                    DEBUG(3, tiramisu::str_dump("Reusing " + producer->comput->get_name() + " in " + o.comput->get_name()));
+                    replace(o, producer->comput->get_name(), access);
+                    eliminated++;
+                    reused = true;
+                    break;
+                }
+            }
+
+            if (!reused)
+                pending.push_back(&o);
+        }
+
+        // The remaining occurrences share a new computation, computed just
+        // before the first of them, in the loops of its computation, if the
+        // saved operations are worth the store and the loads.
+        for (size_t first = 0; first < pending.size(); first++)
+        {
+            const occurrence *source = pending[first];
+            if (source == NULL || source->iterators.size() != dimension_names[source->comput].size())
+                continue;
+
+            std::vector<std::pair<size_t, std::vector<tiramisu::expr>>> users;
+            for (size_t other = first + 1; other < pending.size(); other++)
+                if (pending[other] != NULL && pending[other]->comput != source->comput)
+                {
+                    std::vector<tiramisu::expr> access;
+                    if (can_reuse(*pending[other], *source, access))
+                        users.push_back({other, access});
+                }
+
+            int uses = users.size() + 1;
+            if (users.empty() || (uses - 1) * source->cost <= uses + 1)
+                continue;
+
+            tiramisu::computation *comput = source->comput;
+            std::string name;
+            for (int n = 0; name.empty() || !this->get_computation_by_name(name).empty(); n++)
+                name = comput->get_name() + "_common" + std::to_string(n);
+
+            DEBUG(3, tiramisu::str_dump("Computing " + name + " once for " + std::to_string(uses) + " uses"));
+
+            isl_set *domain = isl_set_set_tuple_name(isl_set_copy(comput->get_iteration_domain()), name.c_str());
+            tiramisu::computation *common = new tiramisu::computation(isl_set_to_str(domain), source->value, true,
+                                                                      source->value.get_data_type(), this);
+            isl_set_free(domain);
+
+            isl_map *schedule = isl_map_set_tuple_name(isl_map_copy(comput->get_schedule()), isl_dim_in, name.c_str());
+            common->set_schedule(isl_map_set_tuple_name(schedule, isl_dim_out, name.c_str()));
+
+            std::vector<std::pair<std::string, int>> parallel;
+            std::vector<std::tuple<std::string, int, int>> vector, unroll;
+            for (auto &dim : this->parallel_dimensions)
+                if (dim.first == comput->get_name())
+                    parallel.push_back({name, dim.second});
+            for (auto &dim : this->vector_dimensions)
+                if (std::get<0>(dim) == comput->get_name())
+                    vector.push_back(std::make_tuple(name, std::get<1>(dim), std::get<2>(dim)));
+            for (auto &dim : this->unroll_dimensions)
+                if (std::get<0>(dim) == comput->get_name())
+                    unroll.push_back(std::make_tuple(name, std::get<1>(dim), std::get<2>(dim)));
+            this->parallel_dimensions.insert(this->parallel_dimensions.end(), parallel.begin(), parallel.end());
+            this->vector_dimensions.insert(this->vector_dimensions.end(), vector.begin(), vector.end());
+            this->unroll_dimensions.insert(this->unroll_dimensions.end(), unroll.begin(), unroll.end());
+
+            int level = comput->get_loop_levels_number() - 1;
+            tiramisu::computation *pred = comput->get_predecessor();
+            if (pred != nullptr)
+                common->between(*pred, this->sched_graph[pred][comput], *comput, level);
+            else
+                common->before(*comput, level);
+
+            common->allocate_and_map_buffer_automatically(tiramisu::a_temporary);
+
+            std::vector<tiramisu::expr> access;
+            for (const std::string &dim : dimension_names[comput])
+                access.push_back(tiramisu::var(dim));
+            replace(*source, name, access);
+
+            for (auto &user : users)
+            {
+                replace(*pending[user.first], name, user.second);
+                pending[user.first] = NULL;
+                eliminated++;
+            }
+        }
+    }
+
+    for (auto &comput_replacements : replacements)
+    {
+        std::map<int, tiramisu::expr> &replaced = comput_replacements.second;
+
+        int index = 0;
+        std::function<tiramisu::expr(const tiramisu::expr &)> rebuild = [&](const tiramisu::expr &e) {
+            auto replacement = replaced.find(index);
+            if (replacement != replaced.end())
+            {
+                index += expression_size(e);
+                return replacement->second;
+            }
+
+            if (e.get_expr_type() == tiramisu::e_op && e.get_op_type() == tiramisu::o_access)
+            {
+                index += expression_size(e);
+                return e;
+            }
+
+            index++;
+            return e.apply_to_operands(rebuild);
+        };
+
+        comput_replacements.first->set_expression(rebuild(expressions[comput_replacements.first]));
+    }
+
+    DEBUG(3, tiramisu::str_dump("Number of redundant subexpressions eliminated: " + std::to_string(eliminated)));
+
+    isl_union_map_free(executed_after);
+    isl_union_map_free(time_stamps);
+
+    DEBUG_INDENT(-4);
+
+    return eliminated;
+}
+
+int tiramisu::function::concatenate_in_place()
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    int eliminated = 0;
+    std::unordered_set<std::string> escaped = get_escaped_buffers(this->get_computations());
+
+    for (auto &copy : this->get_computations())
+    {
+        const tiramisu::expr &e = copy->get_expr();
+
+        if (!copy->should_schedule_this_computation() || copy->is_inline_computation() ||
+            copy->get_access_relation() == NULL || !e.is_defined() ||
+            e.get_expr_type() != tiramisu::e_op || e.get_op_type() != tiramisu::o_access ||
+            this->get_computation_by_name(copy->get_name()).size() > 1)
+            continue;
+
+        std::vector<tiramisu::computation *> producers = this->get_computation_by_name(e.get_name());
+        if (producers.empty() || producers[0]->is_inline_computation() ||
+            producers[0]->get_access_relation() == NULL ||
+            producers[0]->get_data_type() != copy->get_data_type())
+            continue;
+
+        tiramisu::computation *producer = producers[0];
+        std::string source_name = isl_map_get_tuple_name(producer->get_access_relation(), isl_dim_out);
+        std::string target_name = isl_map_get_tuple_name(copy->get_access_relation(), isl_dim_out);
+        auto source_it = this->get_buffers().find(source_name);
+        auto target_it = this->get_buffers().find(target_name);
+
+        if (source_name == target_name || source_it == this->get_buffers().end() ||
+            target_it == this->get_buffers().end())
+            continue;
+
+        tiramisu::buffer *source = source_it->second, *target = target_it->second;
+        if (source->get_argument_type() != tiramisu::a_temporary ||
+            target->get_argument_type() == tiramisu::a_input ||
+            source->get_location() != target->get_location() ||
+            escaped.find(source_name) != escaped.end() || escaped.find(target_name) != escaped.end())
+            continue;
+
+        // The copy is removed from the ordering of the computations: its
+        // successors are ordered after its predecessor.
+        tiramisu::computation *pred = copy->get_predecessor();
+        std::vector<std::pair<tiramisu::computation *, int>> succs(this->sched_graph[copy].begin(),
+                                                                   this->sched_graph[copy].end());
+        if (pred == nullptr && succs.size() > 1)
+            continue;
+
+        // copy -> element of the source buffer that it reads
+        std::vector<std::string> dims = copy->get_iteration_domain_dimension_names();
+        std::string read_str = "[" + utility::get_parameters_list(copy->get_iteration_domain()) + "] -> {";
+        read_str += copy->get_name() + "[";
+        for (size_t d = 0; d < dims.size(); d++)
+            read_str += (d == 0 ? "" : ", ") + dims[d];
+        read_str += "] -> " + producer->get_name() + "[";
+        for (size_t d = 0; d < e.get_access().size(); d++)
+            read_str += (d == 0 ? "" : ", ") + e.get_access()[d].to_str();
+        read_str += "]}";
+
+        isl_map *read = isl_map_read_from_str(this->get_isl_ctx(), read_str.c_str());
+        if (read == NULL)
+            continue;
+
+        read = isl_map_intersect_domain(read, isl_set_copy(copy->get_iteration_domain()));
+        read = isl_map_apply_range(read, isl_map_copy(producer->get_access_relation()));
+        isl_map *write = isl_map_intersect_domain(isl_map_copy(copy->get_access_relation()),
+                                                  isl_set_copy(copy->get_iteration_domain()));
+        isl_set *region = isl_map_range(isl_map_copy(write));
+
+        // element of the source buffer -> element of the target buffer where it is copied
+        isl_map *relocation = isl_map_coalesce(isl_map_apply_range(isl_map_reverse(read), write));
+        isl_set *relocated_elements = isl_map_domain(isl_map_copy(relocation));
+
+        bool legal = isl_map_is_single_valued(relocation) == isl_bool_true &&
+                     isl_map_is_injective(relocation) == isl_bool_true;
+
+        // All the accesses to the source buffer must be relocated, and the
+        // other computations must not write into the region of the copy.
+        std::vector<tiramisu::computation *> relocated;
+        for (auto &comput : this->get_computations())
+        {
+            if (!legal || comput == copy || comput->get_access_relation() == NULL)
+                continue;
+
+            std::string buffer_name = isl_map_get_tuple_name(comput->get_access_relation(), isl_dim_out);
+            if (buffer_name != source_name && buffer_name != target_name)
+                continue;
+
+            isl_set *accessed = isl_map_range(isl_map_intersect_domain(isl_map_copy(comput->get_access_relation()),
+                                                                       isl_set_copy(comput->get_iteration_domain())));
+            if (buffer_name == source_name)
+            {
+                legal = isl_set_is_subset(accessed, relocated_elements) == isl_bool_true;
+                relocated.push_back(comput);
+            }
+            else if (comput->should_schedule_this_computation() && comput->get_expr().is_defined())
+                legal = isl_set_is_disjoint(accessed, region) == isl_bool_true;
+
+            isl_set_free(accessed);
+        }
+
+        if (legal)
+        {
+            DEBUG(3, tiramisu::str_dump("The copy " + copy->get_name() + " is removed, " + source_name +
+                                        " is stored in " + target_name + ": ", isl_map_to_str(relocation)));
+
+            for (tiramisu::computation *comput : relocated)
+            {
+                isl_map *access = isl_map_coalesce(isl_map_apply_range(isl_map_copy(comput->get_access_relation()),
+                                                                       isl_map_copy(relocation)));
+                comput->set_access(access);
+                isl_map_free(access);
+            }
+            source->set_auto_allocate(false);
+
+            int pred_level = (pred != nullptr) ? this->sched_graph[pred][copy] : computation::root_dimension;
+            if (pred != nullptr)
+            {
+                this->sched_graph[pred].erase(copy);
+                this->sched_graph_reversed[copy].erase(pred);
+            }
+            this->sched_graph.erase(copy);
+            for (auto &succ : succs)
+            {
+                this->sched_graph_reversed[succ.first].erase(copy);
+                if (pred != nullptr)
+                    succ.first->after(*pred, std::min(pred_level, succ.second));
+                else
+                    this->starting_computations.insert(succ.first);
+            }
+            this->starting_computations.erase(copy);
+            copy->unschedule_this_computation();
+
+            eliminated++;
+        }
+
+        isl_set_free(relocated_elements);
+        isl_set_free(region);
+        isl_map_free(relocation);
+    }
+
+    DEBUG(3, tiramisu::str_dump("Number of copies removed: " + std::to_string(eliminated)));
+
+    DEBUG_INDENT(-4);
+
+    return eliminated;
+}
+
+std::vector<tiramisu::fusion_info> tiramisu::function::fuse_producer_consumer_chains(bool apply)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    std::vector<tiramisu::fusion_info> fusions;
+
+    if (this->get_computations().empty())
+    {
+        DEBUG_INDENT(-4);
+        return fusions;
+    }
+
+    this->perform_full_dependency_analysis();
+
+    // The computations that write into each buffer, and the elements of each
+    // buffer read by each computation.
+    std::map<std::string, std::unordered_set<tiramisu::computation *>> writers;
+    std::map<std::string, std::vector<std::pair<tiramisu::computation *, isl_map *>>> reads;
+
+    for (auto &comput : this->get_computations())
+    {
+        if (comput->is_inline_computation() || comput->is_let_stmt() || !comput->get_expr().is_defined())
+            continue;
+
+        if (comput->get_access_relation() != NULL)
+            writers[isl_map_get_tuple_name(comput->get_access_relation(), isl_dim_out)].insert(comput);
+
+        std::vector<isl_map *> accesses;
+        generator::get_rhs_accesses(this, comput, accesses, true);
+        for (isl_map *access : accesses)
+            if (isl_map_has_tuple_name(access, isl_dim_out) == isl_bool_true)
+            {
+                access = isl_map_intersect_domain(access, isl_set_copy(comput->get_iteration_domain()));
+                reads[isl_map_get_tuple_name(access, isl_dim_out)].push_back({comput, access});
+            }
+            else
+                isl_map_free(access);
+    }
+
+    for (auto &producer : this->get_computations())
+    {
+        // Only chains: the consumer is the only computation ordered after the producer
+        auto edges = this->sched_graph.find(producer);
+        if (edges == this->sched_graph.end() || edges->second.size() != 1)
+            continue;
+
+        tiramisu::computation *consumer = edges->second.begin()->first;
+        int previous_level = edges->second.begin()->second;
+
+        if (producer->get_access_relation() == NULL || producer->is_inline_computation() ||
+            consumer->is_inline_computation() || !consumer->get_expr().is_defined() ||
+            this->get_computation_by_name(producer->get_name()).size() > 1 ||
+            this->get_computation_by_name(consumer->get_name()).size() > 1)
+            continue;
+
+        std::string buffer_name = isl_map_get_tuple_name(producer->get_access_relation(), isl_dim_out);
+
+        isl_map *consumed = NULL;
+        bool only_reader = true;
+        for (auto &read : reads[buffer_name])
+            if (read.first == consumer)
+                consumed = (consumed == NULL) ? isl_map_copy(read.second) :
+                           isl_map_union(consumed, isl_map_copy(read.second));
+            else if (writers[buffer_name].count(read.first) == 0)
+                only_reader = false;
+
+        if (consumed == NULL)
+            continue;
+
+        // consumer instance -> the producer instances that wrote the values it reads
+        isl_map *written = isl_map_intersect_domain(isl_map_copy(producer->get_access_relation()),
+                                                    isl_set_copy(producer->get_iteration_domain()));
+        isl_map *sources = isl_map_apply_range(consumed, isl_map_reverse(written));
+
+        // The deepest level such that the consumer only reads values produced
+        // at the same iteration of the loops up to that level.
+        int max_level = computation::root_dimension;
+        if (isl_map_is_empty(sources) != isl_bool_true)
+        {
+            std::vector<std::string> producer_loops = producer->get_loop_level_names();
+            std::vector<std::string> consumer_loops = consumer->get_loop_level_names();
+            std::vector<std::string> producer_dims = producer->get_iteration_domain_dimension_names();
+            std::vector<std::string> consumer_dims = consumer->get_iteration_domain_dimension_names();
+
+            for (int l = 0; l < (int) std::min(producer_loops.size(), consumer_loops.size()); l++)
+            {
+                if (l >= (int) producer_dims.size() || l >= (int) consumer_dims.size() ||
+                    producer_loops[l] != producer_dims[l] || consumer_loops[l] != consumer_dims[l])
+                    break;
+
+                isl_map *same_iteration = isl_map_equate(isl_map_copy(sources), isl_dim_in, l, isl_dim_out, l);
+                bool aligned = (isl_map_is_subset(sources, same_iteration) == isl_bool_true);
+                isl_map_free(same_iteration);
+
+                if (!aligned)
+                    break;
+
+                max_level = l;
+            }
+        }
+        isl_map_free(sources);
+
+        // Fuse at the deepest legal level
+        int level = previous_level;
+        for (int l = max_level; l > previous_level; l--)
+        {
+            this->sched_graph[producer][consumer] = l;
+            this->sched_graph_reversed[consumer][producer] = l;
+            this->prepare_schedules_for_legality_checks(true);
+
+            if (this->check_legality_for_function())
+            {
+                level = l;
+                break;
+            }
+        }
+
+        this->sched_graph[producer][consumer] = level;
+        this->sched_graph_reversed[consumer][producer] = level;
+
+        if (level == previous_level)
+            continue;
+
+        double saved_bytes = 0;
+        auto buff_it = this->get_buffers().find(buffer_name);
+        if (buff_it != this->get_buffers().end() && buff_it->second->has_constant_extents())
+        {
+            tiramisu::buffer *buff = buff_it->second;
+            saved_bytes = halide_type_from_tiramisu_type(buff->get_elements_type()).bytes();
+            for (auto &size : buff->get_dim_sizes())
+                saved_bytes *= size.get_int_val();
+            if (only_reader && buff->get_argument_type() == tiramisu::a_temporary)
+                saved_bytes *= 2;
+        }
+
+        DEBUG(3, tiramisu::str_dump("Fused " + consumer->get_name() + " with its producer " + producer->get_name() +
+                                    " at level " + std::to_string(level) + " (previously " +
+                                    std::to_string(previous_level) + "), saving " +
+                                    std::to_string((long) saved_bytes) + " bytes of memory traffic"));
+
+        fusions.push_back({producer, consumer, previous_level, level, saved_bytes});
+    }
+
+    if (!apply)
+        for (auto &fusion : fusions)
+        {
+            this->sched_graph[fusion.producer][fusion.consumer] = fusion.previous_level;
+            this->sched_graph_reversed[fusion.consumer][fusion.producer] = fusion.previous_level;
+        }
+
+    this->prepare_schedules_for_legality_checks(true);
+
+    for (auto &read : reads)
+        for (auto &access : read.second)
+            isl_map_free(access.second);
+
+    DEBUG_INDENT(-4);
+
+    return fusions;
+}
+
+std::vector<tiramisu::fusion_info> tiramisu::function::fuse_gpu_kernels(bool apply)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    std::vector<tiramisu::fusion_info> fusions;
+
+    if (this->get_computations().empty())
+    {
+        DEBUG_INDENT(-4);
+        return fusions;
+    }
+
+    this->perform_full_dependency_analysis();
+
+    auto gpu_levels = [](const std::vector<std::pair<std::string, std::tuple<int, int, int>>> &dims,
+                         const std::string &name, std::tuple<int, int, int> &levels) {
+        for (const auto &d : dims)
+            if (d.first == name)
+            {
+                levels = d.second;
+                return true;
+            }
+        return false;
+    };
+
+    // The loop levels 0 to depth - 1 of a computation in its time-space
+    // domain, without the static dimensions
+    auto loop_times = [](tiramisu::computation *comp, int depth) {
+        isl_map *times = isl_map_intersect_domain(isl_map_copy(comp->get_schedule()),
+                                                  isl_set_copy(comp->get_iteration_domain()));
+        for (int d = isl_map_dim(times, isl_dim_out) - 1; d >= 0; d--)
+        {
+            bool kept = false;
+            for (int l = 0; l < depth; l++)
+                kept = kept || (d == loop_level_into_dynamic_dimension(l));
+            if (!kept)
+                times = isl_map_project_out(times, isl_dim_out, d, 1);
+        }
+        times = isl_map_reset_tuple_id(times, isl_dim_out);
+        for (int d = 0; d < depth; d++)
+            times = isl_map_set_dim_name(times, isl_dim_out, d, ("t" + std::to_string(d)).c_str());
+        return times;
+    };
+
+    // The computations that write into each buffer, and that read it
+    std::map<std::string, std::unordered_set<tiramisu::computation *>> writers, readers;
+    for (auto &comput : this->get_computations())
+    {
+        if (comput->is_let_stmt() || !comput->get_expr().is_defined())
+            continue;
+        if (comput->get_access_relation() != NULL)
+            writers[isl_map_get_tuple_name(comput->get_access_relation(), isl_dim_out)].insert(comput);
+        std::vector<isl_map *> accesses;
+        generator::get_rhs_accesses(this, comput, accesses, true);
+        for (isl_map *access : accesses)
+        {
+            if (isl_map_has_tuple_name(access, isl_dim_out) == isl_bool_true)
+                readers[isl_map_get_tuple_name(access, isl_dim_out)].insert(comput);
+            isl_map_free(access);
+        }
+    }
+
+    std::vector<tiramisu::computation *> computations = this->get_computations();
+    for (auto &producer : computations)
+    {
+        auto edges = this->sched_graph.find(producer);
+        if (edges == this->sched_graph.end() || edges->second.size() != 1)
+            continue;
+
+        tiramisu::computation *consumer = edges->second.begin()->first;
+        int previous_level = edges->second.begin()->second;
+
+        // The same blocks and threads, on the same loop levels
+        std::tuple<int, int, int> producer_blocks, producer_threads, consumer_blocks, consumer_threads;
+        if (producer->get_access_relation() == NULL || !consumer->get_expr().is_defined() ||
+            this->get_computation_by_name(producer->get_name()).size() > 1 ||
+            this->get_computation_by_name(consumer->get_name()).size() > 1 ||
+            !gpu_levels(this->gpu_block_dimensions, producer->get_name(), producer_blocks) ||
+            !gpu_levels(this->gpu_thread_dimensions, producer->get_name(), producer_threads) ||
+            !gpu_levels(this->gpu_block_dimensions, consumer->get_name(), consumer_blocks) ||
+            !gpu_levels(this->gpu_thread_dimensions, consumer->get_name(), consumer_threads) ||
+            producer_blocks != consumer_blocks || producer_threads != consumer_threads)
+            continue;
+
+        int thread_level = std::max({std::get<0>(producer_threads), std::get<1>(producer_threads),
+                                     std::get<2>(producer_threads)});
+        int producer_depth = producer->get_loop_levels_number();
+        int consumer_depth = consumer->get_loop_levels_number();
+        int depth = std::min(producer_depth, consumer_depth);
+        if (previous_level >= thread_level || depth <= thread_level)
+            continue;
+
+        // The same grid of blocks and threads
+        isl_map *producer_times = loop_times(producer, depth);
+        isl_map *consumer_times = loop_times(consumer, depth);
+        isl_set *producer_grid = isl_set_project_out(isl_map_range(isl_map_copy(producer_times)), isl_dim_set,
+                                                     thread_level + 1, depth - thread_level - 1);
+        isl_set *consumer_grid = isl_set_project_out(isl_map_range(isl_map_copy(consumer_times)), isl_dim_set,
+                                                     thread_level + 1, depth - thread_level - 1);
+        bool same_grid = (isl_set_is_equal(producer_grid, consumer_grid) == isl_bool_true);
+        isl_set_free(producer_grid);
+        isl_set_free(consumer_grid);
+
+        // consumer time -> the times of the producer that wrote the values it reads
+        std::string buffer_name = isl_map_get_tuple_name(producer->get_access_relation(), isl_dim_out);
+        isl_map *consumed = NULL;
+        std::vector<isl_map *> accesses;
+        generator::get_rhs_accesses(this, consumer, accesses, true);
+        for (isl_map *access : accesses)
+            if (isl_map_has_tuple_name(access, isl_dim_out) == isl_bool_true &&
+                buffer_name == isl_map_get_tuple_name(access, isl_dim_out))
+                consumed = (consumed == NULL) ? access : isl_map_union(consumed, access);
+            else
+                isl_map_free(access);
+
+        int max_level = computation::root_dimension;
+        if (same_grid && consumed != NULL)
+        {
+            consumed = isl_map_intersect_domain(consumed, isl_set_copy(consumer->get_iteration_domain()));
+            isl_map *written = isl_map_intersect_domain(isl_map_copy(producer->get_access_relation()),
+                                                        isl_set_copy(producer->get_iteration_domain()));
+            isl_map *sources = isl_map_apply_range(isl_map_apply_range(isl_map_reverse(isl_map_copy(consumer_times)),
+                                                                       isl_map_apply_range(consumed, isl_map_reverse(written))),
+                                                   isl_map_copy(producer_times));
+
+            // Each thread only reads what it produced: the deepest level such that the
+            // consumer only reads values produced at the same iteration of the loops up to it
+            isl_map *same_iteration = isl_map_copy(sources);
+            for (int l = 0; l < depth; l++)
+            {
+                same_iteration = isl_map_equate(same_iteration, isl_dim_in, l, isl_dim_out, l);
+                if (isl_map_is_subset(sources, same_iteration) != isl_bool_true)
+                    break;
+                max_level = l;
+            }
+            isl_map_free(same_iteration);
+            isl_map_free(sources);
+        }
+        else if (consumed != NULL)
+            isl_map_free(consumed);
+        isl_map_free(producer_times);
+        isl_map_free(consumer_times);
+
+        // Fuse at the deepest legal level inside the threads
+        int level = previous_level;
+        for (int l = max_level; l >= thread_level && l > previous_level; l--)
+        {
+            this->sched_graph[producer][consumer] = l;
+            this->sched_graph_reversed[consumer][producer] = l;
+            this->prepare_schedules_for_legality_checks(true);
+
+            if (this->check_legality_for_function())
+            {
+                level = l;
+                break;
+            }
+        }
+
+        this->sched_graph[producer][consumer] = level;
+        this->sched_graph_reversed[consumer][producer] = level;
+
+        if (level == previous_level)
+            continue;
+
+        // The intermediate is kept in a register when the consumer is its only reader,
+        // and reads it in the iteration that produced it
+        tiramisu::buffer *buff = this->get_buffers().at(buffer_name);
+        bool in_register = (level == producer_depth - 1 && level == consumer_depth - 1 &&
+                            buff->get_argument_type() == tiramisu::a_temporary &&
+                            buff->location == cuda_ast::memory_location::global &&
+                            writers[buffer_name].size() == 1 && readers[buffer_name].size() == 1 &&
+                            std::none_of(this->mapping.begin(), this->mapping.end(),
+                                         [buff](const std::pair<const std::string, tiramisu::buffer *> &m) {
+                                             return m.first == buff->get_name() || m.second == buff;
+                                         }));
+
+        double saved_bytes = 0;
+        if (buff->has_constant_extents())
+        {
+            saved_bytes = halide_type_from_tiramisu_type(buff->get_elements_type()).bytes();
+            for (auto &size : buff->get_dim_sizes())
+                saved_bytes *= size.get_int_val();
+            if (in_register)
+                saved_bytes *= 2;
+        }
+
+        if (apply && in_register)
+        {
+            std::string reg_name = "_" + producer->get_name() + "_reg";
+            tiramisu::buffer *reg = new tiramisu::buffer(reg_name, {1}, buff->get_elements_type(),
+                                                         tiramisu::a_temporary, this);
+            reg->tag_gpu_register();
+            isl_map *access = isl_map_set_tuple_name(isl_map_copy(producer->get_access_relation()), isl_dim_out,
+                                                     reg_name.c_str());
+            access = isl_map_project_out(access, isl_dim_out, 0, isl_map_dim(access, isl_dim_out));
+            access = isl_map_set_tuple_name(isl_map_add_dims(access, isl_dim_out, 1), isl_dim_out, reg_name.c_str());
+            access = isl_map_fix_si(access, isl_dim_out, 0, 0);
+            producer->set_access(access);
+            isl_map_free(access);
+            buff->set_auto_allocate(false);
+
+            // The register is declared in the iteration of the thread, before the producer
+            isl_set *dec_domain = isl_set_set_tuple_name(isl_set_copy(producer->get_iteration_domain()),
+                                                         (reg_name + "_dec").c_str());
+            tiramisu::computation *dec = new tiramisu::computation(isl_set_to_str(dec_domain), allocate(*reg),
+                                                                   true, p_none, this);
+            isl_set_free(dec_domain);
+            isl_map *schedule = isl_map_set_tuple_name(isl_map_copy(producer->get_schedule()), isl_dim_in,
+                                                       dec->get_name().c_str());
+            dec->set_schedule(isl_map_set_tuple_name(schedule, isl_dim_out, dec->get_name().c_str()));
+            this->gpu_block_dimensions.push_back(std::make_pair(dec->get_name(), producer_blocks));
+            this->gpu_thread_dimensions.push_back(std::make_pair(dec->get_name(), producer_threads));
+
+            tiramisu::computation *pred = producer->get_predecessor();
+            if (pred != nullptr)
+                dec->between(*pred, this->sched_graph[pred][producer], *producer, producer_depth - 1);
+            else
+                dec->before(*producer, producer_depth - 1);
+        }
+
+        DEBUG(3, tiramisu::str_dump("Fused the kernel of " + consumer->get_name() + " with the kernel of " +
+                                    producer->get_name() + " at level " + std::to_string(level) +
+                                    (in_register ? ", the intermediate is kept in a register" : "")));
+
+        fusions.push_back({producer, consumer, previous_level, level, saved_bytes});
+    }
+
+    if (!apply)
+        for (auto &fusion : fusions)
+        {
+            this->sched_graph[fusion.producer][fusion.consumer] = fusion.previous_level;
+            this->sched_graph_reversed[fusion.consumer][fusion.producer] = fusion.previous_level;
+        }
+
+    this->prepare_schedules_for_legality_checks(true);
+
+    DEBUG_INDENT(-4);
+
+    return fusions;
+}
+
+void tiramisu::function::narrow_integer_types(const tiramisu::value_ranges_t &value_ranges)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    tiramisu::value_ranges_t ranges = value_ranges;
+
+    for (tiramisu::computation *comp : this->get_computations())
+    {
+        if (!comp->get_expr().is_defined())
+            continue;
+
+        tiramisu::expr narrowed = tiramisu::narrow_integer_types(comp->get_expr(), ranges);
+        if (!narrowed.is_equal(comp->get_expr()))
+        {
+            DEBUG(3, tiramisu::str_dump("Narrowed the expression of " + comp->get_name() + " to " + narrowed.to_str()));
+            comp->set_expression(narrowed);
+        }
+
+        // The values of a computation defined once bound the accesses to it
+        int64_t min, max;
+        if ((ranges.count(comp->get_name()) == 0) && (this->get_computation_by_name(comp->get_name()).size() == 1) &&
+            tiramisu::get_value_range(narrowed, min, max, ranges))
+            ranges[comp->get_name()] = {min, max};
+    }
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::function::optimize_temporaries_layout()
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    if (this->get_computations().empty())
+    {
+        DEBUG_INDENT(-4);
+        return ;
+    }
+
+    this->perform_full_dependency_analysis();
+
+    // The buffers that can be transformed and the computations that write into each of them.
+    std::vector<tiramisu::buffer *> temporaries;
+    std::map<std::string, std::vector<tiramisu::computation *>> writers;
+    std::unordered_set<std::string> rejected;
+
+    for (auto &comput : this->get_computations())
+    {
+        if (comput->is_inline_computation() || comput->get_access_relation() == NULL)
+            continue;
+
+        std::string buffer_name = isl_map_get_tuple_name(comput->get_access_relation(), isl_dim_out);
+        auto buff_it = this->get_buffers().find(buffer_name);
+
+        if (buff_it == this->get_buffers().end())
+            continue;
+
+        tiramisu::buffer *buff = buff_it->second;
+
+        if (buff->get_argument_type() != tiramisu::a_temporary || !buff->get_auto_allocate() ||
+            buff->get_location() != cuda_ast::memory_location::host || !buff->has_constant_extents() ||
+            buff->get_n_dims() < 2 || this->get_computation_by_name(comput->get_name()).size() > 1)
+            rejected.insert(buffer_name);
+
+        if (writers.find(buffer_name) == writers.end())
+            temporaries.push_back(buff);
+
+        writers[buffer_name].push_back(comput);
+    }
+
+    temporaries.erase(std::remove_if(temporaries.begin(), temporaries.end(), [&](tiramisu::buffer *buff) {
+        return rejected.find(buff->get_name()) != rejected.end();
+    }), temporaries.end());
+
+    // write -> read, for each read of a value
+    isl_union_map *value_reads = isl_union_map_range_factor_domain(isl_union_map_copy(this->dep_read_after_write));
+
+    for (tiramisu::buffer *buff : temporaries)
+    {
+        std::string buffer_name = buff->get_name();
+        int n_dims = buff->get_n_dims();
+
+        isl_union_map *write_access = isl_union_map_read_from_str(this->get_isl_ctx(), "{}");
+        for (tiramisu::computation *comput : writers[buffer_name])
+            write_access = isl_union_map_union(write_access,
+                                               isl_union_map_from_map(isl_map_copy(comput->get_access_relation())));
+        write_access = isl_union_map_intersect_domain(write_access, this->get_iteration_domain());
+
+        // read -> element of the buffer
+        isl_union_map *read_access = isl_union_map_apply_range(
+            isl_union_map_reverse(isl_union_map_intersect_domain(isl_union_map_copy(value_reads),
+                                                                 isl_union_map_domain(isl_union_map_copy(write_access)))),
+            write_access);
+
+        // The elements of the buffer read by the iterations where only dimension d varies
+        auto get_walk_str = [&](int d)
+        {
+            std::string elements_str, constraints_str;
+
+            for (int i = 0; i < n_dims; i++)
+            {
+                elements_str += "x" + std::to_string(i) + ((i != n_dims - 1) ? "," : "");
+                if (i != d)
+                    constraints_str += (constraints_str.empty() ? "" : " and ") + ("x" + std::to_string(i)) + " = 0";
+            }
+
+            return "{" + buffer_name + "[" + elements_str + "] : " + constraints_str + "}";
+        };
+
+        std::vector<int> votes(n_dims, 0);
+
+        for (auto &reader : this->get_computations())
+        {
+            int n_levels = reader->get_loop_levels_number();
+            if (n_levels == 0)
+                continue;
+
+            isl_union_map *reader_access = isl_union_map_intersect_domain(
+                isl_union_map_copy(read_access), isl_union_set_from_set(isl_set_copy(reader->get_iteration_domain())));
+
+            if (isl_union_map_is_empty(reader_access))
+            {
+                isl_union_map_free(reader_access);
+                continue;
+            }
+
+            // time -> element read at that time
+            isl_map *time_access = isl_map_apply_range(isl_map_reverse(isl_map_copy(reader->get_schedule())),
+                                                       isl_map_from_union_map(reader_access));
+
+            // time -> next iteration of the innermost loop
+            int innermost = loop_level_into_dynamic_dimension(n_levels - 1);
+            int time_dims = isl_map_dim(reader->get_schedule(), isl_dim_out);
+            std::string in_str, out_str;
+
+            for (int i = 0; i < time_dims; i++)
+            {
+                std::string t = "t" + std::to_string(i);
+                in_str += t + ((i != time_dims - 1) ? "," : "");
+                out_str += ((i == innermost) ? t + " + 1" : t) + ((i != time_dims - 1) ? "," : "");
+            }
+
+            std::string time_name = isl_map_get_tuple_name(reader->get_schedule(), isl_dim_out);
+            isl_map *next = isl_map_read_from_str(this->get_isl_ctx(),
+                                                  ("{" + time_name + "[" + in_str + "] -> " + time_name + "[" + out_str + "]}").c_str());
+
+            // element -> element read at the next iteration of the innermost loop
+            isl_map *successive_reads = isl_map_apply_range(isl_map_apply_range(isl_map_reverse(isl_map_copy(time_access)), next),
+                                                            time_access);
+            isl_set *strides = isl_map_deltas(successive_reads);
+
+            DEBUG(3, tiramisu::str_dump("Strides of the reads of " + buffer_name + " by " + reader->get_name() + ": ",
+                                        isl_set_to_str(strides)));
+
+            isl_set *zero = isl_set_read_from_str(this->get_isl_ctx(), get_walk_str(-1).c_str());
+            if (isl_set_is_empty(strides) == isl_bool_false && isl_set_is_subset(strides, zero) == isl_bool_false)
+            {
+                for (int d = 0; d < n_dims; d++)
+                {
+                    isl_set *walk = isl_set_read_from_str(this->get_isl_ctx(), get_walk_str(d).c_str());
+                    if (isl_set_is_subset(strides, walk) == isl_bool_true)
+                        votes[d]++;
+                    isl_set_free(walk);
+                }
+            }
+
+            isl_set_free(zero);
+            isl_set_free(strides);
+        }
+
+        isl_union_map_free(read_access);
+
+        int innermost_dim = std::max_element(votes.begin(), votes.end()) - votes.begin();
+
+        if (votes[innermost_dim] <= votes[n_dims - 1])
+            continue;
+
+        // Move the dimension innermost_dim to the end
+        std::vector<int> order;
+        for (int i = 0; i < n_dims; i++)
+            if (i != innermost_dim)
+                order.push_back(i);
+        order.push_back(innermost_dim);
+
+        std::string in_str, out_str;
+        for (int i = 0; i < n_dims; i++)
+        {
+            in_str += "x" + std::to_string(i) + ((i != n_dims - 1) ? "," : "");
+            out_str += "x" + std::to_string(order[i]) + ((i != n_dims - 1) ? "," : "");
+        }
+
+        std::string permutation_str = "{" + buffer_name + "[" + in_str + "] -> " + buffer_name + "[" + out_str + "]}";
+        DEBUG(3, tiramisu::str_dump("Changing the layout of the temporary buffer " + buffer_name + " with " + permutation_str));
+
+        isl_map *permutation = isl_map_read_from_str(this->get_isl_ctx(), permutation_str.c_str());
+
+        for (tiramisu::computation *comput : writers[buffer_name])
+        {
+            isl_map *access = isl_map_apply_range(isl_map_copy(comput->get_access_relation()), isl_map_copy(permutation));
+            comput->set_access(access);
+            isl_map_free(access);
+        }
+
+        isl_map_free(permutation);
+
+        std::vector<int> sizes;
+        for (int i = 0; i < n_dims; i++)
+            sizes.push_back(buff->get_dim_sizes()[i].get_int_val());
+        for (int i = 0; i < n_dims; i++)
+            buff->set_dim_size(i, sizes[order[i]]);
+    }
+
+    isl_union_map_free(value_reads);
+
+    DEBUG_INDENT(-4);
+}
+
+std::string tiramisu::function::get_gpu_thread_iterator(const std::string &comp, int lev0) const
+{
+    assert(!comp.empty());
+    assert(lev0 >= 0);
+
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    std::string res = "";
+
+    for (const auto &pd : this->gpu_thread_dimensions)
+    {
+        if ((pd.first == comp) && ((std::get<0>(pd.second) == lev0) || (std::get<1>(pd.second) == lev0) ||
+                                   (std::get<2>(pd.second) == lev0)))
+        {
+            if (lev0 == std::get<0>(pd.second))
+            {
+                res = ".__thread_id_z";
+            }
+            else if (lev0 == std::get<1>(pd.second))
+            {
+                res = ".__thread_id_y";
+            }
+            else if (lev0 == std::get<2>(pd.second))
+            {
+                res = ".__thread_id_x";
+            }
+            else
+            {
+                ERROR("Level not mapped to GPU.", true);
+            }
+
+            std::string str = "Dimension " + std::to_string(lev0) +
+                              " should be mapped to iterator " + res;
+            str = str + ". It was compared against: " + std::to_string(std::get<0>(pd.second)) +
+                  ", " + std::to_string(std::get<1>(pd.second)) + " and " +
+                  std::to_string(std::get<2>(pd.second));
+            DEBUG(3, tiramisu::str_dump(str));
+        }
+    }
+
+    DEBUG_INDENT(-4);
+    return res;
+}
+
+std::string tiramisu::function::get_gpu_block_iterator(const std::string &comp, int lev0) const
+{
+    assert(!comp.empty());
+    assert(lev0 >= 0);
+
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    std::string res = "";;
+
+    for (const auto &pd : this->gpu_block_dimensions)
+    {
+        if ((pd.first == comp) && ((std::get<0>(pd.second) == lev0) || (std::get<1>(pd.second) == lev0) ||
+                                   (std::get<2>(pd.second) == lev0)))
+        {
+            if (lev0 == std::get<0>(pd.second))
+            {
+                res = ".__block_id_z";
+            }
+            else if (lev0 == std::get<1>(pd.second))
+            {
+                res = ".__block_id_y";
+            }
+            else if (lev0 == std::get<2>(pd.second))
+            {
+                res = ".__block_id_x";
+            }
+            else
+            {
+                ERROR("Level not mapped to GPU.", true);
+            }
+
+            std::string str = "Dimension " + std::to_string(lev0) +
                               " should be mapped to iterator " + res;
             str = str + ". It was compared against: " + std::to_string(std::get<0>(pd.second)) +
                   ", " + std::to_string(std::get<1>(pd.second)) + " and " +
@@ -1688,8 +3817,8 @@ int tiramisu::function::get_max_identity_schedules_range_dim() const
     int max_dim = 0;
     for (const auto &comp : this->get_computations())
     {
-        isl_map *sched = comp->gen_identity_schedule_for_time_space_domain();
-        int m = isl_map_dim(sched, isl_dim_out);
+        isl_map_ptr sched(comp->gen_identity_schedule_for_time_space_domain());
+        int m = isl_map_dim(sched.get(), isl_dim_out);
         max_dim = std::max(max_dim, m);
     }
 
@@ -1742,7 +3871,8 @@ isl_union_map *tiramisu::function::get_aligned_identity_schedules() const
 
     if (this->body.empty() == false)
     {
-        space = isl_map_get_space(this->body[0]->gen_identity_schedule_for_time_space_domain());
+        isl_map_ptr sched(this->body[0]->gen_identity_schedule_for_time_space_domain());
+        space = isl_map_get_space(sched.get());
     }
     else
     {
@@ -1780,13 +3910,16 @@ void tiramisu::function::align_schedules()
 
     for (auto &comp : this->get_computations())
     {
-        
         isl_map *dup_sched = comp->get_schedule();
         assert((dup_sched != NULL) && "Schedules should be set before calling align_schedules");
-        dup_sched = isl_map_align_range_dims(dup_sched, max_dim);
-        comp->set_schedule(dup_sched);
+
+        // Only the schedules whose dimensionality differs are rewritten
+        if (isl_map_dim(dup_sched, isl_dim_out) != max_dim)
+        {
+            dup_sched = isl_map_align_range_dims(dup_sched, max_dim);
+            comp->set_schedule(dup_sched);
+        }
         comp->name_unnamed_time_space_dimensions();
-        
     }
 
     DEBUG_INDENT(-4);
@@ -1796,29 +3929,122 @@ void tiramisu::function::align_schedules()
 void tiramisu::function::reset_schedules()
 {
     for (computation *comp : get_computations())
+    {
         comp->set_identity_schedule_based_on_iteration_domain();
+        comp->thread_block_shape.clear();
+    }
         
     remove_dimension_tags();
     clear_sched_graph();
 }
 
-void tiramisu::function::add_invariant(tiramisu::constant invar)
+void tiramisu::function::add_invariant(tiramisu::constant invar)
+{
+    invariants.push_back(invar);
+}
+
+void tiramisu::function::add_computation(computation *cpt)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(cpt != NULL);
+
+    this->computation_positions[cpt] = this->body.size();
+    this->computations_by_name[cpt->get_name()].push_back(cpt);
+    this->body.push_back(cpt);
+    if (cpt->should_schedule_this_computation())
+        this->starting_computations.insert(cpt);
+
+    DEBUG_INDENT(-4);
+}
+
+void tiramisu::function::add_block(const std::vector<computation *> &children)
+{
+    assert(!children.empty());
+
+    this->blocks.push_back(children);
+}
+
+void tiramisu::function::update_computation_name(computation *comp, const std::string &old_name)
+{
+    auto pos = this->computation_positions.find(comp);
+    if (pos == this->computation_positions.end())
+        return;
+
+    auto old_it = this->computations_by_name.find(old_name);
+    if (old_it != this->computations_by_name.end())
+    {
+        std::vector<computation *> &old_comps = old_it->second;
+        old_comps.erase(std::remove(old_comps.begin(), old_comps.end(), comp), old_comps.end());
+        if (old_comps.empty())
+            this->computations_by_name.erase(old_it);
+    }
+
+    // Keep the computations that have the same name in the order of the body
+    std::vector<computation *> &comps = this->computations_by_name[comp->get_name()];
+    auto it = std::upper_bound(comps.begin(), comps.end(), pos->second,
+                               [this](int position, computation *c) {
+                                   return position < this->computation_positions.at(c);
+                               });
+    comps.insert(it, comp);
+}
+
+void tiramisu::function::truncate_computations(int size)
 {
-    invariants.push_back(invar);
+    for (int i = size; i < this->body.size(); i++)
+    {
+        computation *comp = this->body[i];
+        this->starting_computations.erase(comp);
+        this->computation_positions.erase(comp);
+
+        auto it = this->computations_by_name.find(comp->get_name());
+        if (it != this->computations_by_name.end())
+        {
+            it->second.erase(std::remove(it->second.begin(), it->second.end(), comp), it->second.end());
+            if (it->second.empty())
+                this->computations_by_name.erase(it);
+        }
+    }
+
+    this->body.resize(size);
 }
 
-void tiramisu::function::add_computation(computation *cpt)
+void tiramisu::function::dump_memory_usage() const
 {
-    DEBUG_FCT_NAME(3);
-    DEBUG_INDENT(4);
-
-    assert(cpt != NULL);
+    int n_sets = 0, n_basic_sets = 0;
+    auto count_set = [&](isl_set *set) {
+        if (set != NULL)
+        {
+            n_sets++;
+            n_basic_sets += isl_set_n_basic_set(set);
+        }
+    };
+    auto count_map = [&](isl_map *map) {
+        if (map != NULL)
+        {
+            n_sets++;
+            n_basic_sets += isl_map_n_basic_map(map);
+        }
+    };
 
-    this->body.push_back(cpt);
-    if (cpt->should_schedule_this_computation())
-        this->starting_computations.insert(cpt);
+    for (const auto &comp : this->body)
+    {
+        count_set(comp->get_iteration_domain());
+        count_set(comp->get_time_processor_domain());
+        count_map(comp->get_schedule());
+        count_map(comp->get_access_relation());
+    }
 
-    DEBUG_INDENT(-4);
+    std::cout << "Memory usage of function \"" << this->name << "\":" << std::endl;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 info = mallinfo2();
+    std::cout << "  heap in use: " << info.uordblks + info.hblkhd << " bytes" << std::endl;
+#endif
+    std::cout << "  computations: " << this->body.size() << std::endl;
+    std::cout << "  buffers: " << this->buffers_list.size() << std::endl;
+    std::cout << "  isl sets and maps held: " << n_sets
+              << " (" << n_basic_sets << " basic sets and maps)" << std::endl;
 }
 
 void tiramisu::function::dump(bool exhaustive) const
@@ -1958,6 +4184,14 @@ void tiramisu::function::add_vector_dimension(std::string stmt_name, int vec_dim
     this->vector_dimensions.push_back(std::make_tuple(stmt_name, vec_dim, vector_length));
 }
 
+void tiramisu::function::add_predicated_vector_dimension(std::string stmt_name, int dim)
+{
+    assert(dim >= 0);
+    assert(!stmt_name.empty());
+
+    this->predicated_vector_dimensions.push_back({stmt_name, dim});
+}
+
 void tiramisu::function::add_distributed_dimension(std::string stmt_name, int dim)
 {
     assert(dim >= 0);
@@ -1966,6 +4200,22 @@ void tiramisu::function::add_distributed_dimension(std::string stmt_name, int di
     this->distributed_dimensions.push_back({stmt_name, dim});
 }
 
+void tiramisu::function::add_gpu_device_dimension(std::string stmt_name, int dim)
+{
+    assert(dim >= 0);
+    assert(!stmt_name.empty());
+
+    this->gpu_device_dimensions.push_back({stmt_name, dim});
+}
+
+void tiramisu::function::add_gpu_persistent_dimension(std::string stmt_name, int dim)
+{
+    assert(dim >= 0);
+    assert(!stmt_name.empty());
+
+    this->gpu_persistent_dimensions.push_back({stmt_name, dim});
+}
+
 void tiramisu::function::add_parallel_dimension(std::string stmt_name, int vec_dim)
 {
     assert(vec_dim >= 0);
@@ -1974,6 +4224,71 @@ void tiramisu::function::add_parallel_dimension(std::string stmt_name, int vec_d
     this->parallel_dimensions.push_back({stmt_name, vec_dim});
 }
 
+void tiramisu::function::add_doacross_dimension(std::string stmt_name, int dim, int distance)
+{
+    assert(dim >= 0);
+    assert(distance >= 0);
+    assert(!stmt_name.empty());
+
+    this->doacross_dimensions.push_back(std::make_tuple(stmt_name, dim, distance));
+}
+
+void tiramisu::function::add_pipeline_dimension(std::string stmt_name, int dim, int depth)
+{
+    assert(dim >= 0);
+    assert(depth >= 0);
+    assert(!stmt_name.empty());
+
+    this->pipeline_dimensions.push_back(std::make_tuple(stmt_name, dim, depth));
+}
+
+void tiramisu::function::add_parametric_split_dimension(std::string stmt_name, int dim,
+                                                        std::vector<tiramisu::expr> sizes)
+{
+    assert(dim >= 0);
+    assert(sizes.size() == 1 || sizes.size() == 2);
+    assert(!stmt_name.empty());
+
+    this->parametric_split_dimensions.push_back(std::make_tuple(stmt_name, dim, sizes));
+}
+
+void tiramisu::function::add_reduction_dimension(std::string stmt_name, int dim,
+                                                 tiramisu::reduction_strategy_t strategy, int nb_partials)
+{
+    assert(dim >= 0);
+    assert(nb_partials > 0);
+    assert(!stmt_name.empty());
+
+    this->reduction_dimensions.push_back(std::make_tuple(stmt_name, dim, strategy, nb_partials));
+}
+
+void tiramisu::function::add_scan_dimension(std::string stmt_name, int dim, int nb_blocks)
+{
+    assert(dim >= 0);
+    assert(nb_blocks > 0);
+    assert(!stmt_name.empty());
+
+    this->scan_dimensions.push_back(std::make_tuple(stmt_name, dim, nb_blocks));
+}
+
+void tiramisu::function::add_prefetch_dimension(std::string stmt_name, std::string buffer_name, int dim, int distance)
+{
+    assert(dim >= 0);
+    assert(distance > 0);
+    assert(!stmt_name.empty());
+    assert(!buffer_name.empty());
+
+    this->prefetch_dimensions.push_back(std::make_tuple(stmt_name, buffer_name, dim, distance));
+}
+
+void tiramisu::function::add_ast_option(std::string stmt_name, int dim, tiramisu::ast_option_t option)
+{
+    assert(dim >= 0);
+    assert(!stmt_name.empty());
+
+    this->ast_options.push_back(std::make_tuple(stmt_name, dim, option));
+}
+
 void tiramisu::function::add_unroll_dimension(std::string stmt_name, int level, int factor)
 {
     assert(level >= 0);
@@ -2012,8 +4327,16 @@ void tiramisu::function::add_gpu_thread_dimensions(std::string stmt_name, int di
 void tiramisu::function::remove_dimension_tags()
 {
     parallel_dimensions.clear();
+    doacross_dimensions.clear();
+    parametric_split_dimensions.clear();
+    pipeline_dimensions.clear();
+    prefetch_dimensions.clear();
     vector_dimensions.clear();
+    predicated_vector_dimensions.clear();
     distributed_dimensions.clear();
+    _needs_rank_call = false;
+    gpu_device_dimensions.clear();
+    gpu_persistent_dimensions.clear();
     gpu_block_dimensions.clear();
     gpu_thread_dimensions.clear();
     unroll_dimensions.clear();
@@ -2028,7 +4351,8 @@ isl_union_set *tiramisu::function::get_trimmed_time_processor_domain() const
     isl_space *space = NULL;
     if (!this->body.empty())
     {
-        space = isl_set_get_space(this->body[0]->get_trimmed_time_processor_domain());
+        isl_set_ptr tp_domain(this->body[0]->get_trimmed_time_processor_domain());
+        space = isl_set_get_space(tp_domain.get());
     }
     else
     {
@@ -2043,7 +4367,7 @@ isl_union_set *tiramisu::function::get_trimmed_time_processor_domain() const
     {
         if (cpt->should_schedule_this_computation())
         {
-            isl_set *cpt_iter_space = isl_set_copy(cpt->get_trimmed_time_processor_domain());
+            isl_set *cpt_iter_space = cpt->get_trimmed_time_processor_domain();
             result = isl_union_set_union(isl_union_set_from_set(cpt_iter_space), result);
         }
     }
@@ -2131,7 +4455,7 @@ isl_union_map *tiramisu::function::get_schedule() const
     }
 
     assert(space != NULL);
-    result = isl_union_map_empty(isl_space_copy(space));
+    result = isl_union_map_empty(space);
 
     for (const auto &cpt : this->body)
     {
@@ -2151,7 +4475,8 @@ isl_union_map *tiramisu::function::get_trimmed_schedule() const
 
     if (!this->body.empty())
     {
-        space = isl_map_get_space(this->body[0]->get_trimmed_union_of_schedules());
+        isl_map_ptr sched(this->body[0]->get_trimmed_union_of_schedules());
+        space = isl_map_get_space(sched.get());
     }
     else
     {
@@ -2159,11 +4484,11 @@ isl_union_map *tiramisu::function::get_trimmed_schedule() const
     }
 
     assert(space != NULL);
-    result = isl_union_map_empty(isl_space_copy(space));
+    result = isl_union_map_empty(space);
 
     for (const auto &cpt : this->body)
     {
-        isl_map *m = isl_map_copy(cpt->get_trimmed_union_of_schedules());
+        isl_map *m = cpt->get_trimmed_union_of_schedules();
         result = isl_union_map_union(isl_union_map_from_map(m), result);
     }
 
@@ -2172,9 +4497,99 @@ isl_union_map *tiramisu::function::get_trimmed_schedule() const
     return result;
 }
 
+/**
+  * Bound the accesses of \p e to the inputs \p inputs, which have the boundary
+  * conditions \p conditions.
+  */
+static tiramisu::expr apply_boundary_conditions(const std::map<std::string, tiramisu::computation *> &inputs,
+    const std::map<std::string, std::pair<tiramisu::boundary_t, tiramisu::expr>> &conditions,
+    const tiramisu::expr &e)
+{
+    tiramisu::expr result = e.apply_to_operands([&](const tiramisu::expr &op) {
+        return apply_boundary_conditions(inputs, conditions, op);
+    });
+
+    if (e.get_expr_type() != tiramisu::e_op || e.get_op_type() != tiramisu::o_access ||
+        conditions.count(e.get_name()) == 0)
+        return result;
+
+    tiramisu::boundary_t type = conditions.at(e.get_name()).first;
+    isl_set *domain = inputs.at(e.get_name())->get_iteration_domain();
+
+    tiramisu::expr in_bounds;
+    for (int i = 0; i < result.get_access().size(); i++)
+    {
+        tiramisu::expr index = result.get_access()[i];
+        tiramisu::expr low = utility::get_bound(isl_set_copy(domain), i, false);
+        tiramisu::expr up = utility::get_bound(isl_set_copy(domain), i, true);
+        tiramisu::expr extent = up - low + 1;
+
+        switch (type)
+        {
+            case tiramisu::boundary_constant:
+                in_bounds = in_bounds.is_defined() ? (in_bounds && (index >= low) && (index <= up))
+                                                   : ((index >= low) && (index <= up));
+                // The access itself is clamped, so that it stays valid when the
+                // constant is selected.
+            case tiramisu::boundary_clamp:
+                index = tiramisu::expr(tiramisu::o_max, tiramisu::expr(tiramisu::o_min, index, up), low);
+                break;
+            case tiramisu::boundary_wrap:
+                index = low + ((index - low) % extent + extent) % extent;
+                break;
+            case tiramisu::boundary_mirror:
+            {
+                tiramisu::expr period = extent * 2;
+                tiramisu::expr m = ((index - low) % period + period) % period;
+                index = low + tiramisu::expr(tiramisu::o_select, m < extent, m, period - 1 - m);
+                break;
+            }
+        }
+        result.set_access_dimension(i, index);
+    }
+
+    if (type == tiramisu::boundary_constant)
+    {
+        tiramisu::expr value = tiramisu::expr(tiramisu::o_cast, result.get_data_type(), conditions.at(e.get_name()).second);
+        result = tiramisu::expr(tiramisu::o_select, in_bounds, result, value);
+    }
+
+    return result;
+}
+
+void tiramisu::function::lower_boundary_conditions()
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    if (this->boundary_conditions.empty())
+    {
+        DEBUG_INDENT(-4);
+        return;
+    }
+
+    std::map<std::string, tiramisu::computation *> inputs;
+    for (const auto &condition : this->boundary_conditions)
+        inputs[condition.first] = this->get_computation_by_name(condition.first)[0];
+
+    for (auto &comp : this->body)
+    {
+        if (comp->accesses_in_bounds || !comp->should_schedule_this_computation() ||
+            !comp->get_expr().is_defined())
+            continue;
+
+        DEBUG(3, tiramisu::str_dump("Applying the boundary conditions to the accesses of " + comp->get_name()));
+        comp->set_expression(apply_boundary_conditions(inputs, this->boundary_conditions, comp->get_expr()));
+        comp->accesses_in_bounds = true;
+    }
+
+    DEBUG_INDENT(-4);
+}
+
 void tiramisu::function::lift_dist_comps() {
     for (std::vector<tiramisu::computation *>::iterator comp = body.begin(); comp != body.end(); comp++) {
-        if ((*comp)->is_send() || (*comp)->is_recv() || (*comp)->is_wait() || (*comp)->is_send_recv()) {
+        if ((*comp)->is_send() || (*comp)->is_recv() || (*comp)->is_wait() || (*comp)->is_send_recv() ||
+            (*comp)->is_collective()) {
             xfer_prop chan = static_cast<tiramisu::communicator *>(*comp)->get_xfer_props();
             if (chan.contains_attr(MPI)) {
                 lift_mpi_comp(*comp);
@@ -2191,124 +4606,535 @@ void tiramisu::function::lift_mpi_comp(tiramisu::computation *comp) {
         tiramisu::expr num_elements(s->get_num_elements());
         tiramisu::expr send_type(s->get_xfer_props().get_dtype());
         bool isnonblock = s->get_xfer_props().contains_attr(NONBLOCK);
+        // The properties may have changed since the send was created (e.g. made nonblocking by
+        // overlap_communication), so recompute the name of the runtime function.
+        s->library_call_name = create_send_func_name(s->get_xfer_props());
         // Determine the appropriate number of function args and set ones that we can already know
         s->rhs_argument_idx = 3;
-        s->library_call_args.resize(isnonblock ? 5 : 4);
+        s->library_call_args.resize((isnonblock ? 5 : 4) + (s->is_strided() ? 2 : 0));
         s->library_call_args[0] = tiramisu::expr(tiramisu::o_cast, p_int32, num_elements);
         s->library_call_args[1] = tiramisu::expr(tiramisu::o_cast, p_int32, s->get_dest());
-        s->library_call_args[2] = tiramisu::expr(tiramisu::o_cast, p_int32, s->get_msg_tag());
+        s->library_call_args[2] = lift_mpi_tag(s, s->get_msg_tag());
         if (isnonblock) {
             // This additional RHS argument is to the request buffer. It is really more of a side effect.
             s->wait_argument_idx = 4;
         }
+        if (s->is_strided()) {
+            if (s->get_xfer_props().contains_attr(RMA))
+                ERROR("Strided one-sided (RMA) transfers are not supported.", true);
+            // tiramisu_MPI_<op>_vector_<type> takes the layout of the message as its last two arguments.
+            lift_mpi_strided_layout(s);
+        }
     } else if (comp->is_recv()) {
         recv *r = static_cast<recv *>(comp);
         send *s = r->get_matching_send();
         tiramisu::expr num_elements(r->get_num_elements());
         tiramisu::expr recv_type(s->get_xfer_props().get_dtype());
         bool isnonblock = r->get_xfer_props().contains_attr(NONBLOCK);
+        r->library_call_name = create_recv_func_name(r->get_xfer_props());
         // Determine the appropriate number of function args and set ones that we can already know
         r->lhs_argument_idx = 3;
-        r->library_call_args.resize(isnonblock ? 5 : 4);
+        r->library_call_args.resize((isnonblock ? 5 : 4) + (r->is_strided() ? 2 : 0));
         r->library_call_args[0] = tiramisu::expr(tiramisu::o_cast, p_int32, num_elements);
         r->library_call_args[1] = tiramisu::expr(tiramisu::o_cast, p_int32, r->get_src());
-        r->library_call_args[2] = tiramisu::expr(tiramisu::o_cast, p_int32, r->get_msg_tag().is_defined() ?
-                                                                            r->get_msg_tag() : s->get_msg_tag());
+        r->library_call_args[2] = lift_mpi_tag(r, r->get_msg_tag().is_defined() ? r->get_msg_tag() : s->get_msg_tag());
         r->lhs_access_type = tiramisu::o_address_of;
         if (isnonblock) {
             // This RHS argument is to the request buffer. It is really more of a side effect.
           r->wait_argument_idx = 4;
         }
+        if (r->is_strided()) {
+            if (r->get_xfer_props().contains_attr(RMA))
+                ERROR("Strided one-sided (RMA) transfers are not supported.", true);
+            lift_mpi_strided_layout(r);
+        }
     } else if (comp->is_wait()) {
         wait *w = static_cast<wait *>(comp);
         // Determine the appropriate number of function args and set ones that we can already know
         w->rhs_argument_idx = 0;
         w->library_call_args.resize(1);
         w->library_call_name = "tiramisu_MPI_Wait";
+    } else if (comp->is_collective()) {
+        collective *c = static_cast<collective *>(comp);
+        tiramisu::expr num_elements(c->get_num_elements());
+        tiramisu::expr arg = c->get_collective_arg();
+        // tiramisu_MPI_<collective>_<type>(count, [root or reduction operator,] data, store_in)
+        int first_buffer_idx = arg.is_defined() ? 2 : 1;
+        c->rhs_argument_idx = first_buffer_idx;
+        c->lhs_argument_idx = first_buffer_idx + 1;
+        c->library_call_args.resize(first_buffer_idx + 2);
+        c->library_call_args[0] = tiramisu::expr(tiramisu::o_cast, p_int32, num_elements);
+        if (arg.is_defined()) {
+            c->library_call_args[1] = tiramisu::expr(tiramisu::o_cast, p_int32, arg);
+        }
+        c->lhs_access_type = tiramisu::o_address_of;
+    }
+}
+
+tiramisu::expr tiramisu::function::lift_mpi_tag(tiramisu::communicator *comm, tiramisu::expr msg_tag) {
+    tiramisu::expr tag(tiramisu::o_cast, p_int32, msg_tag);
+    if (comm->get_channel().is_defined()) {
+        // The runtime decodes the channel from the high bits of the tag (see TIRAMISU_MPI_CHANNEL_SHIFT).
+        tag = tag + tiramisu::expr(tiramisu::o_cast, p_int32, comm->get_channel()) * tiramisu::expr(1 << 15);
+    }
+    return tag;
+}
+
+void tiramisu::function::lift_mpi_strided_layout(tiramisu::communicator *comm) {
+    // tiramisu_MPI_Send_f32 -> tiramisu_MPI_Send_vector_f32
+    comm->library_call_name.insert(comm->library_call_name.rfind('_'), "_vector");
+    int nargs = comm->library_call_args.size();
+    comm->library_call_args[nargs - 2] = tiramisu::expr(tiramisu::o_cast, p_int32, comm->get_block_length());
+    comm->library_call_args[nargs - 1] = tiramisu::expr(tiramisu::o_cast, p_int32, comm->get_stride());
+}
+
+void function::gen_ordering_schedules()
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    if (this->use_low_level_scheduling_commands)
+    {
+        DEBUG(3, tiramisu::str_dump("Low level scheduling commands were used."));
+        DEBUG(3, tiramisu::str_dump("Discarding high level scheduling commands."));
+        return;
+    }
+
+    this->dump_sched_graph();
+
+    if(this->is_sched_graph_tree())
+    {
+        DEBUG(3, tiramisu::str_dump("this->is_sched_graph_tree(): true."));
+
+        // The orderings are computed in one pass over the static dimensions
+        // of the schedules, which are only read once and written back once:
+        // the schedules are aligned first, and ordering a computation after
+        // another one does not change the dimensionality of the schedules.
+        this->align_schedules();
+
+        std::vector<std::tuple<computation *, computation *, int>> orderings;
+
+        std::priority_queue<int> level_to_check;
+        std::unordered_map<int, std::deque<computation *>> level_queue;
+
+        auto current_comp = *(this->starting_computations.begin());
+
+        auto init_sched = automatically_allocated;
+        init_sched.push_back(current_comp);
+
+        for (auto it = init_sched.begin(); it != init_sched.end() && it + 1 != init_sched.end(); it++)
+            orderings.push_back(std::make_tuple(*(it+1), *it, computation::root_dimension));
+
+        bool comps_remain = true;
+        while(comps_remain)
+        {
+            for (auto &edge: this->sched_graph[current_comp])
+            {
+                if (level_queue[edge.second].size() == 0)
+                    level_to_check.push(edge.second);
+
+                level_queue[edge.second].push_back(edge.first);
+            }
+
+            comps_remain = level_to_check.size() > 0;
+            // If we haven't exhausted all computations
+            if (comps_remain)
+            {
+                int fuse_level = level_to_check.top();
+                auto next_comp = level_queue[fuse_level].front();
+                level_queue[fuse_level].pop_front();
+
+                orderings.push_back(std::make_tuple(next_comp, current_comp, fuse_level));
+
+                current_comp = next_comp;
+                if (level_queue[fuse_level].size() == 0)
+                    level_to_check.pop();
+            }
+        }
+
+        // The static dimensions of each computation, and the ones that changed
+        std::unordered_map<computation *, std::vector<int>> static_dims;
+        std::unordered_map<computation *, std::set<int>> changed_dims;
+        std::vector<computation *> changed;
+
+        auto get_static_dims = [&](computation *comp) -> std::vector<int> & {
+            auto it = static_dims.find(comp);
+            if (it == static_dims.end())
+            {
+                isl_map *sched = comp->get_schedule();
+                std::vector<int> dims(isl_map_dim(sched, isl_dim_out), 0);
+                for (int i = 1; i < dims.size(); i = i + 2)
+                    dims[i] = isl_map_get_static_dim(sched, i);
+                it = static_dims.insert({comp, dims}).first;
+            }
+            return it->second;
+        };
+
+        for (const auto &ordering : orderings)
+        {
+            computation *comp = std::get<0>(ordering);
+            computation *pred = std::get<1>(ordering);
+            int dim = loop_level_into_static_dimension(std::get<2>(ordering));
+
+            DEBUG(3, tiramisu::str_dump("Ordering " + comp->get_name() + " after " + pred->get_name() +
+                                        " at dimension " + std::to_string(dim)));
+
+            std::vector<int> &pred_dims = get_static_dims(pred);
+            std::vector<int> &dims = get_static_dims(comp);
+            assert(dim < (signed int) dims.size());
+            assert(dim >= computation::root_dimension);
+
+            if (changed_dims.find(comp) == changed_dims.end())
+                changed.push_back(comp);
+
+            for (int i = 1; i <= dim; i = i + 2)
+            {
+                dims[i] = (i < dim) ? pred_dims[i] : pred_dims[i] + 10;
+                changed_dims[comp].insert(i);
+            }
+        }
+
+        for (computation *comp : changed)
+        {
+            isl_map *sched = isl_map_copy(comp->get_schedule());
+            for (int i : changed_dims[comp])
+                sched = add_eq_to_schedule_map(i, 0, -1, static_dims[comp][i], sched);
+            comp->set_schedule(sched);
+
+            DEBUG(3, tiramisu::str_dump("Schedule adjusted: ", isl_map_to_str(comp->get_schedule())));
+        }
+    }
+    else
+    {
+        DEBUG(3, tiramisu::str_dump("this->is_sched_graph_tree(): false."));
+    }
+
+    DEBUG_INDENT(-4);
+}
+
+void function::gen_time_space_domain()
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    // Generate the ordering based on calls to .after() and .before().
+    tiramisu_timer timer;
+    unsigned long isl_operations;
+    this->start_compile_phase(timer, isl_operations);
+    this->gen_ordering_schedules();
+    this->report_compile_time("gen_ordering_schedules", timer, isl_operations);
+
+    this->align_schedules();
+
+    for (auto &comp : this->get_computations())
+    {
+        comp->gen_time_space_domain();
+    }
+
+    DEBUG_INDENT(-4);
+}
+
+std::string function::get_schedules_signature() const
+{
+    std::string signature;
+
+    isl_union_set *domain = this->get_trimmed_time_processor_domain();
+    char *domain_str = isl_union_set_to_str(domain);
+    signature += std::string(domain_str) + "\n";
+    free(domain_str);
+    isl_union_set_free(domain);
+
+    isl_union_map *schedules = this->get_aligned_identity_schedules();
+    char *schedules_str = isl_union_map_to_str(schedules);
+    signature += std::string(schedules_str) + "\n";
+    free(schedules_str);
+    isl_union_map_free(schedules);
+
+    for (auto const &dim : this->parallel_dimensions)
+        signature += "P " + dim.first + " " + std::to_string(dim.second) + "\n";
+
+    for (auto const &dim : this->reduction_dimensions)
+        signature += "R " + std::get<0>(dim) + " " + std::to_string(std::get<1>(dim)) + " " +
+                     std::to_string(std::get<2>(dim)) + " " + std::to_string(std::get<3>(dim)) + "\n";
+
+    for (auto const &dim : this->scan_dimensions)
+        signature += "N " + std::get<0>(dim) + " " + std::to_string(std::get<1>(dim)) + " " + std::to_string(std::get<2>(dim)) + "\n";
+
+    for (auto const &dim : this->doacross_dimensions)
+        signature += "D " + std::get<0>(dim) + " " + std::to_string(std::get<1>(dim)) + " " + std::to_string(std::get<2>(dim)) + "\n";
+
+    for (auto const &dim : this->pipeline_dimensions)
+        signature += "S " + std::get<0>(dim) + " " + std::to_string(std::get<1>(dim)) + " " + std::to_string(std::get<2>(dim)) + "\n";
+
+    for (auto const &dim : this->parametric_split_dimensions)
+    {
+        signature += "T " + std::get<0>(dim) + " " + std::to_string(std::get<1>(dim));
+        for (auto const &size : std::get<2>(dim))
+            signature += " " + size.to_str();
+        signature += "\n";
     }
+
+    for (auto const &dim : this->prefetch_dimensions)
+        signature += "F " + std::get<0>(dim) + " " + std::get<1>(dim) + " " + std::to_string(std::get<2>(dim)) + " " + std::to_string(std::get<3>(dim)) + "\n";
+
+    for (auto const &dim : this->vector_dimensions)
+        signature += "V " + std::get<0>(dim) + " " + std::to_string(std::get<1>(dim)) + " " + std::to_string(std::get<2>(dim)) + "\n";
+
+    for (auto const &dim : this->predicated_vector_dimensions)
+        signature += "W " + dim.first + " " + std::to_string(dim.second) + "\n";
+
+    for (auto const &dim : this->unroll_dimensions)
+        signature += "U " + std::get<0>(dim) + " " + std::to_string(std::get<1>(dim)) + " " + std::to_string(std::get<2>(dim)) + "\n";
+
+    for (auto const &dim : this->distributed_dimensions)
+        signature += "D " + dim.first + " " + std::to_string(dim.second) + "\n";
+
+    for (auto const &dim : this->gpu_device_dimensions)
+        signature += "M " + dim.first + " " + std::to_string(dim.second) + "\n";
+
+    for (auto const &dims : {&this->gpu_block_dimensions, &this->gpu_thread_dimensions})
+        for (auto const &dim : *dims)
+            signature += "G " + dim.first + " " + std::to_string(std::get<0>(dim.second)) + " " +
+                         std::to_string(std::get<1>(dim.second)) + " " + std::to_string(std::get<2>(dim.second)) + "\n";
+
+    for (auto const &dim : this->gpu_persistent_dimensions)
+        signature += "K " + dim.first + " " + std::to_string(dim.second) + "\n";
+
+    for (auto const &option : this->ast_options)
+        signature += "A " + std::get<0>(option) + " " + std::to_string(std::get<1>(option)) + " " + std::to_string(std::get<2>(option)) + "\n";
+
+    signature += "B " + std::to_string(this->ast_atomic_upper_bound) + " " + std::to_string(this->ast_detect_min_max) + " " +
+                 std::to_string(this->ast_allow_else) + " " + std::to_string(this->separate_full_tiles) + "\n";
+
+    for (auto const &dim : this->gpu_tensor_core_dimensions)
+        signature += "C " + dim.first + " " + std::to_string(std::get<0>(dim.second)) + " " +
+                     std::to_string(std::get<1>(dim.second)) + " " + std::to_string(std::get<2>(dim.second)) + "\n";
+
+    return signature;
 }
 
-void function::gen_ordering_schedules()
+void function::save_schedule_file(const std::string &filename)
 {
     DEBUG_FCT_NAME(3);
     DEBUG_INDENT(4);
 
-    if (this->use_low_level_scheduling_commands)
+    // The file holds the schedules with their ordering, it does not depend on the scheduling graph.
+    this->gen_ordering_schedules();
+    this->align_schedules();
+
+    std::ofstream file(filename);
+    if (!file)
+        ERROR("Cannot write the schedule file " + filename + ".", true);
+
+    file << "tiramisu_schedule 1\n";
+    file << "# function " << this->get_name() << "\n";
+
+    std::unordered_map<std::string, int> ranks;
+    for (computation *comp : this->body)
     {
-        DEBUG(3, tiramisu::str_dump("Low level scheduling commands were used."));
-        DEBUG(3, tiramisu::str_dump("Discarding high level scheduling commands."));
-        return;
+        char *map_str = isl_map_to_str(comp->get_schedule());
+        file << "schedule " << comp->get_name() << " " << ranks[comp->get_name()]++ << " " << map_str << "\n";
+        free(map_str);
     }
 
-    this->dump_sched_graph();
+    for (auto const &dim : this->parallel_dimensions)
+        file << "parallel " << dim.first << " " << dim.second << "\n";
 
-    if(this->is_sched_graph_tree())
+    for (auto const &dim : this->doacross_dimensions)
+        file << "doacross " << std::get<0>(dim) << " " << std::get<1>(dim) << " " << std::get<2>(dim) << "\n";
+
+    for (auto const &dim : this->pipeline_dimensions)
+        file << "pipeline " << std::get<0>(dim) << " " << std::get<1>(dim) << " " << std::get<2>(dim) << "\n";
+
+    // The runtime sizes are saved by name, or by value when they are constant
+    for (auto const &dim : this->parametric_split_dimensions)
     {
-        DEBUG(3, tiramisu::str_dump("this->is_sched_graph_tree(): true."));
+        file << "parametric_split " << std::get<0>(dim) << " " << std::get<1>(dim);
+        for (auto const &size : std::get<2>(dim))
+        {
+            if (size.get_expr_type() == tiramisu::e_var)
+                file << " " << size.get_name();
+            else if (size.get_expr_type() == tiramisu::e_val)
+                file << " " << size.get_int_val();
+            else
+                ERROR("The size " + size.to_str() + " of the parametric split of " + std::get<0>(dim) +
+                      " cannot be saved in a schedule file, use a constant instead.", true);
+        }
+        file << "\n";
+    }
 
-        std::priority_queue<int> level_to_check;
-        std::unordered_map<int, std::deque<computation *>> level_queue;
+    for (auto const &dim : this->prefetch_dimensions)
+        file << "prefetch " << std::get<0>(dim) << " " << std::get<1>(dim) << " " << std::get<2>(dim) << " "
+             << std::get<3>(dim) << "\n";
 
-        auto current_comp = *(this->starting_computations.begin());
+    for (auto const &dim : this->vector_dimensions)
+        file << "vector " << std::get<0>(dim) << " " << std::get<1>(dim) << " " << std::get<2>(dim) << "\n";
 
-        auto init_sched = automatically_allocated;
-        init_sched.push_back(current_comp);
+    for (auto const &dim : this->predicated_vector_dimensions)
+        file << "predicated_vector " << dim.first << " " << dim.second << "\n";
 
-        for (auto it = init_sched.begin(); it != init_sched.end() && it + 1 != init_sched.end(); it++)
-            (*(it+1))->after_low_level(**it, computation::root_dimension);
+    for (auto const &dim : this->unroll_dimensions)
+        file << "unroll " << std::get<0>(dim) << " " << std::get<1>(dim) << " " << std::get<2>(dim) << "\n";
 
-        bool comps_remain = true;
-        while(comps_remain)
-        {
-            for (auto &edge: this->sched_graph[current_comp])
-            {
-                if (level_queue[edge.second].size() == 0)
-                    level_to_check.push(edge.second);
+    for (auto const &dim : this->distributed_dimensions)
+        file << "distributed " << dim.first << " " << dim.second << "\n";
 
-                level_queue[edge.second].push_back(edge.first);
-            }
+    for (auto const &dim : this->gpu_device_dimensions)
+        file << "gpu_device " << dim.first << " " << dim.second << "\n";
 
-            comps_remain = level_to_check.size() > 0;
-            // If we haven't exhausted all computations
-            if (comps_remain)
-            {
-                int fuse_level = level_to_check.top();
-                auto next_comp = level_queue[fuse_level].front();
-                level_queue[fuse_level].pop_front();
+    for (auto const &dim : this->gpu_persistent_dimensions)
+        file << "gpu_persistent " << dim.first << " " << dim.second << "\n";
 
-                // assert(this->get_max_iteration_domains_dim() > fuse_level);
+    for (auto const &dim : this->gpu_block_dimensions)
+        file << "gpu_block " << dim.first << " " << std::get<0>(dim.second) << " " << std::get<1>(dim.second) << " "
+             << std::get<2>(dim.second) << "\n";
 
-                next_comp->after_low_level((*current_comp), fuse_level);
+    for (auto const &dim : this->gpu_thread_dimensions)
+        file << "gpu_thread " << dim.first << " " << std::get<0>(dim.second) << " " << std::get<1>(dim.second) << " "
+             << std::get<2>(dim.second) << "\n";
 
-                current_comp = next_comp;
-                if (level_queue[fuse_level].size() == 0)
-                    level_to_check.pop();
-            }
-        }
-    }
-    else
-    {
-        DEBUG(3, tiramisu::str_dump("this->is_sched_graph_tree(): false."));
-    }
+    DEBUG(3, tiramisu::str_dump("Schedule saved in " + filename));
 
     DEBUG_INDENT(-4);
 }
 
-void function::gen_time_space_domain()
+void function::apply_schedule_file(const std::string &filename)
 {
     DEBUG_FCT_NAME(3);
     DEBUG_INDENT(4);
 
-    // Generate the ordering based on calls to .after() and .before().
-    this->gen_ordering_schedules();
+    std::ifstream file(filename);
+    std::string line;
 
-    this->align_schedules();
+    if (!file || !std::getline(file, line) || line != "tiramisu_schedule 1")
+        ERROR("The file " + filename + " is not a schedule file.", true);
 
-    for (auto &comp : this->get_computations())
+    this->remove_dimension_tags();
+
+    int line_number = 1;
+    while (std::getline(file, line))
     {
-        comp->gen_time_space_domain();
+        line_number++;
+        std::istringstream fields(line);
+        std::string keyword, name;
+
+        if (!(fields >> keyword) || keyword[0] == '#')
+            continue;
+
+        bool valid = (bool)(fields >> name);
+
+        if (keyword == "schedule")
+        {
+            int rank = -1;
+            std::string map_str;
+            valid = valid && (fields >> rank) && std::getline(fields, map_str);
+
+            std::vector<computation *> comps = valid ? this->get_computation_by_name(name) : std::vector<computation *>();
+            if (rank < 0 || rank >= (int)comps.size())
+                ERROR("The computation " + name + " of the schedule file " + filename + " does not exist.", true);
+
+            isl_map *map = isl_map_read_from_str(this->get_isl_ctx(), map_str.c_str());
+            if (map == NULL || isl_map_dim(map, isl_dim_in) != isl_set_dim(comps[rank]->get_iteration_domain(), isl_dim_set))
+                ERROR("Invalid schedule for the computation " + name + " in " + filename + ".", true);
+
+            isl_map_free(comps[rank]->get_schedule());
+            comps[rank]->set_schedule(map);
+        }
+        else if (keyword == "parallel" || keyword == "distributed" || keyword == "gpu_device" || keyword == "gpu_persistent" ||
+                 keyword == "predicated_vector")
+        {
+            int level;
+            valid = valid && (fields >> level);
+            if (!valid)
+                break;
+
+            if (keyword == "parallel")
+                this->parallel_dimensions.push_back({name, level});
+            else if (keyword == "predicated_vector")
+                this->predicated_vector_dimensions.push_back({name, level});
+            else if (keyword == "distributed")
+            {
+                this->distributed_dimensions.push_back({name, level});
+                this->_needs_rank_call = true;
+            }
+            else if (keyword == "gpu_device")
+                this->gpu_device_dimensions.push_back({name, level});
+            else
+                this->gpu_persistent_dimensions.push_back({name, level});
+        }
+        else if (keyword == "doacross" || keyword == "pipeline" || keyword == "vector" || keyword == "unroll")
+        {
+            int level, value;
+            valid = valid && (fields >> level >> value);
+            if (!valid)
+                break;
+
+            if (keyword == "doacross")
+                this->doacross_dimensions.push_back(std::make_tuple(name, level, value));
+            else if (keyword == "pipeline")
+                this->pipeline_dimensions.push_back(std::make_tuple(name, level, value));
+            else if (keyword == "vector")
+                this->vector_dimensions.push_back(std::make_tuple(name, level, value));
+            else
+                this->unroll_dimensions.push_back(std::make_tuple(name, level, value));
+        }
+        else if (keyword == "parametric_split")
+        {
+            int level;
+            std::vector<tiramisu::expr> sizes;
+            std::string size;
+            valid = valid && (bool)(fields >> level);
+            while (valid && (fields >> size))
+            {
+                if (std::isdigit(size[0]) || size[0] == '-')
+                    sizes.push_back(tiramisu::expr((int32_t) std::stoi(size)));
+                else
+                    sizes.push_back(tiramisu::var(global::get_loop_iterator_data_type(), size));
+            }
+            valid = valid && (sizes.size() == 1 || sizes.size() == 2);
+            if (!valid)
+                break;
+
+            this->parametric_split_dimensions.push_back(std::make_tuple(name, level, sizes));
+        }
+        else if (keyword == "prefetch")
+        {
+            std::string buffer_name;
+            int level, distance;
+            valid = valid && (fields >> buffer_name >> level >> distance);
+            if (!valid)
+                break;
+
+            this->prefetch_dimensions.push_back(std::make_tuple(name, buffer_name, level, distance));
+        }
+        else if (keyword == "gpu_block" || keyword == "gpu_thread")
+        {
+            int l0, l1, l2;
+            valid = valid && (fields >> l0 >> l1 >> l2);
+            if (!valid)
+                break;
+
+            if (keyword == "gpu_block")
+                this->gpu_block_dimensions.push_back({name, std::make_tuple(l0, l1, l2)});
+            else
+                this->gpu_thread_dimensions.push_back({name, std::make_tuple(l0, l1, l2)});
+        }
+        else
+        {
+            DEBUG(3, tiramisu::str_dump("Ignoring the line " + std::to_string(line_number) + " of " + filename));
+            valid = true;
+        }
+
+        if (!valid)
+            break;
     }
 
+    if (!file.eof())
+        ERROR("Invalid line " + std::to_string(line_number) + " in the schedule file " + filename + ".", true);
+
+    // The loaded schedules already hold the ordering of the computations
+    this->use_low_level_scheduling_commands = true;
+
     DEBUG_INDENT(-4);
 }
 
@@ -2466,6 +5292,46 @@ void tiramisu::function::gen_flexnlp_autocopy(){
   }
 }
 
+void tiramisu::function::enable_flexnlp_async_runtime(bool enable)
+{
+    this->use_flexnlp_async_runtime = enable;
+}
+
+void tiramisu::function::gen_flexnlp_async_calls()
+{
+    // The wrappers that have an asynchronous version in the runtime
+    static const std::set<std::string> wrappers = {
+        "initialize", "finalize", "load_weights", "load_input", "store_output",
+        "run_lstm", "run_lstm_manual", "run_partitioned_lstm", "run_partitioned_lstm_multi"};
+    const std::string prefix = "tiramisu_flexnlp_";
+    const std::string async_prefix = "tiramisu_flexnlp_async_";
+
+    std::function<expr(const expr &)> rename = [&](const expr &e) {
+        expr result = e.apply_to_operands(rename);
+        if (result.get_expr_type() == e_op && result.get_op_type() == o_call)
+        {
+            std::string name = result.get_name();
+            if (name.compare(0, async_prefix.size(), async_prefix) == 0)
+            {
+                if (!this->use_flexnlp_async_runtime)
+                    ERROR("The call " + name + " needs the asynchronous FlexNLP runtime "
+                          "(see function::enable_flexnlp_async_runtime()).", true);
+            }
+            else if (this->use_flexnlp_async_runtime && name.compare(0, prefix.size(), prefix) == 0 &&
+                     wrappers.count(name.substr(prefix.size())) > 0)
+            {
+                name = async_prefix + name.substr(prefix.size());
+                result.set_name(name);
+            }
+        }
+        return result;
+    };
+
+    for (auto comp : this->get_computations())
+        if (comp->get_expr().is_defined())
+            comp->expression = rename(comp->get_expr());
+}
+
 void tiramisu::function::gen_halide_bug_workaround_computations(){
     // PART I : Go through input buffers (arguments) and make a computation that adds each buffer's first element
     // PART II : Go through output buffers (arguments) and rewrite the first element at its place (dummy access to avoid Halide discarding the buffer)
@@ -2537,68 +5403,342 @@ void tiramisu::function::gen_halide_bug_workaround_computations(){
     first_cpt = comp;
 }
 
-void tiramisu::function::codegen(const std::vector<tiramisu::buffer *> &arguments, const std::string obj_filename, const bool gen_cuda_stmt, bool gen_python)
+void tiramisu::function::codegen(const std::vector<tiramisu::buffer *> &arguments, const std::string obj_filename, const bool gen_cuda_stmt, bool gen_python)
+{
+    if (gen_cuda_stmt)
+    {
+        if (this->gpu_constant_memory_bytes >= 0)
+            this->place_gpu_buffers(this->gpu_constant_memory_bytes);
+        if(!this->mapping.empty())
+        {
+            tiramisu::computation* c1 = this->get_first_cpt();
+            tiramisu::computation* c2 = this->get_last_cpt();
+            Automatic_communication(c1,c2);
+        }
+        else
+            DEBUG(3, tiramisu::str_dump("You must specify the corresponding CPU buffer to each GPU buffer else you should do the communication manually"));
+    }
+    this->set_arguments(arguments);
+    tiramisu_timer timer, phase_timer;
+    unsigned long isl_operations, phase_isl_operations;
+    this->start_compile_phase(timer, isl_operations);
+    this->start_compile_phase(phase_timer, phase_isl_operations);
+    this->lower_boundary_conditions();
+    this->lift_dist_comps();
+    this->gen_time_space_domain();
+    this->report_compile_time("gen_time_space_domain", phase_timer, phase_isl_operations);
+    this->gen_isl_ast();
+    this->report_compile_time("gen_isl_ast", phase_timer, phase_isl_operations);
+    if (gen_cuda_stmt) {
+        this->gen_cuda_stmt();
+        this->report_compile_time("gen_cuda_stmt", phase_timer, phase_isl_operations);
+    }
+    this->gen_halide_stmt();
+    this->report_compile_time("gen_halide_stmt", phase_timer, phase_isl_operations);
+    this->gen_halide_obj(obj_filename, gen_python = gen_python);
+    this->report_compile_time("codegen", timer, isl_operations);
+}
+
+/*
+  General codegen function for more than 2 possible architectures,
+  functions specific to architectures are called conditionally on
+  the gen_architecture_flag parameter's value.
+*/
+// TODO:FLEXNLP Fix the bug and delete workaround code ()
+#define USE_HALIDE_BUFFERS_BUG_WORKAROUND true
+void tiramisu::function::codegen(const std::vector<tiramisu::buffer *> &arguments, const std::string obj_filename, const tiramisu::hardware_architecture_t gen_architecture_flag, bool gen_python)
+{
+    this->set_arguments(arguments);
+    if (gen_architecture_flag == tiramisu::hardware_architecture_t::arch_nvidia_gpu ||
+        gen_architecture_flag == tiramisu::hardware_architecture_t::arch_opencl_gpu ||
+        gen_architecture_flag == tiramisu::hardware_architecture_t::arch_flexnlp)
+    {
+        if (this->gpu_constant_memory_bytes >= 0)
+            this->place_gpu_buffers(this->gpu_constant_memory_bytes);
+        if(!this->mapping.empty())
+        {
+            tiramisu::computation* c1 = this->get_first_cpt();
+            tiramisu::computation* c2 = this->get_last_cpt();
+            Automatic_communication(c1,c2);
+        }
+        else
+            DEBUG(3, tiramisu::str_dump("You must specify the corresponding CPU buffer to each GPU buffer else you should do the communication manually"));
+    }
+
+    // TODO:OMIT
+    if (false && gen_architecture_flag == tiramisu::hardware_architecture_t::arch_flexnlp)
+        this->gen_flexnlp_autocopy();
+
+    if (gen_architecture_flag == tiramisu::hardware_architecture_t::arch_flexnlp)
+        this->gen_flexnlp_async_calls();
+
+    if (USE_HALIDE_BUFFERS_BUG_WORKAROUND)
+        this->gen_halide_bug_workaround_computations();
+
+    tiramisu_timer timer, phase_timer;
+    unsigned long isl_operations, phase_isl_operations;
+    this->start_compile_phase(timer, isl_operations);
+    this->start_compile_phase(phase_timer, phase_isl_operations);
+    this->lower_boundary_conditions();
+    this->lift_dist_comps();
+    this->gen_time_space_domain();
+    this->report_compile_time("gen_time_space_domain", phase_timer, phase_isl_operations);
+    this->gen_isl_ast();
+    this->report_compile_time("gen_isl_ast", phase_timer, phase_isl_operations);
+    if (gen_architecture_flag == tiramisu::hardware_architecture_t::arch_nvidia_gpu){
+        this->gen_cuda_stmt();
+        this->report_compile_time("gen_cuda_stmt", phase_timer, phase_isl_operations);
+    }
+    else if (gen_architecture_flag == tiramisu::hardware_architecture_t::arch_opencl_gpu) {
+        this->gen_opencl_stmt();
+        this->report_compile_time("gen_opencl_stmt", phase_timer, phase_isl_operations);
+    }
+    this->gen_halide_stmt();
+    this->report_compile_time("gen_halide_stmt", phase_timer, phase_isl_operations);
+    this->gen_halide_obj(obj_filename, gen_architecture_flag, gen_python = false);
+    this->report_compile_time("codegen", timer, isl_operations);
+}
+
+void tiramisu::function::codegen_c(const std::vector<tiramisu::buffer *> &arguments, const std::string &c_filename)
+{
+    this->set_arguments(arguments);
+    tiramisu_timer timer, phase_timer;
+    unsigned long isl_operations, phase_isl_operations;
+    this->start_compile_phase(timer, isl_operations);
+    this->start_compile_phase(phase_timer, phase_isl_operations);
+    this->lower_boundary_conditions();
+    this->lift_dist_comps();
+    this->gen_time_space_domain();
+    this->report_compile_time("gen_time_space_domain", phase_timer, phase_isl_operations);
+    this->gen_isl_ast();
+    this->report_compile_time("gen_isl_ast", phase_timer, phase_isl_operations);
+    this->gen_c_source(c_filename);
+    this->report_compile_time("codegen_c", timer, isl_operations);
+}
+
+std::vector<tiramisu::computation *> tiramisu::function::get_constant_computations()
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    // The buffer written by each computation and the buffers it reads.
+    std::map<tiramisu::computation *, std::string> written;
+    std::map<tiramisu::computation *, std::set<std::string>> read;
+    for (auto &comp : this->get_computations())
+    {
+        if (!comp->should_schedule_this_computation() || comp->is_inline_computation() ||
+            comp->is_let_stmt() || !comp->get_expr().is_defined() || comp->get_access_relation() == NULL)
+            continue;
+
+        written[comp] = isl_map_get_tuple_name(comp->get_access_relation(), isl_dim_out);
+
+        std::vector<isl_map *> accesses;
+        generator::get_rhs_accesses(this, comp, accesses, true);
+        for (isl_map *access : accesses)
+        {
+            // An access that cannot be resolved to a buffer is not constant
+            read[comp].insert((isl_map_has_tuple_name(access, isl_dim_out) == isl_bool_true) ?
+                              isl_map_get_tuple_name(access, isl_dim_out) : "");
+            isl_map_free(access);
+        }
+    }
+
+    // Start from all the temporary buffers written by computations, and
+    // remove those that are written by a computation or read a buffer that
+    // is not constant, until nothing changes.
+    std::set<std::string> precomputed;
+    for (auto &w : written)
+    {
+        auto buf = this->get_buffers().find(w.second);
+        if (buf != this->get_buffers().end() && buf->second->get_argument_type() == a_temporary)
+            precomputed.insert(w.second);
+    }
+    for (auto &comp : this->get_computations())
+        if (comp->get_access_relation() != NULL && written.count(comp) == 0)
+            precomputed.erase(isl_map_get_tuple_name(comp->get_access_relation(), isl_dim_out));
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto &w : written)
+        {
+            if (precomputed.count(w.second) == 0)
+                continue;
+
+            for (const std::string &name : read[w.first])
+            {
+                auto buf = this->get_buffers().find(name);
+                bool is_constant = (buf != this->get_buffers().end()) &&
+                                   (buf->second->is_constant() || precomputed.count(name) != 0);
+                if (!is_constant)
+                {
+                    precomputed.erase(w.second);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    std::vector<tiramisu::computation *> result;
+    for (auto &comp : this->get_computations())
+        if (written.count(comp) != 0 && precomputed.count(written[comp]) != 0)
+        {
+            DEBUG(3, tiramisu::str_dump("Constant computation: " + comp->get_name()));
+            result.push_back(comp);
+        }
+
+    DEBUG_INDENT(-4);
+
+    return result;
+}
+
+std::vector<tiramisu::buffer *> tiramisu::function::codegen_with_init(const std::vector<tiramisu::buffer *> &arguments,
+                                                                      const std::string &obj_filename,
+                                                                      const std::string &init_obj_filename)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    std::vector<tiramisu::computation *> constant_computations = this->get_constant_computations();
+    std::unordered_set<tiramisu::computation *> is_constant(constant_computations.begin(),
+                                                            constant_computations.end());
+
+    std::vector<tiramisu::computation *> scheduled;
+    std::set<std::string> read_by_function;
+    for (auto &comp : this->get_computations())
+        if (comp->should_schedule_this_computation())
+        {
+            scheduled.push_back(comp);
+            if (is_constant.count(comp) != 0 || comp->is_let_stmt() || !comp->get_expr().is_defined())
+                continue;
+
+            std::vector<isl_map *> accesses;
+            generator::get_rhs_accesses(this, comp, accesses, true);
+            for (isl_map *access : accesses)
+            {
+                if (isl_map_has_tuple_name(access, isl_dim_out) == isl_bool_true)
+                    read_by_function.insert(isl_map_get_tuple_name(access, isl_dim_out));
+                isl_map_free(access);
+            }
+        }
+
+    // The buffers passed from the initialization function to the function;
+    // the other buffers of the constant computations stay temporaries of
+    // the initialization function.
+    std::vector<tiramisu::buffer *> precomputed;
+    for (auto &comp : constant_computations)
+    {
+        std::string buffer_name = isl_map_get_tuple_name(comp->get_access_relation(), isl_dim_out);
+        tiramisu::buffer *buf = this->get_buffers().at(buffer_name);
+        if (read_by_function.count(buffer_name) != 0 &&
+            std::find(precomputed.begin(), precomputed.end(), buf) == precomputed.end())
+            precomputed.push_back(buf);
+    }
+
+    // The initialization function: only the constant computations, that
+    // write the precomputed buffers.
+    std::vector<tiramisu::buffer *> init_arguments;
+    for (auto &buf : arguments)
+        if (buf->is_constant())
+            init_arguments.push_back(buf);
+    init_arguments.insert(init_arguments.end(), precomputed.begin(), precomputed.end());
+
+    for (auto &comp : scheduled)
+        comp->schedule_this_computation = (is_constant.count(comp) != 0);
+    for (auto &buf : precomputed)
+        buf->set_argument_type(a_output);
+
+    std::string name = this->name;
+    this->name = name + "_init";
+    this->codegen(init_arguments, init_obj_filename);
+    this->name = name;
+
+    // The function itself: the other computations, that read them.
+    std::vector<tiramisu::buffer *> main_arguments = arguments;
+    main_arguments.insert(main_arguments.end(), precomputed.begin(), precomputed.end());
+
+    for (auto &comp : scheduled)
+        comp->schedule_this_computation = (is_constant.count(comp) == 0);
+    for (auto &buf : precomputed)
+        buf->set_argument_type(a_input);
+
+    this->codegen(main_arguments, obj_filename);
+
+    for (auto &comp : scheduled)
+        comp->schedule_this_computation = true;
+
+    DEBUG_INDENT(-4);
+
+    return precomputed;
+}
+
+Halide::Internal::JITModule tiramisu::function::jit(const std::vector<tiramisu::buffer *> &arguments)
 {
-    if (gen_cuda_stmt)
-    {
-        if(!this->mapping.empty())
-        {
-            tiramisu::computation* c1 = this->get_first_cpt();
-            tiramisu::computation* c2 = this->get_last_cpt();
-            Automatic_communication(c1,c2);
-        }
-        else
-            DEBUG(3, tiramisu::str_dump("You must specify the corresponding CPU buffer to each GPU buffer else you should do the communication manually"));
-    }
     this->set_arguments(arguments);
+
+    tiramisu_timer timer;
+    unsigned long isl_operations;
+    this->start_compile_phase(timer, isl_operations);
+    this->lower_boundary_conditions();
     this->lift_dist_comps();
     this->gen_time_space_domain();
-    this->gen_isl_ast();
-    if (gen_cuda_stmt) {
-        this->gen_cuda_stmt();
-    }
-    this->gen_halide_stmt();
-    this->gen_halide_obj(obj_filename, gen_python = gen_python);
-}
 
-/*
-  General codegen function for more than 2 possible architectures,
-  functions specific to architectures are called conditionally on
-  the gen_architecture_flag parameter's value.
-*/
-// TODO:FLEXNLP Fix the bug and delete workaround code ()
-#define USE_HALIDE_BUFFERS_BUG_WORKAROUND true
-void tiramisu::function::codegen(const std::vector<tiramisu::buffer *> &arguments, const std::string obj_filename, const tiramisu::hardware_architecture_t gen_architecture_flag, bool gen_python)
-{
-    this->set_arguments(arguments);
-    if (gen_architecture_flag == tiramisu::hardware_architecture_t::arch_nvidia_gpu ||
-        gen_architecture_flag == tiramisu::hardware_architecture_t::arch_flexnlp)
+    std::string key = this->get_schedules_signature();
+    for (const auto &buf : this->function_arguments)
+        key += "|" + buf->get_name();
+
+    // The shapes of the buffers and the options of the code generator
+    // change the generated code without changing the schedules.
+    for (const auto &b : this->get_buffers())
     {
-        if(!this->mapping.empty())
-        {
-            tiramisu::computation* c1 = this->get_first_cpt();
-            tiramisu::computation* c2 = this->get_last_cpt();
-            Automatic_communication(c1,c2);
-        }
-        else
-            DEBUG(3, tiramisu::str_dump("You must specify the corresponding CPU buffer to each GPU buffer else you should do the communication manually"));
+        key += "|" + b.first + " " + std::to_string(b.second->get_elements_type()) + " " +
+               std::to_string(b.second->get_argument_type()) + " " + std::to_string(b.second->get_streaming_stores());
+        for (const auto &size : b.second->get_dim_sizes())
+            key += " " + size.to_str();
     }
 
-    // TODO:OMIT
-    if (false && gen_architecture_flag == tiramisu::hardware_architecture_t::arch_flexnlp)
-        this->gen_flexnlp_autocopy();
+    key += "|" + std::to_string(global::get_loop_iterator_data_type()) + " " +
+           std::to_string(global::is_auto_data_mapping_set()) + " " +
+           std::to_string(global::is_loop_invariant_code_motion_set()) + " " +
+           std::to_string(this->use_buffer_arena) + " " + std::to_string(this->parallel_backend) + " " +
+           std::to_string(this->parallel_chunk_size) + " " + std::to_string(this->gpu_coalescing_remap);
+    for (const auto &feature : this->target_features)
+        key += " " + std::to_string(feature);
 
-    if (USE_HALIDE_BUFFERS_BUG_WORKAROUND)
-        this->gen_halide_bug_workaround_computations();
+    auto it = this->jit_cache.find(key);
+    if (it != this->jit_cache.end())
+        return it->second;
 
-    this->lift_dist_comps();
-    this->gen_time_space_domain();
     this->gen_isl_ast();
-    if (gen_architecture_flag == tiramisu::hardware_architecture_t::arch_nvidia_gpu){
-        this->gen_cuda_stmt();
-    }
     this->gen_halide_stmt();
-    this->gen_halide_obj(obj_filename, gen_architecture_flag, gen_python = false);
+
+    Halide::Target target = Halide::get_jit_target_from_environment().with_feature(Halide::Target::LargeBuffers);
+    for (const auto &feature : this->target_features)
+        target.set_feature(feature);
+
+    std::vector<Halide::Argument> fct_arguments;
+    for (const auto &buf : this->function_arguments)
+        fct_arguments.push_back(Halide::Argument(buf->get_name(),
+                                                 halide_argtype_from_tiramisu_argtype(buf->get_argument_type()),
+                                                 halide_type_from_tiramisu_type(buf->get_elements_type()),
+                                                 buf->get_n_dims(), Halide::ArgumentEstimates{}));
+
+    std::set<std::string> streaming_buffers;
+    for (const auto &b : this->get_buffers())
+        if (b.second->get_streaming_stores())
+            streaming_buffers.insert(b.first);
+
+    Halide::Module m = lower_halide_pipeline(this->get_name(), target, fct_arguments,
+                                             Halide::LinkageType::External,
+                                             this->get_halide_stmt(), streaming_buffers);
+
+    Halide::Internal::JITModule jit_module(m, m.get_function_by_name(this->get_name()));
+    this->jit_cache.emplace(key, jit_module);
+    this->report_compile_time("jit", timer, isl_operations);
+
+    return jit_module;
 }
 
 const std::vector<std::string> tiramisu::function::get_invariant_names() const
@@ -2616,12 +5756,15 @@ void tiramisu::function::perform_full_dependency_analysis()
 {
     DEBUG_FCT_NAME(3);
     DEBUG_INDENT(4);
+    tiramisu_timer timer;
+    unsigned long isl_operations;
+    this->start_compile_phase(timer, isl_operations);
     // align schedules and order schedules
     this->align_schedules();
     this->gen_ordering_schedules();
     // could save default schedules and order here
     this->calculate_dep_flow();
-    
+    this->report_compile_time("dependence analysis", timer, isl_operations);
     DEBUG_INDENT(-4);
 
 }
@@ -3046,6 +6189,72 @@ bool tiramisu::function::loop_vectorization_is_legal(tiramisu::var i , std::vect
     return result;
 }
 
+bool tiramisu::function::loop_distribution_is_legal(int level, std::vector<tiramisu::computation *> first_computations,
+                                                    std::vector<tiramisu::computation *> second_computations)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(level >= 0);
+    assert(this->dep_read_after_write != NULL );
+    assert(this->dep_write_after_write != NULL );
+    assert(this->dep_write_after_read != NULL );
+    assert(first_computations.size() > 0 && second_computations.size() > 0);
+
+    isl_union_map *all_deps = isl_union_map_union(
+        isl_union_map_range_factor_domain(isl_union_map_copy(this->dep_read_after_write)),
+        isl_union_map_range_factor_domain(isl_union_map_copy(this->dep_write_after_read)));
+    all_deps = isl_union_map_union(all_deps,
+        isl_union_map_range_factor_domain(isl_union_map_copy(this->dep_write_after_write)));
+
+    // The schedules of each group, with the same (unnamed) time space
+    isl_union_map *first_schedules = isl_union_map_empty(isl_space_params_alloc(this->get_isl_ctx(), 0));
+    isl_union_map *second_schedules = isl_union_map_empty(isl_space_params_alloc(this->get_isl_ctx(), 0));
+
+    for (auto &computation : first_computations)
+        first_schedules = isl_union_map_union(first_schedules, isl_union_map_from_map(
+            isl_map_set_tuple_name(isl_map_copy(computation->get_schedule()), isl_dim_out, "")));
+
+    for (auto &computation : second_computations)
+        second_schedules = isl_union_map_union(second_schedules, isl_union_map_from_map(
+            isl_map_set_tuple_name(isl_map_copy(computation->get_schedule()), isl_dim_out, "")));
+
+    // Only keep the dependences from the second group to the first one, in the time space
+    all_deps = isl_union_map_apply_domain(all_deps, second_schedules);
+    all_deps = isl_union_map_apply_range(all_deps, first_schedules);
+
+    bool result = true;
+
+    if (!isl_union_map_is_empty(all_deps))
+    {
+        isl_map *deps = isl_map_from_union_map(isl_union_map_copy(all_deps));
+
+        assert(loop_level_into_dynamic_dimension(level - 1) < (int)isl_map_dim(deps, isl_dim_in));
+
+        // Distributing the loop levels from level moves the second group after the first one
+        // in each iteration of the outer loops: a dependence from the second group to the first
+        // one is only kept if it is carried by the outer loops.
+        for (int l = 0; l < level; l++)
+        {
+            int dim = loop_level_into_dynamic_dimension(l);
+            deps = isl_map_equate(deps, isl_dim_in, dim, isl_dim_out, dim);
+        }
+
+        DEBUG(3, tiramisu::str_dump(" dependences not carried by the outer loops : " + std::string(isl_map_to_str(deps))));
+
+        result = isl_map_is_empty(deps);
+        isl_map_free(deps);
+    }
+
+    isl_union_map_free(all_deps);
+
+    DEBUG(3, tiramisu::str_dump(" distribution legality is : " + std::string(result ? "true" : "false")));
+
+    DEBUG_INDENT(-4);
+
+    return result;
+}
+
 void tiramisu::function::reset_all_static_dims_to_zero()
 {   
     DEBUG_FCT_NAME(3);
@@ -3662,6 +6871,402 @@ std::vector<std::tuple<tiramisu::var,int>> function::correcting_loop_fusion_with
 
 }
 
+bool function::compute_fusion_shifts(std::vector<tiramisu::computation *> producers, tiramisu::computation *consumer,
+                                     int level, std::vector<int> &shifts, int first_shifted_level)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    assert(producers.size() > 0);
+    assert(first_shifted_level >= 0 && first_shifted_level <= level);
+
+    std::vector<std::string> loop_names = consumer->get_loop_level_names();
+    assert(level < (int) loop_names.size());
+
+    // Order the consumer after the last producer at level, as gen_ordering_schedules() would
+    isl_map *schedule = consumer->get_schedule();
+    isl_map *producer_schedule = producers.back()->get_schedule();
+    isl_map *ordered = isl_map_copy(schedule);
+
+    int dim = loop_level_into_static_dimension(level);
+    for (int i = 1; i <= dim; i = i + 2)
+    {
+        int value = isl_map_get_static_dim(producer_schedule, i);
+        ordered = add_eq_to_schedule_map(i, 0, -1, (i < dim) ? value : value + 10, ordered);
+    }
+
+    consumer->set_schedule(ordered);
+
+    std::vector<tiramisu::var> shifted_vars;
+    for (int l = first_shifted_level; l <= level; l++)
+        shifted_vars.push_back(tiramisu::var(loop_names[l]));
+
+    std::vector<std::tuple<tiramisu::var, int>> result =
+        this->correcting_loop_fusion_with_shifting(producers, *consumer, shifted_vars);
+
+    consumer->set_schedule(schedule);
+    isl_map_free(ordered);
+
+    shifts.assign(level + 1, 0);
+    for (auto const &shift : result)
+        for (int l = first_shifted_level; l <= level; l++)
+            if (loop_names[l] == std::get<0>(shift).get_name())
+                shifts[l] = std::get<1>(shift);
+
+    DEBUG_INDENT(-4);
+
+    return !result.empty();
+}
+
+/**
+ * Return the number of iterations of the loop levels 0 to \p level that only execute
+ * one of \p producer and \p consumer once the consumer is shifted by \p shifts, or -1
+ * if the bounds of these loop levels are not constant.
+ */
+static double get_fusion_redundant_iterations(tiramisu::computation *producer, tiramisu::computation *consumer,
+                                              int level, const std::vector<int> &shifts)
+{
+    double producer_iterations = 1, consumer_iterations = 1, shared_iterations = 1;
+
+    for (int l = 0; l <= level; l++)
+    {
+        long lower[2], upper[2];
+        tiramisu::computation *comps[2] = {producer, consumer};
+
+        for (int c = 0; c < 2; c++)
+        {
+            isl_set *domain = comps[c]->get_iteration_domain();
+            if (l >= (int) isl_set_dim(domain, isl_dim_set))
+                return -1;
+
+            isl_aff *iterator = isl_aff_var_on_domain(isl_local_space_from_space(isl_set_get_space(domain)),
+                                                      isl_dim_set, l);
+            isl_val *min = isl_set_min_val(domain, iterator);
+            isl_val *max = isl_set_max_val(domain, iterator);
+            isl_aff_free(iterator);
+
+            bool constant = isl_val_is_int(min) && isl_val_is_int(max);
+            if (constant)
+            {
+                lower[c] = isl_val_get_num_si(min);
+                upper[c] = isl_val_get_num_si(max);
+            }
+
+            isl_val_free(min);
+            isl_val_free(max);
+
+            if (!constant)
+                return -1;
+        }
+
+        lower[1] += shifts[l];
+        upper[1] += shifts[l];
+
+        producer_iterations *= upper[0] - lower[0] + 1;
+        consumer_iterations *= upper[1] - lower[1] + 1;
+        shared_iterations *= std::max(0L, std::min(upper[0], upper[1]) - std::max(lower[0], lower[1]) + 1);
+    }
+
+    return producer_iterations + consumer_iterations - 2 * shared_iterations;
+}
+
+tiramisu::fusion_info function::fuse_with_shifting(tiramisu::computation *producer, tiramisu::computation *consumer,
+                                                   int level, bool apply)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    this->perform_full_dependency_analysis();
+    this->prepare_schedules_for_legality_checks(true);
+
+    int previous_level = computation::root_dimension;
+    auto edges = this->sched_graph.find(producer);
+    if (edges != this->sched_graph.end() && edges->second.find(consumer) != edges->second.end())
+        previous_level = edges->second[consumer];
+
+    tiramisu::fusion_info fusion = {producer, consumer, previous_level, previous_level, 0};
+
+    std::vector<int> shifts;
+    if (!this->compute_fusion_shifts({producer}, consumer, level, shifts))
+    {
+        DEBUG(3, tiramisu::str_dump("Cannot fuse " + consumer->get_name() + " with " + producer->get_name() +
+                                    " at level " + std::to_string(level)));
+        DEBUG_INDENT(-4);
+        return fusion;
+    }
+
+    fusion.level = level;
+    if (std::any_of(shifts.begin(), shifts.end(), [](int shift) { return shift != 0; }))
+        fusion.shifts = shifts;
+    fusion.redundant_iterations = get_fusion_redundant_iterations(producer, consumer, level, shifts);
+
+    if (apply)
+    {
+        std::vector<std::string> loop_names = consumer->get_loop_level_names();
+        for (int l = 0; l <= level; l++)
+            if (shifts[l] != 0)
+                consumer->shift(tiramisu::var(loop_names[l]), shifts[l]);
+
+        consumer->after(*producer, level);
+    }
+
+    DEBUG(3, tiramisu::str_dump("Fused " + consumer->get_name() + " with " + producer->get_name() + " at level " +
+                                std::to_string(level) + ", " + std::to_string((long) fusion.redundant_iterations) +
+                                " iterations only execute one of them"));
+
+    DEBUG_INDENT(-4);
+
+    return fusion;
+}
+
+/**
+ * A dimension of the schedule computed by isl on the path from the root of the
+ * schedule tree to a leaf: a member of a band, or the position of a child of a
+ * sequence or set node (member is NULL then).
+ */
+struct polyhedral_schedule_dim
+{
+    isl_union_map *member;
+    int position;
+    bool coincident;
+};
+
+/**
+ * Tile the permutable bands of at least two members by \p user (an int).
+ */
+static isl_schedule_node *tile_polyhedral_band(isl_schedule_node *node, void *user)
+{
+    int tile_size = *(int *) user;
+
+    if (isl_schedule_node_get_type(node) != isl_schedule_node_band ||
+        isl_schedule_node_band_n_member(node) < 2 ||
+        isl_schedule_node_band_get_permutable(node) != isl_bool_true)
+        return node;
+
+    isl_space *space = isl_schedule_node_band_get_space(node);
+    isl_multi_val *sizes = isl_multi_val_zero(space);
+    for (int i = 0; i < (int) isl_schedule_node_band_n_member(node); i++)
+        sizes = isl_multi_val_set_val(sizes, i, isl_val_int_from_si(isl_schedule_node_get_ctx(node), tile_size));
+
+    return isl_schedule_node_band_tile(node, sizes);
+}
+
+/**
+ * Convert the schedule tree below \p node into Tiramisu schedules: the band
+ * members are the dynamic dimensions and the positions in the sequences are
+ * the static dimensions. The outermost coincident member of each statement is
+ * stored in \p parallel_levels.
+ */
+static void collect_polyhedral_schedules(isl_schedule_node *node, std::vector<polyhedral_schedule_dim> &path,
+                                         std::map<std::string, isl_map *> &schedules,
+                                         std::map<std::string, int> &parallel_levels)
+{
+    switch (isl_schedule_node_get_type(node))
+    {
+    case isl_schedule_node_band:
+    {
+        isl_multi_union_pw_aff *partial = isl_schedule_node_band_get_partial_schedule(node);
+        int nb_members = isl_schedule_node_band_n_member(node);
+
+        for (int i = 0; i < nb_members; i++)
+        {
+            isl_union_map *member = isl_union_map_from_union_pw_aff(
+                isl_multi_union_pw_aff_get_union_pw_aff(partial, i));
+            bool coincident = isl_schedule_node_band_member_get_coincident(node, i) == isl_bool_true;
+            path.push_back({member, 0, coincident});
+        }
+        isl_multi_union_pw_aff_free(partial);
+
+        isl_schedule_node *child = isl_schedule_node_get_child(node, 0);
+        collect_polyhedral_schedules(child, path, schedules, parallel_levels);
+        isl_schedule_node_free(child);
+
+        for (int i = 0; i < nb_members; i++)
+        {
+            isl_union_map_free(path.back().member);
+            path.pop_back();
+        }
+        break;
+    }
+
+    case isl_schedule_node_sequence:
+    case isl_schedule_node_set:
+        for (int i = 0; i < isl_schedule_node_n_children(node); i++)
+        {
+            path.push_back({NULL, i, false});
+            isl_schedule_node *child = isl_schedule_node_get_child(node, i);
+            collect_polyhedral_schedules(child, path, schedules, parallel_levels);
+            isl_schedule_node_free(child);
+            path.pop_back();
+        }
+        break;
+
+    case isl_schedule_node_leaf:
+    {
+        isl_union_set *domain = isl_schedule_node_get_domain(node);
+
+        std::vector<isl_set *> statements;
+        isl_union_set_foreach_set(domain, [](isl_set *set, void *user) {
+            ((std::vector<isl_set *> *) user)->push_back(set);
+            return isl_stat_ok;
+        }, &statements);
+        isl_union_set_free(domain);
+
+        for (isl_set *statement : statements)
+        {
+            isl_map *sched = isl_map_from_domain(isl_set_copy(statement));
+            std::vector<int> static_dims = {0};
+            bool static_dim_used = false;
+            int parallel_level = -1;
+
+            for (auto const &dim : path)
+            {
+                int nb_dims = isl_map_dim(sched, isl_dim_out);
+                if (dim.member != NULL)
+                {
+                    isl_map *member = isl_map_from_union_map(isl_union_map_intersect_domain(
+                        isl_union_map_copy(dim.member), isl_union_set_from_set(isl_set_copy(statement))));
+                    sched = isl_map_flat_range_product(sched, member);
+
+                    if (dim.coincident && parallel_level == -1)
+                        parallel_level = nb_dims;
+
+                    static_dims.push_back(0);
+                    static_dim_used = false;
+                }
+                else
+                {
+                    // Two nested sequences are separated by a dynamic dimension equal to 0
+                    if (static_dim_used)
+                    {
+                        sched = isl_map_add_dims(sched, isl_dim_out, 1);
+                        sched = isl_map_fix_si(sched, isl_dim_out, nb_dims, 0);
+                        static_dims.push_back(0);
+                    }
+
+                    static_dims.back() = dim.position;
+                    static_dim_used = true;
+                }
+            }
+
+            for (int i = 0; i < (int) static_dims.size(); i++)
+                sched = isl_map_add_dim_and_eq_constraint(sched, 2 * i, static_dims[i]);
+            sched = isl_map_add_dim_and_eq_constraint(sched, 0, 0);
+
+            std::string name = isl_set_get_tuple_name(statement);
+            schedules[name] = isl_map_coalesce(sched);
+            parallel_levels[name] = parallel_level;
+
+            isl_set_free(statement);
+        }
+        break;
+    }
+
+    default:
+        for (int i = 0; i < isl_schedule_node_n_children(node); i++)
+        {
+            isl_schedule_node *child = isl_schedule_node_get_child(node, i);
+            collect_polyhedral_schedules(child, path, schedules, parallel_levels);
+            isl_schedule_node_free(child);
+        }
+        break;
+    }
+}
+
+bool function::compute_polyhedral_schedule(int tile_size, bool parallelize)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    std::vector<tiramisu::computation *> comps;
+    isl_union_set *domain = isl_union_set_empty(isl_space_params_alloc(this->get_isl_ctx(), 0));
+
+    for (auto &comp : this->get_computations())
+    {
+        if (comp->is_inline_computation() || !comp->get_expr().is_defined())
+            continue;
+
+        // The statements of the schedule tree are identified by their name
+        if (this->get_computation_by_name(comp->get_name()).size() > 1)
+        {
+            DEBUG(3, tiramisu::str_dump("Several computations are named " + comp->get_name() +
+                                        ", no polyhedral schedule is computed."));
+            isl_union_set_free(domain);
+            DEBUG_INDENT(-4);
+            return false;
+        }
+
+        comps.push_back(comp);
+        domain = isl_union_set_union(domain, isl_union_set_from_set(isl_set_copy(comp->get_iteration_domain())));
+    }
+
+    this->perform_full_dependency_analysis();
+
+    isl_union_map *raw = isl_union_map_range_factor_domain(isl_union_map_copy(this->dep_read_after_write));
+    raw = isl_union_map_intersect_domain(raw, isl_union_set_copy(domain));
+    raw = isl_union_map_intersect_range(raw, isl_union_set_copy(domain));
+
+    isl_union_map *validity = isl_union_map_copy(raw);
+    validity = isl_union_map_union(validity,
+        isl_union_map_range_factor_domain(isl_union_map_copy(this->dep_write_after_read)));
+    validity = isl_union_map_union(validity,
+        isl_union_map_range_factor_domain(isl_union_map_copy(this->dep_write_after_write)));
+    validity = isl_union_map_intersect_domain(validity, isl_union_set_copy(domain));
+    validity = isl_union_map_intersect_range(validity, isl_union_set_copy(domain));
+
+    // The dependences must be respected, carried by as few loops as possible
+    // (coincidence), and the producers and consumers kept close (proximity).
+    isl_schedule_constraints *constraints = isl_schedule_constraints_on_domain(domain);
+    constraints = isl_schedule_constraints_set_validity(constraints, isl_union_map_copy(validity));
+    constraints = isl_schedule_constraints_set_coincidence(constraints, validity);
+    constraints = isl_schedule_constraints_set_proximity(constraints, raw);
+
+    isl_schedule *schedule = isl_schedule_constraints_compute_schedule(constraints);
+    if (schedule == NULL)
+    {
+        DEBUG(3, tiramisu::str_dump("isl could not compute a schedule."));
+        DEBUG_INDENT(-4);
+        return false;
+    }
+
+    if (tile_size > 1)
+        schedule = isl_schedule_map_schedule_node_bottom_up(schedule, tile_polyhedral_band, &tile_size);
+
+    DEBUG(3, tiramisu::str_dump("Polyhedral schedule: " + std::string(isl_schedule_to_str(schedule))));
+
+    std::map<std::string, isl_map *> schedules;
+    std::map<std::string, int> parallel_levels;
+    std::vector<polyhedral_schedule_dim> path;
+
+    isl_schedule_node *root = isl_schedule_get_root(schedule);
+    collect_polyhedral_schedules(root, path, schedules, parallel_levels);
+    isl_schedule_node_free(root);
+    isl_schedule_free(schedule);
+
+    for (auto &comp : comps)
+    {
+        auto sched = schedules.find(comp->get_name());
+        if (sched == schedules.end())
+            continue;
+
+        comp->set_schedule(sched->second);
+        comp->name_unnamed_time_space_dimensions();
+
+        if (parallelize && parallel_levels[comp->get_name()] >= 0)
+            comp->tag_parallel_level(parallel_levels[comp->get_name()]);
+
+        DEBUG(3, tiramisu::str_dump("Schedule of " + comp->get_name() + ": ",
+                                    isl_map_to_str(comp->get_schedule())));
+    }
+
+    // The ordering is in the static dimensions of the new schedules
+    this->use_low_level_scheduling_commands = true;
+
+    DEBUG_INDENT(-4);
+
+    return true;
+}
+
 
 std::vector<isl_basic_set*> tiramisu::function::compute_legal_skewing(std::vector<tiramisu::computation *> fused_computations, tiramisu::var outer_variable,
                                               tiramisu::var inner_variable, int&  legal_process)
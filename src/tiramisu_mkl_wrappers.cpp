@@ -25,7 +25,9 @@ uint8_t tiramisu_cblas_sgemm(float *A, float *B, float *C,
         ldC = N;
     }
 
-    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
+    cblas_sgemm(CblasRowMajor,
+                transposeA ? CblasTrans : CblasNoTrans,
+                transposeB ? CblasTrans : CblasNoTrans,
                 M, N, K, alpha, A + offsetA, ldA, B + offsetB, ldB, beta, C + offsetC, ldC);
     return 0;
 }
@@ -53,11 +55,119 @@ uint8_t tiramisu_cblas_dgemm(double *A, double *B, double *C,
         ldC = N;
     }
 
-    cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
+    cblas_dgemm(CblasRowMajor,
+                transposeA ? CblasTrans : CblasNoTrans,
+                transposeB ? CblasTrans : CblasNoTrans,
                 M, N, K, alpha, A + offsetA, ldA, B + offsetB, ldB, beta, C + offsetC, ldC);
     return 0;
 }
 
+/**
+ * This is a reduced interface for the MKL strided batched GEMM API.
+ * It multiplies batch pairs of row-major matrices A and B of size MxK and
+ * KxN; the matrices of a batch start strideA, strideB and strideC elements
+ * after those of the previous one (0 means tightly packed).
+ */
+extern "C"
+uint8_t tiramisu_cblas_sgemm_strided_batched(float *A, float *B, float *C,
+                                             int M, int N, int K,
+                                             float alpha, float beta,
+                                             int ldA, int ldB, int ldC,
+                                             int offsetA, int offsetB, int offsetC,
+                                             int strideA, int strideB, int strideC,
+                                             int batch,
+                                             bool transposeA, bool transposeB)
+{
+    // Default values for tight packing:
+    if (ldA == 0) {
+        ldA = transposeA ? M : K;
+    }
+    if (ldB == 0) {
+        ldB = transposeB ? K : N;
+    }
+    if (ldC == 0) {
+        ldC = N;
+    }
+    if (strideA == 0) {
+        strideA = (transposeA ? K : M) * ldA;
+    }
+    if (strideB == 0) {
+        strideB = (transposeB ? N : K) * ldB;
+    }
+    if (strideC == 0) {
+        strideC = M * ldC;
+    }
+
+#if INTEL_MKL_VERSION >= 20200002
+    cblas_sgemm_batch_strided(CblasRowMajor,
+                              transposeA ? CblasTrans : CblasNoTrans,
+                              transposeB ? CblasTrans : CblasNoTrans,
+                              M, N, K, alpha, A + offsetA, ldA, strideA, B + offsetB, ldB, strideB,
+                              beta, C + offsetC, ldC, strideC, batch);
+#else
+    for (int b = 0; b < batch; b++)
+        cblas_sgemm(CblasRowMajor,
+                    transposeA ? CblasTrans : CblasNoTrans,
+                    transposeB ? CblasTrans : CblasNoTrans,
+                    M, N, K, alpha, A + offsetA + b * strideA, ldA, B + offsetB + b * strideB, ldB,
+                    beta, C + offsetC + b * strideC, ldC);
+#endif
+    return 0;
+}
+
+/**
+ * This is a reduced interface for the MKL strided batched GEMM API.
+ * It multiplies batch pairs of row-major matrices A and B of size MxK and
+ * KxN; the matrices of a batch start strideA, strideB and strideC elements
+ * after those of the previous one (0 means tightly packed).
+ */
+extern "C"
+uint8_t tiramisu_cblas_dgemm_strided_batched(double *A, double *B, double *C,
+                                             int M, int N, int K,
+                                             double alpha, double beta,
+                                             int ldA, int ldB, int ldC,
+                                             int offsetA, int offsetB, int offsetC,
+                                             int strideA, int strideB, int strideC,
+                                             int batch,
+                                             bool transposeA, bool transposeB)
+{
+    // Default values for tight packing:
+    if (ldA == 0) {
+        ldA = transposeA ? M : K;
+    }
+    if (ldB == 0) {
+        ldB = transposeB ? K : N;
+    }
+    if (ldC == 0) {
+        ldC = N;
+    }
+    if (strideA == 0) {
+        strideA = (transposeA ? K : M) * ldA;
+    }
+    if (strideB == 0) {
+        strideB = (transposeB ? N : K) * ldB;
+    }
+    if (strideC == 0) {
+        strideC = M * ldC;
+    }
+
+#if INTEL_MKL_VERSION >= 20200002
+    cblas_dgemm_batch_strided(CblasRowMajor,
+                              transposeA ? CblasTrans : CblasNoTrans,
+                              transposeB ? CblasTrans : CblasNoTrans,
+                              M, N, K, alpha, A + offsetA, ldA, strideA, B + offsetB, ldB, strideB,
+                              beta, C + offsetC, ldC, strideC, batch);
+#else
+    for (int b = 0; b < batch; b++)
+        cblas_dgemm(CblasRowMajor,
+                    transposeA ? CblasTrans : CblasNoTrans,
+                    transposeB ? CblasTrans : CblasNoTrans,
+                    M, N, K, alpha, A + offsetA + b * strideA, ldA, B + offsetB + b * strideB, ldB,
+                    beta, C + offsetC + b * strideC, ldC);
+#endif
+    return 0;
+}
+
 /**
  * This is a reduced interface for the MKL SPMV API.
  * It multiplies a sparse matrix by a dense matrix.
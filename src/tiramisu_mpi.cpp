@@ -1,25 +1,347 @@
 #include <cstdlib>
 #include <cstdio>
 #include <cassert>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
 #include "tiramisu/mpi_comm.h"
 
 #ifdef WITH_MPI
 
+#if defined(OPEN_MPI) && defined(__has_include)
+#if __has_include(<mpi-ext.h>)
+#include <mpi-ext.h>
+#endif
+#endif
+
+// The copies of the CUDA runtime of tiramisu, only linked with the GPU programs.
+extern "C" int tiramisu_cuda_memcpy_to_host(void *to, void *from, uint64_t size) __attribute__((weak));
+extern "C" int tiramisu_cuda_memcpy_to_device(void *to, void *from, uint64_t size) __attribute__((weak));
+
+// The host copies of the messages of the nonblocking transfers of GPU buffers that
+// are staged through the host, released by tiramisu_MPI_Wait() (after copying a
+// received message to the GPU).
+struct staged_transfer {
+    char *host;
+    void *device;
+    long bytes;
+};
+static std::map<MPI_Request *, staged_transfer> staged_transfers;
+static std::mutex staged_transfers_mutex;
+
+// Timeline of the communications of the rank, only recorded when TIRAMISU_MPI_TRACE
+// names the trace file (see tiramisu_MPI_cleanup()). The times are in seconds since
+// the initialization of MPI.
+struct trace_event {
+    const char *name;
+    double start;
+    double end;
+    long bytes;
+    int peer;
+    int tag;
+    const char *message;    // the operation that started the request of a wait
+};
+static std::vector<trace_event> trace_events;
+// The event of the operation that started each pending request
+static std::map<MPI_Request *, size_t> traced_requests;
+static std::mutex trace_mutex;
+static double trace_origin = 0;
+
+static bool tracing()
+{
+    static const bool enabled = (getenv("TIRAMISU_MPI_TRACE") != NULL);
+    return enabled;
+}
+
+static long message_bytes(int count, MPI_Datatype type)
+{
+    int type_size;
+    MPI_Type_size(type, &type_size);
+    return (long) count * type_size;
+}
+
+// Records the call of the communication function in which it is declared.
+class traced_call {
+public:
+    traced_call(const char *name, long bytes, int peer, int tag, long *reqs = NULL)
+        : event({name, tracing() ? MPI_Wtime() - trace_origin : 0, 0, bytes, peer, tag, NULL}), reqs(reqs) {}
+
+    ~traced_call() {
+        if (!tracing()) {
+            return;
+        }
+        event.end = MPI_Wtime() - trace_origin;
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        if (reqs != NULL) {
+            traced_requests[((MPI_Request**)reqs)[0]] = trace_events.size();
+        }
+        trace_events.push_back(event);
+    }
+
+    void set_message(const char *message) {
+        event.message = message;
+    }
+
+private:
+    trace_event event;
+    long *reqs;
+};
+
+// The ranks start their timelines together.
+static void start_trace()
+{
+    if (tracing()) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        trace_origin = MPI_Wtime();
+    }
+}
+
+// Gather the timelines of all the ranks in the Chrome trace (chrome://tracing, Perfetto)
+// written by the rank 0: one process per rank, one thread per communication channel.
+static void write_trace()
+{
+    int rank, nranks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nranks);
+
+    std::string events = "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " + std::to_string(rank) +
+                         ", \"args\": {\"name\": \"rank " + std::to_string(rank) + "\"}}";
+    for (const trace_event &event : trace_events) {
+        events += ",\n  {\"name\": \"" + std::string(event.name) + "\", \"cat\": \"mpi\", \"ph\": \"X\", \"pid\": " +
+                  std::to_string(rank) + ", \"tid\": " + std::to_string(event.tag >> TIRAMISU_MPI_CHANNEL_SHIFT) +
+                  ", \"ts\": " + std::to_string(event.start * 1e6) + ", \"dur\": " +
+                  std::to_string((event.end - event.start) * 1e6) + ", \"args\": {\"peer\": " +
+                  std::to_string(event.peer) + ", \"bytes\": " + std::to_string(event.bytes) +
+                  ", \"tag\": " + std::to_string(event.tag & ((1 << TIRAMISU_MPI_CHANNEL_SHIFT) - 1)) +
+                  ", \"channel\": " + std::to_string(event.tag >> TIRAMISU_MPI_CHANNEL_SHIFT) +
+                  ((event.message != NULL) ? ", \"message\": \"" + std::string(event.message) + "\"" : "") + "}}";
+    }
+
+    int length = events.size();
+    std::vector<int> lengths(nranks), displacements(nranks, 0);
+    MPI_Gather(&length, 1, MPI_INT, lengths.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    for (int r = 1; r < nranks; r++) {
+        displacements[r] = displacements[r - 1] + lengths[r - 1];
+    }
+    std::vector<char> all_events((rank == 0) ? displacements[nranks - 1] + lengths[nranks - 1] : 0);
+    MPI_Gatherv(events.data(), length, MPI_CHAR, all_events.data(), lengths.data(), displacements.data(),
+                MPI_CHAR, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        FILE *trace = fopen(getenv("TIRAMISU_MPI_TRACE"), "w");
+        if (trace == NULL) {
+            fprintf(stderr, "Cannot write the communication trace %s\n", getenv("TIRAMISU_MPI_TRACE"));
+            return;
+        }
+        fprintf(trace, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+        for (int r = 0; r < nranks; r++) {
+            fprintf(trace, "%s%.*s", (r == 0) ? "" : ",\n", lengths[r], all_events.data() + displacements[r]);
+        }
+        fprintf(trace, "\n]}\n");
+        fclose(trace);
+    }
+}
+
+// Cartesian communicator of the ranks (only used after tiramisu_MPI_init_topology()).
+static MPI_Comm topology_comm = MPI_COMM_NULL;
+
+// Communicators of the communication channels (only used with MPI_THREAD_MULTIPLE).
+static std::vector<MPI_Comm> channel_comms;
+
+// One-sided communication (only used after tiramisu_MPI_init_rma()).
+// The data window of each rank has one slot per source rank, used as a ring buffer
+// of the messages put by that source. The counters window of each rank holds, for
+// each rank r, the number of bytes put by r in our slot (at index r) and the number
+// of bytes taken by r from the slot that we fill on r (at index nranks + r).
+static MPI_Win rma_data_win = MPI_WIN_NULL;
+static MPI_Win rma_counters_win = MPI_WIN_NULL;
+static char *rma_data = NULL;
+static long rma_slot_bytes = 0;
+static int rma_rank = 0;
+static int rma_nranks = 0;
+static std::vector<long> rma_put_bytes;
+static std::vector<long> rma_taken_bytes;
+
 int tiramisu_MPI_init() {
     int provided = -1;
     MPI_Init_thread(NULL, NULL, MPI_THREAD_FUNNELED, &provided);
     assert(provided == MPI_THREAD_FUNNELED && "Did not get the appropriate MPI thread requirement.");
+    start_trace();
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    return rank;
+}
+
+int tiramisu_MPI_init_thread_multiple(int num_channels) {
+    int provided = -1;
+    MPI_Init_thread(NULL, NULL, MPI_THREAD_MULTIPLE, &provided);
+    if (provided < MPI_THREAD_MULTIPLE) {
+        fprintf(stderr, "The MPI library does not support MPI_THREAD_MULTIPLE (provided: %d)", provided);
+        exit(28);
+    }
+    assert(num_channels > 0 && "At least one communication channel is required.");
+    // Each channel gets its own communicator so that the messages of different
+    // threads are matched independently (and, with most MPI libraries, without
+    // contending on the matching queue of MPI_COMM_WORLD).
+    int *tag_ub;
+    int flag;
+    MPI_Comm_get_attr(MPI_COMM_WORLD, MPI_TAG_UB, &tag_ub, &flag);
+    if (flag && *tag_ub < (1 << 30)) {
+        fprintf(stderr, "Warning: MPI_TAG_UB (%d) limits the number of distinct communication channels to %d\n",
+                *tag_ub, *tag_ub >> TIRAMISU_MPI_CHANNEL_SHIFT);
+    }
+    start_trace();
+    channel_comms.resize(num_channels);
+    for (int i = 0; i < num_channels; i++) {
+        MPI_Comm_dup(MPI_COMM_WORLD, &channel_comms[i]);
+    }
     int rank;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     return rank;
 }
 
+void tiramisu_MPI_init_rma(long bytes_per_source) {
+    assert(bytes_per_source > 0 && "The RMA window should not be empty.");
+    MPI_Comm_rank(tiramisu_MPI_world(), &rma_rank);
+    MPI_Comm_size(tiramisu_MPI_world(), &rma_nranks);
+    rma_slot_bytes = bytes_per_source;
+    rma_put_bytes.assign(rma_nranks, 0);
+    rma_taken_bytes.assign(rma_nranks, 0);
+
+    // Let the MPI library place the windows in shared memory so that the transfers
+    // between the ranks of a node become direct copies.
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "alloc_shm", "true");
+    MPI_Info_set(info, "same_disp_unit", "true");
+    MPI_Win_allocate(rma_slot_bytes * rma_nranks, 1, info, tiramisu_MPI_world(), &rma_data, &rma_data_win);
+    long *counters;
+    MPI_Win_allocate(2 * rma_nranks * sizeof(long), sizeof(long), info, tiramisu_MPI_world(), &counters, &rma_counters_win);
+    MPI_Info_free(&info);
+    memset(counters, 0, 2 * rma_nranks * sizeof(long));
+
+    MPI_Win_lock_all(0, rma_data_win);
+    MPI_Win_lock_all(0, rma_counters_win);
+    MPI_Barrier(tiramisu_MPI_world());
+}
+
+// Return the shape of the blocks of ranks_per_node ranks in which the grid is split
+// (one block per node), or an empty vector if the grid cannot be split evenly.
+static std::vector<int> get_node_block(const std::vector<int> &grid, int ranks_per_node)
+{
+    std::vector<int> block(grid.size(), 0);
+    MPI_Dims_create(ranks_per_node, grid.size(), block.data());
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool divides = true;
+        for (size_t k = 0; k < grid.size(); k++) {
+            divides = divides && (grid[k] % block[k] == 0);
+        }
+        if (divides) {
+            return block;
+        }
+        // MPI_Dims_create sorts the block in decreasing order, try the other way around.
+        std::reverse(block.begin(), block.end());
+    }
+    return std::vector<int>();
+}
+
+int tiramisu_MPI_init_topology(int ndims, const int *dims) {
+    int world_rank, nranks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nranks);
+    std::vector<int> grid(dims, dims + ndims);
+    std::vector<int> periods(ndims, 0);
+    int grid_size = 1;
+    for (int d : grid) {
+        grid_size *= d;
+    }
+    if (grid_size != nranks) {
+        fprintf(stderr, "The grid of ranks has %d ranks but MPI has %d ranks\n", grid_size, nranks);
+        exit(28);
+    }
+
+    // Find the node of the rank and its position in the node.
+    MPI_Comm node_comm, leaders_comm;
+    int local_rank, ranks_per_node, node = 0;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, world_rank, MPI_INFO_NULL, &node_comm);
+    MPI_Comm_rank(node_comm, &local_rank);
+    MPI_Comm_size(node_comm, &ranks_per_node);
+    MPI_Comm_split(MPI_COMM_WORLD, local_rank == 0 ? 0 : MPI_UNDEFINED, world_rank, &leaders_comm);
+    if (leaders_comm != MPI_COMM_NULL) {
+        MPI_Comm_rank(leaders_comm, &node);
+        MPI_Comm_free(&leaders_comm);
+    }
+    MPI_Bcast(&node, 1, MPI_INT, 0, node_comm);
+    MPI_Comm_free(&node_comm);
+
+    int min_ranks_per_node, max_ranks_per_node;
+    MPI_Allreduce(&ranks_per_node, &min_ranks_per_node, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    MPI_Allreduce(&ranks_per_node, &max_ranks_per_node, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    std::vector<int> block;
+    if (min_ranks_per_node == max_ranks_per_node) {
+        block = get_node_block(grid, ranks_per_node);
+    }
+
+    if (!block.empty()) {
+        // Give each node a block of the grid, so that most of the neighbours of a
+        // rank are on the same node: rank (in the new communicator) = the row-major
+        // position in the grid of the position in the block of the node.
+        int node_pos = node, local_pos = local_rank, logical_rank = 0;
+        std::vector<int> coords(ndims);
+        for (int k = ndims - 1; k >= 0; k--) {
+            coords[k] = (node_pos % (grid[k] / block[k])) * block[k] + local_pos % block[k];
+            node_pos /= grid[k] / block[k];
+            local_pos /= block[k];
+        }
+        for (int k = 0; k < ndims; k++) {
+            logical_rank = logical_rank * grid[k] + coords[k];
+        }
+        MPI_Comm ordered_comm;
+        MPI_Comm_split(MPI_COMM_WORLD, 0, logical_rank, &ordered_comm);
+        MPI_Cart_create(ordered_comm, ndims, grid.data(), periods.data(), 0, &topology_comm);
+        MPI_Comm_free(&ordered_comm);
+    } else {
+        // Let the MPI library place the ranks.
+        MPI_Cart_create(MPI_COMM_WORLD, ndims, grid.data(), periods.data(), 1, &topology_comm);
+    }
+
+    // The channels must number the ranks like the new communicator.
+    for (MPI_Comm &comm : channel_comms) {
+        MPI_Comm_free(&comm);
+        MPI_Comm_dup(topology_comm, &comm);
+    }
+
+    int rank;
+    MPI_Comm_rank(topology_comm, &rank);
+    return rank;
+}
+
 void tiramisu_MPI_cleanup() {
+    if (tracing()) {
+        write_trace();
+    }
+    if (rma_data_win != MPI_WIN_NULL) {
+        MPI_Barrier(tiramisu_MPI_world());
+        MPI_Win_unlock_all(rma_data_win);
+        MPI_Win_unlock_all(rma_counters_win);
+        MPI_Win_free(&rma_data_win);
+        MPI_Win_free(&rma_counters_win);
+    }
+    for (MPI_Comm &comm : channel_comms) {
+        MPI_Comm_free(&comm);
+    }
+    channel_comms.clear();
+    if (topology_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&topology_comm);
+    }
     MPI_Finalize();
 }
 
 void tiramisu_MPI_global_barrier() {
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(tiramisu_MPI_world());
 }
 
 extern "C" {
@@ -27,46 +349,168 @@ extern "C" {
 #define make_Send(suffix, c_datatype, mpi_datatype) \
 void tiramisu_MPI_Send_##suffix(int count, int dest, int tag, c_datatype *data) \
 { \
-    check_MPI_error(MPI_Send(data, count, mpi_datatype, dest, tag, MPI_COMM_WORLD)); \
+    traced_call trace("Send", (long) count * sizeof(c_datatype), dest, tag); \
+    check_MPI_error(MPI_Send(data, count, mpi_datatype, dest, tag, tiramisu_MPI_comm(tag))); \
 }
 
 #define make_Ssend(suffix, c_datatype, mpi_datatype) \
 void tiramisu_MPI_Ssend_##suffix(int count, int dest, int tag, c_datatype *data) \
 { \
-    check_MPI_error(MPI_Ssend(data, count, mpi_datatype, dest, tag, MPI_COMM_WORLD)); \
+    traced_call trace("Ssend", (long) count * sizeof(c_datatype), dest, tag); \
+    check_MPI_error(MPI_Ssend(data, count, mpi_datatype, dest, tag, tiramisu_MPI_comm(tag))); \
 }
 
 #define make_Isend(suffix, c_datatype, mpi_datatype) \
 void tiramisu_MPI_Isend_##suffix(int count, int dest, int tag, c_datatype *data, long *reqs) \
 { \
+    traced_call trace("Isend", (long) count * sizeof(c_datatype), dest, tag, reqs); \
     ((MPI_Request**)reqs)[0] = (MPI_Request*)malloc(sizeof(MPI_Request)); \
-    check_MPI_error(MPI_Isend(data, count, mpi_datatype, dest, tag, MPI_COMM_WORLD, ((MPI_Request**)reqs)[0])); \
+    check_MPI_error(MPI_Isend(data, count, mpi_datatype, dest, tag, tiramisu_MPI_comm(tag), ((MPI_Request**)reqs)[0])); \
 }
 
 #define make_Issend(suffix, c_datatype, mpi_datatype) \
 void tiramisu_MPI_Issend_##suffix(int count, int dest, int tag, c_datatype *data, long *reqs) \
 { \
+    traced_call trace("Issend", (long) count * sizeof(c_datatype), dest, tag, reqs); \
     ((MPI_Request**)reqs)[0] = (MPI_Request*)malloc(sizeof(MPI_Request)); \
-    check_MPI_error(MPI_Issend(data, count, mpi_datatype, dest, tag, MPI_COMM_WORLD, ((MPI_Request**)reqs)[0])); \
+    check_MPI_error(MPI_Issend(data, count, mpi_datatype, dest, tag, tiramisu_MPI_comm(tag), ((MPI_Request**)reqs)[0])); \
 }
 
 #define make_Recv(suffix, c_datatype, mpi_datatype) \
 void tiramisu_MPI_Recv_##suffix(int count, int source, int tag, \
                                 c_datatype *store_in) \
 { \
+    traced_call trace("Recv", (long) count * sizeof(c_datatype), source, tag); \
     MPI_Status status; \
-    check_MPI_error(MPI_Recv(store_in, count, mpi_datatype, source, tag, MPI_COMM_WORLD, &status)); \
+    check_MPI_error(MPI_Recv(store_in, count, mpi_datatype, source, tag, tiramisu_MPI_comm(tag), &status)); \
 }
 
 #define make_Irecv(suffix, c_datatype, mpi_datatype) \
 void tiramisu_MPI_Irecv_##suffix(int count, int source, int tag, \
                                  c_datatype *store_in, long *reqs) \
 { \
+    traced_call trace("Irecv", (long) count * sizeof(c_datatype), source, tag, reqs); \
     ((MPI_Request**)reqs)[0] = (MPI_Request*)malloc(sizeof(MPI_Request)); \
-    check_MPI_error(MPI_Irecv(store_in, count, mpi_datatype, source, tag, MPI_COMM_WORLD, \
+    check_MPI_error(MPI_Irecv(store_in, count, mpi_datatype, source, tag, tiramisu_MPI_comm(tag), \
                               ((MPI_Request**)reqs)[0])); \
 }
 
+#define make_Put(suffix, c_datatype, mpi_datatype) \
+void tiramisu_MPI_Put_##suffix(int count, int dest, int tag, c_datatype *data) \
+{ \
+    tiramisu_MPI_Put(count, dest, tag, (char *) data, mpi_datatype); \
+}
+
+#define make_Get(suffix, c_datatype, mpi_datatype) \
+void tiramisu_MPI_Get_##suffix(int count, int source, int tag, c_datatype *store_in) \
+{ \
+    tiramisu_MPI_Get(count, source, tag, (char *) store_in, mpi_datatype); \
+}
+
+#define make_Send_vector(suffix, c_datatype, mpi_datatype) \
+void tiramisu_MPI_Send_vector_##suffix(int count, int dest, int tag, c_datatype *data, \
+                                       int block_length, int stride) \
+{ \
+    traced_call trace("Send", (long) count * sizeof(c_datatype), dest, tag); \
+    MPI_Datatype type = tiramisu_MPI_vector_type(count, block_length, stride, mpi_datatype); \
+    check_MPI_error(MPI_Send(data, 1, type, dest, tag, tiramisu_MPI_comm(tag))); \
+    check_MPI_error(MPI_Type_free(&type)); \
+}
+
+#define make_Ssend_vector(suffix, c_datatype, mpi_datatype) \
+void tiramisu_MPI_Ssend_vector_##suffix(int count, int dest, int tag, c_datatype *data, \
+                                        int block_length, int stride) \
+{ \
+    traced_call trace("Ssend", (long) count * sizeof(c_datatype), dest, tag); \
+    MPI_Datatype type = tiramisu_MPI_vector_type(count, block_length, stride, mpi_datatype); \
+    check_MPI_error(MPI_Ssend(data, 1, type, dest, tag, tiramisu_MPI_comm(tag))); \
+    check_MPI_error(MPI_Type_free(&type)); \
+}
+
+/* Freeing the datatype of a pending nonblocking operation is allowed: MPI only marks it for deallocation. */
+#define make_Isend_vector(suffix, c_datatype, mpi_datatype) \
+void tiramisu_MPI_Isend_vector_##suffix(int count, int dest, int tag, c_datatype *data, long *reqs, \
+                                        int block_length, int stride) \
+{ \
+    traced_call trace("Isend", (long) count * sizeof(c_datatype), dest, tag, reqs); \
+    MPI_Datatype type = tiramisu_MPI_vector_type(count, block_length, stride, mpi_datatype); \
+    ((MPI_Request**)reqs)[0] = (MPI_Request*)malloc(sizeof(MPI_Request)); \
+    check_MPI_error(MPI_Isend(data, 1, type, dest, tag, tiramisu_MPI_comm(tag), ((MPI_Request**)reqs)[0])); \
+    check_MPI_error(MPI_Type_free(&type)); \
+}
+
+#define make_Issend_vector(suffix, c_datatype, mpi_datatype) \
+void tiramisu_MPI_Issend_vector_##suffix(int count, int dest, int tag, c_datatype *data, long *reqs, \
+                                         int block_length, int stride) \
+{ \
+    traced_call trace("Issend", (long) count * sizeof(c_datatype), dest, tag, reqs); \
+    MPI_Datatype type = tiramisu_MPI_vector_type(count, block_length, stride, mpi_datatype); \
+    ((MPI_Request**)reqs)[0] = (MPI_Request*)malloc(sizeof(MPI_Request)); \
+    check_MPI_error(MPI_Issend(data, 1, type, dest, tag, tiramisu_MPI_comm(tag), ((MPI_Request**)reqs)[0])); \
+    check_MPI_error(MPI_Type_free(&type)); \
+}
+
+#define make_Recv_vector(suffix, c_datatype, mpi_datatype) \
+void tiramisu_MPI_Recv_vector_##suffix(int count, int source, int tag, c_datatype *store_in, \
+                                       int block_length, int stride) \
+{ \
+    traced_call trace("Recv", (long) count * sizeof(c_datatype), source, tag); \
+    MPI_Status status; \
+    MPI_Datatype type = tiramisu_MPI_vector_type(count, block_length, stride, mpi_datatype); \
+    check_MPI_error(MPI_Recv(store_in, 1, type, source, tag, tiramisu_MPI_comm(tag), &status)); \
+    check_MPI_error(MPI_Type_free(&type)); \
+}
+
+#define make_Irecv_vector(suffix, c_datatype, mpi_datatype) \
+void tiramisu_MPI_Irecv_vector_##suffix(int count, int source, int tag, c_datatype *store_in, long *reqs, \
+                                        int block_length, int stride) \
+{ \
+    traced_call trace("Irecv", (long) count * sizeof(c_datatype), source, tag, reqs); \
+    MPI_Datatype type = tiramisu_MPI_vector_type(count, block_length, stride, mpi_datatype); \
+    ((MPI_Request**)reqs)[0] = (MPI_Request*)malloc(sizeof(MPI_Request)); \
+    check_MPI_error(MPI_Irecv(store_in, 1, type, source, tag, tiramisu_MPI_comm(tag), \
+                              ((MPI_Request**)reqs)[0])); \
+    check_MPI_error(MPI_Type_free(&type)); \
+}
+
+#define make_Allreduce(suffix, c_datatype, mpi_datatype) \
+void tiramisu_MPI_Allreduce_##suffix(int count, int op, c_datatype *data, c_datatype *store_in) \
+{ \
+    traced_call trace("Allreduce", (long) count * sizeof(c_datatype), -1, 0); \
+    check_MPI_error(MPI_Allreduce(data == store_in ? MPI_IN_PLACE : data, store_in, count, mpi_datatype, \
+                                  tiramisu_MPI_Op(op), tiramisu_MPI_world())); \
+}
+
+#define make_Allgather(suffix, c_datatype, mpi_datatype) \
+void tiramisu_MPI_Allgather_##suffix(int count, c_datatype *data, c_datatype *store_in) \
+{ \
+    traced_call trace("Allgather", (long) count * sizeof(c_datatype), -1, 0); \
+    int rank; \
+    check_MPI_error(MPI_Comm_rank(tiramisu_MPI_world(), &rank)); \
+    check_MPI_error(MPI_Allgather(data == store_in + (long)rank * count ? MPI_IN_PLACE : data, count, \
+                                  mpi_datatype, store_in, count, mpi_datatype, tiramisu_MPI_world())); \
+}
+
+#define make_Bcast(suffix, c_datatype, mpi_datatype) \
+void tiramisu_MPI_Bcast_##suffix(int count, int root, c_datatype *data, c_datatype *store_in) \
+{ \
+    traced_call trace("Bcast", (long) count * sizeof(c_datatype), root, 0); \
+    int rank; \
+    check_MPI_error(MPI_Comm_rank(tiramisu_MPI_world(), &rank)); \
+    if (rank == root && data != store_in) { \
+        memcpy(store_in, data, count * sizeof(c_datatype)); \
+    } \
+    check_MPI_error(MPI_Bcast(store_in, count, mpi_datatype, root, tiramisu_MPI_world())); \
+}
+
+#define make_Reduce_scatter(suffix, c_datatype, mpi_datatype) \
+void tiramisu_MPI_Reduce_scatter_##suffix(int count, int op, c_datatype *data, c_datatype *store_in) \
+{ \
+    traced_call trace("Reduce_scatter", (long) count * sizeof(c_datatype), -1, 0); \
+    check_MPI_error(MPI_Reduce_scatter_block(data == store_in ? MPI_IN_PLACE : data, store_in, count, \
+                                             mpi_datatype, tiramisu_MPI_Op(op), tiramisu_MPI_world())); \
+}
+
 inline void check_MPI_error(int ret_val) 
 {
     if (ret_val != MPI_SUCCESS) {
@@ -75,22 +519,134 @@ inline void check_MPI_error(int ret_val)
     }
 }
 
+MPI_Comm tiramisu_MPI_world()
+{
+    return (topology_comm != MPI_COMM_NULL) ? topology_comm : MPI_COMM_WORLD;
+}
+
+// The whole tag (channel included) stays the MPI tag, so the channels that share
+// a communicator (when there are more channels than communicators) are still told apart.
+MPI_Comm tiramisu_MPI_comm(int tag)
+{
+    if (channel_comms.empty()) {
+        return tiramisu_MPI_world();
+    }
+    return channel_comms[(tag >> TIRAMISU_MPI_CHANNEL_SHIFT) % channel_comms.size()];
+}
+
 int tiramisu_MPI_Comm_rank(int offset) 
 {
     int rank;
-    check_MPI_error(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    check_MPI_error(MPI_Comm_rank(tiramisu_MPI_world(), &rank));
     return rank + offset;
 }
 
 void tiramisu_MPI_Wait(void *request) 
 {
     MPI_Status status;
-    check_MPI_error(MPI_Wait((MPI_Request*)request, &status));
+    trace_event started = {NULL, 0, 0, 0, -1, 0, NULL};
+    if (tracing()) {
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        auto found = traced_requests.find((MPI_Request*)request);
+        if (found != traced_requests.end()) {
+            started = trace_events[found->second];
+            traced_requests.erase(found);
+        }
+    }
+    {
+        traced_call trace("Wait", started.bytes, started.peer, started.tag);
+        trace.set_message(started.name);
+        check_MPI_error(MPI_Wait((MPI_Request*)request, &status));
+    }
+
+    staged_transfer staged = {NULL, NULL, 0};
+    {
+        std::lock_guard<std::mutex> lock(staged_transfers_mutex);
+        auto found = staged_transfers.find((MPI_Request*)request);
+        if (found == staged_transfers.end()) {
+            return;
+        }
+        staged = found->second;
+        staged_transfers.erase(found);
+    }
+    if (staged.device != NULL) {
+        tiramisu_cuda_memcpy_to_device(staged.device, staged.host, staged.bytes);
+    }
+    free(staged.host);
+}
+
+// Atomically read the counter idx of the calling rank.
+static long rma_read_counter(int idx)
+{
+    long zero = 0, value;
+    check_MPI_error(MPI_Fetch_and_op(&zero, &value, MPI_LONG, rma_rank, idx, MPI_NO_OP, rma_counters_win));
+    check_MPI_error(MPI_Win_flush(rma_rank, rma_counters_win));
+    return value;
+}
+
+// Atomically add value to the counter idx of target.
+static void rma_add_counter(int target, int idx, long value)
+{
+    check_MPI_error(MPI_Accumulate(&value, 1, MPI_LONG, target, idx, 1, MPI_LONG, MPI_SUM, rma_counters_win));
+    check_MPI_error(MPI_Win_flush(target, rma_counters_win));
+}
+
+void tiramisu_MPI_Put(int count, int dest, int tag, char *data, MPI_Datatype type)
+{
+    traced_call trace("Put", message_bytes(count, type), dest, tag);
+    assert(rma_data_win != MPI_WIN_NULL && "tiramisu_MPI_init_rma() should be called before one-sided transfers.");
+    int type_size;
+    MPI_Type_size(type, &type_size);
+    long bytes = (long) count * type_size;
+    if (bytes > rma_slot_bytes) {
+        fprintf(stderr, "A message of %ld bytes does not fit in the RMA window (%ld bytes per source)\n",
+                bytes, rma_slot_bytes);
+        exit(28);
+    }
+
+    // Wait until dest took enough of the previous messages from our slot.
+    while (rma_put_bytes[dest] + bytes - rma_read_counter(rma_nranks + dest) > rma_slot_bytes);
+
+    MPI_Aint slot = (MPI_Aint) rma_rank * rma_slot_bytes;
+    long pos = rma_put_bytes[dest] % rma_slot_bytes;
+    long first = std::min(bytes, rma_slot_bytes - pos);
+    check_MPI_error(MPI_Put(data, first, MPI_BYTE, dest, slot + pos, first, MPI_BYTE, rma_data_win));
+    if (first < bytes) {
+        check_MPI_error(MPI_Put(data + first, bytes - first, MPI_BYTE, dest, slot, bytes - first, MPI_BYTE,
+                                rma_data_win));
+    }
+    // The data must be complete on dest before it is notified.
+    check_MPI_error(MPI_Win_flush(dest, rma_data_win));
+    rma_put_bytes[dest] += bytes;
+    rma_add_counter(dest, rma_rank, bytes);
+}
+
+void tiramisu_MPI_Get(int count, int source, int tag, char *store_in, MPI_Datatype type)
+{
+    traced_call trace("Get", message_bytes(count, type), source, tag);
+    assert(rma_data_win != MPI_WIN_NULL && "tiramisu_MPI_init_rma() should be called before one-sided transfers.");
+    int type_size;
+    MPI_Type_size(type, &type_size);
+    long bytes = (long) count * type_size;
+
+    // Wait for the notification of the put.
+    while (rma_read_counter(source) < rma_taken_bytes[source] + bytes);
+    check_MPI_error(MPI_Win_sync(rma_data_win));
+
+    char *slot = rma_data + (long) source * rma_slot_bytes;
+    long pos = rma_taken_bytes[source] % rma_slot_bytes;
+    long first = std::min(bytes, rma_slot_bytes - pos);
+    memcpy(store_in, slot + pos, first);
+    memcpy(store_in + first, slot, bytes - first);
+    rma_taken_bytes[source] += bytes;
+    // Give the space back to the source.
+    rma_add_counter(source, rma_nranks + rma_rank, bytes);
 }
 
 void tiramisu_MPI_Send(int count, int dest, int tag, char *data, MPI_Datatype type) 
 {
-    check_MPI_error(MPI_Send(data, count, type, dest, tag, MPI_COMM_WORLD));
+    traced_call trace("Send", message_bytes(count, type), dest, tag);
+    check_MPI_error(MPI_Send(data, count, type, dest, tag, tiramisu_MPI_comm(tag)));
 }
 
 make_Send(int8, char, MPI_SIGNED_CHAR)
@@ -106,7 +662,8 @@ make_Send(f64, double, MPI_DOUBLE)
 
 void tiramisu_MPI_Ssend(int count, int dest, int tag, char *data, MPI_Datatype type) 
 {
-    check_MPI_error(MPI_Ssend(data, count, type, dest, tag, MPI_COMM_WORLD));
+    traced_call trace("Ssend", message_bytes(count, type), dest, tag);
+    check_MPI_error(MPI_Ssend(data, count, type, dest, tag, tiramisu_MPI_comm(tag)));
 }
 
 make_Ssend(int8, char, MPI_SIGNED_CHAR)
@@ -122,8 +679,9 @@ make_Ssend(f64, double, MPI_DOUBLE)
 
 void tiramisu_MPI_Isend(int count, int dest, int tag, char *data, MPI_Datatype type, long *reqs) 
 {
+    traced_call trace("Isend", message_bytes(count, type), dest, tag, reqs);
     ((MPI_Request**)reqs)[0] = (MPI_Request*)malloc(sizeof(MPI_Request));
-    check_MPI_error(MPI_Isend(data, count, type, dest, tag, MPI_COMM_WORLD, ((MPI_Request**)reqs)[0]));
+    check_MPI_error(MPI_Isend(data, count, type, dest, tag, tiramisu_MPI_comm(tag), ((MPI_Request**)reqs)[0]));
 }
 
 make_Isend(int8, char, MPI_SIGNED_CHAR)
@@ -139,8 +697,9 @@ make_Isend(f64, double, MPI_DOUBLE)
 
 void tiramisu_MPI_Issend(int count, int dest, int tag, char *data, MPI_Datatype type, long *reqs) 
 {
+    traced_call trace("Issend", message_bytes(count, type), dest, tag, reqs);
     ((MPI_Request**)reqs)[0] = (MPI_Request*)malloc(sizeof(MPI_Request));
-    check_MPI_error(MPI_Issend(data, count, type, dest, tag, MPI_COMM_WORLD, ((MPI_Request**)reqs)[0]));
+    check_MPI_error(MPI_Issend(data, count, type, dest, tag, tiramisu_MPI_comm(tag), ((MPI_Request**)reqs)[0]));
 }
 
 make_Issend(int8, char, MPI_SIGNED_CHAR)
@@ -157,8 +716,9 @@ make_Issend(f64, double, MPI_DOUBLE)
 void tiramisu_MPI_Recv(int count, int source, int tag,
                      char *store_in, MPI_Datatype type) 
 {
+    traced_call trace("Recv", message_bytes(count, type), source, tag);
     MPI_Status status;
-    check_MPI_error(MPI_Recv(store_in, count, type, source, tag, MPI_COMM_WORLD, &status));
+    check_MPI_error(MPI_Recv(store_in, count, type, source, tag, tiramisu_MPI_comm(tag), &status));
 }
 
 make_Recv(int8, char, MPI_SIGNED_CHAR)
@@ -175,8 +735,9 @@ make_Recv(f64, double, MPI_DOUBLE)
 void tiramisu_MPI_Irecv(int count, int source, int tag,
                       char *store_in, MPI_Datatype type, long *reqs) 
 {
+    traced_call trace("Irecv", message_bytes(count, type), source, tag, reqs);
     ((MPI_Request**)reqs)[0] = (MPI_Request*)malloc(sizeof(MPI_Request));
-    check_MPI_error(MPI_Irecv(store_in, count, type, source, tag, MPI_COMM_WORLD,
+    check_MPI_error(MPI_Irecv(store_in, count, type, source, tag, tiramisu_MPI_comm(tag),
                               ((MPI_Request**)reqs)[0]));
 }
 
@@ -191,6 +752,326 @@ make_Irecv(uint64, unsigned long, MPI_UNSIGNED_LONG)
 make_Irecv(f32, float, MPI_FLOAT)
 make_Irecv(f64, double, MPI_DOUBLE)
 
+
+int tiramisu_MPI_cuda_aware()
+{
+    static const int cuda_aware = [] {
+        if (const char *env = getenv("TIRAMISU_MPI_CUDA_AWARE")) {
+            return (atoi(env) != 0) ? 1 : 0;
+        }
+#if defined(MPIX_CUDA_AWARE_SUPPORT) && MPIX_CUDA_AWARE_SUPPORT
+        return MPIX_Query_cuda_support();
+#else
+        return 0;
+#endif
+    }();
+    return cuda_aware;
+}
+
+static void check_staging()
+{
+    if (tiramisu_cuda_memcpy_to_host == NULL || tiramisu_cuda_memcpy_to_device == NULL) {
+        fprintf(stderr, "The transfers of GPU buffers without a CUDA-aware MPI need the CUDA runtime of tiramisu\n");
+        exit(28);
+    }
+}
+
+// A host copy of the message of bytes bytes at data on the GPU (or a host buffer for
+// the message to receive when data is NULL), released with free().
+static char *stage_on_host(void *data, long bytes)
+{
+    check_staging();
+    char *host = (char *) malloc(std::max(bytes, 1L));
+    if (data != NULL) {
+        tiramisu_cuda_memcpy_to_host(host, data, bytes);
+    }
+    return host;
+}
+
+static void add_staged_transfer(MPI_Request *request, char *host, void *device, long bytes)
+{
+    std::lock_guard<std::mutex> lock(staged_transfers_mutex);
+    staged_transfers[request] = {host, device, bytes};
+}
+
+static void send_device(int count, int dest, int tag, void *data, MPI_Datatype type, bool synchronous)
+{
+    char *buffer = tiramisu_MPI_cuda_aware() ? (char *) data : stage_on_host(data, message_bytes(count, type));
+    if (synchronous) {
+        check_MPI_error(MPI_Ssend(buffer, count, type, dest, tag, tiramisu_MPI_comm(tag)));
+    } else {
+        check_MPI_error(MPI_Send(buffer, count, type, dest, tag, tiramisu_MPI_comm(tag)));
+    }
+    if (buffer != data) {
+        free(buffer);
+    }
+}
+
+static void isend_device(int count, int dest, int tag, void *data, MPI_Datatype type, long *reqs, bool synchronous)
+{
+    MPI_Request *request = (MPI_Request*)malloc(sizeof(MPI_Request));
+    ((MPI_Request**)reqs)[0] = request;
+    char *buffer = tiramisu_MPI_cuda_aware() ? (char *) data : stage_on_host(data, message_bytes(count, type));
+    if (synchronous) {
+        check_MPI_error(MPI_Issend(buffer, count, type, dest, tag, tiramisu_MPI_comm(tag), request));
+    } else {
+        check_MPI_error(MPI_Isend(buffer, count, type, dest, tag, tiramisu_MPI_comm(tag), request));
+    }
+    if (buffer != data) {
+        add_staged_transfer(request, buffer, NULL, 0);
+    }
+}
+
+void tiramisu_MPI_Send_device(int count, int dest, int tag, void *data, MPI_Datatype type)
+{
+    traced_call trace("Send", message_bytes(count, type), dest, tag);
+    send_device(count, dest, tag, data, type, false);
+}
+
+void tiramisu_MPI_Ssend_device(int count, int dest, int tag, void *data, MPI_Datatype type)
+{
+    traced_call trace("Ssend", message_bytes(count, type), dest, tag);
+    send_device(count, dest, tag, data, type, true);
+}
+
+void tiramisu_MPI_Isend_device(int count, int dest, int tag, void *data, MPI_Datatype type, long *reqs)
+{
+    traced_call trace("Isend", message_bytes(count, type), dest, tag, reqs);
+    isend_device(count, dest, tag, data, type, reqs, false);
+}
+
+void tiramisu_MPI_Issend_device(int count, int dest, int tag, void *data, MPI_Datatype type, long *reqs)
+{
+    traced_call trace("Issend", message_bytes(count, type), dest, tag, reqs);
+    isend_device(count, dest, tag, data, type, reqs, true);
+}
+
+void tiramisu_MPI_Recv_device(int count, int source, int tag, void *store_in, MPI_Datatype type)
+{
+    traced_call trace("Recv", message_bytes(count, type), source, tag);
+    MPI_Status status;
+    if (tiramisu_MPI_cuda_aware()) {
+        check_MPI_error(MPI_Recv(store_in, count, type, source, tag, tiramisu_MPI_comm(tag), &status));
+        return;
+    }
+    long bytes = message_bytes(count, type);
+    char *host = stage_on_host(NULL, bytes);
+    check_MPI_error(MPI_Recv(host, count, type, source, tag, tiramisu_MPI_comm(tag), &status));
+    tiramisu_cuda_memcpy_to_device(store_in, host, bytes);
+    free(host);
+}
+
+void tiramisu_MPI_Irecv_device(int count, int source, int tag, void *store_in, MPI_Datatype type, long *reqs)
+{
+    traced_call trace("Irecv", message_bytes(count, type), source, tag, reqs);
+    MPI_Request *request = (MPI_Request*)malloc(sizeof(MPI_Request));
+    ((MPI_Request**)reqs)[0] = request;
+    if (tiramisu_MPI_cuda_aware()) {
+        check_MPI_error(MPI_Irecv(store_in, count, type, source, tag, tiramisu_MPI_comm(tag), request));
+        return;
+    }
+    long bytes = message_bytes(count, type);
+    char *host = stage_on_host(NULL, bytes);
+    check_MPI_error(MPI_Irecv(host, count, type, source, tag, tiramisu_MPI_comm(tag), request));
+    add_staged_transfer(request, host, store_in, bytes);
+}
+
+#define make_device(suffix, mpi_datatype) \
+void tiramisu_MPI_Send_device_##suffix(int count, int dest, int tag, void *data) \
+{ \
+    tiramisu_MPI_Send_device(count, dest, tag, data, mpi_datatype); \
+} \
+void tiramisu_MPI_Ssend_device_##suffix(int count, int dest, int tag, void *data) \
+{ \
+    tiramisu_MPI_Ssend_device(count, dest, tag, data, mpi_datatype); \
+} \
+void tiramisu_MPI_Isend_device_##suffix(int count, int dest, int tag, void *data, long *reqs) \
+{ \
+    tiramisu_MPI_Isend_device(count, dest, tag, data, mpi_datatype, reqs); \
+} \
+void tiramisu_MPI_Issend_device_##suffix(int count, int dest, int tag, void *data, long *reqs) \
+{ \
+    tiramisu_MPI_Issend_device(count, dest, tag, data, mpi_datatype, reqs); \
+} \
+void tiramisu_MPI_Recv_device_##suffix(int count, int source, int tag, void *store_in) \
+{ \
+    tiramisu_MPI_Recv_device(count, source, tag, store_in, mpi_datatype); \
+} \
+void tiramisu_MPI_Irecv_device_##suffix(int count, int source, int tag, void *store_in, long *reqs) \
+{ \
+    tiramisu_MPI_Irecv_device(count, source, tag, store_in, mpi_datatype, reqs); \
+}
+
+make_device(int8, MPI_SIGNED_CHAR)
+make_device(uint8, MPI_UNSIGNED_CHAR)
+make_device(int16, MPI_SHORT)
+make_device(uint16, MPI_UNSIGNED_SHORT)
+make_device(int32, MPI_INT)
+make_device(uint32, MPI_UNSIGNED)
+make_device(int64, MPI_LONG)
+make_device(uint64, MPI_UNSIGNED_LONG)
+make_device(f32, MPI_FLOAT)
+make_device(f64, MPI_DOUBLE)
+
+MPI_Datatype tiramisu_MPI_vector_type(int count, int block_length, int stride, MPI_Datatype type)
+{
+    assert(count % block_length == 0 && "The number of elements must be a multiple of the block length.");
+    MPI_Datatype vector_type;
+    check_MPI_error(MPI_Type_vector(count / block_length, block_length, stride, type, &vector_type));
+    check_MPI_error(MPI_Type_commit(&vector_type));
+    return vector_type;
+}
+
+make_Send_vector(int8, char, MPI_SIGNED_CHAR)
+make_Send_vector(uint8, unsigned char, MPI_UNSIGNED_CHAR)
+make_Send_vector(int16, short, MPI_SHORT)
+make_Send_vector(uint16, unsigned short, MPI_UNSIGNED_SHORT)
+make_Send_vector(int32, int, MPI_INT)
+make_Send_vector(uint32, unsigned int, MPI_UNSIGNED)
+make_Send_vector(int64, long, MPI_LONG)
+make_Send_vector(uint64, unsigned long, MPI_UNSIGNED_LONG)
+make_Send_vector(f32, float, MPI_FLOAT)
+make_Send_vector(f64, double, MPI_DOUBLE)
+
+make_Ssend_vector(int8, char, MPI_SIGNED_CHAR)
+make_Ssend_vector(uint8, unsigned char, MPI_UNSIGNED_CHAR)
+make_Ssend_vector(int16, short, MPI_SHORT)
+make_Ssend_vector(uint16, unsigned short, MPI_UNSIGNED_SHORT)
+make_Ssend_vector(int32, int, MPI_INT)
+make_Ssend_vector(uint32, unsigned int, MPI_UNSIGNED)
+make_Ssend_vector(int64, long, MPI_LONG)
+make_Ssend_vector(uint64, unsigned long, MPI_UNSIGNED_LONG)
+make_Ssend_vector(f32, float, MPI_FLOAT)
+make_Ssend_vector(f64, double, MPI_DOUBLE)
+
+make_Isend_vector(int8, char, MPI_SIGNED_CHAR)
+make_Isend_vector(uint8, unsigned char, MPI_UNSIGNED_CHAR)
+make_Isend_vector(int16, short, MPI_SHORT)
+make_Isend_vector(uint16, unsigned short, MPI_UNSIGNED_SHORT)
+make_Isend_vector(int32, int, MPI_INT)
+make_Isend_vector(uint32, unsigned int, MPI_UNSIGNED)
+make_Isend_vector(int64, long, MPI_LONG)
+make_Isend_vector(uint64, unsigned long, MPI_UNSIGNED_LONG)
+make_Isend_vector(f32, float, MPI_FLOAT)
+make_Isend_vector(f64, double, MPI_DOUBLE)
+
+make_Issend_vector(int8, char, MPI_SIGNED_CHAR)
+make_Issend_vector(uint8, unsigned char, MPI_UNSIGNED_CHAR)
+make_Issend_vector(int16, short, MPI_SHORT)
+make_Issend_vector(uint16, unsigned short, MPI_UNSIGNED_SHORT)
+make_Issend_vector(int32, int, MPI_INT)
+make_Issend_vector(uint32, unsigned int, MPI_UNSIGNED)
+make_Issend_vector(int64, long, MPI_LONG)
+make_Issend_vector(uint64, unsigned long, MPI_UNSIGNED_LONG)
+make_Issend_vector(f32, float, MPI_FLOAT)
+make_Issend_vector(f64, double, MPI_DOUBLE)
+
+make_Recv_vector(int8, char, MPI_SIGNED_CHAR)
+make_Recv_vector(uint8, unsigned char, MPI_UNSIGNED_CHAR)
+make_Recv_vector(int16, short, MPI_SHORT)
+make_Recv_vector(uint16, unsigned short, MPI_UNSIGNED_SHORT)
+make_Recv_vector(int32, int, MPI_INT)
+make_Recv_vector(uint32, unsigned int, MPI_UNSIGNED)
+make_Recv_vector(int64, long, MPI_LONG)
+make_Recv_vector(uint64, unsigned long, MPI_UNSIGNED_LONG)
+make_Recv_vector(f32, float, MPI_FLOAT)
+make_Recv_vector(f64, double, MPI_DOUBLE)
+
+make_Irecv_vector(int8, char, MPI_SIGNED_CHAR)
+make_Irecv_vector(uint8, unsigned char, MPI_UNSIGNED_CHAR)
+make_Irecv_vector(int16, short, MPI_SHORT)
+make_Irecv_vector(uint16, unsigned short, MPI_UNSIGNED_SHORT)
+make_Irecv_vector(int32, int, MPI_INT)
+make_Irecv_vector(uint32, unsigned int, MPI_UNSIGNED)
+make_Irecv_vector(int64, long, MPI_LONG)
+make_Irecv_vector(uint64, unsigned long, MPI_UNSIGNED_LONG)
+make_Irecv_vector(f32, float, MPI_FLOAT)
+make_Irecv_vector(f64, double, MPI_DOUBLE)
+
+// The order of the operators is the one of tiramisu::reduce_op.
+MPI_Op tiramisu_MPI_Op(int op)
+{
+    switch (op) {
+        case 0:
+            return MPI_SUM;
+        case 1:
+            return MPI_PROD;
+        case 2:
+            return MPI_MIN;
+        case 3:
+            return MPI_MAX;
+        default:
+            fprintf(stderr, "Unknown reduction operator: %d", op);
+            exit(28);
+    }
+}
+
+make_Allreduce(int8, char, MPI_SIGNED_CHAR)
+make_Allreduce(uint8, unsigned char, MPI_UNSIGNED_CHAR)
+make_Allreduce(int16, short, MPI_SHORT)
+make_Allreduce(uint16, unsigned short, MPI_UNSIGNED_SHORT)
+make_Allreduce(int32, int, MPI_INT)
+make_Allreduce(uint32, unsigned int, MPI_UNSIGNED)
+make_Allreduce(int64, long, MPI_LONG)
+make_Allreduce(uint64, unsigned long, MPI_UNSIGNED_LONG)
+make_Allreduce(f32, float, MPI_FLOAT)
+make_Allreduce(f64, double, MPI_DOUBLE)
+
+make_Allgather(int8, char, MPI_SIGNED_CHAR)
+make_Allgather(uint8, unsigned char, MPI_UNSIGNED_CHAR)
+make_Allgather(int16, short, MPI_SHORT)
+make_Allgather(uint16, unsigned short, MPI_UNSIGNED_SHORT)
+make_Allgather(int32, int, MPI_INT)
+make_Allgather(uint32, unsigned int, MPI_UNSIGNED)
+make_Allgather(int64, long, MPI_LONG)
+make_Allgather(uint64, unsigned long, MPI_UNSIGNED_LONG)
+make_Allgather(f32, float, MPI_FLOAT)
+make_Allgather(f64, double, MPI_DOUBLE)
+
+make_Bcast(int8, char, MPI_SIGNED_CHAR)
+make_Bcast(uint8, unsigned char, MPI_UNSIGNED_CHAR)
+make_Bcast(int16, short, MPI_SHORT)
+make_Bcast(uint16, unsigned short, MPI_UNSIGNED_SHORT)
+make_Bcast(int32, int, MPI_INT)
+make_Bcast(uint32, unsigned int, MPI_UNSIGNED)
+make_Bcast(int64, long, MPI_LONG)
+make_Bcast(uint64, unsigned long, MPI_UNSIGNED_LONG)
+make_Bcast(f32, float, MPI_FLOAT)
+make_Bcast(f64, double, MPI_DOUBLE)
+
+make_Reduce_scatter(int8, char, MPI_SIGNED_CHAR)
+make_Reduce_scatter(uint8, unsigned char, MPI_UNSIGNED_CHAR)
+make_Reduce_scatter(int16, short, MPI_SHORT)
+make_Reduce_scatter(uint16, unsigned short, MPI_UNSIGNED_SHORT)
+make_Reduce_scatter(int32, int, MPI_INT)
+make_Reduce_scatter(uint32, unsigned int, MPI_UNSIGNED)
+make_Reduce_scatter(int64, long, MPI_LONG)
+make_Reduce_scatter(uint64, unsigned long, MPI_UNSIGNED_LONG)
+make_Reduce_scatter(f32, float, MPI_FLOAT)
+make_Reduce_scatter(f64, double, MPI_DOUBLE)
+
+make_Put(int8, char, MPI_SIGNED_CHAR)
+make_Put(uint8, unsigned char, MPI_UNSIGNED_CHAR)
+make_Put(int16, short, MPI_SHORT)
+make_Put(uint16, unsigned short, MPI_UNSIGNED_SHORT)
+make_Put(int32, int, MPI_INT)
+make_Put(uint32, unsigned int, MPI_UNSIGNED)
+make_Put(int64, long, MPI_LONG)
+make_Put(uint64, unsigned long, MPI_UNSIGNED_LONG)
+make_Put(f32, float, MPI_FLOAT)
+make_Put(f64, double, MPI_DOUBLE)
+
+make_Get(int8, char, MPI_SIGNED_CHAR)
+make_Get(uint8, unsigned char, MPI_UNSIGNED_CHAR)
+make_Get(int16, short, MPI_SHORT)
+make_Get(uint16, unsigned short, MPI_UNSIGNED_SHORT)
+make_Get(int32, int, MPI_INT)
+make_Get(uint32, unsigned int, MPI_UNSIGNED)
+make_Get(int64, long, MPI_LONG)
+make_Get(uint64, unsigned long, MPI_UNSIGNED_LONG)
+make_Get(f32, float, MPI_FLOAT)
+make_Get(f64, double, MPI_DOUBLE)
+
 }
 
 #endif
@@ -0,0 +1,795 @@
+#include <tiramisu/onnx.h>
+#include <tiramisu/contraction.h>
+#include <tiramisu/convolution.h>
+#include <tiramisu/debug.h>
+
+#include <onnx/onnx_pb.h>
+#include <onnx/shape_inference/implementation.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <set>
+
+namespace tiramisu {
+
+namespace {
+
+const onnx::AttributeProto *find_attribute(const onnx::NodeProto &node, const std::string &name)
+{
+    for (const onnx::AttributeProto &attribute : node.attribute())
+        if (attribute.name() == name)
+            return &attribute;
+    return nullptr;
+}
+
+int64_t get_int(const onnx::NodeProto &node, const std::string &name, int64_t default_value)
+{
+    const onnx::AttributeProto *attribute = find_attribute(node, name);
+    return (attribute != nullptr) ? attribute->i() : default_value;
+}
+
+float get_float(const onnx::NodeProto &node, const std::string &name, float default_value)
+{
+    const onnx::AttributeProto *attribute = find_attribute(node, name);
+    return (attribute != nullptr) ? attribute->f() : default_value;
+}
+
+std::string get_string(const onnx::NodeProto &node, const std::string &name, const std::string &default_value)
+{
+    const onnx::AttributeProto *attribute = find_attribute(node, name);
+    return (attribute != nullptr) ? attribute->s() : default_value;
+}
+
+std::vector<int> get_ints(const onnx::NodeProto &node, const std::string &name, const std::vector<int> &default_value)
+{
+    const onnx::AttributeProto *attribute = find_attribute(node, name);
+    if (attribute == nullptr)
+        return default_value;
+    return std::vector<int>(attribute->ints().begin(), attribute->ints().end());
+}
+
+tiramisu::primitive_t type_from_onnx_type(int type)
+{
+    switch (type)
+    {
+    case onnx::TensorProto_DataType_FLOAT:
+        return p_float32;
+    case onnx::TensorProto_DataType_DOUBLE:
+        return p_float64;
+    default:
+        return p_none;
+    }
+}
+
+/**
+  * Return \p v as a constant of type \p type.
+  */
+tiramisu::expr value(tiramisu::primitive_t type, double v)
+{
+    if (type == p_float32)
+        return tiramisu::expr((float) v);
+    return tiramisu::expr(v);
+}
+
+tiramisu::expr sigmoid(tiramisu::primitive_t type, const tiramisu::expr &e)
+{
+    return value(type, 1) / (value(type, 1) + tiramisu::expr(o_expo, -e));
+}
+
+/**
+  * Compute the padding before and after each spatial dimension of a
+  * convolution or pooling of \p node, from its pads and auto_pad attributes,
+  * so that the padded input has (output_size - 1) * stride + (kernel - 1) *
+  * dilation + 1 elements.
+  */
+void get_padding(const onnx::NodeProto &node, const std::vector<int> &input_size,
+                 const std::vector<int> &output_size, const std::vector<int> &kernel,
+                 const std::vector<int> &strides, const std::vector<int> &dilations,
+                 std::vector<int> &before, std::vector<int> &after)
+{
+    std::string auto_pad = get_string(node, "auto_pad", "NOTSET");
+    std::vector<int> pads = get_ints(node, "pads", {0, 0, 0, 0});
+
+    for (int d = 0; d < 2; d++)
+    {
+        int needed = (output_size[d] - 1) * strides[d] + (kernel[d] - 1) * dilations[d] + 1;
+        int total = std::max(needed - input_size[d], 0);
+
+        if (auto_pad == "SAME_UPPER")
+            before[d] = total / 2;
+        else if (auto_pad == "SAME_LOWER")
+            before[d] = total - total / 2;
+        else if (auto_pad == "VALID")
+            before[d] = 0;
+        else
+            before[d] = pads[d];
+
+        // Also covers ceil_mode, where the last window may go past the padding
+        after[d] = std::max(needed - input_size[d] - before[d], 0);
+    }
+}
+
+}
+
+onnx_model::onnx_model(const std::string &filename, const std::map<std::string, int> &dim_values, bool fuse)
+    : filename(filename)
+{
+    DEBUG_FCT_NAME(3);
+    DEBUG_INDENT(4);
+
+    onnx::ModelProto model;
+    std::ifstream file(filename, std::ios::binary);
+    if (!file || !model.ParseFromIstream(&file))
+        ERROR("Cannot read the ONNX model " + filename + ".", true);
+
+    onnx::GraphProto *graph = model.mutable_graph();
+    for (onnx::ValueInfoProto &value_info : *graph->mutable_input())
+        for (auto &dim : *value_info.mutable_type()->mutable_tensor_type()->mutable_shape()->mutable_dim())
+            if (dim.has_dim_param() && dim_values.count(dim.dim_param()) != 0)
+                dim.set_dim_value(dim_values.at(dim.dim_param()));
+
+    onnx::shape_inference::InferShapes(model);
+
+    auto record = [&](const onnx::ValueInfoProto &value_info) {
+        if (!value_info.type().has_tensor_type())
+            return;
+        const onnx::TypeProto_Tensor &tensor_type = value_info.type().tensor_type();
+        std::vector<int> shape;
+        for (const auto &dim : tensor_type.shape().dim())
+            shape.push_back(dim.has_dim_value() ? (int) dim.dim_value() : -1);
+        shapes[value_info.name()] = shape;
+        types[value_info.name()] = type_from_onnx_type(tensor_type.elem_type());
+    };
+    for (const onnx::ValueInfoProto &value_info : graph->input())
+        record(value_info);
+    for (const onnx::ValueInfoProto &value_info : graph->value_info())
+        record(value_info);
+    for (const onnx::ValueInfoProto &value_info : graph->output())
+        record(value_info);
+
+    // Inputs, initializers and outputs, in the order of the arguments
+    std::set<std::string> initializer_names;
+    for (const onnx::TensorProto &tensor : graph->initializer())
+        initializer_names.insert(tensor.name());
+
+    for (const onnx::ValueInfoProto &value_info : graph->input())
+        if (initializer_names.count(value_info.name()) == 0)
+        {
+            if (this->get_type(value_info.name()) == p_none)
+                ERROR("The input " + value_info.name() + " of the ONNX model " + filename +
+                      " is not a float or double tensor.", true);
+            arguments.push_back(this->get_buffer(value_info.name(), a_input));
+        }
+
+    for (const onnx::TensorProto &tensor : graph->initializer())
+    {
+        tiramisu::primitive_t type = type_from_onnx_type(tensor.data_type());
+        std::vector<int> shape(tensor.dims().begin(), tensor.dims().end());
+        shapes[tensor.name()] = shape;
+        types[tensor.name()] = type;
+
+        // Other initializers (e.g. the shapes of Reshape) are attributes in disguise
+        if (type == p_none)
+            continue;
+
+        if (tensor.data_location() == onnx::TensorProto_DataLocation_EXTERNAL)
+            ERROR("The initializer " + tensor.name() + " is stored in an external file, which is not supported.", true);
+
+        std::vector<char> &data = initializers[tensor.name()];
+        if (tensor.has_raw_data())
+            data.assign(tensor.raw_data().begin(), tensor.raw_data().end());
+        else if (type == p_float32)
+            data.assign((const char *) tensor.float_data().data(),
+                        (const char *) (tensor.float_data().data() + tensor.float_data_size()));
+        else
+            data.assign((const char *) tensor.double_data().data(),
+                        (const char *) (tensor.double_data().data() + tensor.double_data_size()));
+
+        arguments.push_back(this->get_buffer(tensor.name(), a_input));
+        arguments.back()->set_constant();
+    }
+
+    for (const onnx::ValueInfoProto &value_info : graph->output())
+        arguments.push_back(this->get_buffer(value_info.name(), a_output));
+
+    for (int i = 0; i < graph->node_size(); i++)
+    {
+        const onnx::NodeProto &node = graph->node(i);
+        const std::string &op = node.op_type();
+        std::string layer = node.name().empty() ? op + "_" + std::to_string(i) : node.name();
+        std::vector<std::string> in(node.input().begin(), node.input().end());
+        std::vector<std::string> out(node.output().begin(), node.output().end());
+
+        DEBUG(3, tiramisu::str_dump("Importing the node " + layer + " (" + op + ")"));
+
+        if (op == "Conv")
+            this->import_conv(layer, in, out, node);
+        else if (op == "Gemm" || op == "MatMul")
+            this->import_gemm(layer, in, out, node, op == "MatMul");
+        else if (op == "BatchNormalization")
+            this->import_batch_normalization(layer, in, out, node);
+        else if (op == "Relu" || op == "Sigmoid" || op == "Tanh" || op == "Identity" || op == "Dropout" ||
+                 op == "Add" || op == "Sub" || op == "Mul" || op == "Div")
+            this->import_elementwise(layer, op, in, out);
+        else if (op == "MaxPool" || op == "AveragePool" || op == "GlobalAveragePool")
+            this->import_pool(layer, op, in, out, node);
+        else if (op == "Flatten" || op == "Reshape")
+            this->import_reshape(layer, in, out);
+        else if (op == "LSTM")
+            this->import_lstm(layer, in, out, node);
+        else
+            ERROR("The operator " + op + " of the node " + layer + " is not supported.", true);
+    }
+
+    if (fuse && !computations.empty())
+        fusions = global::get_implicit_function()->fuse_producer_consumer_chains();
+
+    DEBUG(3, this->dump());
+
+    DEBUG_INDENT(-4);
+}
+
+std::string onnx_model::sanitize(const std::string &name)
+{
+    std::string result = name;
+    for (char &c : result)
+        if (!std::isalnum((unsigned char) c))
+            c = '_';
+    return result;
+}
+
+const std::vector<int> &onnx_model::get_shape(const std::string &tensor) const
+{
+    auto it = shapes.find(tensor);
+    if (it == shapes.end() || std::count(it->second.begin(), it->second.end(), -1) != 0)
+        ERROR("The shape of the tensor " + tensor + " is not known (the symbolic dimensions of the inputs can be " +
+              "set with dim_values).", true);
+    return it->second;
+}
+
+tiramisu::primitive_t onnx_model::get_type(const std::string &tensor) const
+{
+    auto it = types.find(tensor);
+    return (it == types.end()) ? p_none : it->second;
+}
+
+tiramisu::buffer *onnx_model::get_buffer(const std::string &tensor, tiramisu::argument_t argument)
+{
+    auto it = buffers.find(tensor);
+    if (it != buffers.end())
+        return it->second;
+
+    if (this->get_type(tensor) == p_none)
+        ERROR("The tensor " + tensor + " is not a float or double tensor.", true);
+
+    std::vector<tiramisu::expr> sizes;
+    for (int size : this->get_shape(tensor))
+        sizes.push_back(size);
+    if (sizes.empty())
+        sizes.push_back(1);
+
+    tiramisu::buffer *buf = new tiramisu::buffer("b_" + sanitize(tensor), sizes, this->get_type(tensor), argument);
+    buffers[tensor] = buf;
+    return buf;
+}
+
+tiramisu::buffer *onnx_model::create_temporary(const std::string &layer, const std::vector<int> &sizes,
+                                               tiramisu::primitive_t type)
+{
+    std::vector<tiramisu::expr> dims(sizes.begin(), sizes.end());
+    return new tiramisu::buffer("_" + sanitize(layer) + "_tmp_" + std::to_string(temporaries++), dims, type,
+                                a_temporary);
+}
+
+tiramisu::var onnx_model::make_var(const std::string &layer, const std::string &suffix, int size)
+{
+    return var(sanitize(layer) + "_" + suffix, 0, size);
+}
+
+tiramisu::expr onnx_model::access(tiramisu::buffer *buf, const std::vector<tiramisu::expr> &indices)
+{
+    auto it = inputs.find(buf);
+    if (it == inputs.end())
+    {
+        std::vector<tiramisu::var> iterators;
+        for (int d = 0; d < buf->get_n_dims(); d++)
+            iterators.push_back(var("_read_" + buf->get_name() + "_" + std::to_string(d), 0, buf->get_dim_sizes()[d]));
+
+        tiramisu::input *in = new tiramisu::input("_read_" + buf->get_name(), iterators, buf->get_elements_type());
+        in->store_in(buf);
+        it = inputs.insert({buf, in}).first;
+    }
+
+    return tiramisu::expr(tiramisu::o_access, it->second->get_name(), indices, buf->get_elements_type());
+}
+
+tiramisu::expr onnx_model::broadcast_access(const std::string &tensor, const std::vector<tiramisu::var> &indices)
+{
+    const std::vector<int> &shape = this->get_shape(tensor);
+    if (shape.size() > indices.size())
+        ERROR("The tensor " + tensor + " cannot be broadcast to the output of its operator.", true);
+
+    // The dimensions are aligned from the innermost, those of size 1 are broadcast
+    std::vector<tiramisu::expr> accessed;
+    int offset = indices.size() - shape.size();
+    for (int d = 0; d < (int) shape.size(); d++)
+        accessed.push_back((shape[d] == 1) ? tiramisu::expr(0) : tiramisu::expr(indices[offset + d]));
+    if (accessed.empty())
+        accessed.push_back(0);
+
+    return this->access(this->get_buffer(tensor, a_temporary), accessed);
+}
+
+void onnx_model::add_computation(const std::string &layer, tiramisu::computation *comp, int level)
+{
+    // The computations of the builders are already ordered after each other
+    if (!computations.empty() && comp->get_predecessor() == nullptr)
+        computations.back()->then(*comp, level);
+    computations.push_back(comp);
+    layers[layer].push_back(comp);
+}
+
+tiramisu::computation *onnx_model::add_computation(const std::string &layer, const std::vector<tiramisu::var> &iterators,
+                                                   const tiramisu::expr &e, tiramisu::buffer *buf,
+                                                   const std::vector<tiramisu::expr> &mapping, int level,
+                                                   const tiramisu::expr &predicate)
+{
+    std::string comp_name = sanitize(layer) + "_" + std::to_string(layers[layer].size());
+    tiramisu::computation *comp = predicate.is_defined() ?
+                                  new tiramisu::computation(comp_name, iterators, predicate, e) :
+                                  new tiramisu::computation(comp_name, iterators, e);
+    comp->store_in(buf, mapping);
+    this->add_computation(layer, comp, level);
+    return comp;
+}
+
+tiramisu::computation *onnx_model::add_update(const std::string &layer, const std::vector<tiramisu::var> &iterators,
+                                              const tiramisu::expr &e, tiramisu::buffer *buf,
+                                              const std::vector<tiramisu::expr> &mapping, int level,
+                                              tiramisu::op_t op)
+{
+    tiramisu::primitive_t type = buf->get_elements_type();
+    tiramisu::computation *update = new tiramisu::computation(sanitize(layer) + "_" +
+                                                              std::to_string(layers[layer].size()),
+                                                              iterators, type);
+    std::vector<tiramisu::expr> self(iterators.begin(), iterators.end());
+    tiramisu::expr previous(tiramisu::o_access, update->get_name(), self, type);
+    update->set_expression((op == o_max) ? tiramisu::expr(o_max, previous, e) : previous + e);
+    update->store_in(buf, mapping);
+    this->add_computation(layer, update, level);
+    return update;
+}
+
+tiramisu::buffer *onnx_model::pad(const std::string &layer, tiramisu::buffer *buf, const std::vector<int> &before,
+                                  const std::vector<int> &after, double fill)
+{
+    if (before[0] == 0 && before[1] == 0 && after[0] == 0 && after[1] == 0)
+        return buf;
+
+    std::vector<int> sizes;
+    for (auto &size : buf->get_dim_sizes())
+        sizes.push_back(size.get_int_val());
+    int height = sizes[2], width = sizes[3];
+    sizes[2] += before[0] + after[0];
+    sizes[3] += before[1] + after[1];
+
+    tiramisu::primitive_t type = buf->get_elements_type();
+    tiramisu::buffer *padded = this->create_temporary(layer, sizes, type);
+    tiramisu::var n = make_var(layer, "pad_n", sizes[0]), c = make_var(layer, "pad_c", sizes[1]);
+    tiramisu::var y = make_var(layer, "pad_y", sizes[2]), x = make_var(layer, "pad_x", sizes[3]);
+    tiramisu::var iy = make_var(layer, "pad_iy", height), ix = make_var(layer, "pad_ix", width);
+
+    this->add_computation(layer, {n, c, y, x}, value(type, fill), padded, {n, c, y, x});
+    this->add_computation(layer, {n, c, iy, ix}, this->access(buf, {n, c, iy, ix}), padded,
+                          {n, c, iy + before[0], ix + before[1]});
+    return padded;
+}
+
+void onnx_model::import_conv(const std::string &layer, const std::vector<std::string> &in,
+                             const std::vector<std::string> &out, const onnx::NodeProto &node)
+{
+    const std::vector<int> &input_shape = this->get_shape(in[0]);
+    const std::vector<int> &weights_shape = this->get_shape(in[1]);
+    const std::vector<int> &output_shape = this->get_shape(out[0]);
+    if (input_shape.size() != 4)
+        ERROR("Only 2D convolutions are supported (node " + layer + ").", true);
+
+    int group = get_int(node, "group", 1);
+    int F = output_shape[1], Cg = weights_shape[1], KH = weights_shape[2], KW = weights_shape[3];
+    std::vector<int> strides = get_ints(node, "strides", {1, 1}), dilations = get_ints(node, "dilations", {1, 1});
+    std::vector<int> before(2), after(2);
+    get_padding(node, {input_shape[2], input_shape[3]}, {output_shape[2], output_shape[3]}, {KH, KW},
+                strides, dilations, before, after);
+
+    tiramisu::buffer *output = this->get_buffer(out[0], a_temporary);
+    tiramisu::buffer *weights = this->get_buffer(in[1], a_temporary);
+    tiramisu::buffer *input = this->pad(layer, this->get_buffer(in[0], a_temporary), before, after, 0);
+    bool has_bias = (in.size() > 2 && !in[2].empty());
+
+    tiramisu::var n = make_var(layer, "n", output_shape[0]), f = make_var(layer, "f", F);
+    tiramisu::var y = make_var(layer, "y", output_shape[2]), x = make_var(layer, "x", output_shape[3]);
+
+    if (group == 1 && strides[0] == 1 && strides[1] == 1 && dilations[0] == 1 && dilations[1] == 1 && KH == KW)
+    {
+        // The padded input and the output have the sizes expected by the builder
+        tiramisu::convolution *conv = new tiramisu::convolution(sanitize(layer) + "_conv", input, weights, output);
+        for (tiramisu::computation *comp : conv->get_computations())
+            this->add_computation(layer, comp);
+
+        if (has_bias)
+            this->add_update(layer, {n, f, y, x}, this->access(this->get_buffer(in[2], a_temporary), {f}),
+                             output, {n, f, y, x});
+        return;
+    }
+
+    // Groups, strides and dilations: a loop nest, with the output channels
+    // split into (group, channel in the group)
+    int Fg = F / group;
+    tiramisu::primitive_t type = output->get_elements_type();
+    tiramisu::var g = make_var(layer, "g", group), fg = make_var(layer, "fg", Fg);
+    tiramisu::var c = make_var(layer, "c", Cg), ky = make_var(layer, "ky", KH), kx = make_var(layer, "kx", KW);
+
+    tiramisu::expr init = has_bias ? this->access(this->get_buffer(in[2], a_temporary), {g * Fg + fg}) : value(type, 0);
+    this->add_computation(layer, {n, g, fg, y, x}, init, output, {n, g * Fg + fg, y, x});
+    this->add_update(layer, {n, g, fg, y, c, ky, kx, x},
+                     this->access(input, {n, g * Cg + c, y * strides[0] + ky * dilations[0],
+                                          x * strides[1] + kx * dilations[1]}) *
+                     this->access(weights, {g * Fg + fg, c, ky, kx}),
+                     output, {n, g * Fg + fg, y, x});
+}
+
+void onnx_model::import_gemm(const std::string &layer, const std::vector<std::string> &in,
+                             const std::vector<std::string> &out, const onnx::NodeProto &node, bool matmul)
+{
+    const std::vector<int> &a_shape = this->get_shape(in[0]);
+    const std::vector<int> &b_shape = this->get_shape(in[1]);
+    const std::vector<int> &output_shape = this->get_shape(out[0]);
+    tiramisu::buffer *output = this->get_buffer(out[0], a_temporary);
+
+    std::string spec;
+    if (matmul)
+    {
+        if (a_shape.size() != b_shape.size() || a_shape.size() < 2 || a_shape.size() > 4 ||
+            !std::equal(a_shape.begin(), a_shape.end() - 2, b_shape.begin()))
+            ERROR("MatMul is only supported for matrices with the same batch dimensions (node " + layer + ").", true);
+
+        std::string batch = std::string("abcd").substr(0, a_shape.size() - 2);
+        spec = batch + "mk," + batch + "kn->" + batch + "mn";
+    }
+    else
+        spec = std::string(get_int(node, "transA", 0) ? "km" : "mk") + "," +
+               (get_int(node, "transB", 0) ? "nk" : "kn") + "->mn";
+
+    tiramisu::contraction *gemm = new tiramisu::contraction(sanitize(layer) + "_gemm", spec,
+                                                            {this->get_buffer(in[0], a_temporary),
+                                                             this->get_buffer(in[1], a_temporary)},
+                                                            output);
+    for (tiramisu::computation *comp : gemm->get_computations())
+        this->add_computation(layer, comp);
+
+    if (matmul)
+        return;
+
+    float alpha = get_float(node, "alpha", 1), beta = get_float(node, "beta", 1);
+    bool has_c = (in.size() > 2 && !in[2].empty());
+    if (alpha == 1 && !has_c)
+        return;
+
+    tiramisu::primitive_t type = output->get_elements_type();
+    tiramisu::var m = make_var(layer, "m", output_shape[0]), n = make_var(layer, "n", output_shape[1]);
+    tiramisu::expr result = this->access(output, {m, n});
+    if (alpha != 1)
+        result = value(type, alpha) * result;
+    if (has_c)
+        result = result + value(type, beta) * this->broadcast_access(in[2], {m, n});
+    this->add_computation(layer, {m, n}, result, output, {m, n});
+}
+
+void onnx_model::import_batch_normalization(const std::string &layer, const std::vector<std::string> &in,
+                                            const std::vector<std::string> &out, const onnx::NodeProto &node)
+{
+    const std::vector<int> &shape = this->get_shape(out[0]);
+    tiramisu::buffer *output = this->get_buffer(out[0], a_temporary);
+    tiramisu::primitive_t type = output->get_elements_type();
+
+    if (out.size() > 1 && !out[1].empty())
+        ERROR("Only the inference mode of BatchNormalization is supported (node " + layer + ").", true);
+
+    // The parameters are folded into a scale and a shift per channel, which
+    // only depend on the initializers (see function::codegen_with_init())
+    tiramisu::var c = make_var(layer, "c", shape[1]);
+    tiramisu::buffer *scale = this->create_temporary(layer, {shape[1]}, type);
+    tiramisu::expr epsilon = value(type, get_float(node, "epsilon", 1e-5f));
+    this->add_computation(layer, {c}, this->access(this->get_buffer(in[1], a_temporary), {c}) /
+                                      tiramisu::expr(o_sqrt, this->access(this->get_buffer(in[4], a_temporary), {c}) +
+                                                             epsilon),
+                          scale, {c});
+    tiramisu::buffer *shift = this->create_temporary(layer, {shape[1]}, type);
+    this->add_computation(layer, {c}, this->access(this->get_buffer(in[2], a_temporary), {c}) -
+                                      this->access(this->get_buffer(in[3], a_temporary), {c}) *
+                                      this->access(scale, {c}),
+                          shift, {c});
+
+    std::vector<tiramisu::var> iterators;
+    for (int d = 0; d < (int) shape.size(); d++)
+        iterators.push_back(make_var(layer, "d" + std::to_string(d), shape[d]));
+    std::vector<tiramisu::expr> indices(iterators.begin(), iterators.end());
+
+    this->add_computation(layer, iterators,
+                          this->access(this->get_buffer(in[0], a_temporary), indices) *
+                          this->access(scale, {iterators[1]}) + this->access(shift, {iterators[1]}),
+                          output, indices);
+}
+
+void onnx_model::import_elementwise(const std::string &layer, const std::string &op,
+                                    const std::vector<std::string> &in, const std::vector<std::string> &out)
+{
+    const std::vector<int> &shape = this->get_shape(out[0]);
+    tiramisu::buffer *output = this->get_buffer(out[0], a_temporary);
+    tiramisu::primitive_t type = output->get_elements_type();
+
+    if (out.size() > 1 && !out[1].empty())
+        ERROR("The mask of Dropout is not supported (node " + layer + ").", true);
+
+    std::vector<tiramisu::var> iterators;
+    for (int d = 0; d < (int) shape.size(); d++)
+        iterators.push_back(make_var(layer, "d" + std::to_string(d), shape[d]));
+    std::vector<tiramisu::expr> indices(iterators.begin(), iterators.end());
+    if (indices.empty())
+    {
+        iterators.push_back(make_var(layer, "d0", 1));
+        indices.push_back(0);
+    }
+
+    tiramisu::expr a = this->broadcast_access(in[0], iterators), result;
+    if (op == "Relu")
+        result = tiramisu::expr(o_max, a, value(type, 0));
+    else if (op == "Sigmoid")
+        result = sigmoid(type, a);
+    else if (op == "Tanh")
+        result = tiramisu::expr(o_tanh, a);
+    else if (op == "Identity" || op == "Dropout")
+        result = a;
+    else
+    {
+        tiramisu::expr b = this->broadcast_access(in[1], iterators);
+        if (op == "Add")
+            result = a + b;
+        else if (op == "Sub")
+            result = a - b;
+        else if (op == "Mul")
+            result = a * b;
+        else
+            result = a / b;
+    }
+
+    this->add_computation(layer, iterators, result, output, indices);
+}
+
+void onnx_model::import_pool(const std::string &layer, const std::string &op, const std::vector<std::string> &in,
+                             const std::vector<std::string> &out, const onnx::NodeProto &node)
+{
+    const std::vector<int> &input_shape = this->get_shape(in[0]);
+    const std::vector<int> &output_shape = this->get_shape(out[0]);
+    if (input_shape.size() != 4)
+        ERROR("Only 2D pooling is supported (node " + layer + ").", true);
+
+    tiramisu::buffer *output = this->get_buffer(out[0], a_temporary);
+    tiramisu::buffer *input = this->get_buffer(in[0], a_temporary);
+    tiramisu::primitive_t type = output->get_elements_type();
+    int H = input_shape[2], W = input_shape[3];
+
+    tiramisu::var n = make_var(layer, "n", output_shape[0]), c = make_var(layer, "c", output_shape[1]);
+    tiramisu::var y = make_var(layer, "y", output_shape[2]), x = make_var(layer, "x", output_shape[3]);
+
+    if (op == "GlobalAveragePool")
+    {
+        tiramisu::var h = make_var(layer, "h", H), w = make_var(layer, "w", W);
+        this->add_computation(layer, {n, c}, value(type, 0), output, {n, c, 0, 0});
+        this->add_update(layer, {n, c, h, w}, this->access(input, {n, c, h, w}), output, {n, c, 0, 0});
+        this->add_computation(layer, {n, c}, this->access(output, {n, c, 0, 0}) * value(type, 1.0 / (H * W)),
+                              output, {n, c, 0, 0});
+        return;
+    }
+
+    std::vector<int> kernel = get_ints(node, "kernel_shape", {1, 1}), strides = get_ints(node, "strides", {1, 1});
+    if (get_ints(node, "dilations", {1, 1}) != std::vector<int>({1, 1}))
+        ERROR("Dilated pooling is not supported (node " + layer + ").", true);
+
+    std::vector<int> before(2), after(2);
+    get_padding(node, {H, W}, {output_shape[2], output_shape[3]}, kernel, strides, {1, 1}, before, after);
+
+    bool max = (op == "MaxPool");
+    double lowest = (type == p_float32) ? -std::numeric_limits<float>::max() : -std::numeric_limits<double>::max();
+    tiramisu::buffer *padded = this->pad(layer, input, before, after, max ? lowest : 0);
+    tiramisu::var ky = make_var(layer, "ky", kernel[0]), kx = make_var(layer, "kx", kernel[1]);
+
+    this->add_computation(layer, {n, c, y, x}, value(type, max ? lowest : 0), output, {n, c, y, x});
+    this->add_update(layer, {n, c, y, x, ky, kx},
+                     this->access(padded, {n, c, y * strides[0] + ky, x * strides[1] + kx}),
+                     output, {n, c, y, x}, computation::root_dimension, max ? o_max : o_add);
+
+    if (max)
+        return;
+
+    // The number of elements of each window, without the padding unless count_include_pad
+    tiramisu::expr count = kernel[0] * kernel[1];
+    if (!get_int(node, "count_include_pad", 0) && (before[0] || before[1] || after[0] || after[1]))
+    {
+        tiramisu::expr first_y = y * strides[0] - before[0], first_x = x * strides[1] - before[1];
+        count = (tiramisu::expr(o_min, first_y + kernel[0], H) - tiramisu::expr(o_max, first_y, 0)) *
+                (tiramisu::expr(o_min, first_x + kernel[1], W) - tiramisu::expr(o_max, first_x, 0));
+    }
+    this->add_computation(layer, {n, c, y, x}, this->access(output, {n, c, y, x}) / cast(type, count),
+                          output, {n, c, y, x});
+}
+
+void onnx_model::import_reshape(const std::string &layer, const std::vector<std::string> &in,
+                                const std::vector<std::string> &out)
+{
+    const std::vector<int> &input_shape = this->get_shape(in[0]);
+    const std::vector<int> &output_shape = this->get_shape(out[0]);
+
+    std::vector<tiramisu::var> iterators;
+    for (int d = 0; d < (int) input_shape.size(); d++)
+        iterators.push_back(make_var(layer, "d" + std::to_string(d), input_shape[d]));
+    std::vector<tiramisu::expr> indices(iterators.begin(), iterators.end());
+
+    // Each dimension of the output must be a group of consecutive dimensions
+    // of the input, whose linearized index is affine
+    std::vector<tiramisu::expr> mapping;
+    size_t d = 0;
+    for (int size : output_shape)
+    {
+        tiramisu::expr index = 0;
+        int64_t product = 1;
+        for (bool first = true; product < size && d < input_shape.size(); d++, first = false)
+        {
+            index = first ? tiramisu::expr(iterators[d]) : index * input_shape[d] + iterators[d];
+            product *= input_shape[d];
+        }
+        if (product != size)
+            ERROR("Reshape is only supported when it merges consecutive dimensions (node " + layer + ").", true);
+        mapping.push_back(index);
+    }
+
+    this->add_computation(layer, iterators, this->access(this->get_buffer(in[0], a_temporary), indices),
+                          this->get_buffer(out[0], a_temporary), mapping);
+}
+
+void onnx_model::import_lstm(const std::string &layer, const std::vector<std::string> &in,
+                             const std::vector<std::string> &out, const onnx::NodeProto &node)
+{
+    auto has = [](const std::vector<std::string> &names, size_t i) { return names.size() > i && !names[i].empty(); };
+
+    if (get_string(node, "direction", "forward") != "forward" || get_int(node, "layout", 0) != 0 ||
+        find_attribute(node, "clip") != nullptr || get_int(node, "input_forget", 0) != 0 || has(in, 4) || has(in, 7))
+        ERROR("Only forward LSTMs without sequence_lens, clipping, peepholes or coupled gates are supported (node " +
+              layer + ").", true);
+
+    const onnx::AttributeProto *activations = find_attribute(node, "activations");
+    if (activations != nullptr &&
+        (activations->strings_size() != 3 || activations->strings(0) != "Sigmoid" ||
+         activations->strings(1) != "Tanh" || activations->strings(2) != "Tanh"))
+        ERROR("Only the default activations of LSTM are supported (node " + layer + ").", true);
+
+    const std::vector<int> &x_shape = this->get_shape(in[0]);
+    int S = x_shape[0], B = x_shape[1], I = x_shape[2];
+    int H = get_int(node, "hidden_size", this->get_shape(in[2])[2]);
+    tiramisu::primitive_t type = this->get_type(in[0]);
+
+    tiramisu::buffer *x_buf = this->get_buffer(in[0], a_temporary);
+    tiramisu::buffer *w_buf = this->get_buffer(in[1], a_temporary), *r_buf = this->get_buffer(in[2], a_temporary);
+
+    // h and c at each time step, the initial state at 0; the gates (i, o, f, c)
+    tiramisu::buffer *h_buf = this->create_temporary(layer, {S + 1, B, H}, type);
+    tiramisu::buffer *c_buf = this->create_temporary(layer, {S + 1, B, H}, type);
+    tiramisu::buffer *gates = this->create_temporary(layer, {S, B, 4 * H}, type);
+
+    tiramisu::var t = make_var(layer, "t", S), b = make_var(layer, "b", B), j = make_var(layer, "j", H);
+    tiramisu::var g = make_var(layer, "g", 4 * H), k = make_var(layer, "k", I), kh = make_var(layer, "kh", H);
+
+    this->add_computation(layer, {b, j}, has(in, 5) ? this->access(this->get_buffer(in[5], a_temporary), {0, b, j}) :
+                                                      value(type, 0), h_buf, {0, b, j});
+    this->add_computation(layer, {b, j}, has(in, 6) ? this->access(this->get_buffer(in[6], a_temporary), {0, b, j}) :
+                                                      value(type, 0), c_buf, {0, b, j});
+
+    // The projections of the inputs do not depend on the recurrence: they
+    // are computed for all the time steps first
+    tiramisu::expr bias = value(type, 0);
+    if (has(in, 3))
+    {
+        tiramisu::buffer *b_buf = this->get_buffer(in[3], a_temporary);
+        bias = this->access(b_buf, {0, g}) + this->access(b_buf, {0, g + 4 * H});
+    }
+    this->add_computation(layer, {t, b, g}, bias, gates, {t, b, g});
+    this->add_update(layer, {t, b, g, k}, this->access(w_buf, {0, g, k}) * this->access(x_buf, {t, b, k}),
+                     gates, {t, b, g}, 2);
+
+    // The recurrence
+    this->add_update(layer, {t, b, g, kh}, this->access(r_buf, {0, g, kh}) * this->access(h_buf, {t, b, kh}),
+                     gates, {t, b, g});
+    tiramisu::expr input_gate = sigmoid(type, this->access(gates, {t, b, j}));
+    tiramisu::expr output_gate = sigmoid(type, this->access(gates, {t, b, j + H}));
+    tiramisu::expr forget_gate = sigmoid(type, this->access(gates, {t, b, j + 2 * H}));
+    tiramisu::expr cell_gate = tiramisu::expr(o_tanh, this->access(gates, {t, b, j + 3 * H}));
+    this->add_computation(layer, {t, b, j}, forget_gate * this->access(c_buf, {t, b, j}) + input_gate * cell_gate,
+                          c_buf, {t + 1, b, j}, 0);
+    this->add_computation(layer, {t, b, j}, output_gate * tiramisu::expr(o_tanh, this->access(c_buf, {t + 1, b, j})),
+                          h_buf, {t + 1, b, j}, 0);
+
+    if (has(out, 0))
+        this->add_computation(layer, {t, b, j}, this->access(h_buf, {t + 1, b, j}),
+                              this->get_buffer(out[0], a_temporary), {t, 0, b, j});
+    if (has(out, 1))
+        this->add_computation(layer, {b, j}, this->access(h_buf, {S, b, j}),
+                              this->get_buffer(out[1], a_temporary), {0, b, j});
+    if (has(out, 2))
+        this->add_computation(layer, {b, j}, this->access(c_buf, {S, b, j}),
+                              this->get_buffer(out[2], a_temporary), {0, b, j});
+}
+
+const std::vector<tiramisu::buffer *> &onnx_model::get_arguments() const
+{
+    return arguments;
+}
+
+tiramisu::buffer *onnx_model::get_buffer(const std::string &tensor) const
+{
+    auto it = buffers.find(tensor);
+    if (it == buffers.end())
+        ERROR("The ONNX model " + filename + " does not have a tensor " + tensor + ".", true);
+    return it->second;
+}
+
+const std::vector<char> &onnx_model::get_initializer_data(const std::string &tensor) const
+{
+    auto it = initializers.find(tensor);
+    if (it == initializers.end())
+        ERROR("The ONNX model " + filename + " does not have an initializer " + tensor + ".", true);
+    return it->second;
+}
+
+const std::vector<tiramisu::computation *> &onnx_model::get_layer(const std::string &node) const
+{
+    auto it = layers.find(node);
+    if (it == layers.end())
+        ERROR("The ONNX model " + filename + " does not have a node " + node + ".", true);
+    return it->second;
+}
+
+const std::vector<tiramisu::computation *> &onnx_model::get_computations() const
+{
+    return computations;
+}
+
+const std::vector<tiramisu::fusion_info> &onnx_model::get_fusions() const
+{
+    return fusions;
+}
+
+void onnx_model::dump() const
+{
+    std::cout << "ONNX model " << filename << ":" << std::endl;
+    for (auto &layer : layers)
+    {
+        std::cout << "    " << layer.first << ":";
+        for (tiramisu::computation *comp : layer.second)
+            std::cout << " " << comp->get_name();
+        std::cout << std::endl;
+    }
+
+    double saved_bytes = 0;
+    for (auto &fusion : fusions)
+    {
+        std::cout << "    Fused " << fusion.consumer->get_name() << " with " << fusion.producer->get_name()
+                  << " at level " << fusion.level << " (" << fusion.saved_bytes << " bytes saved)" << std::endl;
+        saved_bytes += fusion.saved_bytes;
+    }
+    std::cout << "    Memory traffic saved by the fusions: " << saved_bytes << " bytes" << std::endl;
+}
+
+}
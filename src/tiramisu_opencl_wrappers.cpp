@@ -0,0 +1,232 @@
+#define CL_TARGET_OPENCL_VERSION 200
+#include <CL/cl.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The runtime of the code generated for arch_opencl_gpu (see
+// function::gen_opencl_stmt()).  It implements the tiramisu_cuda_* functions
+// called by the host code of the GPU computations on an OpenCL 2.0 device,
+// with shared virtual memory (SVM) for the GPU buffers, so that the GPU
+// pointers of the generated code are kept as they are.
+
+namespace {
+    inline void handle_opencl_error(cl_int e, const std::string & function_name)
+    {
+        if (e != CL_SUCCESS)
+        {
+            std::cerr << "Error at " << function_name << ": OpenCL error " << e << std::endl;
+            exit(1);
+        }
+    }
+
+    struct opencl_device
+    {
+        cl_platform_id platform;
+        cl_device_id device;
+        cl_context context;
+        cl_command_queue queue;
+    };
+
+    // The first GPU of the first platform that has one (the first device of
+    // any type otherwise).  TIRAMISU_OPENCL_PLATFORM selects another platform.
+    opencl_device & get_device()
+    {
+        static std::once_flag initialized;
+        static opencl_device d;
+        std::call_once(initialized, [] {
+            cl_uint nb_platforms = 0;
+            handle_opencl_error(clGetPlatformIDs(0, nullptr, &nb_platforms), "clGetPlatformIDs");
+            if (nb_platforms == 0)
+            {
+                std::cerr << "Error: no OpenCL platform" << std::endl;
+                exit(1);
+            }
+            std::vector<cl_platform_id> platforms(nb_platforms);
+            handle_opencl_error(clGetPlatformIDs(nb_platforms, platforms.data(), nullptr), "clGetPlatformIDs");
+
+            cl_uint first = 0;
+            if (const char * env = std::getenv("TIRAMISU_OPENCL_PLATFORM"))
+                first = std::min<cl_uint>(std::atoi(env), nb_platforms - 1);
+
+            bool found = false;
+            for (cl_device_type type : {(cl_device_type) CL_DEVICE_TYPE_GPU, (cl_device_type) CL_DEVICE_TYPE_ALL})
+                for (cl_uint p = first; p < nb_platforms && !found; p++)
+                    if (clGetDeviceIDs(platforms[p], type, 1, &d.device, nullptr) == CL_SUCCESS)
+                    {
+                        d.platform = platforms[p];
+                        found = true;
+                    }
+            if (!found)
+            {
+                std::cerr << "Error: no OpenCL device" << std::endl;
+                exit(1);
+            }
+
+            cl_int e;
+            d.context = clCreateContext(nullptr, 1, &d.device, nullptr, nullptr, &e);
+            handle_opencl_error(e, "clCreateContext");
+            d.queue = clCreateCommandQueueWithProperties(d.context, d.device, nullptr, &e);
+            handle_opencl_error(e, "clCreateCommandQueueWithProperties");
+        });
+        return d;
+    }
+
+    std::mutex kernels_mutex;
+    // The programs built from the sources of the generated files, and their
+    // kernels, indexed by <source, kernel name>
+    std::map<const char *, cl_program> programs;
+    std::map<std::pair<const char *, std::string>, cl_kernel> kernels;
+
+    cl_kernel get_kernel(const char * source, const char * name)
+    {
+        auto found = kernels.find({source, name});
+        if (found != kernels.end())
+            return found->second;
+
+        opencl_device & d = get_device();
+        cl_int e;
+        auto program = programs.find(source);
+        if (program == programs.end())
+        {
+            cl_program p = clCreateProgramWithSource(d.context, 1, &source, nullptr, &e);
+            handle_opencl_error(e, "clCreateProgramWithSource");
+            if (clBuildProgram(p, 1, &d.device, "-cl-std=CL2.0", nullptr, nullptr) != CL_SUCCESS)
+            {
+                size_t log_size = 0;
+                clGetProgramBuildInfo(p, d.device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &log_size);
+                std::string log(log_size, '\0');
+                clGetProgramBuildInfo(p, d.device, CL_PROGRAM_BUILD_LOG, log_size, &log[0], nullptr);
+                std::cerr << "Error at clBuildProgram:" << std::endl << log << std::endl;
+                exit(1);
+            }
+            program = programs.insert({source, p}).first;
+        }
+
+        cl_kernel k = clCreateKernel(program->second, name, &e);
+        handle_opencl_error(e, "clCreateKernel");
+        kernels[{source, name}] = k;
+        return k;
+    }
+}
+
+extern "C"
+void * tiramisu_cuda_malloc(uint64_t size)
+{
+    void * ptr = clSVMAlloc(get_device().context, CL_MEM_READ_WRITE, size, 0);
+    if (ptr == nullptr && size != 0)
+    {
+        std::cerr << "Error at " << __FUNCTION__ << ": cannot allocate " << size << " bytes" << std::endl;
+        exit(1);
+    }
+    return ptr;
+}
+
+/**
+ * Shared virtual memory is already accessible from the host: the advice and
+ * the prefetches of managed memory (see buffer::set_gpu_managed()) are
+ * ignored.
+ */
+extern "C"
+void * tiramisu_cuda_malloc_managed(uint64_t size, int32_t advice)
+{
+    return tiramisu_cuda_malloc(size);
+}
+
+extern "C"
+int tiramisu_cuda_prefetch_to_device(void * ptr, uint64_t size, int32_t stream)
+{
+    return 0;
+}
+
+extern "C"
+int tiramisu_cuda_free(void * ptr)
+{
+    // The kernels using the buffer may still be running
+    handle_opencl_error(clFinish(get_device().queue), "clFinish");
+    clSVMFree(get_device().context, ptr);
+    return 0;
+}
+
+extern "C"
+void * tiramisu_cuda_offset_pointer(void * ptr, uint64_t offset)
+{
+    return static_cast<char *>(ptr) + offset;
+}
+
+extern "C"
+int tiramisu_cuda_memcpy_to_device(void * to, void * from, uint64_t size)
+{
+    handle_opencl_error(clEnqueueSVMMemcpy(get_device().queue, CL_TRUE, to, from, size, 0, nullptr, nullptr), __FUNCTION__);
+    return 0;
+}
+
+extern "C"
+int tiramisu_cuda_memcpy_to_host(void * to, void * from, uint64_t size)
+{
+    handle_opencl_error(clEnqueueSVMMemcpy(get_device().queue, CL_TRUE, to, from, size, 0, nullptr, nullptr), __FUNCTION__);
+    return 0;
+}
+
+/**
+ * The copies and the kernels are all in the in-order queue of the device:
+ * the asynchronous copies are ordered like the copies of the stream 0 of CUDA,
+ * \p stream is ignored.
+ */
+extern "C"
+int tiramisu_cuda_memcpy_to_device_async(void * to, void * from, uint64_t size, int32_t stream)
+{
+    handle_opencl_error(clEnqueueSVMMemcpy(get_device().queue, CL_FALSE, to, from, size, 0, nullptr, nullptr), __FUNCTION__);
+    return 0;
+}
+
+extern "C"
+int tiramisu_cuda_memcpy_to_host_async(void * to, void * from, uint64_t size, int32_t stream)
+{
+    handle_opencl_error(clEnqueueSVMMemcpy(get_device().queue, CL_FALSE, to, from, size, 0, nullptr, nullptr), __FUNCTION__);
+    return 0;
+}
+
+extern "C"
+int32_t tiramisu_cuda_stream_synchronize(int32_t dummy)
+{
+    handle_opencl_error(clFinish(get_device().queue), "clFinish");
+    return 0;
+}
+
+/**
+ * Launch the kernel \p kernel of the OpenCL C source \p source on
+ * blocks[0] x blocks[1] x blocks[2] work-groups of threads[0] x threads[1] x
+ * threads[2] work-items.  The program is built the first time one of its
+ * kernels is launched.  The buffers of \p arguments (is_buffer[i] != 0) are
+ * SVM pointers, the other arguments point to scalars of sizes[i] bytes.
+ */
+extern "C"
+int32_t tiramisu_opencl_launch(const char * source, const char * kernel, const size_t * blocks,
+                               const size_t * threads, int32_t nb_arguments, void ** arguments,
+                               const size_t * sizes, const int32_t * is_buffer)
+{
+    std::lock_guard<std::mutex> lock(kernels_mutex);
+    cl_kernel k = get_kernel(source, kernel);
+
+    for (int32_t i = 0; i < nb_arguments; i++)
+    {
+        if (is_buffer[i])
+            handle_opencl_error(clSetKernelArgSVMPointer(k, i, arguments[i]), "clSetKernelArgSVMPointer");
+        else
+            handle_opencl_error(clSetKernelArg(k, i, sizes[i], arguments[i]), "clSetKernelArg");
+    }
+
+    size_t global[3];
+    for (int i = 0; i < 3; i++)
+        global[i] = blocks[i] * threads[i];
+    handle_opencl_error(clEnqueueNDRangeKernel(get_device().queue, k, 3, nullptr, global, threads, 0, nullptr, nullptr),
+                        "clEnqueueNDRangeKernel");
+    return 0;
+}
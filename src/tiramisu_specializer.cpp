@@ -0,0 +1,210 @@
+#include <tiramisu/specializer.h>
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tiramisu {
+
+/**
+ * The extents of the dimensions of each argument, the outermost first.
+ */
+static std::vector<std::vector<int>> get_shapes(void **arguments, int nb_arguments)
+{
+    std::vector<std::vector<int>> shapes(nb_arguments);
+    for (int i = 0; i < nb_arguments; i++)
+    {
+        const halide_buffer_t *buf = static_cast<const halide_buffer_t *>(arguments[i]);
+        for (int d = buf->dimensions - 1; d >= 0; d--)
+            shapes[i].push_back(buf->dim[d].extent);
+    }
+    return shapes;
+}
+
+specializer::specializer(const std::string &fct_name, int nb_arguments, declare_function_t declare,
+                         argv_function_t generic, const std::string &cache_dir)
+    : fct_name(fct_name), nb_arguments(nb_arguments), declare(declare), generic(generic), cache_dir(cache_dir)
+{
+    assert(!fct_name.empty());
+    assert(nb_arguments > 0);
+    assert(generic != nullptr);
+}
+
+specializer::~specializer()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->queue_not_empty.notify_all();
+    if (this->worker.joinable())
+        this->worker.join();
+
+    for (void *library : this->libraries)
+        dlclose(library);
+}
+
+void specializer::set_schedule_file(const std::string &filename)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->schedule_filename = filename;
+}
+
+std::string specializer::get_key(const std::vector<std::vector<int>> &shapes)
+{
+    std::string key;
+    for (size_t i = 0; i < shapes.size(); i++)
+    {
+        key += (i == 0 ? "" : "_");
+        for (size_t d = 0; d < shapes[i].size(); d++)
+            key += (d == 0 ? "" : "x") + std::to_string(shapes[i][d]);
+    }
+    return key;
+}
+
+int specializer::run(void **arguments)
+{
+    std::vector<std::vector<int>> shapes = get_shapes(arguments, this->nb_arguments);
+    std::string key = get_key(shapes);
+
+    argv_function_t version = this->generic;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto found = this->versions.find(key);
+        if (found != this->versions.end())
+            version = found->second;
+        else if (this->requested.insert(key).second)
+        {
+            this->queue.push_back({key, shapes});
+            if (!this->worker.joinable())
+                this->worker = std::thread(&specializer::compile_queued_versions, this);
+            this->queue_not_empty.notify_one();
+        }
+    }
+
+    return version(arguments);
+}
+
+bool specializer::is_specialized(void **arguments) const
+{
+    std::string key = get_key(get_shapes(arguments, this->nb_arguments));
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->versions.count(key) > 0;
+}
+
+void specializer::wait()
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->queue_empty.wait(lock, [this] { return this->queue.empty() && !this->compiling; });
+}
+
+void specializer::compile_queued_versions()
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (true)
+    {
+        this->queue_not_empty.wait(lock, [this] { return this->stopping || !this->queue.empty(); });
+        if (this->stopping)
+            break;
+
+        std::pair<std::string, std::vector<std::vector<int>>> next = this->queue.front();
+        this->queue.pop_front();
+        this->compiling = true;
+
+        lock.unlock();
+        argv_function_t version = this->compile(next.first, next.second);
+        lock.lock();
+
+        if (version != nullptr)
+            this->versions[next.first] = version;
+        this->compiling = false;
+        if (this->queue.empty())
+            this->queue_empty.notify_all();
+    }
+
+    this->compiling = false;
+    this->queue.clear();
+    this->queue_empty.notify_all();
+}
+
+specializer::argv_function_t specializer::load_library(const std::string &filename)
+{
+    void *library = dlopen(filename.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (library == nullptr)
+        return nullptr;
+
+    argv_function_t version = reinterpret_cast<argv_function_t>(dlsym(library, (this->fct_name + "_argv").c_str()));
+    if (version == nullptr)
+    {
+        dlclose(library);
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->libraries.push_back(library);
+    return version;
+}
+
+specializer::argv_function_t specializer::compile(const std::string &key, const std::vector<std::vector<int>> &shapes)
+{
+    std::string library_filename = this->cache_dir + "/" + this->fct_name + "_" + key + ".so";
+    if (!this->cache_dir.empty())
+    {
+        argv_function_t cached = this->load_library(library_filename);
+        if (cached != nullptr)
+            return cached;
+    }
+
+    std::string schedule;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        schedule = this->schedule_filename;
+    }
+
+    // The state of Tiramisu is per thread, the function is declared in the
+    // implicit function of this thread
+    tiramisu::init(this->fct_name);
+    std::vector<tiramisu::buffer *> arguments = this->declare(shapes);
+    tiramisu::function *fct = global::get_implicit_function();
+    if (!schedule.empty())
+        fct->apply_schedule_file(schedule);
+
+    if (this->cache_dir.empty())
+    {
+        Halide::Internal::JITModule module = fct->jit(arguments);
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->modules.push_back(module);
+        return reinterpret_cast<argv_function_t>(module.argv_function());
+    }
+
+    // The files are renamed once complete, for the other processes that use
+    // the same cache directory
+    mkdir(this->cache_dir.c_str(), 0755);
+    std::string tmp_prefix = this->cache_dir + "/." + this->fct_name + "_" + key + "_" + std::to_string(getpid());
+    fct->codegen(arguments, tmp_prefix + ".o");
+
+    const char *flags = std::getenv("TIRAMISU_SPECIALIZER_LDFLAGS");
+    std::string link_cmd = "g++ -shared -o " + tmp_prefix + ".so " + tmp_prefix + ".o " + (flags ? flags : "");
+    bool linked = (system(link_cmd.c_str()) == 0) && (rename((tmp_prefix + ".so").c_str(), library_filename.c_str()) == 0);
+    std::remove((tmp_prefix + ".o").c_str());
+
+    if (!linked)
+    {
+        std::remove((tmp_prefix + ".so").c_str());
+        std::cerr << "error: could not link the version of " << this->fct_name << " for the shapes " << key << std::endl;
+        return nullptr;
+    }
+
+    argv_function_t version = this->load_library(library_filename);
+    if (version == nullptr)
+        std::cerr << "error: could not load " << library_filename << std::endl;
+    return version;
+}
+
+}
@@ -1,8 +1,14 @@
 #include "tiramisu/utils.h"
 
+#include <cmath>
 #include <stdexcept>
 #include <iomanip>
 #include <fstream>
+#include <ctime>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
 
 using std::string;
 using std::vector;
@@ -36,6 +42,42 @@ string str_identation(int size)
     return ss.str();
 }
 
+string json_escape(const string &str)
+{
+    string escaped;
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        if (c != '\n' && c != '\t')
+            escaped += c;
+    }
+    return escaped;
+}
+
+// The machine on which the benchmarks run, as a JSON object
+string hardware_info_json()
+{
+    string cpu_model = "unknown";
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    string line;
+    while (std::getline(cpuinfo, line))
+        if (line.compare(0, 10, "model name") == 0 && line.find(':') != string::npos)
+        {
+            cpu_model = line.substr(line.find(':') + 2);
+            break;
+        }
+
+    char hostname[256] = "unknown";
+    gethostname(hostname, sizeof(hostname) - 1);
+
+    std::ostringstream info;
+    info << "{\"host\": \"" << json_escape(hostname) << "\", \"cpu\": \"" << json_escape(cpu_model)
+         << "\", \"hardware_threads\": " << std::thread::hardware_concurrency()
+         << ", \"HL_NUM_THREADS\": \"" << json_escape(getenv("HL_NUM_THREADS") ? getenv("HL_NUM_THREADS") : "") << "\"}";
+    return info.str();
+}
+
 void print_time(const string &file_name, const string &kernel_name,
                 const vector<string> &header_text,
                 const vector<double> &time_vector)
@@ -68,6 +110,104 @@ void print_time(const string &file_name, const string &kernel_name,
     std::cout << std::endl;
 
     file.close();
+
+    // One JSON object per line, read by benchmarks/compare_benchmarks.py
+    if (getenv("TIRAMISU_BENCHMARK_JSON"))
+    {
+        std::ofstream json(getenv("TIRAMISU_BENCHMARK_JSON"), std::ios::app);
+        json << std::setprecision(9);
+        json << "{\"kernel\": \"" << json_escape(kernel_name) << "\", \"timestamp\": " << std::time(nullptr)
+             << ", \"median_ms\": {";
+        for (size_t i = 0; i < time_vector.size(); i++)
+        {
+            string header = (i < header_text.size()) ? header_text[i] : "time_" + std::to_string(i);
+            json << (i > 0 ? ", " : "") << "\"" << json_escape(header) << "\": " << time_vector[i];
+        }
+        json << "}, \"hardware\": " << hardware_info_json() << "}" << std::endl;
+    }
+}
+
+vector<int> get_benchmark_sizes(const vector<int> &default_sizes)
+{
+    if (getenv("TIRAMISU_BENCHMARK_SIZES") == nullptr)
+        return default_sizes;
+
+    vector<int> sizes;
+    std::istringstream iss(getenv("TIRAMISU_BENCHMARK_SIZES"));
+    string size;
+    while (std::getline(iss, size, ','))
+        if (!size.empty())
+            sizes.push_back(std::stoi(size));
+
+    return sizes.empty() ? default_sizes : sizes;
+}
+
+namespace
+{
+    const double golden_ratio = 0.6180339887498949;
+}
+
+co_execution_tuner::co_execution_tuner(double tolerance) : tolerance(tolerance)
+{
+    this->restart();
+}
+
+void co_execution_tuner::restart()
+{
+    low = 0;
+    high = 1;
+    probe[0] = high - golden_ratio * (high - low);
+    probe[1] = low + golden_ratio * (high - low);
+    time[0] = time[1] = -1;
+    measured = 0;
+}
+
+bool co_execution_tuner::converged() const
+{
+    return high - low < tolerance;
+}
+
+double co_execution_tuner::get_gpu_share() const
+{
+    return converged() ? (low + high) / 2 : probe[measured];
+}
+
+int64_t co_execution_tuner::split(int64_t n) const
+{
+    return n - (int64_t) std::llround(get_gpu_share() * n);
+}
+
+void co_execution_tuner::report(double milliseconds)
+{
+    if (converged())
+        return;
+
+    time[measured] = milliseconds;
+    if (time[1 - measured] < 0)
+    {
+        measured = 1 - measured;
+        return;
+    }
+
+    // Keep the part of the interval around the fastest probe, whose time is reused
+    if (time[0] < time[1])
+    {
+        high = probe[1];
+        probe[1] = probe[0];
+        time[1] = time[0];
+        probe[0] = high - golden_ratio * (high - low);
+        time[0] = -1;
+        measured = 0;
+    }
+    else
+    {
+        low = probe[0];
+        probe[0] = probe[1];
+        time[0] = time[1];
+        probe[1] = low + golden_ratio * (high - low);
+        time[1] = -1;
+        measured = 1;
+    }
 }
 
 void combine_dist_results(const std::string &test, std::vector<int> dims, int num_ranks) {
@@ -0,0 +1,47 @@
+#include <tiramisu/tiramisu.h>
+
+#include "wrapper_test_200.h"
+
+using namespace tiramisu;
+
+/**
+ * Test unroll_and_jam() on a matrix multiplication, with a remainder
+ * (the extent of i is not a multiple of the unrolling factor).
+ */
+
+void generate_function(std::string name, int size)
+{
+    tiramisu::init(name);
+
+    // Algorithm
+    tiramisu::var i("i", 0, size), j("j", 0, size), k("k", 0, size);
+    tiramisu::input A("A", {i, k}, p_int32);
+    tiramisu::input B("B", {k, j}, p_int32);
+
+    tiramisu::computation C_init("C_init", {i, j}, tiramisu::expr((int32_t) 0));
+    tiramisu::computation C("C", {i, j, k}, p_int32);
+    C.set_expression(C(i, j, k) + A(i, k) * B(k, j));
+
+    // Schedule
+    C_init.then(C, computation::root);
+    C.unroll_and_jam(i, 4);
+
+    // Layer III
+    tiramisu::buffer buff_A("buff_A", {size, size}, tiramisu::p_int32, a_input);
+    tiramisu::buffer buff_B("buff_B", {size, size}, tiramisu::p_int32, a_input);
+    tiramisu::buffer buff_C("buff_C", {size, size}, tiramisu::p_int32, a_output);
+    A.store_in(&buff_A);
+    B.store_in(&buff_B);
+    C_init.store_in(&buff_C);
+    C.store_in(&buff_C, {i, j});
+
+    // Code generation
+    tiramisu::codegen({&buff_A, &buff_B, &buff_C}, "build/generated_fct_test_" + std::string(TEST_NUMBER_STR) + ".o");
+}
+
+int main(int argc, char **argv)
+{
+    generate_function("tiramisu_generated_code", SIZE1);
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <tiramisu/tiramisu.h>
+
+#include "wrapper_test_201.h"
+
+using namespace tiramisu;
+
+/**
+ * Test prefetch() on a matrix-vector multiplication.  The prefetches do
+ * not change the result, the addresses past the end of A are prefetched
+ * without being guarded.
+ */
+
+void generate_function(std::string name, int size0, int size1)
+{
+    tiramisu::init(name);
+
+    // Algorithm
+    tiramisu::var i("i", 0, size0), j("j", 0, size1);
+    tiramisu::input A("A", {i, j}, p_int32);
+    tiramisu::input x("x", {j}, p_int32);
+
+    tiramisu::computation y_init("y_init", {i}, tiramisu::expr((int32_t) 0));
+    tiramisu::computation y("y", {i, j}, p_int32);
+    y.set_expression(y(i, j) + A(i, j) * x(j));
+
+    // Layer III
+    tiramisu::buffer buff_A("buff_A", {size0, size1}, tiramisu::p_int32, a_input);
+    tiramisu::buffer buff_x("buff_x", {size1}, tiramisu::p_int32, a_input);
+    tiramisu::buffer buff_y("buff_y", {size0}, tiramisu::p_int32, a_output);
+    A.store_in(&buff_A);
+    x.store_in(&buff_x);
+    y_init.store_in(&buff_y);
+    y.store_in(&buff_y, {i});
+
+    // Schedule
+    y_init.then(y, i);
+    y.prefetch(buff_A, j, 8);
+
+    // Code generation
+    tiramisu::codegen({&buff_A, &buff_x, &buff_y}, "build/generated_fct_test_" + std::string(TEST_NUMBER_STR) + ".o");
+}
+
+int main(int argc, char **argv)
+{
+    generate_function("tiramisu_generated_code", SIZE0, SIZE1);
+
+    return 0;
+}
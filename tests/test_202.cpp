@@ -0,0 +1,63 @@
+#include <tiramisu/tiramisu.h>
+
+#include "wrapper_test_202.h"
+
+using namespace tiramisu;
+
+/**
+ * Test specialize(): the version of S0 specialized for N % 8 = 0 is split
+ * by 8 without a remainder loop.  The wrapper runs the generated code with
+ * an N that satisfies the condition and with an N that does not.
+ */
+
+void generate_function(std::string name)
+{
+    tiramisu::global::set_default_tiramisu_options();
+
+    // -------------------------------------------------------
+    // Layer I
+    // -------------------------------------------------------
+
+    tiramisu::function function0(name);
+    tiramisu::computation N_input("{N_input[0]}", tiramisu::expr(), false, p_int32, &function0);
+    tiramisu::constant N("N", N_input(0), p_int32, true, NULL, 0, &function0);
+    tiramisu::var i("i"), i0("i0"), i1("i1");
+    tiramisu::computation A("[N]->{A[i]: 0<=i<N}", tiramisu::expr(), false, p_int32, &function0);
+    tiramisu::computation S0("[N]->{S0[i]: 0<=i<N}", A(i) * 3 + 1, true, p_int32, &function0);
+
+    // -------------------------------------------------------
+    // Layer II
+    // -------------------------------------------------------
+
+    tiramisu::computation &S0_fast = S0.specialize("N % 8 = 0");
+    S0_fast.split(i, 8, i0, i1);
+
+    // -------------------------------------------------------
+    // Layer III
+    // -------------------------------------------------------
+
+    tiramisu::buffer N_input_b("N_input_b", {1}, tiramisu::p_int32, a_input, &function0);
+    tiramisu::buffer A_b("A_b", {SIZE}, tiramisu::p_int32, a_input, &function0);
+    tiramisu::buffer S0_b("S0_b", {SIZE}, tiramisu::p_int32, a_output, &function0);
+    N_input.store_in(&N_input_b);
+    A.store_in(&A_b);
+    S0.store_in(&S0_b);
+    S0_fast.store_in(&S0_b);
+
+    // -------------------------------------------------------
+    // Code Generation
+    // -------------------------------------------------------
+
+    function0.set_arguments({&N_input_b, &A_b, &S0_b});
+    function0.gen_time_space_domain();
+    function0.gen_isl_ast();
+    function0.gen_halide_stmt();
+    function0.gen_halide_obj("build/generated_fct_test_" + std::string(TEST_NUMBER_STR) + ".o");
+}
+
+int main(int argc, char **argv)
+{
+    generate_function("tiramisu_generated_code");
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <tiramisu/tiramisu.h>
+
+#include "wrapper_test_203.h"
+
+using namespace tiramisu;
+
+/**
+ * Test enable_full_tile_separation() with tile sizes that do not divide
+ * the extents of the loops, so that each loop nest has full and partial
+ * tiles.
+ */
+
+void generate_function(std::string name, int size0, int size1)
+{
+    tiramisu::init(name);
+
+    // Algorithm
+    tiramisu::var i("i", 0, size0), j("j", 0, size1);
+    tiramisu::var i0("i0"), j0("j0"), i1("i1"), j1("j1");
+    tiramisu::input A("A", {i, j}, p_int32);
+
+    tiramisu::computation S("S", {i, j}, A(i, j) * 2 + i - j);
+    tiramisu::computation T("T", {i, j}, S(i, j) + A(i, j));
+
+    // Schedule
+    S.then(T, computation::root);
+    S.tile(i, j, 4, 4, i0, j0, i1, j1);
+    T.tile(i, j, 3, 8, i0, j0, i1, j1);
+    tiramisu::global::get_implicit_function()->enable_full_tile_separation();
+
+    // Layer III
+    tiramisu::buffer buff_A("buff_A", {size0, size1}, tiramisu::p_int32, a_input);
+    tiramisu::buffer buff_S("buff_S", {size0, size1}, tiramisu::p_int32, a_temporary);
+    tiramisu::buffer buff_T("buff_T", {size0, size1}, tiramisu::p_int32, a_output);
+    A.store_in(&buff_A);
+    S.store_in(&buff_S);
+    T.store_in(&buff_T);
+
+    // Code generation
+    tiramisu::codegen({&buff_A, &buff_T}, "build/generated_fct_test_" + std::string(TEST_NUMBER_STR) + ".o");
+}
+
+int main(int argc, char **argv)
+{
+    generate_function("tiramisu_generated_code", SIZE0, SIZE1);
+
+    return 0;
+}
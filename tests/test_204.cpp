@@ -0,0 +1,68 @@
+#include <tiramisu/tiramisu.h>
+
+#include "wrapper_test_204.h"
+
+using namespace tiramisu;
+
+/**
+ * Test parallelize_reduction() with its three strategies: the rows of A
+ * are summed with privatized partial results and with atomic updates,
+ * and their maximum is computed with a tree of partial results.  The
+ * number of partial results does not divide the extent of the reduction.
+ */
+
+void generate_function(std::string name, int size0, int size1)
+{
+    tiramisu::init(name);
+
+    // Algorithm
+    tiramisu::var i("i", 0, size0), j("j", 0, size1);
+    tiramisu::input A("A", {i, j}, p_int32);
+
+    tiramisu::computation sum_init("sum_init", {i}, tiramisu::expr((int32_t) 0));
+    tiramisu::computation sum("sum", {i, j}, p_int32);
+    sum.set_expression(sum(i, j) + A(i, j));
+
+    tiramisu::computation maximum_init("maximum_init", {i}, tiramisu::expr((int32_t) -1000));
+    tiramisu::computation maximum("maximum", {i, j}, p_int32);
+    maximum.set_expression(tiramisu::expr(o_max, maximum(i, j), A(i, j)));
+
+    tiramisu::computation atomic_sum_init("atomic_sum_init", {i}, tiramisu::expr((int32_t) 0));
+    tiramisu::computation atomic_sum("atomic_sum", {i, j}, p_int32);
+    atomic_sum.set_expression(atomic_sum(i, j) + A(i, j));
+
+    // Schedule
+    sum_init.then(sum, i)
+            .then(maximum_init, computation::root)
+            .then(maximum, i)
+            .then(atomic_sum_init, computation::root)
+            .then(atomic_sum, i);
+
+    sum.parallelize_reduction(j, reduction_privatized, 8);
+    maximum.parallelize_reduction(j, reduction_tree, 8);
+    atomic_sum.parallelize_reduction(j, reduction_atomic);
+
+    // Layer III
+    tiramisu::buffer buff_A("buff_A", {size0, size1}, tiramisu::p_int32, a_input);
+    tiramisu::buffer buff_sum("buff_sum", {size0}, tiramisu::p_int32, a_output);
+    tiramisu::buffer buff_maximum("buff_maximum", {size0}, tiramisu::p_int32, a_output);
+    tiramisu::buffer buff_atomic_sum("buff_atomic_sum", {size0}, tiramisu::p_int32, a_output);
+    A.store_in(&buff_A);
+    sum_init.store_in(&buff_sum);
+    sum.store_in(&buff_sum, {i});
+    maximum_init.store_in(&buff_maximum);
+    maximum.store_in(&buff_maximum, {i});
+    atomic_sum_init.store_in(&buff_atomic_sum);
+    atomic_sum.store_in(&buff_atomic_sum, {i});
+
+    // Code generation
+    tiramisu::codegen({&buff_A, &buff_sum, &buff_maximum, &buff_atomic_sum},
+                      "build/generated_fct_test_" + std::string(TEST_NUMBER_STR) + ".o");
+}
+
+int main(int argc, char **argv)
+{
+    generate_function("tiramisu_generated_code", SIZE0, SIZE1);
+
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include <tiramisu/tiramisu.h>
+
+#include "wrapper_test_205.h"
+
+using namespace tiramisu;
+
+/**
+ * Test parallelize_scan() on the cumulative sums of the rows of a matrix.
+ * The number of blocks does not divide the extent of the scan.
+ */
+
+void generate_function(std::string name, int size0, int size1)
+{
+    tiramisu::init(name);
+
+    // Algorithm
+    tiramisu::var i("i", 0, size0), j("j", 1, size1), k("k", 0, size1);
+    tiramisu::input A("A", {i, k}, p_int32);
+
+    tiramisu::computation cumsum_first("cumsum_first", {i}, A(i, 0));
+    tiramisu::computation cumsum("cumsum", {i, j}, p_int32);
+    cumsum.set_expression(cumsum(i, j - 1) + A(i, j));
+
+    // Schedule
+    cumsum_first.then(cumsum, i);
+    cumsum.parallelize_scan(j, 4);
+
+    // Layer III
+    tiramisu::buffer buff_A("buff_A", {size0, size1}, tiramisu::p_int32, a_input);
+    tiramisu::buffer buff_cumsum("buff_cumsum", {size0, size1}, tiramisu::p_int32, a_output);
+    A.store_in(&buff_A);
+    cumsum_first.store_in(&buff_cumsum, {i, 0});
+    cumsum.store_in(&buff_cumsum);
+
+    // Code generation
+    tiramisu::codegen({&buff_A, &buff_cumsum}, "build/generated_fct_test_" + std::string(TEST_NUMBER_STR) + ".o");
+}
+
+int main(int argc, char **argv)
+{
+    generate_function("tiramisu_generated_code", SIZE0, SIZE1);
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include <tiramisu/tiramisu.h>
+
+#include "wrapper_test_206.h"
+
+using namespace tiramisu;
+
+/**
+ * Test split_parametric() and tile_parametric() with tile sizes read from
+ * an input.  The wrapper runs the generated code with several tile sizes,
+ * that divide the extents of the loops or not.
+ */
+
+void generate_function(std::string name, int size0, int size1)
+{
+    tiramisu::init(name);
+
+    // Algorithm
+    tiramisu::var i("i", 0, size0), j("j", 0, size1), s("s", 0, 2);
+    tiramisu::input sizes("sizes", {s}, p_int32);
+    tiramisu::input A("A", {i, j}, p_int32);
+
+    tiramisu::constant T0("T0", sizes(0)), T1("T1", sizes(1));
+
+    tiramisu::computation S0("S0", {j}, A(0, j) + 7);
+    tiramisu::computation S1("S1", {i, j}, A(i, j) * 2 - i);
+
+    // Schedule
+    S0.then(S1, computation::root);
+    S0.split_parametric(j, T0);
+    S1.tile_parametric(i, j, T0, T1);
+
+    // Layer III
+    tiramisu::buffer buff_sizes("buff_sizes", {2}, tiramisu::p_int32, a_input);
+    tiramisu::buffer buff_A("buff_A", {size0, size1}, tiramisu::p_int32, a_input);
+    tiramisu::buffer buff_S0("buff_S0", {size1}, tiramisu::p_int32, a_output);
+    tiramisu::buffer buff_S1("buff_S1", {size0, size1}, tiramisu::p_int32, a_output);
+    sizes.store_in(&buff_sizes);
+    A.store_in(&buff_A);
+    S0.store_in(&buff_S0);
+    S1.store_in(&buff_S1);
+
+    // Code generation
+    tiramisu::codegen({&buff_sizes, &buff_A, &buff_S0, &buff_S1},
+                      "build/generated_fct_test_" + std::string(TEST_NUMBER_STR) + ".o");
+}
+
+int main(int argc, char **argv)
+{
+    generate_function("tiramisu_generated_code", SIZE0, SIZE1);
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include <tiramisu/tiramisu.h>
+
+#include "wrapper_test_207.h"
+
+using namespace tiramisu;
+
+/**
+ * Test the linearization of the accesses to 2-D and 3-D buffers whose
+ * dimensions all have different sizes, read and written in a different
+ * order, and padded (see buffer::pad_dimension()) so that the strides of
+ * their outer dimensions are not the products of the sizes of the
+ * accessed elements.  The loop invariant parts of the indices are hoisted
+ * (see global::set_loop_invariant_code_motion()).
+ */
+
+void generate_function(std::string name, int size0, int size1, int size2)
+{
+    tiramisu::init(name);
+    tiramisu::global::set_loop_invariant_code_motion(true);
+
+    // Algorithm
+    tiramisu::var i("i", 0, size0), j("j", 0, size1), k("k", 0, size2);
+    tiramisu::input A2("A2", {i, j}, p_int32);
+    tiramisu::input A3("A3", {i, j, k}, p_int32);
+
+    tiramisu::computation S2("S2", {j, i}, A2(i, j) * 3 + j);
+    tiramisu::computation S3("S3", {i, j, k}, A3(i, j, k) - A2(i, j) + k);
+
+    // Schedule
+    S2.then(S3, computation::root);
+
+    // Layer III
+    tiramisu::buffer buff_A2("buff_A2", {size0, size1}, tiramisu::p_int32, a_input);
+    tiramisu::buffer buff_A3("buff_A3", {size0, size1, size2}, tiramisu::p_int32, a_input);
+    tiramisu::buffer buff_S2("buff_S2", {size1, size0}, tiramisu::p_int32, a_output);
+    tiramisu::buffer buff_S3("buff_S3", {size0, size1, size2}, tiramisu::p_int32, a_output);
+    buff_A2.pad_dimension(1, PAD_A2);
+    buff_A3.pad_dimension(1, PAD_A3);
+    buff_S3.pad_dimension(2, PAD_S3);
+    A2.store_in(&buff_A2);
+    A3.store_in(&buff_A3);
+    S2.store_in(&buff_S2);
+    S3.store_in(&buff_S3);
+
+    // Code generation
+    tiramisu::codegen({&buff_A2, &buff_A3, &buff_S2, &buff_S3},
+                      "build/generated_fct_test_" + std::string(TEST_NUMBER_STR) + ".o");
+}
+
+int main(int argc, char **argv)
+{
+    generate_function("tiramisu_generated_code", SIZE0, SIZE1, SIZE2);
+
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "Halide.h"
+#include <tiramisu/utils.h>
+#include <cstdlib>
+#include <iostream>
+
+#include "wrapper_test_201.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+int main(int, char **)
+{
+    Halide::Buffer<int32_t> A(SIZE1, SIZE0, "A");
+    Halide::Buffer<int32_t> x(SIZE1, "x");
+    for (int j = 0; j < SIZE1; j++)
+    {
+        x(j) = j % 7 - 3;
+        for (int i = 0; i < SIZE0; i++)
+            A(j, i) = i * j + 1;
+    }
+
+    Halide::Buffer<int32_t> reference_buf0(SIZE0, "reference_buf0");
+    for (int i = 0; i < SIZE0; i++)
+    {
+        reference_buf0(i) = 0;
+        for (int j = 0; j < SIZE1; j++)
+            reference_buf0(i) += A(j, i) * x(j);
+    }
+
+    Halide::Buffer<int32_t> output_buf0(SIZE0, "output_buf0");
+    init_buffer(output_buf0, (int32_t)0);
+
+    // Call the Tiramisu generated code
+    tiramisu_generated_code(A.raw_buffer(), x.raw_buffer(), output_buf0.raw_buffer());
+
+    compare_buffers(std::string(TEST_NAME_STR), output_buf0, reference_buf0);
+
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include "Halide.h"
+#include <tiramisu/utils.h>
+#include <cstdlib>
+#include <iostream>
+
+#include "wrapper_test_202.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+int main(int, char **)
+{
+    Halide::Buffer<int32_t> A(SIZE, "A");
+    for (int i = 0; i < SIZE; i++)
+        A(i) = i - 5;
+
+    // SIZE satisfies the condition of the specialized version, SIZE - 3 does not
+    for (int n : {SIZE, SIZE - 3})
+    {
+        Halide::Buffer<int32_t> N(1, "N");
+        init_buffer(N, (int32_t) n);
+
+        Halide::Buffer<int32_t> reference_buf0(SIZE, "reference_buf0");
+        init_buffer(reference_buf0, (int32_t) -1);
+        for (int i = 0; i < n; i++)
+            reference_buf0(i) = A(i) * 3 + 1;
+
+        Halide::Buffer<int32_t> output_buf0(SIZE, "output_buf0");
+        init_buffer(output_buf0, (int32_t) -1);
+
+        // Call the Tiramisu generated code
+        tiramisu_generated_code(N.raw_buffer(), A.raw_buffer(), output_buf0.raw_buffer());
+
+        compare_buffers(std::string(TEST_NAME_STR) + " (N = " + std::to_string(n) + ")", output_buf0, reference_buf0);
+    }
+
+    return 0;
+}
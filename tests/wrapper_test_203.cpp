@@ -0,0 +1,37 @@
+#include "Halide.h"
+#include <tiramisu/utils.h>
+#include <cstdlib>
+#include <iostream>
+
+#include "wrapper_test_203.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+int main(int, char **)
+{
+    Halide::Buffer<int32_t> A(SIZE1, SIZE0, "A");
+    for (int i = 0; i < SIZE0; i++)
+        for (int j = 0; j < SIZE1; j++)
+            A(j, i) = 3 * i - j;
+
+    Halide::Buffer<int32_t> reference_buf0(SIZE1, SIZE0, "reference_buf0");
+    for (int i = 0; i < SIZE0; i++)
+        for (int j = 0; j < SIZE1; j++)
+            reference_buf0(j, i) = (A(j, i) * 2 + i - j) + A(j, i);
+
+    Halide::Buffer<int32_t> output_buf0(SIZE1, SIZE0, "output_buf0");
+    init_buffer(output_buf0, (int32_t)0);
+
+    // Call the Tiramisu generated code
+    tiramisu_generated_code(A.raw_buffer(), output_buf0.raw_buffer());
+
+    compare_buffers(std::string(TEST_NAME_STR), output_buf0, reference_buf0);
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include "Halide.h"
+#include <tiramisu/utils.h>
+#include <cstdlib>
+#include <iostream>
+
+#include "wrapper_test_204.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+int main(int, char **)
+{
+    Halide::Buffer<int32_t> A(SIZE1, SIZE0, "A");
+    for (int i = 0; i < SIZE0; i++)
+        for (int j = 0; j < SIZE1; j++)
+            A(j, i) = (i * 37 + j * 11) % 101 - 50;
+
+    Halide::Buffer<int32_t> reference_sum(SIZE0, "reference_sum");
+    Halide::Buffer<int32_t> reference_max(SIZE0, "reference_max");
+    for (int i = 0; i < SIZE0; i++)
+    {
+        reference_sum(i) = 0;
+        reference_max(i) = -1000;
+        for (int j = 0; j < SIZE1; j++)
+        {
+            reference_sum(i) += A(j, i);
+            reference_max(i) = std::max(reference_max(i), A(j, i));
+        }
+    }
+
+    Halide::Buffer<int32_t> output_sum(SIZE0, "output_sum");
+    Halide::Buffer<int32_t> output_max(SIZE0, "output_max");
+    Halide::Buffer<int32_t> output_atomic_sum(SIZE0, "output_atomic_sum");
+    init_buffer(output_sum, (int32_t)0);
+    init_buffer(output_max, (int32_t)0);
+    init_buffer(output_atomic_sum, (int32_t)0);
+
+    // Call the Tiramisu generated code
+    tiramisu_generated_code(A.raw_buffer(), output_sum.raw_buffer(), output_max.raw_buffer(),
+                            output_atomic_sum.raw_buffer());
+
+    compare_buffers(std::string(TEST_NAME_STR) + " (privatized)", output_sum, reference_sum);
+    compare_buffers(std::string(TEST_NAME_STR) + " (tree)", output_max, reference_max);
+    compare_buffers(std::string(TEST_NAME_STR) + " (atomic)", output_atomic_sum, reference_sum);
+
+    return 0;
+}
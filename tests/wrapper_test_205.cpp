@@ -0,0 +1,40 @@
+#include "Halide.h"
+#include <tiramisu/utils.h>
+#include <cstdlib>
+#include <iostream>
+
+#include "wrapper_test_205.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+int main(int, char **)
+{
+    Halide::Buffer<int32_t> A(SIZE1, SIZE0, "A");
+    for (int i = 0; i < SIZE0; i++)
+        for (int j = 0; j < SIZE1; j++)
+            A(j, i) = (i + 1) * (j % 5) - 2;
+
+    Halide::Buffer<int32_t> reference_buf0(SIZE1, SIZE0, "reference_buf0");
+    for (int i = 0; i < SIZE0; i++)
+    {
+        reference_buf0(0, i) = A(0, i);
+        for (int j = 1; j < SIZE1; j++)
+            reference_buf0(j, i) = reference_buf0(j - 1, i) + A(j, i);
+    }
+
+    Halide::Buffer<int32_t> output_buf0(SIZE1, SIZE0, "output_buf0");
+    init_buffer(output_buf0, (int32_t)0);
+
+    // Call the Tiramisu generated code
+    tiramisu_generated_code(A.raw_buffer(), output_buf0.raw_buffer());
+
+    compare_buffers(std::string(TEST_NAME_STR), output_buf0, reference_buf0);
+
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "Halide.h"
+#include <tiramisu/utils.h>
+#include <cstdlib>
+#include <iostream>
+
+#include "wrapper_test_206.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+int main(int, char **)
+{
+    Halide::Buffer<int32_t> A(SIZE1, SIZE0, "A");
+    for (int i = 0; i < SIZE0; i++)
+        for (int j = 0; j < SIZE1; j++)
+            A(j, i) = i * SIZE1 + j;
+
+    Halide::Buffer<int32_t> reference_S0(SIZE1, "reference_S0");
+    for (int j = 0; j < SIZE1; j++)
+        reference_S0(j) = A(j, 0) + 7;
+
+    Halide::Buffer<int32_t> reference_S1(SIZE1, SIZE0, "reference_S1");
+    for (int i = 0; i < SIZE0; i++)
+        for (int j = 0; j < SIZE1; j++)
+            reference_S1(j, i) = A(j, i) * 2 - i;
+
+    // The same generated code runs with each pair of tile sizes
+    for (std::pair<int, int> tile_sizes : {std::make_pair(3, 4), std::make_pair(5, 13), std::make_pair(1, 32)})
+    {
+        Halide::Buffer<int32_t> sizes(2, "sizes");
+        sizes(0) = tile_sizes.first;
+        sizes(1) = tile_sizes.second;
+
+        Halide::Buffer<int32_t> output_S0(SIZE1, "output_S0");
+        Halide::Buffer<int32_t> output_S1(SIZE1, SIZE0, "output_S1");
+        init_buffer(output_S0, (int32_t)0);
+        init_buffer(output_S1, (int32_t)0);
+
+        // Call the Tiramisu generated code
+        tiramisu_generated_code(sizes.raw_buffer(), A.raw_buffer(), output_S0.raw_buffer(), output_S1.raw_buffer());
+
+        std::string tiles = " (" + std::to_string(tile_sizes.first) + " x " + std::to_string(tile_sizes.second) + ")";
+        compare_buffers(std::string(TEST_NAME_STR) + tiles, output_S0, reference_S0);
+        compare_buffers(std::string(TEST_NAME_STR) + tiles, output_S1, reference_S1);
+    }
+
+    return 0;
+}
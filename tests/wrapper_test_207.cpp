@@ -0,0 +1,54 @@
+#include "Halide.h"
+#include <tiramisu/utils.h>
+#include <cstdlib>
+#include <iostream>
+
+#include "wrapper_test_207.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+int main(int, char **)
+{
+    // The padding elements hold -1, they must be neither read nor written
+    Halide::Buffer<int32_t> A2(SIZE1 + PAD_A2, SIZE0, "A2");
+    Halide::Buffer<int32_t> A3(SIZE2, SIZE1 + PAD_A3, SIZE0, "A3");
+    init_buffer(A2, (int32_t)-1);
+    init_buffer(A3, (int32_t)-1);
+    for (int i = 0; i < SIZE0; i++)
+        for (int j = 0; j < SIZE1; j++)
+        {
+            A2(j, i) = 10 * i + j;
+            for (int k = 0; k < SIZE2; k++)
+                A3(k, j, i) = 100 * i + 10 * j + k;
+        }
+
+    Halide::Buffer<int32_t> reference_S2(SIZE0, SIZE1, "reference_S2");
+    Halide::Buffer<int32_t> reference_S3(SIZE2 + PAD_S3, SIZE1, SIZE0, "reference_S3");
+    init_buffer(reference_S3, (int32_t)-1);
+    for (int i = 0; i < SIZE0; i++)
+        for (int j = 0; j < SIZE1; j++)
+        {
+            reference_S2(i, j) = A2(j, i) * 3 + j;
+            for (int k = 0; k < SIZE2; k++)
+                reference_S3(k, j, i) = A3(k, j, i) - A2(j, i) + k;
+        }
+
+    Halide::Buffer<int32_t> output_S2(SIZE0, SIZE1, "output_S2");
+    Halide::Buffer<int32_t> output_S3(SIZE2 + PAD_S3, SIZE1, SIZE0, "output_S3");
+    init_buffer(output_S2, (int32_t)-1);
+    init_buffer(output_S3, (int32_t)-1);
+
+    // Call the Tiramisu generated code
+    tiramisu_generated_code(A2.raw_buffer(), A3.raw_buffer(), output_S2.raw_buffer(), output_S3.raw_buffer());
+
+    compare_buffers(std::string(TEST_NAME_STR) + " (2-D)", output_S2, reference_S2);
+    compare_buffers(std::string(TEST_NAME_STR) + " (3-D)", output_S3, reference_S3);
+
+    return 0;
+}
@@ -30,16 +30,44 @@ with torch.no_grad():
 
     try:
         while True:
-            prog_json = input()
-            sched_json = input()
+            line = input()
 
-            prog_json = json.loads(prog_json)
-            sched_json = json.loads(sched_json)
+            # A batch of schedules : "batch N" followed by N pairs of (program, schedule)
+            if line.startswith('batch'):
+                batch_size = int(line.split()[1])
+                speedups = [0.0] * batch_size
+
+                # The model takes one loop tree for a whole tensor, so the schedules
+                # of the same program that share the same tree (usually all of them)
+                # are stacked along the batch dimension and evaluated with a single
+                # forward pass
+                groups = dict()
+                for i in range(batch_size):
+                    prog_line = input()
+                    prog_json = json.loads(prog_line)
+                    sched_json = json.loads(input())
+
+                    prog_tree, prog_tensor = get_representation(prog_json, sched_json)
+                    group_key = (prog_line, json.dumps(sched_json['tree_structure'], sort_keys=True))
+                    group = groups.setdefault(group_key, (prog_tree, [], []))
+                    group[1].append(i)
+                    group[2].append(prog_tensor)
+
+                for prog_tree, indices, tensors in groups.values():
+                    group_speedups = model.forward((prog_tree, torch.cat(tensors, 0)))
+                    for i, speedup in zip(indices, group_speedups.tolist()):
+                        speedups[i] = float(speedup)
+
+                print('\n'.join(map(str, speedups)), flush=True)
+                continue
+
+            prog_json = json.loads(line)
+            sched_json = json.loads(input())
 
             tree_tensor = get_representation(prog_json, sched_json)
             
             speedup = model.forward(tree_tensor)
-            print(float(speedup.item()))
+            print(float(speedup.item()), flush=True)
             
     except EOFError:
         exit()
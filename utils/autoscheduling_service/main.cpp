@@ -0,0 +1,39 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <tiramisu/auto_scheduler/service.h>
+
+using namespace tiramisu::auto_scheduler;
+
+//Starts an autoscheduling service : the jobs submitted on the socket share the cost model started here,
+//and the predictions are kept in the evaluation cache between the jobs and the runs of the service. See README.md.
+//
+//usage : ./autoscheduling_service SOCKET NB_WORKERS CACHE_FILE MODEL_CMD [MODEL_ARGS...]
+
+
+int main(int argc, char **argv) {
+    if (argc < 5) {
+        std::cerr << "usage : " << argv[0] << " SOCKET NB_WORKERS CACHE_FILE MODEL_CMD [MODEL_ARGS...]" << std::endl;
+        return 1;
+    }
+
+    std::string socket_path = argv[1];
+    int nb_workers = std::atoi(argv[2]);
+
+    std::vector<std::string> model_args;
+    for (int i = 5; i < argc; ++i)
+        model_args.push_back(argv[i]);
+
+    evaluate_by_learning_model model(argv[4], model_args);
+    evaluation_cache cache(argv[3]);
+    model.set_cache(&cache);
+
+    autoscheduling_service service(socket_path, &model, nb_workers);
+    std::cout << "Listening on " << socket_path << " with " << nb_workers << " workers" << std::endl;
+
+    service.run();
+
+    std::cout << "Stats : " << service.get_stats_json() << std::endl;
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <chrono>
+#include <cstdlib>
+#include "tiramisu_code_generator.h"
+
+using namespace std;
+
+//Generates synthetic programs of increasing size, compiles them, and measures the time, the number of isl operations and
+//the peak memory of each phase of their code generation (the dependence analysis, gen_ordering_schedules, gen_time_space_domain,
+//gen_isl_ast, gen_halide_stmt and the emission of the object file). The results are written in a JSON file, to track the compile
+//time across versions of Tiramisu. See README.md.
+//
+//usage : ./compile_time_benchmark [RESULT_FILE]
+
+
+//a family of programs : the shape of their loop nests and of their updates
+struct program_family {
+    string name;
+    vector<int> computation_dimensions;
+    vector<int> var_nums;
+    int updates_per_buffer;
+};
+
+//returns the numbers of computations of the programs of each family, given by COMPILE_BENCHMARK_SIZES (e.g. "10,100,1000")
+vector<int> get_program_sizes(){
+    string sizes_list = (getenv("COMPILE_BENCHMARK_SIZES") != nullptr) ? getenv("COMPILE_BENCHMARK_SIZES") : "10,50,100,500,1000,2000,5000";
+    vector<int> sizes;
+    stringstream sizes_stream(sizes_list);
+    string size;
+    while (getline(sizes_stream, size, ','))
+        if (!size.empty())
+            sizes.push_back(atoi(size.c_str()));
+    return sizes;
+}
+
+int main(int argc, char **argv) {
+    string result_filename = (argc > 1) ? argv[1] : "compile_times.json";
+
+    //sequences of 3D nests, deep 6D nests, and sequences of 3D nests where groups of 8 computations update the same buffer
+    vector<program_family> families = {
+        {"sequence", {32, 32, 32}, {0, 1}, 1},
+        {"deep", {4, 4, 4, 4, 4, 4}, {0, 1}, 1},
+        {"updates", {32, 32, 32}, {0, 1}, 8}
+    };
+
+    //assignments, assignments of inputs and stencils
+    double computations_probs[2] = {0.3, 0.3};
+    int nb_inputs = 2, offset = 1;
+    string default_type_tiramisu = "p_int32", default_type_wrapper = "int32_t";
+
+    measure_compile_time = true;
+    mkdir("samples", S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+
+    string compile_cmd = get_compile_command();
+    vector<int> sizes = get_program_sizes();
+    ofstream results(result_filename);
+    results << "[";
+
+    int code_id = 0;
+    for (program_family &family : families) {
+        for (int nb_computations : sizes) {
+            //the same programs are generated at each run of the benchmark
+            srand(nb_computations);
+            updates_per_buffer = family.updates_per_buffer;
+            generate_tiramisu_code_multiple_computations(code_id, &family.computation_dimensions, nb_computations, computations_probs,
+                                                         &family.var_nums, nb_inputs, &default_type_tiramisu, &default_type_wrapper, offset);
+
+            //the programs are compiled and run one at a time, so that they do not disturb each other's measurements
+            string function_name = "function" + to_string(code_id++);
+            string dir = "samples/" + function_name;
+            string cmd = "cd " + dir + " && " + compile_cmd + " " + function_name + "_file.cpp -o generator > log.txt 2>&1 && ./generator >> log.txt 2>&1";
+
+            auto start = chrono::steady_clock::now();
+            bool succeeded = system(cmd.c_str()) == 0;
+            auto end = chrono::steady_clock::now();
+
+            ifstream phases_file(dir + "/" + function_name + "_compile_times.json");
+            stringstream phases;
+            phases << phases_file.rdbuf();
+            string phases_json = phases.str();
+            while (!phases_json.empty() && (phases_json.back() == '\n' || phases_json.back() == ' '))
+                phases_json.pop_back();
+            succeeded = succeeded && !phases_json.empty();
+
+            results << (code_id > 1 ? ",\n " : "\n ") << "{\"family\": \"" << family.name << "\", \"function\": \"" << function_name
+                    << "\", \"nb_computations\": " << nb_computations << ", \"depth\": " << family.computation_dimensions.size()
+                    << ", \"updates_per_buffer\": " << family.updates_per_buffer << ", \"succeeded\": " << (succeeded ? "true" : "false")
+                    << ", \"wall_time_s\": " << chrono::duration<double>(end - start).count()
+                    << ", \"phases\": " << (succeeded ? phases_json : "[]") << "}";
+            results.flush();
+
+            cout << family.name << " " << nb_computations << " computations : "
+                 << (succeeded ? "done" : "failed (see " + dir + "/log.txt)") << endl;
+        }
+    }
+
+    results << "\n]\n";
+    cout << "compile times written to " << result_filename << endl;
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <map>
+#include <chrono>
+#include <cstdlib>
+#include <climits>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "tiramisu_code_generator.h"
+
+using namespace std;
+
+//Generates random programs (with the parameters of inputs.txt), and samples and measures schedules of each program
+//with the autoscheduler, in parallel worker processes. See README.md.
+//
+//usage : ./dataset_generator NB_WORKERS [DATASET_FILE]
+
+
+//compiles the generated code of function_name and samples its schedules, in a child process
+pid_t start_worker(string function_name, int worker_id, string compile_cmd, string lock_path){
+    pid_t pid = fork();
+    if (pid != 0)
+        return pid;
+
+    string dir = "samples/" + function_name;
+    if (chdir(dir.c_str()) != 0)
+        _exit(1);
+
+    setenv("DATASET_WORKER_ID", to_string(worker_id).c_str(), 1);
+    setenv("DATASET_LOCK", lock_path.c_str(), 1);
+
+    string cmd = compile_cmd + " " + function_name + "_file.cpp -o generator > log.txt 2>&1 && ./generator >> log.txt 2>&1";
+    execl("/bin/sh", "sh", "-c", cmd.c_str(), (char *) nullptr);
+    _exit(1);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        cerr << "usage : " << argv[0] << " NB_WORKERS [DATASET_FILE]" << endl;
+        return 1;
+    }
+
+    int nb_workers = max(1, atoi(argv[1]));
+    string dataset_filename = (argc > 2) ? argv[2] : "dataset.jsonl";
+
+    int nb_codes, nb_stages, nb_inputs, offset;
+    vector <int> computations_dimensions, var_nums;
+    double assignment_prob, assignment_input_prob, conv_prob, same_padding_prob;
+    string defaut_type_tiramisu, default_type_wrapper;
+    read_inputs(&nb_codes, &nb_stages, &defaut_type_tiramisu, &default_type_wrapper, &assignment_prob, &assignment_input_prob, &conv_prob, &same_padding_prob, &computations_dimensions, &nb_inputs, &var_nums, &offset);
+
+    double num, *padding_probs = new double[1], *computations_probs = new double[2];
+
+    padding_probs[0] = same_padding_prob;
+
+    computations_probs[0] = assignment_prob;
+    computations_probs[1] = assignment_input_prob;
+
+    //generate the codes
+    sample_schedules = true;
+    mkdir("samples", S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+
+    for (int i = 0; i < nb_codes; ++i){
+        num = (double) rand() / (RAND_MAX);
+        if (num < conv_prob){
+            generate_tiramisu_code_conv(i, nb_stages, padding_probs, &defaut_type_tiramisu, &default_type_wrapper);
+        }
+        else{
+            generate_tiramisu_code_multiple_computations(i, &computations_dimensions, nb_stages, computations_probs, &var_nums, nb_inputs, &defaut_type_tiramisu, &default_type_wrapper, offset);
+        }
+    }
+
+    //the parameters of the sampling, if they are not given
+    setenv("BEAM_SIZE", "4", 0);
+    setenv("MAX_DEPTH", "6", 0);
+
+    string compile_cmd = get_compile_command();
+    char cwd[PATH_MAX];
+    string lock_path = string(getcwd(cwd, sizeof(cwd)) != nullptr ? cwd : ".") + "/dataset.lock";
+
+    //compile and sample the codes in parallel, each worker uses its own slot id so that its files are private
+    map<pid_t, int> running;
+    vector<int> free_slots;
+    for (int i = nb_workers - 1; i >= 0; --i)
+        free_slots.push_back(i);
+
+    vector<bool> succeeded(nb_codes, false);
+    map<pid_t, int> codes;
+    int next_code = 0;
+
+    auto start = chrono::steady_clock::now();
+
+    while (next_code < nb_codes || !running.empty()) {
+        while (next_code < nb_codes && !free_slots.empty()) {
+            int slot = free_slots.back();
+            free_slots.pop_back();
+
+            pid_t pid = start_worker("function" + to_string(next_code), slot, compile_cmd, lock_path);
+            running[pid] = slot;
+            codes[pid] = next_code++;
+        }
+
+        int status;
+        pid_t pid = wait(&status);
+        if (pid == -1)
+            break;
+
+        free_slots.push_back(running[pid]);
+        running.erase(pid);
+
+        int code_id = codes[pid];
+        succeeded[code_id] = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        cout << "function" << code_id << (succeeded[code_id] ? " done" : " failed (see its log.txt)") << endl;
+    }
+
+    //gather the sampled schedules of the codes, one JSON object per line
+    ofstream dataset(dataset_filename);
+    int nb_succeeded = 0;
+
+    for (int i = 0; i < nb_codes; ++i) {
+        if (!succeeded[i])
+            continue;
+
+        string function_name = "function" + to_string(i);
+        ifstream sample("samples/" + function_name + "/" + function_name + "_explored_schedules.json");
+        stringstream content;
+        content << sample.rdbuf();
+
+        //new lines and tabs only appear between the tokens of the JSON
+        string line = content.str();
+        for (char &c : line)
+            if (c == '\n' || c == '\t')
+                c = ' ';
+
+        dataset << line << "\n";
+        nb_succeeded++;
+    }
+
+    auto end = chrono::steady_clock::now();
+    cout << nb_succeeded << " / " << nb_codes << " programs sampled in "
+         << chrono::duration_cast<chrono::seconds>(end - start).count() << " s, written to " << dataset_filename << endl;
+
+    return 0;
+}
@@ -8,8 +8,6 @@
 using namespace std;
 
 
-void read_inputs(int *nb_codes, int *nb_stages, string *default_type_tiramisu, string *default_type_wrapper, double *assignment_prob, double *assignment_input_prob, double *conv_prob, double *same_padding_prob, vector<int> *computations_dimensions, 
-                int *nb_inputs,  vector <int> *var_nums, int *offset);
 int main() {
     int nb_codes, nb_stages, nb_inputs, offset;
     vector <int> computations_dimensions, var_nums;
@@ -37,137 +35,3 @@ int main() {
 
     return 0;
 }
-
-void read_inputs(int *nb_codes, int *nb_stages, string *default_type_tiramisu, string *default_type_wrapper, double *assignment_prob, double *assignment_input_prob, double *conv_prob, double *same_padding_prob, vector<int> *computations_dimensions, 
-                int *nb_inputs,  vector <int> *var_nums, int *offset){
-    ifstream input_file;
-    string line, info;
-    unsigned long pos1, pos2;
-    input_file.open("inputs.txt");
-
-    //nb_codes
-    {
-        getline(input_file, line);
-        pos1 = line.find("\"", 0);
-        pos2 = line.find("\"", pos1 + 1);
-        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        stringstream info_stream(info);
-        info_stream >> *nb_codes;
-    }
-
-    //nb_stages
-    {
-        getline(input_file, line);
-        pos1 = line.find("\"", 0);
-        pos2 = line.find("\"", pos1 + 1);
-        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        stringstream info_stream(info);
-        info_stream >> *nb_stages;
-    }
-
-    //default_type_tiramisu
-    {
-        getline(input_file, line);
-        pos1 = line.find("\"", 0);
-        pos2 = line.find("\"", pos1 + 1);
-        *default_type_tiramisu = line.substr(pos1 + 1, pos2 - pos1 - 1);
-    }
-
-    //default_type_wrapper
-    {
-        getline(input_file, line);
-        pos1 = line.find("\"", 0);
-        pos2 = line.find("\"", pos1 + 1);
-        *default_type_wrapper = line.substr(pos1 + 1, pos2 - pos1 - 1);
-    }
-
-
-    //assignment_prob
-    {
-        getline(input_file, line);
-        pos1 = line.find("\"", 0);
-        pos2 = line.find("\"", pos1 + 1);
-        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        stringstream info_stream(info);
-        info_stream >> *assignment_prob;
-    }
-
-    //assignment_input_prob
-    {
-        getline(input_file, line);
-        pos1 = line.find("\"", 0);
-        pos2 = line.find("\"", pos1 + 1);
-        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        stringstream info_stream(info);
-        info_stream >> *assignment_input_prob;
-    }
-
-    //conv_prob
-    {
-        getline(input_file, line);
-        pos1 = line.find("\"", 0);
-        pos2 = line.find("\"", pos1 + 1);
-        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        stringstream info_stream(info);
-        info_stream >> *conv_prob;
-    }
-
-    //computations_dimensions
-    {
-        getline(input_file, line);
-        pos1 = line.find("\"", 0);
-        pos2 = line.find("\"", pos1 + 1);
-        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        stringstream info_stream(info);
-        int number;
-        while (info_stream >> number) {
-            (*computations_dimensions).push_back(number);
-        }
-
-    }
-
-    //nb_inputs
-    {
-        getline(input_file, line);
-        pos1 = line.find("\"", 0);
-        pos2 = line.find("\"", pos1 + 1);
-        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        stringstream info_stream(info);
-        info_stream >> *nb_inputs;
-    }
-
-    //var_nums
-    {
-        getline(input_file, line);
-        pos1 = line.find("\"", 0);
-        pos2 = line.find("\"", pos1 + 1);
-        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        stringstream info_stream(info);
-        int number;
-        while (info_stream >> number)
-            (*var_nums).push_back(number);
-
-    }
-
-    //offset
-    {
-        getline(input_file, line);
-        pos1 = line.find("\"", 0);
-        pos2 = line.find("\"", pos1 + 1);
-        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        stringstream info_stream(info);
-        info_stream >> *offset;
-    }
-
-    //same_padding_prob
-    {
-        getline(input_file, line);
-        pos1 = line.find("\"", 0);
-        pos2 = line.find("\"", pos1 + 1);
-        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        stringstream info_stream(info);
-        info_stream >> *same_padding_prob;
-    }
-
-
-}
@@ -1,5 +1,33 @@
 #include "tiramisu_code_generator.h"
 
+bool sample_schedules = false;
+bool measure_compile_time = false;
+int updates_per_buffer = 1;
+
+//=====================================================================compilation==========================================================================================================
+//returns the command that compiles a generated code (the source file and the output are appended)
+string get_compile_command(){
+    if (getenv("DATASET_COMPILE_CMD") != nullptr)
+        return getenv("DATASET_COMPILE_CMD");
+
+    string root = (getenv("TIRAMISU_ROOT") != nullptr) ? getenv("TIRAMISU_ROOT") : "../..";
+    string lib_dirs = root + "/build:" + root + "/build/src/auto_scheduler:" + root + "/3rdParty/Halide/lib:" + root + "/3rdParty/isl/build/lib";
+
+    string cmd = "g++ -std=c++17 -O2 -fno-rtti -I" + root + "/include -I" + root + "/3rdParty/Halide/include -I" + root + "/3rdParty/isl/include";
+    stringstream dirs(lib_dirs);
+    string dir;
+    while (getline(dirs, dir, ':'))
+        cmd += " -L" + dir + " -Wl,-rpath," + dir;
+
+    cmd += " -ltiramisu_auto_scheduler -ltiramisu -lHalide -lisl -ldl -lpthread -lz -lm";
+
+    //the compilations can be kept away from the cores on which the schedules are measured (AS_PIN_CORES)
+    if (getenv("DATASET_COMPILE_CORES") != nullptr)
+        cmd = "taskset -c " + string(getenv("DATASET_COMPILE_CORES")) + " " + cmd;
+
+    return cmd;
+}
+
 //=====================================================================tiramisu_code_generator==========================================================================================================
 
 vector<variable*> generate_variables(int nb_variables, int from, int *inf_values, int *constants){
@@ -127,6 +155,16 @@ void generate_tiramisu_code_multiple_computations(int code_id, vector<int> *comp
     computation *stage_computation;
 
     for (int i = 0; i < nb_stages; ++i) {
+        //the stages after the first one of a group of updates_per_buffer stages update the buffer of the first one
+        if (i % updates_per_buffer != 0){
+            stage_computation = generate_computation("comp" + to_string(i), variables, ASSIGNMENT_INPUTS, {computations.back()}, {}, 0);
+            stage_computation->expression += " + " + to_string(rand() % MAX_ASSIGNMENT_VAL);
+            computations.push_back(stage_computation);
+            abs = {stage_computation};
+            buffers.back()->computations.push_back(stage_computation);
+            continue;
+        }
+
         switch (types[i]){
             case ASSIGNMENT:
                 stage_computation = generate_computation("comp" + to_string(i), variables, ASSIGNMENT, {}, {}, 0);
@@ -453,6 +491,9 @@ vector <int> generate_padding_types(int nb_layers, double *padding_probs){
 
 tiramisu_code::tiramisu_code(string function_name, vector<computation*> *computations, vector <variable*> *variables, /*vector<constant*> *constants,*/ vector<input*> *inputs, vector<buffer*> *buffers, string *default_type){
     this->code_buffer = "#include <tiramisu/tiramisu.h>\n"
+                        + string(sample_schedules ? "#include <tiramisu/auto_scheduler/evaluator.h>\n"
+                                                    "#include <tiramisu/auto_scheduler/search_method.h>\n" : "") +
+                        string(measure_compile_time ? "#include <fstream>\n" : "") +
                         "\n"
                         "using namespace tiramisu;\n"
                         "\n"
@@ -555,12 +596,73 @@ void tiramisu_code::write_inputs() {
 }
 
 void tiramisu_code::generate_code() {
-    new_line(2, indentation_level, &code_buffer);
-    code_buffer += "tiramisu::codegen({&" + buffers[0]->name;
+    string buffers_list = "{&" + buffers[0]->name;
     for (int i = 1; i < buffers.size(); ++i) {
-        code_buffer += ", &" + buffers[i]->name;
+        buffers_list += ", &" + buffers[i]->name;
+    }
+    buffers_list += "}";
+
+    if (measure_compile_time) {
+        //the phases of the dependence analysis and of codegen are recorded by the function, see compile_time_benchmark.cpp
+        new_line(2, indentation_level, &code_buffer);
+        code_buffer += "perform_full_dependency_analysis();";
+        new_line(1, indentation_level, &code_buffer);
+        code_buffer += "tiramisu::codegen(" + buffers_list + ", \"" + function_name + ".o\");";
+        new_line(2, indentation_level, &code_buffer);
+        code_buffer += "std::ofstream compile_times(\"" + function_name + "_compile_times.json\");";
+        new_line(1, indentation_level, &code_buffer);
+        code_buffer += "const char *separator = \"\";";
+        new_line(1, indentation_level, &code_buffer);
+        code_buffer += "compile_times << \"[\";";
+        new_line(1, indentation_level, &code_buffer);
+        code_buffer += "for (const compile_phase &p : global::get_implicit_function()->get_compile_phases()) {";
+        new_line(1, indentation_level + 1, &code_buffer);
+        code_buffer += "compile_times << separator << \"{\\\"phase\\\": \\\"\" << p.phase << \"\\\", \\\"ms\\\": \" << p.milliseconds "
+                       "<< \", \\\"isl_operations\\\": \" << p.isl_operations << \", \\\"peak_memory_kb\\\": \" << p.peak_memory_kb << \"}\";";
+        new_line(1, indentation_level + 1, &code_buffer);
+        code_buffer += "separator = \", \";";
+        new_line(1, indentation_level, &code_buffer);
+        code_buffer += "}";
+        new_line(1, indentation_level, &code_buffer);
+        code_buffer += "compile_times << \"]\\n\";";
+        return;
     }
-    code_buffer += "}, \"build/generated/generated_" + function_name + ".o\");";
+
+    if (!sample_schedules) {
+        new_line(2, indentation_level, &code_buffer);
+        code_buffer += "tiramisu::codegen(" + buffers_list + ", \"build/generated/generated_" + function_name + ".o\");";
+        return;
+    }
+
+    //the schedules are JIT-compiled and measured in this process, the measurements of the parallel workers
+    //of the dataset generator are serialized by the lock DATASET_LOCK
+    new_line(2, indentation_level, &code_buffer);
+    code_buffer += "prepare_schedules_for_legality_checks();";
+    new_line(1, indentation_level, &code_buffer);
+    code_buffer += "perform_full_dependency_analysis();";
+    new_line(2, indentation_level, &code_buffer);
+    code_buffer += "auto_scheduler::evaluate_by_jit *exec_eval = new auto_scheduler::evaluate_by_jit(" + buffers_list + ");";
+    new_line(1, indentation_level, &code_buffer);
+    code_buffer += "if (getenv(\"DATASET_WORKER_ID\") != nullptr)";
+    new_line(1, indentation_level + 1, &code_buffer);
+    code_buffer += "exec_eval->set_worker(atoi(getenv(\"DATASET_WORKER_ID\")), auto_scheduler::read_env_var(\"DATASET_LOCK\"));";
+    new_line(2, indentation_level, &code_buffer);
+    code_buffer += "auto_scheduler::schedules_generator *scheds_gen = new auto_scheduler::ml_model_schedules_generator();";
+    new_line(1, indentation_level, &code_buffer);
+    code_buffer += "auto_scheduler::search_method *bs = new auto_scheduler::beam_search(atoi(auto_scheduler::read_env_var(\"BEAM_SIZE\")), "
+                   "atoi(auto_scheduler::read_env_var(\"MAX_DEPTH\")), exec_eval, scheds_gen);";
+    new_line(1, indentation_level, &code_buffer);
+    code_buffer += "auto_scheduler::auto_scheduler as(bs, exec_eval);";
+    new_line(1, indentation_level, &code_buffer);
+    code_buffer += "as.set_exec_evaluator(exec_eval);";
+    new_line(1, indentation_level, &code_buffer);
+    code_buffer += "as.sample_search_space(\"" + function_name + "_explored_schedules.json\", true);";
+    new_line(2, indentation_level, &code_buffer);
+    code_buffer += "delete bs;";
+    new_line(1, indentation_level, &code_buffer);
+    code_buffer += "delete scheds_gen;";
+    new_line(1, indentation_level, &code_buffer);
+    code_buffer += "delete exec_eval;";
 }
 
 void tiramisu_code::write_buffers() {
@@ -723,6 +825,9 @@ computation_abstract* tiramisu_code::generate_tiramisu_conv_layer(vector<int> *i
 
 tiramisu_code::tiramisu_code(string function_name, vector <int> *padding_types, string *default_type) {
     this->code_buffer = "#include <tiramisu/tiramisu.h>\n"
+                        + string(sample_schedules ? "#include <tiramisu/auto_scheduler/evaluator.h>\n"
+                                                    "#include <tiramisu/auto_scheduler/search_method.h>\n" : "") +
+                        string(measure_compile_time ? "#include <fstream>\n" : "") +
                         "\n"
                         "using namespace tiramisu;\n"
                         "\n"
@@ -956,3 +1061,138 @@ string random_array_initialization(buffer *buffer, int *indentation_level, strin
     }
     return initialize_array;
 }
+
+//=====================================================================inputs==========================================================================================================
+void read_inputs(int *nb_codes, int *nb_stages, string *default_type_tiramisu, string *default_type_wrapper, double *assignment_prob, double *assignment_input_prob, double *conv_prob, double *same_padding_prob, vector<int> *computations_dimensions, 
+                int *nb_inputs,  vector <int> *var_nums, int *offset){
+    ifstream input_file;
+    string line, info;
+    unsigned long pos1, pos2;
+    input_file.open("inputs.txt");
+
+    //nb_codes
+    {
+        getline(input_file, line);
+        pos1 = line.find("\"", 0);
+        pos2 = line.find("\"", pos1 + 1);
+        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
+        stringstream info_stream(info);
+        info_stream >> *nb_codes;
+    }
+
+    //nb_stages
+    {
+        getline(input_file, line);
+        pos1 = line.find("\"", 0);
+        pos2 = line.find("\"", pos1 + 1);
+        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
+        stringstream info_stream(info);
+        info_stream >> *nb_stages;
+    }
+
+    //default_type_tiramisu
+    {
+        getline(input_file, line);
+        pos1 = line.find("\"", 0);
+        pos2 = line.find("\"", pos1 + 1);
+        *default_type_tiramisu = line.substr(pos1 + 1, pos2 - pos1 - 1);
+    }
+
+    //default_type_wrapper
+    {
+        getline(input_file, line);
+        pos1 = line.find("\"", 0);
+        pos2 = line.find("\"", pos1 + 1);
+        *default_type_wrapper = line.substr(pos1 + 1, pos2 - pos1 - 1);
+    }
+
+
+    //assignment_prob
+    {
+        getline(input_file, line);
+        pos1 = line.find("\"", 0);
+        pos2 = line.find("\"", pos1 + 1);
+        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
+        stringstream info_stream(info);
+        info_stream >> *assignment_prob;
+    }
+
+    //assignment_input_prob
+    {
+        getline(input_file, line);
+        pos1 = line.find("\"", 0);
+        pos2 = line.find("\"", pos1 + 1);
+        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
+        stringstream info_stream(info);
+        info_stream >> *assignment_input_prob;
+    }
+
+    //conv_prob
+    {
+        getline(input_file, line);
+        pos1 = line.find("\"", 0);
+        pos2 = line.find("\"", pos1 + 1);
+        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
+        stringstream info_stream(info);
+        info_stream >> *conv_prob;
+    }
+
+    //computations_dimensions
+    {
+        getline(input_file, line);
+        pos1 = line.find("\"", 0);
+        pos2 = line.find("\"", pos1 + 1);
+        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
+        stringstream info_stream(info);
+        int number;
+        while (info_stream >> number) {
+            (*computations_dimensions).push_back(number);
+        }
+
+    }
+
+    //nb_inputs
+    {
+        getline(input_file, line);
+        pos1 = line.find("\"", 0);
+        pos2 = line.find("\"", pos1 + 1);
+        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
+        stringstream info_stream(info);
+        info_stream >> *nb_inputs;
+    }
+
+    //var_nums
+    {
+        getline(input_file, line);
+        pos1 = line.find("\"", 0);
+        pos2 = line.find("\"", pos1 + 1);
+        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
+        stringstream info_stream(info);
+        int number;
+        while (info_stream >> number)
+            (*var_nums).push_back(number);
+
+    }
+
+    //offset
+    {
+        getline(input_file, line);
+        pos1 = line.find("\"", 0);
+        pos2 = line.find("\"", pos1 + 1);
+        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
+        stringstream info_stream(info);
+        info_stream >> *offset;
+    }
+
+    //same_padding_prob
+    {
+        getline(input_file, line);
+        pos1 = line.find("\"", 0);
+        pos2 = line.find("\"", pos1 + 1);
+        info = line.substr(pos1 + 1, pos2 - pos1 - 1);
+        stringstream info_stream(info);
+        info_stream >> *same_padding_prob;
+    }
+
+
+}
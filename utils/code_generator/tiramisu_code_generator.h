@@ -37,7 +37,9 @@
 #include <time.h>
 #include <sys/stat.h>
 #include <fstream>
+#include <sstream>
 #include <cmath>
+#include <cstdlib>
 
 
 using namespace std;
@@ -180,6 +182,28 @@ public:
 
 };
 
+//=====================================================================dataset==========================================================================================================
+//if true, the generated codes sample schedules with the autoscheduler (sample_search_space) instead of calling codegen,
+//for the dataset generator (see dataset_generator.cpp)
+extern bool sample_schedules;
+
+//returns the command that compiles a generated code (the source file and the output are appended), built from TIRAMISU_ROOT,
+//or given by DATASET_COMPILE_CMD (see README.md)
+string get_compile_command();
+
+//=====================================================================compile time benchmark==========================================================================================================
+//if true, the generated codes run the dependence analysis and codegen, and write the time and the peak memory of each phase
+//of the code generation in FUNCTION_NAME_compile_times.json (see compile_time_benchmark.cpp)
+extern bool measure_compile_time;
+//the number of consecutive stages of a multiple computations code stored in the same buffer : the stages after the first one
+//of each group update the buffer with the value of the previous stage
+extern int updates_per_buffer;
+
+//=====================================================================inputs==========================================================================================================
+//reads the parameters of the generator from the inputs.txt file (see README.md)
+void read_inputs(int *nb_codes, int *nb_stages, string *default_type_tiramisu, string *default_type_wrapper, double *assignment_prob, double *assignment_input_prob, double *conv_prob, double *same_padding_prob, vector<int> *computations_dimensions, 
+                int *nb_inputs,  vector <int> *var_nums, int *offset);
+
 //=====================================================================wrapper==========================================================================================================
 void generate_cpp_wrapper(string function_name, vector <buffer*> buffers, string *default_type_wrapper);
 void generate_h_wrapper(string function_name, vector <buffer*> buffers);
@@ -0,0 +1,30 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <tiramisu/auto_scheduler/machine_profile.h>
+
+using namespace tiramisu::auto_scheduler;
+
+//Measures the caches, the memory and the peak performance of the host, and saves them in a machine profile
+//used by the autoscheduler when AS_MACHINE_PROFILE gives its path. See README.md.
+//
+//usage : ./characterize PROFILE_FILE [NB_THREADS]
+
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "usage : " << argv[0] << " PROFILE_FILE [NB_THREADS]" << std::endl;
+        return 1;
+    }
+
+    int nb_threads = (argc > 2) ? std::atoi(argv[2]) : 0;
+
+    machine_profile profile = machine_profile::characterize(nb_threads);
+    std::cout << profile.get_json() << std::endl;
+
+    if (!profile.save(argv[1])) {
+        std::cerr << "error: cannot write " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}